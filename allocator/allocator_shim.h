@@ -80,6 +80,9 @@ struct AllocatorDispatch {
                            void** to_be_freed,
                            unsigned num_to_be_freed,
                            void* context);
+  // Frees |ptr|, whose allocation was requested with |size| bytes. Called by
+  // sized operator delete and by macOS malloc zones. Allocators which can't
+  // use the size just free |ptr|.
   using FreeDefiniteSizeFn = void(const AllocatorDispatch* self,
                                   void* ptr,
                                   size_t size,
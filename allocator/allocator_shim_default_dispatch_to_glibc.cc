@@ -51,6 +51,13 @@ void GlibcFree(const AllocatorDispatch*, void* address, void* context) {
   __libc_free(address);
 }
 
+void GlibcFreeDefiniteSize(const AllocatorDispatch*,
+                           void* address,
+                           size_t size,
+                           void* context) {
+  __libc_free(address);
+}
+
 size_t GlibcGetSizeEstimate(const AllocatorDispatch*,
                             void* address,
                             void* context) {
@@ -62,14 +69,14 @@ size_t GlibcGetSizeEstimate(const AllocatorDispatch*,
 }  // namespace
 
 const AllocatorDispatch AllocatorDispatch::default_dispatch = {
-    &GlibcMalloc,          /* alloc_function */
-    &GlibcCalloc,          /* alloc_zero_initialized_function */
-    &GlibcMemalign,        /* alloc_aligned_function */
-    &GlibcRealloc,         /* realloc_function */
-    &GlibcFree,            /* free_function */
-    &GlibcGetSizeEstimate, /* get_size_estimate_function */
-    nullptr,               /* batch_malloc_function */
-    nullptr,               /* batch_free_function */
-    nullptr,               /* free_definite_size_function */
-    nullptr,               /* next */
+    &GlibcMalloc,           /* alloc_function */
+    &GlibcCalloc,           /* alloc_zero_initialized_function */
+    &GlibcMemalign,         /* alloc_aligned_function */
+    &GlibcRealloc,          /* realloc_function */
+    &GlibcFree,             /* free_function */
+    &GlibcGetSizeEstimate,  /* get_size_estimate_function */
+    nullptr,                /* batch_malloc_function */
+    nullptr,                /* batch_free_function */
+    &GlibcFreeDefiniteSize, /* free_definite_size_function */
+    nullptr,                /* next */
 };
@@ -64,6 +64,13 @@ void RealFree(const AllocatorDispatch*, void* address, void* context) {
   __real_free(address);
 }
 
+void RealFreeDefiniteSize(const AllocatorDispatch*,
+                          void* address,
+                          size_t size,
+                          void* context) {
+  __real_free(address);
+}
+
 #if defined(OS_ANDROID) && __ANDROID_API__ < 17
 size_t DummyMallocUsableSize(const void*) { return 0; }
 #endif
@@ -100,14 +107,14 @@ size_t RealSizeEstimate(const AllocatorDispatch*,
 }  // namespace
 
 const AllocatorDispatch AllocatorDispatch::default_dispatch = {
-    &RealMalloc,       /* alloc_function */
-    &RealCalloc,       /* alloc_zero_initialized_function */
-    &RealMemalign,     /* alloc_aligned_function */
-    &RealRealloc,      /* realloc_function */
-    &RealFree,         /* free_function */
-    &RealSizeEstimate, /* get_size_estimate_function */
-    nullptr,           /* batch_malloc_function */
-    nullptr,           /* batch_free_function */
-    nullptr,           /* free_definite_size_function */
-    nullptr,           /* next */
+    &RealMalloc,           /* alloc_function */
+    &RealCalloc,           /* alloc_zero_initialized_function */
+    &RealMemalign,         /* alloc_aligned_function */
+    &RealRealloc,          /* realloc_function */
+    &RealFree,             /* free_function */
+    &RealSizeEstimate,     /* get_size_estimate_function */
+    nullptr,               /* batch_malloc_function */
+    nullptr,               /* batch_free_function */
+    &RealFreeDefiniteSize, /* free_definite_size_function */
+    nullptr,               /* next */
 };
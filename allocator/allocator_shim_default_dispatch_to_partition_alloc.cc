@@ -0,0 +1,172 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/allocator_shim.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/allocator/partition_allocator/partition_alloc.h"
+#include "base/bits.h"
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/no_destructor.h"
+#include "base/numerics/checked_math.h"
+
+// This translation unit defines a default dispatch for the allocator shim which
+// routes allocations to a generic PartitionAlloc partition instead of to libc.
+// PartitionAlloc packs allocations of similar sizes together in slot spans,
+// which fragments large, long-lived heaps much less than glibc does.
+//
+// The partition doesn't use a thread cache, as PartitionThreadCache allocates
+// its caches with operator new, which would re-enter the shim.
+
+// In DCHECK builds, PartitionAlloc puts a cookie before each allocation, so
+// allocations are only aligned on the cookie size.
+#if DCHECK_IS_ON()
+#error "PartitionAlloc can't serve malloc() with DCHECKs on."
+#endif
+
+namespace {
+
+using base::allocator::AllocatorDispatch;
+
+// The alignment malloc() guarantees, i.e. alignof(max_align_t). PartitionAlloc
+// slot sizes are multiples of kGenericSmallestBucket, so requests are rounded
+// up to a multiple of this to land in slots which are aligned on it.
+constexpr size_t kMallocAlignment = 16;
+static_assert(kMallocAlignment % base::kGenericSmallestBucket == 0,
+              "malloc() sizes must map to whole buckets");
+
+// The largest alignment PAMemalign() can provide. See there.
+constexpr size_t kMaxAlignment = base::kSystemPageSize;
+
+// Allocations made through the shim are already reported to heap profilers by
+// the shim, so they must not call PartitionAllocHooks too.
+constexpr int kMallocFlags =
+    base::PartitionAllocReturnNull | base::PartitionAllocNoHooks;
+
+constexpr char kTypeName[] = "malloc";
+
+class MallocPartition {
+ public:
+  MallocPartition() { allocator_.init(); }
+
+  base::PartitionRootGeneric* root() { return allocator_.root(); }
+
+ private:
+  base::PartitionAllocatorGeneric allocator_;
+
+  DISALLOW_COPY_AND_ASSIGN(MallocPartition);
+};
+
+// Lazily created, as malloc() is called before static initializers run, and
+// never deleted, as it is called after static destructors run.
+ALWAYS_INLINE base::PartitionRootGeneric* Partition() {
+  static base::NoDestructor<MallocPartition> partition;
+  return partition->root();
+}
+
+// Rounds |size| up to a multiple of kMallocAlignment. Sizes too large for
+// PartitionAlloc are returned as is, so that it fails to allocate them.
+ALWAYS_INLINE size_t RoundUpMallocSize(size_t size) {
+  if (UNLIKELY(size > base::kGenericMaxDirectMapped))
+    return size;
+  return size ? base::bits::Align(size, kMallocAlignment) : kMallocAlignment;
+}
+
+void* PAMalloc(const AllocatorDispatch*, size_t size, void* context) {
+  return base::PartitionAllocGenericFlags(
+      Partition(), kMallocFlags, RoundUpMallocSize(size), kTypeName);
+}
+
+void* PACalloc(const AllocatorDispatch*, size_t n, size_t size, void* context) {
+  size_t total_size;
+  if (!base::CheckMul(n, size).AssignIfValid(&total_size))
+    return nullptr;
+  void* ptr = base::PartitionAllocGenericFlags(
+      Partition(), kMallocFlags, RoundUpMallocSize(total_size), kTypeName);
+  if (ptr)
+    memset(ptr, 0, total_size);
+  return ptr;
+}
+
+void* PAMemalign(const AllocatorDispatch*,
+                 size_t alignment,
+                 size_t size,
+                 void* context) {
+  DCHECK_EQ(0u, alignment & (alignment - 1));
+  if (alignment <= kMallocAlignment) {
+    return base::PartitionAllocGenericFlags(
+        Partition(), kMallocFlags, RoundUpMallocSize(size), kTypeName);
+  }
+  if (alignment > kMaxAlignment)
+    return nullptr;
+
+  // PartitionAlloc doesn't support aligned allocations, but slot spans start on
+  // a partition page boundary and direct mappings on a system page boundary,
+  // so slots whose size is a power of two are aligned on their size, up to
+  // kMaxAlignment. Hence allocate a power of two of at least |alignment|
+  // bytes. This isn't needed for sizes which are direct mapped anyway.
+  size_t aligned_size = std::max(size, alignment);
+  if (aligned_size <= base::kGenericMaxBucketed) {
+    aligned_size = size_t{1}
+                   << (base::kBitsPerSizeT -
+                       base::bits::CountLeadingZeroBitsSizeT(aligned_size - 1));
+  }
+  void* ptr = base::PartitionAllocGenericFlags(
+      Partition(), kMallocFlags, RoundUpMallocSize(aligned_size), kTypeName);
+  DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(ptr) & (alignment - 1));
+  return ptr;
+}
+
+void* PARealloc(const AllocatorDispatch*,
+                void* address,
+                size_t size,
+                void* context) {
+  // Reallocations which stay in the same bucket, and most resizes of direct
+  // mappings, are done in place. realloc(address, 0) frees |address|.
+  return Partition()->ReallocFlags(kMallocFlags, address,
+                                   size ? RoundUpMallocSize(size) : 0,
+                                   kTypeName);
+}
+
+void PAFree(const AllocatorDispatch*, void* address, void* context) {
+  Partition()->FreeNoHooks(address);
+}
+
+// PartitionAlloc finds the slot span of |address| by masking it, and needs its
+// metadata to free the slot, so |size| doesn't save any work.
+void PAFreeDefiniteSize(const AllocatorDispatch*,
+                        void* address,
+                        size_t size,
+                        void* context) {
+  Partition()->FreeNoHooks(address);
+}
+
+size_t PAGetSizeEstimate(const AllocatorDispatch*,
+                         void* address,
+                         void* context) {
+  // malloc_usable_size(nullptr) is 0.
+  if (!address)
+    return 0;
+  return base::PartitionAllocGetSize(address);
+}
+
+}  // namespace
+
+const AllocatorDispatch AllocatorDispatch::default_dispatch = {
+    &PAMalloc,           /* alloc_function */
+    &PACalloc,           /* alloc_zero_initialized_function */
+    &PAMemalign,         /* alloc_aligned_function */
+    &PARealloc,          /* realloc_function */
+    &PAFree,             /* free_function */
+    &PAGetSizeEstimate,  /* get_size_estimate_function */
+    nullptr,             /* batch_malloc_function */
+    nullptr,             /* batch_free_function */
+    &PAFreeDefiniteSize, /* free_definite_size_function */
+    nullptr,             /* next */
+};
@@ -37,6 +37,13 @@ void TCFree(const AllocatorDispatch*, void* address, void* context) {
   tc_free(address);
 }
 
+void TCFreeDefiniteSize(const AllocatorDispatch*,
+                        void* address,
+                        size_t size,
+                        void* context) {
+  tc_free(address);
+}
+
 size_t TCGetSizeEstimate(const AllocatorDispatch*,
                          void* address,
                          void* context) {
@@ -46,16 +53,16 @@ size_t TCGetSizeEstimate(const AllocatorDispatch*,
 }  // namespace
 
 const AllocatorDispatch AllocatorDispatch::default_dispatch = {
-    &TCMalloc,          /* alloc_function */
-    &TCCalloc,          /* alloc_zero_initialized_function */
-    &TCMemalign,        /* alloc_aligned_function */
-    &TCRealloc,         /* realloc_function */
-    &TCFree,            /* free_function */
-    &TCGetSizeEstimate, /* get_size_estimate_function */
-    nullptr,            /* batch_malloc_function */
-    nullptr,            /* batch_free_function */
-    nullptr,            /* free_definite_size_function */
-    nullptr,            /* next */
+    &TCMalloc,           /* alloc_function */
+    &TCCalloc,           /* alloc_zero_initialized_function */
+    &TCMemalign,         /* alloc_aligned_function */
+    &TCRealloc,          /* realloc_function */
+    &TCFree,             /* free_function */
+    &TCGetSizeEstimate,  /* get_size_estimate_function */
+    nullptr,             /* batch_malloc_function */
+    nullptr,             /* batch_free_function */
+    &TCFreeDefiniteSize, /* free_definite_size_function */
+    nullptr,             /* next */
 };
 
 // In the case of tcmalloc we have also to route the diagnostic symbols,
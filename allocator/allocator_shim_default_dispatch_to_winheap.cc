@@ -54,6 +54,13 @@ void DefaultWinHeapFreeImpl(const AllocatorDispatch*,
   base::allocator::WinHeapFree(address);
 }
 
+void DefaultWinHeapFreeDefiniteSizeImpl(const AllocatorDispatch*,
+                                        void* address,
+                                        size_t size,
+                                        void* context) {
+  base::allocator::WinHeapFree(address);
+}
+
 size_t DefaultWinHeapGetSizeEstimateImpl(const AllocatorDispatch*,
                                          void* address,
                                          void* context) {
@@ -74,6 +81,6 @@ constexpr AllocatorDispatch AllocatorDispatch::default_dispatch = {
     &DefaultWinHeapGetSizeEstimateImpl,
     nullptr, /* batch_malloc_function */
     nullptr, /* batch_free_function */
-    nullptr, /* free_definite_size_function */
+    &DefaultWinHeapFreeDefiniteSizeImpl,
     nullptr, /* next */
 };
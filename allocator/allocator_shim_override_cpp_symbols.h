@@ -49,3 +49,75 @@ SHIM_ALWAYS_EXPORT void operator delete[](void* p,
                                           const std::nothrow_t&) __THROW {
   ShimCppDelete(p);
 }
+
+// Sized deallocation lets allocators which can use the size of an allocation
+// skip looking it up.
+
+SHIM_ALWAYS_EXPORT void operator delete(void* p, size_t size) __THROW {
+  ShimCppDeleteSized(p, size);
+}
+
+SHIM_ALWAYS_EXPORT void operator delete[](void* p, size_t size) __THROW {
+  ShimCppDeleteSized(p, size);
+}
+
+#if defined(__cpp_aligned_new)
+// Over-aligned allocations, e.g. new of a type declared with alignas(64), go
+// straight to the allocators' aligned allocation rather than to the C++
+// runtime's default implementation on top of posix_memalign().
+
+SHIM_ALWAYS_EXPORT void* operator new(size_t size, std::align_val_t alignment) {
+  return ShimCppAlignedNew(size, static_cast<size_t>(alignment));
+}
+
+SHIM_ALWAYS_EXPORT void* operator new(size_t size,
+                                      std::align_val_t alignment,
+                                      const std::nothrow_t&) __THROW {
+  return ShimCppAlignedNew(size, static_cast<size_t>(alignment));
+}
+
+SHIM_ALWAYS_EXPORT void* operator new[](size_t size,
+                                        std::align_val_t alignment) {
+  return ShimCppAlignedNew(size, static_cast<size_t>(alignment));
+}
+
+SHIM_ALWAYS_EXPORT void* operator new[](size_t size,
+                                        std::align_val_t alignment,
+                                        const std::nothrow_t&) __THROW {
+  return ShimCppAlignedNew(size, static_cast<size_t>(alignment));
+}
+
+SHIM_ALWAYS_EXPORT void operator delete(void* p,
+                                        std::align_val_t) __THROW {
+  ShimCppDelete(p);
+}
+
+SHIM_ALWAYS_EXPORT void operator delete(void* p,
+                                        size_t size,
+                                        std::align_val_t) __THROW {
+  ShimCppDeleteSized(p, size);
+}
+
+SHIM_ALWAYS_EXPORT void operator delete(void* p,
+                                        std::align_val_t,
+                                        const std::nothrow_t&) __THROW {
+  ShimCppDelete(p);
+}
+
+SHIM_ALWAYS_EXPORT void operator delete[](void* p,
+                                          std::align_val_t) __THROW {
+  ShimCppDelete(p);
+}
+
+SHIM_ALWAYS_EXPORT void operator delete[](void* p,
+                                          size_t size,
+                                          std::align_val_t) __THROW {
+  ShimCppDeleteSized(p, size);
+}
+
+SHIM_ALWAYS_EXPORT void operator delete[](void* p,
+                                          std::align_val_t,
+                                          const std::nothrow_t&) __THROW {
+  ShimCppDelete(p);
+}
+#endif  // defined(__cpp_aligned_new)
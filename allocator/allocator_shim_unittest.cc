@@ -425,6 +425,32 @@ TEST_F(AllocatorShimTest, InterceptCppSymbols) {
   RemoveAllocatorDispatchForTesting(&g_mock_dispatch);
 }
 
+// Windows and macOS intercept the C++ symbols at the malloc level, where the
+// size and the alignment of the allocation are lost.
+#if !defined(OS_WIN) && !defined(OS_MACOSX)
+TEST_F(AllocatorShimTest, InterceptSizedAndAlignedCppSymbols) {
+  InsertAllocatorDispatch(&g_mock_dispatch);
+
+  void* ptr = ::operator new(sizeof(TestStruct1));
+  ::operator delete(ptr, sizeof(TestStruct1));
+  ASSERT_GE(free_definite_sizes_intercepted_by_size[sizeof(TestStruct1)], 1u);
+  ASSERT_GE(frees_intercepted_by_addr[Hash(ptr)], 1u);
+
+#if defined(__cpp_aligned_new)
+  constexpr size_t kAlignment = 64;
+  ptr = ::operator new(sizeof(TestStruct2), std::align_val_t(kAlignment));
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(ptr) % kAlignment);
+  ASSERT_GE(aligned_allocs_intercepted_by_alignment[kAlignment], 1u);
+  ASSERT_GE(aligned_allocs_intercepted_by_size[sizeof(TestStruct2)], 1u);
+
+  ::operator delete(ptr, sizeof(TestStruct2), std::align_val_t(kAlignment));
+  ASSERT_GE(free_definite_sizes_intercepted_by_size[sizeof(TestStruct2)], 1u);
+#endif  // defined(__cpp_aligned_new)
+
+  RemoveAllocatorDispatchForTesting(&g_mock_dispatch);
+}
+#endif  // !defined(OS_WIN) && !defined(OS_MACOSX)
+
 // This test exercises the case of concurrent OOM failure, which would end up
 // invoking std::new_handler concurrently. This is to cover the CallNewHandler()
 // paths of allocator_shim.cc and smoke-test its thread safey.
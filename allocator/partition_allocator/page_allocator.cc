@@ -223,6 +223,12 @@ void DiscardSystemPages(void* address, size_t length) {
   DiscardSystemPagesInternal(address, length);
 }
 
+bool AdviseHugePages(void* address, size_t length) {
+  DCHECK(!(reinterpret_cast<uintptr_t>(address) & kSystemPageOffsetMask));
+  DCHECK_EQ(0UL, length & kSystemPageOffsetMask);
+  return AdviseHugePagesInternal(address, length);
+}
+
 bool ReserveAddressSpace(size_t size) {
   // To avoid deadlock, call only SystemAllocPages.
   subtle::SpinLock::Guard guard(s_reserveLock.Get());
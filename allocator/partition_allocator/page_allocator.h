@@ -133,6 +133,20 @@ BASE_EXPORT WARN_UNUSED_RESULT bool RecommitSystemPages(
 // based on the original page content, or a page of zeroes.
 BASE_EXPORT void DiscardSystemPages(void* address, size_t length);
 
+// Hint that the system pages starting at |address| and continuing for |length|
+// bytes should be backed by huge pages, to reduce TLB misses. Only the aligned
+// huge pages which lie entirely in the range, and whose system pages all have
+// the same permissions, can be. |length| must be a multiple of
+// |kSystemPageSize|.
+//
+// Huge pages remain compatible with the other functions: discarding, or
+// changing the permissions of, part of a huge page splits it back into system
+// pages. Note that touching a huge page commits all of it.
+//
+// Returns false if the system doesn't support huge pages, in which case the
+// pages are left untouched.
+BASE_EXPORT bool AdviseHugePages(void* address, size_t length);
+
 ALWAYS_INLINE uintptr_t RoundUpToSystemPage(uintptr_t address) {
   return (address + kSystemPageOffsetMask) & kSystemPageBaseMask;
 }
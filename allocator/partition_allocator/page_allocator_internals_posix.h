@@ -178,6 +178,18 @@ void DiscardSystemPagesInternal(void* address, size_t length) {
 #endif
 }
 
+bool AdviseHugePagesInternal(void* address, size_t length) {
+#if (defined(OS_LINUX) || defined(OS_ANDROID)) && defined(MADV_HUGEPAGE)
+  // Transparent huge pages, which fail when the kernel is built without them.
+  // MAP_HUGETLB isn't used: its pages come from a pool which must be reserved
+  // by the administrator, and they can't be discarded or protected one system
+  // page at a time.
+  return !madvise(address, length, MADV_HUGEPAGE);
+#else
+  return false;
+#endif
+}
+
 }  // namespace base
 
 #endif  // BASE_ALLOCATOR_PARTITION_ALLOCATOR_PAGE_ALLOCATOR_INTERNALS_POSIX_H_
@@ -116,6 +116,12 @@ void DiscardSystemPagesInternal(void* address, size_t length) {
   }
 }
 
+bool AdviseHugePagesInternal(void* address, size_t length) {
+  // Large pages need the SeLockMemoryPrivilege, and must be allocated as such
+  // with MEM_LARGE_PAGES.
+  return false;
+}
+
 }  // namespace base
 
 #endif  // BASE_ALLOCATOR_PARTITION_ALLOCATOR_PAGE_ALLOCATOR_INTERNALS_WIN_H_
@@ -102,6 +102,28 @@ TEST(PageAllocatorTest, AllocAndFreePages) {
   FreePages(buffer, kPageAllocationGranularity);
 }
 
+// Test that huge pages, if supported, can be discarded one system page at a
+// time.
+TEST(PageAllocatorTest, DiscardHugePages) {
+  const size_t size = 2 * 1024 * 1024;
+  char* buffer = reinterpret_cast<char*>(
+      AllocPages(nullptr, size, size, PageReadWrite, PageTag::kChromium, true));
+  ASSERT_TRUE(buffer);
+#if defined(OS_WIN)
+  EXPECT_FALSE(AdviseHugePages(buffer, size));
+#else
+  AdviseHugePages(buffer, size);
+#endif
+  memset(buffer, 42, size);
+  DiscardSystemPages(buffer + kSystemPageSize, kSystemPageSize);
+  EXPECT_EQ(42, buffer[0]);
+  EXPECT_EQ(42, buffer[2 * kSystemPageSize]);
+  EXPECT_EQ(42, buffer[size - 1]);
+  buffer[kSystemPageSize] = 1;
+  EXPECT_EQ(1, buffer[kSystemPageSize]);
+  FreePages(buffer, size);
+}
+
 // Test permission setting on POSIX, where we can set a trap handler.
 #if defined(OS_POSIX) && !defined(OS_FUCHSIA)
 
@@ -5,6 +5,8 @@
 #include "base/allocator/partition_allocator/partition_alloc.h"
 
 #include <string.h>
+
+#include <limits>
 #include <type_traits>
 
 #include "base/allocator/partition_allocator/partition_direct_map_extent.h"
@@ -54,7 +56,10 @@ internal::PartitionRootBase::~PartitionRootBase() = default;
 PartitionRoot::PartitionRoot() = default;
 PartitionRoot::~PartitionRoot() = default;
 PartitionRootGeneric::PartitionRootGeneric() = default;
-PartitionRootGeneric::~PartitionRootGeneric() = default;
+PartitionRootGeneric::~PartitionRootGeneric() {
+  if (with_thread_cache)
+    internal::PartitionThreadCache::DisableForRoot(this);
+}
 PartitionAllocatorGeneric::PartitionAllocatorGeneric() = default;
 PartitionAllocatorGeneric::~PartitionAllocatorGeneric() = default;
 
@@ -191,6 +196,20 @@ void PartitionRootGeneric::Init() {
   *bucketPtr = internal::PartitionBucket::get_sentinel_bucket();
 }
 
+void PartitionRootGeneric::EnableThreadCache() {
+  DCHECK(this->initialized);
+  DCHECK(!this->with_thread_cache);
+  internal::PartitionThreadCache::EnableForRoot(this);
+  this->with_thread_cache = true;
+}
+
+void PartitionRootGeneric::EnableLifetimeSampling() {
+  DCHECK(this->initialized);
+  DCHECK(!this->lifetime_sampler);
+  this->lifetime_sampler =
+      std::make_unique<internal::PartitionLifetimeSampler>();
+}
+
 bool PartitionReallocDirectMappedInPlace(PartitionRootGeneric* root,
                                          internal::PartitionPage* page,
                                          size_t raw_size) {
@@ -260,18 +279,34 @@ bool PartitionReallocDirectMappedInPlace(PartitionRootGeneric* root,
 void* PartitionRootGeneric::Realloc(void* ptr,
                                     size_t new_size,
                                     const char* type_name) {
+  return ReallocFlags(0, ptr, new_size, type_name);
+}
+
+void* PartitionRootGeneric::ReallocFlags(int flags,
+                                         void* ptr,
+                                         size_t new_size,
+                                         const char* type_name) {
 #if defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
-  return realloc(ptr, new_size);
+  void* result = realloc(ptr, new_size);
+  CHECK(result || !new_size || flags & PartitionAllocReturnNull);
+  return result;
 #else
+  const bool hooks_enabled = !(flags & PartitionAllocNoHooks);
   if (UNLIKELY(!ptr))
-    return this->Alloc(new_size, type_name);
+    return PartitionAllocGenericFlags(this, flags, new_size, type_name);
   if (UNLIKELY(!new_size)) {
-    this->Free(ptr);
+    if (hooks_enabled)
+      this->Free(ptr);
+    else
+      this->FreeNoHooks(ptr);
     return nullptr;
   }
 
-  if (new_size > kGenericMaxDirectMapped)
+  if (new_size > kGenericMaxDirectMapped) {
+    if (flags & PartitionAllocReturnNull)
+      return nullptr;
     internal::PartitionExcessiveAllocationSize();
+  }
 
   internal::PartitionPage* page = internal::PartitionPage::FromPointer(
       internal::PartitionCookieFreePointerAdjust(ptr));
@@ -283,7 +318,10 @@ void* PartitionRootGeneric::Realloc(void* ptr,
     // accessibility of memory pages and, if reducing the size, decommitting
     // them.
     if (PartitionReallocDirectMappedInPlace(this, page, new_size)) {
-      PartitionAllocHooks::ReallocHookIfEnabled(ptr, ptr, new_size, type_name);
+      if (hooks_enabled) {
+        PartitionAllocHooks::ReallocHookIfEnabled(ptr, ptr, new_size,
+                                                  type_name);
+      }
       return ptr;
     }
   }
@@ -309,13 +347,21 @@ void* PartitionRootGeneric::Realloc(void* ptr,
   }
 
   // This realloc cannot be resized in-place. Sadness.
-  void* ret = this->Alloc(new_size, type_name);
+  void* ret = PartitionAllocGenericFlags(this, flags, new_size, type_name);
+  if (!ret) {
+    DCHECK(flags & PartitionAllocReturnNull);
+    return nullptr;
+  }
+
   size_t copy_size = actual_old_size;
   if (new_size < copy_size)
     copy_size = new_size;
 
   memcpy(ret, ptr, copy_size);
-  this->Free(ptr);
+  if (hooks_enabled)
+    this->Free(ptr);
+  else
+    this->FreeNoHooks(ptr);
   return ret;
 #endif
 }
@@ -460,17 +506,6 @@ static size_t PartitionPurgePage(internal::PartitionPage* page, bool discard) {
   return discardable_bytes;
 }
 
-static void PartitionPurgeBucket(internal::PartitionBucket* bucket) {
-  if (bucket->active_pages_head !=
-      internal::PartitionPage::get_sentinel_page()) {
-    for (internal::PartitionPage* page = bucket->active_pages_head; page;
-         page = page->next_page) {
-      DCHECK(page != internal::PartitionPage::get_sentinel_page());
-      PartitionPurgePage(page, true);
-    }
-  }
-}
-
 void PartitionRoot::PurgeMemory(int flags) {
   if (flags & PartitionPurgeDecommitEmptyPages)
     DecommitEmptyPages();
@@ -481,16 +516,70 @@ void PartitionRoot::PurgeMemory(int flags) {
 }
 
 void PartitionRootGeneric::PurgeMemory(int flags) {
+  PartitionPurgeCursor cursor;
+  bool done = PurgeMemoryIncrementally(flags, &cursor,
+                                       std::numeric_limits<size_t>::max());
+  DCHECK(done);
+}
+
+bool PartitionRootGeneric::PurgeMemoryIncrementally(
+    int flags,
+    PartitionPurgeCursor* cursor,
+    size_t max_slot_spans) {
+  DCHECK_GT(max_slot_spans, 0u);
+  bool is_first_step = !cursor->bucket_index && !cursor->num_slot_spans;
+  // Return the slots held by the thread caches to their pages first, so that
+  // the pages which become empty can be decommitted below. The caches of other
+  // threads are only flushed on their next use.
+  if (is_first_step && this->with_thread_cache)
+    internal::PartitionThreadCache::PurgeAll(this);
   subtle::SpinLock::Guard guard(this->lock);
-  if (flags & PartitionPurgeDecommitEmptyPages)
+  if (is_first_step && (flags & PartitionPurgeDecommitEmptyPages))
     DecommitEmptyPages();
   if (flags & PartitionPurgeDiscardUnusedSystemPages) {
-    for (size_t i = 0; i < kGenericNumBuckets; ++i) {
-      internal::PartitionBucket* bucket = &this->buckets[i];
-      if (bucket->slot_size >= kSystemPageSize)
-        PartitionPurgeBucket(bucket);
+    size_t num_purged = 0;
+    for (; cursor->bucket_index < kGenericNumBuckets; ++cursor->bucket_index) {
+      internal::PartitionBucket* bucket = &this->buckets[cursor->bucket_index];
+      if (bucket->slot_size < kSystemPageSize ||
+          bucket->active_pages_head ==
+              internal::PartitionPage::get_sentinel_page()) {
+        continue;
+      }
+      // The active list may have changed since the previous step, in which
+      // case some slot spans are skipped or purged twice until the next purge.
+      internal::PartitionPage* page = bucket->active_pages_head;
+      for (size_t i = 0; page && i < cursor->num_slot_spans; ++i)
+        page = page->next_page;
+      for (; page; page = page->next_page) {
+        DCHECK(page != internal::PartitionPage::get_sentinel_page());
+        if (num_purged == max_slot_spans)
+          return false;
+        PartitionPurgePage(page, true);
+        ++num_purged;
+        ++cursor->num_slot_spans;
+      }
+      cursor->num_slot_spans = 0;
     }
   }
+  *cursor = PartitionPurgeCursor();
+  return true;
+}
+
+uint64_t PartitionRootGeneric::GetNumAllocations() {
+  uint64_t total = 0;
+  // The thread caches are locked before |lock|, so collect their counts first.
+  if (this->with_thread_cache) {
+    uint64_t cached_num_allocations[kThreadCacheNumBuckets] = {};
+    uint64_t cached_num_frees[kThreadCacheNumBuckets] = {};
+    internal::PartitionThreadCache::AddCounts(this, cached_num_allocations,
+                                              cached_num_frees);
+    for (uint64_t count : cached_num_allocations)
+      total += count;
+  }
+  subtle::SpinLock::Guard guard(this->lock);
+  for (uint64_t count : this->num_allocations)
+    total += count;
+  return total + this->num_direct_map_allocations;
 }
 
 static void PartitionDumpPageStats(PartitionBucketMemoryStats* stats_out,
@@ -574,6 +663,23 @@ static void PartitionDumpBucketStats(PartitionBucketMemoryStats* stats_out,
   }
 }
 
+static void PartitionDumpBucketCounts(PartitionBucketMemoryStats* stats_out,
+                                      const PartitionRootGeneric* root,
+                                      size_t bucket_index,
+                                      const uint64_t* cached_num_allocations,
+                                      const uint64_t* cached_num_frees) {
+  stats_out->num_allocations = root->num_allocations[bucket_index];
+  stats_out->num_frees = root->num_frees[bucket_index];
+  if (bucket_index < kThreadCacheNumBuckets) {
+    stats_out->num_allocations += cached_num_allocations[bucket_index];
+    stats_out->num_frees += cached_num_frees[bucket_index];
+  }
+  if (root->lifetime_sampler) {
+    root->lifetime_sampler->GetHistogram(bucket_index,
+                                         stats_out->lifetime_histogram);
+  }
+}
+
 void PartitionRootGeneric::DumpStats(const char* partition_name,
                                      bool is_light_dump,
                                      PartitionStatsDumper* dumper) {
@@ -594,7 +700,16 @@ void PartitionRootGeneric::DumpStats(const char* partition_name,
         std::unique_ptr<uint32_t[]>(new uint32_t[kMaxReportableDirectMaps]);
   }
 
-  PartitionBucketMemoryStats bucket_stats[kGenericNumBuckets];
+  // The thread caches are locked before |lock|, so collect their counts first.
+  uint64_t cached_num_allocations[kThreadCacheNumBuckets] = {};
+  uint64_t cached_num_frees[kThreadCacheNumBuckets] = {};
+  if (this->with_thread_cache) {
+    internal::PartitionThreadCache::AddCounts(this, cached_num_allocations,
+                                              cached_num_frees);
+  }
+
+  std::unique_ptr<PartitionBucketMemoryStats[]> bucket_stats(
+      new PartitionBucketMemoryStats[kGenericNumBuckets]);
   size_t num_direct_mapped_allocations = 0;
   {
     subtle::SpinLock::Guard guard(this->lock);
@@ -609,12 +724,18 @@ void PartitionRootGeneric::DumpStats(const char* partition_name,
       else
         PartitionDumpBucketStats(&bucket_stats[i], bucket);
       if (bucket_stats[i].is_valid) {
+        PartitionDumpBucketCounts(&bucket_stats[i], this, i,
+                                  cached_num_allocations, cached_num_frees);
         stats.total_resident_bytes += bucket_stats[i].resident_bytes;
         stats.total_active_bytes += bucket_stats[i].active_bytes;
         stats.total_decommittable_bytes += bucket_stats[i].decommittable_bytes;
         stats.total_discardable_bytes += bucket_stats[i].discardable_bytes;
+        stats.total_num_allocations += bucket_stats[i].num_allocations;
+        stats.total_num_frees += bucket_stats[i].num_frees;
       }
     }
+    stats.total_num_allocations += this->num_direct_map_allocations;
+    stats.total_num_frees += this->num_direct_map_frees;
 
     for (internal::PartitionDirectMapExtent *extent = this->direct_map_list;
          extent && num_direct_mapped_allocations < kMaxReportableDirectMaps;
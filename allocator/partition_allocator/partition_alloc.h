@@ -63,12 +63,16 @@
 #include <limits.h>
 #include <string.h>
 
+#include <memory>
+
 #include "base/allocator/partition_allocator/page_allocator.h"
 #include "base/allocator/partition_allocator/partition_alloc_constants.h"
 #include "base/allocator/partition_allocator/partition_bucket.h"
 #include "base/allocator/partition_allocator/partition_cookie.h"
+#include "base/allocator/partition_allocator/partition_lifetime_sampler.h"
 #include "base/allocator/partition_allocator/partition_page.h"
 #include "base/allocator/partition_allocator/partition_root_base.h"
+#include "base/allocator/partition_allocator/partition_thread_cache.h"
 #include "base/allocator/partition_allocator/spin_lock.h"
 #include "base/base_export.h"
 #include "base/bits.h"
@@ -96,6 +100,14 @@ enum PartitionPurgeFlags {
   PartitionPurgeDiscardUnusedSystemPages = 1 << 1,
 };
 
+// Where PartitionRootGeneric::PurgeMemoryIncrementally() stopped. A default
+// constructed cursor starts a new purge.
+struct PartitionPurgeCursor {
+  size_t bucket_index = 0;
+  // Number of slot spans of the active list of the bucket already purged.
+  size_t num_slot_spans = 0;
+};
+
 // Never instantiate a PartitionRoot directly, instead use PartitionAlloc.
 struct BASE_EXPORT PartitionRoot : public internal::PartitionRootBase {
   PartitionRoot();
@@ -140,22 +152,74 @@ struct BASE_EXPORT PartitionRootGeneric : public internal::PartitionRootBase {
       bucket_lookups[((kBitsPerSizeT + 1) * kGenericNumBucketsPerOrder) + 1] =
           {};
   internal::PartitionBucket buckets[kGenericNumBuckets] = {};
+  // True if the allocations of small sizes go through per-thread caches. See
+  // EnableThreadCache().
+  bool with_thread_cache = false;
+  // Number of allocations and frees of each bucket which didn't go through the
+  // thread caches, guarded by |lock|. The thread caches count their own.
+  uint64_t num_allocations[kGenericNumBuckets] = {};
+  uint64_t num_frees[kGenericNumBuckets] = {};
+  uint64_t num_direct_map_allocations = 0;
+  uint64_t num_direct_map_frees = 0;
+  // Set by EnableLifetimeSampling().
+  std::unique_ptr<internal::PartitionLifetimeSampler> lifetime_sampler;
 
   // Public API.
   void Init();
 
+  // Makes allocations and frees of small sizes use a cache of free slots owned
+  // by the calling thread, which avoids taking |lock| most of the time. Must be
+  // called after Init(), before the first allocation. Only one root can have
+  // thread caches enabled at a time.
+  void EnableThreadCache();
+
+  // Keeps histograms of the lifetimes of a sample of the allocations of each
+  // bucket, which are reported by DumpStats(). Must be called after Init(),
+  // before the first allocation.
+  void EnableLifetimeSampling();
+
   ALWAYS_INLINE void* Alloc(size_t size, const char* type_name);
   ALWAYS_INLINE void Free(void* ptr);
+  // Like Free(), but doesn't call PartitionAllocHooks. For allocations made
+  // with PartitionAllocNoHooks.
+  ALWAYS_INLINE void FreeNoHooks(void* ptr);
 
   NOINLINE void* Realloc(void* ptr, size_t new_size, const char* type_name);
+  // Like Realloc(), with PartitionAllocFlags. With PartitionAllocReturnNull,
+  // returns nullptr and leaves |ptr| untouched if |new_size| can't be
+  // allocated.
+  NOINLINE void* ReallocFlags(int flags,
+                              void* ptr,
+                              size_t new_size,
+                              const char* type_name);
 
   ALWAYS_INLINE size_t ActualSize(size_t size);
 
   void PurgeMemory(int flags);
 
+  // Like PurgeMemory(), but purges at most |max_slot_spans| slot spans with
+  // PartitionPurgeDiscardUnusedSystemPages before releasing the lock and
+  // returning false. Calling it again with the same |cursor| and |flags| goes
+  // on from there, until it returns true once the purge is complete. The
+  // thread caches and the empty pages are purged on the first step only.
+  bool PurgeMemoryIncrementally(int flags,
+                                PartitionPurgeCursor* cursor,
+                                size_t max_slot_spans);
+
+  // Returns the number of allocations made since Init(), including the ones
+  // served by the thread caches. Must not be called under |lock|.
+  uint64_t GetNumAllocations();
+
   void DumpStats(const char* partition_name,
                  bool is_light_dump,
                  PartitionStatsDumper* partition_stats_dumper);
+
+  // Update the counts of |bucket| after |ptr| was allocated from it, or after
+  // a slot was freed to it. Called under |lock| for the allocations and frees
+  // which don't go through the thread caches.
+  ALWAYS_INLINE void RecordAllocation(internal::PartitionBucket* bucket,
+                                      void* ptr);
+  ALWAYS_INLINE void RecordFree(internal::PartitionBucket* bucket);
 };
 
 // Struct used to retrieve total memory usage of a partition. Used by
@@ -167,6 +231,10 @@ struct PartitionMemoryStats {
   size_t total_active_bytes;     // Total active bytes in the partition.
   size_t total_decommittable_bytes;  // Total bytes that could be decommitted.
   size_t total_discardable_bytes;    // Total bytes that could be discarded.
+  uint64_t total_num_allocations;    // Total allocations since the partition
+                                     // was initialized.
+  uint64_t total_num_frees;          // Total frees since the partition was
+                                     // initialized.
 };
 
 // Struct used to retrieve memory statistics about a partition bucket. Used by
@@ -189,6 +257,16 @@ struct PartitionBucketMemoryStats {
                                  // but not decommitted.
   uint32_t num_decommitted_pages;  // Number of pages that are empty
                                    // and decommitted.
+  // The following are only collected for generic partitions, and not for
+  // direct mappings.
+  uint64_t num_allocations;  // Number of allocations since the partition was
+                             // initialized.
+  uint64_t num_frees;        // Number of frees since the partition was
+                             // initialized.
+  // Number of sampled allocations per lifetime, see
+  // kLifetimeHistogramNumBuckets. All zero unless
+  // PartitionRootGeneric::EnableLifetimeSampling() was called.
+  uint32_t lifetime_histogram[kLifetimeHistogramNumBuckets];
 };
 
 // Interface that is passed to PartitionDumpStats and
@@ -324,11 +402,20 @@ ALWAYS_INLINE void* PartitionAllocGenericFlags(PartitionRootGeneric* root,
   size = internal::PartitionCookieSizeAdjustAdd(size);
   internal::PartitionBucket* bucket = PartitionGenericSizeToBucket(root, size);
   void* ret = nullptr;
-  {
+  if (root->with_thread_cache &&
+      internal::PartitionThreadCache::CanCache(bucket)) {
+    ret = internal::PartitionThreadCache::Get(root)->Alloc(
+        bucket, bucket - root->buckets, flags, size);
+  } else {
     subtle::SpinLock::Guard guard(root->lock);
     ret = root->AllocFromBucket(bucket, flags, size);
+    if (LIKELY(ret))
+      root->RecordAllocation(bucket, ret);
+  }
+  if (!(flags & PartitionAllocNoHooks)) {
+    PartitionAllocHooks::AllocationHookIfEnabled(ret, requested_size,
+                                                 type_name);
   }
-  PartitionAllocHooks::AllocationHookIfEnabled(ret, requested_size, type_name);
   return ret;
 #endif
 }
@@ -339,6 +426,18 @@ ALWAYS_INLINE void* PartitionRootGeneric::Alloc(size_t size,
 }
 
 ALWAYS_INLINE void PartitionRootGeneric::Free(void* ptr) {
+#if defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
+  free(ptr);
+#else
+  if (UNLIKELY(!ptr))
+    return;
+
+  PartitionAllocHooks::FreeHookIfEnabled(ptr);
+  FreeNoHooks(ptr);
+#endif
+}
+
+ALWAYS_INLINE void PartitionRootGeneric::FreeNoHooks(void* ptr) {
 #if defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
   free(ptr);
 #else
@@ -347,18 +446,52 @@ ALWAYS_INLINE void PartitionRootGeneric::Free(void* ptr) {
   if (UNLIKELY(!ptr))
     return;
 
-  PartitionAllocHooks::FreeHookIfEnabled(ptr);
-  ptr = internal::PartitionCookieFreePointerAdjust(ptr);
-  internal::PartitionPage* page = internal::PartitionPage::FromPointer(ptr);
+  void* slot = internal::PartitionCookieFreePointerAdjust(ptr);
+  internal::PartitionPage* page = internal::PartitionPage::FromPointer(slot);
   // TODO(palmer): See if we can afford to make this a CHECK.
   DCHECK(IsValidPage(page));
+  internal::PartitionBucket* bucket = page->bucket;
+  if (UNLIKELY(this->lifetime_sampler) && !bucket->is_direct_mapped())
+    this->lifetime_sampler->OnFree(ptr, bucket - this->buckets);
+  if (this->with_thread_cache &&
+      internal::PartitionThreadCache::CanCache(bucket)) {
+    internal::PartitionThreadCache::Get(this)->Free(
+        bucket, bucket - this->buckets, slot);
+    return;
+  }
   {
     subtle::SpinLock::Guard guard(this->lock);
-    page->Free(ptr);
+    // Before the metadata of a direct mapping is unmapped.
+    RecordFree(bucket);
+    page->Free(slot);
   }
 #endif
 }
 
+ALWAYS_INLINE void PartitionRootGeneric::RecordAllocation(
+    internal::PartitionBucket* bucket,
+    void* ptr) {
+  // Direct mapped sizes get the sentinel bucket, which isn't in |buckets|.
+  if (UNLIKELY(bucket->is_direct_mapped())) {
+    ++this->num_direct_map_allocations;
+    return;
+  }
+  size_t bucket_index = bucket - this->buckets;
+  if (UNLIKELY(internal::PartitionLifetimeSampler::ShouldSample(
+          ++this->num_allocations[bucket_index])) &&
+      this->lifetime_sampler) {
+    this->lifetime_sampler->RecordAllocation(ptr);
+  }
+}
+
+ALWAYS_INLINE void PartitionRootGeneric::RecordFree(
+    internal::PartitionBucket* bucket) {
+  if (UNLIKELY(bucket->is_direct_mapped()))
+    ++this->num_direct_map_frees;
+  else
+    ++this->num_frees[bucket - this->buckets];
+}
+
 ALWAYS_INLINE size_t PartitionRootGeneric::ActualSize(size_t size) {
 #if defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
   return size;
@@ -139,6 +139,30 @@ static const size_t kGenericMaxDirectMapped =
     (1UL << 31) + kPageAllocationGranularity;  // 2 GB plus one more page.
 static const size_t kBitsPerSizeT = sizeof(void*) * CHAR_BIT;
 
+// The following kThreadCache* constants apply to the per-thread caches of
+// generic partitions (see PartitionThreadCache). Only the buckets of the
+// smallest orders are cached, i.e. slot sizes below 256 bytes.
+static const size_t kThreadCacheMaxBucketedOrder = 8;
+static const size_t kThreadCacheMaxSlotSize = 1
+                                              << kThreadCacheMaxBucketedOrder;
+static const size_t kThreadCacheNumBuckets =
+    (kThreadCacheMaxBucketedOrder - kGenericMinBucketedOrder + 1) *
+    kGenericNumBucketsPerOrder;
+// Number of slots moved at once between a thread cache and a bucket.
+static const size_t kThreadCacheBatchSize = 8;
+static const size_t kThreadCacheMaxSlotsPerBucket = 2 * kThreadCacheBatchSize;
+
+// The following kLifetime* constants apply to the lifetime sampling of generic
+// partitions (see PartitionLifetimeSampler). One in kLifetimeSamplingInterval
+// allocations of each bucket is sampled.
+static const size_t kLifetimeSamplingInterval = 1024;
+static const size_t kLifetimeSampleTableSizeBits = 10;
+static const size_t kLifetimeSampleTableSize = 1
+                                               << kLifetimeSampleTableSizeBits;
+// Lifetimes are counted per power of ten microseconds: below 10us, below
+// 100us, ..., below 10s, and 10s or more.
+static const size_t kLifetimeHistogramNumBuckets = 8;
+
 // Constant for the memory reclaim logic.
 static const size_t kMaxFreeableSpans = 16;
 
@@ -152,6 +176,9 @@ static const size_t kReasonableSizeOfUnusedPages = 1024 * 1024 * 1024;  // 1GB
 // Flags for PartitionAllocGenericFlags.
 enum PartitionAllocFlags {
   PartitionAllocReturnNull = 1 << 0,
+  // Skips PartitionAllocHooks, for partitions whose allocations are already
+  // reported by another layer, such as the allocator shim.
+  PartitionAllocNoHooks = 1 << 1,
 };
 
 }  // namespace base
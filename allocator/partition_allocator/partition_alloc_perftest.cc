@@ -0,0 +1,71 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/partition_allocator/partition_alloc.h"
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/test/perf_benchmark.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr int kIterations = 100000;
+
+// A size for each order of size classes, from the smallest to direct-mapped.
+constexpr size_t kSizes[] = {16, 64, 256, 1024, 4096, 32768, 1 << 20};
+
+constexpr char kTypeName[] = "PartitionAllocPerfTest";
+
+class PartitionAllocPerfTest : public testing::Test {
+ protected:
+  void SetUp() override { allocator_.init(); }
+
+  PartitionRootGeneric* root() { return allocator_.root(); }
+
+ private:
+  PartitionAllocatorGeneric allocator_;
+};
+
+}  // namespace
+
+// Frees each allocation right away: the slot is reused by the next one.
+TEST_F(PartitionAllocPerfTest, AllocFree) {
+  for (size_t size : kSizes) {
+    PerfBenchmark benchmark("partition_alloc",
+                            "alloc_free_" + NumberToString(size), kIterations);
+    benchmark.Run([&](int iterations) {
+      for (int i = 0; i < iterations; ++i)
+        root()->Free(root()->Alloc(size, kTypeName));
+    });
+  }
+}
+
+// Allocates a batch before freeing it, which fills and empties slot spans.
+TEST_F(PartitionAllocPerfTest, AllocBatchFreeBatch) {
+  for (size_t size : kSizes) {
+    // Keep the batches of large allocations to a few megabytes.
+    const int batch_size = size < 32768 ? 1000 : 10;
+    std::vector<void*> pointers(batch_size);
+    PerfBenchmark benchmark("partition_alloc",
+                            "alloc_batch_free_batch_" + NumberToString(size),
+                            kIterations);
+    benchmark.Run([&](int iterations) {
+      for (int i = 0; i < iterations; i += batch_size) {
+        for (void*& pointer : pointers)
+          pointer = root()->Alloc(size, kTypeName);
+        for (void* pointer : pointers)
+          root()->Free(pointer);
+      }
+    });
+  }
+}
+
+}  // namespace base
@@ -285,6 +285,8 @@ class MockPartitionStatsDumper : public PartitionStatsDumper {
     EXPECT_EQ(total_active_bytes, stats->total_active_bytes);
     EXPECT_EQ(total_decommittable_bytes, stats->total_decommittable_bytes);
     EXPECT_EQ(total_discardable_bytes, stats->total_discardable_bytes);
+    total_num_allocations = stats->total_num_allocations;
+    total_num_frees = stats->total_num_frees;
   }
 
   void PartitionsDumpBucketStats(
@@ -312,6 +314,9 @@ class MockPartitionStatsDumper : public PartitionStatsDumper {
     return nullptr;
   }
 
+  uint64_t total_num_allocations = 0;
+  uint64_t total_num_frees = 0;
+
  private:
   size_t total_resident_bytes;
   size_t total_active_bytes;
@@ -872,6 +877,100 @@ TEST_F(PartitionAllocTest, Realloc) {
   generic_allocator.root()->Free(ptr2);
 }
 
+// Test that a failed ReallocFlags() with PartitionAllocReturnNull leaves the
+// allocation alone.
+TEST_F(PartitionAllocTest, ReallocFlagsReturnNull) {
+  void* ptr = generic_allocator.root()->Alloc(kTestAllocSize, type_name);
+  memset(ptr, 'A', kTestAllocSize);
+
+  EXPECT_EQ(nullptr, generic_allocator.root()->ReallocFlags(
+                         PartitionAllocReturnNull, ptr,
+                         kGenericMaxDirectMapped + 1, type_name));
+  EXPECT_EQ('A', static_cast<char*>(ptr)[kTestAllocSize - 1]);
+
+  generic_allocator.root()->Free(ptr);
+}
+
+// Test that PartitionAllocNoHooks allocations don't call PartitionAllocHooks.
+TEST_F(PartitionAllocTest, NoHooks) {
+  static int num_hook_calls;
+  num_hook_calls = 0;
+  PartitionAllocHooks::SetAllocationHook(
+      [](void*, size_t, const char*) { ++num_hook_calls; });
+  PartitionAllocHooks::SetFreeHook([](void*) { ++num_hook_calls; });
+
+  void* ptr = PartitionAllocGenericFlags(
+      generic_allocator.root(), PartitionAllocNoHooks, kTestAllocSize,
+      type_name);
+  ptr = generic_allocator.root()->ReallocFlags(
+      PartitionAllocNoHooks, ptr, 2 * kSystemPageSize, type_name);
+  generic_allocator.root()->FreeNoHooks(ptr);
+  EXPECT_EQ(0, num_hook_calls);
+
+  ptr = generic_allocator.root()->Alloc(kTestAllocSize, type_name);
+  generic_allocator.root()->Free(ptr);
+  EXPECT_EQ(2, num_hook_calls);
+
+  PartitionAllocHooks::SetAllocationHook(nullptr);
+  PartitionAllocHooks::SetFreeHook(nullptr);
+}
+
+// Tests that the allocations and frees of generic partitions are counted.
+TEST_F(PartitionAllocTest, DumpAllocationCounts) {
+  PartitionRootGeneric* root = generic_allocator.root();
+  void* ptrs[3];
+  for (void*& ptr : ptrs)
+    ptr = root->Alloc(2048 - kExtraAllocSize, type_name);
+  root->Free(ptrs[0]);
+  ptrs[0] = root->Realloc(ptrs[1], 4096 - kExtraAllocSize, type_name);
+  void* direct_map = root->Alloc(kGenericMaxBucketed + 1, type_name);
+  root->Free(direct_map);
+
+  MockPartitionStatsDumper dumper;
+  root->DumpStats("mock_generic_allocator", false /* detailed dump */,
+                  &dumper);
+  const PartitionBucketMemoryStats* stats = dumper.GetBucketStats(2048);
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(3u, stats->num_allocations);
+  EXPECT_EQ(2u, stats->num_frees);
+  stats = dumper.GetBucketStats(4096);
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(1u, stats->num_allocations);
+  EXPECT_EQ(0u, stats->num_frees);
+  EXPECT_EQ(5u, dumper.total_num_allocations);
+  EXPECT_EQ(3u, dumper.total_num_frees);
+  for (uint32_t count : stats->lifetime_histogram)
+    EXPECT_EQ(0u, count);
+
+  root->Free(ptrs[0]);
+  root->Free(ptrs[2]);
+}
+
+// Tests that one in kLifetimeSamplingInterval allocations has its lifetime
+// recorded.
+TEST_F(PartitionAllocTest, LifetimeSampling) {
+  PartitionAllocatorGeneric sampled_allocator;
+  sampled_allocator.init();
+  PartitionRootGeneric* root = sampled_allocator.root();
+  root->EnableLifetimeSampling();
+
+  std::vector<void*> ptrs;
+  for (size_t i = 0; i < kLifetimeSamplingInterval; ++i)
+    ptrs.push_back(root->Alloc(2048 - kExtraAllocSize, type_name));
+  for (void* ptr : ptrs)
+    root->Free(ptr);
+
+  MockPartitionStatsDumper dumper;
+  root->DumpStats("mock_generic_allocator", false /* detailed dump */,
+                  &dumper);
+  const PartitionBucketMemoryStats* stats = dumper.GetBucketStats(2048);
+  ASSERT_TRUE(stats);
+  uint32_t num_samples = 0;
+  for (uint32_t count : stats->lifetime_histogram)
+    num_samples += count;
+  EXPECT_EQ(1u, num_samples);
+}
+
 // Tests the handing out of freelists for partial pages.
 TEST_F(PartitionAllocTest, PartialPageFreelists) {
   size_t big_size = allocator.root()->max_allocation - kExtraAllocSize;
@@ -2073,6 +2172,76 @@ TEST_F(PartitionAllocTest, PurgeDiscardable) {
   }
 }
 
+// Purges the slot spans of a bucket a few at a time.
+TEST_F(PartitionAllocTest, PurgeDiscardableIncrementally) {
+  const size_t size = kSystemPageSize - kExtraAllocSize;
+  const size_t slots_per_span = 4;
+  const size_t num_spans = 3;
+  void* ptrs[slots_per_span * num_spans];
+  for (void*& ptr : ptrs)
+    ptr = generic_allocator.root()->Alloc(size, type_name);
+  // Frees the last slot of each slot span, which puts them back on the active
+  // list with a discardable system page.
+  for (size_t i = 0; i < num_spans; ++i) {
+    PartitionPage* page = PartitionPage::FromPointer(
+        PartitionCookieFreePointerAdjust(ptrs[i * slots_per_span]));
+    EXPECT_EQ(0u, page->num_unprovisioned_slots);
+    generic_allocator.root()->Free(ptrs[(i + 1) * slots_per_span - 1]);
+  }
+
+  auto get_discardable_bytes = [this]() {
+    MockPartitionStatsDumper dumper;
+    generic_allocator.root()->DumpStats("mock_generic_allocator",
+                                        false /* detailed dump */, &dumper);
+    const PartitionBucketMemoryStats* stats =
+        dumper.GetBucketStats(kSystemPageSize);
+    EXPECT_TRUE(stats);
+    return stats ? stats->discardable_bytes : 0u;
+  };
+  EXPECT_EQ(num_spans * kSystemPageSize, get_discardable_bytes());
+
+  PartitionPurgeCursor cursor;
+  for (size_t i = 1; i < num_spans; ++i) {
+    EXPECT_FALSE(generic_allocator.root()->PurgeMemoryIncrementally(
+        PartitionPurgeDiscardUnusedSystemPages, &cursor, 1));
+    EXPECT_EQ((num_spans - i) * kSystemPageSize, get_discardable_bytes());
+  }
+  EXPECT_TRUE(generic_allocator.root()->PurgeMemoryIncrementally(
+      PartitionPurgeDiscardUnusedSystemPages, &cursor, 1));
+  EXPECT_EQ(0u, get_discardable_bytes());
+  EXPECT_EQ(0u, cursor.bucket_index);
+  EXPECT_EQ(0u, cursor.num_slot_spans);
+
+  for (size_t i = 0; i < arraysize(ptrs); ++i) {
+    if (i % slots_per_span != slots_per_span - 1)
+      generic_allocator.root()->Free(ptrs[i]);
+  }
+}
+
+// Tests that super pages backed by huge pages, where supported, work like the
+// others, including the purge of their unused system pages.
+TEST_F(PartitionAllocTest, HugePages) {
+  PartitionAllocatorGeneric allocator;
+  allocator.init();
+  allocator.root()->EnableHugePages();
+  const size_t size = kSystemPageSize - kExtraAllocSize;
+  void* ptrs[16];
+  for (void*& ptr : ptrs) {
+    ptr = allocator.root()->Alloc(size, type_name);
+    ASSERT_TRUE(ptr);
+    memset(ptr, 'A', size);
+  }
+  for (size_t i = 0; i < arraysize(ptrs); i += 2)
+    allocator.root()->Free(ptrs[i]);
+  allocator.root()->PurgeMemory(PartitionPurgeDecommitEmptyPages |
+                                PartitionPurgeDiscardUnusedSystemPages);
+  for (size_t i = 1; i < arraysize(ptrs); i += 2) {
+    EXPECT_EQ('A', static_cast<char*>(ptrs[i])[0]);
+    EXPECT_EQ('A', static_cast<char*>(ptrs[i])[size - 1]);
+    allocator.root()->Free(ptrs[i]);
+  }
+}
+
 TEST_F(PartitionAllocTest, ReallocMovesCookies) {
   // Resize so as to be sure to hit a "resize in place" case, and ensure that
   // use of the entire result is compatible with the debug mode's cookies, even
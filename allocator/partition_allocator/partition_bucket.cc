@@ -235,26 +235,33 @@ ALWAYS_INLINE void* PartitionBucket::AllocNewSlotSpan(
   char* ret = super_page + kPartitionPageSize;
   root->next_partition_page = ret + total_size;
   root->next_partition_page_end = root->next_super_page - kPartitionPageSize;
-  // Make the first partition page in the super page a guard page, but leave a
-  // hole in the middle.
-  // This is where we put page metadata and also a tiny amount of extent
-  // metadata.
-  CHECK(SetSystemPagesAccess(super_page, kSystemPageSize, PageInaccessible));
-  CHECK(SetSystemPagesAccess(super_page + (kSystemPageSize * 2),
-                             kPartitionPageSize - (kSystemPageSize * 2),
-                             PageInaccessible));
-  //  CHECK(SetSystemPagesAccess(super_page + (kSuperPageSize -
-  //  kPartitionPageSize),
-  //                             kPartitionPageSize, PageInaccessible));
-  // All remaining slotspans for the unallocated PartitionPages inside the
-  // SuperPage are conceptually decommitted. Correctly set the state here
-  // so they do not occupy resources.
-  //
-  // TODO(ajwong): Refactor Page Allocator API so the SuperPage comes in
-  // decommited initially.
-  CHECK(SetSystemPagesAccess(super_page + kPartitionPageSize + total_size,
-                             (kSuperPageSize - kPartitionPageSize - total_size),
-                             PageInaccessible));
+  // A huge page needs all of its system pages to have the same permissions,
+  // so a super page backed by one is left accessible. If huge pages aren't
+  // supported, the super page gets its guard pages as usual.
+  bool is_huge_page =
+      root->use_huge_pages && AdviseHugePages(super_page, kSuperPageSize);
+  if (!is_huge_page) {
+    // Make the first partition page in the super page a guard page, but leave
+    // a hole in the middle.
+    // This is where we put page metadata and also a tiny amount of extent
+    // metadata.
+    CHECK(SetSystemPagesAccess(super_page, kSystemPageSize, PageInaccessible));
+    CHECK(SetSystemPagesAccess(super_page + (kSystemPageSize * 2),
+                               kPartitionPageSize - (kSystemPageSize * 2),
+                               PageInaccessible));
+    //  CHECK(SetSystemPagesAccess(super_page + (kSuperPageSize -
+    //  kPartitionPageSize),
+    //                             kPartitionPageSize, PageInaccessible));
+    // All remaining slotspans for the unallocated PartitionPages inside the
+    // SuperPage are conceptually decommitted. Correctly set the state here
+    // so they do not occupy resources.
+    //
+    // TODO(ajwong): Refactor Page Allocator API so the SuperPage comes in
+    // decommited initially.
+    CHECK(SetSystemPagesAccess(
+        super_page + kPartitionPageSize + total_size,
+        (kSuperPageSize - kPartitionPageSize - total_size), PageInaccessible));
+  }
 
   // If we were after a specific address, but didn't get it, assume that
   // the system chose a lousy address. Here most OS'es have a default
@@ -0,0 +1,69 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/partition_allocator/partition_lifetime_sampler.h"
+
+#include "base/logging.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+int64_t NowInMicroseconds() {
+  return (TimeTicks::Now() - TimeTicks()).InMicroseconds();
+}
+
+}  // namespace
+
+PartitionLifetimeSampler::PartitionLifetimeSampler() = default;
+PartitionLifetimeSampler::~PartitionLifetimeSampler() = default;
+
+void PartitionLifetimeSampler::RecordAllocation(void* ptr) {
+  uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+  Sample* sample = &samples_[Hash(address)];
+  sample->allocation_time_us.store(NowInMicroseconds(),
+                                   std::memory_order_relaxed);
+  // Publishes the allocation time to RecordFree().
+  sample->address.store(address, std::memory_order_release);
+}
+
+void PartitionLifetimeSampler::RecordFree(Sample* sample,
+                                          uintptr_t address,
+                                          size_t bucket_index) {
+  DCHECK_LT(bucket_index, kGenericNumBuckets);
+  // Only the thread which clears the entry records the sample. The allocation
+  // time can still be the one of a sample which replaced this one in the
+  // meantime, which only makes this lifetime shorter.
+  if (!sample->address.compare_exchange_strong(address, 0,
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed)) {
+    return;
+  }
+  int64_t lifetime_us =
+      NowInMicroseconds() -
+      sample->allocation_time_us.load(std::memory_order_relaxed);
+  size_t histogram_bucket = 0;
+  int64_t limit_us = 10;
+  while (histogram_bucket < kLifetimeHistogramNumBuckets - 1 &&
+         lifetime_us >= limit_us) {
+    ++histogram_bucket;
+    limit_us *= 10;
+  }
+  histograms_[bucket_index][histogram_bucket].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+void PartitionLifetimeSampler::GetHistogram(size_t bucket_index,
+                                            uint32_t* histogram) const {
+  DCHECK_LT(bucket_index, kGenericNumBuckets);
+  for (size_t i = 0; i < kLifetimeHistogramNumBuckets; ++i) {
+    histogram[i] =
+        histograms_[bucket_index][i].load(std::memory_order_relaxed);
+  }
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,89 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_ALLOCATOR_PARTITION_ALLOCATOR_PARTITION_LIFETIME_SAMPLER_H_
+#define BASE_ALLOCATOR_PARTITION_ALLOCATOR_PARTITION_LIFETIME_SAMPLER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "base/allocator/partition_allocator/partition_alloc_constants.h"
+#include "base/base_export.h"
+#include "base/compiler_specific.h"
+#include "base/macros.h"
+
+namespace base {
+namespace internal {
+
+// Keeps a histogram of the lifetimes of one in kLifetimeSamplingInterval
+// allocations of each bucket of a PartitionRootGeneric.
+//
+// The sampled allocations are kept in a table indexed by a hash of their
+// address, so that checking whether a freed allocation was sampled costs a
+// single load. A sample is dropped when another one lands on the same entry
+// before it is freed, so long lifetimes are under-counted once many sampled
+// allocations are alive at the same time.
+//
+// All the methods are thread safe.
+class BASE_EXPORT PartitionLifetimeSampler {
+ public:
+  PartitionLifetimeSampler();
+  ~PartitionLifetimeSampler();
+
+  // Returns true if the allocation which brought the allocation count of its
+  // bucket to |num_allocations| must be passed to RecordAllocation().
+  static ALWAYS_INLINE bool ShouldSample(uint64_t num_allocations) {
+    return !(num_allocations & (kLifetimeSamplingInterval - 1));
+  }
+
+  // Starts tracking the lifetime of |ptr|, which was just allocated.
+  void RecordAllocation(void* ptr);
+
+  // Called when |ptr|, an allocation from the bucket at |bucket_index|, is
+  // freed. Records its lifetime if it was sampled.
+  ALWAYS_INLINE void OnFree(void* ptr, size_t bucket_index);
+
+  // Copies the lifetime histogram of the bucket at |bucket_index| to the
+  // kLifetimeHistogramNumBuckets entries of |histogram|.
+  void GetHistogram(size_t bucket_index, uint32_t* histogram) const;
+
+ private:
+  struct Sample {
+    std::atomic<uintptr_t> address;
+    std::atomic<int64_t> allocation_time_us;
+  };
+
+  static ALWAYS_INLINE size_t Hash(uintptr_t address) {
+    // Fibonacci hashing of the address, minus the bits which are the same for
+    // all the slots.
+    return static_cast<uint32_t>((address >> 3) * 2654435761u) >>
+           (32 - kLifetimeSampleTableSizeBits);
+  }
+
+  NOINLINE void RecordFree(Sample* sample,
+                           uintptr_t address,
+                           size_t bucket_index);
+
+  Sample samples_[kLifetimeSampleTableSize] = {};
+  std::atomic<uint32_t> histograms_[kGenericNumBuckets]
+                                   [kLifetimeHistogramNumBuckets] = {};
+
+  DISALLOW_COPY_AND_ASSIGN(PartitionLifetimeSampler);
+};
+
+ALWAYS_INLINE void PartitionLifetimeSampler::OnFree(void* ptr,
+                                                    size_t bucket_index) {
+  uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+  Sample* sample = &samples_[Hash(address)];
+  if (LIKELY(sample->address.load(std::memory_order_relaxed) != address))
+    return;
+  RecordFree(sample, address, bucket_index);
+}
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_ALLOCATOR_PARTITION_ALLOCATOR_PARTITION_LIFETIME_SAMPLER_H_
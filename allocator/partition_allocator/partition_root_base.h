@@ -51,9 +51,20 @@ struct BASE_EXPORT PartitionRootBase {
   PartitionPage* global_empty_page_ring[kMaxFreeableSpans] = {};
   int16_t global_empty_page_ring_index = 0;
   uintptr_t inverted_self = 0;
+  // Set by EnableHugePages().
+  bool use_huge_pages = false;
 
   // Public API
 
+  // Backs the super pages allocated from now on with huge pages, where the
+  // system supports it. Such super pages have no guard pages, since all their
+  // system pages must have the same permissions, and become fully resident
+  // as soon as one of their slot spans is used: this trades the security and
+  // the memory savings of the guard and decommitted pages for fewer TLB
+  // misses, which matters for large heaps. Discarding unused system pages
+  // splits the huge pages again.
+  void EnableHugePages() { use_huge_pages = true; }
+
   // Allocates out of the given bucket. Properly, this function should probably
   // be in PartitionBucket, but because the implementation needs to be inlined
   // for performance, and because it needs to inspect PartitionPage,
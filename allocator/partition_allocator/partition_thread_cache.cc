@@ -0,0 +1,213 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/partition_allocator/partition_thread_cache.h"
+
+#include "base/allocator/partition_allocator/partition_alloc.h"
+#include "base/allocator/partition_allocator/partition_page.h"
+#include "base/allocator/partition_allocator/spin_lock.h"
+#include "base/lazy_instance.h"
+#include "base/no_destructor.h"
+#include "base/threading/thread_local_storage.h"
+
+namespace base {
+namespace internal {
+
+static_assert(kThreadCacheNumBuckets <= kGenericNumBuckets,
+              "cached buckets must exist");
+static_assert(kThreadCacheMaxSlotSize ==
+                  kGenericSmallestBucket << (kThreadCacheNumBuckets /
+                                             kGenericNumBucketsPerOrder),
+              "cached buckets must have the slot sizes below the maximum");
+
+namespace {
+
+// Guards the list of caches and their |root_|. Acquired before the lock of
+// a root.
+LazyInstance<subtle::SpinLock>::Leaky g_registry_lock =
+    LAZY_INSTANCE_INITIALIZER;
+PartitionThreadCache* g_first_cache = nullptr;
+// The counts of the caches which were deleted on thread exit, guarded by the
+// registry lock.
+uint64_t g_exited_num_allocations[kThreadCacheNumBuckets];
+uint64_t g_exited_num_frees[kThreadCacheNumBuckets];
+#if DCHECK_IS_ON()
+PartitionRootGeneric* g_root = nullptr;
+#endif
+
+}  // namespace
+
+// static
+PartitionThreadCache* PartitionThreadCache::Get(PartitionRootGeneric* root) {
+  DCHECK(root->with_thread_cache);
+  static NoDestructor<ThreadLocalStorage::Slot> tls_cache(&OnThreadExit);
+  PartitionThreadCache* cache =
+      static_cast<PartitionThreadCache*>(tls_cache->Get());
+  if (LIKELY(cache && cache->root_.load(std::memory_order_relaxed) == root))
+    return cache;
+
+  subtle::SpinLock::Guard guard(g_registry_lock.Get());
+  // A cache of another root is left over from a destroyed root, since only one
+  // root uses thread caches at a time.
+  DCHECK(!cache || !cache->root_.load(std::memory_order_relaxed));
+  delete cache;
+  cache = new PartitionThreadCache(root);
+  tls_cache->Set(cache);
+  return cache;
+}
+
+// static
+void PartitionThreadCache::EnableForRoot(PartitionRootGeneric* root) {
+#if DCHECK_IS_ON()
+  subtle::SpinLock::Guard guard(g_registry_lock.Get());
+  DCHECK(!g_root) << "Only one root can use thread caches at a time";
+  g_root = root;
+#endif
+}
+
+// static
+void PartitionThreadCache::DisableForRoot(PartitionRootGeneric* root) {
+  subtle::SpinLock::Guard guard(g_registry_lock.Get());
+#if DCHECK_IS_ON()
+  DCHECK_EQ(root, g_root);
+  g_root = nullptr;
+#endif
+  for (PartitionThreadCache* cache = g_first_cache; cache;
+       cache = cache->next_) {
+    if (cache->root_.load(std::memory_order_relaxed) == root)
+      cache->root_.store(nullptr, std::memory_order_relaxed);
+  }
+  memset(g_exited_num_allocations, 0, sizeof(g_exited_num_allocations));
+  memset(g_exited_num_frees, 0, sizeof(g_exited_num_frees));
+}
+
+// static
+void PartitionThreadCache::PurgeAll(PartitionRootGeneric* root) {
+  {
+    subtle::SpinLock::Guard guard(g_registry_lock.Get());
+    for (PartitionThreadCache* cache = g_first_cache; cache;
+         cache = cache->next_) {
+      if (cache->root_.load(std::memory_order_relaxed) == root)
+        cache->should_purge_.store(true, std::memory_order_relaxed);
+    }
+  }
+  // The cache of the calling thread can be flushed right away.
+  Get(root)->Purge();
+}
+
+// static
+void PartitionThreadCache::AddCounts(PartitionRootGeneric* root,
+                                     uint64_t* num_allocations,
+                                     uint64_t* num_frees) {
+  subtle::SpinLock::Guard guard(g_registry_lock.Get());
+  for (size_t i = 0; i < kThreadCacheNumBuckets; ++i) {
+    num_allocations[i] += g_exited_num_allocations[i];
+    num_frees[i] += g_exited_num_frees[i];
+  }
+  for (PartitionThreadCache* cache = g_first_cache; cache;
+       cache = cache->next_) {
+    if (cache->root_.load(std::memory_order_relaxed) != root)
+      continue;
+    for (size_t i = 0; i < kThreadCacheNumBuckets; ++i) {
+      const Bucket& cached = cache->buckets_[i];
+      num_allocations[i] +=
+          cached.num_allocations.load(std::memory_order_relaxed);
+      num_frees[i] += cached.num_frees.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+PartitionThreadCache::PartitionThreadCache(PartitionRootGeneric* root)
+    : root_(root) {
+  // Called under the registry lock.
+  next_ = g_first_cache;
+  if (next_)
+    next_->prev_ = this;
+  g_first_cache = this;
+}
+
+PartitionThreadCache::~PartitionThreadCache() {
+  // Called under the registry lock.
+  if (prev_)
+    prev_->next_ = next_;
+  else
+    g_first_cache = next_;
+  if (next_)
+    next_->prev_ = prev_;
+}
+
+// static
+void PartitionThreadCache::OnThreadExit(void* cache) {
+  subtle::SpinLock::Guard guard(g_registry_lock.Get());
+  PartitionThreadCache* thread_cache =
+      static_cast<PartitionThreadCache*>(cache);
+  // Holding the registry lock keeps the root alive while the cache is flushed.
+  if (thread_cache->root_.load(std::memory_order_relaxed)) {
+    thread_cache->Purge();
+    for (size_t i = 0; i < kThreadCacheNumBuckets; ++i) {
+      const Bucket& cached = thread_cache->buckets_[i];
+      g_exited_num_allocations[i] +=
+          cached.num_allocations.load(std::memory_order_relaxed);
+      g_exited_num_frees[i] +=
+          cached.num_frees.load(std::memory_order_relaxed);
+    }
+  }
+  delete thread_cache;
+}
+
+bool PartitionThreadCache::Refill(PartitionBucket* bucket,
+                                  size_t bucket_index,
+                                  int flags,
+                                  size_t size) {
+  PartitionRootGeneric* root = root_.load(std::memory_order_relaxed);
+  Bucket* cached = &buckets_[bucket_index];
+  DCHECK(!cached->num_slots);
+  subtle::SpinLock::Guard guard(root->lock);
+  while (cached->num_slots < kThreadCacheBatchSize) {
+    void* ret = root->AllocFromBucket(bucket, flags, size);
+    if (!ret)
+      break;
+    cached->slots[cached->num_slots++] = PartitionCookieFreePointerAdjust(ret);
+    // Only the slot needed by the caller may trigger the out of memory
+    // handling.
+    flags |= PartitionAllocReturnNull;
+  }
+  return cached->num_slots != 0;
+}
+
+void PartitionThreadCache::Flush(size_t bucket_index) {
+  PartitionRootGeneric* root = root_.load(std::memory_order_relaxed);
+  Bucket* cached = &buckets_[bucket_index];
+  DCHECK_GE(cached->num_slots, kThreadCacheBatchSize);
+  {
+    subtle::SpinLock::Guard guard(root->lock);
+    for (size_t i = 0; i < kThreadCacheBatchSize; ++i)
+      PartitionPage::FromPointer(cached->slots[i])->Free(cached->slots[i]);
+  }
+  // Keep the most recently freed slots, which are more likely to be in the
+  // CPU caches.
+  cached->num_slots -= kThreadCacheBatchSize;
+  memmove(&cached->slots[0], &cached->slots[kThreadCacheBatchSize],
+          cached->num_slots * sizeof(cached->slots[0]));
+}
+
+void PartitionThreadCache::Purge() {
+  PartitionRootGeneric* root = root_.load(std::memory_order_relaxed);
+  should_purge_.store(false, std::memory_order_relaxed);
+  subtle::SpinLock::Guard guard(root->lock);
+  for (Bucket& cached : buckets_) {
+    for (size_t i = 0; i < cached.num_slots; ++i)
+      PartitionPage::FromPointer(cached.slots[i])->Free(cached.slots[i]);
+    cached.num_slots = 0;
+  }
+}
+
+void PartitionThreadCache::SampleAllocation(void* ptr) {
+  PartitionRootGeneric* root = root_.load(std::memory_order_relaxed);
+  if (root->lifetime_sampler)
+    root->lifetime_sampler->RecordAllocation(ptr);
+}
+
+}  // namespace internal
+}  // namespace base
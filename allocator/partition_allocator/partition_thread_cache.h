@@ -0,0 +1,203 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_ALLOCATOR_PARTITION_ALLOCATOR_PARTITION_THREAD_CACHE_H_
+#define BASE_ALLOCATOR_PARTITION_ALLOCATOR_PARTITION_THREAD_CACHE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "base/allocator/partition_allocator/partition_alloc_constants.h"
+#include "base/allocator/partition_allocator/partition_bucket.h"
+#include "base/allocator/partition_allocator/partition_cookie.h"
+#include "base/allocator/partition_allocator/partition_lifetime_sampler.h"
+#include "base/base_export.h"
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/macros.h"
+
+namespace base {
+
+struct PartitionRootGeneric;
+
+namespace internal {
+
+// A cache of free slots of the small buckets of a PartitionRootGeneric, owned
+// by a single thread. Allocations and frees of small sizes are served from the
+// cache without taking the root's lock. The cache is refilled from, and
+// flushed to, the buckets of the root kThreadCacheBatchSize slots at a time,
+// under the lock. It is flushed entirely when its thread exits and when the
+// root purges its memory.
+//
+// Slots held by a cache are allocated from the point of view of their page, so
+// they are reported as active until they are flushed.
+//
+// Each cache counts the allocations and frees it serves, so that the counts of
+// the cached buckets don't need any synchronization. See AddCounts().
+//
+// Only one root can use thread caches at a time. See
+// PartitionRootGeneric::EnableThreadCache().
+class BASE_EXPORT PartitionThreadCache {
+ public:
+  // Returns true if the slots of |bucket| can be cached.
+  static ALWAYS_INLINE bool CanCache(const PartitionBucket* bucket);
+
+  // Returns the cache of the calling thread for |root|, creating it if needed.
+  // |root| must have thread caches enabled.
+  static PartitionThreadCache* Get(PartitionRootGeneric* root);
+
+  // Makes |root| the root whose allocations of small sizes go through the
+  // thread caches. No other root must use thread caches.
+  static void EnableForRoot(PartitionRootGeneric* root);
+
+  // Detaches all the thread caches from |root|, which is being destroyed. The
+  // slots they hold are dropped.
+  static void DisableForRoot(PartitionRootGeneric* root);
+
+  // Flushes the cache of the calling thread and makes the caches of all the
+  // other threads flush on their next allocation or free.
+  static void PurgeAll(PartitionRootGeneric* root);
+
+  // Adds the number of allocations and frees served by the caches of |root|
+  // since it enabled them, including the caches of the threads which exited,
+  // to the kThreadCacheNumBuckets entries of |num_allocations| and
+  // |num_frees|. Must not be called under the lock of |root|.
+  static void AddCounts(PartitionRootGeneric* root,
+                        uint64_t* num_allocations,
+                        uint64_t* num_frees);
+
+  // Returns a slot of |bucket|, which has index |bucket_index| in the root,
+  // in the same form as PartitionRootBase::AllocFromBucket(). |flags| and
+  // |size| are used when the cache needs to be refilled.
+  ALWAYS_INLINE void* Alloc(PartitionBucket* bucket,
+                            size_t bucket_index,
+                            int flags,
+                            size_t size);
+
+  // Puts |slot|, the start of a slot of |bucket|, in the cache.
+  ALWAYS_INLINE void Free(PartitionBucket* bucket,
+                          size_t bucket_index,
+                          void* slot);
+
+ private:
+  struct Bucket {
+    // Free slots, the most recently freed last.
+    void* slots[kThreadCacheMaxSlotsPerBucket];
+    size_t num_slots = 0;
+    // Only written by the owning thread, and read by AddCounts().
+    std::atomic<uint64_t> num_allocations{0};
+    std::atomic<uint64_t> num_frees{0};
+  };
+
+  // Increments |counter| without an atomic read-modify-write, since only the
+  // owning thread writes it.
+  static ALWAYS_INLINE uint64_t Increment(std::atomic<uint64_t>* counter) {
+    uint64_t value = counter->load(std::memory_order_relaxed) + 1;
+    counter->store(value, std::memory_order_relaxed);
+    return value;
+  }
+
+  explicit PartitionThreadCache(PartitionRootGeneric* root);
+  ~PartitionThreadCache();
+
+  // Called on thread exit by ThreadLocalStorage.
+  static void OnThreadExit(void* cache);
+
+  // Moves up to kThreadCacheBatchSize slots from |bucket| to the cache.
+  // Returns false if no slot could be allocated.
+  NOINLINE bool Refill(PartitionBucket* bucket,
+                       size_t bucket_index,
+                       int flags,
+                       size_t size);
+
+  // Returns the kThreadCacheBatchSize least recently freed slots of the
+  // bucket at |bucket_index| to their page.
+  NOINLINE void Flush(size_t bucket_index);
+
+  // Returns all the cached slots to their page.
+  NOINLINE void Purge();
+
+  // Passes |ptr| to the lifetime sampler of the root, if it has one.
+  NOINLINE void SampleAllocation(void* ptr);
+
+  // The root of the cached slots, or nullptr once the root is destroyed.
+  // Written under the registry lock.
+  std::atomic<PartitionRootGeneric*> root_;
+
+  // Set by PurgeAll() so that the owning thread flushes the cache.
+  std::atomic<bool> should_purge_{false};
+
+  // Links in the list of all the caches, guarded by the registry lock.
+  PartitionThreadCache* prev_ = nullptr;
+  PartitionThreadCache* next_ = nullptr;
+
+  Bucket buckets_[kThreadCacheNumBuckets];
+
+  DISALLOW_COPY_AND_ASSIGN(PartitionThreadCache);
+};
+
+// static
+ALWAYS_INLINE bool PartitionThreadCache::CanCache(
+    const PartitionBucket* bucket) {
+  // The sentinel bucket returned for direct mapped sizes has no slot size.
+  return bucket->slot_size && bucket->slot_size < kThreadCacheMaxSlotSize;
+}
+
+ALWAYS_INLINE void* PartitionThreadCache::Alloc(PartitionBucket* bucket,
+                                                size_t bucket_index,
+                                                int flags,
+                                                size_t size) {
+  DCHECK(CanCache(bucket));
+  if (UNLIKELY(should_purge_.load(std::memory_order_relaxed)))
+    Purge();
+  Bucket* cached = &buckets_[bucket_index];
+  if (UNLIKELY(!cached->num_slots) &&
+      !Refill(bucket, bucket_index, flags, size)) {
+    return nullptr;
+  }
+  char* ret = static_cast<char*>(cached->slots[--cached->num_slots]);
+#if DCHECK_IS_ON()
+  // The cookies were checked and left in place by Free(). The value given to
+  // the application is just after the first one.
+  ret += kCookieSize;
+  memset(ret, kUninitializedByte,
+         PartitionCookieSizeAdjustSubtract(bucket->slot_size));
+#endif
+  if (UNLIKELY(PartitionLifetimeSampler::ShouldSample(
+          Increment(&cached->num_allocations)))) {
+    SampleAllocation(ret);
+  }
+  return ret;
+}
+
+ALWAYS_INLINE void PartitionThreadCache::Free(PartitionBucket* bucket,
+                                              size_t bucket_index,
+                                              void* slot) {
+  DCHECK(CanCache(bucket));
+  if (UNLIKELY(should_purge_.load(std::memory_order_relaxed)))
+    Purge();
+#if DCHECK_IS_ON()
+  // Unlike PartitionPage::Free(), keep the cookies since the slot will go
+  // through it later.
+  PartitionCookieCheckValue(slot);
+  PartitionCookieCheckValue(static_cast<char*>(slot) + bucket->slot_size -
+                            kCookieSize);
+  memset(static_cast<char*>(slot) + kCookieSize, kFreedByte,
+         PartitionCookieSizeAdjustSubtract(bucket->slot_size));
+#endif
+  Bucket* cached = &buckets_[bucket_index];
+  // Catches an immediate double free.
+  CHECK(!cached->num_slots || cached->slots[cached->num_slots - 1] != slot);
+  if (UNLIKELY(cached->num_slots == kThreadCacheMaxSlotsPerBucket))
+    Flush(bucket_index);
+  cached->slots[cached->num_slots++] = slot;
+  Increment(&cached->num_frees);
+}
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_ALLOCATOR_PARTITION_ALLOCATOR_PARTITION_THREAD_CACHE_H_
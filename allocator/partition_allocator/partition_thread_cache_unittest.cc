@@ -0,0 +1,162 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/partition_allocator/partition_thread_cache.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/allocator/partition_allocator/partition_alloc.h"
+#include "base/allocator/partition_allocator/partition_page.h"
+#include "base/macros.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+#if !defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
+
+namespace base {
+namespace internal {
+
+namespace {
+
+constexpr size_t kSmallSize = 16;
+
+PartitionPage* GetPage(void* ptr) {
+  return PartitionPage::FromPointer(PartitionCookieFreePointerAdjust(ptr));
+}
+
+class PartitionThreadCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    allocator_.init();
+    allocator_.root()->EnableThreadCache();
+  }
+
+  PartitionRootGeneric* root() { return allocator_.root(); }
+
+ private:
+  PartitionAllocatorGeneric allocator_;
+};
+
+// Allocates and frees small sizes, and records one pointer per size.
+class ThreadAllocating : public SimpleThread {
+ public:
+  explicit ThreadAllocating(PartitionRootGeneric* root)
+      : SimpleThread("ThreadAllocating"), root_(root) {}
+
+  // SimpleThread:
+  void Run() override {
+    for (size_t size = 1; size < kThreadCacheMaxSlotSize / 2; ++size) {
+      std::vector<void*> ptrs;
+      for (size_t i = 0; i < 3 * kThreadCacheMaxSlotsPerBucket; ++i)
+        ptrs.push_back(root_->Alloc(size, "ThreadAllocating"));
+      sample_ptrs_.push_back(ptrs.front());
+      for (void* ptr : ptrs)
+        root_->Free(ptr);
+    }
+  }
+
+  const std::vector<void*>& sample_ptrs() const { return sample_ptrs_; }
+
+ private:
+  PartitionRootGeneric* const root_;
+  std::vector<void*> sample_ptrs_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadAllocating);
+};
+
+}  // namespace
+
+TEST_F(PartitionThreadCacheTest, ReusesFreedSlot) {
+  void* ptr = root()->Alloc(kSmallSize, "");
+  root()->Free(ptr);
+  void* new_ptr = root()->Alloc(kSmallSize, "");
+  EXPECT_EQ(ptr, new_ptr);
+  root()->Free(new_ptr);
+}
+
+TEST_F(PartitionThreadCacheTest, CachedSlotsStayAllocatedUntilPurge) {
+  void* ptr = root()->Alloc(kSmallSize, "");
+  PartitionPage* page = GetPage(ptr);
+  // The cache was refilled with a batch of slots.
+  EXPECT_EQ(static_cast<int>(kThreadCacheBatchSize), page->num_allocated_slots);
+
+  root()->Free(ptr);
+  EXPECT_EQ(static_cast<int>(kThreadCacheBatchSize), page->num_allocated_slots);
+
+  root()->PurgeMemory(PartitionPurgeDecommitEmptyPages);
+  EXPECT_EQ(0, page->num_allocated_slots);
+}
+
+TEST_F(PartitionThreadCacheTest, FlushesWhenFull) {
+  std::vector<void*> ptrs;
+  for (size_t i = 0; i < 4 * kThreadCacheMaxSlotsPerBucket; ++i)
+    ptrs.push_back(root()->Alloc(kSmallSize, ""));
+  PartitionPage* page = GetPage(ptrs.front());
+  for (void* ptr : ptrs) {
+    EXPECT_EQ(page, GetPage(ptr));
+    root()->Free(ptr);
+  }
+  EXPECT_LE(page->num_allocated_slots,
+            static_cast<int>(kThreadCacheMaxSlotsPerBucket));
+  EXPECT_GT(page->num_allocated_slots, 0);
+}
+
+TEST_F(PartitionThreadCacheTest, LargeSizesBypassCache) {
+  void* ptr = root()->Alloc(kThreadCacheMaxSlotSize, "");
+  PartitionPage* page = GetPage(ptr);
+  EXPECT_EQ(1, page->num_allocated_slots);
+  root()->Free(ptr);
+  EXPECT_EQ(0, page->num_allocated_slots);
+}
+
+TEST_F(PartitionThreadCacheTest, CountsAllocationsOfAllThreads) {
+  constexpr int kNumThreads = 4;
+  std::vector<std::unique_ptr<ThreadAllocating>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(std::make_unique<ThreadAllocating>(root()));
+    threads.back()->Start();
+  }
+  for (const auto& thread : threads)
+    thread->Join();
+  void* ptr = root()->Alloc(kSmallSize, "");
+
+  uint64_t num_allocations[kThreadCacheNumBuckets] = {};
+  uint64_t num_frees[kThreadCacheNumBuckets] = {};
+  PartitionThreadCache::AddCounts(root(), num_allocations, num_frees);
+  uint64_t total_num_allocations = 0;
+  uint64_t total_num_frees = 0;
+  for (size_t i = 0; i < kThreadCacheNumBuckets; ++i) {
+    total_num_allocations += num_allocations[i];
+    total_num_frees += num_frees[i];
+  }
+  // See ThreadAllocating::Run().
+  const uint64_t kNumAllocationsPerThread =
+      (kThreadCacheMaxSlotSize / 2 - 1) * 3 * kThreadCacheMaxSlotsPerBucket;
+  EXPECT_EQ(kNumThreads * kNumAllocationsPerThread + 1, total_num_allocations);
+  EXPECT_EQ(kNumThreads * kNumAllocationsPerThread, total_num_frees);
+
+  root()->Free(ptr);
+}
+
+TEST_F(PartitionThreadCacheTest, ThreadExitFlushesCache) {
+  constexpr int kNumThreads = 4;
+  std::vector<std::unique_ptr<ThreadAllocating>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(std::make_unique<ThreadAllocating>(root()));
+    threads.back()->Start();
+  }
+  for (const auto& thread : threads)
+    thread->Join();
+
+  for (const auto& thread : threads) {
+    for (void* ptr : thread->sample_ptrs())
+      EXPECT_EQ(0, GetPage(ptr)->num_allocated_slots);
+  }
+}
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // !defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
@@ -64,7 +64,20 @@
 namespace base {
 namespace subtle {
 
+namespace {
+
+std::atomic<uint64_t> g_contention_count{0};
+
+}  // namespace
+
+// static
+uint64_t SpinLock::GetContentionCount() {
+  return g_contention_count.load(std::memory_order_relaxed);
+}
+
 void SpinLock::LockSlow() {
+  g_contention_count.fetch_add(1, std::memory_order_relaxed);
+
   // The value of |kYieldProcessorTries| is cargo culted from TCMalloc, Windows
   // critical section defaults, and various other recommendations.
   // TODO(jschuh): Further tuning may be warranted.
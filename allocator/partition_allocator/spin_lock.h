@@ -5,6 +5,8 @@
 #ifndef BASE_ALLOCATOR_PARTITION_ALLOCATOR_SPIN_LOCK_H
 #define BASE_ALLOCATOR_PARTITION_ALLOCATOR_SPIN_LOCK_H
 
+#include <stdint.h>
+
 #include <atomic>
 #include <memory>
 #include <mutex>
@@ -36,6 +38,12 @@ class BASE_EXPORT SpinLock {
 
   ALWAYS_INLINE void unlock() { lock_.store(false, std::memory_order_release); }
 
+  // Returns how many times, in the whole process, a thread found a SpinLock
+  // held and had to wait for it, e.g. to measure the contention on the
+  // PartitionAlloc locks. Only the slow path counts, so this costs nothing to
+  // uncontended locks.
+  static uint64_t GetContentionCount();
+
  private:
   // This is called if the initial attempt to acquire the lock fails. It's
   // slower, but has a much better scheduling and power consumption behavior.
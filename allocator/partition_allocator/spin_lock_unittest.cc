@@ -7,6 +7,7 @@
 #include <memory>
 #include "base/bind.h"
 #include "base/bind_helpers.h"
+#include "base/threading/platform_thread.h"
 #include "base/threading/thread.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -58,4 +59,29 @@ TEST(SpinLockTest, Torture) {
       BindOnce(&ThreadMain, Unretained(static_cast<char*>(shared_buffer))));
 }
 
+TEST(SpinLockTest, ContentionCount) {
+  subtle::SpinLock lock;
+  const uint64_t initial_count = subtle::SpinLock::GetContentionCount();
+  lock.lock();
+  lock.unlock();
+  EXPECT_EQ(initial_count, subtle::SpinLock::GetContentionCount());
+
+  lock.lock();
+  Thread thread("waiter");
+  thread.Start();
+  thread.task_runner()->PostTask(FROM_HERE,
+                                 BindOnce(
+                                     [](subtle::SpinLock* lock) {
+                                       lock->lock();
+                                       lock->unlock();
+                                     },
+                                     Unretained(&lock)));
+  // Wait for |thread| to find the lock held.
+  while (subtle::SpinLock::GetContentionCount() == initial_count)
+    PlatformThread::YieldCurrentThread();
+  lock.unlock();
+  thread.Stop();
+  EXPECT_EQ(initial_count + 1, subtle::SpinLock::GetContentionCount());
+}
+
 }  // namespace base
@@ -5,12 +5,19 @@
 #include "base/at_exit.h"
 
 #include <stddef.h>
+#include <map>
+#include <memory>
 #include <ostream>
 #include <utility>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/callback.h"
 #include "base/logging.h"
+#include "base/no_destructor.h"
+#include "base/process/process.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread_restrictions.h"
 
 namespace base {
 
@@ -24,6 +31,52 @@ static AtExitManager* g_top_manager = nullptr;
 
 static bool g_disable_managers = false;
 
+namespace {
+
+// The flush tasks registered for FastExit(). Leaked, so that they can be
+// unregistered during the destruction of static objects.
+struct FlushTasks {
+  Lock lock;
+  std::map<AtExitManager::FlushTaskId, OnceClosure> tasks;
+  AtExitManager::FlushTaskId next_id = 1;
+};
+
+FlushTasks& GetFlushTasks() {
+  static NoDestructor<FlushTasks> flush_tasks;
+  return *flush_tasks;
+}
+
+// Runs a flush task on its own thread.
+class FlushThread : public PlatformThread::Delegate {
+ public:
+  explicit FlushThread(OnceClosure task) : task_(std::move(task)) {}
+
+  // Starts the thread, or runs the task right away if it can't be created.
+  void Start() {
+    if (!PlatformThread::Create(0, this, &handle_))
+      std::move(task_).Run();
+  }
+
+  void Join() {
+    if (!handle_.is_null())
+      PlatformThread::Join(handle_);
+  }
+
+  // PlatformThread::Delegate:
+  void ThreadMain() override {
+    PlatformThread::SetName("FastExitFlush");
+    std::move(task_).Run();
+  }
+
+ private:
+  OnceClosure task_;
+  PlatformThreadHandle handle_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlushThread);
+};
+
+}  // namespace
+
 AtExitManager::AtExitManager()
     : processing_callbacks_(false), next_manager_(g_top_manager) {
 // If multiple modules instantiate AtExitManagers they'll end up living in this
@@ -100,6 +153,55 @@ void AtExitManager::DisableAllAtExitManagers() {
   g_disable_managers = true;
 }
 
+// static
+AtExitManager::FlushTaskId AtExitManager::RegisterFlushTask(OnceClosure task) {
+  DCHECK(task);
+  FlushTasks& flush_tasks = GetFlushTasks();
+  AutoLock lock(flush_tasks.lock);
+  const FlushTaskId id = flush_tasks.next_id++;
+  flush_tasks.tasks.emplace(id, std::move(task));
+  return id;
+}
+
+// static
+void AtExitManager::UnregisterFlushTask(FlushTaskId id) {
+  FlushTasks& flush_tasks = GetFlushTasks();
+  AutoLock lock(flush_tasks.lock);
+  const size_t erased = flush_tasks.tasks.erase(id);
+  DCHECK_EQ(1u, erased);
+}
+
+// static
+void AtExitManager::FastExit(int exit_code) {
+  // |lock| is held until the process exits, so that the state the tasks save
+  // can't be destroyed under them: UnregisterFlushTask() blocks meanwhile.
+  FlushTasks& flush_tasks = GetFlushTasks();
+  flush_tasks.lock.Acquire();
+
+  // A single task runs on the current thread, which saves creating one.
+  std::vector<std::unique_ptr<FlushThread>> threads;
+  OnceClosure last_task;
+  for (auto& id_and_task : flush_tasks.tasks) {
+    if (last_task) {
+      threads.push_back(std::make_unique<FlushThread>(std::move(last_task)));
+      threads.back()->Start();
+    }
+    last_task = std::move(id_and_task.second);
+  }
+  flush_tasks.tasks.clear();
+
+  {
+    // Flush tasks typically write files, wherever FastExit() is called from.
+    ScopedAllowBlocking allow_blocking;
+    if (last_task)
+      std::move(last_task).Run();
+    for (const auto& thread : threads)
+      thread->Join();
+  }
+
+  Process::TerminateCurrentProcessImmediately(exit_code);
+}
+
 AtExitManager::AtExitManager(bool shadow)
     : processing_callbacks_(false), next_manager_(g_top_manager) {
   DCHECK(shadow || !g_top_manager);
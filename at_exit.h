@@ -52,6 +52,28 @@ class BASE_EXPORT AtExitManager {
   // process mode.
   static void DisableAllAtExitManagers();
 
+  // Identifies a flush task registered with RegisterFlushTask().
+  using FlushTaskId = int;
+
+  // Registers |task| to save state which must outlive the process, such as
+  // data waiting to be written to disk, when the process exits with
+  // FastExit(). Unlike the at-exit callbacks, flush tasks are registered
+  // whether or not there is an AtExitManager, and run concurrently on
+  // separate threads, so they must be thread-safe. They must not register or
+  // unregister flush tasks themselves.
+  //
+  // The task must be unregistered before the state it saves is destroyed.
+  static FlushTaskId RegisterFlushTask(OnceClosure task);
+  static void UnregisterFlushTask(FlushTaskId id);
+
+  // Runs the flush tasks, then terminates the process with |exit_code| right
+  // away: the at-exit callbacks, the destructors of singletons and static
+  // objects, and the shutdown of TaskScheduler, including BLOCK_SHUTDOWN
+  // tasks, are skipped, and the OS reclaims the memory of the process at
+  // once. Attempts to unregister flush tasks meanwhile block until the
+  // process exits.
+  [[noreturn]] static void FastExit(int exit_code);
+
  protected:
   // This constructor will allow this instance of AtExitManager to be created
   // even if one already exists.  This should only be used for testing!
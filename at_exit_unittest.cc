@@ -3,7 +3,11 @@
 // found in the LICENSE file.
 
 #include "base/at_exit.h"
+
+#include <stdio.h>
+
 #include "base/bind.h"
+#include "base/process/process.h"
 
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -85,3 +89,38 @@ TEST_F(AtExitTest, Task) {
                                                &g_test_counter_1));
   base::AtExitManager::ProcessCallbacksNow();
 }
+
+namespace {
+
+const int kFastExitCode = 42;
+
+void FlushTask(const char* name) {
+  fprintf(stderr, "flushed %s\n", name);
+}
+
+// Exits with another code, to tell whether it ran.
+void ExitWithWrongCode() {
+  base::Process::TerminateCurrentProcessImmediately(kFastExitCode + 1);
+}
+
+void RegisterTasksAndFastExit() {
+  base::AtExitManager::RegisterFlushTask(base::BindOnce(&FlushTask, "first"));
+  const base::AtExitManager::FlushTaskId unregistered =
+      base::AtExitManager::RegisterFlushTask(
+          base::BindOnce(&ExitWithWrongCode));
+  base::AtExitManager::RegisterFlushTask(
+      base::BindOnce(&FlushTask, "second"));
+  base::AtExitManager::UnregisterFlushTask(unregistered);
+
+  // The at-exit callbacks are skipped.
+  base::AtExitManager::RegisterTask(base::Bind(&ExitWithWrongCode));
+  base::AtExitManager::FastExit(kFastExitCode);
+}
+
+}  // namespace
+
+TEST_F(AtExitTest, FastExitRunsFlushTasks) {
+  EXPECT_EXIT(RegisterTasksAndFastExit(),
+              testing::ExitedWithCode(kFastExitCode),
+              "flushed (first\nflushed second|second\nflushed first)");
+}
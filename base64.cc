@@ -5,35 +5,393 @@
 #include "base/base64.h"
 
 #include <stddef.h>
+#include <string.h>
 
+#include <algorithm>
+
+#include "base/logging.h"
+#include "build/build_config.h"
 #include "third_party/modp_b64/modp_b64.h"
 
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <immintrin.h>
+
+#include "base/cpu.h"
+#endif
+
 namespace base {
 
-void Base64Encode(const StringPiece& input, std::string* output) {
-  std::string temp;
-  temp.resize(modp_b64_encode_len(input.size()));  // makes room for null byte
+namespace {
+
+const char kPaddingChar = '=';
+
+// Decodes |length| characters of base64, a multiple of four, into |output|.
+// Only the last group of four characters may be padded.
+bool DecodeGroups(const char* input,
+                  size_t length,
+                  uint8_t* output,
+                  size_t* output_size) {
+  if (length % 4)
+    return false;
+  if (!length) {
+    *output_size = 0;
+    return true;
+  }
+
+  // The groups before the last one decode to exactly three bytes each, and go
+  // straight to |output|. The last one is decoded separately so that
+  // modp_b64_decode() never writes past the decoded bytes.
+  size_t body_length = length - 4;
+  size_t body_size = 0;
+  if (body_length) {
+    // modp_b64_decode() would take this for the padding of |input|.
+    if (input[body_length - 1] == kPaddingChar)
+      return false;
+    body_size = modp_b64_decode(reinterpret_cast<char*>(output), input,
+                                body_length);
+    if (body_size == MODP_B64_ERROR)
+      return false;
+  }
+  char last_group[modp_b64_decode_len(4)];
+  size_t last_group_size =
+      modp_b64_decode(last_group, input + body_length, 4);
+  if (last_group_size == MODP_B64_ERROR)
+    return false;
+  memcpy(output + body_size, last_group, last_group_size);
+  *output_size = body_size + last_group_size;
+  return true;
+}
+
+// Decodes base64url by translating it to base64 in chunks, padding the last
+// one if needed.
+bool DecodeUrlSafe(const char* input,
+                   size_t length,
+                   uint8_t* output,
+                   size_t* output_size) {
+  const size_t kChunkLength = 1024;
+  char chunk[kChunkLength];
+  size_t total_size = 0;
+  while (length) {
+    size_t chunk_length = std::min(length, kChunkLength);
+    for (size_t i = 0; i < chunk_length; ++i) {
+      switch (input[i]) {
+        case '+':
+        case '/':
+          // These are only part of the base64 alphabet.
+          return false;
+        case '-':
+          chunk[i] = '+';
+          break;
+        case '_':
+          chunk[i] = '/';
+          break;
+        default:
+          chunk[i] = input[i];
+          break;
+      }
+    }
+    input += chunk_length;
+    length -= chunk_length;
+
+    size_t padded_length = chunk_length;
+    if (length) {
+      // Only the end of |input| may be padded.
+      if (chunk[chunk_length - 1] == kPaddingChar)
+        return false;
+    } else {
+      // A chunk which isn't a multiple of four is shorter than kChunkLength.
+      while (padded_length % 4)
+        chunk[padded_length++] = kPaddingChar;
+    }
+
+    size_t chunk_size;
+    if (!DecodeGroups(chunk, padded_length, output + total_size, &chunk_size))
+      return false;
+    total_size += chunk_size;
+  }
+  *output_size = total_size;
+  return true;
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+#if defined(COMPILER_GCC)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+// The AVX2 loops below follow "Faster Base64 Encoding and Decoding Using AVX2
+// Instructions" by Wojciech Mula and Daniel Lemire,
+// https://arxiv.org/abs/1704.00605. They leave the end of the input to the
+// scalar code.
+
+bool UseAVX2() {
+  static const bool use_avx2 = CPU().has_avx2();
+  return use_avx2;
+}
+
+// Encodes 24 bytes at a time, as long as 28 bytes can be read. Returns the
+// number of bytes encoded.
+AVX2_TARGET size_t EncodeAVX2(const uint8_t* input,
+                              size_t length,
+                              internal::Base64Alphabet alphabet,
+                              char* output) {
+  // Spreads each group of three bytes over a 32-bit word, as bytes 1, 0, 2, 1.
+  const __m256i kSpread = _mm256_setr_epi8(
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  // Added to the 6-bit values to turn them into characters, indexed as
+  // computed below: 'A'-'Z', 'a'-'z', ten times '0'-'9', then 62 and 63.
+  const char kOffset62 = alphabet == internal::Base64Alphabet::kUrlSafe
+                             ? '-' - 62
+                             : '+' - 62;
+  const char kOffset63 = alphabet == internal::Base64Alphabet::kUrlSafe
+                             ? '_' - 63
+                             : '/' - 63;
+  const __m256i kOffsets = _mm256_setr_epi8(
+      'A', 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, kOffset62, kOffset63,
+      0, 0,
+      'A', 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, kOffset62, kOffset63,
+      0, 0);
+
+  size_t encoded = 0;
+  for (; length - encoded >= 28; encoded += 24, output += 32) {
+    // Twelve bytes in each lane.
+    __m256i in = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(input + encoded))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + encoded + 12)),
+        1);
+    in = _mm256_shuffle_epi8(in, kSpread);
+
+    // Move each 6-bit value to its own byte, with multiplications as shifts.
+    const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const __m256i values = _mm256_or_si256(t1, t3);
+
+    // 0 for 0-25, 1 for 26-51, 2-11 for 52-61, 12 and 13 for 62 and 63.
+    __m256i indices = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+    indices = _mm256_sub_epi8(
+        indices, _mm256_cmpgt_epi8(values, _mm256_set1_epi8(25)));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(output),
+        _mm256_add_epi8(values, _mm256_shuffle_epi8(kOffsets, indices)));
+  }
+  return encoded;
+}
+
+// Decodes 32 characters at a time, as long as 45 are left. That keeps the
+// padding out, and leaves characters for at least 8 more bytes, which the
+// 32-byte stores overwrite. Returns false if it finds a character outside of
+// |alphabet|, otherwise sets |*decoded| to the number of characters decoded.
+AVX2_TARGET bool DecodeAVX2(const char* input,
+                            size_t length,
+                            internal::Base64Alphabet alphabet,
+                            uint8_t* output,
+                            size_t* decoded) {
+  // A character is valid when its bits in the tables indexed by its high and
+  // low nibbles don't overlap. The nibbles are masked with 0x2f, which keeps
+  // the high bit of the byte clear and leaves '/' alone.
+  const __m256i kLowNibbleBits = _mm256_setr_epi8(
+      0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+      0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+      0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+      0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m256i kHighNibbleBits = _mm256_setr_epi8(
+      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  // Added to valid characters to get their 6-bit values, indexed by the high
+  // nibble, and by 1 for '/'.
+  const __m256i kOffsets = _mm256_setr_epi8(
+      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i kMask2F = _mm256_set1_epi8(0x2f);
+  // Packs the three bytes of each 32-bit word in big-endian order.
+  const __m256i kPack = _mm256_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  const bool url_safe = alphabet == internal::Base64Alphabet::kUrlSafe;
+
+  size_t consumed = 0;
+  for (; length - consumed >= 45; consumed += 32, output += 24) {
+    __m256i in = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(input + consumed));
+    if (url_safe) {
+      const __m256i plus = _mm256_set1_epi8('+');
+      const __m256i slash = _mm256_set1_epi8('/');
+      if (_mm256_movemask_epi8(
+              _mm256_or_si256(_mm256_cmpeq_epi8(in, plus),
+                              _mm256_cmpeq_epi8(in, slash)))) {
+        return false;
+      }
+      in = _mm256_blendv_epi8(in, plus,
+                              _mm256_cmpeq_epi8(in, _mm256_set1_epi8('-')));
+      in = _mm256_blendv_epi8(in, slash,
+                              _mm256_cmpeq_epi8(in, _mm256_set1_epi8('_')));
+    }
 
-  // modp_b64_encode_len() returns at least 1, so temp[0] is safe to use.
-  size_t output_size = modp_b64_encode(&(temp[0]), input.data(), input.size());
+    const __m256i high_nibbles =
+        _mm256_and_si256(_mm256_srli_epi32(in, 4), kMask2F);
+    const __m256i low_nibbles = _mm256_and_si256(in, kMask2F);
+    if (!_mm256_testz_si256(_mm256_shuffle_epi8(kLowNibbleBits, low_nibbles),
+                            _mm256_shuffle_epi8(kHighNibbleBits,
+                                                high_nibbles))) {
+      return false;
+    }
+    const __m256i offset_indices =
+        _mm256_add_epi8(_mm256_cmpeq_epi8(in, kMask2F), high_nibbles);
+    __m256i values =
+        _mm256_add_epi8(in, _mm256_shuffle_epi8(kOffsets, offset_indices));
 
-  temp.resize(output_size);  // strips off null byte
+    // Merge the 6-bit values into 24 bits per 32-bit word, with
+    // multiplications as shifts, then pack the 12 bytes of each lane.
+    values = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    values = _mm256_madd_epi16(values, _mm256_set1_epi32(0x00011000));
+    values = _mm256_shuffle_epi8(values, kPack);
+    values = _mm256_permutevar8x32_epi32(
+        values, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), values);
+  }
+  *decoded = consumed;
+  return true;
+}
+
+#undef AVX2_TARGET
+
+#endif  // defined(ARCH_CPU_X86_FAMILY)
+
+}  // namespace
+
+void Base64Encode(const StringPiece& input, std::string* output) {
+  std::string temp;
+  temp.resize(Base64EncodedLength(input.size()));
+  if (!temp.empty()) {
+    Base64Encode(
+        make_span(reinterpret_cast<const uint8_t*>(input.data()), input.size()),
+        make_span(&temp[0], temp.size()));
+  }
   output->swap(temp);
 }
 
 bool Base64Decode(const StringPiece& input, std::string* output) {
   std::string temp;
-  temp.resize(modp_b64_decode_len(input.size()));
+  temp.resize(Base64DecodedLengthUpperBound(input.size()));
 
   // does not null terminate result since result is binary data!
-  size_t input_size = input.size();
-  size_t output_size = modp_b64_decode(&(temp[0]), input.data(), input_size);
-  if (output_size == MODP_B64_ERROR)
+  size_t output_size = 0;
+  if (!temp.empty() &&
+      !Base64Decode(input,
+                    make_span(reinterpret_cast<uint8_t*>(&temp[0]),
+                              temp.size()),
+                    &output_size)) {
     return false;
+  }
 
   temp.resize(output_size);
   output->swap(temp);
   return true;
 }
 
+size_t Base64EncodedLength(size_t input_length) {
+  return (input_length + 2) / 3 * 4;
+}
+
+size_t Base64DecodedLengthUpperBound(size_t input_length) {
+  return (input_length + 3) / 4 * 3;
+}
+
+size_t Base64Encode(span<const uint8_t> input, span<char> output) {
+  return internal::Base64EncodeWithAlphabet(
+      input, internal::Base64Alphabet::kStandard, output);
+}
+
+bool Base64Decode(const StringPiece& input,
+                  span<uint8_t> output,
+                  size_t* output_size) {
+  return internal::Base64DecodeWithAlphabet(
+      input, internal::Base64Alphabet::kStandard, output, output_size);
+}
+
+namespace internal {
+
+size_t Base64EncodeWithAlphabet(span<const uint8_t> input,
+                                Base64Alphabet alphabet,
+                                span<char> output) {
+  CHECK_GE(output.size(), Base64EncodedLength(input.size()));
+  const uint8_t* in = input.data();
+  size_t remaining = input.size();
+  char* out = output.data();
+
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (UseAVX2()) {
+    size_t encoded = EncodeAVX2(in, remaining, alphabet, out);
+    in += encoded;
+    remaining -= encoded;
+    out += encoded / 3 * 4;
+  }
+#endif
+
+  char* const scalar_output = out;
+  if (remaining) {
+    // modp_b64_encode() null-terminates its output, so the last group is
+    // encoded separately: before it, the null is overwritten.
+    size_t body_size = (remaining - 1) / 3 * 3;
+    out += modp_b64_encode(out, reinterpret_cast<const char*>(in), body_size);
+    char last_group[modp_b64_encode_len(3)];
+    size_t last_group_length = modp_b64_encode(
+        last_group, reinterpret_cast<const char*>(in + body_size),
+        remaining - body_size);
+    memcpy(out, last_group, last_group_length);
+    out += last_group_length;
+  }
+  if (alphabet == Base64Alphabet::kUrlSafe) {
+    for (char* c = scalar_output; c != out; ++c) {
+      if (*c == '+')
+        *c = '-';
+      else if (*c == '/')
+        *c = '_';
+    }
+  }
+  return out - output.data();
+}
+
+bool Base64DecodeWithAlphabet(const StringPiece& input,
+                              Base64Alphabet alphabet,
+                              span<uint8_t> output,
+                              size_t* output_size) {
+  CHECK_GE(output.size(), Base64DecodedLengthUpperBound(input.size()));
+  const char* in = input.data();
+  size_t remaining = input.size();
+  uint8_t* out = output.data();
+
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (UseAVX2()) {
+    size_t decoded;
+    if (!DecodeAVX2(in, remaining, alphabet, out, &decoded))
+      return false;
+    in += decoded;
+    remaining -= decoded;
+    out += decoded / 4 * 3;
+  }
+#endif
+
+  size_t scalar_size;
+  bool success = alphabet == Base64Alphabet::kUrlSafe
+                     ? DecodeUrlSafe(in, remaining, out, &scalar_size)
+                     : DecodeGroups(in, remaining, out, &scalar_size);
+  if (!success)
+    return false;
+  *output_size = out - output.data() + scalar_size;
+  return true;
+}
+
+}  // namespace internal
+
 }  // namespace base
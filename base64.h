@@ -5,9 +5,13 @@
 #ifndef BASE_BASE64_H_
 #define BASE_BASE64_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <string>
 
 #include "base/base_export.h"
+#include "base/containers/span.h"
 #include "base/strings/string_piece.h"
 
 namespace base {
@@ -20,6 +24,50 @@ BASE_EXPORT void Base64Encode(const StringPiece& input, std::string* output);
 // be done in-place.
 BASE_EXPORT bool Base64Decode(const StringPiece& input, std::string* output);
 
+// Returns the length of the base64 encoding of |input_length| bytes, padding
+// included.
+BASE_EXPORT size_t Base64EncodedLength(size_t input_length);
+
+// Returns how many bytes decoding |input_length| characters of base64 can
+// produce at most.
+BASE_EXPORT size_t Base64DecodedLengthUpperBound(size_t input_length);
+
+// Encodes |input| in base64 into |output|, which must hold at least
+// Base64EncodedLength(input.size()) characters. Returns the number of
+// characters written; no null terminator is added. The buffers must not
+// overlap.
+BASE_EXPORT size_t Base64Encode(span<const uint8_t> input, span<char> output);
+
+// Decodes the base64 |input| into |output|, which must hold at least
+// Base64DecodedLengthUpperBound(input.size()) bytes, and sets |*output_size| to
+// the number of bytes decoded. Returns false if |input| isn't valid base64, in
+// which case the contents of |output| are unspecified. The buffers must not
+// overlap.
+BASE_EXPORT bool Base64Decode(const StringPiece& input,
+                              span<uint8_t> output,
+                              size_t* output_size);
+
+namespace internal {
+
+// The alphabets of RFC 4648: section 4 for base64 and section 5 for
+// base64url.
+enum class Base64Alphabet {
+  kStandard,
+  kUrlSafe,
+};
+
+// The functions above, for either alphabet. When decoding base64url, the
+// padding of |input| is optional.
+BASE_EXPORT size_t Base64EncodeWithAlphabet(span<const uint8_t> input,
+                                            Base64Alphabet alphabet,
+                                            span<char> output);
+BASE_EXPORT bool Base64DecodeWithAlphabet(const StringPiece& input,
+                                          Base64Alphabet alphabet,
+                                          span<uint8_t> output,
+                                          size_t* output_size);
+
+}  // namespace internal
+
 }  // namespace base
 
 #endif  // BASE_BASE64_H_
@@ -4,10 +4,47 @@
 
 #include "base/base64.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
 
+namespace {
+
+// Encodes |input| one bit at a time.
+std::string ReferenceBase64Encode(const std::string& input) {
+  const char kAlphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string output;
+  size_t num_bits = input.size() * 8;
+  for (size_t bit = 0; bit < num_bits; bit += 6) {
+    int value = 0;
+    for (size_t i = bit; i < bit + 6; ++i) {
+      int b = i < num_bits ? (input[i / 8] >> (7 - i % 8)) & 1 : 0;
+      value = value * 2 + b;
+    }
+    output.push_back(kAlphabet[value]);
+  }
+  while (output.size() % 4)
+    output.push_back('=');
+  return output;
+}
+
+// Bytes which give every character of the alphabet.
+std::string MakeInput(size_t size) {
+  std::string input;
+  for (size_t i = 0; i < size; ++i)
+    input.push_back(static_cast<char>(i * 37 + i / 7));
+  return input;
+}
+
+}  // namespace
+
 TEST(Base64Test, Basic) {
   const std::string kText = "hello world";
   const std::string kBase64Text = "aGVsbG8gd29ybGQ=";
@@ -37,4 +74,92 @@ TEST(Base64Test, InPlace) {
   EXPECT_EQ(text, kText);
 }
 
+// Covers both the vectorized loops and the scalar code they leave the ends
+// of the input to.
+TEST(Base64Test, AllLengths) {
+  for (size_t size = 0; size < 300; ++size) {
+    const std::string text = MakeInput(size);
+    std::string encoded;
+    Base64Encode(text, &encoded);
+    EXPECT_EQ(ReferenceBase64Encode(text), encoded) << "size " << size;
+
+    std::string decoded;
+    EXPECT_TRUE(Base64Decode(encoded, &decoded)) << "size " << size;
+    EXPECT_EQ(text, decoded) << "size " << size;
+  }
+}
+
+TEST(Base64Test, InvalidCharacters) {
+  const std::string kInvalidCharacters("-_.= \n\0\x80\xff", 9);
+  std::string encoded;
+  Base64Encode(MakeInput(150), &encoded);
+  for (size_t i = 0; i < encoded.size(); ++i) {
+    for (char c : kInvalidCharacters) {
+      // Padding is valid at the very end.
+      if (c == '=' && i >= encoded.size() - 1)
+        continue;
+      std::string invalid = encoded;
+      invalid[i] = c;
+      std::string decoded = "unchanged";
+      EXPECT_FALSE(Base64Decode(invalid, &decoded)) << i << " " << int{c};
+      EXPECT_EQ("unchanged", decoded);
+    }
+  }
+}
+
+TEST(Base64Test, Padding) {
+  std::string decoded;
+  EXPECT_TRUE(Base64Decode("", &decoded));
+  EXPECT_EQ("", decoded);
+  EXPECT_TRUE(Base64Decode("YQ==", &decoded));
+  EXPECT_EQ("a", decoded);
+  EXPECT_TRUE(Base64Decode("YWI=", &decoded));
+  EXPECT_EQ("ab", decoded);
+
+  EXPECT_FALSE(Base64Decode("YQ", &decoded));
+  EXPECT_FALSE(Base64Decode("YQ=", &decoded));
+  EXPECT_FALSE(Base64Decode("Y===", &decoded));
+  EXPECT_FALSE(Base64Decode("YQ==YWI=", &decoded));
+  EXPECT_FALSE(Base64Decode("YWI=YWI=", &decoded));
+}
+
+TEST(Base64Test, Spans) {
+  const std::string kText = "hello world";
+  const std::string kBase64Text = "aGVsbG8gd29ybGQ=";
+  EXPECT_EQ(kBase64Text.size(), Base64EncodedLength(kText.size()));
+
+  std::vector<char> encoded(Base64EncodedLength(kText.size()));
+  EXPECT_EQ(kBase64Text.size(),
+            Base64Encode(make_span(reinterpret_cast<const uint8_t*>(
+                                       kText.data()),
+                                   kText.size()),
+                         encoded));
+  EXPECT_EQ(kBase64Text, std::string(encoded.begin(), encoded.end()));
+
+  std::vector<uint8_t> decoded(
+      Base64DecodedLengthUpperBound(kBase64Text.size()));
+  size_t decoded_size = 0;
+  EXPECT_TRUE(Base64Decode(kBase64Text, decoded, &decoded_size));
+  EXPECT_EQ(kText,
+            std::string(decoded.begin(), decoded.begin() + decoded_size));
+  EXPECT_FALSE(Base64Decode("aGVsbG8gd29ybGQ", decoded, &decoded_size));
+
+  // A large input, with exactly enough room for its encoding.
+  const std::string large_text = MakeInput(3 * 100000 + 1);
+  std::vector<char> large_encoded(Base64EncodedLength(large_text.size()));
+  ASSERT_EQ(large_encoded.size(),
+            Base64Encode(make_span(reinterpret_cast<const uint8_t*>(
+                                       large_text.data()),
+                                   large_text.size()),
+                         large_encoded));
+  std::string large_base64(large_encoded.begin(), large_encoded.end());
+  EXPECT_EQ(ReferenceBase64Encode(large_text), large_base64);
+
+  std::vector<uint8_t> large_decoded(
+      Base64DecodedLengthUpperBound(large_base64.size()));
+  ASSERT_TRUE(Base64Decode(large_base64, large_decoded, &decoded_size));
+  EXPECT_EQ(large_text, std::string(large_decoded.begin(),
+                                    large_decoded.begin() + decoded_size));
+}
+
 }  // namespace base
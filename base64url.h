@@ -5,10 +5,14 @@
 #ifndef BASE_BASE64URL_H_
 #define BASE_BASE64URL_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <string>
 
 #include "base/base_export.h"
 #include "base/compiler_specific.h"
+#include "base/containers/span.h"
 #include "base/macros.h"
 #include "base/strings/string_piece.h"
 
@@ -31,6 +35,14 @@ BASE_EXPORT void Base64UrlEncode(const StringPiece& input,
                                  Base64UrlEncodePolicy policy,
                                  std::string* output);
 
+// Encodes |input| in base64url into |output|, which must hold at least
+// Base64EncodedLength(input.size()) characters. Returns the number of
+// characters written, which doesn't include the padding when |policy| omits
+// it. No null terminator is added. The buffers must not overlap.
+BASE_EXPORT size_t Base64UrlEncode(span<const uint8_t> input,
+                                   Base64UrlEncodePolicy policy,
+                                   span<char> output);
+
 enum class Base64UrlDecodePolicy {
   // Require inputs contain trailing padding if non-aligned.
   REQUIRE_PADDING,
@@ -51,6 +63,16 @@ BASE_EXPORT bool Base64UrlDecode(const StringPiece& input,
                                  Base64UrlDecodePolicy policy,
                                  std::string* output) WARN_UNUSED_RESULT;
 
+// Decodes the base64url |input| into |output|, which must hold at least
+// Base64DecodedLengthUpperBound(input.size()) bytes, and sets |*output_size| to
+// the number of bytes decoded. The padding is handled as above. The contents of
+// |output| are unspecified when false is returned. The buffers must not
+// overlap.
+BASE_EXPORT bool Base64UrlDecode(const StringPiece& input,
+                                 Base64UrlDecodePolicy policy,
+                                 span<uint8_t> output,
+                                 size_t* output_size) WARN_UNUSED_RESULT;
+
 }  // namespace base
 
 #endif  // BASE_BASE64URL_H_
@@ -4,7 +4,15 @@
 
 #include "base/base64url.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/base64.h"
 #include "base/macros.h"
+#include "base/strings/string_util.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -110,6 +118,90 @@ TEST(Base64UrlTest, DecodeDisallowsPaddingOnly) {
       "====", Base64UrlDecodePolicy::IGNORE_PADDING, &output));
 }
 
+// Covers both the vectorized loops and the scalar code they leave the ends
+// of the input to.
+TEST(Base64UrlTest, AllLengths) {
+  for (size_t size = 0; size < 300; ++size) {
+    std::string text;
+    for (size_t i = 0; i < size; ++i)
+      text.push_back(static_cast<char>(i * 37 + i / 7));
+    std::string base64;
+    Base64Encode(text, &base64);
+    std::string expected;
+    ReplaceChars(base64, "+", "-", &expected);
+    ReplaceChars(expected, "/", "_", &expected);
+
+    std::string encoded;
+    Base64UrlEncode(text, Base64UrlEncodePolicy::INCLUDE_PADDING, &encoded);
+    EXPECT_EQ(expected, encoded) << "size " << size;
+    std::string decoded;
+    EXPECT_TRUE(Base64UrlDecode(encoded, Base64UrlDecodePolicy::REQUIRE_PADDING,
+                                &decoded));
+    EXPECT_EQ(text, decoded) << "size " << size;
+
+    TrimString(expected, "=", &expected);
+    Base64UrlEncode(text, Base64UrlEncodePolicy::OMIT_PADDING, &encoded);
+    EXPECT_EQ(expected, encoded) << "size " << size;
+    EXPECT_TRUE(Base64UrlDecode(
+        encoded, Base64UrlDecodePolicy::DISALLOW_PADDING, &decoded));
+    EXPECT_EQ(text, decoded) << "size " << size;
+  }
+}
+
+TEST(Base64UrlTest, DecodeDisallowsBase64AlphabetAnywhere) {
+  std::string text;
+  for (size_t i = 0; i < 3000; ++i)
+    text.push_back(static_cast<char>(i * 37 + i / 7));
+  std::string encoded;
+  Base64UrlEncode(text, Base64UrlEncodePolicy::OMIT_PADDING, &encoded);
+
+  for (size_t i = 0; i < encoded.size(); ++i) {
+    std::string invalid = encoded;
+    invalid[i] = i % 2 ? '+' : '/';
+    std::string output;
+    EXPECT_FALSE(Base64UrlDecode(
+        invalid, Base64UrlDecodePolicy::IGNORE_PADDING, &output))
+        << "at " << i;
+  }
+}
+
+TEST(Base64UrlTest, DecodeDisallowsPaddingInTheMiddle) {
+  std::string output;
+  std::string input(2000, 'A');
+  for (size_t i : {4, 1020, 1024, 1028, 1990}) {
+    std::string invalid = input;
+    invalid.replace(i - 2, 2, "==");
+    EXPECT_FALSE(Base64UrlDecode(invalid, Base64UrlDecodePolicy::IGNORE_PADDING,
+                                 &output))
+        << "at " << i;
+  }
+}
+
+TEST(Base64UrlTest, Spans) {
+  const std::string kText = "hello?world";
+  const uint8_t* text = reinterpret_cast<const uint8_t*>(kText.data());
+
+  std::vector<char> encoded(Base64EncodedLength(kText.size()));
+  size_t encoded_size =
+      Base64UrlEncode(make_span(text, kText.size()),
+                      Base64UrlEncodePolicy::INCLUDE_PADDING, encoded);
+  EXPECT_EQ("aGVsbG8_d29ybGQ=", std::string(encoded.data(), encoded_size));
+  encoded_size = Base64UrlEncode(make_span(text, kText.size()),
+                                 Base64UrlEncodePolicy::OMIT_PADDING, encoded);
+  EXPECT_EQ("aGVsbG8_d29ybGQ", std::string(encoded.data(), encoded_size));
+
+  std::vector<uint8_t> decoded(Base64DecodedLengthUpperBound(encoded_size));
+  size_t decoded_size = 0;
+  ASSERT_TRUE(Base64UrlDecode(StringPiece(encoded.data(), encoded_size),
+                              Base64UrlDecodePolicy::IGNORE_PADDING, decoded,
+                              &decoded_size));
+  EXPECT_EQ(kText,
+            std::string(decoded.begin(), decoded.begin() + decoded_size));
+  EXPECT_FALSE(Base64UrlDecode(StringPiece(encoded.data(), encoded_size),
+                               Base64UrlDecodePolicy::REQUIRE_PADDING, decoded,
+                               &decoded_size));
+}
+
 }  // namespace
 
 }  // namespace base
@@ -4,7 +4,11 @@
 
 #include "base/big_endian.h"
 
+#include <string.h>
+
 #include "base/strings/string_piece.h"
+#include "base/sys_byteorder.h"
+#include "build/build_config.h"
 
 namespace base {
 
@@ -59,6 +63,32 @@ bool BigEndianReader::ReadU64(uint64_t* value) {
   return Read(value);
 }
 
+template <typename T>
+bool BigEndianReader::ReadArray(span<T> values) {
+  if (values.size() > static_cast<size_t>(end_ - ptr_) / sizeof(T))
+    return false;
+  if (values.empty())
+    return true;
+  memcpy(values.data(), ptr_, values.size_bytes());
+  ptr_ += values.size_bytes();
+#if defined(ARCH_CPU_LITTLE_ENDIAN)
+  ByteSwapInPlace(values);
+#endif
+  return true;
+}
+
+bool BigEndianReader::ReadU16Array(span<uint16_t> values) {
+  return ReadArray(values);
+}
+
+bool BigEndianReader::ReadU32Array(span<uint32_t> values) {
+  return ReadArray(values);
+}
+
+bool BigEndianReader::ReadU64Array(span<uint64_t> values) {
+  return ReadArray(values);
+}
+
 BigEndianWriter::BigEndianWriter(char* buf, size_t len)
     : ptr_(buf), end_(ptr_ + len) {}
 
@@ -102,4 +132,31 @@ bool BigEndianWriter::WriteU64(uint64_t value) {
   return Write(value);
 }
 
+template <typename T>
+bool BigEndianWriter::WriteArray(span<const T> values) {
+  if (values.size() > static_cast<size_t>(end_ - ptr_) / sizeof(T))
+    return false;
+  // Like ByteSwapInPlace(), this loop is vectorized.
+  for (T value : values) {
+#if defined(ARCH_CPU_LITTLE_ENDIAN)
+    value = ByteSwap(value);
+#endif
+    memcpy(ptr_, &value, sizeof(T));
+    ptr_ += sizeof(T);
+  }
+  return true;
+}
+
+bool BigEndianWriter::WriteU16Array(span<const uint16_t> values) {
+  return WriteArray(values);
+}
+
+bool BigEndianWriter::WriteU32Array(span<const uint32_t> values) {
+  return WriteArray(values);
+}
+
+bool BigEndianWriter::WriteU64Array(span<const uint64_t> values) {
+  return WriteArray(values);
+}
+
 }  // namespace base
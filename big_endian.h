@@ -8,7 +8,10 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <initializer_list>
+
 #include "base/base_export.h"
+#include "base/containers/span.h"
 #include "base/strings/string_piece.h"
 
 namespace base {
@@ -49,6 +52,20 @@ inline void WriteBigEndian<uint8_t>(char buf[], uint8_t val) {
   buf[0] = static_cast<char>(val);
 }
 
+namespace internal {
+
+// Returns the sum of the sizes of |T|.
+template <typename... T>
+constexpr size_t TotalSizeOf() {
+  const size_t sizes[] = {0, sizeof(T)...};
+  size_t total = 0;
+  for (size_t size : sizes)
+    total += size;
+  return total;
+}
+
+}  // namespace internal
+
 // Allows reading integers in network order (big endian) while iterating over
 // an underlying buffer. All the reading functions advance the internal pointer.
 class BASE_EXPORT BigEndianReader {
@@ -67,10 +84,36 @@ class BASE_EXPORT BigEndianReader {
   bool ReadU32(uint32_t* value);
   bool ReadU64(uint64_t* value);
 
+  // Read |values.size()| integers, checking the length of the buffer once
+  // rather than once per integer.
+  bool ReadU16Array(span<uint16_t> values);
+  bool ReadU32Array(span<uint32_t> values);
+  bool ReadU64Array(span<uint64_t> values);
+
+  // Reads a block of consecutive integers of any sizes, checking the length
+  // of the buffer once for all of them, e.g. for the fields of a header:
+  //   uint8_t type;
+  //   uint16_t flags;
+  //   uint32_t length;
+  //   if (!reader.ReadFields(&type, &flags, &length))
+  //     return false;
+  template <typename... T>
+  bool ReadFields(T*... values) {
+    if (internal::TotalSizeOf<T...>() > static_cast<size_t>(end_ - ptr_))
+      return false;
+    const char* ptr = ptr_;
+    (void)std::initializer_list<int>{
+        (ReadBigEndian(ptr, values), ptr += sizeof(T), 0)...};
+    ptr_ = ptr;
+    return true;
+  }
+
  private:
   // Hidden to promote type safety.
   template<typename T>
   bool Read(T* v);
+  template <typename T>
+  bool ReadArray(span<T> values);
 
   const char* ptr_;
   const char* end_;
@@ -92,10 +135,31 @@ class BASE_EXPORT BigEndianWriter {
   bool WriteU32(uint32_t value);
   bool WriteU64(uint64_t value);
 
+  // Write all the |values|, checking the length of the buffer once rather
+  // than once per integer.
+  bool WriteU16Array(span<const uint16_t> values);
+  bool WriteU32Array(span<const uint32_t> values);
+  bool WriteU64Array(span<const uint64_t> values);
+
+  // Writes a block of consecutive integers of any sizes, checking the length
+  // of the buffer once for all of them. See BigEndianReader::ReadFields().
+  template <typename... T>
+  bool WriteFields(T... values) {
+    if (internal::TotalSizeOf<T...>() > static_cast<size_t>(end_ - ptr_))
+      return false;
+    char* ptr = ptr_;
+    (void)std::initializer_list<int>{
+        (WriteBigEndian(ptr, values), ptr += sizeof(T), 0)...};
+    ptr_ = ptr;
+    return true;
+  }
+
  private:
   // Hidden to promote type safety.
   template<typename T>
   bool Write(T v);
+  template <typename T>
+  bool WriteArray(span<const T> values);
 
   char* ptr_;
   char* end_;
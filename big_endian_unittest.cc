@@ -70,6 +70,58 @@ TEST(BigEndianReaderTest, RespectsLength) {
   EXPECT_EQ(0, reader.remaining());
 }
 
+TEST(BigEndianReaderTest, ReadsArrays) {
+  char data[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0xA, 0xB, 0xC, 0xD,
+                 0xE, 0xF, 0x1A, 0x2B, 0x3C, 0x4D, 0x5E, 0x6F};
+  uint16_t u16[3];
+  uint32_t u32[2];
+  uint64_t u64[1];
+  BigEndianReader reader(data, sizeof(data));
+
+  EXPECT_TRUE(reader.ReadU16Array(u16));
+  EXPECT_EQ(0x0001, u16[0]);
+  EXPECT_EQ(0x0203, u16[1]);
+  EXPECT_EQ(0x0405, u16[2]);
+  EXPECT_TRUE(reader.ReadU32Array(u32));
+  EXPECT_EQ(0x06070809u, u32[0]);
+  EXPECT_EQ(0x0A0B0C0Du, u32[1]);
+  EXPECT_TRUE(reader.ReadU64Array(u64));
+  EXPECT_EQ(0x0E0F1A2B3C4D5E6Fllu, u64[0]);
+  EXPECT_EQ(0, reader.remaining());
+  EXPECT_TRUE(reader.ReadU32Array(span<uint32_t>()));
+}
+
+TEST(BigEndianReaderTest, ReadsFields) {
+  char data[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  uint8_t u8;
+  uint16_t u16;
+  uint32_t u32;
+  BigEndianReader reader(data, sizeof(data));
+
+  EXPECT_TRUE(reader.ReadFields(&u8, &u16, &u32));
+  EXPECT_EQ(0x01, u8);
+  EXPECT_EQ(0x0203, u16);
+  EXPECT_EQ(0x04050607u, u32);
+  EXPECT_EQ(1, reader.remaining());
+  // Nothing is read unless all the fields fit.
+  EXPECT_FALSE(reader.ReadFields(&u8, &u8));
+  EXPECT_EQ(1, reader.remaining());
+  EXPECT_EQ(0x01, u8);
+}
+
+TEST(BigEndianReaderTest, ArraysRespectLength) {
+  char data[7];
+  uint16_t u16[4];
+  uint32_t u32[2];
+  BigEndianReader reader(data, sizeof(data));
+
+  EXPECT_FALSE(reader.ReadU16Array(u16));
+  EXPECT_FALSE(reader.ReadU32Array(u32));
+  EXPECT_EQ(7, reader.remaining());
+  EXPECT_TRUE(reader.ReadU16Array(make_span(u16, 3)));
+  EXPECT_EQ(1, reader.remaining());
+}
+
 TEST(BigEndianWriterTest, WritesValues) {
   char expected[] = { 0, 0, 2, 3, 4, 5, 6, 7, 8, 9, 0xA, 0xB, 0xC, 0xD, 0xE,
                       0xF, 0x1A, 0x2B, 0x3C };
@@ -113,4 +165,24 @@ TEST(BigEndianWriterTest, RespectsLength) {
   EXPECT_EQ(0, writer.remaining());
 }
 
+TEST(BigEndianWriterTest, WritesArraysAndFields) {
+  char expected[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0xA, 0xB, 0xC, 0xD,
+                     0xE, 0xF, 0x1A, 0x2B, 0x3C, 0x4D, 0x5E, 0x6F, 0x70,
+                     0x71, 0x72};
+  char data[sizeof(expected)];
+  const uint16_t u16[] = {0x0001, 0x0203, 0x0405};
+  const uint32_t u32[] = {0x06070809, 0x0A0B0C0D};
+  const uint64_t u64[] = {0x0E0F1A2B3C4D5E6Fllu};
+  BigEndianWriter writer(data, sizeof(data));
+
+  EXPECT_TRUE(writer.WriteU16Array(u16));
+  EXPECT_TRUE(writer.WriteU32Array(u32));
+  EXPECT_TRUE(writer.WriteU64Array(u64));
+  EXPECT_FALSE(writer.WriteFields(uint16_t{0x7071}, uint16_t{0x7273}));
+  EXPECT_TRUE(writer.WriteFields(uint8_t{0x70}, uint16_t{0x7172}));
+  EXPECT_EQ(0, writer.remaining());
+  EXPECT_EQ(0, memcmp(expected, data, sizeof(expected)));
+  EXPECT_FALSE(writer.WriteU16Array(u16));
+}
+
 }  // namespace base
@@ -0,0 +1,58 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/binary_file_value_serializer.h"
+
+#include "base/binary_value_serializer.h"
+#include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/numerics/safe_conversions.h"
+
+namespace base {
+
+BinaryFileValueSerializer::BinaryFileValueSerializer(const FilePath& file_path)
+    : file_path_(file_path) {}
+
+BinaryFileValueSerializer::~BinaryFileValueSerializer() = default;
+
+bool BinaryFileValueSerializer::Serialize(const Value& root) {
+  std::string data;
+  BinaryValueSerializer serializer(&data);
+  serializer.set_use_string_dictionary(use_string_dictionary_);
+  if (!serializer.Serialize(root) ||
+      !IsValueInRangeForNumericType<int>(data.size())) {
+    return false;
+  }
+
+  const int data_size = static_cast<int>(data.size());
+  return WriteFile(file_path_, data.data(), data_size) == data_size;
+}
+
+BinaryFileValueDeserializer::BinaryFileValueDeserializer(
+    const FilePath& file_path)
+    : file_path_(file_path) {}
+
+BinaryFileValueDeserializer::~BinaryFileValueDeserializer() = default;
+
+std::unique_ptr<Value> BinaryFileValueDeserializer::Deserialize(
+    int* error_code,
+    std::string* error_message) {
+  MemoryMappedFile file;
+  if (!file.Initialize(file_path_)) {
+    const int error = PathExists(file_path_)
+                          ? BinaryValueDeserializer::BINARY_VALUE_CANNOT_READ_FILE
+                          : BinaryValueDeserializer::BINARY_VALUE_NO_SUCH_FILE;
+    if (error_code)
+      *error_code = error;
+    if (error_message)
+      *error_message = BinaryValueDeserializer::GetErrorMessageForCode(error);
+    return nullptr;
+  }
+
+  BinaryValueDeserializer deserializer(StringPiece(
+      reinterpret_cast<const char*>(file.data()), file.length()));
+  return deserializer.Deserialize(error_code, error_message);
+}
+
+}  // namespace base
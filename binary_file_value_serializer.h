@@ -0,0 +1,65 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_BINARY_FILE_VALUE_SERIALIZER_H_
+#define BASE_BINARY_FILE_VALUE_SERIALIZER_H_
+
+#include <memory>
+#include <string>
+
+#include "base/base_export.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/values.h"
+
+namespace base {
+
+// Counterparts of JSONFileValueSerializer and JSONFileValueDeserializer for
+// the format of BinaryValueSerializer, which can be swapped in for them.
+class BASE_EXPORT BinaryFileValueSerializer : public ValueSerializer {
+ public:
+  // |file_path| is the path of a file that will be the destination of the
+  // serialization. The serializer will attempt to create the file at the
+  // specified location.
+  explicit BinaryFileValueSerializer(const FilePath& file_path);
+  ~BinaryFileValueSerializer() override;
+
+  // See BinaryValueSerializer.
+  void set_use_string_dictionary(bool use_string_dictionary) {
+    use_string_dictionary_ = use_string_dictionary;
+  }
+
+  // ValueSerializer:
+  bool Serialize(const Value& root) override;
+
+ private:
+  const FilePath file_path_;
+  bool use_string_dictionary_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryFileValueSerializer);
+};
+
+class BASE_EXPORT BinaryFileValueDeserializer : public ValueDeserializer {
+ public:
+  // |file_path| is the path of a file that will be the source of the
+  // deserialization.
+  explicit BinaryFileValueDeserializer(const FilePath& file_path);
+  ~BinaryFileValueDeserializer() override;
+
+  // ValueDeserializer:
+  // The file is memory-mapped and decoded in place rather than read into a
+  // string first. |error_code| is set to a
+  // BinaryValueDeserializer::BinaryValueError.
+  std::unique_ptr<Value> Deserialize(int* error_code,
+                                     std::string* error_message) override;
+
+ private:
+  const FilePath file_path_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryFileValueDeserializer);
+};
+
+}  // namespace base
+
+#endif  // BASE_BINARY_FILE_VALUE_SERIALIZER_H_
@@ -0,0 +1,506 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/binary_value_serializer.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/optional.h"
+#include "base/strings/string_util.h"
+#include "base/sys_byteorder.h"
+
+namespace base {
+
+namespace {
+
+constexpr char kMagic[] = {'B', 'V', 'A', 'L'};
+constexpr uint8_t kVersion = 1;
+
+// Bits of the flags byte of the header.
+constexpr uint8_t kHasStringDictionary = 1 << 0;
+
+// The type bytes of the values.
+enum Tag : uint8_t {
+  kNullTag = 0,
+  kFalseTag = 1,
+  kTrueTag = 2,
+  kIntTag = 3,
+  kDoubleTag = 4,
+  kStringTag = 5,
+  // A string written as its index in the string dictionary.
+  kStringReferenceTag = 6,
+  kBinaryTag = 7,
+  kListTag = 8,
+  kDictTag = 9,
+};
+
+// Deeper input is rejected, so that reading doesn't overflow the stack.
+constexpr int kMaxDepth = 200;
+
+using StringIndices = std::unordered_map<StringPiece, size_t, StringPieceHash>;
+
+void AppendVarint(uint64_t value, std::string* output) {
+  while (value >= 0x80) {
+    output->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  output->push_back(static_cast<char>(value));
+}
+
+// Counts the uses of each string of |value|, keys included. |strings| lists
+// them in the order of their first use.
+void CountStrings(const Value& value,
+                  StringIndices* counts,
+                  std::vector<StringPiece>* strings) {
+  auto count_string = [counts, strings](StringPiece string) {
+    if (++(*counts)[string] == 1)
+      strings->push_back(string);
+  };
+  switch (value.type()) {
+    case Value::Type::STRING:
+      count_string(value.GetString());
+      break;
+    case Value::Type::LIST:
+      for (const Value& item : value.GetList())
+        CountStrings(item, counts, strings);
+      break;
+    case Value::Type::DICTIONARY:
+      for (const auto& member : value.DictItems()) {
+        count_string(member.first);
+        CountStrings(member.second, counts, strings);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+class Writer {
+ public:
+  // |dictionary| maps the strings of the string dictionary to their index.
+  Writer(const StringIndices& dictionary, std::string* output)
+      : dictionary_(dictionary), output_(output) {}
+
+  void WriteString(StringPiece string) {
+    auto it = dictionary_.find(string);
+    if (it != dictionary_.end()) {
+      output_->push_back(kStringReferenceTag);
+      AppendVarint(it->second, output_);
+      return;
+    }
+    output_->push_back(kStringTag);
+    AppendVarint(string.size(), output_);
+    string.AppendToString(output_);
+  }
+
+  void WriteValue(const Value& value) {
+    switch (value.type()) {
+      case Value::Type::NONE:
+        output_->push_back(kNullTag);
+        return;
+      case Value::Type::BOOLEAN:
+        output_->push_back(value.GetBool() ? kTrueTag : kFalseTag);
+        return;
+      case Value::Type::INTEGER: {
+        // Zigzag encoding keeps small negative numbers short.
+        const int64_t number = value.GetInt();
+        output_->push_back(kIntTag);
+        AppendVarint(
+            (static_cast<uint64_t>(number) << 1) ^
+                static_cast<uint64_t>(number >> 63),
+            output_);
+        return;
+      }
+      case Value::Type::DOUBLE: {
+        const double number = value.GetDouble();
+        uint64_t bits;
+        memcpy(&bits, &number, sizeof(bits));
+        bits = ByteSwapToLE64(bits);
+        output_->push_back(kDoubleTag);
+        output_->append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+        return;
+      }
+      case Value::Type::STRING:
+        WriteString(value.GetString());
+        return;
+      case Value::Type::BINARY: {
+        const Value::BlobStorage& blob = value.GetBlob();
+        output_->push_back(kBinaryTag);
+        AppendVarint(blob.size(), output_);
+        output_->append(blob.data(), blob.size());
+        return;
+      }
+      case Value::Type::LIST: {
+        const Value::ListStorage& list = value.GetList();
+        output_->push_back(kListTag);
+        AppendVarint(list.size(), output_);
+        for (const Value& item : list)
+          WriteValue(item);
+        return;
+      }
+      case Value::Type::DICTIONARY: {
+        const DictionaryValue* dict = nullptr;
+        value.GetAsDictionary(&dict);
+        output_->push_back(kDictTag);
+        AppendVarint(dict->size(), output_);
+        for (const auto& member : dict->DictItems()) {
+          WriteString(member.first);
+          WriteValue(member.second);
+        }
+        return;
+      }
+    }
+    NOTREACHED();
+  }
+
+ private:
+  const StringIndices& dictionary_;
+  std::string* const output_;
+
+  DISALLOW_COPY_AND_ASSIGN(Writer);
+};
+
+class Reader {
+ public:
+  explicit Reader(StringPiece data) : data_(data) {}
+
+  BinaryValueDeserializer::BinaryValueError error() const { return error_; }
+
+  Optional<Value> Read() {
+    if (!ReadHeader())
+      return nullopt;
+    Optional<Value> root = ReadValue(0);
+    if (root && pos_ != data_.size()) {
+      error_ = BinaryValueDeserializer::BINARY_VALUE_UNEXPECTED_DATA_AFTER_ROOT;
+      return nullopt;
+    }
+    return root;
+  }
+
+ private:
+  bool ReadHeader() {
+    if (data_.size() < sizeof(kMagic) + 2 ||
+        memcmp(data_.data(), kMagic, sizeof(kMagic)) != 0 ||
+        data_[sizeof(kMagic)] != kVersion) {
+      error_ = BinaryValueDeserializer::BINARY_VALUE_BAD_HEADER;
+      return false;
+    }
+    const uint8_t flags = data_[sizeof(kMagic) + 1];
+    pos_ = sizeof(kMagic) + 2;
+    if (!(flags & kHasStringDictionary))
+      return true;
+
+    uint64_t count;
+    if (!ReadVarint(&count))
+      return false;
+    // Each string takes at least a byte.
+    dictionary_.reserve(std::min<uint64_t>(count, data_.size() - pos_));
+    for (uint64_t i = 0; i < count; ++i) {
+      StringPiece string;
+      if (!ReadBytes(&string))
+        return false;
+      if (!IsStringUTF8(string)) {
+        error_ = BinaryValueDeserializer::BINARY_VALUE_INVALID_STRING;
+        return false;
+      }
+      dictionary_.push_back(string);
+    }
+    return true;
+  }
+
+  bool ReadVarint(uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ == data_.size()) {
+        error_ = BinaryValueDeserializer::BINARY_VALUE_TRUNCATED;
+        return false;
+      }
+      const uint8_t byte = data_[pos_++];
+      *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    error_ = BinaryValueDeserializer::BINARY_VALUE_INVALID_NUMBER;
+    return false;
+  }
+
+  // Reads a varint length followed by that many bytes, which |bytes| points
+  // to in place.
+  bool ReadBytes(StringPiece* bytes) {
+    uint64_t length;
+    if (!ReadVarint(&length))
+      return false;
+    if (length > data_.size() - pos_) {
+      error_ = BinaryValueDeserializer::BINARY_VALUE_TRUNCATED;
+      return false;
+    }
+    *bytes = data_.substr(pos_, length);
+    pos_ += length;
+    return true;
+  }
+
+  // Reads the payload of a string whose type byte |tag| was read.
+  bool ReadString(uint8_t tag, StringPiece* string) {
+    if (tag == kStringTag) {
+      if (!ReadBytes(string))
+        return false;
+      if (!IsStringUTF8(*string)) {
+        error_ = BinaryValueDeserializer::BINARY_VALUE_INVALID_STRING;
+        return false;
+      }
+      return true;
+    }
+    DCHECK_EQ(kStringReferenceTag, tag);
+    uint64_t index;
+    if (!ReadVarint(&index))
+      return false;
+    if (index >= dictionary_.size()) {
+      error_ = BinaryValueDeserializer::BINARY_VALUE_INVALID_STRING;
+      return false;
+    }
+    *string = dictionary_[index];
+    return true;
+  }
+
+  bool ReadTag(uint8_t* tag) {
+    if (pos_ == data_.size()) {
+      error_ = BinaryValueDeserializer::BINARY_VALUE_TRUNCATED;
+      return false;
+    }
+    *tag = data_[pos_++];
+    return true;
+  }
+
+  // Reads a count of items, which each take at least |min_item_size| bytes.
+  bool ReadCount(size_t min_item_size, size_t* count) {
+    uint64_t value;
+    if (!ReadVarint(&value))
+      return false;
+    if (value > (data_.size() - pos_) / min_item_size) {
+      error_ = BinaryValueDeserializer::BINARY_VALUE_TRUNCATED;
+      return false;
+    }
+    *count = static_cast<size_t>(value);
+    return true;
+  }
+
+  Optional<Value> ReadValue(int depth) {
+    uint8_t tag;
+    if (!ReadTag(&tag))
+      return nullopt;
+
+    switch (tag) {
+      case kNullTag:
+        return Value();
+      case kFalseTag:
+        return Value(false);
+      case kTrueTag:
+        return Value(true);
+      case kIntTag: {
+        uint64_t zigzag;
+        if (!ReadVarint(&zigzag))
+          return nullopt;
+        const int64_t number =
+            static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        if (number < std::numeric_limits<int>::min() ||
+            number > std::numeric_limits<int>::max()) {
+          error_ = BinaryValueDeserializer::BINARY_VALUE_INVALID_NUMBER;
+          return nullopt;
+        }
+        return Value(static_cast<int>(number));
+      }
+      case kDoubleTag: {
+        uint64_t bits;
+        if (data_.size() - pos_ < sizeof(bits)) {
+          error_ = BinaryValueDeserializer::BINARY_VALUE_TRUNCATED;
+          return nullopt;
+        }
+        memcpy(&bits, data_.data() + pos_, sizeof(bits));
+        pos_ += sizeof(bits);
+        // Swapping to little-endian and back is the same operation.
+        bits = ByteSwapToLE64(bits);
+        double number;
+        memcpy(&number, &bits, sizeof(number));
+        if (!std::isfinite(number)) {
+          error_ = BinaryValueDeserializer::BINARY_VALUE_INVALID_NUMBER;
+          return nullopt;
+        }
+        return Value(number);
+      }
+      case kStringTag:
+      case kStringReferenceTag: {
+        StringPiece string;
+        if (!ReadString(tag, &string))
+          return nullopt;
+        return Value(string);
+      }
+      case kBinaryTag: {
+        StringPiece bytes;
+        if (!ReadBytes(&bytes))
+          return nullopt;
+        return Value(Value::BlobStorage(bytes.begin(), bytes.end()));
+      }
+      case kListTag:
+      case kDictTag:
+        break;
+      default:
+        error_ = BinaryValueDeserializer::BINARY_VALUE_INVALID_TYPE;
+        return nullopt;
+    }
+
+    if (depth >= kMaxDepth) {
+      error_ = BinaryValueDeserializer::BINARY_VALUE_TOO_MUCH_NESTING;
+      return nullopt;
+    }
+
+    if (tag == kListTag) {
+      size_t count;
+      if (!ReadCount(1, &count))
+        return nullopt;
+      Value::ListStorage list;
+      list.reserve(count);
+      for (size_t i = 0; i < count; ++i) {
+        Optional<Value> item = ReadValue(depth + 1);
+        if (!item)
+          return nullopt;
+        list.push_back(std::move(*item));
+      }
+      return Value(std::move(list));
+    }
+
+    // Each member has a key and a value, of at least a byte each.
+    size_t count;
+    if (!ReadCount(2, &count))
+      return nullopt;
+    std::vector<Value::DictStorage::value_type> members;
+    members.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      uint8_t key_tag;
+      if (!ReadTag(&key_tag))
+        return nullopt;
+      if (key_tag != kStringTag && key_tag != kStringReferenceTag) {
+        error_ = BinaryValueDeserializer::BINARY_VALUE_INVALID_TYPE;
+        return nullopt;
+      }
+      StringPiece key;
+      if (!ReadString(key_tag, &key))
+        return nullopt;
+      Optional<Value> value = ReadValue(depth + 1);
+      if (!value)
+        return nullopt;
+      members.emplace_back(key.as_string(),
+                           std::make_unique<Value>(std::move(*value)));
+    }
+    return Value(Value::DictStorage(std::move(members), KEEP_LAST_OF_DUPES));
+  }
+
+  const StringPiece data_;
+  size_t pos_ = 0;
+  std::vector<StringPiece> dictionary_;
+  BinaryValueDeserializer::BinaryValueError error_ =
+      BinaryValueDeserializer::BINARY_VALUE_NO_ERROR;
+
+  DISALLOW_COPY_AND_ASSIGN(Reader);
+};
+
+}  // namespace
+
+BinaryValueSerializer::BinaryValueSerializer(std::string* output)
+    : output_(output) {
+  DCHECK(output);
+}
+
+BinaryValueSerializer::~BinaryValueSerializer() = default;
+
+bool BinaryValueSerializer::Serialize(const Value& root) {
+  output_->assign(kMagic, sizeof(kMagic));
+  output_->push_back(kVersion);
+
+  StringIndices dictionary;
+  if (use_string_dictionary_) {
+    StringIndices counts;
+    std::vector<StringPiece> strings;
+    CountStrings(root, &counts, &strings);
+    for (StringPiece string : strings) {
+      // A string of 1 byte would take as much space as its reference.
+      if (counts[string] > 1 && string.size() > 1)
+        dictionary.emplace(string, dictionary.size());
+    }
+  }
+
+  output_->push_back(dictionary.empty() ? 0 : kHasStringDictionary);
+  if (!dictionary.empty()) {
+    std::vector<StringPiece> strings(dictionary.size());
+    for (const auto& entry : dictionary)
+      strings[entry.second] = entry.first;
+    AppendVarint(strings.size(), output_);
+    for (StringPiece string : strings) {
+      AppendVarint(string.size(), output_);
+      string.AppendToString(output_);
+    }
+  }
+
+  Writer(dictionary, output_).WriteValue(root);
+  return true;
+}
+
+BinaryValueDeserializer::BinaryValueDeserializer(StringPiece data)
+    : data_(data) {}
+
+BinaryValueDeserializer::~BinaryValueDeserializer() = default;
+
+// static
+const char* BinaryValueDeserializer::GetErrorMessageForCode(int error_code) {
+  switch (error_code) {
+    case BINARY_VALUE_NO_ERROR:
+      return "";
+    case BINARY_VALUE_BAD_HEADER:
+      return "Not a binary value, or of an unsupported version.";
+    case BINARY_VALUE_TRUNCATED:
+      return "Unexpected end of data.";
+    case BINARY_VALUE_INVALID_TYPE:
+      return "Invalid value type.";
+    case BINARY_VALUE_INVALID_NUMBER:
+      return "Invalid number.";
+    case BINARY_VALUE_INVALID_STRING:
+      return "Invalid string.";
+    case BINARY_VALUE_TOO_MUCH_NESTING:
+      return "Too much nesting.";
+    case BINARY_VALUE_UNEXPECTED_DATA_AFTER_ROOT:
+      return "Trailing data after the root value.";
+    case BINARY_VALUE_NO_SUCH_FILE:
+      return "File doesn't exist.";
+    case BINARY_VALUE_CANNOT_READ_FILE:
+      return "Can't read file.";
+    default:
+      NOTREACHED();
+      return "";
+  }
+}
+
+std::unique_ptr<Value> BinaryValueDeserializer::Deserialize(
+    int* error_code,
+    std::string* error_message) {
+  Reader reader(data_);
+  Optional<Value> root = reader.Read();
+  if (!root) {
+    if (error_code)
+      *error_code = reader.error();
+    if (error_message)
+      *error_message = GetErrorMessageForCode(reader.error());
+    return nullptr;
+  }
+  return std::make_unique<Value>(std::move(*root));
+}
+
+}  // namespace base
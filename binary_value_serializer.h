@@ -0,0 +1,97 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_BINARY_VALUE_SERIALIZER_H_
+#define BASE_BINARY_VALUE_SERIALIZER_H_
+
+#include <memory>
+#include <string>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+
+namespace base {
+
+// Serializes Values in a compact binary format, which is much faster to write
+// and read than JSON. Unlike JSON, binary values are supported.
+//
+// The output starts with the 4 bytes "BVAL", a version byte and a flags byte.
+// Each value then starts with a type byte, followed by:
+//  - nothing for null, false and true.
+//  - A zigzag varint for integers.
+//  - The 8 bytes of the IEEE 754 representation for doubles, little-endian.
+//  - A varint length and the bytes for strings and binary values.
+//  - A varint count and the items for lists.
+//  - A varint count and the members for dictionaries, each a string key
+//    followed by the value.
+// Varints use the LEB128 encoding of protocol buffers.
+//
+// With a string dictionary, the strings used more than once are written in a
+// table after the header, a varint count and each string, and referred to by
+// their varint index in the table elsewhere. This shrinks dictionaries of the
+// same shape, e.g. in lists, since their keys are written only once.
+class BASE_EXPORT BinaryValueSerializer : public ValueSerializer {
+ public:
+  // |output| is the string that will be the destination of the serialization.
+  // It's owned by the caller and must not be null.
+  explicit BinaryValueSerializer(std::string* output);
+  ~BinaryValueSerializer() override;
+
+  void set_use_string_dictionary(bool use_string_dictionary) {
+    use_string_dictionary_ = use_string_dictionary;
+  }
+
+  // ValueSerializer:
+  bool Serialize(const Value& root) override;
+
+ private:
+  // Owned by the caller of the constructor.
+  std::string* const output_;
+  bool use_string_dictionary_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryValueSerializer);
+};
+
+class BASE_EXPORT BinaryValueDeserializer : public ValueDeserializer {
+ public:
+  // Error codes, which don't overlap with JSONReader::JsonParseError.
+  enum BinaryValueError {
+    BINARY_VALUE_NO_ERROR = 0,
+    BINARY_VALUE_BAD_HEADER = 2000,
+    BINARY_VALUE_TRUNCATED,
+    BINARY_VALUE_INVALID_TYPE,
+    BINARY_VALUE_INVALID_NUMBER,
+    BINARY_VALUE_INVALID_STRING,
+    BINARY_VALUE_TOO_MUCH_NESTING,
+    BINARY_VALUE_UNEXPECTED_DATA_AFTER_ROOT,
+    // Reported by BinaryFileValueDeserializer.
+    BINARY_VALUE_NO_SUCH_FILE,
+    BINARY_VALUE_CANNOT_READ_FILE,
+  };
+
+  // This retains a reference to |data|, which must outlive the deserializer.
+  // It's read in place, so a MemoryMappedFile can be decoded without copying
+  // it first.
+  explicit BinaryValueDeserializer(StringPiece data);
+  ~BinaryValueDeserializer() override;
+
+  // Converts an error code into an error message.
+  static const char* GetErrorMessageForCode(int error_code);
+
+  // ValueDeserializer:
+  std::unique_ptr<Value> Deserialize(int* error_code,
+                                     std::string* error_message) override;
+
+ private:
+  // Data is owned by the caller of the constructor.
+  const StringPiece data_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryValueDeserializer);
+};
+
+}  // namespace base
+
+#endif  // BASE_BINARY_VALUE_SERIALIZER_H_
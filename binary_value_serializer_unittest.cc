@@ -0,0 +1,149 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/binary_value_serializer.h"
+
+#include <limits>
+
+#include "base/binary_file_value_serializer.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+Value CreateTestValue() {
+  Value dict(Value::Type::DICTIONARY);
+  dict.SetKey("null", Value());
+  dict.SetKey("bool", Value(true));
+  dict.SetKey("int", Value(-42));
+  dict.SetKey("int_min", Value(std::numeric_limits<int>::min()));
+  dict.SetKey("int_max", Value(std::numeric_limits<int>::max()));
+  dict.SetKey("double", Value(-3.25));
+  dict.SetKey("string", Value("h\xC3\xA9llo"));
+  dict.SetKey("binary", Value(Value::BlobStorage{'\0', '\xFF', 'a'}));
+  Value list(Value::Type::LIST);
+  list.GetList().emplace_back(1);
+  list.GetList().emplace_back("string");
+  list.GetList().emplace_back(Value::Type::DICTIONARY);
+  list.GetList().emplace_back(Value::Type::LIST);
+  dict.SetKey("list", std::move(list));
+  return dict;
+}
+
+std::string Serialize(const Value& value, bool use_string_dictionary) {
+  std::string output;
+  BinaryValueSerializer serializer(&output);
+  serializer.set_use_string_dictionary(use_string_dictionary);
+  EXPECT_TRUE(serializer.Serialize(value));
+  return output;
+}
+
+int DeserializeError(StringPiece data) {
+  BinaryValueDeserializer deserializer(data);
+  int error_code = BinaryValueDeserializer::BINARY_VALUE_NO_ERROR;
+  std::string error_message;
+  EXPECT_FALSE(deserializer.Deserialize(&error_code, &error_message));
+  EXPECT_FALSE(error_message.empty());
+  return error_code;
+}
+
+}  // namespace
+
+TEST(BinaryValueSerializerTest, RoundTrip) {
+  const Value value = CreateTestValue();
+  for (bool use_string_dictionary : {false, true}) {
+    const std::string data = Serialize(value, use_string_dictionary);
+    BinaryValueDeserializer deserializer(data);
+    std::unique_ptr<Value> result = deserializer.Deserialize(nullptr, nullptr);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(value, *result);
+  }
+}
+
+TEST(BinaryValueSerializerTest, StringDictionary) {
+  Value list(Value::Type::LIST);
+  for (int i = 0; i < 100; ++i) {
+    Value dict(Value::Type::DICTIONARY);
+    dict.SetKey("identifier", Value(i));
+    dict.SetKey("description", Value("repeated description"));
+    dict.SetKey("name", Value(IntToString(i)));
+    list.GetList().push_back(std::move(dict));
+  }
+
+  const std::string data = Serialize(list, false);
+  const std::string data_with_dictionary = Serialize(list, true);
+  EXPECT_LT(data_with_dictionary.size() * 2, data.size());
+
+  BinaryValueDeserializer deserializer(data_with_dictionary);
+  std::unique_ptr<Value> result = deserializer.Deserialize(nullptr, nullptr);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(list, *result);
+}
+
+TEST(BinaryValueSerializerTest, Errors) {
+  const std::string data = Serialize(CreateTestValue(), true);
+
+  EXPECT_EQ(BinaryValueDeserializer::BINARY_VALUE_BAD_HEADER,
+            DeserializeError(""));
+  EXPECT_EQ(BinaryValueDeserializer::BINARY_VALUE_BAD_HEADER,
+            DeserializeError("{\"a\": 1}"));
+  std::string wrong_version = data;
+  wrong_version[4] = 2;
+  EXPECT_EQ(BinaryValueDeserializer::BINARY_VALUE_BAD_HEADER,
+            DeserializeError(wrong_version));
+
+  // Every prefix of the data is rejected.
+  for (size_t size = 6; size < data.size(); ++size) {
+    EXPECT_NE(BinaryValueDeserializer::BINARY_VALUE_NO_ERROR,
+              DeserializeError(StringPiece(data).substr(0, size)));
+  }
+
+  EXPECT_EQ(BinaryValueDeserializer::BINARY_VALUE_UNEXPECTED_DATA_AFTER_ROOT,
+            DeserializeError(data + '\0'));
+
+  const std::string header("BVAL\x01\x00", 6);
+  EXPECT_EQ(BinaryValueDeserializer::BINARY_VALUE_INVALID_TYPE,
+            DeserializeError(header + "\x20"));
+  // A dictionary with a key which isn't a string.
+  EXPECT_EQ(BinaryValueDeserializer::BINARY_VALUE_INVALID_TYPE,
+            DeserializeError(header + "\x09\x01\x03\x02"));
+  // An integer which doesn't fit in an int.
+  EXPECT_EQ(BinaryValueDeserializer::BINARY_VALUE_INVALID_NUMBER,
+            DeserializeError(header + "\x03\x80\x80\x80\x80\x10"));
+  // Invalid UTF-8.
+  EXPECT_EQ(BinaryValueDeserializer::BINARY_VALUE_INVALID_STRING,
+            DeserializeError(header + "\x05\x01\xFF"));
+  // A reference to a string, without a string dictionary.
+  EXPECT_EQ(BinaryValueDeserializer::BINARY_VALUE_INVALID_STRING,
+            DeserializeError(header + std::string("\x06\x00", 2)));
+  EXPECT_EQ(BinaryValueDeserializer::BINARY_VALUE_TOO_MUCH_NESTING,
+            DeserializeError(header + std::string(1000, '\x08') + '\x00'));
+}
+
+TEST(BinaryValueSerializerTest, File) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const FilePath path = temp_dir.GetPath().AppendASCII("value");
+  const Value value = CreateTestValue();
+
+  BinaryFileValueSerializer serializer(path);
+  serializer.set_use_string_dictionary(true);
+  ASSERT_TRUE(serializer.Serialize(value));
+
+  BinaryFileValueDeserializer deserializer(path);
+  std::unique_ptr<Value> result = deserializer.Deserialize(nullptr, nullptr);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(value, *result);
+
+  BinaryFileValueDeserializer missing_deserializer(
+      temp_dir.GetPath().AppendASCII("missing"));
+  int error_code = BinaryValueDeserializer::BINARY_VALUE_NO_ERROR;
+  EXPECT_FALSE(missing_deserializer.Deserialize(&error_code, nullptr));
+  EXPECT_EQ(BinaryValueDeserializer::BINARY_VALUE_NO_SUCH_FILE, error_code);
+}
+
+}  // namespace base
@@ -210,10 +210,10 @@ BindOnce(Functor&& functor, Args&&... args) {
   PolymorphicInvoke invoke_func = &Invoker::RunOnce;
 
   using InvokeFuncStorage = internal::BindStateBase::InvokeFuncStorage;
-  return CallbackType(new BindState(
-      reinterpret_cast<InvokeFuncStorage>(invoke_func),
-      std::forward<Functor>(functor),
-      std::forward<Args>(args)...));
+  return CallbackType(internal::EmplaceBindState<BindState>(),
+                      reinterpret_cast<InvokeFuncStorage>(invoke_func),
+                      std::forward<Functor>(functor),
+                      std::forward<Args>(args)...);
 }
 
 // Bind as RepeatingCallback.
@@ -12,6 +12,7 @@
 
 #include "base/callback_internal.h"
 #include "base/memory/raw_scoped_refptr_mismatch_checker.h"
+#include "base/memory/sequence_local_weak_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/template_util.h"
 #include "build/build_config.h"
@@ -697,6 +698,10 @@ struct BindState final : BindStateBase {
       CallbackCancellationTraits<Functor,
                                  std::tuple<BoundArgs...>>::is_cancellable>;
 
+  // The types of the members below, which must be move constructible for the
+  // BindState to be stored inline in a OnceCallback.
+  using StoredTypes = std::tuple<Functor, BoundArgs...>;
+
   template <typename ForwardFunctor, typename... ForwardBoundArgs>
   explicit BindState(BindStateBase::InvokeFuncStorage invoke_func,
                      ForwardFunctor&& functor,
@@ -705,21 +710,40 @@ struct BindState final : BindStateBase {
       // CallbackCancellationTraits<>::IsCancelled returns always false.
       // Otherwise, it's std::true_type.
       : BindState(IsCancellable{},
+                  &Destroy,
+                  invoke_func,
+                  std::forward<ForwardFunctor>(functor),
+                  std::forward<ForwardBoundArgs>(bound_args)...) {}
+
+  // Constructs a BindState in a OnceCallback's inline storage.
+  template <typename ForwardFunctor, typename... ForwardBoundArgs>
+  BindState(InlineBindStateTag,
+            BindStateBase::InvokeFuncStorage invoke_func,
+            ForwardFunctor&& functor,
+            ForwardBoundArgs&&... bound_args)
+      : BindState(IsCancellable{},
+                  &DestroyInPlace,
                   invoke_func,
                   std::forward<ForwardFunctor>(functor),
                   std::forward<ForwardBoundArgs>(bound_args)...) {}
 
+  // Move-constructs an inline BindState in |to|.
+  static void MoveInline(BindStateBase* self, void* to) {
+    new (to) BindState(std::move(*static_cast<BindState*>(self)));
+  }
+
   Functor functor_;
   std::tuple<BoundArgs...> bound_args_;
 
  private:
   template <typename ForwardFunctor, typename... ForwardBoundArgs>
   explicit BindState(std::true_type,
+                     void (*destructor)(const BindStateBase*),
                      BindStateBase::InvokeFuncStorage invoke_func,
                      ForwardFunctor&& functor,
                      ForwardBoundArgs&&... bound_args)
       : BindStateBase(invoke_func,
-                      &Destroy,
+                      destructor,
                       &ApplyCancellationTraits<BindState>),
         functor_(std::forward<ForwardFunctor>(functor)),
         bound_args_(std::forward<ForwardBoundArgs>(bound_args)...) {
@@ -728,20 +752,33 @@ struct BindState final : BindStateBase {
 
   template <typename ForwardFunctor, typename... ForwardBoundArgs>
   explicit BindState(std::false_type,
+                     void (*destructor)(const BindStateBase*),
                      BindStateBase::InvokeFuncStorage invoke_func,
                      ForwardFunctor&& functor,
                      ForwardBoundArgs&&... bound_args)
-      : BindStateBase(invoke_func, &Destroy),
+      : BindStateBase(invoke_func, destructor),
         functor_(std::forward<ForwardFunctor>(functor)),
         bound_args_(std::forward<ForwardBoundArgs>(bound_args)...) {
     DCHECK(!IsNull(functor_));
   }
 
+  // Only used by MoveInline().
+  BindState(BindState&& other)
+      : BindStateBase(other.polymorphic_invoke_,
+                      other.destructor_,
+                      other.is_cancelled_),
+        functor_(std::move(other.functor_)),
+        bound_args_(std::move(other.bound_args_)) {}
+
   ~BindState() = default;
 
   static void Destroy(const BindStateBase* self) {
     delete static_cast<const BindState*>(self);
   }
+
+  static void DestroyInPlace(const BindStateBase* self) {
+    static_cast<const BindState*>(self)->~BindState();
+  }
 };
 
 // Used to implement MakeBindStateType.
@@ -813,6 +850,9 @@ struct IsWeakReceiver<internal::ConstRefWrapper<T>> : IsWeakReceiver<T> {};
 template <typename T>
 struct IsWeakReceiver<WeakPtr<T>> : std::true_type {};
 
+template <typename T>
+struct IsWeakReceiver<SequenceLocalWeakPtr<T>> : std::true_type {};
+
 // An injection point to control how bound objects passed to the target
 // function. BindUnwrapTraits<>::Unwrap() is called for each bound objects right
 // before the target function is invoked.
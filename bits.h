@@ -9,8 +9,10 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "base/compiler_specific.h"
+#include "base/containers/span.h"
 #include "base/logging.h"
 #include "build/build_config.h"
 
@@ -165,6 +167,34 @@ inline int Log2Ceiling(uint32_t n) {
   return (n ? 32 : -1) - CountLeadingZeroBits(n - 1);
 }
 
+namespace internal {
+
+// Counts the bits set in |x| with the classic bit-twiddling, rather than
+// __builtin_popcountll(), which is a library call when the popcnt instruction
+// may be missing. Unlike the call, this vectorizes in a loop.
+ALWAYS_INLINE uint64_t CountOneBits64(uint64_t x) {
+  x = x - ((x >> 1) & 0x5555555555555555ull);
+  x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+  return (x * 0x0101010101010101ull) >> 56;
+}
+
+}  // namespace internal
+
+// Returns the number of bits set in |bytes|, e.g. in a bitmap.
+inline size_t CountOneBits(span<const uint8_t> bytes) {
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= bytes.size(); i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bytes.data() + i, sizeof(word));
+    count += internal::CountOneBits64(word);
+  }
+  for (; i < bytes.size(); ++i)
+    count += internal::CountOneBits64(bytes[i]);
+  return count;
+}
+
 }  // namespace bits
 }  // namespace base
 
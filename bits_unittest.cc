@@ -11,6 +11,7 @@
 
 #include <limits>
 
+#include "base/macros.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -170,5 +171,23 @@ TEST(BitsTest, CountTrailingZeroBitsSizeT) {
 #endif  // ARCH_CPU_64_BITS
 }
 
+TEST(BitsTest, CountOneBits) {
+  EXPECT_EQ(0u, CountOneBits(span<const uint8_t>()));
+
+  // Longer than a word, with a tail.
+  uint8_t bytes[11] = {0xFF, 0x01, 0x80, 0x00, 0x0F, 0xF0,
+                       0x55, 0xAA, 0x03, 0x11, 0x07};
+  EXPECT_EQ(8u + 1 + 1 + 0 + 4 + 4 + 4 + 4 + 2 + 2 + 3, CountOneBits(bytes));
+
+  size_t expected = 0;
+  uint8_t all_ones[37];
+  for (size_t i = 0; i < arraysize(all_ones); ++i) {
+    all_ones[i] = 0xFF;
+    expected += 8;
+  }
+  EXPECT_EQ(expected, CountOneBits(all_ones));
+  EXPECT_EQ(8u, CountOneBits(make_span(all_ones).subspan(3, 1)));
+}
+
 }  // namespace bits
 }  // namespace base
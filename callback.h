@@ -43,6 +43,11 @@
 // will be a no-op. Note that |is_cancelled()| and |is_null()| are distinct:
 // simply cancelling a callback will not also make it null.
 //
+// A base::OnceCallback stores small bound state inline, so that binding and
+// running one usually doesn't allocate; a base::RepeatingCallback always
+// shares its bound state by reference counting. This makes a OnceCallback
+// larger than a RepeatingCallback, and costlier to move.
+//
 // base::Callback is currently a type alias for base::RepeatingCallback. In the
 // future, we expect to flip this to default to base::OnceCallback.
 //
@@ -51,16 +56,23 @@
 namespace base {
 
 template <typename R, typename... Args>
-class OnceCallback<R(Args...)> : public internal::CallbackBase {
+class OnceCallback<R(Args...)> : public internal::OnceCallbackBase {
  public:
   using RunType = R(Args...);
   using PolymorphicInvoke = R (*)(internal::BindStateBase*,
                                   internal::PassingTraitsType<Args>...);
 
-  constexpr OnceCallback() = default;
+  OnceCallback() = default;
 
   explicit OnceCallback(internal::BindStateBase* bind_state)
-      : internal::CallbackBase(bind_state) {}
+      : internal::OnceCallbackBase(bind_state) {}
+
+  // Used by BindOnce() to construct a BindState, inline if it's small enough.
+  template <typename BindStateType, typename... BindStateArgs>
+  OnceCallback(internal::EmplaceBindState<BindStateType> emplace,
+               BindStateArgs&&... args)
+      : internal::OnceCallbackBase(emplace,
+                                   std::forward<BindStateArgs>(args)...) {}
 
   OnceCallback(const OnceCallback&) = delete;
   OnceCallback& operator=(const OnceCallback&) = delete;
@@ -69,10 +81,10 @@ class OnceCallback<R(Args...)> : public internal::CallbackBase {
   OnceCallback& operator=(OnceCallback&&) = default;
 
   OnceCallback(RepeatingCallback<RunType> other)
-      : internal::CallbackBase(std::move(other)) {}
+      : internal::OnceCallbackBase(std::move(other)) {}
 
   OnceCallback& operator=(RepeatingCallback<RunType> other) {
-    static_cast<internal::CallbackBase&>(*this) = std::move(other);
+    static_cast<internal::OnceCallbackBase&>(*this) = std::move(other);
     return *this;
   }
 
@@ -93,7 +105,7 @@ class OnceCallback<R(Args...)> : public internal::CallbackBase {
     OnceCallback cb = std::move(*this);
     PolymorphicInvoke f =
         reinterpret_cast<PolymorphicInvoke>(cb.polymorphic_invoke());
-    return f(cb.bind_state_.get(), std::forward<Args>(args)...);
+    return f(cb.bind_state(), std::forward<Args>(args)...);
   }
 };
 
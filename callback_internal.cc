@@ -4,6 +4,8 @@
 
 #include "base/callback_internal.h"
 
+#include <string.h>
+
 #include "base/logging.h"
 
 namespace base {
@@ -89,5 +91,71 @@ CallbackBaseCopyable& CallbackBaseCopyable::operator=(
 CallbackBaseCopyable& CallbackBaseCopyable::operator=(
     CallbackBaseCopyable&& c) = default;
 
+OnceCallbackBase& OnceCallbackBase::operator=(OnceCallbackBase&& c) {
+  if (this == &c)
+    return *this;
+  if (!is_null()) {
+    // Like Reset(), destroy the current BindState last, since it may be
+    // holding the last ref to whatever object owns us.
+    OnceCallbackBase old(std::move(*this));
+    return *this = std::move(c);
+  }
+  CallbackBase::operator=(std::move(c));
+  TakeInlineState(&c);
+  return *this;
+}
+
+OnceCallbackBase::OnceCallbackBase(CallbackBaseCopyable&& c)
+    : CallbackBase(std::move(c)) {}
+
+OnceCallbackBase& OnceCallbackBase::operator=(CallbackBaseCopyable&& c) {
+  OnceCallbackBase old(std::move(*this));
+  CallbackBase::operator=(std::move(c));
+  return *this;
+}
+
+bool OnceCallbackBase::IsCancelled() const {
+  DCHECK(!is_null());
+  return bind_state()->IsCancelled();
+}
+
+void OnceCallbackBase::Reset() {
+  // An inline BindState is moved out first, so that |this| isn't touched once
+  // the BindState is destroyed.
+  OnceCallbackBase old(std::move(*this));
+}
+
+bool OnceCallbackBase::EqualsInternal(const OnceCallbackBase& other) const {
+  // An inline BindState is only ever referred to by one callback.
+  return bind_state() == other.bind_state();
+}
+
+// static
+void OnceCallbackBase::RelocateTrivially(BindStateBase* from, void* to) {
+  memcpy(to, from, kOnceCallbackInlineSize);
+}
+
+void OnceCallbackBase::MoveInlineState(OnceCallbackBase* c) {
+  relocate_ = c->relocate_;
+  relocate_(c->inline_state(), inline_storage_);
+  c->DestroyInlineState();
+  c->relocate_ = nullptr;
+}
+
+void OnceCallbackBase::DestroyInlineState() {
+  DCHECK(relocate_);
+  if (relocate_ == &RelocateTrivially)
+    return;
+  BindStateBase* bind_state = inline_state();
+#if DCHECK_IS_ON()
+  // Go through Release() to satisfy RefCountedThreadSafe's check that it's
+  // only destroyed that way.
+  bind_state->Release();
+#else
+  // An inline BindState is never shared, so skip the atomic decrement.
+  bind_state->destructor_(bind_state);
+#endif
+}
+
 }  // namespace internal
 }  // namespace base
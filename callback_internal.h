@@ -8,10 +8,20 @@
 #ifndef BASE_CALLBACK_INTERNAL_H_
 #define BASE_CALLBACK_INTERNAL_H_
 
+#include <stddef.h>
+#include <string.h>
+
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
 #include "base/base_export.h"
 #include "base/callback_forward.h"
+#include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
+#include "base/template_util.h"
 
 namespace base {
 
@@ -21,6 +31,7 @@ namespace internal {
 
 class CallbackBase;
 class CallbackBaseCopyable;
+class OnceCallbackBase;
 
 class BindStateBase;
 
@@ -47,6 +58,46 @@ struct PassingTraits<T, true> {
 template <typename T>
 using PassingTraitsType = typename PassingTraits<T>::Type;
 
+// OnceCallbacks store BindStates up to this size inside the callback object,
+// rather than in a separate heap allocation. This fits a method bound to a
+// raw or weak receiver and a small argument, or a function or capture-less
+// lambda bound to a couple of pointers.
+constexpr size_t kOnceCallbackInlineSize = 8 * sizeof(void*);
+constexpr size_t kOnceCallbackInlineAlignment = alignof(void*);
+
+// Passed to BindState's constructor when it is stored inline in a
+// OnceCallback, rather than in its own heap allocation.
+struct InlineBindStateTag {};
+
+// Passed to OnceCallback's constructor to have it construct a BindStateType
+// from the other arguments, inline if it fits.
+template <typename BindStateType>
+struct EmplaceBindState {};
+
+template <typename BindStateType>
+struct CanStoreBindStateInline
+    : std::integral_constant<
+          bool,
+          sizeof(BindStateType) <= kOnceCallbackInlineSize &&
+              alignof(BindStateType) <= kOnceCallbackInlineAlignment &&
+              std::is_move_constructible<
+                  typename BindStateType::StoredTypes>::value> {};
+
+// Whether an inline BindState holding a tuple of StoredTypes can be moved by
+// copying its bytes, and then abandoned without running its destructor.
+template <typename StoredTypes>
+struct IsTriviallyRelocatable;
+
+template <>
+struct IsTriviallyRelocatable<std::tuple<>> : std::true_type {};
+
+template <typename T, typename... Ts>
+struct IsTriviallyRelocatable<std::tuple<T, Ts...>>
+    : std::integral_constant<
+          bool,
+          is_trivially_copyable<T>::value &&
+              IsTriviallyRelocatable<std::tuple<Ts...>>::value> {};
+
 // BindStateBase is used to provide an opaque handle that the Callback
 // class can use to represent a function object with bound arguments.  It
 // behaves as an existential type that is used by a corresponding
@@ -79,6 +130,7 @@ class BASE_EXPORT BindStateBase
 
   friend class CallbackBase;
   friend class CallbackBaseCopyable;
+  friend class OnceCallbackBase;
 
   // Whitelist subclasses that access the destructor of BindStateBase.
   template <typename Functor, typename... BoundArgs>
@@ -95,7 +147,8 @@ class BASE_EXPORT BindStateBase
   // the original type on usage.
   InvokeFuncStorage polymorphic_invoke_;
 
-  // Pointer to a function that will properly destroy |this|.
+  // Pointer to a function that will properly destroy |this|: delete it, or
+  // just run its destructor if it's stored inline in a OnceCallback.
   void (*destructor_)(const BindStateBase*);
   bool (*is_cancelled_)(const BindStateBase*);
 
@@ -104,7 +157,7 @@ class BASE_EXPORT BindStateBase
 
 // Holds the Callback methods that don't require specialization to reduce
 // template bloat.
-// CallbackBase<MoveOnly> is a direct base class of MoveOnly callbacks, and
+// CallbackBase<MoveOnly> is the base of OnceCallbackBase, and
 // CallbackBase<Copyable> uses CallbackBase<MoveOnly> for its implementation.
 class BASE_EXPORT CallbackBase {
  public:
@@ -169,6 +222,110 @@ class BASE_EXPORT CallbackBaseCopyable : public CallbackBase {
   ~CallbackBaseCopyable() = default;
 };
 
+// OnceCallbackBase is a direct base class of OnceCallbacks. Unlike a
+// RepeatingCallback, a OnceCallback is never copied, so it can own a small
+// BindState outright: BindOnce() constructs those in |inline_storage_|, and
+// they are moved along with the callback. Larger ones, and those converted
+// from a RepeatingCallback, are heap-allocated and reference counted as usual.
+class BASE_EXPORT OnceCallbackBase : public CallbackBase {
+ public:
+  // Moving is inline, as a OnceCallback is typically moved several times on
+  // its way from BindOnce() to Run().
+  OnceCallbackBase(OnceCallbackBase&& c) {
+    bind_state_ = std::move(c.bind_state_);
+    TakeInlineState(&c);
+  }
+  OnceCallbackBase& operator=(OnceCallbackBase&& c);
+
+  explicit OnceCallbackBase(CallbackBaseCopyable&& c);
+  OnceCallbackBase& operator=(CallbackBaseCopyable&& c);
+
+  // These hide CallbackBase's versions, to account for inline BindStates.
+  bool is_null() const { return !bind_state_ && !relocate_; }
+  explicit operator bool() const { return !is_null(); }
+  bool IsCancelled() const;
+  void Reset();
+
+ protected:
+  OnceCallbackBase() = default;
+  explicit OnceCallbackBase(BindStateBase* bind_state)
+      : CallbackBase(bind_state) {}
+
+  template <typename BindStateType, typename... Args>
+  explicit OnceCallbackBase(EmplaceBindState<BindStateType>, Args&&... args) {
+    Emplace<BindStateType>(CanStoreBindStateInline<BindStateType>(),
+                           std::forward<Args>(args)...);
+  }
+
+  ~OnceCallbackBase() {
+    if (relocate_ && relocate_ != &RelocateTrivially)
+      DestroyInlineState();
+  }
+
+  bool EqualsInternal(const OnceCallbackBase& other) const;
+
+  BindStateBase* bind_state() const {
+    return relocate_ ? inline_state() : bind_state_.get();
+  }
+
+  InvokeFuncStorage polymorphic_invoke() const {
+    return bind_state()->polymorphic_invoke_;
+  }
+
+ private:
+  template <typename BindStateType, typename... Args>
+  void Emplace(std::true_type, Args&&... args) {
+    new (inline_storage_)
+        BindStateType(InlineBindStateTag(), std::forward<Args>(args)...);
+    relocate_ = IsTriviallyRelocatable<
+                    typename BindStateType::StoredTypes>::value
+                    ? &RelocateTrivially
+                    : &BindStateType::MoveInline;
+  }
+
+  template <typename BindStateType, typename... Args>
+  void Emplace(std::false_type, Args&&... args) {
+    bind_state_ = AdoptRef(static_cast<BindStateBase*>(
+        new BindStateType(std::forward<Args>(args)...)));
+  }
+
+  BindStateBase* inline_state() const {
+    return reinterpret_cast<BindStateBase*>(
+        const_cast<char*>(inline_storage_));
+  }
+
+  // Marks trivially relocatable inline BindStates, which are moved with a
+  // memcpy() and need no destruction.
+  static void RelocateTrivially(BindStateBase* from, void* to);
+
+  // Moves |c|'s inline BindState, if any, into |inline_storage_|.
+  void TakeInlineState(OnceCallbackBase* c) {
+    DCHECK(!relocate_);
+    if (c->relocate_ == &RelocateTrivially) {
+      memcpy(inline_storage_, c->inline_storage_, kOnceCallbackInlineSize);
+      relocate_ = c->relocate_;
+      c->relocate_ = nullptr;
+    } else if (c->relocate_) {
+      MoveInlineState(c);
+    }
+  }
+
+  // Implements TakeInlineState() for BindStates which aren't trivially
+  // relocatable.
+  void MoveInlineState(OnceCallbackBase* c);
+
+  // Destroys the inline BindState. Requires that there is one.
+  void DestroyInlineState();
+
+  // Non-null iff |inline_storage_| holds a BindState, in which case it
+  // move-constructs that BindState in the given storage. The original must
+  // then be destroyed.
+  void (*relocate_)(BindStateBase*, void*) = nullptr;
+
+  alignas(kOnceCallbackInlineAlignment) char inline_storage_
+      [kOnceCallbackInlineSize];
+};
+
 }  // namespace internal
 }  // namespace base
 
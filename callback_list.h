@@ -5,8 +5,11 @@
 #ifndef BASE_CALLBACK_LIST_H_
 #define BASE_CALLBACK_LIST_H_
 
-#include <list>
+#include <stddef.h>
+
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "base/callback.h"
 #include "base/compiler_specific.h"
@@ -20,6 +23,13 @@
 // the iterator. It safely handles the case of a callback removing itself or
 // another callback from the list while callbacks are being run.
 //
+// The callbacks are stored in a vector, so Notify() runs through contiguous
+// memory. Removed callbacks are nulled out and erased in bulk after the
+// current notification, or once enough of them accumulate.
+//
+// For a list which can be used from any thread, see CallbackListThreadSafe in
+// callback_list_threadsafe.h.
+//
 // TYPICAL USAGE:
 //
 // class MyWidget {
@@ -74,25 +84,18 @@ class CallbackListBase {
  public:
   class Subscription {
    public:
-    Subscription(CallbackListBase<CallbackType>* list,
-                 typename std::list<CallbackType>::iterator iter)
-        : list_(list),
-          iter_(iter) {
-    }
+    Subscription(CallbackListBase<CallbackType>* list, size_t index)
+        : list_(list), index_(index) {}
 
-    ~Subscription() {
-      if (list_->active_iterator_count_) {
-        iter_->Reset();
-      } else {
-        list_->callbacks_.erase(iter_);
-        if (!list_->removal_callback_.is_null())
-          list_->removal_callback_.Run();
-      }
-    }
+    ~Subscription() { list_->Remove(index_); }
 
    private:
+    friend class CallbackListBase<CallbackType>;
+
     CallbackListBase<CallbackType>* list_;
-    typename std::list<CallbackType>::iterator iter_;
+    // The index of the callback in |list_->entries_|, which is updated when
+    // the list is compacted.
+    size_t index_;
 
     DISALLOW_COPY_AND_ASSIGN(Subscription);
   };
@@ -102,8 +105,9 @@ class CallbackListBase {
   // CallbackList is destroyed.
   std::unique_ptr<Subscription> Add(const CallbackType& cb) WARN_UNUSED_RESULT {
     DCHECK(!cb.is_null());
-    return std::make_unique<Subscription>(
-        this, callbacks_.insert(callbacks_.end(), cb));
+    auto subscription = std::make_unique<Subscription>(this, entries_.size());
+    entries_.push_back({cb, subscription.get()});
+    return subscription;
   }
 
   // Sets a callback which will be run when a subscription list is changed.
@@ -115,7 +119,7 @@ class CallbackListBase {
   // not looping through the list.
   bool empty() {
     DCHECK_EQ(0, active_iterator_count_);
-    return callbacks_.empty();
+    return entries_.size() == num_removed_entries_;
   }
 
  protected:
@@ -123,14 +127,11 @@ class CallbackListBase {
   class Iterator {
    public:
     explicit Iterator(CallbackListBase<CallbackType>* list)
-        : list_(list),
-          list_iter_(list_->callbacks_.begin()) {
+        : list_(list), index_(0) {
       ++list_->active_iterator_count_;
     }
 
-    Iterator(const Iterator& iter)
-        : list_(iter.list_),
-          list_iter_(iter.list_iter_) {
+    Iterator(const Iterator& iter) : list_(iter.list_), index_(iter.index_) {
       ++list_->active_iterator_count_;
     }
 
@@ -140,28 +141,29 @@ class CallbackListBase {
       }
     }
 
+    // The returned callback may move if callbacks are added to the list, so
+    // it must not be used after that. Running it is still safe, since Run()
+    // doesn't touch the callback after invoking it.
     CallbackType* GetNext() {
-      while ((list_iter_ != list_->callbacks_.end()) && list_iter_->is_null())
-        ++list_iter_;
+      std::vector<Entry>& entries = list_->entries_;
+      while (index_ < entries.size() && entries[index_].callback.is_null())
+        ++index_;
 
-      CallbackType* cb = nullptr;
-      if (list_iter_ != list_->callbacks_.end()) {
-        cb = &(*list_iter_);
-        ++list_iter_;
-      }
-      return cb;
+      if (index_ == entries.size())
+        return nullptr;
+      return &entries[index_++].callback;
     }
 
    private:
     CallbackListBase<CallbackType>* list_;
-    typename std::list<CallbackType>::iterator list_iter_;
+    size_t index_;
   };
 
-  CallbackListBase() : active_iterator_count_(0) {}
+  CallbackListBase() = default;
 
   ~CallbackListBase() {
     DCHECK_EQ(0, active_iterator_count_);
-    DCHECK_EQ(0U, callbacks_.size());
+    DCHECK_EQ(num_removed_entries_, entries_.size());
   }
 
   // Returns an instance of a CallbackListBase::Iterator which can be used
@@ -170,27 +172,64 @@ class CallbackListBase {
     return Iterator(this);
   }
 
-  // Compact the list: remove any entries which were nulled out during
-  // iteration.
+  // Compact the list: remove any entries which were nulled out, and run the
+  // removal callback if some were during iteration.
   void Compact() {
-    auto it = callbacks_.begin();
-    bool updated = false;
-    while (it != callbacks_.end()) {
-      if ((*it).is_null()) {
-        updated = true;
-        it = callbacks_.erase(it);
-      } else {
-        ++it;
+    if (num_removed_entries_ != 0) {
+      size_t new_size = 0;
+      for (size_t i = 0; i < entries_.size(); ++i) {
+        if (entries_[i].callback.is_null())
+          continue;
+        if (i != new_size) {
+          entries_[i].subscription->index_ = new_size;
+          entries_[new_size] = std::move(entries_[i]);
+        }
+        ++new_size;
       }
+      entries_.resize(new_size);
+      num_removed_entries_ = 0;
     }
 
-    if (updated && !removal_callback_.is_null())
-      removal_callback_.Run();
+    if (removed_during_iteration_) {
+      removed_during_iteration_ = false;
+      if (!removal_callback_.is_null())
+        removal_callback_.Run();
+    }
   }
 
  private:
-  std::list<CallbackType> callbacks_;
-  int active_iterator_count_;
+  // The callbacks are stored contiguously, in the order they were added. A
+  // removed callback is nulled out, and its entry erased when the list is
+  // next compacted.
+  struct Entry {
+    CallbackType callback;
+    Subscription* subscription;
+  };
+
+  void Remove(size_t index) {
+    DCHECK_LT(index, entries_.size());
+    entries_[index].callback.Reset();
+    entries_[index].subscription = nullptr;
+    ++num_removed_entries_;
+
+    if (active_iterator_count_) {
+      // Compact() runs after the iteration.
+      removed_during_iteration_ = true;
+      return;
+    }
+
+    // Compacting once half of the entries are removed keeps the cost of
+    // removals constant on average, whatever their order.
+    if (num_removed_entries_ * 2 >= entries_.size())
+      Compact();
+    if (!removal_callback_.is_null())
+      removal_callback_.Run();
+  }
+
+  std::vector<Entry> entries_;
+  size_t num_removed_entries_ = 0;
+  int active_iterator_count_ = 0;
+  bool removed_during_iteration_ = false;
   RepeatingClosure removal_callback_;
 
   DISALLOW_COPY_AND_ASSIGN(CallbackListBase);
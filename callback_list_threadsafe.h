@@ -0,0 +1,144 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CALLBACK_LIST_THREADSAFE_H_
+#define BASE_CALLBACK_LIST_THREADSAFE_H_
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/rcu_ptr.h"
+
+// OVERVIEW:
+//
+// A thread-safe counterpart of CallbackList (see callback_list.h): callbacks
+// can be added, removed and notified from any thread. Callbacks are run
+// synchronously, on the thread calling Notify().
+//
+// Notify() runs the callbacks of an immutable snapshot of the list, published
+// with RcuPtr, so it takes no lock and doesn't contend with other Notify()
+// calls, nor with Add() and removals. These copy the snapshot, so they cost
+// O(number of callbacks): this is meant for lists which are notified far more
+// often than they change.
+//
+// Since Notify() doesn't synchronize with removals, a callback may still run
+// on another thread while, or shortly after, its Subscription is destroyed.
+// Callbacks must be safe to run then, e.g. by being bound to a ref-counted
+// object or to a WeakPtr checked on the right sequence. Callbacks may also be
+// destroyed on any thread. As with any RCU read scope, callbacks should be
+// short, and must not wait for a thread which reclaims snapshots.
+//
+// TYPICAL USAGE:
+//
+//   base::CallbackListThreadSafe<void(const Foo&)> callback_list_;
+//
+//   // On any thread.
+//   std::unique_ptr<base::CallbackListThreadSafe<void(const Foo&)>::
+//                       Subscription>
+//       subscription = callback_list_.Add(base::BindRepeating(&OnFoo));
+//
+//   // On any thread.
+//   callback_list_.Notify(foo);
+
+namespace base {
+
+template <typename Sig>
+class CallbackListThreadSafe;
+
+template <typename... Args>
+class CallbackListThreadSafe<void(Args...)> {
+ public:
+  using CallbackType = RepeatingCallback<void(Args...)>;
+
+  class Subscription {
+   public:
+    ~Subscription() { list_->Remove(this); }
+
+   private:
+    friend class CallbackListThreadSafe;
+
+    explicit Subscription(CallbackListThreadSafe* list) : list_(list) {}
+
+    CallbackListThreadSafe* const list_;
+
+    DISALLOW_COPY_AND_ASSIGN(Subscription);
+  };
+
+  CallbackListThreadSafe() : snapshot_(std::make_unique<Snapshot>()) {}
+
+  ~CallbackListThreadSafe() {
+    DCHECK(snapshot_.GetForWriter()->entries.empty());
+  }
+
+  // Adds a callback to the list. The callback will remain registered until the
+  // returned Subscription is destroyed, which must occur before the
+  // CallbackListThreadSafe is destroyed.
+  std::unique_ptr<Subscription> Add(const CallbackType& cb) WARN_UNUSED_RESULT {
+    DCHECK(!cb.is_null());
+    std::unique_ptr<Subscription> subscription(new Subscription(this));
+
+    AutoLock auto_lock(lock_);
+    auto snapshot = std::make_unique<Snapshot>(*snapshot_.GetForWriter());
+    snapshot->entries.push_back({cb, subscription.get()});
+    snapshot_.Update(std::move(snapshot));
+    return subscription;
+  }
+
+  // Runs the callbacks registered when the call starts, in the order they were
+  // added. Callbacks added during the call are not run, but callbacks removed
+  // during the call may be.
+  template <typename... RunArgs>
+  void Notify(RunArgs&&... args) const {
+    RcuReadScope read_scope;
+    for (const Entry& entry : snapshot_.Get()->entries)
+      entry.callback.Run(args...);
+  }
+
+  // Returns true if there are no subscriptions.
+  bool empty() const {
+    AutoLock auto_lock(lock_);
+    return snapshot_.GetForWriter()->entries.empty();
+  }
+
+ private:
+  struct Entry {
+    CallbackType callback;
+    const Subscription* subscription;
+  };
+
+  // The callbacks at some point in time. Snapshots are never modified once
+  // published in |snapshot_|: Add() and Remove() publish modified copies.
+  struct Snapshot {
+    std::vector<Entry> entries;
+  };
+
+  void Remove(const Subscription* subscription) {
+    AutoLock auto_lock(lock_);
+    auto snapshot = std::make_unique<Snapshot>(*snapshot_.GetForWriter());
+    auto it = std::find_if(snapshot->entries.begin(), snapshot->entries.end(),
+                           [subscription](const Entry& entry) {
+                             return entry.subscription == subscription;
+                           });
+    DCHECK(it != snapshot->entries.end());
+    snapshot->entries.erase(it);
+    snapshot_.Update(std::move(snapshot));
+  }
+
+  // Serializes updates of |snapshot_|. Reads don't need it.
+  mutable Lock lock_;
+
+  RcuPtr<Snapshot> snapshot_;
+
+  DISALLOW_COPY_AND_ASSIGN(CallbackListThreadSafe);
+};
+
+}  // namespace base
+
+#endif  // BASE_CALLBACK_LIST_THREADSAFE_H_
@@ -0,0 +1,152 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/callback_list_threadsafe.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/macros.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace {
+
+using TestCallbackList = CallbackListThreadSafe<void(int)>;
+
+void Add(int* total, int value) {
+  *total += value;
+}
+
+void AddAtomic(std::atomic<int>* total, int value) {
+  total->fetch_add(value, std::memory_order_relaxed);
+}
+
+// Notifies |callback_list| until |done| is set.
+class NotifyingThread : public SimpleThread {
+ public:
+  NotifyingThread(TestCallbackList* callback_list, std::atomic<bool>* done)
+      : SimpleThread("NotifyingThread"),
+        callback_list_(callback_list),
+        done_(done) {}
+
+  void Run() override {
+    while (!done_->load(std::memory_order_relaxed))
+      callback_list_->Notify(1);
+  }
+
+ private:
+  TestCallbackList* const callback_list_;
+  std::atomic<bool>* const done_;
+
+  DISALLOW_COPY_AND_ASSIGN(NotifyingThread);
+};
+
+}  // namespace
+
+TEST(CallbackListThreadSafeTest, AddNotifyRemove) {
+  TestCallbackList callback_list;
+  EXPECT_TRUE(callback_list.empty());
+
+  int a = 0;
+  int b = 0;
+  std::unique_ptr<TestCallbackList::Subscription> a_subscription =
+      callback_list.Add(BindRepeating(&Add, Unretained(&a)));
+  std::unique_ptr<TestCallbackList::Subscription> b_subscription =
+      callback_list.Add(BindRepeating(&Add, Unretained(&b)));
+  EXPECT_FALSE(callback_list.empty());
+
+  callback_list.Notify(2);
+  EXPECT_EQ(2, a);
+  EXPECT_EQ(2, b);
+
+  a_subscription.reset();
+  callback_list.Notify(3);
+  EXPECT_EQ(2, a);
+  EXPECT_EQ(5, b);
+
+  b_subscription.reset();
+  EXPECT_TRUE(callback_list.empty());
+  callback_list.Notify(4);
+  EXPECT_EQ(5, b);
+}
+
+// A callback removing itself is run to completion, and not run again.
+TEST(CallbackListThreadSafeTest, RemoveDuringNotify) {
+  TestCallbackList callback_list;
+  int total = 0;
+  std::unique_ptr<TestCallbackList::Subscription> subscription;
+  subscription = callback_list.Add(BindRepeating(
+      [](std::unique_ptr<TestCallbackList::Subscription>* subscription,
+         int* total, int value) {
+        subscription->reset();
+        *total += value;
+      },
+      Unretained(&subscription), Unretained(&total)));
+
+  callback_list.Notify(1);
+  EXPECT_EQ(1, total);
+  EXPECT_TRUE(callback_list.empty());
+  callback_list.Notify(1);
+  EXPECT_EQ(1, total);
+}
+
+// A callback added during Notify() is only run by the next one.
+TEST(CallbackListThreadSafeTest, AddDuringNotify) {
+  TestCallbackList callback_list;
+  int total = 0;
+  std::unique_ptr<TestCallbackList::Subscription> added_subscription;
+  std::unique_ptr<TestCallbackList::Subscription> subscription =
+      callback_list.Add(BindRepeating(
+          [](TestCallbackList* callback_list,
+             std::unique_ptr<TestCallbackList::Subscription>* added,
+             int* total, int value) {
+            if (!*added)
+              *added = callback_list->Add(BindRepeating(&Add, total));
+          },
+          Unretained(&callback_list), Unretained(&added_subscription),
+          Unretained(&total)));
+
+  callback_list.Notify(1);
+  EXPECT_EQ(0, total);
+  callback_list.Notify(1);
+  EXPECT_EQ(1, total);
+}
+
+// Notify from several threads while callbacks are added and removed.
+TEST(CallbackListThreadSafeTest, ConcurrentNotify) {
+  constexpr size_t kNumThreads = 4;
+  TestCallbackList callback_list;
+  std::atomic<int> total(0);
+  std::unique_ptr<TestCallbackList::Subscription> subscription =
+      callback_list.Add(BindRepeating(&AddAtomic, Unretained(&total)));
+
+  std::atomic<bool> done(false);
+  std::vector<std::unique_ptr<NotifyingThread>> threads;
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    threads.push_back(std::make_unique<NotifyingThread>(&callback_list, &done));
+    threads.back()->Start();
+  }
+
+  std::atomic<int> other_total(0);
+  for (int i = 0; i < 1000; ++i) {
+    std::unique_ptr<TestCallbackList::Subscription> other_subscription =
+        callback_list.Add(BindRepeating(&AddAtomic, Unretained(&other_total)));
+  }
+
+  done.store(true, std::memory_order_relaxed);
+  for (const auto& thread : threads)
+    thread->Join();
+
+  EXPECT_GT(total.load(), 0);
+  subscription.reset();
+  EXPECT_TRUE(callback_list.empty());
+}
+
+}  // namespace base
@@ -296,6 +296,37 @@ TEST(CallbackListTest, AddCallbacksDuringIteration) {
   EXPECT_EQ(2, b.total());
 }
 
+// Removing callbacks in any order compacts the list without losing track of
+// the remaining ones.
+TEST(CallbackListTest, RemoveOutsideIteration) {
+  constexpr size_t kNumCallbacks = 10;
+  CallbackList<void(void)> cb_reg;
+  Listener listeners[kNumCallbacks];
+  std::unique_ptr<CallbackList<void(void)>::Subscription>
+      subscriptions[kNumCallbacks];
+  for (size_t i = 0; i < kNumCallbacks; ++i) {
+    subscriptions[i] =
+        cb_reg.Add(Bind(&Listener::IncrementTotal, Unretained(&listeners[i])));
+  }
+
+  for (size_t i = 0; i < kNumCallbacks; i += 2)
+    subscriptions[i].reset();
+  cb_reg.Notify();
+
+  for (size_t i = kNumCallbacks - 1; i > kNumCallbacks / 2; i -= 2)
+    subscriptions[i].reset();
+  cb_reg.Notify();
+
+  for (size_t i = 0; i < kNumCallbacks; ++i) {
+    const int expected_total = i % 2 == 0 ? 0 : i > kNumCallbacks / 2 ? 1 : 2;
+    EXPECT_EQ(expected_total, listeners[i].total()) << i;
+  }
+
+  for (auto& subscription : subscriptions)
+    subscription.reset();
+  EXPECT_TRUE(cb_reg.empty());
+}
+
 // Sanity check: notifying an empty list is a no-op.
 TEST(CallbackListTest, EmptyList) {
   CallbackList<void(void)> cb_reg;
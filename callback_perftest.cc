@@ -0,0 +1,125 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/callback.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/containers/queue.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+constexpr int kIterations = 1000000;
+
+class Receiver {
+ public:
+  Receiver() : weak_factory_(this) {}
+
+  void Add(int value) { sum_ += value; }
+
+  int sum() const { return sum_; }
+  WeakPtr<Receiver> GetWeakPtr() { return weak_factory_.GetWeakPtr(); }
+
+ private:
+  int sum_ = 0;
+  WeakPtrFactory<Receiver> weak_factory_;
+};
+
+// Too large for a OnceCallback to store inline.
+struct LargeArgument {
+  int values[32] = {};
+};
+
+void PrintResult(const std::string& trace, TimeTicks start, int iterations) {
+  TimeDelta elapsed = TimeTicks::Now() - start;
+  perf_test::PrintResult("callback", "", trace,
+                         elapsed.InNanoseconds() /
+                             static_cast<double>(iterations),
+                         "ns/callback", true);
+}
+
+}  // namespace
+
+TEST(CallbackPerfTest, BindOnceAndRunUnretained) {
+  Receiver receiver;
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i)
+    BindOnce(&Receiver::Add, Unretained(&receiver), 1).Run();
+  PrintResult("bind_once_run_unretained", start, kIterations);
+  EXPECT_EQ(kIterations, receiver.sum());
+}
+
+TEST(CallbackPerfTest, BindOnceAndRunWeakPtr) {
+  Receiver receiver;
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i)
+    BindOnce(&Receiver::Add, receiver.GetWeakPtr(), 1).Run();
+  PrintResult("bind_once_run_weak_ptr", start, kIterations);
+  EXPECT_EQ(kIterations, receiver.sum());
+}
+
+TEST(CallbackPerfTest, BindOnceAndRunLargeState) {
+  int sum = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    BindOnce([](int* sum, const LargeArgument& arg) { *sum += 1; },
+             Unretained(&sum), LargeArgument())
+        .Run();
+  }
+  PrintResult("bind_once_run_large_state", start, kIterations);
+  EXPECT_EQ(kIterations, sum);
+}
+
+TEST(CallbackPerfTest, BindRepeatingAndRun) {
+  Receiver receiver;
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i)
+    BindRepeating(&Receiver::Add, Unretained(&receiver), 1).Run();
+  PrintResult("bind_repeating_run", start, kIterations);
+  EXPECT_EQ(kIterations, receiver.sum());
+}
+
+// Approximates posting and running tasks: callbacks are queued, as in a task
+// queue, before they are run.
+TEST(CallbackPerfTest, QueueAndRunOnceClosures) {
+  constexpr int kBatchSize = 100;
+  Receiver receiver;
+  base::queue<OnceClosure> queue;
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kIterations / kBatchSize; ++i) {
+    for (int j = 0; j < kBatchSize; ++j)
+      queue.push(BindOnce(&Receiver::Add, Unretained(&receiver), 1));
+    while (!queue.empty()) {
+      OnceClosure task = std::move(queue.front());
+      queue.pop();
+      std::move(task).Run();
+    }
+  }
+  PrintResult("queue_run_once_closure", start, kIterations);
+  EXPECT_EQ(kIterations, receiver.sum());
+}
+
+TEST(CallbackPerfTest, MoveOnceClosure) {
+  Receiver receiver;
+  OnceClosure closure = BindOnce(&Receiver::Add, Unretained(&receiver), 1);
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    OnceClosure moved = std::move(closure);
+    closure = std::move(moved);
+  }
+  PrintResult("move_once_closure", start, 2 * kIterations);
+  std::move(closure).Run();
+  EXPECT_EQ(1, receiver.sum());
+}
+
+}  // namespace base
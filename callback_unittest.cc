@@ -9,7 +9,9 @@
 #include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/callback_internal.h"
+#include "base/macros.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -183,5 +185,111 @@ TEST_F(CallbackTest, CallbackHasLastRefOnContainingObject) {
   ASSERT_TRUE(deleted);
 }
 
+// Counts live instances, so that tests can check that bound arguments stored
+// inline in a OnceCallback are destroyed exactly once.
+class InstanceCounter {
+ public:
+  explicit InstanceCounter(int* count) : count_(count) { ++*count_; }
+  InstanceCounter(InstanceCounter&& other) : count_(other.count_) {
+    ++*count_;
+  }
+  ~InstanceCounter() { --*count_; }
+
+ private:
+  int* const count_;
+
+  DISALLOW_COPY_AND_ASSIGN(InstanceCounter);
+};
+
+class OnceCallbackOwner {
+ public:
+  explicit OnceCallbackOwner(bool* deleted) : deleted_(deleted) {}
+  ~OnceCallbackOwner() { *deleted_ = true; }
+
+  OnceClosure callback;
+
+ private:
+  bool* const deleted_;
+};
+
+TEST_F(CallbackTest, OnceCallbackInlineStateMove) {
+  int count = 0;
+  OnceCallback<int(int)> cb =
+      BindOnce([](InstanceCounter counter, int x) { return x; },
+               InstanceCounter(&count));
+  EXPECT_EQ(1, count);
+
+  OnceCallback<int(int)> moved = std::move(cb);
+  EXPECT_TRUE(cb.is_null());
+  EXPECT_FALSE(moved.is_null());
+  EXPECT_EQ(1, count);
+
+  EXPECT_EQ(2, std::move(moved).Run(2));
+  EXPECT_TRUE(moved.is_null());
+  EXPECT_EQ(0, count);
+}
+
+TEST_F(CallbackTest, OnceCallbackInlineStateAssignAndReset) {
+  int count = 0;
+  OnceClosure cb1 = BindOnce([](InstanceCounter) {}, InstanceCounter(&count));
+  OnceClosure cb2 = BindOnce([](InstanceCounter) {}, InstanceCounter(&count));
+  EXPECT_EQ(2, count);
+
+  cb1 = std::move(cb2);
+  EXPECT_EQ(1, count);
+  EXPECT_TRUE(cb2.is_null());
+  EXPECT_TRUE(cb1.Equals(cb1));
+  EXPECT_FALSE(cb1.Equals(cb2));
+
+  cb1.Reset();
+  EXPECT_EQ(0, count);
+  EXPECT_TRUE(cb1.is_null());
+
+  // Assigning a RepeatingCallback replaces the inline state.
+  cb1 = BindOnce([](InstanceCounter) {}, InstanceCounter(&count));
+  cb1 = BindRepeating([] {});
+  EXPECT_EQ(0, count);
+  EXPECT_FALSE(cb1.is_null());
+}
+
+TEST_F(CallbackTest, OnceCallbackInlineStateIsCancelled) {
+  struct Target {
+    void Increment(int* value) { ++*value; }
+  } target;
+  WeakPtrFactory<Target> factory(&target);
+
+  int value = 0;
+  OnceClosure cb =
+      BindOnce(&Target::Increment, factory.GetWeakPtr(), Unretained(&value));
+  OnceClosure moved = std::move(cb);
+  EXPECT_FALSE(moved.IsCancelled());
+  factory.InvalidateWeakPtrs();
+  EXPECT_TRUE(moved.IsCancelled());
+  std::move(moved).Run();
+  EXPECT_EQ(0, value);
+}
+
+TEST_F(CallbackTest, OnceCallbackLargeState) {
+  // Too large to be stored inline.
+  struct Large {
+    char data[256];
+  } large = {};
+  large.data[255] = 42;
+  OnceCallback<char()> cb =
+      BindOnce([](const Large& large) { return large.data[255]; }, large);
+  OnceCallback<char()> moved = std::move(cb);
+  EXPECT_TRUE(cb.is_null());
+  EXPECT_EQ(42, std::move(moved).Run());
+}
+
+TEST_F(CallbackTest, OnceCallbackInlineStateOwnsContainingObject) {
+  bool deleted = false;
+  OnceCallbackOwner* owner = new OnceCallbackOwner(&deleted);
+  owner->callback = BindOnce([](std::unique_ptr<OnceCallbackOwner>) {},
+                             std::unique_ptr<OnceCallbackOwner>(owner));
+  owner->callback.Reset();
+  EXPECT_TRUE(deleted);
+}
+
 }  // namespace
 }  // namespace base
@@ -174,9 +174,22 @@ CommandLine::CommandLine(const StringVector& argv)
   InitFromArgv(argv);
 }
 
-CommandLine::CommandLine(const CommandLine& other) = default;
+CommandLine::CommandLine(const CommandLine& other)
+    : argv_(other.argv_),
+      switches_(other.switches_),
+      begin_args_(other.begin_args_) {
+  RebuildSwitchIndex();
+}
 
-CommandLine& CommandLine::operator=(const CommandLine& other) = default;
+CommandLine& CommandLine::operator=(const CommandLine& other) {
+  if (this == &other)
+    return *this;
+  argv_ = other.argv_;
+  switches_ = other.switches_;
+  begin_args_ = other.begin_args_;
+  RebuildSwitchIndex();
+  return *this;
+}
 
 CommandLine::~CommandLine() = default;
 
@@ -257,6 +270,7 @@ void CommandLine::InitFromArgv(int argc,
 void CommandLine::InitFromArgv(const StringVector& argv) {
   argv_ = StringVector(1);
   switches_.clear();
+  switch_index_.clear();
   begin_args_ = 1;
   SetProgram(argv.empty() ? FilePath() : FilePath(argv[0]));
   AppendSwitchesAndArguments(this, argv);
@@ -275,19 +289,38 @@ void CommandLine::SetProgram(const FilePath& program) {
 }
 
 bool CommandLine::HasSwitch(const base::StringPiece& switch_string) const {
-  DCHECK_EQ(ToLowerASCII(switch_string), switch_string);
-  return ContainsKey(switches_, switch_string);
+  return HasSwitch(SwitchKey(switch_string));
 }
 
 bool CommandLine::HasSwitch(const char switch_constant[]) const {
   return HasSwitch(base::StringPiece(switch_constant));
 }
 
+bool CommandLine::HasSwitch(const SwitchKey& switch_key) const {
+  return FindSwitch(switch_key) != nullptr;
+}
+
 std::string CommandLine::GetSwitchValueASCII(
     const base::StringPiece& switch_string) const {
-  StringType value = GetSwitchValueNative(switch_string);
+  return GetSwitchValueASCII(SwitchKey(switch_string));
+}
+
+FilePath CommandLine::GetSwitchValuePath(
+    const base::StringPiece& switch_string) const {
+  return GetSwitchValuePath(SwitchKey(switch_string));
+}
+
+CommandLine::StringType CommandLine::GetSwitchValueNative(
+    const base::StringPiece& switch_string) const {
+  return GetSwitchValueNative(SwitchKey(switch_string));
+}
+
+std::string CommandLine::GetSwitchValueASCII(
+    const SwitchKey& switch_key) const {
+  StringType value = GetSwitchValueNative(switch_key);
   if (!IsStringASCII(value)) {
-    DLOG(WARNING) << "Value of switch (" << switch_string << ") must be ASCII.";
+    DLOG(WARNING) << "Value of switch (" << switch_key.name()
+                  << ") must be ASCII.";
     return std::string();
   }
 #if defined(OS_WIN)
@@ -297,16 +330,14 @@ std::string CommandLine::GetSwitchValueASCII(
 #endif
 }
 
-FilePath CommandLine::GetSwitchValuePath(
-    const base::StringPiece& switch_string) const {
-  return FilePath(GetSwitchValueNative(switch_string));
+FilePath CommandLine::GetSwitchValuePath(const SwitchKey& switch_key) const {
+  return FilePath(GetSwitchValueNative(switch_key));
 }
 
 CommandLine::StringType CommandLine::GetSwitchValueNative(
-    const base::StringPiece& switch_string) const {
-  DCHECK_EQ(ToLowerASCII(switch_string), switch_string);
-  auto result = switches_.find(switch_string);
-  return result == switches_.end() ? StringType() : result->second;
+    const SwitchKey& switch_key) const {
+  const StringType* value = FindSwitch(switch_key);
+  return value ? *value : StringType();
 }
 
 void CommandLine::AppendSwitch(const std::string& switch_string) {
@@ -330,7 +361,9 @@ void CommandLine::AppendSwitchNative(const std::string& switch_string,
   size_t prefix_length = GetSwitchPrefixLength(combined_switch_string);
   auto insertion =
       switches_.insert(make_pair(switch_key.substr(prefix_length), value));
-  if (!insertion.second)
+  if (insertion.second)
+    IndexSwitch(&*insertion.first);
+  else
     insertion.first->second = value;
   // Preserve existing switch prefixes in |argv_|; only append one if necessary.
   if (prefix_length == 0)
@@ -474,4 +507,48 @@ CommandLine::StringType CommandLine::GetArgumentsStringInternal(
   return params;
 }
 
+const CommandLine::StringType* CommandLine::FindSwitch(
+    const SwitchKey& switch_key) const {
+  DCHECK_EQ(ToLowerASCII(switch_key.name()), switch_key.name());
+  if (switch_index_.empty())
+    return nullptr;
+  size_t mask = switch_index_.size() - 1;
+  for (size_t i = switch_key.hash() & mask;; i = (i + 1) & mask) {
+    const SwitchIndexEntry& slot = switch_index_[i];
+    if (!slot.entry)
+      return nullptr;
+    if (slot.hash == switch_key.hash() &&
+        slot.entry->first == switch_key.name()) {
+      return &slot.entry->second;
+    }
+  }
+}
+
+void CommandLine::IndexSwitch(const SwitchMap::value_type* entry) {
+  if (switches_.size() * 2 > switch_index_.size()) {
+    // |entry| is already in |switches_|.
+    RebuildSwitchIndex();
+    return;
+  }
+  uint32_t hash = SwitchKey::Hash(entry->first.data(), entry->first.size());
+  size_t mask = switch_index_.size() - 1;
+  size_t i = hash & mask;
+  while (switch_index_[i].entry)
+    i = (i + 1) & mask;
+  switch_index_[i] = {hash, entry};
+}
+
+void CommandLine::RebuildSwitchIndex() {
+  if (switches_.empty()) {
+    switch_index_.clear();
+    return;
+  }
+  size_t size = 8;
+  while (size < switches_.size() * 2)
+    size *= 2;
+  switch_index_.assign(size, SwitchIndexEntry{0, nullptr});
+  for (const auto& entry : switches_)
+    IndexSwitch(&entry);
+}
+
 }  // namespace base
@@ -16,6 +16,8 @@
 #define BASE_COMMAND_LINE_H_
 
 #include <stddef.h>
+#include <stdint.h>
+
 #include <map>
 #include <string>
 #include <vector>
@@ -42,6 +44,36 @@ class BASE_EXPORT CommandLine {
   using StringVector = std::vector<StringType>;
   using SwitchMap = std::map<std::string, StringType, std::less<>>;
 
+  // A switch name along with its hash, which is computed at compile time for
+  // the switch constants. Looking up a SwitchKey costs no allocation and a
+  // single string compare, against the matching switch. Hot code should
+  // define its switches as:
+  //   constexpr CommandLine::SwitchKey kMySwitch("my-switch");
+  class SwitchKey {
+   public:
+    // |name| must be a string literal.
+    template <size_t N>
+    constexpr explicit SwitchKey(const char (&name)[N])
+        : name_(name, N - 1), hash_(Hash(name, N - 1)) {}
+    explicit SwitchKey(const StringPiece& name)
+        : name_(name), hash_(Hash(name.data(), name.size())) {}
+
+    constexpr StringPiece name() const { return name_; }
+    constexpr uint32_t hash() const { return hash_; }
+
+    // 32-bit FNV-1a.
+    static constexpr uint32_t Hash(const char* name, size_t length) {
+      uint32_t hash = 2166136261u;
+      for (size_t i = 0; i < length; ++i)
+        hash = (hash ^ static_cast<uint8_t>(name[i])) * 16777619u;
+      return hash;
+    }
+
+   private:
+    StringPiece name_;
+    uint32_t hash_;
+  };
+
   // A constructor for CommandLines that only carry switches and arguments.
   enum NoProgram { NO_PROGRAM };
   explicit CommandLine(NoProgram no_program);
@@ -53,7 +85,7 @@ class BASE_EXPORT CommandLine {
   CommandLine(int argc, const CharType* const* argv);
   explicit CommandLine(const StringVector& argv);
 
-  // Override copy and assign to ensure |switches_by_stringpiece_| is valid.
+  // Override copy and assign to ensure |switch_index_| is valid.
   CommandLine(const CommandLine& other);
   CommandLine& operator=(const CommandLine& other);
 
@@ -161,6 +193,7 @@ class BASE_EXPORT CommandLine {
   // StringPiece.
   bool HasSwitch(const StringPiece& switch_string) const;
   bool HasSwitch(const char switch_constant[]) const;
+  bool HasSwitch(const SwitchKey& switch_key) const;
 
   // Returns the value associated with the given switch. If the switch has no
   // value or isn't present, this method returns the empty string.
@@ -168,6 +201,9 @@ class BASE_EXPORT CommandLine {
   std::string GetSwitchValueASCII(const StringPiece& switch_string) const;
   FilePath GetSwitchValuePath(const StringPiece& switch_string) const;
   StringType GetSwitchValueNative(const StringPiece& switch_string) const;
+  std::string GetSwitchValueASCII(const SwitchKey& switch_key) const;
+  FilePath GetSwitchValuePath(const SwitchKey& switch_key) const;
+  StringType GetSwitchValueNative(const SwitchKey& switch_key) const;
 
   // Get a copy of all switches, along with their values.
   const SwitchMap& GetSwitches() const { return switches_; }
@@ -229,6 +265,15 @@ class BASE_EXPORT CommandLine {
   // also quotes parts with '%' in them.
   StringType GetArgumentsStringInternal(bool quote_placeholders) const;
 
+  // Returns the value of the switch |switch_key|, or null if it isn't present.
+  const StringType* FindSwitch(const SwitchKey& switch_key) const;
+
+  // Adds |entry| of |switches_| to |switch_index_|, growing it if needed.
+  void IndexSwitch(const SwitchMap::value_type* entry);
+
+  // Rebuilds |switch_index_| from |switches_|.
+  void RebuildSwitchIndex();
+
   // The singleton CommandLine representing the current process's command line.
   static CommandLine* current_process_commandline_;
 
@@ -238,6 +283,14 @@ class BASE_EXPORT CommandLine {
   // Parsed-out switch keys and values.
   SwitchMap switches_;
 
+  // Open-addressed hash table of the entries of |switches_|, whose size is a
+  // power of two at least twice their number. Empty slots have a null entry.
+  struct SwitchIndexEntry {
+    uint32_t hash;
+    const SwitchMap::value_type* entry;
+  };
+  std::vector<SwitchIndexEntry> switch_index_;
+
   // The index after the program and switches, any arguments start here.
   size_t begin_args_;
 };
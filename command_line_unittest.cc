@@ -10,6 +10,8 @@
 
 #include "base/files/file_path.h"
 #include "base/macros.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -406,6 +408,43 @@ TEST(CommandLineTest, Copy) {
     EXPECT_TRUE(assigned.HasSwitch(pair.first));
 }
 
+TEST(CommandLineTest, SwitchKey) {
+  static constexpr CommandLine::SwitchKey kSwitchA("a");
+  static constexpr CommandLine::SwitchKey kSwitchB("b");
+  static_assert(kSwitchA.hash() == CommandLine::SwitchKey::Hash("a", 1),
+                "The hash of switch constants is computed at compile time.");
+
+  CommandLine cl(CommandLine::NO_PROGRAM);
+  EXPECT_FALSE(cl.HasSwitch(kSwitchA));
+  cl.AppendSwitchASCII("a", "value");
+  EXPECT_TRUE(cl.HasSwitch(kSwitchA));
+  EXPECT_FALSE(cl.HasSwitch(kSwitchB));
+  EXPECT_EQ("value", cl.GetSwitchValueASCII(kSwitchA));
+  EXPECT_EQ("", cl.GetSwitchValueASCII(kSwitchB));
+
+  // The index grows with the switches.
+  for (int i = 0; i < 100; ++i)
+    cl.AppendSwitchASCII(StringPrintf("switch%d", i), IntToString(i));
+  for (int i = 0; i < 100; ++i) {
+    std::string name = StringPrintf("switch%d", i);
+    EXPECT_EQ(IntToString(i),
+              cl.GetSwitchValueASCII(CommandLine::SwitchKey(name)));
+  }
+  EXPECT_EQ("value", cl.GetSwitchValueASCII(kSwitchA));
+
+  // Overwriting a value doesn't duplicate the switch.
+  cl.AppendSwitchASCII("a", "other");
+  EXPECT_EQ("other", cl.GetSwitchValueASCII(kSwitchA));
+  EXPECT_EQ(101u, cl.GetSwitches().size());
+
+  CommandLine copy(cl);
+  cl.AppendSwitch("b");
+  EXPECT_TRUE(cl.HasSwitch(kSwitchB));
+  EXPECT_FALSE(copy.HasSwitch(kSwitchB));
+  EXPECT_EQ("other", copy.GetSwitchValueASCII(kSwitchA));
+  EXPECT_EQ("99", copy.GetSwitchValueASCII("switch99"));
+}
+
 TEST(CommandLineTest, PrependSimpleWrapper) {
   CommandLine cl(FilePath(FILE_PATH_LITERAL("Program")));
   cl.AppendSwitch("a");
@@ -148,6 +148,23 @@
 // If available, it would look like:
 //   __attribute__((format(wprintf, format_param, dots_param)))
 
+// Annotates a variable with static storage duration which must be constant
+// initialized, i.e. initialized at compile time rather than by a static
+// initializer, so that accessing it never needs a guard or a lazy-creation
+// check. This is C++20's constinit, where the compiler supports an equivalent.
+// The variable's type must have a constexpr constructor, and should be
+// trivially destructible so that it doesn't need an exit-time destructor.
+// Use like:
+//   CONSTINIT std::atomic<bool> g_enabled{false};
+#if defined(__has_attribute)
+#if __has_attribute(require_constant_initialization)
+#define CONSTINIT __attribute__((require_constant_initialization))
+#endif
+#endif
+#if !defined(CONSTINIT)
+#define CONSTINIT
+#endif
+
 // Sanitizers annotations.
 #if defined(__has_attribute)
 #if __has_attribute(no_sanitize)
@@ -0,0 +1,386 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_CHUNKED_DEQUE_H_
+#define BASE_CONTAINERS_CHUNKED_DEQUE_H_
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "base/containers/circular_deque.h"
+#include "base/logging.h"
+
+// base::chunked_deque is a deque storing its elements in fixed-size blocks,
+// like std::deque. Unlike base::circular_deque, growing it never moves the
+// elements: pushes and pops at either end are constant time, and the blocks
+// are freed as the deque drains. Unlike std::deque, whose blocks are 4096
+// bytes in libstdc++ and much smaller in libc++, the block size adapts to the
+// size of the elements, and a drained block is kept for reuse so that a deque
+// which stays around a block boundary doesn't allocate on every push.
+//
+// Use it for queues whose size varies a lot, such as task queues, which
+// would otherwise reallocate and move all their elements on bursts:
+//   base::queue<Task, base::chunked_deque<Task>> queue;
+//
+// Like std::deque, pushes and pops keep the references to the other elements
+// valid, but invalidate all the iterators. The API is the end operations of
+// std::deque, with random access:
+//
+//   chunked_deque();
+//   chunked_deque(std::initializer_list<value_type>);
+//   chunked_deque(const chunked_deque&);
+//   chunked_deque(chunked_deque&&);
+//   chunked_deque& operator=(const chunked_deque&);
+//   chunked_deque& operator=(chunked_deque&&);
+//
+//   T& operator[](size_t);
+//   T& front();
+//   T& back();
+//   iterator begin();
+//   iterator end();
+//   (and their const versions)
+//
+//   bool empty() const;
+//   size_t size() const;
+//   void clear();
+//
+//   void push_front(const T&);
+//   void push_front(T&&);
+//   void push_back(const T&);
+//   void push_back(T&&);
+//   T& emplace_front(Args&&...);
+//   T& emplace_back(Args&&...);
+//   void pop_front();
+//   void pop_back();
+//
+//   void swap(chunked_deque&);
+
+namespace base {
+
+namespace internal {
+
+// The size of the blocks of chunked_deque, unless they would hold fewer than
+// kChunkedDequeMinBlockElements elements.
+constexpr size_t kChunkedDequeBlockBytes = 1024;
+constexpr size_t kChunkedDequeMinBlockElements = 8;
+
+// A random access iterator over a chunked_deque, by index.
+template <typename Deque, typename T>
+class chunked_deque_iterator {
+ public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = typename std::remove_const<T>::type;
+  using pointer = T*;
+  using reference = T&;
+  using iterator_category = std::random_access_iterator_tag;
+
+  chunked_deque_iterator() : deque_(nullptr), index_(0) {}
+  chunked_deque_iterator(Deque* deque, size_t index)
+      : deque_(deque), index_(index) {}
+
+  // Converts an iterator into a const_iterator.
+  template <typename OtherDeque, typename OtherT>
+  chunked_deque_iterator(
+      const chunked_deque_iterator<OtherDeque, OtherT>& other)
+      : deque_(other.deque_), index_(other.index_) {}
+
+  T& operator*() const { return (*deque_)[index_]; }
+  T* operator->() const { return &(*deque_)[index_]; }
+  T& operator[](difference_type i) const { return (*deque_)[index_ + i]; }
+
+  chunked_deque_iterator& operator++() {
+    ++index_;
+    return *this;
+  }
+  chunked_deque_iterator operator++(int) {
+    chunked_deque_iterator ret = *this;
+    ++index_;
+    return ret;
+  }
+  chunked_deque_iterator& operator--() {
+    --index_;
+    return *this;
+  }
+  chunked_deque_iterator operator--(int) {
+    chunked_deque_iterator ret = *this;
+    --index_;
+    return ret;
+  }
+  chunked_deque_iterator& operator+=(difference_type delta) {
+    index_ += delta;
+    return *this;
+  }
+  chunked_deque_iterator& operator-=(difference_type delta) {
+    index_ -= delta;
+    return *this;
+  }
+  friend chunked_deque_iterator operator+(const chunked_deque_iterator& iter,
+                                          difference_type delta) {
+    chunked_deque_iterator ret = iter;
+    ret += delta;
+    return ret;
+  }
+  friend chunked_deque_iterator operator+(difference_type delta,
+                                          const chunked_deque_iterator& iter) {
+    return iter + delta;
+  }
+  friend chunked_deque_iterator operator-(const chunked_deque_iterator& iter,
+                                          difference_type delta) {
+    chunked_deque_iterator ret = iter;
+    ret -= delta;
+    return ret;
+  }
+  friend difference_type operator-(const chunked_deque_iterator& lhs,
+                                   const chunked_deque_iterator& rhs) {
+    DCHECK_EQ(lhs.deque_, rhs.deque_);
+    return static_cast<difference_type>(lhs.index_) -
+           static_cast<difference_type>(rhs.index_);
+  }
+
+  friend bool operator==(const chunked_deque_iterator& lhs,
+                         const chunked_deque_iterator& rhs) {
+    DCHECK_EQ(lhs.deque_, rhs.deque_);
+    return lhs.index_ == rhs.index_;
+  }
+  friend bool operator!=(const chunked_deque_iterator& lhs,
+                         const chunked_deque_iterator& rhs) {
+    return !(lhs == rhs);
+  }
+  friend bool operator<(const chunked_deque_iterator& lhs,
+                        const chunked_deque_iterator& rhs) {
+    return lhs - rhs < 0;
+  }
+  friend bool operator<=(const chunked_deque_iterator& lhs,
+                         const chunked_deque_iterator& rhs) {
+    return lhs - rhs <= 0;
+  }
+  friend bool operator>(const chunked_deque_iterator& lhs,
+                        const chunked_deque_iterator& rhs) {
+    return lhs - rhs > 0;
+  }
+  friend bool operator>=(const chunked_deque_iterator& lhs,
+                         const chunked_deque_iterator& rhs) {
+    return lhs - rhs >= 0;
+  }
+
+ private:
+  template <typename OtherDeque, typename OtherT>
+  friend class chunked_deque_iterator;
+
+  Deque* deque_;
+  size_t index_;
+};
+
+}  // namespace internal
+
+template <typename T>
+class chunked_deque {
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+  using iterator = internal::chunked_deque_iterator<chunked_deque, T>;
+  using const_iterator =
+      internal::chunked_deque_iterator<const chunked_deque, const T>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  // The number of elements of each block.
+  static constexpr size_t kBlockSize =
+      std::max(internal::kChunkedDequeMinBlockElements,
+               internal::kChunkedDequeBlockBytes / sizeof(T));
+
+  chunked_deque() = default;
+
+  chunked_deque(std::initializer_list<T> values) {
+    for (const T& value : values)
+      push_back(value);
+  }
+
+  chunked_deque(const chunked_deque& other) {
+    for (const T& value : other)
+      push_back(value);
+  }
+
+  chunked_deque(chunked_deque&& other) noexcept { swap(other); }
+
+  ~chunked_deque() {
+    clear();
+    delete spare_block_;
+  }
+
+  chunked_deque& operator=(const chunked_deque& other) {
+    if (&other != this) {
+      clear();
+      for (const T& value : other)
+        push_back(value);
+    }
+    return *this;
+  }
+
+  chunked_deque& operator=(chunked_deque&& other) noexcept {
+    chunked_deque(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  // Random access.
+
+  T& operator[](size_t i) {
+    DCHECK_LT(i, size_);
+    const size_t position = begin_ + i;
+    return blocks_[position / kBlockSize]->at(position % kBlockSize);
+  }
+  const T& operator[](size_t i) const {
+    return const_cast<chunked_deque*>(this)->operator[](i);
+  }
+
+  T& front() { return (*this)[0]; }
+  const T& front() const { return (*this)[0]; }
+  T& back() { return (*this)[size_ - 1]; }
+  const T& back() const { return (*this)[size_ - 1]; }
+
+  // Iterators.
+
+  iterator begin() { return iterator(this, 0); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator cbegin() const { return begin(); }
+  iterator end() { return iterator(this, size_); }
+  const_iterator end() const { return const_iterator(this, size_); }
+  const_iterator cend() const { return end(); }
+
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  // Size.
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+  // Destroys the elements, and frees all the blocks but one.
+  void clear() {
+    while (!empty())
+      pop_back();
+  }
+
+  // End insert and erase.
+
+  void push_front(const T& value) { emplace_front(value); }
+  void push_front(T&& value) { emplace_front(std::move(value)); }
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  template <class... Args>
+  reference emplace_front(Args&&... args) {
+    if (begin_ == 0) {
+      blocks_.push_front(AllocateBlock());
+      begin_ = kBlockSize;
+    }
+    T* value = new (blocks_.front()->slot(begin_ - 1))
+        T(std::forward<Args>(args)...);
+    --begin_;
+    ++size_;
+    return *value;
+  }
+
+  template <class... Args>
+  reference emplace_back(Args&&... args) {
+    const size_t end = begin_ + size_;
+    if (end == blocks_.size() * kBlockSize)
+      blocks_.push_back(AllocateBlock());
+    T* value = new (blocks_.back()->slot(end % kBlockSize))
+        T(std::forward<Args>(args)...);
+    ++size_;
+    return *value;
+  }
+
+  void pop_front() {
+    DCHECK(!empty());
+    front().~T();
+    ++begin_;
+    --size_;
+    if (begin_ == kBlockSize || empty()) {
+      FreeBlock(blocks_.front());
+      blocks_.pop_front();
+      begin_ = 0;
+    }
+  }
+
+  void pop_back() {
+    DCHECK(!empty());
+    back().~T();
+    --size_;
+    if ((begin_ + size_) % kBlockSize == 0 || empty()) {
+      FreeBlock(blocks_.back());
+      blocks_.pop_back();
+      if (empty())
+        begin_ = 0;
+    }
+  }
+
+  void swap(chunked_deque& other) {
+    std::swap(blocks_, other.blocks_);
+    std::swap(begin_, other.begin_);
+    std::swap(size_, other.size_);
+    std::swap(spare_block_, other.spare_block_);
+  }
+
+  friend void swap(chunked_deque& lhs, chunked_deque& rhs) { lhs.swap(rhs); }
+
+ private:
+  class Block {
+   public:
+    void* slot(size_t i) { return &slots_[i]; }
+    T& at(size_t i) { return *reinterpret_cast<T*>(&slots_[i]); }
+
+   private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type
+        slots_[kBlockSize];
+  };
+
+  Block* AllocateBlock() {
+    Block* block = spare_block_;
+    spare_block_ = nullptr;
+    return block ? block : new Block;
+  }
+
+  void FreeBlock(Block* block) {
+    if (spare_block_)
+      delete block;
+    else
+      spare_block_ = block;
+  }
+
+  // The blocks holding the elements, from front to back. The first element is
+  // at |begin_| in the first block, and the blocks past the last element are
+  // freed, so there are no blocks when the deque is empty.
+  circular_deque<Block*> blocks_;
+  size_t begin_ = 0;
+  size_t size_ = 0;
+  // The last freed block, if any, reused by the next allocation.
+  Block* spare_block_ = nullptr;
+};
+
+template <typename T>
+constexpr size_t chunked_deque<T>::kBlockSize;
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_CHUNKED_DEQUE_H_
@@ -0,0 +1,206 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/chunked_deque.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/containers/queue.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Counts its live instances.
+class Counted {
+ public:
+  explicit Counted(int value) : value_(value) { ++num_instances_; }
+  Counted(const Counted& other) : value_(other.value_) { ++num_instances_; }
+  ~Counted() { --num_instances_; }
+
+  int value() const { return value_; }
+  static int num_instances() { return num_instances_; }
+
+ private:
+  int value_;
+  static int num_instances_;
+};
+
+int Counted::num_instances_ = 0;
+
+}  // namespace
+
+TEST(ChunkedDeque, Empty) {
+  chunked_deque<int> deque;
+  EXPECT_TRUE(deque.empty());
+  EXPECT_EQ(0u, deque.size());
+  EXPECT_EQ(deque.begin(), deque.end());
+}
+
+TEST(ChunkedDeque, PushPopBack) {
+  const int kCount = 5 * chunked_deque<int>::kBlockSize + 3;
+  chunked_deque<int> deque;
+  for (int i = 0; i < kCount; ++i) {
+    deque.push_back(i);
+    EXPECT_EQ(i, deque.back());
+    EXPECT_EQ(0, deque.front());
+  }
+  ASSERT_EQ(static_cast<size_t>(kCount), deque.size());
+  for (int i = 0; i < kCount; ++i)
+    EXPECT_EQ(i, deque[i]);
+  for (int i = kCount - 1; i >= 0; --i) {
+    EXPECT_EQ(i, deque.back());
+    deque.pop_back();
+  }
+  EXPECT_TRUE(deque.empty());
+}
+
+TEST(ChunkedDeque, PushFrontPopFront) {
+  const int kCount = 5 * chunked_deque<int>::kBlockSize + 3;
+  chunked_deque<int> deque;
+  for (int i = 0; i < kCount; ++i) {
+    deque.push_front(i);
+    EXPECT_EQ(i, deque.front());
+    EXPECT_EQ(0, deque.back());
+  }
+  for (int i = kCount - 1; i >= 0; --i) {
+    EXPECT_EQ(i, deque.front());
+    deque.pop_front();
+  }
+  EXPECT_TRUE(deque.empty());
+}
+
+TEST(ChunkedDeque, Queue) {
+  // Used as a queue, the deque keeps moving to new blocks.
+  const int kBlockSize = chunked_deque<int>::kBlockSize;
+  chunked_deque<int> deque;
+  int next_push = 0;
+  int next_pop = 0;
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < kBlockSize + round; ++i)
+      deque.push_back(next_push++);
+    for (int i = 0; i < kBlockSize; ++i) {
+      EXPECT_EQ(next_pop++, deque.front());
+      deque.pop_front();
+    }
+    EXPECT_EQ(static_cast<size_t>(next_push - next_pop), deque.size());
+  }
+  while (!deque.empty()) {
+    EXPECT_EQ(next_pop++, deque.front());
+    deque.pop_front();
+  }
+  EXPECT_EQ(next_push, next_pop);
+}
+
+TEST(ChunkedDeque, ReferencesAreStable) {
+  chunked_deque<int> deque;
+  deque.push_back(1);
+  int* first = &deque.front();
+  for (int i = 0; i < 10 * chunked_deque<int>::kBlockSize; ++i) {
+    deque.push_back(i);
+    deque.push_front(i);
+  }
+  EXPECT_EQ(1, *first);
+  EXPECT_EQ(first, &deque[10 * chunked_deque<int>::kBlockSize]);
+}
+
+TEST(ChunkedDeque, Iterators) {
+  chunked_deque<int> deque;
+  for (int i = 0; i < 3 * chunked_deque<int>::kBlockSize; ++i)
+    deque.push_back(i);
+  deque.pop_front();
+  deque.push_front(-1);
+
+  int expected = -1;
+  for (int value : deque) {
+    EXPECT_EQ(expected, value);
+    expected = expected == -1 ? 1 : expected + 1;
+  }
+  EXPECT_EQ(static_cast<std::ptrdiff_t>(deque.size()),
+            deque.end() - deque.begin());
+  EXPECT_EQ(deque.back(), *deque.rbegin());
+  EXPECT_EQ(deque[5], deque.begin()[5]);
+
+  const chunked_deque<int>& const_deque = deque;
+  chunked_deque<int>::const_iterator it = deque.begin();
+  EXPECT_EQ(const_deque.begin(), it);
+  for (chunked_deque<int>::iterator mutable_it = deque.begin();
+       mutable_it != deque.end(); ++mutable_it) {
+    *mutable_it = 0;
+  }
+  EXPECT_EQ(0, const_deque.back());
+}
+
+TEST(ChunkedDeque, DestroysElements) {
+  {
+    chunked_deque<Counted> deque;
+    for (int i = 0; i < 100; ++i)
+      deque.emplace_back(i);
+    for (int i = 0; i < 10; ++i)
+      deque.emplace_front(i);
+    EXPECT_EQ(110, Counted::num_instances());
+    deque.pop_front();
+    deque.pop_back();
+    EXPECT_EQ(108, Counted::num_instances());
+
+    chunked_deque<Counted> copy(deque);
+    EXPECT_EQ(216, Counted::num_instances());
+    EXPECT_EQ(deque.front().value(), copy.front().value());
+    EXPECT_EQ(deque.back().value(), copy.back().value());
+    copy.clear();
+    EXPECT_EQ(108, Counted::num_instances());
+  }
+  EXPECT_EQ(0, Counted::num_instances());
+}
+
+TEST(ChunkedDeque, MoveAndSwap) {
+  chunked_deque<std::unique_ptr<int>> deque;
+  for (int i = 0; i < 20; ++i)
+    deque.push_back(std::make_unique<int>(i));
+
+  chunked_deque<std::unique_ptr<int>> moved(std::move(deque));
+  EXPECT_TRUE(deque.empty());
+  ASSERT_EQ(20u, moved.size());
+  EXPECT_EQ(19, *moved.back());
+
+  chunked_deque<std::unique_ptr<int>> other;
+  other.push_back(std::make_unique<int>(100));
+  swap(moved, other);
+  ASSERT_EQ(1u, moved.size());
+  EXPECT_EQ(100, *moved.front());
+  ASSERT_EQ(20u, other.size());
+
+  moved = std::move(other);
+  EXPECT_EQ(20u, moved.size());
+  EXPECT_EQ(0, *moved.front());
+
+  // The moved from deque is still usable.
+  deque.push_back(std::make_unique<int>(1));
+  EXPECT_EQ(1, *deque.front());
+}
+
+TEST(ChunkedDeque, InitializerListAndCopyAssignment) {
+  chunked_deque<int> deque = {1, 2, 3};
+  chunked_deque<int> copy;
+  copy.push_back(7);
+  copy = deque;
+  EXPECT_EQ(std::vector<int>({1, 2, 3}),
+            std::vector<int>(copy.begin(), copy.end()));
+}
+
+TEST(ChunkedDeque, BaseQueue) {
+  base::queue<std::unique_ptr<int>, chunked_deque<std::unique_ptr<int>>> queue;
+  for (int i = 0; i < 100; ++i)
+    queue.push(std::make_unique<int>(i));
+  queue.emplace(new int(100));
+  for (int i = 0; i <= 100; ++i) {
+    EXPECT_EQ(i, *queue.front());
+    queue.pop();
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace base
@@ -0,0 +1,409 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_CONCURRENT_RING_BUFFER_H_
+#define BASE_CONTAINERS_CONCURRENT_RING_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include "base/bits.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+
+// Bounded queues to pass data between threads without taking a lock:
+//
+//   SPSCRingBuffer: one producer thread and one consumer thread at a time.
+//   MPMCRingBuffer: any number of producer and consumer threads.
+//
+// Both have a fixed capacity, rounded up to a power of two, and allocate all
+// their storage on construction. The Try*() methods never block and return
+// how much was done; the batched versions take the cross-thread cost (cache
+// line transfers, and for MPMCRingBuffer a compare-and-swap) once per batch
+// rather than once per element. The indices written by the producers and by
+// the consumers are kept on separate cache lines so that the two sides don't
+// slow each other down.
+//
+// A thread can also block until there are elements to pop or space to push,
+// with WaitForElements() and WaitForSpace() or the blocking Push() and Pop().
+// A push or a pop only takes a lock when a thread is blocked on the other
+// side, so that the blocking support costs nothing but a memory fence when it
+// isn't used.
+//
+// T must be default constructible and move assignable: all the elements are
+// constructed up front, and elements are moved into and out of them. A popped
+// element is left in its moved-from state until it is overwritten.
+//
+// Example:
+//
+//   SPSCRingBuffer<std::unique_ptr<Frame>> frames(16);
+//
+//   // On the producer thread.
+//   frames.Push(std::move(frame));
+//
+//   // On the consumer thread.
+//   std::unique_ptr<Frame> batch[8];
+//   while (frames.WaitForElements(TimeDelta::Max())) {
+//     size_t count = frames.TryPopBatch(batch, arraysize(batch));
+//     ...
+//   }
+
+namespace base {
+
+namespace internal {
+
+// Assumed size of a cache line. Members aligned on it can't share a cache line
+// even when the storage of the ring buffer itself isn't aligned.
+constexpr size_t kRingBufferCacheLineSize = 64;
+
+// The threads blocked on one side of a ring buffer. Cheap to notify when there
+// are none.
+class RingBufferWaiters {
+ public:
+  RingBufferWaiters() : condition_(&lock_) {}
+
+  // Blocks until |is_ready| returns true, for at most |timeout|. Returns what
+  // |is_ready| last returned. |is_ready| must read the state of the ring
+  // buffer with acquire loads.
+  template <typename Predicate>
+  bool Wait(Predicate is_ready, TimeDelta timeout) {
+    if (is_ready())
+      return true;
+
+    const TimeTicks deadline =
+        timeout.is_max() ? TimeTicks::Max() : TimeTicks::Now() + timeout;
+    AutoLock auto_lock(lock_);
+    num_waiters_.fetch_add(1, std::memory_order_relaxed);
+    // Pairs with the fence in NotifyAll(): either the notifier sees this
+    // waiter, or |is_ready| sees the change made before the notification.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool ready;
+    while (!(ready = is_ready())) {
+      if (deadline.is_max()) {
+        condition_.Wait();
+        continue;
+      }
+      const TimeDelta remaining = deadline - TimeTicks::Now();
+      if (remaining <= TimeDelta())
+        break;
+      condition_.TimedWait(remaining);
+    }
+    num_waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return ready;
+  }
+
+  // Wakes up the waiting threads, which check their predicate again.
+  void NotifyAll() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (num_waiters_.load(std::memory_order_relaxed) == 0)
+      return;
+    AutoLock auto_lock(lock_);
+    condition_.Broadcast();
+  }
+
+ private:
+  std::atomic<int> num_waiters_{0};
+  Lock lock_;
+  ConditionVariable condition_;
+
+  DISALLOW_COPY_AND_ASSIGN(RingBufferWaiters);
+};
+
+// Returns |capacity| rounded up to a power of two.
+inline size_t RingBufferSizeForCapacity(size_t capacity) {
+  DCHECK_GT(capacity, 0u);
+  DCHECK_LE(capacity, size_t(1) << 31);
+  return size_t(1) << bits::Log2Ceiling(static_cast<uint32_t>(capacity));
+}
+
+}  // namespace internal
+
+template <typename T>
+class SPSCRingBuffer {
+ public:
+  // |capacity| is rounded up to a power of two.
+  explicit SPSCRingBuffer(size_t capacity)
+      : mask_(internal::RingBufferSizeForCapacity(capacity) - 1),
+        elements_(new T[mask_ + 1]) {}
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // Producer side.
+
+  // Pushes as many of the |count| |values| as fit, in order, and returns how
+  // many it pushed. The pushed values are moved from.
+  size_t TryPushBatch(T* values, size_t count) {
+    const size_t tail = producer_.index.load(std::memory_order_relaxed);
+    size_t free = capacity() - (tail - producer_.cached_other_index);
+    if (free < count) {
+      producer_.cached_other_index =
+          consumer_.index.load(std::memory_order_acquire);
+      free = capacity() - (tail - producer_.cached_other_index);
+    }
+    count = std::min(count, free);
+    if (!count)
+      return 0;
+    for (size_t i = 0; i < count; ++i)
+      elements_[(tail + i) & mask_] = std::move(values[i]);
+    producer_.index.store(tail + count, std::memory_order_release);
+    consumer_waiters_.NotifyAll();
+    return count;
+  }
+
+  // |value| is only moved from if it was pushed.
+  bool TryPush(T&& value) { return TryPushBatch(&value, 1) == 1; }
+
+  // Blocks until |value| is pushed.
+  void Push(T value) {
+    while (!TryPushBatch(&value, 1))
+      WaitForSpace(TimeDelta::Max());
+  }
+
+  // Blocks until there is space for at least one element, for at most
+  // |timeout|. Returns false on time out.
+  bool WaitForSpace(TimeDelta timeout) {
+    return producer_waiters_.Wait(
+        [this]() {
+          return producer_.index.load(std::memory_order_relaxed) -
+                     consumer_.index.load(std::memory_order_acquire) <
+                 capacity();
+        },
+        timeout);
+  }
+
+  // Consumer side.
+
+  // Pops up to |max_count| elements into |values|, in order, and returns how
+  // many it popped.
+  size_t TryPopBatch(T* values, size_t max_count) {
+    const size_t head = consumer_.index.load(std::memory_order_relaxed);
+    size_t available = consumer_.cached_other_index - head;
+    if (available < max_count) {
+      consumer_.cached_other_index =
+          producer_.index.load(std::memory_order_acquire);
+      available = consumer_.cached_other_index - head;
+    }
+    const size_t count = std::min(max_count, available);
+    if (!count)
+      return 0;
+    for (size_t i = 0; i < count; ++i)
+      values[i] = std::move(elements_[(head + i) & mask_]);
+    consumer_.index.store(head + count, std::memory_order_release);
+    producer_waiters_.NotifyAll();
+    return count;
+  }
+
+  bool TryPop(T* value) { return TryPopBatch(value, 1) == 1; }
+
+  // Blocks until an element is popped into |value|.
+  void Pop(T* value) {
+    while (!TryPop(value))
+      WaitForElements(TimeDelta::Max());
+  }
+
+  // Blocks until there is at least one element to pop, for at most |timeout|.
+  // Returns false on time out.
+  bool WaitForElements(TimeDelta timeout) {
+    return consumer_waiters_.Wait(
+        [this]() {
+          return producer_.index.load(std::memory_order_acquire) !=
+                 consumer_.index.load(std::memory_order_relaxed);
+        },
+        timeout);
+  }
+
+ private:
+  // The state owned by one side. |index| is the number of elements pushed or
+  // popped so far, which is only written by that side, and
+  // |cached_other_index| is the other side's index as of when it was last
+  // read, which is enough to know that there are elements or space left
+  // without touching the other side's cache line.
+  struct alignas(internal::kRingBufferCacheLineSize) Side {
+    std::atomic<size_t> index{0};
+    size_t cached_other_index = 0;
+  };
+
+  const size_t mask_;
+  const std::unique_ptr<T[]> elements_;
+
+  Side producer_;
+  Side consumer_;
+
+  internal::RingBufferWaiters producer_waiters_;
+  internal::RingBufferWaiters consumer_waiters_;
+
+  DISALLOW_COPY_AND_ASSIGN(SPSCRingBuffer);
+};
+
+// Based on Dmitry Vyukov's bounded MPMC queue: each element has a sequence
+// number which says whether it is ready to be written or read at a given
+// position, and the producers and the consumers each claim positions by
+// advancing their index with a compare-and-swap.
+template <typename T>
+class MPMCRingBuffer {
+ public:
+  // |capacity| is rounded up to a power of two.
+  explicit MPMCRingBuffer(size_t capacity)
+      : mask_(internal::RingBufferSizeForCapacity(capacity) - 1),
+        cells_(new Cell[mask_ + 1]) {
+    for (size_t i = 0; i <= mask_; ++i)
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // Producer side.
+
+  // Pushes as many of the |count| |values| as fit, in order, and returns how
+  // many it pushed. The values of one call are contiguous in the buffer, but
+  // there is no ordering between concurrent producers. The pushed values are
+  // moved from.
+  size_t TryPushBatch(T* values, size_t count) {
+    size_t position;
+    count = ClaimPositions(&producer_index_, 0, count, &position);
+    for (size_t i = 0; i < count; ++i) {
+      Cell& cell = cells_[(position + i) & mask_];
+      cell.value = std::move(values[i]);
+      cell.sequence.store(position + i + 1, std::memory_order_release);
+    }
+    if (count)
+      consumer_waiters_.NotifyAll();
+    return count;
+  }
+
+  // |value| is only moved from if it was pushed.
+  bool TryPush(T&& value) { return TryPushBatch(&value, 1) == 1; }
+
+  // Blocks until |value| is pushed.
+  void Push(T value) {
+    while (!TryPushBatch(&value, 1))
+      WaitForSpace(TimeDelta::Max());
+  }
+
+  // Blocks until there is space for at least one element, for at most
+  // |timeout|. Returns false on time out. Another producer may take the space
+  // before this one pushes.
+  bool WaitForSpace(TimeDelta timeout) {
+    return producer_waiters_.Wait(
+        [this]() { return IsPositionReady(&producer_index_, 0); }, timeout);
+  }
+
+  // Consumer side.
+
+  // Pops up to |max_count| elements into |values| and returns how many it
+  // popped. The elements pushed by one producer are popped in order.
+  size_t TryPopBatch(T* values, size_t max_count) {
+    size_t position;
+    const size_t count =
+        ClaimPositions(&consumer_index_, 1, max_count, &position);
+    for (size_t i = 0; i < count; ++i) {
+      Cell& cell = cells_[(position + i) & mask_];
+      values[i] = std::move(cell.value);
+      cell.sequence.store(position + i + mask_ + 1, std::memory_order_release);
+    }
+    if (count)
+      producer_waiters_.NotifyAll();
+    return count;
+  }
+
+  bool TryPop(T* value) { return TryPopBatch(value, 1) == 1; }
+
+  // Blocks until an element is popped into |value|.
+  void Pop(T* value) {
+    while (!TryPop(value))
+      WaitForElements(TimeDelta::Max());
+  }
+
+  // Blocks until there is at least one element to pop, for at most |timeout|.
+  // Returns false on time out. Another consumer may pop the element before
+  // this one does.
+  bool WaitForElements(TimeDelta timeout) {
+    return consumer_waiters_.Wait(
+        [this]() { return IsPositionReady(&consumer_index_, 1); }, timeout);
+  }
+
+ private:
+  struct Cell {
+    // Equals the position for which the cell can be written, or the position
+    // plus one once it can be read.
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  struct alignas(internal::kRingBufferCacheLineSize) AlignedIndex {
+    std::atomic<size_t> value{0};
+  };
+
+  // Returns whether the cell at |index| can be used, i.e. whether its
+  // sequence is the index plus |offset| (0 for the producers and 1 for the
+  // consumers).
+  bool IsPositionReady(const AlignedIndex* index, size_t offset) const {
+    const size_t position = index->value.load(std::memory_order_relaxed);
+    return cells_[position & mask_].sequence.load(std::memory_order_acquire) ==
+           position + offset;
+  }
+
+  // Claims up to |max_count| consecutive ready positions from |index|, and
+  // returns how many it claimed, starting at |*position|.
+  size_t ClaimPositions(AlignedIndex* index,
+                        size_t offset,
+                        size_t max_count,
+                        size_t* position) {
+    size_t first = index->value.load(std::memory_order_relaxed);
+    for (;;) {
+      size_t count = 0;
+      bool stale = false;
+      while (count < max_count) {
+        const size_t sequence =
+            cells_[(first + count) & mask_].sequence.load(
+                std::memory_order_acquire);
+        const intptr_t difference = static_cast<intptr_t>(sequence) -
+                                    static_cast<intptr_t>(first + count +
+                                                          offset);
+        if (difference != 0) {
+          // A sequence ahead of the position means that another thread
+          // already claimed it and |first| is out of date.
+          stale = difference > 0 && count == 0;
+          break;
+        }
+        ++count;
+      }
+      if (count == 0 && !stale)
+        return 0;
+      // The cells seen ready stay ready until their positions are claimed,
+      // which only this compare-and-swap can do.
+      if (count &&
+          index->value.compare_exchange_weak(first, first + count,
+                                             std::memory_order_relaxed)) {
+        *position = first;
+        return count;
+      }
+      if (stale)
+        first = index->value.load(std::memory_order_relaxed);
+    }
+  }
+
+  const size_t mask_;
+  const std::unique_ptr<Cell[]> cells_;
+
+  AlignedIndex producer_index_;
+  AlignedIndex consumer_index_;
+
+  internal::RingBufferWaiters producer_waiters_;
+  internal::RingBufferWaiters consumer_waiters_;
+
+  DISALLOW_COPY_AND_ASSIGN(MPMCRingBuffer);
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_CONCURRENT_RING_BUFFER_H_
@@ -0,0 +1,233 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/concurrent_ring_buffer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/macros.h"
+#include "base/single_thread_task_runner.h"
+#include "base/test/test_timeouts.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kNumElements = 100000;
+
+template <typename RingBuffer>
+class ConcurrentRingBufferTest : public testing::Test {};
+
+using RingBufferTypes =
+    testing::Types<SPSCRingBuffer<int>, MPMCRingBuffer<int>>;
+TYPED_TEST_CASE(ConcurrentRingBufferTest, RingBufferTypes);
+
+// Pushes 0 to |kNumElements| - 1 to |ring_buffer|, in batches of
+// |batch_size|.
+template <typename RingBuffer>
+void PushElements(RingBuffer* ring_buffer, size_t batch_size) {
+  std::vector<int> batch(batch_size);
+  size_t pushed = 0;
+  while (pushed < kNumElements) {
+    const size_t count = std::min(batch_size, kNumElements - pushed);
+    for (size_t i = 0; i < count; ++i)
+      batch[i] = static_cast<int>(pushed + i);
+    size_t done = 0;
+    while (done < count) {
+      done += ring_buffer->TryPushBatch(batch.data() + done, count - done);
+      if (done < count)
+        ring_buffer->WaitForSpace(TimeDelta::Max());
+    }
+    pushed += count;
+  }
+}
+
+}  // namespace
+
+TYPED_TEST(ConcurrentRingBufferTest, PushAndPop) {
+  TypeParam ring_buffer(3);
+  EXPECT_EQ(4u, ring_buffer.capacity());
+
+  int value = 0;
+  EXPECT_FALSE(ring_buffer.TryPop(&value));
+  EXPECT_FALSE(ring_buffer.WaitForElements(TimeDelta::FromMilliseconds(1)));
+
+  // Wrap around the end of the buffer a few times.
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(ring_buffer.TryPush(i * 2));
+    EXPECT_TRUE(ring_buffer.TryPush(i * 2 + 1));
+    EXPECT_TRUE(ring_buffer.WaitForElements(TimeDelta()));
+    EXPECT_TRUE(ring_buffer.TryPop(&value));
+    EXPECT_EQ(i * 2, value);
+    EXPECT_TRUE(ring_buffer.TryPop(&value));
+    EXPECT_EQ(i * 2 + 1, value);
+  }
+  EXPECT_FALSE(ring_buffer.TryPop(&value));
+}
+
+TYPED_TEST(ConcurrentRingBufferTest, Full) {
+  TypeParam ring_buffer(4);
+  for (int i = 0; i < 4; ++i)
+    EXPECT_TRUE(ring_buffer.TryPush(int(i)));
+  EXPECT_FALSE(ring_buffer.TryPush(4));
+  EXPECT_FALSE(ring_buffer.WaitForSpace(TimeDelta::FromMilliseconds(1)));
+
+  int value = 0;
+  EXPECT_TRUE(ring_buffer.TryPop(&value));
+  EXPECT_EQ(0, value);
+  EXPECT_TRUE(ring_buffer.WaitForSpace(TimeDelta()));
+  EXPECT_TRUE(ring_buffer.TryPush(4));
+  EXPECT_FALSE(ring_buffer.TryPush(5));
+}
+
+TYPED_TEST(ConcurrentRingBufferTest, Batches) {
+  TypeParam ring_buffer(8);
+  int values[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  EXPECT_EQ(8u, ring_buffer.TryPushBatch(values, 10));
+  EXPECT_EQ(0u, ring_buffer.TryPushBatch(values + 8, 2));
+
+  int popped[10] = {};
+  EXPECT_EQ(3u, ring_buffer.TryPopBatch(popped, 3));
+  EXPECT_EQ(2u, ring_buffer.TryPushBatch(values + 8, 2));
+  EXPECT_EQ(7u, ring_buffer.TryPopBatch(popped + 3, 10));
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(i, popped[i]);
+  EXPECT_EQ(0u, ring_buffer.TryPopBatch(popped, 10));
+}
+
+TYPED_TEST(ConcurrentRingBufferTest, BlockingPop) {
+  TypeParam ring_buffer(4);
+  Thread producer("Producer");
+  ASSERT_TRUE(producer.Start());
+  producer.task_runner()->PostTask(
+      FROM_HERE, BindOnce(
+                     [](TypeParam* ring_buffer) {
+                       PlatformThread::Sleep(TimeDelta::FromMilliseconds(10));
+                       ring_buffer->Push(42);
+                     },
+                     Unretained(&ring_buffer)));
+  int value = 0;
+  ring_buffer.Pop(&value);
+  EXPECT_EQ(42, value);
+  producer.Stop();
+}
+
+TYPED_TEST(ConcurrentRingBufferTest, OneProducerOneConsumer) {
+  const size_t kBatchSizes[] = {1, 7, 64};
+  for (size_t batch_size : kBatchSizes) {
+    TypeParam ring_buffer(32);
+    Thread producer("Producer");
+    ASSERT_TRUE(producer.Start());
+    producer.task_runner()->PostTask(
+        FROM_HERE, BindOnce(&PushElements<TypeParam>, Unretained(&ring_buffer),
+                            batch_size));
+
+    // Everything is popped in order.
+    std::vector<int> batch(batch_size);
+    size_t popped = 0;
+    while (popped < kNumElements) {
+      ASSERT_TRUE(ring_buffer.WaitForElements(
+          TestTimeouts::action_max_timeout()));
+      const size_t count = ring_buffer.TryPopBatch(batch.data(), batch_size);
+      for (size_t i = 0; i < count; ++i)
+        ASSERT_EQ(static_cast<int>(popped + i), batch[i]);
+      popped += count;
+    }
+    producer.Stop();
+    int value = 0;
+    EXPECT_FALSE(ring_buffer.TryPop(&value));
+  }
+}
+
+TYPED_TEST(ConcurrentRingBufferTest, MoveOnly) {
+  using MoveOnlyRingBuffer = typename std::conditional<
+      std::is_same<TypeParam, SPSCRingBuffer<int>>::value,
+      SPSCRingBuffer<std::unique_ptr<int>>,
+      MPMCRingBuffer<std::unique_ptr<int>>>::type;
+  MoveOnlyRingBuffer ring_buffer(1);
+  std::unique_ptr<int> value = std::make_unique<int>(1);
+  EXPECT_TRUE(ring_buffer.TryPush(std::move(value)));
+  EXPECT_FALSE(value);
+
+  // A value which can't be pushed is left alone.
+  value = std::make_unique<int>(2);
+  EXPECT_FALSE(ring_buffer.TryPush(std::move(value)));
+  EXPECT_TRUE(value);
+
+  std::unique_ptr<int> popped;
+  EXPECT_TRUE(ring_buffer.TryPop(&popped));
+  ASSERT_TRUE(popped);
+  EXPECT_EQ(1, *popped);
+}
+
+TEST(MPMCRingBufferTest, ManyProducersManyConsumers) {
+  constexpr int kNumProducers = 4;
+  constexpr int kNumConsumers = 4;
+  MPMCRingBuffer<int> ring_buffer(64);
+
+  std::vector<std::unique_ptr<Thread>> producers;
+  for (int i = 0; i < kNumProducers; ++i) {
+    producers.push_back(std::make_unique<Thread>("Producer"));
+    ASSERT_TRUE(producers.back()->Start());
+    producers.back()->task_runner()->PostTask(
+        FROM_HERE, BindOnce(&PushElements<MPMCRingBuffer<int>>,
+                            Unretained(&ring_buffer), i + 1));
+  }
+
+  // Each consumer stops at the first -1, and adds up what it popped.
+  std::vector<int64_t> sums(kNumConsumers);
+  std::vector<std::unique_ptr<Thread>> consumers;
+  for (int i = 0; i < kNumConsumers; ++i) {
+    consumers.push_back(std::make_unique<Thread>("Consumer"));
+    ASSERT_TRUE(consumers.back()->Start());
+    consumers.back()->task_runner()->PostTask(
+        FROM_HERE, BindOnce(
+                       [](MPMCRingBuffer<int>* ring_buffer, int64_t* sum) {
+                         int batch[16];
+                         for (;;) {
+                           ring_buffer->WaitForElements(TimeDelta::Max());
+                           size_t count = ring_buffer->TryPopBatch(
+                               batch, arraysize(batch));
+                           for (size_t j = 0; j < count; ++j) {
+                             if (batch[j] == -1) {
+                               // Pushes back the rest, for the others.
+                               for (++j; j < count; ++j)
+                                 ring_buffer->Push(batch[j]);
+                               return;
+                             }
+                             *sum += batch[j];
+                           }
+                         }
+                       },
+                       Unretained(&ring_buffer), Unretained(&sums[i])));
+  }
+
+  for (const auto& producer : producers)
+    producer->Stop();
+  for (int i = 0; i < kNumConsumers; ++i)
+    ring_buffer.Push(-1);
+  for (const auto& consumer : consumers)
+    consumer->Stop();
+
+  int64_t total = 0;
+  for (int64_t sum : sums)
+    total += sum;
+  const int64_t kExpectedSumPerProducer =
+      static_cast<int64_t>(kNumElements) * (kNumElements - 1) / 2;
+  EXPECT_EQ(kNumProducers * kExpectedSumPerProducer, total);
+}
+
+}  // namespace base
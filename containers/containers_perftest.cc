@@ -0,0 +1,151 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/containers/chunked_deque.h"
+#include "base/containers/circular_deque.h"
+#include "base/containers/flat_map.h"
+#include "base/containers/small_map.h"
+#include "base/containers/small_vector.h"
+#include "base/debug/alias.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/perf_benchmark.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// Benchmarks of the small containers, which are used in hot paths for their
+// speed at the sizes they're built for. The lookups in large maps are
+// benchmarked by flat_hash_map_perftest.cc.
+
+namespace base {
+
+namespace {
+
+// The iterations of each benchmark handle about this many elements.
+constexpr int kElements = 100000;
+
+// Returns |count| distinct keys, in a random-looking order.
+std::vector<uint32_t> MakeKeys(size_t count) {
+  std::vector<uint32_t> keys(count);
+  for (size_t i = 0; i < count; ++i)
+    keys[i] = static_cast<uint32_t>(i * 0x9E3779B9u);
+  return keys;
+}
+
+// Benchmarks building a |Map| of |size| elements one at a time, and then
+// finding each of them.
+template <typename Map>
+void RunMapTest(const std::string& name, size_t size) {
+  const std::vector<uint32_t> keys = MakeKeys(size);
+  const int num_iterations = kElements / size;
+  PerfBenchmark insert_benchmark(
+      "containers", name + "_insert_" + NumberToString(size), num_iterations);
+  insert_benchmark.Run([&](int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      Map map;
+      for (uint32_t key : keys)
+        map[key] = key;
+      debug::Alias(&map);
+    }
+  });
+
+  Map map;
+  for (uint32_t key : keys)
+    map[key] = key;
+  PerfBenchmark find_benchmark(
+      "containers", name + "_find_" + NumberToString(size), num_iterations);
+  find_benchmark.Run([&](int iterations) {
+    size_t found = 0;
+    for (int i = 0; i < iterations; ++i) {
+      for (uint32_t key : keys)
+        found += map.find(key) != map.end();
+    }
+    EXPECT_EQ(keys.size() * iterations, found);
+  });
+}
+
+// Benchmarks a |Deque| used as a queue of |size| elements: each iteration
+// pushes |size| elements, then pops them.
+template <typename Deque>
+void RunQueueTest(const std::string& name, size_t size) {
+  Deque deque;
+  PerfBenchmark benchmark("containers",
+                          name + "_push_pop_" + NumberToString(size),
+                          kElements / size);
+  benchmark.Run([&](int iterations) {
+    size_t sum = 0;
+    for (int i = 0; i < iterations; ++i) {
+      for (size_t j = 0; j < size; ++j)
+        deque.push_back(j);
+      while (!deque.empty()) {
+        sum += deque.front();
+        deque.pop_front();
+      }
+    }
+    EXPECT_EQ(size * (size - 1) / 2 * iterations, sum);
+  });
+}
+
+// Benchmarks building a |Vector| of |size| elements one at a time.
+template <typename Vector>
+void RunVectorTest(const std::string& name, size_t size) {
+  PerfBenchmark benchmark("containers",
+                          name + "_push_back_" + NumberToString(size),
+                          kElements / size);
+  benchmark.Run([&](int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      Vector vector;
+      for (size_t j = 0; j < size; ++j)
+        vector.push_back(j);
+      debug::Alias(&vector);
+    }
+  });
+}
+
+}  // namespace
+
+TEST(ContainersPerfTest, FlatMap) {
+  for (size_t size : {4, 16, 64})
+    RunMapTest<flat_map<uint32_t, uint32_t>>("flat_map", size);
+}
+
+TEST(ContainersPerfTest, SmallMap) {
+  // Up to 4 elements, small_map is an array.
+  for (size_t size : {4, 16, 64}) {
+    RunMapTest<small_map<std::unordered_map<uint32_t, uint32_t>>>("small_map",
+                                                                  size);
+  }
+}
+
+TEST(ContainersPerfTest, UnorderedMap) {
+  for (size_t size : {4, 16, 64})
+    RunMapTest<std::unordered_map<uint32_t, uint32_t>>("unordered_map", size);
+}
+
+TEST(ContainersPerfTest, CircularDeque) {
+  for (size_t size : {16, 1024})
+    RunQueueTest<circular_deque<size_t>>("circular_deque", size);
+}
+
+TEST(ContainersPerfTest, ChunkedDeque) {
+  for (size_t size : {16, 1024})
+    RunQueueTest<chunked_deque<size_t>>("chunked_deque", size);
+}
+
+TEST(ContainersPerfTest, SmallVector) {
+  for (size_t size : {4, 8})
+    RunVectorTest<small_vector<size_t, 8>>("small_vector", size);
+}
+
+TEST(ContainersPerfTest, Vector) {
+  for (size_t size : {4, 8})
+    RunVectorTest<std::vector<size_t>>("vector", size);
+}
+
+}  // namespace base
@@ -0,0 +1,237 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_FLAT_HASH_MAP_H_
+#define BASE_CONTAINERS_FLAT_HASH_MAP_H_
+
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "base/containers/flat_hash_table.h"
+#include "base/containers/flat_map.h"
+
+namespace base {
+
+// flat_hash_map is a container with a std::unordered_map-like interface that
+// stores its contents in an open-addressing hash table.
+//
+// Please see //base/containers/README.md for an overview of which container
+// to select.
+//
+// PROS
+//
+//  - Lookups, inserts and removals are O(1) on average.
+//  - No allocation per element, and lookups usually touch a single cache line
+//    of metadata before the element they find.
+//  - std::string keys can be looked up by StringPiece with the default hasher.
+//
+// CONS
+//
+//  - Iteration order is unspecified, and changes across rehashes.
+//  - Needs a good hash function: its low 7 bits and its other bits are used
+//    separately. Integers are mixed before use, so std::hash is fine.
+//  - Memory for all the slots is allocated up front, so large values waste
+//    space at low load factors. Store them by std::unique_ptr.
+//
+// IMPORTANT NOTES
+//
+//  - Iterators and references are invalidated by insertions which rehash, and
+//    by the other operations which say so below. Removals only invalidate the
+//    removed elements.
+//  - Elements are moved when the table rehashes.
+//  - As in flat_map, the value_type is std::pair<Key, Mapped>: the key must
+//    not be modified through an iterator.
+//
+// QUICK REFERENCE
+//
+// Most of the core functionality is inherited from flat_hash_table. Please see
+// flat_hash_table.h for more details for most of these functions. As a quick
+// reference, the functions available are:
+//
+// Constructors:
+//   flat_hash_map(size_t bucket_count,
+//                 const Hash& = Hash(),
+//                 const KeyEqual& = KeyEqual());
+//   flat_hash_map(InputIterator first, InputIterator last,
+//                 size_t bucket_count = 0,
+//                 const Hash& = Hash(),
+//                 const KeyEqual& = KeyEqual());
+//   flat_hash_map(const flat_hash_map&);
+//   flat_hash_map(flat_hash_map&&);
+//   flat_hash_map(std::initializer_list<value_type> ilist,
+//                 size_t bucket_count = 0,
+//                 const Hash& = Hash(),
+//                 const KeyEqual& = KeyEqual());
+//
+// Assignment functions:
+//   flat_hash_map& operator=(const flat_hash_map&);
+//   flat_hash_map& operator=(flat_hash_map&&);
+//   flat_hash_map& operator=(initializer_list<value_type>);
+//
+// Memory management functions:
+//   void   reserve(size_t);
+//   size_t capacity() const;
+//   void   rehash(size_t);
+//
+// Size management functions:
+//   void   clear();
+//   size_t size() const;
+//   size_t max_size() const;
+//   bool   empty() const;
+//
+// Iterator functions:
+//   iterator       begin();
+//   const_iterator begin() const;
+//   const_iterator cbegin() const;
+//   iterator       end();
+//   const_iterator end() const;
+//   const_iterator cend() const;
+//
+// Insert and accessor functions:
+//   mapped_type&         operator[](const key_type&);
+//   mapped_type&         operator[](key_type&&);
+//   pair<iterator, bool> insert(const value_type&);
+//   pair<iterator, bool> insert(value_type&&);
+//   void                 insert(InputIterator first, InputIterator last);
+//   pair<iterator, bool> insert_or_assign(K&&, M&&);
+//   pair<iterator, bool> emplace(Args&&...);
+//   pair<iterator, bool> try_emplace(K&&, Args&&...);
+//
+// Erase functions:
+//   iterator erase(iterator);
+//   iterator erase(const_iterator);
+//   iterator erase(const_iterator first, const_iterator last);
+//   template <typename K> size_t erase(const K& key);
+//
+// Observers:
+//   hasher    hash_function() const;
+//   key_equal key_eq() const;
+//
+// Search functions:
+//   template <typename K> size_t                   count(const K&) const;
+//   template <typename K> iterator                 find(const K&);
+//   template <typename K> const_iterator           find(const K&) const;
+//   template <typename K> pair<iterator, iterator> equal_range(const K&);
+//
+// General functions:
+//   void swap(flat_hash_map&);
+//
+// Non-member operators:
+//   bool operator==(const flat_hash_map&, const flat_hash_map&);
+//   bool operator!=(const flat_hash_map&, const flat_hash_map&);
+//
+template <class Key,
+          class Mapped,
+          class Hash = FlatHash<Key>,
+          class KeyEqual = std::equal_to<>>
+class flat_hash_map
+    : public ::base::internal::flat_hash_table<
+          Key,
+          std::pair<Key, Mapped>,
+          ::base::internal::GetKeyFromValuePairFirst<Key, Mapped>,
+          Hash,
+          KeyEqual> {
+ private:
+  using table = typename ::base::internal::flat_hash_table<
+      Key,
+      std::pair<Key, Mapped>,
+      ::base::internal::GetKeyFromValuePairFirst<Key, Mapped>,
+      Hash,
+      KeyEqual>;
+
+ public:
+  using key_type = typename table::key_type;
+  using mapped_type = Mapped;
+  using value_type = typename table::value_type;
+  using iterator = typename table::iterator;
+  using const_iterator = typename table::const_iterator;
+
+  // --------------------------------------------------------------------------
+  // Lifetime and assignments.
+
+  using table::table;
+  using table::operator=;
+
+  // --------------------------------------------------------------------------
+  // Map-specific insert operations.
+  //
+  // Normal insert() functions are inherited from flat_hash_table. These look
+  // up the key before constructing anything.
+
+  mapped_type& operator[](const key_type& key);
+  mapped_type& operator[](key_type&& key);
+
+  template <class K, class M>
+  std::pair<iterator, bool> insert_or_assign(K&& key, M&& obj);
+
+  template <class K, class... Args>
+  std::enable_if_t<std::is_constructible<key_type, K&&>::value,
+                   std::pair<iterator, bool>>
+  try_emplace(K&& key, Args&&... args);
+
+  // --------------------------------------------------------------------------
+  // General operations.
+  //
+  // Assume that swap invalidates iterators and references.
+
+  void swap(flat_hash_map& other) noexcept;
+
+  friend void swap(flat_hash_map& lhs, flat_hash_map& rhs) noexcept {
+    lhs.swap(rhs);
+  }
+};
+
+// ----------------------------------------------------------------------------
+// Insert operations.
+
+template <class Key, class Mapped, class Hash, class KeyEqual>
+auto flat_hash_map<Key, Mapped, Hash, KeyEqual>::operator[](
+    const key_type& key) -> mapped_type& {
+  return try_emplace(key).first->second;
+}
+
+template <class Key, class Mapped, class Hash, class KeyEqual>
+auto flat_hash_map<Key, Mapped, Hash, KeyEqual>::operator[](key_type&& key)
+    -> mapped_type& {
+  return try_emplace(std::move(key)).first->second;
+}
+
+template <class Key, class Mapped, class Hash, class KeyEqual>
+template <class K, class M>
+auto flat_hash_map<Key, Mapped, Hash, KeyEqual>::insert_or_assign(K&& key,
+                                                                  M&& obj)
+    -> std::pair<iterator, bool> {
+  auto result =
+      table::emplace_key_args(key, std::forward<K>(key), std::forward<M>(obj));
+  if (!result.second)
+    result.first->second = std::forward<M>(obj);
+  return result;
+}
+
+template <class Key, class Mapped, class Hash, class KeyEqual>
+template <class K, class... Args>
+auto flat_hash_map<Key, Mapped, Hash, KeyEqual>::try_emplace(K&& key,
+                                                             Args&&... args)
+    -> std::enable_if_t<std::is_constructible<key_type, K&&>::value,
+                        std::pair<iterator, bool>> {
+  return table::emplace_key_args(
+      key, std::piecewise_construct,
+      std::forward_as_tuple(std::forward<K>(key)),
+      std::forward_as_tuple(std::forward<Args>(args)...));
+}
+
+// ----------------------------------------------------------------------------
+// General operations.
+
+template <class Key, class Mapped, class Hash, class KeyEqual>
+void flat_hash_map<Key, Mapped, Hash, KeyEqual>::swap(
+    flat_hash_map& other) noexcept {
+  table::swap(other);
+}
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_HASH_MAP_H_
@@ -0,0 +1,139 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/flat_hash_map.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/debug/alias.h"
+#include "base/macros.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+// Does about this many lookups for each size.
+const size_t kLookups = 10 * 1000 * 1000;
+
+const size_t kSizes[] = {16, 1000, 100 * 1000, 1000 * 1000};
+
+// Returns |count| distinct keys, in a random-looking order.
+std::vector<uint64_t> MakeIntKeys(size_t count) {
+  std::vector<uint64_t> keys(count);
+  for (size_t i = 0; i < count; ++i)
+    keys[i] = i * 0x9E3779B97F4A7C15ULL;
+  return keys;
+}
+
+std::vector<std::string> MakeStringKeys(size_t count) {
+  std::vector<std::string> keys(count);
+  for (size_t i = 0; i < count; ++i)
+    keys[i] = "key_" + NumberToString(i * 0x9E3779B97F4A7C15ULL);
+  return keys;
+}
+
+template <class Map>
+Map Build(const std::vector<typename Map::key_type>& keys) {
+  Map map;
+  for (size_t i = 0; i < keys.size(); ++i)
+    map.insert({keys[i], i});
+  return map;
+}
+
+// flat_map is built in one go: inserting the elements one at a time would be
+// quadratic.
+template <>
+flat_map<uint64_t, size_t> Build(const std::vector<uint64_t>& keys) {
+  std::vector<std::pair<uint64_t, size_t>> items;
+  for (size_t i = 0; i < keys.size(); ++i)
+    items.emplace_back(keys[i], i);
+  return flat_map<uint64_t, size_t>(std::move(items));
+}
+
+template <>
+flat_map<std::string, size_t> Build(const std::vector<std::string>& keys) {
+  std::vector<std::pair<std::string, size_t>> items;
+  for (size_t i = 0; i < keys.size(); ++i)
+    items.emplace_back(keys[i], i);
+  return flat_map<std::string, size_t>(std::move(items));
+}
+
+template <class Map>
+void RunTest(const char* name,
+             const std::vector<typename Map::key_type>& all_keys) {
+  for (size_t size : kSizes) {
+    // The first half of the keys are in the map, and the second half aren't.
+    const std::vector<typename Map::key_type> keys(
+        all_keys.begin(), all_keys.begin() + size * 2);
+    const std::vector<typename Map::key_type> present(keys.begin(),
+                                                      keys.begin() + size);
+
+    TimeTicks start = TimeTicks::Now();
+    const Map map = Build<Map>(present);
+    TimeDelta elapsed = TimeTicks::Now() - start;
+    perf_test::PrintResult("build", StringPrintf("_%zu", size), name,
+                           elapsed.InNanoseconds() / static_cast<double>(size),
+                           "ns/element", true);
+
+    const size_t iterations = std::max<size_t>(kLookups / size, 1);
+    size_t found = 0;
+    start = TimeTicks::Now();
+    for (size_t i = 0; i < iterations; ++i) {
+      for (size_t j = 0; j < size; ++j)
+        found += map.find(present[j]) != map.end();
+    }
+    elapsed = TimeTicks::Now() - start;
+    debug::Alias(&found);
+    perf_test::PrintResult(
+        "find_hit", StringPrintf("_%zu", size), name,
+        elapsed.InNanoseconds() / static_cast<double>(iterations * size),
+        "ns/lookup", true);
+
+    start = TimeTicks::Now();
+    for (size_t i = 0; i < iterations; ++i) {
+      for (size_t j = size; j < size * 2; ++j)
+        found += map.find(keys[j]) != map.end();
+    }
+    elapsed = TimeTicks::Now() - start;
+    debug::Alias(&found);
+    perf_test::PrintResult(
+        "find_miss", StringPrintf("_%zu", size), name,
+        elapsed.InNanoseconds() / static_cast<double>(iterations * size),
+        "ns/lookup", true);
+  }
+}
+
+}  // namespace
+
+TEST(FlatHashMapPerfTest, IntKeys) {
+  const std::vector<uint64_t> keys =
+      MakeIntKeys(kSizes[arraysize(kSizes) - 1] * 2);
+  RunTest<std::unordered_map<uint64_t, size_t>>("std_unordered_map_int", keys);
+  RunTest<flat_map<uint64_t, size_t>>("flat_map_int", keys);
+  RunTest<flat_hash_map<uint64_t, size_t>>("flat_hash_map_int", keys);
+}
+
+TEST(FlatHashMapPerfTest, StringKeys) {
+  const std::vector<std::string> keys =
+      MakeStringKeys(kSizes[arraysize(kSizes) - 1] * 2);
+  RunTest<std::unordered_map<std::string, size_t>>(
+      "std_unordered_map_string", keys);
+  RunTest<flat_map<std::string, size_t>>("flat_map_string", keys);
+  RunTest<flat_hash_map<std::string, size_t>>("flat_hash_map_string", keys);
+}
+
+}  // namespace base
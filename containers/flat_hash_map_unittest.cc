@@ -0,0 +1,107 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/flat_hash_map.h"
+
+#include <memory>
+#include <string>
+
+#include "base/strings/string_piece.h"
+#include "base/test/move_only_int.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// A flat_hash_map is basically a interface to flat_hash_table. So several
+// basic operations are tested to make sure things are set up properly, but
+// the bulk of the tests are in flat_hash_table_unittest.cc.
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+namespace base {
+
+TEST(FlatHashMap, RangeConstructor) {
+  flat_hash_map<int, int>::value_type input_vals[] = {
+      {1, 1}, {1, 2}, {2, 1}, {2, 2}, {3, 1}};
+
+  // Takes the first of the duplicates.
+  flat_hash_map<int, int> map(std::begin(input_vals), std::end(input_vals));
+  EXPECT_THAT(map, UnorderedElementsAre(Pair(1, 1), Pair(2, 1), Pair(3, 1)));
+}
+
+TEST(FlatHashMap, SubscriptOperator) {
+  flat_hash_map<int, int> map;
+  map[1] = 10;
+  map[2] = 20;
+  ++map[1];
+  EXPECT_THAT(map, UnorderedElementsAre(Pair(1, 11), Pair(2, 20)));
+
+  flat_hash_map<std::string, std::unique_ptr<int>> move_only_map;
+  std::string key = "a";
+  move_only_map[std::move(key)] = std::make_unique<int>(1);
+  EXPECT_EQ(1, *move_only_map["a"]);
+}
+
+TEST(FlatHashMap, InsertOrAssign) {
+  flat_hash_map<int, MoveOnlyInt> map;
+  auto result = map.insert_or_assign(1, MoveOnlyInt(1));
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(1, result.first->second.data());
+
+  result = map.insert_or_assign(1, MoveOnlyInt(2));
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(2, result.first->second.data());
+  EXPECT_EQ(1u, map.size());
+}
+
+TEST(FlatHashMap, TryEmplace) {
+  flat_hash_map<int, std::unique_ptr<int>> map;
+  auto result = map.try_emplace(1, std::make_unique<int>(1));
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(1, *result.first->second);
+
+  // The arguments are left alone when the key is already there.
+  std::unique_ptr<int> value = std::make_unique<int>(2);
+  result = map.try_emplace(1, std::move(value));
+  EXPECT_FALSE(result.second);
+  EXPECT_TRUE(value);
+  EXPECT_EQ(1, *result.first->second);
+}
+
+TEST(FlatHashMap, Emplace) {
+  flat_hash_map<std::string, int> map;
+  EXPECT_TRUE(map.emplace("a", 1).second);
+  EXPECT_FALSE(map.emplace("a", 2).second);
+  EXPECT_EQ(1, map["a"]);
+}
+
+TEST(FlatHashMap, HeterogeneousLookup) {
+  flat_hash_map<std::string, int> map = {{"foo", 1}, {"bar", 2}};
+  EXPECT_EQ(1, map.find(StringPiece("foo"))->second);
+  EXPECT_EQ(2, map.find("bar")->second);
+  EXPECT_EQ(map.end(), map.find(StringPiece("baz")));
+
+  // try_emplace() only constructs a std::string when it inserts.
+  EXPECT_FALSE(map.try_emplace(StringPiece("foo"), 3).second);
+  EXPECT_TRUE(map.try_emplace(StringPiece("baz"), 3).second);
+  EXPECT_EQ(3, map["baz"]);
+}
+
+TEST(FlatHashMap, Equality) {
+  flat_hash_map<int, int> a = {{1, 1}, {2, 2}};
+  flat_hash_map<int, int> b = {{2, 2}, {1, 1}};
+  EXPECT_EQ(a, b);
+  b[2] = 3;
+  EXPECT_NE(a, b);
+}
+
+TEST(FlatHashMap, Swap) {
+  flat_hash_map<int, int> a = {{1, 1}};
+  flat_hash_map<int, int> b = {{2, 2}};
+  swap(a, b);
+  EXPECT_THAT(a, UnorderedElementsAre(Pair(2, 2)));
+  EXPECT_THAT(b, UnorderedElementsAre(Pair(1, 1)));
+}
+
+}  // namespace base
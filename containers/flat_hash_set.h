@@ -0,0 +1,127 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_FLAT_HASH_SET_H_
+#define BASE_CONTAINERS_FLAT_HASH_SET_H_
+
+#include <functional>
+
+#include "base/containers/flat_hash_table.h"
+#include "base/containers/flat_tree.h"
+
+namespace base {
+
+// flat_hash_set is a container with a std::unordered_set-like interface that
+// stores its contents in an open-addressing hash table.
+//
+// Please see //base/containers/README.md for an overview of which container
+// to select.
+//
+// PROS
+//
+//  - Lookups, inserts and removals are O(1) on average.
+//  - No allocation per element, and lookups usually touch a single cache line
+//    of metadata before the element they find.
+//  - Strings can be looked up by StringPiece with the default hasher.
+//
+// CONS
+//
+//  - Iteration order is unspecified, and changes across rehashes.
+//  - Needs a good hash function: its low 7 bits and its other bits are used
+//    separately. Integers are mixed before use, so std::hash is fine.
+//
+// IMPORTANT NOTES
+//
+//  - Iterators and references are invalidated by insertions which rehash, and
+//    by the other operations which say so below. Removals only invalidate the
+//    removed elements.
+//  - Elements are moved when the table rehashes.
+//
+// QUICK REFERENCE
+//
+// Most of the core functionality is inherited from flat_hash_table. Please see
+// flat_hash_table.h for more details for most of these functions. As a quick
+// reference, the functions available are:
+//
+// Constructors:
+//   flat_hash_set(size_t bucket_count,
+//                 const Hash& = Hash(),
+//                 const KeyEqual& = KeyEqual());
+//   flat_hash_set(InputIterator first, InputIterator last,
+//                 size_t bucket_count = 0,
+//                 const Hash& = Hash(),
+//                 const KeyEqual& = KeyEqual());
+//   flat_hash_set(const flat_hash_set&);
+//   flat_hash_set(flat_hash_set&&);
+//   flat_hash_set(std::initializer_list<value_type> ilist,
+//                 size_t bucket_count = 0,
+//                 const Hash& = Hash(),
+//                 const KeyEqual& = KeyEqual());
+//
+// Assignment functions:
+//   flat_hash_set& operator=(const flat_hash_set&);
+//   flat_hash_set& operator=(flat_hash_set&&);
+//   flat_hash_set& operator=(initializer_list<Key>);
+//
+// Memory management functions:
+//   void   reserve(size_t);
+//   size_t capacity() const;
+//   void   rehash(size_t);
+//
+// Size management functions:
+//   void   clear();
+//   size_t size() const;
+//   size_t max_size() const;
+//   bool   empty() const;
+//
+// Iterator functions:
+//   iterator       begin();
+//   const_iterator begin() const;
+//   const_iterator cbegin() const;
+//   iterator       end();
+//   const_iterator end() const;
+//   const_iterator cend() const;
+//
+// Insert and accessor functions:
+//   pair<iterator, bool> insert(const key_type&);
+//   pair<iterator, bool> insert(key_type&&);
+//   void                 insert(InputIterator first, InputIterator last);
+//   pair<iterator, bool> emplace(Args&&...);
+//
+// Erase functions:
+//   iterator erase(iterator);
+//   iterator erase(const_iterator);
+//   iterator erase(const_iterator first, const_iterator last);
+//   template <typename K> size_t erase(const K& key);
+//
+// Observers:
+//   hasher    hash_function() const;
+//   key_equal key_eq() const;
+//
+// Search functions:
+//   template <typename K> size_t                   count(const K&) const;
+//   template <typename K> iterator                 find(const K&);
+//   template <typename K> const_iterator           find(const K&) const;
+//   template <typename K> pair<iterator, iterator> equal_range(const K&);
+//
+// General functions:
+//   void swap(flat_hash_set&);
+//
+// Non-member operators:
+//   bool operator==(const flat_hash_set&, const flat_hash_set&);
+//   bool operator!=(const flat_hash_set&, const flat_hash_set&);
+//
+template <class Key,
+          class Hash = FlatHash<Key>,
+          class KeyEqual = std::equal_to<>>
+using flat_hash_set = typename ::base::internal::flat_hash_table<
+    Key,
+    Key,
+    ::base::internal::GetKeyFromValueIdentity<Key>,
+    Hash,
+    KeyEqual>;
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_HASH_SET_H_
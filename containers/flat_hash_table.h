@@ -0,0 +1,1329 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_FLAT_HASH_TABLE_H_
+#define BASE_CONTAINERS_FLAT_HASH_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "base/bits.h"
+#include "base/compiler_specific.h"
+#include "base/containers/flat_tree.h"
+#include "base/hash.h"
+#include "base/logging.h"
+#include "base/strings/string16.h"
+#include "base/strings/string_piece.h"
+#include "base/sys_byteorder.h"
+#include "build/build_config.h"
+
+// Chrome requires SSE2 on x86, so the control bytes of a whole group can be
+// matched with a couple of vector instructions there.
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <emmintrin.h>
+#endif
+
+namespace base {
+
+// The default hasher of flat_hash_map and flat_hash_set. It is std::hash,
+// except that strings are hashed with Hash64() and can be looked up by
+// StringPiece without constructing a temporary string.
+template <class Key>
+struct FlatHash : std::hash<Key> {};
+
+template <>
+struct FlatHash<std::string> {
+  using is_transparent = void;
+  size_t operator()(StringPiece value) const {
+    return static_cast<size_t>(Hash64(value.data(), value.size()));
+  }
+};
+
+template <>
+struct FlatHash<string16> {
+  using is_transparent = void;
+  size_t operator()(StringPiece16 value) const {
+    return static_cast<size_t>(
+        Hash64(value.data(), value.size() * sizeof(char16)));
+  }
+};
+
+namespace internal {
+
+// Implementation -------------------------------------------------------------
+
+// Open-addressing hash table for backing flat_hash_set and flat_hash_map,
+// following the design of Abseil's "Swiss tables"
+// (https://abseil.io/blog/20180927-swisstables). Do not use directly.
+//
+// The values are stored in an array of slots. Each slot has a control byte in
+// a separate array, which is either empty, deleted (a tombstone left by an
+// erase), or full, in which case it holds 7 bits of the hash of the key (H2).
+// The remaining bits of the hash (H1) select where the probing starts. A
+// lookup loads a whole group of consecutive control bytes at once, and only
+// compares the keys of the slots whose control byte matches H2, which almost
+// always means only the slot it is looking for. It stops at the first group
+// which has an empty slot.
+//
+// The capacity is always a power of two minus one, and the control bytes are
+// followed by a sentinel, which stops iteration, and by a copy of the first
+// group, so that a group can be loaded at any position without wrapping
+// around.
+//
+// As in flat_tree, GetKeyFromValue provides the means to extract a key from a
+// value. It should implement:
+//   const Key& operator()(const Value&).
+
+// Control bytes. Full slots hold H2, which is in [0, 127].
+constexpr int8_t kFlatHashEmpty = -128;
+constexpr int8_t kFlatHashDeleted = -2;
+constexpr int8_t kFlatHashSentinel = -1;
+
+static_assert(kFlatHashEmpty & kFlatHashDeleted & kFlatHashSentinel & 0x80,
+              "Special control bytes must have their high bit set.");
+static_assert(kFlatHashEmpty < kFlatHashSentinel &&
+                  kFlatHashDeleted < kFlatHashSentinel,
+              "Empty and deleted must be less than the sentinel.");
+
+inline bool FlatHashIsFull(int8_t ctrl) {
+  return ctrl >= 0;
+}
+
+inline bool FlatHashIsEmptyOrDeleted(int8_t ctrl) {
+  return ctrl < kFlatHashSentinel;
+}
+
+// Control bytes of tables with no capacity, which don't allocate. Lookups in
+// them find an empty slot straight away, and iteration stops at the sentinel.
+inline int8_t* FlatHashEmptyGroup() {
+  alignas(16) static const int8_t kEmptyGroup[16] = {
+      kFlatHashSentinel, kFlatHashEmpty, kFlatHashEmpty, kFlatHashEmpty,
+      kFlatHashEmpty,    kFlatHashEmpty, kFlatHashEmpty, kFlatHashEmpty,
+      kFlatHashEmpty,    kFlatHashEmpty, kFlatHashEmpty, kFlatHashEmpty,
+      kFlatHashEmpty,    kFlatHashEmpty, kFlatHashEmpty, kFlatHashEmpty};
+  // Never written to: the tables only write to control bytes they allocated.
+  return const_cast<int8_t*>(kEmptyGroup);
+}
+
+// The positions of the bytes of a group which matched. Each byte of the group
+// is represented by 1 << Shift bits of |mask|, of which only the highest one
+// can be set. Iterating over it yields the positions from lowest to highest.
+template <class T, int SignificantBits, int Shift>
+class FlatHashBitMask {
+ public:
+  explicit FlatHashBitMask(T mask) : mask_(mask) {}
+
+  explicit operator bool() const { return mask_ != 0; }
+
+  int LowestBitSet() const { return TrailingZeros(); }
+
+  // The number of unmatched bytes before the first match, and after the last
+  // match.
+  int TrailingZeros() const {
+    return static_cast<int>(bits::CountTrailingZeroBits(mask_)) >> Shift;
+  }
+  int LeadingZeros() const {
+    constexpr int kExtraBits = sizeof(T) * 8 - SignificantBits;
+    return static_cast<int>(bits::CountLeadingZeroBits(
+               static_cast<T>(mask_ << kExtraBits))) >>
+           Shift;
+  }
+
+  FlatHashBitMask begin() const { return *this; }
+  FlatHashBitMask end() const { return FlatHashBitMask(0); }
+  int operator*() const { return LowestBitSet(); }
+  FlatHashBitMask& operator++() {
+    mask_ &= mask_ - 1;
+    return *this;
+  }
+  bool operator!=(const FlatHashBitMask& other) const {
+    return mask_ != other.mask_;
+  }
+
+ private:
+  T mask_;
+};
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+// A group of 16 control bytes, matched with SSE2.
+class FlatHashGroup {
+ public:
+  static constexpr size_t kWidth = 16;
+  using BitMask = FlatHashBitMask<uint32_t, kWidth, 0>;
+
+  explicit FlatHashGroup(const int8_t* pos)
+      : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+  BitMask Match(int8_t h2) const {
+    return BitMask(static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_))));
+  }
+
+  BitMask MatchEmpty() const { return Match(kFlatHashEmpty); }
+
+  BitMask MatchEmptyOrDeleted() const {
+    return BitMask(static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpgt_epi8(_mm_set1_epi8(kFlatHashSentinel), ctrl_))));
+  }
+
+  // The number of empty or deleted bytes at the start of the group.
+  uint32_t CountLeadingEmptyOrDeleted() const {
+    const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpgt_epi8(_mm_set1_epi8(kFlatHashSentinel), ctrl_)));
+    return bits::CountTrailingZeroBits(mask + 1);
+  }
+
+ private:
+  __m128i ctrl_;
+};
+
+#else  // defined(ARCH_CPU_X86_FAMILY)
+
+// A group of 8 control bytes, matched with arithmetic on a 64-bit word.
+class FlatHashGroup {
+ public:
+  static constexpr size_t kWidth = 8;
+  using BitMask = FlatHashBitMask<uint64_t, 64, 3>;
+
+  explicit FlatHashGroup(const int8_t* pos) {
+    memcpy(&ctrl_, pos, sizeof(ctrl_));
+#if !defined(ARCH_CPU_LITTLE_ENDIAN)
+    ctrl_ = ByteSwap(ctrl_);
+#endif
+  }
+
+  // May also report the byte following a match when it equals |h2| ^ 1. Such
+  // a byte belongs to a full slot, whose key is compared anyway.
+  BitMask Match(int8_t h2) const {
+    const uint64_t x = ctrl_ ^ (kLsbs * static_cast<uint8_t>(h2));
+    return BitMask((x - kLsbs) & ~x & kMsbs);
+  }
+
+  // Empty is the only control byte with the high bit set and bit 1 clear.
+  BitMask MatchEmpty() const { return BitMask(ctrl_ & (~ctrl_ << 6) & kMsbs); }
+
+  // Empty and deleted are the only ones with the high bit set and bit 0 clear.
+  BitMask MatchEmptyOrDeleted() const {
+    return BitMask(ctrl_ & (~ctrl_ << 7) & kMsbs);
+  }
+
+  uint32_t CountLeadingEmptyOrDeleted() const {
+    constexpr uint64_t kGaps = 0x00FEFEFEFEFEFEFEULL;
+    return (bits::CountTrailingZeroBits(((~ctrl_ & (ctrl_ >> 7)) | kGaps) + 1) +
+            7) >>
+           3;
+  }
+
+ private:
+  static constexpr uint64_t kMsbs = 0x8080808080808080ULL;
+  static constexpr uint64_t kLsbs = 0x0101010101010101ULL;
+
+  uint64_t ctrl_;
+};
+
+#endif  // defined(ARCH_CPU_X86_FAMILY)
+
+// The control bytes copied after the sentinel.
+constexpr size_t kFlatHashNumClonedBytes = FlatHashGroup::kWidth - 1;
+
+// Spreads the entropy of |hash| over all its bits. Many std::hash
+// implementations return integers unchanged, and both ends of the hash are
+// used.
+inline size_t FlatHashMix(size_t hash) {
+  constexpr size_t kMultiplier =
+      sizeof(size_t) == 8 ? static_cast<size_t>(0x9E3779B97F4A7C15ULL)
+                          : static_cast<size_t>(0x9E3779B9U);
+  hash *= kMultiplier;
+  return hash ^ (hash >> (sizeof(size_t) * 4));
+}
+
+// The sequence of group positions visited by a lookup. It visits every group
+// once for a capacity which is a power of two minus one.
+class FlatHashProbeSequence {
+ public:
+  FlatHashProbeSequence(size_t hash, size_t mask)
+      : mask_(mask), offset_(hash & mask) {}
+
+  size_t offset() const { return offset_; }
+  size_t offset(size_t i) const { return (offset_ + i) & mask_; }
+
+  void next() {
+    index_ += FlatHashGroup::kWidth;
+    offset_ = (offset_ + index_) & mask_;
+  }
+
+ private:
+  const size_t mask_;
+  size_t offset_;
+  size_t index_ = 0;
+};
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+class flat_hash_table {
+ public:
+  // --------------------------------------------------------------------------
+  // Types.
+  //
+  using key_type = Key;
+  using value_type = Value;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+
+  template <bool IsConst>
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Value;
+    using difference_type = ptrdiff_t;
+    using reference =
+        typename std::conditional<IsConst, const Value&, Value&>::type;
+    using pointer =
+        typename std::conditional<IsConst, const Value*, Value*>::type;
+
+    Iterator() = default;
+    // Allows conversion from iterator to const_iterator.
+    template <bool OtherIsConst,
+              class = std::enable_if_t<IsConst && !OtherIsConst>>
+    Iterator(const Iterator<OtherIsConst>& other)  // NOLINT
+        : ctrl_(other.ctrl_), slot_(other.slot_) {}
+
+    reference operator*() const { return *slot_; }
+    pointer operator->() const { return slot_; }
+
+    Iterator& operator++() {
+      ++ctrl_;
+      ++slot_;
+      SkipEmptyOrDeleted();
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    friend bool operator==(const Iterator& a, const Iterator& b) {
+      return a.ctrl_ == b.ctrl_;
+    }
+    friend bool operator!=(const Iterator& a, const Iterator& b) {
+      return a.ctrl_ != b.ctrl_;
+    }
+
+   private:
+    friend class flat_hash_table;
+    template <bool>
+    friend class Iterator;
+
+    Iterator(const int8_t* ctrl, Value* slot) : ctrl_(ctrl), slot_(slot) {}
+
+    // Moves to the first full slot from here, or to the sentinel.
+    void SkipEmptyOrDeleted() {
+      while (FlatHashIsEmptyOrDeleted(*ctrl_)) {
+        const uint32_t shift =
+            FlatHashGroup(ctrl_).CountLeadingEmptyOrDeleted();
+        ctrl_ += shift;
+        slot_ += shift;
+      }
+    }
+
+    const int8_t* ctrl_ = nullptr;
+    Value* slot_ = nullptr;
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  // --------------------------------------------------------------------------
+  // Lifetime.
+  //
+  // |bucket_count| is the number of elements to reserve space for.
+
+  flat_hash_table();
+  explicit flat_hash_table(size_type bucket_count,
+                           const hasher& hash = hasher(),
+                           const key_equal& equal = key_equal());
+
+  // Takes the first of the duplicates in the range.
+  template <class InputIterator>
+  flat_hash_table(InputIterator first,
+                  InputIterator last,
+                  size_type bucket_count = 0,
+                  const hasher& hash = hasher(),
+                  const key_equal& equal = key_equal());
+
+  flat_hash_table(std::initializer_list<value_type> ilist,
+                  size_type bucket_count = 0,
+                  const hasher& hash = hasher(),
+                  const key_equal& equal = key_equal());
+
+  flat_hash_table(const flat_hash_table&);
+  flat_hash_table(flat_hash_table&&) noexcept;
+
+  ~flat_hash_table();
+
+  // --------------------------------------------------------------------------
+  // Assignments.
+  //
+  // Assume that assignments invalidate iterators and references.
+
+  flat_hash_table& operator=(const flat_hash_table&);
+  flat_hash_table& operator=(flat_hash_table&&) noexcept;
+  // Takes the first if there are duplicates in the initializer list.
+  flat_hash_table& operator=(std::initializer_list<value_type> ilist);
+
+  // --------------------------------------------------------------------------
+  // Memory management.
+  //
+  // capacity() is the number of elements the allocated slots can hold. The
+  // slots of erased elements count against it until an insertion reuses them
+  // or the table rehashes.
+  // reserve() guarantees that |count| elements fit without a rehash.
+  // reserve() and rehash() invalidate iterators and references if they
+  // rehash.
+
+  void reserve(size_type count);
+  size_type capacity() const;
+  // Rehashes into enough slots for max(|count|, size()) elements. A |count|
+  // of 0 shrinks to fit.
+  void rehash(size_type count);
+
+  // --------------------------------------------------------------------------
+  // Size management.
+  //
+  // clear() keeps the slots allocated, so capacity() is unchanged.
+
+  void clear();
+
+  size_type size() const;
+  size_type max_size() const;
+  bool empty() const;
+
+  // --------------------------------------------------------------------------
+  // Iterators.
+  //
+  // The iteration order is unspecified and changes whenever the table
+  // rehashes. It also differs between two tables with the same contents.
+
+  iterator begin();
+  const_iterator begin() const;
+  const_iterator cbegin() const;
+
+  iterator end();
+  const_iterator end() const;
+  const_iterator cend() const;
+
+  // --------------------------------------------------------------------------
+  // Insert operations.
+  //
+  // An insertion which needs more slots than capacity() rehashes, which
+  // invalidates all iterators and references. Otherwise they stay valid.
+  // Inserting an element takes amortized O(1).
+
+  std::pair<iterator, bool> insert(const value_type& val);
+  std::pair<iterator, bool> insert(value_type&& val);
+
+  // Takes the first of the duplicates in the range.
+  template <class InputIterator>
+  void insert(InputIterator first, InputIterator last);
+  void insert(std::initializer_list<value_type> ilist);
+
+  // Constructs the value before looking up its key. Prefer insert() or, for
+  // maps, try_emplace() when the key is at hand.
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args);
+
+  // --------------------------------------------------------------------------
+  // Erase operations.
+  //
+  // Erasing never rehashes: only iterators and references to the erased
+  // elements are invalidated. The iterator returned by erase() can be used to
+  // continue an iteration.
+
+  iterator erase(iterator position);
+  iterator erase(const_iterator position);
+  iterator erase(const_iterator first, const_iterator last);
+  template <class K>
+  size_type erase(const K& key);
+
+  // --------------------------------------------------------------------------
+  // Search operations.
+  //
+  // Search operations have O(1) complexity on average. Keys of another type
+  // than key_type can be used if both the hasher and the key_equal are
+  // transparent, as FlatHash<std::string> and std::equal_to<> are.
+
+  template <class K>
+  size_type count(const K& key) const;
+
+  template <class K>
+  iterator find(const K& key);
+
+  template <class K>
+  const_iterator find(const K& key) const;
+
+  template <class K>
+  std::pair<iterator, iterator> equal_range(const K& key);
+
+  template <class K>
+  std::pair<const_iterator, const_iterator> equal_range(const K& key) const;
+
+  // --------------------------------------------------------------------------
+  // Observers.
+
+  hasher hash_function() const { return hash_; }
+  key_equal key_eq() const { return equal_; }
+
+  // --------------------------------------------------------------------------
+  // General operations.
+  //
+  // Assume that swap invalidates iterators and references.
+
+  void swap(flat_hash_table& other) noexcept;
+
+  friend bool operator==(const flat_hash_table& lhs,
+                         const flat_hash_table& rhs) {
+    if (lhs.size() != rhs.size())
+      return false;
+    for (const value_type& value : lhs) {
+      auto it = rhs.find(GetKeyFromValue()(value));
+      if (it == rhs.end() || !(*it == value))
+        return false;
+    }
+    return true;
+  }
+
+  friend bool operator!=(const flat_hash_table& lhs,
+                         const flat_hash_table& rhs) {
+    return !(lhs == rhs);
+  }
+
+ protected:
+  // If the hasher or the key_equal are not transparent we want to construct
+  // key_type once.
+  template <class K>
+  using KeyTypeOrK = typename std::conditional<
+      IsTransparentCompare<hasher>::value &&
+          IsTransparentCompare<key_equal>::value,
+      K,
+      key_type>::type;
+
+  // Inserts a value constructed from |args| unless there is already an
+  // element with |key|, which must be the key the value would have.
+  template <class K, class... Args>
+  std::pair<iterator, bool> emplace_key_args(const K& key, Args&&... args);
+
+ private:
+  // Returns the index of the slot of |key|, and true, if it is in the table.
+  // |key| must be a key_type, or be usable as one by the hasher and the
+  // key_equal.
+  // Otherwise returns the index of a slot in which to insert it, whose
+  // control byte is already set, and false.
+  template <class K>
+  std::pair<size_t, bool> find_or_prepare_insert(const K& key);
+
+  // Inlined into the lookups, which are small otherwise.
+  template <class K>
+  ALWAYS_INLINE size_t find_index(const K& key, size_t hash) const;
+  size_t find_first_non_full(size_t hash) const;
+  size_t prepare_insert(size_t hash);
+
+  void resize(size_t new_capacity);
+  void destroy_slots();
+  void set_ctrl(size_t index, int8_t ctrl);
+
+  size_t H1(size_t hash) const {
+    // Salting with the address of the control bytes makes the iteration order
+    // of two tables differ, so that inserting the elements of a table into
+    // another one in iteration order doesn't cluster them.
+    return (hash >> 7) ^ (reinterpret_cast<uintptr_t>(ctrl_) >> 12);
+  }
+  static int8_t H2(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+  template <class K>
+  size_t hash_key(const K& key) const {
+    return FlatHashMix(hash_(key));
+  }
+
+  const flat_hash_table& as_const() { return *this; }
+
+  // The capacity is a power of two minus one.
+  static size_t NormalizeCapacity(size_t count) {
+    return count ? std::numeric_limits<size_t>::max() >>
+                       bits::CountLeadingZeroBitsSizeT(count)
+                 : 1;
+  }
+  // The number of elements which fit in |capacity| slots with a maximum load
+  // factor of 7/8, and the converse. A table with 8-wide groups and 7 slots
+  // must keep one empty for lookups to terminate.
+  static size_t CapacityToGrowth(size_t capacity) {
+    if (FlatHashGroup::kWidth == 8 && capacity == 7)
+      return 6;
+    return capacity - capacity / 8;
+  }
+  static size_t GrowthToLowerboundCapacity(size_t growth) {
+    if (FlatHashGroup::kWidth == 8 && growth == 7)
+      return 8;
+    return growth + (growth - 1) / 7;
+  }
+
+  // The control bytes are followed by the slots in the same allocation.
+  static size_t SlotOffset(size_t capacity) {
+    return bits::Align(capacity + 1 + kFlatHashNumClonedBytes,
+                       alignof(value_type));
+  }
+
+  iterator iterator_at(size_t index) {
+    return iterator(ctrl_ + index, slots_ + index);
+  }
+  const_iterator iterator_at(size_t index) const {
+    return const_iterator(ctrl_ + index, slots_ + index);
+  }
+
+  int8_t* ctrl_ = FlatHashEmptyGroup();
+  value_type* slots_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+  // The number of elements which can still be inserted in empty slots.
+  // Deleted slots are reused without consuming it.
+  size_t growth_left_ = 0;
+  hasher hash_;
+  key_equal equal_;
+
+  static_assert(alignof(value_type) <= alignof(std::max_align_t),
+                "Over-aligned values are not supported.");
+};
+
+// ----------------------------------------------------------------------------
+// Lifetime.
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::
+    flat_hash_table() = default;
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::flat_hash_table(
+    size_type bucket_count,
+    const hasher& hash,
+    const key_equal& equal)
+    : hash_(hash), equal_(equal) {
+  reserve(bucket_count);
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+template <class InputIterator>
+flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::flat_hash_table(
+    InputIterator first,
+    InputIterator last,
+    size_type bucket_count,
+    const hasher& hash,
+    const key_equal& equal)
+    : flat_hash_table(bucket_count, hash, equal) {
+  insert(first, last);
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::flat_hash_table(
+    std::initializer_list<value_type> ilist,
+    size_type bucket_count,
+    const hasher& hash,
+    const key_equal& equal)
+    : flat_hash_table(std::begin(ilist),
+                      std::end(ilist),
+                      bucket_count,
+                      hash,
+                      equal) {}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::flat_hash_table(
+    const flat_hash_table& other)
+    : flat_hash_table(other.size(), other.hash_, other.equal_) {
+  // The keys are known to be distinct, so there is no need to look them up.
+  for (const value_type& value : other) {
+    const size_t index =
+        prepare_insert(hash_key(GetKeyFromValue()(value)));
+    new (slots_ + index) value_type(value);
+  }
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::flat_hash_table(
+    flat_hash_table&& other) noexcept
+    : ctrl_(other.ctrl_),
+      slots_(other.slots_),
+      size_(other.size_),
+      capacity_(other.capacity_),
+      growth_left_(other.growth_left_),
+      hash_(other.hash_),
+      equal_(other.equal_) {
+  other.ctrl_ = FlatHashEmptyGroup();
+  other.slots_ = nullptr;
+  other.size_ = 0;
+  other.capacity_ = 0;
+  other.growth_left_ = 0;
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::
+    ~flat_hash_table() {
+  destroy_slots();
+}
+
+// ----------------------------------------------------------------------------
+// Assignments.
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::operator=(
+    const flat_hash_table& other) -> flat_hash_table& {
+  if (this != &other) {
+    flat_hash_table copy(other);
+    swap(copy);
+  }
+  return *this;
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::operator=(
+    flat_hash_table&& other) noexcept -> flat_hash_table& {
+  flat_hash_table moved(std::move(other));
+  swap(moved);
+  return *this;
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::operator=(
+    std::initializer_list<value_type> ilist) -> flat_hash_table& {
+  clear();
+  insert(ilist);
+  return *this;
+}
+
+// ----------------------------------------------------------------------------
+// Memory management.
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+void flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::reserve(
+    size_type count) {
+  if (count > size_ + growth_left_)
+    resize(NormalizeCapacity(GrowthToLowerboundCapacity(count)));
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::capacity()
+    const -> size_type {
+  return CapacityToGrowth(capacity_);
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+void flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::rehash(
+    size_type count) {
+  count = std::max(count, size_);
+  if (count == 0) {
+    flat_hash_table empty_table(0, hash_, equal_);
+    swap(empty_table);
+    return;
+  }
+  resize(NormalizeCapacity(GrowthToLowerboundCapacity(count)));
+}
+
+// ----------------------------------------------------------------------------
+// Size management.
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+void flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::clear() {
+  if (!capacity_)
+    return;
+  for (size_t i = 0; i < capacity_; ++i) {
+    if (FlatHashIsFull(ctrl_[i]))
+      slots_[i].~value_type();
+  }
+  memset(ctrl_, kFlatHashEmpty, capacity_ + 1 + kFlatHashNumClonedBytes);
+  ctrl_[capacity_] = kFlatHashSentinel;
+  size_ = 0;
+  growth_left_ = CapacityToGrowth(capacity_);
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::size() const
+    -> size_type {
+  return size_;
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::max_size()
+    const -> size_type {
+  return std::numeric_limits<size_type>::max() /
+         (sizeof(value_type) + 1) / 2;
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+bool flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::empty()
+    const {
+  return size_ == 0;
+}
+
+// ----------------------------------------------------------------------------
+// Iterators.
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::begin()
+    -> iterator {
+  iterator it = iterator_at(0);
+  it.SkipEmptyOrDeleted();
+  return it;
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::begin()
+    const -> const_iterator {
+  const_iterator it = iterator_at(0);
+  it.SkipEmptyOrDeleted();
+  return it;
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::cbegin()
+    const -> const_iterator {
+  return begin();
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::end()
+    -> iterator {
+  return iterator_at(capacity_);
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::end() const
+    -> const_iterator {
+  return iterator_at(capacity_);
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::cend() const
+    -> const_iterator {
+  return end();
+}
+
+// ----------------------------------------------------------------------------
+// Insert operations.
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::insert(
+    const value_type& val) -> std::pair<iterator, bool> {
+  return emplace_key_args(GetKeyFromValue()(val), val);
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::insert(
+    value_type&& val) -> std::pair<iterator, bool> {
+  return emplace_key_args(GetKeyFromValue()(val), std::move(val));
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+template <class InputIterator>
+void flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::insert(
+    InputIterator first,
+    InputIterator last) {
+  // Assumes mostly distinct keys: at worst, this reserves for the duplicates
+  // too.
+  if (is_multipass<InputIterator>())
+    reserve(size_ + std::distance(first, last));
+  for (; first != last; ++first)
+    insert(*first);
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+void flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::insert(
+    std::initializer_list<value_type> ilist) {
+  insert(std::begin(ilist), std::end(ilist));
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+template <class... Args>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::emplace(
+    Args&&... args) -> std::pair<iterator, bool> {
+  value_type new_value(std::forward<Args>(args)...);
+  return insert(std::move(new_value));
+}
+
+// ----------------------------------------------------------------------------
+// Erase operations.
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::erase(
+    iterator position) -> iterator {
+  return erase(const_iterator(position));
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::erase(
+    const_iterator position) -> iterator {
+  const size_t index = static_cast<size_t>(position.ctrl_ - ctrl_);
+  DCHECK_LT(index, capacity_);
+  DCHECK(FlatHashIsFull(ctrl_[index]));
+  slots_[index].~value_type();
+  --size_;
+
+  // A lookup stops at the first group with an empty slot. If there is an
+  // empty slot less than a group away on both sides, no group containing this
+  // slot was ever full, so no lookup ever probed past it and it can become
+  // empty rather than deleted.
+  const size_t index_before = (index - FlatHashGroup::kWidth) & capacity_;
+  const auto empty_after = FlatHashGroup(ctrl_ + index).MatchEmpty();
+  const auto empty_before = FlatHashGroup(ctrl_ + index_before).MatchEmpty();
+  const bool was_never_full =
+      empty_before && empty_after &&
+      static_cast<size_t>(empty_after.TrailingZeros() +
+                          empty_before.LeadingZeros()) < FlatHashGroup::kWidth;
+  set_ctrl(index, was_never_full ? kFlatHashEmpty : kFlatHashDeleted);
+  if (was_never_full)
+    ++growth_left_;
+
+  iterator next = iterator_at(index);
+  next.SkipEmptyOrDeleted();
+  return next;
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::erase(
+    const_iterator first,
+    const_iterator last) -> iterator {
+  while (first != last)
+    first = erase(first);
+  return iterator_at(static_cast<size_t>(last.ctrl_ - ctrl_));
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+template <class K>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::erase(
+    const K& key) -> size_type {
+  auto it = find(key);
+  if (it == end())
+    return 0;
+  erase(it);
+  return 1;
+}
+
+// ----------------------------------------------------------------------------
+// Search operations.
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+template <class K>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::count(
+    const K& key) const -> size_type {
+  return find(key) != end() ? 1 : 0;
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+template <class K>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::find(
+    const K& key) -> iterator {
+  const auto it = as_const().find(key);
+  return iterator_at(static_cast<size_t>(it.ctrl_ - ctrl_));
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+template <class K>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::find(
+    const K& key) const -> const_iterator {
+  static_assert(std::is_convertible<const KeyTypeOrK<K>&, const K&>::value,
+                "Requested type cannot be bound to the container's key_type "
+                "which is required for a non-transparent hasher or key_equal.");
+
+  const KeyTypeOrK<K>& key_ref = key;
+  return iterator_at(find_index(key_ref, hash_key(key_ref)));
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+template <class K>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::equal_range(
+    const K& key) -> std::pair<iterator, iterator> {
+  auto it = find(key);
+  if (it == end())
+    return {it, it};
+  return {it, std::next(it)};
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+template <class K>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::equal_range(
+    const K& key) const -> std::pair<const_iterator, const_iterator> {
+  auto it = find(key);
+  if (it == end())
+    return {it, it};
+  return {it, std::next(it)};
+}
+
+// ----------------------------------------------------------------------------
+// General operations.
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+void flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::swap(
+    flat_hash_table& other) noexcept {
+  using std::swap;
+  swap(ctrl_, other.ctrl_);
+  swap(slots_, other.slots_);
+  swap(size_, other.size_);
+  swap(capacity_, other.capacity_);
+  swap(growth_left_, other.growth_left_);
+  swap(hash_, other.hash_);
+  swap(equal_, other.equal_);
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+template <class K, class... Args>
+auto flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::
+    emplace_key_args(const K& key, Args&&... args)
+        -> std::pair<iterator, bool> {
+  const std::pair<size_t, bool> result = find_or_prepare_insert(key);
+  if (!result.second)
+    new (slots_ + result.first) value_type(std::forward<Args>(args)...);
+  return {iterator_at(result.first), !result.second};
+}
+
+// ----------------------------------------------------------------------------
+// Probing and rehashing.
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+template <class K>
+std::pair<size_t, bool>
+flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::
+    find_or_prepare_insert(const K& key) {
+  const KeyTypeOrK<K>& key_ref = key;
+  const size_t hash = hash_key(key_ref);
+  const size_t index = find_index(key_ref, hash);
+  if (index != capacity_)
+    return {index, true};
+  return {prepare_insert(hash), false};
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+template <class K>
+ALWAYS_INLINE size_t
+flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::find_index(
+    const K& key,
+    size_t hash) const {
+  GetKeyFromValue extractor;
+  FlatHashProbeSequence seq(H1(hash), capacity_);
+  for (;;) {
+    const FlatHashGroup group(ctrl_ + seq.offset());
+    for (int i : group.Match(H2(hash))) {
+      const size_t index = seq.offset(i);
+      if (equal_(extractor(slots_[index]), key))
+        return index;
+    }
+    if (group.MatchEmpty())
+      return capacity_;
+    seq.next();
+  }
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+size_t flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::
+    find_first_non_full(size_t hash) const {
+  FlatHashProbeSequence seq(H1(hash), capacity_);
+  for (;;) {
+    const auto mask = FlatHashGroup(ctrl_ + seq.offset()).MatchEmptyOrDeleted();
+    if (mask)
+      return seq.offset(mask.LowestBitSet());
+    seq.next();
+  }
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+size_t flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::
+    prepare_insert(size_t hash) {
+  size_t index = find_first_non_full(hash);
+  if (growth_left_ == 0 && ctrl_[index] != kFlatHashDeleted) {
+    // Either the table is full, or it is mostly tombstones, in which case it
+    // is rehashed at the same capacity to get rid of them.
+    if (capacity_ == 0)
+      resize(1);
+    else if (size_ <= CapacityToGrowth(capacity_) / 2)
+      resize(capacity_);
+    else
+      resize(capacity_ * 2 + 1);
+    index = find_first_non_full(hash);
+  }
+  ++size_;
+  if (ctrl_[index] == kFlatHashEmpty)
+    --growth_left_;
+  set_ctrl(index, H2(hash));
+  return index;
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+void flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::resize(
+    size_t new_capacity) {
+  DCHECK_GE(CapacityToGrowth(new_capacity), size_);
+  int8_t* const old_ctrl = ctrl_;
+  value_type* const old_slots = slots_;
+  const size_t old_capacity = capacity_;
+
+  const size_t slot_offset = SlotOffset(new_capacity);
+  char* const memory = static_cast<char*>(
+      ::operator new(slot_offset + new_capacity * sizeof(value_type)));
+  ctrl_ = reinterpret_cast<int8_t*>(memory);
+  slots_ = reinterpret_cast<value_type*>(memory + slot_offset);
+  capacity_ = new_capacity;
+  memset(ctrl_, kFlatHashEmpty, new_capacity + 1 + kFlatHashNumClonedBytes);
+  ctrl_[new_capacity] = kFlatHashSentinel;
+  growth_left_ = CapacityToGrowth(new_capacity) - size_;
+
+  GetKeyFromValue extractor;
+  for (size_t i = 0; i < old_capacity; ++i) {
+    if (!FlatHashIsFull(old_ctrl[i]))
+      continue;
+    const size_t hash = hash_key(extractor(old_slots[i]));
+    const size_t index = find_first_non_full(hash);
+    set_ctrl(index, H2(hash));
+    new (slots_ + index) value_type(std::move(old_slots[i]));
+    old_slots[i].~value_type();
+  }
+  if (old_capacity)
+    ::operator delete(old_ctrl);
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+void flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::
+    destroy_slots() {
+  if (!capacity_)
+    return;
+  for (size_t i = 0; i < capacity_; ++i) {
+    if (FlatHashIsFull(ctrl_[i]))
+      slots_[i].~value_type();
+  }
+  ::operator delete(ctrl_);
+  ctrl_ = FlatHashEmptyGroup();
+  slots_ = nullptr;
+  size_ = 0;
+  capacity_ = 0;
+  growth_left_ = 0;
+}
+
+template <class Key,
+          class Value,
+          class GetKeyFromValue,
+          class Hash,
+          class KeyEqual>
+void flat_hash_table<Key, Value, GetKeyFromValue, Hash, KeyEqual>::set_ctrl(
+    size_t index,
+    int8_t ctrl) {
+  // Also updates the copy of the byte after the sentinel. When the capacity
+  // is smaller than the copied bytes, the indices past the copies of all the
+  // slots stay empty, and this writes the byte at |index| twice for the
+  // indices which aren't copied.
+  ctrl_[index] = ctrl;
+  ctrl_[((index - kFlatHashNumClonedBytes) & capacity_) +
+        (kFlatHashNumClonedBytes & capacity_)] = ctrl;
+}
+
+}  // namespace internal
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_HASH_TABLE_H_
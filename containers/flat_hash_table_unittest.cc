@@ -0,0 +1,224 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/flat_hash_table.h"
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_hash_set.h"
+#include "base/strings/string_piece.h"
+#include "base/test/move_only_int.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// flat_hash_set is flat_hash_table with the key as the value, so the table is
+// tested through it. The map-specific operations are tested in
+// flat_hash_map_unittest.cc.
+
+using ::testing::UnorderedElementsAre;
+
+namespace base {
+
+namespace {
+
+struct MoveOnlyIntHash {
+  size_t operator()(const MoveOnlyInt& value) const { return value.data(); }
+};
+
+// Sends every key to the same probe sequence and the same H2.
+struct ConstantHash {
+  size_t operator()(int) const { return 42; }
+};
+
+}  // namespace
+
+TEST(FlatHashTable, Empty) {
+  flat_hash_set<int> set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(0u, set.size());
+  EXPECT_EQ(0u, set.capacity());
+  EXPECT_EQ(set.begin(), set.end());
+  EXPECT_EQ(set.end(), set.find(1));
+  EXPECT_EQ(0u, set.count(1));
+  EXPECT_EQ(0u, set.erase(1));
+  set.clear();
+  EXPECT_TRUE(set.empty());
+}
+
+TEST(FlatHashTable, InsertFindErase) {
+  constexpr int kCount = 10000;
+  flat_hash_set<int> set;
+  for (int i = 0; i < kCount; ++i) {
+    auto result = set.insert(i);
+    EXPECT_TRUE(result.second);
+    EXPECT_EQ(i, *result.first);
+  }
+  EXPECT_EQ(static_cast<size_t>(kCount), set.size());
+  EXPECT_FALSE(set.insert(kCount / 2).second);
+
+  for (int i = 0; i < kCount; ++i) {
+    auto it = set.find(i);
+    ASSERT_NE(set.end(), it);
+    EXPECT_EQ(i, *it);
+  }
+  EXPECT_EQ(set.end(), set.find(-1));
+  EXPECT_EQ(set.end(), set.find(kCount));
+
+  for (int i = 0; i < kCount; i += 2)
+    EXPECT_EQ(1u, set.erase(i));
+  EXPECT_EQ(static_cast<size_t>(kCount / 2), set.size());
+  for (int i = 0; i < kCount; ++i)
+    EXPECT_EQ(i % 2 ? 1u : 0u, set.count(i));
+}
+
+TEST(FlatHashTable, Iteration) {
+  flat_hash_set<int> set = {1, 2, 3, 4, 5, 1};
+  EXPECT_THAT(set, UnorderedElementsAre(1, 2, 3, 4, 5));
+
+  // Erasing while iterating visits every element once.
+  std::vector<int> visited;
+  for (auto it = set.begin(); it != set.end();) {
+    visited.push_back(*it);
+    if (*it % 2)
+      it = set.erase(it);
+    else
+      ++it;
+  }
+  EXPECT_THAT(visited, UnorderedElementsAre(1, 2, 3, 4, 5));
+  EXPECT_THAT(set, UnorderedElementsAre(2, 4));
+
+  flat_hash_set<int>::const_iterator cit = set.cbegin();
+  EXPECT_EQ(set.begin(), cit);
+}
+
+TEST(FlatHashTable, EraseRange) {
+  flat_hash_set<int> set = {1, 2, 3, 4, 5};
+  auto last = set.erase(set.cbegin(), set.cend());
+  EXPECT_EQ(set.end(), last);
+  EXPECT_TRUE(set.empty());
+}
+
+TEST(FlatHashTable, ReserveKeepsReferencesStable) {
+  flat_hash_set<int> set;
+  set.reserve(1000);
+  const size_t capacity = set.capacity();
+  EXPECT_GE(capacity, 1000u);
+
+  const int* first = &*set.insert(0).first;
+  for (int i = 1; i < 1000; ++i)
+    set.insert(i);
+  EXPECT_EQ(capacity, set.capacity());
+  EXPECT_EQ(first, &*set.find(0));
+}
+
+TEST(FlatHashTable, ClearKeepsCapacity) {
+  flat_hash_set<int> set = {1, 2, 3};
+  const size_t capacity = set.capacity();
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(capacity, set.capacity());
+  EXPECT_EQ(set.end(), set.find(1));
+  set.insert(2);
+  EXPECT_THAT(set, UnorderedElementsAre(2));
+}
+
+TEST(FlatHashTable, Rehash) {
+  flat_hash_set<int> set;
+  for (int i = 0; i < 1000; ++i)
+    set.insert(i);
+  for (int i = 10; i < 1000; ++i)
+    set.erase(i);
+  const size_t capacity = set.capacity();
+  set.rehash(0);
+  EXPECT_LT(set.capacity(), capacity);
+  EXPECT_GE(set.capacity(), 10u);
+  EXPECT_THAT(set, UnorderedElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+
+  set.clear();
+  set.rehash(0);
+  EXPECT_EQ(0u, set.capacity());
+}
+
+TEST(FlatHashTable, TombstonesDontGrowTheTable) {
+  flat_hash_set<int> set;
+  // Each erase may leave a tombstone. Once the table has settled on a size,
+  // they are reclaimed rather than causing it to grow.
+  int next = 0;
+  auto churn = [&set, &next](int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      set.insert(next);
+      if (next >= 100)
+        set.erase(next - 100);
+      ++next;
+    }
+  };
+  churn(10000);
+  const size_t capacity = set.capacity();
+  churn(100000);
+  EXPECT_EQ(capacity, set.capacity());
+  EXPECT_EQ(100u, set.size());
+  for (int i = next - 100; i < next; ++i)
+    EXPECT_EQ(1u, set.count(i));
+}
+
+TEST(FlatHashTable, Collisions) {
+  flat_hash_set<int, ConstantHash> set;
+  for (int i = 0; i < 100; ++i)
+    EXPECT_TRUE(set.insert(i).second);
+  for (int i = 0; i < 100; i += 3)
+    EXPECT_EQ(1u, set.erase(i));
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(i % 3 ? 1u : 0u, set.count(i));
+  EXPECT_EQ(set.end(), set.find(100));
+}
+
+TEST(FlatHashTable, CopyMoveAndSwap) {
+  flat_hash_set<int> original = {1, 2, 3};
+
+  flat_hash_set<int> copy(original);
+  EXPECT_EQ(original, copy);
+  copy.insert(4);
+  EXPECT_NE(original, copy);
+
+  flat_hash_set<int> moved(std::move(copy));
+  EXPECT_THAT(moved, UnorderedElementsAre(1, 2, 3, 4));
+
+  flat_hash_set<int> assigned;
+  assigned = original;
+  EXPECT_EQ(original, assigned);
+  assigned = std::move(moved);
+  EXPECT_THAT(assigned, UnorderedElementsAre(1, 2, 3, 4));
+  assigned = {5};
+  EXPECT_THAT(assigned, UnorderedElementsAre(5));
+
+  original.swap(assigned);
+  EXPECT_THAT(original, UnorderedElementsAre(5));
+  EXPECT_THAT(assigned, UnorderedElementsAre(1, 2, 3));
+}
+
+TEST(FlatHashTable, MoveOnly) {
+  flat_hash_set<MoveOnlyInt, MoveOnlyIntHash> set;
+  for (int i = 0; i < 100; ++i)
+    EXPECT_TRUE(set.insert(MoveOnlyInt(i)).second);
+  EXPECT_TRUE(set.emplace(100).second);
+  EXPECT_FALSE(set.emplace(100).second);
+  EXPECT_EQ(101u, set.size());
+  for (int i = 0; i <= 100; ++i)
+    EXPECT_EQ(i, set.find(MoveOnlyInt(i))->data());
+}
+
+TEST(FlatHashTable, HeterogeneousLookup) {
+  flat_hash_set<std::string> set = {"foo", "bar"};
+  EXPECT_EQ(1u, set.count(StringPiece("foo")));
+  EXPECT_EQ(1u, set.count("bar"));
+  EXPECT_EQ(0u, set.count(StringPiece("foobar", 4)));
+  EXPECT_EQ("foo", *set.find(StringPiece("foobar", 3)));
+  EXPECT_EQ(1u, set.erase(StringPiece("foo")));
+  EXPECT_THAT(set, UnorderedElementsAre("bar"));
+}
+
+}  // namespace base
@@ -110,6 +110,8 @@ struct GetKeyFromValuePairFirst {
 //   iterator             insert(const_iterator hint, value_type&&);
 //   void                 insert(InputIterator first, InputIterator last,
 //                               FlatContainerDupes = KEEP_FIRST_OF_DUPES);
+//   void                 merge(flat_map&);
+//   void                 merge(flat_map&&);
 //   pair<iterator, bool> insert_or_assign(K&&, M&&);
 //   iterator             insert_or_assign(const_iterator hint, K&&, M&&);
 //   pair<iterator, bool> emplace(Args&&...);
@@ -139,6 +141,8 @@ struct GetKeyFromValuePairFirst {
 //
 // General functions:
 //   void swap(flat_map&&);
+//   std::vector<value_type> extract() &&;
+//   void replace(std::vector<value_type>&&);
 //
 // Non-member operators:
 //   bool operator==(const flat_map&, const flat_map);
@@ -92,6 +92,8 @@ namespace base {
 //   pair<iterator, bool> insert(key_type&&);
 //   void                 insert(InputIterator first, InputIterator last,
 //                               FlatContainerDupes = KEEP_FIRST_OF_DUPES);
+//   void                 merge(flat_set&);
+//   void                 merge(flat_set&&);
 //   iterator             insert(const_iterator hint, const key_type&);
 //   iterator             insert(const_iterator hint, key_type&&);
 //   pair<iterator, bool> emplace(Args&&...);
@@ -119,6 +121,8 @@ namespace base {
 //
 // General functions:
 //   void swap(flat_set&&);
+//   std::vector<value_type> extract() &&;
+//   void replace(std::vector<value_type>&&);
 //
 // Non-member operators:
 //   bool operator==(const flat_set&, const flat_set);
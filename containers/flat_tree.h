@@ -8,8 +8,10 @@
 #include <algorithm>
 #include <iterator>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "base/logging.h"
 #include "base/template_util.h"
 
 namespace base {
@@ -58,6 +60,30 @@ Iterator LastUnique(Iterator first, Iterator last, BinaryPredicate compare) {
   return replacable;
 }
 
+// Like std::lower_bound(), but probes |first|, |first| + 1, |first| + 3,
+// |first| + 7... before the binary search. This takes O(log(distance)) where
+// distance is how far the result is from |first|, which makes a series of
+// searches for increasing values, each starting where the previous one ended,
+// take linear time overall rather than O(n * log(n)).
+template <class Iterator, class T, class Compare>
+Iterator GallopingLowerBound(Iterator first,
+                             Iterator last,
+                             const T& value,
+                             Compare comp) {
+  using difference_type =
+      typename std::iterator_traits<Iterator>::difference_type;
+  const difference_type size = std::distance(first, last);
+  // All the elements before |first| + |low| are less than |value|.
+  difference_type low = 0;
+  difference_type high = 1;
+  while (high <= size && comp(*std::next(first, high - 1), value)) {
+    low = high;
+    high *= 2;
+  }
+  return std::lower_bound(std::next(first, low),
+                          std::next(first, std::min(high, size)), value, comp);
+}
+
 // Uses SFINAE to detect whether type has is_transparent member.
 template <typename T, typename = void>
 struct IsTransparentCompare : std::false_type {};
@@ -224,17 +250,46 @@ class flat_tree {
   // This method inserts the values from the range [first, last) into the
   // current tree. In case of KEEP_LAST_OF_DUPES newly added elements can
   // overwrite existing values.
+  //
+  // Only the new values are sorted, and they are then merged with the
+  // existing ones in one pass: inserting M values into a tree of size N takes
+  // O(M * log(M) + N), rather than the O(M * N) of inserting them one by one.
   template <class InputIterator>
   void insert(InputIterator first,
               InputIterator last,
               FlatContainerDupes dupes = KEEP_FIRST_OF_DUPES);
 
+  // Moves the elements of |source| whose keys aren't in this tree into it,
+  // like std::map::merge(). The other elements are left in |source|. Takes
+  // O(size() + source.size()), as both are already sorted.
+  void merge(flat_tree& source);
+  void merge(flat_tree&& source);
+
   template <class... Args>
   std::pair<iterator, bool> emplace(Args&&... args);
 
   template <class... Args>
   iterator emplace_hint(const_iterator position_hint, Args&&... args);
 
+  // --------------------------------------------------------------------------
+  // Bulk operations.
+  //
+  // extract() moves out the sorted vector of elements, leaving the tree
+  // empty, and replace() takes one back, which must be sorted and free of
+  // duplicates. Together, they let callers modify or build the tree in bulk
+  // while reusing its storage, e.g.:
+  //
+  //   std::vector<value_type> items = std::move(tree).extract();
+  //   items.reserve(items.size() + count);
+  //   ... append |count| items in increasing order ...
+  //   tree.replace(std::move(items));
+  //
+  // To build a tree from unsorted items, pass them to the constructor that
+  // takes a std::vector instead.
+
+  std::vector<value_type> extract() &&;
+  void replace(std::vector<value_type>&& body);
+
   // --------------------------------------------------------------------------
   // Erase operations.
   //
@@ -399,49 +454,42 @@ class flat_tree {
     return {position, false};
   }
 
-  // This method is similar to insert_or_assign, with the following differences:
-  // - Instead of searching [begin(), end()) it only searches [first, last).
-  // - In case no equivalent element is found, val is appended to the end of the
-  //   underlying body and an iterator to the next bigger element in [first,
-  //   last) is returned.
-  template <class V>
-  std::pair<iterator, bool> append_or_assign(iterator first,
-                                             iterator last,
-                                             V&& val) {
-    auto position = std::lower_bound(first, last, val, value_comp());
-
-    if (position == last || value_comp()(val, *position)) {
-      // emplace_back might invalidate position, which is why distance needs to
-      // be cached.
-      const difference_type distance = std::distance(begin(), position);
-      impl_.body_.emplace_back(std::forward<V>(val));
-      return {std::next(begin(), distance), true};
-    }
-
-    *position = std::forward<V>(val);
-    return {position, false};
-  }
-
-  // This method is similar to insert, with the following differences:
-  // - Instead of searching [begin(), end()) it only searches [first, last).
-  // - In case no equivalent element is found, val is appended to the end of the
-  //   underlying body and an iterator to the next bigger element in [first,
-  //   last) is returned.
-  template <class V>
-  std::pair<iterator, bool> append_unique(iterator first,
-                                          iterator last,
-                                          V&& val) {
-    auto position = std::lower_bound(first, last, val, value_comp());
-
-    if (position == last || value_comp()(val, *position)) {
-      // emplace_back might invalidate position, which is why distance needs to
-      // be cached.
-      const difference_type distance = std::distance(begin(), position);
-      impl_.body_.emplace_back(std::forward<V>(val));
-      return {std::next(begin(), distance), true};
+  // Merges the elements from |original_size| on, which were just appended,
+  // with the sorted ones before them. In case of KEEP_LAST_OF_DUPES the
+  // appended elements overwrite the existing ones with the same key.
+  void merge_appended(size_type original_size, FlatContainerDupes dupes) {
+    const iterator middle = std::next(begin(), original_size);
+    sort_and_unique(middle, end(), dupes);
+
+    // Drops the appended elements which are already in the tree, and finds
+    // where the first remaining one goes. They are sorted, so each search
+    // starts where the previous one ended.
+    KeyValueCompare key_value(impl_.get_key_comp());
+    GetKeyFromValue extractor;
+    iterator position = begin();
+    iterator first_new_position = middle;
+    iterator out = middle;
+    for (iterator it = middle; it != end(); ++it) {
+      const key_type& key = extractor(*it);
+      position = GallopingLowerBound(position, middle, key, key_value);
+      if (position != middle && !key_value(key, *position)) {
+        if (dupes == KEEP_LAST_OF_DUPES)
+          *position = std::move(*it);
+        continue;
+      }
+      if (out == middle)
+        first_new_position = position;
+      if (out != it)
+        *out = std::move(*it);
+      ++out;
     }
+    const difference_type first_new_distance =
+        std::distance(begin(), first_new_position);
+    erase(out, end());
 
-    return {position, false};
+    std::inplace_merge(std::next(begin(), first_new_distance),
+                       std::next(begin(), original_size), end(),
+                       value_comp());
   }
 
   void sort_and_unique(iterator first,
@@ -734,44 +782,57 @@ void flat_tree<Key, Value, GetKeyFromValue, KeyCompare>::insert(
     return;
   }
 
-  // Provide a convenience lambda to obtain an iterator pointing past the last
-  // old element. This needs to be dymanic due to possible re-allocations.
+  // Append the new values, and merge them in one go.
   const size_type original_size = size();
-  auto middle = [this, original_size]() {
-    return std::next(begin(), original_size);
-  };
+  if (is_multipass<InputIterator>())
+    reserve(original_size + std::distance(first, last));
+  impl_.body_.insert(impl_.body_.end(), first, last);
+  merge_appended(original_size, dupes);
+}
 
-  // For batch updates initialize the first insertion point.
-  difference_type pos_first_new = original_size;
-
-  // Loop over the input range while appending new values and overwriting
-  // existing ones, if applicable. Keep track of the first insertion point.
-  if (overwrite_existing) {
-    for (; first != last; ++first) {
-      std::pair<iterator, bool> result =
-          append_or_assign(begin(), middle(), *first);
-      if (result.second) {
-        pos_first_new =
-            std::min(pos_first_new, std::distance(begin(), result.first));
-      }
-    }
-  } else {
-    for (; first != last; ++first) {
-      std::pair<iterator, bool> result =
-          append_unique(begin(), middle(), *first);
-      if (result.second) {
-        pos_first_new =
-            std::min(pos_first_new, std::distance(begin(), result.first));
-      }
+template <class Key, class Value, class GetKeyFromValue, class KeyCompare>
+void flat_tree<Key, Value, GetKeyFromValue, KeyCompare>::merge(
+    flat_tree& source) {
+  if (&source == this || source.empty())
+    return;
+  if (empty()) {
+    impl_.body_.swap(source.impl_.body_);
+    return;
+  }
+
+  // Moves the elements which aren't in this tree to its end. The reserve()
+  // keeps |position| valid while appending.
+  reserve(size() + source.size());
+  const size_type original_size = size();
+  const iterator middle = end();
+  KeyValueCompare key_value(impl_.get_key_comp());
+  GetKeyFromValue extractor;
+  iterator position = begin();
+  difference_type first_new_distance = original_size;
+  iterator source_out = source.begin();
+  for (iterator it = source.begin(); it != source.end(); ++it) {
+    const key_type& key = extractor(*it);
+    position = GallopingLowerBound(position, middle, key, key_value);
+    if (position != middle && !key_value(key, *position)) {
+      if (source_out != it)
+        *source_out = std::move(*it);
+      ++source_out;
+      continue;
     }
+    if (size() == original_size)
+      first_new_distance = std::distance(begin(), position);
+    impl_.body_.push_back(std::move(*it));
   }
+  source.erase(source_out, source.end());
 
-  // The new elements might be unordered and contain duplicates, so post-process
-  // the just inserted elements and merge them with the rest, inserting them at
-  // the previously found spot.
-  sort_and_unique(middle(), end(), dupes);
-  std::inplace_merge(std::next(begin(), pos_first_new), middle(), end(),
-                     value_comp());
+  std::inplace_merge(std::next(begin(), first_new_distance),
+                     std::next(begin(), original_size), end(), value_comp());
+}
+
+template <class Key, class Value, class GetKeyFromValue, class KeyCompare>
+void flat_tree<Key, Value, GetKeyFromValue, KeyCompare>::merge(
+    flat_tree&& source) {
+  merge(source);
 }
 
 template <class Key, class Value, class GetKeyFromValue, class KeyCompare>
@@ -789,6 +850,27 @@ auto flat_tree<Key, Value, GetKeyFromValue, KeyCompare>::emplace_hint(
   return insert(position_hint, value_type(std::forward<Args>(args)...));
 }
 
+// ----------------------------------------------------------------------------
+// Bulk operations.
+
+template <class Key, class Value, class GetKeyFromValue, class KeyCompare>
+auto flat_tree<Key, Value, GetKeyFromValue, KeyCompare>::extract() &&
+    -> std::vector<value_type> {
+  return std::exchange(impl_.body_, underlying_type());
+}
+
+template <class Key, class Value, class GetKeyFromValue, class KeyCompare>
+void flat_tree<Key, Value, GetKeyFromValue, KeyCompare>::replace(
+    std::vector<value_type>&& body) {
+  DCHECK(std::adjacent_find(body.begin(), body.end(),
+                            [this](const value_type& lhs,
+                                   const value_type& rhs) {
+                              return !value_comp()(lhs, rhs);
+                            }) == body.end())
+      << "replace() requires sorted and unique elements.";
+  impl_.body_ = std::move(body);
+}
+
 // ----------------------------------------------------------------------------
 // Erase operations.
 
@@ -32,6 +32,7 @@
 #include <functional>
 #include <iterator>
 #include <list>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -250,6 +251,18 @@ TEST(FlatTree, LastUnique) {
   EXPECT_THAT(dnd, ElementsAre(Pair(1, 3), Pair(2, 1), Pair(3, 3)));
 }
 
+TEST(FlatTree, GallopingLowerBound) {
+  std::vector<int> values = {1, 3, 3, 5, 7, 9, 11, 13, 15, 17};
+  for (int i = 0; i <= 18; ++i) {
+    EXPECT_EQ(std::lower_bound(values.begin(), values.end(), i),
+              GallopingLowerBound(values.begin(), values.end(), i,
+                                  std::less<int>()));
+  }
+  std::vector<int> empty;
+  EXPECT_EQ(empty.end(), GallopingLowerBound(empty.begin(), empty.end(), 1,
+                                             std::less<int>()));
+}
+
 // ----------------------------------------------------------------------------
 // Class.
 
@@ -848,6 +861,80 @@ TEST(FlatTree, InsertIterIter) {
                                   IntPair(4, 2), IntPair(5, 3), IntPair(6, 3),
                                   IntPair(7, 3), IntPair(8, 3)));
   }
+
+  {
+    // New elements which go between and around the existing ones, from a
+    // single pass range.
+    IntIntMap cont({{2, 1}, {4, 1}, {6, 1}});
+    std::istringstream input("7 5 4 0 5 3");
+    std::vector<IntPair> int_pairs;
+    for (std::istream_iterator<int> it(input), end; it != end; ++it)
+      int_pairs.emplace_back(*it, 2);
+    cont.insert(std::make_move_iterator(int_pairs.begin()),
+                std::make_move_iterator(int_pairs.end()));
+    EXPECT_THAT(cont, ElementsAre(IntPair(0, 2), IntPair(2, 1), IntPair(3, 2),
+                                  IntPair(4, 1), IntPair(5, 2), IntPair(6, 1),
+                                  IntPair(7, 2)));
+  }
+
+  {
+    IntTree cont({10, 20, 30});
+    std::istringstream input("25 5 20 35 15");
+    cont.insert(std::istream_iterator<int>(input),
+                std::istream_iterator<int>());
+    EXPECT_THAT(cont, ElementsAre(5, 10, 15, 20, 25, 30, 35));
+  }
+}
+
+// void merge(flat_tree& source);
+// void merge(flat_tree&& source);
+
+TEST(FlatTree, Merge) {
+  {
+    IntPairTree cont({{1, 1}, {3, 1}, {5, 1}});
+    IntPairTree source({{0, 2}, {3, 2}, {4, 2}, {5, 2}, {6, 2}});
+    cont.merge(source);
+    EXPECT_THAT(cont, ElementsAre(IntPair(0, 2), IntPair(1, 1), IntPair(3, 1),
+                                  IntPair(4, 2), IntPair(5, 1), IntPair(6, 2)));
+    // The elements whose keys were already there stay in |source|.
+    EXPECT_THAT(source, ElementsAre(IntPair(3, 2), IntPair(5, 2)));
+  }
+
+  {
+    IntTree cont;
+    IntTree source({1, 2, 3});
+    cont.merge(source);
+    EXPECT_THAT(cont, ElementsAre(1, 2, 3));
+    EXPECT_TRUE(source.empty());
+
+    cont.merge(cont);
+    EXPECT_THAT(cont, ElementsAre(1, 2, 3));
+
+    cont.merge(IntTree({0, 4}));
+    EXPECT_THAT(cont, ElementsAre(0, 1, 2, 3, 4));
+  }
+
+  {
+    MoveOnlyTree cont;
+    cont.emplace(2);
+    cont.emplace(4);
+    MoveOnlyTree source;
+    source.emplace(1);
+    source.emplace(2);
+    source.emplace(3);
+    cont.merge(std::move(source));
+    EXPECT_EQ(4U, cont.size());
+    EXPECT_EQ(1, cont.begin()->data());
+    EXPECT_EQ(4, std::prev(cont.end())->data());
+  }
+
+  {
+    ReversedTree cont({5, 3, 1});
+    ReversedTree source({6, 4, 3, 2});
+    cont.merge(source);
+    EXPECT_THAT(cont, ElementsAre(6, 5, 4, 3, 2, 1));
+    EXPECT_THAT(source, ElementsAre(3));
+  }
 }
 
 // template <class... Args>
@@ -918,6 +1005,29 @@ TEST(FlatTree, EmplacePosition) {
   }
 }
 
+// ----------------------------------------------------------------------------
+// Bulk operations.
+
+// std::vector<value_type> extract() &&;
+// void replace(std::vector<value_type>&& body);
+
+TEST(FlatTree, ExtractAndReplace) {
+  IntTree cont({1, 2, 3});
+  cont.reserve(10);
+  std::vector<int> body = std::move(cont).extract();
+  EXPECT_TRUE(cont.empty());
+  EXPECT_THAT(body, ElementsAre(1, 2, 3));
+  EXPECT_GE(body.capacity(), 10U);
+
+  body.push_back(4);
+  body.push_back(5);
+  cont.replace(std::move(body));
+  EXPECT_THAT(cont, ElementsAre(1, 2, 3, 4, 5));
+  EXPECT_GE(cont.capacity(), 10U);
+  EXPECT_EQ(cont.end(), cont.find(6));
+  EXPECT_NE(cont.end(), cont.find(4));
+}
+
 // ----------------------------------------------------------------------------
 // Erase operations.
 
@@ -6,11 +6,13 @@
 #define BASE_CONTAINERS_HASH_TABLES_H_
 
 #include <cstddef>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
 #include "base/hash.h"
+#include "base/strings/string16.h"
 
 // This header file is deprecated. Use the corresponding C++11 type
 // instead. https://crbug.com/576864
@@ -36,6 +38,22 @@ struct hash<std::pair<Type1, Type2>> {
   }
 };
 
+// Strings are hashed with base::Hash64(), which is faster than std::hash on
+// long strings.
+template <>
+struct hash<std::string> {
+  std::size_t operator()(const std::string& value) const {
+    return static_cast<std::size_t>(base::Hash64(value));
+  }
+};
+
+template <>
+struct hash<base::string16> {
+  std::size_t operator()(const base::string16& value) const {
+    return static_cast<std::size_t>(base::Hash64(value));
+  }
+};
+
 }  // namespace BASE_HASH_NAMESPACE
 
 namespace base {
@@ -15,6 +15,7 @@
 #include <utility>
 
 #include "base/containers/flat_set.h"
+#include "base/containers/slot_map.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/sequence_checker.h"
@@ -32,7 +33,17 @@ namespace base {
 
 // The map's value type (the V param) can be any dereferenceable type, such as a
 // raw pointer or smart pointer
-template <typename V, typename K = int32_t>
+//
+// The S param selects how the values are stored. A hash table accepts any
+// ID. A SlotMap (see slot_map.h) makes lookups a single indexed load, but only
+// supports the IDs generated by Add(): AddWithID() is not available. These IDs
+// are 64-bit, so K must be too, and never 0.
+
+enum class IDMapStorage { kHashTable, kSlotMap };
+
+template <typename V,
+          typename K = int32_t,
+          IDMapStorage S = IDMapStorage::kHashTable>
 class IDMap final {
  public:
   using KeyType = K;
@@ -285,6 +296,134 @@ class IDMap final {
   DISALLOW_COPY_AND_ASSIGN(IDMap);
 };
 
+template <typename V, typename K>
+class IDMap<V, K, IDMapStorage::kSlotMap> final {
+ public:
+  using KeyType = K;
+
+ private:
+  using T = typename std::remove_reference<decltype(*V())>::type;
+
+  using Slots = SlotMap<V>;
+
+  static_assert(sizeof(KeyType) == sizeof(uint64_t),
+                "SlotMap IDs don't fit in KeyType");
+
+ public:
+  IDMap() : check_on_null_data_(false) {
+    // See the comments in the hash table IDMap.
+    DETACH_FROM_SEQUENCE(sequence_checker_);
+  }
+
+  ~IDMap() { DETACH_FROM_SEQUENCE(sequence_checker_); }
+
+  void set_check_on_null_data(bool value) { check_on_null_data_ = value; }
+
+  KeyType Add(V data) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    DCHECK(!check_on_null_data_ || data);
+    return static_cast<KeyType>(slots_.Add(std::move(data)).ToUint64());
+  }
+
+  void Remove(KeyType id) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    if (!slots_.Remove(ToHandle(id)))
+      NOTREACHED() << "Attempting to remove an item not in the list";
+  }
+
+  V Replace(KeyType id, V new_data) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    DCHECK(!check_on_null_data_ || new_data);
+    V* data = slots_.Lookup(ToHandle(id));
+    DCHECK(data);
+
+    using std::swap;
+    swap(*data, new_data);
+    return new_data;
+  }
+
+  void Clear() {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    slots_.Clear();
+  }
+
+  bool IsEmpty() const {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    return slots_.IsEmpty();
+  }
+
+  T* Lookup(KeyType id) const {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    const V* data = slots_.Lookup(ToHandle(id));
+    if (!data || !*data)
+      return nullptr;
+    return &**data;
+  }
+
+  size_t size() const {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    return slots_.size();
+  }
+
+#if defined(UNIT_TEST)
+  int iteration_depth() const { return slots_.iteration_depth(); }
+#endif  // defined(UNIT_TEST)
+
+  // It is safe to remove elements from the map during iteration. All iterators
+  // will remain valid.
+  template <class ReturnType>
+  class Iterator {
+   public:
+    Iterator(IDMap* map) : map_(map), iter_(&map->slots_) {
+      DCHECK_CALLED_ON_VALID_SEQUENCE(map_->sequence_checker_);
+    }
+
+    bool IsAtEnd() const {
+      DCHECK_CALLED_ON_VALID_SEQUENCE(map_->sequence_checker_);
+      return iter_.IsAtEnd();
+    }
+
+    KeyType GetCurrentKey() const {
+      DCHECK_CALLED_ON_VALID_SEQUENCE(map_->sequence_checker_);
+      return static_cast<KeyType>(iter_.GetCurrentHandle().ToUint64());
+    }
+
+    ReturnType* GetCurrentValue() const {
+      DCHECK_CALLED_ON_VALID_SEQUENCE(map_->sequence_checker_);
+      V* data = iter_.GetCurrentValue();
+      if (!data || !*data)
+        return nullptr;
+      return &**data;
+    }
+
+    void Advance() {
+      DCHECK_CALLED_ON_VALID_SEQUENCE(map_->sequence_checker_);
+      iter_.Advance();
+    }
+
+   private:
+    IDMap* const map_;
+    typename Slots::iterator iter_;
+  };
+
+  typedef Iterator<T> iterator;
+  typedef Iterator<const T> const_iterator;
+
+ private:
+  static typename Slots::Handle ToHandle(KeyType id) {
+    return Slots::Handle::FromUint64(static_cast<uint64_t>(id));
+  }
+
+  Slots slots_;
+
+  // See description above setter.
+  bool check_on_null_data_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  DISALLOW_COPY_AND_ASSIGN(IDMap);
+};
+
 }  // namespace base
 
 #endif  // BASE_CONTAINERS_ID_MAP_H_
@@ -396,4 +396,76 @@ TEST(IDMapTest, RemovedValueHandling) {
   EXPECT_EQ(1u, map.size());
 }
 
+using SlotIDMap =
+    IDMap<std::unique_ptr<DestructorCounter>, uint64_t, IDMapStorage::kSlotMap>;
+
+TEST(IDMapTest, SlotMapStorage) {
+  int del_count = 0;
+  SlotIDMap map;
+  EXPECT_TRUE(map.IsEmpty());
+
+  const uint64_t id1 =
+      map.Add(std::make_unique<DestructorCounter>(&del_count));
+  const uint64_t id2 =
+      map.Add(std::make_unique<DestructorCounter>(&del_count));
+  EXPECT_NE(0u, id1);
+  EXPECT_NE(id1, id2);
+  EXPECT_EQ(2u, map.size());
+  EXPECT_TRUE(map.Lookup(id1));
+  EXPECT_FALSE(map.Lookup(0));
+
+  map.Remove(id1);
+  EXPECT_EQ(1, del_count);
+  EXPECT_FALSE(map.Lookup(id1));
+
+  // The slot of |id1| is reused, with a new ID.
+  const uint64_t id3 =
+      map.Add(std::make_unique<DestructorCounter>(&del_count));
+  EXPECT_NE(id1, id3);
+  EXPECT_FALSE(map.Lookup(id1));
+  EXPECT_TRUE(map.Lookup(id3));
+
+  std::unique_ptr<DestructorCounter> replaced = map.Replace(
+      id3, std::make_unique<DestructorCounter>(&del_count));
+  EXPECT_NE(replaced.get(), map.Lookup(id3));
+  replaced.reset();
+  EXPECT_EQ(2, del_count);
+
+  map.Clear();
+  EXPECT_EQ(4, del_count);
+  EXPECT_TRUE(map.IsEmpty());
+}
+
+TEST(IDMapTest, SlotMapStorageIteratorRemainsValidWhenRemoving) {
+  int del_count = 0;
+  SlotIDMap map;
+  uint64_t ids[3];
+  for (uint64_t& id : ids)
+    id = map.Add(std::make_unique<DestructorCounter>(&del_count));
+
+  {
+    int visited = 0;
+    SlotIDMap::iterator iter(&map);
+    for (; !iter.IsAtEnd(); iter.Advance()) {
+      EXPECT_EQ(1, map.iteration_depth());
+      if (iter.GetCurrentKey() == ids[0]) {
+        map.Remove(ids[0]);
+        map.Remove(ids[2]);
+        EXPECT_FALSE(iter.GetCurrentValue());
+      } else {
+        EXPECT_TRUE(iter.GetCurrentValue());
+      }
+      ++visited;
+    }
+    EXPECT_EQ(2, visited);
+    // The objects are only destroyed when the iteration ends.
+    EXPECT_EQ(0, del_count);
+  }
+
+  EXPECT_EQ(0, map.iteration_depth());
+  EXPECT_EQ(2, del_count);
+  EXPECT_EQ(1u, map.size());
+  EXPECT_TRUE(map.Lookup(ids[1]));
+}
+
 }  // namespace base
@@ -0,0 +1,201 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_INTRUSIVE_HASH_SET_H_
+#define BASE_CONTAINERS_INTRUSIVE_HASH_SET_H_
+
+#include <stddef.h>
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "base/containers/flat_hash_table.h"
+#include "base/logging.h"
+#include "base/macros.h"
+
+// An intrusive hash set: like LinkedList, the elements embed their own links,
+// so inserting only allocates when the bucket array grows, and an element is
+// removed in O(1) given its pointer.
+//
+// Declare the element type as extending IntrusiveHashSetNode, and give the
+// set a functor returning the key of an element:
+//
+//   class Request : public IntrusiveHashSetNode<Request> {
+//    public:
+//     int id() const { return id_; }
+//     ...
+//   };
+//
+//   struct RequestId {
+//     int operator()(const Request& request) const { return request.id(); }
+//   };
+//
+//   IntrusiveHashSet<Request, RequestId> requests;
+//   requests.Insert(&request);
+//   Request* found = requests.Find(42);
+//   requests.Erase(found);
+//
+// The set doesn't own its elements, which must be removed before they are
+// destroyed. The keys of the elements in a set mustn't change.
+
+namespace base {
+
+template <typename T, typename KeyOf, typename Hash>
+class IntrusiveHashSet;
+
+template <typename T>
+class IntrusiveHashSetNode {
+ public:
+  IntrusiveHashSetNode() = default;
+  ~IntrusiveHashSetNode() { DCHECK(!InSet()); }
+
+  // Returns true if the node is in a set.
+  bool InSet() const { return link_to_this_ != nullptr; }
+
+ private:
+  template <typename U, typename KeyOf, typename Hash>
+  friend class IntrusiveHashSet;
+
+  // The next node of the bucket.
+  IntrusiveHashSetNode* next_ = nullptr;
+  // The pointer to this node: the bucket, or |next_| of the previous node.
+  IntrusiveHashSetNode** link_to_this_ = nullptr;
+  // The hash of the key, so that growing doesn't hash the keys again, and
+  // most mismatches don't compare them.
+  size_t hash_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(IntrusiveHashSetNode);
+};
+
+template <typename T,
+          typename KeyOf,
+          typename Hash = std::hash<typename std::decay<decltype(
+              std::declval<KeyOf>()(std::declval<const T&>()))>::type>>
+class IntrusiveHashSet {
+ public:
+  using Node = IntrusiveHashSetNode<T>;
+
+  IntrusiveHashSet() = default;
+  ~IntrusiveHashSet() { DCHECK(empty()); }
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+  // Adds |value|, which mustn't be in a set. Returns false, and doesn't add
+  // it, if the set already has an element with the same key.
+  bool Insert(T* value) {
+    Node* node = value;
+    DCHECK(!node->InSet());
+    const size_t hash = HashKey(key_of_(*value));
+    if (FindNode(key_of_(*value), hash))
+      return false;
+    // Grow at a load factor of 1.
+    if (size_ == num_buckets_)
+      Rehash(num_buckets_ ? 2 * num_buckets_ : kInitialBuckets);
+    node->hash_ = hash;
+    Link(node, &buckets_[hash & (num_buckets_ - 1)]);
+    ++size_;
+    return true;
+  }
+
+  // Returns the element with |key|, or null.
+  template <typename Key>
+  T* Find(const Key& key) const {
+    return static_cast<T*>(FindNode(key, HashKey(key)));
+  }
+
+  // Removes |value|, which must be in this set.
+  void Erase(T* value) {
+    Node* node = value;
+    DCHECK(node->InSet());
+    *node->link_to_this_ = node->next_;
+    if (node->next_)
+      node->next_->link_to_this_ = node->link_to_this_;
+    node->next_ = nullptr;
+    node->link_to_this_ = nullptr;
+    --size_;
+  }
+
+  // Removes all the elements. Keeps the buckets.
+  void Clear() {
+    for (size_t i = 0; i < num_buckets_; ++i) {
+      while (buckets_[i])
+        Erase(static_cast<T*>(buckets_[i]));
+    }
+  }
+
+  // Calls |function| with each element, in no particular order. |function|
+  // mustn't change the set.
+  template <typename Function>
+  void ForEach(Function function) const {
+    for (size_t i = 0; i < num_buckets_; ++i) {
+      for (Node* node = buckets_[i]; node; node = node->next_)
+        function(static_cast<T*>(node));
+    }
+  }
+
+ private:
+  static constexpr size_t kInitialBuckets = 8;
+
+  // The buckets are picked by the low bits of the hash, which std::hash
+  // leaves unchanged for integers.
+  template <typename Key>
+  size_t HashKey(const Key& key) const {
+    return internal::FlatHashMix(hash_(key));
+  }
+
+  template <typename Key>
+  Node* FindNode(const Key& key, size_t hash) const {
+    if (!num_buckets_)
+      return nullptr;
+    for (Node* node = buckets_[hash & (num_buckets_ - 1)]; node;
+         node = node->next_) {
+      if (node->hash_ == hash && key_of_(*static_cast<T*>(node)) == key)
+        return node;
+    }
+    return nullptr;
+  }
+
+  // Makes |node| the first node of |bucket|.
+  static void Link(Node* node, Node** bucket) {
+    node->next_ = *bucket;
+    if (node->next_)
+      node->next_->link_to_this_ = &node->next_;
+    node->link_to_this_ = bucket;
+    *bucket = node;
+  }
+
+  // Moves the elements to |num_buckets| buckets, a power of 2.
+  void Rehash(size_t num_buckets) {
+    std::unique_ptr<Node* []> buckets(new Node*[num_buckets]());
+    for (size_t i = 0; i < num_buckets_; ++i) {
+      Node* node = buckets_[i];
+      while (node) {
+        Node* next = node->next_;
+        Link(node, &buckets[node->hash_ & (num_buckets - 1)]);
+        node = next;
+      }
+    }
+    buckets_ = std::move(buckets);
+    num_buckets_ = num_buckets;
+  }
+
+  // A power of 2, or 0 before the first insertion.
+  std::unique_ptr<Node* []> buckets_;
+  size_t num_buckets_ = 0;
+  size_t size_ = 0;
+  KeyOf key_of_;
+  Hash hash_;
+
+  DISALLOW_COPY_AND_ASSIGN(IntrusiveHashSet);
+};
+
+template <typename T, typename KeyOf, typename Hash>
+constexpr size_t IntrusiveHashSet<T, KeyOf, Hash>::kInitialBuckets;
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_INTRUSIVE_HASH_SET_H_
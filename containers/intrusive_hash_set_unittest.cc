@@ -0,0 +1,114 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/intrusive_hash_set.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class Element : public IntrusiveHashSetNode<Element> {
+ public:
+  explicit Element(std::string name) : name(std::move(name)) {}
+
+  std::string name;
+};
+
+struct ElementName {
+  const std::string& operator()(const Element& element) const {
+    return element.name;
+  }
+};
+
+using ElementSet = IntrusiveHashSet<Element, ElementName>;
+
+}  // namespace
+
+TEST(IntrusiveHashSetTest, InsertFindErase) {
+  Element a("a"), b("b"), other_a("a");
+  ElementSet set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(nullptr, set.Find(std::string("a")));
+
+  EXPECT_TRUE(set.Insert(&a));
+  EXPECT_TRUE(set.Insert(&b));
+  EXPECT_FALSE(set.Insert(&other_a));
+  EXPECT_TRUE(a.InSet());
+  EXPECT_FALSE(other_a.InSet());
+  EXPECT_EQ(2u, set.size());
+  EXPECT_EQ(&a, set.Find(std::string("a")));
+  EXPECT_EQ(&b, set.Find(std::string("b")));
+  EXPECT_EQ(nullptr, set.Find(std::string("c")));
+
+  set.Erase(&a);
+  EXPECT_FALSE(a.InSet());
+  EXPECT_EQ(nullptr, set.Find(std::string("a")));
+  EXPECT_TRUE(set.Insert(&other_a));
+  EXPECT_EQ(&other_a, set.Find(std::string("a")));
+
+  set.Clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_FALSE(b.InSet());
+  EXPECT_FALSE(other_a.InSet());
+}
+
+TEST(IntrusiveHashSetTest, Grow) {
+  const int kNumElements = 1000;
+  std::vector<std::unique_ptr<Element>> elements;
+  ElementSet set;
+  for (int i = 0; i < kNumElements; ++i) {
+    elements.push_back(std::make_unique<Element>(std::to_string(i)));
+    EXPECT_TRUE(set.Insert(elements.back().get()));
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumElements), set.size());
+  for (int i = 0; i < kNumElements; ++i)
+    EXPECT_EQ(elements[i].get(), set.Find(std::to_string(i)));
+
+  // Erases every other element, from the middle of the buckets too.
+  for (int i = 0; i < kNumElements; i += 2)
+    set.Erase(elements[i].get());
+  for (int i = 0; i < kNumElements; ++i) {
+    EXPECT_EQ(i % 2 ? elements[i].get() : nullptr,
+              set.Find(std::to_string(i)));
+  }
+
+  std::set<Element*> visited;
+  set.ForEach([&](Element* element) { visited.insert(element); });
+  EXPECT_EQ(static_cast<size_t>(kNumElements / 2), visited.size());
+  for (Element* element : visited)
+    EXPECT_EQ(element, set.Find(element->name));
+
+  set.Clear();
+}
+
+TEST(IntrusiveHashSetTest, IntegerKeys) {
+  struct Entry : public IntrusiveHashSetNode<Entry> {
+    explicit Entry(int id) : id(id) {}
+    int id;
+  };
+  struct EntryId {
+    int operator()(const Entry& entry) const { return entry.id; }
+  };
+
+  // Keys which only differ in their high bits.
+  std::vector<std::unique_ptr<Entry>> entries;
+  IntrusiveHashSet<Entry, EntryId> set;
+  for (int i = 0; i < 64; ++i) {
+    entries.push_back(std::make_unique<Entry>(i << 20));
+    EXPECT_TRUE(set.Insert(entries.back().get()));
+  }
+  for (int i = 0; i < 64; ++i)
+    EXPECT_EQ(entries[i].get(), set.Find(i << 20));
+  EXPECT_EQ(nullptr, set.Find(1));
+  set.Clear();
+}
+
+}  // namespace base
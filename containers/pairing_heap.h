@@ -0,0 +1,204 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_PAIRING_HEAP_H_
+#define BASE_CONTAINERS_PAIRING_HEAP_H_
+
+#include <stddef.h>
+
+#include <functional>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/macros.h"
+
+// An intrusive priority queue: like LinkedList, the elements embed their own
+// links, so pushing never allocates, and an element can be removed in
+// O(log n) amortized time given its pointer, e.g. when it's cancelled.
+//
+// Declare the element type as extending PairingHeapNode:
+//
+//   class Timer : public PairingHeapNode<Timer> {
+//     ...
+//   };
+//
+//   PairingHeap<Timer, TimerCompare> heap;
+//   heap.Push(&timer);
+//   ...
+//   heap.Erase(&timer);  // |timer| was cancelled.
+//   ...
+//   Timer* next = heap.Pop();
+//
+// Like std::priority_queue, top() is the greatest element for |Compare|, so
+// a heap ordered by increasing time needs a Compare which returns true when
+// its first argument is later than the second.
+//
+// The heap is a pairing heap: Push() and top() are O(1), Pop() and Erase()
+// O(log n) amortized. The elements never move, only their links change, so a
+// heap of large elements costs the same as a heap of pointers. The heap
+// doesn't own its elements, which must be removed before they are destroyed.
+
+namespace base {
+
+template <typename T, typename Compare>
+class PairingHeap;
+
+template <typename T>
+class PairingHeapNode {
+ public:
+  PairingHeapNode() = default;
+  ~PairingHeapNode() { DCHECK(!InHeap()); }
+
+  // Returns true if the node is in a heap.
+  bool InHeap() const { return previous_ != nullptr; }
+
+ private:
+  template <typename U, typename Compare>
+  friend class PairingHeap;
+
+  // The first child.
+  PairingHeapNode* child_ = nullptr;
+  // The next sibling.
+  PairingHeapNode* next_ = nullptr;
+  // The previous sibling, or the parent of a first child, or the heap's own
+  // sentinel node for its root.
+  PairingHeapNode* previous_ = nullptr;
+
+  DISALLOW_COPY_AND_ASSIGN(PairingHeapNode);
+};
+
+template <typename T, typename Compare = std::less<T>>
+class PairingHeap {
+ public:
+  using Node = PairingHeapNode<T>;
+
+  PairingHeap() = default;
+  explicit PairingHeap(const Compare& compare) : compare_(compare) {}
+  ~PairingHeap() { DCHECK(empty()); }
+
+  bool empty() const { return !root_.child_; }
+  size_t size() const { return size_; }
+
+  // Returns the greatest element.
+  T* top() const {
+    DCHECK(!empty());
+    return static_cast<T*>(root_.child_);
+  }
+
+  // Adds |value|, which mustn't be in a heap.
+  void Push(T* value) {
+    Node* node = value;
+    DCHECK(!node->InHeap());
+    SetRoot(root_.child_ ? Meld(root_.child_, node) : node);
+    ++size_;
+  }
+
+  // Removes and returns the greatest element.
+  T* Pop() {
+    T* value = top();
+    Erase(value);
+    return value;
+  }
+
+  // Removes |value|, which must be in this heap.
+  void Erase(T* value) {
+    Node* node = value;
+    DCHECK(node->InHeap());
+    if (node == root_.child_) {
+      SetRoot(MergePairs(node->child_));
+    } else {
+      Unlink(node);
+      if (node->child_)
+        SetRoot(Meld(root_.child_, MergePairs(node->child_)));
+    }
+    node->child_ = nullptr;
+    node->next_ = nullptr;
+    node->previous_ = nullptr;
+    --size_;
+  }
+
+  // Reorders |value|, which must be in this heap, after its priority changed.
+  void Update(T* value) {
+    Erase(value);
+    Push(value);
+  }
+
+  // Removes all the elements.
+  void Clear() {
+    while (!empty())
+      Pop();
+  }
+
+ private:
+  // Makes |node|, a tree of the heap or null, the whole heap.
+  void SetRoot(Node* node) {
+    root_.child_ = node;
+    if (node) {
+      node->previous_ = &root_;
+      node->next_ = nullptr;
+    }
+  }
+
+  // Returns the root of the tree merging the trees |a| and |b|, whose
+  // siblings are ignored.
+  Node* Meld(Node* a, Node* b) {
+    if (compare_(*static_cast<T*>(a), *static_cast<T*>(b)))
+      std::swap(a, b);
+    // |b| becomes the first child of |a|.
+    b->previous_ = a;
+    b->next_ = a->child_;
+    if (b->next_)
+      b->next_->previous_ = b;
+    a->child_ = b;
+    a->next_ = nullptr;
+    return a;
+  }
+
+  // Returns the root of the tree merging |first| and its next siblings, with
+  // the two pass algorithm: meld the trees in pairs from left to right, then
+  // meld the results from right to left.
+  Node* MergePairs(Node* first) {
+    if (!first)
+      return nullptr;
+    // The first pass links the results backwards through |previous_|.
+    Node* last = nullptr;
+    while (first) {
+      Node* second = first->next_;
+      Node* next = second ? second->next_ : nullptr;
+      Node* tree = second ? Meld(first, second) : first;
+      tree->previous_ = last;
+      last = tree;
+      first = next;
+    }
+    Node* tree = last;
+    Node* node = last->previous_;
+    while (node) {
+      Node* previous = node->previous_;
+      tree = Meld(node, tree);
+      node = previous;
+    }
+    return tree;
+  }
+
+  // Detaches |node|, which isn't the root, from its parent and siblings.
+  void Unlink(Node* node) {
+    if (node->previous_->child_ == node)
+      node->previous_->child_ = node->next_;
+    else
+      node->previous_->next_ = node->next_;
+    if (node->next_)
+      node->next_->previous_ = node->previous_;
+  }
+
+  // |root_.child_| is the root of the heap.
+  Node root_;
+  size_t size_ = 0;
+  Compare compare_;
+
+  DISALLOW_COPY_AND_ASSIGN(PairingHeap);
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_PAIRING_HEAP_H_
@@ -0,0 +1,139 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/pairing_heap.h"
+
+#include <iterator>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "base/rand_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class Element : public PairingHeapNode<Element> {
+ public:
+  explicit Element(int value) : value(value) {}
+
+  bool operator<(const Element& other) const { return value < other.value; }
+
+  int value;
+};
+
+// Orders the heap by increasing value.
+struct Greater {
+  bool operator()(const Element& a, const Element& b) const {
+    return a.value > b.value;
+  }
+};
+
+std::vector<std::unique_ptr<Element>> MakeElements(
+    const std::vector<int>& values) {
+  std::vector<std::unique_ptr<Element>> elements;
+  for (int value : values)
+    elements.push_back(std::make_unique<Element>(value));
+  return elements;
+}
+
+}  // namespace
+
+TEST(PairingHeapTest, PushPop) {
+  std::vector<std::unique_ptr<Element>> elements =
+      MakeElements({3, 1, 4, 1, 5, 9, 2, 6});
+  PairingHeap<Element> heap;
+  EXPECT_TRUE(heap.empty());
+  for (const auto& element : elements) {
+    heap.Push(element.get());
+    EXPECT_TRUE(element->InHeap());
+  }
+  EXPECT_EQ(elements.size(), heap.size());
+  EXPECT_EQ(9, heap.top()->value);
+
+  std::vector<int> values;
+  while (!heap.empty())
+    values.push_back(heap.Pop()->value);
+  EXPECT_EQ(std::vector<int>({9, 6, 5, 4, 3, 2, 1, 1}), values);
+  for (const auto& element : elements)
+    EXPECT_FALSE(element->InHeap());
+}
+
+TEST(PairingHeapTest, Compare) {
+  Element a(2), b(1), c(3);
+  PairingHeap<Element, Greater> heap;
+  heap.Push(&a);
+  heap.Push(&b);
+  heap.Push(&c);
+  EXPECT_EQ(&b, heap.Pop());
+  EXPECT_EQ(&a, heap.Pop());
+  EXPECT_EQ(&c, heap.Pop());
+}
+
+TEST(PairingHeapTest, EraseAndUpdate) {
+  std::vector<std::unique_ptr<Element>> elements =
+      MakeElements({0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  PairingHeap<Element, Greater> heap;
+  for (const auto& element : elements)
+    heap.Push(element.get());
+  // Builds a deeper tree.
+  heap.Erase(heap.top());
+
+  heap.Erase(elements[5].get());
+  heap.Erase(elements[9].get());
+  heap.Erase(elements[1].get());
+  EXPECT_FALSE(elements[5]->InHeap());
+  EXPECT_EQ(6u, heap.size());
+
+  elements[8]->value = -1;
+  heap.Update(elements[8].get());
+  EXPECT_EQ(elements[8].get(), heap.top());
+
+  std::vector<int> values;
+  while (!heap.empty())
+    values.push_back(heap.Pop()->value);
+  EXPECT_EQ(std::vector<int>({-1, 2, 3, 4, 6, 7}), values);
+}
+
+TEST(PairingHeapTest, Random) {
+  const int kNumElements = 1000;
+  std::vector<int> values;
+  for (int i = 0; i < kNumElements; ++i)
+    values.push_back(RandInt(0, 100));
+  std::vector<std::unique_ptr<Element>> elements = MakeElements(values);
+  PairingHeap<Element> heap;
+  std::multiset<int> expected;
+
+  for (int round = 0; round < 10000; ++round) {
+    Element& element = *elements[RandInt(0, kNumElements - 1)];
+    switch (RandInt(0, 2)) {
+      case 0:
+        if (!element.InHeap()) {
+          heap.Push(&element);
+          expected.insert(element.value);
+        }
+        break;
+      case 1:
+        if (element.InHeap()) {
+          expected.erase(expected.find(element.value));
+          heap.Erase(&element);
+        }
+        break;
+      case 2:
+        if (!heap.empty()) {
+          EXPECT_EQ(*expected.rbegin(), heap.top()->value);
+          expected.erase(std::prev(expected.end()));
+          heap.Pop();
+        }
+        break;
+    }
+    ASSERT_EQ(expected.size(), heap.size());
+  }
+  heap.Clear();
+  EXPECT_TRUE(heap.empty());
+}
+
+}  // namespace base
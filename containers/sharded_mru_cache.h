@@ -0,0 +1,305 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// ShardedMRUCache is a thread-safe version of HashingMRUCache, for caches
+// shared between threads which would otherwise wrap a single MRUCache in a
+// global lock.
+//
+// The items are spread over a fixed number of shards by the hash of their
+// key, and each shard is a HashingMRUCache with its own lock and its own
+// share of the budget. Lookups of keys in different shards don't contend,
+// and eviction is least recently used within each shard, which approximates
+// LRU over the whole cache.
+//
+// The budget is expressed as a total cost: by default every item costs 1, so
+// it is the maximum number of items, but a cost function can be given to e.g.
+// bound the number of bytes used.
+//
+// Since other threads may evict an item at any time, the payloads are copied
+// out rather than returned by reference: use a small type, or a
+// scoped_refptr to an immutable one.
+//
+// Example:
+//
+//   struct EntrySize {
+//     size_t operator()(const std::string& key,
+//                       const scoped_refptr<Entry>& entry) const {
+//       return key.size() + entry->size();
+//     }
+//   };
+//
+//   // Holds up to 1 MB of entries.
+//   ShardedMRUCache<std::string, scoped_refptr<Entry>, std::hash<std::string>,
+//                   EntrySize>
+//       cache(1024 * 1024);
+//   cache.EnableMemoryPressureShrinking();
+//
+//   scoped_refptr<Entry> entry;
+//   if (!cache.Get(key, &entry)) {
+//     entry = ComputeEntry(key);
+//     cache.Put(key, entry);
+//   }
+
+#ifndef BASE_CONTAINERS_SHARDED_MRU_CACHE_H_
+#define BASE_CONTAINERS_SHARDED_MRU_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/containers/mru_cache.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/synchronization/lock.h"
+
+namespace base {
+
+// The default cost function of ShardedMRUCache, which counts items.
+struct MRUCacheUnitCost {
+  template <class KeyType, class PayloadType>
+  size_t operator()(const KeyType&, const PayloadType&) const {
+    return 1;
+  }
+};
+
+template <class KeyType,
+          class PayloadType,
+          class HashType = std::hash<KeyType>,
+          class CostType = MRUCacheUnitCost>
+class ShardedMRUCache {
+ public:
+  static constexpr size_t kDefaultShardCount = 16;
+
+  // |max_cost| is split evenly between the |shard_count| shards. Fewer shards
+  // make the eviction order closer to exact LRU, and more shards reduce
+  // contention.
+  explicit ShardedMRUCache(size_t max_cost,
+                           size_t shard_count = kDefaultShardCount,
+                           const CostType& cost = CostType())
+      : max_cost_(max_cost), cost_(cost) {
+    DCHECK_GT(shard_count, 0u);
+    DCHECK_GE(max_cost, shard_count);
+    const size_t shard_max_cost = (max_cost + shard_count - 1) / shard_count;
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i)
+      shards_.push_back(std::make_unique<Shard>(shard_max_cost));
+  }
+
+  ~ShardedMRUCache() = default;
+
+  size_t max_cost() const { return max_cost_; }
+
+  // Inserts |payload| under |key|, replacing any existing item with that key,
+  // and evicts the least recently used items of its shard to make room for
+  // it. Returns false without inserting anything if the item on its own costs
+  // more than a shard's budget.
+  template <typename Payload>
+  bool Put(const KeyType& key, Payload&& payload) {
+    // Computing the cost may be expensive, so it's done before locking.
+    PayloadType value(std::forward<Payload>(payload));
+    const size_t cost = cost_(key, value);
+
+    Shard& shard = GetShard(key);
+    AutoLock lock(shard.lock);
+    auto it = shard.cache.Peek(key);
+    if (it != shard.cache.end()) {
+      shard.cost -= it->second.cost;
+      shard.cache.Erase(it);
+    }
+    if (cost > shard.max_cost)
+      return false;
+    ShrinkShard(&shard, shard.max_cost - cost);
+    shard.cache.Put(key, Entry{std::move(value), cost});
+    shard.cost += cost;
+    return true;
+  }
+
+  // Copies the payload for |key| to |*payload| and marks it as the most
+  // recently used. Returns false if there is none. Counts as a hit or a miss
+  // for RecordHistograms().
+  bool Get(const KeyType& key, PayloadType* payload) {
+    Shard& shard = GetShard(key);
+    AutoLock lock(shard.lock);
+    auto it = shard.cache.Get(key);
+    if (it == shard.cache.end()) {
+      ++shard.misses;
+      return false;
+    }
+    ++shard.hits;
+    *payload = it->second.payload;
+    return true;
+  }
+
+  // Like Get(), but without affecting the recency ordering or the hit and
+  // miss counts.
+  bool Peek(const KeyType& key, PayloadType* payload) const {
+    Shard& shard = GetShard(key);
+    AutoLock lock(shard.lock);
+    auto it = shard.cache.Peek(key);
+    if (it == shard.cache.end())
+      return false;
+    *payload = it->second.payload;
+    return true;
+  }
+
+  // Removes the item with the given key. Returns false if there was none.
+  bool Erase(const KeyType& key) {
+    Shard& shard = GetShard(key);
+    AutoLock lock(shard.lock);
+    auto it = shard.cache.Peek(key);
+    if (it == shard.cache.end())
+      return false;
+    shard.cost -= it->second.cost;
+    shard.cache.Erase(it);
+    return true;
+  }
+
+  // Evicts the least recently used items of each shard until the total cost
+  // is at most |max_cost|. This doesn't change the budget for new items.
+  void ShrinkToCost(size_t max_cost) {
+    const size_t shard_max_cost = max_cost / shards_.size();
+    for (const auto& shard : shards_) {
+      AutoLock lock(shard->lock);
+      ShrinkShard(shard.get(), shard_max_cost);
+    }
+  }
+
+  void Clear() {
+    for (const auto& shard : shards_) {
+      AutoLock lock(shard->lock);
+      shard->cache.Clear();
+      shard->cost = 0;
+    }
+  }
+
+  // These lock each shard in turn, so they are only a snapshot when other
+  // threads are using the cache.
+  size_t size() const {
+    size_t size = 0;
+    for (const auto& shard : shards_) {
+      AutoLock lock(shard->lock);
+      size += shard->cache.size();
+    }
+    return size;
+  }
+
+  size_t total_cost() const {
+    size_t cost = 0;
+    for (const auto& shard : shards_) {
+      AutoLock lock(shard->lock);
+      cost += shard->cost;
+    }
+    return cost;
+  }
+
+  // Halves the cache on moderate memory pressure, and empties it on critical
+  // memory pressure. The notifications are received on the current sequence,
+  // which must also be the one that destroys the cache.
+  void EnableMemoryPressureShrinking() {
+    DCHECK(!memory_pressure_listener_);
+    memory_pressure_listener_ = std::make_unique<MemoryPressureListener>(
+        BindRepeating(&ShardedMRUCache::OnMemoryPressure, Unretained(this)));
+  }
+
+  // Records the hit rate of the Get() calls since the previous call to
+  // |histogram_name|.HitRate, and their number to |histogram_name|.Lookups,
+  // then resets the counts. Call this periodically, e.g. from a timer, or
+  // when the cache is destroyed.
+  void RecordHistograms(const std::string& histogram_name) {
+    size_t hits = 0;
+    size_t misses = 0;
+    for (const auto& shard : shards_) {
+      AutoLock lock(shard->lock);
+      hits += shard->hits;
+      misses += shard->misses;
+      shard->hits = 0;
+      shard->misses = 0;
+    }
+    const size_t lookups = hits + misses;
+    if (lookups == 0)
+      return;
+    UmaHistogramPercentage(histogram_name + ".HitRate",
+                           static_cast<int>(hits * 100 / lookups));
+    UmaHistogramCounts1M(histogram_name + ".Lookups",
+                         saturated_cast<int>(lookups));
+  }
+
+ private:
+  struct Entry {
+    PayloadType payload;
+    size_t cost;
+  };
+
+  struct Shard {
+    explicit Shard(size_t max_cost)
+        : cache(HashingMRUCache<KeyType, Entry, HashType>::NO_AUTO_EVICT),
+          max_cost(max_cost) {}
+
+    mutable Lock lock;
+
+    // All the members below are guarded by |lock|.
+    HashingMRUCache<KeyType, Entry, HashType> cache;
+    size_t cost = 0;
+    const size_t max_cost;
+    size_t hits = 0;
+    size_t misses = 0;
+
+    DISALLOW_COPY_AND_ASSIGN(Shard);
+  };
+
+  Shard& GetShard(const KeyType& key) const {
+    // Mixes the hash, since e.g. std::hash<int> is the identity.
+    const uint64_t hash =
+        static_cast<uint64_t>(HashType()(key)) * UINT64_C(0x9E3779B97F4A7C15);
+    return *shards_[(hash >> 32) % shards_.size()];
+  }
+
+  // Evicts the least recently used items of |shard| until it costs at most
+  // |max_cost|. |shard->lock| must be held.
+  static void ShrinkShard(Shard* shard, size_t max_cost) {
+    shard->lock.AssertAcquired();
+    while (shard->cost > max_cost) {
+      auto it = shard->cache.rbegin();
+      shard->cost -= it->second.cost;
+      shard->cache.Erase(it);
+    }
+  }
+
+  void OnMemoryPressure(
+      MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
+    switch (memory_pressure_level) {
+      case MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE:
+        break;
+      case MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE:
+        ShrinkToCost(total_cost() / 2);
+        break;
+      case MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL:
+        Clear();
+        break;
+    }
+  }
+
+  const size_t max_cost_;
+  const CostType cost_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  // Declared last so that it is destroyed first, and can't notify a partially
+  // destroyed cache.
+  std::unique_ptr<MemoryPressureListener> memory_pressure_listener_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedMRUCache);
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_SHARDED_MRU_CACHE_H_
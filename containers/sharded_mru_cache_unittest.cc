@@ -0,0 +1,217 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/sharded_mru_cache.h"
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/run_loop.h"
+#include "base/test/histogram_tester.h"
+#include "base/test/scoped_task_environment.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+using IntCache = ShardedMRUCache<int, int>;
+
+// Makes each string cost its length.
+struct StringLength {
+  size_t operator()(int, const std::string& payload) const {
+    return payload.size();
+  }
+};
+
+using StringCache =
+    ShardedMRUCache<int, std::string, std::hash<int>, StringLength>;
+
+// Puts and gets keys in its own range, so that it can check the payloads.
+class CacheUser : public DelegateSimpleThread::Delegate {
+ public:
+  CacheUser(IntCache* cache, int first_key)
+      : cache_(cache), first_key_(first_key) {}
+
+  void Run() override {
+    for (int i = 0; i < 10000; ++i) {
+      const int key = first_key_ + i % 500;
+      int payload;
+      if (cache_->Get(key, &payload))
+        EXPECT_EQ(key * 2, payload);
+      else
+        cache_->Put(key, key * 2);
+      if (i % 7 == 0)
+        cache_->Erase(key + 1);
+    }
+  }
+
+ private:
+  IntCache* const cache_;
+  const int first_key_;
+
+  DISALLOW_COPY_AND_ASSIGN(CacheUser);
+};
+
+}  // namespace
+
+TEST(ShardedMRUCacheTest, Basic) {
+  IntCache cache(100);
+  EXPECT_EQ(100u, cache.max_cost());
+
+  int payload = 0;
+  EXPECT_FALSE(cache.Get(1, &payload));
+  EXPECT_TRUE(cache.Put(1, 10));
+  EXPECT_TRUE(cache.Put(2, 20));
+  EXPECT_TRUE(cache.Get(1, &payload));
+  EXPECT_EQ(10, payload);
+  EXPECT_TRUE(cache.Peek(2, &payload));
+  EXPECT_EQ(20, payload);
+  EXPECT_EQ(2u, cache.size());
+
+  // Replaces the existing item.
+  EXPECT_TRUE(cache.Put(1, 11));
+  EXPECT_TRUE(cache.Get(1, &payload));
+  EXPECT_EQ(11, payload);
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(2u, cache.total_cost());
+
+  EXPECT_TRUE(cache.Erase(1));
+  EXPECT_FALSE(cache.Erase(1));
+  EXPECT_FALSE(cache.Get(1, &payload));
+  EXPECT_EQ(1u, cache.size());
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_EQ(0u, cache.total_cost());
+}
+
+TEST(ShardedMRUCacheTest, EvictsLeastRecentlyUsed) {
+  // With a single shard, the eviction order is exactly LRU.
+  IntCache cache(3, 1);
+  cache.Put(1, 1);
+  cache.Put(2, 2);
+  cache.Put(3, 3);
+
+  // Get() makes 1 the most recently used, and Peek() leaves 2 the least.
+  int payload;
+  EXPECT_TRUE(cache.Get(1, &payload));
+  EXPECT_TRUE(cache.Peek(2, &payload));
+  cache.Put(4, 4);
+  EXPECT_EQ(3u, cache.size());
+  EXPECT_FALSE(cache.Peek(2, &payload));
+  EXPECT_TRUE(cache.Peek(1, &payload));
+  EXPECT_TRUE(cache.Peek(3, &payload));
+  EXPECT_TRUE(cache.Peek(4, &payload));
+}
+
+TEST(ShardedMRUCacheTest, Cost) {
+  StringCache cache(10, 1);
+  EXPECT_TRUE(cache.Put(1, "aaaa"));
+  EXPECT_TRUE(cache.Put(2, "bbbb"));
+  EXPECT_EQ(8u, cache.total_cost());
+
+  // Needs to evict 1 to make room.
+  EXPECT_TRUE(cache.Put(3, "ccc"));
+  EXPECT_EQ(7u, cache.total_cost());
+  std::string payload;
+  EXPECT_FALSE(cache.Peek(1, &payload));
+  EXPECT_TRUE(cache.Peek(2, &payload));
+  EXPECT_TRUE(cache.Peek(3, &payload));
+  EXPECT_EQ("ccc", payload);
+
+  // Replacing an item accounts for its new cost.
+  EXPECT_TRUE(cache.Put(3, "c"));
+  EXPECT_EQ(5u, cache.total_cost());
+
+  // An item bigger than the budget isn't stored, and still replaces the old
+  // item with its key.
+  EXPECT_FALSE(cache.Put(3, "xxxxxxxxxxx"));
+  EXPECT_FALSE(cache.Peek(3, &payload));
+  EXPECT_EQ(4u, cache.total_cost());
+}
+
+TEST(ShardedMRUCacheTest, ShrinkToCost) {
+  IntCache cache(100, 4);
+  for (int i = 0; i < 100; ++i)
+    cache.Put(i, i);
+  EXPECT_LE(cache.size(), 100u);
+  cache.ShrinkToCost(40);
+  EXPECT_LE(cache.total_cost(), 40u);
+  // The budget for new items is unchanged.
+  EXPECT_EQ(100u, cache.max_cost());
+}
+
+TEST(ShardedMRUCacheTest, MemoryPressure) {
+  test::ScopedTaskEnvironment scoped_task_environment;
+  IntCache cache(100, 1);
+  cache.EnableMemoryPressureShrinking();
+  for (int i = 0; i < 100; ++i)
+    cache.Put(i, i);
+
+  MemoryPressureListener::NotifyMemoryPressure(
+      MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE);
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(50u, cache.size());
+  int payload;
+  EXPECT_TRUE(cache.Peek(99, &payload));
+  EXPECT_FALSE(cache.Peek(0, &payload));
+
+  MemoryPressureListener::NotifyMemoryPressure(
+      MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL);
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(0u, cache.size());
+}
+
+TEST(ShardedMRUCacheTest, RecordHistograms) {
+  HistogramTester histogram_tester;
+  IntCache cache(100);
+  cache.RecordHistograms("Test.Cache");
+  histogram_tester.ExpectTotalCount("Test.Cache.HitRate", 0);
+
+  cache.Put(1, 1);
+  int payload;
+  cache.Get(1, &payload);
+  cache.Get(1, &payload);
+  cache.Get(1, &payload);
+  cache.Get(2, &payload);
+  // Peek() isn't counted.
+  cache.Peek(2, &payload);
+  cache.RecordHistograms("Test.Cache");
+  histogram_tester.ExpectUniqueSample("Test.Cache.HitRate", 75, 1);
+  histogram_tester.ExpectUniqueSample("Test.Cache.Lookups", 4, 1);
+
+  // The counts are reset.
+  cache.Get(2, &payload);
+  cache.RecordHistograms("Test.Cache");
+  histogram_tester.ExpectBucketCount("Test.Cache.HitRate", 0, 1);
+  histogram_tester.ExpectBucketCount("Test.Cache.Lookups", 1, 1);
+}
+
+TEST(ShardedMRUCacheTest, Threads) {
+  constexpr int kThreads = 8;
+  IntCache cache(1000);
+  std::vector<std::unique_ptr<CacheUser>> users;
+  std::vector<std::unique_ptr<DelegateSimpleThread>> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    users.push_back(std::make_unique<CacheUser>(&cache, i * 1000));
+    threads.push_back(
+        std::make_unique<DelegateSimpleThread>(users.back().get(), "Cache"));
+  }
+  for (const auto& thread : threads)
+    thread->Start();
+  for (const auto& thread : threads)
+    thread->Join();
+
+  EXPECT_LE(cache.total_cost(), cache.max_cost() + kThreads);
+  EXPECT_EQ(cache.size(), cache.total_cost());
+}
+
+}  // namespace base
@@ -0,0 +1,248 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_SLOT_MAP_H_
+#define BASE_CONTAINERS_SLOT_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/optional.h"
+
+namespace base {
+
+// SlotMap stores objects in a vector of slots, and identifies them by handles
+// holding the index of their slot and a generation, which changes whenever the
+// slot is emptied. Adding, removing and looking up an object take constant
+// time, and a lookup is a single indexed load: it's meant for registries
+// mapping generated ids to objects, where lookups are frequent. Handles of
+// removed objects remain invalid even when their slot is reused.
+//
+// As in IDMap, it is safe to remove objects while iterating: they are only
+// destroyed, and their slots reused, once the outermost iteration ends.
+//
+// Pointers returned by Lookup() are invalidated by Add(), since the slots may
+// move; handles are never invalidated.
+//
+// Example:
+//
+//   SlotMap<Foo> foos;
+//   SlotMap<Foo>::Handle handle = foos.Add(Foo());
+//   foos.Lookup(handle)->Bar();
+//   foos.Remove(handle);
+//   DCHECK(!foos.Lookup(handle));
+template <typename T>
+class SlotMap {
+ public:
+  class Handle {
+   public:
+    // A null handle, which never identifies an object.
+    constexpr Handle() = default;
+
+    bool is_null() const { return generation_ == 0; }
+
+    // Converts to and from an integer, which is never 0 unless the handle is
+    // null.
+    uint64_t ToUint64() const {
+      return static_cast<uint64_t>(generation_) << 32 | index_;
+    }
+    static Handle FromUint64(uint64_t value) {
+      return Handle(static_cast<uint32_t>(value),
+                    static_cast<uint32_t>(value >> 32));
+    }
+
+    bool operator==(const Handle& other) const {
+      return index_ == other.index_ && generation_ == other.generation_;
+    }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+
+   private:
+    friend class SlotMap;
+
+    Handle(uint32_t index, uint32_t generation)
+        : index_(index), generation_(generation) {}
+
+    uint32_t index_ = 0;
+    uint32_t generation_ = 0;
+  };
+
+  SlotMap() = default;
+
+  ~SlotMap() { DCHECK_EQ(0, iteration_depth_); }
+
+  // Adds |value| and returns its handle.
+  Handle Add(T value) {
+    uint32_t index;
+    if (!free_indices_.empty()) {
+      index = free_indices_.back();
+      free_indices_.pop_back();
+    } else {
+      CHECK_LT(slots_.size(), size_t{UINT32_MAX});
+      index = static_cast<uint32_t>(slots_.size());
+      slots_.emplace_back();
+    }
+    Slot& slot = slots_[index];
+    DCHECK(!slot.value);
+    slot.value.emplace(std::move(value));
+    ++size_;
+    return Handle(index, slot.generation);
+  }
+
+  // Removes the object identified by |handle|. Returns false if there is none.
+  bool Remove(Handle handle) {
+    Slot* slot = GetSlot(handle);
+    if (!slot)
+      return false;
+    // Invalidates |handle|.
+    if (++slot->generation == 0)
+      slot->generation = 1;
+    --size_;
+    if (iteration_depth_ == 0) {
+      slot->value.reset();
+      free_indices_.push_back(handle.index_);
+    } else {
+      slot->removed = true;
+      removed_indices_.push_back(handle.index_);
+    }
+    return true;
+  }
+
+  // Returns the object identified by |handle|, or null if there is none.
+  T* Lookup(Handle handle) {
+    Slot* slot = GetSlot(handle);
+    return slot ? &*slot->value : nullptr;
+  }
+  const T* Lookup(Handle handle) const {
+    return const_cast<SlotMap*>(this)->Lookup(handle);
+  }
+
+  // Removes all the objects.
+  void Clear() {
+    for (uint32_t index = 0; index < slots_.size(); ++index) {
+      const Slot& slot = slots_[index];
+      if (slot.value && !slot.removed)
+        Remove(Handle(index, slot.generation));
+    }
+  }
+
+  bool IsEmpty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+#if defined(UNIT_TEST)
+  int iteration_depth() const { return iteration_depth_; }
+#endif  // defined(UNIT_TEST)
+
+  // Iterates over the objects in the order of their slots. It is safe to add
+  // and remove objects during the iteration: objects removed before they are
+  // reached are skipped, objects added may or may not be visited.
+  template <typename ReturnType>
+  class Iterator {
+   public:
+    explicit Iterator(SlotMap* map) : map_(map), index_(0) { Init(); }
+
+    Iterator(const Iterator& other) : map_(other.map_), index_(other.index_) {
+      Init();
+    }
+
+    ~Iterator() {
+      DCHECK_LT(0, map_->iteration_depth_);
+      if (--map_->iteration_depth_ == 0)
+        map_->Compact();
+    }
+
+    bool IsAtEnd() const { return index_ >= map_->slots_.size(); }
+
+    Handle GetCurrentHandle() const {
+      DCHECK(!IsAtEnd());
+      return Handle(index_, map_->slots_[index_].generation);
+    }
+
+    // Returns null if the current object was removed after it was reached.
+    ReturnType* GetCurrentValue() const {
+      DCHECK(!IsAtEnd());
+      Slot& slot = map_->slots_[index_];
+      return slot.removed ? nullptr : &*slot.value;
+    }
+
+    void Advance() {
+      DCHECK(!IsAtEnd());
+      ++index_;
+      SkipEmptySlots();
+    }
+
+   private:
+    void Init() {
+      ++map_->iteration_depth_;
+      SkipEmptySlots();
+    }
+
+    void SkipEmptySlots() {
+      while (!IsAtEnd() && (!map_->slots_[index_].value ||
+                            map_->slots_[index_].removed)) {
+        ++index_;
+      }
+    }
+
+    SlotMap* const map_;
+    uint32_t index_;
+
+    DISALLOW_ASSIGN(Iterator);
+  };
+
+  using iterator = Iterator<T>;
+  using const_iterator = Iterator<const T>;
+
+ private:
+  struct Slot {
+    Optional<T> value;
+    // The generation of the current object, or of the next one if empty.
+    uint32_t generation = 1;
+    // Whether |value| was removed during an iteration, and is only kept until
+    // it ends.
+    bool removed = false;
+  };
+
+  Slot* GetSlot(Handle handle) {
+    if (handle.index_ >= slots_.size())
+      return nullptr;
+    Slot& slot = slots_[handle.index_];
+    // The generation only matches while the slot holds the object |handle|
+    // was returned for, since it changes when the object is removed, unless
+    // |handle| was forged from an integer.
+    if (slot.generation != handle.generation_ || !slot.value || slot.removed)
+      return nullptr;
+    return &slot;
+  }
+
+  // Destroys the objects removed during the iteration which just ended.
+  void Compact() {
+    DCHECK_EQ(0, iteration_depth_);
+    for (uint32_t index : removed_indices_) {
+      Slot& slot = slots_[index];
+      slot.value.reset();
+      slot.removed = false;
+      free_indices_.push_back(index);
+    }
+    removed_indices_.clear();
+  }
+
+  std::vector<Slot> slots_;
+  // Empty slots, reused last in, first out.
+  std::vector<uint32_t> free_indices_;
+  // Slots whose objects were removed during the current iteration.
+  std::vector<uint32_t> removed_indices_;
+  size_t size_ = 0;
+  int iteration_depth_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(SlotMap);
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_SLOT_MAP_H_
@@ -0,0 +1,129 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/slot_map.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+using Handle = SlotMap<std::string>::Handle;
+
+}  // namespace
+
+TEST(SlotMapTest, AddLookupRemove) {
+  SlotMap<std::string> map;
+  EXPECT_TRUE(map.IsEmpty());
+
+  const Handle a = map.Add("a");
+  const Handle b = map.Add("b");
+  EXPECT_FALSE(a.is_null());
+  EXPECT_NE(a, b);
+  EXPECT_EQ(2u, map.size());
+  EXPECT_EQ("a", *map.Lookup(a));
+  EXPECT_EQ("b", *map.Lookup(b));
+  EXPECT_FALSE(map.Lookup(Handle()));
+
+  EXPECT_TRUE(map.Remove(a));
+  EXPECT_FALSE(map.Remove(a));
+  EXPECT_FALSE(map.Lookup(a));
+  EXPECT_EQ("b", *map.Lookup(b));
+  EXPECT_EQ(1u, map.size());
+
+  map.Clear();
+  EXPECT_TRUE(map.IsEmpty());
+  EXPECT_FALSE(map.Lookup(b));
+}
+
+TEST(SlotMapTest, ReusedSlotsInvalidateOldHandles) {
+  SlotMap<std::string> map;
+  Handle handle = map.Add("first");
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(map.Remove(handle));
+    const Handle new_handle = map.Add("next");
+    // The slot is reused, but the old handle doesn't find the new object.
+    EXPECT_NE(handle, new_handle);
+    EXPECT_FALSE(map.Lookup(handle));
+    handle = new_handle;
+  }
+  EXPECT_EQ(1u, map.size());
+  EXPECT_EQ("next", *map.Lookup(handle));
+}
+
+TEST(SlotMapTest, HandleToUint64) {
+  SlotMap<std::string> map;
+  map.Add("a");
+  const Handle b = map.Add("b");
+  EXPECT_EQ(0u, Handle().ToUint64());
+  EXPECT_NE(0u, b.ToUint64());
+  EXPECT_EQ(b, Handle::FromUint64(b.ToUint64()));
+  EXPECT_EQ("b", *map.Lookup(Handle::FromUint64(b.ToUint64())));
+
+  // Integers which were never handles don't find anything.
+  for (uint64_t value : {uint64_t{1}, uint64_t{5} << 32, ~uint64_t{0}})
+    EXPECT_FALSE(map.Lookup(Handle::FromUint64(value)));
+}
+
+TEST(SlotMapTest, RemoveDuringIteration) {
+  SlotMap<std::unique_ptr<int>> map;
+  std::vector<SlotMap<std::unique_ptr<int>>::Handle> handles;
+  for (int i = 0; i < 4; ++i)
+    handles.push_back(map.Add(std::make_unique<int>(i)));
+
+  std::vector<int> visited;
+  {
+    SlotMap<std::unique_ptr<int>>::iterator iter(&map);
+    EXPECT_EQ(1, map.iteration_depth());
+    for (; !iter.IsAtEnd(); iter.Advance()) {
+      std::unique_ptr<int>* value = iter.GetCurrentValue();
+      ASSERT_TRUE(value);
+      visited.push_back(**value);
+      if (**value == 0) {
+        // Removing the current object and a later one.
+        EXPECT_TRUE(map.Remove(handles[0]));
+        EXPECT_TRUE(map.Remove(handles[2]));
+        EXPECT_FALSE(iter.GetCurrentValue());
+        // The slots aren't reused until the iteration ends.
+        handles.push_back(map.Add(std::make_unique<int>(4)));
+      }
+    }
+    EXPECT_EQ(3u, map.size());
+  }
+  EXPECT_EQ(0, map.iteration_depth());
+  EXPECT_EQ(std::vector<int>({0, 1, 3, 4}), visited);
+
+  EXPECT_FALSE(map.Lookup(handles[0]));
+  EXPECT_FALSE(map.Lookup(handles[2]));
+  EXPECT_EQ(4, **map.Lookup(handles[4]));
+}
+
+TEST(SlotMapTest, NestedIteration) {
+  SlotMap<std::string> map;
+  const Handle a = map.Add("a");
+  map.Add("b");
+
+  {
+    SlotMap<std::string>::const_iterator outer(&map);
+    {
+      SlotMap<std::string>::const_iterator inner(outer);
+      EXPECT_EQ(2, map.iteration_depth());
+      map.Clear();
+      EXPECT_TRUE(map.IsEmpty());
+    }
+    // The inner iteration ending doesn't destroy the objects.
+    EXPECT_EQ(1, map.iteration_depth());
+    ASSERT_FALSE(outer.IsAtEnd());
+    EXPECT_FALSE(outer.GetCurrentValue());
+  }
+  EXPECT_EQ(0, map.iteration_depth());
+  EXPECT_FALSE(map.Lookup(a));
+}
+
+}  // namespace base
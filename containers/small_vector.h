@@ -0,0 +1,340 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_SMALL_VECTOR_H_
+#define BASE_CONTAINERS_SMALL_VECTOR_H_
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "base/containers/vector_buffer.h"
+#include "base/logging.h"
+
+namespace base {
+
+// base::small_vector<T, N> is a vector which stores up to N elements inline,
+// in the object itself, and only allocates when it grows larger. Use it for
+// vectors which are nearly always small, in hot code, or for arrays of them:
+//
+//   base::small_vector<Frame, 8> frames;
+//
+// Unlike StackVector, it is a real container, with value semantics: copies
+// copy the elements, and moving a vector which fits inline moves the elements
+// without allocating. Moving a larger one takes its heap buffer. It converts
+// to base::span like std::vector.
+//
+// The API is that of std::vector, except:
+//
+//  - Moving or swapping vectors which fit inline moves their elements, so the
+//    iterators and references to them are invalidated, like for
+//    std::array.
+//
+//  - The insert() and erase() of a range, assign(), and the comparisons
+//    other than == and != are missing.
+//
+//  - shrink_to_fit() is missing: once on the heap, a vector stays there until
+//    it is moved from.
+//
+// Pick N so that the inline storage covers the usual sizes: the elements in
+// excess of it are all moved to the heap, so a small_vector which usually has
+// N + 1 elements is slower than a std::vector.
+template <typename T, size_t N>
+class small_vector {
+ public:
+  static_assert(N > 0, "small_vector needs inline storage, use std::vector");
+
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+  using iterator = value_type*;
+  using const_iterator = const value_type*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  small_vector() = default;
+
+  explicit small_vector(size_t count) { resize(count); }
+
+  small_vector(size_t count, const T& value) { resize(count, value); }
+
+  template <class InputIterator,
+            typename = typename std::enable_if<std::is_base_of<
+                std::input_iterator_tag,
+                typename std::iterator_traits<
+                    InputIterator>::iterator_category>::value>::type>
+  small_vector(InputIterator first, InputIterator last) {
+    for (; first != last; ++first)
+      emplace_back(*first);
+  }
+
+  small_vector(std::initializer_list<T> values)
+      : small_vector(values.begin(), values.end()) {}
+
+  small_vector(const small_vector& other) {
+    reserve(other.size_);
+    for (const T& value : other)
+      new (data_ + size_++) T(value);
+  }
+
+  small_vector(small_vector&& other) noexcept { MoveFrom(&other); }
+
+  ~small_vector() {
+    clear();
+    FreeHeapBuffer();
+  }
+
+  small_vector& operator=(const small_vector& other) {
+    if (&other != this) {
+      clear();
+      reserve(other.size_);
+      for (const T& value : other)
+        new (data_ + size_++) T(value);
+    }
+    return *this;
+  }
+
+  small_vector& operator=(small_vector&& other) noexcept {
+    if (&other != this) {
+      clear();
+      FreeHeapBuffer();
+      MoveFrom(&other);
+    }
+    return *this;
+  }
+
+  small_vector& operator=(std::initializer_list<T> values) {
+    clear();
+    reserve(values.size());
+    for (const T& value : values)
+      new (data_ + size_++) T(value);
+    return *this;
+  }
+
+  // Accessors.
+
+  T& operator[](size_t i) {
+    DCHECK_LT(i, size_);
+    return data_[i];
+  }
+  const T& operator[](size_t i) const {
+    DCHECK_LT(i, size_);
+    return data_[i];
+  }
+
+  T& front() { return (*this)[0]; }
+  const T& front() const { return (*this)[0]; }
+  T& back() { return (*this)[size_ - 1]; }
+  const T& back() const { return (*this)[size_ - 1]; }
+
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+
+  // Iterators.
+
+  iterator begin() { return data_; }
+  const_iterator begin() const { return data_; }
+  const_iterator cbegin() const { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator end() const { return data_ + size_; }
+  const_iterator cend() const { return data_ + size_; }
+
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  // Size and capacity.
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+
+  // Returns true if the elements are stored in the object.
+  bool is_inline() const { return data_ == inline_data(); }
+
+  void reserve(size_t new_capacity) {
+    if (new_capacity > capacity_)
+      Reallocate(new_capacity);
+  }
+
+  void clear() {
+    DestructRange(data_, data_ + size_);
+    size_ = 0;
+  }
+
+  void resize(size_t count) {
+    if (count < size_) {
+      DestructRange(data_ + count, data_ + size_);
+      size_ = count;
+      return;
+    }
+    reserve(count);
+    while (size_ < count)
+      new (data_ + size_++) T();
+  }
+
+  void resize(size_t count, const T& value) {
+    if (count < size_) {
+      DestructRange(data_ + count, data_ + size_);
+      size_ = count;
+      return;
+    }
+    if (count > capacity_) {
+      // |value| may be an element.
+      const T copy(value);
+      reserve(count);
+      while (size_ < count)
+        new (data_ + size_++) T(copy);
+      return;
+    }
+    while (size_ < count)
+      new (data_ + size_++) T(value);
+  }
+
+  // Insertion and removal.
+
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  template <class... Args>
+  T& emplace_back(Args&&... args) {
+    if (size_ < capacity_)
+      return *new (data_ + size_++) T(std::forward<Args>(args)...);
+
+    // The arguments may refer to an element, so construct the new element
+    // before moving the others.
+    T* new_data = AllocateHeapBuffer(GrowCapacity());
+    T* value = new (new_data + size_) T(std::forward<Args>(args)...);
+    ReplaceBuffer(new_data, GrowCapacity());
+    ++size_;
+    return *value;
+  }
+
+  void pop_back() {
+    DCHECK(!empty());
+    data_[--size_].~T();
+  }
+
+  iterator insert(const_iterator pos, const T& value) {
+    return emplace(pos, value);
+  }
+  iterator insert(const_iterator pos, T&& value) {
+    return emplace(pos, std::move(value));
+  }
+
+  template <class... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    DCHECK(pos >= begin() && pos <= end());
+    const size_t index = pos - begin();
+    emplace_back(std::forward<Args>(args)...);
+    std::rotate(begin() + index, end() - 1, end());
+    return begin() + index;
+  }
+
+  iterator erase(const_iterator pos) {
+    DCHECK(pos >= begin() && pos < end());
+    iterator it = begin() + (pos - begin());
+    std::move(it + 1, end(), it);
+    pop_back();
+    return it;
+  }
+
+  void swap(small_vector& other) {
+    small_vector tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  friend void swap(small_vector& lhs, small_vector& rhs) { lhs.swap(rhs); }
+
+  friend bool operator==(const small_vector& lhs, const small_vector& rhs) {
+    return lhs.size() == rhs.size() &&
+           std::equal(lhs.begin(), lhs.end(), rhs.begin());
+  }
+  friend bool operator!=(const small_vector& lhs, const small_vector& rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  T* inline_data() { return reinterpret_cast<T*>(&inline_storage_); }
+  const T* inline_data() const {
+    return reinterpret_cast<const T*>(&inline_storage_);
+  }
+
+  size_t GrowCapacity() const { return std::max(capacity_ * 2, size_ + 1); }
+
+  static T* AllocateHeapBuffer(size_t capacity) {
+    return reinterpret_cast<T*>(malloc(sizeof(T) * capacity));
+  }
+
+  void FreeHeapBuffer() {
+    if (!is_inline())
+      free(data_);
+    data_ = inline_data();
+    capacity_ = N;
+  }
+
+  // Moves the elements to |new_data|, a heap buffer, and frees the previous
+  // buffer.
+  void ReplaceBuffer(T* new_data, size_t new_capacity) {
+    internal::VectorBuffer<T>::MoveRange(data_, data_ + size_, new_data);
+    if (!is_inline())
+      free(data_);
+    data_ = new_data;
+    capacity_ = new_capacity;
+  }
+
+  void Reallocate(size_t new_capacity) {
+    ReplaceBuffer(AllocateHeapBuffer(new_capacity), new_capacity);
+  }
+
+  // Takes the elements of |other|, which is left empty and inline. |this| must
+  // be empty and inline.
+  void MoveFrom(small_vector* other) {
+    DCHECK(empty() && is_inline());
+    if (other->is_inline()) {
+      internal::VectorBuffer<T>::MoveRange(
+          other->data_, other->data_ + other->size_, data_);
+    } else {
+      data_ = other->data_;
+      capacity_ = other->capacity_;
+      other->data_ = other->inline_data();
+      other->capacity_ = N;
+    }
+    size_ = other->size_;
+    other->size_ = 0;
+  }
+
+  static void DestructRange(T* begin, T* end) {
+    if (std::is_trivially_destructible<T>::value)
+      return;
+    for (; begin != end; ++begin)
+      begin->~T();
+  }
+
+  T* data_ = inline_data();
+  size_t size_ = 0;
+  size_t capacity_ = N;
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type
+      inline_storage_[N];
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_SMALL_VECTOR_H_
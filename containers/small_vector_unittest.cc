@@ -0,0 +1,196 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/small_vector.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/containers/span.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Counts its live instances.
+class Counted {
+ public:
+  explicit Counted(int value = 0) : value_(value) { ++num_instances_; }
+  Counted(const Counted& other) : value_(other.value_) { ++num_instances_; }
+  Counted& operator=(const Counted& other) = default;
+  ~Counted() { --num_instances_; }
+
+  int value() const { return value_; }
+  static int num_instances() { return num_instances_; }
+
+ private:
+  int value_;
+  static int num_instances_;
+};
+
+int Counted::num_instances_ = 0;
+
+int Sum(span<const int> values) {
+  int sum = 0;
+  for (int value : values)
+    sum += value;
+  return sum;
+}
+
+}  // namespace
+
+TEST(SmallVector, Inline) {
+  small_vector<int, 4> vector;
+  EXPECT_TRUE(vector.empty());
+  EXPECT_EQ(4u, vector.capacity());
+  for (int i = 0; i < 4; ++i)
+    vector.push_back(i);
+  EXPECT_TRUE(vector.is_inline());
+  EXPECT_EQ(4u, vector.size());
+  EXPECT_EQ(0, vector.front());
+  EXPECT_EQ(3, vector.back());
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3}),
+            std::vector<int>(vector.begin(), vector.end()));
+}
+
+TEST(SmallVector, GrowsToTheHeap) {
+  small_vector<int, 2> vector = {1, 2};
+  int* inline_data = vector.data();
+  vector.push_back(3);
+  EXPECT_FALSE(vector.is_inline());
+  EXPECT_NE(inline_data, vector.data());
+  EXPECT_LE(3u, vector.capacity());
+  for (int i = 4; i <= 100; ++i)
+    vector.push_back(i);
+  ASSERT_EQ(100u, vector.size());
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(i + 1, vector[i]);
+
+  vector.clear();
+  EXPECT_TRUE(vector.empty());
+  EXPECT_FALSE(vector.is_inline());
+}
+
+TEST(SmallVector, PushBackAnElement) {
+  // The argument refers to the buffer which is reallocated.
+  small_vector<std::string, 2> vector = {"a", "b"};
+  vector.push_back(vector[0]);
+  vector.emplace_back(vector.back());
+  EXPECT_EQ(std::vector<std::string>({"a", "b", "a", "a"}),
+            std::vector<std::string>(vector.begin(), vector.end()));
+  vector.resize(8, vector[1]);
+  EXPECT_EQ("b", vector.back());
+}
+
+TEST(SmallVector, InsertAndErase) {
+  small_vector<int, 3> vector = {1, 3};
+  EXPECT_EQ(2, *vector.insert(vector.begin() + 1, 2));
+  EXPECT_EQ(0, *vector.insert(vector.begin(), 0));
+  EXPECT_EQ(4, *vector.emplace(vector.end(), 4));
+  EXPECT_EQ((small_vector<int, 3>({0, 1, 2, 3, 4})), vector);
+
+  EXPECT_EQ(2, *vector.erase(vector.begin() + 1));
+  EXPECT_EQ(vector.end(), vector.erase(vector.end() - 1));
+  EXPECT_EQ((small_vector<int, 3>({0, 2, 3})), vector);
+  vector.pop_back();
+  EXPECT_EQ((small_vector<int, 3>({0, 2})), vector);
+}
+
+TEST(SmallVector, Resize) {
+  small_vector<int, 4> vector(3);
+  EXPECT_EQ((small_vector<int, 4>({0, 0, 0})), vector);
+  vector.resize(6, 7);
+  EXPECT_EQ((small_vector<int, 4>({0, 0, 0, 7, 7, 7})), vector);
+  vector.resize(1);
+  EXPECT_EQ((small_vector<int, 4>({0})), vector);
+  vector.reserve(50);
+  EXPECT_EQ(50u, vector.capacity());
+  EXPECT_EQ((small_vector<int, 4>({0})), vector);
+}
+
+TEST(SmallVector, Copy) {
+  small_vector<int, 2> small = {1};
+  small_vector<int, 2> large = {1, 2, 3};
+  small_vector<int, 2> copy(small);
+  EXPECT_EQ(small, copy);
+  EXPECT_TRUE(copy.is_inline());
+  copy = large;
+  EXPECT_EQ(large, copy);
+  copy = small;
+  EXPECT_EQ(small, copy);
+  copy = {4, 5};
+  EXPECT_EQ((small_vector<int, 2>({4, 5})), copy);
+  EXPECT_NE(small, copy);
+}
+
+TEST(SmallVector, MoveInline) {
+  small_vector<std::unique_ptr<int>, 2> vector;
+  vector.push_back(std::make_unique<int>(1));
+  small_vector<std::unique_ptr<int>, 2> moved(std::move(vector));
+  EXPECT_TRUE(moved.is_inline());
+  ASSERT_EQ(1u, moved.size());
+  EXPECT_EQ(1, *moved[0]);
+  EXPECT_TRUE(vector.empty());
+}
+
+TEST(SmallVector, MoveHeap) {
+  small_vector<std::unique_ptr<int>, 2> vector;
+  for (int i = 0; i < 3; ++i)
+    vector.push_back(std::make_unique<int>(i));
+  const std::unique_ptr<int>* data = vector.data();
+
+  small_vector<std::unique_ptr<int>, 2> moved;
+  moved.push_back(std::make_unique<int>(10));
+  moved = std::move(vector);
+  // The heap buffer was taken, and |vector| is inline again.
+  EXPECT_EQ(data, moved.data());
+  ASSERT_EQ(3u, moved.size());
+  EXPECT_EQ(2, *moved[2]);
+  EXPECT_TRUE(vector.empty());
+  EXPECT_TRUE(vector.is_inline());
+  EXPECT_EQ(2u, vector.capacity());
+}
+
+TEST(SmallVector, Swap) {
+  small_vector<int, 2> small = {1};
+  small_vector<int, 2> large = {1, 2, 3};
+  swap(small, large);
+  EXPECT_EQ((small_vector<int, 2>({1, 2, 3})), small);
+  EXPECT_EQ((small_vector<int, 2>({1})), large);
+  EXPECT_TRUE(large.is_inline());
+}
+
+TEST(SmallVector, DestroysElements) {
+  {
+    small_vector<Counted, 2> vector;
+    for (int i = 0; i < 5; ++i)
+      vector.emplace_back(i);
+    EXPECT_EQ(5, Counted::num_instances());
+    small_vector<Counted, 2> copy(vector);
+    EXPECT_EQ(10, Counted::num_instances());
+    copy.resize(1);
+    EXPECT_EQ(6, Counted::num_instances());
+    small_vector<Counted, 2> moved(std::move(copy));
+    EXPECT_EQ(6, Counted::num_instances());
+    vector.erase(vector.begin());
+    EXPECT_EQ(1, vector.front().value());
+    EXPECT_EQ(5, Counted::num_instances());
+  }
+  EXPECT_EQ(0, Counted::num_instances());
+}
+
+TEST(SmallVector, Span) {
+  small_vector<int, 4> vector = {1, 2, 3};
+  EXPECT_EQ(6, Sum(vector));
+  span<int> values(vector);
+  EXPECT_EQ(vector.data(), values.data());
+  EXPECT_EQ(3u, values.size());
+  vector.push_back(4);
+  vector.push_back(5);
+  EXPECT_EQ(15, Sum(vector));
+}
+
+}  // namespace base
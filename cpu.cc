@@ -13,10 +13,16 @@
 #include <utility>
 
 #include "base/macros.h"
+#include "base/no_destructor.h"
 #include "build/build_config.h"
 
 #if defined(ARCH_CPU_ARM_FAMILY) && (defined(OS_ANDROID) || defined(OS_LINUX))
+#include <sys/auxv.h>
+
 #include "base/files/file_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
 #endif
 
 #if defined(ARCH_CPU_X86_FAMILY)
@@ -47,11 +53,29 @@ CPU::CPU()
     has_avx_(false),
     has_avx2_(false),
     has_aesni_(false),
+    has_sha_(false),
+    has_bmi2_(false),
+    has_avx512f_(false),
+    has_avx512bw_(false),
+    has_avx512vl_(false),
     has_non_stop_time_stamp_counter_(false),
+    has_neon_(false),
+    has_arm_crc32_(false),
+    has_arm_aes_(false),
+    has_arm_sha_(false),
+    l1_data_cache_size_(0),
+    l2_cache_size_(0),
+    l3_cache_size_(0),
     cpu_vendor_("unknown") {
   Initialize();
 }
 
+// static
+const CPU& CPU::GetInstance() {
+  static const NoDestructor<CPU> cpu;
+  return *cpu;
+}
+
 namespace {
 
 #if defined(ARCH_CPU_X86_FAMILY)
@@ -59,27 +83,31 @@ namespace {
 
 #if defined(__pic__) && defined(__i386__)
 
-void __cpuid(int cpu_info[4], int info_type) {
+void __cpuidex(int cpu_info[4], int info_type, int info_index) {
   __asm__ volatile(
       "mov %%ebx, %%edi\n"
       "cpuid\n"
       "xchg %%edi, %%ebx\n"
       : "=a"(cpu_info[0]), "=D"(cpu_info[1]), "=c"(cpu_info[2]),
         "=d"(cpu_info[3])
-      : "a"(info_type), "c"(0));
+      : "a"(info_type), "c"(info_index));
 }
 
 #else
 
-void __cpuid(int cpu_info[4], int info_type) {
+void __cpuidex(int cpu_info[4], int info_type, int info_index) {
   __asm__ volatile("cpuid\n"
                    : "=a"(cpu_info[0]), "=b"(cpu_info[1]), "=c"(cpu_info[2]),
                      "=d"(cpu_info[3])
-                   : "a"(info_type), "c"(0));
+                   : "a"(info_type), "c"(info_index));
 }
 
 #endif
 
+void __cpuid(int cpu_info[4], int info_type) {
+  __cpuidex(cpu_info, info_type, 0);
+}
+
 // _xgetbv returns the value of an Intel Extended Control Register (XCR).
 // Currently only XCR0 is defined by Intel so |xcr| should always be zero.
 uint64_t _xgetbv(uint32_t xcr) {
@@ -91,6 +119,38 @@ uint64_t _xgetbv(uint32_t xcr) {
 }
 
 #endif  // !defined(COMPILER_MSVC)
+
+// Reads the cache sizes from the deterministic cache parameters of |leaf|: 4 on
+// Intel processors, 0x8000001D on AMD ones, which use the same format.
+void GetCacheSizes(int leaf,
+                   size_t* l1_data_cache_size,
+                   size_t* l2_cache_size,
+                   size_t* l3_cache_size) {
+  // Bounds the enumeration in case the processor never reports its end.
+  static constexpr int kMaxCaches = 16;
+  for (int index = 0; index < kMaxCaches; ++index) {
+    int cpu_info[4];
+    __cpuidex(cpu_info, leaf, index);
+    const int type = cpu_info[0] & 0x1f;
+    if (type == 0)  // No more caches.
+      break;
+    if (type == 2)  // Instruction cache.
+      continue;
+    const int level = (cpu_info[0] >> 5) & 0x7;
+    const size_t ways = ((cpu_info[1] >> 22) & 0x3ff) + 1;
+    const size_t partitions = ((cpu_info[1] >> 12) & 0x3ff) + 1;
+    const size_t line_size = (cpu_info[1] & 0xfff) + 1;
+    const size_t sets = static_cast<uint32_t>(cpu_info[2]) + size_t{1};
+    const size_t size = ways * partitions * line_size * sets;
+    if (level == 1)
+      *l1_data_cache_size = size;
+    else if (level == 2)
+      *l2_cache_size = size;
+    else if (level == 3)
+      *l3_cache_size = size;
+  }
+}
+
 #endif  // ARCH_CPU_X86_FAMILY
 
 #if defined(ARCH_CPU_ARM_FAMILY) && (defined(OS_ANDROID) || defined(OS_LINUX))
@@ -122,6 +182,41 @@ std::string* CpuInfoBrand() {
 
   return brand;
 }
+
+// Returns the size in bytes of the data or unified cache of |level| described
+// in sysfs for CPU 0, or 0 if there is none.
+size_t ReadSysfsCacheSize(int level) {
+  // Bounds the enumeration like GetCacheSizes() on x86.
+  static constexpr int kMaxCaches = 16;
+  for (int index = 0; index < kMaxCaches; ++index) {
+    const std::string dir =
+        StringPrintf("/sys/devices/system/cpu/cpu0/cache/index%d/", index);
+    std::string contents;
+    if (!ReadFileToString(FilePath(dir + "level"), &contents))
+      break;
+    int cache_level;
+    if (!StringToInt(TrimWhitespaceASCII(contents, TRIM_ALL), &cache_level) ||
+        cache_level != level) {
+      continue;
+    }
+    if (!ReadFileToString(FilePath(dir + "type"), &contents) ||
+        TrimWhitespaceASCII(contents, TRIM_ALL) == "Instruction") {
+      continue;
+    }
+    // The size is in kibibytes, e.g. "32K".
+    if (!ReadFileToString(FilePath(dir + "size"), &contents))
+      continue;
+    StringPiece size_string = TrimWhitespaceASCII(contents, TRIM_ALL);
+    size_t size;
+    if (size_string.empty() || size_string.back() != 'K' ||
+        !StringToSizeT(size_string.substr(0, size_string.size() - 1), &size)) {
+      continue;
+    }
+    return size * 1024;
+  }
+  return 0;
+}
+
 #endif  // defined(ARCH_CPU_ARM_FAMILY) && (defined(OS_ANDROID) ||
         // defined(OS_LINUX))
 
@@ -186,13 +281,29 @@ void CPU::Initialize() {
     // even after following Intel's example code. (See crbug.com/375968.)
     // Because of that, we also test the XSAVE bit because its description in
     // the CPUID documentation suggests that it signals xgetbv support.
-    has_avx_ =
-        (cpu_info[2] & 0x10000000) != 0 &&
+    const uint64_t xcr0 =
         (cpu_info[2] & 0x04000000) != 0 /* XSAVE */ &&
-        (cpu_info[2] & 0x08000000) != 0 /* OSXSAVE */ &&
-        (_xgetbv(0) & 6) == 6 /* XSAVE enabled by kernel */;
+                (cpu_info[2] & 0x08000000) != 0 /* OSXSAVE */
+            ? _xgetbv(0)
+            : 0;
+    has_avx_ = (cpu_info[2] & 0x10000000) != 0 &&
+               (xcr0 & 6) == 6 /* XSAVE enabled by kernel */;
     has_aesni_ = (cpu_info[2] & 0x02000000) != 0;
     has_avx2_ = has_avx_ && (cpu_info7[1] & 0x00000020) != 0;
+    has_sha_ = (cpu_info7[1] & 0x20000000) != 0;
+    has_bmi2_ = (cpu_info7[1] & 0x00000100) != 0;
+
+    // AVX-512 also needs the kernel to save the mask registers and both halves
+    // of the ZMM registers.
+    const bool avx512_enabled = has_avx_ && (xcr0 & 0xe0) == 0xe0;
+    has_avx512f_ = avx512_enabled && (cpu_info7[1] & 0x00010000) != 0;
+    has_avx512bw_ = has_avx512f_ && (cpu_info7[1] & 0x40000000) != 0;
+    has_avx512vl_ = has_avx512f_ && (cpu_info7[1] & 0x80000000) != 0;
+
+    if (num_ids >= 4) {
+      GetCacheSizes(4, &l1_data_cache_size_, &l2_cache_size_,
+                    &l3_cache_size_);
+    }
   }
 
   // Get the brand string of the cpu.
@@ -222,8 +333,70 @@ void CPU::Initialize() {
     __cpuid(cpu_info, kParameterContainingNonStopTimeStampCounter);
     has_non_stop_time_stamp_counter_ = (cpu_info[3] & (1 << 8)) != 0;
   }
-#elif defined(ARCH_CPU_ARM_FAMILY) && (defined(OS_ANDROID) || defined(OS_LINUX))
+
+  // AMD processors don't implement leaf 4, but leaf 0x8000001D when they
+  // support topology extensions, or else the older leaves 0x80000005 and
+  // 0x80000006.
+  if (l1_data_cache_size_ == 0) {
+    static constexpr int kParameterContainingTopologyExtensions = 0x80000001;
+    static constexpr int kParameterContainingCacheProperties = 0x8000001D;
+    static constexpr int kParameterContainingL1Cache = 0x80000005;
+    static constexpr int kParameterContainingL2L3Caches = 0x80000006;
+    if (max_parameter >= kParameterContainingCacheProperties) {
+      __cpuid(cpu_info, kParameterContainingTopologyExtensions);
+      if ((cpu_info[2] & (1 << 22)) != 0) {
+        GetCacheSizes(kParameterContainingCacheProperties,
+                      &l1_data_cache_size_, &l2_cache_size_, &l3_cache_size_);
+      }
+    }
+    if (l1_data_cache_size_ == 0 &&
+        max_parameter >= kParameterContainingL2L3Caches) {
+      __cpuid(cpu_info, kParameterContainingL1Cache);
+      l1_data_cache_size_ = size_t{static_cast<uint32_t>(cpu_info[2]) >> 24}
+                            << 10;
+      __cpuid(cpu_info, kParameterContainingL2L3Caches);
+      l2_cache_size_ = size_t{static_cast<uint32_t>(cpu_info[2]) >> 16} << 10;
+      l3_cache_size_ = size_t{static_cast<uint32_t>(cpu_info[3]) >> 18} << 19;
+    }
+  }
+#elif defined(ARCH_CPU_ARM_FAMILY)
+  // Features the compiler already targets need no check.
+#if defined(__ARM_NEON)
+  has_neon_ = true;
+#endif
+#if defined(__ARM_FEATURE_CRC32)
+  has_arm_crc32_ = true;
+#endif
+#if defined(__ARM_FEATURE_CRYPTO)
+  has_arm_aes_ = true;
+  has_arm_sha_ = true;
+#endif
+
+#if defined(OS_ANDROID) || defined(OS_LINUX)
   cpu_brand_ = *CpuInfoBrand();
+
+  // The bits of the hardware capabilities from the kernel's asm/hwcap.h.
+#if defined(ARCH_CPU_ARM64)
+  const unsigned long hwcap = getauxval(AT_HWCAP);
+  has_neon_ |= (hwcap & (1 << 1)) != 0;       // HWCAP_ASIMD
+  has_arm_aes_ |= (hwcap & (1 << 3)) != 0;    // HWCAP_AES
+  has_arm_sha_ |= (hwcap & (1 << 5)) != 0 &&  // HWCAP_SHA1
+                  (hwcap & (1 << 6)) != 0;    // HWCAP_SHA2
+  has_arm_crc32_ |= (hwcap & (1 << 7)) != 0;  // HWCAP_CRC32
+#else
+  const unsigned long hwcap = getauxval(AT_HWCAP);
+  const unsigned long hwcap2 = getauxval(AT_HWCAP2);
+  has_neon_ |= (hwcap & (1 << 12)) != 0;       // HWCAP_NEON
+  has_arm_aes_ |= (hwcap2 & (1 << 0)) != 0;    // HWCAP2_AES
+  has_arm_sha_ |= (hwcap2 & (1 << 2)) != 0 &&  // HWCAP2_SHA1
+                  (hwcap2 & (1 << 3)) != 0;    // HWCAP2_SHA2
+  has_arm_crc32_ |= (hwcap2 & (1 << 4)) != 0;  // HWCAP2_CRC32
+#endif
+
+  l1_data_cache_size_ = ReadSysfsCacheSize(1);
+  l2_cache_size_ = ReadSysfsCacheSize(2);
+  l3_cache_size_ = ReadSysfsCacheSize(3);
+#endif  // defined(OS_ANDROID) || defined(OS_LINUX)
 #endif
 }
 
@@ -5,6 +5,8 @@
 #ifndef BASE_CPU_H_
 #define BASE_CPU_H_
 
+#include <stddef.h>
+
 #include <string>
 
 #include "base/base_export.h"
@@ -16,6 +18,11 @@ class BASE_EXPORT CPU final {
  public:
   CPU();
 
+  // Returns the information queried once for the process, to avoid querying it
+  // again in code which checks it often. See also CPUDispatch in
+  // cpu_dispatch.h.
+  static const CPU& GetInstance();
+
   enum IntelMicroArchitecture {
     PENTIUM,
     SSE,
@@ -49,10 +56,31 @@ class BASE_EXPORT CPU final {
   bool has_avx() const { return has_avx_; }
   bool has_avx2() const { return has_avx2_; }
   bool has_aesni() const { return has_aesni_; }
+  bool has_sha() const { return has_sha_; }
+  bool has_bmi2() const { return has_bmi2_; }
+  // The AVX-512 accessors also check that the OS saves the ZMM and mask
+  // registers, like has_avx() does for the YMM registers.
+  bool has_avx512f() const { return has_avx512f_; }
+  bool has_avx512bw() const { return has_avx512bw_; }
+  bool has_avx512vl() const { return has_avx512vl_; }
   bool has_non_stop_time_stamp_counter() const {
     return has_non_stop_time_stamp_counter_;
   }
 
+  // ARM features: Advanced SIMD and the optional ARMv8 CRC32, AES and SHA-1/
+  // SHA-256 instructions.
+  bool has_neon() const { return has_neon_; }
+  bool has_arm_crc32() const { return has_arm_crc32_; }
+  bool has_arm_aes() const { return has_arm_aes_; }
+  bool has_arm_sha() const { return has_arm_sha_; }
+
+  // Sizes in bytes of the level 1 data cache, and of the level 2 and 3 caches,
+  // of one core, or 0 if unknown. The level 2 and 3 caches may be shared with
+  // other cores.
+  size_t l1_data_cache_size() const { return l1_data_cache_size_; }
+  size_t l2_cache_size() const { return l2_cache_size_; }
+  size_t l3_cache_size() const { return l3_cache_size_; }
+
   IntelMicroArchitecture GetIntelMicroArchitecture() const;
   const std::string& cpu_brand() const { return cpu_brand_; }
 
@@ -78,7 +106,19 @@ class BASE_EXPORT CPU final {
   bool has_avx_;
   bool has_avx2_;
   bool has_aesni_;
+  bool has_sha_;
+  bool has_bmi2_;
+  bool has_avx512f_;
+  bool has_avx512bw_;
+  bool has_avx512vl_;
   bool has_non_stop_time_stamp_counter_;
+  bool has_neon_;
+  bool has_arm_crc32_;
+  bool has_arm_aes_;
+  bool has_arm_sha_;
+  size_t l1_data_cache_size_;
+  size_t l2_cache_size_;
+  size_t l3_cache_size_;
   std::string cpu_vendor_;
   std::string cpu_brand_;
 };
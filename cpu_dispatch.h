@@ -0,0 +1,88 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CPU_DISPATCH_H_
+#define BASE_CPU_DISPATCH_H_
+
+#include <atomic>
+#include <utility>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/logging.h"
+#include "base/macros.h"
+
+namespace base {
+
+// CPUDispatch calls the implementation of a function best suited to the
+// processor. Like an ELF ifunc, it asks a resolver for the implementation the
+// first time it is called, and then calls it directly: kernels check the
+// processor features once rather than in their loops.
+//
+// The resolver gets the CPU information, from which it can also choose block
+// sizes, e.g. to fit in the level 2 cache. It may run more than once if the
+// first calls race, so it must return the same implementation every time.
+//
+// CPUDispatch is constant-initialized, so it can be a global used during
+// static initialization:
+//
+//   size_t CountScalar(const uint8_t* data, size_t size);
+//   size_t CountAVX2(const uint8_t* data, size_t size);
+//
+//   CPUDispatch<size_t(const uint8_t*, size_t)>::Function ResolveCount(
+//       const CPU& cpu) {
+//     return cpu.has_avx2() ? &CountAVX2 : &CountScalar;
+//   }
+//
+//   CONSTINIT CPUDispatch<size_t(const uint8_t*, size_t)> g_count(
+//       &ResolveCount);
+//
+//   size_t Count(const uint8_t* data, size_t size) {
+//     return g_count(data, size);
+//   }
+template <typename Sig>
+class CPUDispatch;
+
+template <typename R, typename... Args>
+class CPUDispatch<R(Args...)> {
+ public:
+  using Function = R (*)(Args...);
+  using Resolver = Function (*)(const CPU& cpu);
+
+  constexpr explicit CPUDispatch(Resolver resolver)
+      : resolver_(resolver), function_(nullptr) {}
+
+  // Calls the implementation.
+  template <typename... RunArgs>
+  R operator()(RunArgs&&... args) const {
+    return Get()(std::forward<RunArgs>(args)...);
+  }
+
+  // Returns the implementation, resolving it if needed.
+  Function Get() const {
+    // Relaxed is enough: the implementation is code, which doesn't need to be
+    // published along with anything else.
+    Function function = function_.load(std::memory_order_relaxed);
+    if (UNLIKELY(!function))
+      function = Resolve();
+    return function;
+  }
+
+ private:
+  NOINLINE Function Resolve() const {
+    Function function = resolver_(CPU::GetInstance());
+    DCHECK(function);
+    function_.store(function, std::memory_order_relaxed);
+    return function;
+  }
+
+  const Resolver resolver_;
+  mutable std::atomic<Function> function_;
+
+  DISALLOW_COPY_AND_ASSIGN(CPUDispatch);
+};
+
+}  // namespace base
+
+#endif  // BASE_CPU_DISPATCH_H_
@@ -0,0 +1,62 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/cpu_dispatch.h"
+
+#include <memory>
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+int g_num_resolves = 0;
+
+int AddOne(int value) {
+  return value + 1;
+}
+
+int AddTwo(int value) {
+  return value + 2;
+}
+
+CPUDispatch<int(int)>::Function ResolveAdd(const CPU& cpu) {
+  ++g_num_resolves;
+  EXPECT_EQ(&CPU::GetInstance(), &cpu);
+  return cpu.has_sse2() ? &AddTwo : &AddOne;
+}
+
+std::string Consume(std::unique_ptr<std::string> value) {
+  return *value;
+}
+
+CPUDispatch<std::string(std::unique_ptr<std::string>)>::Function
+ResolveConsume(const CPU&) {
+  return &Consume;
+}
+
+}  // namespace
+
+TEST(CPUDispatchTest, ResolvesOnce) {
+  g_num_resolves = 0;
+  CPUDispatch<int(int)> add(&ResolveAdd);
+  EXPECT_EQ(0, g_num_resolves);
+
+  const int expected = CPU::GetInstance().has_sse2() ? 3 : 2;
+  EXPECT_EQ(expected, add(1));
+  EXPECT_EQ(expected + 1, add(2));
+  EXPECT_EQ(1, g_num_resolves);
+  EXPECT_EQ(add.Get(), add.Get());
+  EXPECT_EQ(1, g_num_resolves);
+}
+
+TEST(CPUDispatchTest, ForwardsMoveOnlyArguments) {
+  CPUDispatch<std::string(std::unique_ptr<std::string>)> consume(
+      &ResolveConsume);
+  EXPECT_EQ("value", consume(std::make_unique<std::string>("value")));
+}
+
+}  // namespace base
@@ -72,6 +72,16 @@ TEST(CPU, RunExtendedInstructions) {
     __asm__ __volatile__("vpunpcklbw %%ymm0, %%ymm0, %%ymm0\n" : : : "xmm0");
   }
 
+  if (cpu.has_bmi2()) {
+    // Execute a BMI 2 instruction.
+    __asm__ __volatile__("pdep %%eax, %%eax, %%eax\n" : : : "eax");
+  }
+
+  if (cpu.has_avx512f()) {
+    // Execute an AVX-512 instruction.
+    __asm__ __volatile__("vpxord %%zmm0, %%zmm0, %%zmm0\n" : : : "xmm0");
+  }
+
 // Visual C 32 bit and ClangCL 32/64 bit test.
 #elif defined(COMPILER_MSVC) && (defined(ARCH_CPU_32_BITS) || \
       (defined(ARCH_CPU_64_BITS) && defined(__clang__)))
@@ -132,3 +142,35 @@ TEST(CPU, BrandAndVendorContainsNoNUL) {
   EXPECT_FALSE(base::ContainsValue(cpu.cpu_brand(), '\0'));
   EXPECT_FALSE(base::ContainsValue(cpu.vendor_name(), '\0'));
 }
+
+TEST(CPU, ExtendedFeaturesAreConsistent) {
+  const base::CPU& cpu = base::CPU::GetInstance();
+  EXPECT_EQ(&cpu, &base::CPU::GetInstance());
+
+  EXPECT_TRUE(!cpu.has_avx512f() || cpu.has_avx2());
+  EXPECT_TRUE(!cpu.has_avx512bw() || cpu.has_avx512f());
+  EXPECT_TRUE(!cpu.has_avx512vl() || cpu.has_avx512f());
+
+#if defined(ARCH_CPU_ARM64)
+  EXPECT_TRUE(cpu.has_neon());
+#elif defined(ARCH_CPU_X86_FAMILY)
+  EXPECT_FALSE(cpu.has_neon());
+  EXPECT_FALSE(cpu.has_arm_crc32());
+#endif
+}
+
+TEST(CPU, CacheSizes) {
+  const base::CPU& cpu = base::CPU::GetInstance();
+  // Sizes are unknown on some platforms, but the known ones grow with levels.
+  if (cpu.l1_data_cache_size() && cpu.l2_cache_size()) {
+    EXPECT_LE(cpu.l1_data_cache_size(), cpu.l2_cache_size());
+  }
+  if (cpu.l2_cache_size() && cpu.l3_cache_size()) {
+    EXPECT_LE(cpu.l2_cache_size(), cpu.l3_cache_size());
+  }
+
+#if defined(ARCH_CPU_X86_FAMILY)
+  EXPECT_GT(cpu.l1_data_cache_size(), 0u);
+  EXPECT_GT(cpu.l2_cache_size(), 0u);
+#endif
+}
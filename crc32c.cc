@@ -0,0 +1,285 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/crc32c.h"
+
+#include <string.h>
+
+#include "base/compiler_specific.h"
+#include "base/cpu_dispatch.h"
+#include "base/sys_byteorder.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <nmmintrin.h>
+#elif defined(ARCH_CPU_ARM64) && defined(COMPILER_GCC)
+#include <arm_acle.h>
+#endif
+
+namespace base {
+
+namespace {
+
+// Polynomials are represented bit-reversed, as the checksum is computed least
+// significant bit first: bit 31 holds the coefficient of x^0, and bit 0 that of
+// x^31. This is the CRC-32C polynomial, without its x^32 term.
+constexpr uint32_t kPolynomial = 0x82f63b78;
+
+// Returns a * b modulo the polynomial.
+constexpr uint32_t MultiplyModP(uint32_t a, uint32_t b) {
+  uint32_t product = 0;
+  for (uint32_t m = uint32_t{1} << 31; a; m >>= 1) {
+    if (a & m) {
+      product ^= b;
+      a ^= m;
+    }
+    b = b & 1 ? (b >> 1) ^ kPolynomial : b >> 1;
+  }
+  return product;
+}
+
+// Returns x^(8 * |length|) modulo the polynomial: multiplying by it shifts a
+// checksum past |length| zero bytes.
+constexpr uint32_t ShiftPowerModP(size_t length) {
+  uint32_t result = uint32_t{1} << 31;  // x^0.
+  uint32_t power = uint32_t{1} << 23;   // x^8.
+  for (; length; length >>= 1) {
+    if (length & 1)
+      result = MultiplyModP(power, result);
+    power = MultiplyModP(power, power);
+  }
+  return result;
+}
+
+// Tables for the slicing-by-8 algorithm: |table[k][n]| is the checksum of byte
+// |n| followed by |k| zero bytes.
+struct ByteTables {
+  uint32_t table[8][256];
+};
+
+constexpr ByteTables MakeByteTables() {
+  ByteTables tables{};
+  for (uint32_t n = 0; n < 256; ++n) {
+    uint32_t crc = n;
+    for (int bit = 0; bit < 8; ++bit)
+      crc = crc & 1 ? (crc >> 1) ^ kPolynomial : crc >> 1;
+    tables.table[0][n] = crc;
+  }
+  for (int k = 1; k < 8; ++k) {
+    for (uint32_t n = 0; n < 256; ++n) {
+      const uint32_t crc = tables.table[k - 1][n];
+      tables.table[k][n] = (crc >> 8) ^ tables.table[0][crc & 0xff];
+    }
+  }
+  return tables;
+}
+
+constexpr ByteTables kByteTables = MakeByteTables();
+
+uint32_t ExtendPortable(uint32_t crc, const uint8_t* data, size_t length) {
+  const auto& table = kByteTables.table;
+  uint32_t value = ~crc;
+  for (; length >= 8; data += 8, length -= 8) {
+    uint32_t low;
+    uint32_t high;
+    memcpy(&low, data, sizeof(low));
+    memcpy(&high, data + sizeof(low), sizeof(high));
+    low = ByteSwapToLE32(low) ^ value;
+    high = ByteSwapToLE32(high);
+    value = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^
+            table[5][(low >> 16) & 0xff] ^ table[4][low >> 24] ^
+            table[3][high & 0xff] ^ table[2][(high >> 8) & 0xff] ^
+            table[1][(high >> 16) & 0xff] ^ table[0][high >> 24];
+  }
+  for (; length; ++data, --length)
+    value = (value >> 8) ^ table[0][(value ^ *data) & 0xff];
+  return ~value;
+}
+
+#if defined(ARCH_CPU_X86_FAMILY) || \
+    (defined(ARCH_CPU_ARM64) && defined(COMPILER_GCC))
+#define HARDWARE_CRC32C
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+#if defined(COMPILER_GCC)
+#define CRC32C_TARGET __attribute__((target("sse4.2")))
+#else
+#define CRC32C_TARGET
+#endif
+
+#if defined(ARCH_CPU_X86_64)
+using Word = uint64_t;
+
+CRC32C_TARGET ALWAYS_INLINE uint32_t ExtendWord(uint32_t crc, Word word) {
+  return static_cast<uint32_t>(_mm_crc32_u64(crc, word));
+}
+#else
+using Word = uint32_t;
+
+CRC32C_TARGET ALWAYS_INLINE uint32_t ExtendWord(uint32_t crc, Word word) {
+  return _mm_crc32_u32(crc, word);
+}
+#endif
+
+CRC32C_TARGET ALWAYS_INLINE uint32_t ExtendByte(uint32_t crc, uint8_t byte) {
+  return _mm_crc32_u8(crc, byte);
+}
+
+bool HasHardwareCrc32c(const CPU& cpu) {
+  return cpu.has_sse42();
+}
+
+#else  // defined(ARCH_CPU_X86_FAMILY)
+
+#if defined(__clang__)
+#define CRC32C_TARGET __attribute__((target("crc")))
+#else
+#define CRC32C_TARGET __attribute__((target("+crc")))
+#endif
+
+using Word = uint64_t;
+
+CRC32C_TARGET ALWAYS_INLINE uint32_t ExtendWord(uint32_t crc, Word word) {
+  return __crc32cd(crc, word);
+}
+
+CRC32C_TARGET ALWAYS_INLINE uint32_t ExtendByte(uint32_t crc, uint8_t byte) {
+  return __crc32cb(crc, byte);
+}
+
+bool HasHardwareCrc32c(const CPU& cpu) {
+  return cpu.has_arm_crc32();
+}
+
+#endif  // defined(ARCH_CPU_X86_FAMILY)
+
+// The CRC32 instructions take a few cycles, but a new one can start every
+// cycle: the buffer is checksummed as three interleaved streams, which are
+// then combined. Long streams amortize the combination, short streams handle
+// the rest of the buffer.
+constexpr size_t kLongStreamLength = 8192;
+constexpr size_t kShortStreamLength = 256;
+
+// Tables multiplying a checksum by ShiftPowerModP(|length|), one byte at a
+// time, since the multiplication is linear.
+struct ShiftTable {
+  uint32_t table[4][256];
+};
+
+constexpr ShiftTable MakeShiftTable(size_t length) {
+  const uint32_t power = ShiftPowerModP(length);
+  ShiftTable shift{};
+  for (int k = 0; k < 4; ++k) {
+    for (uint32_t n = 0; n < 256; ++n)
+      shift.table[k][n] = MultiplyModP(power, n << (8 * k));
+  }
+  return shift;
+}
+
+constexpr ShiftTable kLongShift = MakeShiftTable(kLongStreamLength);
+constexpr ShiftTable kShortShift = MakeShiftTable(kShortStreamLength);
+
+inline uint32_t Shift(const ShiftTable& shift, uint32_t crc) {
+  return shift.table[0][crc & 0xff] ^ shift.table[1][(crc >> 8) & 0xff] ^
+         shift.table[2][(crc >> 16) & 0xff] ^ shift.table[3][crc >> 24];
+}
+
+inline Word LoadWord(const uint8_t* data) {
+  Word word;
+  memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+// Extends |value|, the unconditioned checksum, with three streams of
+// |stream_length| bytes as long as |*length| allows.
+CRC32C_TARGET uint32_t ExtendStreams(uint32_t value,
+                                     size_t stream_length,
+                                     const ShiftTable& shift,
+                                     const uint8_t** data,
+                                     size_t* length) {
+  for (; *length >= 3 * stream_length;
+       *data += 3 * stream_length, *length -= 3 * stream_length) {
+    const uint8_t* stream = *data;
+    const uint8_t* const end = stream + stream_length;
+    uint32_t crc0 = value;
+    uint32_t crc1 = 0;
+    uint32_t crc2 = 0;
+    for (; stream < end; stream += sizeof(Word)) {
+      crc0 = ExtendWord(crc0, LoadWord(stream));
+      crc1 = ExtendWord(crc1, LoadWord(stream + stream_length));
+      crc2 = ExtendWord(crc2, LoadWord(stream + 2 * stream_length));
+    }
+    value = Shift(shift, crc0) ^ crc1;
+    value = Shift(shift, value) ^ crc2;
+  }
+  return value;
+}
+
+CRC32C_TARGET uint32_t ExtendHardware(uint32_t crc,
+                                      const uint8_t* data,
+                                      size_t length) {
+  uint32_t value = ~crc;
+  for (; length && reinterpret_cast<uintptr_t>(data) % sizeof(Word);
+       ++data, --length) {
+    value = ExtendByte(value, *data);
+  }
+  value = ExtendStreams(value, kLongStreamLength, kLongShift, &data, &length);
+  value =
+      ExtendStreams(value, kShortStreamLength, kShortShift, &data, &length);
+  for (; length >= sizeof(Word); data += sizeof(Word), length -= sizeof(Word))
+    value = ExtendWord(value, LoadWord(data));
+  for (; length; ++data, --length)
+    value = ExtendByte(value, *data);
+  return ~value;
+}
+
+#undef CRC32C_TARGET
+
+#endif  // defined(ARCH_CPU_X86_FAMILY) || (defined(ARCH_CPU_ARM64) &&
+        // defined(COMPILER_GCC))
+
+using ExtendDispatch =
+    CPUDispatch<uint32_t(uint32_t crc, const uint8_t* data, size_t length)>;
+
+ExtendDispatch::Function ResolveExtend(const CPU& cpu) {
+#if defined(HARDWARE_CRC32C)
+  if (HasHardwareCrc32c(cpu))
+    return &ExtendHardware;
+#endif
+  return &ExtendPortable;
+}
+
+#undef HARDWARE_CRC32C
+
+CONSTINIT ExtendDispatch g_extend(&ResolveExtend);
+
+}  // namespace
+
+uint32_t Crc32c(const void* data, size_t length) {
+  return ExtendCrc32c(0, data, length);
+}
+
+uint32_t Crc32c(StringPiece data) {
+  return ExtendCrc32c(0, data.data(), data.size());
+}
+
+uint32_t ExtendCrc32c(uint32_t crc, const void* data, size_t length) {
+  return g_extend(crc, static_cast<const uint8_t*>(data), length);
+}
+
+uint32_t CombineCrc32c(uint32_t crc1, uint32_t crc2, size_t length2) {
+  // The conditioning of the checksums cancels out.
+  return MultiplyModP(ShiftPowerModP(length2), crc1) ^ crc2;
+}
+
+namespace internal {
+
+uint32_t ExtendCrc32cPortable(uint32_t crc, const void* data, size_t length) {
+  return ExtendPortable(crc, static_cast<const uint8_t*>(data), length);
+}
+
+}  // namespace internal
+
+}  // namespace base
@@ -0,0 +1,57 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CRC32C_H_
+#define BASE_CRC32C_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+
+// Computes the CRC-32C (Castagnoli) checksum of a memory buffer, as used by
+// iSCSI, SCTP, ext4 and others. It detects accidental corruption of persisted
+// or transmitted data, and is much faster than MD5Sum() or PersistentHash():
+// it uses the SSE 4.2 or ARMv8 CRC32 instructions when available. The values
+// never change, so they can be persisted.
+//
+// WARNING: This checksum should not be used for any cryptographic purpose.
+BASE_EXPORT uint32_t Crc32c(const void* data, size_t length);
+BASE_EXPORT uint32_t Crc32c(StringPiece data);
+
+// Returns the Crc32c() of the data checksummed by |crc| followed by |data|, to
+// checksum data which isn't available all at once. For example:
+//
+//   uint32_t crc = 0;
+//   for (const std::string& chunk : chunks)
+//     crc = ExtendCrc32c(crc, chunk.data(), chunk.size());
+//
+// Crc32c() of no data is 0, so it can start the computation.
+BASE_EXPORT uint32_t ExtendCrc32c(uint32_t crc,
+                                  const void* data,
+                                  size_t length);
+
+// Returns the Crc32c() of the concatenation of two buffers, given their
+// checksums |crc1| and |crc2| and the length of the second one, e.g. to
+// checksum the parts of a buffer in parallel. Takes O(log(length2)) time.
+BASE_EXPORT uint32_t CombineCrc32c(uint32_t crc1,
+                                   uint32_t crc2,
+                                   size_t length2);
+
+namespace internal {
+
+// The portable implementation of ExtendCrc32c(), which doesn't use CRC32
+// instructions. Exposed for tests.
+BASE_EXPORT uint32_t ExtendCrc32cPortable(uint32_t crc,
+                                          const void* data,
+                                          size_t length);
+
+}  // namespace internal
+
+}  // namespace base
+
+#endif  // BASE_CRC32C_H_
@@ -0,0 +1,85 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/crc32c.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Returns |length| bytes which don't repeat with a short period.
+std::string MakeInput(size_t length) {
+  std::string input(length, '\0');
+  uint32_t state = 1;
+  for (char& c : input) {
+    state = state * 1103515245 + 12345;
+    c = static_cast<char>(state >> 24);
+  }
+  return input;
+}
+
+}  // namespace
+
+// From RFC 3720, section B.4, and the usual check value.
+TEST(Crc32cTest, KnownValues) {
+  EXPECT_EQ(0u, Crc32c(StringPiece()));
+  EXPECT_EQ(0xe3069283u, Crc32c("123456789"));
+  EXPECT_EQ(0x8a9136aau, Crc32c(std::string(32, '\0')));
+  EXPECT_EQ(0x62a8ab43u, Crc32c(std::string(32, '\xff')));
+
+  uint8_t ascending[32];
+  uint8_t descending[32];
+  for (size_t i = 0; i < 32; ++i) {
+    ascending[i] = static_cast<uint8_t>(i);
+    descending[i] = static_cast<uint8_t>(31 - i);
+  }
+  EXPECT_EQ(0x46dd794eu, Crc32c(ascending, sizeof(ascending)));
+  EXPECT_EQ(0x113fdb5cu, Crc32c(descending, sizeof(descending)));
+  EXPECT_EQ(0xe3069283u, internal::ExtendCrc32cPortable(0, "123456789", 9));
+}
+
+// The hardware implementation, when available, matches the portable one for
+// every length up to and past the stream lengths, and every alignment.
+TEST(Crc32cTest, MatchesPortable) {
+  const std::string input = MakeInput(3 * 8192 + 3 * 256 + 64);
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t length = 0; offset + length <= input.size();
+         length += length < 1024 ? 1 : 97) {
+      const char* data = input.data() + offset;
+      ASSERT_EQ(internal::ExtendCrc32cPortable(0, data, length),
+                Crc32c(data, length))
+          << "offset " << offset << ", length " << length;
+    }
+  }
+}
+
+TEST(Crc32cTest, Extend) {
+  const std::string input = MakeInput(30000);
+  const uint32_t expected = Crc32c(input);
+  for (size_t split : {0, 1, 7, 100, 8192, 25000, 30000}) {
+    uint32_t crc = ExtendCrc32c(0, input.data(), split);
+    crc = ExtendCrc32c(crc, input.data() + split, input.size() - split);
+    EXPECT_EQ(expected, crc) << "split " << split;
+  }
+}
+
+TEST(Crc32cTest, Combine) {
+  const std::string input = MakeInput(30000);
+  const uint32_t expected = Crc32c(input);
+  for (size_t split : {0, 1, 7, 100, 8192, 25000, 30000}) {
+    const uint32_t crc1 = Crc32c(input.data(), split);
+    const uint32_t crc2 = Crc32c(input.data() + split, input.size() - split);
+    EXPECT_EQ(expected, CombineCrc32c(crc1, crc2, input.size() - split))
+        << "split " << split;
+  }
+}
+
+}  // namespace base
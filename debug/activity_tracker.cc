@@ -278,6 +278,18 @@ void Activity::FillFrom(Activity* activity,
 #endif
 }
 
+// static
+void Activity::FillMinimalFrom(Activity* activity,
+                               const void* program_counter,
+                               Type type) {
+  activity->time_internal = base::TimeTicks::Now().ToInternalValue();
+  activity->calling_address = reinterpret_cast<uintptr_t>(program_counter);
+  activity->origin_address = 0;
+  activity->call_stack[0] = 0;
+  activity->activity_type = type;
+  activity->data = kNullActivityData;
+}
+
 ActivityUserData::TypedValue::TypedValue() = default;
 ActivityUserData::TypedValue::TypedValue(const TypedValue& other) = default;
 ActivityUserData::TypedValue::~TypedValue() = default;
@@ -671,6 +683,23 @@ ThreadActivityTracker::ScopedActivity::ScopedActivity(
     activity_id_ = tracker_->PushActivity(program_counter, origin, type, data);
 }
 
+ThreadActivityTracker::ScopedActivity::ScopedActivity(
+    ThreadActivityTracker* tracker,
+    const void* program_counter,
+    const PendingTask& task,
+    bool minimal)
+    : tracker_(tracker) {
+  if (!tracker_)
+    return;
+  if (minimal) {
+    activity_id_ = tracker_->PushMinimalTaskActivity(program_counter, task);
+  } else {
+    activity_id_ = tracker_->PushActivity(
+        program_counter, task.posted_from.program_counter(),
+        Activity::ACT_TASK_RUN, ActivityData::ForTask(task.sequence_num));
+  }
+}
+
 ThreadActivityTracker::ScopedActivity::~ScopedActivity() {
   if (tracker_)
     tracker_->PopActivity(activity_id_);
@@ -771,6 +800,9 @@ ThreadActivityTracker::ActivityId ThreadActivityTracker::PushActivity(
   // re-entry into this code if lock acquisitions are being tracked.
   DCHECK(type == Activity::ACT_LOCK_ACQUIRE || CalledOnValidThread());
 
+  // The task this activity is nested in may have been pushed minimally.
+  CaptureLazyTaskActivity();
+
   // Get the current depth of the stack. No access to other memory guarded
   // by this variable is done here so a "relaxed" load is acceptable.
   uint32_t depth = header_->current_depth.load(std::memory_order_relaxed);
@@ -799,6 +831,44 @@ ThreadActivityTracker::ActivityId ThreadActivityTracker::PushActivity(
   return depth;
 }
 
+ThreadActivityTracker::ActivityId
+ThreadActivityTracker::PushMinimalTaskActivity(const void* program_counter,
+                                               const PendingTask& task) {
+  DCHECK(CalledOnValidThread());
+
+  // A nested task run leaves no room to capture the outer one later.
+  CaptureLazyTaskActivity();
+
+  // See PushActivity() for the memory ordering.
+  uint32_t depth = header_->current_depth.load(std::memory_order_relaxed);
+  if (depth >= stack_slots_) {
+    header_->current_depth.store(depth + 1, std::memory_order_relaxed);
+    return depth;
+  }
+
+  Activity::FillMinimalFrom(&stack_[depth], program_counter,
+                            Activity::ACT_TASK_RUN);
+  lazy_task_ = &task;
+  lazy_task_id_ = depth;
+  header_->current_depth.store(depth + 1, std::memory_order_release);
+  return depth;
+}
+
+void ThreadActivityTracker::CaptureLazyTaskActivity() {
+  if (!lazy_task_)
+    return;
+
+  Activity* activity = &stack_[lazy_task_id_];
+  activity->origin_address =
+      reinterpret_cast<uintptr_t>(lazy_task_->posted_from.program_counter());
+  activity->data = ActivityData::ForTask(lazy_task_->sequence_num);
+  lazy_task_ = nullptr;
+
+  // The entry changed after it was pushed, so some other thread copying the
+  // contents could get bad data, as in PopActivity().
+  header_->data_version.fetch_add(1, std::memory_order_release);
+}
+
 void ThreadActivityTracker::ChangeActivity(ActivityId id,
                                            Activity::Type type,
                                            const ActivityData& data) {
@@ -834,6 +904,10 @@ void ThreadActivityTracker::PopActivity(ActivityId id) {
   // Validate that everything is running correctly.
   DCHECK_EQ(id, depth);
 
+  // A lazily captured entry is always the top-most one, so it's gone now.
+  DCHECK(!lazy_task_ || lazy_task_id_ == depth);
+  lazy_task_ = nullptr;
+
   // A thread-checker creates a lock to check the thread-id which means
   // re-entry into this code if lock acquisitions are being tracked.
   DCHECK(stack_[depth].activity_type == Activity::ACT_LOCK_ACQUIRE ||
@@ -887,6 +961,9 @@ void ThreadActivityTracker::RecordExceptionActivity(const void* program_counter,
   // re-entry into this code if lock acquisitions are being tracked.
   DCHECK(CalledOnValidThread());
 
+  // The exception may have happened within a task pushed minimally.
+  CaptureLazyTaskActivity();
+
   // Fill the reusable exception activity.
   Activity::FillFrom(&header_->last_exception, program_counter, origin, type,
                      data);
@@ -1200,6 +1277,15 @@ GlobalActivityTracker::ScopedThreadActivity::ScopedThreadActivity(
                                             type,
                                             data) {}
 
+GlobalActivityTracker::ScopedThreadActivity::ScopedThreadActivity(
+    const void* program_counter,
+    const PendingTask& task,
+    bool lock_allowed)
+    : ThreadActivityTracker::ScopedActivity(GetOrCreateTracker(lock_allowed),
+                                            program_counter,
+                                            task,
+                                            UseMinimalTaskActivities()) {}
+
 GlobalActivityTracker::ScopedThreadActivity::~ScopedThreadActivity() {
   if (tracker_ && tracker_->HasUserData(activity_id_)) {
     GlobalActivityTracker* global = GlobalActivityTracker::Get();
@@ -1775,16 +1861,13 @@ void ScopedActivity::ChangeActionAndInfo(uint8_t action, int32_t info) {
 ScopedTaskRunActivity::ScopedTaskRunActivity(
     const void* program_counter,
     const base::PendingTask& task)
-    : GlobalActivityTracker::ScopedThreadActivity(
-          program_counter,
-          task.posted_from.program_counter(),
-          Activity::ACT_TASK_RUN,
-          ActivityData::ForTask(task.sequence_num),
-          /*lock_allowed=*/true) {}
+    : GlobalActivityTracker::ScopedThreadActivity(program_counter,
+                                                  task,
+                                                  /*lock_allowed=*/true) {}
 
 ScopedLockAcquireActivity::ScopedLockAcquireActivity(
     const void* program_counter,
-    const base::internal::LockImpl* lock)
+    const void* lock)
     : GlobalActivityTracker::ScopedThreadActivity(
           program_counter,
           nullptr,
@@ -44,6 +44,7 @@ class FilePath;
 class Lock;
 class PlatformThreadHandle;
 class Process;
+class ReadWriteLock;
 class WaitableEvent;
 
 namespace debug {
@@ -339,6 +340,12 @@ struct Activity {
                        const void* origin,
                        Type type,
                        const ActivityData& data);
+
+  // Like FillFrom() but records only the time, |program_counter| and |type|,
+  // clearing the origin, data and call stack.
+  static void FillMinimalFrom(Activity* activity,
+                              const void* program_counter,
+                              Type type);
 };
 
 // This class manages arbitrary user data that can be associated with activities
@@ -626,6 +633,11 @@ class BASE_EXPORT ThreadActivityTracker {
                    const void* origin,
                    Activity::Type type,
                    const ActivityData& data);
+    // Tracks running |task|, with PushMinimalTaskActivity() if |minimal|.
+    ScopedActivity(ThreadActivityTracker* tracker,
+                   const void* program_counter,
+                   const PendingTask& task,
+                   bool minimal);
     ~ScopedActivity();
 
     // Changes some basic metadata about the activity.
@@ -668,6 +680,15 @@ class BASE_EXPORT ThreadActivityTracker {
     return PushActivity(GetProgramCounter(), origin, type, data);
   }
 
+  // Like PushActivity() for running |task|, but records only the time and
+  // |program_counter|, leaving out the origin, data and call stack, which is
+  // cheaper for threads running many short tasks. The origin and sequence
+  // number of |task|, which must outlive the activity, are written to its
+  // entry lazily, once another activity is pushed above it or an exception is
+  // recorded. Until then, snapshots show the entry without them.
+  ActivityId PushMinimalTaskActivity(const void* program_counter,
+                                     const PendingTask& task);
+
   // Changes the activity |type| and |data| of the top-most entry on the stack.
   // This is useful if the information has changed and it is desireable to
   // track that change without creating a new stack entry. If the type is
@@ -737,6 +758,10 @@ class BASE_EXPORT ThreadActivityTracker {
 
   bool CalledOnValidThread();
 
+  // Writes the origin and data of the entry pushed by
+  // PushMinimalTaskActivity(), if they're still missing.
+  void CaptureLazyTaskActivity();
+
   std::unique_ptr<ActivityUserData> CreateUserDataForActivity(
       Activity* activity,
       ActivityTrackerMemoryAllocator* allocator);
@@ -754,6 +779,11 @@ class BASE_EXPORT ThreadActivityTracker {
 
   bool valid_ = false;          // Tracks whether the data is valid or not.
 
+  // The task of the top-most entry if it was pushed by
+  // PushMinimalTaskActivity() and its full data wasn't written yet, or null.
+  const PendingTask* lazy_task_ = nullptr;
+  ActivityId lazy_task_id_ = 0;
+
   DISALLOW_COPY_AND_ASSIGN(ThreadActivityTracker);
 };
 
@@ -845,6 +875,11 @@ class BASE_EXPORT GlobalActivityTracker {
                          Activity::Type type,
                          const ActivityData& data,
                          bool lock_allowed);
+    // Tracks running |task|, minimally if SetMinimalTaskActivities() was
+    // called.
+    ScopedThreadActivity(const void* program_counter,
+                         const PendingTask& task,
+                         bool lock_allowed);
     ~ScopedThreadActivity();
 
     // Returns an object for manipulating user data.
@@ -866,6 +901,12 @@ class BASE_EXPORT GlobalActivityTracker {
         return global_tracker->GetTrackerForCurrentThread();
     }
 
+    static bool UseMinimalTaskActivities() {
+      GlobalActivityTracker* global_tracker = Get();
+      return global_tracker && global_tracker->minimal_task_activities_.load(
+                                   std::memory_order_relaxed);
+    }
+
     // An object that manages additional user data, created only upon request.
     std::unique_ptr<ActivityUserData> user_data_;
 
@@ -973,6 +1014,15 @@ class BASE_EXPORT GlobalActivityTracker {
   // Sets an optional callback to be called when a process exits.
   void SetProcessExitCallback(ProcessExitCallback callback);
 
+  // Sets whether task runs are tracked with only the time and program counter,
+  // rather than with their origin, sequence number and call stack, in order to
+  // lower the overhead of each task. The rest is still captured lazily once
+  // something is nested in the task. See
+  // ThreadActivityTracker::PushMinimalTaskActivity().
+  void SetMinimalTaskActivities(bool minimal) {
+    minimal_task_activities_.store(minimal, std::memory_order_relaxed);
+  }
+
   // Manages process lifetimes. These are called by the process that launched
   // and reaped the subprocess, not the subprocess itself. If it is expensive
   // to generate the parameters, Get() the global tracker and call these
@@ -1200,6 +1250,9 @@ class BASE_EXPORT GlobalActivityTracker {
   // The number of thread trackers currently active.
   std::atomic<int> thread_tracker_count_;
 
+  // Whether task runs are tracked minimally.
+  std::atomic<bool> minimal_task_activities_{false};
+
   // A caching memory allocator for thread-tracker objects.
   ActivityTrackerMemoryAllocator thread_tracker_allocator_;
   Lock thread_tracker_allocator_lock_;
@@ -1305,10 +1358,12 @@ class BASE_EXPORT ScopedLockAcquireActivity
   ALWAYS_INLINE
   explicit ScopedLockAcquireActivity(const base::internal::LockImpl* lock)
       : ScopedLockAcquireActivity(GetProgramCounter(), lock) {}
+  ALWAYS_INLINE
+  explicit ScopedLockAcquireActivity(const base::ReadWriteLock* lock)
+      : ScopedLockAcquireActivity(GetProgramCounter(), lock) {}
 
  private:
-  ScopedLockAcquireActivity(const void* program_counter,
-                            const base::internal::LockImpl* lock);
+  ScopedLockAcquireActivity(const void* program_counter, const void* lock);
   DISALLOW_COPY_AND_ASSIGN(ScopedLockAcquireActivity);
 };
 
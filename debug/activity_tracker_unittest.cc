@@ -249,6 +249,52 @@ TEST_F(ActivityTrackerTest, ScopedTaskTest) {
   ASSERT_EQ(2U, GetGlobalUserDataMemoryCacheUsed());
 }
 
+TEST_F(ActivityTrackerTest, MinimalScopedTaskTest) {
+  GlobalActivityTracker::CreateWithLocalMemory(kMemorySize, 0, "", 3, 0);
+  GlobalActivityTracker::Get()->SetMinimalTaskActivities(true);
+
+  ThreadActivityTracker* tracker =
+      GlobalActivityTracker::Get()->GetOrCreateTrackerForCurrentThread();
+  ThreadActivityTracker::Snapshot snapshot;
+
+  PendingTask task1(FROM_HERE, DoNothing());
+  task1.sequence_num = 1;
+  {
+    ScopedTaskRunActivity activity1(task1);
+
+    // Only the time and the program counter are recorded at first.
+    ASSERT_TRUE(tracker->CreateSnapshot(&snapshot));
+    ASSERT_EQ(1U, snapshot.activity_stack.size());
+    EXPECT_EQ(Activity::ACT_TASK, snapshot.activity_stack[0].activity_type);
+    EXPECT_NE(0U, snapshot.activity_stack[0].calling_address);
+    EXPECT_NE(0, snapshot.activity_stack[0].time_internal);
+    EXPECT_EQ(0U, snapshot.activity_stack[0].origin_address);
+    EXPECT_EQ(0U, snapshot.activity_stack[0].data.task.sequence_id);
+
+    PendingTask task2(FROM_HERE, DoNothing());
+    task2.sequence_num = 2;
+    {
+      // The rest of the outer task is captured once something is nested.
+      ScopedTaskRunActivity activity2(task2);
+      ASSERT_TRUE(tracker->CreateSnapshot(&snapshot));
+      ASSERT_EQ(2U, snapshot.activity_stack.size());
+      EXPECT_EQ(
+          reinterpret_cast<uintptr_t>(task1.posted_from.program_counter()),
+          snapshot.activity_stack[0].origin_address);
+      EXPECT_EQ(1U, snapshot.activity_stack[0].data.task.sequence_id);
+      EXPECT_EQ(0U, snapshot.activity_stack[1].origin_address);
+
+      ScopedActivity activity3(0, 11, 22);
+      ASSERT_TRUE(tracker->CreateSnapshot(&snapshot));
+      ASSERT_EQ(3U, snapshot.activity_stack.size());
+      EXPECT_EQ(2U, snapshot.activity_stack[1].data.task.sequence_id);
+    }
+  }
+
+  ASSERT_TRUE(tracker->CreateSnapshot(&snapshot));
+  ASSERT_EQ(0U, snapshot.activity_stack_depth);
+}
+
 namespace {
 
 class SimpleLockThread : public SimpleThread {
@@ -8,9 +8,14 @@
 
 #include <algorithm>
 #include <sstream>
+#include <utility>
 
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/location.h"
 #include "base/logging.h"
 #include "base/macros.h"
+#include "base/task_scheduler/post_task.h"
 
 #if BUILDFLAG(CAN_UNWIND_WITH_FRAME_POINTERS)
 
@@ -220,6 +225,15 @@ std::string StackTrace::ToString() const {
   return stream.str();
 }
 
+void StackTrace::ToStringAsync(OnceCallback<void(std::string)> callback) const {
+  PostTaskWithTraitsAndReplyWithResult(
+      FROM_HERE,
+      {TaskPriority::BACKGROUND, TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN},
+      BindOnce([](const StackTrace& trace) { return trace.ToString(); },
+               *this),
+      std::move(callback));
+}
+
 #if BUILDFLAG(CAN_UNWIND_WITH_FRAME_POINTERS)
 
 size_t TraceStackFramePointers(const void** out_trace,
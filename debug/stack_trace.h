@@ -11,6 +11,7 @@
 #include <string>
 
 #include "base/base_export.h"
+#include "base/callback_forward.h"
 #include "base/debug/debugging_buildflags.h"
 #include "base/macros.h"
 #include "build/build_config.h"
@@ -91,6 +92,11 @@ class BASE_EXPORT StackTrace {
   // Resolves backtrace to symbols and returns as string.
   std::string ToString() const;
 
+  // Like ToString(), but resolves the backtrace on a TaskScheduler worker,
+  // since symbolizing may take tens of milliseconds, and then runs |callback|
+  // with the string on the calling sequence.
+  void ToStringAsync(OnceCallback<void(std::string)> callback) const;
+
  private:
 #if defined(OS_WIN)
   void InitTrace(const _CONTEXT* context_record);
@@ -46,9 +46,12 @@
 #include "base/macros.h"
 #include "base/memory/free_deleter.h"
 #include "base/memory/singleton.h"
+#include "base/no_destructor.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/posix/eintr_wrapper.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "base/synchronization/lock.h"
 #include "build/build_config.h"
 
 #if defined(USE_SYMBOLIZE)
@@ -153,13 +156,107 @@ void OutputFrameId(intptr_t frame_id, BacktraceOutputHandler* handler) {
   internal::itoa_r(frame_id, buf, sizeof(buf), 10, 1);
   handler->HandleOutput(buf);
 }
+
+// Caches the symbols of the frames symbolized outside of signal handlers, so
+// that symbolizing the same code again, as with repeated traces of a crash
+// loop or of DumpWithoutCrashing(), doesn't reread /proc/self/maps and the ELF
+// sections of the module every time. The symbols are keyed by module and by
+// offset in it. The modules are found in a table of the mapped regions, parsed
+// once and again only when a pc isn't in any of them, e.g. after a library was
+// loaded.
+class SymbolCache {
+ public:
+  static SymbolCache* GetInstance() {
+    static NoDestructor<SymbolCache> instance;
+    return instance.get();
+  }
+
+  // Like google::Symbolize(), but allocates.
+  bool Symbolize(void* pc, char* out, size_t out_size) {
+    const uintptr_t address = reinterpret_cast<uintptr_t>(pc);
+    SymbolKey key;
+    {
+      AutoLock lock(lock_);
+      key = GetKey(address, false);
+      auto it = symbols_.find(key);
+      if (it == symbols_.end() && key.first.empty()) {
+        // The module may have been loaded after the regions were read.
+        key = GetKey(address, true);
+        it = symbols_.find(key);
+      }
+      if (it != symbols_.end())
+        return CopySymbol(it->second, out, out_size);
+    }
+
+    // Symbolized without the lock, since it may take tens of milliseconds.
+    char buf[1024] = {'\0'};
+    std::string symbol;
+    if (google::Symbolize(pc, buf, sizeof(buf)))
+      symbol = buf;
+
+    AutoLock lock(lock_);
+    auto result = symbols_.emplace(std::move(key), std::move(symbol));
+    return CopySymbol(result.first->second, out, out_size);
+  }
+
+ private:
+  friend class NoDestructor<SymbolCache>;
+
+  // The path of a module and an offset in it. Frames outside of any file
+  // mapping are keyed by an empty path and their address.
+  using SymbolKey = std::pair<std::string, uintptr_t>;
+
+  SymbolCache() = default;
+
+  // Returns the key of |address|, after rereading the regions if |reread|.
+  SymbolKey GetKey(uintptr_t address, bool reread) {
+    lock_.AssertAcquired();
+    if (reread || !regions_read_) {
+      std::string contents;
+      if (!ReadProcMaps(&contents) || !ParseProcMaps(contents, &regions_))
+        regions_.clear();
+      regions_read_ = true;
+    }
+
+    // /proc/self/maps lists the regions by address.
+    auto it = std::upper_bound(regions_.begin(), regions_.end(), address,
+                               [](uintptr_t address,
+                                  const MappedMemoryRegion& region) {
+                                 return address < region.end;
+                               });
+    if (it == regions_.end() || it->start > address || it->path.empty())
+      return SymbolKey(std::string(), address);
+    return SymbolKey(it->path, address - it->start + it->offset);
+  }
+
+  // An empty |symbol| is one which couldn't be found.
+  static bool CopySymbol(const std::string& symbol,
+                         char* out,
+                         size_t out_size) {
+    if (symbol.empty())
+      return false;
+    strlcpy(out, symbol.c_str(), out_size);
+    return true;
+  }
+
+  Lock lock_;
+  std::vector<MappedMemoryRegion> regions_;
+  bool regions_read_ = false;
+  std::map<SymbolKey, std::string> symbols_;
+
+  DISALLOW_COPY_AND_ASSIGN(SymbolCache);
+};
 #endif  // defined(USE_SYMBOLIZE)
 
+// |use_symbol_cache| is only set when ProcessBacktrace() needn't be
+// async-signal safe.
 void ProcessBacktrace(void *const *trace,
                       size_t size,
-                      BacktraceOutputHandler* handler) {
+                      BacktraceOutputHandler* handler,
+                      bool use_symbol_cache) {
   // NOTE: This code MUST be async-signal safe (it's used by in-process
-  // stack dumping signal handler). NO malloc or stdio is allowed here.
+  // stack dumping signal handler). NO malloc or stdio is allowed here, unless
+  // |use_symbol_cache| is set.
 
 #if defined(USE_SYMBOLIZE)
   for (size_t i = 0; i < size; ++i) {
@@ -173,7 +270,11 @@ void ProcessBacktrace(void *const *trace,
     // Subtract by one as return address of function may be in the next
     // function when a function is annotated as noreturn.
     void* address = static_cast<char*>(trace[i]) - 1;
-    if (google::Symbolize(address, buf, sizeof(buf)))
+    const bool symbolized =
+        use_symbol_cache
+            ? SymbolCache::GetInstance()->Symbolize(address, buf, sizeof(buf))
+            : google::Symbolize(address, buf, sizeof(buf));
+    if (symbolized)
       handler->HandleOutput(buf);
     else
       handler->HandleOutput("<unknown>");
@@ -817,14 +918,14 @@ void StackTrace::Print() const {
 
 #if !defined(__UCLIBC__) && !defined(_AIX)
   PrintBacktraceOutputHandler handler;
-  ProcessBacktrace(trace_, count_, &handler);
+  ProcessBacktrace(trace_, count_, &handler, false);
 #endif
 }
 
 #if !defined(__UCLIBC__) && !defined(_AIX)
 void StackTrace::OutputToStream(std::ostream* os) const {
   StreamBacktraceOutputHandler handler(os);
-  ProcessBacktrace(trace_, count_, &handler);
+  ProcessBacktrace(trace_, count_, &handler, in_signal_handler == 0);
 }
 #endif
 
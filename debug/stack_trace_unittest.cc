@@ -8,11 +8,14 @@
 #include <sstream>
 #include <string>
 
+#include "base/bind.h"
 #include "base/debug/debugging_buildflags.h"
 #include "base/debug/stack_trace.h"
 #include "base/logging.h"
 #include "base/process/kill.h"
 #include "base/process/process_handle.h"
+#include "base/run_loop.h"
+#include "base/test/scoped_task_environment.h"
 #include "base/test/test_timeouts.h"
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -151,6 +154,26 @@ TEST_F(StackTraceTest, DebugOutputToStream) {
 TEST_F(StackTraceTest, DebugPrintBacktrace) {
   StackTrace().Print();
 }
+
+TEST_F(StackTraceTest, ToStringAsync) {
+  test::ScopedTaskEnvironment scoped_task_environment;
+  StackTrace trace;
+  std::string async_string;
+  RunLoop run_loop;
+  trace.ToStringAsync(BindOnce(
+      [](std::string* async_string, OnceClosure quit_closure,
+         std::string trace_string) {
+        *async_string = std::move(trace_string);
+        std::move(quit_closure).Run();
+      },
+      &async_string, run_loop.QuitClosure()));
+  run_loop.Run();
+
+  // Symbolizing the trace again may use the cached symbols, which must not
+  // change the output.
+  EXPECT_FALSE(async_string.empty());
+  EXPECT_EQ(trace.ToString(), async_string);
+}
 #endif  // !defined(__UCLIBC__)
 
 #if defined(OS_POSIX) && !defined(OS_ANDROID) && !defined(OS_FUCHSIA)
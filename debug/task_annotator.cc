@@ -4,10 +4,14 @@
 
 #include "base/debug/task_annotator.h"
 
+#include <algorithm>
 #include <array>
 
 #include "base/debug/activity_tracker.h"
+#include "base/compiler_specific.h"
 #include "base/debug/alias.h"
+#include "base/debug/task_time_tracker.h"
+#include "base/debug/thread_heap_usage_tracker.h"
 #include "base/no_destructor.h"
 #include "base/pending_task.h"
 #include "base/threading/thread_local.h"
@@ -37,6 +41,9 @@ TaskAnnotator::~TaskAnnotator() = default;
 
 void TaskAnnotator::DidQueueTask(const char* queue_function,
                                  const PendingTask& pending_task) {
+  if (UNLIKELY(TaskTimeTracker::IsEnabled()))
+    pending_task.queue_time = TimeTicks::Now();
+
   if (queue_function) {
     TRACE_EVENT_WITH_FLOW0(TRACE_DISABLED_BY_DEFAULT("toplevel.flow"),
                            queue_function,
@@ -46,13 +53,12 @@ void TaskAnnotator::DidQueueTask(const char* queue_function,
 
   // TODO(https://crbug.com/826902): Fix callers that invoke DidQueueTask()
   // twice for the same PendingTask.
-  // DCHECK(!pending_task.task_backtrace[0])
+  // DCHECK(!pending_task.task_backtrace[0].id())
   //     << "Task backtrace was already set, task posted twice??";
-  if (!pending_task.task_backtrace[0]) {
+  if (!pending_task.task_backtrace[0].id()) {
     const PendingTask* parent_task = GetTLSForCurrentPendingTask()->Get();
     if (parent_task) {
-      pending_task.task_backtrace[0] =
-          parent_task->posted_from.program_counter();
+      pending_task.task_backtrace[0] = parent_task->posted_from;
       std::copy(parent_task->task_backtrace.begin(),
                 parent_task->task_backtrace.end() - 1,
                 pending_task.task_backtrace.begin() + 1);
@@ -86,8 +92,11 @@ void TaskAnnotator::RunTask(const char* queue_function,
   task_backtrace.back() = reinterpret_cast<void*>(0xfefefefefefefefe);
 
   task_backtrace[1] = pending_task->posted_from.program_counter();
-  std::copy(pending_task->task_backtrace.begin(),
-            pending_task->task_backtrace.end(), task_backtrace.begin() + 2);
+  std::transform(pending_task->task_backtrace.begin(),
+                 pending_task->task_backtrace.end(), task_backtrace.begin() + 2,
+                 [](const Location& location) {
+                   return location.program_counter();
+                 });
   debug::Alias(&task_backtrace);
 
   ThreadLocalPointer<const PendingTask>* tls_for_current_pending_task =
@@ -98,7 +107,18 @@ void TaskAnnotator::RunTask(const char* queue_function,
 
   if (g_task_annotator_observer)
     g_task_annotator_observer->BeforeRunTask(pending_task);
-  std::move(pending_task->task).Run();
+
+  TaskTimeTracker::ScopedTaskTimer task_timer(*pending_task);
+  if (UNLIKELY(ThreadHeapUsageTracker::IsTaskAttributionEnabled())) {
+    ThreadHeapUsageTracker heap_usage_tracker;
+    heap_usage_tracker.Start();
+    std::move(pending_task->task).Run();
+    heap_usage_tracker.Stop(false);
+    ThreadHeapUsageTracker::RecordTaskUsage(pending_task->posted_from,
+                                            heap_usage_tracker.usage());
+  } else {
+    std::move(pending_task->task).Run();
+  }
 
   tls_for_current_pending_task->Set(previous_pending_task);
 }
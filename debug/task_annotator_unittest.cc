@@ -80,9 +80,9 @@ class TaskAnnotatorBacktraceIntegrationTest
     for (size_t i = 0; i < last_task_backtrace_.size(); i++) {
       SCOPED_TRACE(StringPrintf("Trace frame: %zu", i));
       if (i < expected_trace.size())
-        EXPECT_EQ(expected_trace[i], last_task_backtrace_[i]);
+        EXPECT_EQ(expected_trace[i], last_task_backtrace_[i].program_counter());
       else
-        EXPECT_EQ(nullptr, last_task_backtrace_[i]);
+        EXPECT_EQ(nullptr, last_task_backtrace_[i].program_counter());
     }
 
     task_runner->PostTask(next_from_here, std::move(task));
@@ -127,7 +127,7 @@ class TaskAnnotatorBacktraceIntegrationTest
   Lock on_before_run_task_lock_;
 
   Location last_posted_from_ = {};
-  std::array<const void*, 4> last_task_backtrace_ = {};
+  std::array<Location, 4> last_task_backtrace_ = {};
 
   DISALLOW_COPY_AND_ASSIGN(TaskAnnotatorBacktraceIntegrationTest);
 };
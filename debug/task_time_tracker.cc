@@ -0,0 +1,190 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/task_time_tracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+
+#include "base/compiler_specific.h"
+#include "base/macros.h"
+#include "base/no_destructor.h"
+#include "base/pending_task.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+using LocationStats = TaskTimeTracker::LocationStats;
+using StatsMap = std::unordered_map<Location, LocationStats>;
+
+CONSTINIT std::atomic<bool> g_enabled{false};
+
+void AddStats(const LocationStats& stats, LocationStats* totals) {
+  totals->posted_from = stats.posted_from;
+  totals->task_count += stats.task_count;
+  totals->total_wall_time += stats.total_wall_time;
+  totals->max_wall_time = std::max(totals->max_wall_time, stats.max_wall_time);
+  totals->total_cpu_time += stats.total_cpu_time;
+  totals->total_queueing_time += stats.total_queueing_time;
+  totals->max_queueing_time =
+      std::max(totals->max_queueing_time, stats.max_queueing_time);
+}
+
+// The stats merged from all the threads.
+class Report {
+ public:
+  Report() = default;
+
+  void Merge(StatsMap* thread_stats) {
+    AutoLock lock(lock_);
+    for (const auto& entry : *thread_stats)
+      AddStats(entry.second, &stats_[entry.first]);
+    thread_stats->clear();
+  }
+
+  std::vector<LocationStats> Get() {
+    std::vector<LocationStats> report;
+    {
+      AutoLock lock(lock_);
+      report.reserve(stats_.size());
+      for (const auto& entry : stats_)
+        report.push_back(entry.second);
+    }
+    std::sort(report.begin(), report.end(),
+              [](const LocationStats& a, const LocationStats& b) {
+                return a.total_wall_time > b.total_wall_time;
+              });
+    return report;
+  }
+
+  void Clear() {
+    AutoLock lock(lock_);
+    stats_.clear();
+  }
+
+ private:
+  Lock lock_;
+  StatsMap stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(Report);
+};
+
+Report& GetMergedReport() {
+  static NoDestructor<Report> report;
+  return *report;
+}
+
+// The stats of the tasks run by a thread since its last merge. Only touched by
+// that thread.
+struct ThreadTable {
+  StatsMap stats;
+  TimeTicks last_merge_time;
+};
+
+ThreadLocalStorage::Slot& GetThreadTableTLS() {
+  static NoDestructor<ThreadLocalStorage::Slot> thread_table_tls(
+      [](void* thread_table) {
+        // Merges what's left of an exiting thread.
+        ThreadTable* table = static_cast<ThreadTable*>(thread_table);
+        GetMergedReport().Merge(&table->stats);
+        delete table;
+      });
+  return *thread_table_tls;
+}
+
+ThreadTable* GetOrCreateThreadTable() {
+  ThreadTable* table = static_cast<ThreadTable*>(GetThreadTableTLS().Get());
+  if (!table) {
+    table = new ThreadTable;
+    table->last_merge_time = TimeTicks::Now();
+    GetThreadTableTLS().Set(table);
+  }
+  return table;
+}
+
+}  // namespace
+
+TaskTimeTracker::ScopedTaskTimer::ScopedTaskTimer(
+    const PendingTask& pending_task) {
+  if (!IsEnabled())
+    return;
+  pending_task_ = &pending_task;
+  start_time_ = TimeTicks::Now();
+  if (ThreadTicks::IsSupported())
+    start_thread_time_ = ThreadTicks::Now();
+}
+
+TaskTimeTracker::ScopedTaskTimer::~ScopedTaskTimer() {
+  if (!pending_task_)
+    return;
+  const TimeTicks end_time = TimeTicks::Now();
+
+  LocationStats task_stats;
+  task_stats.posted_from = pending_task_->posted_from;
+  task_stats.task_count = 1;
+  task_stats.total_wall_time = end_time - start_time_;
+  task_stats.max_wall_time = task_stats.total_wall_time;
+  if (ThreadTicks::IsSupported())
+    task_stats.total_cpu_time = ThreadTicks::Now() - start_thread_time_;
+  if (!pending_task_->queue_time.is_null()) {
+    const TimeTicks ready_time =
+        std::max(pending_task_->queue_time, pending_task_->delayed_run_time);
+    task_stats.total_queueing_time =
+        std::max(TimeDelta(), start_time_ - ready_time);
+    task_stats.max_queueing_time = task_stats.total_queueing_time;
+  }
+
+  ThreadTable* table = GetOrCreateThreadTable();
+  AddStats(task_stats, &table->stats[task_stats.posted_from]);
+  if (end_time - table->last_merge_time >= kMergeInterval) {
+    GetMergedReport().Merge(&table->stats);
+    table->last_merge_time = end_time;
+  }
+}
+
+// static
+constexpr TimeDelta TaskTimeTracker::kMergeInterval;
+
+// static
+void TaskTimeTracker::Enable() {
+  g_enabled.store(true, std::memory_order_relaxed);
+}
+
+// static
+bool TaskTimeTracker::IsEnabled() {
+  return g_enabled.load(std::memory_order_relaxed);
+}
+
+// static
+std::vector<LocationStats> TaskTimeTracker::GetReport() {
+  return GetMergedReport().Get();
+}
+
+// static
+void TaskTimeTracker::MergeCurrentThread() {
+  ThreadTable* table = static_cast<ThreadTable*>(GetThreadTableTLS().Get());
+  if (!table)
+    return;
+  GetMergedReport().Merge(&table->stats);
+  table->last_merge_time = TimeTicks::Now();
+}
+
+// static
+void TaskTimeTracker::ResetForTesting() {
+  g_enabled.store(false, std::memory_order_relaxed);
+  ThreadTable* table = static_cast<ThreadTable*>(GetThreadTableTLS().Get());
+  if (table) {
+    table->stats.clear();
+    table->last_merge_time = TimeTicks::Now();
+  }
+  GetMergedReport().Clear();
+}
+
+}  // namespace debug
+}  // namespace base
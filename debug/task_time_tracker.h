@@ -0,0 +1,90 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_DEBUG_TASK_TIME_TRACKER_H_
+#define BASE_DEBUG_TASK_TIME_TRACKER_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/location.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+
+namespace base {
+struct PendingTask;
+namespace debug {
+
+// Opt-in accounting of the cost of the tasks run by TaskAnnotator, aggregated
+// by the location they were posted from. This is like the old tracked_objects,
+// but cheap enough to leave enabled: each thread adds the tasks it runs to a
+// table which only it touches, and merges that table into the global report
+// after a task once |kMergeInterval| has elapsed since its last merge, and
+// when it exits. The report can thus lag behind by up to |kMergeInterval|
+// for each thread.
+class BASE_EXPORT TaskTimeTracker {
+ public:
+  // The cost of the tasks posted from one location.
+  struct BASE_EXPORT LocationStats {
+    Location posted_from;
+    int64_t task_count = 0;
+
+    // The times of a task include those of the tasks run in nested loops
+    // inside it.
+    TimeDelta total_wall_time;
+    TimeDelta max_wall_time;
+
+    // The CPU time of the thread while running the tasks. Zero where
+    // ThreadTicks aren't supported.
+    TimeDelta total_cpu_time;
+
+    // From the time when a task was posted, or its delayed run time if it's
+    // later, to the time when it started running. Tasks posted before the
+    // tracker was enabled don't count.
+    TimeDelta total_queueing_time;
+    TimeDelta max_queueing_time;
+  };
+
+  // Times the task run in its scope, if the tracker is enabled.
+  class BASE_EXPORT ScopedTaskTimer {
+   public:
+    explicit ScopedTaskTimer(const PendingTask& pending_task);
+    ~ScopedTaskTimer();
+
+   private:
+    // Null if the tracker was disabled when the task started.
+    const PendingTask* pending_task_ = nullptr;
+    TimeTicks start_time_;
+    ThreadTicks start_thread_time_;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedTaskTimer);
+  };
+
+  static constexpr TimeDelta kMergeInterval = TimeDelta::FromSeconds(1);
+
+  // Starts accounting for the tasks which run from now on.
+  static void Enable();
+  static bool IsEnabled();
+
+  // Returns the stats merged so far, the location with the most wall time
+  // first.
+  static std::vector<LocationStats> GetReport();
+
+  // Merges the table of the current thread into the report right away.
+  static void MergeCurrentThread();
+
+  // Disables the tracker, forgets the report and resets the table of the
+  // current thread. The tables of other threads must be empty.
+  static void ResetForTesting();
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(TaskTimeTracker);
+};
+
+}  // namespace debug
+}  // namespace base
+
+#endif  // BASE_DEBUG_TASK_TIME_TRACKER_H_
@@ -0,0 +1,111 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/task_time_tracker.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/debug/task_annotator.h"
+#include "base/location.h"
+#include "base/pending_task.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+constexpr TimeDelta kTaskDuration = TimeDelta::FromMilliseconds(5);
+
+void BusyTask() {
+  const TimeTicks end = TimeTicks::Now() + kTaskDuration;
+  while (TimeTicks::Now() < end) {
+  }
+}
+
+class TaskTimeTrackerTest : public testing::Test {
+ protected:
+  TaskTimeTrackerTest() { TaskTimeTracker::Enable(); }
+  ~TaskTimeTrackerTest() override { TaskTimeTracker::ResetForTesting(); }
+
+  void QueueAndRunTask(const Location& posted_from, TimeDelta queueing_time) {
+    PendingTask pending_task(posted_from, BindOnce(&BusyTask));
+    annotator_.DidQueueTask(nullptr, pending_task);
+    PlatformThread::Sleep(queueing_time);
+    annotator_.RunTask(nullptr, &pending_task);
+  }
+
+  TaskAnnotator annotator_;
+};
+
+}  // namespace
+
+TEST_F(TaskTimeTrackerTest, AggregatesByLocation) {
+  const Location kFirstLocation = FROM_HERE;
+  const Location kSecondLocation = FROM_HERE;
+  const TimeDelta kQueueingTime = TimeDelta::FromMilliseconds(10);
+  QueueAndRunTask(kFirstLocation, TimeDelta());
+  QueueAndRunTask(kFirstLocation, kQueueingTime);
+  QueueAndRunTask(kSecondLocation, TimeDelta());
+
+  TaskTimeTracker::MergeCurrentThread();
+  std::vector<TaskTimeTracker::LocationStats> report =
+      TaskTimeTracker::GetReport();
+  ASSERT_EQ(2U, report.size());
+
+  EXPECT_EQ(kFirstLocation, report[0].posted_from);
+  EXPECT_EQ(2, report[0].task_count);
+  EXPECT_GE(report[0].total_wall_time, 2 * kTaskDuration);
+  EXPECT_GE(report[0].max_wall_time, kTaskDuration);
+  EXPECT_LE(report[0].max_wall_time, report[0].total_wall_time);
+  if (ThreadTicks::IsSupported())
+    EXPECT_GT(report[0].total_cpu_time, TimeDelta());
+  EXPECT_GE(report[0].total_queueing_time, kQueueingTime);
+  EXPECT_GE(report[0].max_queueing_time, kQueueingTime);
+
+  EXPECT_EQ(kSecondLocation, report[1].posted_from);
+  EXPECT_EQ(1, report[1].task_count);
+  EXPECT_GE(report[1].total_wall_time, kTaskDuration);
+}
+
+TEST_F(TaskTimeTrackerTest, NotMergedBeforeInterval) {
+  QueueAndRunTask(FROM_HERE, TimeDelta());
+  // The table of this thread was just created, or reset by a previous test.
+  EXPECT_TRUE(TaskTimeTracker::GetReport().empty());
+
+  TaskTimeTracker::MergeCurrentThread();
+  EXPECT_EQ(1U, TaskTimeTracker::GetReport().size());
+}
+
+TEST_F(TaskTimeTrackerTest, DisabledTasksAreNotTracked) {
+  TaskTimeTracker::ResetForTesting();
+  QueueAndRunTask(FROM_HERE, TimeDelta());
+  TaskTimeTracker::MergeCurrentThread();
+  EXPECT_TRUE(TaskTimeTracker::GetReport().empty());
+}
+
+TEST_F(TaskTimeTrackerTest, MergedWhenThreadExits) {
+  Thread thread("TaskTimeTrackerTest");
+  ASSERT_TRUE(thread.Start());
+  const Location kLocation = FROM_HERE;
+  thread.task_runner()->PostTask(kLocation, BindOnce(&BusyTask));
+  thread.Stop();
+
+  // The report also has the task which quit the thread.
+  std::vector<TaskTimeTracker::LocationStats> report =
+      TaskTimeTracker::GetReport();
+  auto it = std::find_if(report.begin(), report.end(),
+                         [&](const TaskTimeTracker::LocationStats& stats) {
+                           return stats.posted_from == kLocation;
+                         });
+  ASSERT_NE(report.end(), it);
+  EXPECT_EQ(1, it->task_count);
+}
+
+}  // namespace debug
+}  // namespace base
@@ -9,11 +9,14 @@
 #include <limits>
 #include <new>
 #include <type_traits>
+#include <unordered_map>
 
 #include "base/allocator/allocator_shim.h"
 #include "base/allocator/buildflags.h"
 #include "base/logging.h"
+#include "base/macros.h"
 #include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
 #include "base/threading/thread_local_storage.h"
 #include "build/build_config.h"
 
@@ -59,6 +62,57 @@ ThreadLocalStorage::Slot& ThreadAllocationUsage() {
 }
 
 bool g_heap_tracking_enabled = false;
+bool g_task_attribution_enabled = false;
+
+// The heap usage of the tasks run, per posting location.
+class TaskUsageTable {
+ public:
+  TaskUsageTable() = default;
+
+  void Add(const Location& posted_from, const ThreadHeapUsage& usage) {
+    AutoLock lock(lock_);
+    TaskHeapUsage& totals = usage_by_location_[posted_from];
+    totals.posted_from = posted_from;
+    totals.task_count++;
+    totals.alloc_ops += usage.alloc_ops;
+    totals.alloc_bytes += usage.alloc_bytes;
+    totals.free_ops += usage.free_ops;
+    totals.free_bytes += usage.free_bytes;
+    totals.max_allocated_bytes =
+        std::max(totals.max_allocated_bytes, usage.max_allocated_bytes);
+  }
+
+  std::vector<TaskHeapUsage> Get() {
+    std::vector<TaskHeapUsage> usage;
+    {
+      AutoLock lock(lock_);
+      usage.reserve(usage_by_location_.size());
+      for (const auto& entry : usage_by_location_)
+        usage.push_back(entry.second);
+    }
+    std::sort(usage.begin(), usage.end(),
+              [](const TaskHeapUsage& a, const TaskHeapUsage& b) {
+                return a.alloc_bytes > b.alloc_bytes;
+              });
+    return usage;
+  }
+
+  void Clear() {
+    AutoLock lock(lock_);
+    usage_by_location_.clear();
+  }
+
+ private:
+  Lock lock_;
+  std::unordered_map<Location, TaskHeapUsage> usage_by_location_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskUsageTable);
+};
+
+TaskUsageTable& GetTaskUsageTable() {
+  static NoDestructor<TaskUsageTable> task_usage_table;
+  return *task_usage_table;
+}
 
 // Forward declared as it needs to delegate memory allocation to the next
 // lower shim.
@@ -327,6 +381,33 @@ void ThreadHeapUsageTracker::DisableHeapTrackingForTesting() {
   g_heap_tracking_enabled = false;
 }
 
+// static
+void ThreadHeapUsageTracker::EnableTaskAttribution() {
+  g_task_attribution_enabled = true;
+}
+
+// static
+bool ThreadHeapUsageTracker::IsTaskAttributionEnabled() {
+  return g_task_attribution_enabled;
+}
+
+// static
+void ThreadHeapUsageTracker::RecordTaskUsage(const Location& posted_from,
+                                             const ThreadHeapUsage& usage) {
+  GetTaskUsageTable().Add(posted_from, usage);
+}
+
+// static
+std::vector<TaskHeapUsage> ThreadHeapUsageTracker::GetTaskUsageByLocation() {
+  return GetTaskUsageTable().Get();
+}
+
+// static
+void ThreadHeapUsageTracker::DisableTaskAttributionForTesting() {
+  g_task_attribution_enabled = false;
+  GetTaskUsageTable().Clear();
+}
+
 base::allocator::AllocatorDispatch*
 ThreadHeapUsageTracker::GetDispatchForTesting() {
   return &allocator_dispatch;
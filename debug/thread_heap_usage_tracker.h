@@ -7,8 +7,11 @@
 
 #include <stdint.h>
 
+#include <vector>
+
 #include "base/allocator/buildflags.h"
 #include "base/base_export.h"
+#include "base/location.h"
 #include "base/threading/thread_checker.h"
 
 namespace base {
@@ -44,6 +47,24 @@ struct ThreadHeapUsage {
   uint64_t max_allocated_bytes;
 };
 
+// The heap usage of all the tasks posted from one location, see
+// ThreadHeapUsageTracker::EnableTaskAttribution().
+struct BASE_EXPORT TaskHeapUsage {
+  Location posted_from;
+
+  // The number of tasks run.
+  uint64_t task_count = 0;
+
+  // The sums of the ThreadHeapUsage fields of the tasks.
+  uint64_t alloc_ops = 0;
+  uint64_t alloc_bytes = 0;
+  uint64_t free_ops = 0;
+  uint64_t free_bytes = 0;
+
+  // The largest ThreadHeapUsage::max_allocated_bytes of a single task.
+  uint64_t max_allocated_bytes = 0;
+};
+
 // By keeping a tally on heap operations, it's possible to track:
 // - the number of alloc/free operations, where a realloc is zero or one
 //   of each, depending on the input parameters (see man realloc).
@@ -89,11 +110,33 @@ class BASE_EXPORT ThreadHeapUsageTracker {
   // Returns true iff heap tracking is enabled.
   static bool IsHeapTrackingEnabled();
 
+  // Enables attributing the heap usage of each task run by a TaskAnnotator to
+  // the location it was posted from. This only costs a tracker scope per task,
+  // nothing per heap operation. The usage of a task includes that of the tasks
+  // run in nested loops inside it. Only meaningful once EnableHeapTracking()
+  // was called.
+  static void EnableTaskAttribution();
+
+  // Returns true iff task attribution is enabled.
+  static bool IsTaskAttributionEnabled();
+
+  // Adds |usage|, the heap usage of a task, to the totals of |posted_from|.
+  // Called by TaskAnnotator after each task, when task attribution is enabled.
+  static void RecordTaskUsage(const Location& posted_from,
+                              const ThreadHeapUsage& usage);
+
+  // Returns the heap usage of the tasks run so far, per posting location, the
+  // location with the most allocated bytes first.
+  static std::vector<TaskHeapUsage> GetTaskUsageByLocation();
+
  protected:
   // Exposed for testing only - note that it's safe to re-EnableHeapTracking()
   // after calling this function in tests.
   static void DisableHeapTrackingForTesting();
 
+  // Exposed for testing only. Also forgets the usage recorded per location.
+  static void DisableTaskAttributionForTesting();
+
   // Exposed for testing only.
   static void EnsureTLSInitialized();
 
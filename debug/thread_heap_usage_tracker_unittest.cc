@@ -8,6 +8,9 @@
 
 #include "base/allocator/allocator_shim.h"
 #include "base/allocator/buildflags.h"
+#include "base/bind.h"
+#include "base/debug/task_annotator.h"
+#include "base/pending_task.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 #if defined(OS_MACOSX)
@@ -22,6 +25,7 @@ namespace {
 class TestingThreadHeapUsageTracker : public ThreadHeapUsageTracker {
  public:
   using ThreadHeapUsageTracker::DisableHeapTrackingForTesting;
+  using ThreadHeapUsageTracker::DisableTaskAttributionForTesting;
   using ThreadHeapUsageTracker::EnsureTLSInitialized;
   using ThreadHeapUsageTracker::GetDispatchForTesting;
 };
@@ -100,6 +104,8 @@ class ThreadHeapUsageTrackerTest : public testing::Test {
         dispatch_under_test_, address, nullptr);
   }
 
+  void MockMallocAndFree(size_t size) { MockFree(MockMalloc(size)); }
+
  private:
   void RecordAlloc(void* address, size_t size) {
     if (address != nullptr)
@@ -531,6 +537,49 @@ TEST_F(ThreadHeapUsageTrackerTest, ExclusiveScopesWork) {
   EXPECT_EQ(usage.max_allocated_bytes, current.max_allocated_bytes);
 }
 
+TEST_F(ThreadHeapUsageTrackerTest, TaskAttribution) {
+  ThreadHeapUsageTracker::EnableTaskAttribution();
+
+  const Location kSmallTaskLocation = FROM_HERE;
+  const Location kLargeTaskLocation = FROM_HERE;
+  const size_t kSmallAllocSize = 100U;
+  const size_t kLargeAllocSize = 1000U;
+  TaskAnnotator annotator;
+  for (int i = 0; i < 2; ++i) {
+    PendingTask small_task(
+        kSmallTaskLocation,
+        BindOnce(&ThreadHeapUsageTrackerTest::MockMallocAndFree,
+                 Unretained(this), kSmallAllocSize));
+    annotator.RunTask(nullptr, &small_task);
+  }
+  PendingTask large_task(
+      kLargeTaskLocation,
+      BindOnce(&ThreadHeapUsageTrackerTest::MockMallocAndFree,
+               Unretained(this), kLargeAllocSize));
+  annotator.RunTask(nullptr, &large_task);
+
+  std::vector<TaskHeapUsage> usage =
+      ThreadHeapUsageTracker::GetTaskUsageByLocation();
+  ASSERT_EQ(2U, usage.size());
+
+  EXPECT_EQ(kLargeTaskLocation, usage[0].posted_from);
+  EXPECT_EQ(1U, usage[0].task_count);
+  EXPECT_EQ(1U, usage[0].alloc_ops);
+  EXPECT_EQ(kLargeAllocSize, usage[0].alloc_bytes);
+  EXPECT_EQ(1U, usage[0].free_ops);
+  EXPECT_EQ(kLargeAllocSize, usage[0].free_bytes);
+  EXPECT_EQ(kLargeAllocSize, usage[0].max_allocated_bytes);
+
+  EXPECT_EQ(kSmallTaskLocation, usage[1].posted_from);
+  EXPECT_EQ(2U, usage[1].task_count);
+  EXPECT_EQ(2U, usage[1].alloc_ops);
+  EXPECT_EQ(2 * kSmallAllocSize, usage[1].alloc_bytes);
+  EXPECT_EQ(kSmallAllocSize, usage[1].max_allocated_bytes);
+
+  TestingThreadHeapUsageTracker::DisableTaskAttributionForTesting();
+  EXPECT_TRUE(ThreadHeapUsageTracker::GetTaskUsageByLocation().empty());
+}
+
 TEST_F(ThreadHeapUsageTrackerTest, AllShimFunctionsAreProvided) {
   const size_t kAllocSize = 100;
   void* alloc = MockMalloc(kAllocSize);
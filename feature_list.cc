@@ -28,6 +28,25 @@ FeatureList* g_feature_list_instance = nullptr;
 // Tracks whether the FeatureList instance was initialized via an accessor.
 bool g_initialized_from_accessor = false;
 
+// Generation of |g_feature_list_instance|, which tags the states cached in the
+// Feature structs. It is bumped whenever the instance changes, which
+// invalidates them. Never 0, so that the zero-initialized caches don't match.
+std::atomic<uint32_t> g_feature_list_generation{1};
+
+// A cached state holds the generation in the upper bits and whether the
+// feature is enabled in the lowest one.
+constexpr uint32_t kCachedStateEnabled = 1;
+constexpr int kCachedStateGenerationShift = 1;
+
+void InvalidateCachedFeatureStates() {
+  uint32_t generation =
+      g_feature_list_generation.load(std::memory_order_relaxed) + 1;
+  // Skip 0 once the generation wraps around.
+  if (!(generation << kCachedStateGenerationShift))
+    generation = 1;
+  g_feature_list_generation.store(generation, std::memory_order_release);
+}
+
 // An allocator entry for a feature in shared memory. The FeatureEntry is
 // followed by a base::Pickle object that contains the feature and trial name.
 struct FeatureEntry {
@@ -113,8 +132,11 @@ void FeatureList::InitializeFromSharedMemory(
     if (!entry->GetFeatureAndTrialName(&feature_name, &trial_name))
       continue;
 
-    FieldTrial* trial = FieldTrialList::Find(trial_name.as_string());
-    RegisterOverride(feature_name, override_state, trial);
+    // Note: The semantics of insert() is that it does not overwrite the entry
+    // if one already exists for the key, as in RegisterOverride().
+    overrides_.insert(std::make_pair(
+        feature_name.as_string(),
+        OverrideEntry(override_state, trial_name.as_string())));
   }
 }
 
@@ -166,8 +188,8 @@ void FeatureList::AddFeaturesToAllocator(PersistentMemoryAllocator* allocator) {
   for (const auto& override : overrides_) {
     Pickle pickle;
     pickle.WriteString(override.first);
-    if (override.second.field_trial)
-      pickle.WriteString(override.second.field_trial->trial_name());
+    if (!override.second.GetFieldTrialName().empty())
+      pickle.WriteString(override.second.GetFieldTrialName());
 
     size_t total_size = sizeof(FeatureEntry) + pickle.size();
     FeatureEntry* entry = allocator->New<FeatureEntry>(total_size);
@@ -201,7 +223,20 @@ bool FeatureList::IsEnabled(const Feature& feature) {
     g_initialized_from_accessor = true;
     return feature.default_state == FEATURE_ENABLED_BY_DEFAULT;
   }
-  return g_feature_list_instance->IsFeatureEnabled(feature);
+
+  uint32_t generation =
+      g_feature_list_generation.load(std::memory_order_acquire)
+      << kCachedStateGenerationShift;
+  uint32_t cached_state = feature.cached_state.load(std::memory_order_relaxed);
+  if ((cached_state & ~kCachedStateEnabled) == generation)
+    return cached_state & kCachedStateEnabled;
+
+  // Resolving the state activates the associated field trial, if any, so this
+  // only happens once per feature. Racing threads store the same value.
+  bool enabled = g_feature_list_instance->IsFeatureEnabled(feature);
+  feature.cached_state.store(generation | (enabled ? kCachedStateEnabled : 0),
+                             std::memory_order_relaxed);
+  return enabled;
 }
 
 // static
@@ -262,6 +297,7 @@ void FeatureList::SetInstance(std::unique_ptr<FeatureList> instance) {
 
   // Note: Intentional leak of global singleton.
   g_feature_list_instance = instance.release();
+  InvalidateCachedFeatureStates();
 
 #if DCHECK_IS_CONFIGURABLE
   // Update the behaviour of LOG_DCHECK to match the Feature configuration.
@@ -283,6 +319,7 @@ std::unique_ptr<FeatureList> FeatureList::ClearInstanceForTesting() {
   FeatureList* old_instance = g_feature_list_instance;
   g_feature_list_instance = nullptr;
   g_initialized_from_accessor = false;
+  InvalidateCachedFeatureStates();
   return base::WrapUnique(old_instance);
 }
 
@@ -292,6 +329,7 @@ void FeatureList::RestoreInstanceForTesting(
   DCHECK(!g_feature_list_instance);
   // Note: Intentional leak of global singleton.
   g_feature_list_instance = instance.release();
+  InvalidateCachedFeatureStates();
 }
 
 void FeatureList::FinalizeInitialization() {
@@ -309,8 +347,8 @@ bool FeatureList::IsFeatureEnabled(const Feature& feature) {
     const OverrideEntry& entry = it->second;
 
     // Activate the corresponding field trial, if necessary.
-    if (entry.field_trial)
-      entry.field_trial->group();
+    if (FieldTrial* field_trial = entry.GetFieldTrial())
+      field_trial->group();
 
     // TODO(asvitkine) Expand this section as more support is added.
 
@@ -330,7 +368,7 @@ FieldTrial* FeatureList::GetAssociatedFieldTrial(const Feature& feature) {
   auto it = overrides_.find(feature.name);
   if (it != overrides_.end()) {
     const OverrideEntry& entry = it->second;
-    return entry.field_trial;
+    return entry.GetFieldTrial();
   }
 
   return nullptr;
@@ -388,7 +426,7 @@ void FeatureList::GetFeatureOverridesImpl(std::string* enable_overrides,
   // tests to assume the order.
   for (const auto& entry : overrides_) {
     if (command_line_only &&
-        (entry.second.field_trial != nullptr ||
+        (!entry.second.GetFieldTrialName().empty() ||
          entry.second.overridden_state == OVERRIDE_USE_DEFAULT)) {
       continue;
     }
@@ -409,9 +447,9 @@ void FeatureList::GetFeatureOverridesImpl(std::string* enable_overrides,
     if (entry.second.overridden_state == OVERRIDE_USE_DEFAULT)
       target_list->push_back('*');
     target_list->append(entry.first);
-    if (entry.second.field_trial) {
+    if (!entry.second.GetFieldTrialName().empty()) {
       target_list->push_back('<');
-      target_list->append(entry.second.field_trial->trial_name());
+      target_list->append(entry.second.GetFieldTrialName());
     }
   }
 }
@@ -435,4 +473,21 @@ FeatureList::OverrideEntry::OverrideEntry(OverrideState overridden_state,
       field_trial(field_trial),
       overridden_by_field_trial(field_trial != nullptr) {}
 
+FeatureList::OverrideEntry::OverrideEntry(OverrideState overridden_state,
+                                          const std::string& field_trial_name)
+    : overridden_state(overridden_state),
+      field_trial(nullptr),
+      field_trial_name(field_trial_name),
+      overridden_by_field_trial(!field_trial_name.empty()) {}
+
+FieldTrial* FeatureList::OverrideEntry::GetFieldTrial() const {
+  if (field_trial || field_trial_name.empty())
+    return field_trial;
+  return FieldTrialList::Find(field_trial_name);
+}
+
+const std::string& FeatureList::OverrideEntry::GetFieldTrialName() const {
+  return field_trial ? field_trial->trial_name() : field_trial_name;
+}
+
 }  // namespace base
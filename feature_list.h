@@ -5,6 +5,9 @@
 #ifndef BASE_FEATURE_LIST_H_
 #define BASE_FEATURE_LIST_H_
 
+#include <stdint.h>
+
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -41,6 +44,12 @@ struct BASE_EXPORT Feature {
 
   // The default state (i.e. enabled or disabled) for this feature.
   const FeatureState default_state;
+
+  // The state resolved by the FeatureList singleton the first time this
+  // feature was checked, tagged with the generation of the singleton, so that
+  // later checks are a single atomic load. Used only by FeatureList; it is left
+  // out of the initializer and so starts at 0, which matches no generation.
+  mutable std::atomic<uint32_t> cached_state;
 };
 
 #if DCHECK_IS_CONFIGURABLE
@@ -109,7 +118,9 @@ class BASE_EXPORT FeatureList {
 
   // Initializes feature overrides through the field trial allocator, which
   // we're using to store the feature names, their override state, and the name
-  // of the associated field trial.
+  // of the associated field trial. The field trials are only looked up when
+  // their features are queried, so that FieldTrialList doesn't create them at
+  // startup.
   void InitializeFromSharedMemory(PersistentMemoryAllocator* allocator);
 
   // Specifies whether a feature override enables or disables the feature.
@@ -166,7 +177,10 @@ class BASE_EXPORT FeatureList {
   // Returns whether the given |feature| is enabled. Must only be called after
   // the singleton instance has been registered via SetInstance(). Additionally,
   // a feature with a given name must only have a single corresponding Feature
-  // struct, which is checked in builds with DCHECKs enabled.
+  // struct, which is checked in builds with DCHECKs enabled. The state is
+  // resolved, and its field trial activated, on the first call for a given
+  // singleton; the following calls read it back from |feature| without
+  // locking.
   static bool IsEnabled(const Feature& feature);
 
   // Returns the field trial associated with the given |feature|. Must only be
@@ -213,6 +227,8 @@ class BASE_EXPORT FeatureList {
                            StoreAndRetrieveFeaturesFromSharedMemory);
   FRIEND_TEST_ALL_PREFIXES(FeatureListTest,
                            StoreAndRetrieveAssociatedFeaturesFromSharedMemory);
+  FRIEND_TEST_ALL_PREFIXES(FeatureListTest,
+                           LookUpAssociatedFieldTrialFromSharedMemoryLazily);
 
   struct OverrideEntry {
     // The overridden enable (on/off) state of the feature.
@@ -223,6 +239,10 @@ class BASE_EXPORT FeatureList {
     // FieldTrial object that is owned by the FieldTrialList singleton.
     base::FieldTrial* field_trial;
 
+    // The name of the associated field trial, if it's looked up lazily, in
+    // which case |field_trial| is null.
+    const std::string field_trial_name;
+
     // Specifies whether the feature's state is overridden by |field_trial|.
     // If it's not, and |field_trial| is not null, it means it is simply an
     // associated field trial for reporting purposes (and |overridden_state|
@@ -235,6 +255,18 @@ class BASE_EXPORT FeatureList {
     // |field_trial| is not null, it implies that |overridden_state| comes from
     // the trial, so |overridden_by_field_trial| will be set to true.
     OverrideEntry(OverrideState overridden_state, FieldTrial* field_trial);
+
+    // Same, with a field trial that is looked up by name when needed, if
+    // |field_trial_name| isn't empty.
+    OverrideEntry(OverrideState overridden_state,
+                  const std::string& field_trial_name);
+
+    // Returns the associated field trial, which may be looked up by name.
+    FieldTrial* GetFieldTrial() const;
+
+    // Returns the name of the associated field trial, or an empty string if
+    // there is none.
+    const std::string& GetFieldTrialName() const;
   };
 
   // Finalizes the initialization state of the FeatureList, so that no further
@@ -475,6 +475,29 @@ TEST_F(FeatureListTest, UninitializedInstance_IsEnabledReturnsFalse) {
   EXPECT_FALSE(FeatureList::IsEnabled(kFeatureOffByDefault));
 }
 
+TEST_F(FeatureListTest, CachedStateFollowsInstance) {
+  ClearFeatureListInstance();
+  std::unique_ptr<FeatureList> feature_list(new FeatureList);
+  feature_list->InitializeFromCommandLine(kFeatureOffByDefaultName,
+                                          kFeatureOnByDefaultName);
+  RegisterFeatureListInstance(std::move(feature_list));
+
+  // The second calls are served from the states cached by the first ones.
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_FALSE(FeatureList::IsEnabled(kFeatureOnByDefault));
+    EXPECT_TRUE(FeatureList::IsEnabled(kFeatureOffByDefault));
+  }
+
+  // The cached states don't outlive the instance which resolved them.
+  ClearFeatureListInstance();
+  EXPECT_TRUE(FeatureList::IsEnabled(kFeatureOnByDefault));
+  EXPECT_FALSE(FeatureList::IsEnabled(kFeatureOffByDefault));
+
+  RegisterFeatureListInstance(WrapUnique(new FeatureList));
+  EXPECT_TRUE(FeatureList::IsEnabled(kFeatureOnByDefault));
+  EXPECT_FALSE(FeatureList::IsEnabled(kFeatureOffByDefault));
+}
+
 TEST_F(FeatureListTest, StoreAndRetrieveFeaturesFromSharedMemory) {
   std::unique_ptr<base::FeatureList> feature_list(new base::FeatureList);
 
@@ -539,4 +562,39 @@ TEST_F(FeatureListTest, StoreAndRetrieveAssociatedFeaturesFromSharedMemory) {
   EXPECT_EQ(associated_trial2, trial2);
 }
 
+TEST_F(FeatureListTest, LookUpAssociatedFieldTrialFromSharedMemoryLazily) {
+  std::unique_ptr<SharedMemory> shm(new SharedMemory());
+  shm->CreateAndMapAnonymous(4 << 10);
+  SharedPersistentMemoryAllocator allocator(std::move(shm), 1, "", false);
+  {
+    FieldTrialList field_trial_list(nullptr);
+    std::unique_ptr<base::FeatureList> feature_list(new base::FeatureList);
+    feature_list->RegisterFieldTrialOverride(
+        kFeatureOffByDefaultName, FeatureList::OVERRIDE_ENABLE_FEATURE,
+        FieldTrialList::CreateFieldTrial("TrialExample", "A"));
+    feature_list->FinalizeInitialization();
+    feature_list->AddFeaturesToAllocator(&allocator);
+  }
+
+  // The trial doesn't exist yet when the overrides are read.
+  FieldTrialList field_trial_list(nullptr);
+  std::unique_ptr<base::FeatureList> feature_list(new base::FeatureList);
+  feature_list->InitializeFromSharedMemory(&allocator);
+  feature_list->FinalizeInitialization();
+  EXPECT_FALSE(feature_list->IsFeatureOverriddenFromCommandLine(
+      kFeatureOffByDefaultName, FeatureList::OVERRIDE_ENABLE_FEATURE));
+
+  FieldTrial* trial = FieldTrialList::CreateFieldTrial("TrialExample", "A");
+  EXPECT_EQ(trial, feature_list->GetAssociatedFieldTrial(kFeatureOffByDefault));
+  EXPECT_FALSE(FieldTrialList::IsTrialActive("TrialExample"));
+  EXPECT_TRUE(feature_list->IsFeatureEnabled(kFeatureOffByDefault));
+  EXPECT_TRUE(FieldTrialList::IsTrialActive("TrialExample"));
+
+  std::string enable_features;
+  std::string disable_features;
+  feature_list->GetFeatureOverrides(&enable_features, &disable_features);
+  EXPECT_EQ("OffByDefault<TrialExample", enable_features);
+  EXPECT_EQ("", disable_features);
+}
+
 }  // namespace base
@@ -5,6 +5,8 @@
 #ifndef BASE_FILES_DIR_READER_FALLBACK_H_
 #define BASE_FILES_DIR_READER_FALLBACK_H_
 
+#include <dirent.h>
+
 namespace base {
 
 class DirReaderFallback {
@@ -23,6 +25,10 @@ class DirReaderFallback {
   // Return the name of the current directory entry.
   const char* name() { return nullptr;}
 
+  // Return the type of the current directory entry, as a DT_* value of
+  // <dirent.h>.
+  unsigned char type() const { return DT_UNKNOWN; }
+
   // Return the file descriptor which is being used.
   int fd() const { return -1; }
 
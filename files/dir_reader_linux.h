@@ -5,6 +5,7 @@
 #ifndef BASE_FILES_DIR_READER_LINUX_H_
 #define BASE_FILES_DIR_READER_LINUX_H_
 
+#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <stddef.h>
@@ -79,6 +80,17 @@ class DirReaderLinux {
     return dirent->d_name;
   }
 
+  // Returns the type of the current entry, one of the DT_* values of
+  // <dirent.h>, or DT_UNKNOWN if the filesystem doesn't store it.
+  unsigned char type() const {
+    if (!size_)
+      return DT_UNKNOWN;
+
+    const linux_dirent* dirent =
+        reinterpret_cast<const linux_dirent*>(&buf_[offset_]);
+    return dirent->d_type;
+  }
+
   int fd() const {
     return fd_;
   }
@@ -0,0 +1,100 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/file_copier_posix.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/location.h"
+#include "base/sequenced_task_runner.h"
+#include "base/synchronization/atomic_flag.h"
+#include "base/task_scheduler/post_task.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+
+namespace base {
+
+// static
+constexpr TimeDelta FileCopier::kProgressInterval;
+
+// Does the copy on a worker, and posts the progress and the result back to
+// the FileCopier.
+class FileCopier::Core : public RefCountedThreadSafe<Core> {
+ public:
+  explicit Core(WeakPtr<FileCopier> copier)
+      : reply_task_runner_(SequencedTaskRunnerHandle::Get()),
+        copier_(std::move(copier)) {}
+
+  void Copy(const FilePath& from_path, const FilePath& to_path) {
+    bool success = !cancelled_.IsSet() &&
+                   CopyFileWithProgress(
+                       from_path, to_path,
+                       BindRepeating(&Core::OnProgress, Unretained(this)));
+    reply_task_runner_->PostTask(
+        FROM_HERE, BindOnce(&FileCopier::OnDone, copier_, success));
+  }
+
+  // Makes the copy stop at the next chunk.
+  void Cancel() { cancelled_.Set(); }
+
+ private:
+  friend class RefCountedThreadSafe<Core>;
+
+  ~Core() = default;
+
+  bool OnProgress(int64_t bytes_copied, int64_t total_bytes) {
+    if (cancelled_.IsSet())
+      return false;
+    TimeTicks now = TimeTicks::Now();
+    if (now - last_progress_time_ >= kProgressInterval) {
+      last_progress_time_ = now;
+      reply_task_runner_->PostTask(
+          FROM_HERE, BindOnce(&FileCopier::OnProgress, copier_, bytes_copied,
+                              total_bytes));
+    }
+    return true;
+  }
+
+  const scoped_refptr<SequencedTaskRunner> reply_task_runner_;
+  const WeakPtr<FileCopier> copier_;
+
+  AtomicFlag cancelled_;
+
+  // Only used by the worker.
+  TimeTicks last_progress_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(Core);
+};
+
+FileCopier::FileCopier(const FilePath& from_path,
+                       const FilePath& to_path,
+                       ProgressCallback progress,
+                       DoneCallback done)
+    : progress_(std::move(progress)),
+      done_(std::move(done)),
+      weak_factory_(this) {
+  core_ = MakeRefCounted<Core>(weak_factory_.GetWeakPtr());
+  PostTaskWithTraits(FROM_HERE,
+                     {MayBlock(), TaskShutdownBehavior::SKIP_ON_SHUTDOWN},
+                     BindOnce(&Core::Copy, core_, from_path, to_path));
+}
+
+FileCopier::~FileCopier() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  core_->Cancel();
+}
+
+void FileCopier::OnProgress(int64_t bytes_copied, int64_t total_bytes) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (progress_)
+    progress_.Run(bytes_copied, total_bytes);
+}
+
+void FileCopier::OnDone(bool success) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  std::move(done_).Run(success);
+}
+
+}  // namespace base
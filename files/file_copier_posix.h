@@ -0,0 +1,71 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_FILE_COPIER_POSIX_H_
+#define BASE_FILES_FILE_COPIER_POSIX_H_
+
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequence_checker.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// Copies a file with CopyFileWithProgress() on a TaskScheduler worker, and
+// reports the progress back to the sequence which created it.
+//
+// Example:
+//
+//   copier_ = std::make_unique<FileCopier>(
+//       from_path, to_path,
+//       BindRepeating(&Installer::UpdateProgressBar,
+//                     weak_factory_.GetWeakPtr()),
+//       BindOnce(&Installer::OnCopied, weak_factory_.GetWeakPtr()));
+class BASE_EXPORT FileCopier {
+ public:
+  using ProgressCallback =
+      RepeatingCallback<void(int64_t bytes_copied, int64_t total_bytes)>;
+  using DoneCallback = OnceCallback<void(bool success)>;
+
+  // The least time between two runs of the progress callback.
+  static constexpr TimeDelta kProgressInterval =
+      TimeDelta::FromMilliseconds(100);
+
+  // Starts copying |from_path| to |to_path|. |progress|, which may be null,
+  // runs with the arguments of CopyFileProgressCallback at most every
+  // |kProgressInterval|, and |done| runs with the result once the copy is
+  // over. Deleting the copier cancels the copy, possibly leaving |to_path|
+  // partially written, and no callback runs after that.
+  FileCopier(const FilePath& from_path,
+             const FilePath& to_path,
+             ProgressCallback progress,
+             DoneCallback done);
+  ~FileCopier();
+
+ private:
+  class Core;
+
+  void OnProgress(int64_t bytes_copied, int64_t total_bytes);
+  void OnDone(bool success);
+
+  scoped_refptr<Core> core_;
+  ProgressCallback progress_;
+  DoneCallback done_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  WeakPtrFactory<FileCopier> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileCopier);
+};
+
+}  // namespace base
+
+#endif  // BASE_FILES_FILE_COPIER_POSIX_H_
@@ -0,0 +1,86 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/file_copier_posix.h"
+
+#include <memory>
+#include <string>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "base/test/scoped_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class FileCopierTest : public testing::Test {
+ protected:
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  FilePath GetPath(const char* name) {
+    return temp_dir_.GetPath().AppendASCII(name);
+  }
+
+  test::ScopedTaskEnvironment scoped_task_environment_;
+  ScopedTempDir temp_dir_;
+};
+
+void StoreResult(bool* out, OnceClosure quit_closure, bool success) {
+  *out = success;
+  std::move(quit_closure).Run();
+}
+
+}  // namespace
+
+TEST_F(FileCopierTest, Copy) {
+  const std::string data(3 * 1024 * 1024 + 17, 'x');
+  ASSERT_TRUE(WriteFile(GetPath("from"), data.data(), data.size()));
+
+  bool success = false;
+  int64_t last_bytes_copied = 0;
+  RunLoop run_loop;
+  FileCopier copier(
+      GetPath("from"), GetPath("to"),
+      BindRepeating(
+          [](int64_t* last_bytes_copied, int64_t bytes_copied,
+             int64_t total_bytes) {
+            EXPECT_GT(bytes_copied, *last_bytes_copied);
+            EXPECT_LE(bytes_copied, total_bytes);
+            *last_bytes_copied = bytes_copied;
+          },
+          &last_bytes_copied),
+      BindOnce(&StoreResult, &success, run_loop.QuitClosure()));
+  run_loop.Run();
+  EXPECT_TRUE(success);
+
+  std::string copied;
+  ASSERT_TRUE(ReadFileToString(GetPath("to"), &copied));
+  EXPECT_EQ(data, copied);
+}
+
+TEST_F(FileCopierTest, MissingSource) {
+  bool success = true;
+  RunLoop run_loop;
+  FileCopier copier(GetPath("missing"), GetPath("to"),
+                    FileCopier::ProgressCallback(),
+                    BindOnce(&StoreResult, &success, run_loop.QuitClosure()));
+  run_loop.Run();
+  EXPECT_FALSE(success);
+  EXPECT_FALSE(PathExists(GetPath("to")));
+}
+
+TEST_F(FileCopierTest, DeleteBeforeDone) {
+  ASSERT_TRUE(WriteFile(GetPath("from"), "data", 4));
+  auto copier = std::make_unique<FileCopier>(
+      GetPath("from"), GetPath("to"), FileCopier::ProgressCallback(),
+      BindOnce([](bool success) { ADD_FAILURE() << "Copy wasn't cancelled"; }));
+  copier.reset();
+  scoped_task_environment_.RunUntilIdle();
+}
+
+}  // namespace base
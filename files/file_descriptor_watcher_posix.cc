@@ -4,12 +4,15 @@
 
 #include "base/files/file_descriptor_watcher_posix.h"
 
+#include <poll.h>
+
 #include "base/bind.h"
 #include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "base/message_loop/message_loop_current.h"
 #include "base/message_loop/message_pump_for_io.h"
+#include "base/posix/eintr_wrapper.h"
 #include "base/sequenced_task_runner.h"
 #include "base/single_thread_task_runner.h"
 #include "base/threading/sequenced_task_runner_handle.h"
@@ -161,6 +164,8 @@ FileDescriptorWatcher::Controller::Controller(MessagePumpForIO::Mode mode,
                                               int fd,
                                               const Closure& callback)
     : callback_(callback),
+      mode_(mode),
+      fd_(fd),
       message_loop_for_io_task_runner_(
           tls_message_loop_for_io.Get().Get()->task_runner()),
       weak_factory_(this) {
@@ -187,9 +192,31 @@ void FileDescriptorWatcher::Controller::RunCallback() {
 
   callback_.Run();
 
-  // If |this| wasn't deleted, re-enable the watch.
-  if (weak_this)
-    StartWatching();
+  // If |this| was deleted, there's nothing left to do.
+  if (!weak_this)
+    return;
+
+  // If the file descriptor is still ready, e.g. because more data arrived while
+  // the callback ran, run it again from a task posted to this sequence. This
+  // saves the round-trip through the MessageLoopForIO, which would only find
+  // out the same thing. Otherwise, re-enable the watch.
+  if (IsReady()) {
+    SequencedTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, BindOnce(&Controller::RunCallback, weak_this));
+    return;
+  }
+  StartWatching();
+}
+
+bool FileDescriptorWatcher::Controller::IsReady() const {
+  // Like the MessageLoopForIO, report hang-ups and errors as readiness so that
+  // the callback finds out about them.
+  struct pollfd poll_fd = {};
+  poll_fd.fd = fd_;
+  poll_fd.events = mode_ == MessagePumpForIO::WATCH_READ ? POLLIN : POLLOUT;
+  if (HANDLE_EINTR(poll(&poll_fd, 1, 0)) != 1)
+    return false;
+  return (poll_fd.revents & (poll_fd.events | POLLHUP | POLLERR)) != 0;
 }
 
 FileDescriptorWatcher::FileDescriptorWatcher(
@@ -30,7 +30,10 @@ class SingleThreadTaskRunner;
 // for non-critical IO. FileDescriptorWatcher works on threads/sequences without
 // MessagePumps but involves going through the task queue after being notified
 // by the OS (a desirablable property for non-critical IO that shouldn't preempt
-// the main queue).
+// the main queue). While the file descriptor stays readable or writable after
+// the callback runs, e.g. during a burst of incoming data, the callback is
+// posted again directly to the task queue rather than through the
+// MessageLoopForIO.
 class BASE_EXPORT FileDescriptorWatcher {
  public:
   // Instantiated and returned by WatchReadable() or WatchWritable(). The
@@ -52,13 +55,26 @@ class BASE_EXPORT FileDescriptorWatcher {
     // Starts watching the file descriptor.
     void StartWatching();
 
-    // Runs |callback_|.
+    // Runs |callback_|, then runs it again from a task on the current sequence
+    // if the file descriptor is still readable or writable without blocking,
+    // or starts watching it again otherwise.
     void RunCallback();
 
+    // Returns whether |fd_| is readable or writable without blocking
+    // (depending on |mode_|), checked without going through the
+    // MessageLoopForIO.
+    bool IsReady() const;
+
     // The callback to run when the watched file descriptor is readable or
     // writable without blocking.
     Closure callback_;
 
+    // Whether |callback_| runs when |fd_| is readable or writable.
+    const MessagePumpForIO::Mode mode_;
+
+    // The watched file descriptor.
+    const int fd_;
+
     // TaskRunner associated with the MessageLoopForIO that watches the file
     // descriptor.
     const scoped_refptr<SingleThreadTaskRunner>
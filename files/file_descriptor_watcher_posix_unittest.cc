@@ -241,6 +241,36 @@ TEST_P(FileDescriptorWatcherTest, WatchReadableByteWrittenFromCallback) {
   WaitAndRunPendingTasks();
 }
 
+TEST_P(FileDescriptorWatcherTest, StillReadableAfterCallback) {
+  if (GetParam() !=
+      FileDescriptorWatcherTestType::MESSAGE_LOOP_FOR_IO_ON_OTHER_THREAD) {
+    return;
+  }
+
+  auto controller = WatchReadable();
+
+  // Write 2 bytes to the pipe. Expect one call to ReadableCallback() which
+  // reads 1 byte and stops the MessageLoopForIO. Since the pipe is still
+  // readable, expect another call without going through the MessageLoopForIO.
+  WriteByte();
+  WriteByte();
+  RunLoop run_loop;
+  EXPECT_CALL(mock_, ReadableCallback())
+      .WillOnce(testing::Invoke([this]() {
+        ReadByte();
+        other_thread_.Stop();
+      }))
+      .WillOnce(testing::Invoke([this, &run_loop]() {
+        ReadByte();
+        run_loop.Quit();
+      }));
+  run_loop.Run();
+  testing::Mock::VerifyAndClear(&mock_);
+
+  // No more call to ReadableCallback() is expected.
+  WaitAndRunPendingTasks();
+}
+
 TEST_P(FileDescriptorWatcherTest, DeleteControllerFromCallback) {
   auto controller = WatchReadable();
 
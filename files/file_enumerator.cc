@@ -10,8 +10,8 @@ namespace base {
 
 FileEnumerator::FileInfo::~FileInfo() = default;
 
-bool FileEnumerator::ShouldSkip(const FilePath& path) {
-  FilePath::StringType basename = path.BaseName().value();
+bool FileEnumerator::ShouldSkip(FilePathView path) {
+  FilePath::StringPieceType basename = path.BaseName().value();
   return basename == FILE_PATH_LITERAL(".") ||
          (basename == FILE_PATH_LITERAL("..") &&
           !(INCLUDE_DOT_DOT & file_type_));
@@ -52,6 +52,10 @@ class BASE_EXPORT FileEnumerator {
     // includes the |root_path| passed into the FileEnumerator constructor.
     FilePath GetName() const;
 
+    // Same as GetName(), but without copying the name. The view is valid for
+    // as long as this FileInfo.
+    FilePathView GetNameView() const;
+
     int64_t GetSize() const;
     Time GetLastModifiedTime() const;
 
@@ -138,7 +142,7 @@ class BASE_EXPORT FileEnumerator {
 
  private:
   // Returns true if the given path should be skipped in enumeration.
-  bool ShouldSkip(const FilePath& path);
+  bool ShouldSkip(FilePathView path);
 
   bool IsTypeMatched(bool is_dir) const;
 
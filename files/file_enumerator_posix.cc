@@ -46,6 +46,10 @@ FilePath FileEnumerator::FileInfo::GetName() const {
   return filename_;
 }
 
+FilePathView FileEnumerator::FileInfo::GetNameView() const {
+  return filename_;
+}
+
 int64_t FileEnumerator::FileInfo::GetSize() const {
   return stat_.st_size;
 }
@@ -87,6 +87,19 @@ TEST(FileEnumerator, SingleFileInFolderForFileSearch) {
   }
 }
 
+TEST(FileEnumerator, GetNameView) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  ASSERT_TRUE(CreateDummyFile(temp_dir.GetPath().AppendASCII("test.txt")));
+
+  FileEnumerator enumerator(temp_dir.GetPath(), false, FileEnumerator::FILES);
+  ASSERT_FALSE(enumerator.Next().empty());
+  const FileEnumerator::FileInfo info = enumerator.GetInfo();
+  EXPECT_EQ(info.GetName().value(), info.GetNameView().value());
+  EXPECT_EQ(FILE_PATH_LITERAL(".txt"), info.GetNameView().Extension());
+  EXPECT_TRUE(enumerator.Next().empty());
+}
+
 TEST(FileEnumerator, SingleFileInFolderForDirSearch) {
   ScopedTempDir temp_dir;
   ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
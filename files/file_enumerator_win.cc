@@ -46,6 +46,10 @@ FilePath FileEnumerator::FileInfo::GetName() const {
   return FilePath(find_data_.cFileName);
 }
 
+FilePathView FileEnumerator::FileInfo::GetNameView() const {
+  return FilePathView(find_data_.cFileName);
+}
+
 int64_t FileEnumerator::FileInfo::GetSize() const {
   ULARGE_INTEGER size;
   size.HighPart = find_data_.nFileSizeHigh;
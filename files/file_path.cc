@@ -93,23 +93,43 @@ bool IsPathAbsolute(StringPieceType path) {
 #endif  // FILE_PATH_USES_DRIVE_LETTERS
 }
 
-bool AreAllSeparators(const StringType& input) {
-  for (StringType::const_iterator it = input.begin();
-      it != input.end(); ++it) {
-    if (!FilePath::IsSeparator(*it))
-      return false;
-  }
+StringPieceType SeparatorsPiece() {
+  return StringPieceType(FilePath::kSeparators, FilePath::kSeparatorsLength - 1);
+}
 
-  return true;
+// Returns |path| without the trailing separators that
+// FilePath::StripTrailingSeparators() would strip.
+StringPieceType WithoutTrailingSeparators(StringPieceType path) {
+  // If there is no drive letter, start will be 1, which will prevent stripping
+  // the leading separator if there is only one separator.  If there is a drive
+  // letter, start will be set appropriately to prevent stripping the first
+  // separator following the drive letter, if a separator immediately follows
+  // the drive letter.
+  StringPieceType::size_type start = FindDriveLetter(path) + 2;
+
+  StringPieceType::size_type last_stripped = StringPieceType::npos;
+  for (StringPieceType::size_type pos = path.length();
+       pos > start && FilePath::IsSeparator(path[pos - 1]);
+       --pos) {
+    // If the string only has two separators and they're at the beginning,
+    // don't strip them, unless the string began with more than two separators.
+    if (pos != start + 1 || last_stripped == start + 2 ||
+        !FilePath::IsSeparator(path[start - 1])) {
+      path = path.substr(0, pos - 1);
+      last_stripped = pos;
+    }
+  }
+  return path;
 }
 
 // Find the position of the '.' that separates the extension from the rest
 // of the file name. The position is relative to BaseName(), not value().
 // Returns npos if it can't find an extension.
-StringType::size_type FinalExtensionSeparatorPosition(const StringType& path) {
+StringPieceType::size_type FinalExtensionSeparatorPosition(
+    StringPieceType path) {
   // Special case "." and ".."
   if (path == FilePath::kCurrentDirectory || path == FilePath::kParentDirectory)
-    return StringType::npos;
+    return StringPieceType::npos;
 
   return path.rfind(FilePath::kExtensionSeparator);
 }
@@ -118,32 +138,32 @@ StringType::size_type FinalExtensionSeparatorPosition(const StringType& path) {
 // characters when the rightmost extension component is a common double
 // extension (gz, bz2, Z).  For example, foo.tar.gz or foo.tar.Z would have
 // extension components of '.tar.gz' and '.tar.Z' respectively.
-StringType::size_type ExtensionSeparatorPosition(const StringType& path) {
-  const StringType::size_type last_dot = FinalExtensionSeparatorPosition(path);
+StringPieceType::size_type ExtensionSeparatorPosition(StringPieceType path) {
+  const StringPieceType::size_type last_dot =
+      FinalExtensionSeparatorPosition(path);
 
   // No extension, or the extension is the whole filename.
-  if (last_dot == StringType::npos || last_dot == 0U)
+  if (last_dot == StringPieceType::npos || last_dot == 0U)
     return last_dot;
 
-  const StringType::size_type penultimate_dot =
+  const StringPieceType::size_type penultimate_dot =
       path.rfind(FilePath::kExtensionSeparator, last_dot - 1);
-  const StringType::size_type last_separator =
-      path.find_last_of(FilePath::kSeparators, last_dot - 1,
-                        FilePath::kSeparatorsLength - 1);
+  const StringPieceType::size_type last_separator =
+      path.find_last_of(SeparatorsPiece(), last_dot - 1);
 
-  if (penultimate_dot == StringType::npos ||
-      (last_separator != StringType::npos &&
+  if (penultimate_dot == StringPieceType::npos ||
+      (last_separator != StringPieceType::npos &&
        penultimate_dot < last_separator)) {
     return last_dot;
   }
 
   for (size_t i = 0; i < arraysize(kCommonDoubleExtensions); ++i) {
-    StringType extension(path, penultimate_dot + 1);
+    StringPieceType extension = path.substr(penultimate_dot + 1);
     if (LowerCaseEqualsASCII(extension, kCommonDoubleExtensions[i]))
       return penultimate_dot;
   }
 
-  StringType extension(path, last_dot + 1);
+  StringPieceType extension = path.substr(last_dot + 1);
   for (size_t i = 0; i < arraysize(kCommonDoubleExtensionSuffixes); ++i) {
     if (LowerCaseEqualsASCII(extension, kCommonDoubleExtensionSuffixes[i])) {
       if ((last_dot - penultimate_dot) <= 5U &&
@@ -223,34 +243,8 @@ void FilePath::GetComponents(std::vector<StringType>* components) const {
   if (!components)
     return;
   components->clear();
-  if (value().empty())
-    return;
-
-  std::vector<StringType> ret_val;
-  FilePath current = *this;
-  FilePath base;
-
-  // Capture path components.
-  while (current != current.DirName()) {
-    base = current.BaseName();
-    if (!AreAllSeparators(base.value()))
-      ret_val.push_back(base.value());
-    current = current.DirName();
-  }
-
-  // Capture root, if any.
-  base = current.BaseName();
-  if (!base.value().empty() && base.value() != kCurrentDirectory)
-    ret_val.push_back(current.BaseName().value());
-
-  // Capture drive letter, if any.
-  FilePath dir = current.DirName();
-  StringType::size_type letter = FindDriveLetter(dir.value());
-  if (letter != StringType::npos) {
-    ret_val.push_back(StringType(dir.value(), 0, letter + 1));
-  }
-
-  *components = std::vector<StringType>(ret_val.rbegin(), ret_val.rend());
+  for (StringPieceType component : FilePathView(*this).GetComponents())
+    components->push_back(component.as_string());
 }
 
 bool FilePath::IsParent(const FilePath& child) const {
@@ -306,102 +300,27 @@ bool FilePath::AppendRelativePath(const FilePath& child,
 // differently in this regard on different platforms.  Don't use them, but
 // adhere to their behavior.
 FilePath FilePath::DirName() const {
-  FilePath new_path(path_);
-  new_path.StripTrailingSeparatorsInternal();
-
-  // The drive letter, if any, always needs to remain in the output.  If there
-  // is no drive letter, as will always be the case on platforms which do not
-  // support drive letters, letter will be npos, or -1, so the comparisons and
-  // resizes below using letter will still be valid.
-  StringType::size_type letter = FindDriveLetter(new_path.path_);
-
-  StringType::size_type last_separator =
-      new_path.path_.find_last_of(kSeparators, StringType::npos,
-                                  kSeparatorsLength - 1);
-  if (last_separator == StringType::npos) {
-    // path_ is in the current directory.
-    new_path.path_.resize(letter + 1);
-  } else if (last_separator == letter + 1) {
-    // path_ is in the root directory.
-    new_path.path_.resize(letter + 2);
-  } else if (last_separator == letter + 2 &&
-             IsSeparator(new_path.path_[letter + 1])) {
-    // path_ is in "//" (possibly with a drive letter); leave the double
-    // separator intact indicating alternate root.
-    new_path.path_.resize(letter + 3);
-  } else if (last_separator != 0) {
-    // path_ is somewhere else, trim the basename.
-    new_path.path_.resize(last_separator);
-  }
-
-  new_path.StripTrailingSeparatorsInternal();
-  if (!new_path.path_.length())
-    new_path.path_ = kCurrentDirectory;
-
-  return new_path;
+  return FilePath(FilePathView(*this).DirName().value());
 }
 
 FilePath FilePath::BaseName() const {
-  FilePath new_path(path_);
-  new_path.StripTrailingSeparatorsInternal();
-
-  // The drive letter, if any, is always stripped.
-  StringType::size_type letter = FindDriveLetter(new_path.path_);
-  if (letter != StringType::npos) {
-    new_path.path_.erase(0, letter + 1);
-  }
-
-  // Keep everything after the final separator, but if the pathname is only
-  // one character and it's a separator, leave it alone.
-  StringType::size_type last_separator =
-      new_path.path_.find_last_of(kSeparators, StringType::npos,
-                                  kSeparatorsLength - 1);
-  if (last_separator != StringType::npos &&
-      last_separator < new_path.path_.length() - 1) {
-    new_path.path_.erase(0, last_separator + 1);
-  }
-
-  return new_path;
+  return FilePath(FilePathView(*this).BaseName().value());
 }
 
 StringType FilePath::Extension() const {
-  FilePath base(BaseName());
-  const StringType::size_type dot = ExtensionSeparatorPosition(base.path_);
-  if (dot == StringType::npos)
-    return StringType();
-
-  return base.path_.substr(dot, StringType::npos);
+  return FilePathView(*this).Extension().as_string();
 }
 
 StringType FilePath::FinalExtension() const {
-  FilePath base(BaseName());
-  const StringType::size_type dot = FinalExtensionSeparatorPosition(base.path_);
-  if (dot == StringType::npos)
-    return StringType();
-
-  return base.path_.substr(dot, StringType::npos);
+  return FilePathView(*this).FinalExtension().as_string();
 }
 
 FilePath FilePath::RemoveExtension() const {
-  if (Extension().empty())
-    return *this;
-
-  const StringType::size_type dot = ExtensionSeparatorPosition(path_);
-  if (dot == StringType::npos)
-    return *this;
-
-  return FilePath(path_.substr(0, dot));
+  return FilePath(FilePathView(*this).RemoveExtension().value());
 }
 
 FilePath FilePath::RemoveFinalExtension() const {
-  if (FinalExtension().empty())
-    return *this;
-
-  const StringType::size_type dot = FinalExtensionSeparatorPosition(path_);
-  if (dot == StringType::npos)
-    return *this;
-
-  return FilePath(path_.substr(0, dot));
+  return FilePath(FilePathView(*this).RemoveFinalExtension().value());
 }
 
 FilePath FilePath::InsertBeforeExtension(StringPieceType suffix) const {
@@ -464,25 +383,24 @@ FilePath FilePath::ReplaceExtension(StringPieceType extension) const {
 }
 
 bool FilePath::MatchesExtension(StringPieceType extension) const {
-  DCHECK(extension.empty() || extension[0] == kExtensionSeparator);
-
-  StringType current_extension = Extension();
+  return FilePathView(*this).MatchesExtension(extension);
+}
 
-  if (current_extension.length() != extension.length())
-    return false;
+FilePath FilePath::Append(StringPieceType component) const {
+  FilePath new_path(*this);
+  new_path.AppendInPlace(component);
+  return new_path;
+}
 
-  return FilePath::CompareEqualIgnoreCase(extension, current_extension);
+FilePath FilePath::Append(const FilePath& component) const {
+  return Append(component.value());
 }
 
-FilePath FilePath::Append(StringPieceType component) const {
+FilePath& FilePath::AppendInPlace(StringPieceType component) {
   StringPieceType appended = component;
-  StringType without_nuls;
-
   StringType::size_type nul_pos = component.find(kStringTerminator);
-  if (nul_pos != StringPieceType::npos) {
-    component.substr(0, nul_pos).CopyToString(&without_nuls);
-    appended = StringPieceType(without_nuls);
-  }
+  if (nul_pos != StringPieceType::npos)
+    appended = component.substr(0, nul_pos);
 
   DCHECK(!IsPathAbsolute(appended));
 
@@ -494,32 +412,32 @@ FilePath FilePath::Append(StringPieceType component) const {
     // it's likely in practice to wind up with FilePath objects containing
     // only kCurrentDirectory when calling DirName on a single relative path
     // component.
-    return FilePath(appended);
+    appended.CopyToString(&path_);
+    return *this;
   }
 
-  FilePath new_path(path_);
-  new_path.StripTrailingSeparatorsInternal();
+  StripTrailingSeparatorsInternal();
 
   // Don't append a separator if the path is empty (indicating the current
   // directory) or if the path component is empty (indicating nothing to
   // append).
-  if (!appended.empty() && !new_path.path_.empty()) {
+  if (!appended.empty() && !path_.empty()) {
     // Don't append a separator if the path still ends with a trailing
     // separator after stripping (indicating the root directory).
-    if (!IsSeparator(new_path.path_.back())) {
+    if (!IsSeparator(path_.back())) {
       // Don't append a separator if the path is just a drive letter.
-      if (FindDriveLetter(new_path.path_) + 1 != new_path.path_.length()) {
-        new_path.path_.append(1, kSeparators[0]);
+      if (FindDriveLetter(path_) + 1 != path_.length()) {
+        path_.append(1, kSeparators[0]);
       }
     }
   }
 
-  appended.AppendToString(&new_path.path_);
-  return new_path;
+  appended.AppendToString(&path_);
+  return *this;
 }
 
-FilePath FilePath::Append(const FilePath& component) const {
-  return Append(component.value());
+FilePath& FilePath::AppendInPlace(const FilePath& component) {
+  return AppendInPlace(component.value());
 }
 
 FilePath FilePath::AppendASCII(StringPiece component) const {
@@ -536,9 +454,7 @@ bool FilePath::IsAbsolute() const {
 }
 
 bool FilePath::EndsWithSeparator() const {
-  if (empty())
-    return false;
-  return IsSeparator(path_.back());
+  return FilePathView(*this).EndsWithSeparator();
 }
 
 FilePath FilePath::AsEndingWithSeparator() const {
@@ -554,10 +470,7 @@ FilePath FilePath::AsEndingWithSeparator() const {
 }
 
 FilePath FilePath::StripTrailingSeparators() const {
-  FilePath new_path(path_);
-  new_path.StripTrailingSeparatorsInternal();
-
-  return new_path;
+  return FilePath(FilePathView(*this).StripTrailingSeparators().value());
 }
 
 bool FilePath::ReferencesParent() const {
@@ -567,19 +480,14 @@ bool FilePath::ReferencesParent() const {
     return false;
   }
 
-  std::vector<StringType> components;
-  GetComponents(&components);
-
-  std::vector<StringType>::const_iterator it = components.begin();
-  for (; it != components.end(); ++it) {
-    const StringType& component = *it;
+  for (StringPieceType component : FilePathView(*this).GetComponents()) {
     // Windows has odd, undocumented behavior with path components containing
     // only whitespace and . characters. So, if all we see is . and
     // whitespace, then we treat any .. sequence as referencing parent.
     // For simplicity we enforce this on all platforms.
     if (component.find_first_not_of(FILE_PATH_LITERAL(". \n\r\t")) ==
-            std::string::npos &&
-        component.find(kParentDirectory) != std::string::npos) {
+            StringPieceType::npos &&
+        component.find(kParentDirectory) != StringPieceType::npos) {
       return true;
     }
   }
@@ -1287,25 +1195,7 @@ int FilePath::CompareIgnoreCase(StringPieceType string1,
 
 
 void FilePath::StripTrailingSeparatorsInternal() {
-  // If there is no drive letter, start will be 1, which will prevent stripping
-  // the leading separator if there is only one separator.  If there is a drive
-  // letter, start will be set appropriately to prevent stripping the first
-  // separator following the drive letter, if a separator immediately follows
-  // the drive letter.
-  StringType::size_type start = FindDriveLetter(path_) + 2;
-
-  StringType::size_type last_stripped = StringType::npos;
-  for (StringType::size_type pos = path_.length();
-       pos > start && IsSeparator(path_[pos - 1]);
-       --pos) {
-    // If the string only has two separators and they're at the beginning,
-    // don't strip them, unless the string began with more than two separators.
-    if (pos != start + 1 || last_stripped == start + 2 ||
-        !IsSeparator(path_[start - 1])) {
-      path_.resize(pos - 1);
-      last_stripped = pos;
-    }
-  }
+  path_.resize(WithoutTrailingSeparators(path_).length());
 }
 
 FilePath FilePath::NormalizePathSeparators() const {
@@ -1332,4 +1222,204 @@ bool FilePath::IsContentUri() const {
 }
 #endif
 
+// FilePathView ----------------------------------------------------------------
+
+FilePathView::ComponentIterator::ComponentIterator() = default;
+
+FilePathView::ComponentIterator::ComponentIterator(StringPieceType drive,
+                                                   StringPieceType root,
+                                                   StringPieceType rest)
+    : drive_(drive), root_(root), rest_(rest) {
+  ++*this;
+}
+
+FilePathView::ComponentIterator& FilePathView::ComponentIterator::
+operator++() {
+  if (!drive_.empty()) {
+    component_ = drive_;
+    drive_ = StringPieceType();
+    return *this;
+  }
+  if (!root_.empty()) {
+    component_ = root_;
+    root_ = StringPieceType();
+    return *this;
+  }
+
+  const StringPieceType::size_type begin =
+      rest_.find_first_not_of(SeparatorsPiece());
+  if (begin == StringPieceType::npos) {
+    component_ = rest_ = StringPieceType();
+    return *this;
+  }
+  rest_.remove_prefix(begin);
+  const StringPieceType::size_type end = rest_.find_first_of(SeparatorsPiece());
+  component_ = rest_.substr(0, end);
+  rest_.remove_prefix(component_.length());
+  return *this;
+}
+
+FilePathView::ComponentIterator FilePathView::ComponentIterator::operator++(
+    int) {
+  ComponentIterator it = *this;
+  ++*this;
+  return it;
+}
+
+FilePathView::FilePathView(StringPieceType path)
+    : path_(path.substr(0, path.find(kStringTerminator))) {}
+
+// libgen's dirname and basename aren't guaranteed to be thread-safe and aren't
+// guaranteed to not modify their input strings, and in fact are implemented
+// differently in this regard on different platforms.  Don't use them, but
+// adhere to their behavior.
+FilePathView FilePathView::DirName() const {
+  StringPieceType new_path = WithoutTrailingSeparators(path_);
+
+  // The drive letter, if any, always needs to remain in the output.  If there
+  // is no drive letter, as will always be the case on platforms which do not
+  // support drive letters, letter will be npos, or -1, so the comparisons and
+  // substrings below using letter will still be valid.
+  StringPieceType::size_type letter = FindDriveLetter(new_path);
+
+  StringPieceType::size_type last_separator =
+      new_path.find_last_of(SeparatorsPiece());
+  if (last_separator == StringPieceType::npos) {
+    // path_ is in the current directory.
+    new_path = new_path.substr(0, letter + 1);
+  } else if (last_separator == letter + 1) {
+    // path_ is in the root directory.
+    new_path = new_path.substr(0, letter + 2);
+  } else if (last_separator == letter + 2 &&
+             FilePath::IsSeparator(new_path[letter + 1])) {
+    // path_ is in "//" (possibly with a drive letter); leave the double
+    // separator intact indicating alternate root.
+    new_path = new_path.substr(0, letter + 3);
+  } else if (last_separator != 0) {
+    // path_ is somewhere else, trim the basename.
+    new_path = new_path.substr(0, last_separator);
+  }
+
+  new_path = WithoutTrailingSeparators(new_path);
+  if (new_path.empty())
+    return FilePathView(FilePath::kCurrentDirectory);
+
+  return FilePathView(new_path);
+}
+
+FilePathView FilePathView::BaseName() const {
+  StringPieceType new_path = WithoutTrailingSeparators(path_);
+
+  // The drive letter, if any, is always stripped.
+  StringPieceType::size_type letter = FindDriveLetter(new_path);
+  if (letter != StringPieceType::npos)
+    new_path.remove_prefix(letter + 1);
+
+  // Keep everything after the final separator, but if the pathname is only
+  // one character and it's a separator, leave it alone.
+  StringPieceType::size_type last_separator =
+      new_path.find_last_of(SeparatorsPiece());
+  if (last_separator != StringPieceType::npos &&
+      last_separator < new_path.length() - 1) {
+    new_path.remove_prefix(last_separator + 1);
+  }
+
+  return FilePathView(new_path);
+}
+
+StringPieceType FilePathView::Extension() const {
+  StringPieceType base = BaseName().value();
+  const StringPieceType::size_type dot = ExtensionSeparatorPosition(base);
+  if (dot == StringPieceType::npos)
+    return StringPieceType();
+
+  return base.substr(dot);
+}
+
+StringPieceType FilePathView::FinalExtension() const {
+  StringPieceType base = BaseName().value();
+  const StringPieceType::size_type dot = FinalExtensionSeparatorPosition(base);
+  if (dot == StringPieceType::npos)
+    return StringPieceType();
+
+  return base.substr(dot);
+}
+
+FilePathView FilePathView::RemoveExtension() const {
+  if (Extension().empty())
+    return *this;
+
+  const StringPieceType::size_type dot = ExtensionSeparatorPosition(path_);
+  if (dot == StringPieceType::npos)
+    return *this;
+
+  return FilePathView(path_.substr(0, dot));
+}
+
+FilePathView FilePathView::RemoveFinalExtension() const {
+  if (FinalExtension().empty())
+    return *this;
+
+  const StringPieceType::size_type dot = FinalExtensionSeparatorPosition(path_);
+  if (dot == StringPieceType::npos)
+    return *this;
+
+  return FilePathView(path_.substr(0, dot));
+}
+
+bool FilePathView::MatchesExtension(StringPieceType extension) const {
+  DCHECK(extension.empty() || extension[0] == FilePath::kExtensionSeparator);
+
+  StringPieceType current_extension = Extension();
+
+  if (current_extension.length() != extension.length())
+    return false;
+
+  return FilePath::CompareEqualIgnoreCase(extension, current_extension);
+}
+
+bool FilePathView::IsAbsolute() const {
+  return IsPathAbsolute(path_);
+}
+
+bool FilePathView::EndsWithSeparator() const {
+  if (empty())
+    return false;
+  return FilePath::IsSeparator(path_.back());
+}
+
+FilePathView FilePathView::StripTrailingSeparators() const {
+  return FilePathView(WithoutTrailingSeparators(path_));
+}
+
+FilePathView::Components FilePathView::GetComponents() const {
+  if (empty())
+    return Components(ComponentIterator());
+
+  // The root is where DirName() stops: the drive letter, if any, followed by
+  // the root directory, or the current directory. All the components after
+  // it are separated by separators.
+  FilePathView root = *this;
+  for (FilePathView dir = DirName(); dir.value() != root.value();
+       dir = dir.DirName()) {
+    root = dir;
+  }
+
+  // The root is either a prefix of the path, or kCurrentDirectory when the
+  // path is a relative one without a "." prefix.
+  StringPieceType drive;
+  StringPieceType root_dir;
+  StringPieceType rest = path_;
+  if (root.value().data() == path_.data()) {
+    rest.remove_prefix(root.value().length());
+    StringPieceType::size_type letter = FindDriveLetter(root.value());
+    if (letter != StringPieceType::npos)
+      drive = root.value().substr(0, letter + 1);
+    StringPieceType base = root.BaseName().value();
+    if (base != FilePath::kCurrentDirectory)
+      root_dir = base;
+  }
+  return Components(ComponentIterator(drive, root_dir, rest));
+}
+
 }  // namespace base
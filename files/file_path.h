@@ -105,6 +105,7 @@
 #include <stddef.h>
 
 #include <iosfwd>
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -313,6 +314,13 @@ class BASE_EXPORT FilePath {
   FilePath Append(StringPieceType component) const WARN_UNUSED_RESULT;
   FilePath Append(const FilePath& component) const WARN_UNUSED_RESULT;
 
+  // Same as Append(), but appends to this object's path rather than returning
+  // a new FilePath, so that building a path component by component only
+  // reallocates when the path outgrows its capacity. |component| must not
+  // point into this object's path.
+  FilePath& AppendInPlace(StringPieceType component);
+  FilePath& AppendInPlace(const FilePath& component);
+
   // Although Windows StringType is std::wstring, since the encoding it uses for
   // paths is well defined, it can handle ASCII path components as well.
   // Mac uses UTF8, and since ASCII is a subset of that, it works there as well.
@@ -453,6 +461,107 @@ class BASE_EXPORT FilePath {
 BASE_EXPORT std::ostream& operator<<(std::ostream& out,
                                      const FilePath& file_path);
 
+// A non-owning view of a path, with the query API of FilePath. The queries
+// return views into the same characters rather than new FilePaths, so unlike
+// those of FilePath they never allocate; the viewed path must outlive the view
+// and anything returned from it. For example, to visit the components of a
+// path:
+//
+//   for (FilePath::StringPieceType component :
+//        FilePathView(path).GetComponents()) {
+//     ...
+//   }
+class BASE_EXPORT FilePathView {
+ public:
+  using CharType = FilePath::CharType;
+  using StringPieceType = FilePath::StringPieceType;
+
+  // A forward iterator over the components of a path, in the order of
+  // FilePath::GetComponents().
+  class BASE_EXPORT ComponentIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = StringPieceType;
+    using difference_type = ptrdiff_t;
+    using pointer = const StringPieceType*;
+    using reference = const StringPieceType&;
+
+    // Constructs the end iterator.
+    ComponentIterator();
+
+    reference operator*() const { return component_; }
+    pointer operator->() const { return &component_; }
+
+    ComponentIterator& operator++();
+    ComponentIterator operator++(int);
+
+    bool operator==(const ComponentIterator& other) const {
+      return component_.data() == other.component_.data() &&
+             component_.size() == other.component_.size();
+    }
+    bool operator!=(const ComponentIterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class FilePathView;
+
+    // Iterates over |drive| and |root| if they aren't empty, then over the
+    // components separated by separators in |rest|.
+    ComponentIterator(StringPieceType drive,
+                      StringPieceType root,
+                      StringPieceType rest);
+
+    StringPieceType drive_;
+    StringPieceType root_;
+    StringPieceType rest_;
+    // Empty only at the end.
+    StringPieceType component_;
+  };
+
+  // The range returned by GetComponents().
+  class Components {
+   public:
+    ComponentIterator begin() const { return begin_; }
+    ComponentIterator end() const { return ComponentIterator(); }
+
+   private:
+    friend class FilePathView;
+
+    explicit Components(ComponentIterator begin) : begin_(begin) {}
+
+    ComponentIterator begin_;
+  };
+
+  FilePathView() = default;
+  FilePathView(const FilePath& path) : path_(path.value()) {}
+  // Like FilePath, a view of a string with a NUL only views the characters
+  // before it.
+  explicit FilePathView(StringPieceType path);
+
+  const StringPieceType& value() const { return path_; }
+  bool empty() const { return path_.empty(); }
+
+  // The same as the methods of FilePath with the same names.
+  FilePathView DirName() const WARN_UNUSED_RESULT;
+  FilePathView BaseName() const WARN_UNUSED_RESULT;
+  StringPieceType Extension() const WARN_UNUSED_RESULT;
+  StringPieceType FinalExtension() const WARN_UNUSED_RESULT;
+  FilePathView RemoveExtension() const WARN_UNUSED_RESULT;
+  FilePathView RemoveFinalExtension() const WARN_UNUSED_RESULT;
+  bool MatchesExtension(StringPieceType extension) const;
+  bool IsAbsolute() const;
+  bool EndsWithSeparator() const;
+  FilePathView StripTrailingSeparators() const WARN_UNUSED_RESULT;
+
+  // Returns the components of the path, as FilePath::GetComponents() does but
+  // without copying them.
+  Components GetComponents() const;
+
+ private:
+  StringPieceType path_;
+};
+
 }  // namespace base
 
 // Macros for string literal initialization of FilePath::CharType[], and for
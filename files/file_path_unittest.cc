@@ -316,6 +316,11 @@ TEST_F(FilePathTest, Append) {
     FilePath observed_path = root.Append(FilePath(leaf));
     EXPECT_EQ(FilePath::StringType(cases[i].expected), observed_path.value()) <<
               "i: " << i << ", root: " << root.value() << ", leaf: " << leaf;
+    FilePath observed_in_place = root;
+    observed_in_place.AppendInPlace(leaf);
+    EXPECT_EQ(FilePath::StringType(cases[i].expected),
+              observed_in_place.value()) <<
+              "i: " << i << ", root: " << root.value() << ", leaf: " << leaf;
 
     // TODO(erikkay): It would be nice to have a unicode test append value to
     // handle the case when AppendASCII is passed UTF8
@@ -512,6 +517,15 @@ TEST_F(FilePathTest, PathComponentsTest) {
     }
     EXPECT_EQ(FilePath::StringType(cases[i].expected), observed) <<
               "i: " << i << ", input: " << input.value();
+
+    FilePath::StringType observed_view;
+    for (FilePath::StringPieceType component :
+         FilePathView(input).GetComponents()) {
+      observed_view.append(FILE_PATH_LITERAL("|"), 1);
+      component.AppendToString(&observed_view);
+    }
+    EXPECT_EQ(FilePath::StringType(cases[i].expected), observed_view) <<
+              "i: " << i << ", input: " << input.value();
   }
 }
 
@@ -1179,6 +1193,66 @@ TEST_F(FilePathTest, AppendWithNUL) {
 #endif
 }
 
+TEST_F(FilePathTest, AppendInPlaceWithNUL) {
+  FilePath path(FPL("a"));
+  path.AppendInPlace(FPS("b\0b"));
+#if defined(FILE_PATH_USES_WIN_SEPARATORS)
+  EXPECT_EQ(FPL("a\\b"), path.value());
+#else
+  EXPECT_EQ(FPL("a/b"), path.value());
+#endif
+
+  FilePath current(FilePath::kCurrentDirectory);
+  current.AppendInPlace(FPS("b\0b"));
+  EXPECT_EQ(FPL("b"), current.value());
+}
+
+TEST_F(FilePathTest, ViewWithNUL) {
+  const FilePath::StringType path = FPS("a/b\0c");
+  FilePathView view(path);
+  EXPECT_EQ(FPL("a/b"), view.value().as_string());
+  EXPECT_EQ(FPL("b"), view.BaseName().value().as_string());
+}
+
+TEST_F(FilePathTest, ViewQueriesDontCopy) {
+  const FilePath path(FPL("/aa/bb/cc.tar.gz"));
+  const FilePath::CharType* data = path.value().data();
+  FilePathView view(path);
+  EXPECT_EQ(data, view.value().data());
+
+  FilePathView dir = view.DirName();
+  EXPECT_EQ(FPL("/aa/bb"), dir.value().as_string());
+  EXPECT_EQ(data, dir.value().data());
+
+  FilePathView base = view.BaseName();
+  EXPECT_EQ(FPL("cc.tar.gz"), base.value().as_string());
+  EXPECT_EQ(data + 7, base.value().data());
+
+  EXPECT_EQ(FPL(".tar.gz"), view.Extension().as_string());
+  EXPECT_EQ(data + 9, view.Extension().data());
+  EXPECT_EQ(FPL(".gz"), view.FinalExtension().as_string());
+  EXPECT_EQ(FPL("/aa/bb/cc"), view.RemoveExtension().value().as_string());
+  EXPECT_EQ(FPL("/aa/bb/cc.tar"),
+            view.RemoveFinalExtension().value().as_string());
+  EXPECT_TRUE(view.MatchesExtension(FPL(".TAR.GZ")));
+  EXPECT_TRUE(view.IsAbsolute());
+  EXPECT_FALSE(view.EndsWithSeparator());
+
+  std::vector<FilePath::StringPieceType> components(
+      view.GetComponents().begin(), view.GetComponents().end());
+  ASSERT_EQ(4u, components.size());
+  EXPECT_EQ(FPL("/"), components[0].as_string());
+  EXPECT_EQ(data, components[0].data());
+  EXPECT_EQ(data + 1, components[1].data());
+  EXPECT_EQ(data + 4, components[2].data());
+  EXPECT_EQ(base.value(), components[3]);
+  EXPECT_EQ(base.value().data(), components[3].data());
+
+  // The current directory has to come from elsewhere.
+  EXPECT_EQ(FilePath::kCurrentDirectory,
+            FilePathView(FilePath(FPL("aa"))).DirName().value().as_string());
+}
+
 TEST_F(FilePathTest, ReferencesParentWithNUL) {
   // Assert FPS() works.
   ASSERT_EQ(3U, FPS("..\0").length());
@@ -7,6 +7,7 @@
 
 #include "base/files/file_path_watcher.h"
 
+#include "base/bind.h"
 #include "base/logging.h"
 #include "build/build_config.h"
 
@@ -28,8 +29,8 @@ bool FilePathWatcher::RecursiveWatchAvailable() {
 #endif
 }
 
-FilePathWatcher::PlatformDelegate::PlatformDelegate(): cancelled_(false) {
-}
+FilePathWatcher::PlatformDelegate::PlatformDelegate()
+    : cancelled_(false), report_changed_paths_(false) {}
 
 FilePathWatcher::PlatformDelegate::~PlatformDelegate() {
   DCHECK(is_cancelled());
@@ -43,4 +44,46 @@ bool FilePathWatcher::Watch(const FilePath& path,
   return impl_->Watch(path, recursive, callback);
 }
 
+bool FilePathWatcher::WatchCoalesced(const FilePath& path,
+                                     bool recursive,
+                                     TimeDelta window,
+                                     const ChangesCallback& callback) {
+  DCHECK(sequence_checker_.CalledOnValidSequence());
+  DCHECK(path.IsAbsolute());
+  DCHECK(!changes_callback_);
+  changes_callback_ = callback;
+  coalescing_window_ = window;
+  impl_->report_changed_paths_ = true;
+  // |impl_| is cancelled before |this| goes away, so the callback can't run
+  // after that.
+  return impl_->Watch(
+      path, recursive,
+      BindRepeating(&FilePathWatcher::OnChangeToCoalesce, Unretained(this)));
+}
+
+void FilePathWatcher::OnChangeToCoalesce(const FilePath& path, bool error) {
+  DCHECK(sequence_checker_.CalledOnValidSequence());
+  pending_changes_.insert(path);
+  if (error) {
+    // No change follows an error, so there is no point in waiting.
+    coalescing_timer_.Stop();
+    RunChangesCallback(true);
+    return;
+  }
+  if (!coalescing_timer_.IsRunning()) {
+    coalescing_timer_.Start(
+        FROM_HERE, coalescing_window_,
+        BindRepeating(&FilePathWatcher::RunChangesCallback, Unretained(this),
+                      false));
+  }
+}
+
+void FilePathWatcher::RunChangesCallback(bool error) {
+  DCHECK(sequence_checker_.CalledOnValidSequence());
+  std::vector<FilePath> paths(pending_changes_.begin(),
+                              pending_changes_.end());
+  pending_changes_.clear();
+  changes_callback_.Run(paths, error);
+}
+
 }  // namespace base
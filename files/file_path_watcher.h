@@ -8,6 +8,8 @@
 #define BASE_FILES_FILE_PATH_WATCHER_H_
 
 #include <memory>
+#include <set>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/callback.h"
@@ -16,6 +18,8 @@
 #include "base/memory/ref_counted.h"
 #include "base/sequence_checker.h"
 #include "base/sequenced_task_runner.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 
 namespace base {
 
@@ -37,6 +41,11 @@ class BASE_EXPORT FilePathWatcher {
   // that case, the callback won't be invoked again.
   typedef base::Callback<void(const FilePath& path, bool error)> Callback;
 
+  // Callback type for WatchCoalesced(). |paths| are the paths which changed,
+  // each of them once, sorted.
+  using ChangesCallback =
+      RepeatingCallback<void(const std::vector<FilePath>& paths, bool error)>;
+
   // Used internally to encapsulate different members on different platforms.
   class PlatformDelegate {
    public:
@@ -63,6 +72,11 @@ class BASE_EXPORT FilePathWatcher {
       task_runner_ = std::move(runner);
     }
 
+    // Whether the callback should get the path of the file which changed
+    // under the watched path, rather than the watched path itself. Only
+    // implementations which can tell which file changed look at this.
+    bool report_changed_paths() const { return report_changed_paths_; }
+
     // Must be called before the PlatformDelegate is deleted.
     void set_cancelled() {
       cancelled_ = true;
@@ -75,6 +89,7 @@ class BASE_EXPORT FilePathWatcher {
    private:
     scoped_refptr<SequencedTaskRunner> task_runner_;
     bool cancelled_;
+    bool report_changed_paths_;
 
     DISALLOW_COPY_AND_ASSIGN(PlatformDelegate);
   };
@@ -97,9 +112,29 @@ class BASE_EXPORT FilePathWatcher {
   // Watch() will return false in the case of failure.
   bool Watch(const FilePath& path, bool recursive, const Callback& callback);
 
+  // Like Watch(), but for directories whose files change in bursts: the
+  // changes seen within |window| of the first one are delivered together to
+  // |callback|, which runs at most once per |window|. On Linux, |paths| are
+  // the watched path, or the files and directories which changed under it,
+  // where Watch() would only report the watched path. Elsewhere, it is always
+  // the watched path.
+  bool WatchCoalesced(const FilePath& path,
+                      bool recursive,
+                      TimeDelta window,
+                      const ChangesCallback& callback);
+
  private:
+  void OnChangeToCoalesce(const FilePath& path, bool error);
+  void RunChangesCallback(bool error);
+
   std::unique_ptr<PlatformDelegate> impl_;
 
+  // Used by WatchCoalesced().
+  ChangesCallback changes_callback_;
+  TimeDelta coalescing_window_;
+  std::set<FilePath> pending_changes_;
+  OneShotTimer coalescing_timer_;
+
   SequenceChecker sequence_checker_;
 
   DISALLOW_COPY_AND_ASSIGN(FilePathWatcher);
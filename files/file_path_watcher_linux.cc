@@ -45,6 +45,18 @@ namespace {
 class FilePathWatcherImpl;
 class InotifyReader;
 
+// An inotify event, as seen by one watcher.
+struct InotifyChange {
+  int watch;
+  FilePath::StringType child;
+  // |created| is true if the object appears.
+  // |deleted| is true if the object disappears.
+  // |is_dir| is true if the object is a directory.
+  bool created;
+  bool deleted;
+  bool is_dir;
+};
+
 class InotifyReaderThreadDelegate final : public PlatformThread::Delegate {
  public:
   InotifyReaderThreadDelegate(int inotify_fd) : inotify_fd_(inotify_fd){};
@@ -74,8 +86,9 @@ class InotifyReader {
   // Remove |watch| if it's valid.
   void RemoveWatch(Watch watch, FilePathWatcherImpl* watcher);
 
-  // Callback for InotifyReaderTask.
-  void OnInotifyEvent(const inotify_event* event);
+  // Callback for InotifyReaderTask, with all the events read at once, which
+  // are dispatched with one task per watcher.
+  void OnInotifyEvents(const char* buffer, size_t size);
 
  private:
   friend struct LazyInstanceTraitsBase<InotifyReader>;
@@ -113,20 +126,13 @@ class FilePathWatcherImpl : public FilePathWatcher::PlatformDelegate {
   FilePathWatcherImpl();
   ~FilePathWatcherImpl() override;
 
-  // Called for each event coming from the watch. |fired_watch| identifies the
-  // watch that fired, |child| indicates what has changed, and is relative to
-  // the currently watched path for |fired_watch|.
-  //
-  // |created| is true if the object appears.
-  // |deleted| is true if the object disappears.
-  // |is_dir| is true if the object is a directory.
-  void OnFilePathChanged(InotifyReader::Watch fired_watch,
-                         const FilePath::StringType& child,
-                         bool created,
-                         bool deleted,
-                         bool is_dir);
+  // Called with the events coming from the watches, in order. For each of
+  // them, |watch| identifies the watch that fired, and |child| indicates what
+  // has changed, and is relative to the currently watched path for |watch|.
+  void OnFilePathsChanged(std::vector<InotifyChange> changes);
 
  private:
+  void OnFilePathsChangedOnOriginSequence(std::vector<InotifyChange> changes);
   void OnFilePathChangedOnOriginSequence(InotifyReader::Watch fired_watch,
                                          const FilePath::StringType& child,
                                          bool created,
@@ -257,14 +263,7 @@ void InotifyReaderThreadDelegate::ThreadMain() {
       return;
     }
 
-    ssize_t i = 0;
-    while (i < bytes_read) {
-      inotify_event* event = reinterpret_cast<inotify_event*>(&buffer[i]);
-      size_t event_size = sizeof(inotify_event) + event->len;
-      DCHECK(i + event_size <= static_cast<size_t>(bytes_read));
-      g_inotify_reader.Get().OnInotifyEvent(event);
-      i += event_size;
-    }
+    g_inotify_reader.Get().OnInotifyEvents(&buffer[0], bytes_read);
   }
 }
 
@@ -323,22 +322,45 @@ void InotifyReader::RemoveWatch(Watch watch, FilePathWatcherImpl* watcher) {
   }
 }
 
-void InotifyReader::OnInotifyEvent(const inotify_event* event) {
-  if (event->mask & IN_IGNORED)
-    return;
+void InotifyReader::OnInotifyEvents(const char* buffer, size_t size) {
+  std::unordered_map<FilePathWatcherImpl*, std::vector<InotifyChange>> changes;
+  // A file being rewritten sends several events, which all mean that it was
+  // modified, and only the first of them is kept. Creations and deletions
+  // are all kept, since the watchers update their watches on them.
+  std::set<std::pair<Watch, FilePath::StringType>> modified;
 
-  FilePath::StringType child(event->len ? event->name : FILE_PATH_LITERAL(""));
   AutoLock auto_lock(lock_);
 
-  for (WatcherSet::iterator watcher = watchers_[event->wd].begin();
-       watcher != watchers_[event->wd].end();
-       ++watcher) {
-    (*watcher)->OnFilePathChanged(event->wd,
-                                  child,
-                                  event->mask & (IN_CREATE | IN_MOVED_TO),
-                                  event->mask & (IN_DELETE | IN_MOVED_FROM),
-                                  event->mask & IN_ISDIR);
+  size_t i = 0;
+  while (i < size) {
+    const inotify_event* event =
+        reinterpret_cast<const inotify_event*>(&buffer[i]);
+    size_t event_size = sizeof(inotify_event) + event->len;
+    DCHECK(i + event_size <= size);
+    i += event_size;
+
+    if (event->mask & IN_IGNORED)
+      continue;
+    auto it = watchers_.find(event->wd);
+    if (it == watchers_.end())
+      continue;
+
+    InotifyChange change = {
+        event->wd, event->len ? event->name : FILE_PATH_LITERAL(""),
+        (event->mask & (IN_CREATE | IN_MOVED_TO)) != 0,
+        (event->mask & (IN_DELETE | IN_MOVED_FROM)) != 0,
+        (event->mask & IN_ISDIR) != 0};
+    if (!change.created && !change.deleted &&
+        !modified.emplace(change.watch, change.child).second) {
+      continue;
+    }
+    for (FilePathWatcherImpl* watcher : it->second)
+      changes[watcher].push_back(change);
   }
+
+  for (auto& watcher_changes : changes)
+    watcher_changes.first->OnFilePathsChanged(
+        std::move(watcher_changes.second));
 }
 
 FilePathWatcherImpl::FilePathWatcherImpl()
@@ -350,11 +372,8 @@ FilePathWatcherImpl::~FilePathWatcherImpl() {
   DCHECK(!task_runner() || task_runner()->RunsTasksInCurrentSequence());
 }
 
-void FilePathWatcherImpl::OnFilePathChanged(InotifyReader::Watch fired_watch,
-                                            const FilePath::StringType& child,
-                                            bool created,
-                                            bool deleted,
-                                            bool is_dir) {
+void FilePathWatcherImpl::OnFilePathsChanged(
+    std::vector<InotifyChange> changes) {
   DCHECK(!task_runner()->RunsTasksInCurrentSequence());
 
   // This method is invoked on the Inotify thread. Switch to task_runner() to
@@ -362,8 +381,23 @@ void FilePathWatcherImpl::OnFilePathChanged(InotifyReader::Watch fired_watch,
   // running after |this| is destroyed (i.e. after the watch is cancelled).
   task_runner()->PostTask(
       FROM_HERE,
-      BindOnce(&FilePathWatcherImpl::OnFilePathChangedOnOriginSequence,
-               weak_ptr_, fired_watch, child, created, deleted, is_dir));
+      BindOnce(&FilePathWatcherImpl::OnFilePathsChangedOnOriginSequence,
+               weak_ptr_, std::move(changes)));
+}
+
+void FilePathWatcherImpl::OnFilePathsChangedOnOriginSequence(
+    std::vector<InotifyChange> changes) {
+  DCHECK(task_runner()->RunsTasksInCurrentSequence());
+
+  // The callback may delete |this|.
+  WeakPtr<FilePathWatcherImpl> self = weak_ptr_;
+  for (const InotifyChange& change : changes) {
+    OnFilePathChangedOnOriginSequence(change.watch, change.child,
+                                      change.created, change.deleted,
+                                      change.is_dir);
+    if (!self || is_cancelled())
+      return;
+  }
 }
 
 void FilePathWatcherImpl::OnFilePathChangedOnOriginSequence(
@@ -442,15 +476,27 @@ void FilePathWatcherImpl::OnFilePathChangedOnOriginSequence(
         UpdateRecursiveWatches(fired_watch, is_dir);
         did_update = true;
       }
-      callback_.Run(target_, false /* error */);
+      // A change in the watched directory itself can name the entry which
+      // changed in it.
+      FilePath changed_path = target_;
+      if (report_changed_paths() && watch_entry.subdir.empty() &&
+          watch_entry.linkname.empty() && !child.empty()) {
+        changed_path = target_.Append(child);
+      }
+      callback_.Run(changed_path, false /* error */);
       return;
     }
   }
 
-  if (ContainsKey(recursive_paths_by_watch_, fired_watch)) {
+  auto recursive_path = recursive_paths_by_watch_.find(fired_watch);
+  if (recursive_path != recursive_paths_by_watch_.end()) {
+    // Copied, since the update below may remove the watch.
+    FilePath changed_path = target_;
+    if (report_changed_paths())
+      changed_path = recursive_path->second.Append(child);
     if (!did_update)
       UpdateRecursiveWatches(fired_watch, is_dir);
-    callback_.Run(target_, false /* error */);
+    callback_.Run(changed_path, false /* error */);
   }
 }
 
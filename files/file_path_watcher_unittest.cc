@@ -11,7 +11,9 @@
 #include <sys/stat.h>
 #endif
 
+#include <algorithm>
 #include <set>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/bind_helpers.h"
@@ -25,6 +27,7 @@
 #include "base/run_loop.h"
 #include "base/single_thread_task_runner.h"
 #include "base/stl_util.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/test/test_file_util.h"
@@ -789,6 +792,46 @@ TEST_F(FilePathWatcherTest, LinkedDirectoryPart3) {
   ASSERT_TRUE(WaitForEvents());
 }
 
+// Verify that a burst of changes is delivered in a few batches which name the
+// files which changed.
+TEST_F(FilePathWatcherTest, WatchCoalesced) {
+  FilePath dir(temp_dir_.GetPath().AppendASCII("dir"));
+  FilePath subdir(dir.AppendASCII("subdir"));
+  ASSERT_TRUE(base::CreateDirectory(subdir));
+
+  std::set<FilePath> expected;
+  std::set<FilePath> changed;
+  int batches = 0;
+  RunLoop run_loop;
+  FilePathWatcher watcher;
+  ASSERT_TRUE(watcher.WatchCoalesced(
+      dir, true /* recursive */, TestTimeouts::tiny_timeout(),
+      BindRepeating(
+          [](const std::set<FilePath>* expected, std::set<FilePath>* changed,
+             int* batches, const Closure& quit_closure,
+             const std::vector<FilePath>& paths, bool error) {
+            EXPECT_FALSE(error);
+            EXPECT_TRUE(std::is_sorted(paths.begin(), paths.end()));
+            ++*batches;
+            changed->insert(paths.begin(), paths.end());
+            if (std::includes(changed->begin(), changed->end(),
+                              expected->begin(), expected->end())) {
+              quit_closure.Run();
+            }
+          },
+          &expected, &changed, &batches, run_loop.QuitClosure())));
+
+  for (int i = 0; i < 100; ++i) {
+    FilePath file = (i % 2 ? dir : subdir).AppendASCII(IntToString(i));
+    expected.insert(file);
+    ASSERT_TRUE(WriteFile(file, "content"));
+    ASSERT_TRUE(WriteFile(file, "content v2"));
+  }
+  run_loop.Run();
+  // Each file was written twice, and sent several events each time.
+  EXPECT_LT(batches, 100);
+}
+
 #endif  // OS_LINUX
 
 enum Permission {
@@ -12,8 +12,14 @@
 #include "base/files/file_util.h"
 #include "base/location.h"
 #include "base/macros.h"
+#include "base/memory/ptr_util.h"
 #include "base/task_runner.h"
 #include "base/task_runner_util.h"
+#include "build/build_config.h"
+
+#if defined(OS_LINUX)
+#include "base/files/io_uring_linux.h"
+#endif
 
 namespace {
 
@@ -192,6 +198,41 @@ class ReadHelper : public FileHelper {
     std::move(callback).Run(error_, buffer_.get(), bytes_read_);
   }
 
+#if defined(OS_LINUX)
+  // Reads the rest of the range through |ring|, as many times as it takes
+  // File::Read() to read it all, then replies.
+  static void RunAsyncWork(std::unique_ptr<ReadHelper> helper,
+                           SharedIoUring* ring,
+                           int64_t offset,
+                           FileProxy::ReadCallback callback) {
+    ReadHelper* raw = helper.get();
+    ring->Read(raw->file_.GetPlatformFile(), offset + raw->bytes_read_,
+               raw->buffer_.get() + raw->bytes_read_,
+               raw->bytes_to_read_ - raw->bytes_read_,
+               BindOnce(&ReadHelper::OnAsyncWorkDone, std::move(helper), ring,
+                        offset, std::move(callback)));
+  }
+
+  static void OnAsyncWorkDone(std::unique_ptr<ReadHelper> helper,
+                              SharedIoUring* ring,
+                              int64_t offset,
+                              FileProxy::ReadCallback callback,
+                              int result) {
+    if (result < 0) {
+      helper->bytes_read_ = -1;
+      helper->error_ = File::FILE_ERROR_FAILED;
+    } else {
+      helper->bytes_read_ += result;
+      if (result > 0 && helper->bytes_read_ < helper->bytes_to_read_) {
+        RunAsyncWork(std::move(helper), ring, offset, std::move(callback));
+        return;
+      }
+      helper->error_ = File::FILE_OK;
+    }
+    helper->Reply(std::move(callback));
+  }
+#endif  // defined(OS_LINUX)
+
  private:
   std::unique_ptr<char[]> buffer_;
   int bytes_to_read_;
@@ -222,6 +263,41 @@ class WriteHelper : public FileHelper {
       std::move(callback).Run(error_, bytes_written_);
   }
 
+#if defined(OS_LINUX)
+  // Writes the rest of the buffer through |ring|, as many times as it takes
+  // File::Write() to write it all, then replies.
+  static void RunAsyncWork(std::unique_ptr<WriteHelper> helper,
+                           SharedIoUring* ring,
+                           int64_t offset,
+                           FileProxy::WriteCallback callback) {
+    WriteHelper* raw = helper.get();
+    ring->Write(raw->file_.GetPlatformFile(), offset + raw->bytes_written_,
+                raw->buffer_.get() + raw->bytes_written_,
+                raw->bytes_to_write_ - raw->bytes_written_,
+                BindOnce(&WriteHelper::OnAsyncWorkDone, std::move(helper),
+                         ring, offset, std::move(callback)));
+  }
+
+  static void OnAsyncWorkDone(std::unique_ptr<WriteHelper> helper,
+                              SharedIoUring* ring,
+                              int64_t offset,
+                              FileProxy::WriteCallback callback,
+                              int result) {
+    if (result < 0) {
+      helper->bytes_written_ = -1;
+      helper->error_ = File::FILE_ERROR_FAILED;
+    } else {
+      helper->bytes_written_ += result;
+      if (result > 0 && helper->bytes_written_ < helper->bytes_to_write_) {
+        RunAsyncWork(std::move(helper), ring, offset, std::move(callback));
+        return;
+      }
+      helper->error_ = File::FILE_OK;
+    }
+    helper->Reply(std::move(callback));
+  }
+#endif  // defined(OS_LINUX)
+
  private:
   std::unique_ptr<char[]> buffer_;
   int bytes_to_write_;
@@ -306,6 +382,15 @@ bool FileProxy::Read(int64_t offset, int bytes_to_read, ReadCallback callback) {
     return false;
 
   ReadHelper* helper = new ReadHelper(this, std::move(file_), bytes_to_read);
+#if defined(OS_LINUX)
+  if (prefer_io_uring_) {
+    if (SharedIoUring* ring = SharedIoUring::Get()) {
+      ReadHelper::RunAsyncWork(WrapUnique(helper), ring, offset,
+                               std::move(callback));
+      return true;
+    }
+  }
+#endif
   return task_runner_->PostTaskAndReply(
       FROM_HERE, BindOnce(&ReadHelper::RunWork, Unretained(helper), offset),
       BindOnce(&ReadHelper::Reply, Owned(helper), std::move(callback)));
@@ -321,6 +406,15 @@ bool FileProxy::Write(int64_t offset,
 
   WriteHelper* helper =
       new WriteHelper(this, std::move(file_), buffer, bytes_to_write);
+#if defined(OS_LINUX)
+  if (prefer_io_uring_) {
+    if (SharedIoUring* ring = SharedIoUring::Get()) {
+      WriteHelper::RunAsyncWork(WrapUnique(helper), ring, offset,
+                                std::move(callback));
+      return true;
+    }
+  }
+#endif
   return task_runner_->PostTaskAndReply(
       FROM_HERE, BindOnce(&WriteHelper::RunWork, Unretained(helper), offset),
       BindOnce(&WriteHelper::Reply, Owned(helper), std::move(callback)));
@@ -93,6 +93,13 @@ class BASE_EXPORT FileProxy : public SupportsWeakPtr<FileProxy> {
 
   PlatformFile GetPlatformFile() const;
 
+  // On Linux kernels with io_uring, makes Read() and Write() go through a
+  // process-wide io_uring instead of blocking a thread of |task_runner|. The
+  // operations started in the same task are then submitted to the kernel
+  // together, and the callbacks still run on the current sequence. Elsewhere
+  // this has no effect.
+  void set_prefer_io_uring(bool prefer) { prefer_io_uring_ = prefer; }
+
   // Proxies File::Close. The callback can be null.
   // This returns false if task posting to |task_runner| has failed.
   bool Close(StatusCallback callback);
@@ -134,6 +141,7 @@ class BASE_EXPORT FileProxy : public SupportsWeakPtr<FileProxy> {
 
   scoped_refptr<TaskRunner> task_runner_;
   File file_;
+  bool prefer_io_uring_ = false;
   DISALLOW_COPY_AND_ASSIGN(FileProxy);
 };
 
@@ -310,6 +310,29 @@ TEST_F(FileProxyTest, WriteAndFlush) {
   }
 }
 
+// Falls back to |file_task_runner()| where io_uring isn't supported.
+TEST_F(FileProxyTest, WriteAndReadWithIoUring) {
+  FileProxy proxy(file_task_runner());
+  proxy.set_prefer_io_uring(true);
+  CreateProxy(File::FLAG_CREATE | File::FLAG_READ | File::FLAG_WRITE, &proxy);
+
+  const char data[] = "io_uring";
+  int data_bytes = arraysize(data);
+  proxy.Write(3, data, data_bytes,
+              BindOnce(&FileProxyTest::DidWrite, weak_factory_.GetWeakPtr()));
+  RunLoop().Run();
+  EXPECT_EQ(File::FILE_OK, error_);
+  EXPECT_EQ(data_bytes, bytes_written_);
+
+  proxy.Read(3, 128,
+             BindOnce(&FileProxyTest::DidRead, weak_factory_.GetWeakPtr()));
+  RunLoop().Run();
+  EXPECT_EQ(File::FILE_OK, error_);
+  ASSERT_EQ(data_bytes, static_cast<int>(buffer_.size()));
+  for (int i = 0; i < data_bytes; ++i)
+    EXPECT_EQ(data[i], buffer_[i]);
+}
+
 #if defined(OS_ANDROID)
 // Flaky on Android, see http://crbug.com/489602
 #define MAYBE_SetTimes DISABLED_SetTimes
@@ -9,9 +9,12 @@
 #endif
 #include <stdio.h>
 
+#include <algorithm>
 #include <fstream>
 #include <limits>
+#include <memory>
 
+#include "base/callback.h"
 #include "base/files/file_enumerator.h"
 #include "base/files/file_path.h"
 #include "base/logging.h"
@@ -136,28 +139,47 @@ bool ReadFileToStringWithMaxSize(const FilePath& path,
     return false;
   }
 
-  const size_t kBufferSize = 1 << 16;
-  std::unique_ptr<char[]> buf(new char[kBufferSize]);
-  size_t len;
-  size_t size = 0;
-  bool read_status = true;
-
   // Many files supplied in |path| have incorrect size (proc files etc).
-  // Hence, the file is read sequentially as opposed to a one-shot read.
-  while ((len = fread(buf.get(), 1, kBufferSize, file)) > 0) {
-    if (contents)
-      contents->append(buf.get(), std::min(len, max_size - size));
+  // Hence, the file is read sequentially as opposed to a one-shot read, but
+  // straight into the string, and the size of the file, if it is known, sizes
+  // the first read so that most files take only one.
+  const size_t kDefaultChunkSize = 1 << 16;
+  size_t chunk_size = kDefaultChunkSize;
+#if !defined(OS_NACL_NONSFI)
+  int64_t file_size;
+  if (GetFileSize(path, &file_size) && file_size > 0) {
+    // One more byte than expected, so that the first read reaches the end of
+    // the file, and no second read is needed to find that out.
+    uint64_t size_hint = std::min<uint64_t>(file_size, max_size);
+    if (size_hint < std::numeric_limits<size_t>::max())
+      chunk_size = static_cast<size_t>(size_hint) + 1;
+  }
+#endif  // !defined(OS_NACL_NONSFI)
 
+  std::string local_contents;
+  size_t size = 0;
+  bool read_status = true;
+  for (;;) {
+    local_contents.resize(size + chunk_size);
+    size_t len = fread(&local_contents[size], 1, chunk_size, file);
     if ((max_size - size) < len) {
+      size = max_size;
       read_status = false;
       break;
     }
-
     size += len;
+    // Checking the flag saves a read() which would return 0.
+    if (len < chunk_size || feof(file))
+      break;
+    chunk_size = kDefaultChunkSize;
   }
   read_status = read_status && !ferror(file);
   CloseFile(file);
 
+  if (contents) {
+    local_contents.resize(size);
+    contents->swap(local_contents);
+  }
   return read_status;
 }
 
@@ -167,6 +189,33 @@ bool ReadFileToString(const FilePath& path, std::string* contents) {
 }
 
 #if !defined(OS_NACL_NONSFI)
+bool ReadFileInChunks(const FilePath& path,
+                      size_t chunk_size,
+                      const ReadFileChunkCallback& callback) {
+  DCHECK_GT(chunk_size, 0u);
+  if (path.ReferencesParent())
+    return false;
+  File file(path, File::FLAG_OPEN | File::FLAG_READ |
+                      File::FLAG_SEQUENTIAL_SCAN);
+  if (!file.IsValid())
+    return false;
+
+  const int buffer_size = static_cast<int>(
+      std::min<size_t>(chunk_size, std::numeric_limits<int>::max()));
+  std::unique_ptr<uint8_t[]> buffer(new uint8_t[buffer_size]);
+  for (;;) {
+    int bytes_read =
+        file.ReadAtCurrentPos(reinterpret_cast<char*>(buffer.get()),
+                              buffer_size);
+    if (bytes_read < 0)
+      return false;
+    if (bytes_read == 0)
+      return true;
+    if (!callback.Run(make_span(buffer.get(), bytes_read)))
+      return false;
+  }
+}
+
 bool IsDirectoryEmpty(const FilePath& dir_path) {
   FileEnumerator files(dir_path, false,
       FileEnumerator::FILES | FileEnumerator::DIRECTORIES);
@@ -17,6 +17,8 @@
 #include <vector>
 
 #include "base/base_export.h"
+#include "base/callback_forward.h"
+#include "base/containers/span.h"
 #include "base/files/file.h"
 #include "base/files/file_path.h"
 #include "base/strings/string16.h"
@@ -115,8 +117,29 @@ BASE_EXPORT bool ReplaceFile(const FilePath& from_path,
 //   Always 0600.
 // - On ChromeOS, |to_path| has user read/write permissions and group/others
 //   read permissions. i.e. Always 0644.
+//
+// On Linux and Android, the data is copied by the kernel where possible: the
+// file is cloned on file systems which support reflinks, or copied with
+// copy_file_range() or sendfile(), so that it doesn't go through a userspace
+// buffer.
 BASE_EXPORT bool CopyFile(const FilePath& from_path, const FilePath& to_path);
 
+#if defined(OS_POSIX)
+// Runs with the number of bytes copied so far and the size of the source
+// file, or -1 when that isn't known. Returning false cancels the copy.
+using CopyFileProgressCallback =
+    RepeatingCallback<bool(int64_t bytes_copied, int64_t total_bytes)>;
+
+// Like CopyFile(), but runs |progress| as the copy goes on. Returns false if
+// the copy fails or is cancelled, in which case |to_path| may be left
+// partially written. On Mac, the permissions of |to_path| are those it gets
+// on Linux rather than those of CopyFile(). FileCopier runs this on a worker
+// and reports the progress to the calling sequence.
+BASE_EXPORT bool CopyFileWithProgress(const FilePath& from_path,
+                                      const FilePath& to_path,
+                                      const CopyFileProgressCallback& progress);
+#endif  // defined(OS_POSIX)
+
 // Copies the given path, and optionally all subdirectories and their contents
 // as well.
 //
@@ -178,6 +201,21 @@ BASE_EXPORT bool ReadFileToStringWithMaxSize(const FilePath& path,
                                              std::string* contents,
                                              size_t max_size);
 
+// Runs with the next chunk of the file read by ReadFileInChunks(). The chunk
+// is only valid during the call. Returning false stops the reading.
+using ReadFileChunkCallback =
+    RepeatingCallback<bool(span<const uint8_t> chunk)>;
+
+// Reads the file at |path| from start to end, in chunks of at most
+// |chunk_size| bytes, and feeds them to |callback|, reusing one buffer. This
+// is how to parse large files without holding all of them in memory. Returns
+// true if the whole file was read, and false if it couldn't be opened or read
+// or if |callback| stopped the reading. Like ReadFileToString(), this fails on
+// a |path| containing path traversal components ('..').
+BASE_EXPORT bool ReadFileInChunks(const FilePath& path,
+                                  size_t chunk_size,
+                                  const ReadFileChunkCallback& callback);
+
 #if defined(OS_POSIX)
 
 // Read exactly |bytes| bytes from file descriptor |fd|, storing the result
@@ -13,6 +13,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/param.h>
 #include <sys/stat.h>
@@ -22,6 +23,7 @@
 #include <unistd.h>
 
 #include "base/base_switches.h"
+#include "base/callback.h"
 #include "base/command_line.h"
 #include "base/containers/stack.h"
 #include "base/environment.h"
@@ -49,6 +51,16 @@
 #include "base/mac/foundation_util.h"
 #endif
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <linux/fs.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+
+#if !defined(FICLONE)
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+#endif
+
 #if defined(OS_ANDROID)
 #include "base/android/content_uri_utils.h"
 #include "base/os_compat_android.h"
@@ -181,7 +193,105 @@ bool AdvanceEnumeratorWithStat(FileEnumerator* traversal,
   return true;
 }
 
-bool CopyFileContents(File* infile, File* outfile) {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+enum class KernelCopyResult { kDone, kFailed, kUnsupported };
+
+// Copies what remains of |infile| to |outfile| with copy_file_range(), or
+// sendfile() where that isn't available, so that the data doesn't go through
+// a userspace buffer. Returns kUnsupported when the kernel can't copy between
+// these files, leaving both positions where the copy stopped so that the
+// caller can go on with a read/write loop.
+KernelCopyResult KernelCopyFileContents(
+    File* infile,
+    File* outfile,
+    int64_t total_bytes,
+    int64_t* bytes_copied,
+    const CopyFileProgressCallback& progress) {
+  // Small enough for the progress to be reported, and a cancellation to be
+  // noticed, several times a second even on slow disks.
+  static constexpr size_t kChunkSize = 8 * 1024 * 1024;
+  const int in_fd = infile->GetPlatformFile();
+  const int out_fd = outfile->GetPlatformFile();
+
+  bool use_copy_file_range = true;
+  for (;;) {
+    ssize_t copied = -1;
+#if defined(__NR_copy_file_range)
+    if (use_copy_file_range) {
+      copied = HANDLE_EINTR(syscall(__NR_copy_file_range, in_fd, nullptr,
+                                    out_fd, nullptr, kChunkSize, 0));
+      // Older kernels can't copy between file systems, and some file systems
+      // don't implement it at all.
+      if (copied < 0 && (errno == ENOSYS || errno == EXDEV ||
+                         errno == EINVAL || errno == EOPNOTSUPP)) {
+        use_copy_file_range = false;
+      }
+    }
+#else
+    use_copy_file_range = false;
+#endif
+    if (!use_copy_file_range) {
+      copied = HANDLE_EINTR(sendfile(out_fd, in_fd, nullptr, kChunkSize));
+      if (copied < 0 && (errno == ENOSYS || errno == EINVAL))
+        return KernelCopyResult::kUnsupported;
+    }
+    if (copied < 0)
+      return KernelCopyResult::kFailed;
+    if (copied == 0) {
+      // Files whose size is made up, e.g. in /proc, look empty to the kernel
+      // copy, but not to read().
+      return *bytes_copied ? KernelCopyResult::kDone
+                           : KernelCopyResult::kUnsupported;
+    }
+
+    *bytes_copied += copied;
+    if (progress && !progress.Run(*bytes_copied, total_bytes))
+      return KernelCopyResult::kFailed;
+  }
+}
+#endif  // defined(OS_LINUX) || defined(OS_ANDROID)
+
+// Copies |infile| to |outfile| from their current positions, running
+// |progress|, if it isn't null, after each chunk.
+bool CopyFileContents(File* infile,
+                      File* outfile,
+                      const CopyFileProgressCallback& progress) {
+  int64_t total_bytes = -1;
+  int64_t bytes_copied = 0;
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  struct stat in_stat;
+  if (fstat(infile->GetPlatformFile(), &in_stat) == 0 &&
+      S_ISREG(in_stat.st_mode) && in_stat.st_size > 0) {
+    total_bytes = in_stat.st_size;
+
+    // Sharing the extents with a reflink is instant and takes no space, on
+    // the file systems which support it. It replaces the whole of |outfile|,
+    // so it is only right when both files are at their start.
+    if (lseek(infile->GetPlatformFile(), 0, SEEK_CUR) == 0 &&
+        lseek(outfile->GetPlatformFile(), 0, SEEK_CUR) == 0 &&
+        ioctl(outfile->GetPlatformFile(), FICLONE,
+              infile->GetPlatformFile()) == 0) {
+      return !progress || progress.Run(total_bytes, total_bytes);
+    }
+
+    switch (KernelCopyFileContents(infile, outfile, total_bytes,
+                                   &bytes_copied, progress)) {
+      case KernelCopyResult::kDone:
+        return true;
+      case KernelCopyResult::kFailed:
+        return false;
+      case KernelCopyResult::kUnsupported:
+        break;
+    }
+  }
+#else
+  struct stat in_stat;
+  if (fstat(infile->GetPlatformFile(), &in_stat) == 0 &&
+      S_ISREG(in_stat.st_mode)) {
+    total_bytes = in_stat.st_size;
+  }
+#endif
+
   static constexpr size_t kBufferSize = 32768;
   std::vector<char> buffer(kBufferSize);
 
@@ -201,6 +311,10 @@ bool CopyFileContents(File* infile, File* outfile) {
 
       bytes_written_per_read += bytes_written_partial;
     } while (bytes_written_per_read < bytes_read);
+
+    bytes_copied += bytes_read;
+    if (progress && !progress.Run(bytes_copied, total_bytes))
+      return false;
   }
 
   NOTREACHED();
@@ -338,7 +452,7 @@ bool DoCopyDirectory(const FilePath& from_path,
       return false;
     }
 
-    if (!CopyFileContents(&infile, &outfile)) {
+    if (!CopyFileContents(&infile, &outfile, CopyFileProgressCallback())) {
       DLOG(ERROR) << "CopyDirectory() couldn't copy file: " << current.value();
       return false;
     }
@@ -1028,9 +1142,11 @@ bool GetShmemTempDir(bool executable, FilePath* path) {
 }
 #endif  // !defined(OS_ANDROID)
 
-#if !defined(OS_MACOSX)
-// Mac has its own implementation, this is for all other Posix systems.
-bool CopyFile(const FilePath& from_path, const FilePath& to_path) {
+namespace {
+
+bool DoCopyFile(const FilePath& from_path,
+                const FilePath& to_path,
+                const CopyFileProgressCallback& progress) {
   AssertBlockingAllowed();
   File infile;
 #if defined(OS_ANDROID)
@@ -1049,10 +1165,24 @@ bool CopyFile(const FilePath& from_path, const FilePath& to_path) {
   if (!outfile.IsValid())
     return false;
 
-  return CopyFileContents(&infile, &outfile);
+  return CopyFileContents(&infile, &outfile, progress);
+}
+
+}  // namespace
+
+#if !defined(OS_MACOSX)
+// Mac has its own implementation, this is for all other Posix systems.
+bool CopyFile(const FilePath& from_path, const FilePath& to_path) {
+  return DoCopyFile(from_path, to_path, CopyFileProgressCallback());
 }
 #endif  // !defined(OS_MACOSX)
 
+bool CopyFileWithProgress(const FilePath& from_path,
+                          const FilePath& to_path,
+                          const CopyFileProgressCallback& progress) {
+  return DoCopyFile(from_path, to_path, progress);
+}
+
 // -----------------------------------------------------------------------------
 
 namespace internal {
@@ -1212,6 +1212,62 @@ TEST_F(FileUtilTest, CopyFileExecutablePermission) {
 
 #endif  // !defined(OS_FUCHSIA) && defined(OS_POSIX)
 
+#if defined(OS_POSIX)
+
+TEST_F(FileUtilTest, CopyFileWithProgress) {
+  // Larger than a chunk of the kernel copy, and not a multiple of the read
+  // buffer of the fallback.
+  const std::string data(9 * 1024 * 1024 + 7, 'a');
+  FilePath src = temp_dir_.GetPath().Append(FPL("src"));
+  ASSERT_EQ(static_cast<int>(data.size()),
+            WriteFile(src, data.data(), data.size()));
+
+  int64_t last_bytes_copied = 0;
+  FilePath dst = temp_dir_.GetPath().Append(FPL("dst"));
+  EXPECT_TRUE(CopyFileWithProgress(
+      src, dst,
+      BindRepeating(
+          [](int64_t* last_bytes_copied, int64_t size, int64_t bytes_copied,
+             int64_t total_bytes) {
+            EXPECT_EQ(size, total_bytes);
+            EXPECT_GT(bytes_copied, *last_bytes_copied);
+            *last_bytes_copied = bytes_copied;
+            return true;
+          },
+          &last_bytes_copied, static_cast<int64_t>(data.size()))));
+  EXPECT_EQ(static_cast<int64_t>(data.size()), last_bytes_copied);
+
+  std::string copied;
+  ASSERT_TRUE(ReadFileToString(dst, &copied));
+  EXPECT_EQ(data, copied);
+}
+
+TEST_F(FileUtilTest, CopyFileWithProgressCancelled) {
+  const std::string data(1024 * 1024, 'a');
+  FilePath src = temp_dir_.GetPath().Append(FPL("src"));
+  ASSERT_EQ(static_cast<int>(data.size()),
+            WriteFile(src, data.data(), data.size()));
+
+  EXPECT_FALSE(CopyFileWithProgress(
+      src, temp_dir_.GetPath().Append(FPL("dst")),
+      BindRepeating([](int64_t bytes_copied, int64_t total_bytes) {
+        return false;
+      })));
+}
+
+#endif  // defined(OS_POSIX)
+
+#if defined(OS_LINUX)
+TEST_F(FileUtilTest, CopyFileFromProc) {
+  // procfs reports a size of 0, which the kernel copy believes.
+  FilePath dst = temp_dir_.GetPath().Append(FPL("dst"));
+  ASSERT_TRUE(CopyFile(FilePath("/proc/self/status"), dst));
+  std::string copied;
+  ASSERT_TRUE(ReadFileToString(dst, &copied));
+  EXPECT_NE(std::string::npos, copied.find("Pid:"));
+}
+#endif  // defined(OS_LINUX)
+
 #if !defined(OS_FUCHSIA)
 
 TEST_F(FileUtilTest, CopyFileACL) {
@@ -2812,6 +2868,92 @@ TEST_F(FileUtilTest, ReadFileToString) {
   EXPECT_EQ(0u, data.length());
 }
 
+TEST_F(FileUtilTest, ReadFileToStringLarge) {
+  // Larger than the default chunk, so that it's only read at once if the
+  // file size is used.
+  std::string expected(300 * 1024 + 3, 'a');
+  for (size_t i = 0; i < expected.size(); i += 1000)
+    expected[i] = 'b';
+  FilePath file_path =
+      temp_dir_.GetPath().Append(FILE_PATH_LITERAL("ReadFileToStringLarge"));
+  ASSERT_EQ(static_cast<int>(expected.size()),
+            WriteFile(file_path, expected.data(), expected.size()));
+
+  std::string data;
+  EXPECT_TRUE(ReadFileToString(file_path, &data));
+  EXPECT_EQ(expected, data);
+
+  EXPECT_FALSE(ReadFileToStringWithMaxSize(file_path, &data, 100000));
+  EXPECT_EQ(expected.substr(0, 100000), data);
+
+  EXPECT_TRUE(
+      ReadFileToStringWithMaxSize(file_path, &data, expected.size()));
+  EXPECT_EQ(expected, data);
+}
+
+#if defined(OS_LINUX)
+TEST_F(FileUtilTest, ReadFileToStringFromProc) {
+  // The size of files in /proc is 0, whatever their contents.
+  std::string data;
+  EXPECT_TRUE(ReadFileToString(FilePath("/proc/self/status"), &data));
+  EXPECT_NE(std::string::npos, data.find("Pid:"));
+}
+#endif  // defined(OS_LINUX)
+
+TEST_F(FileUtilTest, ReadFileInChunks) {
+  std::string expected(10000, 'a');
+  for (size_t i = 0; i < expected.size(); ++i)
+    expected[i] = 'a' + i % 26;
+  FilePath file_path =
+      temp_dir_.GetPath().Append(FILE_PATH_LITERAL("ReadFileInChunks"));
+  ASSERT_EQ(static_cast<int>(expected.size()),
+            WriteFile(file_path, expected.data(), expected.size()));
+
+  std::string data;
+  int chunks = 0;
+  EXPECT_TRUE(ReadFileInChunks(
+      file_path, 4096,
+      BindRepeating(
+          [](std::string* data, int* chunks, span<const uint8_t> chunk) {
+            EXPECT_LE(chunk.size(), 4096u);
+            data->append(chunk.begin(), chunk.end());
+            ++*chunks;
+            return true;
+          },
+          &data, &chunks)));
+  EXPECT_EQ(expected, data);
+  EXPECT_EQ(3, chunks);
+
+  // Stopping after the first chunk.
+  chunks = 0;
+  EXPECT_FALSE(ReadFileInChunks(
+      file_path, 4096,
+      BindRepeating(
+          [](int* chunks, span<const uint8_t> chunk) {
+            ++*chunks;
+            return false;
+          },
+          &chunks)));
+  EXPECT_EQ(1, chunks);
+
+  const auto fail = BindRepeating([](span<const uint8_t> chunk) {
+    ADD_FAILURE();
+    return true;
+  });
+  EXPECT_FALSE(ReadFileInChunks(
+      temp_dir_.GetPath().Append(FILE_PATH_LITERAL("Missing")), 4096, fail));
+  FilePath file_path_dangerous =
+      temp_dir_.GetPath()
+          .Append(FILE_PATH_LITERAL(".."))
+          .Append(temp_dir_.GetPath().BaseName())
+          .Append(FILE_PATH_LITERAL("ReadFileInChunks"));
+  EXPECT_FALSE(ReadFileInChunks(file_path_dangerous, 4096, fail));
+
+  // An empty file is read without any chunk.
+  ASSERT_EQ(0, WriteFile(file_path, "", 0));
+  EXPECT_TRUE(ReadFileInChunks(file_path, 4096, fail));
+}
+
 TEST_F(FileUtilTest, TouchFile) {
   FilePath data_dir =
       temp_dir_.GetPath().Append(FILE_PATH_LITERAL("FilePathTest"));
@@ -7,6 +7,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <algorithm>
 #include <string>
 #include <utility>
 
@@ -24,12 +25,17 @@
 #include "base/numerics/safe_conversions.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
+#include "base/sequenced_task_runner.h"
 #include "base/task_runner.h"
 #include "base/task_runner_util.h"
 #include "base/threading/thread.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
 
+#if defined(OS_LINUX)
+#include <fcntl.h>
+#endif
+
 namespace base {
 
 namespace {
@@ -129,49 +135,32 @@ void DeleteTmpFile(const FilePath& tmp_file_path,
   }
 }
 
-}  // namespace
-
-// static
-bool ImportantFileWriter::WriteFileAtomically(const FilePath& path,
-                                              StringPiece data,
-                                              StringPiece histogram_suffix) {
-#if defined(OS_CHROMEOS)
-  // On Chrome OS, chrome gets killed when it cannot finish shutdown quickly,
-  // and this function seems to be one of the slowest shutdown steps.
-  // Include some info to the report for investigation. crbug.com/418627
-  // TODO(hashimoto): Remove this.
-  struct {
-    size_t data_size;
-    char path[128];
-  } file_info;
-  file_info.data_size = data.size();
-  strlcpy(file_info.path, path.value().c_str(), arraysize(file_info.path));
-  debug::Alias(&file_info);
-#endif
-
-  // Write the data to a temp file then rename to avoid data loss if we crash
-  // while writing the file. Ensure that the temp file is on the same volume
-  // as target file, so it can be moved in one step, and that the temp file
-  // is securely created.
-  FilePath tmp_file_path;
-  if (!CreateTemporaryFileInDir(path.DirName(), &tmp_file_path)) {
+// Writes |data| to a new temporary file which will replace |path|, without
+// flushing it. The temporary file is on the same volume as |path|, so it can
+// be moved in one step, and it's securely created. Returns an invalid File on
+// failure, after deleting the temporary file.
+File WriteTemporaryFile(const FilePath& path,
+                        StringPiece data,
+                        StringPiece histogram_suffix,
+                        FilePath* tmp_file_path) {
+  if (!CreateTemporaryFileInDir(path.DirName(), tmp_file_path)) {
     UmaHistogramExactLinearWithSuffix(
         "ImportantFile.FileCreateError", histogram_suffix,
         -base::File::GetLastFileError(), -base::File::FILE_ERROR_MAX);
     LogFailure(path, histogram_suffix, FAILED_CREATING,
                "could not create temporary file");
-    return false;
+    return File();
   }
 
-  File tmp_file(tmp_file_path, File::FLAG_OPEN | File::FLAG_WRITE);
+  File tmp_file(*tmp_file_path, File::FLAG_OPEN | File::FLAG_WRITE);
   if (!tmp_file.IsValid()) {
     UmaHistogramExactLinearWithSuffix(
         "ImportantFile.FileOpenError", histogram_suffix,
         -tmp_file.error_details(), -base::File::FILE_ERROR_MAX);
     LogFailure(path, histogram_suffix, FAILED_OPENING,
                "could not open temporary file");
-    DeleteFile(tmp_file_path, false);
-    return false;
+    DeleteFile(*tmp_file_path, false);
+    return File();
   }
 
   // If this fails in the wild, something really bad is going on.
@@ -181,17 +170,22 @@ bool ImportantFileWriter::WriteFileAtomically(const FilePath& path,
     UmaHistogramExactLinearWithSuffix(
         "ImportantFile.FileWriteError", histogram_suffix,
         -base::File::GetLastFileError(), -base::File::FILE_ERROR_MAX);
-  }
-  bool flush_success = tmp_file.Flush();
-  tmp_file.Close();
-
-  if (bytes_written < data_length) {
+    tmp_file.Close();
     LogFailure(path, histogram_suffix, FAILED_WRITING,
                "error writing, bytes_written=" + IntToString(bytes_written));
-    DeleteTmpFile(tmp_file_path, histogram_suffix);
-    return false;
+    DeleteTmpFile(*tmp_file_path, histogram_suffix);
+    return File();
   }
 
+  return tmp_file;
+}
+
+// Renames the temporary file written by WriteTemporaryFile(), which is closed,
+// over |path| if it was flushed successfully, or deletes it.
+bool ReplaceWithTemporaryFile(const FilePath& path,
+                              const FilePath& tmp_file_path,
+                              bool flush_success,
+                              StringPiece histogram_suffix) {
   if (!flush_success) {
     LogFailure(path, histogram_suffix, FAILED_FLUSHING, "error flushing");
     DeleteTmpFile(tmp_file_path, histogram_suffix);
@@ -212,6 +206,38 @@ bool ImportantFileWriter::WriteFileAtomically(const FilePath& path,
   return true;
 }
 
+}  // namespace
+
+// static
+bool ImportantFileWriter::WriteFileAtomically(const FilePath& path,
+                                              StringPiece data,
+                                              StringPiece histogram_suffix) {
+#if defined(OS_CHROMEOS)
+  // On Chrome OS, chrome gets killed when it cannot finish shutdown quickly,
+  // and this function seems to be one of the slowest shutdown steps.
+  // Include some info to the report for investigation. crbug.com/418627
+  // TODO(hashimoto): Remove this.
+  struct {
+    size_t data_size;
+    char path[128];
+  } file_info;
+  file_info.data_size = data.size();
+  strlcpy(file_info.path, path.value().c_str(), arraysize(file_info.path));
+  debug::Alias(&file_info);
+#endif
+
+  FilePath tmp_file_path;
+  File tmp_file =
+      WriteTemporaryFile(path, data, histogram_suffix, &tmp_file_path);
+  if (!tmp_file.IsValid())
+    return false;
+
+  bool flush_success = tmp_file.Flush();
+  tmp_file.Close();
+  return ReplaceWithTemporaryFile(path, tmp_file_path, flush_success,
+                                  histogram_suffix);
+}
+
 ImportantFileWriter::ImportantFileWriter(
     const FilePath& path,
     scoped_refptr<SequencedTaskRunner> task_runner,
@@ -235,17 +261,28 @@ ImportantFileWriter::ImportantFileWriter(
   DCHECK(task_runner_);
 }
 
+struct ImportantFileWriter::GroupedWrite {
+  FilePath path;
+  std::unique_ptr<std::string> data;
+  Closure before_write_callback;
+  Callback<void(bool success)> after_write_callback;
+  std::string histogram_suffix;
+};
+
 ImportantFileWriter::~ImportantFileWriter() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
   // We're usually a member variable of some other object, which also tends
   // to be our serializer. It may not be safe to call back to the parent object
   // being destructed.
   DCHECK(!HasPendingWrite());
+  // Don't leave a dangling pointer in the group in any case.
+  if (commit_group_ && serializer_)
+    commit_group_->RemovePendingWriter(this);
 }
 
 bool ImportantFileWriter::HasPendingWrite() const {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  return timer().IsRunning();
+  return timer().IsRunning() || (commit_group_ && serializer_);
 }
 
 void ImportantFileWriter::WriteNow(std::unique_ptr<std::string> data) {
@@ -275,6 +312,12 @@ void ImportantFileWriter::ScheduleWrite(DataSerializer* serializer) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
   DCHECK(serializer);
+  if (commit_group_) {
+    if (!serializer_)
+      commit_group_->AddPendingWriter(this);
+    serializer_ = serializer;
+    return;
+  }
   serializer_ = serializer;
 
   if (!timer().IsRunning()) {
@@ -303,8 +346,17 @@ void ImportantFileWriter::RegisterOnNextWriteCallbacks(
   after_next_write_callback_ = after_next_write_callback;
 }
 
+void ImportantFileWriter::SetCommitGroup(ImportantFileCommitGroup* group) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!HasPendingWrite());
+  DCHECK(!group || group->task_runner_ == task_runner_);
+  commit_group_ = group;
+}
+
 void ImportantFileWriter::ClearPendingWrite() {
   timer().Stop();
+  if (commit_group_ && serializer_)
+    commit_group_->RemovePendingWriter(this);
   serializer_ = nullptr;
 }
 
@@ -312,4 +364,161 @@ void ImportantFileWriter::SetTimerForTesting(Timer* timer_override) {
   timer_override_ = timer_override;
 }
 
+bool ImportantFileWriter::TakeScheduledWrite(GroupedWrite* write) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(serializer_);
+  DataSerializer* serializer = serializer_;
+  // The group already forgot about this writer.
+  serializer_ = nullptr;
+
+  std::unique_ptr<std::string> data(new std::string);
+  if (!serializer->SerializeData(data.get())) {
+    DLOG(WARNING) << "failed to serialize data to be saved in "
+                  << path_.value();
+    return false;
+  }
+  if (!IsValueInRangeForNumericType<int32_t>(data->length())) {
+    NOTREACHED();
+    return false;
+  }
+
+  write->path = path_;
+  write->data = std::move(data);
+  write->before_write_callback = std::move(before_next_write_callback_);
+  write->after_write_callback = std::move(after_next_write_callback_);
+  write->histogram_suffix = histogram_suffix_;
+  return true;
+}
+
+// static
+void ImportantFileWriter::WriteGroupAtomically(
+    std::vector<GroupedWrite> writes) {
+  for (const GroupedWrite& write : writes) {
+    if (!write.before_write_callback.is_null())
+      write.before_write_callback.Run();
+  }
+
+  TimeTicks start_time = TimeTicks::Now();
+  std::vector<File> tmp_files(writes.size());
+  std::vector<FilePath> tmp_file_paths(writes.size());
+  for (size_t i = 0; i < writes.size(); ++i) {
+    tmp_files[i] = WriteTemporaryFile(writes[i].path, *writes[i].data,
+                                      writes[i].histogram_suffix,
+                                      &tmp_file_paths[i]);
+#if defined(OS_LINUX)
+    // Starts writing the data back without waiting for it, so that the
+    // flushes below mostly wait for I/O which is already in flight. Once the
+    // first flush has committed the journal transaction recording the new
+    // files, the other ones don't need another commit.
+    if (tmp_files[i].IsValid()) {
+      sync_file_range(tmp_files[i].GetPlatformFile(), 0, 0,
+                      SYNC_FILE_RANGE_WRITE);
+    }
+#endif
+  }
+
+  TimeTicks flush_start_time = TimeTicks::Now();
+  std::vector<bool> written(writes.size());
+  std::vector<bool> flush_success(writes.size());
+  for (size_t i = 0; i < writes.size(); ++i) {
+    written[i] = tmp_files[i].IsValid();
+    if (!written[i])
+      continue;
+    flush_success[i] = tmp_files[i].Flush();
+    tmp_files[i].Close();
+  }
+  UmaHistogramTimes("ImportantFile.GroupCommit.TimeToFlush",
+                    TimeTicks::Now() - flush_start_time);
+
+  std::vector<bool> results(writes.size());
+  for (size_t i = 0; i < writes.size(); ++i) {
+    results[i] = written[i] &&
+                 ReplaceWithTemporaryFile(writes[i].path, tmp_file_paths[i],
+                                          flush_success[i],
+                                          writes[i].histogram_suffix);
+  }
+  UmaHistogramTimes("ImportantFile.GroupCommit.TimeToWrite",
+                    TimeTicks::Now() - start_time);
+  UmaHistogramCounts1000("ImportantFile.GroupCommit.FileCount",
+                         static_cast<int>(writes.size()));
+
+  for (size_t i = 0; i < writes.size(); ++i) {
+    if (!writes[i].after_write_callback.is_null())
+      writes[i].after_write_callback.Run(results[i]);
+  }
+}
+
+ImportantFileCommitGroup::ImportantFileCommitGroup(
+    scoped_refptr<SequencedTaskRunner> task_runner)
+    : ImportantFileCommitGroup(std::move(task_runner),
+                               kDefaultCommitInterval) {}
+
+ImportantFileCommitGroup::ImportantFileCommitGroup(
+    scoped_refptr<SequencedTaskRunner> task_runner,
+    TimeDelta interval)
+    : task_runner_(std::move(task_runner)), commit_interval_(interval) {
+  DCHECK(task_runner_);
+}
+
+ImportantFileCommitGroup::~ImportantFileCommitGroup() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(pending_writers_.empty());
+}
+
+bool ImportantFileCommitGroup::HasPendingWrites() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return !pending_writers_.empty();
+}
+
+void ImportantFileCommitGroup::CommitNow() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  timer().Stop();
+
+  std::vector<ImportantFileWriter*> writers;
+  writers.swap(pending_writers_);
+  std::vector<ImportantFileWriter::GroupedWrite> writes;
+  for (ImportantFileWriter* writer : writers) {
+    ImportantFileWriter::GroupedWrite write;
+    if (writer->TakeScheduledWrite(&write))
+      writes.push_back(std::move(write));
+  }
+  if (writes.empty())
+    return;
+
+  Closure task = AdaptCallbackForRepeating(BindOnce(
+      &ImportantFileWriter::WriteGroupAtomically, std::move(writes)));
+  if (!task_runner_->PostTask(FROM_HERE, MakeCriticalClosure(task))) {
+    // As in ImportantFileWriter::WriteNow(), hit the disk on the current
+    // thread rather than losing data.
+    NOTREACHED();
+
+    task.Run();
+  }
+}
+
+void ImportantFileCommitGroup::SetTimerForTesting(Timer* timer_override) {
+  timer_override_ = timer_override;
+}
+
+void ImportantFileCommitGroup::AddPendingWriter(ImportantFileWriter* writer) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  pending_writers_.push_back(writer);
+  if (!timer().IsRunning()) {
+    timer().Start(
+        FROM_HERE, commit_interval_,
+        Bind(&ImportantFileCommitGroup::CommitNow, Unretained(this)));
+  }
+}
+
+void ImportantFileCommitGroup::RemovePendingWriter(
+    ImportantFileWriter* writer) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  auto it =
+      std::find(pending_writers_.begin(), pending_writers_.end(), writer);
+  DCHECK(it != pending_writers_.end());
+  pending_writers_.erase(it);
+  if (pending_writers_.empty())
+    timer().Stop();
+}
+
 }  // namespace base
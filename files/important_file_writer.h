@@ -6,6 +6,7 @@
 #define BASE_FILES_IMPORTANT_FILE_WRITER_H_
 
 #include <string>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/callback.h"
@@ -19,6 +20,7 @@
 
 namespace base {
 
+class ImportantFileCommitGroup;
 class SequencedTaskRunner;
 
 // Helper for atomically writing a file to ensure that it won't be corrupted by
@@ -113,10 +115,27 @@ class BASE_EXPORT ImportantFileWriter {
     return commit_interval_;
   }
 
+  // Makes the writes scheduled by ScheduleWrite() wait for the next commit of
+  // |group|, which writes the files of all its writers together, instead of
+  // this writer's commit interval. |group| must use the same task runner as
+  // this writer, and outlive it. Passing null leaves the group.
+  void SetCommitGroup(ImportantFileCommitGroup* group);
+
   // Overrides the timer to use for scheduling writes with |timer_override|.
   void SetTimerForTesting(Timer* timer_override);
 
  private:
+  friend class ImportantFileCommitGroup;
+
+  struct GroupedWrite;
+
+  // Serializes the data of the write scheduled while in |commit_group_| into
+  // |write|. Returns false if the serialization fails.
+  bool TakeScheduledWrite(GroupedWrite* write);
+
+  // Writes the files of a group commit atomically, flushing them together.
+  static void WriteGroupAtomically(std::vector<GroupedWrite> writes);
+
   const Timer& timer() const {
     return timer_override_ ? const_cast<const Timer&>(*timer_override_)
                            : timer_;
@@ -144,6 +163,9 @@ class BASE_EXPORT ImportantFileWriter {
   // Serializer which will provide the data to be saved.
   DataSerializer* serializer_;
 
+  // The group committing the scheduled writes, if any.
+  ImportantFileCommitGroup* commit_group_ = nullptr;
+
   // Time delta after which scheduled data will be written to disk.
   const TimeDelta commit_interval_;
 
@@ -157,6 +179,68 @@ class BASE_EXPORT ImportantFileWriter {
   DISALLOW_COPY_AND_ASSIGN(ImportantFileWriter);
 };
 
+// Commits the scheduled writes of many ImportantFileWriters together. Instead
+// of each writer writing, flushing and renaming its file after its own commit
+// interval, the group serializes the data of all the writers with a pending
+// write once per commit interval and writes all their files from a single
+// task. The temporary files are all written before any of them is flushed,
+// so that the filesystem can flush them together, which is much faster on
+// slow disks than flushing them one after the other.
+//
+//   ImportantFileCommitGroup group(task_runner);
+//   ImportantFileWriter writer(path, task_runner);
+//   writer.SetCommitGroup(&group);
+//   writer.ScheduleWrite(serializer);
+//
+// All methods, including the ctor and dtor, must be called on the sequence of
+// the writers.
+class BASE_EXPORT ImportantFileCommitGroup {
+ public:
+  // |task_runner| is where the files are written, which must be the task
+  // runner of all the writers in the group.
+  explicit ImportantFileCommitGroup(
+      scoped_refptr<SequencedTaskRunner> task_runner);
+  ImportantFileCommitGroup(scoped_refptr<SequencedTaskRunner> task_runner,
+                           TimeDelta interval);
+
+  // The writers must leave the group first.
+  ~ImportantFileCommitGroup();
+
+  // Returns true if a writer in the group has a scheduled write pending.
+  bool HasPendingWrites() const;
+
+  // Writes the data of all the scheduled writes now, without waiting for the
+  // end of the commit interval. Does not block.
+  void CommitNow();
+
+  TimeDelta commit_interval() const { return commit_interval_; }
+
+  // Overrides the timer to use for scheduling commits with |timer_override|.
+  void SetTimerForTesting(Timer* timer_override);
+
+ private:
+  friend class ImportantFileWriter;
+
+  Timer& timer() { return timer_override_ ? *timer_override_ : timer_; }
+
+  // Called by the writers when they schedule or cancel a write.
+  void AddPendingWriter(ImportantFileWriter* writer);
+  void RemovePendingWriter(ImportantFileWriter* writer);
+
+  const scoped_refptr<SequencedTaskRunner> task_runner_;
+  const TimeDelta commit_interval_;
+
+  OneShotTimer timer_;
+  Timer* timer_override_ = nullptr;
+
+  // The writers with a pending write, in the order they were scheduled in.
+  std::vector<ImportantFileWriter*> pending_writers_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  DISALLOW_COPY_AND_ASSIGN(ImportantFileCommitGroup);
+};
+
 }  // namespace base
 
 #endif  // BASE_FILES_IMPORTANT_FILE_WRITER_H_
@@ -348,4 +348,78 @@ TEST_F(ImportantFileWriterTest, WriteFileAtomicallyHistogramSuffixTest) {
   histogram_tester.ExpectTotalCount("ImportantFile.FileCreateError.test", 1);
 }
 
+TEST_F(ImportantFileWriterTest, CommitGroup) {
+  base::HistogramTester histogram_tester;
+  constexpr TimeDelta kCommitInterval = TimeDelta::FromSeconds(12345);
+  MockTimer timer(true, false);
+  ImportantFileCommitGroup group(ThreadTaskRunnerHandle::Get(),
+                                 kCommitInterval);
+  group.SetTimerForTesting(&timer);
+  ImportantFileWriter writer1(file_, ThreadTaskRunnerHandle::Get());
+  ImportantFileWriter writer2(file_.AddExtension(FILE_PATH_LITERAL("2")),
+                              ThreadTaskRunnerHandle::Get());
+  ImportantFileWriter writer3(file_.AddExtension(FILE_PATH_LITERAL("3")),
+                              ThreadTaskRunnerHandle::Get());
+  writer1.SetCommitGroup(&group);
+  writer2.SetCommitGroup(&group);
+  writer3.SetCommitGroup(&group);
+  EXPECT_FALSE(group.HasPendingWrites());
+
+  DataSerializer foo("foo"), bar("bar"), baz("baz");
+  FailingDataSerializer failing;
+  writer1.ScheduleWrite(&foo);
+  writer1.ScheduleWrite(&bar);
+  writer2.ScheduleWrite(&baz);
+  writer3.ScheduleWrite(&failing);
+  write_callback_observer_.ObserveNextWriteCallbacks(&writer2);
+  EXPECT_TRUE(writer1.HasPendingWrite());
+  EXPECT_TRUE(writer2.HasPendingWrite());
+  EXPECT_TRUE(group.HasPendingWrites());
+  ASSERT_TRUE(timer.IsRunning());
+  EXPECT_EQ(kCommitInterval, timer.GetCurrentDelay());
+
+  timer.Fire();
+  EXPECT_FALSE(writer1.HasPendingWrite());
+  EXPECT_FALSE(writer2.HasPendingWrite());
+  EXPECT_FALSE(writer3.HasPendingWrite());
+  EXPECT_FALSE(group.HasPendingWrites());
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ("bar", GetFileContent(writer1.path()));
+  EXPECT_EQ("baz", GetFileContent(writer2.path()));
+  EXPECT_FALSE(PathExists(writer3.path()));
+  EXPECT_EQ(CALLED_WITH_SUCCESS,
+            write_callback_observer_.GetAndResetObservationState());
+  histogram_tester.ExpectUniqueSample("ImportantFile.GroupCommit.FileCount", 2,
+                                      1);
+  histogram_tester.ExpectTotalCount("ImportantFile.GroupCommit.TimeToFlush", 1);
+  histogram_tester.ExpectTotalCount("ImportantFile.GroupCommit.TimeToWrite", 1);
+}
+
+TEST_F(ImportantFileWriterTest, CommitGroup_WriteNowAndCommitNow) {
+  MockTimer timer(true, false);
+  ImportantFileCommitGroup group(ThreadTaskRunnerHandle::Get());
+  group.SetTimerForTesting(&timer);
+  ImportantFileWriter writer1(file_, ThreadTaskRunnerHandle::Get());
+  ImportantFileWriter writer2(file_.AddExtension(FILE_PATH_LITERAL("2")),
+                              ThreadTaskRunnerHandle::Get());
+  writer1.SetCommitGroup(&group);
+  writer2.SetCommitGroup(&group);
+
+  // Writing one file right away takes it out of the group commit.
+  DataSerializer foo("foo"), bar("bar");
+  writer1.ScheduleWrite(&foo);
+  writer1.WriteNow(std::make_unique<std::string>("now"));
+  EXPECT_FALSE(group.HasPendingWrites());
+  EXPECT_FALSE(timer.IsRunning());
+
+  writer2.ScheduleWrite(&bar);
+  EXPECT_TRUE(timer.IsRunning());
+  group.CommitNow();
+  EXPECT_FALSE(timer.IsRunning());
+  EXPECT_FALSE(writer2.HasPendingWrite());
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ("now", GetFileContent(writer1.path()));
+  EXPECT_EQ("bar", GetFileContent(writer2.path()));
+}
+
 }  // namespace base
@@ -0,0 +1,367 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/io_uring_linux.h"
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/sequenced_task_runner.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+
+namespace base {
+
+namespace {
+
+// The sizes of the queues of the shared ring. Submissions are batched per
+// task, so this only needs to exceed the operations typically started by one.
+const unsigned kSharedRingEntries = 256;
+
+int IoUringSetup(unsigned entries, io_uring_params* params) {
+  return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int IoUringEnter(int ring_fd,
+                 unsigned to_submit,
+                 unsigned min_complete,
+                 unsigned flags) {
+  return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags,
+                 nullptr, 0);
+}
+
+int IoUringRegister(int ring_fd,
+                    unsigned opcode,
+                    const void* arg,
+                    unsigned nr_args) {
+  return syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+// The ring indices are written by one side and read by the other, so they are
+// accessed with acquire and release semantics.
+uint32_t LoadAcquire(const uint32_t* index) {
+  return static_cast<uint32_t>(subtle::Acquire_Load(
+      reinterpret_cast<volatile const subtle::Atomic32*>(index)));
+}
+
+void StoreRelease(uint32_t* index, uint32_t value) {
+  subtle::Release_Store(reinterpret_cast<volatile subtle::Atomic32*>(index),
+                        static_cast<subtle::Atomic32>(value));
+}
+
+void* MapRing(int ring_fd, size_t size, off_t offset) {
+  void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+  return address == MAP_FAILED ? nullptr : address;
+}
+
+// Returns whether the kernel supports the opcodes used by this file, which
+// came after io_uring itself (Linux 5.6), as did probing for them.
+bool SupportsReadAndWrite(int ring_fd) {
+  const unsigned kMaxOps = 256;
+  const size_t size =
+      sizeof(io_uring_probe) + kMaxOps * sizeof(io_uring_probe_op);
+  std::unique_ptr<char[]> storage(new char[size]);
+  memset(storage.get(), 0, size);
+  io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(storage.get());
+  if (IoUringRegister(ring_fd, IORING_REGISTER_PROBE, probe, kMaxOps) < 0)
+    return false;
+  for (uint8_t opcode : {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED,
+                         IORING_OP_WRITE_FIXED}) {
+    if (opcode > probe->last_op ||
+        !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<IoUring> IoUring::Create(unsigned entries) {
+  std::unique_ptr<IoUring> ring = WrapUnique(new IoUring);
+  if (!ring->Initialize(entries))
+    return nullptr;
+  return ring;
+}
+
+IoUring::IoUring() = default;
+
+IoUring::~IoUring() {
+  if (sqes_)
+    munmap(sqes_, sqes_size_);
+  if (cq_ring_ && cq_ring_ != sq_ring_)
+    munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_)
+    munmap(sq_ring_, sq_ring_size_);
+}
+
+bool IoUring::Initialize(unsigned entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_.reset(IoUringSetup(entries, &params));
+  if (!ring_fd_.is_valid())
+    return false;
+  if (!SupportsReadAndWrite(ring_fd_.get()))
+    return false;
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  // Since Linux 5.4 both queues are in one mapping.
+  bool single_mapping = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mapping)
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+  sq_ring_ = MapRing(ring_fd_.get(), sq_ring_size_, IORING_OFF_SQ_RING);
+  if (!sq_ring_)
+    return false;
+  cq_ring_ = single_mapping
+                 ? sq_ring_
+                 : MapRing(ring_fd_.get(), cq_ring_size_, IORING_OFF_CQ_RING);
+  if (!cq_ring_)
+    return false;
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = static_cast<io_uring_sqe*>(
+      MapRing(ring_fd_.get(), sqes_size_, IORING_OFF_SQES));
+  if (!sqes_)
+    return false;
+
+  char* sq = static_cast<char*>(sq_ring_);
+  sq_head_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+  sq_array_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+  sq_mask_ = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  sq_local_tail_ = *sq_tail_;
+
+  char* cq = static_cast<char*>(cq_ring_);
+  cq_head_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+  return true;
+}
+
+bool IoUring::RegisterBuffers(const struct iovec* buffers, unsigned count) {
+  return IoUringRegister(ring_fd_.get(), IORING_REGISTER_BUFFERS, buffers,
+                         count) == 0;
+}
+
+bool IoUring::PrepareRead(PlatformFile file,
+                          void* buffer,
+                          unsigned size,
+                          int64_t offset,
+                          uint64_t user_data) {
+  return Prepare(IORING_OP_READ, file, buffer, size, offset, 0, user_data);
+}
+
+bool IoUring::PrepareWrite(PlatformFile file,
+                           const void* buffer,
+                           unsigned size,
+                           int64_t offset,
+                           uint64_t user_data) {
+  return Prepare(IORING_OP_WRITE, file, buffer, size, offset, 0, user_data);
+}
+
+bool IoUring::PrepareReadFixed(PlatformFile file,
+                               void* buffer,
+                               unsigned size,
+                               int64_t offset,
+                               unsigned buffer_index,
+                               uint64_t user_data) {
+  return Prepare(IORING_OP_READ_FIXED, file, buffer, size, offset,
+                 buffer_index, user_data);
+}
+
+bool IoUring::PrepareWriteFixed(PlatformFile file,
+                                const void* buffer,
+                                unsigned size,
+                                int64_t offset,
+                                unsigned buffer_index,
+                                uint64_t user_data) {
+  return Prepare(IORING_OP_WRITE_FIXED, file, buffer, size, offset,
+                 buffer_index, user_data);
+}
+
+bool IoUring::Submit() {
+  if (!pending_submissions_)
+    return true;
+  StoreRelease(sq_tail_, sq_local_tail_);
+  int submitted =
+      HANDLE_EINTR(IoUringEnter(ring_fd_.get(), pending_submissions_, 0, 0));
+  if (submitted < 0) {
+    DPLOG(ERROR) << "io_uring_enter";
+    return false;
+  }
+  pending_submissions_ -= submitted;
+  return pending_submissions_ == 0;
+}
+
+void IoUring::WaitForCompletion() {
+  while (LoadAcquire(cq_tail_) == *cq_head_) {
+    if (IoUringEnter(ring_fd_.get(), 0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+        errno != EINTR) {
+      DPLOG(ERROR) << "io_uring_enter";
+    }
+  }
+}
+
+bool IoUring::PopCompletion(uint64_t* user_data, int32_t* result) {
+  uint32_t head = *cq_head_;
+  if (head == LoadAcquire(cq_tail_))
+    return false;
+  const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+  *user_data = cqe.user_data;
+  *result = cqe.res;
+  // Hands the entry back to the kernel.
+  StoreRelease(cq_head_, head + 1);
+  return true;
+}
+
+io_uring_sqe* IoUring::GetFreeEntry() {
+  if (sq_local_tail_ - LoadAcquire(sq_head_) >= sq_entries_)
+    return nullptr;
+  uint32_t index = sq_local_tail_ & sq_mask_;
+  sq_array_[index] = index;
+  ++sq_local_tail_;
+  ++pending_submissions_;
+  io_uring_sqe* entry = &sqes_[index];
+  memset(entry, 0, sizeof(*entry));
+  return entry;
+}
+
+bool IoUring::Prepare(uint8_t opcode,
+                      PlatformFile file,
+                      const void* buffer,
+                      unsigned size,
+                      int64_t offset,
+                      unsigned buffer_index,
+                      uint64_t user_data) {
+  io_uring_sqe* entry = GetFreeEntry();
+  if (!entry)
+    return false;
+  entry->opcode = opcode;
+  entry->fd = file;
+  entry->off = static_cast<uint64_t>(offset);
+  entry->addr = reinterpret_cast<uintptr_t>(buffer);
+  entry->len = size;
+  entry->buf_index = static_cast<uint16_t>(buffer_index);
+  entry->user_data = user_data;
+  return true;
+}
+
+struct SharedIoUring::Operation {
+  explicit Operation(CompletionCallback callback)
+      : reply_task_runner(SequencedTaskRunnerHandle::Get()),
+        callback(std::move(callback)) {}
+
+  scoped_refptr<SequencedTaskRunner> reply_task_runner;
+  CompletionCallback callback;
+};
+
+// static
+SharedIoUring* SharedIoUring::Get() {
+  static SharedIoUring* const instance = []() -> SharedIoUring* {
+    std::unique_ptr<IoUring> ring = IoUring::Create(kSharedRingEntries);
+    if (!ring)
+      return nullptr;
+    return new SharedIoUring(std::move(ring));
+  }();
+  return instance;
+}
+
+void SharedIoUring::Read(PlatformFile file,
+                         int64_t offset,
+                         char* buffer,
+                         int size,
+                         CompletionCallback callback) {
+  Prepare(false, file, offset, buffer, size, std::move(callback));
+}
+
+void SharedIoUring::Write(PlatformFile file,
+                          int64_t offset,
+                          const char* buffer,
+                          int size,
+                          CompletionCallback callback) {
+  Prepare(true, file, offset, buffer, size, std::move(callback));
+}
+
+SharedIoUring::SharedIoUring(std::unique_ptr<IoUring> ring)
+    : ring_(std::move(ring)) {
+  if (!PlatformThread::CreateNonJoinable(0, this))
+    LOG(FATAL) << "Failed to start the io_uring completion thread";
+}
+
+// The instance is leaked, since its thread never exits.
+SharedIoUring::~SharedIoUring() = default;
+
+void SharedIoUring::Prepare(bool is_write,
+                            PlatformFile file,
+                            int64_t offset,
+                            const char* buffer,
+                            int size,
+                            CompletionCallback callback) {
+  DCHECK_GE(size, 0);
+  auto operation = std::make_unique<Operation>(std::move(callback));
+  uint64_t user_data = reinterpret_cast<uintptr_t>(operation.get());
+
+  AutoLock lock(lock_);
+  char* mutable_buffer = const_cast<char*>(buffer);
+  while (is_write ? !ring_->PrepareWrite(file, buffer, size, offset, user_data)
+                  : !ring_->PrepareRead(file, mutable_buffer, size, offset,
+                                        user_data)) {
+    // The queue is full, so the batch is submitted early.
+    ring_->Submit();
+  }
+  operation.release();
+
+  if (!submit_scheduled_)
+    ScheduleSubmitLocked();
+}
+
+void SharedIoUring::ScheduleSubmitLocked() {
+  lock_.AssertAcquired();
+  submit_scheduled_ = true;
+  SequencedTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, BindOnce(&SharedIoUring::SubmitPending, Unretained(this)));
+}
+
+void SharedIoUring::SubmitPending() {
+  AutoLock lock(lock_);
+  submit_scheduled_ = false;
+  // Retries later if the kernel is out of resources.
+  if (!ring_->Submit())
+    ScheduleSubmitLocked();
+}
+
+void SharedIoUring::ThreadMain() {
+  PlatformThread::SetName("IoUringCompletions");
+  for (;;) {
+    ring_->WaitForCompletion();
+    uint64_t user_data;
+    int32_t result;
+    while (ring_->PopCompletion(&user_data, &result)) {
+      std::unique_ptr<Operation> operation(
+          reinterpret_cast<Operation*>(static_cast<uintptr_t>(user_data)));
+      operation->reply_task_runner->PostTask(
+          FROM_HERE, BindOnce(std::move(operation->callback), result));
+    }
+  }
+}
+
+}  // namespace base
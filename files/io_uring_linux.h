@@ -0,0 +1,207 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_IO_URING_LINUX_H_
+#define BASE_FILES_IO_URING_LINUX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/files/platform_file.h"
+#include "base/files/scoped_file.h"
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/platform_thread.h"
+
+struct io_uring_cqe;
+struct io_uring_sqe;
+struct iovec;
+
+namespace base {
+
+// A thin wrapper around an io_uring (Linux 5.6 and later), a pair of queues
+// shared with the kernel: reads and writes are added to the submission queue,
+// handed to the kernel in batches with a single system call, and their results
+// are popped from the completion queue without any system call.
+//
+//   std::unique_ptr<IoUring> ring = IoUring::Create(64);
+//   ring->PrepareRead(fd, buffer, size, offset, /*user_data=*/1);
+//   ring->PrepareRead(fd2, buffer2, size2, offset2, /*user_data=*/2);
+//   ring->Submit();
+//   ring->WaitForCompletion();
+//   while (ring->PopCompletion(&user_data, &result)) ...
+//
+// This class is thread-compatible, except that one thread may wait for and pop
+// completions while another one prepares and submits operations.
+class BASE_EXPORT IoUring {
+ public:
+  // Returns a ring whose submission queue holds at least |entries|
+  // operations, or null if the kernel doesn't support io_uring reads and
+  // writes, e.g. because it's too old or a seccomp policy forbids it.
+  static std::unique_ptr<IoUring> Create(unsigned entries);
+
+  ~IoUring();
+
+  // Registers |count| buffers with the kernel, which then keeps their pages
+  // mapped instead of mapping them for each operation. They are used with
+  // PrepareReadFixed() and PrepareWriteFixed(), by index. Returns false on
+  // failure, e.g. if buffers are already registered or exceed RLIMIT_MEMLOCK.
+  bool RegisterBuffers(const struct iovec* buffers, unsigned count);
+
+  // Add an operation transferring |size| bytes between |buffer| and |file| at
+  // |offset| to the submission queue. |buffer| must remain valid until the
+  // operation completes. |user_data| is returned with its completion. These
+  // return false if the submission queue is full, in which case Submit() makes
+  // room. The *Fixed() variants are for buffers within registered buffer
+  // |buffer_index|.
+  bool PrepareRead(PlatformFile file,
+                   void* buffer,
+                   unsigned size,
+                   int64_t offset,
+                   uint64_t user_data);
+  bool PrepareWrite(PlatformFile file,
+                    const void* buffer,
+                    unsigned size,
+                    int64_t offset,
+                    uint64_t user_data);
+  bool PrepareReadFixed(PlatformFile file,
+                        void* buffer,
+                        unsigned size,
+                        int64_t offset,
+                        unsigned buffer_index,
+                        uint64_t user_data);
+  bool PrepareWriteFixed(PlatformFile file,
+                         const void* buffer,
+                         unsigned size,
+                         int64_t offset,
+                         unsigned buffer_index,
+                         uint64_t user_data);
+
+  // Hands all the prepared operations to the kernel with one system call.
+  // Returns false on failure, in which case the operations which weren't
+  // submitted remain pending.
+  bool Submit();
+
+  // Blocks until the completion queue isn't empty.
+  void WaitForCompletion();
+
+  // If an operation has completed, sets |user_data| to the value it was
+  // prepared with and |result| to the number of bytes transferred or a
+  // negated errno value, and returns true. Returns false otherwise.
+  bool PopCompletion(uint64_t* user_data, int32_t* result);
+
+  // The number of operations prepared but not submitted yet.
+  unsigned pending_submissions() const { return pending_submissions_; }
+
+ private:
+  IoUring();
+
+  bool Initialize(unsigned entries);
+
+  // Returns the next free submission queue entry, cleared, or null if the
+  // queue is full.
+  struct io_uring_sqe* GetFreeEntry();
+
+  bool Prepare(uint8_t opcode,
+               PlatformFile file,
+               const void* buffer,
+               unsigned size,
+               int64_t offset,
+               unsigned buffer_index,
+               uint64_t user_data);
+
+  ScopedFD ring_fd_;
+
+  // The mappings of the shared queues, which may be a single mapping.
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  struct io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  // Pointers into the submission queue. The kernel advances the head,
+  // this class advances the tail.
+  uint32_t* sq_head_ = nullptr;
+  uint32_t* sq_tail_ = nullptr;
+  uint32_t* sq_array_ = nullptr;
+  uint32_t sq_mask_ = 0;
+  uint32_t sq_entries_ = 0;
+  // The tail including the prepared operations, which is only published to
+  // the kernel by Submit().
+  uint32_t sq_local_tail_ = 0;
+  unsigned pending_submissions_ = 0;
+
+  // Pointers into the completion queue. The kernel advances the tail,
+  // this class advances the head.
+  uint32_t* cq_head_ = nullptr;
+  uint32_t* cq_tail_ = nullptr;
+  uint32_t cq_mask_ = 0;
+  struct io_uring_cqe* cqes_ = nullptr;
+
+  DISALLOW_COPY_AND_ASSIGN(IoUring);
+};
+
+// A process-wide IoUring for reads and writes from any sequence. Operations
+// started while a task runs are submitted together once it returns, and a
+// dedicated thread delivers the results to the sequences which started them.
+// FileProxy uses this when asked to; see FileProxy::set_prefer_io_uring().
+class BASE_EXPORT SharedIoUring : public PlatformThread::Delegate {
+ public:
+  // Runs with the number of bytes transferred or a negated errno value.
+  using CompletionCallback = OnceCallback<void(int result)>;
+
+  // Returns null if the kernel doesn't support io_uring.
+  static SharedIoUring* Get();
+
+  // Read or write up to |size| bytes between |file| at |offset| and |buffer|,
+  // like pread() and pwrite(), without blocking the calling thread. |file| and
+  // |buffer| must remain valid until |callback| runs on the current sequence.
+  void Read(PlatformFile file,
+            int64_t offset,
+            char* buffer,
+            int size,
+            CompletionCallback callback);
+  void Write(PlatformFile file,
+             int64_t offset,
+             const char* buffer,
+             int size,
+             CompletionCallback callback);
+
+ private:
+  struct Operation;
+
+  explicit SharedIoUring(std::unique_ptr<IoUring> ring);
+  ~SharedIoUring() override;
+
+  // Adds an operation to the next batch, which is submitted from a task posted
+  // to the current sequence.
+  void Prepare(bool is_write,
+               PlatformFile file,
+               int64_t offset,
+               const char* buffer,
+               int size,
+               CompletionCallback callback);
+  void ScheduleSubmitLocked();
+  void SubmitPending();
+
+  // PlatformThread::Delegate, which delivers the completions.
+  void ThreadMain() override;
+
+  const std::unique_ptr<IoUring> ring_;
+
+  // Protects the submission side of |ring_|.
+  Lock lock_;
+  bool submit_scheduled_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedIoUring);
+};
+
+}  // namespace base
+
+#endif  // BASE_FILES_IO_URING_LINUX_H_
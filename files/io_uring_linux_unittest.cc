@@ -0,0 +1,175 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/io_uring_linux.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include <map>
+#include <string>
+
+#include "base/barrier_closure.h"
+#include "base/bind.h"
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "base/test/scoped_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class IoUringTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ring_ = IoUring::Create(8);
+    if (!ring_)
+      return;
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    file_.Initialize(temp_dir_.GetPath().AppendASCII("file"),
+                     File::FLAG_CREATE | File::FLAG_READ | File::FLAG_WRITE);
+    ASSERT_TRUE(file_.IsValid());
+  }
+
+  // Waits for |count| completions, keyed by their user data.
+  std::map<uint64_t, int32_t> WaitForCompletions(size_t count) {
+    std::map<uint64_t, int32_t> results;
+    while (results.size() < count) {
+      ring_->WaitForCompletion();
+      uint64_t user_data;
+      int32_t result;
+      while (ring_->PopCompletion(&user_data, &result))
+        results[user_data] = result;
+    }
+    return results;
+  }
+
+  std::unique_ptr<IoUring> ring_;
+  ScopedTempDir temp_dir_;
+  File file_;
+};
+
+void StoreResult(int* out, const RepeatingClosure& done, int result) {
+  *out = result;
+  done.Run();
+}
+
+}  // namespace
+
+TEST_F(IoUringTest, BatchedWritesAndReads) {
+  if (!ring_)
+    return;  // The kernel doesn't support io_uring.
+
+  ASSERT_TRUE(ring_->PrepareWrite(file_.GetPlatformFile(), "abc", 3, 0, 1));
+  ASSERT_TRUE(ring_->PrepareWrite(file_.GetPlatformFile(), "def", 3, 3, 2));
+  EXPECT_EQ(2u, ring_->pending_submissions());
+  ASSERT_TRUE(ring_->Submit());
+  EXPECT_EQ(0u, ring_->pending_submissions());
+  std::map<uint64_t, int32_t> results = WaitForCompletions(2);
+  EXPECT_EQ(3, results[1]);
+  EXPECT_EQ(3, results[2]);
+
+  char first[4] = {};
+  char second[4] = {};
+  ASSERT_TRUE(ring_->PrepareRead(file_.GetPlatformFile(), first, 3, 0, 3));
+  ASSERT_TRUE(ring_->PrepareRead(file_.GetPlatformFile(), second, 4, 3, 4));
+  ASSERT_TRUE(ring_->Submit());
+  results = WaitForCompletions(2);
+  EXPECT_EQ(3, results[3]);
+  EXPECT_EQ(3, results[4]);
+  EXPECT_EQ("abc", std::string(first));
+  EXPECT_EQ("def", std::string(second));
+
+  uint64_t user_data;
+  int32_t result;
+  EXPECT_FALSE(ring_->PopCompletion(&user_data, &result));
+}
+
+TEST_F(IoUringTest, FullSubmissionQueue) {
+  if (!ring_)
+    return;
+
+  char buffer[1];
+  unsigned prepared = 0;
+  while (ring_->PrepareRead(file_.GetPlatformFile(), buffer, 1, 0, prepared))
+    ++prepared;
+  EXPECT_GE(prepared, 8u);
+  EXPECT_EQ(prepared, ring_->pending_submissions());
+
+  ASSERT_TRUE(ring_->Submit());
+  EXPECT_TRUE(ring_->PrepareRead(file_.GetPlatformFile(), buffer, 1, 0, 0));
+  ASSERT_TRUE(ring_->Submit());
+  WaitForCompletions(prepared);
+}
+
+TEST_F(IoUringTest, Error) {
+  if (!ring_)
+    return;
+
+  char buffer[1];
+  ASSERT_TRUE(ring_->PrepareRead(-1, buffer, 1, 0, 42));
+  ASSERT_TRUE(ring_->Submit());
+  EXPECT_EQ(-EBADF, WaitForCompletions(1)[42]);
+}
+
+TEST_F(IoUringTest, RegisteredBuffers) {
+  if (!ring_)
+    return;
+
+  char buffers[2][8] = {"fixed", {}};
+  struct iovec iovecs[2] = {{buffers[0], 8}, {buffers[1], 8}};
+  if (!ring_->RegisterBuffers(iovecs, 2))
+    return;  // E.g. RLIMIT_MEMLOCK is too low.
+
+  ASSERT_TRUE(ring_->PrepareWriteFixed(file_.GetPlatformFile(), buffers[0], 6,
+                                       0, 0, 1));
+  ASSERT_TRUE(ring_->Submit());
+  EXPECT_EQ(6, WaitForCompletions(1)[1]);
+
+  ASSERT_TRUE(ring_->PrepareReadFixed(file_.GetPlatformFile(), buffers[1], 8,
+                                      0, 1, 2));
+  ASSERT_TRUE(ring_->Submit());
+  EXPECT_EQ(6, WaitForCompletions(1)[2]);
+  EXPECT_EQ("fixed", std::string(buffers[1]));
+}
+
+TEST(SharedIoUringTest, ReadAndWrite) {
+  SharedIoUring* ring = SharedIoUring::Get();
+  if (!ring)
+    return;
+
+  test::ScopedTaskEnvironment scoped_task_environment;
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  File file(temp_dir.GetPath().AppendASCII("file"),
+            File::FLAG_CREATE | File::FLAG_READ | File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+
+  // Both writes are submitted together once this task returns.
+  int results[2] = {0, 0};
+  RunLoop run_loop;
+  RepeatingClosure done = BarrierClosure(2, run_loop.QuitClosure());
+  ring->Write(file.GetPlatformFile(), 0, "one", 3,
+              BindOnce(&StoreResult, &results[0], done));
+  ring->Write(file.GetPlatformFile(), 3, "two", 3,
+              BindOnce(&StoreResult, &results[1], done));
+  run_loop.Run();
+  EXPECT_EQ(3, results[0]);
+  EXPECT_EQ(3, results[1]);
+
+  char buffer[8] = {};
+  int read_result = 0;
+  RunLoop read_loop;
+  ring->Read(file.GetPlatformFile(), 0, buffer, sizeof(buffer),
+             BindOnce(&StoreResult, &read_result, read_loop.QuitClosure()));
+  read_loop.Run();
+  EXPECT_EQ(6, read_result);
+  EXPECT_EQ("onetwo", std::string(buffer));
+}
+
+}  // namespace base
@@ -6,10 +6,13 @@
 
 #include <utility>
 
+#include "base/bind.h"
 #include "base/files/file_path.h"
+#include "base/location.h"
 #include "base/logging.h"
 #include "base/numerics/safe_math.h"
 #include "base/sys_info.h"
+#include "base/task_scheduler/post_task.h"
 #include "build/build_config.h"
 
 namespace base {
@@ -26,12 +29,21 @@ bool MemoryMappedFile::Region::operator!=(
   return other.offset != offset || other.size != size;
 }
 
+MemoryMappedFile::Options::Options()
+    : advice(ADVICE_NORMAL), populate(false), huge_pages(false) {}
+
 MemoryMappedFile::~MemoryMappedFile() {
   CloseHandles();
 }
 
 #if !defined(OS_NACL)
 bool MemoryMappedFile::Initialize(const FilePath& file_name, Access access) {
+  return Initialize(file_name, access, Options());
+}
+
+bool MemoryMappedFile::Initialize(const FilePath& file_name,
+                                  Access access,
+                                  const Options& options) {
   if (IsValid())
     return false;
 
@@ -54,7 +66,7 @@ bool MemoryMappedFile::Initialize(const FilePath& file_name, Access access) {
     return false;
   }
 
-  if (!MapFileRegionToMemory(Region::kWholeFile, access)) {
+  if (!MapFileRegionToMemory(Region::kWholeFile, access, options)) {
     CloseHandles();
     return false;
   }
@@ -70,6 +82,13 @@ bool MemoryMappedFile::Initialize(File file, Access access) {
 bool MemoryMappedFile::Initialize(File file,
                                   const Region& region,
                                   Access access) {
+  return Initialize(std::move(file), region, access, Options());
+}
+
+bool MemoryMappedFile::Initialize(File file,
+                                  const Region& region,
+                                  Access access,
+                                  const Options& options) {
   switch (access) {
     case READ_WRITE_EXTEND:
       DCHECK(Region::kWholeFile != region);
@@ -100,7 +119,7 @@ bool MemoryMappedFile::Initialize(File file,
 
   file_ = std::move(file);
 
-  if (!MapFileRegionToMemory(region, access)) {
+  if (!MapFileRegionToMemory(region, access, options)) {
     CloseHandles();
     return false;
   }
@@ -112,6 +131,17 @@ bool MemoryMappedFile::IsValid() const {
   return data_ != nullptr;
 }
 
+void MemoryMappedFile::PrefetchInBackground(size_t offset, size_t size) {
+  DCHECK(IsValid());
+  DCHECK_LE(offset, length_);
+  DCHECK_LE(size, length_ - offset);
+  PostTaskWithTraits(
+      FROM_HERE,
+      {MayBlock(), TaskPriority::BACKGROUND,
+       TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN},
+      BindOnce(&MemoryMappedFile::Prefetch, data_ + offset, size));
+}
+
 // static
 void MemoryMappedFile::CalculateVMAlignedBoundaries(int64_t start,
                                                     size_t size,
@@ -46,6 +46,43 @@ class BASE_EXPORT MemoryMappedFile {
     READ_WRITE_EXTEND,
   };
 
+  // Hints about how a mapping will be accessed, which let the OS read the data
+  // ahead of the first accesses to it. The OS may ignore them.
+  enum Advice {
+    // The default read-ahead.
+    ADVICE_NORMAL,
+
+    // The data will be accessed in order, so it can be read far ahead and
+    // evicted soon after it's accessed.
+    ADVICE_SEQUENTIAL,
+
+    // The data will be accessed in no particular order, so reading ahead
+    // would mostly read pages which aren't needed.
+    ADVICE_RANDOM,
+
+    // The data will be accessed soon, so reading all of it starts right away.
+    ADVICE_WILL_NEED,
+  };
+
+  // Options which change how a file is mapped, but not the mapped contents.
+  struct BASE_EXPORT Options {
+    Options();
+
+    // The initial access pattern, which Advise() can change later.
+    Advice advice;
+
+    // Reads the whole mapping in during Initialize(), which blocks until it's
+    // done, so that no access to it page faults later. Only effective on
+    // Linux and Android; elsewhere this is ADVICE_WILL_NEED.
+    bool populate;
+
+    // Aligns the mapping so that the kernel can back it with transparent huge
+    // pages, and asks it to. This cuts TLB misses when randomly accessing
+    // large mappings. Only effective on Linux and Android, for filesystems
+    // and kernel configurations with huge pages for files, like tmpfs.
+    bool huge_pages;
+  };
+
   // The default constructor sets all members to invalid/null values.
   MemoryMappedFile();
   ~MemoryMappedFile();
@@ -93,6 +130,15 @@ class BASE_EXPORT MemoryMappedFile {
     return Initialize(std::move(file), region, READ_ONLY);
   }
 
+  // As above, but with |options| instead of the default ones.
+  bool Initialize(const FilePath& file_name,
+                  Access access,
+                  const Options& options);
+  bool Initialize(File file,
+                  const Region& region,
+                  Access access,
+                  const Options& options);
+
   const uint8_t* data() const { return data_; }
   uint8_t* data() { return data_; }
   size_t length() const { return length_; }
@@ -100,6 +146,16 @@ class BASE_EXPORT MemoryMappedFile {
   // Is file_ a valid file handle that points to an open, memory mapped file?
   bool IsValid() const;
 
+  // Tells the OS how the mapping will be accessed from now on. Returns false
+  // if the OS doesn't take such hints.
+  bool Advise(Advice advice);
+
+  // Starts reading the |size| bytes at |offset| in the mapping in, from a
+  // background task which can take page faults instead of the caller, so that
+  // the data is in memory by the time it's accessed. This is harmless even if
+  // the mapping is closed before the task runs.
+  void PrefetchInBackground(size_t offset, size_t size);
+
  private:
   // Given the arbitrarily aligned memory region [start, size], returns the
   // boundaries of the region aligned to the granularity specified by the OS,
@@ -115,7 +171,13 @@ class BASE_EXPORT MemoryMappedFile {
 
   // Map the file to memory, set data_ to that memory address. Return true on
   // success, false on any kind of failure. This is a helper for Initialize().
-  bool MapFileRegionToMemory(const Region& region, Access access);
+  bool MapFileRegionToMemory(const Region& region,
+                             Access access,
+                             const Options& options);
+
+  // Reads the |size| bytes at |address| in, if they are still mapped. This
+  // doesn't access them, so it doesn't crash if they aren't.
+  static void Prefetch(const uint8_t* address, size_t size);
 
   // Closes all open handles.
   void CloseHandles();
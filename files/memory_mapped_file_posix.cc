@@ -11,8 +11,10 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include "base/bits.h"
 #include "base/logging.h"
 #include "base/numerics/safe_conversions.h"
+#include "base/process/process_metrics.h"
 #include "base/threading/thread_restrictions.h"
 #include "build/build_config.h"
 
@@ -20,14 +22,80 @@
 #include <android/api-level.h>
 #endif
 
+// Since Linux 5.14. Older kernels reject it with EINVAL.
+#if (defined(OS_LINUX) || defined(OS_ANDROID)) && !defined(MADV_POPULATE_READ)
+#define MADV_POPULATE_READ 22
+#endif
+
 namespace base {
 
+namespace {
+
+#if !defined(OS_NACL) && !defined(OS_FUCHSIA)
+int ToMadviseAdvice(MemoryMappedFile::Advice advice) {
+  switch (advice) {
+    case MemoryMappedFile::ADVICE_NORMAL:
+      return MADV_NORMAL;
+    case MemoryMappedFile::ADVICE_SEQUENTIAL:
+      return MADV_SEQUENTIAL;
+    case MemoryMappedFile::ADVICE_RANDOM:
+      return MADV_RANDOM;
+    case MemoryMappedFile::ADVICE_WILL_NEED:
+      return MADV_WILLNEED;
+  }
+  NOTREACHED();
+  return MADV_NORMAL;
+}
+
+// madvise() wants a page aligned start, which mappings of regions don't have.
+bool AdviseRange(const uint8_t* address, size_t size, int advice) {
+  uintptr_t start = reinterpret_cast<uintptr_t>(address);
+  uintptr_t aligned_start = start & ~(GetPageSize() - 1);
+  return madvise(reinterpret_cast<void*>(aligned_start),
+                 size + (start - aligned_start), advice) == 0;
+}
+#endif  // !defined(OS_NACL) && !defined(OS_FUCHSIA)
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+// The size of transparent huge pages on x86 and ARM.
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+// Returns an address where |size| bytes of the file from |file_offset| can be
+// mapped with MAP_FIXED, over an inaccessible reservation. The kernel only
+// uses huge pages for the parts of a file mapping whose address and file
+// offset are equal modulo the huge page size, which mmap() doesn't guarantee.
+void* ReserveHugePageAlignedRange(size_t size, off_t file_offset) {
+  size = bits::Align(size, GetPageSize());
+  void* reservation =
+      mmap(nullptr, size + kHugePageSize, PROT_NONE,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (reservation == MAP_FAILED)
+    return nullptr;
+
+  // Trims the reservation before and after the aligned range.
+  uintptr_t start = reinterpret_cast<uintptr_t>(reservation);
+  uintptr_t aligned_start =
+      start + ((static_cast<uintptr_t>(file_offset) - start) &
+               (kHugePageSize - 1));
+  if (aligned_start != start)
+    munmap(reservation, aligned_start - start);
+  uintptr_t aligned_end = aligned_start + size;
+  uintptr_t end = start + size + kHugePageSize;
+  if (end != aligned_end)
+    munmap(reinterpret_cast<void*>(aligned_end), end - aligned_end);
+  return reinterpret_cast<void*>(aligned_start);
+}
+#endif  // defined(OS_LINUX) || defined(OS_ANDROID)
+
+}  // namespace
+
 MemoryMappedFile::MemoryMappedFile() : data_(nullptr), length_(0) {}
 
 #if !defined(OS_NACL)
 bool MemoryMappedFile::MapFileRegionToMemory(
     const MemoryMappedFile::Region& region,
-    Access access) {
+    Access access,
+    const Options& options) {
   AssertBlockingAllowed();
 
   off_t map_start = 0;
@@ -159,16 +227,70 @@ bool MemoryMappedFile::MapFileRegionToMemory(
       break;
   }
 
-  data_ = static_cast<uint8_t*>(mmap(nullptr, map_size, flags, MAP_SHARED,
+  int map_flags = MAP_SHARED;
+  void* address = nullptr;
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  if (options.huge_pages && map_size >= kHugePageSize) {
+    address = ReserveHugePageAlignedRange(map_size, map_start);
+    if (address)
+      map_flags |= MAP_FIXED;
+  }
+  // Huge pages are only used for the pages faulted in after MADV_HUGEPAGE.
+  if (options.populate && !address)
+    map_flags |= MAP_POPULATE;
+#endif
+
+  data_ = static_cast<uint8_t*>(mmap(address, map_size, flags, map_flags,
                                      file_.GetPlatformFile(), map_start));
   if (data_ == MAP_FAILED) {
     DPLOG(ERROR) << "mmap " << file_.GetPlatformFile();
+    if (address)
+      munmap(address, map_size);
     return false;
   }
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  if (address) {
+    madvise(data_, map_size, MADV_HUGEPAGE);
+    if (options.populate)
+      Prefetch(data_, map_size);
+  }
+#endif
+#if !defined(OS_FUCHSIA)
+  Advice advice = options.advice;
+#if !defined(OS_LINUX) && !defined(OS_ANDROID)
+  if (options.populate)
+    advice = ADVICE_WILL_NEED;
+#endif
+  if (advice != ADVICE_NORMAL)
+    madvise(data_, map_size, ToMadviseAdvice(advice));
+#endif
+
   data_ += data_offset;
   return true;
 }
+
+bool MemoryMappedFile::Advise(Advice advice) {
+  DCHECK(IsValid());
+#if defined(OS_FUCHSIA)
+  return false;
+#else
+  return AdviseRange(data_, length_, ToMadviseAdvice(advice));
+#endif
+}
+
+// static
+void MemoryMappedFile::Prefetch(const uint8_t* address, size_t size) {
+#if !defined(OS_FUCHSIA)
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // Unlike MADV_WILLNEED, this also maps the pages which are read in, so that
+  // accessing them doesn't even take minor page faults.
+  if (AdviseRange(address, size, MADV_POPULATE_READ))
+    return;
+#endif
+  AdviseRange(address, size, MADV_WILLNEED);
+#endif
+}
 #endif
 
 void MemoryMappedFile::CloseHandles() {
@@ -11,6 +11,8 @@
 
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/test/scoped_task_environment.h"
+#include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/platform_test.h"
 
@@ -238,6 +240,72 @@ TEST_F(MemoryMappedFileTest, ExtendableFile) {
   EXPECT_EQ("BAZ", contents.substr(kFileSize, 3));
 }
 
+TEST_F(MemoryMappedFileTest, MapWithOptions) {
+  const size_t kFileSize = 157 * 1024;
+  CreateTemporaryTestFile(kFileSize);
+
+  for (MemoryMappedFile::Advice advice :
+       {MemoryMappedFile::ADVICE_NORMAL, MemoryMappedFile::ADVICE_SEQUENTIAL,
+        MemoryMappedFile::ADVICE_RANDOM, MemoryMappedFile::ADVICE_WILL_NEED}) {
+    for (bool populate : {false, true}) {
+      MemoryMappedFile::Options options;
+      options.advice = advice;
+      options.populate = populate;
+      MemoryMappedFile map;
+      ASSERT_TRUE(map.Initialize(temp_file_path(), MemoryMappedFile::READ_ONLY,
+                                 options));
+      ASSERT_EQ(kFileSize, map.length());
+      EXPECT_TRUE(CheckBufferContents(map.data(), kFileSize, 0));
+    }
+  }
+}
+
+TEST_F(MemoryMappedFileTest, MapRegionWithHugePages) {
+  const size_t kFileSize = 5 * 1024 * 1024;
+  const size_t kOffset = 1024 * 1024 + 1234;
+  const size_t kPartialSize = 3 * 1024 * 1024;
+  CreateTemporaryTestFile(kFileSize);
+
+  MemoryMappedFile::Options options;
+  options.huge_pages = true;
+  options.populate = true;
+  MemoryMappedFile map;
+  File file(temp_file_path(), File::FLAG_OPEN | File::FLAG_READ);
+  ASSERT_TRUE(map.Initialize(std::move(file), {kOffset, kPartialSize},
+                             MemoryMappedFile::READ_ONLY, options));
+  ASSERT_EQ(kPartialSize, map.length());
+  EXPECT_TRUE(CheckBufferContents(map.data(), kPartialSize, kOffset));
+}
+
+TEST_F(MemoryMappedFileTest, AdviseAndPrefetch) {
+  const size_t kFileSize = 157 * 1024;
+  const size_t kOffset = 12345;
+  const size_t kPartialSize = 64 * 1024;
+  CreateTemporaryTestFile(kFileSize);
+
+  test::ScopedTaskEnvironment scoped_task_environment;
+  MemoryMappedFile map;
+  File file(temp_file_path(), File::FLAG_OPEN | File::FLAG_READ);
+  ASSERT_TRUE(map.Initialize(std::move(file), {kOffset, kPartialSize}));
+#if defined(OS_POSIX) && !defined(OS_FUCHSIA)
+  EXPECT_TRUE(map.Advise(MemoryMappedFile::ADVICE_RANDOM));
+  EXPECT_TRUE(map.Advise(MemoryMappedFile::ADVICE_NORMAL));
+#endif
+
+  map.PrefetchInBackground(0, kPartialSize);
+  map.PrefetchInBackground(kPartialSize / 2, kPartialSize / 2);
+  scoped_task_environment.RunUntilIdle();
+  EXPECT_TRUE(CheckBufferContents(map.data(), kPartialSize, kOffset));
+
+  // Prefetching a mapping which is closed by the time the task runs is safe.
+  {
+    MemoryMappedFile closed_map;
+    ASSERT_TRUE(closed_map.Initialize(temp_file_path()));
+    closed_map.PrefetchInBackground(0, kFileSize);
+  }
+  scoped_task_environment.RunUntilIdle();
+}
+
 }  // namespace
 
 }  // namespace base
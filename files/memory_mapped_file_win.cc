@@ -20,9 +20,12 @@ namespace base {
 MemoryMappedFile::MemoryMappedFile() : data_(NULL), length_(0) {
 }
 
+// |options| are ignored, since Windows has no equivalent of madvise() for
+// mapped files.
 bool MemoryMappedFile::MapFileRegionToMemory(
     const MemoryMappedFile::Region& region,
-    Access access) {
+    Access access,
+    const Options& options) {
   AssertBlockingAllowed();
 
   if (!file_.IsValid())
@@ -94,6 +97,14 @@ bool MemoryMappedFile::MapFileRegionToMemory(
   return true;
 }
 
+bool MemoryMappedFile::Advise(Advice advice) {
+  DCHECK(IsValid());
+  return false;
+}
+
+// static
+void MemoryMappedFile::Prefetch(const uint8_t* address, size_t size) {}
+
 void MemoryMappedFile::CloseHandles() {
   if (data_)
     ::UnmapViewOfFile(data_);
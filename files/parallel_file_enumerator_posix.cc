@@ -0,0 +1,176 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/parallel_file_enumerator_posix.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <utility>
+
+#include "base/atomic_ref_count.h"
+#include "base/bind.h"
+#include "base/files/file_enumerator.h"
+#include "base/location.h"
+#include "base/sequenced_task_runner.h"
+#include "base/synchronization/atomic_flag.h"
+#include "base/task_scheduler/post_task.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "build/build_config.h"
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include "base/files/dir_reader_linux.h"
+#endif
+
+namespace base {
+
+namespace {
+
+// The most entries reported at once. Huge directories are reported in several
+// batches, so that the first results arrive early.
+const size_t kMaxBatchSize = 256;
+
+}  // namespace
+
+// Reads each directory in a separate task, which reads the entries of its
+// subdirectories from new tasks, and counts the directories still to be read
+// so that the last task to finish can report that the enumeration is done.
+class ParallelFileEnumerator::Core : public RefCountedThreadSafe<Core> {
+ public:
+  Core(int file_type, WeakPtr<ParallelFileEnumerator> enumerator)
+      : file_type_(file_type),
+        reply_task_runner_(SequencedTaskRunnerHandle::Get()),
+        enumerator_(std::move(enumerator)) {}
+
+  // Reads the directory at |path| from a new task.
+  void StartReading(const FilePath& path) {
+    pending_directories_.Increment();
+    PostTaskWithTraits(FROM_HERE,
+                       {MayBlock(), TaskShutdownBehavior::SKIP_ON_SHUTDOWN},
+                       BindOnce(&Core::ReadDirectory, this, path));
+  }
+
+  // Makes the pending tasks return early.
+  void Cancel() { cancelled_.Set(); }
+
+ private:
+  friend class RefCountedThreadSafe<Core>;
+
+  ~Core() = default;
+
+  void ReadDirectory(const FilePath& path) {
+    if (!cancelled_.IsSet()) {
+      std::vector<Entry> entries;
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+      // Reads many entries per system call, and doesn't allocate a DIR.
+      DirReaderLinux reader(path.value().c_str());
+      if (reader.IsValid()) {
+        while (reader.Next())
+          AddEntry(path, reader.fd(), reader.name(), reader.type(), &entries);
+      }
+#else
+      DIR* dir = opendir(path.value().c_str());
+      if (dir) {
+        while (struct dirent* dent = readdir(dir))
+          AddEntry(path, dirfd(dir), dent->d_name, dent->d_type, &entries);
+        closedir(dir);
+      }
+#endif
+      if (!entries.empty())
+        Report(&entries);
+    }
+
+    // All the batches of this task are posted before the last task reports
+    // the end, so they are delivered first.
+    if (!pending_directories_.Decrement()) {
+      reply_task_runner_->PostTask(
+          FROM_HERE, BindOnce(&ParallelFileEnumerator::OnDone, enumerator_));
+    }
+  }
+
+  void AddEntry(const FilePath& directory_path,
+                int directory_fd,
+                const char* name,
+                unsigned char type,
+                std::vector<Entry>* entries) {
+    if (!strcmp(name, ".") || !strcmp(name, ".."))
+      return;
+
+    bool is_directory = type == DT_DIR;
+    bool is_link = type == DT_LNK;
+    if (type == DT_UNKNOWN) {
+      struct stat st;
+      if (fstatat(directory_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+        return;
+      is_directory = S_ISDIR(st.st_mode);
+      is_link = S_ISLNK(st.st_mode);
+    }
+
+    FilePath path = directory_path.Append(name);
+    if (is_directory)
+      StartReading(path);
+
+    // A link is reported with the type of its target, unless the links
+    // themselves are asked for, like FileEnumerator does.
+    if (is_link && !(file_type_ & FileEnumerator::SHOW_SYM_LINKS)) {
+      struct stat st;
+      is_directory =
+          fstatat(directory_fd, name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+    }
+
+    if (file_type_ &
+        (is_directory ? FileEnumerator::DIRECTORIES : FileEnumerator::FILES)) {
+      entries->push_back({std::move(path), is_directory});
+      if (entries->size() == kMaxBatchSize)
+        Report(entries);
+    }
+  }
+
+  void Report(std::vector<Entry>* entries) {
+    reply_task_runner_->PostTask(
+        FROM_HERE, BindOnce(&ParallelFileEnumerator::OnEntries, enumerator_,
+                            std::move(*entries)));
+    entries->clear();
+  }
+
+  const int file_type_;
+  const scoped_refptr<SequencedTaskRunner> reply_task_runner_;
+  const WeakPtr<ParallelFileEnumerator> enumerator_;
+
+  AtomicFlag cancelled_;
+  AtomicRefCount pending_directories_;
+
+  DISALLOW_COPY_AND_ASSIGN(Core);
+};
+
+ParallelFileEnumerator::ParallelFileEnumerator(const FilePath& root_path,
+                                               int file_type,
+                                               EntriesCallback on_entries,
+                                               OnceClosure on_done)
+    : on_entries_(std::move(on_entries)),
+      on_done_(std::move(on_done)),
+      weak_factory_(this) {
+  DCHECK(!(file_type & FileEnumerator::INCLUDE_DOT_DOT));
+  core_ = MakeRefCounted<Core>(file_type, weak_factory_.GetWeakPtr());
+  core_->StartReading(root_path.StripTrailingSeparators());
+}
+
+ParallelFileEnumerator::~ParallelFileEnumerator() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  core_->Cancel();
+}
+
+void ParallelFileEnumerator::OnEntries(std::vector<Entry> entries) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  on_entries_.Run(std::move(entries));
+}
+
+void ParallelFileEnumerator::OnDone() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  std::move(on_done_).Run();
+}
+
+}  // namespace base
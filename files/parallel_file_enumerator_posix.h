@@ -0,0 +1,78 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_PARALLEL_FILE_ENUMERATOR_POSIX_H_
+#define BASE_FILES_PARALLEL_FILE_ENUMERATOR_POSIX_H_
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequence_checker.h"
+
+namespace base {
+
+// Enumerates a directory tree recursively, reading several directories at
+// once from TaskScheduler workers, and streams the results back to the
+// sequence which created it. This is much faster than a recursive
+// FileEnumerator on large trees: directories are read with getdents64() on
+// Linux, and entries are only stat()ed when the directory doesn't say what
+// type they are.
+//
+// Example:
+//
+//   enumerator_ = std::make_unique<ParallelFileEnumerator>(
+//       root, FileEnumerator::FILES,
+//       BindRepeating(&Indexer::AddFiles, weak_factory_.GetWeakPtr()),
+//       BindOnce(&Indexer::OnEnumerationDone, weak_factory_.GetWeakPtr()));
+//
+// Unlike FileEnumerator, this doesn't descend into symbolic links to
+// directories, so that it can't loop.
+class BASE_EXPORT ParallelFileEnumerator {
+ public:
+  struct Entry {
+    // The path of the entry, starting with the root passed to the
+    // constructor.
+    FilePath path;
+    bool is_directory;
+  };
+
+  using EntriesCallback = RepeatingCallback<void(std::vector<Entry> entries)>;
+
+  // Starts enumerating the tree under |root_path|. |file_type| is a bit mask
+  // of FileEnumerator::FILES, DIRECTORIES and SHOW_SYM_LINKS, which have the
+  // same meaning as for FileEnumerator. |on_entries| runs with batches of the
+  // entries found, in no particular order, until all of them are reported,
+  // and then |on_done| runs. Deleting the enumerator stops the enumeration,
+  // and no callback runs after that.
+  ParallelFileEnumerator(const FilePath& root_path,
+                         int file_type,
+                         EntriesCallback on_entries,
+                         OnceClosure on_done);
+  ~ParallelFileEnumerator();
+
+ private:
+  class Core;
+
+  void OnEntries(std::vector<Entry> entries);
+  void OnDone();
+
+  scoped_refptr<Core> core_;
+  EntriesCallback on_entries_;
+  OnceClosure on_done_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  WeakPtrFactory<ParallelFileEnumerator> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelFileEnumerator);
+};
+
+}  // namespace base
+
+#endif  // BASE_FILES_PARALLEL_FILE_ENUMERATOR_POSIX_H_
@@ -0,0 +1,156 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/parallel_file_enumerator_posix.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/scoped_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class ParallelFileEnumeratorTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    root_ = temp_dir_.GetPath();
+  }
+
+  void CreateFile(const FilePath& path) {
+    ASSERT_TRUE(CreateDirectory(path.DirName()));
+    ASSERT_EQ(1, WriteFile(path, "x", 1));
+  }
+
+  // Returns the entries found under |root_|, with a trailing separator for
+  // the directories.
+  std::set<FilePath::StringType> Enumerate(int file_type) {
+    std::set<FilePath::StringType> results;
+    RunLoop run_loop;
+    ParallelFileEnumerator enumerator(
+        root_, file_type,
+        BindRepeating(
+            [](std::set<FilePath::StringType>* results,
+               std::vector<ParallelFileEnumerator::Entry> entries) {
+              for (const ParallelFileEnumerator::Entry& entry : entries) {
+                FilePath::StringType path = entry.path.value();
+                if (entry.is_directory)
+                  path += FILE_PATH_LITERAL("/");
+                EXPECT_TRUE(results->insert(path).second) << path;
+              }
+            },
+            &results),
+        run_loop.QuitClosure());
+    run_loop.Run();
+    return results;
+  }
+
+  // Returns what FileEnumerator finds, in the same format as Enumerate().
+  std::set<FilePath::StringType> EnumerateSerially(int file_type) {
+    std::set<FilePath::StringType> results;
+    FileEnumerator enumerator(root_, true, file_type);
+    for (FilePath path = enumerator.Next(); !path.empty();
+         path = enumerator.Next()) {
+      FilePath::StringType value = path.value();
+      if (enumerator.GetInfo().IsDirectory())
+        value += FILE_PATH_LITERAL("/");
+      results.insert(value);
+    }
+    return results;
+  }
+
+  test::ScopedTaskEnvironment scoped_task_environment_;
+  ScopedTempDir temp_dir_;
+  FilePath root_;
+};
+
+}  // namespace
+
+TEST_F(ParallelFileEnumeratorTest, EmptyDirectory) {
+  EXPECT_TRUE(Enumerate(FileEnumerator::FILES | FileEnumerator::DIRECTORIES)
+                  .empty());
+}
+
+TEST_F(ParallelFileEnumeratorTest, MissingRoot) {
+  root_ = root_.AppendASCII("missing");
+  EXPECT_TRUE(Enumerate(FileEnumerator::FILES).empty());
+}
+
+TEST_F(ParallelFileEnumeratorTest, MatchesFileEnumerator) {
+  // Enough files in one directory to be reported in several batches.
+  for (int i = 0; i < 1000; ++i)
+    CreateFile(root_.AppendASCII("big").AppendASCII(IntToString(i)));
+  for (int i = 0; i < 20; ++i) {
+    FilePath directory = root_.AppendASCII(IntToString(i));
+    CreateFile(directory.AppendASCII("file"));
+    CreateFile(directory.AppendASCII("a").AppendASCII("b").AppendASCII("c"));
+    ASSERT_TRUE(CreateDirectory(directory.AppendASCII("empty")));
+  }
+  CreateFile(root_.AppendASCII("top"));
+
+  const int kFileTypes[] = {
+      FileEnumerator::FILES, FileEnumerator::DIRECTORIES,
+      FileEnumerator::FILES | FileEnumerator::DIRECTORIES};
+  for (int file_type : kFileTypes) {
+    std::set<FilePath::StringType> results = Enumerate(file_type);
+    EXPECT_FALSE(results.empty());
+    EXPECT_EQ(EnumerateSerially(file_type), results);
+  }
+  EXPECT_EQ(1041u, Enumerate(FileEnumerator::FILES).size());
+}
+
+TEST_F(ParallelFileEnumeratorTest, SymbolicLinks) {
+  FilePath directory = root_.AppendASCII("directory");
+  CreateFile(directory.AppendASCII("file"));
+  // A loop, which isn't followed.
+  ASSERT_TRUE(CreateSymbolicLink(root_, directory.AppendASCII("loop")));
+  ASSERT_TRUE(CreateSymbolicLink(directory.AppendASCII("file"),
+                                 root_.AppendASCII("link")));
+
+  const FilePath::StringType prefix = root_.value();
+  EXPECT_EQ((std::set<FilePath::StringType>{
+                prefix + "/directory/", prefix + "/directory/file",
+                prefix + "/directory/loop/", prefix + "/link"}),
+            Enumerate(FileEnumerator::FILES | FileEnumerator::DIRECTORIES));
+  EXPECT_EQ((std::set<FilePath::StringType>{
+                prefix + "/directory/", prefix + "/directory/file",
+                prefix + "/directory/loop", prefix + "/link"}),
+            Enumerate(FileEnumerator::FILES | FileEnumerator::DIRECTORIES |
+                      FileEnumerator::SHOW_SYM_LINKS));
+}
+
+TEST_F(ParallelFileEnumeratorTest, DeleteFromCallback) {
+  for (int i = 0; i < 50; ++i)
+    CreateFile(root_.AppendASCII(IntToString(i)).AppendASCII("file"));
+
+  std::unique_ptr<ParallelFileEnumerator> enumerator;
+  int batches = 0;
+  enumerator = std::make_unique<ParallelFileEnumerator>(
+      root_, FileEnumerator::FILES,
+      BindRepeating(
+          [](std::unique_ptr<ParallelFileEnumerator>* enumerator, int* batches,
+             std::vector<ParallelFileEnumerator::Entry> entries) {
+            ++*batches;
+            enumerator->reset();
+          },
+          &enumerator, &batches),
+      BindOnce([]() { ADD_FAILURE() << "Enumeration wasn't stopped"; }));
+  scoped_task_environment_.RunUntilIdle();
+  EXPECT_EQ(1, batches);
+  EXPECT_FALSE(enumerator);
+}
+
+}  // namespace base
@@ -9,7 +9,6 @@
 
 #include "base/rand_util.h"
 #include "base/strings/string_util.h"
-#include "base/strings/stringprintf.h"
 
 namespace base {
 
@@ -41,6 +40,26 @@ bool IsValidGUIDInternal(const base::StringPiece& guid, bool strict) {
 }  // namespace
 
 std::string GenerateGUID() {
+  return Guid::Generate().ToString();
+}
+
+bool IsValidGUID(const base::StringPiece& guid) {
+  return IsValidGUIDInternal(guid, false /* strict */);
+}
+
+bool IsValidGUIDOutputString(const base::StringPiece& guid) {
+  return IsValidGUIDInternal(guid, true /* strict */);
+}
+
+std::string RandomDataToGUIDString(const uint64_t bytes[2]) {
+  return Guid::Deserialize(bytes[0], bytes[1]).ToString();
+}
+
+// static
+constexpr size_t Guid::kStringLength;
+
+// static
+Guid Guid::Generate() {
   uint64_t sixteen_bytes[2];
   // Use base::RandBytes instead of crypto::RandBytes, because crypto calls the
   // base version directly, and to prevent the dependency from base/ to crypto/.
@@ -59,24 +78,57 @@ std::string GenerateGUID() {
   sixteen_bytes[1] &= 0x3fffffff'ffffffffULL;
   sixteen_bytes[1] |= 0x80000000'00000000ULL;
 
-  return RandomDataToGUIDString(sixteen_bytes);
+  return Guid(sixteen_bytes[0], sixteen_bytes[1]);
 }
 
-bool IsValidGUID(const base::StringPiece& guid) {
-  return IsValidGUIDInternal(guid, false /* strict */);
+// static
+bool Guid::Parse(StringPiece input, Guid* guid) {
+  if (!IsValidGUID(input))
+    return false;
+  uint64_t words[2] = {0, 0};
+  size_t num_digits = 0;
+  for (char c : input) {
+    if (c == '-')
+      continue;
+    uint64_t& word = words[num_digits++ / 16];
+    word = (word << 4) | HexDigitToInt(c);
+  }
+  *guid = Guid(words[0], words[1]);
+  return true;
 }
 
-bool IsValidGUIDOutputString(const base::StringPiece& guid) {
-  return IsValidGUIDInternal(guid, true /* strict */);
+char* Guid::FormatTo(char* output) const {
+  output = internal::WriteHexDigits(high_ >> 32, 8, false, output);
+  *output++ = '-';
+  output = internal::WriteHexDigits(high_ >> 16, 4, false, output);
+  *output++ = '-';
+  output = internal::WriteHexDigits(high_, 4, false, output);
+  *output++ = '-';
+  output = internal::WriteHexDigits(low_ >> 48, 4, false, output);
+  *output++ = '-';
+  return internal::WriteHexDigits(low_, 12, false, output);
 }
 
-std::string RandomDataToGUIDString(const uint64_t bytes[2]) {
-  return StringPrintf("%08x-%04x-%04x-%04x-%012llx",
-                      static_cast<unsigned int>(bytes[0] >> 32),
-                      static_cast<unsigned int>((bytes[0] >> 16) & 0x0000ffff),
-                      static_cast<unsigned int>(bytes[0] & 0x0000ffff),
-                      static_cast<unsigned int>(bytes[1] >> 48),
-                      bytes[1] & 0x0000ffff'ffffffffULL);
+std::string Guid::ToString() const {
+  std::string result(kStringLength, '\0');
+  FormatTo(&result[0]);
+  return result;
+}
+
+namespace internal {
+
+char* WriteHexDigits(uint64_t value,
+                     size_t num_digits,
+                     bool upper_case,
+                     char* output) {
+  const char* digits = upper_case ? "0123456789ABCDEF" : "0123456789abcdef";
+  for (size_t i = num_digits; i > 0; --i) {
+    output[i - 1] = digits[value & 0xf];
+    value >>= 4;
+  }
+  return output + num_digits;
 }
 
+}  // namespace internal
+
 }  // namespace base
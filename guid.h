@@ -5,11 +5,14 @@
 #ifndef BASE_GUID_H_
 #define BASE_GUID_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <string>
+#include <tuple>
 
 #include "base/base_export.h"
+#include "base/hash.h"
 #include "base/strings/string_piece.h"
 #include "build/build_config.h"
 
@@ -40,6 +43,79 @@ BASE_EXPORT bool IsValidGUIDOutputString(const base::StringPiece& guid);
 // For unit testing purposes only.  Do not use outside of tests.
 BASE_EXPORT std::string RandomDataToGUIDString(const uint64_t bytes[2]);
 
+// A GUID in binary form: 16 bytes rather than a 36-character string, which
+// makes it cheaper to generate, compare, hash and store, e.g. as the key of a
+// flat_map or, with GuidHash, of a std::unordered_map. Convert it to the
+// string form only at the boundaries which need one.
+class BASE_EXPORT Guid {
+ public:
+  // The length of the string form, xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx.
+  static constexpr size_t kStringLength = 36;
+
+  // Generates a random version 4 GUID, like GenerateGUID().
+  static Guid Generate();
+
+  // Parses a GUID in any of the forms IsValidGUID() accepts. Returns false,
+  // leaving |guid| untouched, if |input| isn't one.
+  static bool Parse(StringPiece input, Guid* guid);
+
+  // Returns the GUID whose string form is RandomDataToGUIDString({high, low}).
+  static Guid Deserialize(uint64_t high, uint64_t low) {
+    return Guid(high, low);
+  }
+
+  // Creates the all zero GUID.
+  constexpr Guid() = default;
+
+  uint64_t GetHighForSerialization() const { return high_; }
+  uint64_t GetLowForSerialization() const { return low_; }
+
+  bool is_empty() const { return high_ == 0 && low_ == 0; }
+
+  // Writes the kStringLength characters of the lower case string form to
+  // |output|, without a terminating NUL, and returns the end of what it wrote.
+  char* FormatTo(char* output) const;
+
+  // Returns the lower case string form, as GenerateGUID() does.
+  std::string ToString() const;
+
+  bool operator<(const Guid& other) const {
+    return std::tie(high_, low_) < std::tie(other.high_, other.low_);
+  }
+
+  bool operator==(const Guid& other) const {
+    return high_ == other.high_ && low_ == other.low_;
+  }
+
+  bool operator!=(const Guid& other) const { return !(*this == other); }
+
+ private:
+  friend struct GuidHash;
+  constexpr Guid(uint64_t high, uint64_t low) : high_(high), low_(low) {}
+
+  uint64_t high_ = 0;
+  uint64_t low_ = 0;
+};
+
+// For use in std::unordered_map.
+struct GuidHash {
+  size_t operator()(const Guid& guid) const {
+    return HashInts64(guid.high_, guid.low_);
+  }
+};
+
+namespace internal {
+
+// Writes the |num_digits| lowest hexadecimal digits of |value|, most
+// significant first, to |output| and returns their end. Shared by Guid and
+// UnguessableToken.
+BASE_EXPORT char* WriteHexDigits(uint64_t value,
+                                 size_t num_digits,
+                                 bool upper_case,
+                                 char* output);
+
+}  // namespace internal
+
 }  // namespace base
 
 #endif  // BASE_GUID_H_
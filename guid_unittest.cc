@@ -7,7 +7,9 @@
 #include <stdint.h>
 
 #include <limits>
+#include <unordered_set>
 
+#include "base/containers/flat_set.h"
 #include "base/strings/string_util.h"
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -62,4 +64,64 @@ TEST(GUIDTest, GUIDBasicUniqueness) {
   }
 }
 
+TEST(GUIDTest, GuidGeneratesVersion4) {
+  for (int it = 0; it < 10; ++it) {
+    Guid guid = Guid::Generate();
+    EXPECT_FALSE(guid.is_empty());
+    EXPECT_TRUE(IsGUIDv4(guid.ToString()));
+    EXPECT_TRUE(IsValidGUIDOutputString(guid.ToString()));
+    EXPECT_NE(guid, Guid::Generate());
+  }
+}
+
+TEST(GUIDTest, GuidFormatsLikeRandomDataToGUIDString) {
+  const uint64_t bytes[] = {0x0123456789ABCDEFULL, 0xFEDCBA9876543210ULL};
+  Guid guid = Guid::Deserialize(bytes[0], bytes[1]);
+  EXPECT_EQ(RandomDataToGUIDString(bytes), guid.ToString());
+
+  char buffer[Guid::kStringLength + 1];
+  buffer[Guid::kStringLength] = 'x';
+  EXPECT_EQ(buffer + Guid::kStringLength, guid.FormatTo(buffer));
+  EXPECT_EQ("01234567-89ab-cdef-fedc-ba9876543210",
+            std::string(buffer, Guid::kStringLength));
+  EXPECT_EQ('x', buffer[Guid::kStringLength]);
+
+  EXPECT_TRUE(Guid().is_empty());
+  EXPECT_EQ("00000000-0000-0000-0000-000000000000", Guid().ToString());
+}
+
+TEST(GUIDTest, GuidParse) {
+  Guid guid;
+  ASSERT_TRUE(Guid::Parse("01234567-89AB-cdef-FEDC-ba9876543210", &guid));
+  EXPECT_EQ(0x0123456789ABCDEFULL, guid.GetHighForSerialization());
+  EXPECT_EQ(0xFEDCBA9876543210ULL, guid.GetLowForSerialization());
+
+  Guid generated = Guid::Generate();
+  ASSERT_TRUE(Guid::Parse(generated.ToString(), &guid));
+  EXPECT_EQ(generated, guid);
+
+  EXPECT_FALSE(Guid::Parse("", &guid));
+  EXPECT_FALSE(Guid::Parse("01234567-89ab-cdef-fedc-ba987654321", &guid));
+  EXPECT_FALSE(Guid::Parse("01234567-89ab-cdef-fedc-ba987654321g", &guid));
+  EXPECT_FALSE(Guid::Parse("0123456789ab-cdef-fedc-ba9876543210-", &guid));
+  EXPECT_EQ(generated, guid);
+}
+
+TEST(GUIDTest, GuidAsKey) {
+  Guid first = Guid::Deserialize(1, 2);
+  Guid second = Guid::Deserialize(1, 3);
+  Guid third = Guid::Deserialize(2, 0);
+  EXPECT_LT(first, second);
+  EXPECT_LT(second, third);
+
+  flat_set<Guid> sorted = {third, first, second, first};
+  EXPECT_EQ(3u, sorted.size());
+  EXPECT_EQ(first, *sorted.begin());
+
+  std::unordered_set<Guid, GuidHash> hashed = {third, first, second, first};
+  EXPECT_EQ(3u, hashed.size());
+  EXPECT_EQ(1u, hashed.count(second));
+  EXPECT_EQ(0u, hashed.count(Guid()));
+}
+
 }  // namespace base
@@ -4,6 +4,8 @@
 
 #include "base/hash.h"
 
+#include <string.h>
+
 // Definition in base/third_party/superfasthash/superfasthash.c. (Third-party
 // code did not come with its own header file, so declaring the function here.)
 // Note: This algorithm is also in Blink under Source/wtf/StringHasher.h.
@@ -11,6 +13,102 @@ extern "C" uint32_t SuperFastHash(const char* data, int len);
 
 namespace base {
 
+namespace {
+
+// The constants of wyhash.
+const uint64_t kSecret[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+                             0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+
+inline uint64_t Read64(const uint8_t* p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline uint64_t Read32(const uint8_t* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+// Computes the 128-bit product of |a| and |b|.
+inline void Multiply128(uint64_t a, uint64_t b, uint64_t* low, uint64_t* high) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+  *low = static_cast<uint64_t>(product);
+  *high = static_cast<uint64_t>(product >> 64);
+#else
+  uint64_t a_low = a & 0xffffffff;
+  uint64_t a_high = a >> 32;
+  uint64_t b_low = b & 0xffffffff;
+  uint64_t b_high = b >> 32;
+  uint64_t low_low = a_low * b_low;
+  uint64_t high_low = a_high * b_low;
+  uint64_t middle = (low_low >> 32) + (high_low & 0xffffffff) + a_low * b_high;
+  *low = (middle << 32) | (low_low & 0xffffffff);
+  *high = a_high * b_high + (high_low >> 32) + (middle >> 32);
+#endif
+}
+
+// Folds the 128-bit product of |a| and |b| into 64 bits.
+inline uint64_t Mix(uint64_t a, uint64_t b) {
+  uint64_t low, high;
+  Multiply128(a, b, &low, &high);
+  return low ^ high;
+}
+
+uint64_t InitialState(uint64_t seed) {
+  return seed ^ Mix(seed ^ kSecret[0], kSecret[1]);
+}
+
+// Mixes a 48-byte block into |lanes|, which are independent so that their
+// multiplications can run in parallel.
+inline void MixBlock(const uint8_t* block, uint64_t* lanes) {
+  lanes[0] = Mix(Read64(block) ^ kSecret[1], Read64(block + 8) ^ lanes[0]);
+  lanes[1] =
+      Mix(Read64(block + 16) ^ kSecret[2], Read64(block + 24) ^ lanes[1]);
+  lanes[2] =
+      Mix(Read64(block + 32) ^ kSecret[3], Read64(block + 40) ^ lanes[2]);
+}
+
+// Hashes the |tail_length| bytes at |tail| which follow the 48-byte blocks of
+// the input, |length| bytes in total. |state| is the state after the blocks.
+// When there are blocks and |tail_length| is less than 16, the 16 bytes before
+// the end of the input are read.
+uint64_t HashTail(uint64_t state,
+                  const uint8_t* tail,
+                  size_t tail_length,
+                  uint64_t length) {
+  uint64_t a, b;
+  if (length <= 16) {
+    if (length >= 4) {
+      // Two overlapping reads from each end cover up to 16 bytes.
+      size_t offset = (length >> 3) << 2;
+      a = (Read32(tail) << 32) | Read32(tail + offset);
+      b = (Read32(tail + length - 4) << 32) |
+          Read32(tail + length - 4 - offset);
+    } else if (length > 0) {
+      a = (static_cast<uint64_t>(tail[0]) << 16) |
+          (static_cast<uint64_t>(tail[length >> 1]) << 8) | tail[length - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    while (tail_length > 16) {
+      state = Mix(Read64(tail) ^ kSecret[1], Read64(tail + 8) ^ state);
+      tail += 16;
+      tail_length -= 16;
+    }
+    a = Read64(tail + tail_length - 16);
+    b = Read64(tail + tail_length - 8);
+  }
+  Multiply128(a ^ kSecret[1], b ^ state, &a, &b);
+  return Mix(a ^ kSecret[0] ^ length, b ^ kSecret[1]);
+}
+
+}  // namespace
+
 uint32_t Hash(const void* data, size_t length) {
   // Currently our in-memory hash is the same as the persistent hash. The
   // split between in-memory and persistent hash functions is maintained to
@@ -26,6 +124,73 @@ uint32_t Hash(const string16& str) {
   return PersistentHash(str.data(), str.size() * sizeof(char16));
 }
 
+uint64_t Hash64(const void* data, size_t length, uint64_t seed) {
+  const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+  uint64_t state = InitialState(seed);
+  size_t remaining = length;
+  if (remaining > 48) {
+    uint64_t lanes[3] = {state, state, state};
+    do {
+      MixBlock(input, lanes);
+      input += 48;
+      remaining -= 48;
+    } while (remaining > 48);
+    state = lanes[0] ^ lanes[1] ^ lanes[2];
+  }
+  return HashTail(state, input, remaining, length);
+}
+
+uint64_t Hash64(const std::string& str, uint64_t seed) {
+  return Hash64(str.data(), str.size(), seed);
+}
+
+uint64_t Hash64(const string16& str, uint64_t seed) {
+  return Hash64(str.data(), str.size() * sizeof(char16), seed);
+}
+
+IncrementalHash64::IncrementalHash64(uint64_t seed) {
+  lanes_[0] = lanes_[1] = lanes_[2] = InitialState(seed);
+}
+
+void IncrementalHash64::Update(const void* data, size_t length) {
+  const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+  uint8_t* pending = buffer_ + 16;
+  length_ += length;
+  if (pending_size_ + length <= kBlockSize) {
+    memcpy(pending + pending_size_, input, length);
+    pending_size_ += length;
+    return;
+  }
+
+  // Input follows the first kBlockSize bytes, so they can be mixed.
+  const uint8_t* last_block = nullptr;
+  if (pending_size_) {
+    size_t copied = kBlockSize - pending_size_;
+    memcpy(pending + pending_size_, input, copied);
+    input += copied;
+    length -= copied;
+    MixBlock(pending, lanes_);
+    last_block = pending;
+  }
+  while (length > kBlockSize) {
+    MixBlock(input, lanes_);
+    last_block = input;
+    input += kBlockSize;
+    length -= kBlockSize;
+  }
+  DCHECK(last_block);
+  memcpy(buffer_, last_block + kBlockSize - 16, 16);
+  memcpy(pending, input, length);
+  pending_size_ = length;
+}
+
+uint64_t IncrementalHash64::Finish() const {
+  uint64_t state = lanes_[0];
+  if (length_ > kBlockSize)
+    state = lanes_[0] ^ lanes_[1] ^ lanes_[2];
+  return HashTail(state, buffer_ + 16, pending_size_, length_);
+}
+
 uint32_t PersistentHash(const void* data, size_t length) {
   // This hash function must not change, since it is designed to be persistable
   // to disk.
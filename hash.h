@@ -14,6 +14,7 @@
 
 #include "base/base_export.h"
 #include "base/logging.h"
+#include "base/macros.h"
 #include "base/strings/string16.h"
 
 namespace base {
@@ -27,6 +28,48 @@ BASE_EXPORT uint32_t Hash(const void* data, size_t length);
 BASE_EXPORT uint32_t Hash(const std::string& str);
 BASE_EXPORT uint32_t Hash(const string16& str);
 
+// Computes a 64-bit hash of a memory buffer, based on wyhash
+// (https://github.com/wangyi-fudan/wyhash). It is much faster than Hash() on
+// long buffers, and |seed| selects one of a family of hash functions. Like
+// Hash(), it is subject to change in the future and differs between platforms,
+// so use it only for temporary in-memory structures.
+//
+// WARNING: This hash function should not be used for any cryptographic purpose.
+BASE_EXPORT uint64_t Hash64(const void* data, size_t length, uint64_t seed = 0);
+BASE_EXPORT uint64_t Hash64(const std::string& str, uint64_t seed = 0);
+BASE_EXPORT uint64_t Hash64(const string16& str, uint64_t seed = 0);
+
+// Computes Hash64() of data which isn't available all at once: the result is
+// the hash of everything passed to Update(). For example:
+//
+//   IncrementalHash64 hash(seed);
+//   for (const std::string& chunk : chunks)
+//     hash.Update(chunk.data(), chunk.size());
+//   uint64_t value = hash.Finish();
+class BASE_EXPORT IncrementalHash64 {
+ public:
+  explicit IncrementalHash64(uint64_t seed = 0);
+
+  void Update(const void* data, size_t length);
+
+  // Returns the hash of the data so far. More data can be added afterwards.
+  uint64_t Finish() const;
+
+ private:
+  static constexpr size_t kBlockSize = 48;
+
+  // The state after the blocks mixed so far.
+  uint64_t lanes_[3];
+  // The last 16 bytes of the mixed blocks, followed by the |pending_size_|
+  // bytes of input which aren't mixed yet. A block is only mixed once some
+  // input follows it, since the end of the input is hashed differently.
+  uint8_t buffer_[16 + kBlockSize];
+  size_t pending_size_ = 0;
+  uint64_t length_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(IncrementalHash64);
+};
+
 // Computes a hash of a memory buffer. This hash function must not change so
 // that code can use the hashed values for persistent storage purposes or
 // sending across the network. If a new persistent hash function is desired, a
@@ -0,0 +1,87 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/hash.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "base/crc32c.h"
+#include "base/debug/alias.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+// Hashes about this many bytes for each input size.
+const size_t kBytesPerSize = 256 * 1024 * 1024;
+
+const size_t kSizes[] = {4, 16, 64, 256, 1024, 64 * 1024, 1024 * 1024};
+
+uint64_t HashWithHash(const char* data, size_t length) {
+  return Hash(data, length);
+}
+
+uint64_t HashWithHash64(const char* data, size_t length) {
+  return Hash64(data, length);
+}
+
+uint64_t HashWithIncrementalHash64(const char* data, size_t length) {
+  IncrementalHash64 hash;
+  hash.Update(data, length);
+  return hash.Finish();
+}
+
+uint64_t HashWithCrc32c(const char* data, size_t length) {
+  return Crc32c(data, length);
+}
+
+void RunTest(const char* name, uint64_t (*hash)(const char*, size_t)) {
+  std::string input(kSizes[arraysize(kSizes) - 1] + 1, '\0');
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<char>(i * 131);
+
+  for (size_t size : kSizes) {
+    const size_t iterations = kBytesPerSize / size;
+    uint64_t result = 0;
+    TimeTicks start = TimeTicks::Now();
+    for (size_t i = 0; i < iterations; ++i) {
+      // Vary the alignment, and make each hash depend on the previous one so
+      // that they can't overlap.
+      result += hash(input.data() + (result & 1), size);
+    }
+    TimeDelta elapsed = TimeTicks::Now() - start;
+    debug::Alias(&result);
+    perf_test::PrintResult(
+        "hash_throughput", StringPrintf("_%zu_bytes", size), name,
+        iterations * size / elapsed.InSecondsF() / (1024 * 1024), "MB/s",
+        true);
+  }
+}
+
+}  // namespace
+
+TEST(HashPerfTest, Hash) {
+  RunTest("Hash", &HashWithHash);
+}
+
+TEST(HashPerfTest, Hash64) {
+  RunTest("Hash64", &HashWithHash64);
+}
+
+TEST(HashPerfTest, IncrementalHash64) {
+  RunTest("IncrementalHash64", &HashWithIncrementalHash64);
+}
+
+TEST(HashPerfTest, Crc32c) {
+  RunTest("Crc32c", &HashWithCrc32c);
+}
+
+}  // namespace base
@@ -4,9 +4,14 @@
 
 #include "base/hash.h"
 
+#include <stdint.h>
+
+#include <set>
 #include <string>
 #include <vector>
 
+#include "base/strings/utf_string_conversions.h"
+
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -79,4 +84,72 @@ TEST(HashTest, CString) {
   EXPECT_EQ(2794219650u, Hash(str, strlen("hello world")));
 }
 
+TEST(HashTest, PersistentHashIsStable) {
+  // These values must never change.
+  EXPECT_EQ(0u, PersistentHash(std::string()));
+  EXPECT_EQ(2794219650u, PersistentHash("hello world"));
+  EXPECT_EQ(2794219650u, PersistentHash("hello world", strlen("hello world")));
+}
+
+TEST(HashTest, Hash64) {
+  const std::string kText = "hello world";
+  EXPECT_EQ(Hash64(kText.data(), kText.size()), Hash64(kText));
+  EXPECT_EQ(Hash64(kText, 1234), Hash64(kText, 1234));
+  EXPECT_NE(Hash64(kText), Hash64(kText, 1234));
+  EXPECT_NE(Hash64(std::string()), Hash64(std::string(), 1234));
+
+  const string16 text16 = ASCIIToUTF16(kText);
+  EXPECT_EQ(Hash64(text16.data(), text16.size() * sizeof(char16)),
+            Hash64(text16));
+
+  // Ensure that it stops reading after the given length.
+  const char kLonger[] = "hello world; don't read this part";
+  EXPECT_EQ(Hash64(kText), Hash64(kLonger, kText.size()));
+}
+
+// Flipping any bit of inputs of any length, or changing their length, gives a
+// different hash. Covers all the code paths.
+TEST(HashTest, Hash64Collisions) {
+  std::set<uint64_t> hashes;
+  size_t num_inputs = 0;
+  for (size_t length = 0; length <= 200; ++length) {
+    std::string input(length, '\0');
+    for (size_t i = 0; i < length; ++i)
+      input[i] = static_cast<char>(i * 131 + length);
+    hashes.insert(Hash64(input));
+    ++num_inputs;
+    for (size_t bit = 0; bit < length * 8; ++bit) {
+      std::string flipped = input;
+      flipped[bit / 8] ^= 1 << (bit % 8);
+      hashes.insert(Hash64(flipped));
+      ++num_inputs;
+    }
+  }
+  EXPECT_EQ(num_inputs, hashes.size());
+}
+
+TEST(HashTest, IncrementalHash64) {
+  std::string input;
+  for (size_t i = 0; i < 300; ++i)
+    input.push_back(static_cast<char>(i * 131));
+
+  for (size_t length = 0; length <= input.size(); ++length) {
+    const uint64_t expected = Hash64(input.data(), length, 42);
+    for (size_t split = 0; split <= length; ++split) {
+      IncrementalHash64 hash(42);
+      hash.Update(input.data(), split);
+      hash.Update(input.data() + split, length - split);
+      ASSERT_EQ(expected, hash.Finish())
+          << "length " << length << ", split at " << split;
+    }
+
+    // One byte at a time, checking the hash of each prefix on the way.
+    IncrementalHash64 hash(42);
+    for (size_t i = 0; i < length; ++i) {
+      hash.Update(input.data() + i, 1);
+      ASSERT_EQ(Hash64(input.data(), i + 1, 42), hash.Finish());
+    }
+  }
+}
+
 }  // namespace base
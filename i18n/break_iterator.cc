@@ -6,7 +6,13 @@
 
 #include <stdint.h>
 
+#include <map>
+#include <string>
+#include <utility>
+
 #include "base/logging.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
 #include "third_party/icu/source/common/unicode/ubrk.h"
 #include "third_party/icu/source/common/unicode/uchar.h"
 #include "third_party/icu/source/common/unicode/ustring.h"
@@ -16,6 +22,48 @@ namespace i18n {
 
 const size_t npos = static_cast<size_t>(-1);
 
+namespace {
+
+// Iterators of each type and locale, with no text, which Init() clones.
+// Opening an iterator loads and builds its rules, when cloning one copies
+// them. The prototypes are only cloned, with |lock_| held, so they are never
+// changed.
+class PrototypeIterators {
+ public:
+  PrototypeIterators() = default;
+
+  // Returns a new iterator of |type| for the default locale, with no text, or
+  // null on failure.
+  UBreakIterator* Clone(UBreakIteratorType type, UErrorCode* status) {
+    const char* locale = uloc_getDefault();
+    AutoLock lock(lock_);
+    UBreakIterator*& prototype = prototypes_[std::make_pair(type, locale)];
+    if (!prototype) {
+      prototype = ubrk_open(type, locale, nullptr, 0, status);
+      if (U_FAILURE(*status)) {
+        prototype = nullptr;
+        return nullptr;
+      }
+    }
+    UBreakIterator* iter = ubrk_safeClone(prototype, nullptr, nullptr, status);
+    return U_FAILURE(*status) ? nullptr : iter;
+  }
+
+ private:
+  Lock lock_;
+  std::map<std::pair<UBreakIteratorType, std::string>, UBreakIterator*>
+      prototypes_;
+
+  DISALLOW_COPY_AND_ASSIGN(PrototypeIterators);
+};
+
+PrototypeIterators& GetPrototypeIterators() {
+  static NoDestructor<PrototypeIterators> prototype_iterators;
+  return *prototype_iterators;
+}
+
+}  // namespace
+
 BreakIterator::BreakIterator(const StringPiece16& str, BreakType break_type)
     : iter_(nullptr),
       string_(str),
@@ -68,8 +116,11 @@ bool BreakIterator::Init() {
           << parse_error.line << ", offset " << parse_error.offset;
     }
   } else {
-    iter_ = ubrk_open(break_type, nullptr, string_.data(),
-                      static_cast<int32_t>(string_.size()), &status);
+    iter_ = GetPrototypeIterators().Clone(break_type, &status);
+    if (U_SUCCESS(status)) {
+      ubrk_setText(static_cast<UBreakIterator*>(iter_), string_.data(),
+                   static_cast<int32_t>(string_.size()), &status);
+    }
     if (U_FAILURE(status)) {
       NOTREACHED() << "ubrk_open failed for type " << break_type
           << " with error " << status;
@@ -134,6 +185,22 @@ bool BreakIterator::SetText(const base::char16* text, const size_t length) {
   return true;
 }
 
+void BreakIterator::GetWords(std::vector<StringPiece16>* words) {
+  DCHECK(break_type_ == BREAK_WORD || break_type_ == RULE_BASED);
+  words->clear();
+  if (pos_ == npos)
+    return;
+  UBreakIterator* iter = static_cast<UBreakIterator*>(iter_);
+  for (int32_t pos = ubrk_next(iter); pos != UBRK_DONE; pos = ubrk_next(iter)) {
+    prev_ = pos_;
+    pos_ = static_cast<size_t>(pos);
+    if (ubrk_getRuleStatus(iter) != UBRK_WORD_NONE)
+      words->push_back(string_.substr(prev_, pos_ - prev_));
+  }
+  prev_ = pos_;
+  pos_ = npos;
+}
+
 bool BreakIterator::IsWord() const {
   return GetWordBreakStatus() == IS_WORD_BREAK;
 }
@@ -7,6 +7,8 @@
 
 #include <stddef.h>
 
+#include <vector>
+
 #include "base/i18n/base_i18n_export.h"
 #include "base/macros.h"
 #include "base/strings/string16.h"
@@ -54,6 +56,15 @@
 //       VLOG(1) << "word: " << iter.GetString();
 //     }
 //   }
+//
+// or, with GetWords():
+//   std::vector<StringPiece16> words;
+//   iter.GetWords(&words);
+//
+// To break many strings, reuse an iterator with SetText() rather than create
+// one for each string. Creating an iterator is cheaper after the first one of
+// its type and locale though: Init() clones a prototype iterator, rather than
+// load the break rules again.
 
 namespace base {
 namespace i18n {
@@ -110,6 +121,12 @@ class BASE_I18N_EXPORT BreakIterator {
   // unless there is an error setting the text.
   bool SetText(const base::char16* text, const size_t length);
 
+  // Under BREAK_WORD or RULE_BASED mode, advances to the end of the string,
+  // replacing the contents of |words| with the words found on the way, i.e.
+  // the strings between prev() and pos() for which IsWord() would be true.
+  // The pieces point into the string of the iterator.
+  void GetWords(std::vector<StringPiece16>* words);
+
   // Under BREAK_WORD mode, returns true if the break we just hit is the
   // end of a word. (Otherwise, the break iterator just skipped over e.g.
   // whitespace or punctuation.)  Under BREAK_LINE and BREAK_NEWLINE modes,
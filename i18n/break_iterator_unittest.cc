@@ -6,6 +6,8 @@
 
 #include <stddef.h>
 
+#include <vector>
+
 #include "base/macros.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/stringprintf.h"
@@ -457,5 +459,65 @@ TEST(BreakIteratorTest, GetWordBreakStatusBreakWord) {
   EXPECT_FALSE(iter.Advance());
 }
 
+TEST(BreakIteratorTest, GetWords) {
+  const string16 str(UTF8ToUTF16(" foo, bar baz!\n\xe4\xbd\xa0\xe5\xa5\xbd"));
+  BreakIterator iter(str, BreakIterator::BREAK_WORD);
+  ASSERT_TRUE(iter.Init());
+
+  // Stops at the same words as Advance().
+  std::vector<StringPiece16> expected_words;
+  while (iter.Advance()) {
+    if (iter.IsWord())
+      expected_words.push_back(iter.GetStringPiece());
+  }
+  ASSERT_LE(4U, expected_words.size());
+  EXPECT_EQ(ASCIIToUTF16("foo"), expected_words[0]);
+  EXPECT_EQ(ASCIIToUTF16("baz"), expected_words[2]);
+
+  std::vector<StringPiece16> words(1);
+  ASSERT_TRUE(iter.SetText(str.data(), str.size()));
+  iter.GetWords(&words);
+  EXPECT_EQ(expected_words, words);
+  EXPECT_FALSE(iter.Advance());
+
+  // Resumes from the current position.
+  ASSERT_TRUE(iter.SetText(str.data(), str.size()));
+  ASSERT_TRUE(iter.Advance());
+  ASSERT_TRUE(iter.Advance());
+  iter.GetWords(&words);
+  EXPECT_EQ(std::vector<StringPiece16>(expected_words.begin() + 1,
+                                       expected_words.end()),
+            words);
+
+  ASSERT_TRUE(iter.SetText(nullptr, 0));
+  iter.GetWords(&words);
+  EXPECT_TRUE(words.empty());
+}
+
+TEST(BreakIteratorTest, IteratorsOfTheSameTypeAreIndependent) {
+  // The second iterators are cloned from the prototype of the first.
+  const string16 str1(ASCIIToUTF16("foo bar"));
+  const string16 str2(ASCIIToUTF16("a b c"));
+  for (BreakIterator::BreakType type :
+       {BreakIterator::BREAK_WORD, BreakIterator::BREAK_LINE}) {
+    BreakIterator iter1(str1, type);
+    ASSERT_TRUE(iter1.Init());
+    ASSERT_TRUE(iter1.Advance());
+    BreakIterator iter2(str2, type);
+    ASSERT_TRUE(iter2.Init());
+    ASSERT_TRUE(iter2.Advance());
+    EXPECT_EQ(type == BreakIterator::BREAK_WORD ? ASCIIToUTF16("foo")
+                                                : ASCIIToUTF16("foo "),
+              iter1.GetString());
+    EXPECT_EQ(type == BreakIterator::BREAK_WORD ? ASCIIToUTF16("a")
+                                                : ASCIIToUTF16("a "),
+              iter2.GetString());
+    ASSERT_TRUE(iter1.Advance());
+    EXPECT_EQ(type == BreakIterator::BREAK_WORD ? ASCIIToUTF16(" ")
+                                                : ASCIIToUTF16("bar"),
+              iter1.GetString());
+  }
+}
+
 }  // namespace i18n
 }  // namespace base
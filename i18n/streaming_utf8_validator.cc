@@ -8,6 +8,8 @@
 
 #include "base/i18n/streaming_utf8_validator.h"
 
+#include <string.h>
+
 #include "base/i18n/utf8_validator_tables.h"
 #include "base/logging.h"
 
@@ -19,6 +21,61 @@ uint8_t StateTableLookup(uint8_t offset) {
   return internal::kUtf8ValidatorTables[offset];
 }
 
+// Returns a pointer to the first non-ASCII byte in [p, end), or |end|. Checks
+// 8 bytes at a time.
+const char* SkipASCII(const char* p, const char* end) {
+  while (end - p >= 8) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    if (word & UINT64_C(0x8080808080808080))
+      break;
+    p += 8;
+  }
+  while (p != end && (*p & 0x80) == 0)
+    ++p;
+  return p;
+}
+
+bool InRange(char c, uint8_t min, uint8_t max) {
+  return static_cast<uint8_t>(c) >= min && static_cast<uint8_t>(c) <= max;
+}
+
+// Returns the length of the multi-byte sequence starting at |p|, or 0 if it
+// is invalid or goes past |end|. This is the range check version of the state
+// tables, which accepts the same sequences.
+size_t GetSequenceLength(const char* p, const char* end) {
+  const uint8_t lead = static_cast<uint8_t>(*p);
+  const ptrdiff_t available = end - p;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    if (available < 2 || !InRange(p[1], 0x80, 0xBF))
+      return 0;
+    return 2;
+  }
+  if (lead >= 0xE0 && lead <= 0xEF) {
+    if (available < 3)
+      return 0;
+    // No overlong encodings, and no surrogates.
+    const uint8_t min = lead == 0xE0 ? 0xA0 : 0x80;
+    const uint8_t max = lead == 0xED ? 0x9F : 0xBF;
+    if (!InRange(p[1], min, max) || !InRange(p[2], 0x80, 0xBF))
+      return 0;
+    return 3;
+  }
+  if (lead >= 0xF0 && lead <= 0xF4) {
+    if (available < 4)
+      return 0;
+    // No overlong encodings, and nothing above U+10FFFF.
+    const uint8_t min = lead == 0xF0 ? 0x90 : 0x80;
+    const uint8_t max = lead == 0xF4 ? 0x8F : 0xBF;
+    if (!InRange(p[1], min, max) || !InRange(p[2], 0x80, 0xBF) ||
+        !InRange(p[3], 0x80, 0xBF)) {
+      return 0;
+    }
+    return 4;
+  }
+  return 0;
+}
+
 }  // namespace
 
 StreamingUtf8Validator::State StreamingUtf8Validator::AddBytes(const char* data,
@@ -26,7 +83,27 @@ StreamingUtf8Validator::State StreamingUtf8Validator::AddBytes(const char* data,
   // Copy |state_| into a local variable so that the compiler doesn't have to be
   // careful of aliasing.
   uint8_t state = state_;
-  for (const char* p = data; p != data + size; ++p) {
+  const char* const end = data + size;
+  const char* p = data;
+
+  // Between characters, skip runs of ASCII and check complete sequences
+  // directly. The state tables take over for the sequences that are invalid
+  // or cut off by the end of |data|, and for those started by a previous
+  // call.
+  if (state == 0) {
+    while (p != end) {
+      if ((*p & 0x80) == 0) {
+        p = SkipASCII(p, end);
+        continue;
+      }
+      size_t length = GetSequenceLength(p, end);
+      if (!length)
+        break;
+      p += length;
+    }
+  }
+
+  for (; p != end; ++p) {
     if ((*p & 0x80) == 0) {
       if (state == 0)
         continue;
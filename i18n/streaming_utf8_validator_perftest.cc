@@ -21,7 +21,9 @@
 #include "base/macros.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
+#include "base/test/perf_log.h"
 #include "base/test/perf_time_logger.h"
+#include "base/timer/elapsed_timer.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -89,11 +91,19 @@ bool RunTest(const std::string& description,
              const std::string& test_string,
              int times) {
   base::PerfTimeLogger timer(description.c_str());
+  base::ElapsedTimer elapsed_timer;
   bool result = true;
   for (int i = 0; i < times; ++i) {
     result = target(test_string) && result;
   }
   timer.Done();
+  const double seconds = elapsed_timer.Elapsed().InSecondsF();
+  if (seconds > 0) {
+    base::LogPerfResult(
+        (description + " throughput").c_str(),
+        static_cast<double>(test_string.length()) * times / seconds / 1e9,
+        "GB/s");
+  }
   return result;
 }
 
@@ -408,5 +408,58 @@ TEST(StreamingUtf8ValidatorValidateTest, TruncatedIsInvalid) {
   EXPECT_FALSE(StreamingUtf8Validator::Validate("\xc2"));
 }
 
+// Whole sequences are checked with ranges rather than the state tables, which
+// only see the input byte by byte. Checks that they agree on every lead and
+// second byte, and on the boundaries of the ranges for the other bytes.
+TEST(StreamingUtf8ValidatorTest, RangeChecksMatchStateTables) {
+  static const uint8_t kTrailBytes[] = {0x00, 0x41, 0x7F, 0x80, 0x8F,
+                                        0x90, 0x9F, 0xA0, 0xBF, 0xC0};
+  for (int lead = 0; lead < 0x100; ++lead) {
+    for (int second = 0; second < 0x100; ++second) {
+      for (uint8_t third : kTrailBytes) {
+        for (uint8_t fourth : kTrailBytes) {
+          const char sequence[] = {'a',
+                                   static_cast<char>(lead),
+                                   static_cast<char>(second),
+                                   static_cast<char>(third),
+                                   static_cast<char>(fourth),
+                                   'z'};
+          StreamingUtf8Validator byte_by_byte;
+          StreamingUtf8Validator::State expected = VALID_ENDPOINT;
+          for (char c : sequence)
+            expected = byte_by_byte.AddBytes(&c, 1);
+          ASSERT_EQ(expected, StreamingUtf8Validator().AddBytes(
+                                  sequence, sizeof(sequence)))
+              << lead << " " << second << " " << third << " " << fourth;
+        }
+      }
+    }
+  }
+}
+
+TEST(StreamingUtf8ValidatorTest, SplitAnywhere) {
+  // ASCII runs longer than a word, and sequences of every length.
+  const std::string text =
+      "Some ASCII text\xc2\xa0then \xe3\x81\x82, \xf0\xa0\x80\x8b and more "
+      "ASCII text at the end";
+  ASSERT_TRUE(StreamingUtf8Validator::Validate(text));
+  for (size_t i = 0; i <= text.size(); ++i) {
+    StreamingUtf8Validator validator;
+    validator.AddBytes(text.data(), i);
+    EXPECT_EQ(VALID_ENDPOINT,
+              validator.AddBytes(text.data() + i, text.size() - i))
+        << "Split at " << i;
+  }
+
+  const std::string invalid = text + "\xed\xa0\x80" + text;
+  for (size_t i = 0; i <= invalid.size(); ++i) {
+    StreamingUtf8Validator validator;
+    validator.AddBytes(invalid.data(), i);
+    EXPECT_EQ(INVALID,
+              validator.AddBytes(invalid.data() + i, invalid.size() - i))
+        << "Split at " << i;
+  }
+}
+
 }  // namespace
 }  // namespace base
@@ -4,13 +4,55 @@
 
 #include "base/i18n/string_compare.h"
 
+#include <map>
+#include <memory>
+
 #include "base/logging.h"
+#include "base/macros.h"
+#include "base/no_destructor.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/synchronization/lock.h"
+#include "third_party/icu/source/common/unicode/locid.h"
 #include "third_party/icu/source/common/unicode/unistr.h"
 
 namespace base {
 namespace i18n {
 
+namespace {
+
+// The collators of the locales used so far. Comparing with a collator doesn't
+// change it, so they are shared by all the threads.
+class CollatorCache {
+ public:
+  CollatorCache() = default;
+
+  // Returns the collator of the default locale, or null if ICU has no data
+  // for it.
+  const icu::Collator* Get() {
+    const icu::Locale& locale = icu::Locale::getDefault();
+    AutoLock lock(lock_);
+    auto it = collators_.find(locale.getName());
+    if (it == collators_.end()) {
+      UErrorCode error = U_ZERO_ERROR;
+      std::unique_ptr<icu::Collator> collator(
+          icu::Collator::createInstance(locale, error));
+      if (!U_SUCCESS(error))
+        collator.reset();
+      it = collators_.emplace(locale.getName(), std::move(collator)).first;
+    }
+    return it->second.get();
+  }
+
+ private:
+  Lock lock_;
+  // Never erased, so the collators outlive the comparisons using them.
+  std::map<std::string, std::unique_ptr<icu::Collator>> collators_;
+
+  DISALLOW_COPY_AND_ASSIGN(CollatorCache);
+};
+
+}  // namespace
+
 // Compares the character data stored in two different string16 strings by
 // specified Collator instance.
 UCollationResult CompareString16WithCollator(const icu::Collator& collator,
@@ -25,5 +67,18 @@ UCollationResult CompareString16WithCollator(const icu::Collator& collator,
   return result;
 }
 
+UCollationResult CompareString16WithDefaultCollator(const string16& lhs,
+                                                    const string16& rhs) {
+  static NoDestructor<CollatorCache> collator_cache;
+  const icu::Collator* collator = collator_cache->Get();
+  if (collator)
+    return CompareString16WithCollator(*collator, lhs, rhs);
+  // Without collation data, fall back to comparing the code units.
+  const int result = lhs.compare(rhs);
+  if (result == 0)
+    return UCOL_EQUAL;
+  return result < 0 ? UCOL_LESS : UCOL_GREATER;
+}
+
 }  // namespace i18n
 }  // namespace base
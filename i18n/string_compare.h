@@ -22,6 +22,13 @@ CompareString16WithCollator(const icu::Collator& collator,
                             const string16& lhs,
                             const string16& rhs);
 
+// Compares the two strings with the collator of the default locale, at the
+// default strength. The collators are created once for each locale and shared
+// by all the threads, so this is much faster than creating a collator for a
+// few comparisons.
+BASE_I18N_EXPORT UCollationResult
+CompareString16WithDefaultCollator(const string16& lhs, const string16& rhs);
+
 }  // namespace i18n
 }  // namespace base
 
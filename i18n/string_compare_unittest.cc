@@ -0,0 +1,40 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/i18n/string_compare.h"
+
+#include <string>
+
+#include "base/i18n/rtl.h"
+#include "base/strings/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace i18n {
+
+TEST(StringCompareTest, DefaultCollator) {
+  std::string default_locale(uloc_getDefault());
+  SetICUDefaultLocale("en_US");
+  EXPECT_EQ(UCOL_EQUAL, CompareString16WithDefaultCollator(
+                            ASCIIToUTF16("abc"), ASCIIToUTF16("abc")));
+  // Unlike code units, collation orders the letters regardless of case.
+  EXPECT_EQ(UCOL_LESS, CompareString16WithDefaultCollator(
+                           ASCIIToUTF16("apple"), ASCIIToUTF16("Banana")));
+  EXPECT_EQ(UCOL_GREATER, CompareString16WithDefaultCollator(
+                              WideToUTF16(L"\u00e9t\u00e9"),
+                              ASCIIToUTF16("ete")));
+
+  // Swedish sorts a with umlaut after z, unlike English.
+  const string16 a_umlaut = WideToUTF16(L"\u00e4");
+  EXPECT_EQ(UCOL_LESS,
+            CompareString16WithDefaultCollator(a_umlaut, ASCIIToUTF16("z")));
+  SetICUDefaultLocale("sv");
+  EXPECT_EQ(UCOL_GREATER,
+            CompareString16WithDefaultCollator(a_umlaut, ASCIIToUTF16("z")));
+
+  SetICUDefaultLocale(default_locale);
+}
+
+}  // namespace i18n
+}  // namespace base
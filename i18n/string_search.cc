@@ -4,49 +4,123 @@
 
 #include <stdint.h>
 
+#include <map>
+
 #include "base/i18n/string_search.h"
 #include "base/logging.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
 
 #include "third_party/icu/source/i18n/unicode/usearch.h"
 
 namespace base {
 namespace i18n {
 
-FixedPatternStringSearchIgnoringCaseAndAccents::
-FixedPatternStringSearchIgnoringCaseAndAccents(const string16& find_this)
-    : find_this_(find_this) {
-  // usearch_open requires a valid string argument to be searched, even if we
-  // want to set it by usearch_setText afterwards. So, supplying a dummy text.
-  const string16& dummy = find_this_;
+namespace {
 
-  UErrorCode status = U_ZERO_ERROR;
-  search_ = usearch_open(find_this_.data(), find_this_.size(), dummy.data(),
-                         dummy.size(), uloc_getDefault(),
-                         nullptr,  // breakiter
-                         &status);
-  if (U_SUCCESS(status)) {
-    UCollator* collator = usearch_getCollator(search_);
-    ucol_setStrength(collator, UCOL_PRIMARY);
-    usearch_reset(search_);
+// The most idle searchers kept for a locale, about the number of threads
+// searching at the same time.
+constexpr size_t kMaxIdleSearchersPerLocale = 8;
+
+// usearch_open() requires a non-empty pattern and text, even if they are set
+// afterwards. The idle searchers also point to this text, rather than to a
+// string which may be gone.
+const UChar kDummyText[] = {' '};
+
+// The searchers which aren't in use, with a primary strength collator for
+// their locale. Opening a collator loads and parses the rules of its locale,
+// which takes much longer than a search.
+class SearcherPool {
+ public:
+  SearcherPool() = default;
+
+  // Returns a searcher for |pattern| with the collator of |locale|, or null if
+  // ICU fails, e.g. because |pattern| is empty.
+  UStringSearch* Acquire(const std::string& locale, const string16& pattern) {
+    if (pattern.empty())
+      return nullptr;
+
+    UStringSearch* search = nullptr;
+    {
+      AutoLock lock(lock_);
+      auto it = idle_searchers_.find(locale);
+      if (it != idle_searchers_.end() && !it->second.empty()) {
+        search = it->second.back();
+        it->second.pop_back();
+      }
+    }
+
+    UErrorCode status = U_ZERO_ERROR;
+    if (!search) {
+      search = usearch_open(kDummyText, arraysize(kDummyText), kDummyText,
+                            arraysize(kDummyText), locale.c_str(),
+                            nullptr,  // breakiter
+                            &status);
+      if (!U_SUCCESS(status))
+        return nullptr;
+      ucol_setStrength(usearch_getCollator(search), UCOL_PRIMARY);
+    }
+
+    usearch_setPattern(search, pattern.data(), pattern.size(), &status);
+    if (!U_SUCCESS(status)) {
+      usearch_close(search);
+      return nullptr;
+    }
+    return search;
   }
+
+  // Takes back |search|, acquired for |locale|.
+  void Release(const std::string& locale, UStringSearch* search) {
+    UErrorCode status = U_ZERO_ERROR;
+    usearch_setText(search, kDummyText, arraysize(kDummyText), &status);
+    if (U_SUCCESS(status)) {
+      AutoLock lock(lock_);
+      std::vector<UStringSearch*>& idle_searchers = idle_searchers_[locale];
+      if (idle_searchers.size() < kMaxIdleSearchersPerLocale) {
+        idle_searchers.push_back(search);
+        return;
+      }
+    }
+    usearch_close(search);
+  }
+
+ private:
+  Lock lock_;
+  std::map<std::string, std::vector<UStringSearch*>> idle_searchers_;
+
+  DISALLOW_COPY_AND_ASSIGN(SearcherPool);
+};
+
+SearcherPool& GetSearcherPool() {
+  static NoDestructor<SearcherPool> pool;
+  return *pool;
 }
 
+}  // namespace
+
+FixedPatternStringSearchIgnoringCaseAndAccents::
+FixedPatternStringSearchIgnoringCaseAndAccents(const string16& find_this)
+    : find_this_(find_this),
+      locale_(uloc_getDefault()),
+      search_(GetSearcherPool().Acquire(locale_, find_this_)) {}
+
 FixedPatternStringSearchIgnoringCaseAndAccents::
 ~FixedPatternStringSearchIgnoringCaseAndAccents() {
   if (search_)
-    usearch_close(search_);
+    GetSearcherPool().Release(locale_, search_);
 }
 
 bool FixedPatternStringSearchIgnoringCaseAndAccents::Search(
     const string16& in_this, size_t* match_index, size_t* match_length) {
   UErrorCode status = U_ZERO_ERROR;
-  usearch_setText(search_, in_this.data(), in_this.size(), &status);
+  if (search_)
+    usearch_setText(search_, in_this.data(), in_this.size(), &status);
 
   // Default to basic substring search if usearch fails. According to
   // http://icu-project.org/apiref/icu4c/usearch_8h.html, usearch_open will fail
   // if either |find_this| or |in_this| are empty. In either case basic
   // substring search will give the correct return value.
-  if (!U_SUCCESS(status)) {
+  if (!search_ || !U_SUCCESS(status)) {
     size_t index = in_this.find(find_this_);
     if (index == string16::npos) {
       return false;
@@ -77,5 +151,17 @@ bool StringSearchIgnoringCaseAndAccents(const string16& find_this,
       in_this, match_index, match_length);
 }
 
+std::vector<size_t> FindStringsIgnoringCaseAndAccents(
+    const string16& find_this,
+    const std::vector<string16>& in_these) {
+  FixedPatternStringSearchIgnoringCaseAndAccents search(find_this);
+  std::vector<size_t> matches;
+  for (size_t i = 0; i < in_these.size(); ++i) {
+    if (search.Search(in_these[i], nullptr, nullptr))
+      matches.push_back(i);
+  }
+  return matches;
+}
+
 }  // namespace i18n
 }  // namespace base
@@ -7,7 +7,11 @@
 
 #include <stddef.h>
 
+#include <string>
+#include <vector>
+
 #include "base/i18n/base_i18n_export.h"
+#include "base/macros.h"
 #include "base/strings/string16.h"
 
 struct UStringSearch;
@@ -22,15 +26,27 @@ namespace i18n {
 // Only differences between base letters are taken into consideration. Case and
 // accent differences are ignored. Please refer to 'primary level' in
 // http://userguide.icu-project.org/collation/concepts for additional details.
+//
+// The ICU searchers, with their collator for the default locale, are pooled
+// and reused by all the threads, so a call only computes the pattern.
 BASE_I18N_EXPORT
     bool StringSearchIgnoringCaseAndAccents(const string16& find_this,
                                             const string16& in_this,
                                             size_t* match_index,
                                             size_t* match_length);
 
+// Returns the indices of the strings of |in_these| which contain |find_this|,
+// in increasing order, like StringSearchIgnoringCaseAndAccents() but with the
+// pattern computed once.
+BASE_I18N_EXPORT std::vector<size_t> FindStringsIgnoringCaseAndAccents(
+    const string16& find_this,
+    const std::vector<string16>& in_these);
+
 // This class is for speeding up multiple StringSearchIgnoringCaseAndAccents()
 // with the same |find_this| argument. |find_this| is passed as the constructor
-// argument, and precomputation for searching is done only at that timing.
+// argument, and precomputation for searching is done only at that timing. The
+// ICU searcher is taken from the pool on construction, and returned to it on
+// destruction.
 class BASE_I18N_EXPORT FixedPatternStringSearchIgnoringCaseAndAccents {
  public:
   explicit FixedPatternStringSearchIgnoringCaseAndAccents(
@@ -46,7 +62,12 @@ class BASE_I18N_EXPORT FixedPatternStringSearchIgnoringCaseAndAccents {
 
  private:
   string16 find_this_;
+  // The default locale when |search_| was acquired, its key in the pool.
+  std::string locale_;
+  // Null if the pattern couldn't be set, e.g. because it's empty.
   UStringSearch* search_;
+
+  DISALLOW_COPY_AND_ASSIGN(FixedPatternStringSearchIgnoringCaseAndAccents);
 };
 
 }  // namespace i18n
@@ -5,6 +5,7 @@
 #include <stddef.h>
 
 #include <string>
+#include <vector>
 
 #include "base/i18n/rtl.h"
 #include "base/i18n/string_search.h"
@@ -224,5 +225,54 @@ TEST(StringSearchTest, FixedPatternMultipleSearch) {
     SetICUDefaultLocale(default_locale.data());
 }
 
+TEST(StringSearchTest, ConcurrentFixedPatterns) {
+  std::string default_locale(uloc_getDefault());
+  bool locale_is_posix = (default_locale == "en_US_POSIX");
+  if (locale_is_posix)
+    SetICUDefaultLocale("en_US");
+
+  // Each query holds its own searcher from the pool, and the searchers which
+  // are returned to it are reused with another pattern.
+  for (int i = 0; i < 2; ++i) {
+    FixedPatternStringSearchIgnoringCaseAndAccents hello(ASCIIToUTF16("hello"));
+    FixedPatternStringSearchIgnoringCaseAndAccents world(ASCIIToUTF16("world"));
+    FixedPatternStringSearchIgnoringCaseAndAccents empty((string16()));
+    const string16 text = ASCIIToUTF16("Hello World");
+    size_t index = 0;
+    EXPECT_TRUE(hello.Search(text, &index, nullptr));
+    EXPECT_EQ(0U, index);
+    EXPECT_TRUE(world.Search(text, &index, nullptr));
+    EXPECT_EQ(6U, index);
+    EXPECT_TRUE(empty.Search(text, &index, nullptr));
+    EXPECT_EQ(0U, index);
+    EXPECT_FALSE(hello.Search(ASCIIToUTF16("help"), nullptr, nullptr));
+  }
+
+  if (locale_is_posix)
+    SetICUDefaultLocale(default_locale.data());
+}
+
+TEST(StringSearchTest, FindStrings) {
+  std::string default_locale(uloc_getDefault());
+  bool locale_is_posix = (default_locale == "en_US_POSIX");
+  if (locale_is_posix)
+    SetICUDefaultLocale("en_US");
+
+  const std::vector<string16> texts = {
+      ASCIIToUTF16("Chromium"), string16(), WideToUTF16(L"chr\u00f4me"),
+      ASCIIToUTF16("Firefox"), ASCIIToUTF16("CHROME OS")};
+  EXPECT_EQ(std::vector<size_t>({0, 2, 4}),
+            FindStringsIgnoringCaseAndAccents(ASCIIToUTF16("chr"), texts));
+  EXPECT_EQ(std::vector<size_t>({2, 4}),
+            FindStringsIgnoringCaseAndAccents(ASCIIToUTF16("chrome"), texts));
+  EXPECT_EQ(std::vector<size_t>(),
+            FindStringsIgnoringCaseAndAccents(ASCIIToUTF16("safari"), texts));
+  EXPECT_EQ(std::vector<size_t>({0, 1, 2, 3, 4}),
+            FindStringsIgnoringCaseAndAccents(string16(), texts));
+
+  if (locale_is_posix)
+    SetICUDefaultLocale(default_locale.data());
+}
+
 }  // namespace i18n
 }  // namespace base
@@ -4,7 +4,11 @@
 
 #include "base/json/json_parser.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <utility>
 #include <vector>
 
@@ -51,6 +55,92 @@ class StackMarker {
 
 constexpr uint32_t kUnicodeReplacementPoint = 0xFFFD;
 
+// The scanning functions below process the input a word at a time.
+using ScanWord = uint64_t;
+constexpr ScanWord kScanWordLowBits = 0x0101010101010101ULL;
+constexpr ScanWord kScanWordHighBits = 0x8080808080808080ULL;
+
+inline ScanWord LoadScanWord(const char* pos) {
+  ScanWord word;
+  memcpy(&word, pos, sizeof(word));
+  return word;
+}
+
+// Returns whether any byte of |word| is |c|.
+inline bool ScanWordHasByte(ScanWord word, char c) {
+  ScanWord matches = word ^ (kScanWordLowBits * static_cast<uint8_t>(c));
+  return ((matches - kScanWordLowBits) & ~matches & kScanWordHighBits) != 0;
+}
+
+// Returns the number of characters at the start of [|begin|, |end|) which a
+// string can contain as is: ASCII characters other than '"' and '\\'.
+size_t CountPlainStringChars(const char* begin, const char* end) {
+  const char* pos = begin;
+  while (static_cast<size_t>(end - pos) >= sizeof(ScanWord)) {
+    ScanWord word = LoadScanWord(pos);
+    if ((word & kScanWordHighBits) || ScanWordHasByte(word, '"') ||
+        ScanWordHasByte(word, '\\')) {
+      break;
+    }
+    pos += sizeof(ScanWord);
+  }
+  while (pos != end && static_cast<uint8_t>(*pos) < kExtendedASCIIStart &&
+         *pos != '"' && *pos != '\\') {
+    ++pos;
+  }
+  return pos - begin;
+}
+
+// Returns the number of characters at the start of [|begin|, |end|) which
+// are neither '"' nor '\\', i.e. which a skipped string can contain as is.
+size_t CountUnquotedChars(const char* begin, const char* end) {
+  const char* pos = begin;
+  while (static_cast<size_t>(end - pos) >= sizeof(ScanWord)) {
+    ScanWord word = LoadScanWord(pos);
+    if (ScanWordHasByte(word, '"') || ScanWordHasByte(word, '\\'))
+      break;
+    pos += sizeof(ScanWord);
+  }
+  while (pos != end && *pos != '"' && *pos != '\\')
+    ++pos;
+  return pos - begin;
+}
+
+// Decodes the escape sequences of a JSON Pointer |reference| token: "~1"
+// stands for '/' and "~0" for '~'. Returns false if |reference| has an
+// invalid escape sequence.
+bool DecodeJSONPointerReference(StringPiece reference, std::string* out) {
+  out->clear();
+  for (size_t i = 0; i < reference.size(); ++i) {
+    if (reference[i] != '~') {
+      out->push_back(reference[i]);
+      continue;
+    }
+    if (++i == reference.size())
+      return false;
+    if (reference[i] == '0')
+      out->push_back('~');
+    else if (reference[i] == '1')
+      out->push_back('/');
+    else
+      return false;
+  }
+  return true;
+}
+
+// Returns the number of spaces and tabs at the start of [|begin|, |end|).
+size_t CountSpacesAndTabs(const char* begin, const char* end) {
+  const char* pos = begin;
+  // Indentation is made of spaces by far most of the time.
+  while (static_cast<size_t>(end - pos) >= sizeof(ScanWord) &&
+         LoadScanWord(pos) == kScanWordLowBits * ' ') {
+    pos += sizeof(ScanWord);
+  }
+  while (pos != end && (*pos == ' ' || *pos == '\t'))
+    ++pos;
+  return pos - begin;
+}
+
 }  // namespace
 
 // This is U+FFFD.
@@ -72,26 +162,8 @@ JSONParser::JSONParser(int options, int max_depth)
 JSONParser::~JSONParser() = default;
 
 Optional<Value> JSONParser::Parse(StringPiece input) {
-  input_ = input;
-  index_ = 0;
-  line_number_ = 1;
-  index_last_line_ = 0;
-
-  error_code_ = JSONReader::JSON_NO_ERROR;
-  error_line_ = 0;
-  error_column_ = 0;
-
-  // ICU and ReadUnicodeCharacter() use int32_t for lengths, so ensure
-  // that the index_ will not overflow when parsing.
-  if (!base::IsValueInRangeForNumericType<int32_t>(input.length())) {
-    ReportError(JSONReader::JSON_TOO_LARGE, 0);
+  if (!StartParsing(input))
     return nullopt;
-  }
-
-  // When the input JSON string starts with a UTF-8 Byte-Order-Mark,
-  // advance the start position to avoid the ParseNextToken function mis-
-  // treating a Unicode BOM as an invalid character and returning NULL.
-  ConsumeIfMatch("\xEF\xBB\xBF");
 
   // Parse the first and any nested tokens.
   Optional<Value> root(ParseNextToken());
@@ -107,6 +179,64 @@ Optional<Value> JSONParser::Parse(StringPiece input) {
   return root;
 }
 
+bool JSONParser::ParseWithHandler(StringPiece input,
+                                  JSONReader::Handler* handler) {
+  DCHECK(handler);
+  if (!StartParsing(input))
+    return false;
+
+  if (!EmitNextToken(handler))
+    return false;
+
+  // Make sure the input stream is at an end.
+  if (GetNextToken() != T_END_OF_INPUT) {
+    ReportError(JSONReader::JSON_UNEXPECTED_DATA_AFTER_ROOT, 1);
+    return false;
+  }
+
+  return true;
+}
+
+Optional<Value> JSONParser::ParseAtPointer(StringPiece input,
+                                           StringPiece pointer) {
+  // The empty pointer refers to the whole document.
+  if (pointer.empty())
+    return Parse(input);
+
+  if (!StartParsing(input))
+    return nullopt;
+  if (pointer[0] != '/')
+    return nullopt;
+
+  // Follow each reference token, which are separated by '/'.
+  StringPiece tokens = pointer.substr(1);
+  std::string reference;
+  for (bool last = false; !last;) {
+    const size_t end = tokens.find('/');
+    last = end == StringPiece::npos;
+    if (!DecodeJSONPointerReference(tokens.substr(0, end), &reference))
+      return nullopt;
+    if (!last)
+      tokens.remove_prefix(end + 1);
+
+    switch (GetNextToken()) {
+      case T_OBJECT_BEGIN:
+        if (!SeekDictionaryMember(reference))
+          return nullopt;
+        break;
+      case T_ARRAY_BEGIN:
+        if (!SeekListItem(reference))
+          return nullopt;
+        break;
+      default:
+        return nullopt;
+    }
+  }
+
+  // The input after the value isn't looked at.
+  return ParseNextToken();
+}
+
 JSONReader::JsonParseError JSONParser::error_code() const {
   return error_code_;
 }
@@ -152,6 +282,17 @@ void JSONParser::StringBuilder::Append(uint32_t point) {
   }
 }
 
+void JSONParser::StringBuilder::AppendASCII(StringPiece chars) {
+  DCHECK(IsStringASCII(chars));
+
+  if (!string_) {
+    DCHECK_EQ(chars.data(), pos_ + length_);
+    length_ += chars.length();
+  } else {
+    chars.AppendToString(&*string_);
+  }
+}
+
 void JSONParser::StringBuilder::Convert() {
   if (string_)
     return;
@@ -164,8 +305,42 @@ std::string JSONParser::StringBuilder::DestructiveAsString() {
   return std::string(pos_, length_);
 }
 
+StringPiece JSONParser::StringBuilder::AsStringPiece() const {
+  if (string_)
+    return *string_;
+  return StringPiece(pos_, length_);
+}
+
 // JSONParser private //////////////////////////////////////////////////////////
 
+bool JSONParser::StartParsing(StringPiece input) {
+  input_ = input;
+  index_ = 0;
+  line_number_ = 1;
+  index_last_line_ = 0;
+
+  error_code_ = JSONReader::JSON_NO_ERROR;
+  error_line_ = 0;
+  error_column_ = 0;
+
+  // Left over by a parse which failed.
+  list_items_.clear();
+  dict_members_.clear();
+
+  // ICU and ReadUnicodeCharacter() use int32_t for lengths, so ensure
+  // that the index_ will not overflow when parsing.
+  if (!base::IsValueInRangeForNumericType<int32_t>(input.length())) {
+    ReportError(JSONReader::JSON_TOO_LARGE, 0);
+    return false;
+  }
+
+  // When the input JSON string starts with a UTF-8 Byte-Order-Mark,
+  // advance the start position to avoid the ParseNextToken function mis-
+  // treating a Unicode BOM as an invalid character and returning NULL.
+  ConsumeIfMatch("\xEF\xBB\xBF");
+  return true;
+}
+
 Optional<StringPiece> JSONParser::PeekChars(int count) {
   if (static_cast<size_t>(index_) + count > input_.length())
     return nullopt;
@@ -255,10 +430,11 @@ void JSONParser::EatWhitespaceAndComments() {
         if (!(c == '\n' && index_ > 0 && input_[index_ - 1] == '\r')) {
           ++line_number_;
         }
-        FALLTHROUGH;
+        ConsumeChar();
+        break;
       case ' ':
       case '\t':
-        ConsumeChar();
+        index_ += CountSpacesAndTabs(pos(), input_.data() + input_.length());
         break;
       case '/':
         if (!EatComment())
@@ -348,7 +524,7 @@ Optional<Value> JSONParser::ConsumeDictionary() {
     return nullopt;
   }
 
-  std::vector<Value::DictStorage::value_type> dict_storage;
+  const size_t first_member = dict_members_.size();
 
   Token token = GetNextToken();
   while (token != T_OBJECT_END) {
@@ -378,8 +554,8 @@ Optional<Value> JSONParser::ConsumeDictionary() {
       return nullopt;
     }
 
-    dict_storage.emplace_back(key.DestructiveAsString(),
-                              std::make_unique<Value>(std::move(*value)));
+    dict_members_.emplace_back(key.DestructiveAsString(),
+                               std::make_unique<Value>(std::move(*value)));
 
     token = GetNextToken();
     if (token == T_LIST_SEPARATOR) {
@@ -397,6 +573,12 @@ Optional<Value> JSONParser::ConsumeDictionary() {
 
   ConsumeChar();  // Closing '}'.
 
+  std::vector<Value::DictStorage::value_type> dict_storage(
+      std::make_move_iterator(dict_members_.begin() + first_member),
+      std::make_move_iterator(dict_members_.end()));
+  dict_members_.erase(dict_members_.begin() + first_member,
+                      dict_members_.end());
+
   return Value(Value::DictStorage(std::move(dict_storage), KEEP_LAST_OF_DUPES));
 }
 
@@ -412,7 +594,7 @@ Optional<Value> JSONParser::ConsumeList() {
     return nullopt;
   }
 
-  Value::ListStorage list_storage;
+  const size_t first_item = list_items_.size();
 
   Token token = GetNextToken();
   while (token != T_ARRAY_END) {
@@ -422,7 +604,7 @@ Optional<Value> JSONParser::ConsumeList() {
       return nullopt;
     }
 
-    list_storage.push_back(std::move(*item));
+    list_items_.push_back(std::move(*item));
 
     token = GetNextToken();
     if (token == T_LIST_SEPARATOR) {
@@ -440,6 +622,11 @@ Optional<Value> JSONParser::ConsumeList() {
 
   ConsumeChar();  // Closing ']'.
 
+  Value::ListStorage list_storage(
+      std::make_move_iterator(list_items_.begin() + first_item),
+      std::make_move_iterator(list_items_.end()));
+  list_items_.erase(list_items_.begin() + first_item, list_items_.end());
+
   return Value(std::move(list_storage));
 }
 
@@ -463,6 +650,15 @@ bool JSONParser::ConsumeStringRaw(StringBuilder* out) {
   StringBuilder string(pos());
 
   while (PeekChar()) {
+    // Most characters don't need decoding, skip over them in bulk.
+    size_t plain_length =
+        CountPlainStringChars(pos(), input_.data() + input_.length());
+    if (plain_length) {
+      string.AppendASCII(StringPiece(pos(), plain_length));
+      index_ += plain_length;
+      continue;
+    }
+
     uint32_t next_char = 0;
     if (!ReadUnicodeCharacter(input_.data(),
                               static_cast<int32_t>(input_.length()),
@@ -692,7 +888,7 @@ Optional<Value> JSONParser::ConsumeNumber() {
     return Value(num_int);
 
   double num_double;
-  if (StringToDouble(num_string.as_string(), &num_double) &&
+  if (StringToDouble(num_string, &num_double) &&
       std::isfinite(num_double)) {
     return Value(num_double);
   }
@@ -737,6 +933,309 @@ Optional<Value> JSONParser::ConsumeLiteral() {
   }
 }
 
+bool JSONParser::EmitNextToken(JSONReader::Handler* handler) {
+  return EmitToken(GetNextToken(), handler);
+}
+
+bool JSONParser::EmitToken(Token token, JSONReader::Handler* handler) {
+  switch (token) {
+    case T_OBJECT_BEGIN:
+      return EmitDictionary(handler);
+    case T_ARRAY_BEGIN:
+      return EmitList(handler);
+    case T_STRING:
+      return EmitString(handler);
+    case T_NUMBER: {
+      // Numbers are stored inline in a Value, so this doesn't allocate.
+      Optional<Value> number = ConsumeNumber();
+      if (!number)
+        return false;
+      if (number->is_int())
+        return handler->Int(number->GetInt());
+      return handler->Double(number->GetDouble());
+    }
+    case T_BOOL_TRUE:
+    case T_BOOL_FALSE:
+    case T_NULL: {
+      Optional<Value> literal = ConsumeLiteral();
+      if (!literal)
+        return false;
+      if (literal->is_bool())
+        return handler->Bool(literal->GetBool());
+      return handler->Null();
+    }
+    default:
+      ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
+      return false;
+  }
+}
+
+bool JSONParser::EmitDictionary(JSONReader::Handler* handler) {
+  if (ConsumeChar() != '{') {
+    ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
+    return false;
+  }
+
+  StackMarker depth_check(max_depth_, &stack_depth_);
+  if (depth_check.IsTooDeep()) {
+    ReportError(JSONReader::JSON_TOO_MUCH_NESTING, 0);
+    return false;
+  }
+
+  if (!handler->StartObject())
+    return false;
+
+  Token token = GetNextToken();
+  while (token != T_OBJECT_END) {
+    if (token != T_STRING) {
+      ReportError(JSONReader::JSON_UNQUOTED_DICTIONARY_KEY, 1);
+      return false;
+    }
+
+    // First consume the key.
+    {
+      StringBuilder key;
+      if (!ConsumeStringRaw(&key) || !handler->Key(key.AsStringPiece()))
+        return false;
+    }
+
+    // Read the separator.
+    token = GetNextToken();
+    if (token != T_OBJECT_PAIR_SEPARATOR) {
+      ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+      return false;
+    }
+
+    // The next token is the value.
+    ConsumeChar();
+    if (!EmitNextToken(handler))
+      return false;
+
+    token = GetNextToken();
+    if (token == T_LIST_SEPARATOR) {
+      ConsumeChar();
+      token = GetNextToken();
+      if (token == T_OBJECT_END && !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
+        ReportError(JSONReader::JSON_TRAILING_COMMA, 1);
+        return false;
+      }
+    } else if (token != T_OBJECT_END) {
+      ReportError(JSONReader::JSON_SYNTAX_ERROR, 0);
+      return false;
+    }
+  }
+
+  ConsumeChar();  // Closing '}'.
+
+  return handler->EndObject();
+}
+
+bool JSONParser::EmitList(JSONReader::Handler* handler) {
+  if (ConsumeChar() != '[') {
+    ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
+    return false;
+  }
+
+  StackMarker depth_check(max_depth_, &stack_depth_);
+  if (depth_check.IsTooDeep()) {
+    ReportError(JSONReader::JSON_TOO_MUCH_NESTING, 0);
+    return false;
+  }
+
+  if (!handler->StartArray())
+    return false;
+
+  Token token = GetNextToken();
+  while (token != T_ARRAY_END) {
+    if (!EmitToken(token, handler))
+      return false;
+
+    token = GetNextToken();
+    if (token == T_LIST_SEPARATOR) {
+      ConsumeChar();
+      token = GetNextToken();
+      if (token == T_ARRAY_END && !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
+        ReportError(JSONReader::JSON_TRAILING_COMMA, 1);
+        return false;
+      }
+    } else if (token != T_ARRAY_END) {
+      ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+      return false;
+    }
+  }
+
+  ConsumeChar();  // Closing ']'.
+
+  return handler->EndArray();
+}
+
+bool JSONParser::EmitString(JSONReader::Handler* handler) {
+  StringBuilder string;
+  if (!ConsumeStringRaw(&string))
+    return false;
+
+  return handler->String(string.AsStringPiece());
+}
+
+bool JSONParser::SeekDictionaryMember(StringPiece name) {
+  ConsumeChar();  // Opening '{'.
+
+  Token token = GetNextToken();
+  while (token != T_OBJECT_END) {
+    if (token != T_STRING) {
+      ReportError(JSONReader::JSON_UNQUOTED_DICTIONARY_KEY, 1);
+      return false;
+    }
+
+    // Keys without escape sequences are compared in place.
+    StringBuilder key;
+    if (!ConsumeStringRaw(&key))
+      return false;
+
+    token = GetNextToken();
+    if (token != T_OBJECT_PAIR_SEPARATOR) {
+      ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+      return false;
+    }
+    ConsumeChar();
+
+    if (key.AsStringPiece() == name)
+      return true;
+    if (!SkipNextValue())
+      return false;
+
+    token = GetNextToken();
+    if (token == T_LIST_SEPARATOR) {
+      ConsumeChar();
+      token = GetNextToken();
+      if (token == T_OBJECT_END && !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
+        ReportError(JSONReader::JSON_TRAILING_COMMA, 1);
+        return false;
+      }
+    } else if (token != T_OBJECT_END) {
+      ReportError(JSONReader::JSON_SYNTAX_ERROR, 0);
+      return false;
+    }
+  }
+  return false;
+}
+
+bool JSONParser::SeekListItem(StringPiece reference) {
+  // Array indices have no leading zeros.
+  size_t index;
+  if (reference.empty() || (reference.size() > 1 && reference[0] == '0') ||
+      !std::all_of(reference.begin(), reference.end(), IsAsciiDigit<char>) ||
+      !StringToSizeT(reference, &index)) {
+    return false;
+  }
+
+  ConsumeChar();  // Opening '['.
+
+  Token token = GetNextToken();
+  for (size_t i = 0; token != T_ARRAY_END; ++i) {
+    if (i == index)
+      return true;
+    if (!SkipNextValue())
+      return false;
+
+    token = GetNextToken();
+    if (token == T_LIST_SEPARATOR) {
+      ConsumeChar();
+      token = GetNextToken();
+      if (token == T_ARRAY_END && !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
+        ReportError(JSONReader::JSON_TRAILING_COMMA, 1);
+        return false;
+      }
+    } else if (token != T_ARRAY_END) {
+      ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+      return false;
+    }
+  }
+  return false;
+}
+
+bool JSONParser::SkipNextValue() {
+  switch (GetNextToken()) {
+    case T_OBJECT_BEGIN:
+    case T_ARRAY_BEGIN:
+      return SkipContainer();
+    case T_STRING:
+      return SkipString();
+    case T_NUMBER:
+      // Numbers are stored inline in a Value, so this doesn't allocate.
+      return ConsumeNumber().has_value();
+    case T_BOOL_TRUE:
+    case T_BOOL_FALSE:
+    case T_NULL:
+      return ConsumeLiteral().has_value();
+    default:
+      ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
+      return false;
+  }
+}
+
+bool JSONParser::SkipContainer() {
+  // Only the brackets and strings matter, everything else is skipped a
+  // character at a time. This doesn't recurse, so it's not bound by
+  // |max_depth_|.
+  size_t depth = 0;
+  while (Optional<char> c = PeekChar()) {
+    switch (*c) {
+      case '{':
+      case '[':
+        ConsumeChar();
+        ++depth;
+        break;
+      case '}':
+      case ']':
+        ConsumeChar();
+        if (--depth == 0)
+          return true;
+        break;
+      case '"':
+        if (!SkipString())
+          return false;
+        break;
+      case '\r':
+      case '\n':
+      case ' ':
+      case '\t':
+        // Keeps track of the line number for error messages.
+        EatWhitespaceAndComments();
+        break;
+      case '/':
+        if (!EatComment()) {
+          ReportError(JSONReader::JSON_SYNTAX_ERROR, 0);
+          return false;
+        }
+        break;
+      default:
+        ConsumeChar();
+        break;
+    }
+  }
+
+  ReportError(JSONReader::JSON_SYNTAX_ERROR, 0);
+  return false;
+}
+
+bool JSONParser::SkipString() {
+  ConsumeChar();  // Opening '"'.
+
+  while (PeekChar()) {
+    index_ += CountUnquotedChars(pos(), input_.data() + input_.length());
+    Optional<char> c = ConsumeChar();
+    if (c == '"')
+      return true;
+    // Skip the escaped character, which may be '"'.
+    if (c == '\\')
+      ConsumeChar();
+  }
+
+  ReportError(JSONReader::JSON_SYNTAX_ERROR, 0);
+  return false;
+}
+
 bool JSONParser::ConsumeIfMatch(StringPiece match) {
   if (match == PeekChars(match.size())) {
     ConsumeChars(match.size());
@@ -10,6 +10,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/compiler_specific.h"
@@ -18,11 +19,10 @@
 #include "base/macros.h"
 #include "base/optional.h"
 #include "base/strings/string_piece.h"
+#include "base/values.h"
 
 namespace base {
 
-class Value;
-
 namespace internal {
 
 class JSONParserTest;
@@ -52,6 +52,17 @@ class BASE_EXPORT JSONParser {
   // convert to a FooValue at the same time.
   Optional<Value> Parse(StringPiece input);
 
+  // Parses the input string according to the set options and reports its
+  // contents to |handler| instead of building a Value. Returns false on error
+  // or if |handler| stopped the parsing. See JSONReader::ReadWithHandler().
+  bool ParseWithHandler(StringPiece input, JSONReader::Handler* handler);
+
+  // Parses only the value of the input string at |pointer|, skipping over the
+  // values before it without building them. Returns nullopt on error, or
+  // with no error set if |pointer| is malformed or matches nothing. See
+  // JSONReader::ReadAtPointer().
+  Optional<Value> ParseAtPointer(StringPiece input, StringPiece pointer);
+
   // Returns the error code.
   JSONReader::JsonParseError error_code() const;
 
@@ -105,6 +116,10 @@ class BASE_EXPORT JSONParser {
     // converted, or by appending the UTF8 bytes for the code point.
     void Append(uint32_t point);
 
+    // Appends |chars|, which must be ASCII and, unless the builder was
+    // converted, the next characters after the current ones in the input.
+    void AppendASCII(StringPiece chars);
+
     // Converts the builder from its default StringPiece to a full std::string,
     // performing a copy. Once a builder is converted, it cannot be made a
     // StringPiece again.
@@ -115,6 +130,10 @@ class BASE_EXPORT JSONParser {
     // in cases where the builder will not be needed any more.
     std::string DestructiveAsString();
 
+    // Returns a view of the string, valid until the builder is modified or
+    // destroyed.
+    StringPiece AsStringPiece() const;
+
    private:
     // The beginning of the input string.
     const char* pos_;
@@ -127,6 +146,10 @@ class BASE_EXPORT JSONParser {
     base::Optional<std::string> string_;
   };
 
+  // Resets the parser state to parse |input| and skips its Byte-Order-Mark.
+  // Returns false with error information set if |input| is too large.
+  bool StartParsing(StringPiece input);
+
   // Returns the next |count| bytes of the input stream, or nullopt if fewer
   // than |count| bytes remain.
   Optional<StringPiece> PeekChars(int count);
@@ -195,6 +218,51 @@ class BASE_EXPORT JSONParser {
   // parser is wound to the first character of any of those.
   Optional<Value> ConsumeLiteral();
 
+  // Streaming counterparts of the functions above, which report what they
+  // consume to |handler| instead of returning a Value. They return false on
+  // error, with error information set, or if |handler| returned false.
+
+  // Calls GetNextToken() and then EmitToken().
+  bool EmitNextToken(JSONReader::Handler* handler);
+
+  // Counterpart of ParseToken().
+  bool EmitToken(Token token, JSONReader::Handler* handler);
+
+  // Counterpart of ConsumeDictionary().
+  bool EmitDictionary(JSONReader::Handler* handler);
+
+  // Counterpart of ConsumeList().
+  bool EmitList(JSONReader::Handler* handler);
+
+  // Counterpart of ConsumeString().
+  bool EmitString(JSONReader::Handler* handler);
+
+  // Functions which move past the input without building Values, used to
+  // reach the value at a JSON Pointer. Containers are only checked for
+  // balanced nesting and terminated strings, not for full syntax. They return
+  // false with error information set on error.
+
+  // Assuming that the parser is wound to '{', moves it to the value of the
+  // first member named |name|. Returns false with no error set if there is
+  // none.
+  bool SeekDictionaryMember(StringPiece name);
+
+  // Assuming that the parser is wound to '[', moves it to the item at the
+  // index given by |reference|, a JSON Pointer array index. Returns false
+  // with no error set if there is none.
+  bool SeekListItem(StringPiece reference);
+
+  // Moves the parser past the next value.
+  bool SkipNextValue();
+
+  // Assuming that the parser is wound to '{' or '[', moves it past the
+  // matching closing bracket.
+  bool SkipContainer();
+
+  // Assuming that the parser is wound to a double quote, moves it past the
+  // closing double quote without decoding the string.
+  bool SkipString();
+
   // Helper function that returns true if the byte squence |match| can be
   // consumed at the current parser position. Returns false if there are fewer
   // than |match|-length bytes or if the sequence does not match, and the
@@ -237,6 +305,13 @@ class BASE_EXPORT JSONParser {
   int error_line_;
   int error_column_;
 
+  // The items and members of the lists and dictionaries being parsed, from
+  // the outermost to the innermost. They are moved out to a storage of the
+  // exact size when their container ends, which avoids growing each storage
+  // as it is filled. The capacity is reused across containers and parses.
+  std::vector<Value> list_items_;
+  std::vector<Value::DictStorage::value_type> dict_members_;
+
   friend class JSONParserTest;
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, NextChar);
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, ConsumeDictionary);
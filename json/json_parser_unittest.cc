@@ -456,5 +456,30 @@ TEST_F(JSONParserTest, UnterminatedInputs) {
   }
 }
 
+TEST_F(JSONParserTest, LongStringsAndWhitespace) {
+  // Exercise the word-at-a-time scanning with special characters at each
+  // position of a word.
+  for (size_t i = 0; i < 20; ++i) {
+    SCOPED_TRACE(i);
+    std::string prefix(i, 'a');
+    std::string indent(i, ' ');
+
+    std::string input = indent + "[" + indent + "\"" + prefix +
+                        "\\n\u00e9\xC3\xA9\"" + indent + "," + indent +
+                        "\"" + prefix + "\"\t" + indent + "]" + indent;
+    std::unique_ptr<char[]> input_owner;
+    std::unique_ptr<Value> value = JSONReader::Read(
+        MakeNotNullTerminatedInput(input.c_str(), &input_owner));
+    ASSERT_TRUE(value);
+    ASSERT_TRUE(value->is_list());
+    ASSERT_EQ(2u, value->GetList().size());
+    EXPECT_EQ(prefix + "\n\xC3\xA9\xC3\xA9", value->GetList()[0].GetString());
+    EXPECT_EQ(prefix, value->GetList()[1].GetString());
+
+    EXPECT_FALSE(JSONReader::Read(
+        MakeNotNullTerminatedInput(("\"" + prefix).c_str(), &input_owner)));
+  }
+}
+
 }  // namespace internal
 }  // namespace base
@@ -47,6 +47,23 @@ std::unique_ptr<DictionaryValue> GenerateLayeredDict(int breadth, int depth) {
   return root;
 }
 
+// Generates a list of |count| dictionaries holding long strings, most of which
+// need no unescaping.
+std::unique_ptr<ListValue> GenerateStringList(int count) {
+  auto root = std::make_unique<ListValue>();
+  for (int i = 0; i < count; ++i) {
+    auto dict = std::make_unique<DictionaryValue>();
+    dict->SetString("Name", "Item " + std::to_string(i));
+    dict->SetString("Description", std::string(1000, 'x'));
+    dict->SetString("Escaped",
+                    "Quote \" and newline \n " + std::string(100, 'y'));
+    dict->SetString("NonASCII",
+                    "\xE4\xBD\xA0\xE5\xA5\xBD" + std::string(100, 'z'));
+    root->Append(std::move(dict));
+  }
+  return root;
+}
+
 }  // namespace
 
 class JSONPerfTest : public testing::Test {
@@ -71,6 +88,23 @@ class JSONPerfTest : public testing::Test {
                            (end_read - start_read).InMillisecondsF(), "ms",
                            true);
   }
+
+
+  void TestReadStrings(int count, int options) {
+    std::string description =
+        "Count: " + std::to_string(count) +
+        (options & JSONWriter::OPTIONS_PRETTY_PRINT ? ", Pretty" : "");
+    auto list = GenerateStringList(count);
+    std::string json;
+    JSONWriter::WriteWithOptions(*list, options, &json);
+
+    TimeTicks start_read = TimeTicks::Now();
+    JSONReader::Read(json);
+    TimeTicks end_read = TimeTicks::Now();
+    perf_test::PrintResult("ReadStrings", "", description,
+                           (end_read - start_read).InMillisecondsF(), "ms",
+                           true);
+  }
 };
 
 TEST_F(JSONPerfTest, StressTest) {
@@ -81,4 +115,11 @@ TEST_F(JSONPerfTest, StressTest) {
   }
 }
 
+TEST_F(JSONPerfTest, StringHeavy) {
+  for (int count : {1000, 10000}) {
+    TestReadStrings(count, 0);
+    TestReadStrings(count, JSONWriter::OPTIONS_PRETTY_PRINT);
+  }
+}
+
 }  // namespace base
@@ -80,6 +80,15 @@ std::unique_ptr<Value> JSONReader::ReadAndReturnError(
   return root ? std::make_unique<Value>(std::move(*root)) : nullptr;
 }
 
+// static
+std::unique_ptr<Value> JSONReader::ReadAtPointer(StringPiece json,
+                                                 StringPiece pointer,
+                                                 int options) {
+  internal::JSONParser parser(options);
+  Optional<Value> value = parser.ParseAtPointer(json, pointer);
+  return value ? std::make_unique<Value>(std::move(*value)) : nullptr;
+}
+
 // static
 std::string JSONReader::ErrorCodeToString(JsonParseError error_code) {
   switch (error_code) {
@@ -115,6 +124,16 @@ std::unique_ptr<Value> JSONReader::ReadToValue(StringPiece json) {
   return value ? std::make_unique<Value>(std::move(*value)) : nullptr;
 }
 
+std::unique_ptr<Value> JSONReader::ReadToValueAtPointer(StringPiece json,
+                                                        StringPiece pointer) {
+  Optional<Value> value = parser_->ParseAtPointer(json, pointer);
+  return value ? std::make_unique<Value>(std::move(*value)) : nullptr;
+}
+
+bool JSONReader::ReadWithHandler(StringPiece json, Handler* handler) {
+  return parser_->ParseWithHandler(json, handler);
+}
+
 JSONReader::JsonParseError JSONReader::error_code() const {
   return parser_->error_code();
 }
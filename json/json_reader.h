@@ -86,6 +86,28 @@ class BASE_EXPORT JSONReader {
   static const char kUnquotedDictionaryKey[];
   static const char kInputTooLarge[];
 
+  // Receives the contents of a JSON document as a stream of events, see
+  // ReadWithHandler(). The StringPieces passed to Key() and String() are only
+  // valid for the duration of the call. Returning false from any method stops
+  // the parsing.
+  class BASE_EXPORT Handler {
+   public:
+    virtual ~Handler() = default;
+
+    virtual bool StartObject() = 0;
+    // Called before the value of each member of an object.
+    virtual bool Key(StringPiece key) = 0;
+    virtual bool EndObject() = 0;
+    virtual bool StartArray() = 0;
+    virtual bool EndArray() = 0;
+    virtual bool String(StringPiece value) = 0;
+    // Numbers which fit in an int are reported by Int(), others by Double().
+    virtual bool Int(int value) = 0;
+    virtual bool Double(double value) = 0;
+    virtual bool Bool(bool value) = 0;
+    virtual bool Null() = 0;
+  };
+
   // Constructs a reader.
   JSONReader(int options = JSON_PARSE_RFC, int max_depth = kStackMaxDepth);
 
@@ -111,6 +133,19 @@ class BASE_EXPORT JSONReader {
       int* error_line_out = nullptr,
       int* error_column_out = nullptr);
 
+  // Reads only the value at |pointer| in |json|, a JSON Pointer (RFC 6901)
+  // such as "/a/b/3", which refers to item 3 of the list in member "b" of the
+  // dictionary in member "a" of the root dictionary. The values before it are
+  // skipped over without building them, and the input after it isn't looked
+  // at, so this is much faster than Read() for a few values of a large
+  // document. Skipped values are only checked to be well nested. If a
+  // dictionary has several members of the same name, the first one is used.
+  // Returns nullptr if |json| is malformed, or if |pointer| is malformed or
+  // matches nothing.
+  static std::unique_ptr<Value> ReadAtPointer(StringPiece json,
+                                              StringPiece pointer,
+                                              int options = JSON_PARSE_RFC);
+
   // Converts a JSON parse error code into a human readable message.
   // Returns an empty string if error_code is JSON_NO_ERROR.
   static std::string ErrorCodeToString(JsonParseError error_code);
@@ -118,6 +153,20 @@ class BASE_EXPORT JSONReader {
   // Non-static version of Read() above.
   std::unique_ptr<Value> ReadToValue(StringPiece json);
 
+  // Non-static version of ReadAtPointer() above. error_code() tells whether
+  // nullptr was returned because |json| is malformed.
+  std::unique_ptr<Value> ReadToValueAtPointer(StringPiece json,
+                                              StringPiece pointer);
+
+  // Parses |json| and reports its contents to |handler| as they are read,
+  // without building a Value. Memory use is bounded by the nesting depth and
+  // the longest string that needs decoding. Returns true if the whole input
+  // was parsed. Returns false if |json| is not a properly formed JSON string
+  // (see error_code()), or if |handler| stopped the parsing, in which case
+  // error_code() is JSON_NO_ERROR. Events may have been reported before an
+  // error is found.
+  bool ReadWithHandler(StringPiece json, Handler* handler);
+
   // Returns the error code if the last call to ReadToValue() failed.
   // Returns JSON_NO_ERROR otherwise.
   JsonParseError error_code() const;
@@ -13,6 +13,7 @@
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/path_service.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/values.h"
@@ -655,4 +656,205 @@ TEST(JSONReaderTest, MaxNesting) {
   ASSERT_TRUE(root);
 }
 
+TEST(JSONReaderTest, NestedContainersAfterError) {
+  JSONReader reader;
+  EXPECT_FALSE(reader.ReadToValue(R"([1, [2, {"a": 3, "b": [4, 5)"));
+
+  std::unique_ptr<Value> root =
+      reader.ReadToValue(R"([1, [2, 3], {"a": [4, {"b": 5}], "c": 6}, 7])");
+  ASSERT_TRUE(root);
+  ASSERT_TRUE(root->is_list());
+  ASSERT_EQ(4u, root->GetList().size());
+  EXPECT_EQ(1, root->GetList()[0].GetInt());
+  ASSERT_EQ(2u, root->GetList()[1].GetList().size());
+  EXPECT_EQ(3, root->GetList()[1].GetList()[1].GetInt());
+  const Value& dict = root->GetList()[2];
+  ASSERT_TRUE(dict.is_dict());
+  const Value* list = dict.FindKey("a");
+  ASSERT_TRUE(list);
+  ASSERT_EQ(2u, list->GetList().size());
+  EXPECT_EQ(5, list->GetList()[1].FindKey("b")->GetInt());
+  EXPECT_EQ(6, dict.FindKey("c")->GetInt());
+  EXPECT_EQ(7, root->GetList()[3].GetInt());
+}
+
+namespace {
+
+// Records the events it receives as a string, and stops the parsing once
+// |max_events| events were received.
+class RecordingHandler : public JSONReader::Handler {
+ public:
+  explicit RecordingHandler(int max_events = -1) : max_events_(max_events) {}
+  ~RecordingHandler() override = default;
+
+  const std::string& events() const { return events_; }
+
+  // JSONReader::Handler:
+  bool StartObject() override { return Record("{"); }
+  bool Key(StringPiece key) override {
+    return Record("K:" + key.as_string());
+  }
+  bool EndObject() override { return Record("}"); }
+  bool StartArray() override { return Record("["); }
+  bool EndArray() override { return Record("]"); }
+  bool String(StringPiece value) override {
+    return Record("S:" + value.as_string());
+  }
+  bool Int(int value) override { return Record("I:" + NumberToString(value)); }
+  bool Double(double value) override {
+    return Record("D:" + NumberToString(value));
+  }
+  bool Bool(bool value) override { return Record(value ? "true" : "false"); }
+  bool Null() override { return Record("null"); }
+
+ private:
+  bool Record(const std::string& event) {
+    if (!events_.empty())
+      events_ += " ";
+    events_ += event;
+    return --max_events_ != 0;
+  }
+
+  int max_events_;
+  std::string events_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecordingHandler);
+};
+
+}  // namespace
+
+TEST(JSONReaderTest, ReadWithHandler) {
+  JSONReader reader;
+  RecordingHandler handler;
+  EXPECT_TRUE(reader.ReadWithHandler(
+      R"({"a": [1, 2.5, "x\u0041y"], "b": {"c": true, "d": null}, "e": []})",
+      &handler));
+  EXPECT_EQ(JSONReader::JSON_NO_ERROR, reader.error_code());
+  EXPECT_EQ("{ K:a [ I:1 D:2.5 S:xAy ] K:b { K:c true K:d null } K:e [ ] }",
+            handler.events());
+}
+
+TEST(JSONReaderTest, ReadWithHandlerLiteralRoot) {
+  JSONReader reader;
+  RecordingHandler handler;
+  EXPECT_TRUE(reader.ReadWithHandler("  false  ", &handler));
+  EXPECT_EQ("false", handler.events());
+}
+
+TEST(JSONReaderTest, ReadWithHandlerErrors) {
+  {
+    JSONReader reader;
+    RecordingHandler handler;
+    EXPECT_FALSE(reader.ReadWithHandler("[1, 2,]", &handler));
+    EXPECT_EQ(JSONReader::JSON_TRAILING_COMMA, reader.error_code());
+    EXPECT_EQ("[ I:1 I:2", handler.events());
+  }
+  {
+    JSONReader reader(JSON_ALLOW_TRAILING_COMMAS);
+    RecordingHandler handler;
+    EXPECT_TRUE(reader.ReadWithHandler("[1, 2,]", &handler));
+    EXPECT_EQ("[ I:1 I:2 ]", handler.events());
+  }
+  {
+    JSONReader reader;
+    RecordingHandler handler;
+    EXPECT_FALSE(reader.ReadWithHandler("{foo: 1}", &handler));
+    EXPECT_EQ(JSONReader::JSON_UNQUOTED_DICTIONARY_KEY, reader.error_code());
+  }
+  {
+    JSONReader reader;
+    RecordingHandler handler;
+    EXPECT_FALSE(reader.ReadWithHandler("[] []", &handler));
+    EXPECT_EQ(JSONReader::JSON_UNEXPECTED_DATA_AFTER_ROOT, reader.error_code());
+  }
+  {
+    JSONReader reader;
+    RecordingHandler handler;
+    EXPECT_FALSE(
+        reader.ReadWithHandler(std::string(201, '[') + std::string(201, ']'),
+                               &handler));
+    EXPECT_EQ(JSONReader::JSON_TOO_MUCH_NESTING, reader.error_code());
+  }
+}
+
+TEST(JSONReaderTest, ReadWithHandlerStopped) {
+  JSONReader reader;
+  RecordingHandler handler(3);
+  EXPECT_FALSE(reader.ReadWithHandler(R"({"a": 1, "b": 2})", &handler));
+  EXPECT_EQ(JSONReader::JSON_NO_ERROR, reader.error_code());
+  EXPECT_EQ("{ K:a I:1", handler.events());
+}
+
+TEST(JSONReaderTest, ReadAtPointer) {
+  const std::string json = R"({
+    "skipped": {"nested": [1, "]}\"", {"a": null}], "x": -1.5e3},
+    // A comment with a bracket [.
+    "a": {"b": [true, "one", {"c": [4, 5]}]},
+    "with/slash": 1,
+    "with~tilde": 2,
+    "": 3,
+    "\u0065scaped": 4
+  })";
+
+  std::unique_ptr<Value> value = JSONReader::ReadAtPointer(json, "/a/b/2/c/1");
+  ASSERT_TRUE(value);
+  EXPECT_EQ(Value(5), *value);
+
+  value = JSONReader::ReadAtPointer(json, "/a/b/1");
+  ASSERT_TRUE(value);
+  EXPECT_EQ(Value("one"), *value);
+
+  value = JSONReader::ReadAtPointer(json, "/a");
+  ASSERT_TRUE(value);
+  EXPECT_TRUE(value->is_dict());
+
+  value = JSONReader::ReadAtPointer(json, "/with~1slash");
+  ASSERT_TRUE(value);
+  EXPECT_EQ(Value(1), *value);
+  value = JSONReader::ReadAtPointer(json, "/with~0tilde");
+  ASSERT_TRUE(value);
+  EXPECT_EQ(Value(2), *value);
+  value = JSONReader::ReadAtPointer(json, "/");
+  ASSERT_TRUE(value);
+  EXPECT_EQ(Value(3), *value);
+  value = JSONReader::ReadAtPointer(json, "/escaped");
+  ASSERT_TRUE(value);
+  EXPECT_EQ(Value(4), *value);
+
+  // The empty pointer refers to the whole document.
+  value = JSONReader::ReadAtPointer("[1]", "");
+  ASSERT_TRUE(value);
+  EXPECT_TRUE(value->is_list());
+
+  // Pointers which match nothing, or are malformed.
+  EXPECT_FALSE(JSONReader::ReadAtPointer(json, "/missing"));
+  EXPECT_FALSE(JSONReader::ReadAtPointer(json, "/a/b/3"));
+  EXPECT_FALSE(JSONReader::ReadAtPointer(json, "/a/b/01"));
+  EXPECT_FALSE(JSONReader::ReadAtPointer(json, "/a/b/-"));
+  EXPECT_FALSE(JSONReader::ReadAtPointer(json, "/a/b/0/c"));
+  EXPECT_FALSE(JSONReader::ReadAtPointer(json, "a"));
+  EXPECT_FALSE(JSONReader::ReadAtPointer(json, "/with~2tilde"));
+}
+
+TEST(JSONReaderTest, ReadAtPointerErrors) {
+  JSONReader reader;
+  EXPECT_FALSE(reader.ReadToValueAtPointer(R"({"a": 1})", "/b"));
+  EXPECT_EQ(JSONReader::JSON_NO_ERROR, reader.error_code());
+
+  // Errors in the skipped values.
+  EXPECT_FALSE(reader.ReadToValueAtPointer(R"({"a": [1, "2], "b": 1})", "/b"));
+  EXPECT_EQ(JSONReader::JSON_SYNTAX_ERROR, reader.error_code());
+  EXPECT_FALSE(reader.ReadToValueAtPointer(R"({"a": 1,, "b": 1})", "/b"));
+  EXPECT_EQ(JSONReader::JSON_UNQUOTED_DICTIONARY_KEY, reader.error_code());
+  EXPECT_FALSE(reader.ReadToValueAtPointer("[1, 2,]", "/2"));
+  EXPECT_EQ(JSONReader::JSON_TRAILING_COMMA, reader.error_code());
+
+  // Errors in the value itself.
+  EXPECT_FALSE(reader.ReadToValueAtPointer(R"({"a": [1,]})", "/a"));
+  EXPECT_EQ(JSONReader::JSON_TRAILING_COMMA, reader.error_code());
+
+  // The input after the value isn't looked at.
+  EXPECT_TRUE(reader.ReadToValueAtPointer(R"({"a": 1, "b": })", "/a"));
+}
+
 }  // namespace base
@@ -9,8 +9,10 @@
 #include <cmath>
 #include <limits>
 
+#include "base/files/file.h"
 #include "base/json/string_escape.h"
 #include "base/logging.h"
+#include "base/numerics/safe_conversions.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/values.h"
@@ -24,6 +26,10 @@ const char kPrettyPrintLineEnding[] = "\r\n";
 const char kPrettyPrintLineEnding[] = "\n";
 #endif
 
+// The output of a JSONStreamWriter is handed to its sink once it grew past
+// this size.
+constexpr size_t kSinkChunkSize = 64 * 1024;
+
 // static
 bool JSONWriter::Write(const Value& node, std::string* json) {
   return WriteWithOptions(node, 0, json);
@@ -37,28 +43,30 @@ bool JSONWriter::WriteWithOptions(const Value& node,
   // Is there a better way to estimate the size of the output?
   json->reserve(1024);
 
-  JSONWriter writer(options, json);
-  bool result = writer.BuildJSONString(node, 0U);
-
-  if (options & OPTIONS_PRETTY_PRINT)
-    json->append(kPrettyPrintLineEnding);
+  JSONStreamWriter stream_writer(options, json);
+  JSONWriter writer(options, &stream_writer);
+  return writer.BuildJSONString(node);
+}
 
+// static
+bool JSONWriter::WriteToSink(const Value& node, int options, Sink* sink) {
+  JSONStreamWriter stream_writer(options, sink);
+  JSONWriter writer(options, &stream_writer);
+  bool result = writer.BuildJSONString(node);
+  stream_writer.Flush();
   return result;
 }
 
-JSONWriter::JSONWriter(int options, std::string* json)
+JSONWriter::JSONWriter(int options, JSONStreamWriter* writer)
     : omit_binary_values_((options & OPTIONS_OMIT_BINARY_VALUES) != 0),
-      omit_double_type_preservation_(
-          (options & OPTIONS_OMIT_DOUBLE_TYPE_PRESERVATION) != 0),
-      pretty_print_((options & OPTIONS_PRETTY_PRINT) != 0),
-      json_string_(json) {
-  DCHECK(json);
+      writer_(writer) {
+  DCHECK(writer);
 }
 
-bool JSONWriter::BuildJSONString(const Value& node, size_t depth) {
+bool JSONWriter::BuildJSONString(const Value& node) {
   switch (node.type()) {
     case Value::Type::NONE: {
-      json_string_->append("null");
+      writer_->Null();
       return true;
     }
 
@@ -66,7 +74,7 @@ bool JSONWriter::BuildJSONString(const Value& node, size_t depth) {
       bool value;
       bool result = node.GetAsBoolean(&value);
       DCHECK(result);
-      json_string_->append(value ? "true" : "false");
+      writer_->Bool(value);
       return result;
     }
 
@@ -74,7 +82,7 @@ bool JSONWriter::BuildJSONString(const Value& node, size_t depth) {
       int value;
       bool result = node.GetAsInteger(&value);
       DCHECK(result);
-      json_string_->append(IntToString(value));
+      writer_->Int(value);
       return result;
     }
 
@@ -82,80 +90,34 @@ bool JSONWriter::BuildJSONString(const Value& node, size_t depth) {
       double value;
       bool result = node.GetAsDouble(&value);
       DCHECK(result);
-      if (omit_double_type_preservation_ &&
-          value <= std::numeric_limits<int64_t>::max() &&
-          value >= std::numeric_limits<int64_t>::min() &&
-          std::floor(value) == value) {
-        json_string_->append(Int64ToString(static_cast<int64_t>(value)));
-        return result;
-      }
-      std::string real = NumberToString(value);
-      // Ensure that the number has a .0 if there's no decimal or 'e'.  This
-      // makes sure that when we read the JSON back, it's interpreted as a
-      // real rather than an int.
-      if (real.find('.') == std::string::npos &&
-          real.find('e') == std::string::npos &&
-          real.find('E') == std::string::npos) {
-        real.append(".0");
-      }
-      // The JSON spec requires that non-integer values in the range (-1,1)
-      // have a zero before the decimal point - ".52" is not valid, "0.52" is.
-      if (real[0] == '.') {
-        real.insert(static_cast<size_t>(0), static_cast<size_t>(1), '0');
-      } else if (real.length() > 1 && real[0] == '-' && real[1] == '.') {
-        // "-.1" bad "-0.1" good
-        real.insert(static_cast<size_t>(1), static_cast<size_t>(1), '0');
-      }
-      json_string_->append(real);
+      writer_->Double(value);
       return result;
     }
 
     case Value::Type::STRING: {
-      std::string value;
-      bool result = node.GetAsString(&value);
-      DCHECK(result);
-      EscapeJSONString(value, true, json_string_);
-      return result;
+      writer_->String(node.GetString());
+      return true;
     }
 
     case Value::Type::LIST: {
-      json_string_->push_back('[');
-      if (pretty_print_)
-        json_string_->push_back(' ');
-
+      writer_->StartArray();
       const ListValue* list = nullptr;
-      bool first_value_has_been_output = false;
       bool result = node.GetAsList(&list);
       DCHECK(result);
       for (const auto& value : *list) {
         if (omit_binary_values_ && value.type() == Value::Type::BINARY)
           continue;
 
-        if (first_value_has_been_output) {
-          json_string_->push_back(',');
-          if (pretty_print_)
-            json_string_->push_back(' ');
-        }
-
-        if (!BuildJSONString(value, depth))
+        if (!BuildJSONString(value))
           result = false;
-
-        first_value_has_been_output = true;
       }
-
-      if (pretty_print_)
-        json_string_->push_back(' ');
-      json_string_->push_back(']');
+      writer_->EndArray();
       return result;
     }
 
     case Value::Type::DICTIONARY: {
-      json_string_->push_back('{');
-      if (pretty_print_)
-        json_string_->append(kPrettyPrintLineEnding);
-
+      writer_->StartObject();
       const DictionaryValue* dict = nullptr;
-      bool first_value_has_been_output = false;
       bool result = node.GetAsDictionary(&dict);
       DCHECK(result);
       for (DictionaryValue::Iterator itr(*dict); !itr.IsAtEnd();
@@ -164,32 +126,11 @@ bool JSONWriter::BuildJSONString(const Value& node, size_t depth) {
           continue;
         }
 
-        if (first_value_has_been_output) {
-          json_string_->push_back(',');
-          if (pretty_print_)
-            json_string_->append(kPrettyPrintLineEnding);
-        }
-
-        if (pretty_print_)
-          IndentLine(depth + 1U);
-
-        EscapeJSONString(itr.key(), true, json_string_);
-        json_string_->push_back(':');
-        if (pretty_print_)
-          json_string_->push_back(' ');
-
-        if (!BuildJSONString(itr.value(), depth + 1U))
+        writer_->Key(itr.key());
+        if (!BuildJSONString(itr.value()))
           result = false;
-
-        first_value_has_been_output = true;
-      }
-
-      if (pretty_print_) {
-        json_string_->append(kPrettyPrintLineEnding);
-        IndentLine(depth);
       }
-
-      json_string_->push_back('}');
+      writer_->EndObject();
       return result;
     }
 
@@ -202,8 +143,195 @@ bool JSONWriter::BuildJSONString(const Value& node, size_t depth) {
   return false;
 }
 
-void JSONWriter::IndentLine(size_t depth) {
-  json_string_->append(depth * 3U, ' ');
+JSONStreamWriter::JSONStreamWriter(int options, std::string* json)
+    : omit_double_type_preservation_(
+          (options & JSONWriter::OPTIONS_OMIT_DOUBLE_TYPE_PRESERVATION) != 0),
+      pretty_print_((options & JSONWriter::OPTIONS_PRETTY_PRINT) != 0),
+      sink_(nullptr),
+      output_(json) {
+  DCHECK(json);
+}
+
+JSONStreamWriter::JSONStreamWriter(int options, JSONWriter::Sink* sink)
+    : omit_double_type_preservation_(
+          (options & JSONWriter::OPTIONS_OMIT_DOUBLE_TYPE_PRESERVATION) != 0),
+      pretty_print_((options & JSONWriter::OPTIONS_PRETTY_PRINT) != 0),
+      sink_(sink),
+      output_(&buffer_) {
+  DCHECK(sink);
+  buffer_.reserve(kSinkChunkSize);
+}
+
+JSONStreamWriter::~JSONStreamWriter() {
+  Flush();
+}
+
+void JSONStreamWriter::StartObject() {
+  BeginValue();
+  output_->push_back('{');
+  if (pretty_print_)
+    output_->append(kPrettyPrintLineEnding);
+  containers_.push({true, false});
+  ++object_depth_;
+}
+
+void JSONStreamWriter::Key(StringPiece key) {
+  DCHECK(!containers_.empty() && containers_.top().is_object);
+  Container& object = containers_.top();
+  if (object.has_members) {
+    output_->push_back(',');
+    if (pretty_print_)
+      output_->append(kPrettyPrintLineEnding);
+  }
+  object.has_members = true;
+
+  if (pretty_print_)
+    IndentLine(object_depth_);
+  EscapeJSONString(key, true, output_);
+  output_->push_back(':');
+  if (pretty_print_)
+    output_->push_back(' ');
+}
+
+void JSONStreamWriter::EndObject() {
+  DCHECK(!containers_.empty() && containers_.top().is_object);
+  containers_.pop();
+  --object_depth_;
+  if (pretty_print_) {
+    output_->append(kPrettyPrintLineEnding);
+    IndentLine(object_depth_);
+  }
+  output_->push_back('}');
+  EndValue();
+}
+
+void JSONStreamWriter::StartArray() {
+  BeginValue();
+  output_->push_back('[');
+  if (pretty_print_)
+    output_->push_back(' ');
+  containers_.push({false, false});
+}
+
+void JSONStreamWriter::EndArray() {
+  DCHECK(!containers_.empty() && !containers_.top().is_object);
+  containers_.pop();
+  if (pretty_print_)
+    output_->push_back(' ');
+  output_->push_back(']');
+  EndValue();
+}
+
+void JSONStreamWriter::String(StringPiece value) {
+  BeginValue();
+  EscapeJSONString(value, true, output_);
+  EndValue();
+}
+
+void JSONStreamWriter::Int(int value) {
+  BeginValue();
+  char buffer[kMaxNumberToBufferLength];
+  output_->append(buffer, NumberToBuffer(value, buffer));
+  EndValue();
+}
+
+void JSONStreamWriter::Double(double value) {
+  BeginValue();
+  char buffer[kMaxNumberToBufferLength];
+  if (omit_double_type_preservation_ &&
+      value <= std::numeric_limits<int64_t>::max() &&
+      value >= std::numeric_limits<int64_t>::min() &&
+      std::floor(value) == value) {
+    output_->append(buffer,
+                    NumberToBuffer(static_cast<int64_t>(value), buffer));
+    EndValue();
+    return;
+  }
+  StringPiece real(buffer, NumberToBuffer(value, buffer));
+  // The JSON spec requires that non-integer values in the range (-1,1)
+  // have a zero before the decimal point - ".52" is not valid, "0.52" is.
+  if (real[0] == '-') {
+    output_->push_back('-');
+    real.remove_prefix(1);
+  }
+  if (real[0] == '.')
+    output_->push_back('0');
+  real.AppendToString(output_);
+  // Ensure that the number has a .0 if there's no decimal or 'e'.  This
+  // makes sure that when we read the JSON back, it's interpreted as a
+  // real rather than an int.
+  if (real.find_first_of(".eE") == StringPiece::npos)
+    output_->append(".0");
+  EndValue();
+}
+
+void JSONStreamWriter::Bool(bool value) {
+  BeginValue();
+  output_->append(value ? "true" : "false");
+  EndValue();
+}
+
+void JSONStreamWriter::Null() {
+  BeginValue();
+  output_->append("null");
+  EndValue();
+}
+
+void JSONStreamWriter::Flush() {
+  if (!sink_ || buffer_.empty())
+    return;
+  sink_->Append(buffer_);
+  buffer_.clear();
+}
+
+void JSONStreamWriter::BeginValue() {
+  if (sink_ && buffer_.size() >= kSinkChunkSize)
+    Flush();
+
+  // The members of objects are preceded by their key instead.
+  if (containers_.empty() || containers_.top().is_object)
+    return;
+  Container& array = containers_.top();
+  if (array.has_members) {
+    output_->push_back(',');
+    if (pretty_print_)
+      output_->push_back(' ');
+  }
+  array.has_members = true;
+}
+
+void JSONStreamWriter::EndValue() {
+  if (pretty_print_ && containers_.empty())
+    output_->append(kPrettyPrintLineEnding);
+}
+
+void JSONStreamWriter::IndentLine(size_t depth) {
+  output_->append(depth * 3U, ' ');
+}
+
+JSONFileSink::JSONFileSink(File* file) : file_(file) {
+  DCHECK(file->IsValid());
+}
+
+JSONFileSink::~JSONFileSink() = default;
+
+void JSONFileSink::Append(StringPiece chunk) {
+  if (!ok_)
+    return;
+  const int size = checked_cast<int>(chunk.size());
+  ok_ = file_->WriteAtCurrentPos(chunk.data(), size) == size;
+}
+
+JSONCallbackSink::JSONCallbackSink(
+    RepeatingCallback<void(StringPiece)> callback)
+    : callback_(std::move(callback)) {
+  DCHECK(callback_);
+}
+
+JSONCallbackSink::~JSONCallbackSink() = default;
+
+void JSONCallbackSink::Append(StringPiece chunk) {
+  callback_.Run(chunk);
 }
 
 }  // namespace base
@@ -10,14 +10,29 @@
 #include <string>
 
 #include "base/base_export.h"
+#include "base/callback.h"
+#include "base/containers/stack.h"
 #include "base/macros.h"
+#include "base/strings/string_piece.h"
 
 namespace base {
 
+class File;
+class JSONStreamWriter;
 class Value;
 
 class BASE_EXPORT JSONWriter {
  public:
+  // Receives the output of a writer in chunks, see WriteToSink() and
+  // JSONStreamWriter.
+  class BASE_EXPORT Sink {
+   public:
+    virtual ~Sink() = default;
+
+    // Called with each chunk of the output, in order.
+    virtual void Append(StringPiece chunk) = 0;
+  };
+
   enum Options {
     // This option instructs the writer that if a Binary value is encountered,
     // the value (and key if within a dictionary) will be omitted from the
@@ -50,26 +65,134 @@ class BASE_EXPORT JSONWriter {
                                int options,
                                std::string* json);
 
- private:
-  JSONWriter(int options, std::string* json);
+  // Same as above but hands the output to |sink| in chunks as it's generated,
+  // so that the whole document is never held in memory.
+  static bool WriteToSink(const Value& node, int options, Sink* sink);
 
-  // Called recursively to build the JSON string. When completed,
-  // |json_string_| will contain the JSON.
-  bool BuildJSONString(const Value& node, size_t depth);
+ private:
+  JSONWriter(int options, JSONStreamWriter* writer);
 
-  // Adds space to json_string_ for the indent level.
-  void IndentLine(size_t depth);
+  // Called recursively to write the JSON events of |node| to |writer_|.
+  bool BuildJSONString(const Value& node);
 
   bool omit_binary_values_;
-  bool omit_double_type_preservation_;
-  bool pretty_print_;
 
   // Where we write JSON data as we generate it.
-  std::string* json_string_;
+  JSONStreamWriter* const writer_;
 
   DISALLOW_COPY_AND_ASSIGN(JSONWriter);
 };
 
+// Writes a JSON document from a stream of events, without building a Value.
+// The events mirror those of JSONReader::Handler: the value of each member of
+// an object is preceded by a call to Key(). Takes the same options as
+// JSONWriter, except OPTIONS_OMIT_BINARY_VALUES which has no use here.
+//
+//   JSONStreamWriter writer(0, &json);
+//   writer.StartObject();
+//   writer.Key("name");
+//   writer.String("value");
+//   writer.EndObject();
+//
+// The output is appended to a string, or handed to a JSONWriter::Sink in
+// chunks. In the latter case, the last chunk is handed over on Flush() or
+// destruction.
+class BASE_EXPORT JSONStreamWriter {
+ public:
+  JSONStreamWriter(int options, std::string* json);
+  JSONStreamWriter(int options, JSONWriter::Sink* sink);
+  ~JSONStreamWriter();
+
+  void StartObject();
+  void Key(StringPiece key);
+  void EndObject();
+  void StartArray();
+  void EndArray();
+  void String(StringPiece value);
+  void Int(int value);
+  void Double(double value);
+  void Bool(bool value);
+  void Null();
+
+  // Hands the output generated so far to the sink. Does nothing when writing
+  // to a string.
+  void Flush();
+
+ private:
+  // Writes the separator and indentation needed before a value, and flushes
+  // the output to the sink once it grew large.
+  void BeginValue();
+
+  // Ends a pretty printed document with a line ending once its top-level
+  // value is complete.
+  void EndValue();
+
+  // Adds space to |output_| for the indent level.
+  void IndentLine(size_t depth);
+
+  const bool omit_double_type_preservation_;
+  const bool pretty_print_;
+
+  JSONWriter::Sink* const sink_;
+
+  // Buffers the output until it's handed to |sink_|.
+  std::string buffer_;
+
+  // Where we write JSON data as we generate it: the string given by the
+  // caller, or |buffer_|.
+  std::string* const output_;
+
+  // Whether each of the enclosing arrays and objects is an object, and
+  // whether it has members yet.
+  struct Container {
+    bool is_object;
+    bool has_members;
+  };
+  stack<Container> containers_;
+
+  // The number of enclosing objects, which pretty printing indents by.
+  size_t object_depth_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(JSONStreamWriter);
+};
+
+// A sink which writes the output of a JSON writer to a file.
+class BASE_EXPORT JSONFileSink : public JSONWriter::Sink {
+ public:
+  // |file| must be open for writing and outlive the sink.
+  explicit JSONFileSink(File* file);
+  ~JSONFileSink() override;
+
+  // Returns false if a write to the file failed. Once a write failed, the
+  // following output is dropped.
+  bool ok() const { return ok_; }
+
+  // JSONWriter::Sink:
+  void Append(StringPiece chunk) override;
+
+ private:
+  File* const file_;
+  bool ok_ = true;
+
+  DISALLOW_COPY_AND_ASSIGN(JSONFileSink);
+};
+
+// A sink which runs a callback with each chunk of the output of a JSON
+// writer.
+class BASE_EXPORT JSONCallbackSink : public JSONWriter::Sink {
+ public:
+  explicit JSONCallbackSink(RepeatingCallback<void(StringPiece)> callback);
+  ~JSONCallbackSink() override;
+
+  // JSONWriter::Sink:
+  void Append(StringPiece chunk) override;
+
+ private:
+  const RepeatingCallback<void(StringPiece)> callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(JSONCallbackSink);
+};
+
 }  // namespace base
 
 #endif  // BASE_JSON_JSON_WRITER_H_
@@ -4,6 +4,9 @@
 
 #include "base/json/json_writer.h"
 
+#include <vector>
+
+#include "base/bind.h"
 #include "base/memory/ptr_util.h"
 #include "base/values.h"
 #include "build/build_config.h"
@@ -151,4 +154,102 @@ TEST(JSONWriterTest, DoublesAsInts) {
   EXPECT_EQ("10000000000", output_js);
 }
 
+TEST(JSONWriterTest, WriteToSink) {
+  ListValue list;
+  DictionaryValue dict;
+  dict.SetString("key", std::string(100, 'a'));
+  dict.SetDouble("double", 0.5);
+  for (int i = 0; i < 2000; ++i)
+    list.Append(dict.CreateDeepCopy());
+  std::string expected;
+  ASSERT_TRUE(JSONWriter::WriteWithOptions(
+      list, JSONWriter::OPTIONS_PRETTY_PRINT, &expected));
+
+  // The output is handed over in several chunks, which make up the same
+  // document as the string output.
+  std::vector<std::string> chunks;
+  JSONCallbackSink sink(BindRepeating(
+      [](std::vector<std::string>* chunks, StringPiece chunk) {
+        chunks->push_back(chunk.as_string());
+      },
+      Unretained(&chunks)));
+  EXPECT_TRUE(
+      JSONWriter::WriteToSink(list, JSONWriter::OPTIONS_PRETTY_PRINT, &sink));
+  EXPECT_GT(chunks.size(), 1u);
+  std::string output_js;
+  for (const std::string& chunk : chunks)
+    output_js += chunk;
+  EXPECT_EQ(expected, output_js);
+
+  ListValue binary_list;
+  binary_list.Append(Value::CreateWithCopiedBuffer("asdf", 4));
+  binary_list.Append(std::make_unique<Value>(5));
+  chunks.clear();
+  EXPECT_FALSE(JSONWriter::WriteToSink(binary_list, 0, &sink));
+  EXPECT_TRUE(JSONWriter::WriteToSink(
+      binary_list, JSONWriter::OPTIONS_OMIT_BINARY_VALUES, &sink));
+  ASSERT_EQ(2u, chunks.size());
+  EXPECT_EQ("[5]", chunks[1]);
+}
+
+TEST(JSONStreamWriterTest, Write) {
+  std::string output_js;
+  {
+    JSONStreamWriter writer(0, &output_js);
+    writer.StartObject();
+    writer.Key("list");
+    writer.StartArray();
+    writer.Int(1);
+    writer.Double(-0.5);
+    writer.String("\"quoted\"");
+    writer.Bool(false);
+    writer.Null();
+    writer.StartObject();
+    writer.EndObject();
+    writer.EndArray();
+    writer.Key("int");
+    writer.Int(-3);
+    writer.EndObject();
+  }
+  EXPECT_EQ(
+      "{\"list\":[1,-0.5,\"\\\"quoted\\\"\",false,null,{}],\"int\":-3}",
+      output_js);
+
+  // Pretty printing matches that of JSONWriter.
+  output_js.clear();
+  {
+    JSONStreamWriter writer(JSONWriter::OPTIONS_PRETTY_PRINT, &output_js);
+    writer.StartObject();
+    writer.Key("list");
+    writer.StartArray();
+    writer.Int(1);
+    writer.StartObject();
+    writer.Key("inner");
+    writer.Bool(true);
+    writer.EndObject();
+    writer.EndArray();
+    writer.Key("double");
+    writer.Double(2);
+    writer.EndObject();
+  }
+#if defined(OS_WIN)
+  const char kExpected[] =
+      "{\r\n"
+      "   \"list\": [ 1, {\r\n"
+      "      \"inner\": true\r\n"
+      "   } ],\r\n"
+      "   \"double\": 2.0\r\n"
+      "}\r\n";
+#else
+  const char kExpected[] =
+      "{\n"
+      "   \"list\": [ 1, {\n"
+      "      \"inner\": true\n"
+      "   } ],\n"
+      "   \"double\": 2.0\n"
+      "}\n";
+#endif
+  EXPECT_EQ(kExpected, output_js);
+}
+
 }  // namespace base
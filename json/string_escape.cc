@@ -6,6 +6,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <limits>
 #include <string>
@@ -77,6 +78,63 @@ bool EscapeSpecialCodePoint(uint32_t code_point, std::string* dest) {
   return true;
 }
 
+// Returns whether |c| is copied to the output as is: a printable ASCII
+// character with no escape sequence.
+template <typename Char>
+inline bool IsUnescapedChar(Char c) {
+  return c >= 0x20 && c < 0x80 && c != '"' && c != '\\' && c != '<';
+}
+
+// The scanning below processes the input a word at a time.
+using ScanWord = uint64_t;
+constexpr ScanWord kScanWordLowBits = 0x0101010101010101ULL;
+constexpr ScanWord kScanWordHighBits = 0x8080808080808080ULL;
+
+// Returns whether any byte of |word|, which has no byte above 0x7F, is |c|.
+inline bool ScanWordHasByte(ScanWord word, char c) {
+  ScanWord matches = word ^ (kScanWordLowBits * static_cast<uint8_t>(c));
+  return ((matches - kScanWordLowBits) & ~matches & kScanWordHighBits) != 0;
+}
+
+// Returns the number of characters at the start of [|begin|, |end|) for which
+// IsUnescapedChar() holds.
+size_t CountUnescapedChars(const char* begin, const char* end) {
+  const char* pos = begin;
+  while (static_cast<size_t>(end - pos) >= sizeof(ScanWord)) {
+    ScanWord word;
+    memcpy(&word, pos, sizeof(word));
+    // Bytes above 0x7F, then bytes below 0x20.
+    if ((word & kScanWordHighBits) ||
+        ((word - kScanWordLowBits * 0x20) & ~word & kScanWordHighBits) ||
+        ScanWordHasByte(word, '"') || ScanWordHasByte(word, '\\') ||
+        ScanWordHasByte(word, '<')) {
+      break;
+    }
+    pos += sizeof(ScanWord);
+  }
+  while (pos != end && IsUnescapedChar(static_cast<uint8_t>(*pos)))
+    ++pos;
+  return pos - begin;
+}
+
+size_t CountUnescapedChars(const char16* begin, const char16* end) {
+  const char16* pos = begin;
+  while (pos != end && IsUnescapedChar(*pos))
+    ++pos;
+  return pos - begin;
+}
+
+void AppendUnescapedChars(const char* chars, size_t count, std::string* dest) {
+  dest->append(chars, count);
+}
+
+void AppendUnescapedChars(const char16* chars,
+                          size_t count,
+                          std::string* dest) {
+  for (size_t i = 0; i < count; ++i)
+    dest->push_back(static_cast<char>(chars[i]));
+}
+
 template <typename S>
 bool EscapeJSONStringImpl(const S& str, bool put_in_quotes, std::string* dest) {
   bool did_replacement = false;
@@ -90,6 +148,16 @@ bool EscapeJSONStringImpl(const S& str, bool put_in_quotes, std::string* dest) {
   const int32_t length = static_cast<int32_t>(str.length());
 
   for (int32_t i = 0; i < length; ++i) {
+    // Most characters need no escaping, copy them in bulk.
+    const size_t unescaped_length =
+        CountUnescapedChars(str.data() + i, str.data() + length);
+    if (unescaped_length) {
+      AppendUnescapedChars(str.data() + i, unescaped_length, dest);
+      i += static_cast<int32_t>(unescaped_length);
+      if (i == length)
+        break;
+    }
+
     uint32_t code_point;
     if (!ReadUnicodeCharacter(str.data(), length, &i, &code_point) ||
         code_point == static_cast<decltype(code_point)>(CBU_SENTINEL) ||
@@ -186,4 +186,37 @@ TEST(JSONStringEscapeTest, EscapeBytes) {
             EscapeBytesAsInvalidJSONString(in, false));
 }
 
+TEST(JSONStringEscapeTest, LongUnescapedRuns) {
+  // Runs of characters which need no escaping, of various lengths and
+  // alignments, around characters which do.
+  const std::string kRun = "abcdefghijklmnopqrstuvwxyz0123456789";
+  const struct {
+    const char* to_escape;
+    const char* escaped;
+  } cases[] = {
+      {"\"", "\\\""},
+      {"\\", "\\\\"},
+      {"<", "\\u003C"},
+      {"\n", "\\n"},
+      {"\x01", "\\u0001"},
+      {"\x7f", "\x7f"},
+      {"\xc3\xa9", "\xc3\xa9"},
+      {"\xe2\x80\xa8", "\\u2028"},
+  };
+
+  for (size_t i = 0; i < arraysize(cases); ++i) {
+    for (size_t prefix = 0; prefix <= 17; ++prefix) {
+      const std::string head = kRun.substr(0, prefix);
+      std::string in = head + cases[i].to_escape + kRun;
+      std::string out;
+      EscapeJSONString(in, false, &out);
+      EXPECT_EQ(head + cases[i].escaped + kRun, out);
+
+      out.clear();
+      EscapeJSONString(UTF8ToUTF16(in), false, &out);
+      EXPECT_EQ(head + cases[i].escaped + kRun, out);
+    }
+  }
+}
+
 }  // namespace base
@@ -6,11 +6,80 @@
 
 #include "base/at_exit.h"
 #include "base/atomicops.h"
+#include "base/compiler_specific.h"
 #include "base/threading/platform_thread.h"
+#include "build/build_config.h"
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <limits.h>
+
+#include <atomic>
+
+#include "base/synchronization/futex_linux.h"
+#endif
 
 namespace base {
 namespace internal {
 
+namespace {
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+// The threads waiting for another thread to create an instance sleep on this
+// futex, which is shared by all the instances since contention is rare. It's
+// incremented each time an instance is created while there are waiters, and
+// they are then all woken up to check whether it was theirs.
+CONSTINIT std::atomic<int32_t> g_creation_futex{0};
+// The number of threads sleeping, or about to sleep, on |g_creation_futex|, so
+// that creating an instance only makes a system call if one could be waiting.
+CONSTINIT std::atomic<int32_t> g_creation_waiters{0};
+
+void WaitForInstance(subtle::AtomicWord* state) {
+  for (;;) {
+    // Read the futex before checking |state|, so that a creation after the
+    // check makes FutexWait() return right away rather than sleep.
+    const int32_t creations = g_creation_futex.load(std::memory_order_relaxed);
+    g_creation_waiters.fetch_add(1, std::memory_order_relaxed);
+    // Pairs with the fence in WakeWaiters(): either this sees the instance,
+    // or WakeWaiters() sees this waiter.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const bool creating =
+        subtle::Acquire_Load(state) == kLazyInstanceStateCreating;
+    if (creating)
+      FutexWait(&g_creation_futex, creations, nullptr);
+    g_creation_waiters.fetch_sub(1, std::memory_order_relaxed);
+    if (!creating)
+      return;
+  }
+}
+
+void WakeWaiters() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (g_creation_waiters.load(std::memory_order_relaxed) == 0)
+    return;
+  g_creation_futex.fetch_add(1, std::memory_order_relaxed);
+  FutexWake(&g_creation_futex, INT_MAX);
+}
+#else
+void WaitForInstance(subtle::AtomicWord* state) {
+  const base::TimeTicks start = base::TimeTicks::Now();
+  do {
+    const base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+    // Spin with YieldCurrentThread for at most one ms - this ensures maximum
+    // responsiveness. After that spin with Sleep(1ms) so that we don't burn
+    // excessive CPU time - this also avoids infinite loops due to priority
+    // inversions (https://crbug.com/797129).
+    if (elapsed < TimeDelta::FromMilliseconds(1))
+      PlatformThread::YieldCurrentThread();
+    else
+      PlatformThread::Sleep(TimeDelta::FromMilliseconds(1));
+  } while (subtle::Acquire_Load(state) == kLazyInstanceStateCreating);
+}
+
+void WakeWaiters() {}
+#endif
+
+}  // namespace
+
 bool NeedsLazyInstance(subtle::AtomicWord* state) {
   // Try to create the instance, if we're the first, will go from 0 to
   // kLazyInstanceStateCreating, otherwise we've already been beaten here.
@@ -23,25 +92,15 @@ bool NeedsLazyInstance(subtle::AtomicWord* state) {
     return true;
   }
 
-  // It's either in the process of being created, or already created. Spin.
+  // It's either in the process of being created, or already created. Wait.
   // The load has acquire memory ordering as a thread which sees
   // state_ == STATE_CREATED needs to acquire visibility over
   // the associated data (buf_). Pairing Release_Store is in
-  // CompleteLazyInstance().
-  if (subtle::Acquire_Load(state) == kLazyInstanceStateCreating) {
-    const base::TimeTicks start = base::TimeTicks::Now();
-    do {
-      const base::TimeDelta elapsed = base::TimeTicks::Now() - start;
-      // Spin with YieldCurrentThread for at most one ms - this ensures maximum
-      // responsiveness. After that spin with Sleep(1ms) so that we don't burn
-      // excessive CPU time - this also avoids infinite loops due to priority
-      // inversions (https://crbug.com/797129).
-      if (elapsed < TimeDelta::FromMilliseconds(1))
-        PlatformThread::YieldCurrentThread();
-      else
-        PlatformThread::Sleep(TimeDelta::FromMilliseconds(1));
-    } while (subtle::Acquire_Load(state) == kLazyInstanceStateCreating);
-  }
+  // CompleteLazyInstance(). On Linux, waiting threads sleep on a futex rather
+  // than poll |state|, so that they neither burn CPU time nor are woken up
+  // late.
+  if (subtle::Acquire_Load(state) == kLazyInstanceStateCreating)
+    WaitForInstance(state);
   // Someone else created the instance.
   return false;
 }
@@ -54,6 +113,7 @@ void CompleteLazyInstance(subtle::AtomicWord* state,
   // |new_instance| is null). Releases visibility over |private_buf_| to
   // readers. Pairing Acquire_Load is in NeedsLazyInstance().
   subtle::Release_Store(state, new_instance);
+  WakeWaiters();
 
   // Make sure that the lazily instantiated object will get destroyed at exit.
   if (new_instance && destructor)
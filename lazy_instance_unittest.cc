@@ -320,3 +320,78 @@ TEST(LazyInstanceTest, PriorityInversionAtInitializationResolves) {
   EXPECT_LT(base::TimeTicks::Now() - test_begin,
             base::TimeDelta::FromSeconds(5));
 }
+
+namespace {
+
+// A class whose constructor sleeps until it is told to complete construction.
+class GatedConstructor {
+ public:
+  GatedConstructor() {
+    base::subtle::NoBarrier_Store(&constructor_called_, 1);
+    while (!base::subtle::NoBarrier_Load(&complete_construction_))
+      base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(1));
+    done_construction_ = true;
+  }
+
+  static bool WasConstructorCalled() {
+    return base::subtle::NoBarrier_Load(&constructor_called_);
+  }
+
+  static void CompleteConstructionNow() {
+    base::subtle::NoBarrier_Store(&complete_construction_, 1);
+  }
+
+  bool done_construction() const { return done_construction_; }
+
+ private:
+  static base::subtle::Atomic32 constructor_called_;
+  static base::subtle::Atomic32 complete_construction_;
+
+  bool done_construction_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(GatedConstructor);
+};
+
+// static
+base::subtle::Atomic32 GatedConstructor::constructor_called_ = 0;
+// static
+base::subtle::Atomic32 GatedConstructor::complete_construction_ = 0;
+
+base::LazyInstance<GatedConstructor>::Leaky lazy_gated =
+    LAZY_INSTANCE_INITIALIZER;
+base::LazyInstance<int>::Leaky lazy_other = LAZY_INSTANCE_INITIALIZER;
+
+class GatedGetter : public base::DelegateSimpleThread::Delegate {
+ public:
+  GatedGetter() = default;
+
+  void Run() override { EXPECT_TRUE(lazy_gated.Get().done_construction()); }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(GatedGetter);
+};
+
+}  // namespace
+
+// Tests that the threads waiting for an instance under construction don't
+// return when another instance is created in the meantime, which wakes them up
+// on Linux.
+TEST(LazyInstanceTest, WaitersIgnoreOtherInstances) {
+  constexpr int kNumThreads = 8;
+  GatedGetter getter;
+  base::DelegateSimpleThreadPool pool("GatedGetter", kNumThreads);
+  pool.AddWork(&getter, kNumThreads);
+  pool.Start();
+
+  while (!GatedConstructor::WasConstructorCalled())
+    base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(1));
+  // Gives the other threads time to start waiting.
+  base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(20));
+
+  lazy_other.Get() = 1;
+  base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(20));
+
+  GatedConstructor::CompleteConstructionNow();
+  pool.JoinAll();
+  EXPECT_TRUE(lazy_gated.Get().done_construction());
+}
@@ -8,27 +8,126 @@
 #include <intrin.h>
 #endif
 
+#include <atomic>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+
 #include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/no_destructor.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/stringprintf.h"
+#include "base/synchronization/lock.h"
 #include "build/build_config.h"
 
 namespace base {
 
+namespace {
+
+// Ids index fixed-size chunks of interned Location data, which are never moved
+// nor freed, so that the data of an id can be read without a lock.
+constexpr uint32_t kChunkShift = 12;
+constexpr uint32_t kChunkSize = 1 << kChunkShift;
+constexpr uint32_t kMaxChunks = 1024;
+
+}  // namespace
+
+// The interned data of all the Locations. Interning is serialized by |lock_|,
+// while GetData() only reads the chunks.
+class LocationTable {
+ public:
+  using Data = Location::Data;
+
+  LocationTable() = default;
+
+  uint32_t Intern(const Data& data) {
+    AutoLock auto_lock(lock_);
+    auto it = ids_.find(data);
+    if (it != ids_.end())
+      return it->second;
+
+    // Id 0 is the default-initialized Location.
+    const uint32_t id = static_cast<uint32_t>(ids_.size()) + 1;
+    const uint32_t chunk_index = id >> kChunkShift;
+    CHECK_LT(chunk_index, kMaxChunks);
+    Data* chunk = chunks_[chunk_index].load(std::memory_order_relaxed);
+    if (!chunk) {
+      chunk = new Data[kChunkSize];
+      chunks_[chunk_index].store(chunk, std::memory_order_release);
+    }
+    chunk[id & (kChunkSize - 1)] = data;
+    ids_.emplace(data, id);
+    return id;
+  }
+
+  static const Data& Get(uint32_t id) {
+    static constexpr Data kEmptyData;
+    if (!id)
+      return kEmptyData;
+    return chunks_[id >> kChunkShift].load(
+        std::memory_order_acquire)[id & (kChunkSize - 1)];
+  }
+
+ private:
+  struct DataHash {
+    size_t operator()(const Data& data) const {
+      return HashInts(HashInts(reinterpret_cast<uintptr_t>(data.file_name),
+                               data.line_number),
+                      reinterpret_cast<uintptr_t>(data.program_counter));
+    }
+  };
+
+  struct DataEqual {
+    bool operator()(const Data& a, const Data& b) const {
+      return std::tie(a.function_name, a.file_name, a.line_number,
+                      a.program_counter) ==
+             std::tie(b.function_name, b.file_name, b.line_number,
+                      b.program_counter);
+    }
+  };
+
+  static std::atomic<Data*> chunks_[kMaxChunks];
+
+  Lock lock_;
+  std::unordered_map<Data, uint32_t, DataHash, DataEqual> ids_;
+
+  DISALLOW_COPY_AND_ASSIGN(LocationTable);
+};
+
+// static
+std::atomic<Location::Data*> LocationTable::chunks_[kMaxChunks];
+
+namespace {
+
+LocationTable& GetLocationTable() {
+  static NoDestructor<LocationTable> location_table;
+  return *location_table;
+}
+
+}  // namespace
+
 Location::Location() = default;
 Location::Location(const Location& other) = default;
 
-Location::Location(const char* file_name, const void* program_counter)
-    : file_name_(file_name), program_counter_(program_counter) {}
+Location::Location(const char* file_name, const void* program_counter) {
+  Data data;
+  data.file_name = file_name;
+  data.program_counter = program_counter;
+  id_ = GetLocationTable().Intern(data);
+}
 
 Location::Location(const char* function_name,
                    const char* file_name,
                    int line_number,
-                   const void* program_counter)
-    : function_name_(function_name),
-      file_name_(file_name),
-      line_number_(line_number),
-      program_counter_(program_counter) {
+                   const void* program_counter) {
+  Data data;
+  data.function_name = function_name;
+  data.file_name = file_name;
+  data.line_number = line_number;
+  data.program_counter = program_counter;
+  id_ = GetLocationTable().Intern(data);
 #if !defined(OS_NACL)
   // The program counter should not be null except in a default constructed
   // (empty) Location object. This value is used for identity, so if it doesn't
@@ -42,10 +141,14 @@ Location::Location(const char* function_name,
 
 std::string Location::ToString() const {
   if (has_source_info()) {
-    return std::string(function_name_) + "@" + file_name_ + ":" +
-           IntToString(line_number_);
+    return std::string(function_name()) + "@" + file_name() + ":" +
+           IntToString(line_number());
   }
-  return StringPrintf("pc:%p", program_counter_);
+  return StringPrintf("pc:%p", program_counter());
+}
+
+const Location::Data& Location::GetData() const {
+  return LocationTable::Get(id_);
 }
 
 #if defined(COMPILER_MSVC)
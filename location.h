@@ -6,6 +6,7 @@
 #define BASE_LOCATION_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <cassert>
 #include <string>
@@ -18,6 +19,11 @@ namespace base {
 
 // Location provides basic info where of an object was constructed, or was
 // significantly brought to life.
+//
+// The source info is interned in a process-wide table, so a Location is only
+// a 4-byte id into it: it's cheap to copy into every posted task, and to
+// compare and hash when aggregating by Location. FROM_HERE interns its site
+// once, the first time it runs, and then only copies the id.
 class BASE_EXPORT Location {
  public:
   Location();
@@ -36,33 +42,38 @@ class BASE_EXPORT Location {
            int line_number,
            const void* program_counter);
 
-  // Comparator for hash map insertion. The program counter should uniquely
-  // identify a location.
-  bool operator==(const Location& other) const {
-    return program_counter_ == other.program_counter_;
-  }
+  // Comparator for hash map insertion. Locations with the same source info
+  // and program counter have the same id.
+  bool operator==(const Location& other) const { return id_ == other.id_; }
+  bool operator!=(const Location& other) const { return id_ != other.id_; }
 
   // Returns true if there is source code location info. If this is false,
   // the Location object only contains a program counter or is
   // default-initialized (the program counter is also null).
-  bool has_source_info() const { return function_name_ && file_name_; }
+  bool has_source_info() const {
+    return GetData().function_name && GetData().file_name;
+  }
 
   // Will be nullptr for default initialized Location objects and when source
   // names are disabled.
-  const char* function_name() const { return function_name_; }
+  const char* function_name() const { return GetData().function_name; }
 
   // Will be nullptr for default initialized Location objects and when source
   // names are disabled.
-  const char* file_name() const { return file_name_; }
+  const char* file_name() const { return GetData().file_name; }
 
   // Will be -1 for default initialized Location objects and when source names
   // are disabled.
-  int line_number() const { return line_number_; }
+  int line_number() const { return GetData().line_number; }
 
   // The address of the code generating this Location object. Should always be
   // valid except for default initialized Location objects, which will be
   // nullptr.
-  const void* program_counter() const { return program_counter_; }
+  const void* program_counter() const { return GetData().program_counter; }
+
+  // The interned id of this Location, unique within the process. It is 0 for
+  // default initialized Location objects.
+  uint32_t id() const { return id_; }
 
   // Converts to the most user-readable form possible. If function and filename
   // are not available, this will return "pc:<hex address>".
@@ -74,10 +85,19 @@ class BASE_EXPORT Location {
                                  int line_number);
 
  private:
-  const char* function_name_ = nullptr;
-  const char* file_name_ = nullptr;
-  int line_number_ = -1;
-  const void* program_counter_ = nullptr;
+  friend class LocationTable;
+
+  // The interned source info of a Location.
+  struct Data {
+    const char* function_name = nullptr;
+    const char* file_name = nullptr;
+    int line_number = -1;
+    const void* program_counter = nullptr;
+  };
+
+  const Data& GetData() const;
+
+  uint32_t id_ = 0;
 };
 
 BASE_EXPORT const void* GetProgramCounter();
@@ -85,15 +105,28 @@ BASE_EXPORT const void* GetProgramCounter();
 // The macros defined here will expand to the current function.
 #if BUILDFLAG(ENABLE_LOCATION_SOURCE)
 
-// Full source information should be included.
-#define FROM_HERE FROM_HERE_WITH_EXPLICIT_FUNCTION(__func__)
+// Full source information should be included. The Location of each FROM_HERE
+// site is created once, in a static local of a lambda unique to the site (a
+// lambda's own __func__ would be "operator()", so the enclosing function's is
+// passed in). The explicit function name may vary, so it isn't cached.
+#define FROM_HERE                                                            \
+  ([](const char* function_name) {                                           \
+    static const ::base::Location location =                                 \
+        ::base::Location::CreateFromHere(function_name, __FILE__, __LINE__); \
+    return location;                                                         \
+  }(__func__))
 #define FROM_HERE_WITH_EXPLICIT_FUNCTION(function_name) \
   ::base::Location::CreateFromHere(function_name, __FILE__, __LINE__)
 
 #else
 
 // TODO(http://crbug.com/760702) remove the __FILE__ argument from these calls.
-#define FROM_HERE ::base::Location::CreateFromHere(__FILE__)
+#define FROM_HERE                                   \
+  ([] {                                             \
+    static const ::base::Location location =        \
+        ::base::Location::CreateFromHere(__FILE__); \
+    return location;                                \
+  }())
 #define FROM_HERE_WITH_EXPLICIT_FUNCTION(function_name) \
   ::base::Location::CreateFromHere(function_name, __FILE__, -1)
 
@@ -107,8 +140,7 @@ namespace std {
 template <>
 struct hash<::base::Location> {
   std::size_t operator()(const ::base::Location& loc) const {
-    const void* program_counter = loc.program_counter();
-    return base::Hash(&program_counter, sizeof(void*));
+    return loc.id();
   }
 };
 
@@ -0,0 +1,72 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/location.h"
+
+#include <string.h>
+
+#include "base/debug/debugging_buildflags.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+Location WhereAmI() {
+  return FROM_HERE;
+}
+
+}  // namespace
+
+TEST(LocationTest, Default) {
+  Location location;
+  EXPECT_EQ(0u, location.id());
+  EXPECT_FALSE(location.has_source_info());
+  EXPECT_EQ(nullptr, location.function_name());
+  EXPECT_EQ(nullptr, location.file_name());
+  EXPECT_EQ(-1, location.line_number());
+  EXPECT_EQ(nullptr, location.program_counter());
+}
+
+TEST(LocationTest, FromHere) {
+  const Location location = WhereAmI();
+  EXPECT_NE(0u, location.id());
+  EXPECT_NE(nullptr, location.program_counter());
+  EXPECT_NE(nullptr, strstr(location.file_name(), "location_unittest.cc"));
+#if BUILDFLAG(ENABLE_LOCATION_SOURCE)
+  EXPECT_STREQ("WhereAmI", location.function_name());
+  EXPECT_EQ(17, location.line_number());
+#endif
+
+  // A site always has the same Location, and other sites different ones.
+  EXPECT_EQ(location, WhereAmI());
+  EXPECT_EQ(location.id(), WhereAmI().id());
+  EXPECT_NE(location, FROM_HERE);
+}
+
+// Locations are interned by their source info and program counter.
+TEST(LocationTest, Interned) {
+  static const char kFunction[] = "Function";
+  static const char kFile[] = "file.cc";
+  static const int kProgramCounter = 0;
+
+  const Location a(kFunction, kFile, 1, &kProgramCounter);
+  const Location b(kFunction, kFile, 1, &kProgramCounter);
+  const Location c(kFunction, kFile, 2, &kProgramCounter);
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(a.id(), b.id());
+  EXPECT_NE(a, c);
+  EXPECT_EQ(kFunction, c.function_name());
+  EXPECT_EQ(kFile, c.file_name());
+  EXPECT_EQ(2, c.line_number());
+  EXPECT_EQ(&kProgramCounter, c.program_counter());
+  EXPECT_EQ("Function@file.cc:2", c.ToString());
+}
+
+// Copies of a Location only copy its id.
+TEST(LocationTest, Size) {
+  EXPECT_EQ(sizeof(uint32_t), sizeof(Location));
+}
+
+}  // namespace base
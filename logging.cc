@@ -4,6 +4,7 @@
 
 #include "base/logging.h"
 
+#include <inttypes.h>
 #include <limits.h>
 #include <stdint.h>
 
@@ -71,6 +72,7 @@ typedef pthread_mutex_t* MutexHandle;
 #include <cstring>
 #include <ctime>
 #include <iomanip>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -91,7 +93,9 @@ typedef pthread_mutex_t* MutexHandle;
 #include "base/strings/sys_string_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/synchronization/lock_impl.h"
+#include "base/synchronization/waitable_event.h"
 #include "base/threading/platform_thread.h"
+#include "base/time/time.h"
 #include "base/vlog.h"
 #if defined(OS_POSIX)
 #include "base/posix/safe_strerror.h"
@@ -383,6 +387,161 @@ void CloseLogFileUnlocked() {
   g_log_file = nullptr;
 }
 
+void WriteToStderr(base::StringPiece message) {
+  ignore_result(fwrite(message.data(), message.size(), 1, stderr));
+  fflush(stderr);
+}
+
+void WriteToLogFile(base::StringPiece message) {
+  // We can have multiple threads and/or processes, so try to prevent them
+  // from clobbering each other's writes.
+  // If the client app did not call InitLogging, and the lock has not
+  // been created do it now. We do this on demand, but if two threads try
+  // to do this at the same time, there will be a race condition to create
+  // the lock. This is why InitLogging should be called from the main
+  // thread at the beginning of execution.
+#if !defined(OS_WIN)
+  LoggingLock::Init(LOCK_LOG_FILE, nullptr);
+  LoggingLock logging_lock;
+#endif
+  if (InitializeLogFileHandle()) {
+#if defined(OS_WIN)
+    DWORD num_written;
+    WriteFile(g_log_file,
+              static_cast<const void*>(message.data()),
+              static_cast<DWORD>(message.size()),
+              &num_written,
+              nullptr);
+#else
+    ignore_result(fwrite(message.data(), message.size(), 1, g_log_file));
+    fflush(g_log_file);
+#endif
+  }
+}
+
+// The maximum number of bytes queued in the WRITE_LOG_ASYNCHRONOUSLY mode.
+constexpr size_t kMaxQueuedLogBytes = 1024 * 1024;
+
+// The writer thread is woken up once this many bytes are queued, and otherwise
+// writes the queued messages at this interval.
+constexpr size_t kQueuedLogBytesToWakeUp = 64 * 1024;
+constexpr base::TimeDelta kAsyncLogWriteInterval =
+    base::TimeDelta::FromMilliseconds(50);
+
+// Writes the messages queued by the logging threads from a background thread,
+// in the WRITE_LOG_ASYNCHRONOUSLY mode. The logging threads only hold the
+// queue lock to append to the queue, not while writing. Uses LockImpl
+// directly, like LoggingLock, because Lock makes logging calls.
+class AsyncLogWriter : public base::PlatformThread::Delegate {
+ public:
+  AsyncLogWriter()
+      : wake_up_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                 base::WaitableEvent::InitialState::NOT_SIGNALED) {}
+
+  // Queues |message| to be written to stderr and/or to the log file, or drops
+  // it if the queue is full.
+  void Enqueue(base::StringPiece message, bool to_stderr, bool to_file) {
+    size_t size = (to_stderr ? message.size() : 0) +
+                  (to_file ? message.size() : 0);
+    queue_lock_.Lock();
+    if (queued_bytes_ + size > kMaxQueuedLogBytes) {
+      ++dropped_since_flush_;
+      ++dropped_count_;
+      queue_lock_.Unlock();
+      return;
+    }
+    if (to_stderr)
+      message.AppendToString(&stderr_queue_);
+    if (to_file)
+      message.AppendToString(&file_queue_);
+    bool wake_up = queued_bytes_ < kQueuedLogBytesToWakeUp &&
+                   queued_bytes_ + size >= kQueuedLogBytesToWakeUp;
+    queued_bytes_ += size;
+    queue_lock_.Unlock();
+    if (wake_up)
+      wake_up_.Signal();
+  }
+
+  // Writes the queued messages on the calling thread.
+  void Flush() {
+    // Only one thread writes at a time, so that the batches stay in order.
+    write_lock_.Lock();
+    queue_lock_.Lock();
+    stderr_queue_.swap(stderr_batch_);
+    file_queue_.swap(file_batch_);
+    queued_bytes_ = 0;
+    uint64_t dropped = dropped_since_flush_;
+    dropped_since_flush_ = 0;
+    queue_lock_.Unlock();
+
+    if (dropped) {
+      std::string notice = base::StringPrintf(
+          "[%" PRIu64 " log messages dropped]\n", dropped);
+      stderr_batch_.append(notice);
+      if ((g_logging_destination & LOG_TO_FILE) != 0)
+        file_batch_.append(notice);
+    }
+    if (!stderr_batch_.empty())
+      WriteToStderr(stderr_batch_);
+    if (!file_batch_.empty())
+      WriteToLogFile(file_batch_);
+    // The batches keep their capacity for the next flush.
+    stderr_batch_.clear();
+    file_batch_.clear();
+    write_lock_.Unlock();
+  }
+
+  uint64_t dropped_count() {
+    queue_lock_.Lock();
+    uint64_t dropped_count = dropped_count_;
+    queue_lock_.Unlock();
+    return dropped_count;
+  }
+
+  // base::PlatformThread::Delegate:
+  void ThreadMain() override {
+    while (true) {
+      wake_up_.TimedWait(kAsyncLogWriteInterval);
+      Flush();
+    }
+  }
+
+ private:
+  base::WaitableEvent wake_up_;
+
+  base::internal::LockImpl queue_lock_;
+  std::string stderr_queue_;
+  std::string file_queue_;
+  size_t queued_bytes_ = 0;
+  uint64_t dropped_since_flush_ = 0;
+  uint64_t dropped_count_ = 0;
+
+  base::internal::LockImpl write_lock_;
+  std::string stderr_batch_;
+  std::string file_batch_;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncLogWriter);
+};
+
+// Created, along with its thread, when WRITE_LOG_ASYNCHRONOUSLY is first set.
+// Leaky.
+AsyncLogWriter* g_async_log_writer = nullptr;
+
+// Whether the messages are currently queued for |g_async_log_writer|.
+bool g_write_log_asynchronously = false;
+
+// Starts |g_async_log_writer| if it isn't yet. Returns false if its thread
+// couldn't be created.
+bool StartAsyncLogWriter() {
+  if (g_async_log_writer)
+    return true;
+  std::unique_ptr<AsyncLogWriter> writer(new AsyncLogWriter);
+  if (!base::PlatformThread::CreateNonJoinable(0, writer.get()))
+    return false;
+  g_async_log_writer = writer.release();
+  return true;
+}
+
 }  // namespace
 
 #if DCHECK_IS_CONFIGURABLE
@@ -399,6 +558,7 @@ std::ostream* g_swallow_stream;
 
 LoggingSettings::LoggingSettings()
     : logging_dest(LOG_DEFAULT),
+      write_mode(WRITE_LOG_SYNCHRONOUSLY),
       log_file(nullptr),
       lock_log(LOCK_LOG_FILE),
       delete_old(APPEND_TO_OLD_LOG_FILE) {}
@@ -423,10 +583,17 @@ bool BaseInitLoggingImpl(const LoggingSettings& settings) {
         new VlogInfo(command_line->GetSwitchValueASCII(switches::kV),
                      command_line->GetSwitchValueASCII(switches::kVModule),
                      &g_min_log_level);
+    VlogSiteCache::InvalidateAll();
   }
 
   g_logging_destination = settings.logging_dest;
 
+  // Write the messages queued with the previous settings.
+  if (g_async_log_writer)
+    g_async_log_writer->Flush();
+  g_write_log_asynchronously =
+      settings.write_mode == WRITE_LOG_ASYNCHRONOUSLY && StartAsyncLogWriter();
+
   // ignore file options unless logging to file is set.
   if ((g_logging_destination & LOG_TO_FILE) == 0)
     return true;
@@ -451,6 +618,8 @@ bool BaseInitLoggingImpl(const LoggingSettings& settings) {
 
 void SetMinLogLevel(int level) {
   g_min_log_level = std::min(LOG_FATAL, level);
+  // The vlog levels of the files not matched by --vmodule follow it.
+  VlogSiteCache::InvalidateAll();
 }
 
 int GetMinLogLevel() {
@@ -482,6 +651,39 @@ int GetVlogLevelHelper(const char* file, size_t N) {
       GetVlogVerbosity();
 }
 
+std::atomic<uint32_t> VlogSiteCache::generation_{1};
+
+// static
+void VlogSiteCache::InvalidateAll() {
+  // Skip 0 on wraparound, which is the generation of the unresolved caches.
+  if (generation_.fetch_add(1, std::memory_order_relaxed) == UINT32_MAX)
+    generation_.fetch_add(1, std::memory_order_relaxed);
+}
+
+int VlogSiteCache::ResolveVlogLevel(const char* file, size_t N) {
+  // The generation is read first, so that a level resolved while the settings
+  // change is cached with the old generation and resolved again next time.
+  uint32_t generation = generation_.load(std::memory_order_relaxed);
+  int level = GetVlogLevelHelper(file, N);
+  state_.store((static_cast<uint64_t>(generation) << 32) |
+                   static_cast<uint32_t>(level),
+               std::memory_order_relaxed);
+  return level;
+}
+
+bool LogEveryTState::ShouldLog(double seconds) {
+  int64_t now_us =
+      (base::TimeTicks::Now() - base::TimeTicks()).InMicroseconds();
+  int64_t next_log_time_us = next_log_time_us_.load(std::memory_order_relaxed);
+  if (next_log_time_us && now_us < next_log_time_us)
+    return false;
+  // Only one of the threads racing past the deadline logs.
+  int64_t interval_us =
+      static_cast<int64_t>(seconds * base::Time::kMicrosecondsPerSecond);
+  return next_log_time_us_.compare_exchange_strong(
+      next_log_time_us, now_us + interval_us, std::memory_order_relaxed);
+}
+
 void SetLogItems(bool enable_process_id, bool enable_thread_id,
                  bool enable_timestamp, bool enable_tickcount) {
   g_log_process_id = enable_process_id;
@@ -599,6 +801,14 @@ LogMessage::~LogMessage() {
   stream_ << std::endl;
   std::string str_newline(stream_.str());
 
+  // In the asynchronous mode, fatal messages are written right away, after the
+  // queued ones.
+  bool write_asynchronously = g_write_log_asynchronously;
+  if (write_asynchronously && severity_ == LOG_FATAL) {
+    g_async_log_writer->Flush();
+    write_asynchronously = false;
+  }
+
   // Give any log message handler first dibs on the message.
   if (log_message_handler &&
       log_message_handler(severity_, file_, line_,
@@ -607,6 +817,7 @@ LogMessage::~LogMessage() {
     return;
   }
 
+  bool to_stderr = false;
   if ((g_logging_destination & LOG_TO_SYSTEM_DEBUG_LOG) != 0) {
 #if defined(OS_WIN)
     OutputDebugStringA(str_newline.c_str());
@@ -776,43 +987,23 @@ LogMessage::~LogMessage() {
     }
     __android_log_write(priority, "chromium", str_newline.c_str());
 #endif
-    ignore_result(fwrite(str_newline.data(), str_newline.size(), 1, stderr));
-    fflush(stderr);
+    to_stderr = true;
   } else if (severity_ >= kAlwaysPrintErrorLevel) {
     // When we're only outputting to a log file, above a certain log level, we
     // should still output to stderr so that we can better detect and diagnose
     // problems with unit tests, especially on the buildbots.
-    ignore_result(fwrite(str_newline.data(), str_newline.size(), 1, stderr));
-    fflush(stderr);
+    to_stderr = true;
   }
 
-  // write to log file
-  if ((g_logging_destination & LOG_TO_FILE) != 0) {
-    // We can have multiple threads and/or processes, so try to prevent them
-    // from clobbering each other's writes.
-    // If the client app did not call InitLogging, and the lock has not
-    // been created do it now. We do this on demand, but if two threads try
-    // to do this at the same time, there will be a race condition to create
-    // the lock. This is why InitLogging should be called from the main
-    // thread at the beginning of execution.
-#if !defined(OS_WIN)
-    LoggingLock::Init(LOCK_LOG_FILE, nullptr);
-    LoggingLock logging_lock;
-#endif
-    if (InitializeLogFileHandle()) {
-#if defined(OS_WIN)
-      DWORD num_written;
-      WriteFile(g_log_file,
-                static_cast<const void*>(str_newline.c_str()),
-                static_cast<DWORD>(str_newline.length()),
-                &num_written,
-                nullptr);
-#else
-      ignore_result(fwrite(
-          str_newline.data(), str_newline.size(), 1, g_log_file));
-      fflush(g_log_file);
-#endif
-    }
+  // write to stderr and to the log file
+  bool to_file = (g_logging_destination & LOG_TO_FILE) != 0;
+  if (write_asynchronously) {
+    g_async_log_writer->Enqueue(str_newline, to_stderr, to_file);
+  } else {
+    if (to_stderr)
+      WriteToStderr(str_newline);
+    if (to_file)
+      WriteToLogFile(str_newline);
   }
 
   if (severity_ == LOG_FATAL) {
@@ -993,12 +1184,22 @@ ErrnoLogMessage::~ErrnoLogMessage() {
 #endif  // defined(OS_WIN)
 
 void CloseLogFile() {
+  FlushAsyncLogging();
 #if !defined(OS_WIN)
   LoggingLock logging_lock;
 #endif
   CloseLogFileUnlocked();
 }
 
+void FlushAsyncLogging() {
+  if (g_async_log_writer)
+    g_async_log_writer->Flush();
+}
+
+uint64_t GetDroppedAsyncLogMessageCount() {
+  return g_async_log_writer ? g_async_log_writer->dropped_count() : 0;
+}
+
 void RawLog(int level, const char* message) {
   if (level >= g_min_log_level && message) {
     size_t bytes_written = 0;
@@ -6,7 +6,9 @@
 #define BASE_LOGGING_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <sstream>
@@ -184,16 +186,26 @@ enum LogLockingState { LOCK_LOG_FILE, DONT_LOCK_LOG_FILE };
 // Defaults to APPEND_TO_OLD_LOG_FILE.
 enum OldFileDeletionState { DELETE_OLD_LOG_FILE, APPEND_TO_OLD_LOG_FILE };
 
+// Are the messages written to stderr and to the log file by the thread which
+// logs them, or queued for a background thread to write them in batches? In
+// the asynchronous mode, the queue is bounded and the messages which don't fit
+// are dropped, see GetDroppedAsyncLogMessageCount(). Fatal messages are always
+// written synchronously, after the queued ones. Defaults to
+// WRITE_LOG_SYNCHRONOUSLY.
+enum LogWritingMode { WRITE_LOG_SYNCHRONOUSLY, WRITE_LOG_ASYNCHRONOUSLY };
+
 struct BASE_EXPORT LoggingSettings {
   // The defaults values are:
   //
   //  logging_dest: LOG_DEFAULT
+  //  write_mode:   WRITE_LOG_SYNCHRONOUSLY
   //  log_file:     NULL
   //  lock_log:     LOCK_LOG_FILE
   //  delete_old:   APPEND_TO_OLD_LOG_FILE
   LoggingSettings();
 
   LoggingDestination logging_dest;
+  LogWritingMode write_mode;
 
   // The three settings below have an effect only when LOG_TO_FILE is
   // set in |logging_dest|.
@@ -261,6 +273,73 @@ int GetVlogLevel(const char (&file)[N]) {
   return GetVlogLevelHelper(file, N);
 }
 
+// The vlog level of a call site, as cached by VLOG_IS_ON() so that the vmodule
+// patterns are only matched against its file once. The level is kept along
+// with the generation of the vlog settings it was resolved with, and is
+// resolved again once they change.
+class BASE_EXPORT VlogSiteCache {
+ public:
+  constexpr VlogSiteCache() : state_(0) {}
+
+  template <size_t N>
+  int GetVlogLevel(const char (&file)[N]) {
+    uint64_t state = state_.load(std::memory_order_relaxed);
+    if (static_cast<uint32_t>(state >> 32) ==
+        generation_.load(std::memory_order_relaxed)) {
+      return static_cast<int32_t>(static_cast<uint32_t>(state));
+    }
+    return ResolveVlogLevel(file, N);
+  }
+
+  // Makes all the call sites resolve their level again. Called whenever the
+  // vlog settings change.
+  static void InvalidateAll();
+
+ private:
+  int ResolveVlogLevel(const char* file, size_t N);
+
+  // The generation in the upper 32 bits and the level in the lower ones. 0
+  // never matches, since the generations start at 1.
+  std::atomic<uint64_t> state_;
+
+  static std::atomic<uint32_t> generation_;
+
+  DISALLOW_COPY_AND_ASSIGN(VlogSiteCache);
+};
+
+// The state of a LOG_EVERY_N() call site.
+class BASE_EXPORT LogEveryNState {
+ public:
+  constexpr LogEveryNState() : count_(0) {}
+
+  // Returns true on the first call and then on every |n|th one.
+  bool ShouldLog(int n) {
+    return count_.fetch_add(1, std::memory_order_relaxed) %
+               static_cast<uint32_t>(n > 0 ? n : 1) ==
+           0;
+  }
+
+ private:
+  std::atomic<uint32_t> count_;
+
+  DISALLOW_COPY_AND_ASSIGN(LogEveryNState);
+};
+
+// The state of a LOG_EVERY_T() call site.
+class BASE_EXPORT LogEveryTState {
+ public:
+  constexpr LogEveryTState() : next_log_time_us_(0) {}
+
+  // Returns true on the first call and then at most once every |seconds|.
+  bool ShouldLog(double seconds);
+
+ private:
+  // In microseconds of TimeTicks, 0 before the first message.
+  std::atomic<int64_t> next_log_time_us_;
+
+  DISALLOW_COPY_AND_ASSIGN(LogEveryTState);
+};
+
 // Sets the common items you want to be prepended to each log message.
 // process and thread IDs default to off, the timestamp defaults to on.
 // If this function is not called, logging defaults to writing the timestamp
@@ -395,12 +474,29 @@ const LogSeverity LOG_0 = LOG_ERROR;
 #define LOG_IS_ON(severity) \
   (::logging::ShouldCreateLogMessage(::logging::LOG_##severity))
 
-// We can't do any caching tricks with VLOG_IS_ON() like the
-// google-glog version since it requires GCC extensions.  This means
-// that using the v-logging functions in conjunction with --vmodule
-// may be slow.
-#define VLOG_IS_ON(verboselevel) \
-  ((verboselevel) <= ::logging::GetVlogLevel(__FILE__))
+// Each VLOG_IS_ON() caches the vlog level of its file in a function-local
+// static of a lambda, so that the --vmodule patterns are only matched once per
+// call site rather than on every message.
+#define VLOG_IS_ON(verboselevel)                                     \
+  ((verboselevel) <= []() -> ::logging::VlogSiteCache& {             \
+    static ::logging::VlogSiteCache vlog_site_cache;                 \
+    return vlog_site_cache;                                          \
+  }().GetVlogLevel(__FILE__))
+
+// Rate-limited checks, keeping their state in a static per call site like
+// VLOG_IS_ON(). LOG_EVERY_N_IS_ON holds on the first call and on every |n|th
+// one after it; LOG_EVERY_T_IS_ON holds on the first call and then at most
+// once every |seconds|.
+#define LOG_EVERY_N_IS_ON(n)                                         \
+  ([]() -> ::logging::LogEveryNState& {                              \
+    static ::logging::LogEveryNState log_every_n_state;              \
+    return log_every_n_state;                                        \
+  }().ShouldLog(n))
+#define LOG_EVERY_T_IS_ON(seconds)                                   \
+  ([]() -> ::logging::LogEveryTState& {                              \
+    static ::logging::LogEveryTState log_every_t_state;              \
+    return log_every_t_state;                                        \
+  }().ShouldLog(seconds))
 
 // Helper macro which avoids evaluating the arguments to a stream if
 // the condition doesn't hold. Condition is evaluated once and only once.
@@ -421,6 +517,21 @@ const LogSeverity LOG_0 = LOG_ERROR;
 #define LOG_IF(severity, condition) \
   LAZY_STREAM(LOG_STREAM(severity), LOG_IS_ON(severity) && (condition))
 
+// Rate-limited logging, for messages which could otherwise flood the log:
+//
+//   LOG_EVERY_N(WARNING, 100) << "Dropped packet " << id;
+//   LOG_EVERY_T(ERROR, 5) << "Still can't connect";
+//
+// The first one logs the 1st, 101st, 201st... messages, the second one at
+// most one message every 5 seconds. The messages skipped aren't counted when
+// the severity is disabled.
+#define LOG_EVERY_N(severity, n)    \
+  LAZY_STREAM(LOG_STREAM(severity), \
+              LOG_IS_ON(severity) && LOG_EVERY_N_IS_ON(n))
+#define LOG_EVERY_T(severity, seconds) \
+  LAZY_STREAM(LOG_STREAM(severity),    \
+              LOG_IS_ON(severity) && LOG_EVERY_T_IS_ON(seconds))
+
 // The VLOG macros log with negative verbosities.
 #define VLOG_STREAM(verbose_level) \
   ::logging::LogMessage(__FILE__, __LINE__, -verbose_level).stream()
@@ -1107,6 +1218,16 @@ class BASE_EXPORT ErrnoLogMessage {
 //       after this call.
 BASE_EXPORT void CloseLogFile();
 
+// Writes the messages queued in the WRITE_LOG_ASYNCHRONOUSLY mode on the
+// calling thread. This is done before writing a fatal message; crash handlers
+// which don't go through LOG(FATAL) should call it too, before the process
+// dies. It takes locks and uses stdio, so it isn't async signal safe.
+BASE_EXPORT void FlushAsyncLogging();
+
+// Returns the number of messages dropped in the WRITE_LOG_ASYNCHRONOUSLY mode
+// because the queue was full.
+BASE_EXPORT uint64_t GetDroppedAsyncLogMessageCount();
+
 // Async signal safe logging mechanism.
 BASE_EXPORT void RawLog(int level, const char* message);
 
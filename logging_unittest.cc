@@ -6,6 +6,8 @@
 #include "base/bind.h"
 #include "base/callback.h"
 #include "base/compiler_specific.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/macros.h"
 #include "base/strings/string_piece.h"
 #include "base/test/scoped_feature_list.h"
@@ -154,6 +156,59 @@ TEST_F(LoggingTest, LogIsOn) {
   EXPECT_EQ(kDfatalIsFatal, LOG_IS_ON(DFATAL));
 }
 
+// A single VLOG_IS_ON() call site, whose cached level must follow the changes
+// of the vlog settings.
+bool IsVlogOneOn() {
+  return VLOG_IS_ON(1);
+}
+
+TEST_F(LoggingTest, VlogIsOnFollowsMinLogLevel) {
+  SetMinLogLevel(LOG_INFO);
+  EXPECT_FALSE(IsVlogOneOn());
+  EXPECT_FALSE(IsVlogOneOn());
+  EXPECT_TRUE(VLOG_IS_ON(0));
+
+  SetMinLogLevel(-1);
+  EXPECT_TRUE(IsVlogOneOn());
+  EXPECT_TRUE(IsVlogOneOn());
+  EXPECT_FALSE(VLOG_IS_ON(2));
+
+  SetMinLogLevel(LOG_INFO);
+  EXPECT_FALSE(IsVlogOneOn());
+}
+
+TEST_F(LoggingTest, LogEveryN) {
+  int num_logged = 0;
+  for (int i = 0; i < 10; ++i) {
+    if (LOG_EVERY_N_IS_ON(3))
+      ++num_logged;
+  }
+  // The 1st, 4th, 7th and 10th calls.
+  EXPECT_EQ(4, num_logged);
+
+  MockLogSource mock_log_source;
+  EXPECT_CALL(mock_log_source, Log()).Times(2).WillRepeatedly(Return("log"));
+  SetMinLogLevel(LOG_INFO);
+  for (int i = 0; i < 4; ++i)
+    LOG_EVERY_N(INFO, 2) << mock_log_source.Log();
+}
+
+TEST_F(LoggingTest, LogEveryT) {
+  int num_logged = 0;
+  for (int i = 0; i < 10; ++i) {
+    if (LOG_EVERY_T_IS_ON(1000))
+      ++num_logged;
+  }
+  EXPECT_EQ(1, num_logged);
+
+  num_logged = 0;
+  for (int i = 0; i < 10; ++i) {
+    if (LOG_EVERY_T_IS_ON(0))
+      ++num_logged;
+  }
+  EXPECT_EQ(10, num_logged);
+}
+
 TEST_F(LoggingTest, LoggingIsLazyBySeverity) {
   MockLogSource mock_log_source;
   EXPECT_CALL(mock_log_source, Log()).Times(0);
@@ -543,6 +598,41 @@ TEST_F(LoggingTest, CheckEqStatements) {
     CHECK_EQ(false, true);           // Unreached.
 }
 
+TEST_F(LoggingTest, AsynchronousLogging) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath log_file = temp_dir.GetPath().AppendASCII("test.log");
+
+  SetMinLogLevel(LOG_INFO);
+  LoggingSettings settings;
+  settings.logging_dest = LOG_TO_FILE;
+  settings.log_file = log_file.value().c_str();
+  settings.write_mode = WRITE_LOG_ASYNCHRONOUSLY;
+  ASSERT_TRUE(InitLogging(settings));
+
+  LOG(INFO) << "First message";
+  LOG(WARNING) << "Second message";
+  FlushAsyncLogging();
+
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(log_file, &contents));
+  size_t first = contents.find("First message");
+  ASSERT_NE(std::string::npos, first);
+  EXPECT_NE(std::string::npos, contents.find("Second message", first));
+  EXPECT_EQ(0u, GetDroppedAsyncLogMessageCount());
+
+  // Switching back to the synchronous mode writes the messages right away.
+  settings.write_mode = WRITE_LOG_SYNCHRONOUSLY;
+  ASSERT_TRUE(InitLogging(settings));
+  LOG(INFO) << "Third message";
+  ASSERT_TRUE(base::ReadFileToString(log_file, &contents));
+  EXPECT_NE(std::string::npos, contents.find("Third message"));
+
+  settings.logging_dest = LOG_TO_SYSTEM_DEBUG_LOG;
+  InitLogging(settings);
+  CloseLogFile();
+}
+
 TEST_F(LoggingTest, NestedLogAssertHandlers) {
   ::testing::InSequence dummy;
   ::testing::StrictMock<MockLogAssertHandler> handler_a, handler_b;
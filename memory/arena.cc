@@ -0,0 +1,98 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/arena.h"
+
+#include <stdlib.h>
+
+namespace base {
+
+// Chunks are followed by their memory.
+struct alignas(std::max_align_t) Arena::Chunk {
+  Chunk* next;
+  // The number of bytes following the chunk.
+  size_t size;
+
+  uintptr_t begin() { return reinterpret_cast<uintptr_t>(this + 1); }
+  uintptr_t end() { return begin() + size; }
+};
+
+constexpr size_t Arena::kDefaultChunkSize;
+
+Arena::Arena(size_t chunk_size) : chunk_size_(chunk_size) {
+  DCHECK_GE(chunk_size_, 4 * sizeof(Destructor));
+}
+
+Arena::~Arena() {
+  Reset();
+  if (chunks_) {
+    DCHECK(!chunks_->next);
+    free(chunks_);
+  }
+}
+
+void Arena::Reset() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  for (Destructor* destructor = destructors_; destructor;
+       destructor = destructor->next) {
+    destructor->destroy(destructor->object);
+  }
+  destructors_ = nullptr;
+
+  // Keeps the chunk the allocations were bumped from, unless it was dedicated
+  // to a large allocation.
+  Chunk* kept_chunk =
+      chunks_ && chunks_->size == chunk_size_ ? chunks_ : nullptr;
+  Chunk* chunk = chunks_;
+  while (chunk) {
+    Chunk* next = chunk->next;
+    if (chunk != kept_chunk) {
+      bytes_reserved_ -= sizeof(Chunk) + chunk->size;
+      free(chunk);
+    }
+    chunk = next;
+  }
+  chunks_ = kept_chunk;
+  if (kept_chunk) {
+    kept_chunk->next = nullptr;
+    next_ = kept_chunk->begin();
+    end_ = kept_chunk->end();
+  } else {
+    next_ = end_ = 0;
+  }
+}
+
+void* Arena::AllocateSlow(size_t size) {
+  if (size > chunk_size_ / 4) {
+    // Linked after the current chunk, which goes on serving the small
+    // allocations.
+    Chunk* chunk = NewChunk(size);
+    if (chunks_) {
+      chunk->next = chunks_->next;
+      chunks_->next = chunk;
+    } else {
+      chunk->next = nullptr;
+      chunks_ = chunk;
+    }
+    return reinterpret_cast<void*>(chunk->begin());
+  }
+
+  Chunk* chunk = NewChunk(chunk_size_);
+  chunk->next = chunks_;
+  chunks_ = chunk;
+  next_ = chunk->begin() + size;
+  end_ = chunk->end();
+  return reinterpret_cast<void*>(chunk->begin());
+}
+
+Arena::Chunk* Arena::NewChunk(size_t size) {
+  size_t total_size = CheckAdd(sizeof(Chunk), size).ValueOrDie();
+  Chunk* chunk = static_cast<Chunk*>(malloc(total_size));
+  CHECK(chunk);
+  chunk->size = size;
+  bytes_reserved_ += total_size;
+  return chunk;
+}
+
+}  // namespace base
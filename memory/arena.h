@@ -0,0 +1,181 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_ARENA_H_
+#define BASE_MEMORY_ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "base/base_export.h"
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/numerics/checked_math.h"
+#include "base/sequence_checker.h"
+
+namespace base {
+
+// A bump-pointer allocator for objects which share a lifetime, such as the
+// objects created while handling a request, or while running the tasks of a
+// sequence. Allocating is a pointer increment most of the time, and all the
+// memory of the arena is released at once by Reset() or by its destructor.
+// Freeing an individual allocation is a no-op.
+//
+// Objects created with New() are destroyed by Reset(), in the reverse order of
+// their creation. Memory returned by Allocate() is not tracked.
+//
+// Example:
+//   Arena arena;
+//   Node* root = arena.New<Node>(nullptr);
+//   std::vector<Node*, ArenaAllocator<Node*>> children(
+//       ArenaAllocator<Node*>(&arena));
+//   ...
+//   arena.Reset();  // Destroys |root|.
+//
+// An arena is not thread safe, and must be used on a single sequence.
+class BASE_EXPORT Arena {
+ public:
+  static constexpr size_t kDefaultChunkSize = 4096;
+
+  // Memory is obtained from malloc() in chunks of |chunk_size| bytes.
+  // Allocations larger than a quarter of that get a chunk of their own.
+  explicit Arena(size_t chunk_size = kDefaultChunkSize);
+  ~Arena();
+
+  // Returns |size| bytes aligned to |alignment|, which must be a power of two
+  // no larger than alignof(std::max_align_t). Never returns null.
+  void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    DCHECK(alignment && !(alignment & (alignment - 1)));
+    DCHECK_LE(alignment, alignof(std::max_align_t));
+    uintptr_t ptr = (next_ + alignment - 1) & ~(alignment - 1);
+    if (LIKELY(ptr <= end_ && size <= end_ - ptr)) {
+      next_ = ptr + size;
+      return reinterpret_cast<void*>(ptr);
+    }
+    return AllocateSlow(size);
+  }
+
+  // Creates a T in the arena, which is destroyed by Reset().
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "over-aligned types are not supported");
+    if (std::is_trivially_destructible<T>::value) {
+      return new (Allocate(sizeof(T), alignof(T)))
+          T(std::forward<Args>(args)...);
+    }
+    Destructor* destructor = static_cast<Destructor*>(
+        Allocate(sizeof(Destructor), alignof(Destructor)));
+    T* object =
+        new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    // Registered after the construction, so that the objects created by the
+    // constructor of T are destroyed after it.
+    destructor->destroy = &Destroy<T>;
+    destructor->object = object;
+    destructor->next = destructors_;
+    destructors_ = destructor;
+    return object;
+  }
+
+  // Returns an array of |count| default initialized T, which must be trivially
+  // destructible.
+  template <typename T>
+  T* NewArray(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "the elements of arena arrays are not destroyed");
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "over-aligned types are not supported");
+    return new (Allocate(CheckMul(sizeof(T), count).ValueOrDie(), alignof(T)))
+        T[count];
+  }
+
+  // Destroys the objects created with New() and releases all the memory of the
+  // arena, except for one chunk which is kept for the next allocations.
+  void Reset();
+
+  // Returns the number of bytes obtained from malloc().
+  size_t bytes_reserved() const { return bytes_reserved_; }
+
+ private:
+  struct Chunk;
+
+  struct Destructor {
+    void (*destroy)(void* object);
+    void* object;
+    Destructor* next;
+  };
+
+  template <typename T>
+  static void Destroy(void* object) {
+    static_cast<T*>(object)->~T();
+  }
+
+  NOINLINE void* AllocateSlow(size_t size);
+
+  // Allocates an unlinked chunk holding |size| bytes.
+  Chunk* NewChunk(size_t size);
+
+  const size_t chunk_size_;
+
+  // The chunk allocations are bumped from is the head of the list. Chunks
+  // dedicated to large allocations are linked after it.
+  Chunk* chunks_ = nullptr;
+  uintptr_t next_ = 0;
+  uintptr_t end_ = 0;
+  size_t bytes_reserved_ = 0;
+
+  // The objects to destroy, most recent first.
+  Destructor* destructors_ = nullptr;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  DISALLOW_COPY_AND_ASSIGN(Arena);
+};
+
+// Allocator which lets STL containers allocate from an arena. Deallocation is
+// a no-op: the memory of a container is reclaimed when its arena is reset, so
+// containers which grow repeatedly are better reserved up front.
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "over-aligned types are not supported");
+    return static_cast<T*>(
+        arena_->Allocate(CheckMul(sizeof(T), n).ValueOrDie(), alignof(T)));
+  }
+  void deallocate(T* ptr, size_t n) {}
+
+  Arena* arena() const { return arena_; }
+
+ private:
+  Arena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return !(a == b);
+}
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_ARENA_H_
@@ -0,0 +1,129 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/arena.h"
+
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Appends its id to |destroyed| when destroyed.
+class Tracked {
+ public:
+  Tracked(int id, std::vector<int>* destroyed)
+      : id_(id), destroyed_(destroyed) {}
+  ~Tracked() { destroyed_->push_back(id_); }
+
+ private:
+  const int id_;
+  std::vector<int>* const destroyed_;
+
+  DISALLOW_COPY_AND_ASSIGN(Tracked);
+};
+
+bool IsAligned(void* ptr, size_t alignment) {
+  return !(reinterpret_cast<uintptr_t>(ptr) & (alignment - 1));
+}
+
+}  // namespace
+
+TEST(ArenaTest, Allocate) {
+  Arena arena(256);
+  char* a = static_cast<char*>(arena.Allocate(10, 1));
+  char* b = static_cast<char*>(arena.Allocate(10, 1));
+  // Consecutive allocations are bumped.
+  EXPECT_EQ(a + 10, b);
+  EXPECT_TRUE(IsAligned(arena.Allocate(1, 8), 8));
+  EXPECT_TRUE(IsAligned(arena.Allocate(1), alignof(std::max_align_t)));
+
+  // Overflows the first chunk.
+  for (int i = 0; i < 100; ++i)
+    memset(arena.Allocate(10, 1), 'a', 10);
+  EXPECT_GT(arena.bytes_reserved(), 256u * 4);
+
+  // Large allocations get their own chunk.
+  void* large = arena.Allocate(1000);
+  memset(large, 'b', 1000);
+  EXPECT_GT(arena.bytes_reserved(), 256u * 4 + 1000);
+}
+
+TEST(ArenaTest, ResetKeepsOneChunk) {
+  Arena arena(256);
+  for (int i = 0; i < 100; ++i)
+    arena.Allocate(10, 1);
+  arena.Allocate(1000);
+  arena.Reset();
+  size_t bytes_reserved = arena.bytes_reserved();
+  EXPECT_GE(bytes_reserved, 256u);
+  EXPECT_LT(bytes_reserved, 2 * 256u);
+
+  // The kept chunk is reused.
+  arena.Allocate(100);
+  EXPECT_EQ(bytes_reserved, arena.bytes_reserved());
+}
+
+TEST(ArenaTest, LargeAllocationFirst) {
+  Arena arena(256);
+  arena.Allocate(1000);
+  char* a = static_cast<char*>(arena.Allocate(10, 1));
+  char* b = static_cast<char*>(arena.Allocate(10, 1));
+  EXPECT_EQ(a + 10, b);
+  arena.Reset();
+  EXPECT_LT(arena.bytes_reserved(), 2 * 256u);
+}
+
+TEST(ArenaTest, NewDestroysInReverseOrder) {
+  std::vector<int> destroyed;
+  {
+    Arena arena(256);
+    for (int i = 0; i < 50; ++i)
+      arena.New<Tracked>(i, &destroyed);
+    int* trivial = arena.New<int>(42);
+    EXPECT_EQ(42, *trivial);
+    arena.Reset();
+    ASSERT_EQ(50u, destroyed.size());
+    for (int i = 0; i < 50; ++i)
+      EXPECT_EQ(49 - i, destroyed[i]);
+
+    destroyed.clear();
+    arena.New<Tracked>(1, &destroyed);
+  }
+  // Destroying the arena destroys its objects.
+  EXPECT_EQ(std::vector<int>({1}), destroyed);
+}
+
+TEST(ArenaTest, NewArray) {
+  Arena arena;
+  int* array = arena.NewArray<int>(100);
+  EXPECT_TRUE(IsAligned(array, alignof(int)));
+  for (int i = 0; i < 100; ++i)
+    array[i] = i;
+  EXPECT_EQ(99, array[99]);
+}
+
+TEST(ArenaTest, Allocator) {
+  Arena arena;
+  std::vector<int, ArenaAllocator<int>> vector{ArenaAllocator<int>(&arena)};
+  for (int i = 0; i < 1000; ++i)
+    vector.push_back(i);
+  EXPECT_EQ(999, vector.back());
+
+  using Map = std::map<int, int, std::less<int>,
+                       ArenaAllocator<std::pair<const int, int>>>;
+  Map map{ArenaAllocator<std::pair<const int, int>>(&arena)};
+  for (int i = 0; i < 100; ++i)
+    map[i] = i;
+  map.erase(50);
+  EXPECT_EQ(99u, map.size());
+  EXPECT_EQ(ArenaAllocator<int>(&arena), map.get_allocator());
+}
+
+}  // namespace base
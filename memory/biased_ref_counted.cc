@@ -0,0 +1,264 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/biased_ref_counted.h"
+
+#include <utility>
+#include <vector>
+
+#include "base/memory/ref_counted.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
+#include "build/build_config.h"
+
+namespace base {
+namespace subtle {
+
+class BiasedRefCountedThreadSafeBase::OwnerThread
+    : public RefCountedThreadSafe<OwnerThread> {
+ public:
+  OwnerThread() = default;
+
+  // Returns the OwnerThread of the current thread, with a reference for the
+  // caller. Processes its queue, if it already existed.
+  static OwnerThread* GetOrCreateForCurrentThread();
+
+  // Queues |object|, with a reference to release with |destruct|. If the
+  // thread exited, processes it right away instead.
+  void Enqueue(const BiasedRefCountedThreadSafeBase* object,
+               DestructFunction destruct);
+
+  // Processes the queued objects. Called on the thread.
+  void ProcessQueue();
+
+  // Stops queuing objects, and processes those already queued. Called on the
+  // thread when it exits.
+  void OnThreadExit();
+
+ private:
+  friend class RefCountedThreadSafe<OwnerThread>;
+
+  using QueuedRelease =
+      std::pair<const BiasedRefCountedThreadSafeBase*, DestructFunction>;
+
+  ~OwnerThread() { DCHECK(queue_.empty()); }
+
+  Lock lock_;
+  bool exited_ = false;
+  std::vector<QueuedRelease> queue_;
+  // Whether |queue_| may not be empty, checked without |lock_|.
+  std::atomic<bool> has_queue_{false};
+
+  DISALLOW_COPY_AND_ASSIGN(OwnerThread);
+};
+
+namespace {
+
+using OwnerThread = BiasedRefCountedThreadSafeBase::OwnerThread;
+
+ThreadLocalStorage::Slot& GetOwnerThreadTLS() {
+  static NoDestructor<ThreadLocalStorage::Slot> owner_thread_tls(
+      [](void* owner_thread) {
+        static_cast<OwnerThread*>(owner_thread)->OnThreadExit();
+      });
+  return *owner_thread_tls;
+}
+
+#if defined(OS_LINUX)
+// A copy of the slot above, which is checked on each AddRef() and Release().
+// The initial-exec model makes it a fixed offset from the thread pointer,
+// unlike the ThreadLocalStorage lookup.
+__attribute__((tls_model("initial-exec"))) thread_local OwnerThread*
+    g_current_owner_thread = nullptr;
+
+void SetCurrentOwnerThread(OwnerThread* owner_thread) {
+  g_current_owner_thread = owner_thread;
+  GetOwnerThreadTLS().Set(owner_thread);
+}
+#else
+void SetCurrentOwnerThread(OwnerThread* owner_thread) {
+  GetOwnerThreadTLS().Set(owner_thread);
+}
+#endif
+
+}  // namespace
+
+// static
+OwnerThread* OwnerThread::GetOrCreateForCurrentThread() {
+  OwnerThread* owner_thread =
+      static_cast<OwnerThread*>(GetOwnerThreadTLS().Get());
+  if (owner_thread) {
+    owner_thread->ProcessQueue();
+  } else {
+    owner_thread = new OwnerThread;
+    // Released by OnThreadExit().
+    owner_thread->AddRef();
+    SetCurrentOwnerThread(owner_thread);
+  }
+  owner_thread->AddRef();
+  return owner_thread;
+}
+
+void OwnerThread::Enqueue(const BiasedRefCountedThreadSafeBase* object,
+                          DestructFunction destruct) {
+  {
+    AutoLock lock(lock_);
+    if (!exited_) {
+      queue_.emplace_back(object, destruct);
+      has_queue_.store(true, std::memory_order_relaxed);
+      return;
+    }
+  }
+  ProcessQueuedRelease(object, destruct);
+}
+
+void OwnerThread::ProcessQueue() {
+  if (!has_queue_.load(std::memory_order_relaxed))
+    return;
+  std::vector<QueuedRelease> queue;
+  {
+    AutoLock lock(lock_);
+    queue.swap(queue_);
+    has_queue_.store(false, std::memory_order_relaxed);
+  }
+  for (const QueuedRelease& queued_release : queue)
+    ProcessQueuedRelease(queued_release.first, queued_release.second);
+}
+
+void OwnerThread::OnThreadExit() {
+  // The objects this thread created are now treated as if they were created
+  // by another thread, until their counts are merged.
+#if defined(OS_LINUX)
+  g_current_owner_thread = nullptr;
+#endif
+  std::vector<QueuedRelease> queue;
+  {
+    AutoLock lock(lock_);
+    exited_ = true;
+    queue.swap(queue_);
+    has_queue_.store(false, std::memory_order_relaxed);
+  }
+  for (const QueuedRelease& queued_release : queue)
+    ProcessQueuedRelease(queued_release.first, queued_release.second);
+  Release();
+}
+
+// static
+constexpr intptr_t BiasedRefCountedThreadSafeBase::kMerged;
+// static
+constexpr intptr_t BiasedRefCountedThreadSafeBase::kQueued;
+// static
+constexpr intptr_t BiasedRefCountedThreadSafeBase::kFlagsMask;
+// static
+constexpr intptr_t BiasedRefCountedThreadSafeBase::kOne;
+
+BiasedRefCountedThreadSafeBase::BiasedRefCountedThreadSafeBase(
+    StartRefCountFromOneTag)
+    : owner_(OwnerThread::GetOrCreateForCurrentThread()) {}
+
+BiasedRefCountedThreadSafeBase::~BiasedRefCountedThreadSafeBase() {
+#if DCHECK_IS_ON()
+  DCHECK(in_dtor_) << "BiasedRefCountedThreadSafe object deleted without "
+                      "calling Release()";
+#endif
+  owner_->Release();
+}
+
+bool BiasedRefCountedThreadSafeBase::HasOneRef() const {
+  if (IsBiased()) {
+    // This object may be queued with a reference.
+    owner_->ProcessQueue();
+    if (!merged_) {
+      return biased_count_ +
+                 Count(shared_count_.load(std::memory_order_acquire)) ==
+             1;
+    }
+  }
+  const intptr_t shared_count = shared_count_.load(std::memory_order_acquire);
+  return (shared_count & kMerged) && Count(shared_count) == 1;
+}
+
+// static
+const OwnerThread* BiasedRefCountedThreadSafeBase::GetCurrentOwnerThread() {
+#if defined(OS_LINUX)
+  return g_current_owner_thread;
+#else
+  return static_cast<OwnerThread*>(GetOwnerThreadTLS().Get());
+#endif
+}
+
+bool BiasedRefCountedThreadSafeBase::MergeBiasedCount() const {
+  DCHECK(!merged_);
+  const intptr_t biased_count = biased_count_;
+  biased_count_ = 0;
+  merged_ = true;
+  // Publishes the changes made to the object along with the biased count, and
+  // acquires those of the other threads in case the object is deleted.
+  const intptr_t shared_count = shared_count_.fetch_add(
+      biased_count * kOne + kMerged, std::memory_order_acq_rel);
+  DCHECK(!(shared_count & kMerged));
+  return Count(shared_count) + biased_count == 0;
+}
+
+bool BiasedRefCountedThreadSafeBase::ReleaseBiased() const {
+  // If this object is queued, this merges its counts, so that its last
+  // reference isn't left in the queue. This doesn't delete it, as the caller
+  // holds a reference.
+  owner_->ProcessQueue();
+  if (merged_)
+    return ReleaseMerged();
+  if (--biased_count_ > 0)
+    return false;
+  return MergeBiasedCount();
+}
+
+bool BiasedRefCountedThreadSafeBase::ReleaseShared(
+    DestructFunction destruct) const {
+  intptr_t shared_count = shared_count_.load(std::memory_order_relaxed);
+  while (!(shared_count & kMerged)) {
+    // Until the counts are merged, the owner holds a reference or this object
+    // is queued with one, so this can't be the last reference.
+    if ((shared_count & kQueued) || Count(shared_count) > 0) {
+      if (shared_count_.compare_exchange_weak(shared_count,
+                                              shared_count - kOne,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        return false;
+      }
+      continue;
+    }
+    // Only the owner can tell whether this is the last reference: hand it
+    // over, instead of making the shared count negative.
+    if (shared_count_.compare_exchange_weak(shared_count,
+                                            shared_count | kQueued,
+                                            std::memory_order_relaxed)) {
+      owner_->Enqueue(this, destruct);
+      return false;
+    }
+  }
+  // Merging is final, so the shared count is now the whole count.
+  return ReleaseMerged();
+}
+
+// static
+void BiasedRefCountedThreadSafeBase::ProcessQueuedRelease(
+    const BiasedRefCountedThreadSafeBase* object,
+    DestructFunction destruct) {
+  // The owner may have merged the counts since |object| was queued. Either
+  // way, the queued reference is still counted, so this doesn't delete it.
+  if (!object->merged_) {
+    const bool should_delete = object->MergeBiasedCount();
+    DCHECK(!should_delete);
+  }
+  if (object->ReleaseMerged()) {
+#if DCHECK_IS_ON()
+    object->in_dtor_ = true;
+#endif
+    destruct(object);
+  }
+}
+
+}  // namespace subtle
+}  // namespace base
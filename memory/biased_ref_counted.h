@@ -0,0 +1,231 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_BIASED_REF_COUNTED_H_
+#define BASE_MEMORY_BIASED_REF_COUNTED_H_
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "base/base_export.h"
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/scoped_refptr.h"
+
+namespace base {
+namespace subtle {
+
+// The reference count of BiasedRefCountedThreadSafe, see below.
+//
+// The count is split in two: a biased count, only used by the thread which
+// created the object (its owner) with plain increments and decrements, and a
+// shared count, used by the other threads with atomic operations. The object
+// is deleted once their sum is zero, which the owner finds out by merging
+// its biased count into the shared count when the former drops to zero.
+// Afterwards, all the threads use the shared count.
+//
+// The shared count may go negative when the references taken by the owner
+// are released by other threads. Then, only the owner knows whether the
+// object is still referenced, so the first thread to make the shared count
+// negative queues the object on the owner, along with the reference it is
+// releasing. The owner merges the queued objects and releases the queued
+// references before it releases a reference to any object, when it creates
+// one, and when it exits. An object released by other threads may thus be
+// deleted some time after its last reference is gone, if its owner is idle.
+class BASE_EXPORT BiasedRefCountedThreadSafeBase {
+ public:
+  // A thread owning objects, with the queue of the objects released by other
+  // threads which it needs to merge.
+  class OwnerThread;
+
+  // Returns true if there is a single reference to the object. The answer is
+  // only exact on the owner, or once the counts are merged: on another thread,
+  // it may be false when there is in fact a single reference.
+  bool HasOneRef() const;
+
+ protected:
+  // Deletes an object whose last reference is released when its owner
+  // processes its queue.
+  using DestructFunction = void (*)(const BiasedRefCountedThreadSafeBase*);
+
+  // The reference count starts from one, for the reference of the owner.
+  explicit BiasedRefCountedThreadSafeBase(StartRefCountFromOneTag);
+  ~BiasedRefCountedThreadSafeBase();
+
+  void AddRef() const {
+#if DCHECK_IS_ON()
+    DCHECK(!in_dtor_);
+    DCHECK(!needs_adopt_ref_)
+        << "The first reference to a BiasedRefCountedThreadSafe object has to "
+        << "be made by AdoptRef or MakeRefCounted.";
+#endif
+    if (IsBiased()) {
+      ++biased_count_;
+      return;
+    }
+    shared_count_.fetch_add(kOne, std::memory_order_relaxed);
+  }
+
+  // Returns true if the object should self-delete. |destruct| deletes it if
+  // it's queued on its owner.
+  bool Release(DestructFunction destruct) const {
+#if DCHECK_IS_ON()
+    DCHECK(!in_dtor_);
+#endif
+    bool should_delete;
+    if (IsBiased())
+      should_delete = ReleaseBiased();
+    else
+      should_delete = ReleaseShared(destruct);
+#if DCHECK_IS_ON()
+    if (should_delete)
+      in_dtor_ = true;
+#endif
+    return should_delete;
+  }
+
+ private:
+  template <typename U>
+  friend scoped_refptr<U> base::AdoptRef(U*);
+
+  // The low bits of |shared_count_| are flags, and the count is in the others.
+  static constexpr intptr_t kMerged = 1;
+  static constexpr intptr_t kQueued = 2;
+  static constexpr intptr_t kFlagsMask = kMerged | kQueued;
+  static constexpr intptr_t kOne = 4;
+
+  static intptr_t Count(intptr_t shared_count) {
+    return (shared_count & ~kFlagsMask) / kOne;
+  }
+
+  void Adopted() const {
+#if DCHECK_IS_ON()
+    DCHECK(needs_adopt_ref_);
+    needs_adopt_ref_ = false;
+#endif
+  }
+
+  // Returns true on the owner, until the counts are merged.
+  bool IsBiased() const {
+    return owner_ == GetCurrentOwnerThread() && !merged_;
+  }
+
+  static const OwnerThread* GetCurrentOwnerThread();
+
+  // Merges the biased count into the shared count. Called on the owner, or
+  // on any thread once the owner exited. Returns true if the object should
+  // self-delete.
+  bool MergeBiasedCount() const;
+
+  // Releases a reference on the owner, after processing its queue. Returns
+  // true if the object should self-delete.
+  bool ReleaseBiased() const;
+
+  // Releases a reference from another thread than the owner, or after the
+  // counts were merged. Returns true if the object should self-delete.
+  bool ReleaseShared(DestructFunction destruct) const;
+
+  // Releases a reference once the counts were merged. Returns true if the
+  // object should self-delete.
+  bool ReleaseMerged() const {
+    return Count(shared_count_.fetch_sub(kOne, std::memory_order_acq_rel)) ==
+           1;
+  }
+
+  // Merges the counts of an object queued by ReleaseShared(), and releases
+  // the reference which came with it. Called like MergeBiasedCount().
+  static void ProcessQueuedRelease(const BiasedRefCountedThreadSafeBase* object,
+                                   DestructFunction destruct);
+
+  // Owns a reference to the OwnerThread, released on destruction.
+  OwnerThread* const owner_;
+  mutable std::atomic<intptr_t> shared_count_{0};
+  // Only used on |owner_|, or once it exited.
+  mutable intptr_t biased_count_ = 1;
+  mutable bool merged_ = false;
+#if DCHECK_IS_ON()
+  mutable bool needs_adopt_ref_ = true;
+  mutable bool in_dtor_ = false;
+#endif
+
+  DISALLOW_COPY_AND_ASSIGN(BiasedRefCountedThreadSafeBase);
+};
+
+}  // namespace subtle
+
+template <class T, typename Traits>
+class BiasedRefCountedThreadSafe;
+
+// Default traits for BiasedRefCountedThreadSafe<T>. Deletes the object when
+// its ref count reaches 0.
+template <typename T>
+struct DefaultBiasedRefCountedThreadSafeTraits {
+  static void Destruct(const T* x) {
+    BiasedRefCountedThreadSafe<
+        T, DefaultBiasedRefCountedThreadSafeTraits>::DeleteInternal(x);
+  }
+};
+
+// A variant of RefCountedThreadSafe<T> for objects which are referenced
+// mostly by the thread which created them, but also by others, such as task
+// runners. With RefCountedThreadSafe, each AddRef() and Release() is an
+// atomic operation on the cache line of the count, which bounces between the
+// cores of the threads using the object. Here, the thread which created the
+// object updates the count without atomic operations, and only the other
+// threads pay for them. See BiasedRefCountedThreadSafeBase for the details.
+//
+//   class MyFoo : public base::BiasedRefCountedThreadSafe<MyFoo> {
+//    ...
+//    private:
+//     friend class base::BiasedRefCountedThreadSafe<MyFoo>;
+//     ~MyFoo();
+//   };
+//
+//   scoped_refptr<MyFoo> foo = base::MakeRefCounted<MyFoo>();
+//
+// The reference count always starts from one, so the objects must be created
+// with MakeRefCounted() or AdoptRef().
+template <class T,
+          typename Traits = DefaultBiasedRefCountedThreadSafeTraits<T>>
+class BiasedRefCountedThreadSafe
+    : public subtle::BiasedRefCountedThreadSafeBase {
+ public:
+  static constexpr subtle::StartRefCountFromOneTag kRefCountPreference =
+      subtle::kStartRefCountFromOneTag;
+
+  BiasedRefCountedThreadSafe()
+      : subtle::BiasedRefCountedThreadSafeBase(T::kRefCountPreference) {}
+
+  void AddRef() const { subtle::BiasedRefCountedThreadSafeBase::AddRef(); }
+
+  void Release() const {
+    if (subtle::BiasedRefCountedThreadSafeBase::Release(&DestructBase)) {
+      ANALYZER_SKIP_THIS_PATH();
+      Traits::Destruct(static_cast<const T*>(this));
+    }
+  }
+
+ protected:
+  ~BiasedRefCountedThreadSafe() = default;
+
+ private:
+  friend struct DefaultBiasedRefCountedThreadSafeTraits<T>;
+  template <typename U>
+  static void DeleteInternal(const U* x) {
+    delete x;
+  }
+
+  static void DestructBase(const subtle::BiasedRefCountedThreadSafeBase* x) {
+    Traits::Destruct(static_cast<const T*>(
+        static_cast<const BiasedRefCountedThreadSafe*>(x)));
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(BiasedRefCountedThreadSafe);
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_BIASED_REF_COUNTED_H_
@@ -0,0 +1,144 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/biased_ref_counted.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class Biased : public BiasedRefCountedThreadSafe<Biased> {
+ public:
+  explicit Biased(std::atomic<int>* destructions)
+      : destructions_(destructions) {}
+
+ private:
+  friend class BiasedRefCountedThreadSafe<Biased>;
+  ~Biased() { ++*destructions_; }
+
+  std::atomic<int>* const destructions_;
+};
+
+class ClosureThread : public SimpleThread {
+ public:
+  explicit ClosureThread(OnceClosure closure)
+      : SimpleThread("BiasedRefCountedTest"), closure_(std::move(closure)) {}
+
+  void Run() override { std::move(closure_).Run(); }
+
+ private:
+  OnceClosure closure_;
+
+  DISALLOW_COPY_AND_ASSIGN(ClosureThread);
+};
+
+// Runs |closure| on a new thread, which exits before this returns.
+void RunOnOtherThread(OnceClosure closure) {
+  ClosureThread thread(std::move(closure));
+  thread.Start();
+  thread.Join();
+}
+
+void Drop(scoped_refptr<Biased> biased) {}
+
+}  // namespace
+
+TEST(BiasedRefCountedTest, OwnerOnly) {
+  std::atomic<int> destructions{0};
+  scoped_refptr<Biased> biased = MakeRefCounted<Biased>(&destructions);
+  EXPECT_TRUE(biased->HasOneRef());
+  {
+    scoped_refptr<Biased> copy = biased;
+    EXPECT_FALSE(biased->HasOneRef());
+  }
+  EXPECT_TRUE(biased->HasOneRef());
+  biased = nullptr;
+  EXPECT_EQ(1, destructions);
+}
+
+TEST(BiasedRefCountedTest, CopiedByOtherThread) {
+  std::atomic<int> destructions{0};
+  scoped_refptr<Biased> biased = MakeRefCounted<Biased>(&destructions);
+  RunOnOtherThread(BindOnce(
+      [](scoped_refptr<Biased> biased) {
+        scoped_refptr<Biased> copy = biased;
+        EXPECT_FALSE(biased->HasOneRef());
+      },
+      biased));
+  EXPECT_TRUE(biased->HasOneRef());
+  EXPECT_EQ(0, destructions);
+  biased = nullptr;
+  EXPECT_EQ(1, destructions);
+}
+
+TEST(BiasedRefCountedTest, LastReferenceReleasedByOtherThread) {
+  std::atomic<int> destructions{0};
+  scoped_refptr<Biased> biased = MakeRefCounted<Biased>(&destructions);
+  RunOnOtherThread(BindOnce(&Drop, std::move(biased)));
+  // The object is queued on this thread, which hasn't processed its queue.
+  EXPECT_EQ(0, destructions);
+
+  // Creating another object processes it.
+  std::atomic<int> other_destructions{0};
+  scoped_refptr<Biased> other = MakeRefCounted<Biased>(&other_destructions);
+  EXPECT_EQ(1, destructions);
+  EXPECT_EQ(0, other_destructions);
+}
+
+TEST(BiasedRefCountedTest, ReleasedAfterOwnerExited) {
+  std::atomic<int> destructions{0};
+  scoped_refptr<Biased> biased;
+  RunOnOtherThread(BindOnce(
+      [](std::atomic<int>* destructions, scoped_refptr<Biased>* biased) {
+        *biased = MakeRefCounted<Biased>(destructions);
+      },
+      &destructions, &biased));
+  scoped_refptr<Biased> copy = biased;
+  biased = nullptr;
+  EXPECT_EQ(0, destructions);
+  copy = nullptr;
+  EXPECT_EQ(1, destructions);
+}
+
+TEST(BiasedRefCountedTest, ConcurrentCopies) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumCopies = 10000;
+  std::atomic<int> destructions{0};
+  scoped_refptr<Biased> biased = MakeRefCounted<Biased>(&destructions);
+
+  auto copy_many = [](scoped_refptr<Biased> biased) {
+    std::vector<scoped_refptr<Biased>> copies;
+    for (int i = 0; i < kNumCopies; ++i)
+      copies.push_back(biased);
+  };
+  std::vector<std::unique_ptr<ClosureThread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(
+        std::make_unique<ClosureThread>(BindOnce(copy_many, biased)));
+    threads.back()->Start();
+  }
+  copy_many(biased);
+  biased = nullptr;
+  for (auto& thread : threads)
+    thread->Join();
+
+  // Whether this thread or another released the last reference, the object
+  // is deleted once this thread processes its queue.
+  std::atomic<int> other_destructions{0};
+  MakeRefCounted<Biased>(&other_destructions);
+  EXPECT_EQ(1, destructions);
+}
+
+}  // namespace base
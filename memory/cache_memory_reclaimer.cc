@@ -0,0 +1,134 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/cache_memory_reclaimer.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/process/process_metrics.h"
+#include "base/stl_util.h"
+#include "build/build_config.h"
+
+namespace base {
+
+CacheMemoryReclaimer::CacheMemoryReclaimer(const Options& options)
+    : options_(options),
+      memory_pressure_listener_(
+          BindRepeating(&CacheMemoryReclaimer::OnMemoryPressure,
+                        Unretained(this))) {
+  DCHECK_GT(options_.step_size, 0u);
+#if !defined(OS_LINUX) && !defined(OS_ANDROID)
+  DCHECK(options_.get_resident_set_size);
+#endif
+}
+
+CacheMemoryReclaimer::~CacheMemoryReclaimer() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+}
+
+void CacheMemoryReclaimer::AddCache(ReclaimableCache* cache) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!is_reclaiming_);
+  DCHECK(!ContainsValue(caches_, cache));
+  caches_.push_back(cache);
+}
+
+void CacheMemoryReclaimer::RemoveCache(ReclaimableCache* cache) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!is_reclaiming_);
+  auto it = std::find(caches_.begin(), caches_.end(), cache);
+  DCHECK(it != caches_.end());
+  caches_.erase(it);
+}
+
+size_t CacheMemoryReclaimer::ReclaimToward(size_t target_resident_set_size) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  const size_t resident_set_size = GetResidentSetSize();
+  if (resident_set_size <= target_resident_set_size)
+    return 0;
+  // The resident set size isn't measured again between the steps, since the
+  // allocator may hold on to the memory freed by the caches for a while.
+  return Reclaim(resident_set_size - target_resident_set_size);
+}
+
+size_t CacheMemoryReclaimer::Reclaim(size_t bytes) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!is_reclaiming_);
+  is_reclaiming_ = true;
+
+  const TimeTicks now = TimeTicks::Now();
+  // The caches which failed to free anything are left out of the next steps.
+  std::vector<bool> exhausted(caches_.size());
+  size_t reclaimed = 0;
+  while (reclaimed < bytes) {
+    // Find the cache whose memory is worth the least per byte.
+    size_t best_index = caches_.size();
+    double best_value = 0;
+    size_t best_reclaimable_bytes = 0;
+    for (size_t i = 0; i < caches_.size(); ++i) {
+      if (exhausted[i])
+        continue;
+      const ReclaimableCache::Estimate estimate =
+          caches_[i]->GetReclaimEstimate();
+      if (estimate.reclaimable_bytes == 0)
+        continue;
+      const TimeDelta age = std::max(now - estimate.last_use_time, TimeDelta());
+      const double value =
+          estimate.rebuild_cost_per_byte *
+          exp2(-age.InSecondsF() / options_.recency_half_life.InSecondsF());
+      if (best_index == caches_.size() || value < best_value) {
+        best_index = i;
+        best_value = value;
+        best_reclaimable_bytes = estimate.reclaimable_bytes;
+      }
+    }
+    if (best_index == caches_.size())
+      break;
+
+    const size_t step_size = std::min(
+        {options_.step_size, bytes - reclaimed, best_reclaimable_bytes});
+    const size_t freed = caches_[best_index]->Reclaim(step_size);
+    if (freed == 0)
+      exhausted[best_index] = true;
+    reclaimed += freed;
+  }
+
+  is_reclaiming_ = false;
+  return reclaimed;
+}
+
+void CacheMemoryReclaimer::OnMemoryPressure(
+    MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  double fraction;
+  switch (memory_pressure_level) {
+    case MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE:
+      return;
+    case MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE:
+      fraction = options_.moderate_pressure_fraction;
+      break;
+    case MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL:
+      fraction = options_.critical_pressure_fraction;
+      break;
+  }
+  Reclaim(static_cast<size_t>(GetResidentSetSize() * fraction));
+}
+
+size_t CacheMemoryReclaimer::GetResidentSetSize() const {
+  if (options_.get_resident_set_size)
+    return options_.get_resident_set_size.Run();
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  return ProcessMetrics::CreateCurrentProcessMetrics()->GetResidentSetSize();
+#else
+  NOTREACHED();
+  return 0;
+#endif
+}
+
+}  // namespace base
@@ -0,0 +1,108 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_CACHE_MEMORY_RECLAIMER_H_
+#define BASE_MEMORY_CACHE_MEMORY_RECLAIMER_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/sequence_checker.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// A cache which gives memory back to a CacheMemoryReclaimer piece by piece,
+// least valuable first.
+class BASE_EXPORT ReclaimableCache {
+ public:
+  // What the cache could free, and what it would cost.
+  struct Estimate {
+    // The number of bytes the cache could free.
+    size_t reclaimable_bytes = 0;
+    // The last use of the least recently used of these bytes.
+    TimeTicks last_use_time;
+    // The cost of rebuilding a byte once it's freed, in units shared by all
+    // the caches of the reclaimer, e.g. nanoseconds of CPU time.
+    double rebuild_cost_per_byte = 1.0;
+  };
+
+  // Called before each step of a reclaim, so it should be cheap.
+  virtual Estimate GetReclaimEstimate() const = 0;
+
+  // Frees about |bytes| of the least valuable memory of the cache. Returns the
+  // number of bytes freed.
+  virtual size_t Reclaim(size_t bytes) = 0;
+
+ protected:
+  virtual ~ReclaimableCache() = default;
+};
+
+// Reclaims memory from caches incrementally when the process has to shrink,
+// rather than letting each cache drop everything: each step frees a little of
+// the cache which loses the least from it, until the resident set size of the
+// process gets down to a target. The memory of a cache is worth its rebuild
+// cost, discounted by how long ago it was used.
+//
+// On memory pressure, the target is a fraction of the current resident set
+// size, which depends on the level of pressure.
+//
+// This class and the caches must be used on a single sequence.
+class BASE_EXPORT CacheMemoryReclaimer {
+ public:
+  struct Options {
+    // The maximum number of bytes freed in a step.
+    size_t step_size = 256 * 1024;
+    // The fractions of the resident set size reclaimed on moderate and
+    // critical memory pressure.
+    double moderate_pressure_fraction = 0.1;
+    double critical_pressure_fraction = 0.3;
+    // How long a byte goes unused for its value to halve.
+    TimeDelta recency_half_life = TimeDelta::FromMinutes(1);
+    // Returns the resident set size of the process. Defaults to
+    // ProcessMetrics::GetResidentSetSize() on Linux and Android, and must be
+    // set elsewhere.
+    RepeatingCallback<size_t()> get_resident_set_size;
+  };
+
+  explicit CacheMemoryReclaimer(const Options& options);
+  ~CacheMemoryReclaimer();
+
+  // |cache| must be removed before it's destroyed.
+  void AddCache(ReclaimableCache* cache);
+  void RemoveCache(ReclaimableCache* cache);
+
+  // Reclaims memory until the resident set size of the process is down to
+  // |target_resident_set_size|, or the caches have nothing left to free.
+  // Returns the number of bytes freed.
+  size_t ReclaimToward(size_t target_resident_set_size);
+
+  // Reclaims |bytes| from the caches, or as much as they can free. Returns the
+  // number of bytes freed.
+  size_t Reclaim(size_t bytes);
+
+ private:
+  void OnMemoryPressure(
+      MemoryPressureListener::MemoryPressureLevel memory_pressure_level);
+
+  size_t GetResidentSetSize() const;
+
+  const Options options_;
+  std::vector<ReclaimableCache*> caches_;
+  bool is_reclaiming_ = false;
+  MemoryPressureListener memory_pressure_listener_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  DISALLOW_COPY_AND_ASSIGN(CacheMemoryReclaimer);
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_CACHE_MEMORY_RECLAIMER_H_
@@ -0,0 +1,141 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/cache_memory_reclaimer.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/run_loop.h"
+#include "base/test/scoped_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kKB = 1024;
+
+class FakeCache : public ReclaimableCache {
+ public:
+  FakeCache(size_t size, double rebuild_cost_per_byte, TimeDelta age)
+      : size_(size),
+        rebuild_cost_per_byte_(rebuild_cost_per_byte),
+        last_use_time_(TimeTicks::Now() - age) {}
+
+  size_t size() const { return size_; }
+
+  // ReclaimableCache:
+  Estimate GetReclaimEstimate() const override {
+    Estimate estimate;
+    estimate.reclaimable_bytes = size_;
+    estimate.last_use_time = last_use_time_;
+    estimate.rebuild_cost_per_byte = rebuild_cost_per_byte_;
+    return estimate;
+  }
+
+  size_t Reclaim(size_t bytes) override {
+    const size_t freed = std::min(bytes, size_);
+    size_ -= freed;
+    return freed;
+  }
+
+ private:
+  size_t size_;
+  const double rebuild_cost_per_byte_;
+  const TimeTicks last_use_time_;
+};
+
+class CacheMemoryReclaimerTest : public testing::Test {
+ protected:
+  CacheMemoryReclaimerTest() {
+    options_.step_size = 64 * kKB;
+    options_.get_resident_set_size = BindRepeating(
+        [](const size_t* resident_set_size) { return *resident_set_size; },
+        Unretained(&resident_set_size_));
+  }
+
+  test::ScopedTaskEnvironment scoped_task_environment_;
+  CacheMemoryReclaimer::Options options_;
+  size_t resident_set_size_ = 0;
+};
+
+}  // namespace
+
+TEST_F(CacheMemoryReclaimerTest, ReclaimsCheapestMemoryFirst) {
+  CacheMemoryReclaimer reclaimer(options_);
+  FakeCache cheap_cache(256 * kKB, 1, TimeDelta());
+  FakeCache expensive_cache(256 * kKB, 10, TimeDelta());
+  reclaimer.AddCache(&expensive_cache);
+  reclaimer.AddCache(&cheap_cache);
+
+  EXPECT_EQ(128 * kKB, reclaimer.Reclaim(128 * kKB));
+  EXPECT_EQ(128 * kKB, cheap_cache.size());
+  EXPECT_EQ(256 * kKB, expensive_cache.size());
+
+  // Once the cheap cache is empty, the expensive one gives its memory.
+  EXPECT_EQ(192 * kKB, reclaimer.Reclaim(192 * kKB));
+  EXPECT_EQ(0u, cheap_cache.size());
+  EXPECT_EQ(192 * kKB, expensive_cache.size());
+
+  // Reclaiming stops when the caches are empty.
+  EXPECT_EQ(192 * kKB, reclaimer.Reclaim(1024 * kKB));
+  EXPECT_EQ(0u, expensive_cache.size());
+
+  reclaimer.RemoveCache(&expensive_cache);
+  reclaimer.RemoveCache(&cheap_cache);
+}
+
+TEST_F(CacheMemoryReclaimerTest, DiscountsMemoryUnusedForLong) {
+  options_.recency_half_life = TimeDelta::FromMinutes(1);
+  CacheMemoryReclaimer reclaimer(options_);
+  // Unused for 3 half-lives, the memory of |stale_cache| is worth 1/8th of
+  // its rebuild cost.
+  FakeCache stale_cache(256 * kKB, 4, TimeDelta::FromMinutes(3));
+  FakeCache fresh_cache(256 * kKB, 1, TimeDelta());
+  reclaimer.AddCache(&fresh_cache);
+  reclaimer.AddCache(&stale_cache);
+
+  EXPECT_EQ(128 * kKB, reclaimer.Reclaim(128 * kKB));
+  EXPECT_EQ(128 * kKB, stale_cache.size());
+  EXPECT_EQ(256 * kKB, fresh_cache.size());
+
+  reclaimer.RemoveCache(&fresh_cache);
+  reclaimer.RemoveCache(&stale_cache);
+}
+
+TEST_F(CacheMemoryReclaimerTest, ReclaimToward) {
+  CacheMemoryReclaimer reclaimer(options_);
+  FakeCache cache(1024 * kKB, 1, TimeDelta());
+  reclaimer.AddCache(&cache);
+
+  resident_set_size_ = 4096 * kKB;
+  EXPECT_EQ(0u, reclaimer.ReclaimToward(8192 * kKB));
+  EXPECT_EQ(256 * kKB, reclaimer.ReclaimToward(3840 * kKB));
+  EXPECT_EQ(768 * kKB, cache.size());
+
+  reclaimer.RemoveCache(&cache);
+}
+
+TEST_F(CacheMemoryReclaimerTest, MemoryPressure) {
+  CacheMemoryReclaimer reclaimer(options_);
+  FakeCache cache(4096 * kKB, 1, TimeDelta());
+  reclaimer.AddCache(&cache);
+  resident_set_size_ = 10240 * kKB;
+
+  // 10% of the resident set size is reclaimed on moderate pressure, and 30%
+  // on critical pressure.
+  MemoryPressureListener::NotifyMemoryPressure(
+      MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE);
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(3072 * kKB, cache.size());
+  MemoryPressureListener::NotifyMemoryPressure(
+      MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL);
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(0u, cache.size());
+
+  reclaimer.RemoveCache(&cache);
+}
+
+}  // namespace base
@@ -0,0 +1,319 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/in_process_discardable_memory_allocator.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/bits.h"
+#include "base/logging.h"
+#include "base/memory/discardable_memory.h"
+#include "base/memory/free_deleter.h"
+#include "base/process/memory.h"
+#include "base/trace_event/memory_allocator_dump.h"
+#include "base/trace_event/process_memory_dump.h"
+
+namespace base {
+
+namespace {
+
+// The alignment of the memory allocated in a segment.
+constexpr size_t kAlignment = 16;
+
+}  // namespace
+
+// A block of memory holding the memory of one or more DiscardableMemory, which
+// are purged together. Its state is an atomic count of the locked memory in
+// it, with a bit set once it's purged, so that locking and purging race
+// safely without a lock.
+class InProcessDiscardableMemoryAllocator::Segment {
+ public:
+  Segment(std::unique_ptr<uint8_t, FreeDeleter> memory,
+          size_t size,
+          uint64_t use_time)
+      : memory_(std::move(memory)), size_(size), last_use_time_(use_time) {}
+
+  ~Segment() { DCHECK_EQ(0u, state_.load() & ~kPurged); }
+
+  uint8_t* memory() const { return memory_.get(); }
+  size_t size() const { return size_; }
+
+  uint64_t last_use_time() const {
+    return last_use_time_.load(std::memory_order_relaxed);
+  }
+
+  bool IsPurged() const {
+    return state_.load(std::memory_order_relaxed) & kPurged;
+  }
+
+  // Locks a memory in the segment. Returns false if the segment is purged.
+  bool Lock() {
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    do {
+      if (state & kPurged)
+        return false;
+    } while (!state_.compare_exchange_weak(state, state + 1,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed));
+    return true;
+  }
+
+  void Unlock(uint64_t use_time) {
+    last_use_time_.store(use_time, std::memory_order_relaxed);
+    const uint32_t previous_state =
+        state_.fetch_sub(1, std::memory_order_release);
+    DCHECK_GT(previous_state, 0u);
+  }
+
+  // Purges the segment unless memory in it is locked. Returns true if it was
+  // purged.
+  bool TryPurge() {
+    uint32_t state = 0;
+    if (!state_.compare_exchange_strong(state, kPurged,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+      return false;
+    }
+    memory_.reset();
+    return true;
+  }
+
+  // The bytes of the segment handed out, and the number of memory living in
+  // it, guarded by the lock of the allocator.
+  size_t used_size = 0;
+  size_t num_memories = 0;
+
+ private:
+  static constexpr uint32_t kPurged = 1u << 31;
+
+  std::unique_ptr<uint8_t, FreeDeleter> memory_;
+  const size_t size_;
+  std::atomic<uint64_t> last_use_time_;
+  std::atomic<uint32_t> state_{0};
+
+  DISALLOW_COPY_AND_ASSIGN(Segment);
+};
+
+class InProcessDiscardableMemoryAllocator::Memory : public DiscardableMemory {
+ public:
+  Memory(InProcessDiscardableMemoryAllocator* allocator,
+         Segment* segment,
+         size_t offset,
+         size_t size)
+      : allocator_(allocator),
+        segment_(segment),
+        offset_(offset),
+        size_(size) {}
+
+  ~Memory() override {
+    if (is_locked_)
+      Unlock();
+    allocator_->ReleaseMemory(segment_);
+  }
+
+  // DiscardableMemory:
+  bool Lock() override {
+    DCHECK(!is_locked_);
+    is_locked_ = segment_->Lock();
+    return is_locked_;
+  }
+
+  void Unlock() override {
+    DCHECK(is_locked_);
+    is_locked_ = false;
+    segment_->Unlock(allocator_->GetUseTime());
+  }
+
+  void* data() const override {
+    DCHECK(is_locked_);
+    return segment_->memory() + offset_;
+  }
+
+  trace_event::MemoryAllocatorDump* CreateMemoryAllocatorDump(
+      const char* name,
+      trace_event::ProcessMemoryDump* pmd) const override {
+    trace_event::MemoryAllocatorDump* dump = pmd->CreateAllocatorDump(name);
+    dump->AddScalar(trace_event::MemoryAllocatorDump::kNameSize,
+                    trace_event::MemoryAllocatorDump::kUnitsBytes,
+                    segment_->IsPurged() ? 0 : size_);
+    return dump;
+  }
+
+ private:
+  InProcessDiscardableMemoryAllocator* const allocator_;
+  Segment* const segment_;
+  const size_t offset_;
+  const size_t size_;
+  bool is_locked_ = true;
+
+  DISALLOW_COPY_AND_ASSIGN(Memory);
+};
+
+constexpr size_t InProcessDiscardableMemoryAllocator::kDefaultSegmentSize;
+
+InProcessDiscardableMemoryAllocator::InProcessDiscardableMemoryAllocator(
+    size_t segment_size,
+    size_t memory_limit)
+    : segment_size_(bits::Align(segment_size, kAlignment)),
+      memory_limit_(memory_limit),
+      // Purging only takes the lock of the allocator, so it's done right away
+      // on the thread which notifies the pressure.
+      memory_pressure_listener_(
+          DoNothing(),
+          BindRepeating(&InProcessDiscardableMemoryAllocator::OnMemoryPressure,
+                        Unretained(this))) {
+  DCHECK_GT(segment_size_, 0u);
+}
+
+InProcessDiscardableMemoryAllocator::~InProcessDiscardableMemoryAllocator() {
+  DCHECK(segments_.empty() ||
+         (segments_.size() == 1 && segments_[0].get() == current_segment_ &&
+          current_segment_->num_memories == 0))
+      << "Discardable memory outlives its allocator";
+}
+
+std::unique_ptr<DiscardableMemory>
+InProcessDiscardableMemoryAllocator::AllocateLockedDiscardableMemory(
+    size_t size) {
+  const size_t aligned_size =
+      bits::Align(std::max<size_t>(size, 1), kAlignment);
+
+  AutoLock auto_lock(lock_);
+  Segment* segment;
+  size_t offset = 0;
+  if (aligned_size > segment_size_ / 4) {
+    segment = AllocateSegmentLocked(aligned_size);
+    if (!segment)
+      return nullptr;
+  } else {
+    if (!current_segment_ ||
+        current_segment_->used_size + aligned_size > segment_size_) {
+      Segment* previous_segment = current_segment_;
+      current_segment_ = nullptr;
+      if (previous_segment && previous_segment->num_memories == 0)
+        DeleteSegmentLocked(previous_segment);
+      current_segment_ = AllocateSegmentLocked(segment_size_);
+      if (!current_segment_)
+        return nullptr;
+    }
+    segment = current_segment_;
+    offset = segment->used_size;
+  }
+
+  // The segment can't be purged meanwhile, since purging takes |lock_|.
+  const bool locked = segment->Lock();
+  DCHECK(locked);
+  segment->used_size = offset + aligned_size;
+  ++segment->num_memories;
+  return std::make_unique<Memory>(this, segment, offset, size);
+}
+
+void InProcessDiscardableMemoryAllocator::PurgeUntil(size_t target_size) {
+  AutoLock auto_lock(lock_);
+  PurgeUntilLocked(target_size);
+}
+
+size_t InProcessDiscardableMemoryAllocator::GetResidentSize() const {
+  AutoLock auto_lock(lock_);
+  return resident_size_;
+}
+
+void InProcessDiscardableMemoryAllocator::ReleaseMemory(Segment* segment) {
+  AutoLock auto_lock(lock_);
+  DCHECK_GT(segment->num_memories, 0u);
+  if (--segment->num_memories > 0)
+    return;
+  // Small memory is allocated from the start of the current segment again.
+  if (segment == current_segment_) {
+    segment->used_size = 0;
+    return;
+  }
+  DeleteSegmentLocked(segment);
+}
+
+InProcessDiscardableMemoryAllocator::Segment*
+InProcessDiscardableMemoryAllocator::AllocateSegmentLocked(size_t size) {
+  lock_.AssertAcquired();
+  if (resident_size_ + size > memory_limit_)
+    PurgeUntilLocked(memory_limit_ > size ? memory_limit_ - size : 0);
+
+  void* memory;
+  if (!UncheckedMalloc(size, &memory)) {
+    // Give up the cache rather than run out of memory.
+    PurgeUntilLocked(0);
+    if (!UncheckedMalloc(size, &memory))
+      return nullptr;
+  }
+  segments_.push_back(std::make_unique<Segment>(
+      std::unique_ptr<uint8_t, FreeDeleter>(static_cast<uint8_t*>(memory)),
+      size, GetUseTime()));
+  resident_size_ += size;
+  return segments_.back().get();
+}
+
+void InProcessDiscardableMemoryAllocator::PurgeUntilLocked(
+    size_t target_size) {
+  lock_.AssertAcquired();
+  if (resident_size_ <= target_size)
+    return;
+
+  std::vector<Segment*> segments;
+  for (const auto& segment : segments_) {
+    if (!segment->IsPurged())
+      segments.push_back(segment.get());
+  }
+  std::sort(segments.begin(), segments.end(),
+            [](const Segment* a, const Segment* b) {
+              return a->last_use_time() < b->last_use_time();
+            });
+
+  for (Segment* segment : segments) {
+    if (resident_size_ <= target_size)
+      return;
+    if (!segment->TryPurge())
+      continue;
+    resident_size_ -= segment->size();
+    if (segment == current_segment_) {
+      current_segment_ = nullptr;
+      if (segment->num_memories == 0)
+        DeleteSegmentLocked(segment);
+    }
+  }
+}
+
+void InProcessDiscardableMemoryAllocator::DeleteSegmentLocked(
+    Segment* segment) {
+  lock_.AssertAcquired();
+  DCHECK_EQ(0u, segment->num_memories);
+  if (!segment->IsPurged())
+    resident_size_ -= segment->size();
+  auto it = std::find_if(segments_.begin(), segments_.end(),
+                         [segment](const std::unique_ptr<Segment>& other) {
+                           return other.get() == segment;
+                         });
+  DCHECK(it != segments_.end());
+  std::swap(*it, segments_.back());
+  segments_.pop_back();
+}
+
+void InProcessDiscardableMemoryAllocator::OnMemoryPressure(
+    MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
+  switch (memory_pressure_level) {
+    case MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE:
+      break;
+    case MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE: {
+      AutoLock auto_lock(lock_);
+      PurgeUntilLocked(resident_size_ / 2);
+      break;
+    }
+    case MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL:
+      PurgeUntil(0);
+      break;
+  }
+}
+
+}  // namespace base
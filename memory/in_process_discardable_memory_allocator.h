@@ -0,0 +1,111 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_IN_PROCESS_DISCARDABLE_MEMORY_ALLOCATOR_H_
+#define BASE_MEMORY_IN_PROCESS_DISCARDABLE_MEMORY_ALLOCATOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/memory/discardable_memory_allocator.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/synchronization/lock.h"
+
+namespace base {
+
+// A DiscardableMemoryAllocator for caches of many small blobs, which packs the
+// memory it allocates into segments of the heap of the process, rather than
+// giving each its own shared memory. Locking and unlocking the memory only
+// take an atomic operation on its segment, without any system call.
+//
+// The memory is purged a segment at a time, once no memory in the segment is
+// locked, starting with the segments which were unlocked the longest ago. This
+// happens:
+// - when allocating a segment would take the resident segments past
+//   |memory_limit|,
+// - on memory pressure, down to half the resident segments if it's moderate,
+//   and as much as possible if it's critical,
+// - and on PurgeUntil().
+//
+// Memory larger than a quarter of |segment_size| gets a segment of its own.
+//
+// This class is thread-safe. It must outlive the memory it allocates.
+class BASE_EXPORT InProcessDiscardableMemoryAllocator
+    : public DiscardableMemoryAllocator {
+ public:
+  static constexpr size_t kDefaultSegmentSize = 256 * 1024;
+
+  explicit InProcessDiscardableMemoryAllocator(
+      size_t segment_size = kDefaultSegmentSize,
+      size_t memory_limit = std::numeric_limits<size_t>::max());
+  ~InProcessDiscardableMemoryAllocator() override;
+
+  // DiscardableMemoryAllocator:
+  // Returns null if the memory can't be allocated even after purging all the
+  // unlocked segments.
+  std::unique_ptr<DiscardableMemory> AllocateLockedDiscardableMemory(
+      size_t size) override;
+
+  // Purges the least recently used segments without locked memory until the
+  // resident segments take at most |target_size| bytes, or none is left to
+  // purge.
+  void PurgeUntil(size_t target_size);
+
+  // Returns the size of the segments which aren't purged.
+  size_t GetResidentSize() const;
+
+ private:
+  class Memory;
+  class Segment;
+
+  // Returns the time of a use of memory, which orders the segments to purge.
+  uint64_t GetUseTime() {
+    return use_clock_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Called when a memory in |segment| is destroyed.
+  void ReleaseMemory(Segment* segment);
+
+  // Returns a segment of |size| bytes, after purging segments if needed to
+  // stay within |memory_limit_|. Returns null on failure.
+  Segment* AllocateSegmentLocked(size_t size);
+
+  void PurgeUntilLocked(size_t target_size);
+
+  // Deletes |segment|, which holds no memory.
+  void DeleteSegmentLocked(Segment* segment);
+
+  void OnMemoryPressure(
+      MemoryPressureListener::MemoryPressureLevel memory_pressure_level);
+
+  const size_t segment_size_;
+  const size_t memory_limit_;
+
+  std::atomic<uint64_t> use_clock_{0};
+
+  mutable Lock lock_;
+
+  // The segments which hold memory, or which are |current_segment_|.
+  std::vector<std::unique_ptr<Segment>> segments_;
+
+  // The segment in which small memory is allocated, or null.
+  Segment* current_segment_ = nullptr;
+
+  size_t resident_size_ = 0;
+
+  MemoryPressureListener memory_pressure_listener_;
+
+  DISALLOW_COPY_AND_ASSIGN(InProcessDiscardableMemoryAllocator);
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_IN_PROCESS_DISCARDABLE_MEMORY_ALLOCATOR_H_
@@ -0,0 +1,129 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/in_process_discardable_memory_allocator.h"
+
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/memory/discardable_memory.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kSegmentSize = 4096;
+
+}  // namespace
+
+TEST(InProcessDiscardableMemoryAllocatorTest, PacksSmallMemory) {
+  InProcessDiscardableMemoryAllocator allocator(kSegmentSize);
+  std::vector<std::unique_ptr<DiscardableMemory>> memories;
+  for (int i = 0; i < 16; ++i) {
+    memories.push_back(allocator.AllocateLockedDiscardableMemory(200));
+    ASSERT_TRUE(memories.back());
+    memset(memories.back()->data(), i, 200);
+  }
+  EXPECT_EQ(kSegmentSize, allocator.GetResidentSize());
+
+  for (int i = 0; i < 16; ++i) {
+    memories[i]->Unlock();
+    ASSERT_TRUE(memories[i]->Lock());
+    EXPECT_EQ(i, memories[i]->data_as<uint8_t>()[199]);
+  }
+
+  // Larger memory gets a segment of its own.
+  std::unique_ptr<DiscardableMemory> large_memory =
+      allocator.AllocateLockedDiscardableMemory(kSegmentSize);
+  ASSERT_TRUE(large_memory);
+  EXPECT_EQ(2 * kSegmentSize, allocator.GetResidentSize());
+  large_memory.reset();
+  EXPECT_EQ(kSegmentSize, allocator.GetResidentSize());
+}
+
+TEST(InProcessDiscardableMemoryAllocatorTest, LockedMemoryIsNotPurged) {
+  InProcessDiscardableMemoryAllocator allocator(kSegmentSize);
+  std::unique_ptr<DiscardableMemory> locked_memory =
+      allocator.AllocateLockedDiscardableMemory(100);
+  std::unique_ptr<DiscardableMemory> unlocked_memory =
+      allocator.AllocateLockedDiscardableMemory(100);
+  unlocked_memory->Unlock();
+
+  // The segment holds locked memory.
+  allocator.PurgeUntil(0);
+  EXPECT_EQ(kSegmentSize, allocator.GetResidentSize());
+  ASSERT_TRUE(unlocked_memory->Lock());
+
+  locked_memory->Unlock();
+  unlocked_memory->Unlock();
+  allocator.PurgeUntil(0);
+  EXPECT_EQ(0u, allocator.GetResidentSize());
+  EXPECT_FALSE(locked_memory->Lock());
+  EXPECT_FALSE(unlocked_memory->Lock());
+
+  // Memory is allocated in a new segment.
+  std::unique_ptr<DiscardableMemory> memory =
+      allocator.AllocateLockedDiscardableMemory(100);
+  ASSERT_TRUE(memory);
+  EXPECT_EQ(kSegmentSize, allocator.GetResidentSize());
+}
+
+TEST(InProcessDiscardableMemoryAllocatorTest, PurgesLeastRecentlyUsed) {
+  InProcessDiscardableMemoryAllocator allocator(kSegmentSize);
+  std::unique_ptr<DiscardableMemory> memories[4];
+  for (auto& memory : memories)
+    memory = allocator.AllocateLockedDiscardableMemory(kSegmentSize);
+  EXPECT_EQ(4 * kSegmentSize, allocator.GetResidentSize());
+  for (int i : {2, 0, 3, 1})
+    memories[i]->Unlock();
+
+  allocator.PurgeUntil(2 * kSegmentSize);
+  EXPECT_EQ(2 * kSegmentSize, allocator.GetResidentSize());
+  EXPECT_FALSE(memories[2]->Lock());
+  EXPECT_FALSE(memories[0]->Lock());
+  EXPECT_TRUE(memories[3]->Lock());
+  EXPECT_TRUE(memories[1]->Lock());
+}
+
+TEST(InProcessDiscardableMemoryAllocatorTest, MemoryLimit) {
+  InProcessDiscardableMemoryAllocator allocator(kSegmentSize,
+                                                2 * kSegmentSize);
+  std::unique_ptr<DiscardableMemory> memories[3];
+  for (auto& memory : memories) {
+    memory = allocator.AllocateLockedDiscardableMemory(kSegmentSize);
+    memory->Unlock();
+  }
+  EXPECT_EQ(2 * kSegmentSize, allocator.GetResidentSize());
+  EXPECT_FALSE(memories[0]->Lock());
+  EXPECT_TRUE(memories[1]->Lock());
+  EXPECT_TRUE(memories[2]->Lock());
+
+  // The limit is exceeded rather than purge locked memory.
+  std::unique_ptr<DiscardableMemory> memory =
+      allocator.AllocateLockedDiscardableMemory(kSegmentSize);
+  ASSERT_TRUE(memory);
+  EXPECT_EQ(3 * kSegmentSize, allocator.GetResidentSize());
+}
+
+TEST(InProcessDiscardableMemoryAllocatorTest, MemoryPressure) {
+  InProcessDiscardableMemoryAllocator allocator(kSegmentSize);
+  std::unique_ptr<DiscardableMemory> memories[4];
+  for (auto& memory : memories) {
+    memory = allocator.AllocateLockedDiscardableMemory(kSegmentSize);
+    memory->Unlock();
+  }
+
+  MemoryPressureListener::NotifyMemoryPressure(
+      MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE);
+  EXPECT_EQ(2 * kSegmentSize, allocator.GetResidentSize());
+  MemoryPressureListener::NotifyMemoryPressure(
+      MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL);
+  EXPECT_EQ(0u, allocator.GetResidentSize());
+}
+
+}  // namespace base
@@ -0,0 +1,332 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/memory_pressure_monitor_linux.h"
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/sequenced_task_runner.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+
+namespace base {
+
+namespace {
+
+// Opens a PSI trigger on |psi_file| which fires when tasks stall on memory for
+// |stall| within |window|. |type| is "some" or "full". Returns an invalid fd
+// if PSI isn't supported.
+ScopedFD OpenPsiTrigger(const FilePath& psi_file,
+                        const char* type,
+                        TimeDelta stall,
+                        TimeDelta window) {
+  ScopedFD fd(HANDLE_EINTR(
+      open(psi_file.value().c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC)));
+  if (!fd.is_valid())
+    return fd;
+  const std::string trigger =
+      StringPrintf("%s %" PRId64 " %" PRId64, type, stall.InMicroseconds(),
+                   window.InMicroseconds());
+  // The kernel expects the terminating null to be written.
+  if (HANDLE_EINTR(write(fd.get(), trigger.c_str(), trigger.size() + 1)) < 0) {
+    DPLOG(ERROR) << "Failed to set PSI trigger \"" << trigger << "\"";
+    return ScopedFD();
+  }
+  return fd;
+}
+
+// Reads the memory.events file open as |fd| from its start. Reading it also
+// rearms the notification of the next change.
+bool ReadCgroupMemoryEvents(int fd, internal::CgroupMemoryEvents* events) {
+  char buffer[512];
+  const ssize_t size = HANDLE_EINTR(pread(fd, buffer, sizeof(buffer), 0));
+  if (size < 0) {
+    DPLOG(ERROR) << "Failed to read memory.events";
+    return false;
+  }
+  return internal::ParseCgroupMemoryEvents(
+      StringPiece(buffer, static_cast<size_t>(size)), events);
+}
+
+FilePath FindCgroupMemoryEventsFile() {
+  std::string proc_cgroup;
+  std::string proc_mountinfo;
+  if (!ReadFileToString(FilePath("/proc/self/cgroup"), &proc_cgroup) ||
+      !ReadFileToString(FilePath("/proc/self/mountinfo"), &proc_mountinfo)) {
+    return FilePath();
+  }
+  return internal::GetCgroupMemoryEventsFile(proc_cgroup, proc_mountinfo);
+}
+
+}  // namespace
+
+// Sleeps in poll() on its own thread until a source of pressure signals, and
+// posts the pressure to the monitor. It deletes itself when the monitor
+// signals |stop_event_|.
+class MemoryPressureMonitorLinux::Watcher : public PlatformThread::Delegate {
+ public:
+  Watcher(ScopedFD moderate_trigger,
+          ScopedFD critical_trigger,
+          ScopedFD memory_events,
+          ScopedFD stop_event,
+          WeakPtr<MemoryPressureMonitorLinux> monitor)
+      : moderate_trigger_(std::move(moderate_trigger)),
+        critical_trigger_(std::move(critical_trigger)),
+        memory_events_(std::move(memory_events)),
+        stop_event_(std::move(stop_event)),
+        task_runner_(SequencedTaskRunnerHandle::Get()),
+        monitor_(std::move(monitor)) {
+    if (memory_events_.is_valid() &&
+        !ReadCgroupMemoryEvents(memory_events_.get(), &memory_events_counts_)) {
+      memory_events_.reset();
+    }
+  }
+
+  // PlatformThread::Delegate:
+  void ThreadMain() override {
+    PlatformThread::SetName("MemoryPressureWatcher");
+
+    // Negative fds are ignored by poll().
+    pollfd fds[] = {
+        {stop_event_.get(), POLLIN, 0},
+        {moderate_trigger_.get(), POLLPRI, 0},
+        {critical_trigger_.get(), POLLPRI, 0},
+        {memory_events_.get(), POLLPRI, 0},
+    };
+    for (;;) {
+      if (HANDLE_EINTR(poll(fds, arraysize(fds), -1)) < 0) {
+        DPLOG(ERROR) << "poll";
+        break;
+      }
+      if (fds[0].revents)
+        break;
+
+      MemoryPressureLevel level =
+          MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+      if (fds[1].revents & POLLPRI)
+        level = MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE;
+      if (fds[2].revents & POLLPRI)
+        level = MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL;
+      if (fds[3].revents & POLLPRI)
+        level = std::max(level, GetCgroupPressureLevel());
+      // A source which fails is dropped rather than spin on it.
+      for (pollfd& fd : fds) {
+        if (fd.revents & POLLNVAL)
+          fd.fd = -1;
+      }
+
+      if (level != MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE) {
+        task_runner_->PostTask(
+            FROM_HERE, BindOnce(&MemoryPressureMonitorLinux::OnPressureEvent,
+                                monitor_, level));
+      }
+    }
+    delete this;
+  }
+
+ private:
+  // Returns the pressure level signaled by the counts of memory.events which
+  // changed since they were last read.
+  MemoryPressureLevel GetCgroupPressureLevel() {
+    internal::CgroupMemoryEvents counts;
+    if (!ReadCgroupMemoryEvents(memory_events_.get(), &counts))
+      return MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+    MemoryPressureLevel level =
+        MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+    if (counts.max > memory_events_counts_.max ||
+        counts.oom > memory_events_counts_.oom) {
+      level = MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL;
+    } else if (counts.high > memory_events_counts_.high) {
+      level = MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE;
+    }
+    memory_events_counts_ = counts;
+    return level;
+  }
+
+  const ScopedFD moderate_trigger_;
+  const ScopedFD critical_trigger_;
+  ScopedFD memory_events_;
+  const ScopedFD stop_event_;
+  internal::CgroupMemoryEvents memory_events_counts_;
+  const scoped_refptr<SequencedTaskRunner> task_runner_;
+  const WeakPtr<MemoryPressureMonitorLinux> monitor_;
+
+  DISALLOW_COPY_AND_ASSIGN(Watcher);
+};
+
+MemoryPressureMonitorLinux::MemoryPressureMonitorLinux()
+    : MemoryPressureMonitorLinux(Options()) {}
+
+MemoryPressureMonitorLinux::MemoryPressureMonitorLinux(const Options& options)
+    : options_(options),
+      dispatch_callback_(
+          base::Bind(&MemoryPressureListener::NotifyMemoryPressure)),
+      weak_ptr_factory_(this) {
+  ScopedFD moderate_trigger = OpenPsiTrigger(
+      options_.psi_file, "some", options_.moderate_stall, options_.psi_window);
+  ScopedFD critical_trigger = OpenPsiTrigger(
+      options_.psi_file, "full", options_.critical_stall, options_.psi_window);
+
+  const FilePath memory_events_file =
+      options_.cgroup_memory_events_file.empty()
+          ? FindCgroupMemoryEventsFile()
+          : options_.cgroup_memory_events_file;
+  ScopedFD memory_events;
+  if (!memory_events_file.empty()) {
+    memory_events.reset(HANDLE_EINTR(
+        open(memory_events_file.value().c_str(), O_RDONLY | O_CLOEXEC)));
+  }
+
+  if (!moderate_trigger.is_valid() && !critical_trigger.is_valid() &&
+      !memory_events.is_valid()) {
+    LOG(WARNING) << "No source of memory pressure events";
+    return;
+  }
+
+  ScopedFD stop_event(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+  if (!stop_event.is_valid()) {
+    DPLOG(ERROR) << "eventfd";
+    return;
+  }
+  // The watcher closes its own copy of the event, so that signaling it after
+  // the watcher died is harmless.
+  ScopedFD watcher_stop_event(HANDLE_EINTR(dup(stop_event.get())));
+  if (!watcher_stop_event.is_valid()) {
+    DPLOG(ERROR) << "dup";
+    return;
+  }
+
+  Watcher* watcher = new Watcher(
+      std::move(moderate_trigger), std::move(critical_trigger),
+      std::move(memory_events), std::move(watcher_stop_event),
+      weak_ptr_factory_.GetWeakPtr());
+  if (!PlatformThread::CreateNonJoinable(0, watcher)) {
+    delete watcher;
+    return;
+  }
+  stop_event_ = std::move(stop_event);
+}
+
+MemoryPressureMonitorLinux::~MemoryPressureMonitorLinux() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (stop_event_.is_valid()) {
+    const uint64_t value = 1;
+    if (HANDLE_EINTR(write(stop_event_.get(), &value, sizeof(value))) < 0)
+      DPLOG(ERROR) << "Failed to stop the memory pressure watcher";
+  }
+}
+
+MemoryPressureMonitor::MemoryPressureLevel
+MemoryPressureMonitorLinux::GetCurrentPressureLevel() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return current_pressure_level_;
+}
+
+void MemoryPressureMonitorLinux::SetDispatchCallback(
+    const DispatchCallback& callback) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  dispatch_callback_ = callback;
+}
+
+void MemoryPressureMonitorLinux::OnPressureEvent(MemoryPressureLevel level) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  // A lower level doesn't override a higher one until the latter expires.
+  if (level >= current_pressure_level_)
+    current_pressure_level_ = level;
+  pressure_timer_.Start(FROM_HERE, options_.pressure_duration, this,
+                        &MemoryPressureMonitorLinux::OnPressureExpired);
+  dispatch_callback_.Run(level);
+}
+
+void MemoryPressureMonitorLinux::OnPressureExpired() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  current_pressure_level_ = MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+}
+
+namespace internal {
+
+bool ParseCgroupMemoryEvents(StringPiece contents,
+                             CgroupMemoryEvents* events) {
+  *events = CgroupMemoryEvents();
+  for (StringPiece line : SplitStringPiece(contents, "\n", TRIM_WHITESPACE,
+                                           SPLIT_WANT_NONEMPTY)) {
+    std::vector<StringPiece> fields = SplitStringPiece(
+        line, " ", TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY);
+    uint64_t count;
+    if (fields.size() != 2 || !StringToUint64(fields[1], &count))
+      return false;
+    if (fields[0] == "high")
+      events->high = count;
+    else if (fields[0] == "max")
+      events->max = count;
+    else if (fields[0] == "oom")
+      events->oom = count;
+  }
+  return true;
+}
+
+FilePath GetCgroupMemoryEventsFile(StringPiece proc_cgroup,
+                                   StringPiece proc_mountinfo) {
+  // The cgroup v2 of the process is on a line "0::<path>".
+  StringPiece cgroup_path;
+  for (StringPiece line : SplitStringPiece(proc_cgroup, "\n", TRIM_WHITESPACE,
+                                           SPLIT_WANT_NONEMPTY)) {
+    if (StartsWith(line, "0::", CompareCase::SENSITIVE)) {
+      cgroup_path = line.substr(3);
+      break;
+    }
+  }
+  if (cgroup_path.empty())
+    return FilePath();
+
+  // A mountinfo line is "<id> <parent id> <device> <root> <mount point>
+  // <options> [<optional fields>] - <type> <source> <super options>".
+  for (StringPiece line : SplitStringPiece(proc_mountinfo, "\n",
+                                           TRIM_WHITESPACE,
+                                           SPLIT_WANT_NONEMPTY)) {
+    std::vector<StringPiece> fields =
+        SplitStringPiece(line, " ", TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY);
+    auto separator = std::find(fields.begin(), fields.end(), "-");
+    if (fields.size() < 5 || separator == fields.end() ||
+        separator + 1 == fields.end() || *(separator + 1) != "cgroup2") {
+      continue;
+    }
+    // The mount may expose a subtree of the hierarchy, e.g. in a cgroup
+    // namespace.
+    StringPiece root = fields[3];
+    StringPiece path = cgroup_path;
+    if (root != "/") {
+      if (!StartsWith(path, root, CompareCase::SENSITIVE))
+        continue;
+      path.remove_prefix(root.size());
+    }
+    FilePath file(fields[4]);
+    path = TrimString(path, "/", TRIM_ALL);
+    if (!path.empty())
+      file = file.Append(path);
+    return file.Append("memory.events");
+  }
+  return FilePath();
+}
+
+}  // namespace internal
+
+}  // namespace base
@@ -0,0 +1,116 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_MEMORY_PRESSURE_MONITOR_LINUX_H_
+#define BASE_MEMORY_MEMORY_PRESSURE_MONITOR_LINUX_H_
+
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/files/file_path.h"
+#include "base/files/scoped_file.h"
+#include "base/macros.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/memory/memory_pressure_monitor.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequence_checker.h"
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+
+namespace base {
+
+// A MemoryPressureMonitor which is told of memory pressure by the kernel
+// rather than polling for it. It subscribes to two sources, each optional:
+//  - Pressure stall information (PSI) triggers on /proc/pressure/memory, which
+//    fire when tasks stall on memory for longer than a threshold within a
+//    time window. Linux 5.2 and above.
+//  - The memory.events file of the cgroup v2 of the process, whose "high"
+//    count increments when the cgroup is throttled above its memory.high
+//    limit, and "max" and "oom" counts when it hits its memory.max limit.
+//
+// A thread sleeps in poll() on them, and wakes up only on pressure. Each
+// event is dispatched right away, and the pressure level falls back to none
+// once no event was seen for a while.
+//
+// This class must be used on a single sequence, which has a task runner.
+class BASE_EXPORT MemoryPressureMonitorLinux : public MemoryPressureMonitor {
+ public:
+  struct Options {
+    // The PSI file, and the stall durations within |psi_window| which trigger
+    // moderate and critical pressure. Moderate pressure is signaled when
+    // some tasks stall, critical pressure when all non-idle tasks stall at
+    // once. Unprivileged processes may only use windows which are a multiple
+    // of 2 seconds.
+    FilePath psi_file = FilePath("/proc/pressure/memory");
+    TimeDelta psi_window = TimeDelta::FromSeconds(2);
+    TimeDelta moderate_stall = TimeDelta::FromMilliseconds(150);
+    TimeDelta critical_stall = TimeDelta::FromMilliseconds(100);
+    // The memory.events file to watch. Found from /proc/self/cgroup when
+    // empty.
+    FilePath cgroup_memory_events_file;
+    // How long the pressure level stays up after the last event.
+    TimeDelta pressure_duration = TimeDelta::FromSeconds(5);
+  };
+
+  MemoryPressureMonitorLinux();
+  explicit MemoryPressureMonitorLinux(const Options& options);
+  ~MemoryPressureMonitorLinux() override;
+
+  // Returns true if the monitor subscribed to any source of pressure events.
+  bool IsWatching() const { return stop_event_.is_valid(); }
+
+  // MemoryPressureMonitor:
+  MemoryPressureLevel GetCurrentPressureLevel() override;
+  void SetDispatchCallback(const DispatchCallback& callback) override;
+
+ private:
+  class Watcher;
+
+  // Called on the sequence of the monitor when a source signals |level|.
+  void OnPressureEvent(MemoryPressureLevel level);
+  void OnPressureExpired();
+
+  const Options options_;
+  MemoryPressureLevel current_pressure_level_ =
+      MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+  OneShotTimer pressure_timer_;
+  DispatchCallback dispatch_callback_;
+
+  // Signaled to stop the thread of the Watcher, which owns itself.
+  ScopedFD stop_event_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  WeakPtrFactory<MemoryPressureMonitorLinux> weak_ptr_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryPressureMonitorLinux);
+};
+
+namespace internal {
+
+// The counts of memory.events which the monitor watches.
+struct CgroupMemoryEvents {
+  uint64_t high = 0;
+  uint64_t max = 0;
+  uint64_t oom = 0;
+};
+
+// Parses the |contents| of a memory.events file. Returns false if it's
+// malformed. Exposed for testing.
+BASE_EXPORT bool ParseCgroupMemoryEvents(StringPiece contents,
+                                         CgroupMemoryEvents* events);
+
+// Returns the memory.events file of the cgroup v2 of a process, given the
+// contents of its /proc/<pid>/cgroup and /proc/<pid>/mountinfo files, or an
+// empty path if cgroup v2 isn't mounted. The file doesn't exist if the cgroup
+// has no memory controller, e.g. for the root cgroup. Exposed for testing.
+BASE_EXPORT FilePath GetCgroupMemoryEventsFile(StringPiece proc_cgroup,
+                                               StringPiece proc_mountinfo);
+
+}  // namespace internal
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_MEMORY_PRESSURE_MONITOR_LINUX_H_
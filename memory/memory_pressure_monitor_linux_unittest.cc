@@ -0,0 +1,84 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/memory_pressure_monitor_linux.h"
+
+#include <string.h>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/test/scoped_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(MemoryPressureMonitorLinuxTest, ParseCgroupMemoryEvents) {
+  internal::CgroupMemoryEvents events;
+  ASSERT_TRUE(internal::ParseCgroupMemoryEvents(
+      "low 0\nhigh 12\nmax 3\noom 1\noom_kill 1\n", &events));
+  EXPECT_EQ(12u, events.high);
+  EXPECT_EQ(3u, events.max);
+  EXPECT_EQ(1u, events.oom);
+
+  EXPECT_FALSE(internal::ParseCgroupMemoryEvents("high twelve\n", &events));
+  EXPECT_FALSE(internal::ParseCgroupMemoryEvents("high\n", &events));
+}
+
+TEST(MemoryPressureMonitorLinuxTest, GetCgroupMemoryEventsFile) {
+  constexpr char kMountinfo[] =
+      "22 1 8:1 / / rw,relatime shared:1 - ext4 /dev/sda1 rw\n"
+      "30 22 0:26 / /sys/fs/cgroup rw,nosuid shared:4 - cgroup2 cgroup2 rw\n";
+  EXPECT_EQ(FilePath("/sys/fs/cgroup/user.slice/app.scope/memory.events"),
+            internal::GetCgroupMemoryEventsFile("0::/user.slice/app.scope\n",
+                                                kMountinfo));
+  EXPECT_EQ(FilePath("/sys/fs/cgroup/memory.events"),
+            internal::GetCgroupMemoryEventsFile("0::/\n", kMountinfo));
+
+  // Only cgroup v1 controllers.
+  EXPECT_EQ(FilePath(), internal::GetCgroupMemoryEventsFile(
+                            "4:memory:/user.slice\n", kMountinfo));
+  // No cgroup v2 mount.
+  EXPECT_EQ(FilePath(),
+            internal::GetCgroupMemoryEventsFile(
+                "0::/user.slice\n",
+                "22 1 8:1 / / rw,relatime shared:1 - ext4 /dev/sda1 rw\n"));
+  // A mount of a subtree of the hierarchy.
+  EXPECT_EQ(FilePath("/sys/fs/cgroup/app.scope/memory.events"),
+            internal::GetCgroupMemoryEventsFile(
+                "0::/user.slice/app.scope\n",
+                "30 22 0:26 /user.slice /sys/fs/cgroup rw - cgroup2 none rw\n"));
+}
+
+TEST(MemoryPressureMonitorLinuxTest, NoSourceOfEvents) {
+  test::ScopedTaskEnvironment scoped_task_environment;
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  MemoryPressureMonitorLinux::Options options;
+  options.psi_file = temp_dir.GetPath().Append("missing");
+  options.cgroup_memory_events_file = temp_dir.GetPath().Append("missing");
+  MemoryPressureMonitorLinux monitor(options);
+  EXPECT_FALSE(monitor.IsWatching());
+  EXPECT_EQ(MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE,
+            monitor.GetCurrentPressureLevel());
+}
+
+TEST(MemoryPressureMonitorLinuxTest, WatchesMemoryEvents) {
+  test::ScopedTaskEnvironment scoped_task_environment;
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const FilePath memory_events = temp_dir.GetPath().Append("memory.events");
+  constexpr char kMemoryEvents[] = "high 0\nmax 0\noom 0\n";
+  ASSERT_EQ(static_cast<int>(strlen(kMemoryEvents)),
+            WriteFile(memory_events, kMemoryEvents, strlen(kMemoryEvents)));
+  MemoryPressureMonitorLinux::Options options;
+  options.psi_file = temp_dir.GetPath().Append("missing");
+  options.cgroup_memory_events_file = memory_events;
+
+  // The watcher thread is stopped when the monitor is destroyed.
+  MemoryPressureMonitorLinux monitor(options);
+  EXPECT_TRUE(monitor.IsWatching());
+}
+
+}  // namespace base
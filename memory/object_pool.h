@@ -0,0 +1,106 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_OBJECT_POOL_H_
+#define BASE_MEMORY_OBJECT_POOL_H_
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/arena.h"
+
+namespace base {
+
+// A pool of objects of type T, for objects which are created and destroyed
+// often. The memory of a destroyed object is reused by the next one, so once
+// the pool has grown to the peak number of objects, creating one costs no more
+// than popping a free list. The memory is only returned to the system when
+// the pool is destroyed, which must happen after all its objects are.
+//
+// Example:
+//   ObjectPool<Request> pool;
+//   ObjectPool<Request>::UniquePtr request = pool.MakeUnique(url);
+//
+// A pool is not thread safe, and must be used on a single sequence.
+template <typename T>
+class ObjectPool {
+ public:
+  // Deleter for the std::unique_ptr of objects of a pool.
+  class Deleter {
+   public:
+    Deleter() = default;
+    explicit Deleter(ObjectPool* pool) : pool_(pool) {}
+
+    void operator()(T* object) const { pool_->Delete(object); }
+
+   private:
+    ObjectPool* pool_ = nullptr;
+  };
+
+  using UniquePtr = std::unique_ptr<T, Deleter>;
+
+  ObjectPool() = default;
+  ~ObjectPool() { DCHECK_EQ(0u, num_objects_); }
+
+  template <typename... Args>
+  T* New(Args&&... args) {
+    void* slot = free_slots_;
+    if (slot)
+      free_slots_ = free_slots_->next;
+    else
+      slot = arena_.Allocate(kSlotSize, kSlotAlignment);
+    ++num_objects_;
+    return new (slot) T(std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  UniquePtr MakeUnique(Args&&... args) {
+    return UniquePtr(New(std::forward<Args>(args)...), Deleter(this));
+  }
+
+  // Destroys |object|, which was created by New().
+  void Delete(T* object) {
+    DCHECK_GT(num_objects_, 0u);
+    object->~T();
+    FreeSlot* slot = reinterpret_cast<FreeSlot*>(object);
+    slot->next = free_slots_;
+    free_slots_ = slot;
+    --num_objects_;
+  }
+
+  // Returns the number of objects created by New() and not deleted yet.
+  size_t num_objects() const { return num_objects_; }
+
+ private:
+  struct FreeSlot {
+    FreeSlot* next;
+  };
+
+  static constexpr size_t kSlotSize = std::max(sizeof(T), sizeof(FreeSlot));
+  static constexpr size_t kSlotAlignment =
+      std::max(alignof(T), alignof(FreeSlot));
+
+  // Holds at least a few slots per chunk, so that they aren't allocated one by
+  // one as large allocations.
+  Arena arena_{std::max(Arena::kDefaultChunkSize, 16 * kSlotSize)};
+  FreeSlot* free_slots_ = nullptr;
+  size_t num_objects_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(ObjectPool);
+};
+
+template <typename T>
+constexpr size_t ObjectPool<T>::kSlotSize;
+template <typename T>
+constexpr size_t ObjectPool<T>::kSlotAlignment;
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_OBJECT_POOL_H_
@@ -0,0 +1,53 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/object_pool.h"
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(ObjectPoolTest, ReusesMemory) {
+  ObjectPool<std::string> pool;
+  std::string* a = pool.New("a");
+  std::string* b = pool.New(3, 'b');
+  EXPECT_EQ("a", *a);
+  EXPECT_EQ("bbb", *b);
+  EXPECT_EQ(2u, pool.num_objects());
+
+  pool.Delete(a);
+  EXPECT_EQ(1u, pool.num_objects());
+  std::string* c = pool.New("c");
+  EXPECT_EQ(a, c);
+  EXPECT_EQ("c", *c);
+
+  pool.Delete(b);
+  pool.Delete(c);
+  EXPECT_EQ(0u, pool.num_objects());
+}
+
+TEST(ObjectPoolTest, SmallObjects) {
+  ObjectPool<char> pool;
+  char* objects[1000];
+  for (char*& object : objects)
+    object = pool.New('a');
+  for (char* object : objects) {
+    EXPECT_EQ('a', *object);
+    pool.Delete(object);
+  }
+}
+
+TEST(ObjectPoolTest, MakeUnique) {
+  ObjectPool<std::string> pool;
+  {
+    ObjectPool<std::string>::UniquePtr a = pool.MakeUnique("a");
+    EXPECT_EQ("a", *a);
+    EXPECT_EQ(1u, pool.num_objects());
+  }
+  EXPECT_EQ(0u, pool.num_objects());
+}
+
+}  // namespace base
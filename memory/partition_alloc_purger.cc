@@ -0,0 +1,142 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/partition_alloc_purger.h"
+
+#include <stdint.h>
+
+#include <utility>
+
+#include "base/allocator/partition_allocator/partition_alloc.h"
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequence_checker.h"
+#include "base/sequenced_task_runner.h"
+#include "base/task_scheduler/post_task.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+
+namespace base {
+
+namespace {
+
+constexpr int kPurgeFlags = PartitionPurgeDecommitEmptyPages |
+                            PartitionPurgeDiscardUnusedSystemPages;
+
+}  // namespace
+
+// The state of the purger, which lives on its sequence.
+class PartitionAllocPurger::Core {
+ public:
+  Core(PartitionRootGeneric* root, const Options& options)
+      : root_(root), options_(options), weak_factory_(this) {
+    DETACH_FROM_SEQUENCE(sequence_checker_);
+  }
+
+  ~Core() { DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_); }
+
+  void Start() {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    // Created here so that the notifications are received on this sequence.
+    memory_pressure_listener_ = std::make_unique<MemoryPressureListener>(
+        BindRepeating(&Core::OnMemoryPressure, Unretained(this)));
+    last_num_allocations_ = root_->GetNumAllocations();
+    PostIdleCheck();
+  }
+
+ private:
+  void OnMemoryPressure(
+      MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    if (memory_pressure_level ==
+        MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE) {
+      return;
+    }
+    StartPurge();
+  }
+
+  void PostIdleCheck() {
+    SequencedTaskRunnerHandle::Get()->PostDelayedTask(
+        FROM_HERE, BindOnce(&Core::CheckIdle, weak_factory_.GetWeakPtr()),
+        options_.idle_check_interval);
+  }
+
+  void CheckIdle() {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    uint64_t num_allocations = root_->GetNumAllocations();
+    if (num_allocations - last_num_allocations_ <=
+            options_.max_idle_allocations &&
+        num_allocations != num_allocations_at_last_purge_) {
+      StartPurge();
+    }
+    last_num_allocations_ = num_allocations;
+    PostIdleCheck();
+  }
+
+  void StartPurge() {
+    if (is_purging_)
+      return;
+    is_purging_ = true;
+    num_allocations_at_last_purge_ = root_->GetNumAllocations();
+    PurgeStep();
+  }
+
+  void PurgeStep() {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    DCHECK(is_purging_);
+    if (root_->PurgeMemoryIncrementally(kPurgeFlags, &cursor_,
+                                        options_.max_slot_spans_per_step)) {
+      is_purging_ = false;
+      return;
+    }
+    // Yields to the other tasks of the sequence between the steps.
+    SequencedTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, BindOnce(&Core::PurgeStep, weak_factory_.GetWeakPtr()));
+  }
+
+  PartitionRootGeneric* const root_;
+  const Options options_;
+  std::unique_ptr<MemoryPressureListener> memory_pressure_listener_;
+
+  // The number of allocations of |root_| at the previous idle check, and when
+  // the last purge started.
+  uint64_t last_num_allocations_ = 0;
+  uint64_t num_allocations_at_last_purge_ = 0;
+
+  bool is_purging_ = false;
+  PartitionPurgeCursor cursor_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  WeakPtrFactory<Core> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(Core);
+};
+
+PartitionAllocPurger::PartitionAllocPurger(PartitionRootGeneric* root,
+                                           const Options& options)
+    : PartitionAllocPurger(
+          root,
+          options,
+          CreateSequencedTaskRunnerWithTraits(
+              {TaskPriority::BACKGROUND,
+               TaskShutdownBehavior::SKIP_ON_SHUTDOWN})) {}
+
+PartitionAllocPurger::PartitionAllocPurger(
+    PartitionRootGeneric* root,
+    const Options& options,
+    scoped_refptr<SequencedTaskRunner> task_runner)
+    : task_runner_(std::move(task_runner)),
+      core_(std::make_unique<Core>(root, options)) {
+  // |core_| is deleted on |task_runner_|, after this task.
+  task_runner_->PostTask(FROM_HERE,
+                         BindOnce(&Core::Start, Unretained(core_.get())));
+}
+
+PartitionAllocPurger::~PartitionAllocPurger() {
+  task_runner_->DeleteSoon(FROM_HERE, std::move(core_));
+}
+
+}  // namespace base
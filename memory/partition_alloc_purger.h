@@ -0,0 +1,63 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_PARTITION_ALLOC_PURGER_H_
+#define BASE_MEMORY_PARTITION_ALLOC_PURGER_H_
+
+#include <stddef.h>
+
+#include <memory>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/time/time.h"
+
+namespace base {
+
+class SequencedTaskRunner;
+struct PartitionRootGeneric;
+
+// Purges a generic partition in the background, a few slot spans at a time,
+// when the system is under memory pressure or the partition has been mostly
+// idle for a while. Unlike PartitionRootGeneric::PurgeMemory(), the lock of
+// the partition is released between each step, so that the threads which
+// allocate are not blocked for the duration of a whole purge.
+//
+// The purge runs on a BACKGROUND priority sequence. The partition must outlive
+// the purger, and its tasks which may still be pending on that sequence after
+// the purger is destroyed.
+class BASE_EXPORT PartitionAllocPurger {
+ public:
+  struct Options {
+    // How often the number of allocations of the partition is checked.
+    TimeDelta idle_check_interval = TimeDelta::FromSeconds(30);
+    // The partition is considered idle, and is purged, when it served at most
+    // this many allocations since the previous check. It isn't purged again
+    // until it has allocated since the previous purge.
+    size_t max_idle_allocations = 1000;
+    // Maximum number of slot spans purged while holding the lock.
+    size_t max_slot_spans_per_step = 64;
+  };
+
+  PartitionAllocPurger(PartitionRootGeneric* root, const Options& options);
+  // Runs the purges on |task_runner| instead, for tests.
+  PartitionAllocPurger(PartitionRootGeneric* root,
+                       const Options& options,
+                       scoped_refptr<SequencedTaskRunner> task_runner);
+  ~PartitionAllocPurger();
+
+ private:
+  class Core;
+
+  const scoped_refptr<SequencedTaskRunner> task_runner_;
+  // Lives on |task_runner_|.
+  std::unique_ptr<Core> core_;
+
+  DISALLOW_COPY_AND_ASSIGN(PartitionAllocPurger);
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_PARTITION_ALLOC_PURGER_H_
@@ -0,0 +1,107 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/partition_alloc_purger.h"
+
+#include <memory>
+
+#include "base/allocator/partition_allocator/partition_alloc.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/test/test_mock_time_task_runner.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+#if !defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
+
+namespace base {
+
+namespace {
+
+constexpr size_t kSlotsPerSpan = 4;
+
+class PartitionAllocPurgerTest : public testing::Test {
+ protected:
+  PartitionAllocPurgerTest()
+      : task_runner_(MakeRefCounted<TestMockTimeTaskRunner>(
+            TestMockTimeTaskRunner::Type::kBoundToThread)) {
+    allocator_.init();
+    options_.idle_check_interval = TimeDelta::FromSeconds(1);
+    options_.max_idle_allocations = 0;
+    options_.max_slot_spans_per_step = 1;
+  }
+
+  void TearDown() override {
+    purger_.reset();
+    task_runner_->RunUntilIdle();
+    for (void* ptr : ptrs_) {
+      if (ptr)
+        allocator_.root()->Free(ptr);
+    }
+  }
+
+  void CreatePurger() {
+    purger_ = std::make_unique<PartitionAllocPurger>(allocator_.root(),
+                                                     options_, task_runner_);
+    task_runner_->RunUntilIdle();
+  }
+
+  // Fills a slot span with system page sized slots, and frees its last one,
+  // which can then be purged.
+  void AllocateDiscardableSlot() {
+    size_t size = internal::PartitionCookieSizeAdjustSubtract(kSystemPageSize);
+    for (void*& ptr : ptrs_)
+      ptr = allocator_.root()->Alloc(size, "");
+    allocator_.root()->Free(ptrs_[kSlotsPerSpan - 1]);
+    ptrs_[kSlotsPerSpan - 1] = nullptr;
+    ASSERT_FALSE(IsPurged());
+  }
+
+  // Returns true if the slot freed by AllocateDiscardableSlot() was purged.
+  bool IsPurged() {
+    internal::PartitionPage* page = internal::PartitionPage::FromPointer(
+        internal::PartitionCookieFreePointerAdjust(ptrs_[0]));
+    return page->num_unprovisioned_slots == 1;
+  }
+
+  scoped_refptr<TestMockTimeTaskRunner> task_runner_;
+  PartitionAllocatorGeneric allocator_;
+  PartitionAllocPurger::Options options_;
+  std::unique_ptr<PartitionAllocPurger> purger_;
+  void* ptrs_[kSlotsPerSpan] = {};
+};
+
+}  // namespace
+
+TEST_F(PartitionAllocPurgerTest, PurgesOnMemoryPressure) {
+  // Doesn't purge on its own.
+  options_.idle_check_interval = TimeDelta::FromDays(1);
+  CreatePurger();
+  AllocateDiscardableSlot();
+
+  MemoryPressureListener::SimulatePressureNotification(
+      MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE);
+  task_runner_->RunUntilIdle();
+  EXPECT_FALSE(IsPurged());
+
+  MemoryPressureListener::SimulatePressureNotification(
+      MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE);
+  task_runner_->RunUntilIdle();
+  EXPECT_TRUE(IsPurged());
+}
+
+TEST_F(PartitionAllocPurgerTest, PurgesWhenIdle) {
+  CreatePurger();
+  AllocateDiscardableSlot();
+
+  // The partition allocated since the previous check.
+  task_runner_->FastForwardBy(options_.idle_check_interval);
+  EXPECT_FALSE(IsPurged());
+
+  task_runner_->FastForwardBy(options_.idle_check_interval);
+  EXPECT_TRUE(IsPurged());
+}
+
+}  // namespace base
+
+#endif  // !defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
@@ -5,6 +5,7 @@
 #include "base/memory/platform_shared_memory_region.h"
 
 #include "base/memory/shared_memory_mapping.h"
+#include "build/build_config.h"
 
 namespace base {
 namespace subtle {
@@ -21,6 +22,34 @@ PlatformSharedMemoryRegion PlatformSharedMemoryRegion::CreateUnsafe(
   return Create(Mode::kUnsafe, size);
 }
 
+// static
+PlatformSharedMemoryRegion PlatformSharedMemoryRegion::CreateWritable(
+    size_t size,
+    const CreateOptions& options) {
+  return CreateWithOptions(Mode::kWritable, size, options);
+}
+
+// static
+PlatformSharedMemoryRegion PlatformSharedMemoryRegion::CreateUnsafe(
+    size_t size,
+    const CreateOptions& options) {
+  return CreateWithOptions(Mode::kUnsafe, size, options);
+}
+
+#if !defined(OS_LINUX)
+// static
+PlatformSharedMemoryRegion PlatformSharedMemoryRegion::CreateWithOptions(
+    Mode mode,
+    size_t size,
+    const CreateOptions& options) {
+  return Create(mode, size);
+}
+
+bool PlatformSharedMemoryRegion::IsWriteSealed() const {
+  return false;
+}
+#endif  // !defined(OS_LINUX)
+
 PlatformSharedMemoryRegion::PlatformSharedMemoryRegion() = default;
 PlatformSharedMemoryRegion::PlatformSharedMemoryRegion(
     PlatformSharedMemoryRegion&& other) = default;
@@ -119,6 +119,45 @@ class BASE_EXPORT PlatformSharedMemoryRegion {
   static PlatformSharedMemoryRegion CreateWritable(size_t size);
   static PlatformSharedMemoryRegion CreateUnsafe(size_t size);
 
+  // The size of the huge pages that CreateOptions refer to.
+  enum : size_t { kHugePageSize = 2 * 1024 * 1024 };
+
+  // Options to lay out large regions for speed. They are only honored on Linux
+  // and ignored elsewhere.
+  struct CreateOptions {
+    // Backs the region with huge pages, as memfd_create(MFD_HUGETLB) does,
+    // which saves most TLB misses. The pages come from the pool reserved in
+    // /proc/sys/vm/nr_hugepages, and creation fails if it's short. The size
+    // of the region is rounded up to a multiple of kHugePageSize, as must be
+    // the offsets and sizes passed to MapAt().
+    bool use_huge_pages = false;
+
+    // If not negative, allocates the pages of the region on this NUMA node,
+    // as numbered by SysInfo::NumaNodeProcessors(), rather than on the node
+    // of the process which first touches them. Huge pages are prefaulted for
+    // the binding to hold.
+    int numa_node = -1;
+
+    // Allocates all the pages of the region at creation, rather than when
+    // they are first touched.
+    bool prefault = false;
+
+    // Aligns the mappings of the region of at least kHugePageSize bytes to
+    // kHugePageSize, and asks for transparent huge pages to back them when
+    // /sys/kernel/mm/transparent_hugepage/shmem_enabled allows it. This
+    // applies to the mappings made by this instance and the instances
+    // converted or duplicated from it, but not to those made from handles
+    // sent to another process.
+    bool align_mappings = false;
+  };
+
+  // Same as above, with |options|.
+  static PlatformSharedMemoryRegion CreateWritable(
+      size_t size,
+      const CreateOptions& options);
+  static PlatformSharedMemoryRegion CreateUnsafe(size_t size,
+                                                 const CreateOptions& options);
+
   // Returns a new PlatformSharedMemoryRegion that takes ownership of the
   // |handle|. All parameters must be taken from another valid
   // PlatformSharedMemoryRegion instance, e.g. |size| must be equal to the
@@ -173,6 +212,13 @@ class BASE_EXPORT PlatformSharedMemoryRegion {
   bool ConvertToReadOnly(void* mapped_addr);
 #endif  // defined(OS_MACOSX) && !defined(OS_IOS)
 
+  // Returns whether the memory of the region is sealed against writes, which
+  // ConvertToReadOnly() does on Linux where memfd sealing is supported. A
+  // sealed region can't be mapped writable anymore through any handle in any
+  // process, although the writable mappings made before may stay. Only costs
+  // a system call, and is always false on other platforms.
+  bool IsWriteSealed() const;
+
   // Maps |size| bytes of the shared memory region starting with the given
   // |offset| into the caller's address space. |offset| must be aligned to value
   // of |SysInfo::VMAllocationGranularity()|. Fails if requested bytes are out
@@ -198,6 +244,10 @@ class BASE_EXPORT PlatformSharedMemoryRegion {
   FRIEND_TEST_ALL_PREFIXES(PlatformSharedMemoryRegionTest,
                            CheckPlatformHandlePermissionsCorrespondToMode);
   static PlatformSharedMemoryRegion Create(Mode mode, size_t size);
+  static PlatformSharedMemoryRegion CreateWithOptions(
+      Mode mode,
+      size_t size,
+      const CreateOptions& options);
 
   static bool CheckPlatformHandlePermissionsCorrespondToMode(
       PlatformHandle handle,
@@ -213,6 +263,9 @@ class BASE_EXPORT PlatformSharedMemoryRegion {
   Mode mode_ = Mode::kReadOnly;
   size_t size_ = 0;
   UnguessableToken guid_;
+#if defined(OS_LINUX)
+  bool align_mappings_ = false;
+#endif
 
   DISALLOW_COPY_AND_ASSIGN(PlatformSharedMemoryRegion);
 };
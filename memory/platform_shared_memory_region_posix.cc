@@ -4,6 +4,7 @@
 
 #include "base/memory/platform_shared_memory_region.h"
 
+#include <errno.h>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -13,6 +14,39 @@
 #include "base/threading/thread_restrictions.h"
 #include "build/build_config.h"
 
+#if defined(OS_LINUX)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+
+#include "base/bits.h"
+#include "base/process/process_metrics.h"
+#include "base/strings/stringprintf.h"
+
+// Not defined by older C libraries.
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef MFD_HUGETLB
+#define MFD_HUGETLB 0x0004U
+#endif
+#ifndef MFD_HUGE_2MB
+#define MFD_HUGE_2MB (21U << 26)
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_GET_SEALS 1034
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#define F_SEAL_WRITE 0x0008
+#endif
+#ifndef F_SEAL_FUTURE_WRITE
+#define F_SEAL_FUTURE_WRITE 0x0010
+#endif
+#endif  // defined(OS_LINUX)
+
 namespace base {
 namespace subtle {
 
@@ -48,6 +82,135 @@ bool CheckFDAccessMode(int fd, int expected_mode) {
   return true;
 }
 
+#if defined(OS_LINUX)
+// The largest NUMA node that CreateOptions::numa_node can name.
+constexpr int kMaxNumaNode = 1023;
+
+// Creates the descriptors of a memfd of |size| bytes, with |flags| added to
+// those of memfd_create(). The size is sealed so that no process can shrink
+// the memory under the mappings of another, and sealing against writes is
+// left to ConvertToReadOnly(). Returns invalid descriptors on failure.
+ScopedFDPair CreateMemfdFDs(PlatformSharedMemoryRegion::Mode mode,
+                            size_t size,
+                            unsigned int flags) {
+  ScopedFD fd(static_cast<int>(syscall(__NR_memfd_create, "shared_memory",
+                                       MFD_CLOEXEC | MFD_ALLOW_SEALING |
+                                           flags)));
+  if (!fd.is_valid())
+    return {};
+  if (HANDLE_EINTR(ftruncate(fd.get(), size)) != 0) {
+    DPLOG(ERROR) << "ftruncate " << fd.get() << " failed";
+    return {};
+  }
+  if (fcntl(fd.get(), F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0) {
+    DPLOG(ERROR) << "fcntl(" << fd.get() << ", F_ADD_SEALS) failed";
+    return {};
+  }
+
+  ScopedFD readonly_fd;
+  if (mode == PlatformSharedMemoryRegion::Mode::kWritable) {
+    // A memfd has no path but its link in /proc to open it again read-only.
+    const std::string path = StringPrintf("/proc/self/fd/%d", fd.get());
+    readonly_fd.reset(HANDLE_EINTR(open(path.c_str(), O_RDONLY)));
+    if (!readonly_fd.is_valid()) {
+      DPLOG(ERROR) << "open(\"" << path << "\", O_RDONLY) failed";
+      return {};
+    }
+  }
+  return ScopedFDPair(std::move(fd), std::move(readonly_fd));
+}
+
+// Seals the memory of |fd| against writes if it's a memfd. F_SEAL_FUTURE_WRITE
+// leaves the writable mappings made before alone. Where it isn't supported,
+// F_SEAL_WRITE is used instead, which fails if there are any.
+void SealAgainstWrites(int fd) {
+  if (fcntl(fd, F_ADD_SEALS, F_SEAL_FUTURE_WRITE) != 0 && errno == EINVAL)
+    fcntl(fd, F_ADD_SEALS, F_SEAL_WRITE);
+}
+
+// Binds the pages of the |size| bytes mapped at |memory| to |numa_node|. On
+// tmpfs, the file keeps the policy for all its mappings. On hugetlbfs, it
+// only applies to the pages faulted in through this mapping.
+bool BindToNumaNode(void* memory, size_t size, int numa_node) {
+  constexpr int kBitsPerWord = 8 * sizeof(unsigned long);
+  unsigned long node_mask[(kMaxNumaNode + 1) / kBitsPerWord] = {};
+  node_mask[numa_node / kBitsPerWord] |= 1UL << (numa_node % kBitsPerWord);
+  // The kernel reads one bit less of the mask than it's told.
+  if (syscall(__NR_mbind, memory, size, MPOL_BIND, node_mask,
+              kMaxNumaNode + 2, 0) != 0) {
+    DPLOG(ERROR) << "mbind to node " << numa_node << " failed";
+    return false;
+  }
+  return true;
+}
+
+// Binds and allocates the pages of the region of |size| bytes of |fd| as
+// |options| ask, through a temporary mapping. Mapping huge pages reserves
+// them, which fails if the pool is short.
+bool SetUpPages(int fd,
+                size_t size,
+                const PlatformSharedMemoryRegion::CreateOptions& options) {
+  void* memory =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (memory == MAP_FAILED) {
+    DPLOG(ERROR) << "mmap " << fd << " failed";
+    return false;
+  }
+
+  bool success = options.numa_node < 0 ||
+                 BindToNumaNode(memory, size, options.numa_node);
+  if (success && options.use_huge_pages &&
+      (options.prefault || options.numa_node >= 0)) {
+    // Touching the pages can't fail since they are reserved.
+    for (size_t offset = 0; offset < size;
+         offset += PlatformSharedMemoryRegion::kHugePageSize) {
+      static_cast<volatile uint8_t*>(memory)[offset] = 0;
+    }
+  } else if (success && options.prefault) {
+    // Unlike touching the pages, fallocate() fails rather than raise SIGBUS
+    // when tmpfs is full.
+    if (HANDLE_EINTR(fallocate(fd, 0, 0, size)) != 0) {
+      DPLOG(ERROR) << "fallocate " << fd << " failed";
+      success = false;
+    }
+  }
+
+  if (munmap(memory, size) != 0)
+    DPLOG(ERROR) << "munmap";
+  return success;
+}
+
+// Maps |size| bytes of |fd| from |offset| at an address aligned to
+// |alignment|, by reserving |alignment| bytes more of address space than
+// needed and unmapping what's left around the mapping. Returns MAP_FAILED on
+// failure.
+void* MapAligned(size_t size, int prot, int fd, off_t offset,
+                 size_t alignment) {
+  const size_t page_aligned_size = bits::Align(size, GetPageSize());
+  const size_t reserved_size = page_aligned_size + alignment;
+  void* reservation = mmap(nullptr, reserved_size, PROT_NONE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (reservation == MAP_FAILED)
+    return MAP_FAILED;
+
+  const uintptr_t reserved_start = reinterpret_cast<uintptr_t>(reservation);
+  const uintptr_t start = bits::Align(reserved_start, alignment);
+  void* memory = mmap(reinterpret_cast<void*>(start), size, prot,
+                      MAP_SHARED | MAP_FIXED, fd, offset);
+  if (memory == MAP_FAILED) {
+    munmap(reservation, reserved_size);
+    return MAP_FAILED;
+  }
+
+  if (start > reserved_start)
+    munmap(reservation, start - reserved_start);
+  const uintptr_t end = start + page_aligned_size;
+  if (reserved_start + reserved_size > end)
+    munmap(reinterpret_cast<void*>(end), reserved_start + reserved_size - end);
+  return memory;
+}
+#endif  // defined(OS_LINUX)
+
 }  // namespace
 
 ScopedFDPair::ScopedFDPair() = default;
@@ -129,8 +292,12 @@ PlatformSharedMemoryRegion PlatformSharedMemoryRegion::Duplicate() const {
     return {};
   }
 
-  return PlatformSharedMemoryRegion({std::move(duped_fd), ScopedFD()}, mode_,
+  PlatformSharedMemoryRegion region({std::move(duped_fd), ScopedFD()}, mode_,
                                     size_, guid_);
+#if defined(OS_LINUX)
+  region.align_mappings_ = align_mappings_;
+#endif
+  return region;
 }
 
 bool PlatformSharedMemoryRegion::ConvertToReadOnly() {
@@ -140,11 +307,27 @@ bool PlatformSharedMemoryRegion::ConvertToReadOnly() {
   CHECK_EQ(mode_, Mode::kWritable)
       << "Only writable shared memory region can be converted to read-only";
 
+#if defined(OS_LINUX)
+  // Unlike closing the writable descriptor, the seal holds in the processes
+  // which hold a copy of it.
+  SealAgainstWrites(handle_.fd.get());
+#endif
+
   handle_.fd.reset(handle_.readonly_fd.release());
   mode_ = Mode::kReadOnly;
   return true;
 }
 
+#if defined(OS_LINUX)
+bool PlatformSharedMemoryRegion::IsWriteSealed() const {
+  if (!IsValid())
+    return false;
+
+  int seals = fcntl(handle_.fd.get(), F_GET_SEALS);
+  return seals != -1 && (seals & (F_SEAL_WRITE | F_SEAL_FUTURE_WRITE));
+}
+#endif  // defined(OS_LINUX)
+
 bool PlatformSharedMemoryRegion::MapAt(off_t offset,
                                        size_t size,
                                        void** memory,
@@ -158,8 +341,20 @@ bool PlatformSharedMemoryRegion::MapAt(off_t offset,
   }
 
   bool write_allowed = mode_ != Mode::kReadOnly;
-  *memory = mmap(nullptr, size, PROT_READ | (write_allowed ? PROT_WRITE : 0),
-                 MAP_SHARED, handle_.fd.get(), offset);
+  const int prot = PROT_READ | (write_allowed ? PROT_WRITE : 0);
+#if defined(OS_LINUX)
+  if (align_mappings_ && size >= kHugePageSize) {
+    *memory =
+        MapAligned(size, prot, handle_.fd.get(), offset, kHugePageSize);
+    // Fails harmlessly where transparent huge pages are unsupported.
+    if (*memory != MAP_FAILED)
+      madvise(*memory, size, MADV_HUGEPAGE);
+  } else {
+    *memory = mmap(nullptr, size, prot, MAP_SHARED, handle_.fd.get(), offset);
+  }
+#else
+  *memory = mmap(nullptr, size, prot, MAP_SHARED, handle_.fd.get(), offset);
+#endif
 
   bool mmap_succeeded = *memory && *memory != reinterpret_cast<void*>(-1);
   if (!mmap_succeeded) {
@@ -189,6 +384,16 @@ PlatformSharedMemoryRegion PlatformSharedMemoryRegion::Create(Mode mode,
   CHECK_NE(mode, Mode::kReadOnly) << "Creating a region in read-only mode will "
                                      "lead to this region being non-modifiable";
 
+#if defined(OS_LINUX)
+  // Unlike a file, a memfd can be sealed against writes by
+  // ConvertToReadOnly(). Kernels older than 3.17 don't support it.
+  ScopedFDPair fds = CreateMemfdFDs(mode, size, 0);
+  if (fds.fd.is_valid()) {
+    return PlatformSharedMemoryRegion(std::move(fds), mode, size,
+                                      UnguessableToken::Create());
+  }
+#endif
+
   // This function theoretically can block on the disk, but realistically
   // the temporary files we create will just go into the buffer cache
   // and be deleted before they ever make it out to disk.
@@ -259,6 +464,49 @@ PlatformSharedMemoryRegion PlatformSharedMemoryRegion::Create(Mode mode,
 #endif  // !defined(OS_NACL)
 }
 
+#if defined(OS_LINUX)
+// static
+PlatformSharedMemoryRegion PlatformSharedMemoryRegion::CreateWithOptions(
+    Mode mode,
+    size_t size,
+    const CreateOptions& options) {
+  if (options.numa_node > kMaxNumaNode)
+    return {};
+
+  PlatformSharedMemoryRegion region;
+  if (options.use_huge_pages) {
+    const size_t max_size = std::numeric_limits<int>::max();
+    if (size == 0 || size > max_size)
+      return {};
+    size = bits::Align(size, kHugePageSize);
+    if (size > max_size)
+      return {};
+    CHECK_NE(mode, Mode::kReadOnly) << "Creating a region in read-only mode "
+                                       "will lead to this region being "
+                                       "non-modifiable";
+
+    ScopedFDPair fds = CreateMemfdFDs(mode, size, MFD_HUGETLB | MFD_HUGE_2MB);
+    if (!fds.fd.is_valid()) {
+      DPLOG(ERROR) << "Creating huge page shared memory failed";
+      return {};
+    }
+    region = PlatformSharedMemoryRegion(std::move(fds), mode, size,
+                                        UnguessableToken::Create());
+  } else {
+    region = Create(mode, size);
+  }
+  if (!region.IsValid())
+    return {};
+
+  if (options.use_huge_pages || options.numa_node >= 0 || options.prefault) {
+    if (!SetUpPages(region.handle_.fd.get(), size, options))
+      return {};
+  }
+  region.align_mappings_ = options.align_mappings;
+  return region;
+}
+#endif  // defined(OS_LINUX)
+
 bool PlatformSharedMemoryRegion::CheckPlatformHandlePermissionsCorrespondToMode(
     PlatformHandle handle,
     Mode mode,
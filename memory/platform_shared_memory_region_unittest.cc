@@ -16,6 +16,14 @@
 #include <mach/mach_vm.h>
 #endif
 
+#if defined(OS_LINUX)
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "base/files/scoped_file.h"
+#include "base/posix/eintr_wrapper.h"
+#endif
+
 namespace base {
 namespace subtle {
 
@@ -170,6 +178,114 @@ TEST_F(PlatformSharedMemoryRegionTest,
 }
 #endif
 
+#if defined(OS_LINUX)
+// Tests that the mappings of a region created with |align_mappings| are
+// aligned to huge pages, and that the mappings share the memory.
+TEST_F(PlatformSharedMemoryRegionTest, AlignMappings) {
+  constexpr size_t kSize = 2 * PlatformSharedMemoryRegion::kHugePageSize;
+  PlatformSharedMemoryRegion::CreateOptions options;
+  options.align_mappings = true;
+  options.prefault = true;
+  PlatformSharedMemoryRegion region =
+      PlatformSharedMemoryRegion::CreateWritable(kSize, options);
+  ASSERT_TRUE(region.IsValid());
+  EXPECT_EQ(kSize, region.GetSize());
+
+  WritableSharedMemoryMapping mappings[3];
+  for (WritableSharedMemoryMapping& mapping : mappings) {
+    mapping = MapForTesting(&region);
+    ASSERT_TRUE(mapping.IsValid());
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(mapping.memory()) %
+                      PlatformSharedMemoryRegion::kHugePageSize);
+  }
+  static_cast<char*>(mappings[0].memory())[kSize - 1] = 'a';
+  EXPECT_EQ('a', static_cast<char*>(mappings[2].memory())[kSize - 1]);
+
+  // Smaller mappings aren't aligned, which would waste address space.
+  WritableSharedMemoryMapping small_mapping =
+      MapAtForTesting(&region, 0, kRegionSize);
+  EXPECT_TRUE(small_mapping.IsValid());
+
+  ASSERT_TRUE(region.ConvertToReadOnly());
+  WritableSharedMemoryMapping read_only_mapping = MapForTesting(&region);
+  ASSERT_TRUE(read_only_mapping.IsValid());
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(read_only_mapping.memory()) %
+                    PlatformSharedMemoryRegion::kHugePageSize);
+  EXPECT_EQ('a', static_cast<char*>(read_only_mapping.memory())[kSize - 1]);
+}
+
+// Tests that converting a region to read-only seals it against writes, so that
+// a copy of its writable handle can't map it writable anymore.
+TEST_F(PlatformSharedMemoryRegionTest, ConvertToReadOnlySealsMemory) {
+  PlatformSharedMemoryRegion region =
+      PlatformSharedMemoryRegion::CreateWritable(kRegionSize);
+  ASSERT_TRUE(region.IsValid());
+  EXPECT_FALSE(region.IsWriteSealed());
+  WritableSharedMemoryMapping mapping = MapForTesting(&region);
+  ASSERT_TRUE(mapping.IsValid());
+  ScopedFD writable_fd(HANDLE_EINTR(dup(region.GetPlatformHandle().fd)));
+  ASSERT_TRUE(writable_fd.is_valid());
+
+  ASSERT_TRUE(region.ConvertToReadOnly());
+  if (!region.IsWriteSealed())
+    return;  // memfd sealing is unsupported.
+  void* memory = mmap(nullptr, kRegionSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      writable_fd.get(), 0);
+  EXPECT_EQ(MAP_FAILED, memory);
+  if (memory != MAP_FAILED)
+    munmap(memory, kRegionSize);
+
+  // The mapping made before the conversion stays writable.
+  static_cast<char*>(mapping.memory())[0] = 'a';
+  WritableSharedMemoryMapping read_only_mapping = MapForTesting(&region);
+  ASSERT_TRUE(read_only_mapping.IsValid());
+  EXPECT_EQ('a', static_cast<char*>(read_only_mapping.memory())[0]);
+
+  PlatformSharedMemoryRegion unsafe_region =
+      PlatformSharedMemoryRegion::CreateUnsafe(kRegionSize);
+  ASSERT_TRUE(unsafe_region.IsValid());
+  EXPECT_FALSE(unsafe_region.IsWriteSealed());
+}
+
+// Tests that a region can be bound to the first NUMA node, which always
+// exists.
+TEST_F(PlatformSharedMemoryRegionTest, BindToNumaNode) {
+  PlatformSharedMemoryRegion::CreateOptions options;
+  options.numa_node = 0;
+  options.prefault = true;
+  PlatformSharedMemoryRegion region =
+      PlatformSharedMemoryRegion::CreateUnsafe(kRegionSize, options);
+  ASSERT_TRUE(region.IsValid());
+  WritableSharedMemoryMapping mapping = MapForTesting(&region);
+  ASSERT_TRUE(mapping.IsValid());
+  static_cast<char*>(mapping.memory())[0] = 'a';
+
+  options.numa_node = 1 << 20;
+  EXPECT_FALSE(
+      PlatformSharedMemoryRegion::CreateUnsafe(kRegionSize, options).IsValid());
+}
+
+// Tests that a region of huge pages is rounded up to a whole number of huge
+// pages. Creation fails when the system has no huge page to spare, which is
+// the default.
+TEST_F(PlatformSharedMemoryRegionTest, HugePages) {
+  PlatformSharedMemoryRegion::CreateOptions options;
+  options.use_huge_pages = true;
+  PlatformSharedMemoryRegion region =
+      PlatformSharedMemoryRegion::CreateWritable(kRegionSize, options);
+  if (!region.IsValid())
+    return;
+  EXPECT_EQ(PlatformSharedMemoryRegion::kHugePageSize, region.GetSize());
+  WritableSharedMemoryMapping mapping = MapForTesting(&region);
+  ASSERT_TRUE(mapping.IsValid());
+  static_cast<char*>(mapping.memory())[0] = 'a';
+  ASSERT_TRUE(region.ConvertToReadOnly());
+  WritableSharedMemoryMapping read_only_mapping = MapForTesting(&region);
+  ASSERT_TRUE(read_only_mapping.IsValid());
+  EXPECT_EQ('a', static_cast<char*>(read_only_mapping.memory())[0]);
+}
+#endif  // defined(OS_LINUX)
+
 #if defined(OS_MACOSX) && !defined(OS_IOS)
 // Tests that protection bits are set correctly for read-only region on MacOS.
 TEST_F(PlatformSharedMemoryRegionTest, MapCurrentAndMaxProtectionSetCorrectly) {
@@ -86,6 +86,14 @@ class BASE_EXPORT ReadOnlySharedMemoryRegion {
     return handle_.GetSize();
   }
 
+  // Returns whether no process can map the region writable anymore, whatever
+  // handle it holds, so that only the mapping returned by Create() can change
+  // it. See subtle::PlatformSharedMemoryRegion::IsWriteSealed().
+  bool IsWriteSealed() const {
+    DCHECK(IsValid());
+    return handle_.IsWriteSealed();
+  }
+
  private:
   explicit ReadOnlySharedMemoryRegion(
       subtle::PlatformSharedMemoryRegion handle);
@@ -4,6 +4,9 @@
 
 #include "base/memory/ref_counted_memory.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <utility>
 
 #include "base/logging.h"
@@ -11,6 +14,34 @@
 
 namespace base {
 
+namespace {
+
+// A range of bytes in another RefCountedMemory, which it keeps alive.
+class RefCountedMemoryRange : public RefCountedMemory {
+ public:
+  RefCountedMemoryRange(scoped_refptr<RefCountedMemory> memory,
+                        const char* data,
+                        size_t size)
+      : memory_(std::move(memory)), data_(data), size_(size) {}
+
+  // RefCountedMemory:
+  const unsigned char* front() const override {
+    return size_ ? reinterpret_cast<const unsigned char*>(data_) : nullptr;
+  }
+  size_t size() const override { return size_; }
+
+ private:
+  ~RefCountedMemoryRange() override = default;
+
+  const scoped_refptr<RefCountedMemory> memory_;
+  const char* const data_;
+  const size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(RefCountedMemoryRange);
+};
+
+}  // namespace
+
 bool RefCountedMemory::Equals(
     const scoped_refptr<RefCountedMemory>& other) const {
   return other.get() &&
@@ -129,4 +160,102 @@ RefCountedSharedMemoryMapping::CreateFromWholeRegion(
   return MakeRefCounted<RefCountedSharedMemoryMapping>(std::move(mapping));
 }
 
+// static
+constexpr size_t RefCountedSlice::kInlineCapacity;
+
+RefCountedSlice::RefCountedSlice() = default;
+
+RefCountedSlice::RefCountedSlice(scoped_refptr<RefCountedMemory> memory) {
+  if (!memory)
+    return;
+  data_ = memory->front_as<char>();
+  size_ = memory->size();
+  memory_ = std::move(memory);
+}
+
+RefCountedSlice::RefCountedSlice(scoped_refptr<RefCountedMemory> memory,
+                                 const char* data,
+                                 size_t size)
+    : memory_(std::move(memory)), data_(data), size_(size) {}
+
+// static
+RefCountedSlice RefCountedSlice::CopyFrom(StringPiece bytes) {
+  if (bytes.size() > kInlineCapacity) {
+    std::string copy = bytes.as_string();
+    return TakeString(&copy);
+  }
+  RefCountedSlice slice;
+  slice.SetInline(bytes);
+  return slice;
+}
+
+// static
+RefCountedSlice RefCountedSlice::TakeString(std::string* to_destroy) {
+  if (to_destroy->size() <= kInlineCapacity) {
+    RefCountedSlice slice;
+    slice.SetInline(*to_destroy);
+    to_destroy->clear();
+    return slice;
+  }
+  return RefCountedSlice(RefCountedString::TakeString(to_destroy));
+}
+
+RefCountedSlice::RefCountedSlice(const RefCountedSlice& other) = default;
+
+RefCountedSlice::RefCountedSlice(RefCountedSlice&& other) noexcept
+    : memory_(std::move(other.memory_)),
+      data_(other.data_),
+      size_(other.size_) {
+  if (!memory_)
+    memcpy(inline_data_, other.inline_data_, size_);
+  other.size_ = 0;
+}
+
+RefCountedSlice& RefCountedSlice::operator=(const RefCountedSlice& other) =
+    default;
+
+RefCountedSlice& RefCountedSlice::operator=(RefCountedSlice&& other) noexcept {
+  if (this != &other) {
+    memory_ = std::move(other.memory_);
+    data_ = other.data_;
+    size_ = other.size_;
+    if (!memory_)
+      memcpy(inline_data_, other.inline_data_, size_);
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+RefCountedSlice::~RefCountedSlice() = default;
+
+RefCountedSlice RefCountedSlice::substr(size_t pos, size_t count) const {
+  DCHECK_LE(pos, size_);
+  count = std::min(count, size_ - pos);
+  if (count <= kInlineCapacity) {
+    RefCountedSlice slice;
+    slice.SetInline(StringPiece(data() + pos, count));
+    return slice;
+  }
+  return RefCountedSlice(memory_, data_ + pos, count);
+}
+
+scoped_refptr<RefCountedMemory> RefCountedSlice::ToRefCountedMemory() const {
+  if (!memory_) {
+    return MakeRefCounted<RefCountedBytes>(
+        reinterpret_cast<const unsigned char*>(inline_data_), size_);
+  }
+  if (memory_->front_as<char>() == data_ && memory_->size() == size_)
+    return memory_;
+  return MakeRefCounted<RefCountedMemoryRange>(memory_, data_, size_);
+}
+
+void RefCountedSlice::SetInline(StringPiece bytes) {
+  DCHECK_LE(bytes.size(), kInlineCapacity);
+  memory_ = nullptr;
+  // memcpy() doesn't accept null pointers, even with a zero size.
+  if (!bytes.empty())
+    memcpy(inline_data_, bytes.data(), bytes.size());
+  size_ = bytes.size();
+}
+
 }  //  namespace base
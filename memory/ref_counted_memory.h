@@ -16,6 +16,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/shared_memory.h"
 #include "base/memory/shared_memory_mapping.h"
+#include "base/strings/string_piece.h"
 
 namespace base {
 
@@ -188,6 +189,75 @@ class BASE_EXPORT RefCountedSharedMemoryMapping : public RefCountedMemory {
   DISALLOW_COPY_AND_ASSIGN(RefCountedSharedMemoryMapping);
 };
 
+// An immutable byte string which shares the RefCountedMemory it points into,
+// so that copies and substrings don't copy the bytes. Small contents are stored
+// inline instead, without a heap allocation. Since the memory is immutable and
+// thread-safe ref counted, slices can be passed to other sequences freely.
+//
+//   RefCountedSlice contents = RefCountedSlice::TakeString(&file_contents);
+//   RefCountedSlice header = contents.substr(0, header_size);
+//   Process(header.AsStringPiece());
+class BASE_EXPORT RefCountedSlice {
+ public:
+  // Contents up to this size are stored inline.
+  static constexpr size_t kInlineCapacity = 24;
+
+  // An empty slice.
+  RefCountedSlice();
+
+  // Shares all of |memory|, which may be null.
+  explicit RefCountedSlice(scoped_refptr<RefCountedMemory> memory);
+
+  // Copies |bytes|, inline if they are small enough.
+  static RefCountedSlice CopyFrom(StringPiece bytes);
+
+  // Takes the contents of |to_destroy| without copying them, unless they are
+  // small enough to be stored inline.
+  static RefCountedSlice TakeString(std::string* to_destroy);
+
+  RefCountedSlice(const RefCountedSlice& other);
+  RefCountedSlice(RefCountedSlice&& other) noexcept;
+  RefCountedSlice& operator=(const RefCountedSlice& other);
+  RefCountedSlice& operator=(RefCountedSlice&& other) noexcept;
+  ~RefCountedSlice();
+
+  const char* data() const { return memory_ ? data_ : inline_data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  StringPiece AsStringPiece() const { return StringPiece(data(), size_); }
+
+  // Returns the |count| bytes from |pos| on, or fewer if the slice ends
+  // first, in O(1): the result shares the memory of this slice, unless it is
+  // small enough to be stored inline.
+  RefCountedSlice substr(size_t pos, size_t count = StringPiece::npos) const;
+
+  // Returns a RefCountedMemory holding the bytes of this slice, for the APIs
+  // which take one. This doesn't copy the bytes when the slice isn't inline.
+  scoped_refptr<RefCountedMemory> ToRefCountedMemory() const;
+
+  bool operator==(const RefCountedSlice& other) const {
+    return AsStringPiece() == other.AsStringPiece();
+  }
+  bool operator!=(const RefCountedSlice& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  RefCountedSlice(scoped_refptr<RefCountedMemory> memory,
+                  const char* data,
+                  size_t size);
+
+  void SetInline(StringPiece bytes);
+
+  // Null when the bytes are stored inline.
+  scoped_refptr<RefCountedMemory> memory_;
+  // The first byte, in |memory_|.
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  char inline_data_[kInlineCapacity];
+};
+
 }  // namespace base
 
 #endif  // BASE_MEMORY_REF_COUNTED_MEMORY_H_
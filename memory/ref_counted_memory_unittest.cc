@@ -6,6 +6,7 @@
 
 #include <stdint.h>
 
+#include <string>
 #include <utility>
 
 #include "base/memory/read_only_shared_memory_region.h"
@@ -142,4 +143,75 @@ TEST(RefCountedMemoryUnitTest, EqualsNull) {
   EXPECT_FALSE(mem->Equals(nullptr));
 }
 
+TEST(RefCountedMemoryUnitTest, RefCountedSliceInline) {
+  RefCountedSlice empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ("", empty.AsStringPiece());
+  EXPECT_EQ(empty, RefCountedSlice(nullptr));
+
+  std::string s("short");
+  RefCountedSlice slice = RefCountedSlice::TakeString(&s);
+  EXPECT_EQ("short", slice.AsStringPiece());
+  EXPECT_EQ(0U, s.size());
+
+  RefCountedSlice copy = slice;
+  EXPECT_EQ(slice, copy);
+  EXPECT_NE(slice.data(), copy.data());
+  EXPECT_EQ("or", slice.substr(2, 2).AsStringPiece());
+  EXPECT_EQ("ort", slice.substr(2).AsStringPiece());
+  EXPECT_EQ("", slice.substr(5).AsStringPiece());
+
+  scoped_refptr<RefCountedMemory> mem = slice.ToRefCountedMemory();
+  ASSERT_EQ(5U, mem->size());
+  EXPECT_EQ('s', mem->front()[0]);
+}
+
+TEST(RefCountedMemoryUnitTest, RefCountedSliceShared) {
+  std::string s(100, 'x');
+  s[50] = 'y';
+  const char* chars = s.data();
+  RefCountedSlice slice = RefCountedSlice::TakeString(&s);
+  ASSERT_EQ(100U, slice.size());
+  // The characters were moved, not copied.
+  EXPECT_EQ(chars, slice.data());
+
+  RefCountedSlice copy = slice;
+  EXPECT_EQ(chars, copy.data());
+  RefCountedSlice middle = slice.substr(40, 30);
+  EXPECT_EQ(chars + 40, middle.data());
+  EXPECT_EQ(30U, middle.size());
+  EXPECT_EQ('y', middle.data()[10]);
+
+  // Small substrings are copied inline, and outlive the original memory.
+  RefCountedSlice small = slice.substr(49, 3);
+  slice = RefCountedSlice();
+  copy = RefCountedSlice();
+  EXPECT_EQ("xyx", small.AsStringPiece());
+  EXPECT_EQ('y', middle.data()[10]);
+
+  scoped_refptr<RefCountedMemory> mem = middle.ToRefCountedMemory();
+  ASSERT_EQ(30U, mem->size());
+  EXPECT_EQ(chars + 40, mem->front_as<char>());
+  middle = RefCountedSlice();
+  EXPECT_EQ('y', mem->front()[10]);
+
+  // Wrapping the whole memory returns it.
+  scoped_refptr<RefCountedMemory> whole =
+      RefCountedSlice(mem).ToRefCountedMemory();
+  EXPECT_EQ(mem, whole);
+}
+
+TEST(RefCountedMemoryUnitTest, RefCountedSliceMove) {
+  RefCountedSlice slice = RefCountedSlice::CopyFrom(std::string(50, 'a'));
+  const char* chars = slice.data();
+  RefCountedSlice moved = std::move(slice);
+  EXPECT_EQ(chars, moved.data());
+  EXPECT_TRUE(slice.empty());
+
+  RefCountedSlice small = RefCountedSlice::CopyFrom("small");
+  moved = std::move(small);
+  EXPECT_EQ("small", moved.AsStringPiece());
+  EXPECT_TRUE(small.empty());
+}
+
 }  //  namespace base
@@ -0,0 +1,32 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/sequence_local_weak_ptr.h"
+
+namespace base {
+namespace internal {
+
+SequenceLocalWeakFlag::SequenceLocalWeakFlag() {
+  // Like WeakReference::Flag, only bind when first checked or invalidated.
+  sequence_checker_.DetachFromSequence();
+}
+
+void SequenceLocalWeakFlag::Invalidate() {
+  // A single ref means that there are no pointers left, so the factory may be
+  // destroyed on another sequence.
+  DCHECK(sequence_checker_.CalledOnValidSequence() || HasOneRef())
+      << "SequenceLocalWeakPtrs must be invalidated on their sequence.";
+  is_valid_ = false;
+}
+
+bool SequenceLocalWeakFlag::IsValid() const {
+  DCHECK(sequence_checker_.CalledOnValidSequence())
+      << "SequenceLocalWeakPtrs must be checked on their sequence.";
+  return is_valid_;
+}
+
+SequenceLocalWeakFlag::~SequenceLocalWeakFlag() = default;
+
+}  // namespace internal
+}  // namespace base
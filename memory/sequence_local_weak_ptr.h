@@ -0,0 +1,193 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// SequenceLocalWeakPtr<T> and SequenceLocalWeakPtrFactory<T> are a cheaper
+// variant of WeakPtr<T> and WeakPtrFactory<T> (see weak_ptr.h), for objects
+// whose weak pointers never leave their sequence.
+//
+// A WeakPtr may be copied and destroyed on any sequence, so the flag it shares
+// with its factory is reference counted atomically. A SequenceLocalWeakPtr
+// must instead be copied, moved, checked and destroyed only on the sequence to
+// which its factory is bound, which lets its flag use a plain reference count.
+// This includes SequenceLocalWeakPtrs bound into callbacks: only post those to
+// a task runner for the same sequence, and never one which may destroy pending
+// tasks on another thread when it shuts down.
+//
+// In DCHECK builds, the reference count and the flag are checked by
+// SequenceCheckers, just like WeakPtr's flag is, so misuse is caught there.
+// Otherwise the checks are compiled out and misuse is a data race.
+//
+// As with WeakPtrFactory, the factory becomes bound to the sequence on which
+// its first outstanding pointer is used, and unbound again once all of its
+// pointers are gone.
+//
+// EXAMPLE:
+//
+//  class Connection {
+//   public:
+//    Connection() : weak_factory_(this) {}
+//    void Start() {
+//      ThreadTaskRunnerHandle::Get()->PostTask(
+//          FROM_HERE, BindOnce(&Connection::Poll, weak_factory_.GetWeakPtr()));
+//    }
+//   private:
+//    void Poll();
+//    // Member variables should appear before the factory.
+//    SequenceLocalWeakPtrFactory<Connection> weak_factory_;
+//  };
+
+#ifndef BASE_MEMORY_SEQUENCE_LOCAL_WEAK_PTR_H_
+#define BASE_MEMORY_SEQUENCE_LOCAL_WEAK_PTR_H_
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "base/base_export.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/sequence_checker.h"
+
+namespace base {
+
+template <typename T> class SequenceLocalWeakPtr;
+template <typename T> class SequenceLocalWeakPtrFactory;
+
+namespace internal {
+
+// The validity flag shared by a SequenceLocalWeakPtrFactory and its pointers.
+// DO NOT USE THIS CLASS DIRECTLY YOURSELF.
+class BASE_EXPORT SequenceLocalWeakFlag
+    : public RefCounted<SequenceLocalWeakFlag> {
+ public:
+  SequenceLocalWeakFlag();
+
+  void Invalidate();
+  bool IsValid() const;
+
+ private:
+  friend class base::RefCounted<SequenceLocalWeakFlag>;
+
+  ~SequenceLocalWeakFlag();
+
+  SequenceChecker sequence_checker_;
+  bool is_valid_ = true;
+
+  DISALLOW_COPY_AND_ASSIGN(SequenceLocalWeakFlag);
+};
+
+}  // namespace internal
+
+template <typename T>
+class SequenceLocalWeakPtr {
+ public:
+  SequenceLocalWeakPtr() = default;
+  SequenceLocalWeakPtr(std::nullptr_t) {}
+
+  // Allow conversion from U to T provided U "is a" T.
+  template <typename U>
+  SequenceLocalWeakPtr(const SequenceLocalWeakPtr<U>& other)
+      : flag_(other.flag_), ptr_(other.ptr_) {
+    static_assert(std::is_convertible<U*, T*>::value,
+                  "SequenceLocalWeakPtr<U> can't be converted to "
+                  "SequenceLocalWeakPtr<T>");
+  }
+  template <typename U>
+  SequenceLocalWeakPtr(SequenceLocalWeakPtr<U>&& other)
+      : flag_(std::move(other.flag_)), ptr_(other.ptr_) {
+    static_assert(std::is_convertible<U*, T*>::value,
+                  "SequenceLocalWeakPtr<U> can't be converted to "
+                  "SequenceLocalWeakPtr<T>");
+  }
+
+  T* get() const { return flag_ && flag_->IsValid() ? ptr_ : nullptr; }
+
+  T& operator*() const {
+    DCHECK(get() != nullptr);
+    return *get();
+  }
+  T* operator->() const {
+    DCHECK(get() != nullptr);
+    return get();
+  }
+
+  // Allow conditionals to test validity, e.g. if (weak_ptr) {...};
+  explicit operator bool() const { return get() != nullptr; }
+
+  void reset() {
+    flag_ = nullptr;
+    ptr_ = nullptr;
+  }
+
+ private:
+  template <typename U> friend class SequenceLocalWeakPtr;
+  friend class SequenceLocalWeakPtrFactory<T>;
+
+  SequenceLocalWeakPtr(scoped_refptr<internal::SequenceLocalWeakFlag> flag,
+                       T* ptr)
+      : flag_(std::move(flag)), ptr_(ptr) {}
+
+  scoped_refptr<internal::SequenceLocalWeakFlag> flag_;
+  T* ptr_ = nullptr;
+};
+
+// Allow callers to compare SequenceLocalWeakPtrs against nullptr to test
+// validity.
+template <class T>
+bool operator!=(const SequenceLocalWeakPtr<T>& weak_ptr, std::nullptr_t) {
+  return !(weak_ptr == nullptr);
+}
+template <class T>
+bool operator!=(std::nullptr_t, const SequenceLocalWeakPtr<T>& weak_ptr) {
+  return weak_ptr != nullptr;
+}
+template <class T>
+bool operator==(const SequenceLocalWeakPtr<T>& weak_ptr, std::nullptr_t) {
+  return weak_ptr.get() == nullptr;
+}
+template <class T>
+bool operator==(std::nullptr_t, const SequenceLocalWeakPtr<T>& weak_ptr) {
+  return weak_ptr == nullptr;
+}
+
+template <class T>
+class SequenceLocalWeakPtrFactory {
+ public:
+  explicit SequenceLocalWeakPtrFactory(T* ptr) : ptr_(ptr) { DCHECK(ptr_); }
+
+  ~SequenceLocalWeakPtrFactory() {
+    if (flag_)
+      flag_->Invalidate();
+  }
+
+  SequenceLocalWeakPtr<T> GetWeakPtr() {
+    // A new flag is created when there are no outstanding pointers, which
+    // lets the factory be used from another sequence.
+    if (!HasWeakPtrs())
+      flag_ = MakeRefCounted<internal::SequenceLocalWeakFlag>();
+    return SequenceLocalWeakPtr<T>(flag_, ptr_);
+  }
+
+  // Call this method to invalidate all existing weak pointers.
+  void InvalidateWeakPtrs() {
+    if (flag_) {
+      flag_->Invalidate();
+      flag_ = nullptr;
+    }
+  }
+
+  // Call this method to determine if any weak pointers exist.
+  bool HasWeakPtrs() const { return flag_ && !flag_->HasOneRef(); }
+
+ private:
+  scoped_refptr<internal::SequenceLocalWeakFlag> flag_;
+  T* const ptr_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(SequenceLocalWeakPtrFactory);
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_SEQUENCE_LOCAL_WEAK_PTR_H_
@@ -0,0 +1,176 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/sequence_local_weak_ptr.h"
+
+#include <memory>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/location.h"
+#include "base/single_thread_task_runner.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/test/gtest_util.h"
+#include "base/threading/thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+struct Base {
+  int value = 0;
+};
+struct Derived : public Base {};
+
+class Target {
+ public:
+  Target() : weak_factory_(this) {}
+
+  void Increment() { ++count_; }
+  int count() const { return count_; }
+
+  SequenceLocalWeakPtrFactory<Target>& weak_factory() { return weak_factory_; }
+
+ private:
+  int count_ = 0;
+  SequenceLocalWeakPtrFactory<Target> weak_factory_;
+};
+
+// Runs |task| on |thread| and waits for it to complete.
+void RunOnThread(Thread* thread, OnceClosure task) {
+  WaitableEvent done(WaitableEvent::ResetPolicy::MANUAL,
+                     WaitableEvent::InitialState::NOT_SIGNALED);
+  thread->task_runner()->PostTask(
+      FROM_HERE, BindOnce(
+                     [](OnceClosure task, WaitableEvent* done) {
+                       std::move(task).Run();
+                       done->Signal();
+                     },
+                     std::move(task), &done));
+  done.Wait();
+}
+
+}  // namespace
+
+TEST(SequenceLocalWeakPtrTest, Basic) {
+  int data;
+  SequenceLocalWeakPtrFactory<int> factory(&data);
+  SequenceLocalWeakPtr<int> ptr = factory.GetWeakPtr();
+  EXPECT_EQ(&data, ptr.get());
+  EXPECT_TRUE(ptr);
+  EXPECT_TRUE(ptr != nullptr);
+
+  SequenceLocalWeakPtr<int> copy = ptr;
+  EXPECT_EQ(&data, copy.get());
+  SequenceLocalWeakPtr<int> moved = std::move(copy);
+  EXPECT_EQ(&data, moved.get());
+
+  SequenceLocalWeakPtr<int> null_ptr = nullptr;
+  EXPECT_FALSE(null_ptr);
+  EXPECT_TRUE(null_ptr == nullptr);
+}
+
+TEST(SequenceLocalWeakPtrTest, UpCast) {
+  Derived data;
+  SequenceLocalWeakPtrFactory<Derived> factory(&data);
+  SequenceLocalWeakPtr<Base> ptr = factory.GetWeakPtr();
+  EXPECT_EQ(&data, ptr.get());
+  ptr->value = 1;
+  EXPECT_EQ(1, data.value);
+}
+
+TEST(SequenceLocalWeakPtrTest, OutOfScope) {
+  SequenceLocalWeakPtr<int> ptr;
+  {
+    int data;
+    SequenceLocalWeakPtrFactory<int> factory(&data);
+    ptr = factory.GetWeakPtr();
+    EXPECT_EQ(&data, ptr.get());
+  }
+  EXPECT_EQ(nullptr, ptr.get());
+}
+
+TEST(SequenceLocalWeakPtrTest, InvalidateWeakPtrs) {
+  int data;
+  SequenceLocalWeakPtrFactory<int> factory(&data);
+  SequenceLocalWeakPtr<int> ptr = factory.GetWeakPtr();
+  EXPECT_TRUE(factory.HasWeakPtrs());
+
+  factory.InvalidateWeakPtrs();
+  EXPECT_FALSE(ptr);
+  EXPECT_FALSE(factory.HasWeakPtrs());
+
+  // Pointers handed out afterwards are valid.
+  SequenceLocalWeakPtr<int> new_ptr = factory.GetWeakPtr();
+  EXPECT_EQ(&data, new_ptr.get());
+  EXPECT_FALSE(ptr);
+}
+
+TEST(SequenceLocalWeakPtrTest, HasWeakPtrs) {
+  int data;
+  SequenceLocalWeakPtrFactory<int> factory(&data);
+  EXPECT_FALSE(factory.HasWeakPtrs());
+  {
+    SequenceLocalWeakPtr<int> ptr = factory.GetWeakPtr();
+    EXPECT_TRUE(factory.HasWeakPtrs());
+  }
+  EXPECT_FALSE(factory.HasWeakPtrs());
+}
+
+TEST(SequenceLocalWeakPtrTest, BoundCallbackIsCancelled) {
+  Target target;
+  RepeatingClosure callback = BindRepeating(
+      &Target::Increment, target.weak_factory().GetWeakPtr());
+  callback.Run();
+  EXPECT_EQ(1, target.count());
+
+  target.weak_factory().InvalidateWeakPtrs();
+  callback.Run();
+  EXPECT_EQ(1, target.count());
+}
+
+TEST(SequenceLocalWeakPtrTest, MoveToAnotherSequenceWithoutPointers) {
+  Thread thread("SequenceLocalWeakPtrTest");
+  thread.Start();
+
+  Target target;
+  {
+    SequenceLocalWeakPtr<Target> ptr = target.weak_factory().GetWeakPtr();
+    ptr->Increment();
+  }
+
+  // With no outstanding pointers, the factory can be used on another thread.
+  RunOnThread(&thread, BindOnce(
+                           [](Target* target) {
+                             SequenceLocalWeakPtr<Target> ptr =
+                                 target->weak_factory().GetWeakPtr();
+                             ptr->Increment();
+                           },
+                           Unretained(&target)));
+  EXPECT_EQ(2, target.count());
+}
+
+TEST(SequenceLocalWeakPtrDeathTest, CopyOnAnotherSequence) {
+  // The default style "fast" does not support multi-threaded tests
+  // (introduces deadlock on Linux).
+  ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+  Thread thread("SequenceLocalWeakPtrTest");
+  thread.Start();
+
+  int data;
+  SequenceLocalWeakPtrFactory<int> factory(&data);
+  SequenceLocalWeakPtr<int> ptr = factory.GetWeakPtr();
+  EXPECT_EQ(&data, ptr.get());
+
+  // Unlike a WeakPtr, the pointer can't even be copied off its sequence.
+  ASSERT_DCHECK_DEATH(RunOnThread(
+      &thread, BindOnce([](const SequenceLocalWeakPtr<int>* ptr) {
+        SequenceLocalWeakPtr<int> copy = *ptr;
+      },
+                        Unretained(&ptr))));
+}
+
+}  // namespace base
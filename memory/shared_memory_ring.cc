@@ -0,0 +1,356 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/shared_memory_ring.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <utility>
+
+#include "base/bits.h"
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "base/threading/platform_thread.h"
+#include "build/build_config.h"
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include "base/synchronization/futex_linux.h"
+#endif
+
+namespace base {
+
+namespace internal {
+
+// The layout of the start of the region, followed by the records. The cursors
+// of each end are on their own cache line, so that the ends don't contend on
+// them more than needed.
+struct SharedMemoryRingHeader {
+  uint32_t magic;
+  // The size of the records area, a power of two.
+  uint32_t capacity;
+  std::atomic<int32_t> closed;
+
+  // The position after the last committed record, increasing forever. Written
+  // by the writer.
+  alignas(64) std::atomic<uint64_t> write_position;
+  // 1 while the reader sleeps waiting for a record.
+  std::atomic<int32_t> reader_waiting;
+
+  // The position after the last released record. Written by the reader.
+  alignas(64) std::atomic<uint64_t> read_position;
+  // 1 while the writer sleeps waiting for room.
+  std::atomic<int32_t> writer_waiting;
+};
+
+}  // namespace internal
+
+namespace {
+
+using internal::SharedMemoryRingHeader;
+
+constexpr uint32_t kMagic = 0x52494e47;  // "RING"
+constexpr uint32_t kMinCapacity = 4096;
+constexpr uint32_t kMaxCapacity = 1u << 31;
+
+// Each record is a RecordHeader followed by its data, padded to a multiple of
+// kRecordAlignment. A record doesn't wrap around the end of the ring: when it
+// doesn't fit before it, the rest of the ring is skipped with a padding record.
+struct RecordHeader {
+  uint32_t size;
+  uint32_t reserved;
+};
+constexpr size_t kRecordAlignment = 8;
+constexpr uint32_t kPaddingRecordSize = 0xffffffff;
+
+static_assert(sizeof(RecordHeader) % kRecordAlignment == 0,
+              "records must stay aligned");
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+              "std::atomic<uint64_t> can't be shared with another process");
+
+uint64_t GetRecordSize(uint32_t data_size) {
+  return sizeof(RecordHeader) +
+         ((uint64_t{data_size} + kRecordAlignment - 1) &
+          ~uint64_t{kRecordAlignment - 1});
+}
+
+// Waits until |is_ready| returns true, the ring is closed or |end_time| is
+// reached. Returns the last result of |is_ready|. |waiting| is the flag by
+// which the other end knows to wake this one up.
+template <typename Predicate>
+bool WaitUntil(SharedMemoryRingHeader* header,
+               std::atomic<int32_t>* waiting,
+               Predicate is_ready,
+               TimeTicks end_time) {
+  for (;;) {
+    if (is_ready())
+      return true;
+    if (header->closed.load(std::memory_order_acquire))
+      return false;
+    const TimeTicks now = TimeTicks::Now();
+    if (now >= end_time)
+      return false;
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+    // Pairs with the fence in Notify(): either this end sees the progress of
+    // the other one, or the other one sees the flag and wakes this one up.
+    waiting->store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (is_ready())
+      return true;
+    if (header->closed.load(std::memory_order_acquire))
+      return false;
+    if (end_time.is_max()) {
+      internal::FutexWaitShared(waiting, 1, nullptr);
+    } else {
+      const struct timespec relative_time = (end_time - now).ToTimeSpec();
+      internal::FutexWaitShared(waiting, 1, &relative_time);
+    }
+#else
+    // There is no wait primitive which can live in shared memory, so poll.
+    PlatformThread::Sleep(
+        std::min(end_time - now, TimeDelta::FromMilliseconds(1)));
+#endif
+  }
+}
+
+// Wakes up the other end if it sleeps on |waiting|, after this end made
+// progress.
+void Notify(std::atomic<int32_t>* waiting) {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting->load(std::memory_order_relaxed)) {
+    waiting->store(0, std::memory_order_relaxed);
+    internal::FutexWakeShared(waiting, 1);
+  }
+#endif
+}
+
+TimeTicks GetEndTime(TimeDelta timeout) {
+  return timeout.is_max() ? TimeTicks::Max() : TimeTicks::Now() + timeout;
+}
+
+}  // namespace
+
+SharedMemoryRing::SharedMemoryRing(WritableSharedMemoryMapping mapping)
+    : mapping_(std::move(mapping)) {
+  if (!mapping_.IsValid() || mapping_.size() < sizeof(SharedMemoryRingHeader))
+    return;
+  auto* header = static_cast<SharedMemoryRingHeader*>(mapping_.memory());
+  // The capacity is only read once, since the other end could change it.
+  const uint32_t capacity = header->capacity;
+  if (header->magic != kMagic || capacity < kMinCapacity ||
+      capacity > kMaxCapacity || (capacity & (capacity - 1)) ||
+      mapping_.size() - sizeof(SharedMemoryRingHeader) < capacity) {
+    DLOG(ERROR) << "Invalid shared memory ring";
+    return;
+  }
+  header_ = header;
+  data_ = static_cast<uint8_t*>(mapping_.memory()) +
+          sizeof(SharedMemoryRingHeader);
+  capacity_ = capacity;
+}
+
+SharedMemoryRing::~SharedMemoryRing() = default;
+
+void SharedMemoryRing::Close() {
+  if (!IsValid())
+    return;
+  header_->closed.store(1, std::memory_order_release);
+  // Wake up whichever end is blocked.
+  header_->reader_waiting.store(1, std::memory_order_relaxed);
+  header_->writer_waiting.store(1, std::memory_order_relaxed);
+  Notify(&header_->reader_waiting);
+  Notify(&header_->writer_waiting);
+}
+
+bool SharedMemoryRing::IsClosed() const {
+  return !IsValid() || header_->closed.load(std::memory_order_acquire);
+}
+
+void SharedMemoryRing::Invalidate() {
+  DLOG(ERROR) << "Corrupt shared memory ring";
+  header_ = nullptr;
+}
+
+// static
+WritableSharedMemoryRegion SharedMemoryRingWriter::CreateRegion(
+    size_t capacity) {
+  if (capacity > kMaxCapacity)
+    return WritableSharedMemoryRegion();
+  capacity = std::max<size_t>(capacity, kMinCapacity);
+  capacity = size_t{1} << bits::Log2Ceiling(static_cast<uint32_t>(capacity));
+
+  WritableSharedMemoryRegion region = WritableSharedMemoryRegion::Create(
+      sizeof(SharedMemoryRingHeader) + capacity);
+  if (!region.IsValid())
+    return region;
+  WritableSharedMemoryMapping mapping = region.Map();
+  if (!mapping.IsValid())
+    return WritableSharedMemoryRegion();
+  // The memory is zeroed, which is how the atomics start out.
+  auto* header = new (mapping.memory()) SharedMemoryRingHeader();
+  header->capacity = static_cast<uint32_t>(capacity);
+  header->magic = kMagic;
+  return region;
+}
+
+SharedMemoryRingWriter::SharedMemoryRingWriter(
+    WritableSharedMemoryMapping mapping)
+    : SharedMemoryRing(std::move(mapping)) {
+  if (IsValid())
+    write_position_ = header_->write_position.load(std::memory_order_relaxed);
+}
+
+SharedMemoryRingWriter::~SharedMemoryRingWriter() = default;
+
+size_t SharedMemoryRingWriter::max_record_size() const {
+  // Whatever the position of the writer, there is that much room either before
+  // or after it, so that any record eventually fits.
+  return capacity_ / 2 - sizeof(RecordHeader);
+}
+
+void* SharedMemoryRingWriter::BeginWrite(size_t size, TimeDelta timeout) {
+  DCHECK(!pending_write_end_);
+  if (!IsValid() || size > max_record_size())
+    return nullptr;
+
+  const uint64_t record_size = GetRecordSize(static_cast<uint32_t>(size));
+  const uint32_t offset = write_position_ & (capacity_ - 1);
+  const uint32_t contiguous_size = capacity_ - offset;
+  const uint64_t padding_size =
+      record_size <= contiguous_size ? 0 : contiguous_size;
+  const uint64_t end = write_position_ + padding_size + record_size;
+
+  bool corrupt = false;
+  auto has_room = [this, end, &corrupt]() {
+    const uint64_t read_position =
+        header_->read_position.load(std::memory_order_acquire);
+    if (read_position > write_position_ ||
+        write_position_ - read_position > capacity_) {
+      corrupt = true;
+      return true;
+    }
+    return end - read_position <= capacity_;
+  };
+  if (!WaitUntil(header_, &header_->writer_waiting, has_room,
+                 GetEndTime(timeout)) ||
+      header_->closed.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  if (corrupt) {
+    Invalidate();
+    return nullptr;
+  }
+
+  uint8_t* record = data_ + offset;
+  if (padding_size) {
+    const RecordHeader padding = {kPaddingRecordSize, 0};
+    memcpy(record, &padding, sizeof(padding));
+    record = data_;
+  }
+  const RecordHeader record_header = {static_cast<uint32_t>(size), 0};
+  memcpy(record, &record_header, sizeof(record_header));
+  pending_write_end_ = end;
+  return record + sizeof(RecordHeader);
+}
+
+void SharedMemoryRingWriter::EndWrite() {
+  DCHECK(pending_write_end_);
+  if (!IsValid())
+    return;
+  write_position_ = pending_write_end_;
+  pending_write_end_ = 0;
+  header_->write_position.store(write_position_, std::memory_order_release);
+  Notify(&header_->reader_waiting);
+}
+
+bool SharedMemoryRingWriter::WritePickle(const Pickle& pickle,
+                                         TimeDelta timeout) {
+  void* record = BeginWrite(pickle.size(), timeout);
+  if (!record)
+    return false;
+  memcpy(record, pickle.data(), pickle.size());
+  EndWrite();
+  return true;
+}
+
+SharedMemoryRingReader::SharedMemoryRingReader(
+    WritableSharedMemoryMapping mapping)
+    : SharedMemoryRing(std::move(mapping)) {
+  if (IsValid())
+    read_position_ = header_->read_position.load(std::memory_order_relaxed);
+}
+
+SharedMemoryRingReader::~SharedMemoryRingReader() = default;
+
+bool SharedMemoryRingReader::BeginRead(span<const uint8_t>* record,
+                                       TimeDelta timeout) {
+  DCHECK(!pending_read_end_);
+  if (!IsValid())
+    return false;
+  // Once the ring is found corrupt, stop waiting.
+  auto is_ready = [this, record]() {
+    return TryBeginRead(record) || !IsValid();
+  };
+  if (!WaitUntil(header_, &header_->reader_waiting, is_ready,
+                 GetEndTime(timeout))) {
+    // The writer may have written its last records before closing the ring.
+    return IsValid() && TryBeginRead(record);
+  }
+  return IsValid();
+}
+
+bool SharedMemoryRingReader::TryBeginRead(span<const uint8_t>* record) {
+  const uint64_t write_position =
+      header_->write_position.load(std::memory_order_acquire);
+  uint64_t position = read_position_;
+  for (;;) {
+    if (write_position < position ||
+        write_position - read_position_ > capacity_) {
+      Invalidate();
+      return false;
+    }
+    const uint64_t available_size = write_position - position;
+    if (!available_size)
+      return false;
+
+    const uint32_t offset = position & (capacity_ - 1);
+    const uint32_t contiguous_size = capacity_ - offset;
+    if (available_size < sizeof(RecordHeader)) {
+      Invalidate();
+      return false;
+    }
+    // The record header is only read once, since the writer could change it.
+    RecordHeader record_header;
+    memcpy(&record_header, data_ + offset, sizeof(record_header));
+    if (record_header.size == kPaddingRecordSize) {
+      position += contiguous_size;
+      continue;
+    }
+    const uint64_t record_size = GetRecordSize(record_header.size);
+    if (record_size > contiguous_size || record_size > available_size) {
+      Invalidate();
+      return false;
+    }
+    *record = make_span(data_ + offset + sizeof(RecordHeader),
+                        record_header.size);
+    pending_read_end_ = position + record_size;
+    return true;
+  }
+}
+
+void SharedMemoryRingReader::EndRead() {
+  DCHECK(pending_read_end_);
+  if (!IsValid())
+    return;
+  read_position_ = pending_read_end_;
+  pending_read_end_ = 0;
+  header_->read_position.store(read_position_, std::memory_order_release);
+  Notify(&header_->writer_waiting);
+}
+
+}  // namespace base
@@ -0,0 +1,162 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A single-producer single-consumer ring of variable-length records in shared
+// memory, to stream data between two processes without copying it through a
+// socket:
+//
+//   // In the producer:
+//   WritableSharedMemoryRegion region =
+//       SharedMemoryRingWriter::CreateRegion(256 * 1024);
+//   SharedMemoryRingWriter writer(region.Map());
+//   ... send |region| to the consumer ...
+//   writer.WritePickle(pickle);
+//
+//   // In the consumer:
+//   SharedMemoryRingReader reader(region.Map());
+//   span<const uint8_t> record;
+//   while (reader.BeginRead(&record)) {
+//     Pickle pickle(record);
+//     ... read |pickle| in place ...
+//     reader.EndRead();
+//   }
+//
+// A record is written in place with BeginWrite() and EndWrite(), and read in
+// place with BeginRead() and EndRead(), so its data is only copied when the
+// producer writes it into the ring. Each end blocks when the ring is full or
+// empty. On Linux and Android, it sleeps on a futex in the shared memory,
+// which the other end only wakes up when it is sleeping. Elsewhere, it polls.
+//
+// The ends only trust the cursors and records of each other as far as they
+// can check them, and give up on a ring which doesn't add up. Since the
+// producer can still change a record while it's read, a reader which doesn't
+// trust the producer must parse records defensively, as Pickle does.
+
+#ifndef BASE_MEMORY_SHARED_MEMORY_RING_H_
+#define BASE_MEMORY_SHARED_MEMORY_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+#include "base/macros.h"
+#include "base/memory/shared_memory_mapping.h"
+#include "base/memory/writable_shared_memory_region.h"
+#include "base/time/time.h"
+
+namespace base {
+
+class Pickle;
+
+namespace internal {
+struct SharedMemoryRingHeader;
+}  // namespace internal
+
+// The state common to both ends of a ring.
+class BASE_EXPORT SharedMemoryRing {
+ public:
+  // Returns false if the mapping doesn't hold a valid ring, or if the ring was
+  // found corrupt.
+  bool IsValid() const { return header_ != nullptr; }
+
+  // Closes the ring, from either end. The blocked and subsequent calls of both
+  // ends fail, except that the reader can still read the records written
+  // before.
+  void Close();
+
+  // Returns true if either end closed the ring.
+  bool IsClosed() const;
+
+ protected:
+  explicit SharedMemoryRing(WritableSharedMemoryMapping mapping);
+  ~SharedMemoryRing();
+
+  // Gives up on a ring whose other end broke its invariants.
+  void Invalidate();
+
+  WritableSharedMemoryMapping mapping_;
+
+  // Null if the ring is invalid.
+  internal::SharedMemoryRingHeader* header_ = nullptr;
+  uint8_t* data_ = nullptr;
+  uint32_t capacity_ = 0;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryRing);
+};
+
+class BASE_EXPORT SharedMemoryRingWriter : public SharedMemoryRing {
+ public:
+  // Creates a region holding an empty ring of |capacity| bytes, which is
+  // rounded up to a power of two. Returns an invalid region on failure.
+  static WritableSharedMemoryRegion CreateRegion(size_t capacity);
+
+  // |mapping| must map a region created by CreateRegion(). The ring must have
+  // a single writer.
+  explicit SharedMemoryRingWriter(WritableSharedMemoryMapping mapping);
+  ~SharedMemoryRingWriter();
+
+  // Returns the largest record that the ring can hold.
+  size_t max_record_size() const;
+
+  // Returns space for a record of |size| bytes, to be committed by EndWrite(),
+  // waiting up to |timeout| for the reader to make room. Returns null on
+  // timeout, if the ring is closed or invalid, or if |size| is larger than
+  // max_record_size().
+  void* BeginWrite(size_t size, TimeDelta timeout = TimeDelta::Max());
+
+  // Makes the record returned by the last BeginWrite() available to the
+  // reader.
+  void EndWrite();
+
+  // Writes the data of |pickle| as a record. Returns false on failure, as
+  // BeginWrite().
+  bool WritePickle(const Pickle& pickle, TimeDelta timeout = TimeDelta::Max());
+
+ private:
+  // The position after the last committed record, which only this end writes.
+  uint64_t write_position_ = 0;
+
+  // The position after the record returned by BeginWrite(), or 0 if there is
+  // none.
+  uint64_t pending_write_end_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryRingWriter);
+};
+
+class BASE_EXPORT SharedMemoryRingReader : public SharedMemoryRing {
+ public:
+  // |mapping| must map a region created by SharedMemoryRingWriter. The ring
+  // must have a single reader.
+  explicit SharedMemoryRingReader(WritableSharedMemoryMapping mapping);
+  ~SharedMemoryRingReader();
+
+  // Sets |record| to the next record, which stays valid until EndRead(),
+  // waiting up to |timeout| for the writer to write one. Returns false on
+  // timeout, or if the ring is invalid or closed and has no record left.
+  bool BeginRead(span<const uint8_t>* record,
+                 TimeDelta timeout = TimeDelta::Max());
+
+  // Releases the record returned by the last BeginRead() to the writer.
+  void EndRead();
+
+ private:
+  // Returns true if a record is available, after setting |record| to it.
+  // Invalidates the ring and returns false if it is corrupt.
+  bool TryBeginRead(span<const uint8_t>* record);
+
+  // The position after the last record released, which only this end writes.
+  uint64_t read_position_ = 0;
+
+  // The position after the record returned by BeginRead(), or 0 if there is
+  // none.
+  uint64_t pending_read_end_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryRingReader);
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_SHARED_MEMORY_RING_H_
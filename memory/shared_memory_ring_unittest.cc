@@ -0,0 +1,179 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/shared_memory_ring.h"
+
+#include <string.h>
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/pickle.h"
+#include "base/threading/thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class SharedMemoryRingTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    region_ = SharedMemoryRingWriter::CreateRegion(4096);
+    ASSERT_TRUE(region_.IsValid());
+    // Both ends map the region, as they would in different processes.
+    writer_ = std::make_unique<SharedMemoryRingWriter>(region_.Map());
+    reader_ = std::make_unique<SharedMemoryRingReader>(region_.Map());
+    ASSERT_TRUE(writer_->IsValid());
+    ASSERT_TRUE(reader_->IsValid());
+  }
+
+  bool Write(const std::string& data) {
+    void* record = writer_->BeginWrite(data.size(), TimeDelta());
+    if (!record)
+      return false;
+    memcpy(record, data.data(), data.size());
+    writer_->EndWrite();
+    return true;
+  }
+
+  bool Read(std::string* data) {
+    span<const uint8_t> record;
+    if (!reader_->BeginRead(&record, TimeDelta()))
+      return false;
+    data->assign(reinterpret_cast<const char*>(record.data()), record.size());
+    reader_->EndRead();
+    return true;
+  }
+
+  WritableSharedMemoryRegion region_;
+  std::unique_ptr<SharedMemoryRingWriter> writer_;
+  std::unique_ptr<SharedMemoryRingReader> reader_;
+};
+
+}  // namespace
+
+TEST_F(SharedMemoryRingTest, WriteAndRead) {
+  std::string data;
+  EXPECT_FALSE(Read(&data));
+
+  EXPECT_TRUE(Write("a"));
+  EXPECT_TRUE(Write(""));
+  EXPECT_TRUE(Write("0123456789"));
+  EXPECT_TRUE(Read(&data));
+  EXPECT_EQ("a", data);
+  EXPECT_TRUE(Read(&data));
+  EXPECT_EQ("", data);
+  EXPECT_TRUE(Read(&data));
+  EXPECT_EQ("0123456789", data);
+  EXPECT_FALSE(Read(&data));
+}
+
+TEST_F(SharedMemoryRingTest, WrapAround) {
+  // Records of varying sizes which don't divide the capacity go around the
+  // ring several times.
+  for (int i = 0; i < 1000; ++i) {
+    const std::string record(i % 300, static_cast<char>('a' + i % 26));
+    ASSERT_TRUE(Write(record));
+    if (i % 3 == 0)
+      ASSERT_TRUE(Write(record));
+    std::string data;
+    ASSERT_TRUE(Read(&data));
+    EXPECT_EQ(record, data);
+    if (i % 3 == 0) {
+      ASSERT_TRUE(Read(&data));
+      EXPECT_EQ(record, data);
+    }
+  }
+}
+
+TEST_F(SharedMemoryRingTest, Full) {
+  const std::string record(writer_->max_record_size(), 'x');
+  EXPECT_FALSE(writer_->BeginWrite(record.size() + 1, TimeDelta::Max()));
+
+  // The ring holds two of the largest records.
+  EXPECT_TRUE(Write(record));
+  EXPECT_TRUE(Write(record));
+  EXPECT_FALSE(
+      writer_->BeginWrite(record.size(), TimeDelta::FromMilliseconds(10)));
+  std::string data;
+  EXPECT_TRUE(Read(&data));
+  EXPECT_TRUE(Write(record));
+}
+
+TEST_F(SharedMemoryRingTest, Pickle) {
+  Pickle pickle;
+  pickle.WriteInt(42);
+  pickle.WriteString("foo");
+  EXPECT_TRUE(writer_->WritePickle(pickle));
+
+  span<const uint8_t> record;
+  ASSERT_TRUE(reader_->BeginRead(&record));
+  // The pickle is read in place.
+  Pickle read_pickle(record);
+  PickleIterator iter(read_pickle);
+  int i;
+  std::string s;
+  EXPECT_TRUE(iter.ReadInt(&i));
+  EXPECT_TRUE(iter.ReadString(&s));
+  EXPECT_EQ(42, i);
+  EXPECT_EQ("foo", s);
+  reader_->EndRead();
+}
+
+TEST_F(SharedMemoryRingTest, Close) {
+  EXPECT_TRUE(Write("a"));
+  writer_->Close();
+  EXPECT_TRUE(reader_->IsClosed());
+  EXPECT_FALSE(writer_->BeginWrite(1));
+
+  // The records written before closing can still be read.
+  std::string data;
+  EXPECT_TRUE(Read(&data));
+  EXPECT_EQ("a", data);
+  span<const uint8_t> record;
+  EXPECT_FALSE(reader_->BeginRead(&record, TimeDelta::Max()));
+}
+
+TEST_F(SharedMemoryRingTest, BlockingWritesAndReads) {
+  // The writer blocks when the ring is full, and the reader when it's empty.
+  constexpr int kNumRecords = 100000;
+  Thread thread("SharedMemoryRingTest");
+  ASSERT_TRUE(thread.Start());
+  thread.task_runner()->PostTask(
+      FROM_HERE, BindOnce(
+                     [](SharedMemoryRingWriter* writer) {
+                       for (int i = 0; i < kNumRecords; ++i) {
+                         void* record = writer->BeginWrite(sizeof(i));
+                         ASSERT_TRUE(record);
+                         memcpy(record, &i, sizeof(i));
+                         writer->EndWrite();
+                       }
+                       writer->Close();
+                     },
+                     writer_.get()));
+
+  int expected = 0;
+  span<const uint8_t> record;
+  while (reader_->BeginRead(&record)) {
+    ASSERT_EQ(sizeof(int), record.size());
+    int value;
+    memcpy(&value, record.data(), sizeof(value));
+    EXPECT_EQ(expected, value);
+    ++expected;
+    reader_->EndRead();
+  }
+  EXPECT_EQ(kNumRecords, expected);
+}
+
+TEST(SharedMemoryRingInvalidTest, NotARing) {
+  WritableSharedMemoryRegion region = WritableSharedMemoryRegion::Create(8192);
+  ASSERT_TRUE(region.IsValid());
+  SharedMemoryRingReader reader(region.Map());
+  EXPECT_FALSE(reader.IsValid());
+  span<const uint8_t> record;
+  EXPECT_FALSE(reader.BeginRead(&record));
+}
+
+}  // namespace base
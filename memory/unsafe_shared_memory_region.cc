@@ -18,6 +18,16 @@ UnsafeSharedMemoryRegion UnsafeSharedMemoryRegion::Create(size_t size) {
   return UnsafeSharedMemoryRegion(std::move(handle));
 }
 
+// static
+UnsafeSharedMemoryRegion UnsafeSharedMemoryRegion::Create(
+    size_t size,
+    const subtle::PlatformSharedMemoryRegion::CreateOptions& options) {
+  subtle::PlatformSharedMemoryRegion handle =
+      subtle::PlatformSharedMemoryRegion::CreateUnsafe(size, options);
+
+  return UnsafeSharedMemoryRegion(std::move(handle));
+}
+
 // static
 UnsafeSharedMemoryRegion UnsafeSharedMemoryRegion::Deserialize(
     subtle::PlatformSharedMemoryRegion handle) {
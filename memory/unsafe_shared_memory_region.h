@@ -33,6 +33,12 @@ class BASE_EXPORT UnsafeSharedMemoryRegion {
   // used for mapping writable shared memory into the virtual address space.
   static UnsafeSharedMemoryRegion Create(size_t size);
 
+  // Same as above, with |options| to lay out a large region for speed. See
+  // subtle::PlatformSharedMemoryRegion::CreateOptions.
+  static UnsafeSharedMemoryRegion Create(
+      size_t size,
+      const subtle::PlatformSharedMemoryRegion::CreateOptions& options);
+
   // Returns an UnsafeSharedMemoryRegion built from a platform-specific handle
   // that was taken from another UnsafeSharedMemoryRegion instance. Returns an
   // invalid region iff the |handle| is invalid. CHECK-fails if the |handle|
@@ -19,6 +19,16 @@ WritableSharedMemoryRegion WritableSharedMemoryRegion::Create(size_t size) {
   return WritableSharedMemoryRegion(std::move(handle));
 }
 
+// static
+WritableSharedMemoryRegion WritableSharedMemoryRegion::Create(
+    size_t size,
+    const subtle::PlatformSharedMemoryRegion::CreateOptions& options) {
+  subtle::PlatformSharedMemoryRegion handle =
+      subtle::PlatformSharedMemoryRegion::CreateWritable(size, options);
+
+  return WritableSharedMemoryRegion(std::move(handle));
+}
+
 // static
 WritableSharedMemoryRegion WritableSharedMemoryRegion::Deserialize(
     subtle::PlatformSharedMemoryRegion handle) {
@@ -29,6 +29,12 @@ class BASE_EXPORT WritableSharedMemoryRegion {
   // address space.
   static WritableSharedMemoryRegion Create(size_t size);
 
+  // Same as above, with |options| to lay out a large region for speed. See
+  // subtle::PlatformSharedMemoryRegion::CreateOptions.
+  static WritableSharedMemoryRegion Create(
+      size_t size,
+      const subtle::PlatformSharedMemoryRegion::CreateOptions& options);
+
   // Returns a WritableSharedMemoryRegion built from a platform handle that was
   // taken from another WritableSharedMemoryRegion instance. Returns an invalid
   // region iff the |handle| is invalid. CHECK-fails if the |handle| isn't
@@ -0,0 +1,219 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop/delayed_task_wheel.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bits.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+constexpr int64_t kTickMicroseconds = Time::kMicrosecondsPerMillisecond;
+constexpr int kSlotBits = 6;
+constexpr int kWheelBits = kSlotBits * DelayedTaskWheel::kNumLevels;
+constexpr uint64_t kSlotMask = DelayedTaskWheel::kNumSlots - 1;
+
+static_assert(DelayedTaskWheel::kNumSlots == 1 << kSlotBits,
+              "Slot occupancy must fit a 64-bit bitmap");
+
+// Below this many tasks, sweeping isn't worth the time.
+constexpr size_t kMinSweepSize = 64;
+
+// Orders a heap like DelayedTaskQueue: PendingTask::operator< puts the task
+// which runs first at the front.
+void PushHeap(std::vector<PendingTask>* heap, PendingTask pending_task) {
+  heap->push_back(std::move(pending_task));
+  std::push_heap(heap->begin(), heap->end());
+}
+
+PendingTask PopHeap(std::vector<PendingTask>* heap) {
+  std::pop_heap(heap->begin(), heap->end());
+  PendingTask pending_task = std::move(heap->back());
+  heap->pop_back();
+  return pending_task;
+}
+
+}  // namespace
+
+DelayedTaskWheel::DelayedTaskWheel() : next_sweep_size_(kMinSweepSize) {}
+
+DelayedTaskWheel::~DelayedTaskWheel() = default;
+
+// static
+int64_t DelayedTaskWheel::GetTick(const PendingTask& pending_task) {
+  return std::max<int64_t>(
+      0, pending_task.delayed_run_time.since_origin().InMicroseconds() /
+             kTickMicroseconds);
+}
+
+void DelayedTaskWheel::Push(PendingTask pending_task) {
+  DCHECK(!pending_task.delayed_run_time.is_null());
+  if (!slack_.is_zero()) {
+    const TimeDelta remainder =
+        pending_task.delayed_run_time.since_origin() % slack_;
+    if (!remainder.is_zero())
+      pending_task.delayed_run_time += slack_ - remainder;
+  }
+
+  // An empty wheel can jump straight to the new task.
+  if (size_ == 0)
+    cursor_ = GetTick(pending_task);
+
+  if (pending_task.is_high_res)
+    ++num_high_res_tasks_;
+  ++size_;
+  Insert(std::move(pending_task));
+
+  if (size_ >= next_sweep_size_) {
+    SweepCancelledTasks();
+    next_sweep_size_ = std::max(kMinSweepSize, 2 * size_);
+  }
+}
+
+const PendingTask& DelayedTaskWheel::Peek() {
+  DCHECK(!empty());
+  if (ready_.empty())
+    AdvanceToNextTask();
+  return ready_.front();
+}
+
+PendingTask DelayedTaskWheel::Pop() {
+  DCHECK(!empty());
+  if (ready_.empty())
+    AdvanceToNextTask();
+  PendingTask pending_task = PopHeap(&ready_);
+  if (pending_task.is_high_res)
+    --num_high_res_tasks_;
+  --size_;
+  return pending_task;
+}
+
+size_t DelayedTaskWheel::SweepCancelledTasks() {
+  size_t num_removed = 0;
+  auto sweep = [this, &num_removed](Slot* slot) {
+    auto new_end = std::remove_if(
+        slot->begin(), slot->end(), [this](const PendingTask& pending_task) {
+          if (!pending_task.task.IsCancelled())
+            return false;
+          if (pending_task.is_high_res)
+            --num_high_res_tasks_;
+          return true;
+        });
+    const size_t num_slot_removed = slot->end() - new_end;
+    slot->erase(new_end, slot->end());
+    num_removed += num_slot_removed;
+    return num_slot_removed != 0;
+  };
+
+  if (sweep(&ready_))
+    std::make_heap(ready_.begin(), ready_.end());
+  if (sweep(&overflow_))
+    std::make_heap(overflow_.begin(), overflow_.end());
+
+  for (int level = 0; level < kNumLevels; ++level) {
+    for (uint64_t occupied = occupied_[level]; occupied;
+         occupied &= occupied - 1) {
+      const int index = bits::CountTrailingZeroBits(occupied);
+      Slot& slot = slots_[level][index];
+      sweep(&slot);
+      if (slot.empty())
+        occupied_[level] &= ~(uint64_t{1} << index);
+    }
+  }
+
+  size_ -= num_removed;
+  return num_removed;
+}
+
+void DelayedTaskWheel::Clear() {
+  // Destroying a task may post another one, so move the tasks out first.
+  std::vector<Slot> slots;
+  slots.push_back(std::move(ready_));
+  slots.push_back(std::move(overflow_));
+  for (int level = 0; level < kNumLevels; ++level) {
+    for (Slot& slot : slots_[level])
+      slots.push_back(std::move(slot));
+    occupied_[level] = 0;
+  }
+  ready_.clear();
+  overflow_.clear();
+  size_ = 0;
+  num_high_res_tasks_ = 0;
+  next_sweep_size_ = kMinSweepSize;
+}
+
+void DelayedTaskWheel::Insert(PendingTask pending_task) {
+  const int64_t tick = GetTick(pending_task);
+  if (tick <= cursor_) {
+    PushHeap(&ready_, std::move(pending_task));
+    return;
+  }
+
+  // The level is that of the highest slot index which differs from the
+  // cursor's.
+  const uint64_t differing_bits =
+      static_cast<uint64_t>(tick) ^ static_cast<uint64_t>(cursor_);
+  const int level =
+      (63 - bits::CountLeadingZeroBits(differing_bits)) / kSlotBits;
+  if (level >= kNumLevels) {
+    PushHeap(&overflow_, std::move(pending_task));
+    return;
+  }
+
+  const int index = (tick >> (level * kSlotBits)) & kSlotMask;
+  slots_[level][index].push_back(std::move(pending_task));
+  occupied_[level] |= uint64_t{1} << index;
+}
+
+void DelayedTaskWheel::AdvanceToNextTask() {
+  DCHECK(!empty());
+  while (ready_.empty()) {
+    // Slots at or before the cursor's index on each level are empty, so the
+    // next tasks are in the lowest occupied slot of the lowest occupied level.
+    int level = 0;
+    while (level < kNumLevels && !occupied_[level])
+      ++level;
+
+    if (level == kNumLevels) {
+      // The wheel is empty: move on to the earliest overflow task, and bring
+      // in all overflow tasks now within reach of the wheel.
+      DCHECK(!overflow_.empty());
+      cursor_ = GetTick(overflow_.front());
+      while (!overflow_.empty() &&
+             (GetTick(overflow_.front()) >> kWheelBits) ==
+                 (cursor_ >> kWheelBits)) {
+        Insert(PopHeap(&overflow_));
+      }
+      continue;
+    }
+
+    const int index = bits::CountTrailingZeroBits(occupied_[level]);
+    const int shift = level * kSlotBits;
+    cursor_ = ((cursor_ >> (shift + kSlotBits)) << (shift + kSlotBits)) |
+              (static_cast<int64_t>(index) << shift);
+
+    Slot slot;
+    std::swap(slot, slots_[level][index]);
+    occupied_[level] &= ~(uint64_t{1} << index);
+    if (level == 0) {
+      // All of the slot's tasks are due at |cursor_|.
+      ready_ = std::move(slot);
+      std::make_heap(ready_.begin(), ready_.end());
+    } else {
+      for (PendingTask& pending_task : slot)
+        Insert(std::move(pending_task));
+      // Keep the slot's capacity for the next tasks placed in it.
+      slot.clear();
+      std::swap(slot, slots_[level][index]);
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace base
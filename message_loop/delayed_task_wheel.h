@@ -0,0 +1,121 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MESSAGE_LOOP_DELAYED_TASK_WHEEL_H_
+#define BASE_MESSAGE_LOOP_DELAYED_TASK_WHEEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/pending_task.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace internal {
+
+// A priority queue of delayed tasks, ordered like DelayedTaskQueue (by
+// |delayed_run_time|, then by |sequence_num|), implemented as a hierarchical
+// timer wheel.
+//
+// Tasks are bucketed by their run time in ticks of one millisecond. The wheel
+// has kNumLevels levels of kNumSlots slots each; a slot on level L spans
+// kNumSlots^L ticks. A task is placed on the lowest level on which its tick
+// shares all higher slot indices with the wheel's cursor, so Push() is O(1).
+// When the tasks due at the cursor run out, the cursor advances to the next
+// occupied slot (found with a bitmap scan) and that slot's tasks are moved down
+// a level, or into a small heap of the tasks due at the cursor's tick. Each
+// task is moved at most kNumLevels times. Tasks too far in the future for the
+// wheel wait in an overflow heap.
+//
+// Cancelled tasks are not removed when they're cancelled, as callbacks carry no
+// handle back to their queue. Instead, all cancelled tasks are swept out every
+// time the number of tasks doubles, which keeps the memory held by cancelled
+// tasks proportional to the number of live ones at an amortized O(1) cost.
+//
+// This class is not thread-safe.
+class BASE_EXPORT DelayedTaskWheel {
+ public:
+  static constexpr int kNumLevels = 4;
+  static constexpr int kNumSlots = 64;
+
+  DelayedTaskWheel();
+  ~DelayedTaskWheel();
+
+  // Tasks pushed after this call have their |delayed_run_time| rounded up to
+  // the next multiple of |slack|, so that tasks due within |slack| of each
+  // other run on a single wake-up. Tasks never run earlier than requested. A
+  // zero |slack| (the default) leaves run times untouched.
+  void set_slack(TimeDelta slack) {
+    DCHECK_GE(slack, TimeDelta());
+    slack_ = slack;
+  }
+  TimeDelta slack() const { return slack_; }
+
+  void Push(PendingTask pending_task);
+
+  // Returns the next task. empty() is assumed to be false. Not const, as this
+  // may advance the wheel.
+  const PendingTask& Peek();
+
+  // Removes and returns the next task. empty() is assumed to be false.
+  PendingTask Pop();
+
+  // Removes all cancelled tasks. Returns the number of tasks removed.
+  size_t SweepCancelledTasks();
+
+  // Removes all tasks.
+  void Clear();
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+  // Returns the number of tasks which require a high resolution timer.
+  int num_high_res_tasks() const { return num_high_res_tasks_; }
+
+ private:
+  using Slot = std::vector<PendingTask>;
+
+  // Returns the tick at which |pending_task| is due.
+  static int64_t GetTick(const PendingTask& pending_task);
+
+  // Places |pending_task| relative to |cursor_| without updating counters.
+  void Insert(PendingTask pending_task);
+
+  // Moves the cursor forward until |ready_| holds the next tasks.
+  void AdvanceToNextTask();
+
+  // The tasks due at or before |cursor_|, ordered as a heap.
+  Slot ready_;
+
+  // The slots of each level, and a bitmap of those which are not empty.
+  Slot slots_[kNumLevels][kNumSlots];
+  uint64_t occupied_[kNumLevels] = {};
+
+  // Tasks beyond the reach of the wheel, ordered as a heap.
+  Slot overflow_;
+
+  // The tick the wheel last advanced to. All tasks in |slots_| and
+  // |overflow_| are due after it.
+  int64_t cursor_ = 0;
+
+  size_t size_ = 0;
+  int num_high_res_tasks_ = 0;
+
+  // SweepCancelledTasks() runs when |size_| reaches this.
+  size_t next_sweep_size_;
+
+  TimeDelta slack_;
+
+  DISALLOW_COPY_AND_ASSIGN(DelayedTaskWheel);
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_MESSAGE_LOOP_DELAYED_TASK_WHEEL_H_
@@ -0,0 +1,186 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop/delayed_task_wheel.h"
+
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/location.h"
+#include "base/memory/weak_ptr.h"
+#include "base/rand_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+class Target {
+ public:
+  Target() : weak_factory_(this) {}
+
+  void Run() {}
+
+  WeakPtr<Target> GetWeakPtr() { return weak_factory_.GetWeakPtr(); }
+  void InvalidateWeakPtrs() { weak_factory_.InvalidateWeakPtrs(); }
+
+ private:
+  WeakPtrFactory<Target> weak_factory_;
+};
+
+PendingTask MakeTask(TimeTicks delayed_run_time,
+                     int sequence_num,
+                     OnceClosure task = DoNothing()) {
+  PendingTask pending_task(FROM_HERE, std::move(task), delayed_run_time);
+  pending_task.sequence_num = sequence_num;
+  return pending_task;
+}
+
+TimeTicks TicksFromMilliseconds(int64_t ms) {
+  return TimeTicks() + TimeDelta::FromMilliseconds(ms);
+}
+
+}  // namespace
+
+TEST(DelayedTaskWheelTest, MatchesDelayedTaskQueueOrder) {
+  DelayedTaskWheel wheel;
+  DelayedTaskQueue queue;
+  const TimeTicks start = TicksFromMilliseconds(123456789);
+  int sequence_num = 0;
+
+  // Interleave pushes and pops, with delays spanning every level of the wheel
+  // and its overflow, down to the microsecond.
+  for (int round = 0; round < 20; ++round) {
+    for (int i = 0; i < 200; ++i) {
+      const int64_t max_delay_us = int64_t{1} << RandInt(0, 40);
+      const TimeTicks run_time =
+          start + TimeDelta::FromMicroseconds(RandGenerator(max_delay_us));
+      wheel.Push(MakeTask(run_time, sequence_num));
+      queue.push(MakeTask(run_time, sequence_num));
+      ++sequence_num;
+    }
+    for (int i = 0; i < 150; ++i) {
+      ASSERT_EQ(queue.top().sequence_num, wheel.Peek().sequence_num);
+      EXPECT_EQ(queue.top().sequence_num, wheel.Pop().sequence_num);
+      queue.pop();
+    }
+  }
+
+  EXPECT_EQ(queue.size(), wheel.size());
+  while (!queue.empty()) {
+    EXPECT_EQ(queue.top().delayed_run_time, wheel.Peek().delayed_run_time);
+    EXPECT_EQ(queue.top().sequence_num, wheel.Pop().sequence_num);
+    queue.pop();
+  }
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(DelayedTaskWheelTest, SameRunTimeOrderedBySequenceNum) {
+  DelayedTaskWheel wheel;
+  const TimeTicks run_time = TicksFromMilliseconds(1000);
+  wheel.Push(MakeTask(run_time, 2));
+  wheel.Push(MakeTask(run_time, 0));
+  wheel.Push(MakeTask(run_time, 1));
+
+  EXPECT_EQ(0, wheel.Pop().sequence_num);
+  EXPECT_EQ(1, wheel.Pop().sequence_num);
+  EXPECT_EQ(2, wheel.Pop().sequence_num);
+}
+
+TEST(DelayedTaskWheelTest, PushBeforeCursor) {
+  DelayedTaskWheel wheel;
+  wheel.Push(MakeTask(TicksFromMilliseconds(1000), 0));
+  wheel.Push(MakeTask(TicksFromMilliseconds(5000000), 1));
+
+  // Advance the wheel to the second task, then push an earlier one.
+  EXPECT_EQ(0, wheel.Pop().sequence_num);
+  EXPECT_EQ(1, wheel.Peek().sequence_num);
+  wheel.Push(MakeTask(TicksFromMilliseconds(2000), 2));
+  wheel.Push(MakeTask(TicksFromMilliseconds(6000000), 3));
+
+  EXPECT_EQ(2, wheel.Pop().sequence_num);
+  EXPECT_EQ(1, wheel.Pop().sequence_num);
+  EXPECT_EQ(3, wheel.Pop().sequence_num);
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(DelayedTaskWheelTest, Slack) {
+  DelayedTaskWheel wheel;
+  wheel.set_slack(TimeDelta::FromMilliseconds(10));
+  wheel.Push(MakeTask(TicksFromMilliseconds(1001), 0));
+  wheel.Push(MakeTask(TicksFromMilliseconds(1010), 1));
+  wheel.Push(MakeTask(
+      TicksFromMilliseconds(1008) + TimeDelta::FromMicroseconds(1), 2));
+  wheel.Push(MakeTask(TicksFromMilliseconds(1011), 3));
+
+  // Run times are rounded up, never down.
+  EXPECT_EQ(TicksFromMilliseconds(1010), wheel.Peek().delayed_run_time);
+  EXPECT_EQ(0, wheel.Pop().sequence_num);
+  EXPECT_EQ(1, wheel.Pop().sequence_num);
+  EXPECT_EQ(2, wheel.Pop().sequence_num);
+  EXPECT_EQ(TicksFromMilliseconds(1020), wheel.Peek().delayed_run_time);
+  EXPECT_EQ(3, wheel.Pop().sequence_num);
+
+  // Clearing the slack leaves later tasks untouched.
+  wheel.set_slack(TimeDelta());
+  wheel.Push(MakeTask(TicksFromMilliseconds(1001), 4));
+  EXPECT_EQ(TicksFromMilliseconds(1001), wheel.Peek().delayed_run_time);
+}
+
+TEST(DelayedTaskWheelTest, SweepCancelledTasks) {
+  DelayedTaskWheel wheel;
+  Target target;
+  for (int i = 0; i < 10; ++i) {
+    PendingTask pending_task = MakeTask(
+        TicksFromMilliseconds(1000 + i * 100000), i,
+        i % 2 ? BindOnce(&Target::Run, target.GetWeakPtr()) : DoNothing());
+    pending_task.is_high_res = true;
+    wheel.Push(std::move(pending_task));
+  }
+  EXPECT_EQ(10, wheel.num_high_res_tasks());
+
+  target.InvalidateWeakPtrs();
+  EXPECT_EQ(5u, wheel.SweepCancelledTasks());
+  EXPECT_EQ(5u, wheel.size());
+  EXPECT_EQ(5, wheel.num_high_res_tasks());
+  for (int i = 0; i < 10; i += 2)
+    EXPECT_EQ(i, wheel.Pop().sequence_num);
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_EQ(0, wheel.num_high_res_tasks());
+}
+
+TEST(DelayedTaskWheelTest, CancelledTasksAreSweptOnPush) {
+  DelayedTaskWheel wheel;
+  wheel.Push(MakeTask(TicksFromMilliseconds(1000), 0));
+
+  // Keep pushing tasks which are cancelled right away: the wheel mustn't
+  // accumulate them.
+  for (int i = 1; i <= 10000; ++i) {
+    Target target;
+    wheel.Push(MakeTask(TicksFromMilliseconds(1000 + i), i,
+                        BindOnce(&Target::Run, target.GetWeakPtr())));
+  }
+  EXPECT_GT(200u, wheel.size());
+  EXPECT_EQ(0, wheel.Pop().sequence_num);
+}
+
+TEST(DelayedTaskWheelTest, Clear) {
+  DelayedTaskWheel wheel;
+  for (int i = 0; i < 100; ++i)
+    wheel.Push(MakeTask(TicksFromMilliseconds(1000 + i * i * i * i), i));
+  wheel.Clear();
+  EXPECT_TRUE(wheel.empty());
+
+  wheel.Push(MakeTask(TicksFromMilliseconds(10), 100));
+  EXPECT_EQ(100, wheel.Pop().sequence_num);
+  EXPECT_TRUE(wheel.empty());
+}
+
+}  // namespace internal
+}  // namespace base
@@ -86,10 +86,7 @@ bool IncomingTaskQueue::AddToIncomingQueue(const Location& from_here,
 }
 
 void IncomingTaskQueue::WillDestroyCurrentMessageLoop() {
-  {
-    AutoLock auto_lock(incoming_queue_lock_);
-    accept_new_tasks_ = false;
-  }
+  accept_new_tasks_.store(false, std::memory_order_release);
   {
     AutoLock auto_lock(message_loop_lock_);
     message_loop_ = nullptr;
@@ -97,21 +94,18 @@ void IncomingTaskQueue::WillDestroyCurrentMessageLoop() {
 }
 
 void IncomingTaskQueue::StartScheduling() {
-  bool schedule_work;
-  {
-    AutoLock lock(incoming_queue_lock_);
-    DCHECK(!is_ready_for_scheduling_);
-    DCHECK(!message_loop_scheduled_);
-    is_ready_for_scheduling_ = true;
-    schedule_work = !incoming_queue_.empty();
-    if (schedule_work)
-      message_loop_scheduled_ = true;
-  }
-  if (schedule_work) {
-    DCHECK(message_loop_);
-    AutoLock auto_lock(message_loop_lock_);
-    message_loop_->ScheduleWork();
-  }
+  DCHECK(!is_ready_for_scheduling_.load(std::memory_order_relaxed));
+  is_ready_for_scheduling_.store(true, std::memory_order_release);
+
+  // |incoming_queue_| starts out as if the message loop was already scheduled,
+  // which prevents tasks posted before now from scheduling work. Mark it idle
+  // so that the next posted task schedules work, unless tasks are already
+  // pending.
+  if (incoming_queue_.TryMarkIdle())
+    return;
+  DCHECK(message_loop_);
+  AutoLock auto_lock(message_loop_lock_);
+  message_loop_->ScheduleWork();
 }
 
 IncomingTaskQueue::~IncomingTaskQueue() {
@@ -193,29 +187,19 @@ IncomingTaskQueue::DelayedQueue::~DelayedQueue() = default;
 
 void IncomingTaskQueue::DelayedQueue::Push(PendingTask pending_task) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(outer_->sequence_checker_);
-
-  if (pending_task.is_high_res)
-    ++outer_->pending_high_res_tasks_;
-
-  queue_.push(std::move(pending_task));
+  queue_.Push(std::move(pending_task));
 }
 
 const PendingTask& IncomingTaskQueue::DelayedQueue::Peek() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(outer_->sequence_checker_);
   DCHECK(!queue_.empty());
-  return queue_.top();
+  return queue_.Peek();
 }
 
 PendingTask IncomingTaskQueue::DelayedQueue::Pop() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(outer_->sequence_checker_);
   DCHECK(!queue_.empty());
-  PendingTask delayed_task = std::move(const_cast<PendingTask&>(queue_.top()));
-  queue_.pop();
-
-  if (delayed_task.is_high_res)
-    --outer_->pending_high_res_tasks_;
-
-  return delayed_task;
+  return queue_.Pop();
 }
 
 bool IncomingTaskQueue::DelayedQueue::HasTasks() {
@@ -229,8 +213,17 @@ bool IncomingTaskQueue::DelayedQueue::HasTasks() {
 
 void IncomingTaskQueue::DelayedQueue::Clear() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(outer_->sequence_checker_);
-  while (!queue_.empty())
-    Pop();
+  queue_.Clear();
+}
+
+void IncomingTaskQueue::DelayedQueue::SetSlack(TimeDelta slack) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(outer_->sequence_checker_);
+  queue_.set_slack(slack);
+}
+
+int IncomingTaskQueue::DelayedQueue::num_high_res_tasks() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(outer_->sequence_checker_);
+  return queue_.num_high_res_tasks();
 }
 
 IncomingTaskQueue::DeferredQueue::DeferredQueue(IncomingTaskQueue* outer)
@@ -282,26 +275,38 @@ bool IncomingTaskQueue::PostPendingTask(PendingTask* pending_task) {
   // Warning: Don't try to short-circuit, and handle this thread's tasks more
   // directly, as it could starve handling of foreign threads.  Put every task
   // into this queue.
-  bool accept_new_tasks;
-  bool schedule_work = false;
-  {
-    AutoLock auto_lock(incoming_queue_lock_);
-    accept_new_tasks = accept_new_tasks_;
-    if (accept_new_tasks)
-      schedule_work = PostPendingTaskLockRequired(pending_task);
-  }
-
-  if (!accept_new_tasks) {
-    // Clear the pending task outside of |incoming_queue_lock_| to prevent any
-    // chance of self-deadlock if destroying a task also posts a task to this
-    // queue.
-    DCHECK(!schedule_work);
+  if (!accept_new_tasks_.load(std::memory_order_acquire)) {
     pending_task->task.Reset();
     return false;
   }
 
-  // Wake up the message loop and schedule work. This is done outside
-  // |incoming_queue_lock_| to allow for multiple post tasks to occur while
+#if defined(OS_WIN)
+  // Incremented before the task is pushed so that ReloadWorkQueue() never
+  // reloads a high resolution task without accounting for it.
+  if (pending_task->is_high_res)
+    high_res_task_count_.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+  // Initialize the sequence number. The sequence number is used for delayed
+  // tasks (to facilitate FIFO sorting when two tasks have the same
+  // delayed_run_time value) and for identifying the task in about:tracing.
+  pending_task->sequence_num = next_sequence_num_.GetNext();
+
+  task_annotator_.DidQueueTask("MessageLoop::PostTask", *pending_task);
+
+  // After we've scheduled the message loop, we do not need to do so again
+  // until we know it has processed all of the work in our queue and is waiting
+  // for more work again. The message loop will always attempt to reload from
+  // the incoming queue before waiting again so |incoming_queue_| is marked idle
+  // in ReloadWorkQueue().
+  bool schedule_work = incoming_queue_.Push(std::move(*pending_task));
+  if (always_schedule_work_ &&
+      is_ready_for_scheduling_.load(std::memory_order_acquire)) {
+    schedule_work = true;
+  }
+
+  // Wake up the message loop and schedule work. |incoming_queue_| doesn't
+  // require a lock, which allows for multiple post tasks to occur while
   // ScheduleWork() is running. For platforms (e.g. Android) that require one
   // call to ScheduleWork() for each task, all pending tasks may serialize
   // within the ScheduleWork() call. As a result, holding a lock to maintain the
@@ -316,57 +321,27 @@ bool IncomingTaskQueue::PostPendingTask(PendingTask* pending_task) {
   return true;
 }
 
-bool IncomingTaskQueue::PostPendingTaskLockRequired(PendingTask* pending_task) {
-  incoming_queue_lock_.AssertAcquired();
-
-#if defined(OS_WIN)
-  if (pending_task->is_high_res)
-    ++high_res_task_count_;
-#endif
-
-  // Initialize the sequence number. The sequence number is used for delayed
-  // tasks (to facilitate FIFO sorting when two tasks have the same
-  // delayed_run_time value) and for identifying the task in about:tracing.
-  pending_task->sequence_num = next_sequence_num_++;
-
-  task_annotator_.DidQueueTask("MessageLoop::PostTask", *pending_task);
-
-  bool was_empty = incoming_queue_.empty();
-  incoming_queue_.push(std::move(*pending_task));
-
-  if (is_ready_for_scheduling_ &&
-      (always_schedule_work_ || (!message_loop_scheduled_ && was_empty))) {
-    // After we've scheduled the message loop, we do not need to do so again
-    // until we know it has processed all of the work in our queue and is
-    // waiting for more work again. The message loop will always attempt to
-    // reload from the incoming queue before waiting again so we clear this
-    // flag in ReloadWorkQueue().
-    message_loop_scheduled_ = true;
-    return true;
-  }
-  return false;
-}
-
 int IncomingTaskQueue::ReloadWorkQueue(TaskQueue* work_queue) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
   // Make sure no tasks are lost.
   DCHECK(work_queue->empty());
 
-  // Acquire all we can from the inter-thread queue with one lock acquisition.
-  AutoLock lock(incoming_queue_lock_);
-  if (incoming_queue_.empty()) {
+  // Acquire all we can from the inter-thread queue at once.
+  while (!incoming_queue_.TakeAll(work_queue)) {
     // If the loop attempts to reload but there are no tasks in the incoming
     // queue, that means it will go to sleep waiting for more work. If the
-    // incoming queue becomes nonempty we need to schedule it again.
-    message_loop_scheduled_ = false;
-  } else {
-    incoming_queue_.swap(*work_queue);
+    // incoming queue becomes nonempty we need to schedule it again. Marking
+    // the queue idle fails if a task was posted in the meantime, in which case
+    // it is reloaded instead. Before StartScheduling(), the message loop can't
+    // be scheduled and the queue is left as is.
+    if (!is_ready_for_scheduling_.load(std::memory_order_relaxed) ||
+        incoming_queue_.TryMarkIdle()) {
+      break;
+    }
   }
   // Reset the count of high resolution tasks since our queue is now empty.
-  int high_res_tasks = high_res_task_count_;
-  high_res_task_count_ = 0;
-  return high_res_tasks;
+  return high_res_task_count_.exchange(0, std::memory_order_relaxed);
 }
 
 }  // namespace internal
@@ -5,11 +5,16 @@
 #ifndef BASE_MESSAGE_LOOP_INCOMING_TASK_QUEUE_H_
 #define BASE_MESSAGE_LOOP_INCOMING_TASK_QUEUE_H_
 
+#include <atomic>
+
+#include "base/atomic_sequence_num.h"
 #include "base/base_export.h"
 #include "base/callback.h"
 #include "base/debug/task_annotator.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
+#include "base/message_loop/delayed_task_wheel.h"
+#include "base/message_loop/lock_free_task_queue.h"
 #include "base/pending_task.h"
 #include "base/sequence_checker.h"
 #include "base/synchronization/lock.h"
@@ -95,9 +100,14 @@ class BASE_EXPORT IncomingTaskQueue
 
   bool HasPendingHighResolutionTasks() {
     DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-    return pending_high_res_tasks_ > 0;
+    return pending_high_res_tasks_ + delayed_tasks_.num_high_res_tasks() > 0;
   }
 
+  // Rounds up the run time of delayed tasks reloaded after this call to a
+  // multiple of |slack|, so that tasks due close together share a wake-up. See
+  // DelayedTaskWheel::set_slack().
+  void SetDelayedTaskSlack(TimeDelta slack) { delayed_tasks_.SetSlack(slack); }
+
  private:
   friend class base::PostTaskTest;
   friend class RefCountedThreadSafe<IncomingTaskQueue>;
@@ -120,7 +130,7 @@ class BASE_EXPORT IncomingTaskQueue
   //
   // Many of these do not share implementations even though they look like they
   // could because of small quirks (reloading semantics) or differing underlying
-  // data strucutre (TaskQueue vs DelayedTaskQueue).
+  // data strucutre (TaskQueue vs DelayedTaskWheel).
 
   // The starting point for all tasks on the sequence processing the tasks.
   class TriageQueue : public ReadAndRemoveOnlyQueue {
@@ -160,9 +170,12 @@ class BASE_EXPORT IncomingTaskQueue
     void Clear() override;
     void Push(PendingTask pending_task) override;
 
+    void SetSlack(TimeDelta slack);
+    int num_high_res_tasks() const;
+
    private:
     IncomingTaskQueue* const outer_;
-    DelayedTaskQueue queue_;
+    DelayedTaskWheel queue_;
 
     DISALLOW_COPY_AND_ASSIGN(DelayedQueue);
   };
@@ -194,10 +207,6 @@ class BASE_EXPORT IncomingTaskQueue
   // does not retain |pending_task->task| beyond this function call.
   bool PostPendingTask(PendingTask* pending_task);
 
-  // Does the real work of posting a pending task. Returns true if the caller
-  // should call ScheduleWork() on the message loop.
-  bool PostPendingTaskLockRequired(PendingTask* pending_task);
-
   // Loads tasks from the |incoming_queue_| into |*work_queue|. Must be called
   // from the sequence processing the tasks. Returns the number of tasks that
   // require high resolution timers in |work_queue|.
@@ -221,7 +230,8 @@ class BASE_EXPORT IncomingTaskQueue
   // Queue for non-nestable deferred tasks on the |sequence_checker_| sequence.
   DeferredQueue deferred_tasks_;
 
-  // Number of high resolution tasks in the sequence affine queues above.
+  // Number of high resolution tasks in the sequence affine queues above, except
+  // for |delayed_tasks_| which counts its own.
   int pending_high_res_tasks_ = 0;
 
   // Lock that serializes |message_loop_->ScheduleWork()| calls as well as
@@ -231,30 +241,31 @@ class BASE_EXPORT IncomingTaskQueue
   // Points to the message loop that owns |this|.
   MessageLoop* message_loop_;
 
-  // Synchronizes access to all members below this line.
-  base::Lock incoming_queue_lock_;
+  // The members below are accessed without a lock from the posting threads.
 
   // Number of tasks that require high resolution timing. This value is kept
   // so that ReloadWorkQueue() completes in constant time.
-  int high_res_task_count_ = 0;
+  std::atomic<int> high_res_task_count_{0};
 
-  // An incoming queue of tasks that are acquired under a mutex for processing
-  // on this instance's thread. These tasks have not yet been been pushed to
-  // |triage_tasks_|.
-  TaskQueue incoming_queue_;
+  // An incoming queue of tasks posted from any thread for processing on this
+  // instance's thread. These tasks have not yet been been pushed to
+  // |triage_tasks_|. It also tracks whether the message loop has already been
+  // scheduled and does not need to be scheduled again until an empty reload
+  // occurs.
+  LockFreeTaskQueue incoming_queue_;
 
   // True if new tasks should be accepted.
-  bool accept_new_tasks_ = true;
-
-  // The next sequence number to use for delayed tasks.
-  int next_sequence_num_ = 0;
+  std::atomic<bool> accept_new_tasks_{true};
 
-  // True if our message loop has already been scheduled and does not need to be
-  // scheduled again until an empty reload occurs.
-  bool message_loop_scheduled_ = false;
+  // The next sequence number to use for delayed tasks. Sequence numbers are
+  // handed out before a task is pushed to |incoming_queue_|. Tasks posted from
+  // a given thread therefore reach |triage_tasks_| in increasing sequence
+  // number order; only tasks racing in from different threads, whose relative
+  // order is arbitrary anyway, may be reloaded out of sequence number order.
+  AtomicSequenceNumber next_sequence_num_;
 
   // False until StartScheduling() is called.
-  bool is_ready_for_scheduling_ = false;
+  std::atomic<bool> is_ready_for_scheduling_{false};
 
   DISALLOW_COPY_AND_ASSIGN(IncomingTaskQueue);
 };
@@ -0,0 +1,93 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop/lock_free_task_queue.h"
+
+#include <stdint.h>
+
+#include <utility>
+
+#include "base/logging.h"
+
+namespace base {
+namespace internal {
+
+struct LockFreeTaskQueue::Node {
+  explicit Node(PendingTask pending_task)
+      : pending_task(std::move(pending_task)) {}
+
+  PendingTask pending_task;
+  Node* next = nullptr;
+};
+
+// static
+LockFreeTaskQueue::Node* LockFreeTaskQueue::EmptyAndActive() {
+  return reinterpret_cast<Node*>(static_cast<uintptr_t>(1));
+}
+
+// static
+bool LockFreeTaskQueue::IsNode(const Node* node) {
+  return node != nullptr && node != EmptyAndActive();
+}
+
+LockFreeTaskQueue::LockFreeTaskQueue() : head_(EmptyAndActive()) {}
+
+LockFreeTaskQueue::~LockFreeTaskQueue() {
+  Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+  while (IsNode(node)) {
+    Node* const next = node->next;
+    delete node;
+    node = next;
+  }
+}
+
+bool LockFreeTaskQueue::Push(PendingTask pending_task) {
+  Node* const node = new Node(std::move(pending_task));
+  Node* head = head_.load(std::memory_order_relaxed);
+  do {
+    node->next = head;
+  } while (!head_.compare_exchange_weak(head, node, std::memory_order_release,
+                                        std::memory_order_relaxed));
+  return head == nullptr;
+}
+
+bool LockFreeTaskQueue::TakeAll(TaskQueue* work_queue) {
+  // Only the consumer removes nodes, so the queue can't become empty between
+  // the load and the exchange.
+  if (!IsNode(head_.load(std::memory_order_relaxed)))
+    return false;
+  Node* node = head_.exchange(EmptyAndActive(), std::memory_order_acquire);
+  DCHECK(IsNode(node));
+
+  // Nodes are linked from the most recently pushed; reverse them to restore
+  // the order in which they were pushed.
+  Node* reversed = nullptr;
+  while (IsNode(node)) {
+    Node* const next = node->next;
+    node->next = reversed;
+    reversed = node;
+    node = next;
+  }
+
+  while (reversed) {
+    work_queue->push(std::move(reversed->pending_task));
+    Node* const next = reversed->next;
+    delete reversed;
+    reversed = next;
+  }
+  return true;
+}
+
+bool LockFreeTaskQueue::TryMarkIdle() {
+  Node* expected = EmptyAndActive();
+  if (head_.compare_exchange_strong(expected, nullptr,
+                                    std::memory_order_relaxed)) {
+    return true;
+  }
+  // The queue may already be idle if TryMarkIdle() is called repeatedly.
+  return expected == nullptr;
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,77 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MESSAGE_LOOP_LOCK_FREE_TASK_QUEUE_H_
+#define BASE_MESSAGE_LOOP_LOCK_FREE_TASK_QUEUE_H_
+
+#include <atomic>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/pending_task.h"
+
+namespace base {
+namespace internal {
+
+// A multi-producer single-consumer queue of PendingTasks that doesn't use a
+// lock. Any thread can Push() a task while the consumer sequence takes all the
+// pending tasks at once with TakeAll().
+//
+// The queue also tracks whether its consumer needs to be woken up when a task
+// is pushed. It is "active" while the consumer is known to look at the queue
+// again before going to sleep, and "idle" once the consumer found the queue
+// empty and committed to sleeping via TryMarkIdle(). Push() returns true when
+// it pushes the first task into an idle queue, which is the only case where
+// the producer needs to wake up the consumer. The queue is initially active so
+// that no wake up is requested until the consumer first calls TryMarkIdle().
+//
+// Tasks are taken in the order in which they were pushed. This order is
+// consistent with the order of the Push() calls made by any given thread.
+class BASE_EXPORT LockFreeTaskQueue {
+ public:
+  LockFreeTaskQueue();
+
+  // Deletes the tasks that were never taken.
+  ~LockFreeTaskQueue();
+
+  // Appends |pending_task| to the queue. Returns true if the queue was idle,
+  // in which case the caller is responsible for waking up the consumer. Can be
+  // called from any thread.
+  bool Push(PendingTask pending_task);
+
+  // Moves all the tasks of the queue to the back of |work_queue| and returns
+  // true, or returns false if the queue is empty. The queue is active after
+  // tasks are taken. Must be called from the consumer sequence.
+  bool TakeAll(TaskQueue* work_queue);
+
+  // Marks the queue idle if it is empty, so that the next Push() returns true.
+  // Returns false if the queue is not empty, in which case its tasks should be
+  // taken before trying again. Must be called from the consumer sequence.
+  bool TryMarkIdle();
+
+ private:
+  struct Node;
+
+  // Returns the value of |head_| and of the |next| field of the least recently
+  // pushed node when the queue is active. Never dereferenced.
+  static Node* EmptyAndActive();
+
+  // Returns true if |node| is neither nullptr nor EmptyAndActive().
+  static bool IsNode(const Node* node);
+
+  // Most recently pushed node, or one of the values below when the queue is
+  // empty. Pushed nodes are linked from the most recent to the least recent
+  // through Node::next, the last node pointing to one of the values below.
+  //
+  // nullptr: The queue is idle.
+  // EmptyAndActive(): The queue is active.
+  std::atomic<Node*> head_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockFreeTaskQueue);
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_MESSAGE_LOOP_LOCK_FREE_TASK_QUEUE_H_
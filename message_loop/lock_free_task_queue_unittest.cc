@@ -0,0 +1,161 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop/lock_free_task_queue.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/callback_helpers.h"
+#include "base/location.h"
+#include "base/macros.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// Returns a PendingTask identified by |id|, stored in its |sequence_num|.
+PendingTask CreateTask(int id) {
+  PendingTask pending_task(FROM_HERE, DoNothing());
+  pending_task.sequence_num = id;
+  return pending_task;
+}
+
+class ThreadPushingTasks : public SimpleThread {
+ public:
+  ThreadPushingTasks(LockFreeTaskQueue* queue,
+                     WaitableEvent* start_event,
+                     int thread_index,
+                     int num_tasks)
+      : SimpleThread("ThreadPushingTasks"),
+        queue_(queue),
+        start_event_(start_event),
+        thread_index_(thread_index),
+        num_tasks_(num_tasks) {}
+
+  // SimpleThread:
+  void Run() override {
+    start_event_->Wait();
+    for (int i = 0; i < num_tasks_; ++i)
+      queue_->Push(CreateTask(thread_index_ * num_tasks_ + i));
+  }
+
+ private:
+  LockFreeTaskQueue* const queue_;
+  WaitableEvent* const start_event_;
+  const int thread_index_;
+  const int num_tasks_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadPushingTasks);
+};
+
+}  // namespace
+
+TEST(LockFreeTaskQueueTest, TakeAllInPushOrder) {
+  LockFreeTaskQueue queue;
+  TaskQueue work_queue;
+  EXPECT_FALSE(queue.TakeAll(&work_queue));
+
+  for (int i = 0; i < 5; ++i)
+    queue.Push(CreateTask(i));
+  EXPECT_TRUE(queue.TakeAll(&work_queue));
+  EXPECT_FALSE(queue.TakeAll(&work_queue));
+
+  ASSERT_EQ(5U, work_queue.size());
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(i, work_queue.front().sequence_num);
+    work_queue.pop();
+  }
+}
+
+TEST(LockFreeTaskQueueTest, ScheduleWorkOnlyWhenIdle) {
+  LockFreeTaskQueue queue;
+  TaskQueue work_queue;
+
+  // The queue is initially active: pushing doesn't request a wake up.
+  EXPECT_FALSE(queue.Push(CreateTask(0)));
+
+  // The queue can't be marked idle while it has tasks.
+  EXPECT_FALSE(queue.TryMarkIdle());
+  EXPECT_TRUE(queue.TakeAll(&work_queue));
+
+  // Once idle, only the first push requests a wake up.
+  EXPECT_TRUE(queue.TryMarkIdle());
+  EXPECT_TRUE(queue.TryMarkIdle());
+  EXPECT_TRUE(queue.Push(CreateTask(1)));
+  EXPECT_FALSE(queue.Push(CreateTask(2)));
+
+  // Taking tasks makes the queue active again.
+  EXPECT_TRUE(queue.TakeAll(&work_queue));
+  EXPECT_FALSE(queue.Push(CreateTask(3)));
+  EXPECT_TRUE(queue.TakeAll(&work_queue));
+  EXPECT_TRUE(queue.TryMarkIdle());
+  EXPECT_TRUE(queue.Push(CreateTask(4)));
+
+  EXPECT_EQ(4U, work_queue.size());
+}
+
+TEST(LockFreeTaskQueueTest, DeletesRemainingTasks) {
+  bool deleted = false;
+  {
+    LockFreeTaskQueue queue;
+    PendingTask pending_task(
+        FROM_HERE,
+        BindOnce([](const ScopedClosureRunner&) {},
+                 ScopedClosureRunner(BindOnce(
+                     [](bool* deleted) { *deleted = true; }, &deleted))));
+    queue.Push(std::move(pending_task));
+    EXPECT_FALSE(deleted);
+  }
+  EXPECT_TRUE(deleted);
+}
+
+// Verify that no task is lost and that tasks pushed by a given thread are taken
+// in order when many threads push concurrently.
+TEST(LockFreeTaskQueueTest, MultipleProducers) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumTasksPerThread = 1000;
+
+  LockFreeTaskQueue queue;
+  WaitableEvent start_event(WaitableEvent::ResetPolicy::MANUAL,
+                            WaitableEvent::InitialState::NOT_SIGNALED);
+  std::vector<std::unique_ptr<ThreadPushingTasks>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(std::make_unique<ThreadPushingTasks>(
+        &queue, &start_event, i, kNumTasksPerThread));
+    threads.back()->Start();
+  }
+  start_event.Signal();
+
+  std::vector<int> next_id_per_thread(kNumThreads);
+  for (int i = 0; i < kNumThreads; ++i)
+    next_id_per_thread[i] = i * kNumTasksPerThread;
+
+  int num_tasks_taken = 0;
+  while (num_tasks_taken < kNumThreads * kNumTasksPerThread) {
+    TaskQueue work_queue;
+    if (!queue.TakeAll(&work_queue))
+      continue;
+    while (!work_queue.empty()) {
+      const int id = work_queue.front().sequence_num;
+      work_queue.pop();
+      EXPECT_EQ(next_id_per_thread[id / kNumTasksPerThread]++, id);
+      ++num_tasks_taken;
+    }
+  }
+
+  for (const auto& thread : threads)
+    thread->Join();
+  TaskQueue work_queue;
+  EXPECT_FALSE(queue.TakeAll(&work_queue));
+}
+
+}  // namespace internal
+}  // namespace base
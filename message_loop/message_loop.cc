@@ -169,6 +169,11 @@ void MessageLoop::RemoveTaskObserver(TaskObserver* task_observer) {
   task_observers_.RemoveObserver(task_observer);
 }
 
+void MessageLoop::SetDelayedTaskSlack(TimeDelta slack) {
+  DCHECK_CALLED_ON_VALID_THREAD(bound_thread_checker_);
+  incoming_task_queue_->SetDelayedTaskSlack(slack);
+}
+
 bool MessageLoop::IsIdleForTesting() {
   // Have unprocessed tasks? (this reloads the work queue if necessary)
   if (incoming_task_queue_->triage_tasks().HasTasks())
@@ -363,13 +368,13 @@ bool MessageLoop::DoWork() {
 
     if (!pending_task.delayed_run_time.is_null()) {
       int sequence_num = pending_task.sequence_num;
-      TimeTicks delayed_run_time = pending_task.delayed_run_time;
       incoming_task_queue_->delayed_tasks().Push(std::move(pending_task));
-      // If we changed the topmost task, then it is time to reschedule.
-      if (incoming_task_queue_->delayed_tasks().Peek().sequence_num ==
-          sequence_num) {
-        pump_->ScheduleDelayedWork(delayed_run_time);
-      }
+      // If we changed the topmost task, then it is time to reschedule. The
+      // queue may have deferred the task's run time to coalesce wake-ups.
+      const PendingTask& next_task =
+          incoming_task_queue_->delayed_tasks().Peek();
+      if (next_task.sequence_num == sequence_num)
+        pump_->ScheduleDelayedWork(next_task.delayed_run_time);
     } else if (DeferOrRunPendingTask(std::move(pending_task))) {
       return true;
     }
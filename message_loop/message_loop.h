@@ -146,6 +146,11 @@ class BASE_EXPORT MessageLoop : public MessagePump::Delegate,
     pump_->SetTimerSlack(timer_slack);
   }
 
+  // Lets delayed tasks posted to this message loop run up to |slack| late, so
+  // that tasks due close together run on a single wake-up. Must be called on
+  // the thread running this message loop.
+  void SetDelayedTaskSlack(TimeDelta slack);
+
   // Returns true if this loop is |type|. This allows subclasses (especially
   // those in tests) to specialize how they are identified.
   virtual bool IsType(Type type) const;
@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "base/atomicops.h"
@@ -118,8 +119,11 @@ class PostingThread {
 
 class MessageLoopPerfTest : public ::testing::TestWithParam<int> {
  public:
-  MessageLoopPerfTest()
-      : message_loop_task_runner_(SequencedTaskRunnerHandle::Get()),
+  MessageLoopPerfTest() : MessageLoopPerfTest(MessageLoop::TYPE_DEFAULT) {}
+
+  explicit MessageLoopPerfTest(MessageLoop::Type type)
+      : message_loop_(type),
+        message_loop_task_runner_(SequencedTaskRunnerHandle::Get()),
         run_posting_threads_(WaitableEvent::ResetPolicy::MANUAL,
                              WaitableEvent::InitialState::NOT_SIGNALED) {}
 
@@ -160,6 +164,54 @@ class MessageLoopPerfTest : public ::testing::TestWithParam<int> {
     DISALLOW_COPY_AND_ASSIGN(ContinuouslyPostTasks);
   };
 
+  // Posts bursts of tasks and waits for each burst to run before posting the
+  // next one, so that the message loop goes to sleep and is woken up between
+  // bursts.
+  class PostTaskBursts final : public PostingThread::Action {
+   public:
+    PostTaskBursts(MessageLoopPerfTest* outer)
+        : outer_(outer),
+          burst_done_(WaitableEvent::ResetPolicy::AUTOMATIC,
+                      WaitableEvent::InitialState::NOT_SIGNALED) {
+      DCHECK(outer_);
+    }
+    ~PostTaskBursts() override = default;
+
+   private:
+    static constexpr int kTasksPerBurst = 20;
+
+    void Run() override {
+      RepeatingClosure task_to_run =
+          BindRepeating([](size_t* num_tasks_run) { ++*num_tasks_run; },
+                        &outer_->num_tasks_run_);
+      while (!outer_->stop_posting_threads_.IsSet()) {
+        for (int i = 0; i < kTasksPerBurst - 1; ++i)
+          outer_->message_loop_task_runner_->PostTask(FROM_HERE, task_to_run);
+        outer_->message_loop_task_runner_->PostTask(
+            FROM_HERE,
+            BindOnce(
+                [](size_t* num_tasks_run, WaitableEvent* burst_done) {
+                  ++*num_tasks_run;
+                  burst_done->Signal();
+                },
+                &outer_->num_tasks_run_, &burst_done_));
+        subtle::NoBarrier_AtomicIncrement(&outer_->num_tasks_posted_,
+                                          kTasksPerBurst);
+
+        // The last burst doesn't run once the message loop quits.
+        while (!burst_done_.TimedWait(TimeDelta::FromMilliseconds(10))) {
+          if (outer_->stop_posting_threads_.IsSet())
+            return;
+        }
+      }
+    }
+
+    MessageLoopPerfTest* const outer_;
+    WaitableEvent burst_done_;
+
+    DISALLOW_COPY_AND_ASSIGN(PostTaskBursts);
+  };
+
   void SetUp() override {
     // This check is here because we can't ASSERT_TRUE in the constructor.
     ASSERT_TRUE(message_loop_task_runner_);
@@ -212,6 +264,21 @@ class MessageLoopPerfTest : public ::testing::TestWithParam<int> {
 
   TimeDelta tasks_run_duration() const { return tasks_run_duration_; }
 
+  // Prints the average time to post and to run a task, with |modifier|
+  // appended to the names of the measurements.
+  void PrintTaskRates(const std::string& modifier) const {
+    perf_test::PrintResult("task_posting", modifier,
+                           PostingThreadCountToString(GetParam()),
+                           tasks_posted_duration().InMicroseconds() /
+                               static_cast<double>(num_tasks_posted()),
+                           "us/task", true);
+    perf_test::PrintResult("task_running", modifier,
+                           PostingThreadCountToString(GetParam()),
+                           tasks_run_duration().InMicroseconds() /
+                               static_cast<double>(num_tasks_run()),
+                           "us/task", true);
+  }
+
  private:
   MessageLoop message_loop_;
 
@@ -229,26 +296,44 @@ class MessageLoopPerfTest : public ::testing::TestWithParam<int> {
   DISALLOW_COPY_AND_ASSIGN(MessageLoopPerfTest);
 };
 
+// Same as MessageLoopPerfTest, with a MessagePumpLibevent on POSIX.
+class MessageLoopForIOPerfTest : public MessageLoopPerfTest {
+ public:
+  MessageLoopForIOPerfTest() : MessageLoopPerfTest(MessageLoop::TYPE_IO) {}
+};
+
 }  // namespace
 
 TEST_P(MessageLoopPerfTest, PostTaskRate) {
   // Measures the average rate of posting tasks from different threads and the
   // average rate that the message loop is running those tasks.
   RunTest<ContinuouslyPostTasks>(GetParam(), TimeDelta::FromSeconds(3));
-  perf_test::PrintResult("task_posting", "",
-                         PostingThreadCountToString(GetParam()),
-                         tasks_posted_duration().InMicroseconds() /
-                             static_cast<double>(num_tasks_posted()),
-                         "us/task", true);
-  perf_test::PrintResult("task_running", "",
-                         PostingThreadCountToString(GetParam()),
-                         tasks_run_duration().InMicroseconds() /
-                             static_cast<double>(num_tasks_run()),
-                         "us/task", true);
+  PrintTaskRates("");
+}
+
+TEST_P(MessageLoopPerfTest, PostTaskBurstRate) {
+  // Measures the same rates when the message loop is woken up for each burst
+  // of tasks, which includes the cost of the wakeups.
+  RunTest<PostTaskBursts>(GetParam(), TimeDelta::FromSeconds(3));
+  PrintTaskRates("_bursts");
+}
+
+TEST_P(MessageLoopForIOPerfTest, PostTaskRate) {
+  RunTest<ContinuouslyPostTasks>(GetParam(), TimeDelta::FromSeconds(3));
+  PrintTaskRates("_io");
+}
+
+TEST_P(MessageLoopForIOPerfTest, PostTaskBurstRate) {
+  RunTest<PostTaskBursts>(GetParam(), TimeDelta::FromSeconds(3));
+  PrintTaskRates("_io_bursts");
 }
 
 INSTANTIATE_TEST_CASE_P(,
                         MessageLoopPerfTest,
                         ::testing::Values(1, 5, 10),
                         MessageLoopPerfTest::ParamInfoToString);
+INSTANTIATE_TEST_CASE_P(,
+                        MessageLoopForIOPerfTest,
+                        ::testing::Values(1, 5, 10),
+                        MessageLoopPerfTest::ParamInfoToString);
 }  // namespace base
@@ -4,13 +4,52 @@
 
 #include "base/message_loop/message_pump.h"
 
+#include "build/build_config.h"
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <sys/prctl.h>
+
+#include "base/logging.h"
+#endif
+
 namespace base {
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+namespace {
+
+// The slack of TIMER_SLACK_MAXIMUM. The kernel accepts any value, so this is
+// the longest delay we're willing to add to the delayed work of the threads
+// which ask for it.
+constexpr unsigned long kMaximumTimerSlackNs = 10 * 1000 * 1000;
+
+}  // namespace
+#endif
+
 MessagePump::MessagePump() = default;
 
 MessagePump::~MessagePump() = default;
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+void MessagePump::SetTimerSlack(TimerSlack timer_slack) {
+  // A slack of 0 restores the default slack of the thread, so the lowest one
+  // that can be set is 1ns.
+  unsigned long slack_ns = 0;
+  switch (timer_slack) {
+    case TIMER_SLACK_NONE:
+      break;
+    case TIMER_SLACK_MAXIMUM:
+      slack_ns = kMaximumTimerSlackNs;
+      break;
+    case TIMER_SLACK_HIGH_RESOLUTION:
+      slack_ns = 1;
+      break;
+  }
+  if (prctl(PR_SET_TIMERSLACK, slack_ns, 0, 0, 0))
+    DPLOG(ERROR) << "prctl(PR_SET_TIMERSLACK)";
+}
+#else
 void MessagePump::SetTimerSlack(TimerSlack) {
 }
+#endif
 
 }  // namespace base
@@ -122,7 +122,9 @@ class BASE_EXPORT MessagePump {
   // used on the thread that called Run.
   virtual void ScheduleDelayedWork(const TimeTicks& delayed_work_time) = 0;
 
-  // Sets the timer slack to the specified value.
+  // Sets the timer slack to the specified value. On Linux, the slack is set for
+  // the calling thread, so this must be called on the thread which runs the
+  // pump.
   virtual void SetTimerSlack(TimerSlack timer_slack);
 };
 
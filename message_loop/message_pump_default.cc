@@ -19,6 +19,15 @@
 
 namespace base {
 
+namespace {
+
+// How long a pump with high resolution timer slack polls for work at most
+// before going to sleep. Sleeping and being woken up takes a few tens of
+// microseconds of latency.
+constexpr TimeDelta kMaxSpinDuration = TimeDelta::FromMicroseconds(50);
+
+}  // namespace
+
 MessagePumpDefault::MessagePumpDefault()
     : keep_running_(true),
       event_(WaitableEvent::ResetPolicy::AUTOMATIC,
@@ -53,7 +62,11 @@ void MessagePumpDefault::Run(Delegate* delegate) {
       continue;
 
     ThreadRestrictions::ScopedAllowWait allow_wait;
-    if (delayed_work_time_.is_null()) {
+    if (spin_waiter_) {
+      spin_waiter_->TimedWaitUntil(&event_, delayed_work_time_.is_null()
+                                                ? TimeTicks::Max()
+                                                : delayed_work_time_);
+    } else if (delayed_work_time_.is_null()) {
       event_.Wait();
     } else {
       // No need to handle already expired |delayed_work_time_| in any special
@@ -85,8 +98,15 @@ void MessagePumpDefault::ScheduleDelayedWork(
   delayed_work_time_ = delayed_work_time;
 }
 
-#if defined(OS_MACOSX)
 void MessagePumpDefault::SetTimerSlack(TimerSlack timer_slack) {
+  if (timer_slack == TIMER_SLACK_HIGH_RESOLUTION) {
+    if (!spin_waiter_)
+      spin_waiter_ = std::make_unique<AdaptiveSpinWaiter>(kMaxSpinDuration);
+  } else {
+    spin_waiter_.reset();
+  }
+
+#if defined(OS_MACOSX)
   thread_latency_qos_policy_data_t policy{};
   policy.thread_latency_qos_tier = timer_slack == TIMER_SLACK_MAXIMUM
                                        ? LATENCY_QOS_TIER_3
@@ -97,7 +117,13 @@ void MessagePumpDefault::SetTimerSlack(TimerSlack timer_slack) {
                         reinterpret_cast<thread_policy_t>(&policy),
                         THREAD_LATENCY_QOS_POLICY_COUNT);
   MACH_DVLOG_IF(1, kr != KERN_SUCCESS, kr) << "thread_policy_set";
-}
+#else
+  MessagePump::SetTimerSlack(timer_slack);
 #endif
+}
+
+uint64_t MessagePumpDefault::num_avoided_wakeups() const {
+  return spin_waiter_ ? spin_waiter_->num_avoided_wakeups() : 0;
+}
 
 }  // namespace base
@@ -5,9 +5,14 @@
 #ifndef BASE_MESSAGE_LOOP_MESSAGE_PUMP_DEFAULT_H_
 #define BASE_MESSAGE_LOOP_MESSAGE_PUMP_DEFAULT_H_
 
+#include <stdint.h>
+
+#include <memory>
+
 #include "base/base_export.h"
 #include "base/macros.h"
 #include "base/message_loop/message_pump.h"
+#include "base/synchronization/adaptive_spin_waiter.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
@@ -24,9 +29,14 @@ class BASE_EXPORT MessagePumpDefault : public MessagePump {
   void Quit() override;
   void ScheduleWork() override;
   void ScheduleDelayedWork(const TimeTicks& delayed_work_time) override;
-#if defined(OS_MACOSX)
+  // With TIMER_SLACK_HIGH_RESOLUTION, the pump also polls for work for a few
+  // microseconds before going to sleep, so that a thread which is given work
+  // again right away isn't put to sleep and woken up in between.
   void SetTimerSlack(TimerSlack timer_slack) override;
-#endif
+
+  // Returns the number of times the pump found work while polling for it
+  // rather than after being woken up.
+  uint64_t num_avoided_wakeups() const;
 
  private:
   // This flag is set to false when Run should return.
@@ -38,6 +48,10 @@ class BASE_EXPORT MessagePumpDefault : public MessagePump {
   // The time at which we should call DoDelayedWork.
   TimeTicks delayed_work_time_;
 
+  // Used to poll |event_| before sleeping on it, with high resolution timer
+  // slack. Null otherwise.
+  std::unique_ptr<AdaptiveSpinWaiter> spin_waiter_;
+
   DISALLOW_COPY_AND_ASSIGN(MessagePumpDefault);
 };
 
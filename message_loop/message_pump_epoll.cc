@@ -0,0 +1,361 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop/message_pump_epoll.h"
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/auto_reset.h"
+#include "base/logging.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/stl_util.h"
+#include "base/trace_event/trace_event.h"
+
+namespace base {
+
+MessagePumpEpoll::FdWatchController::FdWatchController(
+    const Location& from_here)
+    : FdWatchControllerInterface(from_here) {}
+
+MessagePumpEpoll::FdWatchController::~FdWatchController() {
+  if (fd_ >= 0)
+    StopWatchingFileDescriptor();
+  if (was_destroyed_) {
+    DCHECK(!*was_destroyed_);
+    *was_destroyed_ = true;
+  }
+}
+
+bool MessagePumpEpoll::FdWatchController::StopWatchingFileDescriptor() {
+  bool success = true;
+  if (pump_)
+    success = pump_->RemoveController(this);
+  fd_ = -1;
+  mode_ = 0;
+  persistent_ = false;
+  edge_triggered_ = false;
+  watcher_ = nullptr;
+  return success;
+}
+
+void MessagePumpEpoll::FdWatchController::OnFileCanReadWithoutBlocking(
+    int fd) {
+  // Since OnFileCanWriteWithoutBlocking() gets called first, it can stop
+  // watching the file descriptor.
+  if (!watcher_)
+    return;
+  watcher_->OnFileCanReadWithoutBlocking(fd);
+}
+
+void MessagePumpEpoll::FdWatchController::OnFileCanWriteWithoutBlocking(
+    int fd) {
+  DCHECK(watcher_);
+  watcher_->OnFileCanWriteWithoutBlocking(fd);
+}
+
+MessagePumpEpoll::EpollEntry::EpollEntry() = default;
+
+MessagePumpEpoll::EpollEntry::~EpollEntry() = default;
+
+MessagePumpEpoll::MessagePumpEpoll()
+    : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)),
+      wakeup_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+  PCHECK(epoll_fd_.is_valid()) << "epoll_create1";
+  PCHECK(wakeup_fd_.is_valid()) << "eventfd";
+
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = wakeup_fd_.get();
+  PCHECK(epoll_ctl(epoll_fd_.get(), EPOLL_CTL_ADD, wakeup_fd_.get(), &event) ==
+         0)
+      << "epoll_ctl";
+}
+
+MessagePumpEpoll::~MessagePumpEpoll() {
+  // Controllers may outlive the pump; make them forget about it.
+  for (auto& fd_and_entry : entries_) {
+    for (FdWatchController* controller : fd_and_entry.second.controllers)
+      controller->pump_ = nullptr;
+  }
+}
+
+bool MessagePumpEpoll::WatchFileDescriptor(int fd,
+                                           bool persistent,
+                                           int mode,
+                                           FdWatchController* controller,
+                                           FdWatcher* delegate) {
+  return WatchFileDescriptorImpl(fd, persistent, false, mode, controller,
+                                 delegate);
+}
+
+bool MessagePumpEpoll::WatchFileDescriptorEdgeTriggered(
+    int fd,
+    int mode,
+    FdWatchController* controller,
+    FdWatcher* delegate) {
+  return WatchFileDescriptorImpl(fd, true, true, mode, controller, delegate);
+}
+
+// Reentrant!
+void MessagePumpEpoll::Run(Delegate* delegate) {
+  AutoReset<bool> auto_reset_keep_running(&keep_running_, true);
+  AutoReset<bool> auto_reset_in_run(&in_run_, true);
+
+  for (;;) {
+    bool did_work = delegate->DoWork();
+    if (!keep_running_)
+      break;
+
+    did_work |= WaitForEvents(0);
+    if (!keep_running_)
+      break;
+
+    did_work |= delegate->DoDelayedWork(&delayed_work_time_);
+    if (!keep_running_)
+      break;
+
+    if (did_work)
+      continue;
+
+    did_work = delegate->DoIdleWork();
+    if (!keep_running_)
+      break;
+
+    if (did_work)
+      continue;
+
+    int timeout_ms = -1;
+    if (!delayed_work_time_.is_null()) {
+      TimeDelta delay = delayed_work_time_ - TimeTicks::Now();
+      if (delay <= TimeDelta()) {
+        // It looks like delayed_work_time_ indicates a time in the past, so we
+        // need to call DoDelayedWork now.
+        delayed_work_time_ = TimeTicks();
+        continue;
+      }
+      // Round up so that the delayed work is due when epoll_wait() returns.
+      timeout_ms = saturated_cast<int>(delay.InMillisecondsRoundedUp());
+    }
+    WaitForEvents(timeout_ms);
+
+    if (!keep_running_)
+      break;
+  }
+}
+
+void MessagePumpEpoll::Quit() {
+  DCHECK(in_run_) << "Quit was called outside of Run!";
+  // Tell both epoll_wait() and Run that they should break out of their loops.
+  keep_running_ = false;
+  ScheduleWork();
+}
+
+void MessagePumpEpoll::ScheduleWork() {
+  // Writing to the eventfd is threadsafe and wakes up epoll_wait().
+  const uint64_t value = 1;
+  int nwrite = HANDLE_EINTR(write(wakeup_fd_.get(), &value, sizeof(value)));
+  DCHECK(nwrite == sizeof(value) || errno == EAGAIN)
+      << "[nwrite:" << nwrite << "] [errno:" << errno << "]";
+}
+
+void MessagePumpEpoll::ScheduleDelayedWork(const TimeTicks& delayed_work_time) {
+  // We know that we can't be blocked on epoll_wait() right now since this
+  // method can only be called on the same thread as Run, so we only need to
+  // update our record of how long to sleep when we do sleep.
+  delayed_work_time_ = delayed_work_time;
+}
+
+bool MessagePumpEpoll::WatchFileDescriptorImpl(int fd,
+                                               bool persistent,
+                                               bool edge_triggered,
+                                               int mode,
+                                               FdWatchController* controller,
+                                               FdWatcher* delegate) {
+  DCHECK_GE(fd, 0);
+  DCHECK(controller);
+  DCHECK(delegate);
+  DCHECK(mode == WATCH_READ || mode == WATCH_WRITE || mode == WATCH_READ_WRITE);
+  // WatchFileDescriptor should be called on the pump thread. It is not
+  // threadsafe, and your watcher may never be registered.
+  DCHECK(watch_file_descriptor_caller_checker_.CalledOnValidThread());
+  DCHECK(!controller->pump_ || controller->pump_ == this);
+
+  if (controller->fd_ >= 0) {
+    // It's illegal to use this function to listen on 2 separate fds with the
+    // same |controller|.
+    if (controller->fd_ != fd) {
+      NOTREACHED() << "FDs don't match" << controller->fd_ << "!=" << fd;
+      return false;
+    }
+    // Combine old/new registrations.
+    mode |= controller->mode_;
+    persistent |= controller->persistent_;
+  }
+
+  controller->fd_ = fd;
+  controller->mode_ = mode;
+  controller->persistent_ = persistent;
+  controller->edge_triggered_ = edge_triggered;
+  controller->watcher_ = delegate;
+
+  bool success;
+  if (controller->pump_) {
+    // Only the events watched on |fd| may change.
+    success = UpdateEpollEntry(fd, &entries_[fd]);
+  } else {
+    success = AddController(controller);
+  }
+  if (!success) {
+    controller->StopWatchingFileDescriptor();
+    return false;
+  }
+  return true;
+}
+
+bool MessagePumpEpoll::AddController(FdWatchController* controller) {
+  DCHECK(!controller->pump_);
+  controller->pump_ = this;
+  EpollEntry* entry = &entries_[controller->fd_];
+  entry->controllers.push_back(controller);
+  return UpdateEpollEntry(controller->fd_, entry);
+}
+
+bool MessagePumpEpoll::RemoveController(FdWatchController* controller) {
+  DCHECK_EQ(this, controller->pump_);
+  controller->pump_ = nullptr;
+  auto it = entries_.find(controller->fd_);
+  DCHECK(it != entries_.end());
+  std::vector<FdWatchController*>& controllers = it->second.controllers;
+  controllers.erase(
+      std::find(controllers.begin(), controllers.end(), controller));
+  return UpdateEpollEntry(controller->fd_, &it->second);
+}
+
+bool MessagePumpEpoll::UpdateEpollEntry(int fd, EpollEntry* entry) {
+  uint32_t events = 0;
+  for (const FdWatchController* controller : entry->controllers) {
+    DCHECK_EQ(entry->controllers.front()->edge_triggered_,
+              controller->edge_triggered_);
+    if (controller->mode_ & WATCH_READ)
+      events |= EPOLLIN;
+    if (controller->mode_ & WATCH_WRITE)
+      events |= EPOLLOUT;
+    if (controller->edge_triggered_)
+      events |= EPOLLET;
+  }
+
+  bool success = true;
+  if (events != entry->registered_events) {
+    int op = EPOLL_CTL_MOD;
+    if (!entry->registered_events)
+      op = EPOLL_CTL_ADD;
+    else if (!events)
+      op = EPOLL_CTL_DEL;
+    epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_.get(), op, fd, &event) == 0) {
+      entry->registered_events = events;
+    } else if (op == EPOLL_CTL_DEL && (errno == EBADF || errno == ENOENT)) {
+      // |fd| was closed before it was unwatched, which removed it from the
+      // epoll set already.
+    } else {
+      DPLOG(ERROR) << "epoll_ctl failed(fd=" << fd << ")";
+      success = false;
+    }
+  }
+
+  if (entry->controllers.empty())
+    entries_.erase(fd);
+  return success;
+}
+
+bool MessagePumpEpoll::WaitForEvents(int timeout_ms) {
+  epoll_event events[kMaxEventsPerWait];
+  int num_events =
+      epoll_wait(epoll_fd_.get(), events, kMaxEventsPerWait, timeout_ms);
+  if (num_events < 0) {
+    DPCHECK(errno == EINTR) << "epoll_wait";
+    return false;
+  }
+
+  for (int i = 0; i < num_events; ++i) {
+    if (events[i].data.fd == wakeup_fd_.get()) {
+      // Reset the eventfd written by ScheduleWork().
+      uint64_t value;
+      int nread = HANDLE_EINTR(read(wakeup_fd_.get(), &value, sizeof(value)));
+      DCHECK(nread == sizeof(value) || errno == EAGAIN);
+      continue;
+    }
+    OnEpollEvent(events[i].data.fd, events[i].events);
+  }
+  return num_events > 0;
+}
+
+void MessagePumpEpoll::OnEpollEvent(int fd, uint32_t events) {
+  auto it = entries_.find(fd);
+  // A previous callback of the same batch may have stopped watching |fd|.
+  if (it == entries_.end())
+    return;
+
+  // Like libevent, report errors and hang ups to both readers and writers.
+  const bool can_read = events & (EPOLLIN | EPOLLPRI | EPOLLERR | EPOLLHUP);
+  const bool can_write = events & (EPOLLOUT | EPOLLERR | EPOLLHUP);
+
+  // Callbacks can add and remove controllers of |fd|, so iterate over a copy
+  // and skip the controllers which were removed in the meantime.
+  const std::vector<FdWatchController*> controllers = it->second.controllers;
+  for (FdWatchController* controller : controllers) {
+    it = entries_.find(fd);
+    if (it == entries_.end())
+      return;
+    if (!ContainsValue(it->second.controllers, controller))
+      continue;
+    NotifyController(controller, fd,
+                     can_read && (controller->mode_ & WATCH_READ),
+                     can_write && (controller->mode_ & WATCH_WRITE));
+  }
+}
+
+void MessagePumpEpoll::NotifyController(FdWatchController* controller,
+                                        int fd,
+                                        bool can_read,
+                                        bool can_write) {
+  if (!can_read && !can_write)
+    return;
+
+  TRACE_EVENT2("toplevel", "MessagePumpEpoll::OnEpollEvent", "src_file",
+               controller->created_from_location().file_name(), "src_func",
+               controller->created_from_location().function_name());
+  TRACE_HEAP_PROFILER_API_SCOPED_TASK_EXECUTION heap_profiler_scope(
+      controller->created_from_location().file_name());
+
+  // A non-persistent watch only fires once.
+  if (!controller->persistent_)
+    RemoveController(controller);
+
+  if (can_read && can_write) {
+    // Both callbacks will be called. It is necessary to check that
+    // |controller| is not destroyed.
+    bool controller_was_destroyed = false;
+    controller->was_destroyed_ = &controller_was_destroyed;
+    controller->OnFileCanWriteWithoutBlocking(fd);
+    if (!controller_was_destroyed)
+      controller->OnFileCanReadWithoutBlocking(fd);
+    if (!controller_was_destroyed)
+      controller->was_destroyed_ = nullptr;
+  } else if (can_write) {
+    controller->OnFileCanWriteWithoutBlocking(fd);
+  } else {
+    controller->OnFileCanReadWithoutBlocking(fd);
+  }
+}
+
+}  // namespace base
@@ -0,0 +1,164 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MESSAGE_LOOP_MESSAGE_PUMP_EPOLL_H_
+#define BASE_MESSAGE_LOOP_MESSAGE_PUMP_EPOLL_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/files/scoped_file.h"
+#include "base/macros.h"
+#include "base/message_loop/message_pump.h"
+#include "base/message_loop/watchable_io_message_pump_posix.h"
+#include "base/threading/thread_checker.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// MessagePump built directly on top of Linux's epoll, used by MessageLoopForIO
+// on Linux. Registrations are kept in a table of epoll entries, one per file
+// descriptor, so that changing what a controller watches only costs an
+// epoll_ctl() call when the set of events watched on its file descriptor
+// changes. Ready file descriptors are dispatched in batches of up to
+// kMaxEventsPerWait per epoll_wait() call.
+//
+// Watches are level-triggered by default, like with MessagePumpLibevent. See
+// WatchFileDescriptorEdgeTriggered() for the edge-triggered alternative.
+class BASE_EXPORT MessagePumpEpoll : public MessagePump,
+                                     public WatchableIOMessagePumpPosix {
+ public:
+  class FdWatchController : public FdWatchControllerInterface {
+   public:
+    explicit FdWatchController(const Location& from_here);
+
+    // Implicitly calls StopWatchingFileDescriptor.
+    ~FdWatchController() override;
+
+    // FdWatchControllerInterface:
+    bool StopWatchingFileDescriptor() override;
+
+   private:
+    friend class MessagePumpEpoll;
+    friend class MessagePumpEpollTest;
+
+    void OnFileCanReadWithoutBlocking(int fd);
+    void OnFileCanWriteWithoutBlocking(int fd);
+
+    // The watched file descriptor, or -1 if the controller isn't in use.
+    int fd_ = -1;
+    // The combination of WatchableIOMessagePumpPosix::Mode values watched.
+    int mode_ = 0;
+    bool persistent_ = false;
+    bool edge_triggered_ = false;
+    // The pump whose epoll entry for |fd_| includes |this|. Reset when a
+    // non-persistent watch fires, while |fd_| and |mode_| are kept so that
+    // watching again adds onto the previous registration.
+    MessagePumpEpoll* pump_ = nullptr;
+    FdWatcher* watcher_ = nullptr;
+    // If this pointer is non-NULL, the pointee is set to true in the
+    // destructor.
+    bool* was_destroyed_ = nullptr;
+
+    DISALLOW_COPY_AND_ASSIGN(FdWatchController);
+  };
+
+  // Maximum number of ready file descriptors returned by epoll_wait() at once.
+  static constexpr int kMaxEventsPerWait = 16;
+
+  MessagePumpEpoll();
+  ~MessagePumpEpoll() override;
+
+  // See WatchableIOMessagePumpPosix.
+  bool WatchFileDescriptor(int fd,
+                           bool persistent,
+                           int mode,
+                           FdWatchController* controller,
+                           FdWatcher* delegate);
+
+  // Same as a persistent WatchFileDescriptor(), except that |delegate| is only
+  // notified when |fd| becomes ready again after the previous notification
+  // (EPOLLET). |delegate| must read or write until EAGAIN before it can expect
+  // another notification. All the controllers watching |fd| must use the same
+  // triggering.
+  bool WatchFileDescriptorEdgeTriggered(int fd,
+                                        int mode,
+                                        FdWatchController* controller,
+                                        FdWatcher* delegate);
+
+  // MessagePump methods:
+  void Run(Delegate* delegate) override;
+  void Quit() override;
+  void ScheduleWork() override;
+  void ScheduleDelayedWork(const TimeTicks& delayed_work_time) override;
+
+ private:
+  friend class MessagePumpEpollTest;
+
+  // The controllers watching a file descriptor, and the events registered for
+  // it with epoll.
+  struct EpollEntry {
+    EpollEntry();
+    ~EpollEntry();
+
+    std::vector<FdWatchController*> controllers;
+    uint32_t registered_events = 0;
+  };
+
+  bool WatchFileDescriptorImpl(int fd,
+                               bool persistent,
+                               bool edge_triggered,
+                               int mode,
+                               FdWatchController* controller,
+                               FdWatcher* delegate);
+
+  // Adds |controller| to the entry of |controller->fd_|, or removes it. Returns
+  // false if epoll_ctl() fails.
+  bool AddController(FdWatchController* controller);
+  bool RemoveController(FdWatchController* controller);
+
+  // Brings the epoll registration of |fd| in line with the controllers of
+  // |entry|, removing |entry| if it has no controllers left.
+  bool UpdateEpollEntry(int fd, EpollEntry* entry);
+
+  // Waits up to |timeout_ms| for events and dispatches them. A negative
+  // |timeout_ms| waits forever. Returns true if any event was processed.
+  bool WaitForEvents(int timeout_ms);
+
+  // Notifies the controllers of |fd| that it is ready for |events|.
+  void OnEpollEvent(int fd, uint32_t events);
+
+  // Notifies |controller| that its file descriptor |fd| is ready for reading
+  // and/or writing.
+  void NotifyController(FdWatchController* controller,
+                        int fd,
+                        bool can_read,
+                        bool can_write);
+
+  // This flag is set to false when Run should return.
+  bool keep_running_ = true;
+
+  // This flag is set when inside Run.
+  bool in_run_ = false;
+
+  // The time at which we should call DoDelayedWork.
+  TimeTicks delayed_work_time_;
+
+  ScopedFD epoll_fd_;
+
+  // eventfd written by ScheduleWork() to wake up epoll_wait().
+  ScopedFD wakeup_fd_;
+
+  std::map<int, EpollEntry> entries_;
+
+  ThreadChecker watch_file_descriptor_caller_checker_;
+  DISALLOW_COPY_AND_ASSIGN(MessagePumpEpoll);
+};
+
+}  // namespace base
+
+#endif  // BASE_MESSAGE_LOOP_MESSAGE_PUMP_EPOLL_H_
@@ -0,0 +1,289 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop/message_pump_epoll.h"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <memory>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "base/message_loop/message_loop.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/run_loop.h"
+#include "base/test/gtest_util.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+class MessagePumpEpollTest : public testing::Test {
+ protected:
+  MessagePumpEpollTest() = default;
+  ~MessagePumpEpollTest() override = default;
+
+  void SetUp() override { ASSERT_TRUE(CreateLocalNonBlockingPipe(pipefds_)); }
+
+  void TearDown() override {
+    if (IGNORE_EINTR(close(pipefds_[0])) < 0)
+      PLOG(ERROR) << "close";
+    if (IGNORE_EINTR(close(pipefds_[1])) < 0)
+      PLOG(ERROR) << "close";
+  }
+
+  void OnEpollEvent(MessagePumpEpoll* pump, int fd) {
+    pump->OnEpollEvent(fd, EPOLLIN | EPOLLOUT);
+  }
+
+  bool WaitForEvents(MessagePumpEpoll* pump) {
+    return pump->WaitForEvents(0);
+  }
+
+  int pipefds_[2];
+};
+
+namespace {
+
+class BaseWatcher : public MessagePumpEpoll::FdWatcher {
+ public:
+  explicit BaseWatcher(MessagePumpEpoll::FdWatchController* controller)
+      : controller_(controller) {
+    DCHECK(controller_);
+  }
+  ~BaseWatcher() override = default;
+
+  // base:MessagePumpEpoll::FdWatcher interface
+  void OnFileCanReadWithoutBlocking(int /* fd */) override { NOTREACHED(); }
+
+  void OnFileCanWriteWithoutBlocking(int /* fd */) override { NOTREACHED(); }
+
+ protected:
+  MessagePumpEpoll::FdWatchController* controller_;
+};
+
+// Counts the notifications it receives.
+class CountingWatcher : public MessagePumpEpoll::FdWatcher {
+ public:
+  CountingWatcher() = default;
+  ~CountingWatcher() override = default;
+
+  // base:MessagePumpEpoll::FdWatcher interface
+  void OnFileCanReadWithoutBlocking(int /* fd */) override { ++num_reads_; }
+  void OnFileCanWriteWithoutBlocking(int /* fd */) override { ++num_writes_; }
+
+  int num_reads() const { return num_reads_; }
+  int num_writes() const { return num_writes_; }
+
+ private:
+  int num_reads_ = 0;
+  int num_writes_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingWatcher);
+};
+
+TEST_F(MessagePumpEpollTest, QuitOutsideOfRun) {
+  std::unique_ptr<MessagePumpEpoll> pump(new MessagePumpEpoll);
+  ASSERT_DCHECK_DEATH(pump->Quit());
+}
+
+class DeleteWatcher : public BaseWatcher {
+ public:
+  explicit DeleteWatcher(MessagePumpEpoll::FdWatchController* controller)
+      : BaseWatcher(controller) {}
+
+  ~DeleteWatcher() override { DCHECK(!controller_); }
+
+  void OnFileCanWriteWithoutBlocking(int /* fd */) override {
+    DCHECK(controller_);
+    delete controller_;
+    controller_ = nullptr;
+  }
+};
+
+TEST_F(MessagePumpEpollTest, DeleteWatcher) {
+  std::unique_ptr<MessagePumpEpoll> pump(new MessagePumpEpoll);
+  MessagePumpEpoll::FdWatchController* watcher =
+      new MessagePumpEpoll::FdWatchController(FROM_HERE);
+  DeleteWatcher delegate(watcher);
+  pump->WatchFileDescriptor(pipefds_[1], false,
+                            MessagePumpEpoll::WATCH_READ_WRITE, watcher,
+                            &delegate);
+
+  // Spoof an epoll notification.
+  OnEpollEvent(pump.get(), pipefds_[1]);
+}
+
+class StopWatcher : public BaseWatcher {
+ public:
+  explicit StopWatcher(MessagePumpEpoll::FdWatchController* controller)
+      : BaseWatcher(controller) {}
+
+  ~StopWatcher() override = default;
+
+  void OnFileCanWriteWithoutBlocking(int /* fd */) override {
+    controller_->StopWatchingFileDescriptor();
+  }
+};
+
+TEST_F(MessagePumpEpollTest, StopWatcher) {
+  std::unique_ptr<MessagePumpEpoll> pump(new MessagePumpEpoll);
+  MessagePumpEpoll::FdWatchController watcher(FROM_HERE);
+  StopWatcher delegate(&watcher);
+  pump->WatchFileDescriptor(pipefds_[1], true,
+                            MessagePumpEpoll::WATCH_READ_WRITE, &watcher,
+                            &delegate);
+
+  // Spoof an epoll notification.
+  OnEpollEvent(pump.get(), pipefds_[1]);
+}
+
+// Tests that a file descriptor can be watched for reading and for writing by
+// two controllers, as FileDescriptorWatcher does.
+TEST_F(MessagePumpEpollTest, TwoControllersOnOneFd) {
+  MessagePumpEpoll pump;
+  MessagePumpEpoll::FdWatchController read_controller(FROM_HERE);
+  MessagePumpEpoll::FdWatchController write_controller(FROM_HERE);
+  CountingWatcher read_watcher;
+  CountingWatcher write_watcher;
+  ASSERT_TRUE(pump.WatchFileDescriptor(pipefds_[0], true,
+                                       MessagePumpEpoll::WATCH_READ,
+                                       &read_controller, &read_watcher));
+  ASSERT_TRUE(pump.WatchFileDescriptor(pipefds_[0], true,
+                                       MessagePumpEpoll::WATCH_WRITE,
+                                       &write_controller, &write_watcher));
+
+  OnEpollEvent(&pump, pipefds_[0]);
+  EXPECT_EQ(1, read_watcher.num_reads());
+  EXPECT_EQ(0, read_watcher.num_writes());
+  EXPECT_EQ(0, write_watcher.num_reads());
+  EXPECT_EQ(1, write_watcher.num_writes());
+
+  EXPECT_TRUE(write_controller.StopWatchingFileDescriptor());
+  OnEpollEvent(&pump, pipefds_[0]);
+  EXPECT_EQ(2, read_watcher.num_reads());
+  EXPECT_EQ(1, write_watcher.num_writes());
+}
+
+TEST_F(MessagePumpEpollTest, NonPersistentWatchFiresOnce) {
+  MessagePumpEpoll pump;
+  MessagePumpEpoll::FdWatchController controller(FROM_HERE);
+  CountingWatcher watcher;
+  ASSERT_TRUE(pump.WatchFileDescriptor(pipefds_[0], false,
+                                       MessagePumpEpoll::WATCH_READ,
+                                       &controller, &watcher));
+
+  const char buf = 0;
+  ASSERT_TRUE(WriteFileDescriptor(pipefds_[1], &buf, 1));
+  EXPECT_TRUE(WaitForEvents(&pump));
+  EXPECT_EQ(1, watcher.num_reads());
+
+  // The pipe is still readable, but the watch is gone.
+  EXPECT_FALSE(WaitForEvents(&pump));
+  EXPECT_EQ(1, watcher.num_reads());
+
+  // Watching again works.
+  ASSERT_TRUE(pump.WatchFileDescriptor(pipefds_[0], false,
+                                       MessagePumpEpoll::WATCH_READ,
+                                       &controller, &watcher));
+  EXPECT_TRUE(WaitForEvents(&pump));
+  EXPECT_EQ(2, watcher.num_reads());
+}
+
+TEST_F(MessagePumpEpollTest, LevelTriggered) {
+  MessagePumpEpoll pump;
+  MessagePumpEpoll::FdWatchController controller(FROM_HERE);
+  CountingWatcher watcher;
+  ASSERT_TRUE(pump.WatchFileDescriptor(pipefds_[0], true,
+                                       MessagePumpEpoll::WATCH_READ,
+                                       &controller, &watcher));
+
+  const char buf = 0;
+  ASSERT_TRUE(WriteFileDescriptor(pipefds_[1], &buf, 1));
+  EXPECT_TRUE(WaitForEvents(&pump));
+  EXPECT_TRUE(WaitForEvents(&pump));
+  EXPECT_EQ(2, watcher.num_reads());
+}
+
+TEST_F(MessagePumpEpollTest, EdgeTriggered) {
+  MessagePumpEpoll pump;
+  MessagePumpEpoll::FdWatchController controller(FROM_HERE);
+  CountingWatcher watcher;
+  ASSERT_TRUE(pump.WatchFileDescriptorEdgeTriggered(
+      pipefds_[0], MessagePumpEpoll::WATCH_READ, &controller, &watcher));
+
+  const char buf = 0;
+  ASSERT_TRUE(WriteFileDescriptor(pipefds_[1], &buf, 1));
+  EXPECT_TRUE(WaitForEvents(&pump));
+  EXPECT_EQ(1, watcher.num_reads());
+
+  // The pipe is still readable, but didn't become readable again.
+  EXPECT_FALSE(WaitForEvents(&pump));
+  EXPECT_EQ(1, watcher.num_reads());
+
+  ASSERT_TRUE(WriteFileDescriptor(pipefds_[1], &buf, 1));
+  EXPECT_TRUE(WaitForEvents(&pump));
+  EXPECT_EQ(2, watcher.num_reads());
+}
+
+TEST_F(MessagePumpEpollTest, ControllerOutlivesPump) {
+  MessagePumpEpoll::FdWatchController controller(FROM_HERE);
+  CountingWatcher watcher;
+  {
+    MessagePumpEpoll pump;
+    ASSERT_TRUE(pump.WatchFileDescriptor(pipefds_[0], true,
+                                         MessagePumpEpoll::WATCH_READ,
+                                         &controller, &watcher));
+  }
+  EXPECT_TRUE(controller.StopWatchingFileDescriptor());
+}
+
+void FatalClosure() {
+  FAIL() << "Reached fatal closure.";
+}
+
+class QuitWatcher : public BaseWatcher {
+ public:
+  QuitWatcher(MessagePumpEpoll::FdWatchController* controller,
+              OnceClosure quit_closure)
+      : BaseWatcher(controller), quit_closure_(std::move(quit_closure)) {}
+
+  void OnFileCanReadWithoutBlocking(int /* fd */) override {
+    // Post a fatal closure to the MessageLoop before we quit it.
+    ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, BindOnce(&FatalClosure));
+
+    std::move(quit_closure_).Run();
+  }
+
+ private:
+  OnceClosure quit_closure_;
+};
+
+// Tests that MessagePumpEpoll quits immediately when it is quit from a
+// watcher.
+TEST_F(MessagePumpEpollTest, QuitWatcher) {
+  MessagePumpEpoll* pump = new MessagePumpEpoll;  // owned by |loop|.
+  MessageLoop loop(WrapUnique(pump));
+  RunLoop run_loop;
+  MessagePumpEpoll::FdWatchController controller(FROM_HERE);
+  QuitWatcher delegate(&controller, run_loop.QuitClosure());
+
+  // Tell the pump to watch the pipe.
+  pump->WatchFileDescriptor(pipefds_[0], false, MessagePumpEpoll::WATCH_READ,
+                            &controller, &delegate);
+
+  const char buf = 0;
+  ASSERT_TRUE(WriteFileDescriptor(pipefds_[1], &buf, 1));
+
+  // Now run the MessageLoop.
+  run_loop.Run();
+}
+
+}  // namespace
+
+}  // namespace base
@@ -18,6 +18,8 @@
 #include "base/message_loop/message_pump_default.h"
 #elif defined(OS_FUCHSIA)
 #include "base/message_loop/message_pump_fuchsia.h"
+#elif defined(OS_LINUX)
+#include "base/message_loop/message_pump_epoll.h"
 #elif defined(OS_POSIX)
 #include "base/message_loop/message_pump_libevent.h"
 #endif
@@ -33,6 +35,8 @@ using MessagePumpForIO = MessagePumpIOSForIO;
 using MessagePumpForIO = MessagePumpDefault;
 #elif defined(OS_FUCHSIA)
 using MessagePumpForIO = MessagePumpFuchsia;
+#elif defined(OS_LINUX)
+using MessagePumpForIO = MessagePumpEpoll;
 #elif defined(OS_POSIX)
 using MessagePumpForIO = MessagePumpLibevent;
 #else
@@ -23,6 +23,11 @@
 #include "base/mac/scoped_nsautorelease_pool.h"
 #endif
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#endif
+
 // Lifecycle of struct event
 // Libevent uses two main data structures:
 // struct event_base (of which there is one per message pump), and
@@ -113,7 +118,15 @@ MessagePumpLibevent::~MessagePumpLibevent() {
   DCHECK(event_base_);
   event_del(wakeup_event_);
   delete wakeup_event_;
-  if (wakeup_pipe_in_ >= 0) {
+  if (high_res_timer_event_) {
+    event_del(high_res_timer_event_);
+    delete high_res_timer_event_;
+  }
+  if (high_res_timer_fd_ >= 0) {
+    if (IGNORE_EINTR(close(high_res_timer_fd_)) < 0)
+      DPLOG(ERROR) << "close";
+  }
+  if (wakeup_pipe_in_ >= 0 && wakeup_pipe_in_ != wakeup_pipe_out_) {
     if (IGNORE_EINTR(close(wakeup_pipe_in_)) < 0)
       DPLOG(ERROR) << "close";
   }
@@ -237,6 +250,13 @@ void MessagePumpLibevent::Run(Delegate* delegate) {
       event_base_loop(event_base_, EVLOOP_ONCE);
     } else {
       TimeDelta delay = delayed_work_time_ - TimeTicks::Now();
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+      if (delay > TimeDelta() && high_res_timer_fd_ >= 0) {
+        SetHighResolutionTimer(delay);
+        event_base_loop(event_base_, EVLOOP_ONCE);
+        SetHighResolutionTimer(TimeDelta());
+      } else
+#endif
       if (delay > TimeDelta()) {
         struct timeval poll_tv;
         poll_tv.tv_sec = delay.InSeconds();
@@ -266,10 +286,19 @@ void MessagePumpLibevent::Quit() {
 }
 
 void MessagePumpLibevent::ScheduleWork() {
+  // A wakeup which is already pending makes the loop run its work after this
+  // call, so there's no need for another one.
+  if (wakeup_pending_.exchange(true, std::memory_order_acq_rel))
+    return;
+
   // Tell libevent (in a threadsafe way) that it should break out of its loop.
-  char buf = 0;
-  int nwrite = HANDLE_EINTR(write(wakeup_pipe_in_, &buf, 1));
-  DCHECK(nwrite == 1 || errno == EAGAIN)
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  const uint64_t buf = 1;
+#else
+  const char buf = 0;
+#endif
+  int nwrite = HANDLE_EINTR(write(wakeup_pipe_in_, &buf, sizeof(buf)));
+  DCHECK(nwrite == sizeof(buf) || errno == EAGAIN)
       << "[nwrite:" << nwrite << "] [errno:" << errno << "]";
 }
 
@@ -281,7 +310,65 @@ void MessagePumpLibevent::ScheduleDelayedWork(
   delayed_work_time_ = delayed_work_time;
 }
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+void MessagePumpLibevent::SetTimerSlack(TimerSlack timer_slack) {
+  MessagePump::SetTimerSlack(timer_slack);
+  if (timer_slack != TIMER_SLACK_HIGH_RESOLUTION || high_res_timer_fd_ >= 0)
+    return;
+
+  // The timerfd is kept once created. The pump then wakes up to the
+  // microsecond whatever its slack, which is no worse than the libevent
+  // timeouts.
+  high_res_timer_fd_ =
+      timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (high_res_timer_fd_ < 0) {
+    DPLOG(ERROR) << "timerfd_create";
+    return;
+  }
+  high_res_timer_event_ = new event;
+  event_set(high_res_timer_event_, high_res_timer_fd_, EV_READ | EV_PERSIST,
+            OnHighResolutionTimer, this);
+  event_base_set(event_base_, high_res_timer_event_);
+  if (event_add(high_res_timer_event_, nullptr))
+    NOTREACHED();
+}
+
+void MessagePumpLibevent::SetHighResolutionTimer(TimeDelta delay) {
+  struct itimerspec spec = {};
+  spec.it_value.tv_sec = delay.InSeconds();
+  spec.it_value.tv_nsec =
+      (delay.InMicroseconds() % Time::kMicrosecondsPerSecond) *
+      Time::kNanosecondsPerMicrosecond;
+  if (timerfd_settime(high_res_timer_fd_, 0, &spec, nullptr))
+    DPLOG(ERROR) << "timerfd_settime";
+}
+
+// static
+void MessagePumpLibevent::OnHighResolutionTimer(int fd,
+                                                short flags,
+                                                void* context) {
+  MessagePumpLibevent* that = static_cast<MessagePumpLibevent*>(context);
+  DCHECK_EQ(that->high_res_timer_fd_, fd);
+
+  // Read the expiration count, or fail with EAGAIN if the timer was disarmed
+  // after it expired.
+  uint64_t expirations;
+  ignore_result(HANDLE_EINTR(read(fd, &expirations, sizeof(expirations))));
+  event_base_loopbreak(that->event_base_);
+}
+#endif
+
 bool MessagePumpLibevent::Init() {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // An eventfd takes one file descriptor and no pipe buffer, and wakeups
+  // written to it add up instead of queuing.
+  wakeup_pipe_out_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wakeup_pipe_out_ < 0) {
+    DPLOG(ERROR) << "eventfd creation failed";
+    return false;
+  }
+  wakeup_pipe_in_ = wakeup_pipe_out_;
+#else
   int fds[2];
   if (!CreateLocalNonBlockingPipe(fds)) {
     DPLOG(ERROR) << "pipe creation failed";
@@ -289,6 +376,7 @@ bool MessagePumpLibevent::Init() {
   }
   wakeup_pipe_out_ = fds[0];
   wakeup_pipe_in_ = fds[1];
+#endif
 
   wakeup_event_ = new event;
   event_set(wakeup_event_, wakeup_pipe_out_, EV_READ | EV_PERSIST,
@@ -338,10 +426,19 @@ void MessagePumpLibevent::OnWakeup(int socket, short flags, void* context) {
   MessagePumpLibevent* that = static_cast<MessagePumpLibevent*>(context);
   DCHECK(that->wakeup_pipe_out_ == socket);
 
-  // Remove and discard the wakeup byte.
+  // Remove and discard the wakeup count or byte.
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  uint64_t buf;
+#else
   char buf;
-  int nread = HANDLE_EINTR(read(socket, &buf, 1));
-  DCHECK_EQ(nread, 1);
+#endif
+  int nread = HANDLE_EINTR(read(socket, &buf, sizeof(buf)));
+  DCHECK_EQ(nread, static_cast<int>(sizeof(buf)));
+  // Only clear the pending wakeup once the pipe is drained, or this read could
+  // discard a wakeup written in between and leave it set with nothing to read.
+  // The work of the ScheduleWork() calls skipped until now is done by Run()
+  // right after this, and the exchange makes it visible.
+  that->wakeup_pending_.exchange(false, std::memory_order_acq_rel);
   that->processed_io_events_ = true;
   // Tell libevent to break out of inner loop.
   event_base_loopbreak(that->event_base_);
@@ -5,6 +5,7 @@
 #ifndef BASE_MESSAGE_LOOP_MESSAGE_PUMP_LIBEVENT_H_
 #define BASE_MESSAGE_LOOP_MESSAGE_PUMP_LIBEVENT_H_
 
+#include <atomic>
 #include <memory>
 
 #include "base/compiler_specific.h"
@@ -13,6 +14,7 @@
 #include "base/message_loop/watchable_io_message_pump_posix.h"
 #include "base/threading/thread_checker.h"
 #include "base/time/time.h"
+#include "build/build_config.h"
 
 // Declare structs we need from libevent.h rather than including it
 struct event_base;
@@ -77,6 +79,9 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump,
   void Quit() override;
   void ScheduleWork() override;
   void ScheduleDelayedWork(const TimeTicks& delayed_work_time) override;
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  void SetTimerSlack(TimerSlack timer_slack) override;
+#endif
 
  private:
   friend class MessagePumpLibeventTest;
@@ -87,10 +92,19 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump,
   // Called by libevent to tell us a registered FD can be read/written to.
   static void OnLibeventNotification(int fd, short flags, void* context);
 
-  // Unix pipe used to implement ScheduleWork()
+  // Unix pipe, or eventfd on Linux, used to implement ScheduleWork()
   // ... callback; called by libevent inside Run() when pipe is ready to read
   static void OnWakeup(int socket, short flags, void* context);
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // Arms |high_res_timer_fd_| to expire after |delay|, or disarms it if
+  // |delay| is zero.
+  void SetHighResolutionTimer(TimeDelta delay);
+
+  // Called by libevent when |high_res_timer_fd_| expires.
+  static void OnHighResolutionTimer(int fd, short flags, void* context);
+#endif
+
   // This flag is set to false when Run should return.
   bool keep_running_;
 
@@ -107,12 +121,24 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump,
   // readiness callbacks when a socket is ready for I/O.
   event_base* event_base_;
 
-  // ... write end; ScheduleWork() writes a single byte to it
+  // ... write end; ScheduleWork() writes a single byte to it, or increments
+  // the eventfd
   int wakeup_pipe_in_;
-  // ... read end; OnWakeup reads it and then breaks Run() out of its sleep
+  // ... read end; OnWakeup reads it and then breaks Run() out of its sleep.
+  // The same eventfd as |wakeup_pipe_in_| on Linux.
   int wakeup_pipe_out_;
   // ... libevent wrapper for read end
   event* wakeup_event_;
+  // ... set by ScheduleWork() until OnWakeup() drains the pipe, so that a
+  // burst of ScheduleWork() calls from other threads writes to it once.
+  std::atomic<bool> wakeup_pending_{false};
+
+  // A timerfd used instead of the libevent timeouts to wake up for delayed
+  // work with TIMER_SLACK_HIGH_RESOLUTION, since epoll_wait() rounds them up
+  // to the millisecond. -1 with other timer slacks.
+  int high_res_timer_fd_ = -1;
+  // ... libevent wrapper for it
+  event* high_res_timer_event_ = nullptr;
 
   ThreadChecker watch_file_descriptor_caller_checker_;
   DISALLOW_COPY_AND_ASSIGN(MessagePumpLibevent);
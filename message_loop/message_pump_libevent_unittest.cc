@@ -27,6 +27,10 @@
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <sys/prctl.h>
+#endif
+
 namespace base {
 
 class MessagePumpLibeventTest : public testing::Test {
@@ -258,6 +262,37 @@ TEST_F(MessagePumpLibeventTest, QuitWatcher) {
                                             Owned(watcher.release())));
 }
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+TEST_F(MessagePumpLibeventTest, HighResolutionTimerSlack) {
+  Thread thread("HighResolutionTimerSlackThread");
+  Thread::Options options(MessageLoop::TYPE_IO, 0);
+  options.timer_slack = TIMER_SLACK_HIGH_RESOLUTION;
+  ASSERT_TRUE(thread.StartWithOptions(options));
+
+  // The delayed task is woken up by the timerfd, with the slack set for the
+  // thread.
+  const TimeDelta kDelay = TimeDelta::FromMicroseconds(500);
+  WaitableEvent event(WaitableEvent::ResetPolicy::AUTOMATIC,
+                      WaitableEvent::InitialState::NOT_SIGNALED);
+  int timer_slack_ns = -1;
+  TimeTicks run_time;
+  TimeTicks post_time = TimeTicks::Now();
+  thread.task_runner()->PostDelayedTask(
+      FROM_HERE,
+      BindOnce(
+          [](int* timer_slack_ns, TimeTicks* run_time, WaitableEvent* event) {
+            *timer_slack_ns = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+            *run_time = TimeTicks::Now();
+            event->Signal();
+          },
+          &timer_slack_ns, &run_time, &event),
+      kDelay);
+  event.Wait();
+  EXPECT_EQ(1, timer_slack_ns);
+  EXPECT_GE(run_time - post_time, kDelay);
+}
+#endif  // defined(OS_LINUX) || defined(OS_ANDROID)
+
 }  // namespace
 
 }  // namespace base
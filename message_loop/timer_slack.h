@@ -10,11 +10,19 @@ namespace base {
 // Amount of timer slack to use for delayed timers.  Increasing timer slack
 // allows the OS to coalesce timers more effectively.
 enum TimerSlack {
-  // Lowest value for timer slack allowed by OS.
+  // Lowest value for timer slack allowed by OS for normal threads, i.e. the
+  // default one.
   TIMER_SLACK_NONE,
 
   // Maximal value for timer slack allowed by OS.
-  TIMER_SLACK_MAXIMUM
+  TIMER_SLACK_MAXIMUM,
+
+  // As little timer slack as possible, for latency-critical threads, at the
+  // cost of more wakeups. On Linux, the delayed work of such threads is run
+  // within microseconds of its time rather than within the default 50us, and
+  // MessagePumpLibevent doesn't round its timeouts up to the millisecond.
+  // MessagePumpDefault also polls for work briefly before going to sleep.
+  TIMER_SLACK_HIGH_RESOLUTION
 };
 
 }  // namespace base
@@ -5,7 +5,9 @@
 #include "base/metrics/bucket_ranges.h"
 
 #include <cmath>
+#include <limits>
 
+#include "base/bits.h"
 #include "base/logging.h"
 
 namespace base {
@@ -86,6 +88,30 @@ static uint32_t Crc32(uint32_t sum, HistogramBase::Sample value) {
   return sum;
 }
 
+namespace {
+
+// Buckets of fewer ranges are found as fast by a binary search.
+constexpr size_t kMinBucketsForIndex = 8;
+
+// Returns the slot of |value| in the index of BucketRanges: its position in a
+// power of two range, split in four.
+size_t GetIndexSlot(HistogramBase::Sample value) {
+  const uint32_t bits =
+      32 - bits::CountLeadingZeroBits(static_cast<uint32_t>(value));
+  if (bits < 3)
+    return value;
+  return (bits - 2) * 4 + ((value >> (bits - 3)) & 3);
+}
+
+// Returns the smallest value of |slot|.
+HistogramBase::Sample GetIndexSlotMinimum(size_t slot) {
+  if (slot < 4)
+    return slot;
+  return (4 + slot % 4) << (slot / 4 - 1);
+}
+
+}  // namespace
+
 BucketRanges::BucketRanges(size_t num_ranges)
     : ranges_(num_ranges, 0),
       checksum_(0) {}
@@ -107,6 +133,61 @@ bool BucketRanges::HasValidChecksum() const {
 
 void BucketRanges::ResetChecksum() {
   checksum_ = CalculateChecksum();
+  BuildBucketIndex();
+}
+
+void BucketRanges::SetKnownChecksum(uint32_t checksum) {
+  checksum_ = checksum;
+  DCHECK(HasValidChecksum());
+  BuildBucketIndex();
+}
+
+void BucketRanges::BuildBucketIndex() {
+  bucket_index_.clear();
+  const size_t buckets = bucket_count();
+  if (buckets < kMinBucketsForIndex ||
+      buckets > std::numeric_limits<uint16_t>::max()) {
+    return;
+  }
+  // The samples past the last slot overlapping more than the last bucket all
+  // fall in it.
+  const size_t slots = GetIndexSlot(ranges_[buckets - 1]) + 1;
+  bucket_index_.resize(slots + 1);
+  size_t bucket = 0;
+  for (size_t slot = 0; slot < slots; ++slot) {
+    const HistogramBase::Sample minimum = GetIndexSlotMinimum(slot);
+    while (bucket + 1 < buckets && ranges_[bucket + 1] <= minimum)
+      ++bucket;
+    bucket_index_[slot] = bucket;
+  }
+  bucket_index_[slots] = buckets - 1;
+}
+
+size_t BucketRanges::GetBucketIndex(HistogramBase::Sample value) const {
+  size_t under;
+  size_t over;
+  if (!bucket_index_.empty()) {
+    const size_t slot = GetIndexSlot(value);
+    if (slot + 1 >= bucket_index_.size())
+      return bucket_index_.back();
+    // The bucket of |value| is between the first buckets overlapping its slot
+    // and the next slot.
+    under = bucket_index_[slot];
+    over = bucket_index_[slot + 1] + 1;
+  } else {
+    under = 0;
+    over = bucket_count();
+  }
+
+  // Finds the last bucket in [under, over) whose range is <= |value|.
+  while (over - under > 1) {
+    const size_t mid = under + (over - under) / 2;
+    if (ranges_[mid] <= value)
+      under = mid;
+    else
+      over = mid;
+  }
+  return under;
 }
 
 bool BucketRanges::Equals(const BucketRanges* other) const {
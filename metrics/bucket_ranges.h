@@ -44,6 +44,7 @@ class BASE_EXPORT BucketRanges {
     DCHECK_LT(i, ranges_.size());
     DCHECK_GE(value, 0);
     ranges_[i] = value;
+    bucket_index_.clear();
   }
   uint32_t checksum() const { return checksum_; }
   void set_checksum(uint32_t checksum) { checksum_ = checksum; }
@@ -54,12 +55,21 @@ class BASE_EXPORT BucketRanges {
   // [0, 1), [1, 3), [3, 7), and [7, INT_MAX).
   size_t bucket_count() const { return ranges_.size() - 1; }
 
+  // Returns the index of the bucket which |value| falls into, which must be in
+  // [range(0), range(bucket_count())).
+  size_t GetBucketIndex(HistogramBase::Sample value) const;
+
   // Checksum methods to verify whether the ranges are corrupted (e.g. bad
-  // memory access).
+  // memory access). ResetChecksum() is called once the ranges are set, so it
+  // also builds the index which speeds up GetBucketIndex().
   uint32_t CalculateChecksum() const;
   bool HasValidChecksum() const;
   void ResetChecksum();
 
+  // Like ResetChecksum(), for ranges copied from a trusted source which also
+  // provides their |checksum|, so that it isn't computed again.
+  void SetKnownChecksum(uint32_t checksum);
+
   // Return true iff |other| object has same ranges_ as |this| object's ranges_.
   bool Equals(const BucketRanges* other) const;
 
@@ -75,11 +85,21 @@ class BASE_EXPORT BucketRanges {
   }
 
  private:
+  // Builds |bucket_index_| for the current ranges.
+  void BuildBucketIndex();
+
   // A monotonically increasing list of values which determine which bucket to
   // put a sample into.  For each index, show the smallest sample that can be
   // added to the corresponding bucket.
   Ranges ranges_;
 
+  // Splits the samples in slots, four per power of two, and maps each slot to
+  // the first bucket overlapping it, followed by the last bucket. The buckets
+  // of exponential histograms grow by a similar ratio, so most slots overlap
+  // one or two buckets, and GetBucketIndex() is about one comparison rather
+  // than a binary search over all of them. Empty until ResetChecksum().
+  std::vector<uint16_t> bucket_index_;
+
   // Checksum for the conntents of ranges_.  Used to detect random over-writes
   // of our data, and to quickly see if some other BucketRanges instance is
   // possibly Equal() to this instance.
@@ -0,0 +1,163 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/bucket_ranges_pool.h"
+
+#include <stddef.h>
+
+#include <utility>
+
+#include "base/atomicops.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/metrics/bucket_ranges.h"
+#include "base/metrics/histogram.h"
+#include "base/metrics/statistics_recorder.h"
+
+namespace base {
+
+namespace {
+
+// The global pool. This is a leaky singleton, like the global histogram
+// allocator.
+subtle::AtomicWord g_bucket_ranges_pool = 0;
+
+}  // namespace
+
+// The ranges of histograms with given arguments.
+struct BucketRangesPool::RangesRecord {
+  // SHA1(BucketRangesRecord): Increment this if structure changes!
+  static constexpr uint32_t kPersistentTypeId = 0x6B1D9A43 + 1;
+
+  // Expected size for 32/64-bit check.
+  static constexpr size_t kExpectedInstanceSize = 24;
+
+  // Returns the size of a record with |count| ranges.
+  static size_t GetAllocSize(size_t count) {
+    return offsetof(RangesRecord, ranges) + count * sizeof(int32_t);
+  }
+
+  int32_t histogram_type;
+  int32_t minimum;
+  int32_t maximum;
+  uint32_t bucket_count;
+  uint32_t ranges_checksum;
+
+  // The |bucket_count| + 1 ranges. Space for them is added during the actual
+  // allocation request. This must be the last field of the structure.
+  int32_t ranges[1];
+};
+
+BucketRangesPool::BucketRangesPool(
+    std::unique_ptr<PersistentMemoryAllocator> memory_allocator)
+    : memory_allocator_(std::move(memory_allocator)),
+      records_iterator_(memory_allocator_.get()) {}
+
+BucketRangesPool::~BucketRangesPool() = default;
+
+// static
+void BucketRangesPool::Set(std::unique_ptr<BucketRangesPool> pool) {
+  CHECK(!subtle::NoBarrier_Load(&g_bucket_ranges_pool));
+  subtle::Release_Store(&g_bucket_ranges_pool,
+                        reinterpret_cast<uintptr_t>(pool.release()));
+}
+
+// static
+BucketRangesPool* BucketRangesPool::Get() {
+  return reinterpret_cast<BucketRangesPool*>(
+      subtle::Acquire_Load(&g_bucket_ranges_pool));
+}
+
+// static
+std::unique_ptr<BucketRangesPool> BucketRangesPool::ReleaseForTesting() {
+  BucketRangesPool* pool = Get();
+  subtle::Release_Store(&g_bucket_ranges_pool, 0);
+  return WrapUnique(pool);
+}
+
+const BucketRanges* BucketRangesPool::FindRanges(
+    HistogramType histogram_type,
+    HistogramBase::Sample minimum,
+    HistogramBase::Sample maximum,
+    uint32_t bucket_count) {
+  const Key key(histogram_type, minimum, maximum, bucket_count);
+  PersistentMemoryAllocator::Reference ref;
+  {
+    AutoLock auto_lock(lock_);
+    auto found = records_.find(key);
+    if (found == records_.end()) {
+      ImportRecordsLockRequired();
+      found = records_.find(key);
+      if (found == records_.end())
+        return nullptr;
+    }
+    ref = found->second;
+  }
+
+  // The records are never changed once iterable, and the key was read from
+  // them, but the memory may be shared with less trusted processes, so the
+  // ranges are validated as when importing histograms.
+  const RangesRecord* record =
+      memory_allocator_->GetAsObject<RangesRecord>(ref);
+  const size_t count = bucket_count + 1;
+  if (!record || memory_allocator_->GetAllocSize(ref) <
+                     RangesRecord::GetAllocSize(count)) {
+    return nullptr;
+  }
+  // To avoid racy destruction at shutdown, the following may be leaked.
+  std::unique_ptr<BucketRanges> ranges(new BucketRanges(count));
+  for (size_t i = 0; i < count; ++i) {
+    const HistogramBase::Sample value = record->ranges[i];
+    if (value < 0 || (i > 0 && value <= ranges->range(i - 1)))
+      return nullptr;
+    ranges->set_range(i, value);
+  }
+  if (ranges->range(1) != minimum || ranges->range(count - 2) != maximum)
+    return nullptr;
+  ranges->SetKnownChecksum(record->ranges_checksum);
+  return StatisticsRecorder::RegisterOrDeleteDuplicateRanges(ranges.release());
+}
+
+void BucketRangesPool::AddRanges(HistogramType histogram_type,
+                                 HistogramBase::Sample minimum,
+                                 HistogramBase::Sample maximum,
+                                 uint32_t bucket_count,
+                                 const BucketRanges& ranges) {
+  DCHECK_EQ(bucket_count + 1, ranges.size());
+  if (memory_allocator_->IsReadonly())
+    return;
+
+  const Key key(histogram_type, minimum, maximum, bucket_count);
+  AutoLock auto_lock(lock_);
+  ImportRecordsLockRequired();
+  if (records_.count(key))
+    return;
+
+  RangesRecord* record = memory_allocator_->New<RangesRecord>(
+      RangesRecord::GetAllocSize(ranges.size()));
+  if (!record)
+    return;
+  record->histogram_type = histogram_type;
+  record->minimum = minimum;
+  record->maximum = maximum;
+  record->bucket_count = bucket_count;
+  record->ranges_checksum = ranges.checksum();
+  for (size_t i = 0; i < ranges.size(); ++i)
+    record->ranges[i] = ranges.range(i);
+  // The record will be found by the iterator, but can be used right away.
+  memory_allocator_->MakeIterable(record);
+  records_.emplace(key, memory_allocator_->GetAsReference(record));
+}
+
+void BucketRangesPool::ImportRecordsLockRequired() {
+  lock_.AssertAcquired();
+  while (const RangesRecord* record =
+             records_iterator_.GetNextOfObject<RangesRecord>()) {
+    records_.emplace(Key(record->histogram_type, record->minimum,
+                         record->maximum, record->bucket_count),
+                     memory_allocator_->GetAsReference(record));
+  }
+}
+
+}  // namespace base
@@ -0,0 +1,94 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_METRICS_BUCKET_RANGES_POOL_H_
+#define BASE_METRICS_BUCKET_RANGES_POOL_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <tuple>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/metrics/histogram_base.h"
+#include "base/metrics/persistent_memory_allocator.h"
+#include "base/synchronization/lock.h"
+
+namespace base {
+
+class BucketRanges;
+
+// BucketRangesPool keeps the BucketRanges of histograms in persistent memory,
+// keyed by the type and construction arguments of the histograms, which
+// determine them. A process which starts many children records there the
+// ranges of the histograms it creates, and shares the memory read-only with
+// its children, e.g. with a SharedPersistentMemoryAllocator on a read-only
+// handle: when they create histograms with the same arguments, they copy the
+// ranges and their checksums from the pool instead of computing them.
+//
+// Only histograms whose ranges follow from their arguments use the pool, not
+// custom histograms. All the methods are thread-safe.
+class BASE_EXPORT BucketRangesPool {
+ public:
+  // Creates a pool in |allocator|, which already holds the records of the
+  // pool it was created with, if any. The pool only records ranges if the
+  // allocator isn't read-only.
+  explicit BucketRangesPool(
+      std::unique_ptr<PersistentMemoryAllocator> allocator);
+  ~BucketRangesPool();
+
+  // Sets the pool used when creating histograms. Like the global histogram
+  // allocator, it can't be changed once set, except in tests.
+  static void Set(std::unique_ptr<BucketRangesPool> pool);
+  static BucketRangesPool* Get();
+  static std::unique_ptr<BucketRangesPool> ReleaseForTesting();
+
+  // Returns the ranges recorded for histograms of type |histogram_type| with
+  // the arguments |minimum|, |maximum| and |bucket_count|, registered with
+  // the StatisticsRecorder, or null if there are none.
+  const BucketRanges* FindRanges(HistogramType histogram_type,
+                                 HistogramBase::Sample minimum,
+                                 HistogramBase::Sample maximum,
+                                 uint32_t bucket_count);
+
+  // Records |ranges| for histograms of type |histogram_type| with the
+  // arguments |minimum|, |maximum| and |bucket_count|, unless the pool is
+  // read-only or has ranges for them already.
+  void AddRanges(HistogramType histogram_type,
+                 HistogramBase::Sample minimum,
+                 HistogramBase::Sample maximum,
+                 uint32_t bucket_count,
+                 const BucketRanges& ranges);
+
+  const PersistentMemoryAllocator* memory_allocator() const {
+    return memory_allocator_.get();
+  }
+
+ private:
+  struct RangesRecord;
+
+  // The histogram type, minimum, maximum and bucket count.
+  using Key = std::tuple<int32_t, int32_t, int32_t, uint32_t>;
+
+  // Indexes the records made iterable since the last call.
+  void ImportRecordsLockRequired();
+
+  const std::unique_ptr<PersistentMemoryAllocator> memory_allocator_;
+
+  Lock lock_;
+
+  // Iterates over the records, which other processes may add to.
+  PersistentMemoryAllocator::Iterator records_iterator_;
+
+  // The records found so far.
+  std::map<Key, PersistentMemoryAllocator::Reference> records_;
+
+  DISALLOW_COPY_AND_ASSIGN(BucketRangesPool);
+};
+
+}  // namespace base
+
+#endif  // BASE_METRICS_BUCKET_RANGES_POOL_H_
@@ -0,0 +1,115 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/bucket_ranges_pool.h"
+
+#include <memory>
+
+#include "base/metrics/bucket_ranges.h"
+#include "base/metrics/histogram.h"
+#include "base/metrics/statistics_recorder.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kAllocatorMemorySize = 64 << 10;
+
+// Returns a read-only allocator over the memory of |allocator|, as a child
+// process would have.
+std::unique_ptr<PersistentMemoryAllocator> CreateReadOnlyAllocator(
+    const PersistentMemoryAllocator& allocator) {
+  return std::make_unique<PersistentMemoryAllocator>(
+      const_cast<void*>(allocator.data()), allocator.size(), 0, 0, "",
+      /*readonly=*/true);
+}
+
+}  // namespace
+
+class BucketRangesPoolTest : public testing::Test {
+ protected:
+  BucketRangesPoolTest()
+      : statistics_recorder_(StatisticsRecorder::CreateTemporaryForTesting()),
+        pool_(std::make_unique<LocalPersistentMemoryAllocator>(
+            kAllocatorMemorySize, 0, "")) {}
+
+  std::unique_ptr<StatisticsRecorder> statistics_recorder_;
+  BucketRangesPool pool_;
+};
+
+TEST_F(BucketRangesPoolTest, AddAndFind) {
+  BucketRanges ranges(11);
+  Histogram::InitializeBucketRanges(1, 100, &ranges);
+  EXPECT_FALSE(pool_.FindRanges(HISTOGRAM, 1, 100, 10));
+  pool_.AddRanges(HISTOGRAM, 1, 100, 10, ranges);
+
+  BucketRangesPool child_pool(
+      CreateReadOnlyAllocator(*pool_.memory_allocator()));
+  for (BucketRangesPool* pool : {&pool_, &child_pool}) {
+    const BucketRanges* found = pool->FindRanges(HISTOGRAM, 1, 100, 10);
+    ASSERT_TRUE(found);
+    EXPECT_TRUE(found->Equals(&ranges));
+    EXPECT_TRUE(found->HasValidChecksum());
+    EXPECT_EQ(5u, found->GetBucketIndex(ranges.range(5)));
+
+    // The other arguments and types don't match.
+    EXPECT_FALSE(pool->FindRanges(LINEAR_HISTOGRAM, 1, 100, 10));
+    EXPECT_FALSE(pool->FindRanges(HISTOGRAM, 1, 100, 11));
+  }
+
+  // Ranges added later are found too.
+  BucketRanges linear_ranges(11);
+  LinearHistogram::InitializeBucketRanges(1, 100, &linear_ranges);
+  pool_.AddRanges(LINEAR_HISTOGRAM, 1, 100, 10, linear_ranges);
+  const BucketRanges* found =
+      child_pool.FindRanges(LINEAR_HISTOGRAM, 1, 100, 10);
+  ASSERT_TRUE(found);
+  EXPECT_TRUE(found->Equals(&linear_ranges));
+
+  // Read-only pools don't record ranges.
+  child_pool.AddRanges(HISTOGRAM, 1, 1000, 10, ranges);
+  EXPECT_FALSE(pool_.FindRanges(HISTOGRAM, 1, 1000, 10));
+}
+
+// Histograms use the ranges in the global pool rather than computing them,
+// and record those they compute.
+TEST_F(BucketRangesPoolTest, HistogramsUsePool) {
+  // Ranges which don't follow from their arguments, to tell whether they are
+  // used.
+  BucketRanges pooled_ranges(21);
+  Histogram::InitializeBucketRanges(1, 1000, &pooled_ranges);
+  pooled_ranges.set_range(18, pooled_ranges.range(18) + 1);
+  pooled_ranges.ResetChecksum();
+  pool_.AddRanges(HISTOGRAM, 1, 1000, 20, pooled_ranges);
+
+  BucketRangesPool::Set(std::make_unique<BucketRangesPool>(
+      CreateReadOnlyAllocator(*pool_.memory_allocator())));
+  HistogramBase* histogram = Histogram::FactoryGet("Test.Pooled", 1, 1000, 20,
+                                                   HistogramBase::kNoFlags);
+  EXPECT_TRUE(static_cast<Histogram*>(histogram)->bucket_ranges()->Equals(
+      &pooled_ranges));
+
+  // The child pool is read-only, so the ranges of other histograms are
+  // computed, and not recorded.
+  histogram = Histogram::FactoryGet("Test.Computed", 1, 100, 20,
+                                    HistogramBase::kNoFlags);
+  BucketRanges computed_ranges(21);
+  Histogram::InitializeBucketRanges(1, 100, &computed_ranges);
+  EXPECT_TRUE(static_cast<Histogram*>(histogram)->bucket_ranges()->Equals(
+      &computed_ranges));
+  EXPECT_FALSE(BucketRangesPool::Get()->FindRanges(HISTOGRAM, 1, 100, 20));
+  BucketRangesPool::ReleaseForTesting();
+
+  // Writable pools record them.
+  BucketRangesPool::Set(std::make_unique<BucketRangesPool>(
+      std::make_unique<LocalPersistentMemoryAllocator>(kAllocatorMemorySize, 0,
+                                                       "")));
+  Histogram::FactoryGet("Test.Recorded", 1, 10000, 20,
+                        HistogramBase::kNoFlags);
+  EXPECT_TRUE(BucketRangesPool::Get()->FindRanges(HISTOGRAM, 1, 10000, 20));
+  BucketRangesPool::ReleaseForTesting();
+}
+
+}  // namespace base
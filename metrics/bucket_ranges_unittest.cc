@@ -6,11 +6,43 @@
 
 #include <stdint.h>
 
+#include <vector>
+
+#include "base/metrics/histogram.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
 namespace {
 
+// Checks GetBucketIndex() against a linear search, for the values next to
+// each range and a sweep of values in between.
+void ExpectBucketIndicesMatchLinearSearch(const BucketRanges& ranges) {
+  auto linear_search = [&ranges](HistogramBase::Sample value) {
+    size_t index = 0;
+    while (ranges.range(index + 1) <= value)
+      ++index;
+    return index;
+  };
+  std::vector<HistogramBase::Sample> values;
+  for (size_t i = 0; i < ranges.bucket_count(); ++i) {
+    values.push_back(ranges.range(i));
+    if (ranges.range(i) > 0)
+      values.push_back(ranges.range(i) - 1);
+    values.push_back(ranges.range(i) + 1);
+  }
+  for (HistogramBase::Sample value = 0; value < 100000; value += 7)
+    values.push_back(value);
+  values.push_back(HistogramBase::kSampleType_MAX - 1);
+  for (HistogramBase::Sample value : values) {
+    if (value < ranges.range(0) ||
+        value >= ranges.range(ranges.bucket_count())) {
+      continue;
+    }
+    EXPECT_EQ(linear_search(value), ranges.GetBucketIndex(value))
+        << "value " << value;
+  }
+}
+
 TEST(BucketRangesTest, NormalSetup) {
   BucketRanges ranges(5);
   ASSERT_EQ(5u, ranges.size());
@@ -25,6 +57,37 @@ TEST(BucketRangesTest, NormalSetup) {
   EXPECT_EQ(100, ranges.range(3));
 }
 
+TEST(BucketRangesTest, GetBucketIndex) {
+  // Few buckets, without an index.
+  BucketRanges small_ranges(4);
+  small_ranges.set_range(1, 5);
+  small_ranges.set_range(2, 10);
+  small_ranges.set_range(3, HistogramBase::kSampleType_MAX);
+  small_ranges.ResetChecksum();
+  ExpectBucketIndicesMatchLinearSearch(small_ranges);
+
+  BucketRanges exponential_ranges(51);
+  Histogram::InitializeBucketRanges(1, 1000000, &exponential_ranges);
+  ExpectBucketIndicesMatchLinearSearch(exponential_ranges);
+
+  BucketRanges linear_ranges(102);
+  LinearHistogram::InitializeBucketRanges(1, 1000, &linear_ranges);
+  ExpectBucketIndicesMatchLinearSearch(linear_ranges);
+
+  BucketRanges custom_ranges(12);
+  for (size_t i = 1; i < 11; ++i)
+    custom_ranges.set_range(i, static_cast<HistogramBase::Sample>(i * i * 3));
+  custom_ranges.set_range(11, HistogramBase::kSampleType_MAX);
+  custom_ranges.ResetChecksum();
+  ExpectBucketIndicesMatchLinearSearch(custom_ranges);
+
+  // Changing a range drops the index until the next ResetChecksum().
+  custom_ranges.set_range(10, 301);
+  ExpectBucketIndicesMatchLinearSearch(custom_ranges);
+  custom_ranges.ResetChecksum();
+  ExpectBucketIndicesMatchLinearSearch(custom_ranges);
+}
+
 TEST(BucketRangesTest, Equals) {
   // Compare empty ranges.
   BucketRanges ranges1(3);
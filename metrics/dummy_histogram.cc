@@ -95,6 +95,10 @@ std::unique_ptr<HistogramSamples> DummyHistogram::SnapshotDelta() {
   return std::make_unique<DummyHistogramSamples>();
 }
 
+bool DummyHistogram::HasUnloggedSamples() const {
+  return false;
+}
+
 std::unique_ptr<HistogramSamples> DummyHistogram::SnapshotFinalDelta() const {
   return std::make_unique<DummyHistogramSamples>();
 }
@@ -35,6 +35,7 @@ class BASE_EXPORT DummyHistogram : public HistogramBase {
   bool AddSamplesFromPickle(PickleIterator* iter) override;
   std::unique_ptr<HistogramSamples> SnapshotSamples() const override;
   std::unique_ptr<HistogramSamples> SnapshotDelta() override;
+  bool HasUnloggedSamples() const override;
   std::unique_ptr<HistogramSamples> SnapshotFinalDelta() const override;
   void WriteHTMLGraph(std::string* output) const override {}
   void WriteAscii(std::string* output) const override {}
@@ -657,6 +657,7 @@ void FieldTrialList::AllStatesToString(std::string* output,
   if (!global_)
     return;
   AutoLock auto_lock(global_->lock_);
+  global_->PreLockedCreateAllSharedTrials();
 
   for (const auto& registered : global_->registered_) {
     FieldTrial::State trial;
@@ -1063,7 +1064,8 @@ size_t FieldTrialList::GetFieldTrialCount() {
   if (!global_)
     return 0;
   AutoLock auto_lock(global_->lock_);
-  return global_->registered_.size();
+  return global_->registered_.size() +
+         global_->uncreated_shared_trials_.size();
 }
 
 // static
@@ -1174,6 +1176,7 @@ void FieldTrialList::DumpAllFieldTrialsToPersistentAllocator(
   if (!global_)
     return;
   AutoLock auto_lock(global_->lock_);
+  global_->PreLockedCreateAllSharedTrials();
   for (const auto& registered : global_->registered_) {
     AddToAllocatorWhileLocked(allocator, registered.second);
   }
@@ -1347,18 +1350,25 @@ bool FieldTrialList::CreateTrialsFromSharedMemory(
     if (!entry->GetTrialAndGroupName(&trial_name, &group_name))
       return false;
 
+    // Most trials are never looked up in a given child process, so they are
+    // only created when they are, by PreLockedFind().
+    if (!subtle::NoBarrier_Load(&entry->activated)) {
+      AutoLock auto_lock(global_->lock_);
+      global_->uncreated_shared_trials_.emplace(trial_name,
+                                                mem_iter.GetAsReference(entry));
+      continue;
+    }
+
     // TODO(lawrencewu): Convert the API for CreateFieldTrial to take
     // StringPieces.
     FieldTrial* trial =
         CreateFieldTrial(trial_name.as_string(), group_name.as_string());
 
     trial->ref_ = mem_iter.GetAsReference(entry);
-    if (subtle::NoBarrier_Load(&entry->activated)) {
-      // Call |group()| to mark the trial as "used" and notify observers, if
-      // any. This is useful to ensure that field trials created in child
-      // processes are properly reported in crash reports.
-      trial->group();
-    }
+    // Call |group()| to mark the trial as "used" and notify observers, if
+    // any. This is useful to ensure that field trials created in child
+    // processes are properly reported in crash reports.
+    trial->group();
   }
   return true;
 }
@@ -1492,10 +1502,45 @@ const FieldTrial::EntropyProvider*
 FieldTrial* FieldTrialList::PreLockedFind(const std::string& name) {
   RegistrationMap::iterator it = registered_.find(name);
   if (registered_.end() == it)
-    return nullptr;
+    return PreLockedCreateSharedTrial(name);
   return it->second;
 }
 
+FieldTrial* FieldTrialList::PreLockedCreateSharedTrial(
+    const std::string& name) {
+  auto it = uncreated_shared_trials_.find(name);
+  if (uncreated_shared_trials_.end() == it)
+    return nullptr;
+  const FieldTrial::FieldTrialRef ref = it->second;
+  uncreated_shared_trials_.erase(it);
+
+  const FieldTrial::FieldTrialEntry* entry =
+      field_trial_allocator_->GetAsObject<FieldTrial::FieldTrialEntry>(ref);
+  StringPiece trial_name;
+  StringPiece group_name;
+  if (!entry || !entry->GetTrialAndGroupName(&trial_name, &group_name))
+    return nullptr;
+
+  // Same as CreateFieldTrial() and Register(), while already holding lock_.
+  const int kTotalProbability = 100;
+  FieldTrial* field_trial =
+      new FieldTrial(name, kTotalProbability, group_name.as_string(), 0);
+  field_trial->AddRef();
+  field_trial->SetTrialRegistered();
+  registered_[name] = field_trial;
+  field_trial->FinalizeGroupChoiceImpl(true);
+  field_trial->forced_ = true;
+  field_trial->ref_ = ref;
+  return field_trial;
+}
+
+void FieldTrialList::PreLockedCreateAllSharedTrials() {
+  while (!uncreated_shared_trials_.empty()) {
+    PreLockedCreateSharedTrial(
+        uncreated_shared_trials_.begin()->first.as_string());
+  }
+}
+
 // static
 void FieldTrialList::Register(FieldTrial* trial) {
   if (!global_) {
@@ -1514,6 +1559,7 @@ FieldTrialList::RegistrationMap FieldTrialList::GetRegisteredTrials() {
   RegistrationMap output;
   if (global_) {
     AutoLock auto_lock(global_->lock_);
+    global_->PreLockedCreateAllSharedTrials();
     output = global_->registered_;
   }
   return output;
@@ -674,6 +674,8 @@ class BASE_EXPORT FieldTrialList {
   // Allow tests to access our innards for testing purposes.
   FRIEND_TEST_ALL_PREFIXES(FieldTrialListTest, InstantiateAllocator);
   FRIEND_TEST_ALL_PREFIXES(FieldTrialListTest, AddTrialsToAllocator);
+  FRIEND_TEST_ALL_PREFIXES(FieldTrialListTest,
+                           CreateTrialsFromSharedMemoryLazily);
   FRIEND_TEST_ALL_PREFIXES(FieldTrialListTest,
                            DoNotAddSimulatedFieldTrialsToAllocator);
   FRIEND_TEST_ALL_PREFIXES(FieldTrialListTest, AssociateFieldTrialParams);
@@ -718,9 +720,10 @@ class BASE_EXPORT FieldTrialList {
 
   // Expects a mapped piece of shared memory |shm| that was created from the
   // browser process's field_trial_allocator and shared via the command line.
-  // This function recreates the allocator, iterates through all the field
-  // trials in it, and creates them via CreateFieldTrial(). Returns true if
-  // successful and false otherwise.
+  // This function recreates the allocator and iterates through all the field
+  // trials in it. The active ones are created via CreateFieldTrial(), so that
+  // observers learn about them, and the others only when they are first
+  // looked up. Returns true if successful and false otherwise.
   static bool CreateTrialsFromSharedMemory(
       std::unique_ptr<base::SharedMemory> shm);
 
@@ -748,6 +751,15 @@ class BASE_EXPORT FieldTrialList {
   // Helper function should be called only while holding lock_.
   FieldTrial* PreLockedFind(const std::string& name);
 
+  // Creates the trial named |name| from its entry in the read-only allocator of
+  // a child process, if it wasn't created yet, and returns it. Returns null if
+  // there is no such entry. Should be called only while holding lock_.
+  FieldTrial* PreLockedCreateSharedTrial(const std::string& name);
+
+  // Creates all the trials of the read-only allocator that weren't created yet.
+  // Should be called only while holding lock_.
+  void PreLockedCreateAllSharedTrials();
+
   // Register() stores a pointer to the given trial in a global map.
   // This method also AddRef's the indicated trial.
   // This should always be called after creating a new FieldTrial instance.
@@ -786,6 +798,10 @@ class BASE_EXPORT FieldTrialList {
   // to start passing more data other than field trials.
   std::unique_ptr<FieldTrialAllocator> field_trial_allocator_ = nullptr;
 
+  // Entries of the read-only allocator of a child process whose trials weren't
+  // created yet, by trial name, which points into the allocator.
+  std::map<StringPiece, FieldTrial::FieldTrialRef> uncreated_shared_trials_;
+
   // Readonly copy of the handle to the allocator. Needs to be a member variable
   // because it's needed from both CopyFieldTrialStateToFlags() and
   // AppendFieldTrialHandleIfNeeded().
@@ -1248,6 +1248,40 @@ TEST(FieldTrialListTest, AddTrialsToAllocator) {
   EXPECT_EQ(save_string, check_string);
 }
 
+TEST(FieldTrialListTest, CreateTrialsFromSharedMemoryLazily) {
+  SharedMemoryHandle handle;
+  {
+    test::ScopedFeatureList scoped_feature_list;
+    scoped_feature_list.Init();
+
+    FieldTrialList field_trial_list(nullptr);
+    FieldTrialList::CreateFieldTrial("Trial1", "Group1");
+    FieldTrialList::CreateFieldTrial("Trial2", "Group2")->group();
+    FieldTrialList::InstantiateFieldTrialAllocatorIfNeeded();
+    handle = SharedMemory::DuplicateHandle(
+        field_trial_list.field_trial_allocator_->shared_memory()->handle());
+  }
+
+  FieldTrialList field_trial_list2(nullptr);
+  std::unique_ptr<SharedMemory> shm(new SharedMemory(handle, true));
+  // 4 KiB is enough to hold the trials only created for this test.
+  shm.get()->Map(4 << 10);
+  FieldTrialList::CreateTrialsFromSharedMemory(std::move(shm));
+
+  // Only the active trial is created up front.
+  EXPECT_EQ(1u, field_trial_list2.registered_.size());
+  EXPECT_TRUE(FieldTrialList::IsTrialActive("Trial2"));
+  EXPECT_EQ(2u, FieldTrialList::GetFieldTrialCount());
+
+  // The other one is created, but not activated, when it's looked up.
+  EXPECT_FALSE(FieldTrialList::IsTrialActive("Trial1"));
+  EXPECT_EQ(2u, field_trial_list2.registered_.size());
+  EXPECT_EQ("Group1", FieldTrialList::FindFullName("Trial1"));
+  EXPECT_TRUE(FieldTrialList::IsTrialActive("Trial1"));
+  EXPECT_FALSE(FieldTrialList::TrialExists("Trial3"));
+  EXPECT_EQ(2u, FieldTrialList::GetFieldTrialCount());
+}
+
 TEST(FieldTrialListTest, DoNotAddSimulatedFieldTrialsToAllocator) {
   constexpr char kTrialName[] = "trial";
   SharedMemoryHandle handle;
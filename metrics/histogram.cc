@@ -12,15 +12,18 @@
 #include <inttypes.h>
 #include <limits.h>
 #include <math.h>
+#include <string.h>
 
 #include <algorithm>
 #include <string>
 #include <utility>
 
+#include "base/bits.h"
 #include "base/compiler_specific.h"
 #include "base/debug/alias.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
+#include "base/metrics/bucket_ranges_pool.h"
 #include "base/metrics/dummy_histogram.h"
 #include "base/metrics/histogram_functions.h"
 #include "base/metrics/metrics_hashes.h"
@@ -32,6 +35,7 @@
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/lock.h"
+#include "base/sys_info.h"
 #include "base/values.h"
 #include "build/build_config.h"
 
@@ -164,10 +168,24 @@ HistogramBase* Histogram::Factory::Build() {
         StatisticsRecorder::ShouldRecordHistogram(HashMetricName(name_));
     if (!should_record)
       return DummyHistogram::GetInstance();
-    // To avoid racy destruction at shutdown, the following will be leaked.
-    const BucketRanges* created_ranges = CreateRanges();
+    // Ranges which follow from the construction arguments may have been
+    // computed by another process already.
+    BucketRangesPool* ranges_pool =
+        bucket_count_ != 0 ? BucketRangesPool::Get() : nullptr;
     const BucketRanges* registered_ranges =
-        StatisticsRecorder::RegisterOrDeleteDuplicateRanges(created_ranges);
+        ranges_pool ? ranges_pool->FindRanges(histogram_type_, minimum_,
+                                              maximum_, bucket_count_)
+                    : nullptr;
+    if (!registered_ranges) {
+      // To avoid racy destruction at shutdown, the following will be leaked.
+      const BucketRanges* created_ranges = CreateRanges();
+      registered_ranges =
+          StatisticsRecorder::RegisterOrDeleteDuplicateRanges(created_ranges);
+      if (ranges_pool) {
+        ranges_pool->AddRanges(histogram_type_, minimum_, maximum_,
+                               bucket_count_, *registered_ranges);
+      }
+    }
 
     // In most cases, the bucket-count, minimum, and maximum values are known
     // when the code is written and so are passed in explicitly. In other
@@ -505,15 +523,28 @@ std::unique_ptr<HistogramSamples> Histogram::SnapshotDelta() {
   // a snapshot is captured. Note that this is why it's important to subtract
   // exactly the snapshotted unlogged samples, rather than simply resetting the
   // vector: this way, the next snapshot will include any concurrent updates
-  // missed by the current snapshot.
+  // missed by the current snapshot. Moving the counts out by exchanging each
+  // with zero does that in one pass; otherwise they're copied, then
+  // subtracted.
 
-  std::unique_ptr<HistogramSamples> snapshot = SnapshotUnloggedSamples();
-  unlogged_samples_->Subtract(*snapshot);
+  std::unique_ptr<SampleVector> snapshot(
+      new SampleVector(unlogged_samples_->id(), bucket_ranges()));
+  if (!unlogged_samples_->MoveSamplesTo(snapshot.get())) {
+    snapshot->Add(*unlogged_samples_);
+    unlogged_samples_->Subtract(*snapshot);
+  }
   logged_samples_->Add(*snapshot);
 
   return snapshot;
 }
 
+bool Histogram::HasUnloggedSamples() const {
+  // Every sample added to |unlogged_samples_| increments its count, including
+  // those of other processes for persistent histograms, and SnapshotDelta()
+  // subtracts exactly the samples it snapshots.
+  return unlogged_samples_->redundant_count() != 0;
+}
+
 std::unique_ptr<HistogramSamples> Histogram::SnapshotFinalDelta() const {
 #if DCHECK_IS_ON()
   DCHECK(!final_delta_created_);
@@ -788,6 +819,220 @@ void Histogram::GetCountAndBucketData(Count* count,
   }
 }
 
+//------------------------------------------------------------------------------
+// ShardedHistogram: This histogram spreads the samples added by different
+// threads over separate counters.
+//------------------------------------------------------------------------------
+
+namespace {
+
+// Shards are aligned to, and padded to, this many bytes so that no two of them
+// share a cache line.
+constexpr size_t kCacheLineSize = 64;
+
+// There is no point in having more shards than cores recording samples at the
+// same time. This limits the memory used by histograms with many buckets.
+constexpr size_t kMaxShards = 16;
+
+// A SampleVector filled from the shards of a ShardedHistogram, which hold the
+// exact sum of their samples and only the counts per bucket.
+class MergedShardSamples : public SampleVector {
+ public:
+  MergedShardSamples(uint64_t id, const BucketRanges* bucket_ranges)
+      : SampleVector(id, bucket_ranges) {}
+
+  // Accumulate() adds the samples with the value they are given, which is
+  // the minimum of their bucket here. Replaces that sum with the exact one.
+  void SetSum(int64_t sum) { IncreaseSumAndCount(sum - this->sum(), 0); }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MergedShardSamples);
+};
+
+}  // namespace
+
+class ShardedHistogram::Factory : public Histogram::Factory {
+ public:
+  Factory(const std::string& name,
+          HistogramBase::Sample minimum,
+          HistogramBase::Sample maximum,
+          uint32_t bucket_count,
+          int32_t flags)
+      : Histogram::Factory(name, minimum, maximum, bucket_count, flags) {}
+
+ protected:
+  std::unique_ptr<HistogramBase> HeapAlloc(
+      const BucketRanges* ranges) override {
+    return WrapUnique(new ShardedHistogram(GetPermanentName(name_), minimum_,
+                                           maximum_, ranges));
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(Factory);
+};
+
+ShardedHistogram::~ShardedHistogram() = default;
+
+// static
+HistogramBase* ShardedHistogram::FactoryGet(const std::string& name,
+                                            Sample minimum,
+                                            Sample maximum,
+                                            uint32_t bucket_count,
+                                            int32_t flags) {
+  bool valid_arguments =
+      InspectConstructionArguments(name, &minimum, &maximum, &bucket_count);
+  DCHECK(valid_arguments);
+
+  return Factory(name, minimum, maximum, bucket_count, flags).Build();
+}
+
+// static
+HistogramBase* ShardedHistogram::FactoryGet(const char* name,
+                                            Sample minimum,
+                                            Sample maximum,
+                                            uint32_t bucket_count,
+                                            int32_t flags) {
+  return FactoryGet(std::string(name), minimum, maximum, bucket_count, flags);
+}
+
+void ShardedHistogram::AddCount(Sample value, int count) {
+  DCHECK_EQ(0, ranges(0));
+  DCHECK_EQ(kSampleType_MAX, ranges(bucket_count()));
+
+  if (value > kSampleType_MAX - 1)
+    value = kSampleType_MAX - 1;
+  if (value < 0)
+    value = 0;
+  if (count <= 0) {
+    NOTREACHED();
+    return;
+  }
+  size_t shard = GetCurrentShard();
+  GetShardCounts(shard)[GetBucketIndex(value)].fetch_add(
+      count, std::memory_order_relaxed);
+  GetShardSum(shard)->fetch_add(strict_cast<int64_t>(count) * value,
+                                std::memory_order_relaxed);
+
+  FindAndRunCallback(value);
+}
+
+std::unique_ptr<HistogramSamples> ShardedHistogram::SnapshotSamples() const {
+  MergeShards();
+  return Histogram::SnapshotSamples();
+}
+
+std::unique_ptr<HistogramSamples> ShardedHistogram::SnapshotDelta() {
+  MergeShards();
+  return Histogram::SnapshotDelta();
+}
+
+bool ShardedHistogram::HasUnloggedSamples() const {
+  MergeShards();
+  return Histogram::HasUnloggedSamples();
+}
+
+std::unique_ptr<HistogramSamples> ShardedHistogram::SnapshotFinalDelta()
+    const {
+  MergeShards();
+  return Histogram::SnapshotFinalDelta();
+}
+
+void ShardedHistogram::WriteHTMLGraph(std::string* output) const {
+  MergeShards();
+  Histogram::WriteHTMLGraph(output);
+}
+
+void ShardedHistogram::WriteAscii(std::string* output) const {
+  MergeShards();
+  Histogram::WriteAscii(output);
+}
+
+ShardedHistogram::ShardedHistogram(const char* name,
+                                   Sample minimum,
+                                   Sample maximum,
+                                   const BucketRanges* ranges)
+    : Histogram(name, minimum, maximum, ranges),
+      num_shards_(std::min(
+          static_cast<size_t>(std::max(SysInfo::NumberOfProcessors(), 1)),
+          kMaxShards)),
+      shard_size_(bits::Align(sizeof(std::atomic<int64_t>) +
+                                  ranges->bucket_count() *
+                                      sizeof(std::atomic<Count>),
+                              kCacheLineSize)),
+      shards_(static_cast<char*>(
+          AlignedAlloc(num_shards_ * shard_size_, kCacheLineSize))) {
+  // The atomics are used in place, so they must be plain integers.
+  static_assert(sizeof(std::atomic<int64_t>) == sizeof(int64_t),
+                "std::atomic<int64_t> has extra state");
+  static_assert(sizeof(std::atomic<Count>) == sizeof(Count),
+                "std::atomic<Count> has extra state");
+  memset(shards_.get(), 0, num_shards_ * shard_size_);
+}
+
+void ShardedHistogram::GetCountAndBucketData(Count* count,
+                                             int64_t* sum,
+                                             ListValue* buckets) const {
+  MergeShards();
+  Histogram::GetCountAndBucketData(count, sum, buckets);
+}
+
+size_t ShardedHistogram::GetCurrentShard() const {
+  // Threads are told apart by the address of their stack, which is cheaper to
+  // get than a thread id and remains valid while a thread is torn down. Stacks
+  // are usually much larger than 64 KiB, and the hash spreads stacks allocated
+  // next to each other over the shards. Threads that end up sharing a shard
+  // are still counted correctly, only less efficiently.
+  int stack_marker;
+  uint64_t stack_chunk = reinterpret_cast<uintptr_t>(&stack_marker) >> 16;
+  return static_cast<size_t>(((stack_chunk * UINT64_C(0x9E3779B97F4A7C15)) >>
+                              32) %
+                             num_shards_);
+}
+
+size_t ShardedHistogram::GetBucketIndex(Sample value) const {
+  const BucketRanges* ranges = bucket_ranges();
+  const size_t bucket_index = ranges->GetBucketIndex(value);
+  DCHECK_LE(ranges->range(bucket_index), value);
+  DCHECK_GT(ranges->range(bucket_index + 1), value);
+  return bucket_index;
+}
+
+std::atomic<int64_t>* ShardedHistogram::GetShardSum(size_t shard) const {
+  DCHECK_LT(shard, num_shards_);
+  return reinterpret_cast<std::atomic<int64_t>*>(shards_.get() +
+                                                 shard * shard_size_);
+}
+
+std::atomic<Count>* ShardedHistogram::GetShardCounts(size_t shard) const {
+  return reinterpret_cast<std::atomic<Count>*>(GetShardSum(shard) + 1);
+}
+
+void ShardedHistogram::MergeShards() const {
+  // Like SnapshotDelta(), this only guarantees eventual consistency: samples
+  // added concurrently may have their count merged now and their value later,
+  // or the other way around. Every sample is merged exactly once.
+  MergedShardSamples samples(unlogged_samples()->id(), bucket_ranges());
+  int64_t sum = 0;
+  bool has_samples = false;
+  for (size_t shard = 0; shard < num_shards_; ++shard) {
+    std::atomic<int64_t>* shard_sum = GetShardSum(shard);
+    if (shard_sum->load(std::memory_order_relaxed) != 0)
+      sum += shard_sum->exchange(0, std::memory_order_relaxed);
+    std::atomic<Count>* counts = GetShardCounts(shard);
+    for (uint32_t i = 0; i < bucket_count(); ++i) {
+      if (counts[i].load(std::memory_order_relaxed) == 0)
+        continue;
+      samples.Accumulate(ranges(i),
+                         counts[i].exchange(0, std::memory_order_relaxed));
+      has_samples = true;
+    }
+  }
+  if (!has_samples && sum == 0)
+    return;
+  samples.SetSum(sum);
+  unlogged_samples()->Add(samples);
+}
+
 //------------------------------------------------------------------------------
 // LinearHistogram: This histogram uses a traditional set of evenly spaced
 // buckets.
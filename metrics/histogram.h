@@ -67,6 +67,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -77,6 +78,7 @@
 #include "base/gtest_prod_util.h"
 #include "base/logging.h"
 #include "base/macros.h"
+#include "base/memory/aligned_memory.h"
 #include "base/metrics/bucket_ranges.h"
 #include "base/metrics/histogram_base.h"
 #include "base/metrics/histogram_samples.h"
@@ -94,6 +96,7 @@ class Pickle;
 class PickleIterator;
 class SampleVector;
 class SampleVectorBase;
+class ShardedHistogram;
 
 class BASE_EXPORT Histogram : public HistogramBase {
  public:
@@ -202,6 +205,7 @@ class BASE_EXPORT Histogram : public HistogramBase {
   void AddCount(Sample value, int count) override;
   std::unique_ptr<HistogramSamples> SnapshotSamples() const override;
   std::unique_ptr<HistogramSamples> SnapshotDelta() override;
+  bool HasUnloggedSamples() const override;
   std::unique_ptr<HistogramSamples> SnapshotFinalDelta() const override;
   void AddSamples(const HistogramSamples& samples) override;
   bool AddSamplesFromPickle(base::PickleIterator* iter) override;
@@ -244,6 +248,9 @@ class BASE_EXPORT Histogram : public HistogramBase {
 
   // HistogramBase implementation:
   void SerializeInfoImpl(base::Pickle* pickle) const override;
+  void GetCountAndBucketData(Count* count,
+                             int64_t* sum,
+                             ListValue* buckets) const override;
 
   // Method to override to skip the display of the i'th bucket if it's empty.
   virtual bool PrintEmptyBucket(uint32_t index) const;
@@ -256,6 +263,10 @@ class BASE_EXPORT Histogram : public HistogramBase {
   // be a name (or string description) given to the bucket.
   virtual const std::string GetAsciiBucketRange(uint32_t it) const;
 
+  // Samples that have not yet been logged with SnapshotDelta(), for classes
+  // that record samples elsewhere before moving them here.
+  SampleVectorBase* unlogged_samples() const { return unlogged_samples_.get(); }
+
  private:
   // Allow tests to corrupt our innards for testing purposes.
   FRIEND_TEST_ALL_PREFIXES(HistogramTest, BoundsTest);
@@ -303,10 +314,6 @@ class BASE_EXPORT Histogram : public HistogramBase {
   // WriteJSON calls these.
   void GetParameters(DictionaryValue* params) const override;
 
-  void GetCountAndBucketData(Count* count,
-                             int64_t* sum,
-                             ListValue* buckets) const override;
-
   // Samples that have not yet been logged with SnapshotDelta().
   std::unique_ptr<SampleVectorBase> unlogged_samples_;
 
@@ -324,6 +331,92 @@ class BASE_EXPORT Histogram : public HistogramBase {
 
 //------------------------------------------------------------------------------
 
+// ShardedHistogram is an exponential Histogram for samples recorded from many
+// threads at a high rate. Adding a sample to a Histogram updates counters that
+// are shared by all threads, so the cache lines holding them bounce between
+// the cores recording samples. A ShardedHistogram instead spreads its samples
+// over several shards, each on its own cache lines, and picks the shard from
+// the calling thread. The shards are merged into the samples of the histogram
+// whenever those are read, e.g. by SnapshotDelta() when
+// StatisticsRecorder::PrepareDeltas() runs.
+//
+// Apart from the sharding, it behaves exactly like a Histogram with the same
+// construction arguments and is reported as one. Histograms allocated from
+// persistent memory are read directly by other processes, so when a
+// persistent allocator is in use, a plain Histogram is created instead.
+class BASE_EXPORT ShardedHistogram : public Histogram {
+ public:
+  ~ShardedHistogram() override;
+
+  // See Histogram::FactoryGet().
+  static HistogramBase* FactoryGet(const std::string& name,
+                                   Sample minimum,
+                                   Sample maximum,
+                                   uint32_t bucket_count,
+                                   int32_t flags);
+
+  // Overload of the above function that takes a const char* |name| param,
+  // to avoid code bloat from the std::string constructor being inlined into
+  // call sites.
+  static HistogramBase* FactoryGet(const char* name,
+                                   Sample minimum,
+                                   Sample maximum,
+                                   uint32_t bucket_count,
+                                   int32_t flags);
+
+  // HistogramBase implementation:
+  void AddCount(Sample value, int count) override;
+  std::unique_ptr<HistogramSamples> SnapshotSamples() const override;
+  std::unique_ptr<HistogramSamples> SnapshotDelta() override;
+  bool HasUnloggedSamples() const override;
+  std::unique_ptr<HistogramSamples> SnapshotFinalDelta() const override;
+  void WriteHTMLGraph(std::string* output) const override;
+  void WriteAscii(std::string* output) const override;
+
+  size_t num_shards() const { return num_shards_; }
+
+ protected:
+  class Factory;
+
+  ShardedHistogram(const char* name,
+                   Sample minimum,
+                   Sample maximum,
+                   const BucketRanges* ranges);
+
+ private:
+  // HistogramBase implementation:
+  void GetCountAndBucketData(Count* count,
+                             int64_t* sum,
+                             ListValue* buckets) const override;
+
+  // Returns the shard that the calling thread adds its samples to.
+  size_t GetCurrentShard() const;
+
+  // Returns the bucket that |value| is counted in.
+  size_t GetBucketIndex(Sample value) const;
+
+  // Returns the sum of the samples in |shard|, and their counts per bucket.
+  std::atomic<int64_t>* GetShardSum(size_t shard) const;
+  std::atomic<Count>* GetShardCounts(size_t shard) const;
+
+  // Moves the samples of all the shards to the unlogged samples. This doesn't
+  // change the contents of the histogram, only where they are held.
+  void MergeShards() const;
+
+  const size_t num_shards_;
+
+  // Size of a shard in bytes: the sum of its samples followed by their counts,
+  // padded to a whole number of cache lines.
+  const size_t shard_size_;
+
+  // The shards, one after the other.
+  std::unique_ptr<char, AlignedFreeDeleter> shards_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedHistogram);
+};
+
+//------------------------------------------------------------------------------
+
 // LinearHistogram is a more traditional histogram, with evenly spaced
 // buckets.
 class BASE_EXPORT LinearHistogram : public Histogram {
@@ -130,6 +130,10 @@ uint32_t HistogramBase::FindCorruption(const HistogramSamples& samples) const {
   return NO_INCONSISTENCIES;
 }
 
+bool HistogramBase::HasUnloggedSamples() const {
+  return true;
+}
+
 void HistogramBase::ValidateHistogramContents() const {}
 
 void HistogramBase::WriteJSON(std::string* output,
@@ -217,6 +217,12 @@ class BASE_EXPORT HistogramBase {
   // changed since the last call.
   virtual std::unique_ptr<HistogramSamples> SnapshotDelta() = 0;
 
+  // Returns whether samples may have been recorded since the previous call to
+  // SnapshotDelta(), without taking a snapshot. It never returns false when
+  // there are such samples, so that the snapshot of the histograms which
+  // haven't changed can be skipped. Returns true by default.
+  virtual bool HasUnloggedSamples() const;
+
   // Calculate the change (delta) in histogram counts since the previous call
   // to SnapshotDelta() but do so without modifying any internal data as to
   // what was previous logged. After such a call, no further calls to this
@@ -4,8 +4,13 @@
 
 #include "base/metrics/histogram_delta_serialization.h"
 
+#include <limits>
+#include <vector>
+
 #include "base/logging.h"
+#include "base/metrics/histogram.h"
 #include "base/metrics/histogram_base.h"
+#include "base/metrics/histogram_samples.h"
 #include "base/metrics/histogram_snapshot_manager.h"
 #include "base/metrics/statistics_recorder.h"
 #include "base/numerics/safe_conversions.h"
@@ -31,11 +36,148 @@ void DeserializeHistogramAndAddSamples(PickleIterator* iter) {
   histogram->AddSamplesFromPickle(iter);
 }
 
+// The compact deltas are a sequence of records, one per histogram:
+//   - the name hash of the histogram, as 8 little-endian bytes,
+//   - the size of the description of the histogram, as a varint, followed by
+//     the description as written by HistogramBase::SerializeInfo(), the first
+//     time the histogram is serialized. The size is 0 the following times,
+//   - the sum of the samples, as a zigzag varint,
+//   - the number of non-empty buckets, as a varint,
+//   - for each bucket, in order, its key minus that of the previous bucket (or
+//     0), as a zigzag varint, and its count as a zigzag varint. The key is
+//     the index of the bucket, or the sample for sparse histograms.
+//
+// The varints are those of protocol buffers: 7 bits per byte, least
+// significant first, with the high bit set on all bytes but the last.
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void AppendZigZagVarint(int64_t value, std::string* out) {
+  AppendVarint((static_cast<uint64_t>(value) << 1) ^
+                   static_cast<uint64_t>(value >> 63),
+               out);
+}
+
+void AppendFixed64(uint64_t value, std::string* out) {
+  for (int i = 0; i < 8; ++i)
+    out->push_back(static_cast<char>(value >> (8 * i)));
+}
+
+bool ReadVarint(StringPiece* in, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64 && !in->empty(); shift += 7) {
+    uint8_t byte = static_cast<uint8_t>(in->front());
+    in->remove_prefix(1);
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+bool ReadZigZagVarint(StringPiece* in, int64_t* value) {
+  uint64_t zigzag;
+  if (!ReadVarint(in, &zigzag))
+    return false;
+  *value =
+      static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+  return true;
+}
+
+bool ReadFixed64(StringPiece* in, uint64_t* value) {
+  if (in->size() < 8)
+    return false;
+  *value = 0;
+  for (int i = 0; i < 8; ++i)
+    *value |= static_cast<uint64_t>(static_cast<uint8_t>((*in)[i])) << (8 * i);
+  in->remove_prefix(8);
+  return true;
+}
+
+// Reads the buckets of a record into |pickle|, in the format of
+// HistogramSamples::Serialize(), for |histogram| which may be null if the
+// samples are dropped.
+bool ReadCompactSamples(StringPiece* in,
+                        const HistogramBase* histogram,
+                        Pickle* pickle) {
+  int64_t sum;
+  uint64_t num_buckets;
+  if (!ReadZigZagVarint(in, &sum) || !ReadVarint(in, &num_buckets))
+    return false;
+
+  const BucketRanges* ranges = nullptr;
+  if (histogram && histogram->GetHistogramType() != SPARSE_HISTOGRAM)
+    ranges = static_cast<const Histogram*>(histogram)->bucket_ranges();
+
+  struct Bucket {
+    HistogramBase::Sample min;
+    int64_t max;
+    HistogramBase::Count count;
+  };
+  std::vector<Bucket> buckets;
+  int64_t key = 0;
+  int64_t total_count = 0;
+  for (uint64_t i = 0; i < num_buckets; ++i) {
+    int64_t key_delta;
+    int64_t count;
+    if (!ReadZigZagVarint(in, &key_delta) || !ReadZigZagVarint(in, &count))
+      return false;
+    // Wrap around rather than overflow, the key is checked below.
+    key = static_cast<int64_t>(static_cast<uint64_t>(key) +
+                               static_cast<uint64_t>(key_delta));
+    if (count < std::numeric_limits<HistogramBase::Count>::min() ||
+        count > std::numeric_limits<HistogramBase::Count>::max()) {
+      return false;
+    }
+    total_count += count;
+    if (!histogram)
+      continue;
+
+    Bucket bucket;
+    bucket.count = static_cast<HistogramBase::Count>(count);
+    if (ranges) {
+      if (key < 0 || static_cast<uint64_t>(key) >= ranges->bucket_count())
+        return false;
+      bucket.min = ranges->range(static_cast<size_t>(key));
+      bucket.max = ranges->range(static_cast<size_t>(key) + 1);
+    } else {
+      if (key < std::numeric_limits<HistogramBase::Sample>::min() ||
+          key > std::numeric_limits<HistogramBase::Sample>::max()) {
+        return false;
+      }
+      bucket.min = static_cast<HistogramBase::Sample>(key);
+      bucket.max = key + 1;
+    }
+    buckets.push_back(bucket);
+  }
+  if (total_count < std::numeric_limits<HistogramBase::Count>::min() ||
+      total_count > std::numeric_limits<HistogramBase::Count>::max()) {
+    return false;
+  }
+
+  pickle->WriteInt64(sum);
+  pickle->WriteInt(static_cast<HistogramBase::Count>(total_count));
+  for (const Bucket& bucket : buckets) {
+    pickle->WriteInt(bucket.min);
+    pickle->WriteInt64(bucket.max);
+    pickle->WriteInt(bucket.count);
+  }
+  return true;
+}
+
 }  // namespace
 
 HistogramDeltaSerialization::HistogramDeltaSerialization(
     const std::string& caller_name)
-    : histogram_snapshot_manager_(this), serialized_deltas_(nullptr) {}
+    : histogram_snapshot_manager_(this),
+      serialized_deltas_(nullptr),
+      compact_deltas_(nullptr) {}
 
 HistogramDeltaSerialization::~HistogramDeltaSerialization() = default;
 
@@ -54,6 +196,20 @@ void HistogramDeltaSerialization::PrepareAndSerializeDeltas(
   serialized_deltas_ = nullptr;
 }
 
+void HistogramDeltaSerialization::PrepareAndSerializeCompactDeltas(
+    std::string* compact_deltas,
+    bool include_persistent) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  DCHECK(compact_deltas);
+
+  compact_deltas_ = compact_deltas;
+  // See PrepareAndSerializeDeltas() for the kIPCSerializationSourceFlag.
+  StatisticsRecorder::PrepareDeltas(
+      include_persistent, Histogram::kIPCSerializationSourceFlag,
+      Histogram::kNoFlags, &histogram_snapshot_manager_);
+  compact_deltas_ = nullptr;
+}
+
 // static
 void HistogramDeltaSerialization::DeserializeAndAddSamples(
     const std::vector<std::string>& serialized_deltas) {
@@ -71,6 +227,11 @@ void HistogramDeltaSerialization::RecordDelta(
   DCHECK(thread_checker_.CalledOnValidThread());
   DCHECK_NE(0, snapshot.TotalCount());
 
+  if (compact_deltas_) {
+    RecordCompactDelta(histogram, snapshot);
+    return;
+  }
+
   Pickle pickle;
   histogram.SerializeInfo(&pickle);
   snapshot.Serialize(&pickle);
@@ -78,4 +239,94 @@ void HistogramDeltaSerialization::RecordDelta(
       std::string(static_cast<const char*>(pickle.data()), pickle.size()));
 }
 
+void HistogramDeltaSerialization::RecordCompactDelta(
+    const HistogramBase& histogram,
+    const HistogramSamples& snapshot) {
+  AppendFixed64(histogram.name_hash(), compact_deltas_);
+  if (described_histograms_.insert(histogram.name_hash()).second) {
+    Pickle info;
+    histogram.SerializeInfo(&info);
+    AppendVarint(info.size(), compact_deltas_);
+    compact_deltas_->append(static_cast<const char*>(info.data()),
+                            info.size());
+  } else {
+    AppendVarint(0, compact_deltas_);
+  }
+  AppendZigZagVarint(snapshot.sum(), compact_deltas_);
+
+  // The number of buckets precedes them, so they are written aside first.
+  std::string buckets;
+  uint64_t num_buckets = 0;
+  int64_t previous_key = 0;
+  HistogramBase::Sample min;
+  int64_t max;
+  HistogramBase::Count count;
+  for (std::unique_ptr<SampleCountIterator> it = snapshot.Iterator();
+       !it->Done(); it->Next()) {
+    it->Get(&min, &max, &count);
+    size_t index;
+    int64_t key = min;
+    if (histogram.GetHistogramType() != SPARSE_HISTOGRAM) {
+      bool has_index = it->GetBucketIndex(&index);
+      DCHECK(has_index);
+      key = static_cast<int64_t>(index);
+    }
+    AppendZigZagVarint(key - previous_key, &buckets);
+    AppendZigZagVarint(count, &buckets);
+    previous_key = key;
+    ++num_buckets;
+  }
+  AppendVarint(num_buckets, compact_deltas_);
+  compact_deltas_->append(buckets);
+}
+
+HistogramDeltaDeserializer::HistogramDeltaDeserializer() = default;
+
+HistogramDeltaDeserializer::~HistogramDeltaDeserializer() = default;
+
+bool HistogramDeltaDeserializer::DeserializeAndAddSamples(
+    StringPiece compact_deltas) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
+  StringPiece in = compact_deltas;
+  while (!in.empty()) {
+    uint64_t name_hash;
+    uint64_t info_size;
+    if (!ReadFixed64(&in, &name_hash) || !ReadVarint(&in, &info_size))
+      return false;
+
+    auto it = histograms_.find(name_hash);
+    if (info_size) {
+      if (it != histograms_.end() || info_size > in.size())
+        return false;
+      Pickle info(in.data(), checked_cast<int>(info_size));
+      PickleIterator info_iter(info);
+      HistogramBase* histogram = DeserializeHistogramInfo(&info_iter);
+      if (histogram && histogram->name_hash() != name_hash)
+        return false;
+      it = histograms_.emplace(name_hash, histogram).first;
+      in.remove_prefix(info_size);
+    } else if (it == histograms_.end()) {
+      return false;
+    }
+
+    HistogramBase* histogram = it->second;
+    if (histogram &&
+        (histogram->flags() & HistogramBase::kIPCSerializationSourceFlag)) {
+      DVLOG(1) << "Single process mode, histogram observed and not copied: "
+               << histogram->histogram_name();
+      histogram = nullptr;
+    }
+
+    Pickle samples;
+    if (!ReadCompactSamples(&in, histogram, &samples))
+      return false;
+    if (histogram) {
+      PickleIterator samples_iter(samples);
+      histogram->AddSamplesFromPickle(&samples_iter);
+    }
+  }
+  return true;
+}
+
 }  // namespace base
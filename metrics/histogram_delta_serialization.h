@@ -5,7 +5,11 @@
 #ifndef BASE_METRICS_HISTOGRAM_DELTA_SERIALIZATION_H_
 #define BASE_METRICS_HISTOGRAM_DELTA_SERIALIZATION_H_
 
+#include <stdint.h>
+
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -13,6 +17,7 @@
 #include "base/macros.h"
 #include "base/metrics/histogram_flattener.h"
 #include "base/metrics/histogram_snapshot_manager.h"
+#include "base/strings/string_piece.h"
 #include "base/threading/thread_checker.h"
 
 namespace base {
@@ -35,6 +40,15 @@ class BASE_EXPORT HistogramDeltaSerialization : public HistogramFlattener {
   void PrepareAndSerializeDeltas(std::vector<std::string>* serialized_deltas,
                                  bool include_persistent);
 
+  // Same as above, but appends the deltas to |compact_deltas| in a compact
+  // format, which is read by a HistogramDeltaDeserializer. Each histogram is
+  // described only the first time this object serializes a delta of it, and
+  // is referred to by the hash of its name afterwards, so all the deltas
+  // serialized by this object must be read, in order, by the same
+  // deserializer (typically, one of each per IPC connection).
+  void PrepareAndSerializeCompactDeltas(std::string* compact_deltas,
+                                        bool include_persistent);
+
   // Deserialize deltas and add samples to corresponding histograms, creating
   // them if necessary. Silently ignores errors in |serialized_deltas|.
   static void DeserializeAndAddSamples(
@@ -45,6 +59,10 @@ class BASE_EXPORT HistogramDeltaSerialization : public HistogramFlattener {
   void RecordDelta(const HistogramBase& histogram,
                    const HistogramSamples& snapshot) override;
 
+  // Appends |snapshot| to |compact_deltas_|.
+  void RecordCompactDelta(const HistogramBase& histogram,
+                          const HistogramSamples& snapshot);
+
   ThreadChecker thread_checker_;
 
   // Calculates deltas in histogram counters.
@@ -53,9 +71,37 @@ class BASE_EXPORT HistogramDeltaSerialization : public HistogramFlattener {
   // Output buffer for serialized deltas.
   std::vector<std::string>* serialized_deltas_;
 
+  // Output buffer for compact deltas.
+  std::string* compact_deltas_;
+
+  // The name hashes of the histograms already described in compact deltas.
+  std::set<uint64_t> described_histograms_;
+
   DISALLOW_COPY_AND_ASSIGN(HistogramDeltaSerialization);
 };
 
+// Reads the compact deltas written by the PrepareAndSerializeCompactDeltas() of
+// a HistogramDeltaSerialization, and adds their samples to the corresponding
+// histograms, creating them if necessary.
+class BASE_EXPORT HistogramDeltaDeserializer {
+ public:
+  HistogramDeltaDeserializer();
+  ~HistogramDeltaDeserializer();
+
+  // Returns false if |compact_deltas| is malformed, in which case the deltas
+  // following the error are ignored.
+  bool DeserializeAndAddSamples(StringPiece compact_deltas);
+
+ private:
+  ThreadChecker thread_checker_;
+
+  // The histograms described so far, by name hash. Null for the histograms
+  // which couldn't be created.
+  std::map<uint64_t, HistogramBase*> histograms_;
+
+  DISALLOW_COPY_AND_ASSIGN(HistogramDeltaDeserializer);
+};
+
 }  // namespace base
 
 #endif  // BASE_METRICS_HISTOGRAM_DELTA_SERIALIZATION_H_
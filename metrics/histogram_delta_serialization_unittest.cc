@@ -4,10 +4,12 @@
 
 #include "base/metrics/histogram_delta_serialization.h"
 
+#include <string>
 #include <vector>
 
 #include "base/metrics/histogram.h"
 #include "base/metrics/histogram_base.h"
+#include "base/metrics/sparse_histogram.h"
 #include "base/metrics/statistics_recorder.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -52,4 +54,75 @@ TEST(HistogramDeltaSerializationTest, DeserializeHistogramAndAddSamples) {
   EXPECT_EQ(2, snapshot2->GetCount(1000));
 }
 
+TEST(HistogramDeltaSerializationTest, CompactDeltas) {
+  std::unique_ptr<StatisticsRecorder> statistic_recorder(
+      StatisticsRecorder::CreateTemporaryForTesting());
+  HistogramDeltaSerialization serializer("HistogramDeltaSerializationTest");
+  HistogramDeltaDeserializer deserializer;
+  std::string deltas;
+  serializer.PrepareAndSerializeCompactDeltas(&deltas, true);
+  EXPECT_TRUE(deltas.empty());
+
+  HistogramBase* histogram = Histogram::FactoryGet(
+      "TestHistogram", 1, 1000, 10, HistogramBase::kNoFlags);
+  HistogramBase* sparse_histogram = SparseHistogram::FactoryGet(
+      "TestSparseHistogram", HistogramBase::kNoFlags);
+  histogram->Add(1);
+  histogram->Add(10);
+  histogram->Add(1000);
+  sparse_histogram->Add(-5);
+  sparse_histogram->Add(1000000);
+
+  serializer.PrepareAndSerializeCompactDeltas(&deltas, true);
+  EXPECT_NE(std::string::npos, deltas.find("TestHistogram"));
+  // The samples are ignored, the histograms have kIPCSerializationSourceFlag.
+  EXPECT_TRUE(deserializer.DeserializeAndAddSamples(deltas));
+  EXPECT_EQ(3, histogram->SnapshotSamples()->TotalCount());
+  EXPECT_EQ(2, sparse_histogram->SnapshotSamples()->TotalCount());
+
+  // The histograms are only described in the first deltas.
+  histogram->Add(10);
+  sparse_histogram->Add(-5);
+  std::string deltas2;
+  serializer.PrepareAndSerializeCompactDeltas(&deltas2, true);
+  EXPECT_EQ(std::string::npos, deltas2.find("TestHistogram"));
+  EXPECT_LT(deltas2.size(), deltas.size());
+
+  // Clear kIPCSerializationSourceFlag to emulate multi-process usage.
+  histogram->ClearFlags(HistogramBase::kIPCSerializationSourceFlag);
+  sparse_histogram->ClearFlags(HistogramBase::kIPCSerializationSourceFlag);
+  EXPECT_TRUE(deserializer.DeserializeAndAddSamples(deltas2));
+
+  std::unique_ptr<HistogramSamples> snapshot = histogram->SnapshotSamples();
+  EXPECT_EQ(5, snapshot->TotalCount());
+  EXPECT_EQ(1, snapshot->GetCount(1));
+  EXPECT_EQ(3, snapshot->GetCount(10));
+  EXPECT_EQ(1, snapshot->GetCount(1000));
+  EXPECT_EQ(1 + 3 * 10 + 1000, snapshot->sum());
+  snapshot = sparse_histogram->SnapshotSamples();
+  EXPECT_EQ(4, snapshot->TotalCount());
+  EXPECT_EQ(3, snapshot->GetCount(-5));
+  EXPECT_EQ(1, snapshot->GetCount(1000000));
+}
+
+TEST(HistogramDeltaSerializationTest, MalformedCompactDeltas) {
+  std::unique_ptr<StatisticsRecorder> statistic_recorder(
+      StatisticsRecorder::CreateTemporaryForTesting());
+  HistogramDeltaSerialization serializer("HistogramDeltaSerializationTest");
+  HistogramBase* histogram = Histogram::FactoryGet(
+      "TestHistogram", 1, 1000, 10, HistogramBase::kNoFlags);
+  histogram->Add(10);
+  std::string deltas;
+  serializer.PrepareAndSerializeCompactDeltas(&deltas, true);
+  histogram->Add(10);
+  std::string deltas2;
+  serializer.PrepareAndSerializeCompactDeltas(&deltas2, true);
+
+  // The histogram is only described in the first deltas.
+  EXPECT_FALSE(HistogramDeltaDeserializer().DeserializeAndAddSamples(deltas2));
+  EXPECT_FALSE(HistogramDeltaDeserializer().DeserializeAndAddSamples(
+      deltas.substr(0, deltas.size() - 1)));
+  EXPECT_TRUE(HistogramDeltaDeserializer().DeserializeAndAddSamples(deltas));
+}
+
 }  // namespace base
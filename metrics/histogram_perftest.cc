@@ -0,0 +1,78 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/histogram.h"
+
+#include <memory>
+
+#include "base/macros.h"
+#include "base/metrics/histogram_base.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/metrics/sparse_histogram.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/test/perf_benchmark.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr int kIterations = 1000000;
+
+class HistogramPerfTest : public testing::Test {
+ protected:
+  HistogramPerfTest()
+      : statistics_recorder_(StatisticsRecorder::CreateTemporaryForTesting()) {}
+
+  // Benchmarks adding samples spread over the buckets of |histogram|.
+  void RunAddTest(const char* story, HistogramBase* histogram) {
+    PerfBenchmark benchmark("histogram", story, kIterations);
+    benchmark.Run([histogram](int iterations) {
+      for (int i = 0; i < iterations; ++i)
+        histogram->Add(i & 1023);
+    });
+  }
+
+ private:
+  std::unique_ptr<StatisticsRecorder> statistics_recorder_;
+
+  DISALLOW_COPY_AND_ASSIGN(HistogramPerfTest);
+};
+
+}  // namespace
+
+TEST_F(HistogramPerfTest, Add) {
+  RunAddTest("histogram_add",
+             Histogram::FactoryGet("Perf.Histogram", 1, 1000, 50,
+                                   HistogramBase::kNoFlags));
+}
+
+TEST_F(HistogramPerfTest, LinearAdd) {
+  RunAddTest("linear_histogram_add",
+             LinearHistogram::FactoryGet("Perf.LinearHistogram", 1, 1000, 50,
+                                         HistogramBase::kNoFlags));
+}
+
+TEST_F(HistogramPerfTest, ShardedAdd) {
+  RunAddTest("sharded_histogram_add",
+             ShardedHistogram::FactoryGet("Perf.ShardedHistogram", 1, 1000,
+                                          50, HistogramBase::kNoFlags));
+}
+
+TEST_F(HistogramPerfTest, SparseAdd) {
+  RunAddTest("sparse_histogram_add",
+             SparseHistogram::FactoryGet("Perf.SparseHistogram",
+                                         HistogramBase::kNoFlags));
+}
+
+// The macros cache the histogram in a static, after looking it up once.
+TEST_F(HistogramPerfTest, MacroAdd) {
+  PerfBenchmark benchmark("histogram", "macro_add", kIterations);
+  benchmark.Run([](int iterations) {
+    for (int i = 0; i < iterations; ++i)
+      UMA_HISTOGRAM_COUNTS_1000("Perf.MacroHistogram", i & 1023);
+  });
+}
+
+}  // namespace base
@@ -216,6 +216,18 @@ void HistogramSamples::Subtract(const HistogramSamples& other) {
   DCHECK(success);
 }
 
+HistogramBase::Count* HistogramSamples::GetOrCreateSampleCountStorage(
+    HistogramBase::Sample value) {
+  return nullptr;
+}
+
+void HistogramSamples::AccumulateAtStorage(HistogramBase::Count* storage,
+                                           HistogramBase::Sample value,
+                                           HistogramBase::Count count) {
+  subtle::NoBarrier_AtomicIncrement(storage, count);
+  IncreaseSumAndCount(strict_cast<int64_t>(count) * value, count);
+}
+
 void HistogramSamples::Serialize(Pickle* pickle) const {
   pickle->WriteInt64(sum());
   pickle->WriteInt(redundant_count());
@@ -253,6 +265,17 @@ void HistogramSamples::IncreaseSumAndCount(int64_t sum,
   subtle::NoBarrier_AtomicIncrement(&meta_->redundant_count, count);
 }
 
+void HistogramSamples::ExtractSumAndCount(int64_t* sum,
+                                          HistogramBase::Count* count) {
+#ifdef ARCH_CPU_64_BITS
+  *sum = subtle::NoBarrier_AtomicExchange(&meta_->sum, 0);
+#else
+  *sum = meta_->sum;
+  meta_->sum = 0;
+#endif
+  *count = subtle::NoBarrier_AtomicExchange(&meta_->redundant_count, 0);
+}
+
 void HistogramSamples::RecordNegativeSample(NegativeSampleReason reason,
                                             HistogramBase::Count increment) {
   UMA_HISTOGRAM_ENUMERATION("UMA.NegativeSamples.Reason", reason,
@@ -270,6 +293,12 @@ bool SampleCountIterator::GetBucketIndex(size_t* index) const {
   return false;
 }
 
+const HistogramBase::AtomicCount* SampleCountIterator::GetCountsArray(
+    size_t* size,
+    const BucketRanges** bucket_ranges) const {
+  return nullptr;
+}
+
 SingleSampleIterator::SingleSampleIterator(HistogramBase::Sample min,
                                            int64_t max,
                                            HistogramBase::Count count)
@@ -17,6 +17,7 @@
 
 namespace base {
 
+class BucketRanges;
 class Pickle;
 class PickleIterator;
 class SampleCountIterator;
@@ -146,6 +147,21 @@ class BASE_EXPORT HistogramSamples {
   virtual std::unique_ptr<SampleCountIterator> Iterator() const = 0;
   virtual void Serialize(Pickle* pickle) const;
 
+  // Returns the storage of the count of |value|, creating it if needed, for
+  // the samples which keep each count at the same address for their whole
+  // life and only ever update it atomically (the sample maps). Returns null
+  // for the others.
+  virtual HistogramBase::Count* GetOrCreateSampleCountStorage(
+      HistogramBase::Sample value);
+
+  // Same as Accumulate(), given the |storage| of the count of |value| returned
+  // by GetOrCreateSampleCountStorage(). On 64-bit platforms, where the sum is
+  // updated atomically, this can be called concurrently with the other
+  // methods.
+  void AccumulateAtStorage(HistogramBase::Count* storage,
+                           HistogramBase::Sample value,
+                           HistogramBase::Count count);
+
   // Accessor fuctions.
   uint64_t id() const { return meta_->id; }
   int64_t sum() const {
@@ -187,6 +203,10 @@ class BASE_EXPORT HistogramSamples {
   // Atomically adjust the sum and redundant-count.
   void IncreaseSumAndCount(int64_t sum, HistogramBase::Count count);
 
+  // Atomically resets the sum and redundant-count to zero, returning their
+  // previous values in |sum| and |count|.
+  void ExtractSumAndCount(int64_t* sum, HistogramBase::Count* count);
+
   // Record a negative-sample observation and the reason why.
   void RecordNegativeSample(NegativeSampleReason reason,
                             HistogramBase::Count increment);
@@ -231,6 +251,14 @@ class BASE_EXPORT SampleCountIterator {
   // For histograms that don't use predefined buckets, it returns false.
   // Requires: !Done();
   virtual bool GetBucketIndex(size_t* index) const;
+
+  // Get the whole array of counts being iterated, one per bucket of
+  // |*bucket_ranges|, so that it can be merged without visiting each sample.
+  // For iterators that aren't backed by such an array, it returns null.
+  // Requires: Next() wasn't called.
+  virtual const HistogramBase::AtomicCount* GetCountsArray(
+      size_t* size,
+      const BucketRanges** bucket_ranges) const;
 };
 
 class BASE_EXPORT SingleSampleIterator : public SampleCountIterator {
@@ -55,6 +55,11 @@ void HistogramSnapshotManager::PrepareDeltas(
 }
 
 void HistogramSnapshotManager::PrepareDelta(HistogramBase* histogram) {
+  // Most histograms don't change between two deltas, and taking a snapshot of
+  // them and checking it for corruption costs as much as for the others.
+  if (!histogram->HasUnloggedSamples())
+    return;
+
   histogram->ValidateHistogramContents();
   PrepareSamples(histogram, histogram->SnapshotDelta());
 }
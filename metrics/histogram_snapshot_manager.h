@@ -33,8 +33,9 @@ class BASE_EXPORT HistogramSnapshotManager final {
   explicit HistogramSnapshotManager(HistogramFlattener* histogram_flattener);
   ~HistogramSnapshotManager();
 
-  // Snapshot all histograms, and ask |histogram_flattener_| to record the
-  // delta. |flags_to_set| is used to set flags for each histogram.
+  // Snapshot all histograms which changed since the previous delta (see
+  // HistogramBase::HasUnloggedSamples()), and ask |histogram_flattener_| to
+  // record the delta. |flags_to_set| is used to set flags for each histogram.
   // |required_flags| is used to select histograms to be recorded.
   // Only histograms that have all the flags specified by the argument will be
   // chosen. If all histograms should be recorded, set it to
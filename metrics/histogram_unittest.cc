@@ -26,6 +26,7 @@
 #include "base/pickle.h"
 #include "base/strings/stringprintf.h"
 #include "base/test/gtest_util.h"
+#include "base/threading/simple_thread.h"
 #include "base/time/time.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -169,6 +170,7 @@ TEST_P(HistogramTest, DeltaTest) {
   HistogramBase* histogram =
       Histogram::FactoryGet("DeltaHistogram", 1, 64, 8,
                             HistogramBase::kNoFlags);
+  EXPECT_FALSE(histogram->HasUnloggedSamples());
   histogram->Add(1);
   histogram->Add(10);
   histogram->Add(50);
@@ -179,12 +181,14 @@ TEST_P(HistogramTest, DeltaTest) {
   EXPECT_EQ(1, samples->GetCount(10));
   EXPECT_EQ(1, samples->GetCount(50));
   EXPECT_EQ(samples->TotalCount(), samples->redundant_count());
+  EXPECT_FALSE(histogram->HasUnloggedSamples());
 
   samples = histogram->SnapshotDelta();
   EXPECT_EQ(0, samples->TotalCount());
 
   histogram->Add(10);
   histogram->Add(10);
+  EXPECT_TRUE(histogram->HasUnloggedSamples());
   samples = histogram->SnapshotDelta();
   EXPECT_EQ(2, samples->TotalCount());
   EXPECT_EQ(2, samples->GetCount(10));
@@ -219,6 +223,104 @@ TEST_P(HistogramTest, FinalDeltaTest) {
   EXPECT_EQ(samples->TotalCount(), samples->redundant_count());
 }
 
+TEST_P(HistogramTest, ShardedHistogram) {
+  HistogramBase* histogram = ShardedHistogram::FactoryGet(
+      "ShardedHistogram", 1, 64, 8, HistogramBase::kNoFlags);
+  EXPECT_EQ(HISTOGRAM, histogram->GetHistogramType());
+  EXPECT_EQ(histogram, Histogram::FactoryGet("ShardedHistogram", 1, 64, 8,
+                                             HistogramBase::kNoFlags));
+  histogram->Add(1);
+  histogram->Add(10);
+  histogram->AddCount(50, 3);
+  histogram->Add(100);
+
+  std::unique_ptr<HistogramSamples> samples = histogram->SnapshotSamples();
+  EXPECT_EQ(6, samples->TotalCount());
+  EXPECT_EQ(1, samples->GetCount(1));
+  EXPECT_EQ(1, samples->GetCount(10));
+  EXPECT_EQ(3, samples->GetCount(50));
+  EXPECT_EQ(1, samples->GetCount(64));
+  EXPECT_EQ(1 + 10 + 3 * 50 + 100, samples->sum());
+  EXPECT_EQ(samples->TotalCount(), samples->redundant_count());
+
+  histogram->Add(2);
+  EXPECT_TRUE(histogram->HasUnloggedSamples());
+  samples = histogram->SnapshotDelta();
+  EXPECT_FALSE(histogram->HasUnloggedSamples());
+  EXPECT_EQ(7, samples->TotalCount());
+  EXPECT_EQ(1, samples->GetCount(2));
+  EXPECT_EQ(1 + 10 + 3 * 50 + 100 + 2, samples->sum());
+  EXPECT_EQ(samples->TotalCount(), samples->redundant_count());
+
+  samples = histogram->SnapshotDelta();
+  EXPECT_EQ(0, samples->TotalCount());
+  EXPECT_EQ(0, samples->sum());
+  EXPECT_EQ(7, histogram->SnapshotSamples()->TotalCount());
+
+  histogram->Add(20);
+  samples = histogram->SnapshotFinalDelta();
+  EXPECT_EQ(1, samples->TotalCount());
+  EXPECT_EQ(20, samples->sum());
+}
+
+namespace {
+
+// Adds the values [0, |num_samples|) to a histogram.
+class AddSamplesDelegate : public DelegateSimpleThread::Delegate {
+ public:
+  AddSamplesDelegate(HistogramBase* histogram, int num_samples)
+      : histogram_(histogram), num_samples_(num_samples) {}
+  ~AddSamplesDelegate() override = default;
+
+  void Run() override {
+    for (int i = 0; i < num_samples_; ++i)
+      histogram_->Add(i);
+  }
+
+ private:
+  HistogramBase* const histogram_;
+  const int num_samples_;
+
+  DISALLOW_COPY_AND_ASSIGN(AddSamplesDelegate);
+};
+
+}  // namespace
+
+TEST_P(HistogramTest, ShardedHistogramThreads) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumSamples = 10000;
+  HistogramBase* histogram = ShardedHistogram::FactoryGet(
+      "ShardedHistogramThreads", 1, kNumSamples, 50, HistogramBase::kNoFlags);
+
+  AddSamplesDelegate delegate(histogram, kNumSamples);
+  std::vector<std::unique_ptr<DelegateSimpleThread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(std::make_unique<DelegateSimpleThread>(
+        &delegate, StringPrintf("ShardedHistogramThreads%d", i)));
+    threads.back()->Start();
+  }
+  // Snapshots taken while samples are being added don't lose any.
+  int64_t total_count = 0;
+  int64_t sum = 0;
+  for (int i = 0; i < 10; ++i) {
+    std::unique_ptr<HistogramSamples> samples = histogram->SnapshotDelta();
+    total_count += samples->TotalCount();
+    sum += samples->sum();
+  }
+  for (const auto& thread : threads)
+    thread->Join();
+  std::unique_ptr<HistogramSamples> samples = histogram->SnapshotDelta();
+  total_count += samples->TotalCount();
+  sum += samples->sum();
+
+  EXPECT_EQ(kNumThreads * kNumSamples, total_count);
+  EXPECT_EQ(int64_t{kNumThreads} * kNumSamples * (kNumSamples - 1) / 2, sum);
+  samples = histogram->SnapshotSamples();
+  EXPECT_EQ(kNumThreads * kNumSamples, samples->TotalCount());
+  EXPECT_EQ(kNumThreads, samples->GetCount(0));
+  EXPECT_EQ(kNumThreads, samples->GetCount(1));
+}
+
 TEST_P(HistogramTest, ExponentialRangesTest) {
   // Check that we got a nice exponential when there was enough room.
   BucketRanges ranges(9);
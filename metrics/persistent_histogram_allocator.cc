@@ -268,6 +268,22 @@ PersistentHistogramAllocator::Iterator::GetNextWithIgnore(Reference ignore) {
   return nullptr;
 }
 
+std::unique_ptr<HistogramBase>
+PersistentHistogramAllocator::Iterator::GetNextWithUnloggedSamples() {
+  PersistentMemoryAllocator::Reference ref;
+  while ((ref = memory_iter_.GetNextOfType<PersistentHistogramData>()) != 0) {
+    // Every sample increments the redundant-count of the unlogged samples and
+    // logging them subtracts exactly what it logs, so it's non-zero only if
+    // there's something left to log.
+    const PersistentHistogramData* data =
+        memory_iter_.GetAsObject<PersistentHistogramData>(ref);
+    if (data &&
+        subtle::NoBarrier_Load(&data->samples_metadata.redundant_count) != 0) {
+      return allocator_->GetHistogram(ref);
+    }
+  }
+  return nullptr;
+}
 
 PersistentHistogramAllocator::PersistentHistogramAllocator(
     std::unique_ptr<PersistentMemoryAllocator> memory)
@@ -194,6 +194,12 @@ class BASE_EXPORT PersistentHistogramAllocator {
     // reference in the process. Pass |ignore| of zero (0) to ignore nothing.
     std::unique_ptr<HistogramBase> GetNextWithIgnore(Reference ignore);
 
+    // Gets the next histogram with samples that haven't been logged, such as
+    // by MergeHistogramDeltaToStatisticsRecorder(), since they were recorded.
+    // The others are skipped without being created, so an uploader reading a
+    // segment repeatedly only pays for the histograms that changed.
+    std::unique_ptr<HistogramBase> GetNextWithUnloggedSamples();
+
    private:
     // Weak-pointer to histogram allocator being iterated over.
     PersistentHistogramAllocator* allocator_;
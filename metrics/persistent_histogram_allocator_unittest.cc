@@ -335,6 +335,46 @@ TEST_F(PersistentHistogramAllocatorTest, StatisticsRecorderMerge) {
   EXPECT_EQ(1, snapshot->GetCount(7));
 }
 
+TEST_F(PersistentHistogramAllocatorTest, IterateWithUnloggedSamples) {
+  HistogramBase* histogram1 =
+      LinearHistogram::FactoryGet("UnloggedHistogram1", 1, 10, 10, 0);
+  HistogramBase* histogram2 =
+      LinearHistogram::FactoryGet("UnloggedHistogram2", 1, 10, 10, 0);
+  LinearHistogram::FactoryGet("UnloggedHistogram3", 1, 10, 10, 0);
+  histogram1->Add(3);
+  histogram2->Add(4);
+
+  // Histograms without samples are skipped.
+  PersistentHistogramAllocator reader(
+      std::make_unique<PersistentMemoryAllocator>(
+          allocator_memory_.get(), kAllocatorMemorySize, 0, 0, "", false));
+  PersistentHistogramAllocator::Iterator iter1(&reader);
+  std::unique_ptr<HistogramBase> recovered = iter1.GetNextWithUnloggedSamples();
+  ASSERT_TRUE(recovered);
+  recovered->CheckName("UnloggedHistogram1");
+  recovered->SnapshotDelta();
+  recovered = iter1.GetNextWithUnloggedSamples();
+  ASSERT_TRUE(recovered);
+  recovered->CheckName("UnloggedHistogram2");
+  EXPECT_FALSE(iter1.GetNextWithUnloggedSamples());
+
+  // So are histograms whose samples were logged, until they get new ones.
+  histogram2->Add(5);
+  PersistentHistogramAllocator::Iterator iter2(&reader);
+  recovered = iter2.GetNextWithUnloggedSamples();
+  ASSERT_TRUE(recovered);
+  recovered->CheckName("UnloggedHistogram2");
+  EXPECT_EQ(2, recovered->SnapshotDelta()->TotalCount());
+  EXPECT_FALSE(iter2.GetNextWithUnloggedSamples());
+
+  histogram1->Add(6);
+  PersistentHistogramAllocator::Iterator iter3(&reader);
+  recovered = iter3.GetNextWithUnloggedSamples();
+  ASSERT_TRUE(recovered);
+  recovered->CheckName("UnloggedHistogram1");
+  EXPECT_FALSE(iter3.GetNextWithUnloggedSamples());
+}
+
 TEST_F(PersistentHistogramAllocatorTest, RangesDeDuplication) {
   // This corresponds to the "ranges_ref" field of the PersistentHistogramData
   // structure defined (privately) inside persistent_histogram_allocator.cc.
@@ -9,6 +9,7 @@
 #include "base/logging.h"
 #include "base/metrics/persistent_histogram_allocator.h"
 #include "base/metrics/persistent_memory_allocator.h"
+#include "base/process/process_handle.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/time/time.h"
@@ -35,10 +36,53 @@ PersistentHistogramStorage::PersistentHistogramStorage(
   GlobalHistogramAllocator::Get()->CreateTrackingHistograms(allocator_name);
 }
 
+PersistentHistogramStorage::PersistentHistogramStorage(
+    StringPiece allocator_name,
+    StorageDirManagement storage_dir_management,
+    const FilePath& storage_base_dir)
+    : storage_base_dir_(storage_base_dir),
+      storage_dir_management_(storage_dir_management) {
+  DCHECK(!allocator_name.empty());
+  DCHECK(IsStringASCII(allocator_name));
+  DCHECK(!storage_base_dir.empty());
+
+#if !defined(OS_NACL)
+  const FilePath storage_dir = storage_base_dir_.empty()
+                                   ? FilePath()
+                                   : GetStorageDir(allocator_name);
+  // The process id keeps apart the files of processes started within the same
+  // second, which CreateWithFile() would otherwise share.
+  memory_mapped_ =
+      !storage_dir.empty() &&
+      GlobalHistogramAllocator::CreateWithFile(
+          GlobalHistogramAllocator::ConstructFilePathForUploadDir(
+              storage_dir, allocator_name, Time::Now(), GetCurrentProcId()),
+          kAllocSize,
+          0,  // No identifier.
+          allocator_name);
+#endif
+  if (!memory_mapped_) {
+    GlobalHistogramAllocator::CreateWithLocalMemory(kAllocSize,
+                                                    0,  // No identifier.
+                                                    allocator_name);
+  }
+  GlobalHistogramAllocator::Get()->CreateTrackingHistograms(allocator_name);
+}
+
 PersistentHistogramStorage::~PersistentHistogramStorage() {
-  PersistentHistogramAllocator* allocator = GlobalHistogramAllocator::Get();
+  GlobalHistogramAllocator* allocator = GlobalHistogramAllocator::Get();
   allocator->UpdateTrackingHistograms();
 
+  // A memory-mapped file already holds the histograms, so it only needs to be
+  // flushed, or deleted if they're not wanted.
+  if (memory_mapped_) {
+    if (disabled_)
+      allocator->DeletePersistentLocation();
+    else
+      allocator->memory_allocator()->Flush(/*sync=*/true);
+    return;
+  }
+
   // TODO(chengx): Investigate making early return depend on whethere there are
   // metrics to report at this point or not.
   if (disabled_)
@@ -53,16 +97,43 @@ PersistentHistogramStorage::~PersistentHistogramStorage() {
     return;
   }
 
-  FilePath storage_dir = storage_base_dir_.AppendASCII(allocator->Name());
+  FilePath storage_dir = GetStorageDir(allocator->Name());
+  if (storage_dir.empty())
+    return;
+
+  // Save data using the current time as the filename. The actual filename
+  // doesn't matter (so long as it ends with the correct extension) but this
+  // works as well as anything.
+  Time::Exploded exploded;
+  Time::Now().LocalExplode(&exploded);
+  const FilePath file_path =
+      storage_dir
+          .AppendASCII(StringPrintf("%04d%02d%02d%02d%02d%02d", exploded.year,
+                                    exploded.month, exploded.day_of_month,
+                                    exploded.hour, exploded.minute,
+                                    exploded.second))
+          .AddExtension(PersistentMemoryAllocator::kFileExtension);
+
+  StringPiece contents(static_cast<const char*>(allocator->data()),
+                       allocator->used());
+  if (!ImportantFileWriter::WriteFileAtomically(file_path, contents)) {
+    LOG(ERROR) << "Persistent histograms fail to write to file: "
+               << file_path.value();
+  }
+}
+
+FilePath PersistentHistogramStorage::GetStorageDir(
+    StringPiece allocator_name) const {
+  FilePath storage_dir = storage_base_dir_.AppendASCII(allocator_name);
 
   switch (storage_dir_management_) {
     case StorageDirManagement::kCreate:
       if (!CreateDirectory(storage_dir)) {
         LOG(ERROR)
-            << "Could not write \"" << allocator->Name()
+            << "Could not write \"" << allocator_name
             << "\" persistent histograms to file as the storage directory "
                "cannot be created.";
-        return;
+        return FilePath();
       }
       break;
     case StorageDirManagement::kUseExisting:
@@ -71,33 +142,15 @@ PersistentHistogramStorage::~PersistentHistogramStorage() {
         // directory, it should ensure the directory's existence if it's
         // essential.
         LOG(ERROR)
-            << "Could not write \"" << allocator->Name()
+            << "Could not write \"" << allocator_name
             << "\" persistent histograms to file as the storage directory "
                "does not exist.";
-        return;
+        return FilePath();
       }
       break;
   }
 
-  // Save data using the current time as the filename. The actual filename
-  // doesn't matter (so long as it ends with the correct extension) but this
-  // works as well as anything.
-  Time::Exploded exploded;
-  Time::Now().LocalExplode(&exploded);
-  const FilePath file_path =
-      storage_dir
-          .AppendASCII(StringPrintf("%04d%02d%02d%02d%02d%02d", exploded.year,
-                                    exploded.month, exploded.day_of_month,
-                                    exploded.hour, exploded.minute,
-                                    exploded.second))
-          .AddExtension(PersistentMemoryAllocator::kFileExtension);
-
-  StringPiece contents(static_cast<const char*>(allocator->data()),
-                       allocator->used());
-  if (!ImportantFileWriter::WriteFileAtomically(file_path, contents)) {
-    LOG(ERROR) << "Persistent histograms fail to write to file: "
-               << file_path.value();
-  }
+  return storage_dir;
 }
 
 }  // namespace base
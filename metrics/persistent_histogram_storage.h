@@ -20,6 +20,11 @@ namespace base {
 // destruction. PersistentHistogramStorage should be instantiated as early as
 // possible in the process lifetime and should never be instantiated again.
 // Persisted histograms will eventually be reported by Chrome.
+//
+// If the storage directory is known at construction, the persistent memory
+// can instead be a file memory-mapped in it, so that histograms are persisted
+// as they are recorded, even if the process crashes, and the OS only writes
+// back the pages that changed.
 class BASE_EXPORT PersistentHistogramStorage {
  public:
   enum class StorageDirManagement { kCreate, kUseExisting };
@@ -35,19 +40,35 @@ class BASE_EXPORT PersistentHistogramStorage {
   PersistentHistogramStorage(StringPiece allocator_name,
                              StorageDirManagement storage_dir_management);
 
+  // Creates a process-wide storage location for histograms that is a file
+  // memory-mapped in |storage_base_dir|/|allocator_name|, which is flushed on
+  // destruction. If that file can't be created, this falls back to the local
+  // memory of the above ctor, written to |storage_base_dir| on destruction.
+  PersistentHistogramStorage(StringPiece allocator_name,
+                             StorageDirManagement storage_dir_management,
+                             const FilePath& storage_base_dir);
+
   ~PersistentHistogramStorage();
 
   // The storage directory isn't always known during initial construction so
   // it's set separately. The last one wins if there are multiple calls to this
-  // method.
+  // method. It has no effect if the histograms are memory-mapped.
   void set_storage_base_dir(const FilePath& storage_base_dir) {
     storage_base_dir_ = storage_base_dir;
   }
 
-  // Disables histogram storage.
+  // Disables histogram storage. A memory-mapped file is deleted.
   void Disable() { disabled_ = true; }
 
+  // Returns whether the histograms are memory-mapped from a file.
+  bool is_memory_mapped() const { return memory_mapped_; }
+
  private:
+  // Returns the directory |storage_base_dir_|/|allocator_name| after creating
+  // it or checking that it exists, according to |storage_dir_management_|, or
+  // an empty path on failure.
+  FilePath GetStorageDir(StringPiece allocator_name) const;
+
   // Metrics files are written into directory
   // |storage_base_dir_|/|allocator_name| (see the ctor for allocator_name).
   FilePath storage_base_dir_;
@@ -60,6 +81,10 @@ class BASE_EXPORT PersistentHistogramStorage {
   // histogram data.
   bool disabled_ = false;
 
+  // Whether the histograms are in a file memory-mapped in the storage
+  // directory rather than in local memory.
+  bool memory_mapped_ = false;
+
   DISALLOW_COPY_AND_ASSIGN(PersistentHistogramStorage);
 };
 
@@ -5,11 +5,17 @@
 #include "base/metrics/persistent_histogram_storage.h"
 
 #include <memory>
+#include <string>
 
+#include "base/files/file_enumerator.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/files/scoped_temp_dir.h"
+#include "base/metrics/histogram.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/metrics/persistent_histogram_allocator.h"
+#include "base/metrics/persistent_memory_allocator.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -35,6 +41,10 @@ class PersistentHistogramStorageTest : public testing::Test {
         temp_dir_path().AppendASCII(kTestHistogramAllocatorName);
   }
 
+  // Releases the global allocator created by the PersistentHistogramStorage,
+  // so that another one can be created.
+  void TearDown() override { GlobalHistogramAllocator::ReleaseForTesting(); }
+
   // Gets the path to the temporary directory.
   const FilePath& temp_dir_path() { return temp_dir_.GetPath(); }
 
@@ -73,6 +83,70 @@ TEST_F(PersistentHistogramStorageTest, HistogramWriteTest) {
   EXPECT_TRUE(DirectoryExists(test_storage_dir()));
   EXPECT_FALSE(IsDirectoryEmpty(test_storage_dir()));
 }
+
+TEST_F(PersistentHistogramStorageTest, MemoryMappedTest) {
+  auto persistent_histogram_storage =
+      std::make_unique<PersistentHistogramStorage>(
+          kTestHistogramAllocatorName,
+          PersistentHistogramStorage::StorageDirManagement::kCreate,
+          temp_dir_path());
+  ASSERT_TRUE(persistent_histogram_storage->is_memory_mapped());
+
+  // The histogram file exists while histograms are recorded in it.
+  EXPECT_FALSE(IsDirectoryEmpty(test_storage_dir()));
+  HistogramBase* histogram =
+      LinearHistogram::FactoryGet("Some.Test.MappedMetric", 1, 10, 11, 0);
+  histogram->Add(3);
+
+  persistent_histogram_storage.reset();
+
+  FileEnumerator enumerator(test_storage_dir(), false, FileEnumerator::FILES);
+  const FilePath file_path = enumerator.Next();
+  ASSERT_FALSE(file_path.empty());
+  EXPECT_TRUE(enumerator.Next().empty());
+
+  // Another process reading the file finds the samples.
+  std::unique_ptr<MemoryMappedFile> mmfile(new MemoryMappedFile());
+  ASSERT_TRUE(mmfile->Initialize(file_path));
+  PersistentHistogramAllocator reader(
+      std::make_unique<FilePersistentMemoryAllocator>(std::move(mmfile), 0, 0,
+                                                      "", true));
+  PersistentHistogramAllocator::Iterator iter(&reader);
+  std::unique_ptr<HistogramBase> recovered;
+  while ((recovered = iter.GetNext()) != nullptr) {
+    if (std::string(recovered->histogram_name()) == "Some.Test.MappedMetric")
+      break;
+  }
+  ASSERT_TRUE(recovered);
+  EXPECT_EQ(1, recovered->SnapshotSamples()->GetCount(3));
+}
+
+TEST_F(PersistentHistogramStorageTest, MemoryMappedDisableTest) {
+  auto persistent_histogram_storage =
+      std::make_unique<PersistentHistogramStorage>(
+          kTestHistogramAllocatorName,
+          PersistentHistogramStorage::StorageDirManagement::kCreate,
+          temp_dir_path());
+  ASSERT_TRUE(persistent_histogram_storage->is_memory_mapped());
+  EXPECT_FALSE(IsDirectoryEmpty(test_storage_dir()));
+
+  // Disabling the storage deletes the histogram file.
+  persistent_histogram_storage->Disable();
+  persistent_histogram_storage.reset();
+  EXPECT_TRUE(IsDirectoryEmpty(test_storage_dir()));
+}
+
+TEST_F(PersistentHistogramStorageTest, MemoryMappedFallbackTest) {
+  // Without the storage directory, the histograms are kept in local memory.
+  auto persistent_histogram_storage =
+      std::make_unique<PersistentHistogramStorage>(
+          kTestHistogramAllocatorName,
+          PersistentHistogramStorage::StorageDirManagement::kUseExisting,
+          temp_dir_path());
+  EXPECT_FALSE(persistent_histogram_storage->is_memory_mapped());
+  EXPECT_TRUE(GlobalHistogramAllocator::Get());
+  EXPECT_FALSE(DirectoryExists(test_storage_dir()));
+}
 #endif  // !defined(OS_NACL) && !defined(OS_IOS)
 
 }  // namespace base
@@ -4,6 +4,7 @@
 
 #include "base/metrics/persistent_sample_map.h"
 
+#include "base/atomicops.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "base/metrics/histogram_macros.h"
@@ -71,11 +72,11 @@ void PersistentSampleMapIterator::Get(Sample* min,
   if (max)
     *max = strict_cast<int64_t>(iter_->first) + 1;
   if (count)
-    *count = *iter_->second;
+    *count = subtle::NoBarrier_Load(iter_->second);
 }
 
 void PersistentSampleMapIterator::SkipEmptyBuckets() {
-  while (!Done() && *iter_->second == 0) {
+  while (!Done() && subtle::NoBarrier_Load(iter_->second) == 0) {
     ++iter_;
   }
 }
@@ -112,17 +113,19 @@ void PersistentSampleMap::Accumulate(Sample value, Count count) {
 #if 0  // TODO(bcwhite) Re-enable efficient version after crbug.com/682680.
   *GetOrCreateSampleCountStorage(value) += count;
 #else
+  // The counts are updated atomically, see AccumulateAtStorage().
   Count* local_count_ptr = GetOrCreateSampleCountStorage(value);
   if (count < 0) {
-    if (*local_count_ptr < -count)
+    if (subtle::NoBarrier_Load(local_count_ptr) < -count)
       RecordNegativeSample(SAMPLES_ACCUMULATE_WENT_NEGATIVE, -count);
     else
       RecordNegativeSample(SAMPLES_ACCUMULATE_NEGATIVE_COUNT, -count);
-    *local_count_ptr += count;
+    subtle::NoBarrier_AtomicIncrement(local_count_ptr, count);
   } else {
-    Sample old_value = *local_count_ptr;
-    Sample new_value = old_value + count;
-    *local_count_ptr = new_value;
+    Sample new_value =
+        subtle::NoBarrier_AtomicIncrement(local_count_ptr, count);
+    Sample old_value = static_cast<Sample>(static_cast<uint32_t>(new_value) -
+                                           static_cast<uint32_t>(count));
     if ((new_value >= 0) != (old_value >= 0))
       RecordNegativeSample(SAMPLES_ACCUMULATE_OVERFLOW, count);
   }
@@ -135,7 +138,7 @@ Count PersistentSampleMap::GetCount(Sample value) const {
   // being able to know what value to return.
   Count* count_pointer =
       const_cast<PersistentSampleMap*>(this)->GetSampleCountStorage(value);
-  return count_pointer ? *count_pointer : 0;
+  return count_pointer ? subtle::NoBarrier_Load(count_pointer) : 0;
 }
 
 Count PersistentSampleMap::TotalCount() const {
@@ -145,7 +148,7 @@ Count PersistentSampleMap::TotalCount() const {
 
   Count count = 0;
   for (const auto& entry : sample_counts_) {
-    count += *entry.second;
+    count += subtle::NoBarrier_Load(entry.second);
   }
   return count;
 }
@@ -203,8 +206,9 @@ bool PersistentSampleMap::AddSubtractImpl(SampleCountIterator* iter,
       continue;
     if (strict_cast<int64_t>(min) + 1 != max)
       return false;  // SparseHistogram only supports bucket with size 1.
-    *GetOrCreateSampleCountStorage(min) +=
-        (op == HistogramSamples::ADD) ? count : -count;
+    subtle::NoBarrier_AtomicIncrement(
+        GetOrCreateSampleCountStorage(min),
+        (op == HistogramSamples::ADD) ? count : -count);
   }
   return true;
 }
@@ -44,6 +44,11 @@ class BASE_EXPORT PersistentSampleMap : public HistogramSamples {
   HistogramBase::Count TotalCount() const override;
   std::unique_ptr<SampleCountIterator> Iterator() const override;
 
+  // Gets a pointer to a "count" corresponding to a given |value|, creating
+  // the sample (initialized to zero) if it does not already exists.
+  HistogramBase::Count* GetOrCreateSampleCountStorage(
+      HistogramBase::Sample value) override;
+
   // Uses a persistent-memory |iterator| to locate and return information about
   // the next record holding information for a PersistentSampleMap. The record
   // could be for any Map so return the |sample_map_id| as well.
@@ -66,11 +71,6 @@ class BASE_EXPORT PersistentSampleMap : public HistogramSamples {
   // if sample does not exist.
   HistogramBase::Count* GetSampleCountStorage(HistogramBase::Sample value);
 
-  // Gets a pointer to a "count" corresponding to a given |value|, creating
-  // the sample (initialized to zero) if it does not already exists.
-  HistogramBase::Count* GetOrCreateSampleCountStorage(
-      HistogramBase::Sample value);
-
  private:
   // Gets the object that manages persistent records. This returns the
   // |records_| member after first initializing it if necessary.
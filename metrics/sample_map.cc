@@ -4,6 +4,7 @@
 
 #include "base/metrics/sample_map.h"
 
+#include "base/atomicops.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "base/numerics/safe_conversions.h"
@@ -66,11 +67,11 @@ void SampleMapIterator::Get(Sample* min, int64_t* max, Count* count) const {
   if (max)
     *max = strict_cast<int64_t>(iter_->first) + 1;
   if (count)
-    *count = iter_->second;
+    *count = subtle::NoBarrier_Load(&iter_->second);
 }
 
 void SampleMapIterator::SkipEmptyBuckets() {
-  while (!Done() && iter_->second == 0) {
+  while (!Done() && subtle::NoBarrier_Load(&iter_->second) == 0) {
     ++iter_;
   }
 }
@@ -86,21 +87,20 @@ SampleMap::~SampleMap() {
 }
 
 void SampleMap::Accumulate(Sample value, Count count) {
-  sample_counts_[value] += count;
-  IncreaseSumAndCount(strict_cast<int64_t>(count) * value, count);
+  AccumulateAtStorage(&sample_counts_[value], value, count);
 }
 
 Count SampleMap::GetCount(Sample value) const {
   std::map<Sample, Count>::const_iterator it = sample_counts_.find(value);
   if (it == sample_counts_.end())
     return 0;
-  return it->second;
+  return subtle::NoBarrier_Load(&it->second);
 }
 
 Count SampleMap::TotalCount() const {
   Count count = 0;
   for (const auto& entry : sample_counts_) {
-    count += entry.second;
+    count += subtle::NoBarrier_Load(&entry.second);
   }
   return count;
 }
@@ -109,6 +109,10 @@ std::unique_ptr<SampleCountIterator> SampleMap::Iterator() const {
   return WrapUnique(new SampleMapIterator(sample_counts_));
 }
 
+Count* SampleMap::GetOrCreateSampleCountStorage(Sample value) {
+  return &sample_counts_[value];
+}
+
 bool SampleMap::AddSubtractImpl(SampleCountIterator* iter, Operator op) {
   Sample min;
   int64_t max;
@@ -118,7 +122,8 @@ bool SampleMap::AddSubtractImpl(SampleCountIterator* iter, Operator op) {
     if (strict_cast<int64_t>(min) + 1 != max)
       return false;  // SparseHistogram only supports bucket with size 1.
 
-    sample_counts_[min] += (op == HistogramSamples::ADD) ? count : -count;
+    subtle::NoBarrier_AtomicIncrement(
+        &sample_counts_[min], (op == HistogramSamples::ADD) ? count : -count);
   }
   return true;
 }
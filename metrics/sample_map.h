@@ -22,6 +22,10 @@ namespace base {
 
 // The logic here is similar to that of PersistentSampleMap but with different
 // data structures. Changes here likely need to be duplicated there.
+//
+// The counts are only updated atomically, and the entries of the map are never
+// removed, so that a count can be updated through its storage without a lock
+// (see HistogramSamples::AccumulateAtStorage()).
 class BASE_EXPORT SampleMap : public HistogramSamples {
  public:
   SampleMap();
@@ -34,6 +38,8 @@ class BASE_EXPORT SampleMap : public HistogramSamples {
   HistogramBase::Count GetCount(HistogramBase::Sample value) const override;
   HistogramBase::Count TotalCount() const override;
   std::unique_ptr<SampleCountIterator> Iterator() const override;
+  HistogramBase::Count* GetOrCreateSampleCountStorage(
+      HistogramBase::Sample value) override;
 
  protected:
   // Performs arithemetic. |op| is ADD or SUBTRACT.
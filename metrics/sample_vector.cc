@@ -23,6 +23,24 @@ namespace base {
 typedef HistogramBase::Count Count;
 typedef HistogramBase::Sample Sample;
 
+namespace {
+
+// Returns true if more than one of the |size| |counts| is non-zero.
+bool HasMultipleNonEmptyBuckets(const HistogramBase::AtomicCount* counts,
+                                size_t size) {
+  bool found = false;
+  for (size_t i = 0; i < size; ++i) {
+    if (subtle::NoBarrier_Load(&counts[i]) != 0) {
+      if (found)
+        return true;
+      found = true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
 SampleVectorBase::SampleVectorBase(uint64_t id,
                                    Metadata* meta,
                                    const BucketRanges* bucket_ranges)
@@ -125,12 +143,67 @@ std::unique_ptr<SampleCountIterator> SampleVectorBase::Iterator() const {
   return std::make_unique<SampleVectorIterator>(nullptr, 0, bucket_ranges_);
 }
 
+bool SampleVectorBase::MoveSamplesTo(SampleVectorBase* dest) {
+  DCHECK(bucket_ranges_ == dest->bucket_ranges_ ||
+         bucket_ranges_->Equals(dest->bucket_ranges_));
+
+  // Once the single-sample is disabled, all samples go to the counts array.
+  if (!single_sample().IsDisabled())
+    return false;
+  if (!counts() && !MountExistingCountsStorage())
+    return false;
+
+  int64_t sum;
+  Count count;
+  ExtractSumAndCount(&sum, &count);
+  dest->IncreaseSumAndCount(sum, count);
+
+  HistogramBase::AtomicCount* counts_array = counts();
+  HistogramBase::AtomicCount* dest_counts = nullptr;
+  const size_t size = counts_size();
+  for (size_t i = 0; i < size; ++i) {
+    if (subtle::NoBarrier_Load(&counts_array[i]) == 0)
+      continue;
+    // Only mount the counts storage of |dest| when there's something to move.
+    if (!dest_counts) {
+      dest->MountCountsStorageAndMoveSingleSample();
+      dest_counts = dest->counts();
+    }
+    subtle::NoBarrier_AtomicIncrement(
+        &dest_counts[i], subtle::NoBarrier_AtomicExchange(&counts_array[i], 0));
+  }
+  return true;
+}
+
 bool SampleVectorBase::AddSubtractImpl(SampleCountIterator* iter,
                                        HistogramSamples::Operator op) {
   // Stop now if there's nothing to do.
   if (iter->Done())
     return true;
 
+  // A counts array over the same buckets, such as that of another
+  // SampleVector, is merged index by index without looking up the bucket of
+  // each sample. A lone sample still goes to the single-sample below.
+  size_t src_size;
+  const BucketRanges* src_ranges;
+  const HistogramBase::AtomicCount* src_counts =
+      iter->GetCountsArray(&src_size, &src_ranges);
+  if (src_counts && src_size == counts_size() &&
+      (src_ranges == bucket_ranges_ || src_ranges->Equals(bucket_ranges_)) &&
+      (counts() || HasMultipleNonEmptyBuckets(src_counts, src_size))) {
+    if (!counts())
+      MountCountsStorageAndMoveSingleSample();
+    HistogramBase::AtomicCount* dest_counts = counts();
+    for (size_t i = 0; i < src_size; ++i) {
+      Count count = subtle::NoBarrier_Load(&src_counts[i]);
+      if (count == 0)
+        continue;
+      subtle::NoBarrier_AtomicIncrement(
+          &dest_counts[i], op == HistogramSamples::ADD ? count : -count);
+    }
+    return true;
+  }
+
   // Get the first value and its index.
   HistogramBase::Sample min;
   int64_t max;
@@ -220,23 +293,10 @@ size_t SampleVectorBase::GetBucketIndex(Sample value) const {
   CHECK_GE(value, bucket_ranges_->range(0));
   CHECK_LT(value, bucket_ranges_->range(bucket_count));
 
-  size_t under = 0;
-  size_t over = bucket_count;
-  size_t mid;
-  do {
-    DCHECK_GE(over, under);
-    mid = under + (over - under)/2;
-    if (mid == under)
-      break;
-    if (bucket_ranges_->range(mid) <= value)
-      under = mid;
-    else
-      over = mid;
-  } while (true);
-
-  DCHECK_LE(bucket_ranges_->range(mid), value);
-  CHECK_GT(bucket_ranges_->range(mid + 1), value);
-  return mid;
+  const size_t bucket_index = bucket_ranges_->GetBucketIndex(value);
+  DCHECK_LE(bucket_ranges_->range(bucket_index), value);
+  CHECK_GT(bucket_ranges_->range(bucket_index + 1), value);
+  return bucket_index;
 }
 
 void SampleVectorBase::MoveSingleSampleToCounts() {
@@ -415,6 +475,14 @@ bool SampleVectorIterator::GetBucketIndex(size_t* index) const {
   return true;
 }
 
+const HistogramBase::AtomicCount* SampleVectorIterator::GetCountsArray(
+    size_t* size,
+    const BucketRanges** bucket_ranges) const {
+  *size = counts_size_;
+  *bucket_ranges = bucket_ranges_;
+  return counts_;
+}
+
 void SampleVectorIterator::SkipEmptyBuckets() {
   if (Done())
     return;
@@ -47,6 +47,12 @@ class BASE_EXPORT SampleVectorBase : public HistogramSamples {
   // Access the bucket ranges held externally.
   const BucketRanges* bucket_ranges() const { return bucket_ranges_; }
 
+  // Moves all the samples to |dest|, which must have the same bucket ranges,
+  // by atomically exchanging each count with zero so that samples accumulated
+  // concurrently are neither lost nor moved twice. Returns false, without
+  // moving anything, if the samples aren't held in the counts array yet.
+  bool MoveSamplesTo(SampleVectorBase* dest);
+
  protected:
   bool AddSubtractImpl(
       SampleCountIterator* iter,
@@ -170,6 +176,10 @@ class BASE_EXPORT SampleVectorIterator : public SampleCountIterator {
   // SampleVector uses predefined buckets, so iterator can return bucket index.
   bool GetBucketIndex(size_t* index) const override;
 
+  const HistogramBase::AtomicCount* GetCountsArray(
+      size_t* size,
+      const BucketRanges** bucket_ranges) const override;
+
  private:
   void SkipEmptyBuckets();
 
@@ -127,6 +127,94 @@ TEST_F(SampleVectorTest, AddSubtract) {
   EXPECT_EQ(samples1.redundant_count(), samples1.TotalCount());
 }
 
+TEST_F(SampleVectorTest, AddSubtractCountsArray) {
+  // Two equal but distinct sets of custom buckets: [1, 5) [5, 10) [10, 20)
+  BucketRanges ranges1(4);
+  BucketRanges ranges2(4);
+  for (BucketRanges* ranges : {&ranges1, &ranges2}) {
+    ranges->set_range(0, 1);
+    ranges->set_range(1, 5);
+    ranges->set_range(2, 10);
+    ranges->set_range(3, 20);
+    ranges->ResetChecksum();
+  }
+
+  SampleVector samples1(1, &ranges1);
+  samples1.Accumulate(1, 100);
+  samples1.Accumulate(15, 300);
+  ASSERT_TRUE(GetSamplesCounts(samples1));
+
+  // Counts arrays are merged as a whole, including into an empty vector.
+  SampleVector samples2(2, &ranges2);
+  samples2.Add(samples1);
+  EXPECT_TRUE(GetSamplesCounts(samples2));
+  EXPECT_EQ(100, samples2.GetCountAtIndex(0));
+  EXPECT_EQ(0, samples2.GetCountAtIndex(1));
+  EXPECT_EQ(300, samples2.GetCountAtIndex(2));
+  EXPECT_EQ(100 + 15 * 300, samples2.sum());
+  EXPECT_EQ(400, samples2.TotalCount());
+  EXPECT_EQ(samples2.redundant_count(), samples2.TotalCount());
+
+  samples2.Add(samples1);
+  samples2.Subtract(samples1);
+  EXPECT_EQ(100, samples2.GetCountAtIndex(0));
+  EXPECT_EQ(300, samples2.GetCountAtIndex(2));
+  EXPECT_EQ(samples2.redundant_count(), samples2.TotalCount());
+
+  // A counts array holding a lone sample still merges into a single-sample.
+  samples1.Subtract(samples2);
+  samples1.Accumulate(7, 50);
+  ASSERT_TRUE(GetSamplesCounts(samples1));
+  SampleVector samples3(3, &ranges2);
+  samples3.Add(samples1);
+  EXPECT_FALSE(GetSamplesCounts(samples3));
+  EXPECT_EQ(50, samples3.GetCountAtIndex(1));
+  EXPECT_EQ(7 * 50, samples3.sum());
+  EXPECT_EQ(50, samples3.redundant_count());
+}
+
+TEST_F(SampleVectorTest, MoveSamplesTo) {
+  // Custom buckets: [1, 5) [5, 10)
+  BucketRanges ranges(3);
+  ranges.set_range(0, 1);
+  ranges.set_range(1, 5);
+  ranges.set_range(2, 10);
+  SampleVector samples(1, &ranges);
+
+  // Nothing moves while the samples may still be in the single-sample.
+  SampleVector dest(2, &ranges);
+  EXPECT_FALSE(samples.MoveSamplesTo(&dest));
+  samples.Accumulate(3, 200);
+  EXPECT_FALSE(samples.MoveSamplesTo(&dest));
+  EXPECT_EQ(200, samples.TotalCount());
+  EXPECT_EQ(0, dest.TotalCount());
+
+  samples.Accumulate(8, 100);
+  EXPECT_TRUE(samples.MoveSamplesTo(&dest));
+  EXPECT_EQ(0, samples.GetCountAtIndex(0));
+  EXPECT_EQ(0, samples.GetCountAtIndex(1));
+  EXPECT_EQ(0, samples.sum());
+  EXPECT_EQ(0, samples.redundant_count());
+  EXPECT_EQ(200, dest.GetCountAtIndex(0));
+  EXPECT_EQ(100, dest.GetCountAtIndex(1));
+  EXPECT_EQ(3 * 200 + 8 * 100, dest.sum());
+  EXPECT_EQ(300, dest.redundant_count());
+
+  // Moving again adds only the samples accumulated since.
+  samples.Accumulate(9, 10);
+  EXPECT_TRUE(samples.MoveSamplesTo(&dest));
+  EXPECT_EQ(0, samples.TotalCount());
+  EXPECT_EQ(110, dest.GetCountAtIndex(1));
+  EXPECT_EQ(3 * 200 + 8 * 100 + 9 * 10, dest.sum());
+  EXPECT_EQ(310, dest.redundant_count());
+
+  // An empty counts array doesn't allocate the counts of the destination.
+  SampleVector empty_dest(3, &ranges);
+  EXPECT_TRUE(samples.MoveSamplesTo(&empty_dest));
+  EXPECT_FALSE(GetSamplesCounts(empty_dest));
+  EXPECT_EQ(0, empty_dest.redundant_count());
+}
+
 TEST_F(SampleVectorTest, BucketIndexDeath) {
   // 8 buckets with exponential layout:
   // [0, 1) [1, 2) [2, 4) [4, 8) [8, 16) [16, 32) [32, 64) [64, INT_MAX)
@@ -16,12 +16,24 @@
 #include "base/pickle.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/lock.h"
+#include "build/build_config.h"
 
 namespace base {
 
 typedef HistogramBase::Count Count;
 typedef HistogramBase::Sample Sample;
 
+namespace {
+
+#if defined(ARCH_CPU_64_BITS)
+// Returns a hash of |value| of |bits| bits.
+size_t HashSample(Sample value, size_t bits) {
+  return (static_cast<uint32_t>(value) * 0x9E3779B9u) >> (32 - bits);
+}
+#endif
+
+}  // namespace
+
 // static
 HistogramBase* SparseHistogram::FactoryGet(const std::string& name,
                                            int32_t flags) {
@@ -112,9 +124,13 @@ void SparseHistogram::AddCount(Sample value, int count) {
     NOTREACHED();
     return;
   }
-  {
+  Count* storage = FindCachedCountStorage(value);
+  if (storage) {
+    unlogged_samples_->AccumulateAtStorage(storage, value, count);
+  } else {
     base::AutoLock auto_lock(lock_);
     unlogged_samples_->Accumulate(value, count);
+    CacheCountStorage(value);
   }
 
   FindAndRunCallback(value);
@@ -141,6 +157,11 @@ std::unique_ptr<HistogramSamples> SparseHistogram::SnapshotDelta() {
   return std::move(snapshot);
 }
 
+bool SparseHistogram::HasUnloggedSamples() const {
+  // The count is atomic, so reading it doesn't need the lock.
+  return unlogged_samples_->redundant_count() != 0;
+}
+
 std::unique_ptr<HistogramSamples> SparseHistogram::SnapshotFinalDelta() const {
   DCHECK(!final_delta_created_);
   final_delta_created_ = true;
@@ -203,6 +224,44 @@ SparseHistogram::SparseHistogram(PersistentHistogramAllocator* allocator,
                                               allocator,
                                               logged_meta)) {}
 
+Count* SparseHistogram::FindCachedCountStorage(Sample value) const {
+#if defined(ARCH_CPU_64_BITS)
+  const size_t mask = arraysize(count_storage_cache_) - 1;
+  const size_t index = HashSample(value, kCountStorageCacheBits);
+  for (size_t i = 0; i < arraysize(count_storage_cache_); ++i) {
+    const CountStorageEntry& entry = count_storage_cache_[(index + i) & mask];
+    Count* storage = entry.storage.load(std::memory_order_acquire);
+    if (!storage)
+      return nullptr;
+    if (entry.value.load(std::memory_order_relaxed) == value)
+      return storage;
+  }
+#endif
+  return nullptr;
+}
+
+void SparseHistogram::CacheCountStorage(Sample value) {
+#if defined(ARCH_CPU_64_BITS)
+  lock_.AssertAcquired();
+  const size_t mask = arraysize(count_storage_cache_) - 1;
+  const size_t index = HashSample(value, kCountStorageCacheBits);
+  for (size_t i = 0; i < arraysize(count_storage_cache_); ++i) {
+    CountStorageEntry& entry = count_storage_cache_[(index + i) & mask];
+    if (entry.storage.load(std::memory_order_relaxed)) {
+      if (entry.value.load(std::memory_order_relaxed) == value)
+        return;
+      continue;
+    }
+    Count* storage = unlogged_samples_->GetOrCreateSampleCountStorage(value);
+    if (!storage)
+      return;
+    entry.value.store(value, std::memory_order_relaxed);
+    entry.storage.store(storage, std::memory_order_release);
+    return;
+  }
+#endif
+}
+
 HistogramBase* SparseHistogram::DeserializeInfoImpl(PickleIterator* iter) {
   std::string histogram_name;
   int flags;
@@ -8,6 +8,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -53,6 +54,7 @@ class BASE_EXPORT SparseHistogram : public HistogramBase {
   bool AddSamplesFromPickle(base::PickleIterator* iter) override;
   std::unique_ptr<HistogramSamples> SnapshotSamples() const override;
   std::unique_ptr<HistogramSamples> SnapshotDelta() override;
+  bool HasUnloggedSamples() const override;
   std::unique_ptr<HistogramSamples> SnapshotFinalDelta() const override;
   void WriteHTMLGraph(std::string* output) const override;
   void WriteAscii(std::string* output) const override;
@@ -88,6 +90,14 @@ class BASE_EXPORT SparseHistogram : public HistogramBase {
   void WriteAsciiHeader(const Count total_count,
                         std::string* output) const;
 
+  // Returns the storage of the count of |value| in |unlogged_samples_| if it
+  // is in |count_storage_cache_|, or null.
+  Count* FindCachedCountStorage(Sample value) const;
+
+  // Adds the storage of the count of |value| in |unlogged_samples_| to
+  // |count_storage_cache_|, if there is room. Must be called with |lock_|.
+  void CacheCountStorage(Sample value);
+
   // For constuctor calling.
   friend class SparseHistogramTest;
 
@@ -100,6 +110,19 @@ class BASE_EXPORT SparseHistogram : public HistogramBase {
   std::unique_ptr<HistogramSamples> unlogged_samples_;
   std::unique_ptr<HistogramSamples> logged_samples_;
 
+  // The storage of the counts of the first values recorded, so that recording
+  // them again takes no lock, nor a lookup in the sample map. This is an
+  // open-addressing hash table which is only added to, with |lock_|, and read
+  // without it: the |storage| of an entry is published after its |value|, and
+  // the lookups stop at the first empty entry. Only used on 64-bit platforms,
+  // see HistogramSamples::AccumulateAtStorage().
+  struct CountStorageEntry {
+    std::atomic<Sample> value{0};
+    std::atomic<Count*> storage{nullptr};
+  };
+  static constexpr size_t kCountStorageCacheBits = 4;
+  CountStorageEntry count_storage_cache_[1 << kCountStorageCacheBits];
+
   DISALLOW_COPY_AND_ASSIGN(SparseHistogram);
 };
 
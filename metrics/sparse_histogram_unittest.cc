@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/metrics/histogram_base.h"
 #include "base/metrics/histogram_functions.h"
@@ -17,6 +18,7 @@
 #include "base/metrics/statistics_recorder.h"
 #include "base/pickle.h"
 #include "base/strings/stringprintf.h"
+#include "base/threading/simple_thread.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -109,6 +111,105 @@ TEST_P(SparseHistogramTest, BasicTest) {
   EXPECT_EQ(1, snapshot2->GetCount(101));
 }
 
+TEST_P(SparseHistogramTest, DeltaTest) {
+  std::unique_ptr<SparseHistogram> histogram(NewSparseHistogram("Sparse"));
+  EXPECT_FALSE(histogram->HasUnloggedSamples());
+
+  histogram->Add(100);
+  histogram->Add(101);
+  EXPECT_TRUE(histogram->HasUnloggedSamples());
+  std::unique_ptr<HistogramSamples> snapshot(histogram->SnapshotDelta());
+  EXPECT_EQ(2, snapshot->TotalCount());
+  EXPECT_FALSE(histogram->HasUnloggedSamples());
+
+  histogram->Add(100);
+  EXPECT_TRUE(histogram->HasUnloggedSamples());
+  snapshot = histogram->SnapshotDelta();
+  EXPECT_EQ(1, snapshot->TotalCount());
+  EXPECT_EQ(1, snapshot->GetCount(100));
+}
+
+TEST_P(SparseHistogramTest, ManyValues) {
+  // More values than the counts cached for recording without the lock.
+  constexpr int kNumValues = 100;
+  std::unique_ptr<SparseHistogram> histogram(NewSparseHistogram("Sparse"));
+  for (int i = 0; i < 3; ++i) {
+    for (int value = -kNumValues / 2; value < kNumValues / 2; ++value)
+      histogram->AddCount(value, 2);
+  }
+  std::unique_ptr<HistogramSamples> snapshot(histogram->SnapshotDelta());
+  EXPECT_EQ(3 * 2 * kNumValues, snapshot->TotalCount());
+  EXPECT_EQ(3 * 2 * kNumValues, snapshot->redundant_count());
+  EXPECT_EQ(3 * 2 * (-kNumValues / 2), snapshot->sum());
+  for (int value = -kNumValues / 2; value < kNumValues / 2; ++value)
+    EXPECT_EQ(6, snapshot->GetCount(value));
+
+  histogram->Add(0);
+  histogram->Add(kNumValues);
+  snapshot = histogram->SnapshotDelta();
+  EXPECT_EQ(2, snapshot->TotalCount());
+  EXPECT_EQ(1, snapshot->GetCount(0));
+  EXPECT_EQ(1, snapshot->GetCount(kNumValues));
+  EXPECT_EQ(3 * 2 * kNumValues + 2,
+            histogram->SnapshotSamples()->TotalCount());
+}
+
+namespace {
+
+// Adds the values [0, |num_values|) to a histogram, |num_samples| times in all.
+class AddSamplesDelegate : public DelegateSimpleThread::Delegate {
+ public:
+  AddSamplesDelegate(HistogramBase* histogram, int num_values, int num_samples)
+      : histogram_(histogram),
+        num_values_(num_values),
+        num_samples_(num_samples) {}
+  ~AddSamplesDelegate() override = default;
+
+  void Run() override {
+    for (int i = 0; i < num_samples_; ++i)
+      histogram_->Add(i % num_values_);
+  }
+
+ private:
+  HistogramBase* const histogram_;
+  const int num_values_;
+  const int num_samples_;
+
+  DISALLOW_COPY_AND_ASSIGN(AddSamplesDelegate);
+};
+
+}  // namespace
+
+TEST_P(SparseHistogramTest, Threads) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumValues = 40;
+  constexpr int kNumSamples = 10000;
+  std::unique_ptr<SparseHistogram> histogram(NewSparseHistogram("Sparse"));
+
+  AddSamplesDelegate delegate(histogram.get(), kNumValues, kNumSamples);
+  std::vector<std::unique_ptr<DelegateSimpleThread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(std::make_unique<DelegateSimpleThread>(
+        &delegate, StringPrintf("SparseHistogramThreads%d", i)));
+    threads.back()->Start();
+  }
+  // Snapshots taken while samples are being added don't lose any.
+  int64_t total_count = 0;
+  for (int i = 0; i < 10; ++i)
+    total_count += histogram->SnapshotDelta()->TotalCount();
+  for (const auto& thread : threads)
+    thread->Join();
+  total_count += histogram->SnapshotDelta()->TotalCount();
+
+  EXPECT_EQ(kNumThreads * kNumSamples, total_count);
+  std::unique_ptr<HistogramSamples> snapshot(histogram->SnapshotSamples());
+  EXPECT_EQ(kNumThreads * kNumSamples, snapshot->TotalCount());
+  EXPECT_EQ(kNumThreads * kNumSamples, snapshot->redundant_count());
+  for (int value = 0; value < kNumValues; ++value)
+    EXPECT_EQ(kNumThreads * kNumSamples / kNumValues,
+              snapshot->GetCount(value));
+}
+
 TEST_P(SparseHistogramTest, BasicTestAddCount) {
   std::unique_ptr<SparseHistogram> histogram(NewSparseHistogram("Sparse"));
   std::unique_ptr<HistogramSamples> snapshot(histogram->SnapshotSamples());
@@ -4,10 +4,12 @@
 
 #include "base/metrics/statistics_recorder.h"
 
+#include <atomic>
 #include <memory>
 
 #include "base/at_exit.h"
 #include "base/debug/leak_annotations.h"
+#include "base/hash.h"
 #include "base/json/string_escape.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
@@ -28,6 +30,22 @@ bool HistogramNameLesser(const base::HistogramBase* a,
   return strcmp(a->histogram_name(), b->histogram_name()) < 0;
 }
 
+// The number of entries of the cache of FindHistogram(). A power of 2.
+constexpr size_t kLookupCacheSize = 1024;
+
+// A direct-mapped cache of the histograms found by FindHistogram(), indexed by
+// a hash of their name, so that recording to the histograms whose name is only
+// known at runtime (e.g. with UmaHistogramCounts1000()) usually takes no lock.
+// The entries are written while holding the lock and read without it. The
+// histograms are never deleted once registered, and the tests which forget
+// them clear the cache.
+std::atomic<HistogramBase*> g_lookup_cache[kLookupCacheSize];
+
+std::atomic<HistogramBase*>& GetLookupCacheEntry(StringPiece name) {
+  return g_lookup_cache[Hash(name.data(), name.size()) &
+                        (kLookupCacheSize - 1)];
+}
+
 }  // namespace
 
 // static
@@ -54,6 +72,7 @@ StatisticsRecorder::~StatisticsRecorder() {
   const AutoLock auto_lock(lock_.Get());
   DCHECK_EQ(this, top_);
   top_ = previous_;
+  ClearLookupCacheWhileLocked();
 }
 
 // static
@@ -186,6 +205,14 @@ std::vector<const BucketRanges*> StatisticsRecorder::GetBucketRanges() {
 
 // static
 HistogramBase* StatisticsRecorder::FindHistogram(base::StringPiece name) {
+  // A histogram registered locally needs neither the lock nor the import of
+  // the histograms of other processes. The name is compared since the entry
+  // may be that of another histogram with the same hash.
+  std::atomic<HistogramBase*>& cache_entry = GetLookupCacheEntry(name);
+  HistogramBase* const cached = cache_entry.load(std::memory_order_acquire);
+  if (cached && name == cached->histogram_name())
+    return cached;
+
   // This must be called *before* the lock is acquired below because it will
   // call back into this object to register histograms. Those called methods
   // will acquire the lock at that time.
@@ -195,7 +222,10 @@ HistogramBase* StatisticsRecorder::FindHistogram(base::StringPiece name) {
   EnsureGlobalRecorderWhileLocked();
 
   const HistogramMap::const_iterator it = top_->histograms_.find(name);
-  return it != top_->histograms_.end() ? it->second : nullptr;
+  if (it == top_->histograms_.end())
+    return nullptr;
+  cache_entry.store(it->second, std::memory_order_release);
+  return it->second;
 }
 
 // static
@@ -302,6 +332,7 @@ void StatisticsRecorder::ForgetHistogramForTesting(base::StringPiece name) {
   }
 
   top_->histograms_.erase(found);
+  ClearLookupCacheWhileLocked();
 }
 
 // static
@@ -396,9 +427,17 @@ StatisticsRecorder::StatisticsRecorder() {
   lock_.Get().AssertAcquired();
   previous_ = top_;
   top_ = this;
+  ClearLookupCacheWhileLocked();
   InitLogOnShutdownWhileLocked();
 }
 
+// static
+void StatisticsRecorder::ClearLookupCacheWhileLocked() {
+  lock_.Get().AssertAcquired();
+  for (std::atomic<HistogramBase*>& entry : g_lookup_cache)
+    entry.store(nullptr, std::memory_order_relaxed);
+}
+
 // static
 void StatisticsRecorder::InitLogOnShutdownWhileLocked() {
   lock_.Get().AssertAcquired();
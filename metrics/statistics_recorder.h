@@ -125,7 +125,8 @@ class BASE_EXPORT StatisticsRecorder {
   // Finds a histogram by name. Matches the exact name. Returns a null pointer
   // if a matching histogram is not found.
   //
-  // This method is thread safe.
+  // This method is thread safe. The histograms found recently are usually
+  // found again without taking the lock.
   static HistogramBase* FindHistogram(base::StringPiece name);
 
   // Imports histograms from providers.
@@ -267,6 +268,12 @@ class BASE_EXPORT StatisticsRecorder {
   // Precondition: The global lock is already acquired.
   StatisticsRecorder();
 
+  // Clears the cache of FindHistogram(), when the histograms of the current
+  // recorder change other than by being registered.
+  //
+  // Precondition: The global lock is already acquired.
+  static void ClearLookupCacheWhileLocked();
+
   // Initialize implementation but without lock. Caller should guard
   // StatisticsRecorder by itself if needed (it isn't in unit tests).
   //
@@ -258,6 +258,29 @@ TEST_P(StatisticsRecorderTest, FindHistogram) {
   EXPECT_FALSE(StatisticsRecorder::FindHistogram("TestHistogram"));
 }
 
+TEST_P(StatisticsRecorderTest, FindHistogramCached) {
+  HistogramBase* histogram = Histogram::FactoryGet(
+      "TestHistogram", 1, 1000, 10, HistogramBase::kNoFlags);
+
+  // The second lookup is served by the cache.
+  EXPECT_EQ(histogram, StatisticsRecorder::FindHistogram("TestHistogram"));
+  EXPECT_EQ(histogram, StatisticsRecorder::FindHistogram("TestHistogram"));
+  EXPECT_FALSE(StatisticsRecorder::FindHistogram("TestHistogram2"));
+
+  // Forgotten histograms aren't found anymore.
+  StatisticsRecorder::ForgetHistogramForTesting("TestHistogram");
+  EXPECT_FALSE(StatisticsRecorder::FindHistogram("TestHistogram"));
+
+  // Neither are the histograms of a previous recorder.
+  HistogramBase* histogram2 = Histogram::FactoryGet(
+      "TestHistogram2", 1, 1000, 10, HistogramBase::kNoFlags);
+  EXPECT_EQ(histogram2, StatisticsRecorder::FindHistogram("TestHistogram2"));
+  std::unique_ptr<StatisticsRecorder> recorder =
+      StatisticsRecorder::CreateTemporaryForTesting();
+  if (!use_persistent_histogram_allocator_)
+    EXPECT_FALSE(StatisticsRecorder::FindHistogram("TestHistogram2"));
+}
+
 TEST_P(StatisticsRecorderTest, WithName) {
   Histogram::FactoryGet("TestHistogram1", 1, 1000, 10, Histogram::kNoFlags);
   Histogram::FactoryGet("TestHistogram2", 1, 1000, 10, Histogram::kNoFlags);
@@ -0,0 +1,252 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/native_library_preloader.h"
+
+#include <stddef.h>
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/logging.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/task_scheduler/post_task.h"
+#include "base/threading/thread_restrictions.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+// Loads the library at |path|, after reading its file in with the mapping of
+// the file which populates it, unlike the mappings by the dynamic loader which
+// take a page fault for each page they touch.
+NativeLibrary LoadNativeLibraryWithPrefetch(const FilePath& path,
+                                            NativeLibraryLoadError* error) {
+  {
+    // This fails harmlessly for library names looked up in the search path,
+    // and for bundles, which are loaded without the prefetch.
+    MemoryMappedFile::Options options;
+    options.populate = true;
+    MemoryMappedFile file;
+    file.Initialize(path, MemoryMappedFile::READ_ONLY, options);
+  }
+  return LoadNativeLibrary(path, error);
+}
+
+}  // namespace
+
+class NativeLibraryPreloader::State : public RefCountedThreadSafe<State> {
+ public:
+  State() : loaded_cv_(&lock_) {}
+
+  void Preload(const FilePath& library_path,
+               const std::vector<FilePath>& dependencies) {
+    AutoLock auto_lock(lock_);
+    DCHECK_EQ(kNotFound, FindLibraryLockRequired(library_path))
+        << library_path.value() << " was preloaded twice";
+    const size_t index = libraries_.size();
+    libraries_.emplace_back(library_path);
+    for (const FilePath& dependency_path : dependencies) {
+      const size_t dependency = FindLibraryLockRequired(dependency_path);
+      DCHECK_NE(kNotFound, dependency)
+          << dependency_path.value() << " must be preloaded before "
+          << library_path.value();
+      if (dependency == kNotFound)
+        continue;
+      libraries_[index].dependencies.push_back(dependency);
+      if (!libraries_[dependency].IsLoaded()) {
+        ++libraries_[index].pending_dependencies;
+        libraries_[dependency].dependents.push_back(index);
+      }
+    }
+    if (libraries_[index].pending_dependencies == 0)
+      PostLoadTaskLockRequired(index);
+  }
+
+  NativeLibrary TakeLibrary(const FilePath& library_path,
+                            NativeLibraryLoadError* error) {
+    AssertBlockingAllowed();
+    AutoLock auto_lock(lock_);
+    const size_t index = FindLibraryLockRequired(library_path);
+    if (index == kNotFound) {
+      AutoUnlock auto_unlock(lock_);
+      return LoadNativeLibrary(library_path, error);
+    }
+    EnsureLoadedLockRequired(index);
+
+    Library& library = libraries_[index];
+    DCHECK_NE(Status::TAKEN, library.status)
+        << library_path.value() << " was taken twice";
+    library.status = Status::TAKEN;
+    if (!library.library && error)
+      *error = library.error;
+    return std::exchange(library.library, nullptr);
+  }
+
+  // Unloads the libraries which weren't taken, and those which finish loading
+  // from now on.
+  void Abandon() {
+    std::vector<NativeLibrary> libraries_to_unload;
+    {
+      AutoLock auto_lock(lock_);
+      abandoned_ = true;
+      // Dependents come after their dependencies.
+      for (auto it = libraries_.rbegin(); it != libraries_.rend(); ++it) {
+        if (it->status == Status::LOADED && it->library)
+          libraries_to_unload.push_back(std::exchange(it->library, nullptr));
+      }
+    }
+    for (NativeLibrary library : libraries_to_unload)
+      UnloadNativeLibrary(library);
+  }
+
+ private:
+  friend class RefCountedThreadSafe<State>;
+
+  enum class Status {
+    // Waiting for dependencies to load.
+    WAITING,
+    // A task to load the library was posted.
+    QUEUED,
+    LOADING,
+    LOADED,
+    TAKEN,
+  };
+
+  struct Library {
+    explicit Library(const FilePath& path) : path(path) {}
+
+    bool IsLoaded() const {
+      return status == Status::LOADED || status == Status::TAKEN;
+    }
+
+    const FilePath path;
+    Status status = Status::WAITING;
+    NativeLibrary library = nullptr;
+    NativeLibraryLoadError error;
+    // Indices of the libraries this one depends on, and of those depending on
+    // it which are still waiting for it.
+    std::vector<size_t> dependencies;
+    std::vector<size_t> dependents;
+    size_t pending_dependencies = 0;
+  };
+
+  ~State() = default;
+
+  size_t FindLibraryLockRequired(const FilePath& library_path) const {
+    lock_.AssertAcquired();
+    for (size_t index = 0; index < libraries_.size(); ++index) {
+      if (libraries_[index].path == library_path)
+        return index;
+    }
+    return kNotFound;
+  }
+
+  void PostLoadTaskLockRequired(size_t index) {
+    lock_.AssertAcquired();
+    DCHECK_EQ(Status::WAITING, libraries_[index].status);
+    libraries_[index].status = Status::QUEUED;
+    PostTaskWithTraits(FROM_HERE,
+                       {MayBlock(), TaskPriority::USER_BLOCKING,
+                        TaskShutdownBehavior::SKIP_ON_SHUTDOWN},
+                       BindOnce(&State::RunLoadTask, this, index));
+  }
+
+  void RunLoadTask(size_t index) {
+    AutoLock auto_lock(lock_);
+    // The library may have been loaded by TakeLibrary() meanwhile.
+    if (libraries_[index].status != Status::QUEUED || abandoned_)
+      return;
+    LoadLockRequired(index);
+  }
+
+  // Loads the library at |index|, releasing the lock meanwhile.
+  void LoadLockRequired(size_t index) {
+    lock_.AssertAcquired();
+    libraries_[index].status = Status::LOADING;
+    const FilePath path = libraries_[index].path;
+
+    NativeLibraryLoadError error;
+    NativeLibrary library;
+    {
+      AutoUnlock auto_unlock(lock_);
+      library = LoadNativeLibraryWithPrefetch(path, &error);
+    }
+
+    if (abandoned_ && library) {
+      AutoUnlock auto_unlock(lock_);
+      UnloadNativeLibrary(library);
+      library = nullptr;
+    }
+    // |libraries_| may have grown while the lock was released.
+    Library& loaded = libraries_[index];
+    loaded.status = Status::LOADED;
+    loaded.library = library;
+    loaded.error = std::move(error);
+    for (size_t dependent : loaded.dependents) {
+      DCHECK_LT(0u, libraries_[dependent].pending_dependencies);
+      if (--libraries_[dependent].pending_dependencies == 0 &&
+          libraries_[dependent].status == Status::WAITING && !abandoned_) {
+        PostLoadTaskLockRequired(dependent);
+      }
+    }
+    libraries_[index].dependents.clear();
+    loaded_cv_.Broadcast();
+  }
+
+  // Returns once the library at |index| is loaded, loading it and its
+  // dependencies on the current thread if no task started to.
+  void EnsureLoadedLockRequired(size_t index) {
+    lock_.AssertAcquired();
+    // Dependencies have lower indices, so this terminates.
+    for (size_t i = 0; i < libraries_[index].dependencies.size(); ++i)
+      EnsureLoadedLockRequired(libraries_[index].dependencies[i]);
+
+    const Status status = libraries_[index].status;
+    if (status == Status::WAITING || status == Status::QUEUED)
+      LoadLockRequired(index);
+    while (libraries_[index].status == Status::LOADING)
+      loaded_cv_.Wait();
+  }
+
+  mutable Lock lock_;
+  ConditionVariable loaded_cv_;
+
+  // The libraries in the order they were preloaded, in which they depend on
+  // each other.
+  std::vector<Library> libraries_;
+
+  bool abandoned_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(State);
+};
+
+NativeLibraryPreloader::NativeLibraryPreloader() : state_(new State) {}
+
+NativeLibraryPreloader::~NativeLibraryPreloader() {
+  state_->Abandon();
+}
+
+void NativeLibraryPreloader::Preload(const FilePath& library_path) {
+  state_->Preload(library_path, std::vector<FilePath>());
+}
+
+void NativeLibraryPreloader::Preload(
+    const FilePath& library_path,
+    const std::vector<FilePath>& dependencies) {
+  state_->Preload(library_path, dependencies);
+}
+
+NativeLibrary NativeLibraryPreloader::TakeLibrary(
+    const FilePath& library_path,
+    NativeLibraryLoadError* error) {
+  return state_->TakeLibrary(library_path, error);
+}
+
+}  // namespace base
@@ -0,0 +1,73 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_NATIVE_LIBRARY_PRELOADER_H_
+#define BASE_NATIVE_LIBRARY_PRELOADER_H_
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/native_library.h"
+
+namespace base {
+
+class FilePath;
+
+// Loads native libraries concurrently on TaskScheduler workers, so that the
+// time spent reading them from disk and relocating them overlaps, e.g. when
+// loading many plugins at startup. The files of the libraries are read in
+// before loading them, so that loading doesn't wait on page faults for each
+// page it touches.
+//
+// A library is loaded after the libraries it was given as dependencies, e.g.
+// plugins which use symbols of other plugins. TakeLibrary() returns a library
+// once it's loaded, loading it and its dependencies on the calling thread if
+// no worker started to yet, so it never waits on tasks which haven't run.
+//
+// Example:
+//
+//   NativeLibraryPreloader preloader;
+//   preloader.Preload(core_path);
+//   preloader.Preload(plugin_path, {core_path});
+//   ...
+//   ScopedNativeLibrary plugin(preloader.TakeLibrary(plugin_path, &error));
+//
+// This class is thread-safe.
+class BASE_EXPORT NativeLibraryPreloader {
+ public:
+  NativeLibraryPreloader();
+
+  // Unloads the libraries which were loaded but not taken, including those
+  // whose loads are still in progress, once they complete.
+  ~NativeLibraryPreloader();
+
+  // Starts loading the library at |library_path| once the libraries at
+  // |dependencies| are loaded. The dependencies must have been preloaded
+  // before, so they are loaded in the order of the calls when they depend on
+  // each other, and each library can only be preloaded once.
+  void Preload(const FilePath& library_path);
+  void Preload(const FilePath& library_path,
+               const std::vector<FilePath>& dependencies);
+
+  // Returns the library at |library_path| once it's loaded, passing its
+  // ownership to the caller, or null if it failed to load, in which case
+  // |error|, if not null, is filled in. Libraries which weren't preloaded are
+  // loaded by LoadNativeLibrary(). Each library can only be taken once.
+  NativeLibrary TakeLibrary(const FilePath& library_path,
+                            NativeLibraryLoadError* error);
+
+ private:
+  class State;
+
+  // Shared with the load tasks, which may outlive |this|.
+  const scoped_refptr<State> state_;
+
+  DISALLOW_COPY_AND_ASSIGN(NativeLibraryPreloader);
+};
+
+}  // namespace base
+
+#endif  // BASE_NATIVE_LIBRARY_PRELOADER_H_
@@ -0,0 +1,120 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/native_library_preloader.h"
+
+#include "base/files/file_path.h"
+#include "base/path_service.h"
+#include "base/scoped_native_library.h"
+#include "base/test/scoped_task_environment.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const FilePath::CharType kDummyLibraryPath[] =
+    FILE_PATH_LITERAL("dummy_library");
+const FilePath::CharType kOtherDummyLibraryPath[] =
+    FILE_PATH_LITERAL("other_dummy_library");
+
+class NativeLibraryPreloaderTest : public testing::Test {
+ protected:
+  test::ScopedTaskEnvironment scoped_task_environment_;
+};
+
+}  // namespace
+
+TEST_F(NativeLibraryPreloaderTest, LoadFailure) {
+  NativeLibraryPreloader preloader;
+  preloader.Preload(FilePath(kDummyLibraryPath));
+  scoped_task_environment_.RunUntilIdle();
+
+  NativeLibraryLoadError error;
+  EXPECT_FALSE(preloader.TakeLibrary(FilePath(kDummyLibraryPath), &error));
+  EXPECT_FALSE(error.ToString().empty());
+}
+
+// Libraries are loaded by TakeLibrary() if the load tasks didn't run yet,
+// after their dependencies.
+TEST_F(NativeLibraryPreloaderTest, TakeBeforeLoadTasks) {
+  NativeLibraryPreloader preloader;
+  preloader.Preload(FilePath(kDummyLibraryPath));
+  preloader.Preload(FilePath(kOtherDummyLibraryPath),
+                    {FilePath(kDummyLibraryPath)});
+
+  NativeLibraryLoadError error;
+  EXPECT_FALSE(
+      preloader.TakeLibrary(FilePath(kOtherDummyLibraryPath), &error));
+  EXPECT_FALSE(error.ToString().empty());
+  EXPECT_FALSE(preloader.TakeLibrary(FilePath(kDummyLibraryPath), nullptr));
+  scoped_task_environment_.RunUntilIdle();
+}
+
+TEST_F(NativeLibraryPreloaderTest, NotPreloaded) {
+  NativeLibraryPreloader preloader;
+  NativeLibraryLoadError error;
+  EXPECT_FALSE(preloader.TakeLibrary(FilePath(kDummyLibraryPath), &error));
+  EXPECT_FALSE(error.ToString().empty());
+}
+
+// We don't support dynamic loading on iOS, and ASAN complains about the ODR
+// violations of the test library, as in NativeLibraryTest.
+#if !defined(OS_IOS) && !defined(ADDRESS_SANITIZER)
+
+namespace {
+
+const char kTestLibraryName[] =
+#if defined(OS_MACOSX)
+    "libtest_shared_library.dylib";
+#elif defined(OS_ANDROID) && defined(COMPONENT_BUILD)
+    "libtest_shared_library.cr.so";
+#elif defined(OS_POSIX)
+    "libtest_shared_library.so";
+#elif defined(OS_WIN)
+    "test_shared_library.dll";
+#endif
+
+FilePath GetTestLibraryPath() {
+  FilePath exe_path;
+#if !defined(OS_FUCHSIA)
+  // Libraries do not sit alongside the executable in Fuchsia.
+  CHECK(PathService::Get(DIR_EXE, &exe_path));
+#endif
+  return exe_path.AppendASCII(kTestLibraryName);
+}
+
+}  // namespace
+
+TEST_F(NativeLibraryPreloaderTest, Load) {
+  NativeLibraryPreloader preloader;
+  const FilePath path = GetTestLibraryPath();
+  preloader.Preload(path);
+  scoped_task_environment_.RunUntilIdle();
+
+  ScopedNativeLibrary library(preloader.TakeLibrary(path, nullptr));
+  ASSERT_TRUE(library.is_valid());
+  EXPECT_EQ(5, reinterpret_cast<int (*)()>(
+                   library.GetFunctionPointer("GetSimpleTestValue"))());
+}
+
+// Libraries which aren't taken are unloaded with the preloader, even if their
+// loads complete after it's destroyed.
+TEST_F(NativeLibraryPreloaderTest, NotTaken) {
+  {
+    NativeLibraryPreloader preloader;
+    preloader.Preload(GetTestLibraryPath());
+    scoped_task_environment_.RunUntilIdle();
+  }
+  {
+    NativeLibraryPreloader preloader;
+    preloader.Preload(GetTestLibraryPath());
+  }
+  scoped_task_environment_.RunUntilIdle();
+}
+
+#endif  // !defined(OS_IOS) && !defined(ADDRESS_SANITIZER)
+
+}  // namespace base
@@ -45,6 +45,12 @@ namespace base {
 // Note that since the destructor is never run, this *will* leak memory if used
 // as a stack or member variable. Furthermore, a NoDestructor<T> should never
 // have global scope as that may require a static initializer.
+//
+// If T has a constexpr constructor and is trivially destructible, e.g. a
+// std::atomic, neither NoDestructor<T> nor LazyInstance<T> is needed: a global
+// annotated with CONSTINIT (see base/compiler_specific.h) is initialized at
+// compile time, and is then cheaper to access than a function-local static,
+// whose guard must be checked on every call.
 template <typename T>
 class NoDestructor {
  public:
@@ -115,6 +115,9 @@ class CheckedNumeric {
   template <typename U>
   friend U GetNumericValueForTest(const CheckedNumeric<U>& src);
 
+  template <typename U>
+  friend CheckedNumeric<U> CheckedSum(const U* values, size_t size);
+
   // Prototypes for the supported arithmetic operator overloads.
   template <typename Src>
   constexpr CheckedNumeric& operator+=(const Src rhs);
@@ -349,6 +352,28 @@ BASE_NUMERIC_ARITHMETIC_OPERATORS(Checked, Check, Xor, ^, ^=)
 BASE_NUMERIC_ARITHMETIC_VARIADIC(Checked, Check, Max)
 BASE_NUMERIC_ARITHMETIC_VARIADIC(Checked, Check, Min)
 
+// Returns the sum of the |size| integers at |values|, which is invalid if it
+// overflows T, e.g. to add up the elements of a span. Rather than after each
+// addition, overflow is checked once per batch of values, so that the loop
+// doesn't branch and can be vectorized. As a result, a sum that overflows and
+// comes back within a batch of integers narrower than 64 bits remains valid.
+template <typename T>
+CheckedNumeric<T> CheckedSum(const T* values, size_t size) {
+  static_assert(std::is_integral<T>::value, "Type must be an integer.");
+  constexpr size_t kBatchSize = 1024;
+  CheckedNumeric<T> sum = 0;
+  for (size_t begin = 0; begin < size && sum.IsValid(); begin += kBatchSize) {
+    const size_t batch_size =
+        size - begin < kBatchSize ? size - begin : kBatchSize;
+    bool overflow = false;
+    const auto batch_sum =
+        CheckedSumBatch<T>::Sum(values + begin, batch_size, &overflow);
+    sum += CheckedNumeric<typename CheckedSumBatch<T>::type>(batch_sum,
+                                                             !overflow);
+  }
+  return sum;
+}
+
 // These are some extra StrictNumeric operators to support simple pointer
 // arithmetic with our result types. Since wrapping on a pointer is always
 // bad, we trigger the CHECK condition here.
@@ -375,6 +400,7 @@ using internal::IsValidForType;
 using internal::ValueOrDieForType;
 using internal::ValueOrDefaultForType;
 using internal::MakeCheckedNum;
+using internal::CheckedSum;
 using internal::CheckMax;
 using internal::CheckMin;
 using internal::CheckAdd;
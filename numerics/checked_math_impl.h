@@ -38,6 +38,61 @@ constexpr bool CheckedAddImpl(T x, T y, T* result) {
              : uresult >= uy;  // Unsigned is either valid or underflow.
 }
 
+// Stores the wrapped sum of integers |x| and |y| in |*result| and returns
+// whether it overflowed, without branching, so that loops of it can be
+// vectorized.
+template <typename T>
+constexpr bool CheckedAddBranchless(T x, T y, T* result) {
+  static_assert(std::is_integral<T>::value, "Type must be an integer.");
+  using UnsignedT = typename std::make_unsigned<T>::type;
+  const UnsignedT ux = static_cast<UnsignedT>(x);
+  const UnsignedT uy = static_cast<UnsignedT>(y);
+  const UnsignedT sum = static_cast<UnsignedT>(ux + uy);
+  *result = static_cast<T>(sum);
+  // A signed sum overflowed if its sign differs from those of both operands,
+  // and an unsigned one if it wrapped below an operand.
+  return std::is_signed<T>::value
+             ? static_cast<UnsignedT>((ux ^ sum) & (uy ^ sum)) >>
+                   (IntegerBitsPlusSign<T>::value - 1)
+             : sum < ux;
+}
+
+// Adds up the values of a batch for CheckedSum(). Integers narrower than 64
+// bits are added up in 64 bits, which doesn't overflow for batches of up to
+// 2^32 values, so there is nothing to check in the loop.
+template <typename T,
+          bool kIsNarrow = (IntegerBitsPlusSign<T>::value <
+                            IntegerBitsPlusSign<intmax_t>::value)>
+struct CheckedSumBatch {
+  using type =
+      typename IntegerForDigitsAndSign<IntegerBitsPlusSign<intmax_t>::value,
+                                       std::is_signed<T>::value>::type;
+
+  static type Sum(const T* values, size_t size, bool* overflow) {
+    type sum = 0;
+    for (size_t i = 0; i < size; ++i)
+      sum += values[i];
+    *overflow = false;
+    return sum;
+  }
+};
+
+// 64-bit integers are added up with wrapping, remembering whether any of the
+// additions overflowed.
+template <typename T>
+struct CheckedSumBatch<T, false> {
+  using type = T;
+
+  static type Sum(const T* values, size_t size, bool* overflow) {
+    T sum = 0;
+    bool any_overflow = false;
+    for (size_t i = 0; i < size; ++i)
+      any_overflow |= CheckedAddBranchless(sum, values[i], &sum);
+    *overflow = any_overflow;
+    return sum;
+  }
+};
+
 template <typename T, typename U, class Enable = void>
 struct CheckedAddOp {};
 
@@ -221,6 +221,16 @@ ClampMathOp(const L lhs, const R rhs, const Args... args) {
   return ClampMathOp<M>(ClampMathOp<M>(lhs, rhs), args...);
 }
 
+// Adds each of the first |size| integers of |src| to the one at the same index
+// of |dst|, saturating at the limits of T, e.g. to merge two spans of counts.
+// Unlike a loop of ClampAdd() calls, this doesn't branch on overflow, so that
+// it can be vectorized.
+template <typename T>
+void ClampAddElements(T* dst, const T* src, size_t size) {
+  for (size_t i = 0; i < size; ++i)
+    dst[i] = ClampedAddBranchless(dst[i], src[i]);
+}
+
 BASE_NUMERIC_ARITHMETIC_OPERATORS(Clamped, Clamp, Add, +, +=)
 BASE_NUMERIC_ARITHMETIC_OPERATORS(Clamped, Clamp, Sub, -, -=)
 BASE_NUMERIC_ARITHMETIC_OPERATORS(Clamped, Clamp, Mul, *, *=)
@@ -247,6 +257,7 @@ using internal::MakeClampedNum;
 using internal::ClampMax;
 using internal::ClampMin;
 using internal::ClampAdd;
+using internal::ClampAddElements;
 using internal::ClampSub;
 using internal::ClampMul;
 using internal::ClampDiv;
@@ -68,6 +68,28 @@ constexpr T SaturatedAbsWrapper(T value) {
   return value < 0 ? -value : value;
 }
 
+// Returns the sum of integers |x| and |y|, saturated at the limits of T,
+// without branching, so that loops of it can be vectorized.
+template <typename T>
+constexpr T ClampedAddBranchless(T x, T y) {
+  static_assert(std::is_integral<T>::value, "Type must be an integer.");
+  using UnsignedT = typename std::make_unsigned<T>::type;
+  T sum = 0;
+  const UnsignedT overflow = CheckedAddBranchless(x, y, &sum);
+  // An overflow saturates toward the sign of the operands: at max() + 1, i.e.
+  // lowest(), when they are negative. Unsigned sums only overflow upward.
+  const UnsignedT saturated =
+      std::is_signed<T>::value
+          ? static_cast<UnsignedT>(
+                (static_cast<UnsignedT>(x) >>
+                 (IntegerBitsPlusSign<T>::value - 1)) +
+                static_cast<UnsignedT>(std::numeric_limits<T>::max()))
+          : std::numeric_limits<UnsignedT>::max();
+  const UnsignedT mask = static_cast<UnsignedT>(0 - overflow);
+  return static_cast<T>((static_cast<UnsignedT>(sum) & ~mask) |
+                        (saturated & mask));
+}
+
 template <typename T, typename U, class Enable = void>
 struct ClampedAddOp {};
 
@@ -5,7 +5,11 @@
 #ifndef BASE_OBSERVER_LIST_THREADSAFE_H_
 #define BASE_OBSERVER_LIST_THREADSAFE_H_
 
+#include <algorithm>
+#include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/bind.h"
@@ -18,6 +22,7 @@
 #include "base/sequenced_task_runner.h"
 #include "base/stl_util.h"
 #include "base/synchronization/lock.h"
+#include "base/synchronization/rcu_ptr.h"
 #include "base/threading/sequenced_task_runner_handle.h"
 #include "base/threading/thread_local.h"
 #include "build/build_config.h"
@@ -51,9 +56,30 @@
 //   will always be done via PostTask() to another sequence, whereas with the
 //   non-thread-safe observer_list, notifications happen synchronously.
 //
+//   By default, each notification posts one task per observer. Lists with
+//   many observers on few sequences can instead post one task per sequence,
+//   which notifies its observers in turn: see
+//   ObserverListThreadSafeBatching.
+//
+//   Notify() reads an immutable snapshot of the observers, published with
+//   RcuPtr, so it doesn't contend with AddObserver() and RemoveObserver().
+//   These copy the snapshot, so they cost O(number of observers).
+//
 ///////////////////////////////////////////////////////////////////////////////
 
 namespace base {
+
+// How ObserverListThreadSafe::Notify() posts notifications.
+enum class ObserverListThreadSafeBatching {
+  // One task per observer. This is the default.
+  PER_OBSERVER,
+
+  // One task per SequencedTaskRunner which observers were added from, which
+  // notifies all of them. An observer removed by another observer's
+  // notification is not notified, but other tasks can't run in between.
+  PER_SEQUENCE,
+};
+
 namespace internal {
 
 class BASE_EXPORT ObserverListThreadSafeBase
@@ -98,9 +124,19 @@ class BASE_EXPORT ObserverListThreadSafeBase
 template <class ObserverType>
 class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
  public:
-  ObserverListThreadSafe() = default;
+  ObserverListThreadSafe()
+      : ObserverListThreadSafe(ObserverListPolicy::ALL,
+                               ObserverListThreadSafeBatching::PER_OBSERVER) {
+  }
   explicit ObserverListThreadSafe(ObserverListPolicy policy)
-      : policy_(policy) {}
+      : ObserverListThreadSafe(policy,
+                               ObserverListThreadSafeBatching::PER_OBSERVER) {
+  }
+  ObserverListThreadSafe(ObserverListPolicy policy,
+                         ObserverListThreadSafeBatching batching)
+      : policy_(policy),
+        batching_(batching),
+        snapshot_(std::make_unique<Snapshot>()) {}
 
   // Adds |observer| to the list. |observer| must not already be in the list.
   void AddObserver(ObserverType* observer) {
@@ -109,19 +145,25 @@ class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
     if (!SequencedTaskRunnerHandle::IsSet())
       return;
 
-    AutoLock auto_lock(lock_);
-
-    // Add |observer| to the list of observers.
-    DCHECK(!ContainsKey(observers_, observer));
     const scoped_refptr<SequencedTaskRunner> task_runner =
         SequencedTaskRunnerHandle::Get();
-    observers_[observer] = task_runner;
+
+    // Add |observer| to the list of observers.
+    {
+      AutoLock auto_lock(lock_);
+      auto snapshot = std::make_unique<Snapshot>(*snapshot_.GetForWriter());
+      DCHECK(!ContainsKey(snapshot->observers, observer));
+      snapshot->observers[observer] = task_runner;
+      if (batching_ == ObserverListThreadSafeBatching::PER_SEQUENCE)
+        snapshot->GetSequence(task_runner.get()).push_back(observer);
+      snapshot_.Update(std::move(snapshot));
+    }
 
     // If this is called while a notification is being dispatched on this thread
     // and |policy_| is ALL, |observer| must be notified (if a notification is
     // being dispatched on another thread in parallel, the notification may or
-    // may not make it to |observer| depending on the outcome of the race to
-    // |lock_|).
+    // may not make it to |observer| depending on whether it reads the observers
+    // before or after they're updated).
     if (policy_ == ObserverListPolicy::ALL) {
       const NotificationDataBase* current_notification =
           tls_current_notification_.Get().Get();
@@ -143,14 +185,23 @@ class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
   // observer won't stop it.
   void RemoveObserver(ObserverType* observer) {
     AutoLock auto_lock(lock_);
-    observers_.erase(observer);
+    const Snapshot* current = snapshot_.GetForWriter();
+    auto it = current->observers.find(observer);
+    if (it == current->observers.end())
+      return;
+
+    auto snapshot = std::make_unique<Snapshot>(*current);
+    if (batching_ == ObserverListThreadSafeBatching::PER_SEQUENCE)
+      snapshot->RemoveFromSequence(it->second.get(), observer);
+    snapshot->observers.erase(observer);
+    snapshot_.Update(std::move(snapshot));
   }
 
   // Verifies that the list is currently empty (i.e. there are no observers).
   void AssertEmpty() const {
 #if DCHECK_IS_ON()
-    AutoLock auto_lock(lock_);
-    DCHECK(observers_.empty());
+    RcuReadScope read_scope;
+    DCHECK(snapshot_.Get()->observers.empty());
 #endif
   }
 
@@ -163,13 +214,25 @@ class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
     Callback<void(ObserverType*)> method =
         Bind(&Dispatcher<ObserverType, Method>::Run, m,
              std::forward<Params>(params)...);
+    const NotificationData notification(this, from_here, method);
+
+    RcuReadScope read_scope;
+    const Snapshot* snapshot = snapshot_.Get();
+    if (batching_ == ObserverListThreadSafeBatching::PER_SEQUENCE) {
+      for (const auto& sequence : snapshot->sequences) {
+        sequence.first->PostTask(
+            from_here,
+            BindOnce(&ObserverListThreadSafe<ObserverType>::NotifyAllWrapper,
+                     this, sequence.second, notification));
+      }
+      return;
+    }
 
-    AutoLock lock(lock_);
-    for (const auto& observer : observers_) {
+    for (const auto& observer : snapshot->observers) {
       observer.second->PostTask(
           from_here,
           BindOnce(&ObserverListThreadSafe<ObserverType>::NotifyWrapper, this,
-                   observer.first, NotificationData(this, from_here, method)));
+                   observer.first, notification));
     }
   }
 
@@ -186,19 +249,75 @@ class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
     Callback<void(ObserverType*)> method;
   };
 
+  // The observers at some point in time. Snapshots are never modified once
+  // published in |snapshot_|: AddObserver() and RemoveObserver() publish
+  // modified copies.
+  struct Snapshot {
+    using SequenceObservers = std::pair<scoped_refptr<SequencedTaskRunner>,
+                                        std::vector<ObserverType*>>;
+
+    // Returns the observers added from |task_runner|, adding it to |sequences|
+    // if needed.
+    std::vector<ObserverType*>& GetSequence(SequencedTaskRunner* task_runner) {
+      for (auto& sequence : sequences) {
+        if (sequence.first.get() == task_runner)
+          return sequence.second;
+      }
+      sequences.emplace_back(task_runner, std::vector<ObserverType*>());
+      return sequences.back().second;
+    }
+
+    void RemoveFromSequence(SequencedTaskRunner* task_runner,
+                            ObserverType* observer) {
+      auto sequence = std::find_if(
+          sequences.begin(), sequences.end(),
+          [task_runner](const SequenceObservers& sequence) {
+            return sequence.first.get() == task_runner;
+          });
+      DCHECK(sequence != sequences.end());
+      auto& sequence_observers = sequence->second;
+      sequence_observers.erase(std::find(sequence_observers.begin(),
+                                         sequence_observers.end(), observer));
+      if (sequence_observers.empty())
+        sequences.erase(sequence);
+    }
+
+    // Keys are observers. Values are the SequencedTaskRunners on which they
+    // must be notified.
+    std::unordered_map<ObserverType*, scoped_refptr<SequencedTaskRunner>>
+        observers;
+
+    // With PER_SEQUENCE batching, the same observers grouped by
+    // SequencedTaskRunner, in the order they were added. Otherwise empty.
+    std::vector<SequenceObservers> sequences;
+  };
+
   ~ObserverListThreadSafe() override = default;
 
+  // Returns whether |observer| is still in the list, and so still needs
+  // notifications.
+  bool IsObserverRegistered(ObserverType* observer) const {
+    RcuReadScope read_scope;
+    const auto& observers = snapshot_.Get()->observers;
+    auto it = observers.find(observer);
+    if (it == observers.end())
+      return false;
+    DCHECK(it->second->RunsTasksInCurrentSequence());
+    return true;
+  }
+
+  void NotifyAllWrapper(const std::vector<ObserverType*>& observers,
+                        const NotificationData& notification) {
+    // Each notification may remove later observers.
+    for (ObserverType* observer : observers)
+      NotifyWrapper(observer, notification);
+  }
+
   void NotifyWrapper(ObserverType* observer,
                      const NotificationData& notification) {
-    {
-      AutoLock auto_lock(lock_);
-
-      // Check whether the observer still needs a notification.
-      auto it = observers_.find(observer);
-      if (it == observers_.end())
-        return;
-      DCHECK(it->second->RunsTasksInCurrentSequence());
-    }
+    // Check whether the observer still needs a notification.
+    if (!IsObserverRegistered(observer))
+      return;
 
     // Keep track of the notification being dispatched on the current thread.
     // This will be used if the callback below calls AddObserver().
@@ -219,15 +338,13 @@ class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
     tls_current_notification.Set(previous_notification);
   }
 
-  const ObserverListPolicy policy_ = ObserverListPolicy::ALL;
+  const ObserverListPolicy policy_;
+  const ObserverListThreadSafeBatching batching_;
 
-  // Synchronizes access to |observers_|.
-  mutable Lock lock_;
+  // Serializes updates of |snapshot_|. Reads don't need it.
+  Lock lock_;
 
-  // Keys are observers. Values are the SequencedTaskRunners on which they must
-  // be notified.
-  std::unordered_map<ObserverType*, scoped_refptr<SequencedTaskRunner>>
-      observers_;
+  RcuPtr<Snapshot> snapshot_;
 
   DISALLOW_COPY_AND_ASSIGN(ObserverListThreadSafe);
 };
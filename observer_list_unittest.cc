@@ -22,8 +22,10 @@
 #include "base/task_scheduler/task_scheduler.h"
 #include "base/test/gtest_util.h"
 #include "base/test/scoped_task_environment.h"
+#include "base/test/test_simple_task_runner.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/thread_restrictions.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -578,6 +580,61 @@ TEST(ObserverListThreadSafeTest, RemoveMultipleObservers) {
   RunLoop().RunUntilIdle();
 }
 
+// Verify that with PER_SEQUENCE batching, a notification posts one task per
+// sequence, which notifies all of its observers.
+TEST(ObserverListThreadSafeTest, BatchedNotifications) {
+  auto task_runner = MakeRefCounted<TestSimpleTaskRunner>();
+  ThreadTaskRunnerHandle task_runner_handle(task_runner);
+  auto observer_list = MakeRefCounted<ObserverListThreadSafe<Foo>>(
+      ObserverListPolicy::ALL, ObserverListThreadSafeBatching::PER_SEQUENCE);
+  Adder a(1);
+  Adder b(1);
+  Adder c(1);
+
+  observer_list->AddObserver(&a);
+  observer_list->AddObserver(&b);
+  observer_list->AddObserver(&c);
+
+  observer_list->Notify(FROM_HERE, &Foo::Observe, 10);
+  EXPECT_EQ(1u, task_runner->NumPendingTasks());
+  task_runner->RunPendingTasks();
+  EXPECT_EQ(10, a.total);
+  EXPECT_EQ(10, b.total);
+  EXPECT_EQ(10, c.total);
+
+  observer_list->RemoveObserver(&b);
+  observer_list->Notify(FROM_HERE, &Foo::Observe, 10);
+  EXPECT_EQ(1u, task_runner->NumPendingTasks());
+  task_runner->RunPendingTasks();
+  EXPECT_EQ(20, a.total);
+  EXPECT_EQ(10, b.total);
+  EXPECT_EQ(20, c.total);
+
+  observer_list->RemoveObserver(&a);
+  observer_list->RemoveObserver(&c);
+  observer_list->AssertEmpty();
+  observer_list->Notify(FROM_HERE, &Foo::Observe, 10);
+  EXPECT_EQ(0u, task_runner->NumPendingTasks());
+}
+
+// Verify that an observer removed by another observer's notification within a
+// batched notification isn't notified.
+TEST(ObserverListThreadSafeTest, BatchedNotificationRemovesObserver) {
+  MessageLoop loop;
+  auto observer_list = MakeRefCounted<ObserverListThreadSafe<Foo>>(
+      ObserverListPolicy::ALL, ObserverListThreadSafeBatching::PER_SEQUENCE);
+  FooRemover a(observer_list.get());
+  Adder b(1);
+
+  observer_list->AddObserver(&a);
+  observer_list->AddObserver(&b);
+  a.AddFooToRemove(&b);
+
+  observer_list->Notify(FROM_HERE, &Foo::Observe, 1);
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(0, b.total);
+}
+
 // A test driver for a multi-threaded notification loop.  Runs a number
 // of observer threads, each of which constantly adds/removes itself
 // from the observer list.  Optionally, if cross_thread_notifies is set
@@ -4,6 +4,7 @@
 
 #include "base/path_service.h"
 
+#include <memory>
 #include <unordered_map>
 
 #if defined(OS_WIN)
@@ -16,6 +17,7 @@
 #include "base/files/file_util.h"
 #include "base/logging.h"
 #include "base/synchronization/lock.h"
+#include "base/synchronization/rcu_ptr.h"
 #include "build/build_config.h"
 
 namespace base {
@@ -118,7 +120,9 @@ Provider base_provider_posix = {
 
 struct PathData {
   Lock lock;
-  PathMap cache;        // Cache mappings from path key to path value.
+  // Cache mappings from path key to path value. Read without |lock|, and
+  // replaced by a new snapshot while holding it. Null while empty or disabled.
+  RcuPtr<PathMap> cache;
   PathMap overrides;    // Track path overrides.
   Provider* providers;  // Linked list of path service providers.
   bool cache_disabled;  // Don't use cache if true;
@@ -143,27 +147,40 @@ static PathData* GetPathData() {
   return path_data;
 }
 
-// Tries to find |key| in the cache. |path_data| should be locked by the caller!
-bool LockedGetFromCache(int key, const PathData* path_data, FilePath* result) {
-  if (path_data->cache_disabled)
+// Tries to find |key| in the cache. Doesn't need |path_data| to be locked.
+bool GetFromCache(int key, const PathData* path_data, FilePath* result) {
+  RcuReadScope read_scope;
+  const PathMap* cache = path_data->cache.Get();
+  if (!cache)
     return false;
   // check for a cached version
-  PathMap::const_iterator it = path_data->cache.find(key);
-  if (it != path_data->cache.end()) {
+  PathMap::const_iterator it = cache->find(key);
+  if (it != cache->end()) {
     *result = it->second;
     return true;
   }
   return false;
 }
 
+// Publishes a copy of the cache with |path| at |key|. |path_data| should be
+// locked by the caller!
+void LockedAddToCache(int key, const FilePath& path, PathData* path_data) {
+  if (path_data->cache_disabled)
+    return;
+  const PathMap* cache = path_data->cache.GetForWriter();
+  std::unique_ptr<PathMap> new_cache =
+      cache ? std::make_unique<PathMap>(*cache) : std::make_unique<PathMap>();
+  (*new_cache)[key] = path;
+  path_data->cache.Update(std::move(new_cache));
+}
+
 // Tries to find |key| in the overrides map. |path_data| should be locked by the
 // caller!
 bool LockedGetFromOverrides(int key, PathData* path_data, FilePath* result) {
   // check for an overridden version.
   PathMap::const_iterator it = path_data->overrides.find(key);
   if (it != path_data->overrides.end()) {
-    if (!path_data->cache_disabled)
-      path_data->cache[key] = it->second;
+    LockedAddToCache(key, it->second, path_data);
     *result = it->second;
     return true;
   }
@@ -186,12 +203,13 @@ bool PathService::Get(int key, FilePath* result) {
   if (key == DIR_CURRENT)
     return GetCurrentDirectory(result);
 
+  // Paths which were already resolved don't need the lock.
+  if (GetFromCache(key, path_data, result))
+    return true;
+
   Provider* provider = nullptr;
   {
     AutoLock scoped_lock(path_data->lock);
-    if (LockedGetFromCache(key, path_data, result))
-      return true;
-
     if (LockedGetFromOverrides(key, path_data, result))
       return true;
 
@@ -222,8 +240,7 @@ bool PathService::Get(int key, FilePath* result) {
   *result = path;
 
   AutoLock scoped_lock(path_data->lock);
-  if (!path_data->cache_disabled)
-    path_data->cache[key] = path;
+  LockedAddToCache(key, path, path_data);
 
   return true;
 }
@@ -268,7 +285,7 @@ bool PathService::OverrideAndCreateIfNeeded(int key,
 
   // Clear the cache now. Some of its entries could have depended
   // on the value we are overriding, and are now out of sync with reality.
-  path_data->cache.clear();
+  path_data->cache.Update(nullptr);
 
   path_data->overrides[key] = file_path;
 
@@ -287,7 +304,7 @@ bool PathService::RemoveOverride(int key) {
 
   // Clear the cache now. Some of its entries could have depended on the value
   // we are going to remove, and are now out of sync.
-  path_data->cache.clear();
+  path_data->cache.Update(nullptr);
 
   path_data->overrides.erase(key);
 
@@ -332,7 +349,7 @@ void PathService::DisableCache() {
   DCHECK(path_data);
 
   AutoLock scoped_lock(path_data->lock);
-  path_data->cache.clear();
+  path_data->cache.Update(nullptr);
   path_data->cache_disabled = true;
 }
 
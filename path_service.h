@@ -29,6 +29,8 @@ class BASE_EXPORT PathService {
   //
   // Returns true if the directory or file was successfully retrieved. On
   // failure, 'path' will not be changed.
+  //
+  // Retrieved paths are cached, and later calls for them don't take a lock.
   static bool Get(int key, FilePath* path);
 
   // Overrides the path to a special directory or file.  This cannot be used to
@@ -82,6 +84,7 @@ class BASE_EXPORT PathService {
  private:
   friend class ScopedPathOverride;
   FRIEND_TEST_ALL_PREFIXES(PathServiceTest, RemoveOverride);
+  FRIEND_TEST_ALL_PREFIXES(PathServiceTest, GetWhileOverriding);
 
   // Removes an override for a special directory or file. Returns true if there
   // was an override to remove or false if none was present.
@@ -8,6 +8,8 @@
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/strings/string_util.h"
+#include "base/synchronization/atomic_flag.h"
+#include "base/threading/simple_thread.h"
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest-spi.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -223,6 +225,55 @@ TEST_F(PathServiceTest, RemoveOverride) {
   EXPECT_EQ(original_user_data_dir, new_user_data_dir);
 }
 
+// Readers see either path while an override is added and removed.
+TEST_F(PathServiceTest, GetWhileOverriding) {
+  PathService::RemoveOverride(DIR_TEMP);
+  FilePath original_temp_dir;
+  ASSERT_TRUE(PathService::Get(DIR_TEMP, &original_temp_dir));
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const FilePath overridden_temp_dir =
+      MakeAbsoluteFilePath(temp_dir.GetPath());
+
+  class Reader : public SimpleThread {
+   public:
+    Reader(const FilePath& original_temp_dir,
+           const FilePath& overridden_temp_dir,
+           const AtomicFlag* done)
+        : SimpleThread("PathServiceReader"),
+          original_temp_dir_(original_temp_dir),
+          overridden_temp_dir_(overridden_temp_dir),
+          done_(done) {}
+
+    void Run() override {
+      while (!done_->IsSet()) {
+        FilePath path;
+        EXPECT_TRUE(PathService::Get(DIR_TEMP, &path));
+        EXPECT_TRUE(path == original_temp_dir_ || path == overridden_temp_dir_)
+            << path.value();
+      }
+    }
+
+   private:
+    const FilePath original_temp_dir_;
+    const FilePath overridden_temp_dir_;
+    const AtomicFlag* const done_;
+  };
+
+  AtomicFlag done;
+  Reader reader1(original_temp_dir, overridden_temp_dir, &done);
+  Reader reader2(original_temp_dir, overridden_temp_dir, &done);
+  reader1.Start();
+  reader2.Start();
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(PathService::Override(DIR_TEMP, temp_dir.GetPath()));
+    EXPECT_TRUE(PathService::RemoveOverride(DIR_TEMP));
+  }
+  done.Set();
+  reader1.Join();
+  reader2.Join();
+}
+
 #if defined(OS_WIN)
 TEST_F(PathServiceTest, GetProgramFiles) {
   FilePath programfiles_dir;
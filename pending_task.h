@@ -5,17 +5,20 @@
 #ifndef BASE_PENDING_TASK_H_
 #define BASE_PENDING_TASK_H_
 
+#include <stdint.h>
+
 #include <array>
 
 #include "base/base_export.h"
 #include "base/callback.h"
+#include "base/containers/chunked_deque.h"
 #include "base/containers/queue.h"
 #include "base/location.h"
 #include "base/time/time.h"
 
 namespace base {
 
-enum class Nestable {
+enum class Nestable : uint8_t {
   kNonNestable,
   kNestable,
 };
@@ -41,15 +44,23 @@ struct BASE_EXPORT PendingTask {
   // The site this PendingTask was posted from.
   Location posted_from;
 
+  // Secondary sort key for run time. Next to |posted_from|, which is only 4
+  // bytes, so that they share a word.
+  int sequence_num = 0;
+
   // The time when the task should be run.
   base::TimeTicks delayed_run_time;
 
-  // Task backtrace. mutable so it can be set while annotating const PendingTask
-  // objects from TaskAnnotator::DidQueueTask().
-  mutable std::array<const void*, 4> task_backtrace = {};
+  // Task backtrace: the sites the parent tasks of this task were posted from,
+  // closest first. Stored as interned Locations, half the size of their
+  // program counters. mutable so it can be set while annotating const
+  // PendingTask objects from TaskAnnotator::DidQueueTask().
+  mutable std::array<Location, 4> task_backtrace = {};
 
-  // Secondary sort key for run time.
-  int sequence_num = 0;
+  // The time when the task was queued. Only set by
+  // TaskAnnotator::DidQueueTask() while debug::TaskTimeTracker is enabled, and
+  // mutable for the same reason.
+  mutable base::TimeTicks queue_time;
 
   // OK to dispatch from a nested loop.
   Nestable nestable;
@@ -58,7 +69,9 @@ struct BASE_EXPORT PendingTask {
   bool is_high_res = false;
 };
 
-using TaskQueue = base::queue<PendingTask>;
+// Bursts of posted tasks grow the queue by whole blocks, without moving the
+// tasks already queued.
+using TaskQueue = base::queue<PendingTask, chunked_deque<PendingTask>>;
 
 // PendingTasks are sorted by their |delayed_run_time| property.
 using DelayedTaskQueue = std::priority_queue<base::PendingTask>;
@@ -22,11 +22,17 @@ const int Pickle::kPayloadUnit = 64;
 
 static const size_t kCapacityReadOnly = static_cast<size_t>(-1);
 
+// The maximum size of a LEB128 varint holding a uint64_t.
+static const size_t kMaxVarintSize = 10;
+
 PickleIterator::PickleIterator(const Pickle& pickle)
+    : PickleIterator(pickle, pickle.encoding()) {}
+
+PickleIterator::PickleIterator(const Pickle& pickle, PickleEncoding encoding)
     : payload_(pickle.payload()),
       read_index_(0),
-      end_index_(pickle.payload_size()) {
-}
+      end_index_(pickle.payload_size()),
+      encoding_(encoding) {}
 
 template <typename Type>
 inline bool PickleIterator::ReadBuiltinType(Type* result) {
@@ -40,8 +46,67 @@ inline bool PickleIterator::ReadBuiltinType(Type* result) {
   return true;
 }
 
+inline bool PickleIterator::ReadVarint(uint64_t* result) {
+  // Rather than checking the bounds of each byte, find how many bytes the
+  // varint may span, and decode within that block.
+  const uint8_t* read_from =
+      reinterpret_cast<const uint8_t*>(payload_ + read_index_);
+  size_t max_size = std::min(end_index_ - read_index_, kMaxVarintSize);
+  uint64_t value = 0;
+  for (size_t i = 0; i < max_size; ++i) {
+    uint8_t byte = read_from[i];
+    value |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+    if (!(byte & 0x80)) {
+      // The last byte of a 10-byte varint only holds the top bit.
+      if (i == kMaxVarintSize - 1 && byte > 1)
+        break;
+      read_index_ += i + 1;
+      *result = value;
+      return true;
+    }
+  }
+  read_index_ = end_index_;
+  return false;
+}
+
+template <typename Type>
+inline bool PickleIterator::ReadSignedVarint(Type* result) {
+  uint64_t encoded;
+  if (!ReadVarint(&encoded))
+    return false;
+  int64_t value = static_cast<int64_t>(encoded >> 1) ^
+                  -static_cast<int64_t>(encoded & 1);
+  if (!IsValueInRangeForNumericType<Type>(value)) {
+    read_index_ = end_index_;
+    return false;
+  }
+  *result = static_cast<Type>(value);
+  return true;
+}
+
+template <typename Type>
+inline bool PickleIterator::ReadUnsignedVarint(Type* result) {
+  uint64_t value;
+  if (!ReadVarint(&value))
+    return false;
+  if (!IsValueInRangeForNumericType<Type>(value)) {
+    read_index_ = end_index_;
+    return false;
+  }
+  *result = static_cast<Type>(value);
+  return true;
+}
+
+inline bool PickleIterator::ReadLengthPrefix(int* result) {
+  if (UNLIKELY(encoding_ == PickleEncoding::kCompact))
+    return ReadUnsignedVarint(result);
+  return ReadInt(result);
+}
+
 inline void PickleIterator::Advance(size_t size) {
-  size_t aligned_size = bits::Align(size, sizeof(uint32_t));
+  size_t aligned_size = encoding_ == PickleEncoding::kCompact
+                            ? size
+                            : bits::Align(size, sizeof(uint32_t));
   if (end_index_ - read_index_ < aligned_size) {
     read_index_ = end_index_;
   } else {
@@ -82,10 +147,21 @@ inline const char* PickleIterator::GetReadPointerAndAdvance(
 }
 
 bool PickleIterator::ReadBool(bool* result) {
+  if (UNLIKELY(encoding_ == PickleEncoding::kCompact)) {
+    uint8_t value;
+    if (!ReadUnsignedVarint(&value) || value > 1) {
+      read_index_ = end_index_;
+      return false;
+    }
+    *result = !!value;
+    return true;
+  }
   return ReadBuiltinType(result);
 }
 
 bool PickleIterator::ReadInt(int* result) {
+  if (UNLIKELY(encoding_ == PickleEncoding::kCompact))
+    return ReadSignedVarint(result);
   return ReadBuiltinType(result);
 }
 
@@ -93,7 +169,7 @@ bool PickleIterator::ReadLong(long* result) {
   // Always read long as a 64-bit value to ensure compatibility between 32-bit
   // and 64-bit processes.
   int64_t result_int64 = 0;
-  if (!ReadBuiltinType(&result_int64))
+  if (!ReadInt64(&result_int64))
     return false;
   // CHECK if the cast truncates the value so that we know to change this IPC
   // parameter to use int64_t.
@@ -102,18 +178,26 @@ bool PickleIterator::ReadLong(long* result) {
 }
 
 bool PickleIterator::ReadUInt16(uint16_t* result) {
+  if (UNLIKELY(encoding_ == PickleEncoding::kCompact))
+    return ReadUnsignedVarint(result);
   return ReadBuiltinType(result);
 }
 
 bool PickleIterator::ReadUInt32(uint32_t* result) {
+  if (UNLIKELY(encoding_ == PickleEncoding::kCompact))
+    return ReadUnsignedVarint(result);
   return ReadBuiltinType(result);
 }
 
 bool PickleIterator::ReadInt64(int64_t* result) {
+  if (UNLIKELY(encoding_ == PickleEncoding::kCompact))
+    return ReadSignedVarint(result);
   return ReadBuiltinType(result);
 }
 
 bool PickleIterator::ReadUInt64(uint64_t* result) {
+  if (UNLIKELY(encoding_ == PickleEncoding::kCompact))
+    return ReadVarint(result);
   return ReadBuiltinType(result);
 }
 
@@ -143,7 +227,7 @@ bool PickleIterator::ReadDouble(double* result) {
 
 bool PickleIterator::ReadString(std::string* result) {
   int len;
-  if (!ReadInt(&len))
+  if (!ReadLengthPrefix(&len))
     return false;
   const char* read_from = GetReadPointerAndAdvance(len);
   if (!read_from)
@@ -155,7 +239,7 @@ bool PickleIterator::ReadString(std::string* result) {
 
 bool PickleIterator::ReadStringPiece(StringPiece* result) {
   int len;
-  if (!ReadInt(&len))
+  if (!ReadLengthPrefix(&len))
     return false;
   const char* read_from = GetReadPointerAndAdvance(len);
   if (!read_from)
@@ -167,7 +251,7 @@ bool PickleIterator::ReadStringPiece(StringPiece* result) {
 
 bool PickleIterator::ReadString16(string16* result) {
   int len;
-  if (!ReadInt(&len))
+  if (!ReadLengthPrefix(&len))
     return false;
   const char* read_from = GetReadPointerAndAdvance(len, sizeof(char16));
   if (!read_from)
@@ -179,7 +263,7 @@ bool PickleIterator::ReadString16(string16* result) {
 
 bool PickleIterator::ReadStringPiece16(StringPiece16* result) {
   int len;
-  if (!ReadInt(&len))
+  if (!ReadLengthPrefix(&len))
     return false;
   const char* read_from = GetReadPointerAndAdvance(len, sizeof(char16));
   if (!read_from)
@@ -193,7 +277,7 @@ bool PickleIterator::ReadData(const char** data, int* length) {
   *length = 0;
   *data = nullptr;
 
-  if (!ReadInt(length))
+  if (!ReadLengthPrefix(length))
     return false;
 
   return ReadBytes(data, *length);
@@ -211,13 +295,14 @@ Pickle::Attachment::Attachment() = default;
 
 Pickle::Attachment::~Attachment() = default;
 
-// Payload is uint32_t aligned.
+// Payload is uint32_t aligned, unless the encoding is compact.
 
 Pickle::Pickle()
     : header_(nullptr),
       header_size_(sizeof(Header)),
       capacity_after_header_(0),
-      write_offset_(0) {
+      write_offset_(0),
+      encoding_(PickleEncoding::kAligned) {
   static_assert((Pickle::kPayloadUnit & (Pickle::kPayloadUnit - 1)) == 0,
                 "Pickle::kPayloadUnit must be a power of two");
   Resize(kPayloadUnit);
@@ -225,10 +310,14 @@ Pickle::Pickle()
 }
 
 Pickle::Pickle(int header_size)
+    : Pickle(header_size, PickleEncoding::kAligned) {}
+
+Pickle::Pickle(int header_size, PickleEncoding encoding)
     : header_(nullptr),
       header_size_(bits::Align(header_size, sizeof(uint32_t))),
       capacity_after_header_(0),
-      write_offset_(0) {
+      write_offset_(0),
+      encoding_(encoding) {
   DCHECK_GE(static_cast<size_t>(header_size), sizeof(Header));
   DCHECK_LE(header_size, kPayloadUnit);
   Resize(kPayloadUnit);
@@ -239,7 +328,8 @@ Pickle::Pickle(const char* data, int data_len)
     : header_(reinterpret_cast<Header*>(const_cast<char*>(data))),
       header_size_(0),
       capacity_after_header_(kCapacityReadOnly),
-      write_offset_(0) {
+      write_offset_(0),
+      encoding_(PickleEncoding::kAligned) {
   if (data_len >= static_cast<int>(sizeof(Header)))
     header_size_ = data_len - header_->payload_size;
 
@@ -254,11 +344,16 @@ Pickle::Pickle(const char* data, int data_len)
     header_ = nullptr;
 }
 
+Pickle::Pickle(span<const uint8_t> data)
+    : Pickle(reinterpret_cast<const char*>(data.data()),
+             saturated_cast<int>(data.size())) {}
+
 Pickle::Pickle(const Pickle& other)
     : header_(nullptr),
       header_size_(other.header_size_),
       capacity_after_header_(0),
-      write_offset_(other.write_offset_) {
+      write_offset_(other.write_offset_),
+      encoding_(other.encoding_) {
   Resize(other.header_->payload_size);
   memcpy(header_, other.header_, header_size_ + other.header_->payload_size);
 }
@@ -285,22 +380,23 @@ Pickle& Pickle::operator=(const Pickle& other) {
   memcpy(header_, other.header_,
          other.header_size_ + other.header_->payload_size);
   write_offset_ = other.write_offset_;
+  encoding_ = other.encoding_;
   return *this;
 }
 
 void Pickle::WriteString(const StringPiece& value) {
-  WriteInt(static_cast<int>(value.size()));
+  WriteLengthPrefix(value.size());
   WriteBytes(value.data(), static_cast<int>(value.size()));
 }
 
 void Pickle::WriteString16(const StringPiece16& value) {
-  WriteInt(static_cast<int>(value.size()));
+  WriteLengthPrefix(value.size());
   WriteBytes(value.data(), static_cast<int>(value.size()) * sizeof(char16));
 }
 
 void Pickle::WriteData(const char* data, int length) {
   DCHECK_GE(length, 0);
-  WriteInt(length);
+  WriteLengthPrefix(length);
   WriteBytes(data, length);
 }
 
@@ -308,6 +404,24 @@ void Pickle::WriteBytes(const void* data, int length) {
   WriteBytesCommon(data, length);
 }
 
+void Pickle::WriteVarint(uint64_t value) {
+  uint8_t bytes[kMaxVarintSize];
+  size_t size = 0;
+  while (value >= 0x80) {
+    bytes[size++] = static_cast<uint8_t>(value) | 0x80;
+    value >>= 7;
+  }
+  bytes[size++] = static_cast<uint8_t>(value);
+  WriteBytesCommon(bytes, size);
+}
+
+void Pickle::WriteLengthPrefix(size_t length) {
+  if (is_compact())
+    WriteVarint(length);
+  else
+    WriteInt(static_cast<int>(length));
+}
+
 void Pickle::Reserve(size_t length) {
   size_t data_len = bits::Align(length, sizeof(uint32_t));
   DCHECK_GE(data_len, length);
@@ -402,7 +516,8 @@ template void Pickle::WriteBytesStatic<8>(const void* data);
 inline void* Pickle::ClaimUninitializedBytesInternal(size_t length) {
   DCHECK_NE(kCapacityReadOnly, capacity_after_header_)
       << "oops: pickle is readonly";
-  size_t data_len = bits::Align(length, sizeof(uint32_t));
+  size_t data_len =
+      is_compact() ? length : bits::Align(length, sizeof(uint32_t));
   DCHECK_GE(data_len, length);
 #ifdef ARCH_CPU_64_BITS
   DCHECK_LE(data_len, std::numeric_limits<uint32_t>::max());
@@ -432,4 +547,58 @@ inline void Pickle::WriteBytesCommon(const void* data, size_t length) {
   memcpy(write, data, length);
 }
 
+SegmentedPickleWriter::SegmentedPickleWriter()
+    : SegmentedPickleWriter(sizeof(Pickle::Header)) {}
+
+SegmentedPickleWriter::SegmentedPickleWriter(int header_size)
+    : pickle_(header_size),
+      header_(pickle_.header_size_ / sizeof(uint32_t)) {}
+
+SegmentedPickleWriter::~SegmentedPickleWriter() = default;
+
+void SegmentedPickleWriter::WriteDataUnowned(span<const uint8_t> data) {
+  DCHECK_LE(data.size(),
+            static_cast<size_t>(std::numeric_limits<int>::max()));
+  pickle_.WriteInt(static_cast<int>(data.size()));
+  unowned_data_.push_back({pickle_.write_offset_, data});
+  unowned_size_ += bits::Align(data.size(), sizeof(uint32_t));
+}
+
+size_t SegmentedPickleWriter::size() const {
+  return pickle_.size() + unowned_size_;
+}
+
+std::vector<span<const uint8_t>> SegmentedPickleWriter::GetSegments() {
+  // Used to pad the unowned blobs, like Pickle pads what it copies.
+  static const uint8_t kPadding[sizeof(uint32_t)] = {};
+
+  memcpy(header_.data(), pickle_.header_, pickle_.header_size_);
+  reinterpret_cast<Pickle::Header*>(header_.data())->payload_size =
+      checked_cast<uint32_t>(pickle_.write_offset_ + unowned_size_);
+
+  std::vector<span<const uint8_t>> segments;
+  segments.reserve(3 * unowned_data_.size() + 2);
+  segments.push_back(as_bytes(make_span(header_)));
+
+  const uint8_t* payload =
+      reinterpret_cast<const uint8_t*>(pickle_.payload());
+  size_t offset = 0;
+  for (const UnownedData& unowned : unowned_data_) {
+    if (unowned.offset > offset)
+      segments.push_back(make_span(payload + offset, unowned.offset - offset));
+    offset = unowned.offset;
+    if (!unowned.data.empty())
+      segments.push_back(unowned.data);
+    size_t padding = bits::Align(unowned.data.size(), sizeof(uint32_t)) -
+                     unowned.data.size();
+    if (padding)
+      segments.push_back(make_span(kPadding, padding));
+  }
+  if (pickle_.write_offset_ > offset) {
+    segments.push_back(
+        make_span(payload + offset, pickle_.write_offset_ - offset));
+  }
+  return segments;
+}
+
 }  // namespace base
@@ -9,9 +9,11 @@
 #include <stdint.h>
 
 #include <string>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/compiler_specific.h"
+#include "base/containers/span.h"
 #include "base/gtest_prod_util.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
@@ -26,12 +28,33 @@ namespace base {
 
 class Pickle;
 
+// How values are laid out in the payload of a Pickle.
+enum class PickleEncoding {
+  // Each value is written as its fixed-size representation, padded to a
+  // multiple of 4 bytes. This is the default.
+  kAligned,
+  // Integers are written as LEB128 varints (zigzag-encoded when signed),
+  // bools as a single byte, and strings and data are prefixed with their
+  // varint length. Nothing is padded. This is smaller for payloads of small
+  // integers and short strings, but values can't be read in place at known
+  // offsets.
+  kCompact,
+};
+
 // PickleIterator reads data from a Pickle. The Pickle object must remain valid
 // while the PickleIterator object is in use.
 class BASE_EXPORT PickleIterator {
  public:
-  PickleIterator() : payload_(NULL), read_index_(0), end_index_(0) {}
+  PickleIterator()
+      : payload_(NULL),
+        read_index_(0),
+        end_index_(0),
+        encoding_(PickleEncoding::kAligned) {}
+  // Reads |pickle| with the encoding it was written with.
   explicit PickleIterator(const Pickle& pickle);
+  // Reads |pickle| as data written with |encoding|, e.g. for a Pickle
+  // initialized from received data.
+  PickleIterator(const Pickle& pickle, PickleEncoding encoding);
 
   // Methods for reading the payload of the Pickle. To read from the start of
   // the Pickle, create a PickleIterator from a Pickle. If successful, these
@@ -84,8 +107,25 @@ class BASE_EXPORT PickleIterator {
   template <typename Type>
   bool ReadBuiltinType(Type* result);
 
+  // Reads a varint of a compact pickle.
+  bool ReadVarint(uint64_t* result);
+
+  // Reads a zigzag-encoded varint of a compact pickle, and checks that it fits
+  // in Type.
+  template <typename Type>
+  bool ReadSignedVarint(Type* result);
+
+  // Reads an unsigned varint of a compact pickle, and checks that it fits in
+  // Type.
+  template <typename Type>
+  bool ReadUnsignedVarint(Type* result);
+
+  // Reads the length of a string or of data, which is never negative in
+  // compact pickles.
+  bool ReadLengthPrefix(int* result);
+
   // Advance read_index_ but do not allow it to exceed end_index_.
-  // Keeps read_index_ aligned.
+  // Keeps read_index_ aligned, unless the encoding is compact.
   void Advance(size_t size);
 
   // Get read pointer for Type and advance read pointer.
@@ -104,6 +144,7 @@ class BASE_EXPORT PickleIterator {
   const char* payload_;  // Start of our pickle's payload.
   size_t read_index_;  // Offset of the next readable byte in payload.
   size_t end_index_;  // Payload size.
+  PickleEncoding encoding_;
 
   FRIEND_TEST_ALL_PREFIXES(PickleTest, GetReadPointerAndAdvance);
 };
@@ -150,12 +191,21 @@ class BASE_EXPORT Pickle {
   // will be rounded up to ensure that the header size is 32bit-aligned.
   explicit Pickle(int header_size);
 
+  // Initialize a Pickle object with the specified header size, whose payload
+  // is written with |encoding|. The data must be read with the same encoding.
+  Pickle(int header_size, PickleEncoding encoding);
+
   // Initializes a Pickle from a const block of data.  The data is not copied;
   // instead the data is merely referenced by this Pickle.  Only const methods
   // should be used on the Pickle when initialized this way.  The header
   // padding size is deduced from the data length.
   Pickle(const char* data, int data_len);
 
+  // Same as above for data held in a span, such as a mapping of shared memory
+  // or of a file, which can then be read without being copied. |data| must
+  // hold exactly one pickle and outlive this Pickle.
+  explicit Pickle(span<const uint8_t> data);
+
   // Initializes a Pickle as a deep copy of another Pickle.
   Pickle(const Pickle& other);
 
@@ -186,17 +236,47 @@ class BASE_EXPORT Pickle {
   // Pickle, it is important to read them in the order in which they were added
   // to the Pickle.
 
-  void WriteBool(bool value) { WriteInt(value ? 1 : 0); }
-  void WriteInt(int value) { WritePOD(value); }
+  void WriteBool(bool value) {
+    if (UNLIKELY(is_compact()))
+      WriteVarint(value ? 1 : 0);
+    else
+      WriteInt(value ? 1 : 0);
+  }
+  void WriteInt(int value) {
+    if (UNLIKELY(is_compact()))
+      WriteSignedVarint(value);
+    else
+      WritePOD(value);
+  }
   void WriteLong(long value) {
     // Always write long as a 64-bit value to ensure compatibility between
     // 32-bit and 64-bit processes.
-    WritePOD(static_cast<int64_t>(value));
+    WriteInt64(static_cast<int64_t>(value));
+  }
+  void WriteUInt16(uint16_t value) {
+    if (UNLIKELY(is_compact()))
+      WriteVarint(value);
+    else
+      WritePOD(value);
+  }
+  void WriteUInt32(uint32_t value) {
+    if (UNLIKELY(is_compact()))
+      WriteVarint(value);
+    else
+      WritePOD(value);
+  }
+  void WriteInt64(int64_t value) {
+    if (UNLIKELY(is_compact()))
+      WriteSignedVarint(value);
+    else
+      WritePOD(value);
+  }
+  void WriteUInt64(uint64_t value) {
+    if (UNLIKELY(is_compact()))
+      WriteVarint(value);
+    else
+      WritePOD(value);
   }
-  void WriteUInt16(uint16_t value) { WritePOD(value); }
-  void WriteUInt32(uint32_t value) { WritePOD(value); }
-  void WriteInt64(int64_t value) { WritePOD(value); }
-  void WriteUInt64(uint64_t value) { WritePOD(value); }
   void WriteFloat(float value) { WritePOD(value); }
   void WriteDouble(double value) { WritePOD(value); }
   void WriteString(const StringPiece& value);
@@ -227,6 +307,9 @@ class BASE_EXPORT Pickle {
   // Reserve() before calling WriteFoo() multiple times.
   void Reserve(size_t additional_capacity);
 
+  // Returns the encoding of the payload.
+  PickleEncoding encoding() const { return encoding_; }
+
   // Payload follows after allocation of Header (header size is customizable).
   struct Header {
     uint32_t payload_size;  // Specifies the size of the payload.
@@ -282,6 +365,7 @@ class BASE_EXPORT Pickle {
   // Claims |num_bytes| bytes of payload. This is similar to Reserve() in that
   // it may grow the capacity, but it also advances the write offset of the
   // pickle by |num_bytes|. Claimed memory, including padding, is zeroed.
+  // Compact pickles have no padding.
   //
   // Returns the address of the first byte claimed.
   void* ClaimBytes(size_t num_bytes);
@@ -309,6 +393,7 @@ class BASE_EXPORT Pickle {
 
  private:
   friend class PickleIterator;
+  friend class SegmentedPickleWriter;
 
   Header* header_;
   size_t header_size_;  // Supports extra data between header and payload.
@@ -318,6 +403,22 @@ class BASE_EXPORT Pickle {
   // The offset at which we will write the next field. Note: this doesn't count
   // the header.
   size_t write_offset_;
+  PickleEncoding encoding_;
+
+  bool is_compact() const { return encoding_ == PickleEncoding::kCompact; }
+
+  // Writes |value| as a LEB128 varint, in compact pickles.
+  void WriteVarint(uint64_t value);
+
+  // Writes |value| zigzag-encoded as a varint, in compact pickles, so that
+  // small negative values are short too.
+  void WriteSignedVarint(int64_t value) {
+    WriteVarint((static_cast<uint64_t>(value) << 1) ^
+                static_cast<uint64_t>(value >> 63));
+  }
+
+  // Writes the length of a string or of data.
+  void WriteLengthPrefix(size_t length);
 
   // Just like WriteBytes, but with a compile-time size, for performance.
   template<size_t length> void BASE_EXPORT WriteBytesStatic(const void* data);
@@ -340,6 +441,53 @@ class BASE_EXPORT Pickle {
   FRIEND_TEST_ALL_PREFIXES(PickleTest, FindNextOverflow);
 };
 
+// Writes the same data as a Pickle, except that the blobs passed to
+// WriteDataUnowned() are referenced rather than copied. The data is then
+// retrieved as a list of segments, to be sent with writev() or an equivalent
+// scatter-gather API. This avoids copying large payloads into the Pickle.
+class BASE_EXPORT SegmentedPickleWriter {
+ public:
+  // Initializes the writer with the default header size, or with
+  // |header_size|. See the Pickle constructors.
+  SegmentedPickleWriter();
+  explicit SegmentedPickleWriter(int header_size);
+  ~SegmentedPickleWriter();
+
+  // Returns the Pickle holding the header and everything written except the
+  // unowned blobs. Values written to it are copied as usual, and follow the
+  // unowned blobs written before them.
+  Pickle* pickle() { return &pickle_; }
+
+  // Same as pickle()->WriteData(), except that |data| isn't copied. It must
+  // stay valid and unchanged for as long as the segments are used.
+  void WriteDataUnowned(span<const uint8_t> data);
+
+  // Returns the number of bytes of data, including the header.
+  size_t size() const;
+
+  // Returns the segments which, concatenated, make the data of a Pickle into
+  // which all the values were written. The header segment gets the payload
+  // size of the whole data. The segments are valid until the next write.
+  std::vector<span<const uint8_t>> GetSegments();
+
+ private:
+  // A blob written with WriteDataUnowned(), which starts at |offset| in the
+  // payload of the whole data, not counting the previous unowned blobs.
+  struct UnownedData {
+    size_t offset;
+    span<const uint8_t> data;
+  };
+
+  Pickle pickle_;
+  std::vector<UnownedData> unowned_data_;
+  // The sum of the sizes of the unowned blobs, including padding.
+  size_t unowned_size_ = 0;
+  // Copy of the header of |pickle_| with the payload size of the whole data.
+  std::vector<uint32_t> header_;
+
+  DISALLOW_COPY_AND_ASSIGN(SegmentedPickleWriter);
+};
+
 }  // namespace base
 
 #endif  // BASE_PICKLE_H_
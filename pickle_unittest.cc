@@ -8,6 +8,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <limits>
 #include <memory>
 #include <string>
 
@@ -139,6 +140,146 @@ TEST(PickleTest, EncodeDecode) {
   VerifyResult(pickle3);
 }
 
+TEST(PickleTest, EncodeDecodeCompact) {
+  Pickle pickle(sizeof(Pickle::Header), PickleEncoding::kCompact);
+
+  pickle.WriteBool(testbool1);
+  pickle.WriteBool(testbool2);
+  pickle.WriteInt(testint);
+  pickle.WriteLong(testlong);
+  pickle.WriteUInt16(testuint16);
+  pickle.WriteUInt32(testuint32);
+  pickle.WriteInt64(testint64);
+  pickle.WriteUInt64(testuint64);
+  pickle.WriteFloat(testfloat);
+  pickle.WriteDouble(testdouble);
+  pickle.WriteString(teststring);
+  pickle.WriteString16(teststring16);
+  pickle.WriteString(testrawstring);
+  pickle.WriteString16(testrawstring16);
+  pickle.WriteData(testdata, testdatalen);
+  VerifyResult(pickle);
+
+  Pickle copy(pickle);
+  VerifyResult(copy);
+
+  // Received data must be read with the encoding it was written with.
+  Pickle view(static_cast<const char*>(pickle.data()), pickle.size());
+  EXPECT_EQ(PickleEncoding::kAligned, view.encoding());
+  PickleIterator iter(view, PickleEncoding::kCompact);
+  bool outbool;
+  EXPECT_TRUE(iter.ReadBool(&outbool));
+  EXPECT_FALSE(outbool);
+}
+
+TEST(PickleTest, CompactIsSmaller) {
+  Pickle aligned;
+  Pickle compact(sizeof(Pickle::Header), PickleEncoding::kCompact);
+  for (Pickle* pickle : {&aligned, &compact}) {
+    pickle->WriteInt(1);
+    pickle->WriteUInt64(2);
+    pickle->WriteBool(true);
+    pickle->WriteString("abc");
+  }
+  EXPECT_EQ(4u + 8u + 4u + 8u, aligned.payload_size());
+  // One byte per integer, and one byte of length before the string.
+  EXPECT_EQ(1u + 1u + 1u + 4u, compact.payload_size());
+}
+
+TEST(PickleTest, CompactVarints) {
+  const int64_t kSigned[] = {0,
+                             1,
+                             -1,
+                             63,
+                             -64,
+                             64,
+                             std::numeric_limits<int64_t>::max(),
+                             std::numeric_limits<int64_t>::min()};
+  const uint64_t kUnsigned[] = {0, 127, 128, 16383, 16384,
+                                std::numeric_limits<uint64_t>::max()};
+
+  Pickle pickle(sizeof(Pickle::Header), PickleEncoding::kCompact);
+  for (int64_t value : kSigned)
+    pickle.WriteInt64(value);
+  for (uint64_t value : kUnsigned)
+    pickle.WriteUInt64(value);
+
+  PickleIterator iter(pickle);
+  for (int64_t value : kSigned) {
+    int64_t out;
+    EXPECT_TRUE(iter.ReadInt64(&out));
+    EXPECT_EQ(value, out);
+  }
+  for (uint64_t value : kUnsigned) {
+    uint64_t out;
+    EXPECT_TRUE(iter.ReadUInt64(&out));
+    EXPECT_EQ(value, out);
+  }
+  uint64_t out;
+  EXPECT_FALSE(iter.ReadUInt64(&out));
+}
+
+TEST(PickleTest, CompactRejectsBadVarints) {
+  // Values which don't fit in the type read.
+  {
+    Pickle pickle(sizeof(Pickle::Header), PickleEncoding::kCompact);
+    pickle.WriteUInt64(std::numeric_limits<uint32_t>::max() + 1ULL);
+    PickleIterator iter(pickle);
+    uint32_t out;
+    EXPECT_FALSE(iter.ReadUInt32(&out));
+  }
+  {
+    Pickle pickle(sizeof(Pickle::Header), PickleEncoding::kCompact);
+    pickle.WriteInt64(std::numeric_limits<int64_t>::min());
+    PickleIterator iter(pickle);
+    int out;
+    EXPECT_FALSE(iter.ReadInt(&out));
+  }
+  {
+    Pickle pickle(sizeof(Pickle::Header), PickleEncoding::kCompact);
+    pickle.WriteUInt32(2);
+    PickleIterator iter(pickle);
+    bool out;
+    EXPECT_FALSE(iter.ReadBool(&out));
+  }
+  // A negative length.
+  {
+    Pickle pickle(sizeof(Pickle::Header), PickleEncoding::kCompact);
+    pickle.WriteInt(-1);
+    PickleIterator iter(pickle);
+    std::string out;
+    EXPECT_FALSE(iter.ReadString(&out));
+  }
+  // A varint continued past the end of the payload.
+  {
+    Pickle pickle(sizeof(Pickle::Header), PickleEncoding::kCompact);
+    const uint8_t kTruncated[] = {0x80, 0x80};
+    pickle.WriteBytes(kTruncated, sizeof(kTruncated));
+    PickleIterator iter(pickle);
+    uint64_t out;
+    EXPECT_FALSE(iter.ReadUInt64(&out));
+  }
+  // A varint longer than any uint64_t, or with bits beyond 64.
+  {
+    Pickle pickle(sizeof(Pickle::Header), PickleEncoding::kCompact);
+    const uint8_t kTooLong[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                0xff, 0xff, 0xff, 0x80, 0x01};
+    pickle.WriteBytes(kTooLong, sizeof(kTooLong));
+    PickleIterator iter(pickle);
+    uint64_t out;
+    EXPECT_FALSE(iter.ReadUInt64(&out));
+  }
+  {
+    Pickle pickle(sizeof(Pickle::Header), PickleEncoding::kCompact);
+    const uint8_t kTooBig[] = {0xff, 0xff, 0xff, 0xff, 0xff,
+                               0xff, 0xff, 0xff, 0xff, 0x02};
+    pickle.WriteBytes(kTooBig, sizeof(kTooBig));
+    PickleIterator iter(pickle);
+    uint64_t out;
+    EXPECT_FALSE(iter.ReadUInt64(&out));
+  }
+}
+
 // Tests that reading/writing a long works correctly when the source process
 // is 64-bit.  We rely on having both 32- and 64-bit trybots to validate both
 // arms of the conditional in this test.
@@ -570,4 +711,105 @@ TEST(PickleTest, ClaimBytes) {
   EXPECT_EQ(42, out_value);
 }
 
+TEST(PickleTest, FromSpan) {
+  Pickle pickle;
+  pickle.WriteInt(42);
+  pickle.WriteString(teststring);
+
+  Pickle view(make_span(static_cast<const uint8_t*>(pickle.data()),
+                        pickle.size()));
+  EXPECT_EQ(pickle.data(), view.data());
+  EXPECT_EQ(0u, view.GetTotalAllocatedSize());
+
+  PickleIterator iter(view);
+  int out_int;
+  EXPECT_TRUE(iter.ReadInt(&out_int));
+  EXPECT_EQ(42, out_int);
+  std::string out_string;
+  EXPECT_TRUE(iter.ReadString(&out_string));
+  EXPECT_EQ(teststring, out_string);
+
+  // Data that isn't a pickle is rejected.
+  const uint8_t kGarbage[] = {1, 2, 3};
+  Pickle bad_view((span<const uint8_t>(kGarbage)));
+  EXPECT_FALSE(bad_view.data());
+}
+
+TEST(PickleTest, SegmentedPickleWriter) {
+  const std::string blob1(3 * 1024 * 1024 + 1, 'x');
+  const std::string blob2(100, 'y');
+
+  SegmentedPickleWriter writer;
+  writer.pickle()->WriteInt(42);
+  writer.WriteDataUnowned(as_bytes(make_span(blob1)));
+  writer.WriteDataUnowned(as_bytes(make_span(blob2)));
+  writer.pickle()->WriteString(teststring);
+  writer.WriteDataUnowned(span<const uint8_t>());
+  // Only the small values were copied.
+  EXPECT_LT(writer.pickle()->GetTotalAllocatedSize(), blob2.size());
+
+  Pickle expected;
+  expected.WriteInt(42);
+  expected.WriteData(blob1.data(), blob1.size());
+  expected.WriteData(blob2.data(), blob2.size());
+  expected.WriteString(teststring);
+  expected.WriteData(nullptr, 0);
+  EXPECT_EQ(expected.size(), writer.size());
+
+  std::string data;
+  bool found_blob1 = false;
+  for (span<const uint8_t> segment : writer.GetSegments()) {
+    found_blob1 |= segment.data() == as_bytes(make_span(blob1)).data();
+    data.append(reinterpret_cast<const char*>(segment.data()),
+                segment.size());
+  }
+  EXPECT_TRUE(found_blob1);
+  EXPECT_EQ(std::string(static_cast<const char*>(expected.data()),
+                        expected.size()),
+            data);
+
+  Pickle pickle(data.data(), data.size());
+  PickleIterator iter(pickle);
+  int out_int;
+  EXPECT_TRUE(iter.ReadInt(&out_int));
+  EXPECT_EQ(42, out_int);
+  const char* out_data;
+  int out_length;
+  EXPECT_TRUE(iter.ReadData(&out_data, &out_length));
+  EXPECT_EQ(blob1, std::string(out_data, out_length));
+  EXPECT_TRUE(iter.ReadData(&out_data, &out_length));
+  EXPECT_EQ(blob2, std::string(out_data, out_length));
+  std::string out_string;
+  EXPECT_TRUE(iter.ReadString(&out_string));
+  EXPECT_EQ(teststring, out_string);
+  EXPECT_TRUE(iter.ReadData(&out_data, &out_length));
+  EXPECT_EQ(0, out_length);
+}
+
+TEST(PickleTest, SegmentedPickleWriterCustomHeader) {
+  struct CustomHeader : Pickle::Header {
+    int blah;
+  };
+
+  SegmentedPickleWriter writer(sizeof(CustomHeader));
+  writer.pickle()->headerT<CustomHeader>()->blah = 10;
+  const std::string blob(5, 'z');
+  writer.WriteDataUnowned(as_bytes(make_span(blob)));
+
+  std::string data;
+  for (span<const uint8_t> segment : writer.GetSegments()) {
+    data.append(reinterpret_cast<const char*>(segment.data()),
+                segment.size());
+  }
+  EXPECT_EQ(writer.size(), data.size());
+
+  Pickle pickle(data.data(), data.size());
+  EXPECT_EQ(10, pickle.headerT<CustomHeader>()->blah);
+  PickleIterator iter(pickle);
+  const char* out_data;
+  int out_length;
+  EXPECT_TRUE(iter.ReadData(&out_data, &out_length));
+  EXPECT_EQ(blob, std::string(out_data, out_length));
+}
+
 }  // namespace base
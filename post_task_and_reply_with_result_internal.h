@@ -5,9 +5,19 @@
 #ifndef BASE_POST_TASK_AND_REPLY_WITH_RESULT_INTERNAL_H_
 #define BASE_POST_TASK_AND_REPLY_WITH_RESULT_INTERNAL_H_
 
+#include <memory>
 #include <utility>
 
+#include "base/bind.h"
 #include "base/callback.h"
+#include "base/debug/leak_annotations.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/optional.h"
+#include "base/sequenced_task_runner.h"
+#include "base/threading/sequenced_task_runner_handle.h"
 
 namespace base {
 
@@ -27,6 +37,80 @@ void ReplyAdapter(OnceCallback<void(ReplyArgType)> callback,
   std::move(callback).Run(std::move(*result));
 }
 
+// Carries a task, its reply and the task's result between the two sequences of
+// a PostTaskAndReplyWithResult(). It is bound by value into the task and then
+// into the reply, so that a hop takes two BindState allocations rather than a
+// heap-allocated result, two adapter callbacks and a PostTaskAndReplyRelay.
+// Callbacks that didn't run are destroyed on the reply sequence, and the reply
+// runs right after the task if both run on the same SequencedTaskRunner, as
+// with PostTaskAndReplyRelay in post_task_and_reply_impl.cc.
+template <typename TaskReturnType, typename ReplyArgType>
+class PostTaskAndReplyWithResultRelay {
+ public:
+  // |task_runner| is the TaskRunner which |task| is posted to.
+  PostTaskAndReplyWithResultRelay(const TaskRunner* task_runner,
+                                  const Location& from_here,
+                                  OnceCallback<TaskReturnType()> task,
+                                  OnceCallback<void(ReplyArgType)> reply)
+      : from_here_(from_here),
+        task_(std::move(task)),
+        reply_(std::move(reply)),
+        reply_task_runner_(SequencedTaskRunnerHandle::Get()),
+        run_reply_inline_(task_runner == reply_task_runner_.get()) {}
+  PostTaskAndReplyWithResultRelay(PostTaskAndReplyWithResultRelay&&) = default;
+
+  ~PostTaskAndReplyWithResultRelay() {
+    if (reply_ && !reply_task_runner_->RunsTasksInCurrentSequence()) {
+      // |task_| was cancelled or posting |reply_| failed. Destroy callbacks on
+      // the reply sequence, to which they can be affine.
+      auto relay_to_delete =
+          std::make_unique<PostTaskAndReplyWithResultRelay>(std::move(*this));
+      ANNOTATE_LEAKING_OBJECT_PTR(relay_to_delete.get());
+      reply_task_runner_->DeleteSoon(from_here_, std::move(relay_to_delete));
+    }
+  }
+
+  PostTaskAndReplyWithResultRelay& operator=(
+      PostTaskAndReplyWithResultRelay&&) = delete;
+
+  static void RunTaskAndPostReply(PostTaskAndReplyWithResultRelay relay) {
+    DCHECK(relay.task_);
+    relay.result_.emplace(std::move(relay.task_).Run());
+
+    if (relay.run_reply_inline_) {
+      DCHECK(relay.reply_task_runner_->RunsTasksInCurrentSequence());
+      RunReply(std::move(relay));
+      return;
+    }
+
+    // Keep a reference to the reply TaskRunner for the PostTask() call before
+    // |relay| is moved into a callback.
+    scoped_refptr<SequencedTaskRunner> reply_task_runner =
+        relay.reply_task_runner_;
+    reply_task_runner->PostTask(
+        relay.from_here_,
+        BindOnce(&PostTaskAndReplyWithResultRelay::RunReply, std::move(relay)));
+  }
+
+ private:
+  static void RunReply(PostTaskAndReplyWithResultRelay relay) {
+    DCHECK(!relay.task_);
+    DCHECK(relay.reply_);
+    std::move(relay.reply_).Run(std::move(*relay.result_));
+  }
+
+  const Location from_here_;
+  OnceCallback<TaskReturnType()> task_;
+  OnceCallback<void(ReplyArgType)> reply_;
+  Optional<TaskReturnType> result_;
+  const scoped_refptr<SequencedTaskRunner> reply_task_runner_;
+  // Whether |task_| runs on |reply_task_runner_|, so that |reply_| can run
+  // right after it.
+  const bool run_reply_inline_;
+
+  DISALLOW_COPY_AND_ASSIGN(PostTaskAndReplyWithResultRelay);
+};
+
 }  // namespace internal
 
 }  // namespace base
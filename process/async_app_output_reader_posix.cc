@@ -0,0 +1,148 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/process/async_app_output_reader_posix.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/location.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/process/kill.h"
+#include "base/process/launch.h"
+#include "base/task_scheduler/post_task.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+
+namespace base {
+
+namespace {
+
+// The most read from the output at a time.
+constexpr size_t kReadBufferSize = 16 * 1024;
+
+Optional<int> WaitForExitCode(Process process) {
+  int exit_code;
+  if (!process.WaitForExit(&exit_code))
+    return nullopt;
+  return exit_code;
+}
+
+}  // namespace
+
+AsyncAppOutputReader::AsyncAppOutputReader(
+    const std::vector<std::string>& argv,
+    const Options& options,
+    OutputCallback output,
+    DoneCallback done)
+    : max_output_size_(options.max_output_size),
+      output_(std::move(output)),
+      done_(std::move(done)),
+      weak_factory_(this) {
+  DCHECK(done_);
+  int pipe_fds[2];
+  if (pipe(pipe_fds) == 0) {
+    read_fd_.reset(pipe_fds[0]);
+    // Closed once the child was launched, so that the output ends when the
+    // child closes its end.
+    ScopedFD write_fd(pipe_fds[1]);
+
+    LaunchOptions launch_options;
+    launch_options.fds_to_remap.emplace_back(write_fd.get(), STDOUT_FILENO);
+    if (options.include_stderr)
+      launch_options.fds_to_remap.emplace_back(write_fd.get(), STDERR_FILENO);
+    process_ = LaunchProcess(argv, launch_options);
+  }
+
+  if (!process_.IsValid() || !SetNonBlocking(read_fd_.get())) {
+    if (process_.IsValid())
+      Terminate(RESULT_LAUNCH_FAILED);
+    else
+      Finish(RESULT_LAUNCH_FAILED, EXIT_FAILURE);
+    return;
+  }
+
+  read_watcher_ = FileDescriptorWatcher::WatchReadable(
+      read_fd_.get(), BindRepeating(&AsyncAppOutputReader::OnReadable,
+                                    Unretained(this)));
+}
+
+AsyncAppOutputReader::~AsyncAppOutputReader() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (process_.IsValid()) {
+    process_.Terminate(EXIT_FAILURE, false);
+    EnsureProcessTerminated(std::move(process_));
+  }
+}
+
+void AsyncAppOutputReader::OnReadable() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  char buffer[kReadBufferSize];
+  const ssize_t bytes_read =
+      HANDLE_EINTR(read(read_fd_.get(), buffer, sizeof(buffer)));
+  if (bytes_read < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK)
+      Terminate(RESULT_FAILED);
+    return;
+  }
+  if (bytes_read == 0) {
+    WaitForExit();
+    return;
+  }
+
+  const size_t remaining_size = max_output_size_ - output_size_;
+  const size_t chunk_size = std::min<size_t>(bytes_read, remaining_size);
+  output_size_ += chunk_size;
+  if (output_ && chunk_size)
+    output_.Run(StringPiece(buffer, chunk_size));
+  if (static_cast<size_t>(bytes_read) > remaining_size)
+    Terminate(RESULT_OUTPUT_LIMIT_EXCEEDED);
+}
+
+void AsyncAppOutputReader::WaitForExit() {
+  read_watcher_.reset();
+  read_fd_.reset();
+  // The process normally exits right after closing its output, so this
+  // doesn't hold the worker for long.
+  PostTaskWithTraitsAndReplyWithResult(
+      FROM_HERE,
+      {MayBlock(), WithBaseSyncPrimitives(),
+       TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN},
+      BindOnce(&WaitForExitCode, std::move(process_)),
+      BindOnce(&AsyncAppOutputReader::OnExited, weak_factory_.GetWeakPtr()));
+}
+
+void AsyncAppOutputReader::OnExited(Optional<int> exit_code) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (exit_code)
+    RunDoneCallback(RESULT_EXITED, *exit_code);
+  else
+    RunDoneCallback(RESULT_FAILED, EXIT_FAILURE);
+}
+
+void AsyncAppOutputReader::Terminate(Result result) {
+  read_watcher_.reset();
+  read_fd_.reset();
+  process_.Terminate(EXIT_FAILURE, false);
+  EnsureProcessTerminated(std::move(process_));
+  Finish(result, EXIT_FAILURE);
+}
+
+void AsyncAppOutputReader::Finish(Result result, int exit_code) {
+  SequencedTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, BindOnce(&AsyncAppOutputReader::RunDoneCallback,
+                          weak_factory_.GetWeakPtr(), result, exit_code));
+}
+
+void AsyncAppOutputReader::RunDoneCallback(Result result, int exit_code) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  std::move(done_).Run(result, exit_code);
+}
+
+}  // namespace base
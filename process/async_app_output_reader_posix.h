@@ -0,0 +1,112 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PROCESS_ASYNC_APP_OUTPUT_READER_POSIX_H_
+#define BASE_PROCESS_ASYNC_APP_OUTPUT_READER_POSIX_H_
+
+#include <stddef.h>
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/files/file_descriptor_watcher_posix.h"
+#include "base/files/scoped_file.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/optional.h"
+#include "base/process/process.h"
+#include "base/sequence_checker.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+
+// Like GetAppOutput(), but without blocking the calling sequence: launches a
+// command, streams its output to a callback as it's read and reports how it
+// ended on the sequence which created the reader. The output is watched with
+// FileDescriptorWatcher, so the reader must be created on a sequence where
+// FileDescriptorWatcher::WatchReadable() can be called. Only waiting for the
+// process to exit, once its output ended, uses a TaskScheduler worker.
+//
+// Example:
+//
+//   reader_ = std::make_unique<AsyncAppOutputReader>(
+//       argv, AsyncAppOutputReader::Options(),
+//       BindRepeating(&Helper::OnOutput, weak_factory_.GetWeakPtr()),
+//       BindOnce(&Helper::OnDone, weak_factory_.GetWeakPtr()));
+class BASE_EXPORT AsyncAppOutputReader {
+ public:
+  enum Result {
+    // The process exited, with the exit code passed to the DoneCallback.
+    RESULT_EXITED,
+    RESULT_LAUNCH_FAILED,
+    // The output was longer than Options::max_output_size, and the process
+    // was terminated once the output up to the limit was passed on.
+    RESULT_OUTPUT_LIMIT_EXCEEDED,
+    // Reading the output or waiting for the process failed, and the process
+    // was terminated.
+    RESULT_FAILED,
+  };
+
+  struct BASE_EXPORT Options {
+    // Whether stderr is read along with stdout, like GetAppOutputAndError().
+    bool include_stderr = false;
+    size_t max_output_size = std::numeric_limits<size_t>::max();
+  };
+
+  // Runs with each chunk of the output, as it's read. It must not delete the
+  // reader.
+  using OutputCallback = RepeatingCallback<void(StringPiece chunk)>;
+  // Runs once the process exited, or failed. |exit_code| is only meaningful
+  // with RESULT_EXITED.
+  using DoneCallback = OnceCallback<void(Result result, int exit_code)>;
+
+  // Launches |argv| and starts reading its output. |output| may be null, if
+  // only the result matters. |done| never runs before the constructor
+  // returns. Deleting the reader terminates the process if it's still running,
+  // and no callback runs after that.
+  AsyncAppOutputReader(const std::vector<std::string>& argv,
+                       const Options& options,
+                       OutputCallback output,
+                       DoneCallback done);
+  ~AsyncAppOutputReader();
+
+ private:
+  void OnReadable();
+
+  // Waits for the process to exit on a worker, once its output ended.
+  void WaitForExit();
+  void OnExited(Optional<int> exit_code);
+
+  // Terminates the process, and finishes with |result|.
+  void Terminate(Result result);
+
+  // Runs |done_| in a task, since Finish() may be called from the
+  // constructor or from the output callback.
+  void Finish(Result result, int exit_code);
+  void RunDoneCallback(Result result, int exit_code);
+
+  const size_t max_output_size_;
+  OutputCallback output_;
+  DoneCallback done_;
+
+  // Valid until it's handed over to be waited for or terminated.
+  Process process_;
+  ScopedFD read_fd_;
+  std::unique_ptr<FileDescriptorWatcher::Controller> read_watcher_;
+  size_t output_size_ = 0;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  WeakPtrFactory<AsyncAppOutputReader> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncAppOutputReader);
+};
+
+}  // namespace base
+
+#endif  // BASE_PROCESS_ASYNC_APP_OUTPUT_READER_POSIX_H_
@@ -0,0 +1,107 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/process/async_app_output_reader_posix.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/run_loop.h"
+#include "base/test/scoped_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class AsyncAppOutputReaderTest : public testing::Test {
+ protected:
+  AsyncAppOutputReaderTest()
+      : scoped_task_environment_(
+            test::ScopedTaskEnvironment::MainThreadType::IO) {}
+
+  // Runs |script| with the shell and waits until it's over.
+  void RunScript(const char* script,
+                 const AsyncAppOutputReader::Options& options =
+                     AsyncAppOutputReader::Options()) {
+    Run({"/bin/sh", "-c", script}, options);
+  }
+
+  void Run(const std::vector<std::string>& argv,
+           const AsyncAppOutputReader::Options& options) {
+    output_.clear();
+    RunLoop run_loop;
+    AsyncAppOutputReader reader(
+        argv, options,
+        BindRepeating(&AsyncAppOutputReaderTest::OnOutput, Unretained(this)),
+        BindOnce(&AsyncAppOutputReaderTest::OnDone, Unretained(this),
+                 run_loop.QuitClosure()));
+    run_loop.Run();
+  }
+
+  void OnOutput(StringPiece chunk) { chunk.AppendToString(&output_); }
+
+  void OnDone(OnceClosure quit_closure,
+              AsyncAppOutputReader::Result result,
+              int exit_code) {
+    result_ = result;
+    exit_code_ = exit_code;
+    std::move(quit_closure).Run();
+  }
+
+  test::ScopedTaskEnvironment scoped_task_environment_;
+  std::string output_;
+  AsyncAppOutputReader::Result result_ = AsyncAppOutputReader::RESULT_FAILED;
+  int exit_code_ = -1;
+};
+
+}  // namespace
+
+TEST_F(AsyncAppOutputReaderTest, Output) {
+  RunScript("echo hello; echo error >&2; exit 3");
+  EXPECT_EQ(AsyncAppOutputReader::RESULT_EXITED, result_);
+  EXPECT_EQ(3, exit_code_);
+  EXPECT_EQ("hello\n", output_);
+
+  AsyncAppOutputReader::Options options;
+  options.include_stderr = true;
+  RunScript("echo hello; echo error >&2", options);
+  EXPECT_EQ(AsyncAppOutputReader::RESULT_EXITED, result_);
+  EXPECT_EQ(0, exit_code_);
+  EXPECT_EQ("hello\nerror\n", output_);
+}
+
+TEST_F(AsyncAppOutputReaderTest, LongOutput) {
+  // Longer than a pipe buffer, so that it's read in several chunks.
+  RunScript(
+      "i=0; while [ $i -lt 10000 ]; do echo 0123456789; i=$((i+1)); done");
+  EXPECT_EQ(AsyncAppOutputReader::RESULT_EXITED, result_);
+  EXPECT_EQ(0, exit_code_);
+  std::string expected;
+  for (int i = 0; i < 10000; ++i)
+    expected += "0123456789\n";
+  EXPECT_EQ(expected, output_);
+}
+
+TEST_F(AsyncAppOutputReaderTest, OutputLimit) {
+  AsyncAppOutputReader::Options options;
+  options.max_output_size = 1000;
+  RunScript("while true; do echo 0123456789; done", options);
+  EXPECT_EQ(AsyncAppOutputReader::RESULT_OUTPUT_LIMIT_EXCEEDED, result_);
+  EXPECT_EQ(1000u, output_.size());
+
+  RunScript("printf 0123456789", options);
+  EXPECT_EQ(AsyncAppOutputReader::RESULT_EXITED, result_);
+  EXPECT_EQ("0123456789", output_);
+}
+
+TEST_F(AsyncAppOutputReaderTest, MissingExecutable) {
+  Run({"/nonexistent/executable"}, AsyncAppOutputReader::Options());
+  // The child fails to execute the program after it was launched.
+  EXPECT_EQ(AsyncAppOutputReader::RESULT_EXITED, result_);
+  EXPECT_EQ(127, exit_code_);
+}
+
+}  // namespace base
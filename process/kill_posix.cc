@@ -16,6 +16,7 @@
 #include "base/macros.h"
 #include "base/posix/eintr_wrapper.h"
 #include "base/process/process_iterator.h"
+#include "base/process/process_reaper_posix.h"
 #include "base/task_scheduler/post_task.h"
 #include "base/threading/platform_thread.h"
 #include "build/build_config.h"
@@ -133,38 +134,15 @@ bool CleanupProcesses(const FilePath::StringType& executable_name,
 
 #if !defined(OS_MACOSX)
 
-namespace {
-
-class BackgroundReaper : public PlatformThread::Delegate {
- public:
-  BackgroundReaper(base::Process child_process, const TimeDelta& wait_time)
-      : child_process_(std::move(child_process)), wait_time_(wait_time) {}
-
-  void ThreadMain() override {
-    if (!wait_time_.is_zero()) {
-      child_process_.WaitForExitWithTimeout(wait_time_, nullptr);
-      kill(child_process_.Handle(), SIGKILL);
-    }
-    child_process_.WaitForExit(nullptr);
-    delete this;
-  }
-
- private:
-  Process child_process_;
-  const TimeDelta wait_time_;
-  DISALLOW_COPY_AND_ASSIGN(BackgroundReaper);
-};
-
-}  // namespace
-
 void EnsureProcessTerminated(Process process) {
   DCHECK(!process.is_current());
 
   if (process.WaitForExitWithTimeout(TimeDelta(), nullptr))
     return;
 
-  PlatformThread::CreateNonJoinable(
-      0, new BackgroundReaper(std::move(process), TimeDelta::FromSeconds(2)));
+  ProcessReaper::GetInstance()->Watch(process.Handle(),
+                                      TimeDelta::FromSeconds(2),
+                                      ProcessReaper::ExitCallback());
 }
 
 #if defined(OS_LINUX)
@@ -175,8 +153,8 @@ void EnsureProcessGetsReaped(Process process) {
   if (process.WaitForExitWithTimeout(TimeDelta(), nullptr))
     return;
 
-  PlatformThread::CreateNonJoinable(
-      0, new BackgroundReaper(std::move(process), TimeDelta()));
+  ProcessReaper::GetInstance()->Watch(process.Handle(), TimeDelta(),
+                                      ProcessReaper::ExitCallback());
 }
 #endif  // defined(OS_LINUX)
 
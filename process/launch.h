@@ -256,6 +256,9 @@ struct BASE_EXPORT LaunchOptions {
 //   parent's stdout and stderr.
 // - If the first argument on the command line does not contain a slash,
 //   PATH will be searched.  (See man execvp.)
+// - On Linux, the child is created with clone(CLONE_VM | CLONE_VFORK), which
+//   doesn't copy the page tables of the parent, unless options::clone_flags or
+//   options::pre_exec_delegate are set and fork() is needed.
 BASE_EXPORT Process LaunchProcess(const CommandLine& cmdline,
                                   const LaunchOptions& options);
 
@@ -7,12 +7,14 @@
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <sched.h>
 #include <setjmp.h>
 #include <signal.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/resource.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
@@ -37,9 +39,11 @@
 #include "base/posix/eintr_wrapper.h"
 #include "base/process/process.h"
 #include "base/process/process_metrics.h"
+#include "base/rand_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/threading/platform_thread.h"
+#include "base/threading/platform_thread_internal_posix.h"
 #include "base/threading/thread_restrictions.h"
 #include "base/time/time.h"
 #include "base/trace_event/trace_event.h"
@@ -67,6 +71,13 @@
 extern char** environ;
 #endif
 
+// Children which share the memory of their parent aren't supported by the
+// sanitizers.
+#if defined(OS_LINUX) && !defined(ADDRESS_SANITIZER) && \
+    !defined(MEMORY_SANITIZER) && !defined(THREAD_SANITIZER)
+#define LAUNCH_PROCESS_WITH_VFORK
+#endif
+
 namespace base {
 
 // Friend and derived class of ScopedAllowBaseSyncPrimitives which allows
@@ -293,6 +304,262 @@ void CloseSuperfluousFds(const base::InjectiveMultimap& saved_mapping) {
   }
 }
 
+namespace {
+
+// What the child of LaunchProcess() needs between fork() and execvp(). It's
+// all prepared by the parent, since the child can't allocate.
+struct ChildLaunchState {
+  const LaunchOptions* options = nullptr;
+  char* const* argv = nullptr;
+  // The environment of the child, if |set_environ|. Null for an empty one.
+  char** new_environ = nullptr;
+  bool set_environ = false;
+  const char* current_directory = nullptr;
+  sigset_t orig_sigmask;
+  // Reserved by the parent for the arcs of |options->fds_to_remap|.
+  InjectiveMultimap* fd_shuffle1 = nullptr;
+  InjectiveMultimap* fd_shuffle2 = nullptr;
+  // Whether the child shares the memory of its parent until it executes the
+  // new program, which is then suspended.
+  bool shares_memory = false;
+};
+
+#if defined(LAUNCH_PROCESS_WITH_VFORK)
+// Like execvp() once the environment was replaced by |envp|: the executable
+// is looked up in the PATH of |envp| rather than in the one of the calling
+// process, unlike with execvpe(). Doesn't allocate and only returns on
+// failure.
+void ExecvpWithEnvironment(const char* file,
+                           char* const argv[],
+                           char* const envp[]) {
+  char* const empty_environ[] = {nullptr};
+  if (!envp)
+    envp = empty_environ;
+  if (strchr(file, '/')) {
+    execve(file, argv, envp);
+    return;
+  }
+
+  // The default of glibc when there is no PATH.
+  const char* path = "/bin:/usr/bin";
+  for (char* const* variable = envp; *variable; ++variable) {
+    if (strncmp(*variable, "PATH=", 5) == 0) {
+      path = *variable + 5;
+      break;
+    }
+  }
+
+  const size_t file_length = strlen(file);
+  char candidate[PATH_MAX];
+  bool access_denied = false;
+  for (const char* directory = path;;) {
+    const char* end = directory;
+    while (*end && *end != ':')
+      ++end;
+    const size_t directory_length = end - directory;
+    if (directory_length + file_length + 2 <= sizeof(candidate)) {
+      // An empty directory stands for the current one.
+      size_t length = 0;
+      if (directory_length) {
+        memcpy(candidate, directory, directory_length);
+        candidate[directory_length] = '/';
+        length = directory_length + 1;
+      }
+      memcpy(candidate + length, file, file_length + 1);
+      execve(candidate, argv, envp);
+      // Keep looking if the file isn't there, like execvp().
+      if (errno == EACCES)
+        access_denied = true;
+      else if (errno != ENOENT && errno != ENOTDIR)
+        return;
+    }
+    if (!*end)
+      break;
+    directory = end + 1;
+  }
+  if (access_denied)
+    errno = EACCES;
+}
+#endif  // defined(LAUNCH_PROCESS_WITH_VFORK)
+
+// Runs in the child of LaunchProcess() to set it up and execute the new
+// program. Never returns.
+void ExecChild(const ChildLaunchState& state) {
+  const LaunchOptions& options = *state.options;
+  // DANGER: no calls to malloc or locks are allowed from now on:
+  // http://crbug.com/36678
+
+  // DANGER: fork() rule: in the child, if you don't end up doing exec*(),
+  // you call _exit() instead of exit(). This is because _exit() does not
+  // call any previously-registered (in the parent) exit handlers, which
+  // might do things like block waiting for threads that don't even exist
+  // in the child.
+
+  // If a child process uses the readline library, the process block forever.
+  // In BSD like OSes including OS X it is safe to assign /dev/null as stdin.
+  // See http://crbug.com/56596.
+  base::ScopedFD null_fd(HANDLE_EINTR(open("/dev/null", O_RDONLY)));
+  if (!null_fd.is_valid()) {
+    RAW_LOG(ERROR, "Failed to open /dev/null");
+    _exit(127);
+  }
+
+  int new_fd = HANDLE_EINTR(dup2(null_fd.get(), STDIN_FILENO));
+  if (new_fd != STDIN_FILENO) {
+    RAW_LOG(ERROR, "Failed to dup /dev/null for stdin");
+    _exit(127);
+  }
+
+  if (options.new_process_group) {
+    // Instead of inheriting the process group ID of the parent, the child
+    // starts off a new process group with pgid equal to its process ID.
+    if (setpgid(0, 0) < 0) {
+      RAW_LOG(ERROR, "setpgid failed");
+      _exit(127);
+    }
+  }
+
+  if (options.maximize_rlimits) {
+    // Some resource limits need to be maximal in this child.
+    for (size_t i = 0; i < options.maximize_rlimits->size(); ++i) {
+      const int resource = (*options.maximize_rlimits)[i];
+      struct rlimit limit;
+      if (getrlimit(resource, &limit) < 0) {
+        RAW_LOG(WARNING, "getrlimit failed");
+      } else if (limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        if (setrlimit(resource, &limit) < 0) {
+          RAW_LOG(WARNING, "setrlimit failed");
+        }
+      }
+    }
+  }
+
+#if defined(OS_MACOSX)
+  RestoreDefaultExceptionHandler();
+#endif  // defined(OS_MACOSX)
+
+  ResetChildSignalHandlersToDefaults();
+  SetSignalMask(state.orig_sigmask);
+
+#if 0
+  // When debugging it can be helpful to check that we really aren't making
+  // any hidden calls to malloc.
+  void *malloc_thunk =
+      reinterpret_cast<void*>(reinterpret_cast<intptr_t>(malloc) & ~4095);
+  mprotect(malloc_thunk, 4096, PROT_READ | PROT_WRITE | PROT_EXEC);
+  memset(reinterpret_cast<void*>(malloc), 0xff, 8);
+#endif  // 0
+
+#if defined(OS_CHROMEOS)
+  if (options.ctrl_terminal_fd >= 0) {
+    // Set process' controlling terminal.
+    if (HANDLE_EINTR(setsid()) != -1) {
+      if (HANDLE_EINTR(
+              ioctl(options.ctrl_terminal_fd, TIOCSCTTY, nullptr)) == -1) {
+        RAW_LOG(WARNING, "ioctl(TIOCSCTTY), ctrl terminal not set");
+      }
+    } else {
+      RAW_LOG(WARNING, "setsid failed, ctrl terminal not set");
+    }
+  }
+#endif  // defined(OS_CHROMEOS)
+
+  // Cannot use STL iterators here, since debug iterators use locks.
+  for (size_t i = 0; i < options.fds_to_remap.size(); ++i) {
+    const FileHandleMappingVector::value_type& value =
+        options.fds_to_remap[i];
+    state.fd_shuffle1->push_back(InjectionArc(value.first, value.second, false));
+    state.fd_shuffle2->push_back(InjectionArc(value.first, value.second, false));
+  }
+
+  // A child sharing the memory of its parent must not replace its
+  // environment, which it passes to execve() instead.
+  if (state.set_environ && !state.shares_memory)
+    SetEnvironment(state.new_environ);
+
+  // fd_shuffle1 is mutated by this call because it cannot malloc.
+  if (!ShuffleFileDescriptors(state.fd_shuffle1))
+    _exit(127);
+
+  CloseSuperfluousFds(*state.fd_shuffle2);
+
+  // Set NO_NEW_PRIVS by default. Since NO_NEW_PRIVS only exists in kernel
+  // 3.5+, do not check the return value of prctl here.
+#if defined(OS_LINUX) || defined(OS_AIX)
+#ifndef PR_SET_NO_NEW_PRIVS
+#define PR_SET_NO_NEW_PRIVS 38
+#endif
+  if (!options.allow_new_privs) {
+    if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) && errno != EINVAL) {
+      // Only log if the error is not EINVAL (i.e. not supported).
+      RAW_LOG(FATAL, "prctl(PR_SET_NO_NEW_PRIVS) failed");
+    }
+  }
+
+  if (options.kill_on_parent_death) {
+    if (prctl(PR_SET_PDEATHSIG, SIGKILL) != 0) {
+      RAW_LOG(ERROR, "prctl(PR_SET_PDEATHSIG) failed");
+      _exit(127);
+    }
+  }
+#endif
+
+  if (state.current_directory != nullptr) {
+    RAW_CHECK(chdir(state.current_directory) == 0);
+  }
+
+  if (options.pre_exec_delegate != nullptr) {
+    options.pre_exec_delegate->RunAsyncSafe();
+  }
+
+  const char* executable_path = !options.real_path.empty() ?
+      options.real_path.value().c_str() : state.argv[0];
+
+#if defined(LAUNCH_PROCESS_WITH_VFORK)
+  if (state.shares_memory) {
+    ExecvpWithEnvironment(executable_path, state.argv,
+                          state.set_environ ? state.new_environ
+                                            : GetEnvironment());
+  } else
+#endif
+  {
+    execvp(executable_path, state.argv);
+  }
+
+  RAW_LOG(ERROR, "LaunchProcess: failed to execvp:");
+  RAW_LOG(ERROR, state.argv[0]);
+  _exit(127);
+}
+
+#if defined(LAUNCH_PROCESS_WITH_VFORK)
+// The options which run code of the caller in the child, which could touch
+// the memory of the parent, or which change how the child is created need
+// fork().
+bool CanLaunchWithVfork(const LaunchOptions& options) {
+  return !options.pre_exec_delegate && !options.clone_flags;
+}
+
+int ExecChildFromClone(void* state) {
+  ExecChild(*static_cast<const ChildLaunchState*>(state));
+  return 127;
+}
+
+// Unlike fork(), this doesn't copy the page tables of the parent, which takes
+// tens of milliseconds for a large process. The calling thread is suspended
+// until the child executes the new program or exits.
+pid_t CloneVforkAndExecChild(ChildLaunchState* state) {
+  // The child needs its own stack, since it shares the memory of the parent.
+  constexpr size_t kStackSize = 64 * 1024;
+  std::unique_ptr<char[]> stack(new char[kStackSize]);
+  // The stack grows downward.
+  return clone(&ExecChildFromClone, stack.get() + kStackSize,
+               CLONE_VM | CLONE_VFORK | SIGCHLD, state);
+}
+#endif  // defined(LAUNCH_PROCESS_WITH_VFORK)
+
+}  // namespace
+
 Process LaunchProcess(const CommandLine& cmdline,
                       const LaunchOptions& options) {
   return LaunchProcess(cmdline.argv(), options);
@@ -333,13 +600,26 @@ Process LaunchProcess(const std::vector<std::string>& argv,
   sigfillset(&full_sigset);
   const sigset_t orig_sigmask = SetSignalMask(full_sigset);
 
-  const char* current_directory = nullptr;
+  ChildLaunchState child_state;
+  child_state.options = &options;
+  child_state.argv = argv_cstr.data();
+  child_state.new_environ = new_environ.get();
+  child_state.set_environ = !options.environ.empty() || options.clear_environ;
   if (!options.current_directory.empty()) {
-    current_directory = options.current_directory.value().c_str();
+    child_state.current_directory = options.current_directory.value().c_str();
   }
+  child_state.orig_sigmask = orig_sigmask;
+  child_state.fd_shuffle1 = &fd_shuffle1;
+  child_state.fd_shuffle2 = &fd_shuffle2;
 
   pid_t pid;
   base::TimeTicks before_fork = TimeTicks::Now();
+#if defined(LAUNCH_PROCESS_WITH_VFORK)
+  if (CanLaunchWithVfork(options)) {
+    child_state.shares_memory = true;
+    pid = CloneVforkAndExecChild(&child_state);
+  } else
+#endif
 #if defined(OS_LINUX) || defined(OS_AIX)
   if (options.clone_flags) {
     // Signal handling in this function assumes the creation of a new
@@ -378,140 +658,7 @@ Process LaunchProcess(const std::vector<std::string>& argv,
     return Process();
   } else if (pid == 0) {
     // Child process
-
-    // DANGER: no calls to malloc or locks are allowed from now on:
-    // http://crbug.com/36678
-
-    // DANGER: fork() rule: in the child, if you don't end up doing exec*(),
-    // you call _exit() instead of exit(). This is because _exit() does not
-    // call any previously-registered (in the parent) exit handlers, which
-    // might do things like block waiting for threads that don't even exist
-    // in the child.
-
-    // If a child process uses the readline library, the process block forever.
-    // In BSD like OSes including OS X it is safe to assign /dev/null as stdin.
-    // See http://crbug.com/56596.
-    base::ScopedFD null_fd(HANDLE_EINTR(open("/dev/null", O_RDONLY)));
-    if (!null_fd.is_valid()) {
-      RAW_LOG(ERROR, "Failed to open /dev/null");
-      _exit(127);
-    }
-
-    int new_fd = HANDLE_EINTR(dup2(null_fd.get(), STDIN_FILENO));
-    if (new_fd != STDIN_FILENO) {
-      RAW_LOG(ERROR, "Failed to dup /dev/null for stdin");
-      _exit(127);
-    }
-
-    if (options.new_process_group) {
-      // Instead of inheriting the process group ID of the parent, the child
-      // starts off a new process group with pgid equal to its process ID.
-      if (setpgid(0, 0) < 0) {
-        RAW_LOG(ERROR, "setpgid failed");
-        _exit(127);
-      }
-    }
-
-    if (options.maximize_rlimits) {
-      // Some resource limits need to be maximal in this child.
-      for (size_t i = 0; i < options.maximize_rlimits->size(); ++i) {
-        const int resource = (*options.maximize_rlimits)[i];
-        struct rlimit limit;
-        if (getrlimit(resource, &limit) < 0) {
-          RAW_LOG(WARNING, "getrlimit failed");
-        } else if (limit.rlim_cur < limit.rlim_max) {
-          limit.rlim_cur = limit.rlim_max;
-          if (setrlimit(resource, &limit) < 0) {
-            RAW_LOG(WARNING, "setrlimit failed");
-          }
-        }
-      }
-    }
-
-#if defined(OS_MACOSX)
-    RestoreDefaultExceptionHandler();
-#endif  // defined(OS_MACOSX)
-
-    ResetChildSignalHandlersToDefaults();
-    SetSignalMask(orig_sigmask);
-
-#if 0
-    // When debugging it can be helpful to check that we really aren't making
-    // any hidden calls to malloc.
-    void *malloc_thunk =
-        reinterpret_cast<void*>(reinterpret_cast<intptr_t>(malloc) & ~4095);
-    mprotect(malloc_thunk, 4096, PROT_READ | PROT_WRITE | PROT_EXEC);
-    memset(reinterpret_cast<void*>(malloc), 0xff, 8);
-#endif  // 0
-
-#if defined(OS_CHROMEOS)
-    if (options.ctrl_terminal_fd >= 0) {
-      // Set process' controlling terminal.
-      if (HANDLE_EINTR(setsid()) != -1) {
-        if (HANDLE_EINTR(
-                ioctl(options.ctrl_terminal_fd, TIOCSCTTY, nullptr)) == -1) {
-          RAW_LOG(WARNING, "ioctl(TIOCSCTTY), ctrl terminal not set");
-        }
-      } else {
-        RAW_LOG(WARNING, "setsid failed, ctrl terminal not set");
-      }
-    }
-#endif  // defined(OS_CHROMEOS)
-
-    // Cannot use STL iterators here, since debug iterators use locks.
-    for (size_t i = 0; i < options.fds_to_remap.size(); ++i) {
-      const FileHandleMappingVector::value_type& value =
-          options.fds_to_remap[i];
-      fd_shuffle1.push_back(InjectionArc(value.first, value.second, false));
-      fd_shuffle2.push_back(InjectionArc(value.first, value.second, false));
-    }
-
-    if (!options.environ.empty() || options.clear_environ)
-      SetEnvironment(new_environ.get());
-
-    // fd_shuffle1 is mutated by this call because it cannot malloc.
-    if (!ShuffleFileDescriptors(&fd_shuffle1))
-      _exit(127);
-
-    CloseSuperfluousFds(fd_shuffle2);
-
-    // Set NO_NEW_PRIVS by default. Since NO_NEW_PRIVS only exists in kernel
-    // 3.5+, do not check the return value of prctl here.
-#if defined(OS_LINUX) || defined(OS_AIX)
-#ifndef PR_SET_NO_NEW_PRIVS
-#define PR_SET_NO_NEW_PRIVS 38
-#endif
-    if (!options.allow_new_privs) {
-      if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) && errno != EINVAL) {
-        // Only log if the error is not EINVAL (i.e. not supported).
-        RAW_LOG(FATAL, "prctl(PR_SET_NO_NEW_PRIVS) failed");
-      }
-    }
-
-    if (options.kill_on_parent_death) {
-      if (prctl(PR_SET_PDEATHSIG, SIGKILL) != 0) {
-        RAW_LOG(ERROR, "prctl(PR_SET_PDEATHSIG) failed");
-        _exit(127);
-      }
-    }
-#endif
-
-    if (current_directory != nullptr) {
-      RAW_CHECK(chdir(current_directory) == 0);
-    }
-
-    if (options.pre_exec_delegate != nullptr) {
-      options.pre_exec_delegate->RunAsyncSafe();
-    }
-
-    const char* executable_path = !options.real_path.empty() ?
-        options.real_path.value().c_str() : argv_cstr[0];
-
-    execvp(executable_path, argv_cstr.data());
-
-    RAW_LOG(ERROR, "LaunchProcess: failed to execvp:");
-    RAW_LOG(ERROR, argv_cstr[0]);
-    _exit(127);
+    ExecChild(child_state);
   } else {
     // Parent process
     if (options.wait) {
@@ -757,6 +904,11 @@ pid_t ForkWithFlags(unsigned long flags, pid_t* ptid, pid_t* ctid) {
     return CloneAndLongjmpInChild(flags, ptid, ctid, &env);
   }
 
+#if defined(OS_LINUX)
+  // The pthread_atfork() handlers didn't run in the child.
+  internal::InvalidateTidCache();
+  internal::ReseedRandBytesAfterFork();
+#endif
   return 0;
 }
 #endif  // defined(OS_LINUX) || defined(OS_NACL_NONSFI)
@@ -6,6 +6,7 @@
 #define BASE_PROCESS_PROCESS_H_
 
 #include "base/base_export.h"
+#include "base/callback_forward.h"
 #include "base/macros.h"
 #include "base/process/process_handle.h"
 #include "base/time/time.h"
@@ -134,6 +135,14 @@ class BASE_EXPORT Process {
   // is not required.
   bool WaitForExitWithTimeout(TimeDelta timeout, int* exit_code) const;
 
+#if defined(OS_POSIX) && !defined(OS_FUCHSIA) && !defined(OS_NACL_NONSFI)
+  // Runs |callback| on the current sequence once the process exited, with its
+  // exit code as WaitForExit() reports it, without blocking a thread for it:
+  // a single thread waits for all the processes. The process is reaped, so it
+  // must not be waited for otherwise after this. It must be a child process.
+  void WaitForExitAsync(OnceCallback<void(int exit_code)> callback) const;
+#endif
+
   // Indicates that the process has exited with the specified |exit_code|.
   // This should be called if process exit is observed outside of this class.
   // (i.e. Not because Terminate or WaitForExit, above, was called.)
@@ -0,0 +1,219 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/process/process_metrics_sampler_linux.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/process/internal_linux.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "base/threading/thread_restrictions.h"
+
+namespace base {
+
+namespace {
+
+// Large enough for the stat and io files, and for most status files.
+const size_t kInitialBufferSize = 2048;
+
+// Calls |callback| with the key and the trimmed value of each "key: value"
+// line of |contents|.
+template <typename Callback>
+void ForEachKeyValueLine(StringPiece contents, Callback callback) {
+  while (!contents.empty()) {
+    size_t end = contents.find('\n');
+    StringPiece line = contents.substr(0, end);
+    contents.remove_prefix(end == StringPiece::npos ? contents.size()
+                                                    : end + 1);
+    size_t colon = line.find(':');
+    if (colon == StringPiece::npos)
+      continue;
+    callback(line.substr(0, colon),
+             TrimWhitespaceASCII(line.substr(colon + 1), TRIM_ALL));
+  }
+}
+
+bool ParseStat(StringPiece stat, ProcessMetricsSampler::Snapshot* snapshot) {
+  // The process name may contain spaces and parentheses, so the fields start
+  // after the last parenthesis. See internal::ParseProcStats().
+  size_t close_parens = stat.rfind(") ");
+  if (close_parens == StringPiece::npos)
+    return false;
+  StringPiece fields = stat.substr(close_parens + 2);
+
+  int64_t utime = 0;
+  int64_t stime = 0;
+  int64_t rss_pages = 0;
+  int field = internal::VM_STATE;
+  for (; field <= internal::VM_RSS; ++field) {
+    size_t end = fields.find(' ');
+    if (end == StringPiece::npos)
+      return false;
+    StringPiece value = fields.substr(0, end);
+    fields.remove_prefix(end + 1);
+
+    int64_t* out = nullptr;
+    switch (field) {
+      case internal::VM_MINFLT:
+        out = &snapshot->page_faults.minor;
+        break;
+      case internal::VM_MAJFLT:
+        out = &snapshot->page_faults.major;
+        break;
+      case internal::VM_UTIME:
+        out = &utime;
+        break;
+      case internal::VM_STIME:
+        out = &stime;
+        break;
+      case internal::VM_RSS:
+        out = &rss_pages;
+        break;
+      case internal::VM_NUMTHREADS:
+        if (!StringToInt(value, &snapshot->num_threads))
+          return false;
+        break;
+    }
+    if (out && !StringToInt64(value, out))
+      return false;
+  }
+
+  snapshot->cumulative_cpu_usage =
+      internal::ClockTicksToTimeDelta(static_cast<int>(utime + stime));
+  snapshot->resident_set_bytes =
+      static_cast<size_t>(rss_pages) * getpagesize();
+  return true;
+}
+
+bool ParseStatus(StringPiece status,
+                 ProcessMetricsSampler::Snapshot* snapshot) {
+  bool parsed = true;
+  ForEachKeyValueLine(status, [snapshot, &parsed](StringPiece key,
+                                                  StringPiece value) {
+    // Kernel threads have no VmSwap line.
+    if (key != "VmSwap")
+      return;
+    uint64_t swap_kb;
+    if (!value.ends_with(" kB") ||
+        !StringToUint64(value.substr(0, value.size() - 3), &swap_kb)) {
+      parsed = false;
+      return;
+    }
+    snapshot->vm_swap_bytes = swap_kb * 1024;
+  });
+  return parsed;
+}
+
+void ParseIo(StringPiece io, ProcessMetricsSampler::Snapshot* snapshot) {
+  IoCounters* counters = &snapshot->io_counters;
+  ForEachKeyValueLine(io, [counters](StringPiece key, StringPiece value) {
+    uint64_t* counter = nullptr;
+    if (key == "syscr")
+      counter = &counters->ReadOperationCount;
+    else if (key == "syscw")
+      counter = &counters->WriteOperationCount;
+    else if (key == "rchar")
+      counter = &counters->ReadTransferCount;
+    else if (key == "wchar")
+      counter = &counters->WriteTransferCount;
+    if (counter) {
+      bool converted = StringToUint64(value, counter);
+      DCHECK(converted);
+    }
+  });
+  snapshot->has_io_counters = true;
+}
+
+}  // namespace
+
+ProcessMetricsSampler::ProcessMetricsSampler(int sources)
+    : sources_(sources), buffer_(kInitialBufferSize) {
+  DCHECK(sources_);
+  DCHECK_EQ(0, sources_ & ~SOURCE_ALL);
+  // Synchronously reading files in /proc does not hit the disk.
+  ThreadRestrictions::ScopedAllowIO allow_io;
+  proc_fd_.reset(HANDLE_EINTR(
+      open(internal::kProcDir, O_RDONLY | O_DIRECTORY | O_CLOEXEC)));
+  DPLOG_IF(ERROR, !proc_fd_.is_valid()) << "open(" << internal::kProcDir << ")";
+}
+
+ProcessMetricsSampler::~ProcessMetricsSampler() = default;
+
+bool ProcessMetricsSampler::Sample(ProcessId pid, Snapshot* snapshot) {
+  *snapshot = Snapshot();
+  snapshot->pid = pid;
+
+  StringPiece contents;
+  if (sources_ & SOURCE_STAT) {
+    if (!ReadProcFile(pid, internal::kStatFile, &contents) ||
+        !ParseStat(contents, snapshot)) {
+      return false;
+    }
+  }
+  if (sources_ & SOURCE_STATUS) {
+    if (!ReadProcFile(pid, "status", &contents) ||
+        !ParseStatus(contents, snapshot)) {
+      return false;
+    }
+  }
+  if ((sources_ & SOURCE_IO) && ReadProcFile(pid, "io", &contents))
+    ParseIo(contents, snapshot);
+  return true;
+}
+
+std::vector<ProcessMetricsSampler::Snapshot> ProcessMetricsSampler::SampleAll(
+    const std::vector<ProcessId>& pids) {
+  std::vector<Snapshot> snapshots(pids.size());
+  size_t sampled = 0;
+  for (ProcessId pid : pids) {
+    if (Sample(pid, &snapshots[sampled]))
+      ++sampled;
+  }
+  snapshots.resize(sampled);
+  return snapshots;
+}
+
+bool ProcessMetricsSampler::ReadProcFile(ProcessId pid,
+                                         const char* name,
+                                         StringPiece* contents) {
+  if (!proc_fd_.is_valid())
+    return false;
+
+  // Synchronously reading files in /proc does not hit the disk.
+  ThreadRestrictions::ScopedAllowIO allow_io;
+
+  char path[32];
+  snprintf(path, sizeof(path), "%d/%s", pid, name);
+  ScopedFD fd(HANDLE_EINTR(openat(proc_fd_.get(), path, O_RDONLY | O_CLOEXEC)));
+  if (!fd.is_valid())
+    return false;
+
+  // The files are generated as they are read, so their size isn't known
+  // until the end is reached.
+  size_t size = 0;
+  for (;;) {
+    if (size == buffer_.size())
+      buffer_.resize(buffer_.size() * 2);
+    ssize_t bytes_read = HANDLE_EINTR(
+        read(fd.get(), buffer_.data() + size, buffer_.size() - size));
+    if (bytes_read < 0)
+      return false;
+    if (bytes_read == 0)
+      break;
+    size += bytes_read;
+  }
+  // The process may have exited while it was read.
+  if (!size)
+    return false;
+
+  *contents = StringPiece(buffer_.data(), size);
+  return true;
+}
+
+}  // namespace base
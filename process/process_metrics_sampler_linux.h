@@ -0,0 +1,98 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PROCESS_PROCESS_METRICS_SAMPLER_LINUX_H_
+#define BASE_PROCESS_PROCESS_METRICS_SAMPLER_LINUX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/files/scoped_file.h"
+#include "base/macros.h"
+#include "base/process/process_handle.h"
+#include "base/process/process_metrics.h"
+#include "base/process/process_metrics_iocounters.h"
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// Reads the metrics of many processes at once, for monitors which sample them
+// often. Each process is sampled by reading each of its /proc files once,
+// into a buffer reused across processes, and without copying the fields out,
+// where the ProcessMetrics getters each read and split a file.
+//
+// Example:
+//
+//   ProcessMetricsSampler sampler(ProcessMetricsSampler::SOURCE_STAT);
+//   for (const ProcessMetricsSampler::Snapshot& snapshot :
+//        sampler.SampleAll(child_pids)) {
+//     ...
+//   }
+class BASE_EXPORT ProcessMetricsSampler {
+ public:
+  // The /proc/<pid> files to read.
+  enum Source {
+    SOURCE_STAT = 1 << 0,
+    SOURCE_STATUS = 1 << 1,
+    SOURCE_IO = 1 << 2,
+    SOURCE_ALL = SOURCE_STAT | SOURCE_STATUS | SOURCE_IO,
+  };
+
+  // The fields of a source which isn't read are left to 0.
+  struct BASE_EXPORT Snapshot {
+    ProcessId pid = 0;
+
+    // From /proc/<pid>/stat.
+    // CPU time in user and kernel mode of all the threads of the process,
+    // including those which exited, unlike GetPlatformIndependentCPUUsage()
+    // which only counts the live ones.
+    TimeDelta cumulative_cpu_usage;
+    PageFaultCounts page_faults = {0, 0};
+    int num_threads = 0;
+    size_t resident_set_bytes = 0;
+
+    // From /proc/<pid>/status.
+    uint64_t vm_swap_bytes = 0;
+
+    // From /proc/<pid>/io, which only exists if the kernel has
+    // CONFIG_TASK_IO_ACCOUNTING, and usually can't be read for the processes
+    // of other users.
+    bool has_io_counters = false;
+    IoCounters io_counters = {};
+  };
+
+  // |sources| is a bit mask of Source.
+  explicit ProcessMetricsSampler(int sources);
+  ~ProcessMetricsSampler();
+
+  // Reads the metrics of |pid| into |snapshot|. Returns false if the process
+  // doesn't exist, or if its stat or status file couldn't be read or parsed.
+  bool Sample(ProcessId pid, Snapshot* snapshot);
+
+  // Returns the snapshots of the processes of |pids| which could be sampled,
+  // in the same order.
+  std::vector<Snapshot> SampleAll(const std::vector<ProcessId>& pids);
+
+ private:
+  // Reads /proc/<pid>/<name> into |buffer_|, and points |contents| to it.
+  bool ReadProcFile(ProcessId pid, const char* name, StringPiece* contents);
+
+  const int sources_;
+
+  // /proc, which the files are opened relative to.
+  ScopedFD proc_fd_;
+
+  // Grown to hold the largest file read so far.
+  std::vector<char> buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProcessMetricsSampler);
+};
+
+}  // namespace base
+
+#endif  // BASE_PROCESS_PROCESS_METRICS_SAMPLER_LINUX_H_
@@ -0,0 +1,80 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/process/process_metrics_sampler_linux.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/process/process_metrics.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Keeps the CPU busy for a while, so that it shows in the stat file.
+void Spin() {
+  TimeTicks end = TimeTicks::Now() + TimeDelta::FromMilliseconds(50);
+  while (TimeTicks::Now() < end) {
+  }
+}
+
+}  // namespace
+
+TEST(ProcessMetricsSamplerTest, SampleCurrentProcess) {
+  Spin();
+  ProcessMetricsSampler sampler(ProcessMetricsSampler::SOURCE_ALL);
+  ProcessMetricsSampler::Snapshot snapshot;
+  ASSERT_TRUE(sampler.Sample(GetCurrentProcId(), &snapshot));
+
+  EXPECT_EQ(GetCurrentProcId(), snapshot.pid);
+  EXPECT_GT(snapshot.cumulative_cpu_usage, TimeDelta());
+  EXPECT_GT(snapshot.page_faults.minor, 0);
+  EXPECT_GE(snapshot.num_threads, 1);
+  EXPECT_GT(snapshot.resident_set_bytes, 0u);
+
+  std::unique_ptr<ProcessMetrics> process_metrics =
+      ProcessMetrics::CreateCurrentProcessMetrics();
+  PageFaultCounts counts;
+  ASSERT_TRUE(process_metrics->GetPageFaultCounts(&counts));
+  EXPECT_GE(counts.minor, snapshot.page_faults.minor);
+  EXPECT_EQ(process_metrics->GetVmSwapBytes(), snapshot.vm_swap_bytes);
+  if (snapshot.has_io_counters)
+    EXPECT_GT(snapshot.io_counters.ReadOperationCount, 0u);
+
+  // The buffer and the /proc descriptor are reused.
+  ProcessMetricsSampler::Snapshot second_snapshot;
+  ASSERT_TRUE(sampler.Sample(GetCurrentProcId(), &second_snapshot));
+  EXPECT_GE(second_snapshot.page_faults.minor, snapshot.page_faults.minor);
+  EXPECT_GE(second_snapshot.cumulative_cpu_usage,
+            snapshot.cumulative_cpu_usage);
+}
+
+TEST(ProcessMetricsSamplerTest, OnlyRequestedSources) {
+  ProcessMetricsSampler sampler(ProcessMetricsSampler::SOURCE_STATUS);
+  ProcessMetricsSampler::Snapshot snapshot;
+  ASSERT_TRUE(sampler.Sample(GetCurrentProcId(), &snapshot));
+  EXPECT_EQ(0, snapshot.num_threads);
+  EXPECT_EQ(0u, snapshot.resident_set_bytes);
+  EXPECT_FALSE(snapshot.has_io_counters);
+}
+
+TEST(ProcessMetricsSamplerTest, SampleAll) {
+  ProcessMetricsSampler sampler(ProcessMetricsSampler::SOURCE_STAT);
+  // Pid 0 never has a /proc entry, and neither has a negative one.
+  std::vector<ProcessMetricsSampler::Snapshot> snapshots =
+      sampler.SampleAll({0, GetCurrentProcId(), -1, GetCurrentProcId()});
+  ASSERT_EQ(2u, snapshots.size());
+  EXPECT_EQ(GetCurrentProcId(), snapshots[0].pid);
+  EXPECT_EQ(GetCurrentProcId(), snapshots[1].pid);
+  EXPECT_GE(snapshots[0].num_threads, 1);
+  EXPECT_GE(snapshots[1].num_threads, 1);
+
+  ProcessMetricsSampler::Snapshot snapshot;
+  EXPECT_FALSE(sampler.Sample(0, &snapshot));
+}
+
+}  // namespace base
@@ -10,11 +10,15 @@
 #include <sys/resource.h>
 #include <sys/wait.h>
 
+#include <utility>
+
+#include "base/callback.h"
 #include "base/debug/activity_tracker.h"
 #include "base/files/scoped_file.h"
 #include "base/logging.h"
 #include "base/posix/eintr_wrapper.h"
 #include "base/process/kill.h"
+#include "base/process/process_reaper_posix.h"
 #include "base/threading/thread_restrictions.h"
 #include "build/build_config.h"
 
@@ -352,6 +356,17 @@ bool Process::WaitForExitWithTimeout(TimeDelta timeout, int* exit_code) const {
   return exited;
 }
 
+#if !defined(OS_NACL_NONSFI)
+void Process::WaitForExitAsync(
+    OnceCallback<void(int exit_code)> callback) const {
+  DCHECK(IsValid());
+  DCHECK(!is_current());
+  DCHECK(callback);
+  ProcessReaper::GetInstance()->Watch(Handle(), TimeDelta(),
+                                      std::move(callback));
+}
+#endif  // !defined(OS_NACL_NONSFI)
+
 void Process::Exited(int exit_code) const {}
 
 #if !defined(OS_LINUX) && !defined(OS_MACOSX) && !defined(OS_AIX)
@@ -0,0 +1,199 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/process/process_reaper_posix.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/scoped_file.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/message_loop/message_loop_current.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/sequenced_task_runner.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "build/build_config.h"
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <sys/syscall.h>
+#endif
+
+namespace base {
+
+namespace {
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#if !defined(__NR_pidfd_open)
+// The same on all the architectures.
+#define __NR_pidfd_open 434
+#endif
+
+// Returns a file descriptor which becomes readable once |process| exited, or
+// an invalid one before Linux 5.3.
+ScopedFD OpenPidfd(ProcessHandle process) {
+  return ScopedFD(syscall(__NR_pidfd_open, process, 0));
+}
+#else
+ScopedFD OpenPidfd(ProcessHandle process) {
+  return ScopedFD();
+}
+#endif
+
+void KillProcess(ProcessHandle process) {
+  kill(process, SIGKILL);
+}
+
+}  // namespace
+
+// static
+constexpr TimeDelta ProcessReaper::kPollInterval;
+
+// A child being waited for, on the thread of the ProcessReaper.
+class ProcessReaper::Child : public MessagePumpForIO::FdWatcher {
+ public:
+  Child(ProcessReaper* reaper, ProcessHandle process)
+      : reaper_(reaper), process_(process), pidfd_(OpenPidfd(process)) {}
+  ~Child() override = default;
+
+  ProcessHandle process() const { return process_; }
+  bool has_pidfd() const { return pidfd_.is_valid(); }
+  bool polled() const { return polled_; }
+  void set_polled() { polled_ = true; }
+
+  // Watches |pidfd_|, which must be valid. Returns false on failure.
+  bool WatchPidfd() {
+    return MessageLoopCurrentForIO::Get()->WatchFileDescriptor(
+        pidfd_.get(), false, MessagePumpForIO::WATCH_READ, &pidfd_controller_,
+        this);
+  }
+
+  void AddCallback(ExitCallback callback) {
+    if (callback) {
+      callbacks_.emplace_back(std::move(callback),
+                              SequencedTaskRunnerHandle::Get());
+    }
+  }
+
+  void StartKillTimer(TimeDelta kill_delay) {
+    if (kill_delay.is_zero() || kill_timer_.IsRunning())
+      return;
+    kill_timer_.Start(FROM_HERE, kill_delay,
+                      BindRepeating(&KillProcess, process_));
+  }
+
+  // Posts the callbacks, once the process exited.
+  void RunCallbacks(int exit_code) {
+    for (auto& callback : callbacks_) {
+      callback.second->PostTask(
+          FROM_HERE, BindOnce(std::move(callback.first), exit_code));
+    }
+    callbacks_.clear();
+  }
+
+  // MessagePumpForIO::FdWatcher:
+  void OnFileCanReadWithoutBlocking(int fd) override {
+    // Deletes |this|.
+    reaper_->TryReap(this);
+  }
+  void OnFileCanWriteWithoutBlocking(int fd) override { NOTREACHED(); }
+
+ private:
+  ProcessReaper* const reaper_;
+  const ProcessHandle process_;
+  ScopedFD pidfd_;
+  bool polled_ = false;
+  MessagePumpForIO::FdWatchController pidfd_controller_{FROM_HERE};
+  OneShotTimer kill_timer_;
+  std::vector<std::pair<ExitCallback, scoped_refptr<SequencedTaskRunner>>>
+      callbacks_;
+
+  DISALLOW_COPY_AND_ASSIGN(Child);
+};
+
+// static
+ProcessReaper* ProcessReaper::GetInstance() {
+  static NoDestructor<ProcessReaper> instance;
+  return instance.get();
+}
+
+void ProcessReaper::Watch(ProcessHandle process,
+                          TimeDelta kill_delay,
+                          ExitCallback callback) {
+  thread_.task_runner()->PostTask(
+      FROM_HERE,
+      BindOnce(&ProcessReaper::StartWatching, Unretained(this), process,
+               kill_delay, std::move(callback)));
+}
+
+ProcessReaper::ProcessReaper() : thread_("ProcessReaper") {
+  CHECK(thread_.StartWithOptions(Thread::Options(MessageLoop::TYPE_IO, 0)));
+}
+
+// Never called, since the instance is leaked.
+ProcessReaper::~ProcessReaper() = default;
+
+void ProcessReaper::StartWatching(ProcessHandle process,
+                                  TimeDelta kill_delay,
+                                  ExitCallback callback) {
+  std::unique_ptr<Child>& entry = children_[process];
+  const bool already_watched = !!entry;
+  if (!already_watched)
+    entry = std::make_unique<Child>(this, process);
+  Child* child = entry.get();
+  child->AddCallback(std::move(callback));
+  child->StartKillTimer(kill_delay);
+  if (already_watched || TryReap(child))
+    return;
+
+  if (child->has_pidfd() && child->WatchPidfd())
+    return;
+  child->set_polled();
+  ++polled_children_;
+  if (!poll_timer_.IsRunning()) {
+    poll_timer_.Start(FROM_HERE, kPollInterval,
+                      BindRepeating(&ProcessReaper::PollChildren,
+                                    Unretained(this)));
+  }
+}
+
+void ProcessReaper::PollChildren() {
+  for (auto it = children_.begin(); it != children_.end();) {
+    Child* child = (it++)->second.get();
+    if (child->polled())
+      TryReap(child);
+  }
+}
+
+bool ProcessReaper::TryReap(Child* child) {
+  int status;
+  const pid_t result =
+      HANDLE_EINTR(waitpid(child->process(), &status, WNOHANG));
+  if (result == 0)
+    return false;
+
+  int exit_code = -1;
+  if (result == -1)
+    DPLOG(ERROR) << "waitpid(" << child->process() << ")";
+  else if (WIFEXITED(status))
+    exit_code = WEXITSTATUS(status);
+  child->RunCallbacks(exit_code);
+
+  if (child->polled()) {
+    DCHECK_GT(polled_children_, 0u);
+    if (--polled_children_ == 0)
+      poll_timer_.Stop();
+  }
+  children_.erase(child->process());
+  return true;
+}
+
+}  // namespace base
@@ -0,0 +1,73 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PROCESS_PROCESS_REAPER_POSIX_H_
+#define BASE_PROCESS_PROCESS_REAPER_POSIX_H_
+
+#include <map>
+#include <memory>
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/no_destructor.h"
+#include "base/process/process_handle.h"
+#include "base/threading/thread.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+
+namespace base {
+
+// Waits for child processes to exit and reaps them on a single thread, rather
+// than on a thread per child blocked in waitpid(). On Linux, each child is
+// watched through a pidfd by the MessagePumpForIO of that thread, so its exit
+// is noticed right away. Where pidfds aren't supported, the children are
+// polled with waitpid(WNOHANG) every |kPollInterval| instead, still on that
+// thread. This backs EnsureProcessTerminated() and
+// Process::WaitForExitAsync().
+class BASE_EXPORT ProcessReaper {
+ public:
+  // Runs with the exit code of the process, or -1 if it was killed by a
+  // signal or couldn't be waited for, like Process::WaitForExit().
+  using ExitCallback = OnceCallback<void(int exit_code)>;
+
+  static constexpr TimeDelta kPollInterval = TimeDelta::FromMilliseconds(50);
+
+  static ProcessReaper* GetInstance();
+
+  // Reaps |process|, a child of this process, once it exited. If |kill_delay|
+  // isn't zero, the process is sent SIGKILL if it's still running after it.
+  // If |callback| isn't null, it's then posted to the current sequence. The
+  // process must not be waited for otherwise after this.
+  void Watch(ProcessHandle process, TimeDelta kill_delay, ExitCallback callback);
+
+ private:
+  friend class NoDestructor<ProcessReaper>;
+  class Child;
+
+  ProcessReaper();
+  ~ProcessReaper();
+
+  // These run on |thread_|.
+  void StartWatching(ProcessHandle process,
+                     TimeDelta kill_delay,
+                     ExitCallback callback);
+  void PollChildren();
+  // Reaps |child| if it exited, and then forgets it. Returns whether it did.
+  bool TryReap(Child* child);
+
+  Thread thread_;
+
+  // Only used on |thread_|.
+  std::map<ProcessHandle, std::unique_ptr<Child>> children_;
+  // The number of |children_| without a pidfd, which are polled.
+  size_t polled_children_ = 0;
+  RepeatingTimer poll_timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProcessReaper);
+};
+
+}  // namespace base
+
+#endif  // BASE_PROCESS_PROCESS_REAPER_POSIX_H_
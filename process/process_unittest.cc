@@ -7,8 +7,11 @@
 #include <utility>
 
 #include "base/at_exit.h"
+#include "base/bind.h"
 #include "base/process/kill.h"
+#include "base/run_loop.h"
 #include "base/test/multiprocess_test.h"
+#include "base/test/scoped_task_environment.h"
 #include "base/test/test_timeouts.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/thread_local.h"
@@ -222,6 +225,40 @@ TEST_F(ProcessTest, WaitForExitWithTimeout) {
   process.Terminate(kDummyExitCode, false);
 }
 
+#if defined(OS_POSIX) && !defined(OS_FUCHSIA)
+namespace {
+
+void StoreExitCode(int* out, OnceClosure quit_closure, int exit_code) {
+  *out = exit_code;
+  std::move(quit_closure).Run();
+}
+
+}  // namespace
+
+TEST_F(ProcessTest, WaitForExitAsync) {
+  test::ScopedTaskEnvironment scoped_task_environment;
+
+  Process process(SpawnChild("TerminateCurrentProcessImmediatelyWithCode250"));
+  ASSERT_TRUE(process.IsValid());
+  int exit_code = 42;
+  RunLoop run_loop;
+  process.WaitForExitAsync(
+      BindOnce(&StoreExitCode, &exit_code, run_loop.QuitClosure()));
+  run_loop.Run();
+  EXPECT_EQ(250, exit_code);
+
+  // Processes killed by a signal report -1, like with WaitForExit().
+  Process sleepy_process(SpawnChild("SleepyChildProcess"));
+  ASSERT_TRUE(sleepy_process.IsValid());
+  RunLoop sleepy_run_loop;
+  sleepy_process.WaitForExitAsync(
+      BindOnce(&StoreExitCode, &exit_code, sleepy_run_loop.QuitClosure()));
+  sleepy_process.Terminate(0, false);
+  sleepy_run_loop.Run();
+  EXPECT_EQ(-1, exit_code);
+}
+#endif  // defined(OS_POSIX) && !defined(OS_FUCHSIA)
+
 // Ensure that the priority of a process is restored correctly after
 // backgrounding and restoring.
 // Note: a platform may not be willing or able to lower the priority of
@@ -1024,6 +1024,22 @@ TEST_F(ProcessUtilTest, LaunchProcess) {
 #endif  // defined(OS_LINUX)
 }
 
+// The executable is looked up in the PATH of the environment of the child.
+TEST_F(ProcessUtilTest, LaunchProcessSearchesChildPath) {
+  const char kBaseTest[] = "BASE_TEST";
+  const std::string parent_path = getenv("PATH");
+  const std::vector<std::string> kPrintEnvCommand = {
+      test_helper_path_.BaseName().value(), "-e", kBaseTest};
+
+  EnvironmentMap env_changes;
+  env_changes["PATH"] = test_helper_path_.DirName().value();
+  env_changes[kBaseTest] = "found";
+  EXPECT_EQ("found", TestLaunchProcess(kPrintEnvCommand, env_changes,
+                                       false /* clear_environ */,
+                                       0 /* clone_flags */));
+  EXPECT_EQ(parent_path, getenv("PATH"));
+}
+
 // There's no such thing as a parent process id on Fuchsia.
 #if !defined(OS_FUCHSIA)
 TEST_F(ProcessUtilTest, GetParentProcessId) {
@@ -1124,6 +1140,23 @@ TEST(ForkWithFlagsTest, UpdatesPidCache) {
   EXPECT_EQ(kSuccess, WEXITSTATUS(status));
 }
 
+TEST(ForkWithFlagsTest, UpdatesTidCache) {
+  // Warm up the thread id cache.
+  ASSERT_EQ(syscall(__NR_gettid), PlatformThread::CurrentId());
+
+  const pid_t pid = ForkWithFlags(SIGCHLD, nullptr, nullptr);
+  if (pid == 0) {
+    RAW_CHECK(syscall(__NR_gettid) == PlatformThread::CurrentId());
+    _exit(kSuccess);
+  }
+
+  ASSERT_NE(-1, pid);
+  int status = 42;
+  ASSERT_EQ(pid, HANDLE_EINTR(waitpid(pid, &status, 0)));
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(kSuccess, WEXITSTATUS(status));
+}
+
 TEST_F(ProcessUtilTest, InvalidCurrentDirectory) {
   LaunchOptions options;
   options.current_directory = FilePath("/dev/null");
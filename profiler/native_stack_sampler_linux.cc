@@ -0,0 +1,500 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/profiler/native_stack_sampler.h"
+
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_64) || defined(ARCH_CPU_ARM64)
+
+#include <errno.h>
+#include <link.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "base/debug/elf_reader_linux.h"
+#include "base/debug/proc_maps_linux.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+
+namespace base {
+
+namespace {
+
+// The signal which makes the sampled thread copy its stack. SIGURG is ignored
+// by default, so a signal which arrives after its sample was abandoned is
+// harmless.
+constexpr int kSamplingSignal = SIGURG;
+
+// How long to wait for the sampled thread to handle the signal, beyond which
+// the sample is abandoned. The thread may have blocked the signal, or not be
+// scheduled.
+constexpr TimeDelta kSignalTimeout = TimeDelta::FromMilliseconds(100);
+
+// Bounds the frames walked, in case the frame pointers form a long chain of
+// garbage which happens to look valid.
+constexpr size_t kMaxFrames = 256;
+
+// The registers needed to walk the stack.
+struct RegisterState {
+  uintptr_t pc;
+  uintptr_t sp;
+  uintptr_t fp;
+};
+
+// The request for a sample, shared with the signal handler. StackSamplingProfiler
+// samples all the threads from its single sampling thread, so there is at most
+// one request at a time.
+struct SampleRequest {
+  // The thread to sample. The signal handler, or the sampling thread if the
+  // handler doesn't run in time, claims the request by resetting it to 0.
+  std::atomic<pid_t> thread_id;
+
+  // Where to copy the stack, and the bounds of the stack of the thread.
+  uintptr_t* buffer;
+  size_t buffer_size;
+  uintptr_t stack_bottom;
+  uintptr_t stack_top;
+
+  // Set by the signal handler before posting |done|. |stack_size| is 0 if the
+  // stack pointer is not within the bounds of the stack.
+  RegisterState registers;
+  size_t stack_size;
+  sem_t done;
+};
+
+SampleRequest g_request;
+struct sigaction g_previous_action;
+
+// Copies |count| words of the stack of the current thread. Runs in the signal
+// handler, which must not call anything which isn't async-signal-safe.
+NO_SANITIZE("address")
+void CopyStack(uintptr_t* destination, const uintptr_t* source, size_t count) {
+  for (size_t i = 0; i < count; ++i)
+    destination[i] = source[i];
+}
+
+void GetRegisterState(const ucontext_t* context, RegisterState* registers) {
+#if defined(ARCH_CPU_X86_64)
+  registers->pc = context->uc_mcontext.gregs[REG_RIP];
+  registers->sp = context->uc_mcontext.gregs[REG_RSP];
+  registers->fp = context->uc_mcontext.gregs[REG_RBP];
+#elif defined(ARCH_CPU_ARM64)
+  registers->pc = context->uc_mcontext.pc;
+  registers->sp = context->uc_mcontext.sp;
+  registers->fp = context->uc_mcontext.regs[29];
+#endif
+}
+
+// IMPORTANT NOTE: This runs on the sampled thread, interrupted at an arbitrary
+// point. Do not do ANYTHING in here that might allocate memory or take a lock,
+// including indirectly via use of DCHECK/CHECK or other logging statements.
+void OnSamplingSignal(int signal, siginfo_t* info, void* context) {
+  int saved_errno = errno;
+  bool is_sampling_signal =
+      info->si_code == SI_TKILL && info->si_pid == getpid();
+  pid_t thread_id = static_cast<pid_t>(syscall(__NR_gettid));
+  if (!is_sampling_signal) {
+    // Someone else's signal.
+    if (g_previous_action.sa_flags & SA_SIGINFO) {
+      if (g_previous_action.sa_sigaction)
+        g_previous_action.sa_sigaction(signal, info, context);
+    } else if (g_previous_action.sa_handler != SIG_DFL &&
+               g_previous_action.sa_handler != SIG_IGN) {
+      g_previous_action.sa_handler(signal);
+    }
+  } else if (g_request.thread_id.compare_exchange_strong(
+                 thread_id, 0, std::memory_order_acquire)) {
+    RegisterState* registers = &g_request.registers;
+    GetRegisterState(static_cast<ucontext_t*>(context), registers);
+    g_request.stack_size = 0;
+    if (registers->sp >= g_request.stack_bottom &&
+        registers->sp < g_request.stack_top) {
+      // The frames closest to the top of the stack are dropped if the buffer
+      // is too small.
+      size_t stack_size = std::min(g_request.stack_top - registers->sp,
+                                   g_request.buffer_size) &
+                          ~(sizeof(uintptr_t) - 1);
+      CopyStack(g_request.buffer,
+                reinterpret_cast<const uintptr_t*>(registers->sp),
+                stack_size / sizeof(uintptr_t));
+      g_request.stack_size = stack_size;
+    }
+    sem_post(&g_request.done);
+  }
+  errno = saved_errno;
+}
+
+bool InstallSignalHandler() {
+  if (sem_init(&g_request.done, 0, 0))
+    return false;
+  struct sigaction action = {};
+  action.sa_sigaction = &OnSamplingSignal;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  return !sigaction(kSamplingSignal, &action, &g_previous_action);
+}
+
+// Module identifiers ---------------------------------------------------------
+
+// Maps a module's address range (half-open) in memory to an index in a separate
+// data structure.
+struct ModuleIndex {
+  ModuleIndex(uintptr_t start, uintptr_t end, size_t idx)
+      : base_address(start), end_address(end), index(idx) {}
+  // Start of the executable code of the represented module.
+  uintptr_t base_address;
+  // First address off the end of the executable code of the represented
+  // module.
+  uintptr_t end_address;
+  // An index to the represented module in a separate container.
+  size_t index;
+};
+
+// The module containing |address|, found by FindModule().
+struct ModuleSearch {
+  uintptr_t address;
+  uintptr_t code_start;
+  uintptr_t code_end;
+  const void* elf_header;
+  const char* name;
+};
+
+int FindModuleCallback(dl_phdr_info* info, size_t size, void* data) {
+  ModuleSearch* search = static_cast<ModuleSearch*>(data);
+  uintptr_t code_start = std::numeric_limits<uintptr_t>::max();
+  uintptr_t code_end = 0;
+  const void* elf_header = nullptr;
+  bool contains_address = false;
+  for (int i = 0; i < info->dlpi_phnum; ++i) {
+    const ElfW(Phdr)& header = info->dlpi_phdr[i];
+    if (header.p_type != PT_LOAD)
+      continue;
+    uintptr_t start = info->dlpi_addr + header.p_vaddr;
+    uintptr_t end = start + header.p_memsz;
+    if (header.p_offset == 0)
+      elf_header = reinterpret_cast<const void*>(start);
+    if (!(header.p_flags & PF_X))
+      continue;
+    code_start = std::min(code_start, start);
+    code_end = std::max(code_end, end);
+    if (search->address >= start && search->address < end)
+      contains_address = true;
+  }
+  if (!contains_address || !elf_header)
+    return 0;
+  search->code_start = code_start;
+  search->code_end = code_end;
+  search->elf_header = elf_header;
+  search->name = info->dlpi_name;
+  return 1;
+}
+
+// Gets the index for the Module containing |instruction_pointer| in
+// |modules|, adding it if it's not already present. Returns
+// StackSamplingProfiler::Frame::kUnknownModuleIndex if no Module can be
+// determined for |instruction_pointer|.
+size_t GetModuleIndex(uintptr_t instruction_pointer,
+                      std::vector<StackSamplingProfiler::Module>* modules,
+                      std::vector<ModuleIndex>* profile_module_index) {
+  auto module_index =
+      std::find_if(profile_module_index->begin(), profile_module_index->end(),
+                   [instruction_pointer](const ModuleIndex& index) {
+                     return instruction_pointer >= index.base_address &&
+                            instruction_pointer < index.end_address;
+                   });
+  if (module_index != profile_module_index->end())
+    return module_index->index;
+
+  ModuleSearch search = {instruction_pointer};
+  if (!dl_iterate_phdr(&FindModuleCallback, &search))
+    return StackSamplingProfiler::Frame::kUnknownModuleIndex;
+
+  // The main executable has no name.
+  FilePath filename(search.name);
+  if (filename.empty())
+    ReadSymbolicLink(FilePath("/proc/self/exe"), &filename);
+  modules->emplace_back(reinterpret_cast<uintptr_t>(search.elf_header),
+                        debug::ReadElfBuildId(search.elf_header)
+                            .value_or(std::string()),
+                        filename);
+  size_t index = modules->size() - 1;
+  profile_module_index->emplace_back(search.code_start, search.code_end, index);
+  return index;
+}
+
+// NativeStackSamplerLinux ----------------------------------------------------
+
+class NativeStackSamplerLinux : public NativeStackSampler {
+ public:
+  NativeStackSamplerLinux(PlatformThreadId thread_id,
+                          AnnotateCallback annotator,
+                          NativeStackSamplerTestDelegate* test_delegate);
+  ~NativeStackSamplerLinux() override;
+
+  // StackSamplingProfiler::NativeStackSampler:
+  void ProfileRecordingStarting(
+      std::vector<StackSamplingProfiler::Module>* modules) override;
+  void RecordStackSample(StackBuffer* stack_buffer,
+                         StackSamplingProfiler::Sample* sample) override;
+  void ProfileRecordingStopped(StackBuffer* stack_buffer) override;
+
+ private:
+  // Signals the thread to copy its stack to |stack_buffer|, and waits for it.
+  // Returns false if the thread didn't handle the signal in time. Otherwise,
+  // sets |registers| and |stack_size|, which is 0 if the stack pointer is out
+  // of the known bounds of the stack.
+  bool CopyThreadStack(StackBuffer* stack_buffer,
+                       RegisterState* registers,
+                       size_t* stack_size);
+
+  // Sets the bounds of the stack to the mapping which contains |sp|. Returns
+  // false if there is none.
+  bool UpdateStackBounds(uintptr_t sp);
+
+  // Walks the frame pointers of the copy of the stack, and records the frames
+  // and associated modules into |sample|.
+  void WalkStack(const uintptr_t* stack_copy,
+                 size_t stack_size,
+                 const RegisterState& registers,
+                 StackSamplingProfiler::Sample* sample);
+
+  const PlatformThreadId thread_id_;
+
+  const AnnotateCallback annotator_;
+
+  NativeStackSamplerTestDelegate* const test_delegate_;
+
+  // The bounds of the mapping which holds the stack of the thread, found on
+  // the first sample, and updated when the stack grows out of them.
+  uintptr_t stack_bottom_ = 0;
+  uintptr_t stack_top_ = 0;
+
+  // Weak. Points to the modules associated with the profile being recorded
+  // between ProfileRecordingStarting() and ProfileRecordingStopped().
+  std::vector<StackSamplingProfiler::Module>* current_modules_ = nullptr;
+
+  // Maps a module's address range to the corresponding Module's index within
+  // current_modules_.
+  std::vector<ModuleIndex> profile_module_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(NativeStackSamplerLinux);
+};
+
+NativeStackSamplerLinux::NativeStackSamplerLinux(
+    PlatformThreadId thread_id,
+    AnnotateCallback annotator,
+    NativeStackSamplerTestDelegate* test_delegate)
+    : thread_id_(thread_id),
+      annotator_(annotator),
+      test_delegate_(test_delegate) {
+  DCHECK(annotator_);
+}
+
+NativeStackSamplerLinux::~NativeStackSamplerLinux() = default;
+
+void NativeStackSamplerLinux::ProfileRecordingStarting(
+    std::vector<StackSamplingProfiler::Module>* modules) {
+  current_modules_ = modules;
+  profile_module_index_.clear();
+}
+
+void NativeStackSamplerLinux::RecordStackSample(
+    StackBuffer* stack_buffer,
+    StackSamplingProfiler::Sample* sample) {
+  DCHECK(current_modules_);
+
+  RegisterState registers;
+  size_t stack_size;
+  if (!CopyThreadStack(stack_buffer, &registers, &stack_size))
+    return;
+  if (!stack_size) {
+    // This is the first sample, or the stack grew. Finding the bounds of the
+    // stack allocates, so it can't be done by the signal handler.
+    if (!UpdateStackBounds(registers.sp) ||
+        !CopyThreadStack(stack_buffer, &registers, &stack_size) ||
+        !stack_size) {
+      return;
+    }
+  }
+
+  (*annotator_)(sample);
+
+  if (test_delegate_)
+    test_delegate_->OnPreStackWalk();
+
+  WalkStack(static_cast<const uintptr_t*>(stack_buffer->buffer()), stack_size,
+            registers, sample);
+}
+
+void NativeStackSamplerLinux::ProfileRecordingStopped(
+    StackBuffer* stack_buffer) {
+  current_modules_ = nullptr;
+}
+
+bool NativeStackSamplerLinux::CopyThreadStack(StackBuffer* stack_buffer,
+                                              RegisterState* registers,
+                                              size_t* stack_size) {
+  g_request.buffer = static_cast<uintptr_t*>(stack_buffer->buffer());
+  g_request.buffer_size = stack_buffer->size();
+  g_request.stack_bottom = stack_bottom_;
+  g_request.stack_top = stack_top_;
+  // Publishes the request to the signal handler.
+  g_request.thread_id.store(thread_id_, std::memory_order_release);
+
+  if (syscall(__NR_tgkill, getpid(), thread_id_, kSamplingSignal)) {
+    g_request.thread_id.store(0, std::memory_order_relaxed);
+    return false;
+  }
+
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_nsec += kSignalTimeout.InMicroseconds() * 1000;
+  deadline.tv_sec += deadline.tv_nsec / Time::kNanosecondsPerSecond;
+  deadline.tv_nsec %= Time::kNanosecondsPerSecond;
+  int result;
+  do {
+    result = sem_timedwait(&g_request.done, &deadline);
+  } while (result && errno == EINTR);
+
+  if (result) {
+    // Abandons the request, unless the handler claimed it in the meantime, in
+    // which case it is about to complete.
+    pid_t thread_id = thread_id_;
+    if (g_request.thread_id.compare_exchange_strong(
+            thread_id, 0, std::memory_order_relaxed)) {
+      return false;
+    }
+    while (sem_wait(&g_request.done) && errno == EINTR) {
+    }
+  }
+
+  // Synchronizes with the handler through |done|.
+  *registers = g_request.registers;
+  *stack_size = g_request.stack_size;
+  return true;
+}
+
+bool NativeStackSamplerLinux::UpdateStackBounds(uintptr_t sp) {
+  std::string proc_maps;
+  std::vector<debug::MappedMemoryRegion> regions;
+  if (!debug::ReadProcMaps(&proc_maps) ||
+      !debug::ParseProcMaps(proc_maps, &regions)) {
+    return false;
+  }
+  for (const debug::MappedMemoryRegion& region : regions) {
+    if (sp >= region.start && sp < region.end &&
+        (region.permissions & debug::MappedMemoryRegion::READ)) {
+      stack_bottom_ = region.start;
+      stack_top_ = region.end;
+      return true;
+    }
+  }
+  return false;
+}
+
+void NativeStackSamplerLinux::WalkStack(const uintptr_t* stack_copy,
+                                        size_t stack_size,
+                                        const RegisterState& registers,
+                                        StackSamplingProfiler::Sample* sample) {
+  // Reserve enough memory for most stacks, to avoid repeated allocations.
+  // Approximately 99.9% of recorded stacks are 128 frames or fewer.
+  sample->frames.reserve(128);
+
+  size_t module_index = GetModuleIndex(registers.pc, current_modules_,
+                                       &profile_module_index_);
+  if (module_index == StackSamplingProfiler::Frame::kUnknownModuleIndex)
+    return;
+  sample->frames.emplace_back(registers.pc, module_index);
+
+  // Each frame starts with a record of the frame pointer of its caller,
+  // followed by its return address. Frame pointers point within the original
+  // stack, at the same offset from the stack pointer as in the copy.
+  const size_t kFrameRecordSize = 2 * sizeof(uintptr_t);
+  uintptr_t fp = registers.fp;
+  while (sample->frames.size() < kMaxFrames) {
+    if (fp < registers.sp || fp % sizeof(uintptr_t) ||
+        stack_size < kFrameRecordSize ||
+        fp - registers.sp > stack_size - kFrameRecordSize) {
+      break;
+    }
+    const uintptr_t* frame_record =
+        stack_copy + (fp - registers.sp) / sizeof(uintptr_t);
+    uintptr_t return_address = frame_record[1];
+    // Frame pointers which don't lead to code are garbage, for instance from
+    // a function compiled without frame pointers.
+    module_index = GetModuleIndex(return_address, current_modules_,
+                                  &profile_module_index_);
+    if (module_index == StackSamplingProfiler::Frame::kUnknownModuleIndex)
+      break;
+    sample->frames.emplace_back(return_address, module_index);
+    // The stack grows down, so the frames of callers are above.
+    if (frame_record[0] <= fp)
+      break;
+    fp = frame_record[0];
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<NativeStackSampler> NativeStackSampler::Create(
+    PlatformThreadId thread_id,
+    AnnotateCallback annotator,
+    NativeStackSamplerTestDelegate* test_delegate) {
+  static const bool signal_handler_installed = InstallSignalHandler();
+  if (!signal_handler_installed)
+    return nullptr;
+  return std::make_unique<NativeStackSamplerLinux>(thread_id, annotator,
+                                                   test_delegate);
+}
+
+size_t NativeStackSampler::GetStackBufferSize() {
+  // The default stack size of the threads created by glibc is RLIMIT_STACK, as
+  // is the maximum size of the stack of the main thread.
+  struct rlimit stack_rlimit;
+  if (getrlimit(RLIMIT_STACK, &stack_rlimit) == 0 &&
+      stack_rlimit.rlim_cur != RLIM_INFINITY) {
+    return stack_rlimit.rlim_cur;
+  }
+
+  // The usual RLIMIT_STACK, with extra wiggle room.
+  return 12 * 1024 * 1024;
+}
+
+}  // namespace base
+
+#else  // defined(ARCH_CPU_X86_64) || defined(ARCH_CPU_ARM64)
+
+namespace base {
+
+std::unique_ptr<NativeStackSampler> NativeStackSampler::Create(
+    PlatformThreadId thread_id,
+    AnnotateCallback annotator,
+    NativeStackSamplerTestDelegate* test_delegate) {
+  return std::unique_ptr<NativeStackSampler>();
+}
+
+size_t NativeStackSampler::GetStackBufferSize() {
+  return 0;
+}
+
+}  // namespace base
+
+#endif  // defined(ARCH_CPU_X86_64) || defined(ARCH_CPU_ARM64)
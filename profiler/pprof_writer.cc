@@ -0,0 +1,355 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/profiler/pprof_writer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/logging.h"
+
+#if defined(OS_LINUX)
+#include "base/debug/elf_reader_linux.h"
+#include "base/debug/proc_maps_linux.h"
+#endif
+
+namespace base {
+
+namespace {
+
+// The number of bytes buffered before they are sent to the sink.
+constexpr size_t kBufferSize = 64 * 1024;
+
+// Field numbers of the messages of profile.proto.
+enum ProfileField {
+  kProfileSampleType = 1,
+  kProfileSample = 2,
+  kProfileMapping = 3,
+  kProfileLocation = 4,
+  kProfileStringTable = 6,
+  kProfileTimeNanos = 9,
+  kProfileDurationNanos = 10,
+  kProfilePeriodType = 11,
+  kProfilePeriod = 12,
+};
+
+enum ValueTypeField {
+  kValueTypeType = 1,
+  kValueTypeUnit = 2,
+};
+
+enum SampleField {
+  kSampleLocationId = 1,
+  kSampleValue = 2,
+};
+
+enum MappingField {
+  kMappingId = 1,
+  kMappingMemoryStart = 2,
+  kMappingMemoryLimit = 3,
+  kMappingFileOffset = 4,
+  kMappingFilename = 5,
+  kMappingBuildId = 6,
+};
+
+enum LocationField {
+  kLocationId = 1,
+  kLocationMappingId = 2,
+  kLocationAddress = 3,
+};
+
+enum WireType {
+  kVarint = 0,
+  kLengthDelimited = 2,
+};
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void AppendKey(int field_number, WireType wire_type, std::string* out) {
+  AppendVarint((static_cast<uint64_t>(field_number) << 3) | wire_type, out);
+}
+
+// Integers of all types are encoded as varints, negative ones taking ten
+// bytes. Fields of value 0, the default, are omitted.
+void AppendVarintField(int field_number, uint64_t value, std::string* out) {
+  if (!value)
+    return;
+  AppendKey(field_number, kVarint, out);
+  AppendVarint(value, out);
+}
+
+void AppendBytesField(int field_number, StringPiece bytes, std::string* out) {
+  AppendKey(field_number, kLengthDelimited, out);
+  AppendVarint(bytes.size(), out);
+  out->append(bytes.data(), bytes.size());
+}
+
+// Appends |values| as a packed repeated field.
+template <typename T>
+void AppendPackedField(int field_number,
+                       const std::vector<T>& values,
+                       std::string* scratch,
+                       std::string* out) {
+  if (values.empty())
+    return;
+  scratch->clear();
+  for (T value : values)
+    AppendVarint(static_cast<uint64_t>(value), scratch);
+  AppendBytesField(field_number, *scratch, out);
+}
+
+// Return addresses point after the call instruction, possibly into the next
+// line or function. pprof expects an address within the call.
+uintptr_t CallAddress(uintptr_t return_address) {
+  return return_address ? return_address - 1 : 0;
+}
+
+}  // namespace
+
+PprofWriter::PprofWriter(Sink sink) : sink_(std::move(sink)) {
+  buffer_.reserve(kBufferSize);
+  // The first string of the table must be the empty string.
+  InternString(StringPiece());
+}
+
+PprofWriter::~PprofWriter() {
+  DCHECK(finished_);
+}
+
+void PprofWriter::AddSampleType(StringPiece type, StringPiece unit) {
+  std::string value_type;
+  AppendVarintField(kValueTypeType, InternString(type), &value_type);
+  AppendVarintField(kValueTypeUnit, InternString(unit), &value_type);
+  WriteMessage(kProfileSampleType, value_type);
+  ++num_sample_types_;
+}
+
+void PprofWriter::SetPeriod(StringPiece type,
+                            StringPiece unit,
+                            int64_t period) {
+  std::string value_type;
+  AppendVarintField(kValueTypeType, InternString(type), &value_type);
+  AppendVarintField(kValueTypeUnit, InternString(unit), &value_type);
+  WriteMessage(kProfilePeriodType, value_type);
+  AppendVarintField(kProfilePeriod, period, &buffer_);
+}
+
+void PprofWriter::SetTime(Time start, TimeDelta duration) {
+  if (!start.is_null()) {
+    AppendVarintField(kProfileTimeNanos,
+                      (start - Time::UnixEpoch()).InMicroseconds() *
+                          Time::kNanosecondsPerMicrosecond,
+                      &buffer_);
+  }
+  AppendVarintField(kProfileDurationNanos, duration.InNanoseconds(), &buffer_);
+}
+
+uint64_t PprofWriter::AddMapping(uintptr_t start,
+                                 uintptr_t limit,
+                                 uint64_t file_offset,
+                                 StringPiece filename,
+                                 StringPiece build_id) {
+  DCHECK(location_ids_.empty());
+  uint64_t id = mappings_.size() + 1;
+  auto it = std::upper_bound(
+      mappings_.begin(), mappings_.end(), start,
+      [](uintptr_t start, const Mapping& mapping) {
+        return start < mapping.start;
+      });
+  mappings_.insert(it, {start, limit, id});
+
+  message_.clear();
+  AppendVarintField(kMappingId, id, &message_);
+  AppendVarintField(kMappingMemoryStart, start, &message_);
+  AppendVarintField(kMappingMemoryLimit, limit, &message_);
+  AppendVarintField(kMappingFileOffset, file_offset, &message_);
+  AppendVarintField(kMappingFilename, InternString(filename), &message_);
+  AppendVarintField(kMappingBuildId, InternString(build_id), &message_);
+  WriteMessage(kProfileMapping, message_);
+  return id;
+}
+
+#if defined(OS_LINUX)
+void PprofWriter::AddMappingsFromProcMaps() {
+  std::string proc_maps;
+  std::vector<debug::MappedMemoryRegion> regions;
+  if (!debug::ReadProcMaps(&proc_maps) ||
+      !debug::ParseProcMaps(proc_maps, &regions)) {
+    return;
+  }
+  for (const debug::MappedMemoryRegion& region : regions) {
+    if (!(region.permissions & debug::MappedMemoryRegion::EXECUTE) ||
+        region.path.empty() || region.path[0] == '[') {
+      continue;
+    }
+    // The ELF header is at the start of the first mapping of the file, which
+    // precedes the executable ones.
+    std::string build_id;
+    auto header = std::find_if(
+        regions.begin(), regions.end(),
+        [&region](const debug::MappedMemoryRegion& other) {
+          return other.offset == 0 && other.path == region.path &&
+                 (other.permissions & debug::MappedMemoryRegion::READ) &&
+                 other.start <= region.start;
+        });
+    if (header != regions.end()) {
+      build_id = debug::ReadElfBuildId(reinterpret_cast<void*>(header->start))
+                     .value_or(std::string());
+    }
+    AddMapping(region.start, region.end, region.offset, region.path,
+               build_id);
+  }
+}
+#endif  // defined(OS_LINUX)
+
+uint64_t PprofWriter::InternLocation(uintptr_t address, uint64_t mapping_id) {
+  auto result = location_ids_.try_emplace(address, location_ids_.size() + 1);
+  if (!result.second)
+    return result.first->second;
+
+  if (!mapping_id) {
+    auto it = std::upper_bound(
+        mappings_.begin(), mappings_.end(), address,
+        [](uintptr_t address, const Mapping& mapping) {
+          return address < mapping.start;
+        });
+    if (it != mappings_.begin() && address < (it - 1)->limit)
+      mapping_id = (it - 1)->id;
+  }
+
+  message_.clear();
+  AppendVarintField(kLocationId, result.first->second, &message_);
+  AppendVarintField(kLocationMappingId, mapping_id, &message_);
+  AppendVarintField(kLocationAddress, address, &message_);
+  WriteMessage(kProfileLocation, message_);
+  return result.first->second;
+}
+
+void PprofWriter::AddSample(const std::vector<uint64_t>& location_ids,
+                            const std::vector<int64_t>& values) {
+  DCHECK_EQ(num_sample_types_, values.size());
+  message_.clear();
+  AppendPackedField(kSampleLocationId, location_ids, &packed_field_,
+                    &message_);
+  AppendPackedField(kSampleValue, values, &packed_field_, &message_);
+  WriteMessage(kProfileSample, message_);
+}
+
+void PprofWriter::Finish() {
+  DCHECK(!finished_);
+  Flush();
+  finished_ = true;
+}
+
+int64_t PprofWriter::InternString(StringPiece string) {
+  auto it = string_indices_.find(string);
+  if (it != string_indices_.end())
+    return it->second;
+  int64_t index = string_indices_.size();
+  string_indices_.emplace(string.as_string(), index);
+  AppendBytesField(kProfileStringTable, string, &buffer_);
+  return index;
+}
+
+void PprofWriter::WriteMessage(int field_number, const std::string& message) {
+  DCHECK(!finished_);
+  AppendBytesField(field_number, message, &buffer_);
+  if (buffer_.size() >= kBufferSize)
+    Flush();
+}
+
+void PprofWriter::Flush() {
+  if (buffer_.empty())
+    return;
+  sink_.Run(buffer_);
+  buffer_.clear();
+}
+
+void WriteHeapProfileAsPprof(
+    const std::vector<SamplingHeapProfiler::Sample>& samples,
+    PprofWriter::Sink sink) {
+  PprofWriter writer(std::move(sink));
+  writer.AddSampleType("inuse_objects", "count");
+  writer.AddSampleType("inuse_space", "bytes");
+#if defined(OS_LINUX)
+  writer.AddMappingsFromProcMaps();
+#endif
+
+  std::vector<uint64_t> location_ids;
+  for (const SamplingHeapProfiler::Sample& sample : samples) {
+    location_ids.clear();
+    // All the frames are return addresses, since the stack is captured by
+    // the profiler.
+    for (void* frame : sample.stack) {
+      uintptr_t address = CallAddress(reinterpret_cast<uintptr_t>(frame));
+      location_ids.push_back(writer.InternLocation(address));
+    }
+    // Each sample stands for |total| bytes of allocations of |size| bytes.
+    int64_t count = std::max<int64_t>(
+        1, sample.size ? sample.total / sample.size : 0);
+    writer.AddSample(location_ids,
+                     {count, static_cast<int64_t>(sample.total)});
+  }
+  writer.Finish();
+}
+
+void WriteCallStackProfileAsPprof(
+    const StackSamplingProfiler::CallStackProfile& profile,
+    PprofWriter::Sink sink) {
+  PprofWriter writer(std::move(sink));
+  writer.AddSampleType("samples", "count");
+  writer.AddSampleType("cpu", "nanoseconds");
+  int64_t period = profile.sampling_period.InNanoseconds();
+  writer.SetPeriod("cpu", "nanoseconds", period);
+  writer.SetTime(Time(), profile.profile_duration);
+
+  // The extent of the modules isn't recorded, so the mappings end after the
+  // last sampled address of their module.
+  std::vector<uintptr_t> module_limits(profile.modules.size());
+  for (size_t i = 0; i < profile.modules.size(); ++i)
+    module_limits[i] = profile.modules[i].base_address + 1;
+  for (const StackSamplingProfiler::Sample& sample : profile.samples) {
+    for (const StackSamplingProfiler::Frame& frame : sample.frames) {
+      if (frame.module_index < module_limits.size()) {
+        module_limits[frame.module_index] =
+            std::max(module_limits[frame.module_index],
+                     frame.instruction_pointer + 1);
+      }
+    }
+  }
+  std::vector<uint64_t> mapping_ids;
+  for (size_t i = 0; i < profile.modules.size(); ++i) {
+    const StackSamplingProfiler::Module& module = profile.modules[i];
+    mapping_ids.push_back(writer.AddMapping(module.base_address,
+                                            module_limits[i], 0,
+                                            module.filename.AsUTF8Unsafe(),
+                                            module.id));
+  }
+
+  std::vector<uint64_t> location_ids;
+  for (const StackSamplingProfiler::Sample& sample : profile.samples) {
+    location_ids.clear();
+    for (size_t i = 0; i < sample.frames.size(); ++i) {
+      const StackSamplingProfiler::Frame& frame = sample.frames[i];
+      // The innermost frame is the sampled instruction, the others are
+      // return addresses.
+      uintptr_t address = i ? CallAddress(frame.instruction_pointer)
+                            : frame.instruction_pointer;
+      uint64_t mapping_id = frame.module_index < mapping_ids.size()
+                                ? mapping_ids[frame.module_index]
+                                : 0;
+      location_ids.push_back(writer.InternLocation(address, mapping_id));
+    }
+    writer.AddSample(location_ids, {1, period});
+  }
+  writer.Finish();
+}
+
+}  // namespace base
@@ -0,0 +1,146 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PROFILER_PPROF_WRITER_H_
+#define BASE_PROFILER_PPROF_WRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/containers/flat_hash_map.h"
+#include "base/macros.h"
+#include "base/profiler/stack_sampling_profiler.h"
+#include "base/sampling_heap_profiler/sampling_heap_profiler.h"
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+#include "build/build_config.h"
+
+namespace base {
+
+// Encodes a profile in the pprof format, i.e. as a serialized
+// perftools.profiles.Profile protocol buffer (see
+// https://github.com/google/pprof/blob/master/proto/profile.proto), which is
+// not compressed.
+//
+// The profile is streamed to a sink as it is written: the writer only keeps the
+// tables needed to deduplicate the strings, mappings and locations, and not the
+// samples. This relies on the fields of a protocol buffer message being allowed
+// in any order, including the elements of repeated fields being interleaved
+// with other fields.
+//
+// Example:
+//   PprofWriter writer(BindRepeating(&AppendToFile, &file));
+//   writer.AddSampleType("samples", "count");
+//   writer.AddMappingsFromProcMaps();
+//   std::vector<uint64_t> location_ids;
+//   for (uintptr_t address : stack)
+//     location_ids.push_back(writer.InternLocation(address));
+//   writer.AddSample(location_ids, {1});
+//   writer.Finish();
+//
+// The mappings must be added before the first location which refers to them.
+class BASE_EXPORT PprofWriter {
+ public:
+  // Receives the encoded profile, in chunks.
+  using Sink = RepeatingCallback<void(StringPiece)>;
+
+  explicit PprofWriter(Sink sink);
+  ~PprofWriter();
+
+  // Adds a type of the values of the samples. All samples have a value of each
+  // type, in the order the types are added.
+  void AddSampleType(StringPiece type, StringPiece unit);
+
+  // Sets the kind of events sampled, and the number of them between samples.
+  void SetPeriod(StringPiece type, StringPiece unit, int64_t period);
+
+  // Sets when the collection of the profile started, which may be null if
+  // unknown, and how long it lasted.
+  void SetTime(Time start, TimeDelta duration);
+
+  // Adds a mapping of the file |filename| at [|start|, |limit|), and returns
+  // its id. |build_id| is empty if unknown.
+  uint64_t AddMapping(uintptr_t start,
+                      uintptr_t limit,
+                      uint64_t file_offset,
+                      StringPiece filename,
+                      StringPiece build_id);
+
+#if defined(OS_LINUX)
+  // Adds the executable mappings of the current process, with the build ids
+  // of the ELF files they map.
+  void AddMappingsFromProcMaps();
+#endif
+
+  // Returns the id of the location of the code at |address|, writing the
+  // location the first time. |mapping_id| is that of the mapping of the code,
+  // or 0 to find it among the mappings by address.
+  uint64_t InternLocation(uintptr_t address, uint64_t mapping_id = 0);
+
+  // Adds a sample of the stack of locations |location_ids|, innermost first,
+  // with a value per sample type.
+  void AddSample(const std::vector<uint64_t>& location_ids,
+                 const std::vector<int64_t>& values);
+
+  // Writes the end of the profile to the sink. The writer can't be used
+  // afterwards.
+  void Finish();
+
+ private:
+  struct Mapping {
+    uintptr_t start;
+    uintptr_t limit;
+    uint64_t id;
+  };
+
+  // Returns the index of |string| in the string table, adding it if needed.
+  int64_t InternString(StringPiece string);
+
+  // Writes |message| as the field |field_number| of the profile.
+  void WriteMessage(int field_number, const std::string& message);
+
+  // Flushes the buffer to the sink.
+  void Flush();
+
+  const Sink sink_;
+
+  // Holds the encoded profile until it is big enough to be sent to the sink.
+  std::string buffer_;
+
+  // Scratch space for encoding the messages nested in the profile, and the
+  // packed fields of samples.
+  std::string message_;
+  std::string packed_field_;
+
+  flat_hash_map<std::string, int64_t> string_indices_;
+  flat_hash_map<uintptr_t, uint64_t> location_ids_;
+
+  // Sorted by start address.
+  std::vector<Mapping> mappings_;
+
+  size_t num_sample_types_ = 0;
+  bool finished_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(PprofWriter);
+};
+
+// Writes |samples| of SamplingHeapProfiler as a pprof heap profile of the live
+// objects and space.
+BASE_EXPORT void WriteHeapProfileAsPprof(
+    const std::vector<SamplingHeapProfiler::Sample>& samples,
+    PprofWriter::Sink sink);
+
+// Writes |profile| of StackSamplingProfiler as a pprof CPU profile.
+BASE_EXPORT void WriteCallStackProfileAsPprof(
+    const StackSamplingProfiler::CallStackProfile& profile,
+    PprofWriter::Sink sink);
+
+}  // namespace base
+
+#endif  // BASE_PROFILER_PPROF_WRITER_H_
@@ -0,0 +1,241 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/profiler/pprof_writer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// A decoded protocol buffer message: the values of its fields by field number.
+// Varints are decoded to integers, length-delimited fields are kept as bytes.
+struct Message {
+  std::map<int, std::vector<uint64_t>> varints;
+  std::map<int, std::vector<std::string>> bytes;
+};
+
+uint64_t ReadVarint(const std::string& data, size_t* pos) {
+  uint64_t value = 0;
+  for (int shift = 0; *pos < data.size(); shift += 7) {
+    uint8_t byte = data[(*pos)++];
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      break;
+  }
+  return value;
+}
+
+Message Decode(const std::string& data) {
+  Message message;
+  size_t pos = 0;
+  while (pos < data.size()) {
+    uint64_t key = ReadVarint(data, &pos);
+    int field_number = key >> 3;
+    if ((key & 7) == 0) {
+      message.varints[field_number].push_back(ReadVarint(data, &pos));
+    } else {
+      EXPECT_EQ(2u, key & 7);
+      size_t size = ReadVarint(data, &pos);
+      message.bytes[field_number].push_back(data.substr(pos, size));
+      pos += size;
+    }
+  }
+  EXPECT_EQ(data.size(), pos);
+  return message;
+}
+
+std::vector<uint64_t> DecodePacked(const std::string& data) {
+  std::vector<uint64_t> values;
+  size_t pos = 0;
+  while (pos < data.size())
+    values.push_back(ReadVarint(data, &pos));
+  return values;
+}
+
+// Returns the field |field_number| of |message|, or 0 if absent.
+uint64_t GetVarint(const Message& message, int field_number) {
+  auto it = message.varints.find(field_number);
+  return it == message.varints.end() ? 0 : it->second.back();
+}
+
+void Append(std::string* profile, int* num_chunks, StringPiece chunk) {
+  chunk.AppendToString(profile);
+  ++*num_chunks;
+}
+
+// The decoded tables of a profile.
+struct Profile {
+  explicit Profile(const std::string& data) {
+    Message profile = Decode(data);
+    strings = profile.bytes[6];
+    for (const std::string& sample_type : profile.bytes[1]) {
+      Message value_type = Decode(sample_type);
+      sample_types.push_back(strings[GetVarint(value_type, 1)] + "/" +
+                             strings[GetVarint(value_type, 2)]);
+    }
+    for (const std::string& mapping : profile.bytes[3])
+      mappings.push_back(Decode(mapping));
+    for (const std::string& location : profile.bytes[4]) {
+      Message message = Decode(location);
+      locations[GetVarint(message, 1)] = message;
+    }
+    for (const std::string& sample : profile.bytes[2]) {
+      Message message = Decode(sample);
+      std::vector<uintptr_t> stack;
+      for (uint64_t id : DecodePacked(message.bytes[1][0])) {
+        EXPECT_EQ(1u, locations.count(id));
+        stack.push_back(GetVarint(locations[id], 3));
+      }
+      stacks.push_back(stack);
+      values.push_back(DecodePacked(message.bytes[2][0]));
+    }
+    period = GetVarint(profile, 12);
+    duration_nanos = GetVarint(profile, 10);
+  }
+
+  std::vector<std::string> strings;
+  std::vector<std::string> sample_types;
+  std::vector<Message> mappings;
+  std::map<uint64_t, Message> locations;
+  // The addresses of the stacks and the values of the samples.
+  std::vector<std::vector<uintptr_t>> stacks;
+  std::vector<std::vector<uint64_t>> values;
+  uint64_t period;
+  uint64_t duration_nanos;
+};
+
+}  // namespace
+
+TEST(PprofWriterTest, Encode) {
+  std::string data;
+  int num_chunks = 0;
+  PprofWriter writer(BindRepeating(&Append, &data, &num_chunks));
+  writer.AddSampleType("samples", "count");
+  uint64_t mapping_id = writer.AddMapping(0x1000, 0x2000, 0, "lib.so", "id");
+  EXPECT_EQ(1u, mapping_id);
+  std::vector<uint64_t> stack = {writer.InternLocation(0x1010),
+                                 writer.InternLocation(0x1020)};
+  writer.AddSample(stack, {2});
+  // Locations are deduplicated.
+  EXPECT_EQ(stack[0], writer.InternLocation(0x1010));
+  stack = {writer.InternLocation(0x3000), stack[1]};
+  writer.AddSample(stack, {3});
+  writer.Finish();
+  EXPECT_EQ(1, num_chunks);
+
+  Profile profile(data);
+  ASSERT_FALSE(profile.strings.empty());
+  EXPECT_EQ("", profile.strings[0]);
+  EXPECT_EQ(std::vector<std::string>({"samples/count"}), profile.sample_types);
+
+  ASSERT_EQ(1u, profile.mappings.size());
+  const Message& mapping = profile.mappings[0];
+  EXPECT_EQ(0x1000u, GetVarint(mapping, 2));
+  EXPECT_EQ(0x2000u, GetVarint(mapping, 3));
+  EXPECT_EQ("lib.so", profile.strings[GetVarint(mapping, 5)]);
+  EXPECT_EQ("id", profile.strings[GetVarint(mapping, 6)]);
+
+  ASSERT_EQ(3u, profile.locations.size());
+  // Locations are mapped by address.
+  EXPECT_EQ(1u, GetVarint(profile.locations[stack[1]], 2));
+  EXPECT_EQ(0u, GetVarint(profile.locations[stack[0]], 2));
+
+  ASSERT_EQ(2u, profile.stacks.size());
+  EXPECT_EQ(std::vector<uintptr_t>({0x1010, 0x1020}), profile.stacks[0]);
+  EXPECT_EQ(std::vector<uintptr_t>({0x3000, 0x1020}), profile.stacks[1]);
+  EXPECT_EQ(std::vector<uint64_t>({2}), profile.values[0]);
+  EXPECT_EQ(std::vector<uint64_t>({3}), profile.values[1]);
+}
+
+TEST(PprofWriterTest, Streams) {
+  std::string data;
+  int num_chunks = 0;
+  PprofWriter writer(BindRepeating(&Append, &data, &num_chunks));
+  writer.AddSampleType("samples", "count");
+  const size_t kNumSamples = 10000;
+  for (size_t i = 0; i < kNumSamples; ++i) {
+    std::vector<uint64_t> stack = {writer.InternLocation(0x1000 + i),
+                                   writer.InternLocation(0x100)};
+    writer.AddSample(stack, {1});
+  }
+  writer.Finish();
+  // The profile is sent as it is written.
+  EXPECT_GT(num_chunks, 1);
+
+  Profile profile(data);
+  EXPECT_EQ(kNumSamples + 1, profile.locations.size());
+  ASSERT_EQ(kNumSamples, profile.stacks.size());
+  EXPECT_EQ(std::vector<uintptr_t>({0x1000 + kNumSamples - 1, 0x100}),
+            profile.stacks.back());
+}
+
+TEST(PprofWriterTest, CallStackProfile) {
+  using Frame = StackSamplingProfiler::Frame;
+  StackSamplingProfiler::CallStackProfile call_stack_profile;
+  call_stack_profile.modules.emplace_back(
+      0x1000, "id", FilePath(FILE_PATH_LITERAL("lib.so")));
+  call_stack_profile.samples.emplace_back(std::vector<Frame>(
+      {Frame(0x1010, 0), Frame(0x1020, 0),
+       Frame(0x5000, Frame::kUnknownModuleIndex)}));
+  call_stack_profile.sampling_period = TimeDelta::FromMilliseconds(10);
+  call_stack_profile.profile_duration = TimeDelta::FromSeconds(1);
+
+  std::string data;
+  int num_chunks = 0;
+  WriteCallStackProfileAsPprof(call_stack_profile,
+                               BindRepeating(&Append, &data, &num_chunks));
+
+  Profile profile(data);
+  EXPECT_EQ(std::vector<std::string>({"samples/count", "cpu/nanoseconds"}),
+            profile.sample_types);
+  EXPECT_EQ(10000000u, profile.period);
+  EXPECT_EQ(1000000000u, profile.duration_nanos);
+
+  ASSERT_EQ(1u, profile.mappings.size());
+  EXPECT_EQ(0x1000u, GetVarint(profile.mappings[0], 2));
+  EXPECT_EQ(0x1021u, GetVarint(profile.mappings[0], 3));
+
+  ASSERT_EQ(1u, profile.stacks.size());
+  // The return addresses point within the calls.
+  EXPECT_EQ(std::vector<uintptr_t>({0x1010, 0x101f, 0x4fff}),
+            profile.stacks[0]);
+  EXPECT_EQ(std::vector<uint64_t>({1, 10000000}), profile.values[0]);
+}
+
+#if defined(OS_LINUX)
+TEST(PprofWriterTest, MappingsFromProcMaps) {
+  std::string data;
+  int num_chunks = 0;
+  PprofWriter writer(BindRepeating(&Append, &data, &num_chunks));
+  writer.AddMappingsFromProcMaps();
+  uintptr_t address = reinterpret_cast<uintptr_t>(&Decode);
+  writer.InternLocation(address);
+  writer.Finish();
+
+  Profile profile(data);
+  ASSERT_EQ(1u, profile.locations.size());
+  uint64_t mapping_id = GetVarint(profile.locations.begin()->second, 2);
+  ASSERT_NE(0u, mapping_id);
+  const Message& mapping = profile.mappings[mapping_id - 1];
+  EXPECT_EQ(mapping_id, GetVarint(mapping, 1));
+  EXPECT_LE(GetVarint(mapping, 2), address);
+  EXPECT_GT(GetVarint(mapping, 3), address);
+  EXPECT_FALSE(profile.strings[GetVarint(mapping, 5)].empty());
+}
+#endif  // defined(OS_LINUX)
+
+}  // namespace base
@@ -0,0 +1,87 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/profiler/stack_sample_store.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace base {
+
+const size_t StackSampleStore::kInvalidIndex;
+
+StackSampleStore::StackSampleStore() = default;
+
+StackSampleStore::~StackSampleStore() = default;
+
+void StackSampleStore::AddProfile(
+    const StackSamplingProfiler::CallStackProfile& profile) {
+  std::vector<size_t> module_indices;
+  module_indices.reserve(profile.modules.size());
+  for (const StackSamplingProfiler::Module& module : profile.modules)
+    module_indices.push_back(InternModule(module));
+
+  for (const StackSamplingProfiler::Sample& sample : profile.samples) {
+    size_t stack_index = InsertStack(sample, module_indices);
+    auto result = sample_count_indices_.try_emplace(
+        std::make_pair(stack_index, sample.process_milestones),
+        sample_counts_.size());
+    if (result.second)
+      sample_counts_.push_back({stack_index, sample.process_milestones, 0});
+    ++sample_counts_[result.first->second].count;
+    ++num_samples_;
+  }
+}
+
+std::vector<StackSamplingProfiler::Frame> StackSampleStore::GetStack(
+    size_t stack_index) const {
+  std::vector<StackSamplingProfiler::Frame> stack;
+  for (size_t node_index = stack_index; node_index != kInvalidIndex;
+       node_index = nodes_[node_index].parent_index) {
+    stack.push_back(frames_[nodes_[node_index].frame_index]);
+  }
+  return stack;
+}
+
+size_t StackSampleStore::InternModule(
+    const StackSamplingProfiler::Module& module) {
+  // There are few modules, and they are only interned once per profile.
+  auto it = std::find(modules_.begin(), modules_.end(), module);
+  if (it != modules_.end())
+    return it - modules_.begin();
+  modules_.push_back(module);
+  return modules_.size() - 1;
+}
+
+size_t StackSampleStore::InsertStack(
+    const StackSamplingProfiler::Sample& sample,
+    const std::vector<size_t>& module_indices) {
+  // Walks down the trie from the outermost frame.
+  size_t node_index = kInvalidIndex;
+  for (auto it = sample.frames.rbegin(); it != sample.frames.rend(); ++it) {
+    size_t module_index = it->module_index;
+    if (module_index != StackSamplingProfiler::Frame::kUnknownModuleIndex) {
+      DCHECK_LT(module_index, module_indices.size());
+      module_index = module_indices[module_index];
+    }
+
+    auto frame =
+        frame_indices_.try_emplace(std::make_pair(it->instruction_pointer,
+                                                  module_index),
+                                   frames_.size());
+    if (frame.second)
+      frames_.emplace_back(it->instruction_pointer, module_index);
+    size_t frame_index = frame.first->second;
+
+    auto node = node_indices_.try_emplace(IndexPair(node_index, frame_index),
+                                          nodes_.size());
+    if (node.second)
+      nodes_.push_back({frame_index, node_index});
+    node_index = node.first->second;
+  }
+  return node_index;
+}
+
+}  // namespace base
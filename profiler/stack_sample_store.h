@@ -0,0 +1,134 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PROFILER_STACK_SAMPLE_STORE_H_
+#define BASE_PROFILER_STACK_SAMPLE_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/containers/flat_hash_map.h"
+#include "base/hash.h"
+#include "base/macros.h"
+#include "base/profiler/stack_sampling_profiler.h"
+
+namespace base {
+
+// Accumulates the samples of CallStackProfiles in bounded memory, for
+// collections spanning many profiles. Each distinct stack is stored once, and
+// the samples are reduced to a count per distinct stack and process
+// milestones.
+//
+// The modules and frames are interned in tables, and the stacks are stored as
+// a trie of frames rooted at their outermost frames, so stacks which share
+// callers share nodes. A stack is identified by the index of the node of its
+// innermost frame.
+//
+// The tables are only ever appended to, and only the counts of existing
+// entries of sample_counts() change, so a reader can read the store
+// incrementally by remembering the sizes of the tables it has seen.
+//
+// Example:
+//   StackSampleStore store;
+//   for (const CallStackProfile& profile : profiles)
+//     store.AddProfile(profile);
+//   for (const StackSampleStore::SampleCount& entry : store.sample_counts())
+//     Report(store.GetStack(entry.stack_index), entry.count);
+//
+// The store is not thread safe.
+class BASE_EXPORT StackSampleStore {
+ public:
+  // Identifies a missing parent node, or the empty stack.
+  static const size_t kInvalidIndex = static_cast<size_t>(-1);
+
+  // A node of the trie of stacks.
+  struct Node {
+    // Index of the frame of the node in frames().
+    size_t frame_index;
+
+    // Index of the node of the caller in nodes(), or kInvalidIndex for an
+    // outermost frame.
+    size_t parent_index;
+  };
+
+  // The number of samples of a stack taken with the same process milestones.
+  struct SampleCount {
+    // Index of the node of the innermost frame of the stack in nodes(), or
+    // kInvalidIndex for samples without frames.
+    size_t stack_index;
+
+    uint32_t process_milestones;
+
+    size_t count;
+  };
+
+  StackSampleStore();
+  ~StackSampleStore();
+
+  // Adds the samples of |profile|.
+  void AddProfile(const StackSamplingProfiler::CallStackProfile& profile);
+
+  // Returns the frames of the stack identified by |stack_index|, innermost
+  // first as in StackSamplingProfiler::Sample.
+  std::vector<StackSamplingProfiler::Frame> GetStack(size_t stack_index) const;
+
+  // The distinct modules of the added profiles.
+  const std::vector<StackSamplingProfiler::Module>& modules() const {
+    return modules_;
+  }
+
+  // The distinct frames of the added profiles. Their module indices are
+  // indices in modules().
+  const std::vector<StackSamplingProfiler::Frame>& frames() const {
+    return frames_;
+  }
+
+  const std::vector<Node>& nodes() const { return nodes_; }
+
+  const std::vector<SampleCount>& sample_counts() const {
+    return sample_counts_;
+  }
+
+  // Returns the total number of samples added.
+  size_t num_samples() const { return num_samples_; }
+
+ private:
+  using IndexPair = std::pair<size_t, size_t>;
+
+  // Returns the index of |module| in |modules_|, adding it if needed.
+  size_t InternModule(const StackSamplingProfiler::Module& module);
+
+  // Returns the index in |nodes_| of the innermost frame of |sample|, adding
+  // the nodes which are missing.
+  size_t InsertStack(const StackSamplingProfiler::Sample& sample,
+                     const std::vector<size_t>& module_indices);
+
+  std::vector<StackSamplingProfiler::Module> modules_;
+  std::vector<StackSamplingProfiler::Frame> frames_;
+  std::vector<Node> nodes_;
+  std::vector<SampleCount> sample_counts_;
+  size_t num_samples_ = 0;
+
+  // Map the keys of the entries of the tables above to their indices.
+  flat_hash_map<std::pair<uintptr_t, size_t>,
+                size_t,
+                IntPairHash<std::pair<uintptr_t, size_t>>>
+      frame_indices_;
+  // Keyed by the parent node index and frame index.
+  flat_hash_map<IndexPair, size_t, IntPairHash<IndexPair>> node_indices_;
+  flat_hash_map<std::pair<size_t, uint32_t>,
+                size_t,
+                IntPairHash<std::pair<size_t, uint32_t>>>
+      sample_count_indices_;
+
+  DISALLOW_COPY_AND_ASSIGN(StackSampleStore);
+};
+
+}  // namespace base
+
+#endif  // BASE_PROFILER_STACK_SAMPLE_STORE_H_
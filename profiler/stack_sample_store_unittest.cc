@@ -0,0 +1,99 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/profiler/stack_sample_store.h"
+
+#include <utility>
+
+#include "base/files/file_path.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+using Frame = StackSamplingProfiler::Frame;
+using Frames = std::vector<StackSamplingProfiler::Frame>;
+using Module = StackSamplingProfiler::Module;
+using Sample = StackSamplingProfiler::Sample;
+using CallStackProfile = StackSamplingProfiler::CallStackProfile;
+
+namespace {
+
+CallStackProfile MakeProfile(std::vector<Module> modules,
+                             std::vector<Sample> samples) {
+  CallStackProfile profile;
+  profile.modules = std::move(modules);
+  profile.samples = std::move(samples);
+  return profile;
+}
+
+}  // namespace
+
+TEST(StackSampleStoreTest, DeduplicatesStacks) {
+  Module module_a(0x1000, "a", FilePath(FILE_PATH_LITERAL("a")));
+  // Inner frames first.
+  Frames stack1 = {Frame(0x1010, 0), Frame(0x1020, 0), Frame(0x1030, 0)};
+  Frames stack2 = {Frame(0x1040, 0), Frame(0x1020, 0), Frame(0x1030, 0)};
+
+  StackSampleStore store;
+  store.AddProfile(MakeProfile(
+      {module_a}, {Sample(stack1), Sample(stack2), Sample(stack1)}));
+
+  EXPECT_EQ(3u, store.num_samples());
+  ASSERT_EQ(1u, store.modules().size());
+  EXPECT_EQ(4u, store.frames().size());
+  // The two stacks share their two outer frames.
+  EXPECT_EQ(4u, store.nodes().size());
+
+  ASSERT_EQ(2u, store.sample_counts().size());
+  EXPECT_EQ(2u, store.sample_counts()[0].count);
+  EXPECT_EQ(stack1, store.GetStack(store.sample_counts()[0].stack_index));
+  EXPECT_EQ(1u, store.sample_counts()[1].count);
+  EXPECT_EQ(stack2, store.GetStack(store.sample_counts()[1].stack_index));
+}
+
+TEST(StackSampleStoreTest, MergesModulesAcrossProfiles) {
+  Module module_a(0x1000, "a", FilePath(FILE_PATH_LITERAL("a")));
+  Module module_b(0x2000, "b", FilePath(FILE_PATH_LITERAL("b")));
+
+  StackSampleStore store;
+  store.AddProfile(
+      MakeProfile({module_a, module_b}, {Sample(Frame(0x2010, 1))}));
+  // The same frame, with the modules listed in another order.
+  store.AddProfile(
+      MakeProfile({module_b, module_a}, {Sample(Frame(0x2010, 0))}));
+  // The same stack with other milestones.
+  Sample sample(Frame(0x2010, 0));
+  sample.process_milestones = 1;
+  store.AddProfile(MakeProfile({module_b}, {sample}));
+
+  EXPECT_EQ(3u, store.num_samples());
+  EXPECT_EQ(2u, store.modules().size());
+  EXPECT_EQ(1u, store.frames().size());
+  ASSERT_EQ(2u, store.sample_counts().size());
+  EXPECT_EQ(2u, store.sample_counts()[0].count);
+  EXPECT_EQ(0u, store.sample_counts()[0].process_milestones);
+  EXPECT_EQ(1u, store.sample_counts()[1].count);
+  EXPECT_EQ(1u, store.sample_counts()[1].process_milestones);
+  EXPECT_EQ(store.sample_counts()[0].stack_index,
+            store.sample_counts()[1].stack_index);
+
+  Frames stack = store.GetStack(store.sample_counts()[0].stack_index);
+  ASSERT_EQ(1u, stack.size());
+  EXPECT_EQ(module_b, store.modules()[stack[0].module_index]);
+}
+
+TEST(StackSampleStoreTest, EmptyAndUnknownFrames) {
+  StackSampleStore store;
+  store.AddProfile(MakeProfile(
+      {}, {Sample(), Sample(Frame(0x10, Frame::kUnknownModuleIndex))}));
+
+  ASSERT_EQ(2u, store.sample_counts().size());
+  EXPECT_EQ(StackSampleStore::kInvalidIndex,
+            store.sample_counts()[0].stack_index);
+  EXPECT_TRUE(store.GetStack(StackSampleStore::kInvalidIndex).empty());
+  EXPECT_EQ(Frames({Frame(0x10, Frame::kUnknownModuleIndex)}),
+            store.GetStack(store.sample_counts()[1].stack_index));
+}
+
+}  // namespace base
@@ -41,8 +41,10 @@
 #endif
 
 // STACK_SAMPLING_PROFILER_SUPPORTED is used to conditionally enable the tests
-// below for supported platforms (currently Win x64 and Mac x64).
-#if defined(_WIN64) || (defined(OS_MACOSX) && !defined(OS_IOS))
+// below for supported platforms (currently Win x64, Mac x64, and Linux x64 and
+// arm64).
+#if defined(_WIN64) || (defined(OS_MACOSX) && !defined(OS_IOS)) || \
+    (defined(OS_LINUX) && (defined(ARCH_CPU_X86_64) || defined(ARCH_CPU_ARM64)))
 #define STACK_SAMPLING_PROFILER_SUPPORTED 1
 #endif
 
@@ -316,8 +318,8 @@ void SynchronousUnloadNativeLibrary(NativeLibrary library) {
          ::GetLastError() != ERROR_MOD_NOT_FOUND) {
     PlatformThread::Sleep(TimeDelta::FromMilliseconds(1));
   }
-#elif defined(OS_MACOSX)
-// Unloading a library on the Mac is synchronous.
+#elif defined(OS_MACOSX) || defined(OS_LINUX)
+// Unloading a library on the Mac and Linux is synchronous.
 #else
   NOTIMPLEMENTED();
 #endif
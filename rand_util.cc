@@ -11,11 +11,20 @@
 #include <algorithm>
 #include <limits>
 
+#include "base/compiler_specific.h"
 #include "base/logging.h"
 #include "base/strings/string_util.h"
 
 namespace base {
 
+namespace {
+
+inline uint64_t RotateLeft(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+}  // namespace
+
 uint64_t RandUint64() {
   uint64_t number;
   RandBytes(&number, sizeof(number));
@@ -79,4 +88,40 @@ std::string RandBytesAsString(size_t length) {
   return result;
 }
 
+void InsecureRandomGenerator::ReseedForTesting(uint64_t seed) {
+  Seed(seed);
+}
+
+uint64_t InsecureRandomGenerator::RandUint64() {
+  if (UNLIKELY((state_[0] | state_[1] | state_[2] | state_[3]) == 0))
+    Seed(base::RandUint64());
+
+  // xoshiro256**, see http://xoshiro.di.unimi.it/.
+  const uint64_t result = RotateLeft(state_[1] * 5, 7) * 9;
+  const uint64_t shifted = state_[1] << 17;
+  state_[2] ^= state_[0];
+  state_[3] ^= state_[1];
+  state_[1] ^= state_[2];
+  state_[0] ^= state_[3];
+  state_[2] ^= shifted;
+  state_[3] = RotateLeft(state_[3], 45);
+  return result;
+}
+
+double InsecureRandomGenerator::RandDouble() {
+  return BitsToOpenEndedUnitInterval(RandUint64());
+}
+
+void InsecureRandomGenerator::Seed(uint64_t seed) {
+  // Expands the seed with splitmix64, as recommended for xoshiro, which never
+  // yields an all zero state.
+  for (uint64_t& word : state_) {
+    seed += UINT64_C(0x9E3779B97F4A7C15);
+    uint64_t mixed = seed;
+    mixed = (mixed ^ (mixed >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    mixed = (mixed ^ (mixed >> 27)) * UINT64_C(0x94D049BB133111EB);
+    word = mixed ^ (mixed >> 31);
+  }
+}
+
 }  // namespace base
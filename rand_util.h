@@ -57,6 +57,46 @@ BASE_EXPORT std::string RandBytesAsString(size_t length);
 BASE_EXPORT int GetUrandomFD();
 #endif
 
+#if defined(OS_LINUX)
+namespace internal {
+
+// Makes RandBytes() reseed its per-thread generators from the kernel. Must be
+// called in the child of a fork which bypasses pthread_atfork() handlers, like
+// a raw clone(), so that the child doesn't repeat the parent's output.
+BASE_EXPORT void ReseedRandBytesAfterFork();
+
+}  // namespace internal
+#endif
+
+// A fast pseudo-random number generator (xoshiro256**), for uses which need
+// statistically good random numbers but no security, like sampling decisions
+// or jitter. Its output is NOT cryptographically secure: it can be predicted
+// from a few previous outputs. Use the functions above for anything an
+// attacker shouldn't guess.
+//
+// Not thread-safe: use one instance per thread. The constructor is constexpr
+// and the generator seeds itself from RandBytes() on first use, so it can be a
+// global or a thread_local without a static initializer.
+class BASE_EXPORT InsecureRandomGenerator {
+ public:
+  constexpr InsecureRandomGenerator() = default;
+
+  // Makes the generator output a fixed sequence, which depends on |seed|.
+  void ReseedForTesting(uint64_t seed);
+
+  // Returns a random number in range [0, UINT64_MAX].
+  uint64_t RandUint64();
+
+  // Returns a random double in range [0, 1).
+  double RandDouble();
+
+ private:
+  void Seed(uint64_t seed);
+
+  // All zero until seeded, which xoshiro256** never reaches once seeded.
+  uint64_t state_[4] = {};
+};
+
 }  // namespace base
 
 #endif  // BASE_RAND_UTIL_H_
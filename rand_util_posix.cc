@@ -8,12 +8,27 @@
 #include <fcntl.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+
+#include "base/compiler_specific.h"
 #include "base/files/file_util.h"
 #include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/macros.h"
 #include "base/posix/eintr_wrapper.h"
+#include "build/build_config.h"
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <sys/syscall.h>
+#endif
+
+#if defined(OS_LINUX)
+#include <pthread.h>
+#endif
 
 namespace {
 
@@ -45,19 +60,195 @@ class URandomFd {
 
 base::LazyInstance<URandomFd>::Leaky g_urandom_fd = LAZY_INSTANCE_INITIALIZER;
 
-}  // namespace
+#if (defined(OS_LINUX) || defined(OS_ANDROID)) && defined(SYS_getrandom)
+// Set once getrandom() failed because the kernel predates it (Linux 3.17), or
+// a seccomp sandbox denies it.
+std::atomic<bool> g_getrandom_unavailable{false};
 
-namespace base {
+// Fills |output| with getrandom(), which needs no file descriptor. Returns
+// false if the syscall is unavailable.
+bool GetRandomSyscall(void* output, size_t output_length) {
+  if (g_getrandom_unavailable.load(std::memory_order_relaxed))
+    return false;
+  char* out = static_cast<char*>(output);
+  while (output_length > 0) {
+    const ssize_t result =
+        HANDLE_EINTR(syscall(SYS_getrandom, out, output_length, 0));
+    if (result < 0) {
+      DPCHECK(errno == ENOSYS || errno == EPERM);
+      g_getrandom_unavailable.store(true, std::memory_order_relaxed);
+      return false;
+    }
+    out += result;
+    output_length -= result;
+  }
+  return true;
+}
+#endif  // (defined(OS_LINUX) || defined(OS_ANDROID)) && defined(SYS_getrandom)
 
-void RandBytes(void* output, size_t output_length) {
+// Fills |output| with random bytes from the kernel.
+void RandBytesFromKernel(void* output, size_t output_length) {
+#if (defined(OS_LINUX) || defined(OS_ANDROID)) && defined(SYS_getrandom)
+  if (GetRandomSyscall(output, output_length))
+    return;
+#endif
   const int urandom_fd = g_urandom_fd.Pointer()->fd();
   const bool success =
-      ReadFromFD(urandom_fd, static_cast<char*>(output), output_length);
+      base::ReadFromFD(urandom_fd, static_cast<char*>(output), output_length);
   CHECK(success);
 }
 
+#if defined(OS_LINUX)
+// Small requests, like those of RandUint64() and GenerateGUID(), are served
+// from a per-thread ChaCha20 generator seeded from the kernel, rather than
+// with a syscall each.
+//
+// The generator uses "fast key erasure": each refill of the buffer generates
+// the next key along with the output, and the output is wiped as it is
+// returned, so that the memory of a thread never reveals the bytes it already
+// returned. It reseeds from the kernel periodically, and after a fork, so that
+// the child and the parent never share output.
+
+constexpr size_t kChaChaBlockSize = 64;
+constexpr size_t kChaChaKeySize = 32;
+constexpr size_t kBufferSize = 8 * kChaChaBlockSize;
+// Larger requests go straight to the kernel, which is then about as fast.
+constexpr size_t kMaxBufferedRequest = 256;
+// About 1 MiB of output between reseeds.
+constexpr uint32_t kRefillsPerReseed = 2048;
+
+struct ThreadRng {
+  uint32_t key[kChaChaKeySize / sizeof(uint32_t)];
+  uint8_t buffer[kBufferSize];
+  // The number of bytes left to return, at the end of |buffer|.
+  size_t available;
+  uint32_t refills_until_reseed;
+  // The value of |g_fork_generation| when the generator was seeded, or 0.
+  uint32_t fork_generation;
+};
+
+// Incremented in the child of each fork, starts from 1 so that the zero
+// initialized generators are reseeded.
+std::atomic<uint32_t> g_fork_generation{1};
+
+// Zero initialized, so there is no constructor to run on each thread. Unlike
+// the other hot thread locals of base, this isn't initial-exec: it would take
+// a large part of the static TLS surplus when base is dlopen()ed.
+thread_local ThreadRng g_thread_rng;
+
+void OnFork() {
+  g_fork_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline uint32_t RotateLeft(uint32_t value, int bits) {
+  return (value << bits) | (value >> (32 - bits));
+}
+
+inline void QuarterRound(uint32_t* x, int a, int b, int c, int d) {
+  x[a] += x[b];
+  x[d] = RotateLeft(x[d] ^ x[a], 16);
+  x[c] += x[d];
+  x[b] = RotateLeft(x[b] ^ x[c], 12);
+  x[a] += x[b];
+  x[d] = RotateLeft(x[d] ^ x[a], 8);
+  x[c] += x[d];
+  x[b] = RotateLeft(x[b] ^ x[c], 7);
+}
+
+// Writes the ChaCha20 block |counter| of |key| (RFC 7539), with a zero nonce.
+void ChaCha20Block(const uint32_t* key, uint32_t counter, uint8_t* output) {
+  uint32_t input[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+  memcpy(&input[4], key, kChaChaKeySize);
+  input[12] = counter;
+
+  uint32_t x[16];
+  memcpy(x, input, sizeof(x));
+  for (int i = 0; i < 10; ++i) {
+    QuarterRound(x, 0, 4, 8, 12);
+    QuarterRound(x, 1, 5, 9, 13);
+    QuarterRound(x, 2, 6, 10, 14);
+    QuarterRound(x, 3, 7, 11, 15);
+    QuarterRound(x, 0, 5, 10, 15);
+    QuarterRound(x, 1, 6, 11, 12);
+    QuarterRound(x, 2, 7, 8, 13);
+    QuarterRound(x, 3, 4, 9, 14);
+  }
+  for (int i = 0; i < 16; ++i) {
+    const uint32_t word = x[i] + input[i];
+    output[4 * i] = static_cast<uint8_t>(word);
+    output[4 * i + 1] = static_cast<uint8_t>(word >> 8);
+    output[4 * i + 2] = static_cast<uint8_t>(word >> 16);
+    output[4 * i + 3] = static_cast<uint8_t>(word >> 24);
+  }
+}
+
+void Refill(ThreadRng* rng, uint32_t fork_generation) {
+  if (rng->fork_generation != fork_generation ||
+      rng->refills_until_reseed == 0) {
+    static const int at_fork_registered =
+        pthread_atfork(nullptr, nullptr, &OnFork);
+    ALLOW_UNUSED_LOCAL(at_fork_registered);
+    RandBytesFromKernel(rng->key, sizeof(rng->key));
+    rng->fork_generation = fork_generation;
+    rng->refills_until_reseed = kRefillsPerReseed;
+  }
+  --rng->refills_until_reseed;
+
+  for (size_t i = 0; i < kBufferSize / kChaChaBlockSize; ++i)
+    ChaCha20Block(rng->key, i, rng->buffer + i * kChaChaBlockSize);
+  memcpy(rng->key, rng->buffer, kChaChaKeySize);
+  memset(rng->buffer, 0, kChaChaKeySize);
+  rng->available = kBufferSize - kChaChaKeySize;
+}
+
+void RandBytesFromThreadRng(void* output, size_t output_length) {
+  ThreadRng* rng = &g_thread_rng;
+  const uint32_t fork_generation =
+      g_fork_generation.load(std::memory_order_relaxed);
+  if (UNLIKELY(rng->fork_generation != fork_generation))
+    rng->available = 0;
+
+  uint8_t* out = static_cast<uint8_t*>(output);
+  while (output_length > 0) {
+    if (rng->available == 0)
+      Refill(rng, fork_generation);
+    const size_t length = std::min(output_length, rng->available);
+    uint8_t* bytes = rng->buffer + kBufferSize - rng->available;
+    memcpy(out, bytes, length);
+    memset(bytes, 0, length);
+    rng->available -= length;
+    out += length;
+    output_length -= length;
+  }
+}
+#endif  // defined(OS_LINUX)
+
+}  // namespace
+
+namespace base {
+
+void RandBytes(void* output, size_t output_length) {
+#if defined(OS_LINUX)
+  if (output_length <= kMaxBufferedRequest) {
+    RandBytesFromThreadRng(output, output_length);
+    return;
+  }
+#endif
+  RandBytesFromKernel(output, output_length);
+}
+
 int GetUrandomFD(void) {
   return g_urandom_fd.Pointer()->fd();
 }
 
+#if defined(OS_LINUX)
+namespace internal {
+
+void ReseedRandBytesAfterFork() {
+  OnFork();
+}
+
+}  // namespace internal
+#endif
+
 }  // namespace base
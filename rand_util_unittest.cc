@@ -13,8 +13,16 @@
 
 #include "base/logging.h"
 #include "base/time/time.h"
+#include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+#if defined(OS_POSIX) && !defined(OS_FUCHSIA) && !defined(OS_NACL)
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "base/posix/eintr_wrapper.h"
+#endif
+
 namespace {
 
 const int kIntMin = std::numeric_limits<int>::min();
@@ -150,6 +158,62 @@ TEST(RandUtilTest, RandBytesLonger) {
   EXPECT_EQ(4097u, random_string2.size());
 }
 
+#if defined(OS_POSIX) && !defined(OS_FUCHSIA) && !defined(OS_NACL)
+TEST(RandUtilTest, ForkedChildDoesNotRepeatParent) {
+  // Makes sure the parent has buffered output, if it buffers any.
+  base::RandUint64();
+
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  const pid_t pid = fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    uint64_t value = base::RandUint64();
+    ssize_t written = HANDLE_EINTR(write(fds[1], &value, sizeof(value)));
+    _exit(written == sizeof(value) ? 0 : 1);
+  }
+  close(fds[1]);
+  uint64_t child_value;
+  EXPECT_EQ(static_cast<ssize_t>(sizeof(child_value)),
+            HANDLE_EINTR(read(fds[0], &child_value, sizeof(child_value))));
+  close(fds[0]);
+  int status;
+  ASSERT_EQ(pid, HANDLE_EINTR(waitpid(pid, &status, 0)));
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+  EXPECT_NE(base::RandUint64(), child_value);
+}
+#endif
+
+TEST(RandUtilTest, InsecureRandomGenerator) {
+  base::InsecureRandomGenerator generator;
+  uint64_t found_ones = 0;
+  uint64_t found_zeros = ~found_ones;
+  for (size_t i = 0; i < 1000; ++i) {
+    uint64_t value = generator.RandUint64();
+    found_ones |= value;
+    found_zeros &= value;
+    volatile double number = generator.RandDouble();
+    EXPECT_GT(1.0, number);
+    EXPECT_LE(0.0, number);
+  }
+  EXPECT_EQ(~UINT64_C(0), found_ones);
+  EXPECT_EQ(0u, found_zeros);
+}
+
+TEST(RandUtilTest, InsecureRandomGeneratorReseedForTesting) {
+  base::InsecureRandomGenerator generator1;
+  base::InsecureRandomGenerator generator2;
+  generator1.ReseedForTesting(42);
+  generator2.ReseedForTesting(42);
+  for (size_t i = 0; i < 10; ++i)
+    EXPECT_EQ(generator1.RandUint64(), generator2.RandUint64());
+
+  // A zero seed still gives a working generator.
+  generator1.ReseedForTesting(0);
+  EXPECT_NE(generator1.RandUint64(), generator1.RandUint64());
+}
+
 // Benchmark test for RandBytes().  Disabled since it's intentionally slow and
 // does not test anything that isn't already tested by the existing RandBytes()
 // tests.
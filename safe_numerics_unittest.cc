@@ -7,6 +7,7 @@
 
 #include <limits>
 #include <type_traits>
+#include <vector>
 
 #include "base/compiler_specific.h"
 
@@ -26,6 +27,7 @@
 #endif
 
 #include "base/logging.h"
+#include "base/macros.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/numerics/safe_math.h"
 #include "base/test/gtest_util.h"
@@ -1632,6 +1634,82 @@ TEST(SafeNumerics, VariadicNumericOperations) {
   }
 }
 
+template <typename T>
+void TestClampAddElements() {
+  using Limits = std::numeric_limits<T>;
+  const T half_max = Limits::max() / 2;
+  T dst[] = {1, Limits::max(), half_max, 0, Limits::lowest(),
+             static_cast<T>(-1)};
+  const T src[] = {2, 1, static_cast<T>(half_max + 2), Limits::max(),
+                   static_cast<T>(-1), Limits::lowest()};
+  T expected[arraysize(dst)];
+  for (size_t i = 0; i < arraysize(dst); ++i)
+    expected[i] = ClampAdd(dst[i], src[i]);
+
+  ClampAddElements(dst, src, arraysize(dst));
+  for (size_t i = 0; i < arraysize(dst); ++i)
+    EXPECT_EQ(expected[i], dst[i]) << "i: " << i;
+}
+
+TEST(SafeNumerics, ClampAddElements) {
+  TestClampAddElements<int8_t>();
+  TestClampAddElements<uint8_t>();
+  TestClampAddElements<int16_t>();
+  TestClampAddElements<uint16_t>();
+  TestClampAddElements<int32_t>();
+  TestClampAddElements<uint32_t>();
+  TestClampAddElements<int64_t>();
+  TestClampAddElements<uint64_t>();
+
+  int32_t dst[3] = {std::numeric_limits<int32_t>::max() - 1, -5,
+                    std::numeric_limits<int32_t>::lowest() + 1};
+  const int32_t src[3] = {5, 3, -5};
+  ClampAddElements(dst, src, 3);
+  EXPECT_EQ(std::numeric_limits<int32_t>::max(), dst[0]);
+  EXPECT_EQ(-2, dst[1]);
+  EXPECT_EQ(std::numeric_limits<int32_t>::lowest(), dst[2]);
+}
+
+template <typename T>
+void TestCheckedSum() {
+  using Limits = std::numeric_limits<T>;
+  EXPECT_EQ(static_cast<T>(0), CheckedSum<T>(nullptr, 0).ValueOrDie());
+
+  // Enough values for several batches.
+  std::vector<T> values(5000, 1);
+  EXPECT_EQ(static_cast<T>(5000),
+            CheckedSum(values.data(), values.size()).ValueOrDie());
+
+  values.back() = Limits::max();
+  EXPECT_FALSE(CheckedSum(values.data(), values.size()).IsValid());
+
+  values.assign(2, Limits::max());
+  EXPECT_FALSE(CheckedSum(values.data(), values.size()).IsValid());
+
+  values.assign({Limits::max(), 0});
+  EXPECT_EQ(Limits::max(),
+            CheckedSum(values.data(), values.size()).ValueOrDie());
+}
+
+TEST(SafeNumerics, CheckedSum) {
+  TestCheckedSum<int16_t>();
+  TestCheckedSum<uint16_t>();
+  TestCheckedSum<int32_t>();
+  TestCheckedSum<uint32_t>();
+  TestCheckedSum<int64_t>();
+  TestCheckedSum<uint64_t>();
+
+  // Within a batch, narrow sums are only checked once they are complete.
+  const int32_t int32_max = std::numeric_limits<int32_t>::max();
+  const int32_t values[] = {int32_max, int32_max, -int32_max};
+  EXPECT_EQ(int32_max, CheckedSum(values, arraysize(values)).ValueOrDie());
+
+  // 64-bit ones can't be, since there's no wider type to add them up in.
+  const int64_t int64_max = std::numeric_limits<int64_t>::max();
+  const int64_t values64[] = {int64_max, int64_max, -int64_max};
+  EXPECT_FALSE(CheckedSum(values64, arraysize(values64)).IsValid());
+}
+
 #if defined(__clang__)
 #pragma clang diagnostic pop  // -Winteger-overflow
 #endif
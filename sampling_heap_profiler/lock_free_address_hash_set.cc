@@ -0,0 +1,66 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/sampling_heap_profiler/lock_free_address_hash_set.h"
+
+namespace base {
+
+LockFreeAddressHashSet::Node::Node(void* key, Node* next) : next(next) {
+  this->key.store(key, std::memory_order_relaxed);
+}
+
+LockFreeAddressHashSet::LockFreeAddressHashSet(size_t buckets_count)
+    : buckets_(buckets_count), bucket_mask_(buckets_count - 1) {
+  DCHECK(buckets_count && !(buckets_count & bucket_mask_));
+}
+
+LockFreeAddressHashSet::~LockFreeAddressHashSet() {
+  for (std::atomic<Node*>& bucket : buckets_) {
+    Node* node = bucket.load(std::memory_order_relaxed);
+    while (node) {
+      Node* next = node->next;
+      delete node;
+      node = next;
+    }
+  }
+}
+
+void LockFreeAddressHashSet::Insert(void* key) {
+  DCHECK(key);
+  DCHECK(!Contains(key));
+  ++size_;
+  std::atomic<Node*>& bucket = buckets_[Hash(key) & bucket_mask_];
+  Node* head = bucket.load(std::memory_order_relaxed);
+  // Reuses a free node of the bucket, if there is one.
+  for (Node* node = head; node; node = node->next) {
+    if (!node->key.load(std::memory_order_relaxed)) {
+      node->key.store(key, std::memory_order_relaxed);
+      return;
+    }
+  }
+  // The node is fully constructed before it is published.
+  bucket.store(new Node(key, head), std::memory_order_release);
+}
+
+void LockFreeAddressHashSet::Remove(void* key) {
+  Node* node = FindNode(key);
+  DCHECK(node);
+  // The node stays in the bucket, for concurrent readers walking it.
+  node->key.store(nullptr, std::memory_order_relaxed);
+  --size_;
+}
+
+void LockFreeAddressHashSet::Copy(const LockFreeAddressHashSet& other) {
+  DCHECK_EQ(0u, size_);
+  for (const std::atomic<Node*>& bucket : other.buckets_) {
+    for (Node* node = bucket.load(std::memory_order_relaxed); node;
+         node = node->next) {
+      void* key = node->key.load(std::memory_order_relaxed);
+      if (key)
+        Insert(key);
+    }
+  }
+}
+
+}  // namespace base
@@ -0,0 +1,107 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_SAMPLING_HEAP_PROFILER_LOCK_FREE_ADDRESS_HASH_SET_H_
+#define BASE_SAMPLING_HEAP_PROFILER_LOCK_FREE_ADDRESS_HASH_SET_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/macros.h"
+
+namespace base {
+
+// A hash set of addresses, used by SamplingHeapProfiler to tell whether a
+// freed address was sampled without taking a lock.
+//
+// Contains() can be called concurrently with any operation. Insert(), Remove()
+// and Copy() must be externally synchronized with each other.
+//
+// The keys are kept in buckets of linked nodes. Removing a key clears its node,
+// which is reused by the next key inserted into the bucket, so that nodes are
+// never freed while a concurrent Contains() may be walking them. As a result,
+// looking up a key of an empty bucket, which is the common case for the
+// addresses which weren't sampled, takes a single load.
+//
+// The set doesn't grow by itself. When the load factor gets too high, the
+// owner is expected to Copy() it into a bigger set and switch the readers to
+// it, keeping the old set alive as long as there may be readers of it.
+class BASE_EXPORT LockFreeAddressHashSet {
+ public:
+  // |buckets_count| must be a power of two.
+  explicit LockFreeAddressHashSet(size_t buckets_count);
+  ~LockFreeAddressHashSet();
+
+  // Checks if |key| is in the set.
+  ALWAYS_INLINE bool Contains(void* key) const;
+
+  // Inserts |key|, which must not be in the set already, nor null.
+  void Insert(void* key);
+
+  // Removes |key|, which must be in the set.
+  void Remove(void* key);
+
+  // Inserts the keys of |other| into this set, which must be empty.
+  void Copy(const LockFreeAddressHashSet& other);
+
+  size_t buckets_count() const { return buckets_.size(); }
+  size_t size() const { return size_; }
+
+  // Returns the average number of keys per bucket.
+  float load_factor() const {
+    return static_cast<float>(size_) / buckets_count();
+  }
+
+ private:
+  struct Node {
+    Node(void* key, Node* next);
+
+    std::atomic<void*> key;
+    // Immutable once the node is published.
+    Node* const next;
+  };
+
+  ALWAYS_INLINE static uint32_t Hash(void* key);
+  ALWAYS_INLINE Node* FindNode(void* key) const;
+
+  std::vector<std::atomic<Node*>> buckets_;
+  const size_t bucket_mask_;
+  size_t size_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(LockFreeAddressHashSet);
+};
+
+ALWAYS_INLINE bool LockFreeAddressHashSet::Contains(void* key) const {
+  return FindNode(key) != nullptr;
+}
+
+ALWAYS_INLINE LockFreeAddressHashSet::Node* LockFreeAddressHashSet::FindNode(
+    void* key) const {
+  DCHECK(key);
+  const std::atomic<Node*>& bucket = buckets_[Hash(key) & bucket_mask_];
+  for (Node* node = bucket.load(std::memory_order_acquire); node;
+       node = node->next) {
+    if (node->key.load(std::memory_order_relaxed) == key)
+      return node;
+  }
+  return nullptr;
+}
+
+// static
+ALWAYS_INLINE uint32_t LockFreeAddressHashSet::Hash(void* key) {
+  // Multiplicative hashing. The low bits of addresses are mostly zero due to
+  // alignment, so the high bits of the product are used.
+  constexpr uint64_t kMultiplier = 0x4bfdb9df5a6f243bull;
+  uint64_t k = reinterpret_cast<uintptr_t>(key);
+  return static_cast<uint32_t>((k * kMultiplier) >> 32);
+}
+
+}  // namespace base
+
+#endif  // BASE_SAMPLING_HEAP_PROFILER_LOCK_FREE_ADDRESS_HASH_SET_H_
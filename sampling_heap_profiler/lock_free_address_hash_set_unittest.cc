@@ -0,0 +1,96 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/sampling_heap_profiler/lock_free_address_hash_set.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace {
+
+void* Address(uintptr_t value) {
+  return reinterpret_cast<void*>(value);
+}
+
+TEST(LockFreeAddressHashSetTest, InsertAndRemove) {
+  LockFreeAddressHashSet set(8);
+  for (uintptr_t i = 1; i <= 100; ++i)
+    set.Insert(Address(i * 16));
+  EXPECT_EQ(100u, set.size());
+  EXPECT_FLOAT_EQ(100.f / 8, set.load_factor());
+
+  for (uintptr_t i = 1; i <= 100; i += 2)
+    set.Remove(Address(i * 16));
+  EXPECT_EQ(50u, set.size());
+  for (uintptr_t i = 1; i <= 100; ++i)
+    EXPECT_EQ(i % 2 == 0, set.Contains(Address(i * 16))) << i;
+  EXPECT_FALSE(set.Contains(Address(8)));
+
+  // The removed keys can be inserted again.
+  set.Insert(Address(16));
+  EXPECT_TRUE(set.Contains(Address(16)));
+  EXPECT_EQ(51u, set.size());
+}
+
+TEST(LockFreeAddressHashSetTest, Copy) {
+  LockFreeAddressHashSet set(4);
+  for (uintptr_t i = 1; i <= 20; ++i)
+    set.Insert(Address(i * 8));
+  set.Remove(Address(8));
+
+  LockFreeAddressHashSet bigger_set(32);
+  bigger_set.Copy(set);
+  EXPECT_EQ(19u, bigger_set.size());
+  EXPECT_EQ(32u, bigger_set.buckets_count());
+  EXPECT_FALSE(bigger_set.Contains(Address(8)));
+  for (uintptr_t i = 2; i <= 20; ++i)
+    EXPECT_TRUE(bigger_set.Contains(Address(i * 8))) << i;
+}
+
+// Looks up keys while another thread inserts and removes others.
+class Reader : public SimpleThread {
+ public:
+  Reader(const LockFreeAddressHashSet* set, std::atomic<bool>* stop)
+      : SimpleThread("Reader"), set_(set), stop_(stop) {}
+
+  void Run() override {
+    while (!stop_->load(std::memory_order_relaxed)) {
+      // The even keys are never removed, and the odd ones never inserted.
+      for (uintptr_t i = 1; i <= 64; ++i)
+        EXPECT_EQ(i % 2 == 0, set_->Contains(Address(i * 16))) << i;
+    }
+  }
+
+ private:
+  const LockFreeAddressHashSet* const set_;
+  std::atomic<bool>* const stop_;
+};
+
+TEST(LockFreeAddressHashSetTest, ConcurrentAccess) {
+  LockFreeAddressHashSet set(16);
+  for (uintptr_t i = 2; i <= 64; i += 2)
+    set.Insert(Address(i * 16));
+
+  std::atomic<bool> stop(false);
+  Reader reader(&set, &stop);
+  reader.Start();
+  for (int round = 0; round < 1000; ++round) {
+    for (uintptr_t i = 1; i <= 1000; ++i)
+      set.Insert(Address(0x100000 + i * 16));
+    for (uintptr_t i = 1; i <= 1000; ++i)
+      set.Remove(Address(0x100000 + i * 16));
+  }
+  stop.store(true, std::memory_order_relaxed);
+  reader.Join();
+  EXPECT_EQ(32u, set.size());
+}
+
+}  // namespace
+}  // namespace base
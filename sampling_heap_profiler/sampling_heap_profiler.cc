@@ -5,17 +5,21 @@
 #include "base/sampling_heap_profiler/sampling_heap_profiler.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <memory>
 
 #include "base/allocator/allocator_shim.h"
 #include "base/allocator/buildflags.h"
 #include "base/allocator/partition_allocator/partition_alloc.h"
 #include "base/atomicops.h"
+#include "base/debug/debugging_buildflags.h"
 #include "base/debug/stack_trace.h"
 #include "base/macros.h"
 #include "base/no_destructor.h"
 #include "base/partition_alloc_buildflags.h"
 #include "base/rand_util.h"
+#include "base/sampling_heap_profiler/lock_free_address_hash_set.h"
 #include "base/threading/thread_local_storage.h"
 #include "build/build_config.h"
 
@@ -33,19 +37,26 @@ const uint32_t kSkipBaseAllocatorFrames = 2;
 
 const size_t kDefaultSamplingIntervalBytes = 128 * 1024;
 
+// The maximum number of frames recorded for a sample.
+const size_t kMaxStackEntries = 128;
+
 // Controls if sample intervals should not be randomized. Used for testing.
 bool g_deterministic;
 
+#if defined(OS_LINUX)
+// Generates the sample intervals, which need no secure randomness, without a
+// syscall or a cryptographic generator on each sample.
+__attribute__((tls_model("initial-exec"))) thread_local InsecureRandomGenerator
+    g_interval_generator;
+#endif
+
 // A positive value if profiling is running, otherwise it's zero.
 Atomic32 g_running;
 
-// Number of lock-free safe (not causing rehashing) accesses to samples_ map
-// currently being performed.
-Atomic32 g_operations_in_flight;
-
-// Controls if new incoming lock-free accesses are allowed.
-// When set to true, threads should not enter lock-free paths.
-Atomic32 g_fast_path_is_closed;
+// The addresses of the samples, which RecordFree() checks without taking the
+// lock. It is replaced by a bigger set as the number of samples grows, and the
+// replaced sets are leaked, since there may still be threads reading them.
+std::atomic<LockFreeAddressHashSet*> g_sampled_addresses_set;
 
 // Sampling interval parameter, the mean value for intervals between samples.
 AtomicWord g_sampling_interval = kDefaultSamplingIntervalBytes;
@@ -160,6 +171,10 @@ void PartitionFreeHook(void* address) {
 
 #endif  // BUILDFLAG(USE_PARTITION_ALLOC) && !defined(OS_NACL)
 
+LockFreeAddressHashSet& SampledAddressesSet() {
+  return *g_sampled_addresses_set.load(std::memory_order_acquire);
+}
+
 ThreadLocalStorage::Slot& AccumulatedBytesTLS() {
   static base::NoDestructor<base::ThreadLocalStorage::Slot>
       accumulated_bytes_tls;
@@ -181,6 +196,8 @@ SamplingHeapProfiler* SamplingHeapProfiler::instance_;
 
 SamplingHeapProfiler::SamplingHeapProfiler() {
   instance_ = this;
+  g_sampled_addresses_set.store(new LockFreeAddressHashSet(64),
+                                std::memory_order_release);
 }
 
 // static
@@ -259,7 +276,11 @@ size_t SamplingHeapProfiler::GetNextSampleInterval(size_t interval) {
   // between samples.
   // Let u be a uniformly distributed random number between 0 and 1, then
   // next_sample = -ln(u) / λ
+#if defined(OS_LINUX)
+  double uniform = g_interval_generator.RandDouble();
+#else
   double uniform = base::RandDouble();
+#endif
   double value = -log(uniform) * interval;
   size_t min_value = sizeof(intptr_t);
   // We limit the upper bound of a sample interval to make sure we don't have
@@ -310,16 +331,29 @@ void SamplingHeapProfiler::RecordAlloc(void* address,
 void SamplingHeapProfiler::RecordStackTrace(Sample* sample,
                                             uint32_t skip_frames) {
 #if !defined(OS_NACL)
-  // TODO(alph): Consider using debug::TraceStackFramePointers. It should be
-  // somewhat faster than base::debug::StackTrace.
-  base::debug::StackTrace trace;
-  size_t count;
-  void* const* addresses = const_cast<void* const*>(trace.Addresses(&count));
   const uint32_t kSkipProfilerOwnFrames = 2;
   skip_frames += kSkipProfilerOwnFrames;
-  sample->stack.insert(
-      sample->stack.end(), &addresses[skip_frames],
-      &addresses[std::max(count, static_cast<size_t>(skip_frames))]);
+  // The frames are captured into a buffer on the stack, so that the only
+  // allocation is the one of the stack of the sample.
+#if BUILDFLAG(CAN_UNWIND_WITH_FRAME_POINTERS)
+  const void* frames[kMaxStackEntries];
+  size_t count = base::debug::TraceStackFramePointers(
+      frames, kMaxStackEntries, skip_frames);
+  const void* const* addresses = frames;
+#else
+  base::debug::StackTrace trace(kMaxStackEntries);
+  size_t count;
+  const void* const* addresses = trace.Addresses(&count);
+  if (count > skip_frames) {
+    addresses += skip_frames;
+    count -= skip_frames;
+  } else {
+    count = 0;
+  }
+#endif
+  sample->stack.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+    sample->stack.push_back(const_cast<void*>(addresses[i]));
 #endif
 }
 
@@ -335,32 +369,38 @@ void SamplingHeapProfiler::DoRecordAlloc(size_t total_allocated,
   Sample sample(size, total_allocated, ++g_last_sample_ordinal);
   RecordStackTrace(&sample, skip_frames);
 
-  // Close the fast-path as inserting an element into samples_ may cause
-  // rehashing that invalidates iterators affecting all the concurrent
-  // readers.
-  base::subtle::Release_Store(&g_fast_path_is_closed, 1);
-  while (base::subtle::Acquire_Load(&g_operations_in_flight)) {
-    while (base::subtle::NoBarrier_Load(&g_operations_in_flight)) {
-    }
-  }
   for (auto* observer : observers_)
     observer->SampleAdded(sample.ordinal, size, total_allocated);
-  // TODO(alph): We can do better by keeping the fast-path open when
-  // we know insert won't cause rehashing.
-  samples_.emplace(address, std::move(sample));
-  base::subtle::Release_Store(&g_fast_path_is_closed, 0);
+  // The address may already be sampled, if it was freed while the hooks were
+  // reentered.
+  if (samples_.emplace(address, std::move(sample)).second) {
+    SampledAddressesSet().Insert(address);
+    BalanceAddressesHashSet();
+  }
 
   entered_.Set(false);
 }
 
+void SamplingHeapProfiler::BalanceAddressesHashSet() {
+  // Keeps the load factor at most 1, so that looking up an address rarely
+  // walks more than a node.
+  LockFreeAddressHashSet& current_set = SampledAddressesSet();
+  if (current_set.load_factor() < 1)
+    return;
+  auto new_set =
+      std::make_unique<LockFreeAddressHashSet>(current_set.buckets_count() * 2);
+  new_set->Copy(current_set);
+  // The old set is leaked, as there may be concurrent readers of it.
+  g_sampled_addresses_set.store(new_set.release(), std::memory_order_release);
+}
+
 // static
 void SamplingHeapProfiler::RecordFree(void* address) {
-  bool maybe_sampled = true;  // Pessimistically assume allocation was sampled.
-  base::subtle::Barrier_AtomicIncrement(&g_operations_in_flight, 1);
-  if (LIKELY(!base::subtle::NoBarrier_Load(&g_fast_path_is_closed)))
-    maybe_sampled = instance_->samples_.count(address);
-  base::subtle::Barrier_AtomicIncrement(&g_operations_in_flight, -1);
-  if (maybe_sampled)
+  if (UNLIKELY(!address))
+    return;
+  // Unsampled addresses are the common case, for which this is a single load
+  // of an empty bucket, in most cases.
+  if (UNLIKELY(SampledAddressesSet().Contains(address)))
     instance_->DoRecordFree(address);
 }
 
@@ -376,6 +416,7 @@ void SamplingHeapProfiler::DoRecordFree(void* address) {
     for (auto* observer : observers_)
       observer->SampleRemoved(it->second.ordinal);
     samples_.erase(it);
+    SampledAddressesSet().Remove(address);
   }
   entered_.Set(false);
 }
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "base/base_export.h"
+#include "base/containers/small_vector.h"
 #include "base/macros.h"
 #include "base/synchronization/lock.h"
 #include "base/threading/thread_local.h"
@@ -92,11 +93,13 @@ class BASE_EXPORT SamplingHeapProfiler {
                      uint32_t skip_frames);
   void DoRecordFree(void* address);
   void RecordStackTrace(Sample*, uint32_t skip_frames);
+  void BalanceAddressesHashSet();
 
   base::ThreadLocalBoolean entered_;
   base::Lock mutex_;
   std::unordered_map<void*, Sample> samples_;
-  std::vector<SamplesObserver*> observers_;
+  // Notified of each sample, there are rarely more than a couple of them.
+  small_vector<SamplesObserver*, 4> observers_;
 
   static SamplingHeapProfiler* instance_;
 
@@ -4,48 +4,51 @@
 
 #include "base/sequence_checker_impl.h"
 
-#include "base/logging.h"
-#include "base/memory/ptr_util.h"
-#include "base/sequence_token.h"
-#include "base/threading/thread_checker_impl.h"
+#include "base/macros.h"
+#include "base/threading/platform_thread.h"
 
 namespace base {
 
-class SequenceCheckerImpl::Core {
- public:
-  Core() : sequence_token_(SequenceToken::GetForCurrentThread()) {}
-
-  ~Core() = default;
-
-  bool CalledOnValidSequence() const {
-    if (sequence_token_.IsValid())
-      return sequence_token_ == SequenceToken::GetForCurrentThread();
-
-    // SequenceChecker behaves as a ThreadChecker when it is not bound to a
-    // valid sequence token.
-    return thread_checker_.CalledOnValidThread();
-  }
-
- private:
-  SequenceToken sequence_token_;
-
-  // Used when |sequence_token_| is invalid.
-  ThreadCheckerImpl thread_checker_;
-};
+SequenceCheckerImpl::SequenceCheckerImpl() {
+  EnsureAssigned();
+}
 
-SequenceCheckerImpl::SequenceCheckerImpl() : core_(std::make_unique<Core>()) {}
 SequenceCheckerImpl::~SequenceCheckerImpl() = default;
 
 bool SequenceCheckerImpl::CalledOnValidSequence() const {
-  AutoLock auto_lock(lock_);
-  if (!core_)
-    core_ = std::make_unique<Core>();
-  return core_->CalledOnValidSequence();
+  EnsureAssigned();
+  if (sequence_token_.IsValid())
+    return sequence_token_ == SequenceToken::GetForCurrentThread();
+
+  // SequenceChecker behaves as a ThreadChecker when it is not bound to a valid
+  // sequence token.
+  return thread_checker_.CalledOnValidThread();
 }
 
 void SequenceCheckerImpl::DetachFromSequence() {
-  AutoLock auto_lock(lock_);
-  core_.reset();
+  // The members are overwritten when the checker is bound again.
+  state_.store(UNBOUND, std::memory_order_release);
+}
+
+void SequenceCheckerImpl::EnsureAssigned() const {
+  if (LIKELY(state_.load(std::memory_order_acquire) == BOUND))
+    return;
+
+  int expected = UNBOUND;
+  if (state_.compare_exchange_strong(expected, BINDING,
+                                     std::memory_order_acquire)) {
+    sequence_token_ = SequenceToken::GetForCurrentThread();
+    thread_checker_.DetachFromThread();
+    // Binds |thread_checker_| to the current thread.
+    ignore_result(thread_checker_.CalledOnValidThread());
+    state_.store(BOUND, std::memory_order_release);
+    return;
+  }
+
+  // Another thread is binding the checker, so this check is about to fail;
+  // wait for the members to be written before reading them.
+  while (state_.load(std::memory_order_acquire) != BOUND)
+    PlatformThread::YieldCurrentThread();
 }
 
 }  // namespace base
@@ -5,12 +5,13 @@
 #ifndef BASE_SEQUENCE_CHECKER_IMPL_H_
 #define BASE_SEQUENCE_CHECKER_IMPL_H_
 
-#include <memory>
+#include <atomic>
 
 #include "base/base_export.h"
 #include "base/compiler_specific.h"
 #include "base/macros.h"
-#include "base/synchronization/lock.h"
+#include "base/sequence_token.h"
+#include "base/threading/thread_checker_impl.h"
 
 namespace base {
 
@@ -34,11 +35,19 @@ class BASE_EXPORT SequenceCheckerImpl {
   void DetachFromSequence();
 
  private:
-  class Core;
+  // Binds the checker to the current sequence, if it isn't bound yet.
+  void EnsureAssigned() const;
 
-  // Guards all variables below.
-  mutable Lock lock_;
-  mutable std::unique_ptr<Core> core_;
+  // Binding states of the checker, as in ThreadCheckerImpl: the members below
+  // are written while BINDING, and only read once BOUND, until the next
+  // DetachFromSequence(), so that checks don't take a lock.
+  enum State : int { UNBOUND, BINDING, BOUND };
+  mutable std::atomic<int> state_{UNBOUND};
+
+  mutable SequenceToken sequence_token_;
+
+  // Used when |sequence_token_| is invalid.
+  mutable ThreadCheckerImpl thread_checker_;
 
   DISALLOW_COPY_AND_ASSIGN(SequenceCheckerImpl);
 };
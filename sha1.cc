@@ -8,7 +8,16 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <algorithm>
+
+#include "base/compiler_specific.h"
+#include "base/cpu_dispatch.h"
 #include "base/sys_byteorder.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <immintrin.h>
+#endif
 
 namespace base {
 
@@ -19,53 +28,22 @@ namespace base {
 // also find a description of the algorithm:
 // http://csrc.nist.gov/publications/fips/fips180-3/fips180-3_final.pdf
 
-// Usage example:
-//
-// SecureHashAlgorithm sha;
-// while(there is data to hash)
-//   sha.Update(moredata, size of data);
-// sha.Final();
-// memcpy(somewhere, sha.Digest(), 20);
-//
-// to reuse the instance of sha, call sha.Init();
-
 // TODO(jhawkins): Replace this implementation with a per-platform
 // implementation using each platform's crypto library.  See
 // http://crbug.com/47218
 
-class SecureHashAlgorithm {
- public:
-  SecureHashAlgorithm() { Init(); }
-
-  static const int kDigestSizeBytes;
-
-  void Init();
-  void Update(const void* data, size_t nbytes);
-  void Final();
-
-  // 20 bytes of message digest.
-  const unsigned char* Digest() const {
-    return reinterpret_cast<const unsigned char*>(H);
-  }
-
- private:
-  void Pad();
-  void Process();
-
-  uint32_t A, B, C, D, E;
+namespace {
 
-  uint32_t H[5];
+const size_t kBlockSize = 64;
 
-  union {
-    uint32_t W[80];
-    uint8_t M[64];
-  };
+static_assert(sizeof(SHA1Context::buffer) == kBlockSize,
+              "SHA1Context::buffer must hold one block");
 
-  uint32_t cursor;
-  uint64_t l;
-};
+// Updates |state| with |num_blocks| consecutive blocks of input.
+using ProcessBlocksDispatch = CPUDispatch<
+    void(uint32_t* state, const uint8_t* blocks, size_t num_blocks)>;
 
-static inline uint32_t f(uint32_t t, uint32_t B, uint32_t C, uint32_t D) {
+inline uint32_t f(uint32_t t, uint32_t B, uint32_t C, uint32_t D) {
   if (t < 20) {
     return (B & C) | ((~B) & D);
   } else if (t < 40) {
@@ -77,11 +55,11 @@ static inline uint32_t f(uint32_t t, uint32_t B, uint32_t C, uint32_t D) {
   }
 }
 
-static inline uint32_t S(uint32_t n, uint32_t X) {
+inline uint32_t S(uint32_t n, uint32_t X) {
   return (X << n) | (X >> (32-n));
 }
 
-static inline uint32_t K(uint32_t t) {
+inline uint32_t K(uint32_t t) {
   if (t < 20) {
     return 0x5a827999;
   } else if (t < 40) {
@@ -93,122 +71,339 @@ static inline uint32_t K(uint32_t t) {
   }
 }
 
-const int SecureHashAlgorithm::kDigestSizeBytes = 20;
-
-void SecureHashAlgorithm::Init() {
-  A = 0;
-  B = 0;
-  C = 0;
-  D = 0;
-  E = 0;
-  cursor = 0;
-  l = 0;
-  H[0] = 0x67452301;
-  H[1] = 0xefcdab89;
-  H[2] = 0x98badcfe;
-  H[3] = 0x10325476;
-  H[4] = 0xc3d2e1f0;
+void ProcessBlocks(uint32_t* H, const uint8_t* blocks, size_t num_blocks) {
+  for (; num_blocks; --num_blocks, blocks += kBlockSize) {
+    uint32_t W[80];
+    uint32_t t;
+
+    // Each a...e corresponds to a section in the FIPS 180-3 algorithm.
+
+    // a.
+    memcpy(W, blocks, kBlockSize);
+    for (t = 0; t < 16; ++t)
+      W[t] = NetToHost32(W[t]);
+
+    // b.
+    for (t = 16; t < 80; ++t)
+      W[t] = S(1, W[t - 3] ^ W[t - 8] ^ W[t - 14] ^ W[t - 16]);
+
+    // c.
+    uint32_t A = H[0];
+    uint32_t B = H[1];
+    uint32_t C = H[2];
+    uint32_t D = H[3];
+    uint32_t E = H[4];
+
+    // d.
+    for (t = 0; t < 80; ++t) {
+      uint32_t TEMP = S(5, A) + f(t, B, C, D) + E + W[t] + K(t);
+      E = D;
+      D = C;
+      C = S(30, B);
+      B = A;
+      A = TEMP;
+    }
+
+    // e.
+    H[0] += A;
+    H[1] += B;
+    H[2] += C;
+    H[3] += D;
+    H[4] += E;
+  }
 }
 
-void SecureHashAlgorithm::Final() {
-  Pad();
-  Process();
+#if defined(ARCH_CPU_X86_FAMILY)
+
+#if defined(COMPILER_GCC)
+#define SHA_NI_TARGET __attribute__((target("sha,sse4.1")))
+#else
+#define SHA_NI_TARGET
+#endif
+
+// ProcessBlocks() using the SHA extensions. Each _mm_sha1rnds4_epu32() does
+// four rounds of section d., and the message schedule of section b. is spread
+// in between, four words at a time: _mm_sha1msg1_epu32(), the XOR and
+// _mm_sha1msg2_epu32() compute the next words from the ones four, three and
+// two steps before. _mm_sha1nexte_epu32() computes E from A of four rounds
+// earlier and adds it to the next words.
+SHA_NI_TARGET void ProcessBlocksShaNi(uint32_t* H,
+                                      const uint8_t* blocks,
+                                      size_t num_blocks) {
+  // Reverses the bytes of the whole register: the words are big-endian, and
+  // the instructions expect the first word in the highest lane.
+  const __m128i kShuffleMask =
+      _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+  // A in the highest lane of |abcd|, and E in the highest lane of |e0|.
+  __m128i abcd = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(H)), 0x1B);
+  __m128i e0 = _mm_set_epi32(H[4], 0, 0, 0);
+
+  for (; num_blocks; --num_blocks, blocks += kBlockSize) {
+    const __m128i* words = reinterpret_cast<const __m128i*>(blocks);
+    const __m128i abcd_save = abcd;
+    const __m128i e0_save = e0;
+    __m128i e1, msg0, msg1, msg2, msg3;
+
+    // Rounds 0-3.
+    msg0 = _mm_shuffle_epi8(_mm_loadu_si128(words + 0), kShuffleMask);
+    e0 = _mm_add_epi32(e0, msg0);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+    // Rounds 4-7.
+    msg1 = _mm_shuffle_epi8(_mm_loadu_si128(words + 1), kShuffleMask);
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+    msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+    // Rounds 8-11.
+    msg2 = _mm_shuffle_epi8(_mm_loadu_si128(words + 2), kShuffleMask);
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+    msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+    msg0 = _mm_xor_si128(msg0, msg2);
+
+    // Rounds 12-15.
+    msg3 = _mm_shuffle_epi8(_mm_loadu_si128(words + 3), kShuffleMask);
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+    msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+    msg1 = _mm_xor_si128(msg1, msg3);
+
+    // Rounds 16-19.
+    e0 = _mm_sha1nexte_epu32(e0, msg0);
+    e1 = abcd;
+    msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+    msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+    msg2 = _mm_xor_si128(msg2, msg0);
+
+    // Rounds 20-23.
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+    msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+    msg3 = _mm_xor_si128(msg3, msg1);
+
+    // Rounds 24-27.
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+    msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+    msg0 = _mm_xor_si128(msg0, msg2);
+
+    // Rounds 28-31.
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+    msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+    msg1 = _mm_xor_si128(msg1, msg3);
+
+    // Rounds 32-35.
+    e0 = _mm_sha1nexte_epu32(e0, msg0);
+    e1 = abcd;
+    msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+    msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+    msg2 = _mm_xor_si128(msg2, msg0);
+
+    // Rounds 36-39.
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+    msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+    msg3 = _mm_xor_si128(msg3, msg1);
+
+    // Rounds 40-43.
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+    msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+    msg0 = _mm_xor_si128(msg0, msg2);
+
+    // Rounds 44-47.
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+    msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+    msg1 = _mm_xor_si128(msg1, msg3);
+
+    // Rounds 48-51.
+    e0 = _mm_sha1nexte_epu32(e0, msg0);
+    e1 = abcd;
+    msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+    msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+    msg2 = _mm_xor_si128(msg2, msg0);
+
+    // Rounds 52-55.
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+    msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+    msg3 = _mm_xor_si128(msg3, msg1);
+
+    // Rounds 56-59.
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+    msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+    msg0 = _mm_xor_si128(msg0, msg2);
+
+    // Rounds 60-63.
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+    msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+    msg1 = _mm_xor_si128(msg1, msg3);
+
+    // Rounds 64-67.
+    e0 = _mm_sha1nexte_epu32(e0, msg0);
+    e1 = abcd;
+    msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+    msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+    msg2 = _mm_xor_si128(msg2, msg0);
+
+    // Rounds 68-71.
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+    msg3 = _mm_xor_si128(msg3, msg1);
+
+    // Rounds 72-75.
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+
+    // Rounds 76-79.
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+    // Section e.
+    e0 = _mm_sha1nexte_epu32(e0, e0_save);
+    abcd = _mm_add_epi32(abcd, abcd_save);
+  }
 
-  for (int t = 0; t < 5; ++t)
-    H[t] = ByteSwap(H[t]);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(H),
+                   _mm_shuffle_epi32(abcd, 0x1B));
+  H[4] = _mm_extract_epi32(e0, 3);
 }
 
-void SecureHashAlgorithm::Update(const void* data, size_t nbytes) {
-  const uint8_t* d = reinterpret_cast<const uint8_t*>(data);
-  while (nbytes--) {
-    M[cursor++] = *d++;
-    if (cursor >= 64)
-      Process();
-    l += 8;
-  }
+#undef SHA_NI_TARGET
+
+#endif  // defined(ARCH_CPU_X86_FAMILY)
+
+ProcessBlocksDispatch::Function ResolveProcessBlocks(const CPU& cpu) {
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (cpu.has_sha() && cpu.has_sse41())
+    return &ProcessBlocksShaNi;
+#endif
+  return &ProcessBlocks;
 }
 
-void SecureHashAlgorithm::Pad() {
-  M[cursor++] = 0x80;
+CONSTINIT ProcessBlocksDispatch
+    g_process_blocks_with_best_implementation(&ResolveProcessBlocks);
 
-  if (cursor > 64-8) {
-    // pad out to next block
-    while (cursor < 64)
-      M[cursor++] = 0;
+void ProcessBlocksWithBestImplementation(uint32_t* state,
+                                         const uint8_t* blocks,
+                                         size_t num_blocks) {
+  g_process_blocks_with_best_implementation(state, blocks, num_blocks);
+}
 
-    Process();
-  }
+}  // namespace
 
-  while (cursor < 64-8)
-    M[cursor++] = 0;
-
-  M[cursor++] = (l >> 56) & 0xff;
-  M[cursor++] = (l >> 48) & 0xff;
-  M[cursor++] = (l >> 40) & 0xff;
-  M[cursor++] = (l >> 32) & 0xff;
-  M[cursor++] = (l >> 24) & 0xff;
-  M[cursor++] = (l >> 16) & 0xff;
-  M[cursor++] = (l >> 8) & 0xff;
-  M[cursor++] = l & 0xff;
+void SHA1Init(SHA1Context* context) {
+  context->state[0] = 0x67452301;
+  context->state[1] = 0xefcdab89;
+  context->state[2] = 0x98badcfe;
+  context->state[3] = 0x10325476;
+  context->state[4] = 0xc3d2e1f0;
+  context->buffer_size = 0;
+  context->length = 0;
 }
 
-void SecureHashAlgorithm::Process() {
-  uint32_t t;
-
-  // Each a...e corresponds to a section in the FIPS 180-3 algorithm.
-
-  // a.
-  //
-  // W and M are in a union, so no need to memcpy.
-  // memcpy(W, M, sizeof(M));
-  for (t = 0; t < 16; ++t)
-    W[t] = ByteSwap(W[t]);
-
-  // b.
-  for (t = 16; t < 80; ++t)
-    W[t] = S(1, W[t - 3] ^ W[t - 8] ^ W[t - 14] ^ W[t - 16]);
-
-  // c.
-  A = H[0];
-  B = H[1];
-  C = H[2];
-  D = H[3];
-  E = H[4];
-
-  // d.
-  for (t = 0; t < 80; ++t) {
-    uint32_t TEMP = S(5, A) + f(t, B, C, D) + E + W[t] + K(t);
-    E = D;
-    D = C;
-    C = S(30, B);
-    B = A;
-    A = TEMP;
+void SHA1Update(SHA1Context* context, const StringPiece& data) {
+  const uint8_t* input = reinterpret_cast<const uint8_t*>(data.data());
+  size_t size = data.size();
+  context->length += size;
+
+  // Complete the buffered block first.
+  if (context->buffer_size) {
+    size_t copied = std::min(size, kBlockSize - context->buffer_size);
+    memcpy(context->buffer + context->buffer_size, input, copied);
+    context->buffer_size += copied;
+    input += copied;
+    size -= copied;
+    if (context->buffer_size < kBlockSize)
+      return;
+    ProcessBlocksWithBestImplementation(context->state, context->buffer, 1);
+    context->buffer_size = 0;
   }
 
-  // e.
-  H[0] += A;
-  H[1] += B;
-  H[2] += C;
-  H[3] += D;
-  H[4] += E;
+  // Then hash the whole blocks straight from the input.
+  size_t num_blocks = size / kBlockSize;
+  if (num_blocks) {
+    ProcessBlocksWithBestImplementation(context->state, input, num_blocks);
+    input += num_blocks * kBlockSize;
+    size -= num_blocks * kBlockSize;
+  }
 
-  cursor = 0;
+  memcpy(context->buffer, input, size);
+  context->buffer_size = size;
+}
+
+void SHA1Final(unsigned char* hash, SHA1Context* context) {
+  // Pad with a single bit, zeros and the length of the input in bits, to a
+  // whole number of blocks.
+  const uint64_t length_in_bits = HostToNet64(context->length * 8);
+  uint8_t padding[2 * kBlockSize] = {0x80};
+  size_t padding_size = kBlockSize - context->buffer_size;
+  if (padding_size < 1 + sizeof(length_in_bits))
+    padding_size += kBlockSize;
+  memcpy(padding + padding_size - sizeof(length_in_bits), &length_in_bits,
+         sizeof(length_in_bits));
+  SHA1Update(context, StringPiece(reinterpret_cast<const char*>(padding),
+                                  padding_size));
+
+  for (int t = 0; t < 5; ++t) {
+    uint32_t word = HostToNet32(context->state[t]);
+    memcpy(hash + t * sizeof(word), &word, sizeof(word));
+  }
 }
 
 std::string SHA1HashString(const std::string& str) {
-  char hash[SecureHashAlgorithm::kDigestSizeBytes];
+  char hash[kSHA1Length];
   SHA1HashBytes(reinterpret_cast<const unsigned char*>(str.c_str()),
                 str.length(), reinterpret_cast<unsigned char*>(hash));
-  return std::string(hash, SecureHashAlgorithm::kDigestSizeBytes);
+  return std::string(hash, kSHA1Length);
 }
 
 void SHA1HashBytes(const unsigned char* data, size_t len,
                    unsigned char* hash) {
-  SecureHashAlgorithm sha;
-  sha.Update(data, len);
-  sha.Final();
-
-  memcpy(hash, sha.Digest(), SecureHashAlgorithm::kDigestSizeBytes);
+  SHA1Context context;
+  SHA1Init(&context);
+  SHA1Update(&context,
+             StringPiece(reinterpret_cast<const char*>(data), len));
+  SHA1Final(hash, &context);
 }
 
 }  // namespace base
@@ -6,10 +6,12 @@
 #define BASE_SHA1_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <string>
 
 #include "base/base_export.h"
+#include "base/strings/string_piece.h"
 
 namespace base {
 
@@ -26,6 +28,40 @@ BASE_EXPORT std::string SHA1HashString(const std::string& str);
 BASE_EXPORT void SHA1HashBytes(const unsigned char* data, size_t len,
                                unsigned char* hash);
 
+// Used to compute the SHA-1 hash of data which isn't available all at once,
+// for example:
+//
+//   SHA1Context ctx;
+//   SHA1Init(&ctx);
+//   for (const std::string& chunk : chunks)
+//     SHA1Update(&ctx, chunk);
+//   unsigned char hash[kSHA1Length];
+//   SHA1Final(hash, &ctx);
+//
+// Callers should not access the data in the context.
+struct SHA1Context {
+  uint32_t state[5];
+  // The input which doesn't fill a block yet.
+  uint8_t buffer[64];
+  size_t buffer_size;
+  // The number of bytes of input.
+  uint64_t length;
+};
+
+// Initializes the given SHA-1 context structure for subsequent calls to
+// SHA1Update().
+BASE_EXPORT void SHA1Init(SHA1Context* context);
+
+// For the given buffer of |data| as a StringPiece, updates the given SHA-1
+// context with the sum of the data. You can call this any number of times
+// during the computation, except that SHA1Init() must have been called first.
+BASE_EXPORT void SHA1Update(SHA1Context* context, const StringPiece& data);
+
+// Finalizes the SHA-1 operation and fills the buffer with the hash. |hash|
+// must be kSHA1Length bytes long. The context can't be updated afterwards
+// unless SHA1Init() is called again.
+BASE_EXPORT void SHA1Final(unsigned char* hash, SHA1Context* context);
+
 }  // namespace base
 
 #endif  // BASE_SHA1_H_
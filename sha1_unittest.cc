@@ -8,6 +8,8 @@
 
 #include <string>
 
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 TEST(SHA1Test, Test1) {
@@ -107,3 +109,71 @@ TEST(SHA1Test, Test3Bytes) {
   for (size_t i = 0; i < base::kSHA1Length; i++)
     EXPECT_EQ(expected[i], output[i]);
 }
+
+TEST(SHA1Test, ContextSplitAnywhere) {
+  // Example A.2 from FIPS 180-2, hashed in two parts split at every offset.
+  std::string input =
+      "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  std::string expected = base::SHA1HashString(input);
+
+  for (size_t split = 0; split <= input.size(); ++split) {
+    base::SHA1Context context;
+    base::SHA1Init(&context);
+    base::SHA1Update(&context, base::StringPiece(input).substr(0, split));
+    base::SHA1Update(&context, base::StringPiece(input).substr(split));
+    unsigned char output[base::kSHA1Length];
+    base::SHA1Final(output, &context);
+    EXPECT_EQ(expected, std::string(reinterpret_cast<char*>(output),
+                                    base::kSHA1Length))
+        << "split at " << split;
+  }
+}
+
+TEST(SHA1Test, ContextUnevenUpdates) {
+  // Example A.3 from FIPS 180-2, in updates crossing the block boundaries.
+  std::string input(1000000, 'a');
+
+  unsigned char expected[] = { 0x34, 0xaa, 0x97, 0x3c,
+                               0xd4, 0xc4, 0xda, 0xa4,
+                               0xf6, 0x1e, 0xeb, 0x2b,
+                               0xdb, 0xad, 0x27, 0x31,
+                               0x65, 0x34, 0x01, 0x6f };
+
+  base::SHA1Context context;
+  base::SHA1Init(&context);
+  base::StringPiece remaining(input);
+  for (size_t size = 1; !remaining.empty(); size = size * 3 + 1) {
+    base::StringPiece part = remaining.substr(0, size);
+    base::SHA1Update(&context, part);
+    remaining.remove_prefix(part.size());
+  }
+  unsigned char output[base::kSHA1Length];
+  base::SHA1Final(output, &context);
+  for (size_t i = 0; i < base::kSHA1Length; i++)
+    EXPECT_EQ(expected[i], output[i]);
+}
+
+TEST(SHA1Test, PaddingBoundaries) {
+  // Lengths around the point where the padding needs a block of its own, with
+  // the hashes of that many 'a's.
+  const struct {
+    size_t length;
+    const char* hash;
+  } kCases[] = {
+      {0, "DA39A3EE5E6B4B0D3255BFEF95601890AFD80709"},
+      {55, "C1C8BBDC22796E28C0E15163D20899B65621D65A"},
+      {56, "C2DB330F6083854C99D4B5BFB6E8F29F201BE699"},
+      {63, "03F09F5B158A7A8CDAD920BDDC29B81C18A551F5"},
+      {64, "0098BA824B5C16427BD7A1122A5A442A25EC644D"},
+      {65, "11655326C708D70319BE2610E8A57D9A5B959D3B"},
+      {119, "EE971065AAA017E0632A8CA6C77BB3BF8B1DFC56"},
+      {120, "F34C1488385346A55709BA056DDD08280DD4C6D6"},
+  };
+
+  for (const auto& test_case : kCases) {
+    std::string output =
+        base::SHA1HashString(std::string(test_case.length, 'a'));
+    EXPECT_EQ(test_case.hash, base::HexEncode(output.data(), output.size()))
+        << "length " << test_case.length;
+  }
+}
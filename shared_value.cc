@@ -0,0 +1,271 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/shared_value.h"
+
+#include <utility>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+
+namespace base {
+
+// A node holds either a scalar, a dictionary or a list, and is never modified
+// once it's shared by several SharedValues.
+class SharedValue::Node : public RefCountedThreadSafe<Node> {
+ public:
+  explicit Node(Value::Type type) : type_(type) {}
+
+  // A shallow copy, whose children are shared with |other|.
+  Node(const Node& other)
+      : type_(other.type_),
+        scalar_(other.scalar_.Clone()),
+        dict_(other.dict_),
+        list_(other.list_) {}
+
+  Value::Type type() const { return type_; }
+
+  Value& scalar() { return scalar_; }
+  const Value& scalar() const { return scalar_; }
+  DictStorage& dict() { return dict_; }
+  const DictStorage& dict() const { return dict_; }
+  ListStorage& list() { return list_; }
+  const ListStorage& list() const { return list_; }
+
+ private:
+  friend class RefCountedThreadSafe<Node>;
+  ~Node() = default;
+
+  const Value::Type type_;
+  // Only used by nodes of the matching type.
+  Value scalar_;
+  DictStorage dict_;
+  ListStorage list_;
+
+  DISALLOW_ASSIGN(Node);
+};
+
+SharedValue::SharedValue() = default;
+
+SharedValue::SharedValue(Value value) {
+  switch (value.type()) {
+    case Value::Type::NONE:
+      return;
+
+    case Value::Type::DICTIONARY: {
+      node_ = MakeRefCounted<Node>(Value::Type::DICTIONARY);
+      DictStorage& dict = node_->dict();
+      // The members are already sorted, so they're appended in order.
+      for (auto item : value.DictItems())
+        dict.emplace_hint(dict.end(), item.first, std::move(item.second));
+      return;
+    }
+
+    case Value::Type::LIST: {
+      node_ = MakeRefCounted<Node>(Value::Type::LIST);
+      ListStorage& list = node_->list();
+      list.reserve(value.GetList().size());
+      for (Value& item : value.GetList())
+        list.emplace_back(std::move(item));
+      return;
+    }
+
+    default:
+      node_ = MakeRefCounted<Node>(value.type());
+      node_->scalar() = std::move(value);
+      return;
+  }
+}
+
+SharedValue::SharedValue(const SharedValue& other) = default;
+
+SharedValue::SharedValue(SharedValue&& other) noexcept = default;
+
+SharedValue::SharedValue(scoped_refptr<Node> node) : node_(std::move(node)) {}
+
+SharedValue::~SharedValue() = default;
+
+SharedValue& SharedValue::operator=(const SharedValue& other) = default;
+
+SharedValue& SharedValue::operator=(SharedValue&& other) noexcept = default;
+
+Value::Type SharedValue::type() const {
+  return node_ ? node_->type() : Value::Type::NONE;
+}
+
+bool SharedValue::GetBool() const {
+  CHECK_EQ(Value::Type::BOOLEAN, type());
+  return node_->scalar().GetBool();
+}
+
+int SharedValue::GetInt() const {
+  CHECK_EQ(Value::Type::INTEGER, type());
+  return node_->scalar().GetInt();
+}
+
+double SharedValue::GetDouble() const {
+  CHECK(type() == Value::Type::DOUBLE || type() == Value::Type::INTEGER);
+  return node_->scalar().GetDouble();
+}
+
+const std::string& SharedValue::GetString() const {
+  CHECK_EQ(Value::Type::STRING, type());
+  return node_->scalar().GetString();
+}
+
+const Value::BlobStorage& SharedValue::GetBlob() const {
+  CHECK_EQ(Value::Type::BINARY, type());
+  return node_->scalar().GetBlob();
+}
+
+const SharedValue::ListStorage& SharedValue::GetList() const {
+  CHECK(is_list());
+  return node_->list();
+}
+
+const SharedValue::DictStorage& SharedValue::GetDict() const {
+  CHECK(is_dict());
+  return node_->dict();
+}
+
+const SharedValue* SharedValue::FindKey(StringPiece key) const {
+  CHECK(is_dict());
+  auto found = node_->dict().find(key);
+  if (found == node_->dict().end())
+    return nullptr;
+  return &found->second;
+}
+
+const SharedValue* SharedValue::FindPath(
+    std::initializer_list<StringPiece> path) const {
+  return FindPath(make_span(path.begin(), path.size()));
+}
+
+const SharedValue* SharedValue::FindPath(span<const StringPiece> path) const {
+  const SharedValue* current = this;
+  for (StringPiece component : path) {
+    if (!current->is_dict())
+      return nullptr;
+    current = current->FindKey(component);
+    if (!current)
+      return nullptr;
+  }
+  return current;
+}
+
+bool SharedValue::SetKey(StringPiece key, SharedValue value) {
+  if (!is_dict())
+    return false;
+  DictStorage& dict = GetMutableNode()->dict();
+  auto position = dict.lower_bound(key);
+  if (position != dict.end() && position->first == key)
+    position->second = std::move(value);
+  else
+    dict.emplace_hint(position, key.as_string(), std::move(value));
+  return true;
+}
+
+bool SharedValue::SetPath(std::initializer_list<StringPiece> path,
+                          SharedValue value) {
+  DCHECK_NE(path.begin(), path.end());
+  return SetPath(make_span(path.begin(), path.size()), std::move(value));
+}
+
+bool SharedValue::SetPath(span<const StringPiece> path, SharedValue value) {
+  if (!is_dict())
+    return false;
+  if (path.size() == 1)
+    return SetKey(path[0], std::move(value));
+
+  // Only the dictionaries along |path| are copied, if they're shared; their
+  // other members are shared with the previous version of the tree.
+  DictStorage& dict = GetMutableNode()->dict();
+  auto position = dict.lower_bound(path[0]);
+  if (position == dict.end() || position->first != path[0]) {
+    position = dict.emplace_hint(
+        position, path[0].as_string(),
+        SharedValue(MakeRefCounted<Node>(Value::Type::DICTIONARY)));
+  }
+  return position->second.SetPath(path.subspan(1), std::move(value));
+}
+
+bool SharedValue::RemovePath(std::initializer_list<StringPiece> path) {
+  DCHECK_NE(path.begin(), path.end());
+  span<const StringPiece> path_span = make_span(path.begin(), path.size());
+  // Check that the value exists first, so that a failed removal doesn't copy
+  // the shared dictionaries along |path|.
+  if (!FindPath(path_span))
+    return false;
+  RemoveExistingPath(path_span);
+  return true;
+}
+
+void SharedValue::RemoveExistingPath(span<const StringPiece> path) {
+  DictStorage& dict = GetMutableNode()->dict();
+  auto found = dict.find(path[0]);
+  DCHECK(found != dict.end());
+  if (path.size() > 1) {
+    found->second.RemoveExistingPath(path.subspan(1));
+    if (!found->second.GetDict().empty())
+      return;
+  }
+  dict.erase(found);
+}
+
+Value SharedValue::ToValue() const {
+  switch (type()) {
+    case Value::Type::NONE:
+      return Value();
+
+    case Value::Type::DICTIONARY: {
+      Value::DictStorage dict;
+      dict.reserve(node_->dict().size());
+      for (const auto& item : node_->dict()) {
+        dict.emplace_hint(dict.end(), item.first,
+                          std::make_unique<Value>(item.second.ToValue()));
+      }
+      return Value(std::move(dict));
+    }
+
+    case Value::Type::LIST: {
+      Value::ListStorage list;
+      list.reserve(node_->list().size());
+      for (const SharedValue& item : node_->list())
+        list.push_back(item.ToValue());
+      return Value(std::move(list));
+    }
+
+    default:
+      return node_->scalar().Clone();
+  }
+}
+
+bool SharedValue::operator==(const SharedValue& other) const {
+  // Shared subtrees are equal without looking into them.
+  if (node_ == other.node_)
+    return true;
+  if (type() != other.type())
+    return false;
+
+  switch (type()) {
+    case Value::Type::NONE:
+      return true;
+    case Value::Type::DICTIONARY:
+      return node_->dict() == other.node_->dict();
+    case Value::Type::LIST:
+      return node_->list() == other.node_->list();
+    default:
+      return node_->scalar() == other.node_->scalar();
+  }
+}
+
+SharedValue::Node* SharedValue::GetMutableNode() {
+  DCHECK(node_);
+  if (!node_->HasOneRef())
+    node_ = MakeRefCounted<Node>(*node_);
+  return node_.get();
+}
+
+}  // namespace base
@@ -0,0 +1,115 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_SHARED_VALUE_H_
+#define BASE_SHARED_VALUE_H_
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/containers/flat_map.h"
+#include "base/containers/span.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+
+namespace base {
+
+// An immutable tree of values, whose copies share their subtrees. Copying a
+// SharedValue is O(1) whatever its size, which makes it cheap to hand
+// snapshots of a large tree, e.g. a configuration, to many readers. The
+// subtrees are reference counted thread-safely and never modified once
+// shared, so copies can be read on any sequence.
+//
+// Mutations are copy-on-write: they create new nodes on the path to the
+// mutated value, which share all other subtrees with the previous version,
+// and leave the other copies unchanged. Nodes which aren't shared are
+// modified in place.
+//
+//   SharedValue config(std::move(value));
+//   SharedValue snapshot = config;  // O(1).
+//   config.SetPath({"network", "timeout"}, SharedValue(Value(30)));
+//   // |snapshot| still has the previous timeout, and shares all of the tree
+//   // but the "network" dictionary with |config|.
+//
+// This class is thread-compatible: a given SharedValue must not be mutated
+// while it's read, but distinct copies can be used on distinct sequences.
+class BASE_EXPORT SharedValue {
+ public:
+  using DictStorage = flat_map<std::string, SharedValue>;
+  using ListStorage = std::vector<SharedValue>;
+
+  // Creates a null value.
+  SharedValue();
+  // Converts |value|, which takes O(size of |value|) once.
+  explicit SharedValue(Value value);
+  SharedValue(const SharedValue& other);
+  SharedValue(SharedValue&& other) noexcept;
+  ~SharedValue();
+
+  SharedValue& operator=(const SharedValue& other);
+  SharedValue& operator=(SharedValue&& other) noexcept;
+
+  Value::Type type() const;
+  bool is_none() const { return type() == Value::Type::NONE; }
+  bool is_dict() const { return type() == Value::Type::DICTIONARY; }
+  bool is_list() const { return type() == Value::Type::LIST; }
+
+  // These must only be called on values of the matching type, like the
+  // accessors of Value.
+  bool GetBool() const;
+  int GetInt() const;
+  double GetDouble() const;  // Implicitly converts from int if necessary.
+  const std::string& GetString() const;
+  const Value::BlobStorage& GetBlob() const;
+  const ListStorage& GetList() const;
+  const DictStorage& GetDict() const;
+
+  // Returns the value of |key| in this dictionary, or of the dictionaries
+  // along |path|, or null if there is none.
+  const SharedValue* FindKey(StringPiece key) const;
+  const SharedValue* FindPath(std::initializer_list<StringPiece> path) const;
+
+  // Sets the value of |key| in this dictionary. Returns false if this isn't
+  // a dictionary.
+  bool SetKey(StringPiece key, SharedValue value);
+
+  // Sets the value at |path|, creating the missing dictionaries along it.
+  // Returns false if a value along |path| isn't a dictionary, like
+  // Value::SetPath().
+  bool SetPath(std::initializer_list<StringPiece> path, SharedValue value);
+
+  // Removes the value at |path|, and the dictionaries which are left empty
+  // along it. Returns false if there is none, like Value::RemovePath().
+  bool RemovePath(std::initializer_list<StringPiece> path);
+
+  // Returns a deep copy of this tree as a Value, for the APIs which need one.
+  Value ToValue() const;
+
+  bool operator==(const SharedValue& other) const;
+  bool operator!=(const SharedValue& other) const { return !(*this == other); }
+
+ private:
+  class Node;
+
+  explicit SharedValue(scoped_refptr<Node> node);
+
+  // Returns the node of this value, made unshared first so that it can be
+  // modified.
+  Node* GetMutableNode();
+
+  const SharedValue* FindPath(span<const StringPiece> path) const;
+  bool SetPath(span<const StringPiece> path, SharedValue value);
+  // Like RemovePath(), once the value at |path| is known to exist.
+  void RemoveExistingPath(span<const StringPiece> path);
+
+  // Null for null values, so that they don't allocate.
+  scoped_refptr<Node> node_;
+};
+
+}  // namespace base
+
+#endif  // BASE_SHARED_VALUE_H_
@@ -0,0 +1,128 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/shared_value.h"
+
+#include <utility>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+Value CreateTestValue() {
+  Value network(Value::Type::DICTIONARY);
+  network.SetKey("timeout", Value(10));
+  network.SetKey("host", Value("example.com"));
+  Value list(Value::Type::LIST);
+  list.GetList().emplace_back(1.5);
+  list.GetList().emplace_back(Value::BlobStorage{'a', 'b'});
+  list.GetList().emplace_back();
+  Value dict(Value::Type::DICTIONARY);
+  dict.SetKey("network", std::move(network));
+  dict.SetKey("list", std::move(list));
+  dict.SetKey("enabled", Value(true));
+  return dict;
+}
+
+}  // namespace
+
+TEST(SharedValueTest, ConvertValue) {
+  const Value value = CreateTestValue();
+  SharedValue shared(value.Clone());
+  EXPECT_TRUE(shared.is_dict());
+  EXPECT_EQ(3u, shared.GetDict().size());
+  EXPECT_TRUE(shared.FindKey("enabled")->GetBool());
+  EXPECT_EQ(10, shared.FindPath({"network", "timeout"})->GetInt());
+  EXPECT_EQ("example.com", shared.FindPath({"network", "host"})->GetString());
+  EXPECT_EQ(nullptr, shared.FindPath({"network", "missing"}));
+  EXPECT_EQ(nullptr, shared.FindPath({"enabled", "missing"}));
+
+  const SharedValue::ListStorage& list = shared.FindKey("list")->GetList();
+  ASSERT_EQ(3u, list.size());
+  EXPECT_EQ(1.5, list[0].GetDouble());
+  EXPECT_EQ(Value::BlobStorage({'a', 'b'}), list[1].GetBlob());
+  EXPECT_TRUE(list[2].is_none());
+
+  EXPECT_EQ(value, shared.ToValue());
+}
+
+TEST(SharedValueTest, CopiesShareTheTree) {
+  SharedValue shared(CreateTestValue());
+  SharedValue copy = shared;
+  EXPECT_EQ(&shared.GetDict(), &copy.GetDict());
+  EXPECT_EQ(shared, copy);
+}
+
+TEST(SharedValueTest, SetPath) {
+  SharedValue original(CreateTestValue());
+  SharedValue modified = original;
+  EXPECT_TRUE(modified.SetPath({"network", "timeout"}, SharedValue(Value(30))));
+  EXPECT_TRUE(modified.SetPath({"new", "nested", "key"},
+                               SharedValue(Value("value"))));
+
+  EXPECT_EQ(30, modified.FindPath({"network", "timeout"})->GetInt());
+  EXPECT_EQ("value", modified.FindPath({"new", "nested", "key"})->GetString());
+  EXPECT_EQ(10, original.FindPath({"network", "timeout"})->GetInt());
+  EXPECT_EQ(nullptr, original.FindKey("new"));
+  EXPECT_NE(original, modified);
+
+  // The subtrees off the path are still shared.
+  EXPECT_EQ(&original.FindKey("list")->GetList(),
+            &modified.FindKey("list")->GetList());
+  EXPECT_NE(&original.FindKey("network")->GetDict(),
+            &modified.FindKey("network")->GetDict());
+
+  // Unshared dictionaries are modified in place.
+  const SharedValue::DictStorage* network =
+      &modified.FindKey("network")->GetDict();
+  EXPECT_TRUE(modified.SetPath({"network", "timeout"}, SharedValue(Value(5))));
+  EXPECT_EQ(network, &modified.FindKey("network")->GetDict());
+
+  // Values which aren't dictionaries aren't replaced.
+  EXPECT_FALSE(modified.SetPath({"enabled", "key"}, SharedValue(Value(1))));
+  EXPECT_TRUE(modified.FindKey("enabled")->GetBool());
+
+  Value expected = CreateTestValue();
+  expected.SetPath({"network", "timeout"}, Value(5));
+  expected.SetPath({"new", "nested", "key"}, Value("value"));
+  EXPECT_EQ(expected, modified.ToValue());
+}
+
+TEST(SharedValueTest, RemovePath) {
+  SharedValue original(CreateTestValue());
+  original.SetPath({"a", "b", "c"}, SharedValue(Value(1)));
+  SharedValue modified = original;
+
+  EXPECT_FALSE(modified.RemovePath({"network", "missing"}));
+  EXPECT_EQ(&original.GetDict(), &modified.GetDict());
+
+  EXPECT_TRUE(modified.RemovePath({"network", "timeout"}));
+  EXPECT_EQ(nullptr, modified.FindPath({"network", "timeout"}));
+  EXPECT_EQ(10, original.FindPath({"network", "timeout"})->GetInt());
+
+  // Emptied dictionaries are removed along with the value.
+  EXPECT_TRUE(modified.RemovePath({"a", "b", "c"}));
+  EXPECT_EQ(nullptr, modified.FindKey("a"));
+  EXPECT_EQ(1, original.FindPath({"a", "b", "c"})->GetInt());
+
+  Value expected = CreateTestValue();
+  expected.RemovePath({"network", "timeout"});
+  EXPECT_EQ(expected, modified.ToValue());
+}
+
+TEST(SharedValueTest, Equality) {
+  SharedValue a(CreateTestValue());
+  SharedValue b(CreateTestValue());
+  EXPECT_EQ(a, b);
+  b.SetPath({"network", "timeout"}, SharedValue(Value(10)));
+  EXPECT_EQ(a, b);
+  b.SetPath({"network", "timeout"}, SharedValue(Value(11)));
+  EXPECT_NE(a, b);
+  EXPECT_NE(a, SharedValue());
+  EXPECT_EQ(SharedValue(), SharedValue(Value()));
+}
+
+}  // namespace base
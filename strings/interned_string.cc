@@ -0,0 +1,137 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/interned_string.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "base/hash.h"
+#include "base/macros.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+
+namespace base {
+
+namespace internal {
+
+const InternedStringEntry kEmptyInternedStringEntry = {"", 0, 0};
+
+}  // namespace internal
+
+namespace {
+
+using internal::InternedStringEntry;
+
+// The table is split into shards, each with its own lock, so that threads
+// interning different strings rarely contend. Each shard is an open
+// addressing hash table of entries, with linear probing.
+class InternedStringTable {
+ public:
+  InternedStringTable() = default;
+
+  static InternedStringTable* GetInstance() {
+    static NoDestructor<InternedStringTable> table;
+    return table.get();
+  }
+
+  // Returns the entry for |str|, which is added if |insert| is true and it
+  // isn't in the table yet.
+  const InternedStringEntry* Lookup(StringPiece str, bool insert) {
+    if (str.empty())
+      return &internal::kEmptyInternedStringEntry;
+
+    const uint64_t hash = Hash64(str.data(), str.size());
+    // The top bits pick the shard, and the bottom ones the slot.
+    Shard& shard = shards_[hash >> (64 - kShardBits)];
+    AutoLock lock(shard.lock);
+    size_t mask = shard.slots.size() - 1;
+    size_t index = static_cast<size_t>(hash);
+    if (!shard.slots.empty()) {
+      for (;; ++index) {
+        const InternedStringEntry* entry = shard.slots[index & mask];
+        if (!entry)
+          break;
+        if (entry->hash == static_cast<size_t>(hash) &&
+            StringPiece(entry->data, entry->length) == str) {
+          return entry;
+        }
+      }
+    }
+    if (!insert)
+      return nullptr;
+
+    // Keeps the load factor at most 1/2.
+    if ((shard.size + 1) * 2 > shard.slots.size()) {
+      Grow(&shard);
+      mask = shard.slots.size() - 1;
+      index = static_cast<size_t>(hash);
+      while (shard.slots[index & mask])
+        ++index;
+    }
+    const InternedStringEntry* entry =
+        NewEntry(str, static_cast<size_t>(hash));
+    shard.slots[index & mask] = entry;
+    ++shard.size;
+    return entry;
+  }
+
+ private:
+  static constexpr int kShardBits = 4;
+
+  struct Shard {
+    Lock lock;
+    // A power of two number of slots, or none.
+    std::vector<const InternedStringEntry*> slots;
+    size_t size = 0;
+  };
+
+  static void Grow(Shard* shard) {
+    std::vector<const InternedStringEntry*> slots(
+        shard->slots.empty() ? 64 : shard->slots.size() * 2);
+    const size_t mask = slots.size() - 1;
+    for (const InternedStringEntry* entry : shard->slots) {
+      if (!entry)
+        continue;
+      size_t index = entry->hash;
+      while (slots[index & mask])
+        ++index;
+      slots[index & mask] = entry;
+    }
+    shard->slots.swap(slots);
+  }
+
+  // Entries are never freed, since handles to them may be anywhere.
+  static const InternedStringEntry* NewEntry(StringPiece str, size_t hash) {
+    char* memory = new char[sizeof(InternedStringEntry) + str.size() + 1];
+    char* data = memory + sizeof(InternedStringEntry);
+    memcpy(data, str.data(), str.size());
+    data[str.size()] = '\0';
+    return new (memory) InternedStringEntry{data, str.size(), hash};
+  }
+
+  Shard shards_[1 << kShardBits];
+
+  DISALLOW_COPY_AND_ASSIGN(InternedStringTable);
+};
+
+}  // namespace
+
+InternedString::InternedString(StringPiece str)
+    : entry_(InternedStringTable::GetInstance()->Lookup(str, true)) {}
+
+// static
+Optional<InternedString> InternedString::Find(StringPiece str) {
+  const InternedStringEntry* entry =
+      InternedStringTable::GetInstance()->Lookup(str, false);
+  if (!entry)
+    return nullopt;
+  return InternedString(entry);
+}
+
+}  // namespace base
@@ -0,0 +1,90 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_STRINGS_INTERNED_STRING_H_
+#define BASE_STRINGS_INTERNED_STRING_H_
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+#include "base/optional.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+
+namespace internal {
+
+// The characters of an interned string, which are NUL-terminated, follow the
+// entry in the same allocation.
+struct InternedStringEntry {
+  const char* data;
+  size_t length;
+  size_t hash;
+};
+
+BASE_EXPORT extern const InternedStringEntry kEmptyInternedStringEntry;
+
+}  // namespace internal
+
+// A handle to a string in a process-wide table, which holds a single copy of
+// each distinct string. Comparing two InternedStrings for equality is a
+// pointer comparison, and their hash is computed once, when the string is
+// interned. This suits strings used over and over as keys, such as category,
+// histogram or feature names. Handles are as cheap to copy as pointers.
+//
+//   InternedString name("Memory.Browser");
+//   if (name == other_name) ...
+//   std::unordered_map<InternedString, int, InternedStringHash> counts;
+//
+// The table is thread-safe. Interned strings are never freed, so only intern
+// strings from bounded sets, not ones derived from untrusted input.
+class BASE_EXPORT InternedString {
+ public:
+  // The empty string, which doesn't need a lookup.
+  InternedString() : entry_(&internal::kEmptyInternedStringEntry) {}
+
+  // Interns |str|, i.e. adds it to the table unless it's already there.
+  explicit InternedString(StringPiece str);
+
+  // Returns the interned string equal to |str| if there is one, without
+  // adding it to the table. Handy to look up keys which can only be present
+  // if they were interned before.
+  static Optional<InternedString> Find(StringPiece str);
+
+  StringPiece value() const {
+    return StringPiece(entry_->data, entry_->length);
+  }
+  const char* c_str() const { return entry_->data; }
+  size_t size() const { return entry_->length; }
+  bool empty() const { return entry_->length == 0; }
+
+  // A hash of the string, which is the same for all the handles to it.
+  size_t hash() const { return entry_->hash; }
+
+  friend bool operator==(InternedString a, InternedString b) {
+    return a.entry_ == b.entry_;
+  }
+  friend bool operator!=(InternedString a, InternedString b) {
+    return a.entry_ != b.entry_;
+  }
+  // Orders by the characters, so that ordered containers of InternedStrings
+  // iterate in the same order in every process.
+  friend bool operator<(InternedString a, InternedString b) {
+    return a.entry_ != b.entry_ && a.value() < b.value();
+  }
+
+ private:
+  explicit InternedString(const internal::InternedStringEntry* entry)
+      : entry_(entry) {}
+
+  const internal::InternedStringEntry* entry_;
+};
+
+struct InternedStringHash {
+  size_t operator()(InternedString str) const { return str.hash(); }
+};
+
+}  // namespace base
+
+#endif  // BASE_STRINGS_INTERNED_STRING_H_
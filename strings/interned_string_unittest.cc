@@ -0,0 +1,115 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/interned_string.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Interns the same strings as the other threads.
+class InternThread : public DelegateSimpleThread::Delegate {
+ public:
+  void Run() override {
+    for (int i = 0; i < 1000; ++i)
+      strings_.push_back(InternedString("thread" + IntToString(i)));
+  }
+
+  const std::vector<InternedString>& strings() const { return strings_; }
+
+ private:
+  std::vector<InternedString> strings_;
+};
+
+}  // namespace
+
+TEST(InternedStringTest, Empty) {
+  InternedString empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(0u, empty.size());
+  EXPECT_EQ("", empty.value());
+  EXPECT_STREQ("", empty.c_str());
+  EXPECT_EQ(empty, InternedString(""));
+  EXPECT_EQ(empty, InternedString(StringPiece()));
+  EXPECT_EQ(empty, InternedString::Find(""));
+}
+
+TEST(InternedStringTest, SameStringSameHandle) {
+  std::string chars = "InternedStringTest.Same";
+  InternedString first(chars);
+  InternedString second(chars.substr());
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(first.hash(), second.hash());
+  EXPECT_EQ(first.c_str(), second.c_str());
+  EXPECT_NE(chars.c_str(), first.c_str());
+  EXPECT_EQ(chars, first.value());
+  EXPECT_STREQ(chars.c_str(), first.c_str());
+
+  InternedString other("InternedStringTest.Other");
+  EXPECT_NE(first, other);
+  EXPECT_FALSE(first < first);
+  EXPECT_TRUE(other < first);
+  EXPECT_FALSE(first < other);
+
+  // Embedded NULs are part of the string.
+  EXPECT_NE(InternedString(StringPiece("a\0b", 3)), InternedString("a"));
+  EXPECT_EQ(3u, InternedString(StringPiece("a\0b", 3)).size());
+}
+
+TEST(InternedStringTest, Find) {
+  EXPECT_FALSE(InternedString::Find("InternedStringTest.Find"));
+  InternedString str("InternedStringTest.Find");
+  EXPECT_EQ(str, InternedString::Find("InternedStringTest.Find"));
+}
+
+TEST(InternedStringTest, ManyStrings) {
+  std::vector<InternedString> strings;
+  std::unordered_set<InternedString, InternedStringHash> set;
+  for (int i = 0; i < 10000; ++i) {
+    strings.push_back(InternedString("many" + IntToString(i)));
+    set.insert(strings.back());
+  }
+  EXPECT_EQ(10000u, set.size());
+  for (int i = 0; i < 10000; ++i) {
+    InternedString str("many" + IntToString(i));
+    EXPECT_EQ(strings[i], str);
+    EXPECT_EQ("many" + IntToString(i), str.value());
+    EXPECT_EQ(1u, set.count(str));
+  }
+
+  std::map<InternedString, int> map;
+  map[InternedString("b")] = 2;
+  map[InternedString("a")] = 1;
+  map[InternedString("c")] = 3;
+  EXPECT_EQ("a", map.begin()->first.value());
+  EXPECT_EQ("c", map.rbegin()->first.value());
+}
+
+TEST(InternedStringTest, Threads) {
+  InternThread delegates[4];
+  std::vector<std::unique_ptr<DelegateSimpleThread>> threads;
+  for (InternThread& delegate : delegates) {
+    threads.push_back(
+        std::make_unique<DelegateSimpleThread>(&delegate, "InternThread"));
+    threads.back()->Start();
+  }
+  for (const auto& thread : threads)
+    thread->Join();
+
+  for (size_t i = 1; i < arraysize(delegates); ++i)
+    EXPECT_EQ(delegates[0].strings(), delegates[i].strings());
+}
+
+}  // namespace base
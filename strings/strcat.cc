@@ -4,6 +4,12 @@
 
 #include "base/strings/strcat.h"
 
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/macros.h"
+
 namespace base {
 
 namespace {
@@ -38,6 +44,49 @@ void StrAppendT(DestString* dest, span<const InputString> pieces) {
 
 }  // namespace
 
+StrCatPiece::StrCatPiece(int value)
+    : piece_(buffer_, NumberToBuffer(value, buffer_)) {}
+
+StrCatPiece::StrCatPiece(unsigned int value)
+    : piece_(buffer_, NumberToBuffer(value, buffer_)) {}
+
+StrCatPiece::StrCatPiece(long value)
+    : piece_(buffer_, NumberToBuffer(value, buffer_)) {}
+
+StrCatPiece::StrCatPiece(unsigned long value)
+    : piece_(buffer_, NumberToBuffer(value, buffer_)) {}
+
+StrCatPiece::StrCatPiece(long long value)
+    : piece_(buffer_, NumberToBuffer(value, buffer_)) {}
+
+StrCatPiece::StrCatPiece(unsigned long long value)
+    : piece_(buffer_, NumberToBuffer(value, buffer_)) {}
+
+StrCatPiece::StrCatPiece(double value)
+    : piece_(buffer_, NumberToBuffer(value, buffer_)) {}
+
+StrCatPiece::StrCatPiece(Hex hex) {
+  // Writes back to front, at least |width| digits.
+  char digits[16];
+  char* end = digits + arraysize(digits);
+  char* begin = end;
+  char* width_begin = end - std::min(std::max(hex.width, 1), 16);
+  uint64_t value = hex.value;
+  do {
+    *--begin = "0123456789abcdef"[value & 0xf];
+    value >>= 4;
+  } while (value || begin > width_begin);
+  memcpy(buffer_, begin, end - begin);
+  piece_ = StringPiece(buffer_, end - begin);
+}
+
+StrCatPiece::StrCatPiece(const StrCatPiece& other) : piece_(other.piece_) {
+  if (other.piece_.data() == other.buffer_) {
+    memcpy(buffer_, other.buffer_, other.piece_.size());
+    piece_ = StringPiece(buffer_, other.piece_.size());
+  }
+}
+
 std::string StrCat(span<const StringPiece> pieces) {
   std::string result;
   StrAppendT(&result, pieces);
@@ -62,6 +111,12 @@ string16 StrCat(span<const string16> pieces) {
   return result;
 }
 
+std::string StrCat(span<const StrCatPiece> pieces) {
+  std::string result;
+  StrAppendT(&result, pieces);
+  return result;
+}
+
 void StrAppend(std::string* dest, span<const StringPiece> pieces) {
   StrAppendT(dest, pieces);
 }
@@ -78,4 +133,8 @@ void StrAppend(string16* dest, span<const string16> pieces) {
   StrAppendT(dest, pieces);
 }
 
+void StrAppend(std::string* dest, span<const StrCatPiece> pieces) {
+  StrAppendT(dest, pieces);
+}
+
 }  // namespace base
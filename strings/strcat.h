@@ -5,11 +5,16 @@
 #ifndef BASE_STRINGS_STRCAT_H_
 #define BASE_STRINGS_STRCAT_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <initializer_list>
+#include <string>
 
 #include "base/base_export.h"
 #include "base/compiler_specific.h"
 #include "base/containers/span.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_piece.h"
 #include "build/build_config.h"
 
@@ -28,6 +33,11 @@ namespace base {
 //
 //   std::string result = base::StrCat({"foo ", result, "\nfoo ", bar});
 //
+// The 8-bit version also accepts numbers, which are formatted the way
+// NumberToString() formats them, and Hex() values:
+//
+//   std::string key = base::StrCat({"frame.", id, ".", Hex(address)});
+//
 // To join an array of strings with a separator, see base::JoinString in
 // base/strings/string_util.h.
 //
@@ -50,21 +60,63 @@ namespace base {
 // Abseil's StrCat also allows numbers by using an intermediate class that can
 // be implicitly constructed from either a string or various number types. This
 // class formats the numbers into a static buffer for increased performance,
-// and the call sites look nice.
-//
-// As-written Abseil's helper class for numbers generates slightly more code
-// than the raw StringPiece version. We can de-inline the helper class'
-// constructors which will cause the StringPiece constructors to be de-inlined
-// for this call and generate slightly less code. This is something we can
-// explore more in the future.
+// and the call sites look nice. StrCatPiece below is that class. Its number
+// constructors are de-inlined, so that call sites which only concatenate
+// strings stay as small as with raw StringPieces.
+
+// Formats |value| in lower case hexadecimal for StrCat() and StrAppend(),
+// padded with leading zeros to at least |width| digits. |width| is clamped to
+// [1, 16].
+struct Hex {
+  explicit Hex(uint64_t value, int width = 1) : value(value), width(width) {}
+
+  uint64_t value;
+  int width;
+};
+
+// An argument of the 8-bit StrCat() and StrAppend(): a string, or a number
+// formatted into a buffer at the start of the piece. Only meant to be
+// implicitly constructed in their argument lists, since it may point into the
+// strings it was constructed from.
+class BASE_EXPORT StrCatPiece {
+ public:
+  StrCatPiece(const char* str) : piece_(str) {}  // NOLINT(runtime/explicit)
+  StrCatPiece(const std::string& str)  // NOLINT(runtime/explicit)
+      : piece_(str) {}
+  StrCatPiece(StringPiece piece) : piece_(piece) {}  // NOLINT(runtime/explicit)
+
+  StrCatPiece(int value);                 // NOLINT(runtime/explicit)
+  StrCatPiece(unsigned int value);        // NOLINT(runtime/explicit)
+  StrCatPiece(long value);                // NOLINT(runtime/explicit)
+  StrCatPiece(unsigned long value);       // NOLINT(runtime/explicit)
+  StrCatPiece(long long value);           // NOLINT(runtime/explicit)
+  StrCatPiece(unsigned long long value);  // NOLINT(runtime/explicit)
+  StrCatPiece(double value);              // NOLINT(runtime/explicit)
+  StrCatPiece(Hex hex);                   // NOLINT(runtime/explicit)
+
+  // A char would otherwise be formatted as a number. Use StringPiece(&c, 1).
+  StrCatPiece(char) = delete;
+
+  // Copies point to their own copy of a formatted number.
+  StrCatPiece(const StrCatPiece& other);
+  StrCatPiece& operator=(const StrCatPiece&) = delete;
+
+  const char* data() const { return piece_.data(); }
+  size_t size() const { return piece_.size(); }
+
+ private:
+  StringPiece piece_;
+  char buffer_[kMaxNumberToBufferLength];
+};
 
 BASE_EXPORT std::string StrCat(span<const StringPiece> pieces);
 BASE_EXPORT string16 StrCat(span<const StringPiece16> pieces);
 BASE_EXPORT std::string StrCat(span<const std::string> pieces);
 BASE_EXPORT string16 StrCat(span<const string16> pieces);
+BASE_EXPORT std::string StrCat(span<const StrCatPiece> pieces);
 
 // Initializer list forwards to the array version.
-inline std::string StrCat(std::initializer_list<StringPiece> pieces) {
+inline std::string StrCat(std::initializer_list<StrCatPiece> pieces) {
   return StrCat(make_span(pieces.begin(), pieces.size()));
 }
 inline string16 StrCat(std::initializer_list<StringPiece16> pieces) {
@@ -83,10 +135,11 @@ BASE_EXPORT void StrAppend(std::string* dest, span<const StringPiece> pieces);
 BASE_EXPORT void StrAppend(string16* dest, span<const StringPiece16> pieces);
 BASE_EXPORT void StrAppend(std::string* dest, span<const std::string> pieces);
 BASE_EXPORT void StrAppend(string16* dest, span<const string16> pieces);
+BASE_EXPORT void StrAppend(std::string* dest, span<const StrCatPiece> pieces);
 
 // Initializer list forwards to the array version.
 inline void StrAppend(std::string* dest,
-                      std::initializer_list<StringPiece> pieces) {
+                      std::initializer_list<StrCatPiece> pieces) {
   return StrAppend(dest, make_span(pieces.begin(), pieces.size()));
 }
 inline void StrAppend(string16* dest,
@@ -3,6 +3,15 @@
 // found in the LICENSE file.
 
 #include "base/strings/strcat.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -17,6 +26,37 @@ TEST(StrCat, 8Bit) {
   EXPECT_EQ("122333444455555", StrCat({"1", "22", "333", "4444", "55555"}));
 }
 
+TEST(StrCat, Numbers) {
+  int zero = 0;
+  EXPECT_EQ("0", StrCat({zero}));
+  EXPECT_EQ("-2147483648", StrCat({std::numeric_limits<int>::min()}));
+  EXPECT_EQ("18446744073709551615",
+            StrCat({std::numeric_limits<uint64_t>::max()}));
+  EXPECT_EQ("1.5e+300", StrCat({1.5e300}));
+  EXPECT_EQ("key.42.-7.2.5", StrCat({"key.", 42u, ".", -7L, ".", 2.5f}));
+
+  std::string str = "str";
+  EXPECT_EQ("str12str", StrCat({str, size_t{12}, StringPiece(str)}));
+
+  for (int i = -1000; i <= 1000; i += 13)
+    EXPECT_EQ(NumberToString(i / 3.0), StrCat({i / 3.0}));
+
+  // Copies don't point into the original's buffer.
+  std::unique_ptr<StrCatPiece> piece = std::make_unique<StrCatPiece>(123);
+  StrCatPiece copy = *piece;
+  piece.reset();
+  EXPECT_EQ("123", StringPiece(copy.data(), copy.size()));
+}
+
+TEST(StrCat, Hex) {
+  EXPECT_EQ("0", StrCat({Hex(0)}));
+  EXPECT_EQ("0x1f", StrCat({"0x", Hex(31)}));
+  EXPECT_EQ("ffffffffffffffff", StrCat({Hex(-1)}));
+  EXPECT_EQ("0000abcd", StrCat({Hex(0xabcd, 8)}));
+  EXPECT_EQ("123456789", StrCat({Hex(0x123456789, 4)}));
+  EXPECT_EQ("0000000000000001", StrCat({Hex(1, 100)}));
+}
+
 TEST(StrCat, 16Bit) {
   string16 arg1 = ASCIIToUTF16("1");
   string16 arg2 = ASCIIToUTF16("22");
@@ -42,6 +82,10 @@ TEST(StrAppend, 8Bit) {
   result = "foo";
   StrAppend(&result, {"1", "22", "333"});
   EXPECT_EQ("foo122333", result);
+
+  result = "foo";
+  StrAppend(&result, {1, "22", 333, Hex(0x4444)});
+  EXPECT_EQ("foo1223334444", result);
 }
 
 TEST(StrAppend, 16Bit) {
@@ -7,14 +7,17 @@
 #include <ctype.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <wctype.h>
 
 #include <limits>
 #include <type_traits>
 
 #include "base/logging.h"
+#include "base/macros.h"
 #include "base/numerics/safe_math.h"
 #include "base/scoped_clear_errno.h"
+#include "base/strings/string_number_conversions_internal.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/third_party/dmg_fp/dmg_fp.h"
 
@@ -22,41 +25,51 @@ namespace base {
 
 namespace {
 
+// log10(2) ~= 0.3 bytes needed per bit or per byte log10(2**8) ~= 2.4.
+// So round up to allocate 3 output characters per byte, plus 1 for '-'.
+template <typename INT>
+constexpr size_t IntToStringBufferSize() {
+  return 3 * sizeof(INT) + std::numeric_limits<INT>::is_signed;
+}
+
+// Writes |value| to the characters ending before |end|, back to front, and
+// returns a pointer to the first one.
+template <typename CHR, typename INT>
+CHR* FormatIntBackward(INT value, CHR* end) {
+  // The ValueOrDie call below can never fail, because UnsignedAbs is valid
+  // for all valid inputs.
+  typename std::make_unsigned<INT>::type res =
+      CheckedNumeric<INT>(value).UnsignedAbs().ValueOrDie();
+
+  CHR* i = internal::FormatDecimalBackward(res, end);
+  if (IsValueNegative(value))
+    *--i = static_cast<CHR>('-');
+  return i;
+}
+
 template <typename STR, typename INT>
 struct IntToStringT {
   static STR IntToString(INT value) {
-    // log10(2) ~= 0.3 bytes needed per bit or per byte log10(2**8) ~= 2.4.
-    // So round up to allocate 3 output characters per byte, plus 1 for '-'.
-    const size_t kOutputBufSize =
-        3 * sizeof(INT) + std::numeric_limits<INT>::is_signed;
-
     // Create the string in a temporary buffer, write it back to front, and
     // then return the substr of what we ended up using.
     using CHR = typename STR::value_type;
-    CHR outbuf[kOutputBufSize];
-
-    // The ValueOrDie call below can never fail, because UnsignedAbs is valid
-    // for all valid inputs.
-    typename std::make_unsigned<INT>::type res =
-        CheckedNumeric<INT>(value).UnsignedAbs().ValueOrDie();
-
-    CHR* end = outbuf + kOutputBufSize;
-    CHR* i = end;
-    do {
-      --i;
-      DCHECK(i != outbuf);
-      *i = static_cast<CHR>((res % 10) + '0');
-      res /= 10;
-    } while (res != 0);
-    if (IsValueNegative(value)) {
-      --i;
-      DCHECK(i != outbuf);
-      *i = static_cast<CHR>('-');
-    }
-    return STR(i, end);
+    CHR outbuf[IntToStringBufferSize<INT>()];
+    CHR* end = outbuf + arraysize(outbuf);
+    return STR(FormatIntBackward(value, end), end);
   }
 };
 
+template <typename INT>
+size_t IntToBuffer(INT value, span<char> buffer) {
+  char outbuf[IntToStringBufferSize<INT>()];
+  char* end = outbuf + arraysize(outbuf);
+  char* begin = FormatIntBackward(value, end);
+  size_t length = end - begin;
+  CHECK_GE(buffer.size(), length);
+  memcpy(buffer.data(), begin, length);
+  return length;
+}
+
 // Utility to convert a character to a digit in a given base
 template<typename CHAR, int BASE, bool BASE_LTE_10> class BaseCharToDigit {
 };
@@ -361,20 +374,49 @@ string16 NumberToString16(unsigned long long value) {
 }
 
 std::string NumberToString(double value) {
-  // According to g_fmt.cc, it is sufficient to declare a buffer of size 32.
-  char buffer[32];
-  dmg_fp::g_fmt(buffer, value);
-  return std::string(buffer);
+  char buffer[internal::kDoubleToStringBufferSize];
+  return std::string(buffer, internal::DoubleToShortestString(value, buffer));
 }
 
 base::string16 NumberToString16(double value) {
-  // According to g_fmt.cc, it is sufficient to declare a buffer of size 32.
-  char buffer[32];
-  dmg_fp::g_fmt(buffer, value);
+  char buffer[internal::kDoubleToStringBufferSize];
+  size_t length = internal::DoubleToShortestString(value, buffer);
 
   // The number will be ASCII. This creates the string using the "input
   // iterator" variant which promotes from 8-bit to 16-bit via "=".
-  return base::string16(&buffer[0], &buffer[strlen(buffer)]);
+  return base::string16(&buffer[0], &buffer[length]);
+}
+
+size_t NumberToBuffer(int value, span<char> buffer) {
+  return IntToBuffer(value, buffer);
+}
+
+size_t NumberToBuffer(unsigned int value, span<char> buffer) {
+  return IntToBuffer(value, buffer);
+}
+
+size_t NumberToBuffer(long value, span<char> buffer) {
+  return IntToBuffer(value, buffer);
+}
+
+size_t NumberToBuffer(unsigned long value, span<char> buffer) {
+  return IntToBuffer(value, buffer);
+}
+
+size_t NumberToBuffer(long long value, span<char> buffer) {
+  return IntToBuffer(value, buffer);
+}
+
+size_t NumberToBuffer(unsigned long long value, span<char> buffer) {
+  return IntToBuffer(value, buffer);
+}
+
+size_t NumberToBuffer(double value, span<char> buffer) {
+  char outbuf[internal::kDoubleToStringBufferSize];
+  size_t length = internal::DoubleToShortestString(value, outbuf);
+  CHECK_GE(buffer.size(), length);
+  memcpy(buffer.data(), outbuf, length);
+  return length;
 }
 
 bool StringToInt(StringPiece input, int* output) {
@@ -417,12 +459,20 @@ bool StringToSizeT(StringPiece16 input, size_t* output) {
   return String16ToIntImpl(input, output);
 }
 
-bool StringToDouble(const std::string& input, double* output) {
+bool StringToDouble(StringPiece input, double* output) {
+  // Most numbers can be converted exactly without dmg_fp's arbitrary precision
+  // arithmetic. The fast path doesn't accept leading whitespace or trailing
+  // characters, and never overflows or underflows.
+  if (internal::FastStringToDouble(input, output))
+    return true;
+
   // Thread-safe?  It is on at least Mac, Linux, and Windows.
   ScopedClearErrno clear_errno;
 
+  // dmg_fp::strtod() needs a NUL-terminated string.
+  std::string input_string = input.as_string();
   char* endptr = nullptr;
-  *output = dmg_fp::strtod(input.c_str(), &endptr);
+  *output = dmg_fp::strtod(input_string.c_str(), &endptr);
 
   // Cases to return false:
   //  - If errno is ERANGE, there was an overflow or underflow.
@@ -434,9 +484,9 @@ bool StringToDouble(const std::string& input, double* output) {
   //    where the string contains embedded NUL characters.
   //  - If the first character is a space, there was leading whitespace
   return errno == 0 &&
-         !input.empty() &&
-         input.c_str() + input.length() == endptr &&
-         !isspace(input[0]);
+         !input_string.empty() &&
+         input_string.c_str() + input_string.length() == endptr &&
+         !isspace(input_string[0]);
 }
 
 // Note: if you need to add String16ToDouble, first ask yourself if it's
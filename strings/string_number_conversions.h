@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "base/base_export.h"
+#include "base/containers/span.h"
 #include "base/strings/string16.h"
 #include "base/strings/string_piece.h"
 #include "build/build_config.h"
@@ -56,6 +57,20 @@ BASE_EXPORT string16 NumberToString16(unsigned long long value);
 BASE_EXPORT std::string NumberToString(double value);
 BASE_EXPORT string16 NumberToString16(double value);
 
+// Variants of NumberToString() which write to |buffer| instead of allocating a
+// string. They write the same characters, without a terminating NUL, to the
+// start of |buffer| and return how many were written. |buffer| must be large
+// enough, which kMaxNumberToBufferLength characters always are.
+constexpr size_t kMaxNumberToBufferLength = 32;
+BASE_EXPORT size_t NumberToBuffer(int value, span<char> buffer);
+BASE_EXPORT size_t NumberToBuffer(unsigned int value, span<char> buffer);
+BASE_EXPORT size_t NumberToBuffer(long value, span<char> buffer);
+BASE_EXPORT size_t NumberToBuffer(unsigned long value, span<char> buffer);
+BASE_EXPORT size_t NumberToBuffer(long long value, span<char> buffer);
+BASE_EXPORT size_t NumberToBuffer(unsigned long long value,
+                                  span<char> buffer);
+BASE_EXPORT size_t NumberToBuffer(double value, span<char> buffer);
+
 // Type-specific naming for backwards compatibility.
 //
 // TODO(brettw) these should be removed and callers converted to the overloaded
@@ -120,7 +135,7 @@ BASE_EXPORT bool StringToSizeT(StringPiece16 input, size_t* output);
 // If your input is locale specific, use ICU to read the number.
 // WARNING: Will write to |output| even when returning false.
 //          Read the comments here and above StringToInt() carefully.
-BASE_EXPORT bool StringToDouble(const std::string& input, double* output);
+BASE_EXPORT bool StringToDouble(StringPiece input, double* output);
 
 // Hex encoding ----------------------------------------------------------------
 
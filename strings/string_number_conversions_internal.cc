@@ -0,0 +1,1820 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/string_number_conversions_internal.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "base/bits.h"
+#include "base/logging.h"
+#include "base/macros.h"
+
+namespace base {
+namespace internal {
+
+const char kDecimalDigitPairs[200] = {
+    '0', '0', '0', '1', '0', '2', '0', '3', '0', '4', '0', '5', '0', '6', '0',
+    '7', '0', '8', '0', '9', '1', '0', '1', '1', '1', '2', '1', '3', '1', '4',
+    '1', '5', '1', '6', '1', '7', '1', '8', '1', '9', '2', '0', '2', '1', '2',
+    '2', '2', '3', '2', '4', '2', '5', '2', '6', '2', '7', '2', '8', '2', '9',
+    '3', '0', '3', '1', '3', '2', '3', '3', '3', '4', '3', '5', '3', '6', '3',
+    '7', '3', '8', '3', '9', '4', '0', '4', '1', '4', '2', '4', '3', '4', '4',
+    '4', '5', '4', '6', '4', '7', '4', '8', '4', '9', '5', '0', '5', '1', '5',
+    '2', '5', '3', '5', '4', '5', '5', '5', '6', '5', '7', '5', '8', '5', '9',
+    '6', '0', '6', '1', '6', '2', '6', '3', '6', '4', '6', '5', '6', '6', '6',
+    '7', '6', '8', '6', '9', '7', '0', '7', '1', '7', '2', '7', '3', '7', '4',
+    '7', '5', '7', '6', '7', '7', '7', '8', '7', '9', '8', '0', '8', '1', '8',
+    '2', '8', '3', '8', '4', '8', '5', '8', '6', '8', '7', '8', '8', '8', '9',
+    '9', '0', '9', '1', '9', '2', '9', '3', '9', '4', '9', '5', '9', '6', '9',
+    '7', '9', '8', '9', '9'};
+
+namespace {
+
+const int kMantissaBits = 52;
+const int kExponentBias = 1023;
+const uint64_t kMantissaMask = (uint64_t{1} << kMantissaBits) - 1;
+const uint32_t kExponentMask = 0x7ff;
+
+struct UInt128 {
+  uint64_t high;
+  uint64_t low;
+};
+
+// The tables below were generated with Python's arbitrary precision integers.
+// pow5bits(i) is ((i * 1217359) >> 19) + 1, which is the bit length of 5^i.
+
+// kPow5InvSplit[i] is 2^(pow5bits(i) + 124) / 5^i + 1, rounded down, for the
+// powers of ten needed by doubles with non-negative binary exponents.
+const int kPow5InvBitCount = 125;
+const UInt128 kPow5InvSplit[291] = {
+    {0x2000000000000000ULL, 0x0000000000000001ULL},
+    {0x1999999999999999ULL, 0x999999999999999aULL},
+    {0x147ae147ae147ae1ULL, 0x47ae147ae147ae15ULL},
+    {0x10624dd2f1a9fbe7ULL, 0x6c8b4395810624deULL},
+    {0x1a36e2eb1c432ca5ULL, 0x7a786c226809d496ULL},
+    {0x14f8b588e368f084ULL, 0x61f9f01b866e43abULL},
+    {0x10c6f7a0b5ed8d36ULL, 0xb4c7f34938583622ULL},
+    {0x1ad7f29abcaf4857ULL, 0x87a6520ec08d236aULL},
+    {0x15798ee2308c39dfULL, 0x9fb841a566d74f88ULL},
+    {0x112e0be826d694b2ULL, 0xe62d01511f12a607ULL},
+    {0x1b7cdfd9d7bdbab7ULL, 0xd6ae6881cb5109a4ULL},
+    {0x15fd7fe17964955fULL, 0xdef1ed34a2a73aeaULL},
+    {0x119799812dea1119ULL, 0x7f27f0f6e885c8bbULL},
+    {0x1c25c268497681c2ULL, 0x650cb4be40d60df8ULL},
+    {0x16849b86a12b9b01ULL, 0xea70909833de7193ULL},
+    {0x1203af9ee756159bULL, 0x21f3a6e0297ec143ULL},
+    {0x1cd2b297d889bc2bULL, 0x6985d7cd0f313537ULL},
+    {0x170ef54646d49689ULL, 0x2137dfd73f5a90f9ULL},
+    {0x12725dd1d243aba0ULL, 0xe75fe645cc4873faULL},
+    {0x1d83c94fb6d2ac34ULL, 0xa5663d3c7a0d865dULL},
+    {0x179ca10c9242235dULL, 0x511e976394d79eb1ULL},
+    {0x12e3b40a0e9b4f7dULL, 0xda7edf82dd794bc1ULL},
+    {0x1e392010175ee596ULL, 0x2a6498d1625bac68ULL},
+    {0x182db34012b25144ULL, 0xeeb6e0a781e2f053ULL},
+    {0x1357c299a88ea76aULL, 0x58924d52ce4f26a9ULL},
+    {0x1ef2d0f5da7dd8aaULL, 0x27507bb7b07ea441ULL},
+    {0x18c240c4aecb13bbULL, 0x52a6c95fc0655034ULL},
+    {0x13ce9a36f23c0fc9ULL, 0x0eebd44c99eaa690ULL},
+    {0x1fb0f6be50601941ULL, 0xb17953adc3110a80ULL},
+    {0x195a5efea6b34767ULL, 0xc12ddc8b02740867ULL},
+    {0x14484bfeebc29f86ULL, 0x3424b06f3529a052ULL},
+    {0x1039d66589687f9eULL, 0x901d59f290ee19dbULL},
+    {0x19f623d5a8a73297ULL, 0x4cfbc31db4b0295fULL},
+    {0x14c4e977ba1f5bacULL, 0x3d9635b15d59bab2ULL},
+    {0x109d8792fb4c4956ULL, 0x97ab5e277de16228ULL},
+    {0x1a95a5b7f87a0ef0ULL, 0xf2abc9d8c9689d0dULL},
+    {0x154484932d2e725aULL, 0x5bbca17a3aba173eULL},
+    {0x11039d428a8b8eaeULL, 0xafca1ac82efb45cbULL},
+    {0x1b38fb9daa78e44aULL, 0xb2dcf7a6b1920945ULL},
+    {0x15c72fb1552d836eULL, 0xf57d92ebc141a104ULL},
+    {0x116c262777579c58ULL, 0xc46475896767b403ULL},
+    {0x1be03d0bf225c6f4ULL, 0x6d6d88dbd8a5ecd2ULL},
+    {0x164cfda3281e38c3ULL, 0x8abe071646eb23dbULL},
+    {0x11d7314f534b609cULL, 0x6efe6c11d255b649ULL},
+    {0x1c8b821885456760ULL, 0xb197134fb6ef8a0eULL},
+    {0x16d601ad376ab91aULL, 0x27ac0f72f8bfa1a5ULL},
+    {0x1244ce242c5560e1ULL, 0xb95672c260994e1eULL},
+    {0x1d3ae36d13bbce35ULL, 0xf5571e03cdc21695ULL},
+    {0x17624f8a762fd82bULL, 0x2aac18030b01ababULL},
+    {0x12b50c6ec4f31355ULL, 0xbbbce0026f348956ULL},
+    {0x1dee7a4ad4b81eefULL, 0x92c7ccd0b1eda889ULL},
+    {0x17f1fb6f10934bf2ULL, 0xdbd30a408e57ba07ULL},
+    {0x1327fc58da0f6ff5ULL, 0x7ca8d50071dfc806ULL},
+    {0x1ea6608e29b24cbbULL, 0xfaa7bb33e9660cd6ULL},
+    {0x18851a0b548ea3c9ULL, 0x9552fc298784d711ULL},
+    {0x139dae6f76d88307ULL, 0xaaa8c9bad2d0ac0eULL},
+    {0x1f62b0b257c0d1a5ULL, 0xdddadc5e1e1aace3ULL},
+    {0x191bc08eac9a4151ULL, 0x7e48b04b4b488a4fULL},
+    {0x141633a556e1cddaULL, 0xcb6d59d5d5d3a1d9ULL},
+    {0x1011c2eaabe7d7e2ULL, 0x3c577b1177dc817bULL},
+    {0x19b604aaaca62636ULL, 0xc6f25e825960cf2aULL},
+    {0x14919d5556eb51c5ULL, 0x6bf518684780a5bbULL},
+    {0x10747ddddf22a7d1ULL, 0x232a79ed06008496ULL},
+    {0x1a53fc9631d10c81ULL, 0xd1dd8fe1a3340756ULL},
+    {0x150ffd44f4a73d34ULL, 0xa7e4731ae8f66c45ULL},
+    {0x10d9976a5d52975dULL, 0x531d28e253f8569eULL},
+    {0x1af5bf109550f22eULL, 0xeb61db03b98d5762ULL},
+    {0x159165a6ddda5b58ULL, 0xbc4e48cfc7a445e8ULL},
+    {0x11411e1f17e1e2adULL, 0x6371d3d96c836b20ULL},
+    {0x1b9b6364f3030448ULL, 0x9f1c8628ad9f11cdULL},
+    {0x1615e91d8f359d06ULL, 0xe5b06b53be18db0bULL},
+    {0x11ab20e472914a6bULL, 0xeaf3890fcb4715a2ULL},
+    {0x1c45016d841baa46ULL, 0x44b8db4c7871bc37ULL},
+    {0x169d9abe03495505ULL, 0x03c715d6c6c1635fULL},
+    {0x1217aefe69077737ULL, 0x3638de456bcde919ULL},
+    {0x1cf2b1970e725858ULL, 0x56c163a2461641c1ULL},
+    {0x17288e1271f51379ULL, 0xdf011c81d1ab67ceULL},
+    {0x1286d80ec190dc61ULL, 0x7f3416ce4155eca5ULL},
+    {0x1da48ce468e7c702ULL, 0x6520247d3556476eULL},
+    {0x17b6d71d20b96c01ULL, 0xea801d30f7783925ULL},
+    {0x12f8ac174d612334ULL, 0xbb99b0f3f92cfa84ULL},
+    {0x1e5aacf215683854ULL, 0x5f5c4e532847f739ULL},
+    {0x18488a5b44536043ULL, 0x7f7d0b75b9d32c2eULL},
+    {0x136d3b7c36a919cfULL, 0x9930d5f7c7dc2358ULL},
+    {0x1f152bf9f10e8fb2ULL, 0x8eb4898c72f9d226ULL},
+    {0x18ddbcc7f40ba628ULL, 0x722a07a38f2e41b8ULL},
+    {0x13e497065cd61e86ULL, 0xc1bb394fa5be9afaULL},
+    {0x1fd424d6faf030d7ULL, 0x9c5ec2190930f7f6ULL},
+    {0x197683df2f268d79ULL, 0x49e56814075a5ff8ULL},
+    {0x145ecfe5bf520ac7ULL, 0x6e51201005e1e660ULL},
+    {0x104bd984990e6f05ULL, 0xf1da800cd181851aULL},
+    {0x1a12f5a0f4e3e4d6ULL, 0x4fc400148268d4f5ULL},
+    {0x14dbf7b3f71cb711ULL, 0xd96999aa01ed772bULL},
+    {0x10aff95cc5b09274ULL, 0xadee1488018ac5bcULL},
+    {0x1ab328946f80ea54ULL, 0x497ceda668de092cULL},
+    {0x155c2076bf9a5510ULL, 0x3aca57b853e4d424ULL},
+    {0x1116805effaeaa73ULL, 0x623b7960431d7683ULL},
+    {0x1b5733cb32b110b8ULL, 0x9d2bf566d1c8bd9eULL},
+    {0x15df5ca28ef40d60ULL, 0x7dbcc452416d647fULL},
+    {0x117f7d4ed8c33de6ULL, 0xcafd69db678ab6ccULL},
+    {0x1bff2ee48e052fd7ULL, 0xab2f0fc572778adfULL},
+    {0x1665bf1d3e6a8cacULL, 0x88f273045b92d580ULL},
+    {0x11eaff4a98553d56ULL, 0xd3f528d049424466ULL},
+    {0x1cab3210f3bb9557ULL, 0xb988414d4203a0a3ULL},
+    {0x16ef5b40c2fc7779ULL, 0x6139cdd76802e6e9ULL},
+    {0x125915cd68c9f92dULL, 0xe761717920025254ULL},
+    {0x1d5b561574765b7cULL, 0xa568b58e999d5086ULL},
+    {0x177c44ddf6c515fdULL, 0x5120913ee14aa6d2ULL},
+    {0x12c9d0b1923744caULL, 0xa74d40ff1aa21f0eULL},
+    {0x1e0fb44f50586e11ULL, 0x0baece64f769cb4aULL},
+    {0x180c903f7379f1a7ULL, 0x3c8bd850c5ee3c3bULL},
+    {0x133d4032c2c7f485ULL, 0xca0979da37f1c9c9ULL},
+    {0x1ec866b79e0cba6fULL, 0xa9a8c2f6bfe942dbULL},
+    {0x18a0522c7e709526ULL, 0x2153cf2bccba9be3ULL},
+    {0x13b374f06526ddb8ULL, 0x1aa9728970954982ULL},
+    {0x1f8587e7083e2f8cULL, 0xf775840f1a88759dULL},
+    {0x19379fec0698260aULL, 0x5f9136727ba05e17ULL},
+    {0x142c7ff0054684d5ULL, 0x1940f85b9619e4dfULL},
+    {0x1023998cd1053710ULL, 0xe100c6afab47ea4cULL},
+    {0x19d28f47b4d524e7ULL, 0xce67a44c453fdd47ULL},
+    {0x14a8729fc3ddb71fULL, 0xd852e9d69dccb106ULL},
+    {0x1086c219697e2c19ULL, 0x79dbee454b0a2738ULL},
+    {0x1a71368f0f30468fULL, 0x295fe3a211a9d859ULL},
+    {0x15275ed8d8f36ba5ULL, 0xbab31c81a7bb137aULL},
+    {0x10ec4be0ad8f8951ULL, 0x6228e39aec95a92fULL},
+    {0x1b13ac9aaf4c0ee8ULL, 0x9d0e38f7e0ef7517ULL},
+    {0x15a956e225d67253ULL, 0xb0d82d931a592a79ULL},
+    {0x11544581b7dec1dcULL, 0x8d79be0f4847552eULL},
+    {0x1bba08cf8c979c94ULL, 0x158f967eda0bbb7cULL},
+    {0x162e6d72d6dfb076ULL, 0x77a611ff14d62f97ULL},
+    {0x11bebdf578b2f391ULL, 0xf951a7ff43de8c79ULL},
+    {0x1c6463225ab7ec1cULL, 0xc21c3ffed2fdad8eULL},
+    {0x16b6b5b5155ff017ULL, 0x01b0333242648ad8ULL},
+    {0x122bc490dde659acULL, 0x0159c28e9b83a246ULL},
+    {0x1d12d41afca3c2acULL, 0xcef604175f3903a3ULL},
+    {0x17424348ca1c9bbdULL, 0x725e69ac4c2d9c83ULL},
+    {0x129b69070816e2fdULL, 0xf5185489d68ae39cULL},
+    {0x1dc574d80cf16b2fULL, 0xee8d540fbdab05c6ULL},
+    {0x17d12a4670c1228cULL, 0xbed77672fe226b05ULL},
+    {0x130dbb6b8d674ed6ULL, 0xff12c528cb4ebc04ULL},
+    {0x1e7c5f127bd87e24ULL, 0xcb513b74787df9a0ULL},
+    {0x18637f41fcad31b7ULL, 0x090dc929f9fe614dULL},
+    {0x1382cc34ca2427c5ULL, 0xa0d7d42194cb810aULL},
+    {0x1f37ad21436d0c6fULL, 0x67bfb9cf5478ce77ULL},
+    {0x18f9574dcf8a7059ULL, 0x1fcc94a5dd2d71f9ULL},
+    {0x13faac3e3fa1f37aULL, 0x7fd6dd517dbdf4c7ULL},
+    {0x1ff779fd329cb8c3ULL, 0xffbe2ee8c92fee0bULL},
+    {0x1992c7fdc216fa36ULL, 0x6631bf20a0f324d6ULL},
+    {0x14756ccb01abfb5eULL, 0xb827cc1a1a5c1d78ULL},
+    {0x105df0a267bcc918ULL, 0x935309ae7b7ce460ULL},
+    {0x1a2fe76a3f9474f4ULL, 0x1eeb42b0c594a099ULL},
+    {0x14f31f8832dd2a5cULL, 0xe58902270476e6e1ULL},
+    {0x10c27fa028b0eeb0ULL, 0xb7a0ce859d2bebe7ULL},
+    {0x1ad0cc33744e4ab4ULL, 0x59014a6f61dfdfd8ULL},
+    {0x1573d68f903ea229ULL, 0xe0cdd525e7e64cadULL},
+    {0x11297872d9cbb4eeULL, 0x4d7177518651d6f1ULL},
+    {0x1b758d848fac54b0ULL, 0x7be8bee8d6e957e8ULL},
+    {0x15f7a46a0c89dd59ULL, 0xfcba3253df211320ULL},
+    {0x1192e9ee706e4aaeULL, 0x63c8284318e74280ULL},
+    {0x1c1e43171a4a1117ULL, 0x060d0d3827d86a66ULL},
+    {0x167e9c127b6e7412ULL, 0x6b3da42cecad21ebULL},
+    {0x11fee341fc585cdbULL, 0x88fe1cf0bd574e56ULL},
+    {0x1ccb0536608d615fULL, 0x419694b462254a23ULL},
+    {0x1708d0f84d3de77fULL, 0x67abaa29e81dd4e9ULL},
+    {0x126d73f9d764b932ULL, 0xb95621bb2017dd87ULL},
+    {0x1d7becc2f23ac1eaULL, 0xc223692b668c95a5ULL},
+    {0x179657025b6234bbULL, 0xce82ba891ed6de1dULL},
+    {0x12deac01e2b4f6fcULL, 0xa53562074bdf1818ULL},
+    {0x1e3113363787f194ULL, 0x3b889cd87964f359ULL},
+    {0x18274291c6065adcULL, 0xfc6d4a46c783f5e1ULL},
+    {0x13529ba7d19eaf17ULL, 0x30576e9f06032b1aULL},
+    {0x1eea92a61c311825ULL, 0x1a257dcb3cd1de90ULL},
+    {0x18bba884e35a79b7ULL, 0x481dfe3c30a7e540ULL},
+    {0x13c9539d82aec7c5ULL, 0xd34b31c9c0865100ULL},
+    {0x1fa885c8d117a609ULL, 0x5211e942cda3b4cdULL},
+    {0x19539e3a40dfb807ULL, 0x74db21023e1c90a4ULL},
+    {0x1442e4fb67196005ULL, 0xf715b401cb4a0d50ULL},
+    {0x103583fc527ab337ULL, 0xf8de299b09080aa7ULL},
+    {0x19ef3993b72ab859ULL, 0x8e304291a80cddd7ULL},
+    {0x14bf6142f8eef9e1ULL, 0x3e8d020e200a4b13ULL},
+    {0x10991a9bfa58c7e7ULL, 0x653d9b3e80083c0fULL},
+    {0x1a8e90f9908e0ca5ULL, 0x6ec8f864000d2ce4ULL},
+    {0x153eda614071a3b7ULL, 0x8bd3f9e999a423eaULL},
+    {0x10ff151a99f482f9ULL, 0x3ca994bae1501cbbULL},
+    {0x1b31bb5dc320d18eULL, 0xc775bac49bb3612bULL},
+    {0x15c162b168e70e0bULL, 0xd2c4956a16291a89ULL},
+    {0x11678227871f3e6fULL, 0xdbd0778811ba7ba1ULL},
+    {0x1bd8d03f3e9863e6ULL, 0x2c80bf401c5d929bULL},
+    {0x16470cff6546b651ULL, 0xbd33cc3349e47549ULL},
+    {0x11d270cc51055ea7ULL, 0xca8fd68f6e505dd4ULL},
+    {0x1c83e7ad4e6efdd9ULL, 0x4419574be3b3c953ULL},
+    {0x16cfec8aa52597e1ULL, 0x0347790982f63aa9ULL},
+    {0x123ff06eea847980ULL, 0xcf6c60d468c4fbbaULL},
+    {0x1d331a4b10d3f59aULL, 0xe57a34870e07f92aULL},
+    {0x175c1508da432ae2ULL, 0x512e906c0b399422ULL},
+    {0x12b010d3e1cf5581ULL, 0xda8ba6bcd5c7a9b5ULL},
+    {0x1de6815302e5559cULL, 0x90df712e22d90f87ULL},
+    {0x17eb9aa8cf1dde16ULL, 0xda4c5a8b4f140c6cULL},
+    {0x1322e220a5b17e78ULL, 0xaea37ba2a5a9a38aULL},
+    {0x1e9e369aa2b59727ULL, 0x7dd25f6aa2a905a9ULL},
+    {0x187e92154ef7ac1fULL, 0x97db7f888220d154ULL},
+    {0x139874ddd8c6234cULL, 0x797c6606ce80a777ULL},
+    {0x1f5a549627a36badULL, 0x8f2d700ae4010bf1ULL},
+    {0x191510781fb5efbeULL, 0x0c2459a25000d65aULL},
+    {0x1410d9f9b2f7f2feULL, 0x701d1481d99a4515ULL},
+    {0x100d7b2e28c65bfeULL, 0xc017439b147b6a77ULL},
+    {0x19af2b7d0e0a2ccaULL, 0xccf205c4ed9243f2ULL},
+    {0x148c22ca71a1bd6fULL, 0x0a5b37d0be0e9cc2ULL},
+    {0x10701bd527b4978cULL, 0x0848f973cb3ee3ceULL},
+    {0x1a4cf9550c5425acULL, 0xda0e5bec78649fb0ULL},
+    {0x150a6110d6a9b7bdULL, 0x7b3eaff060507fc0ULL},
+    {0x10d51a73deee2c97ULL, 0x95cbbff380406633ULL},
+    {0x1aee90b964b04758ULL, 0xefac665266cd7052ULL},
+    {0x158ba6fab6f36c47ULL, 0x2623850eb8a459dbULL},
+    {0x113c85955f29236cULL, 0x1e82d0d893b6ae49ULL},
+    {0x1b9408eefea838acULL, 0xfd9e1af41f8ab075ULL},
+    {0x16100725988693bdULL, 0x97b1af29b2d559f7ULL},
+    {0x11a66c1e139edc97ULL, 0xac8e25baf5777b2cULL},
+    {0x1c3d79c9b8fe2dbfULL, 0x7a7d092b2258c513ULL},
+    {0x169794a160cb57ccULL, 0x61fda0ef4ead6a76ULL},
+    {0x1212dd4de7091309ULL, 0xe7fe1a590bbdeec5ULL},
+    {0x1ceafbafd80e84dcULL, 0xa6635d5b45fcb13aULL},
+    {0x172262f3133ed0b0ULL, 0x851c4aaf6b308dc8ULL},
+    {0x1281e8c275cbda26ULL, 0xd0e36ef2bc26d7d4ULL},
+    {0x1d9ca79d894629d7ULL, 0xb49f17eac6a48c86ULL},
+    {0x17b08617a104ee46ULL, 0x2a18dfef0550706bULL},
+    {0x12f39e794d9d8b6bULL, 0x54e0b3259dd9f389ULL},
+    {0x1e5297287c2f4578ULL, 0x87cdeb6f62f65274ULL},
+    {0x18421286c9bf6ac6ULL, 0xd30b22bf825ea85dULL},
+    {0x13680ed23aff889fULL, 0x0f3c1bcc684bb9e4ULL},
+    {0x1f0ce4839198da98ULL, 0x18602c7a4079296dULL},
+    {0x18d71d360e13e213ULL, 0x46b356c833942124ULL},
+    {0x13df4a91a4dcb4dcULL, 0x388f78a029434db6ULL},
+    {0x1fcbaa82a1612160ULL, 0x5a7f2766a86baf8aULL},
+    {0x196fbb9bb44db44dULL, 0x153285ebb9efbfa2ULL},
+    {0x145962e2f6a4903dULL, 0xaa8ed189618c994eULL},
+    {0x1047824f2bb6d9caULL, 0xeed8a7a11ad6e10cULL},
+    {0x1a0c03b1df8af611ULL, 0x7e27729b5e249b45ULL},
+    {0x14d6695b193bf80dULL, 0xfe85f549181d4904ULL},
+    {0x10ab877c142ff9a4ULL, 0xcb9e5dd4134aa0d0ULL},
+    {0x1aac0bf9b9e65c3aULL, 0xdf63c9535211014dULL},
+    {0x15566ffafb1eb02fULL, 0x191ca10f74da6771ULL},
+    {0x1111f32f2f4bc025ULL, 0xadb080d92a4852c1ULL},
+    {0x1b4feb7eb212cd09ULL, 0x15e7348eaa0d5134ULL},
+    {0x15d98932280f0a6dULL, 0xab1f5d3eee710dc4ULL},
+    {0x117ad428200c0857ULL, 0xbc1917658b8da49dULL},
+    {0x1bf7b9d9cce00d59ULL, 0x2cf4f23c127c3a94ULL},
+    {0x165fc7e170b33de0ULL, 0xf0c3f4fcdb969543ULL},
+    {0x11e6398126f5cb1aULL, 0x5a365d9716121103ULL},
+    {0x1ca38f350b22de90ULL, 0x9056fc24f01ce804ULL},
+    {0x16e93f5da2824ba6ULL, 0xd9df301d8ce3ecd0ULL},
+    {0x125432b14ecea2ebULL, 0xe17f59b13d8323daULL},
+    {0x1d53844ee47dd179ULL, 0x68cbc2b52f38395cULL},
+    {0x177603725064a794ULL, 0x53d6355dbf602de3ULL},
+    {0x12c4cf8ea6b6ec76ULL, 0xa9782ab165e68b1cULL},
+    {0x1e07b27dd78b13f1ULL, 0x0f26aab56fd744faULL},
+    {0x18062864ac6f4327ULL, 0x3f52222abfdf6a62ULL},
+    {0x1338205089f29c1fULL, 0x65db4e88997f884eULL},
+    {0x1ec033b40fea9365ULL, 0x6fc54a7428cc0d4aULL},
+    {0x1899c2f673220f84ULL, 0x596aa1f68709a43bULL},
+    {0x13ae3591f5b4d936ULL, 0xadeee7f86c07b696ULL},
+    {0x1f7d228322baf524ULL, 0x497e3ff3e00c5756ULL},
+    {0x1930e868e89590e9ULL, 0xd464fff64cd6ac45ULL},
+    {0x14272053ed4473eeULL, 0x4383fff83d7889d1ULL},
+    {0x101f4d0ff1038ff1ULL, 0xcf9cccc69793a174ULL},
+    {0x19cbae7fe805b31cULL, 0x7f6147a425b90252ULL},
+    {0x14a2f1ffecd15c16ULL, 0xcc4dd2e9b7c7350fULL},
+    {0x10825b3323dab012ULL, 0x3d0b0f215fd290d9ULL},
+    {0x1a6a2b85062ab350ULL, 0x61ab4b689950e7c1ULL},
+    {0x1521bc6a6b555c40ULL, 0x4e22a2ba1440b967ULL},
+    {0x10e7c9eebc4449cdULL, 0x0b4ee894dd009453ULL},
+    {0x1b0c764ac6d3a948ULL, 0x1217da87c800ed51ULL},
+    {0x15a391d56bdc876cULL, 0xdb46486ca000bddaULL},
+    {0x114fa7ddefe39f8aULL, 0x490506bd4ccd64afULL},
+    {0x1bb2a62fe638ff43ULL, 0xa8080ac87ae23ab1ULL},
+    {0x162884f31e93ff69ULL, 0x5339a239fbe82ef4ULL},
+    {0x11ba03f5b20fff87ULL, 0x75c7b4fb2fecf25dULL},
+    {0x1c5cd322b67fff3fULL, 0x22d92191e647ea2eULL},
+    {0x16b0a8e891ffff65ULL, 0xb57a8141850654f2ULL},
+    {0x1226ed86db3332b7ULL, 0xc4620101373843f5ULL},
+    {0x1d0b15a491eb8459ULL, 0x3a366801f1f39feeULL},
+    {0x173c115074bc69e0ULL, 0xfb5eb99b27f6198bULL},
+    {0x129674405d6387e7ULL, 0x2f7efae2865e7ad6ULL},
+    {0x1dbd86cd6238d971ULL, 0xe597f7d0d6fd9156ULL},
+    {0x17cad23de82d7ac1ULL, 0x8479930d78cadaabULL},
+    {0x1308a831868ac89aULL, 0xd06142712d6f1556ULL},
+    {0x1e74404f3daada91ULL, 0x4d686a4eaf182222ULL},
+    {0x185d003f6488aedaULL, 0xa453883ef279b4e8ULL},
+    {0x137d99cc506d58aeULL, 0xe9dc6cff28615d87ULL},
+    {0x1f2f5c7a1a488de4ULL, 0xa960ae650d6895a4ULL},
+    {0x18f2b061aea07183ULL, 0xbab3beb73ded4483ULL},
+};
+
+// kPow5Split[i] is 5^i, shifted to be 125 bits long and rounded down.
+const int kPow5BitCount = 125;
+const UInt128 kPow5Split[326] = {
+    {0x1000000000000000ULL, 0x0000000000000000ULL},
+    {0x1400000000000000ULL, 0x0000000000000000ULL},
+    {0x1900000000000000ULL, 0x0000000000000000ULL},
+    {0x1f40000000000000ULL, 0x0000000000000000ULL},
+    {0x1388000000000000ULL, 0x0000000000000000ULL},
+    {0x186a000000000000ULL, 0x0000000000000000ULL},
+    {0x1e84800000000000ULL, 0x0000000000000000ULL},
+    {0x1312d00000000000ULL, 0x0000000000000000ULL},
+    {0x17d7840000000000ULL, 0x0000000000000000ULL},
+    {0x1dcd650000000000ULL, 0x0000000000000000ULL},
+    {0x12a05f2000000000ULL, 0x0000000000000000ULL},
+    {0x174876e800000000ULL, 0x0000000000000000ULL},
+    {0x1d1a94a200000000ULL, 0x0000000000000000ULL},
+    {0x12309ce540000000ULL, 0x0000000000000000ULL},
+    {0x16bcc41e90000000ULL, 0x0000000000000000ULL},
+    {0x1c6bf52634000000ULL, 0x0000000000000000ULL},
+    {0x11c37937e0800000ULL, 0x0000000000000000ULL},
+    {0x16345785d8a00000ULL, 0x0000000000000000ULL},
+    {0x1bc16d674ec80000ULL, 0x0000000000000000ULL},
+    {0x1158e460913d0000ULL, 0x0000000000000000ULL},
+    {0x15af1d78b58c4000ULL, 0x0000000000000000ULL},
+    {0x1b1ae4d6e2ef5000ULL, 0x0000000000000000ULL},
+    {0x10f0cf064dd59200ULL, 0x0000000000000000ULL},
+    {0x152d02c7e14af680ULL, 0x0000000000000000ULL},
+    {0x1a784379d99db420ULL, 0x0000000000000000ULL},
+    {0x108b2a2c28029094ULL, 0x0000000000000000ULL},
+    {0x14adf4b7320334b9ULL, 0x0000000000000000ULL},
+    {0x19d971e4fe8401e7ULL, 0x4000000000000000ULL},
+    {0x1027e72f1f128130ULL, 0x8800000000000000ULL},
+    {0x1431e0fae6d7217cULL, 0xaa00000000000000ULL},
+    {0x193e5939a08ce9dbULL, 0xd480000000000000ULL},
+    {0x1f8def8808b02452ULL, 0xc9a0000000000000ULL},
+    {0x13b8b5b5056e16b3ULL, 0xbe04000000000000ULL},
+    {0x18a6e32246c99c60ULL, 0xad85000000000000ULL},
+    {0x1ed09bead87c0378ULL, 0xd8e6400000000000ULL},
+    {0x13426172c74d822bULL, 0x878fe80000000000ULL},
+    {0x1812f9cf7920e2b6ULL, 0x6973e20000000000ULL},
+    {0x1e17b84357691b64ULL, 0x03d0da8000000000ULL},
+    {0x12ced32a16a1b11eULL, 0x8262889000000000ULL},
+    {0x178287f49c4a1d66ULL, 0x22fb2ab400000000ULL},
+    {0x1d6329f1c35ca4bfULL, 0xabb9f56100000000ULL},
+    {0x125dfa371a19e6f7ULL, 0xcb54395ca0000000ULL},
+    {0x16f578c4e0a060b5ULL, 0xbe2947b3c8000000ULL},
+    {0x1cb2d6f618c878e3ULL, 0x2db399a0ba000000ULL},
+    {0x11efc659cf7d4b8dULL, 0xfc90400474400000ULL},
+    {0x166bb7f0435c9e71ULL, 0x7bb4500591500000ULL},
+    {0x1c06a5ec5433c60dULL, 0xdaa16406f5a40000ULL},
+    {0x118427b3b4a05bc8ULL, 0xa8a4de8459868000ULL},
+    {0x15e531a0a1c872baULL, 0xd2ce16256fe82000ULL},
+    {0x1b5e7e08ca3a8f69ULL, 0x87819baecbe22800ULL},
+    {0x111b0ec57e6499a1ULL, 0xf4b1014d3f6d5900ULL},
+    {0x1561d276ddfdc00aULL, 0x71dd41a08f48af40ULL},
+    {0x1aba4714957d300dULL, 0x0e549208b31adb10ULL},
+    {0x10b46c6cdd6e3e08ULL, 0x28f4db456ff0c8eaULL},
+    {0x14e1878814c9cd8aULL, 0x33321216cbecfb24ULL},
+    {0x1a19e96a19fc40ecULL, 0xbffe969c7ee839edULL},
+    {0x105031e2503da893ULL, 0xf7ff1e21cf512434ULL},
+    {0x14643e5ae44d12b8ULL, 0xf5fee5aa43256d41ULL},
+    {0x197d4df19d605767ULL, 0x337e9f14d3eec892ULL},
+    {0x1fdca16e04b86d41ULL, 0x005e46da08ea7ab6ULL},
+    {0x13e9e4e4c2f34448ULL, 0xa03aec4845928cb2ULL},
+    {0x18e45e1df3b0155aULL, 0xc849a75a56f72fdeULL},
+    {0x1f1d75a5709c1ab1ULL, 0x7a5c1130ecb4fbd6ULL},
+    {0x13726987666190aeULL, 0xec798abe93f11d65ULL},
+    {0x184f03e93ff9f4daULL, 0xa797ed6e38ed64bfULL},
+    {0x1e62c4e38ff87211ULL, 0x517de8c9c728bdefULL},
+    {0x12fdbb0e39fb474aULL, 0xd2eeb17e1c7976b5ULL},
+    {0x17bd29d1c87a191dULL, 0x87aa5ddda397d462ULL},
+    {0x1dac74463a989f64ULL, 0xe994f5550c7dc97bULL},
+    {0x128bc8abe49f639fULL, 0x11fd195527ce9dedULL},
+    {0x172ebad6ddc73c86ULL, 0xd67c5faa71c24568ULL},
+    {0x1cfa698c95390ba8ULL, 0x8c1b77950e32d6c2ULL},
+    {0x121c81f7dd43a749ULL, 0x57912abd28dfc639ULL},
+    {0x16a3a275d494911bULL, 0xad75756c7317b7c8ULL},
+    {0x1c4c8b1349b9b562ULL, 0x98d2d2c78fdda5baULL},
+    {0x11afd6ec0e14115dULL, 0x9f83c3bcb9ea8794ULL},
+    {0x161bcca7119915b5ULL, 0x0764b4abe8652979ULL},
+    {0x1ba2bfd0d5ff5b22ULL, 0x493de1d6e27e73d7ULL},
+    {0x1145b7e285bf98f5ULL, 0x6dc6ad264d8f0866ULL},
+    {0x159725db272f7f32ULL, 0xc938586fe0f2ca80ULL},
+    {0x1afcef51f0fb5effULL, 0x7b866e8bd92f7d20ULL},
+    {0x10de1593369d1b5fULL, 0xad34051767bdae34ULL},
+    {0x15159af804446237ULL, 0x9881065d41ad19c1ULL},
+    {0x1a5b01b605557ac5ULL, 0x7ea147f492186032ULL},
+    {0x1078e111c3556cbbULL, 0x6f24ccf8db4f3c1fULL},
+    {0x14971956342ac7eaULL, 0x4aee003712230b27ULL},
+    {0x19bcdfabc13579e4ULL, 0xdda98044d6abcdf0ULL},
+    {0x10160bcb58c16c2fULL, 0x0a89f02b062b60b6ULL},
+    {0x141b8ebe2ef1c73aULL, 0xcd2c6c35c7b638e4ULL},
+    {0x1922726dbaae3909ULL, 0x8077874339a3c71dULL},
+    {0x1f6b0f092959c74bULL, 0xe0956914080cb8e4ULL},
+    {0x13a2e965b9d81c8fULL, 0x6c5d61ac8507f38eULL},
+    {0x188ba3bf284e23b3ULL, 0x4774ba17a649f072ULL},
+    {0x1eae8caef261aca0ULL, 0x1951e89d8fdc6c8fULL},
+    {0x132d17ed577d0be4ULL, 0x0fd3316279e9c3d9ULL},
+    {0x17f85de8ad5c4eddULL, 0x13c7fdbb186434cfULL},
+    {0x1df67562d8b36294ULL, 0x58b9fd29de7d4203ULL},
+    {0x12ba095dc7701d9cULL, 0xb7743e3a2b0e4942ULL},
+    {0x17688bb5394c2503ULL, 0xe5514dc8b5d1db92ULL},
+    {0x1d42aea2879f2e44ULL, 0xdea5a13ae3465277ULL},
+    {0x1249ad2594c37cebULL, 0x0b2784c4ce0bf38aULL},
+    {0x16dc186ef9f45c25ULL, 0xcdf165f6018ef06dULL},
+    {0x1c931e8ab871732fULL, 0x416dbf7381f2ac88ULL},
+    {0x11dbf316b346e7fdULL, 0x88e497a83137abd5ULL},
+    {0x1652efdc6018a1fcULL, 0xeb1dbd923d8596caULL},
+    {0x1be7abd3781eca7cULL, 0x25e52cf6cce6fc7dULL},
+    {0x1170cb642b133e8dULL, 0x97af3c1a40105dceULL},
+    {0x15ccfe3d35d80e30ULL, 0xfd9b0b20d0147542ULL},
+    {0x1b403dcc834e11bdULL, 0x3d01cde904199292ULL},
+    {0x1108269fd210cb16ULL, 0x462120b1a28ffb9bULL},
+    {0x154a3047c694fddbULL, 0xd7a968de0b33fa82ULL},
+    {0x1a9cbc59b83a3d52ULL, 0xcd93c3158e00f923ULL},
+    {0x10a1f5b813246653ULL, 0xc07c59ed78c09bb6ULL},
+    {0x14ca732617ed7fe8ULL, 0xb09b7068d6f0c2a3ULL},
+    {0x19fd0fef9de8dfe2ULL, 0xdcc24c830cacf34cULL},
+    {0x103e29f5c2b18bedULL, 0xc9f96fd1e7ec180fULL},
+    {0x144db473335deee9ULL, 0x3c77cbc661e71e13ULL},
+    {0x1961219000356aa3ULL, 0x8b95beb7fa60e598ULL},
+    {0x1fb969f40042c54cULL, 0x6e7b2e65f8f91efeULL},
+    {0x13d3e2388029bb4fULL, 0xc50cfcffbb9bb35fULL},
+    {0x18c8dac6a0342a23ULL, 0xb6503c3faa82a037ULL},
+    {0x1efb1178484134acULL, 0xa3e44b4f95234844ULL},
+    {0x135ceaeb2d28c0ebULL, 0xe66eaf11bd360d2bULL},
+    {0x183425a5f872f126ULL, 0xe00a5ad62c839075ULL},
+    {0x1e412f0f768fad70ULL, 0x980cf18bb7a47493ULL},
+    {0x12e8bd69aa19cc66ULL, 0x5f0816f752c6c8dcULL},
+    {0x17a2ecc414a03f7fULL, 0xf6ca1cb527787b13ULL},
+    {0x1d8ba7f519c84f5fULL, 0xf47ca3e2715699d7ULL},
+    {0x127748f9301d319bULL, 0xf8cde66d86d62026ULL},
+    {0x17151b377c247e02ULL, 0xf7016008e88ba830ULL},
+    {0x1cda62055b2d9d83ULL, 0xb4c1b80b22ae923cULL},
+    {0x12087d4358fc8272ULL, 0x50f91306f5ad1b65ULL},
+    {0x168a9c942f3ba30eULL, 0xe53757c8b318623fULL},
+    {0x1c2d43b93b0a8bd2ULL, 0x9e852dbadfde7acfULL},
+    {0x119c4a53c4e69763ULL, 0xa3133c94cbeb0cc1ULL},
+    {0x16035ce8b6203d3cULL, 0x8bd80bb9fee5cff1ULL},
+    {0x1b843422e3a84c8bULL, 0xaece0ea87e9f43eeULL},
+    {0x1132a095ce492fd7ULL, 0x4d40c9294f238a75ULL},
+    {0x157f48bb41db7bcdULL, 0x2090fb73a2ec6d12ULL},
+    {0x1adf1aea12525ac0ULL, 0x68b53a508ba78856ULL},
+    {0x10cb70d24b7378b8ULL, 0x417144725748b536ULL},
+    {0x14fe4d06de5056e6ULL, 0x51cd958eed1ae283ULL},
+    {0x1a3de04895e46c9fULL, 0xe640faf2a8619b24ULL},
+    {0x1066ac2d5daec3e3ULL, 0xefe89cd7a93d00f7ULL},
+    {0x14805738b51a74dcULL, 0xebe2c40d938c4134ULL},
+    {0x19a06d06e2611214ULL, 0x26db7510f86f5181ULL},
+    {0x100444244d7cab4cULL, 0x9849292a9b4592f1ULL},
+    {0x1405552d60dbd61fULL, 0xbe5b73754216f7adULL},
+    {0x1906aa78b912cba7ULL, 0xadf25052929cb598ULL},
+    {0x1f485516e7577e91ULL, 0x996ee4673743e2ffULL},
+    {0x138d352e5096af1aULL, 0xffe54ec0828a6ddfULL},
+    {0x18708279e4bc5ae1ULL, 0xbfdea270a32d0957ULL},
+    {0x1e8ca3185deb719aULL, 0x2fd64b0ccbf84badULL},
+    {0x1317e5ef3ab32700ULL, 0x5de5eee7ff7b2f4cULL},
+    {0x17dddf6b095ff0c0ULL, 0x755f6aa1ff59fb1fULL},
+    {0x1dd55745cbb7ecf0ULL, 0x92b7454a7f3079e7ULL},
+    {0x12a5568b9f52f416ULL, 0x5bb28b4e8f7e4c30ULL},
+    {0x174eac2e8727b11bULL, 0xf29f2e22335ddf3cULL},
+    {0x1d22573a28f19d62ULL, 0xef46f9aac035570bULL},
+    {0x123576845997025dULL, 0xd58c5c0ab8215667ULL},
+    {0x16c2d4256ffcc2f5ULL, 0x4aef730d6629ac01ULL},
+    {0x1c73892ecbfbf3b2ULL, 0x9dab4fd0bfb41701ULL},
+    {0x11c835bd3f7d784fULL, 0xa28b11e277d08e60ULL},
+    {0x163a432c8f5cd663ULL, 0x8b2dd65b15c4b1f9ULL},
+    {0x1bc8d3f7b3340bfcULL, 0x6df94bf1db35de77ULL},
+    {0x115d847ad000877dULL, 0xc4bbcf772901ab0aULL},
+    {0x15b4e5998400a95dULL, 0x35eac354f34215cdULL},
+    {0x1b221effe500d3b4ULL, 0x8365742a30129b40ULL},
+    {0x10f5535fef208450ULL, 0xd21f689a5e0ba108ULL},
+    {0x1532a837eae8a565ULL, 0x06a742c0f58e894aULL},
+    {0x1a7f5245e5a2cebeULL, 0x4851137132f22b9dULL},
+    {0x108f936baf85c136ULL, 0xed32ac26bfd75b42ULL},
+    {0x14b378469b673184ULL, 0xa87f57306fcd3212ULL},
+    {0x19e056584240fde5ULL, 0xd29f2cfc8bc07e97ULL},
+    {0x102c35f729689eafULL, 0xa3a37c1dd7584f1eULL},
+    {0x14374374f3c2c65bULL, 0x8c8c5b254d2e62e6ULL},
+    {0x1945145230b377f2ULL, 0x6faf71eea079fb9fULL},
+    {0x1f965966bce055efULL, 0x0b9b4e6a48987a87ULL},
+    {0x13bdf7e0360c35b5ULL, 0x674111026d5f4c94ULL},
+    {0x18ad75d8438f4322ULL, 0xc111554308b71fbaULL},
+    {0x1ed8d34e547313ebULL, 0x7155aa93cae4e7a8ULL},
+    {0x13478410f4c7ec73ULL, 0x26d58a9c5ecf10c9ULL},
+    {0x1819651531f9e78fULL, 0xf08aed437682d4fbULL},
+    {0x1e1fbe5a7e786173ULL, 0xecada89454238a3aULL},
+    {0x12d3d6f88f0b3ce8ULL, 0x73ec895cb4963664ULL},
+    {0x1788ccb6b2ce0c22ULL, 0x90e7abb3e1bbc3fdULL},
+    {0x1d6affe45f818f2bULL, 0x352196a0da2ab4fdULL},
+    {0x1262dfeebbb0f97bULL, 0x0134fe24885ab11eULL},
+    {0x16fb97ea6a9d37d9ULL, 0xc1823dadaa715d65ULL},
+    {0x1cba7de5054485d0ULL, 0x31e2cd19150db4bfULL},
+    {0x11f48eaf234ad3a2ULL, 0x1f2dc02fad2890f7ULL},
+    {0x1671b25aec1d888aULL, 0xa6f9303b9872b535ULL},
+    {0x1c0e1ef1a724eaadULL, 0x50b77c4a7e8f6282ULL},
+    {0x1188d357087712acULL, 0x5272adae8f199d91ULL},
+    {0x15eb082cca94d757ULL, 0x670f591a32e004f6ULL},
+    {0x1b65ca37fd3a0d2dULL, 0x40d32f60bf980633ULL},
+    {0x111f9e62fe44483cULL, 0x4883fd9c77bf03e0ULL},
+    {0x156785fbbdd55a4bULL, 0x5aa4fd0395aec4d8ULL},
+    {0x1ac1677aad4ab0deULL, 0x314e3c447b1a760eULL},
+    {0x10b8e0acac4eae8aULL, 0xded0e5aaccf089c9ULL},
+    {0x14e718d7d7625a2dULL, 0x96851f15802cac3bULL},
+    {0x1a20df0dcd3af0b8ULL, 0xfc2666dae037d74aULL},
+    {0x10548b68a044d673ULL, 0x9d980048cc22e68eULL},
+    {0x1469ae42c8560c10ULL, 0x84fe005aff2ba032ULL},
+    {0x198419d37a6b8f14ULL, 0xa63d8071bef6883eULL},
+    {0x1fe52048590672d9ULL, 0xcfcce08e2eb42a4eULL},
+    {0x13ef342d37a407c8ULL, 0x21e00c58dd309a70ULL},
+    {0x18eb0138858d09baULL, 0x2a580f6f147cc10dULL},
+    {0x1f25c186a6f04c28ULL, 0xb4ee134ad99bf150ULL},
+    {0x137798f428562f99ULL, 0x7114cc0ec80176d2ULL},
+    {0x18557f31326bbb7fULL, 0xcd59ff127a01d486ULL},
+    {0x1e6adefd7f06aa5fULL, 0xc0b07ed7188249a8ULL},
+    {0x1302cb5e6f642a7bULL, 0xd86e4f466f516e09ULL},
+    {0x17c37e360b3d351aULL, 0xce89e3180b25c98bULL},
+    {0x1db45dc38e0c8261ULL, 0x822c5bde0def3beeULL},
+    {0x1290ba9a38c7d17cULL, 0xf15bb96ac8b58575ULL},
+    {0x1734e940c6f9c5dcULL, 0x2db2a7c57ae2e6d2ULL},
+    {0x1d022390f8b83753ULL, 0x391f51b6d99ba086ULL},
+    {0x1221563a9b732294ULL, 0x03b3931248014454ULL},
+    {0x16a9abc9424feb39ULL, 0x04a077d6da019569ULL},
+    {0x1c5416bb92e3e607ULL, 0x45c895cc9081fac3ULL},
+    {0x11b48e353bce6fc4ULL, 0x8b9d5d9fda513cbaULL},
+    {0x1621b1c28ac20bb5ULL, 0xae84b507d0e58be8ULL},
+    {0x1baa1e332d728ea3ULL, 0x1a25e249c51eeee3ULL},
+    {0x114a52dffc679925ULL, 0xf057ad6e1b33554dULL},
+    {0x159ce797fb817f6fULL, 0x6c6d98c9a2002aa1ULL},
+    {0x1b04217dfa61df4bULL, 0x4788fefc0a803549ULL},
+    {0x10e294eebc7d2b8fULL, 0x0cb59f5d8690214eULL},
+    {0x151b3a2a6b9c7672ULL, 0xcfe30734e83429a1ULL},
+    {0x1a6208b50683940fULL, 0x83dbc9022241340aULL},
+    {0x107d457124123c89ULL, 0xb2695da15568c086ULL},
+    {0x149c96cd6d16cbacULL, 0x1f03b509aac2f0a7ULL},
+    {0x19c3bc80c85c7e97ULL, 0x26c4a24c1573acd1ULL},
+    {0x101a55d07d39cf1eULL, 0x783ae56f8d684c03ULL},
+    {0x1420eb449c8842e6ULL, 0x16499ecb70c25f03ULL},
+    {0x19292615c3aa539fULL, 0x9bdc067e4cf2f6c4ULL},
+    {0x1f736f9b3494e887ULL, 0x82d3081de02fb476ULL},
+    {0x13a825c100dd1154ULL, 0xb1c3e512ac1dd0c9ULL},
+    {0x18922f31411455a9ULL, 0xde34de57572544fcULL},
+    {0x1eb6bafd91596b14ULL, 0x55c215ed2cee963bULL},
+    {0x133234de7ad7e2ecULL, 0xb5994db43c151de5ULL},
+    {0x17fec216198ddba7ULL, 0xe2ffa1214b1a655eULL},
+    {0x1dfe729b9ff15291ULL, 0xdbbf89699de0feb6ULL},
+    {0x12bf07a143f6d39bULL, 0x2957b5e202ac9f31ULL},
+    {0x176ec98994f48881ULL, 0xf3ada35a8357c6feULL},
+    {0x1d4a7bebfa31aaa2ULL, 0x70990c31242db8bdULL},
+    {0x124e8d737c5f0aa5ULL, 0x865fa79eb69c9376ULL},
+    {0x16e230d05b76cd4eULL, 0xe7f791866443b854ULL},
+    {0x1c9abd04725480a2ULL, 0xa1f575e7fd54a669ULL},
+    {0x11e0b622c774d065ULL, 0xa53969b0fe54e801ULL},
+    {0x1658e3ab7952047fULL, 0x0e87c41d3dea2202ULL},
+    {0x1bef1c9657a6859eULL, 0xd229b5248d64aa82ULL},
+    {0x117571ddf6c81383ULL, 0x435a1136d85eea91ULL},
+    {0x15d2ce55747a1864ULL, 0x143095848e76a536ULL},
+    {0x1b4781ead1989e7dULL, 0x193cbae5b2144e83ULL},
+    {0x110cb132c2ff630eULL, 0x2fc5f4cf8f4cb112ULL},
+    {0x154fdd7f73bf3bd1ULL, 0xbbb77203731fdd56ULL},
+    {0x1aa3d4df50af0ac6ULL, 0x2aa54e844fe7d4acULL},
+    {0x10a6650b926d66bbULL, 0xdaa75112b1f0e4ebULL},
+    {0x14cffe4e7708c06aULL, 0xd15125575e6d1e26ULL},
+    {0x1a03fde214caf085ULL, 0x85a56ead360865b0ULL},
+    {0x10427ead4cfed653ULL, 0x7387652c41c53f8eULL},
+    {0x14531e58a03e8be8ULL, 0x50693e7752368f71ULL},
+    {0x1967e5eec84e2ee2ULL, 0x64838e1526c4334eULL},
+    {0x1fc1df6a7a61ba9aULL, 0xfda4719a70754022ULL},
+    {0x13d92ba28c7d14a0ULL, 0xde86c70086494815ULL},
+    {0x18cf768b2f9c59c9ULL, 0x162878c0a7db9a1aULL},
+    {0x1f03542dfb83703bULL, 0x5bb296f0d1d280a1ULL},
+    {0x1362149cbd322625ULL, 0x194f9e5683239064ULL},
+    {0x183a99c3ec7eafaeULL, 0x5fa385ec23ec747eULL},
+    {0x1e494034e79e5b99ULL, 0xf78c67672ce7919dULL},
+    {0x12edc82110c2f940ULL, 0x3ab7c0a07c10bb02ULL},
+    {0x17a93a2954f3b790ULL, 0x4965b0c89b14e9c3ULL},
+    {0x1d9388b3aa30a574ULL, 0x5bbf1cfac1da2433ULL},
+    {0x127c35704a5e6768ULL, 0xb957721cb92856a0ULL},
+    {0x171b42cc5cf60142ULL, 0xe7ad4ea3e7726c48ULL},
+    {0x1ce2137f74338193ULL, 0xa198a24ce14f075aULL},
+    {0x120d4c2fa8a030fcULL, 0x44ff65700cd16498ULL},
+    {0x16909f3b92c83d3bULL, 0x563f3ecc1005bdbeULL},
+    {0x1c34c70a777a4c8aULL, 0x2bcf0e7f14072d2eULL},
+    {0x11a0fc668aac6fd6ULL, 0x5b61690f6c847c3dULL},
+    {0x16093b802d578bcbULL, 0xf239c35347a59b4cULL},
+    {0x1b8b8a6038ad6ebeULL, 0xeec83428198f021fULL},
+    {0x1137367c236c6537ULL, 0x553d20990ff96153ULL},
+    {0x1585041b2c477e85ULL, 0x2a8c68bf53f7b9a8ULL},
+    {0x1ae64521f7595e26ULL, 0x752f82ef28f5a812ULL},
+    {0x10cfeb353a97dad8ULL, 0x093db1d57999890bULL},
+    {0x1503e602893dd18eULL, 0x0b8d1e4ad7ffeb4eULL},
+    {0x1a44df832b8d45f1ULL, 0x8e7065dd8dffe622ULL},
+    {0x106b0bb1fb384bb6ULL, 0xf9063faa78bfefd5ULL},
+    {0x1485ce9e7a065ea4ULL, 0xb747cf9516efebcaULL},
+    {0x19a742461887f64dULL, 0xe519c37a5cabe6bdULL},
+    {0x1008896bcf54f9f0ULL, 0xaf301a2c79eb7036ULL},
+    {0x140aabc6c32a386cULL, 0xdafc20b798664c43ULL},
+    {0x190d56b873f4c688ULL, 0x11bb28e57e7fdf54ULL},
+    {0x1f50ac6690f1f82aULL, 0x1629f31ede1fd72aULL},
+    {0x13926bc01a973b1aULL, 0x4dda37f34ad3e67aULL},
+    {0x187706b0213d09e0ULL, 0xe150c5f01d88e019ULL},
+    {0x1e94c85c298c4c59ULL, 0x19a4f76c24eb181fULL},
+    {0x131cfd3999f7afb7ULL, 0xb0071aa39712ef13ULL},
+    {0x17e43c8800759ba5ULL, 0x9c08e14c7cd7aad8ULL},
+    {0x1ddd4baa0093028fULL, 0x030b199f9c0d958eULL},
+    {0x12aa4f4a405be199ULL, 0x61e6f003c1887d79ULL},
+    {0x1754e31cd072d9ffULL, 0xba60ac04b1ea9cd7ULL},
+    {0x1d2a1be4048f907fULL, 0xa8f8d705de65440dULL},
+    {0x123a516e82d9ba4fULL, 0xc99b8663aaff4a88ULL},
+    {0x16c8e5ca239028e3ULL, 0xbc0267fc95bf1d2aULL},
+    {0x1c7b1f3cac74331cULL, 0xab0301fbbb2ee474ULL},
+    {0x11ccf385ebc89ff1ULL, 0xeae1e13d54fd4ec9ULL},
+    {0x1640306766bac7eeULL, 0x659a598caa3ca27bULL},
+    {0x1bd03c81406979e9ULL, 0xff00efefd4cbcb1aULL},
+    {0x116225d0c841ec32ULL, 0x3f6095f5e4ff5ef0ULL},
+    {0x15baaf44fa52673eULL, 0xcf38bb735e3f36acULL},
+    {0x1b295b1638e7010eULL, 0x8306ea5035cf0457ULL},
+    {0x10f9d8ede39060a9ULL, 0x11e4527221a162b6ULL},
+    {0x15384f295c7478d3ULL, 0x565d670eaa09bb64ULL},
+    {0x1a8662f3b3919708ULL, 0x2bf4c0d2548c2a3dULL},
+    {0x1093fdd8503afe65ULL, 0x1b78f88374d79a66ULL},
+    {0x14b8fd4e6449bdfeULL, 0x625736a4520d8100ULL},
+    {0x19e73ca1fd5c2d7dULL, 0xfaed044d6690e140ULL},
+    {0x103085e53e599c6eULL, 0xbcd422b0601a8cc8ULL},
+    {0x143ca75e8df0038aULL, 0x6c092b5c78212ffaULL},
+    {0x194bd136316c046dULL, 0x070b763396297bf8ULL},
+    {0x1f9ec583bdc70588ULL, 0x48ce53c07bb3daf6ULL},
+    {0x13c33b72569c6375ULL, 0x2d80f4584d5068daULL},
+    {0x18b40a4eec437c52ULL, 0x78e1316e60a48310ULL},
+};
+
+// kPowersOfTen[i] is 10^(i + kMinPowerOfTen), shifted to be 128 bits long
+// (i.e. with the top bit set) and rounded down. This covers the range in
+// which the Eisel-Lemire algorithm can produce a finite non-zero double from a
+// 64-bit mantissa.
+const int kMinPowerOfTen = -348;
+const int kMaxPowerOfTen = 347;
+const UInt128 kPowersOfTen[kMaxPowerOfTen - kMinPowerOfTen + 1] = {
+    {0xfa8fd5a0081c0288ULL, 0x1732c869cd60e453ULL},
+    {0x9c99e58405118195ULL, 0x0e7fbd42205c8eb4ULL},
+    {0xc3c05ee50655e1faULL, 0x521fac92a873b261ULL},
+    {0xf4b0769e47eb5a78ULL, 0xe6a797b752909ef9ULL},
+    {0x98ee4a22ecf3188bULL, 0x9028bed2939a635cULL},
+    {0xbf29dcaba82fdeaeULL, 0x7432ee873880fc33ULL},
+    {0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL},
+    {0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL},
+    {0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL},
+    {0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL},
+    {0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL},
+    {0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL},
+    {0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL},
+    {0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL},
+    {0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL},
+    {0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL},
+    {0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL},
+    {0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL},
+    {0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL},
+    {0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL},
+    {0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL},
+    {0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL},
+    {0x84a57695fe98746dULL, 0x014bb630f7604b57ULL},
+    {0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL},
+    {0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL},
+    {0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL},
+    {0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL},
+    {0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL},
+    {0xfd00b897478238d0ULL, 0x8920b098955522b4ULL},
+    {0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL},
+    {0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL},
+    {0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL},
+    {0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL},
+    {0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL},
+    {0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL},
+    {0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL},
+    {0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL},
+    {0xeba09271e88d976bULL, 0xf7864a44c633682eULL},
+    {0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL},
+    {0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL},
+    {0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL},
+    {0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL},
+    {0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL},
+    {0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL},
+    {0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL},
+    {0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL},
+    {0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL},
+    {0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL},
+    {0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL},
+    {0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL},
+    {0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL},
+    {0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL},
+    {0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL},
+    {0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL},
+    {0xa37fce126597973cULL, 0xe50ff107bab528a0ULL},
+    {0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL},
+    {0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL},
+    {0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL},
+    {0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL},
+    {0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL},
+    {0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL},
+    {0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL},
+    {0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL},
+    {0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL},
+    {0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL},
+    {0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL},
+    {0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL},
+    {0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL},
+    {0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL},
+    {0x91376c36d99995beULL, 0x23100809b9c21fa1ULL},
+    {0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL},
+    {0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL},
+    {0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL},
+    {0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL},
+    {0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL},
+    {0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL},
+    {0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL},
+    {0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL},
+    {0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL},
+    {0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL},
+    {0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL},
+    {0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL},
+    {0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL},
+    {0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL},
+    {0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL},
+    {0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL},
+    {0xc987434744ac874eULL, 0xa327ffb266b56220ULL},
+    {0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL},
+    {0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL},
+    {0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL},
+    {0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL},
+    {0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL},
+    {0xc0314325637a1939ULL, 0xfa911155fefb5308ULL},
+    {0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL},
+    {0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL},
+    {0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL},
+    {0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL},
+    {0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL},
+    {0xb749faed14125d36ULL, 0xcef980ec671f667bULL},
+    {0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL},
+    {0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL},
+    {0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL},
+    {0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL},
+    {0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL},
+    {0xaecc49914078536dULL, 0x58fae9f773886e18ULL},
+    {0xda7f5bf590966848ULL, 0xaf39a475506a899eULL},
+    {0x888f99797a5e012dULL, 0x6d8406c952429603ULL},
+    {0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL},
+    {0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL},
+    {0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL},
+    {0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL},
+    {0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL},
+    {0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL},
+    {0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL},
+    {0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL},
+    {0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL},
+    {0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL},
+    {0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL},
+    {0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL},
+    {0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL},
+    {0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL},
+    {0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL},
+    {0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL},
+    {0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL},
+    {0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL},
+    {0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL},
+    {0xb913179899f68584ULL, 0x28e2557b59846e3fULL},
+    {0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL},
+    {0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL},
+    {0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL},
+    {0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL},
+    {0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL},
+    {0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL},
+    {0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL},
+    {0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL},
+    {0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL},
+    {0xd77485cb25823ac7ULL, 0x7d633293366b828bULL},
+    {0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL},
+    {0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL},
+    {0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL},
+    {0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL},
+    {0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL},
+    {0xcd795be870516656ULL, 0x67902e276c921f8bULL},
+    {0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL},
+    {0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL},
+    {0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL},
+    {0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL},
+    {0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL},
+    {0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL},
+    {0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL},
+    {0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL},
+    {0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL},
+    {0xef340a98172aace4ULL, 0x86fb897116c87c34ULL},
+    {0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL},
+    {0xbae0a846d2195712ULL, 0x8974836059cca109ULL},
+    {0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL},
+    {0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL},
+    {0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL},
+    {0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL},
+    {0x8e938662882af53eULL, 0x547eb47b7282ee9cULL},
+    {0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL},
+    {0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL},
+    {0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL},
+    {0xae0b158b4738705eULL, 0x9624ab50b148d445ULL},
+    {0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL},
+    {0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL},
+    {0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL},
+    {0xd47487cc8470652bULL, 0x7647c3200069671fULL},
+    {0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL},
+    {0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL},
+    {0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL},
+    {0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL},
+    {0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL},
+    {0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL},
+    {0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL},
+    {0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL},
+    {0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL},
+    {0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL},
+    {0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL},
+    {0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL},
+    {0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL},
+    {0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL},
+    {0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL},
+    {0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL},
+    {0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL},
+    {0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL},
+    {0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL},
+    {0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL},
+    {0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL},
+    {0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL},
+    {0x8c974f7383725573ULL, 0x1e414218c73a13fbULL},
+    {0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL},
+    {0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL},
+    {0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL},
+    {0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL},
+    {0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL},
+    {0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL},
+    {0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL},
+    {0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL},
+    {0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL},
+    {0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL},
+    {0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL},
+    {0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL},
+    {0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL},
+    {0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL},
+    {0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL},
+    {0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL},
+    {0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL},
+    {0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL},
+    {0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL},
+    {0xbe89523386091465ULL, 0xf6bbb397f1135823ULL},
+    {0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL},
+    {0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL},
+    {0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL},
+    {0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL},
+    {0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL},
+    {0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL},
+    {0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL},
+    {0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL},
+    {0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL},
+    {0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL},
+    {0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL},
+    {0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL},
+    {0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL},
+    {0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL},
+    {0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL},
+    {0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL},
+    {0x843610cb4bf160cbULL, 0xcedf722a585139baULL},
+    {0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL},
+    {0xce947a3da6a9273eULL, 0x733d226229feea32ULL},
+    {0x811ccc668829b887ULL, 0x0806357d5a3f525fULL},
+    {0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL},
+    {0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL},
+    {0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL},
+    {0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL},
+    {0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL},
+    {0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL},
+    {0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL},
+    {0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL},
+    {0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL},
+    {0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL},
+    {0xbbe226efb628afeaULL, 0x890489f70a55368bULL},
+    {0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL},
+    {0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL},
+    {0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL},
+    {0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL},
+    {0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL},
+    {0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL},
+    {0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL},
+    {0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL},
+    {0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL},
+    {0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL},
+    {0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL},
+    {0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL},
+    {0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL},
+    {0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL},
+    {0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL},
+    {0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL},
+    {0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL},
+    {0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL},
+    {0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL},
+    {0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL},
+    {0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL},
+    {0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL},
+    {0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL},
+    {0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL},
+    {0xc24452da229b021bULL, 0xfbe85badce996168ULL},
+    {0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL},
+    {0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL},
+    {0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL},
+    {0xed246723473e3813ULL, 0x290123e9aab23b68ULL},
+    {0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL},
+    {0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL},
+    {0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL},
+    {0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL},
+    {0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL},
+    {0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL},
+    {0x8d590723948a535fULL, 0x579c487e5a38ad0eULL},
+    {0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL},
+    {0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL},
+    {0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL},
+    {0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL},
+    {0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL},
+    {0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL},
+    {0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL},
+    {0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL},
+    {0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL},
+    {0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL},
+    {0xcdb02555653131b6ULL, 0x3792f412cb06794dULL},
+    {0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL},
+    {0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL},
+    {0xc8de047564d20a8bULL, 0xf245825a5a445275ULL},
+    {0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL},
+    {0x9ced737bb6c4183dULL, 0x55464dd69685606bULL},
+    {0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL},
+    {0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL},
+    {0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL},
+    {0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL},
+    {0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL},
+    {0x95a8637627989aadULL, 0xdde7001379a44aa8ULL},
+    {0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL},
+    {0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL},
+    {0x9226712162ab070dULL, 0xcab3961304ca70e8ULL},
+    {0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL},
+    {0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL},
+    {0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL},
+    {0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL},
+    {0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL},
+    {0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL},
+    {0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL},
+    {0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL},
+    {0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL},
+    {0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL},
+    {0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL},
+    {0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL},
+    {0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL},
+    {0xcfb11ead453994baULL, 0x67de18eda5814af2ULL},
+    {0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL},
+    {0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL},
+    {0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL},
+    {0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL},
+    {0x9e74d1b791e07e48ULL, 0x775ea264cf55347dULL},
+    {0xc612062576589ddaULL, 0x95364afe032a819dULL},
+    {0xf79687aed3eec551ULL, 0x3a83ddbd83f52204ULL},
+    {0x9abe14cd44753b52ULL, 0xc4926a9672793542ULL},
+    {0xc16d9a0095928a27ULL, 0x75b7053c0f178293ULL},
+    {0xf1c90080baf72cb1ULL, 0x5324c68b12dd6338ULL},
+    {0x971da05074da7beeULL, 0xd3f6fc16ebca5e03ULL},
+    {0xbce5086492111aeaULL, 0x88f4bb1ca6bcf584ULL},
+    {0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e5ULL},
+    {0x9392ee8e921d5d07ULL, 0x3aff322e62439fcfULL},
+    {0xb877aa3236a4b449ULL, 0x09befeb9fad487c2ULL},
+    {0xe69594bec44de15bULL, 0x4c2ebe687989a9b3ULL},
+    {0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a10ULL},
+    {0xb424dc35095cd80fULL, 0x538484c19ef38c94ULL},
+    {0xe12e13424bb40e13ULL, 0x2865a5f206b06fb9ULL},
+    {0x8cbccc096f5088cbULL, 0xf93f87b7442e45d3ULL},
+    {0xafebff0bcb24aafeULL, 0xf78f69a51539d748ULL},
+    {0xdbe6fecebdedd5beULL, 0xb573440e5a884d1bULL},
+    {0x89705f4136b4a597ULL, 0x31680a88f8953030ULL},
+    {0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3dULL},
+    {0xd6bf94d5e57a42bcULL, 0x3d32907604691b4cULL},
+    {0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b10fULL},
+    {0xa7c5ac471b478423ULL, 0x0fcf80dc33721d53ULL},
+    {0xd1b71758e219652bULL, 0xd3c36113404ea4a8ULL},
+    {0x83126e978d4fdf3bULL, 0x645a1cac083126e9ULL},
+    {0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a3ULL},
+    {0xccccccccccccccccULL, 0xccccccccccccccccULL},
+    {0x8000000000000000ULL, 0x0000000000000000ULL},
+    {0xa000000000000000ULL, 0x0000000000000000ULL},
+    {0xc800000000000000ULL, 0x0000000000000000ULL},
+    {0xfa00000000000000ULL, 0x0000000000000000ULL},
+    {0x9c40000000000000ULL, 0x0000000000000000ULL},
+    {0xc350000000000000ULL, 0x0000000000000000ULL},
+    {0xf424000000000000ULL, 0x0000000000000000ULL},
+    {0x9896800000000000ULL, 0x0000000000000000ULL},
+    {0xbebc200000000000ULL, 0x0000000000000000ULL},
+    {0xee6b280000000000ULL, 0x0000000000000000ULL},
+    {0x9502f90000000000ULL, 0x0000000000000000ULL},
+    {0xba43b74000000000ULL, 0x0000000000000000ULL},
+    {0xe8d4a51000000000ULL, 0x0000000000000000ULL},
+    {0x9184e72a00000000ULL, 0x0000000000000000ULL},
+    {0xb5e620f480000000ULL, 0x0000000000000000ULL},
+    {0xe35fa931a0000000ULL, 0x0000000000000000ULL},
+    {0x8e1bc9bf04000000ULL, 0x0000000000000000ULL},
+    {0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL},
+    {0xde0b6b3a76400000ULL, 0x0000000000000000ULL},
+    {0x8ac7230489e80000ULL, 0x0000000000000000ULL},
+    {0xad78ebc5ac620000ULL, 0x0000000000000000ULL},
+    {0xd8d726b7177a8000ULL, 0x0000000000000000ULL},
+    {0x878678326eac9000ULL, 0x0000000000000000ULL},
+    {0xa968163f0a57b400ULL, 0x0000000000000000ULL},
+    {0xd3c21bcecceda100ULL, 0x0000000000000000ULL},
+    {0x84595161401484a0ULL, 0x0000000000000000ULL},
+    {0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL},
+    {0xcecb8f27f4200f3aULL, 0x0000000000000000ULL},
+    {0x813f3978f8940984ULL, 0x4000000000000000ULL},
+    {0xa18f07d736b90be5ULL, 0x5000000000000000ULL},
+    {0xc9f2c9cd04674edeULL, 0xa400000000000000ULL},
+    {0xfc6f7c4045812296ULL, 0x4d00000000000000ULL},
+    {0x9dc5ada82b70b59dULL, 0xf020000000000000ULL},
+    {0xc5371912364ce305ULL, 0x6c28000000000000ULL},
+    {0xf684df56c3e01bc6ULL, 0xc732000000000000ULL},
+    {0x9a130b963a6c115cULL, 0x3c7f400000000000ULL},
+    {0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL},
+    {0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL},
+    {0x96769950b50d88f4ULL, 0x1314448000000000ULL},
+    {0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL},
+    {0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL},
+    {0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL},
+    {0xb7abc627050305adULL, 0xf14a3d9e40000000ULL},
+    {0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL},
+    {0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL},
+    {0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL},
+    {0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL},
+    {0x8c213d9da502de45ULL, 0x4526f422cc340000ULL},
+    {0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL},
+    {0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL},
+    {0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL},
+    {0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL},
+    {0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL},
+    {0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL},
+    {0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL},
+    {0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL},
+    {0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL},
+    {0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL},
+    {0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL},
+    {0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL},
+    {0x9f4f2726179a2245ULL, 0x01d762422c946590ULL},
+    {0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL},
+    {0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL},
+    {0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL},
+    {0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL},
+    {0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL},
+    {0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL},
+    {0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL},
+    {0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL},
+    {0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL},
+    {0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL},
+    {0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL},
+    {0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL},
+    {0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL},
+    {0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL},
+    {0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL},
+    {0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL},
+    {0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL},
+    {0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL},
+    {0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL},
+    {0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL},
+    {0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL},
+    {0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL},
+    {0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL},
+    {0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL},
+    {0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL},
+    {0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL},
+    {0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL},
+    {0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL},
+    {0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL},
+    {0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL},
+    {0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL},
+    {0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL},
+    {0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL},
+    {0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL},
+    {0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL},
+    {0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL},
+    {0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL},
+    {0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL},
+    {0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL},
+    {0x924d692ca61be758ULL, 0x593c2626705f9c56ULL},
+    {0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL},
+    {0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL},
+    {0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL},
+    {0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL},
+    {0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL},
+    {0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL},
+    {0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL},
+    {0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL},
+    {0x884134fe908658b2ULL, 0x3109058d147fdcddULL},
+    {0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL},
+    {0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL},
+    {0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL},
+    {0xa6539930bf6bff45ULL, 0x84db8346b786151cULL},
+    {0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL},
+    {0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL},
+    {0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL},
+    {0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL},
+    {0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL},
+    {0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL},
+    {0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL},
+    {0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL},
+    {0x9ae757596946075fULL, 0x3375788de9b06958ULL},
+    {0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL},
+    {0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL},
+    {0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL},
+    {0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL},
+    {0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL},
+    {0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL},
+    {0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL},
+    {0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL},
+    {0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL},
+    {0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL},
+    {0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL},
+    {0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL},
+    {0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL},
+    {0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL},
+    {0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL},
+    {0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL},
+    {0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL},
+    {0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL},
+    {0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL},
+    {0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL},
+    {0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL},
+    {0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL},
+    {0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL},
+    {0x802221226be55a64ULL, 0xc2494954da2c9789ULL},
+    {0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL},
+    {0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL},
+    {0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL},
+    {0x9c69a97284b578d7ULL, 0xff2a760414536efbULL},
+    {0xc38413cf25e2d70dULL, 0xfef5138519684abaULL},
+    {0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL},
+    {0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL},
+    {0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL},
+    {0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL},
+    {0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL},
+    {0xba756174393d88dfULL, 0x94f971119aeef9e4ULL},
+    {0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL},
+    {0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL},
+    {0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL},
+    {0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL},
+    {0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL},
+    {0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL},
+    {0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL},
+    {0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL},
+    {0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL},
+    {0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL},
+    {0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL},
+    {0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL},
+    {0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL},
+    {0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL},
+    {0xa59bc234db398c25ULL, 0x43fab9837e699095ULL},
+    {0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL},
+    {0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL},
+    {0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL},
+    {0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL},
+    {0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL},
+    {0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL},
+    {0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL},
+    {0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL},
+    {0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL},
+    {0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL},
+    {0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL},
+    {0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL},
+    {0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL},
+    {0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL},
+    {0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL},
+    {0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL},
+    {0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL},
+    {0x8fa475791a569d10ULL, 0xf96e017d694487bcULL},
+    {0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL},
+    {0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL},
+    {0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL},
+    {0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL},
+    {0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL},
+    {0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL},
+    {0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL},
+    {0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL},
+    {0x85c7056562757456ULL, 0xf6872d5667844e49ULL},
+    {0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL},
+    {0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL},
+    {0x82a45b450226b39cULL, 0xecc0024661173473ULL},
+    {0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL},
+    {0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL},
+    {0xff290242c83396ceULL, 0x7e67047175a15271ULL},
+    {0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL},
+    {0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL},
+    {0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL},
+    {0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL},
+    {0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL},
+    {0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL},
+    {0x98165af37b2153deULL, 0xc3727a337a8b704aULL},
+    {0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL},
+    {0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL},
+    {0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL},
+    {0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL},
+    {0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL},
+    {0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL},
+    {0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL},
+    {0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL},
+    {0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL},
+    {0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL},
+    {0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL},
+    {0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL},
+    {0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL},
+    {0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL},
+    {0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL},
+    {0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL},
+    {0xd31045a8341ca07cULL, 0x1ede48111209a050ULL},
+    {0x83ea2b892091e44dULL, 0x934aed0aab460432ULL},
+    {0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL},
+    {0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL},
+    {0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL},
+    {0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL},
+    {0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL},
+    {0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL},
+    {0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL},
+    {0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL},
+    {0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL},
+    {0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL},
+    {0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL},
+    {0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL},
+    {0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL},
+    {0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL},
+    {0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL},
+    {0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL},
+    {0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL},
+    {0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL},
+    {0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL},
+    {0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL},
+    {0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL},
+    {0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL},
+    {0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL},
+    {0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL},
+    {0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL},
+    {0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL},
+    {0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL},
+    {0x8533285c936b35deULL, 0xd53a88958f87275fULL},
+    {0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL},
+    {0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL},
+    {0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL},
+    {0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL},
+    {0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL},
+    {0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL},
+    {0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL},
+    {0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL},
+    {0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL},
+    {0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL},
+    {0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL},
+    {0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL},
+    {0x976e41088617ca01ULL, 0xd5be0503e085d813ULL},
+    {0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL},
+    {0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL},
+    {0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL},
+    {0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL},
+    {0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL},
+    {0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL},
+    {0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL},
+    {0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL},
+    {0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL},
+    {0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL},
+    {0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL},
+    {0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL},
+    {0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL},
+    {0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL},
+    {0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL},
+    {0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL},
+    {0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL},
+    {0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL},
+    {0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL},
+    {0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL},
+    {0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL},
+    {0xa0555e361951c366ULL, 0xd7e105bcc332621fULL},
+    {0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL},
+    {0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL},
+    {0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL},
+    {0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL},
+    {0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL},
+    {0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL},
+    {0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL},
+    {0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL},
+    {0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL},
+    {0xbaa718e68396cffdULL, 0xd30560258f54e6baULL},
+    {0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL},
+    {0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL},
+    {0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL},
+    {0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL},
+    {0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL},
+    {0xb201833b35d63f73ULL, 0x2cd2cc6551e513daULL},
+    {0xde81e40a034bcf4fULL, 0xf8077f7ea65e58d1ULL},
+    {0x8b112e86420f6191ULL, 0xfb04afaf27faf782ULL},
+    {0xadd57a27d29339f6ULL, 0x79c5db9af1f9b563ULL},
+    {0xd94ad8b1c7380874ULL, 0x18375281ae7822bcULL},
+    {0x87cec76f1c830548ULL, 0x8f2293910d0b15b5ULL},
+    {0xa9c2794ae3a3c69aULL, 0xb2eb3875504ddb22ULL},
+    {0xd433179d9c8cb841ULL, 0x5fa60692a46151ebULL},
+    {0x849feec281d7f328ULL, 0xdbc7c41ba6bcd333ULL},
+    {0xa5c7ea73224deff3ULL, 0x12b9b522906c0800ULL},
+    {0xcf39e50feae16befULL, 0xd768226b34870a00ULL},
+    {0x81842f29f2cce375ULL, 0xe6a1158300d46640ULL},
+    {0xa1e53af46f801c53ULL, 0x60495ae3c1097fd0ULL},
+    {0xca5e89b18b602368ULL, 0x385bb19cb14bdfc4ULL},
+    {0xfcf62c1dee382c42ULL, 0x46729e03dd9ed7b5ULL},
+    {0x9e19db92b4e31ba9ULL, 0x6c07a2c26a8346d1ULL},
+    {0xc5a05277621be293ULL, 0xc7098b7305241885ULL},
+    {0xf70867153aa2db38ULL, 0xb8cbee4fc66d1ea7ULL},
+    {0x9a65406d44a5c903ULL, 0x737f74f1dc043328ULL},
+    {0xc0fe908895cf3b44ULL, 0x505f522e53053ff2ULL},
+    {0xf13e34aabb430a15ULL, 0x647726b9e7c68fefULL},
+    {0x96c6e0eab509e64dULL, 0x5eca783430dc19f5ULL},
+    {0xbc789925624c5fe0ULL, 0xb67d16413d132072ULL},
+    {0xeb96bf6ebadf77d8ULL, 0xe41c5bd18c57e88fULL},
+    {0x933e37a534cbaae7ULL, 0x8e91b962f7b6f159ULL},
+    {0xb80dc58e81fe95a1ULL, 0x723627bbb5a4adb0ULL},
+    {0xe61136f2227e3b09ULL, 0xcec3b1aaa30dd91cULL},
+    {0x8fcac257558ee4e6ULL, 0x213a4f0aa5e8a7b1ULL},
+    {0xb3bd72ed2af29e1fULL, 0xa988e2cd4f62d19dULL},
+    {0xe0accfa875af45a7ULL, 0x93eb1b80a33b8605ULL},
+    {0x8c6c01c9498d8b88ULL, 0xbc72f130660533c3ULL},
+    {0xaf87023b9bf0ee6aULL, 0xeb8fad7c7f8680b4ULL},
+    {0xdb68c2ca82ed2a05ULL, 0xa67398db9f6820e1ULL},
+    {0x892179be91d43a43ULL, 0x88083f8943a1148cULL},
+    {0xab69d82e364948d4ULL, 0x6a0a4f6b948959b0ULL},
+    {0xd6444e39c3db9b09ULL, 0x848ce34679abb01cULL},
+    {0x85eab0e41a6940e5ULL, 0xf2d80e0c0c0b4e11ULL},
+    {0xa7655d1d2103911fULL, 0x6f8e118f0f0e2195ULL},
+    {0xd13eb46469447567ULL, 0x4b7195f2d2d1a9fbULL},
+};
+
+// The powers of ten which are exact doubles.
+const double kExactPowersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                    1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                    1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Returns the low half of the 128-bit product of |a| and |b|, and stores the
+// high half in |high|.
+inline uint64_t Multiply128(uint64_t a, uint64_t b, uint64_t* high) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+  *high = static_cast<uint64_t>(product >> 64);
+  return static_cast<uint64_t>(product);
+#else
+  uint64_t a_low = a & 0xffffffff;
+  uint64_t a_high = a >> 32;
+  uint64_t b_low = b & 0xffffffff;
+  uint64_t b_high = b >> 32;
+  uint64_t low_low = a_low * b_low;
+  uint64_t high_low = a_high * b_low;
+  uint64_t middle = (low_low >> 32) + (high_low & 0xffffffff) + a_low * b_high;
+  *high = a_high * b_high + (high_low >> 32) + (middle >> 32);
+  return (middle << 32) | (low_low & 0xffffffff);
+#endif
+}
+
+// Double to string ------------------------------------------------------------
+
+inline int Pow5Bits(int e) {
+  return static_cast<int>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e)) and floor(log10(5^e)), for non-negative |e|.
+inline uint32_t Log10Pow2(int e) {
+  return (static_cast<uint32_t>(e) * 78913) >> 18;
+}
+
+inline uint32_t Log10Pow5(int e) {
+  return (static_cast<uint32_t>(e) * 732923) >> 20;
+}
+
+inline bool IsMultipleOfPowerOf5(uint64_t value, uint32_t p) {
+  uint32_t count = 0;
+  while (value % 5 == 0) {
+    value /= 5;
+    ++count;
+  }
+  return count >= p;
+}
+
+inline bool IsMultipleOfPowerOf2(uint64_t value, uint32_t p) {
+  return (value & ((uint64_t{1} << p) - 1)) == 0;
+}
+
+// Returns (|m| * |mul|) >> |shift|, where the result fits in 64 bits.
+inline uint64_t MultiplyShift(uint64_t m, const UInt128& mul, int shift) {
+  uint64_t high0;
+  Multiply128(m, mul.low, &high0);
+  uint64_t high1;
+  uint64_t low1 = Multiply128(m, mul.high, &high1);
+  uint64_t sum_low = high0 + low1;
+  uint64_t sum_high = high1 + (sum_low < high0);
+  shift -= 64;
+  DCHECK_GT(shift, 0);
+  DCHECK_LT(shift, 64);
+  return (sum_high << (64 - shift)) | (sum_low >> shift);
+}
+
+// Computes the shortest decimal |digits| * 10^|exponent| which is closer to
+// the double with the given non-zero finite mantissa and biased exponent than
+// to any other double, picking the closest one to the exact value when
+// several have the same length.
+void ShortestDecimal(uint64_t ieee_mantissa,
+                     uint32_t ieee_exponent,
+                     uint64_t* digits,
+                     int* exponent) {
+  // The double is m2 * 2^e2. It is subtracted two from e2 so that the
+  // boundaries of the interval of values which round to the double, halfway
+  // to its neighbors, are integers: mm and mp below.
+  int e2;
+  uint64_t m2;
+  if (ieee_exponent == 0) {
+    e2 = 1 - kExponentBias - kMantissaBits - 2;
+    m2 = ieee_mantissa;
+  } else {
+    e2 = static_cast<int>(ieee_exponent) - kExponentBias - kMantissaBits - 2;
+    m2 = (uint64_t{1} << kMantissaBits) | ieee_mantissa;
+  }
+  // The boundaries round to the double when its mantissa is even, since ties
+  // are broken to even when parsing.
+  const bool accept_bounds = (m2 & 1) == 0;
+
+  const uint64_t mv = 4 * m2;
+  // The gap to the previous double is halved at powers of two.
+  const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+  // mp = mv + 2 and mm = mv - 1 - mm_shift.
+
+  // Converts the interval to a decimal exponent, dropping e10 digits, and
+  // tracks whether the dropped digits of vm and vr are all zeros.
+  uint64_t vr, vp, vm;
+  int e10;
+  bool vm_is_trailing_zeros = false;
+  bool vr_is_trailing_zeros = false;
+  if (e2 >= 0) {
+    const uint32_t q = Log10Pow2(e2) - (e2 > 3);
+    e10 = static_cast<int>(q);
+    const int k = kPow5InvBitCount + Pow5Bits(static_cast<int>(q)) - 1;
+    const int i = -e2 + static_cast<int>(q) + k;
+    DCHECK_LT(q, arraysize(kPow5InvSplit));
+    vr = MultiplyShift(mv, kPow5InvSplit[q], i);
+    vp = MultiplyShift(mv + 2, kPow5InvSplit[q], i);
+    vm = MultiplyShift(mv - 1 - mm_shift, kPow5InvSplit[q], i);
+    if (q <= 21) {
+      // At most one of mp, mv and mm can be a multiple of 5.
+      if (mv % 5 == 0)
+        vr_is_trailing_zeros = IsMultipleOfPowerOf5(mv, q);
+      else if (accept_bounds)
+        vm_is_trailing_zeros = IsMultipleOfPowerOf5(mv - 1 - mm_shift, q);
+      else
+        vp -= IsMultipleOfPowerOf5(mv + 2, q);
+    }
+  } else {
+    const uint32_t q = Log10Pow5(-e2) - (-e2 > 1);
+    e10 = static_cast<int>(q) + e2;
+    const int i = -e2 - static_cast<int>(q);
+    const int k = Pow5Bits(i) - kPow5BitCount;
+    const int j = static_cast<int>(q) - k;
+    DCHECK_LT(static_cast<size_t>(i), arraysize(kPow5Split));
+    vr = MultiplyShift(mv, kPow5Split[i], j);
+    vp = MultiplyShift(mv + 2, kPow5Split[i], j);
+    vm = MultiplyShift(mv - 1 - mm_shift, kPow5Split[i], j);
+    if (q <= 1) {
+      // mv has at least two trailing zero bits, mp at least one, and mm has
+      // one when mm_shift is 1.
+      vr_is_trailing_zeros = true;
+      if (accept_bounds)
+        vm_is_trailing_zeros = mm_shift == 1;
+      else
+        --vp;
+    } else if (q < 63) {
+      vr_is_trailing_zeros = IsMultipleOfPowerOf2(mv, q);
+    }
+  }
+
+  // Removes digits while the interval still contains a shorter number.
+  int removed = 0;
+  uint64_t output;
+  if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+    // The general case, which is rare.
+    uint32_t last_removed_digit = 0;
+    while (vp / 10 > vm / 10) {
+      vm_is_trailing_zeros &= vm % 10 == 0;
+      vr_is_trailing_zeros &= last_removed_digit == 0;
+      last_removed_digit = static_cast<uint32_t>(vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    if (vm_is_trailing_zeros) {
+      while (vm % 10 == 0) {
+        vr_is_trailing_zeros &= last_removed_digit == 0;
+        last_removed_digit = static_cast<uint32_t>(vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        ++removed;
+      }
+    }
+    // Rounds half to even when the exact value ends in 5000...
+    if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+      last_removed_digit = 4;
+    output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+                   last_removed_digit >= 5);
+  } else {
+    bool round_up = false;
+    if (vp / 100 > vm / 100) {
+      round_up = vr % 100 >= 50;
+      vr /= 100;
+      vp /= 100;
+      vm /= 100;
+      removed += 2;
+    }
+    while (vp / 10 > vm / 10) {
+      round_up = vr % 10 >= 5;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    output = vr + (vr == vm || round_up);
+  }
+
+  // Rounding up may have produced trailing zeros, which dtoa never outputs.
+  e10 += removed;
+  while (output % 10 == 0) {
+    output /= 10;
+    ++e10;
+  }
+  *digits = output;
+  *exponent = e10;
+}
+
+// String to double ------------------------------------------------------------
+
+// Returns the double nearest to |mantissa| * 10^|exponent|, where |mantissa|
+// is not zero, using the Eisel-Lemire algorithm. Returns false when the result
+// isn't a finite normal double, or when the 128-bit approximation of the power
+// of ten isn't precise enough to round correctly, which is rare.
+bool EiselLemire(uint64_t mantissa, int exponent, uint64_t* bits) {
+  if (exponent < kMinPowerOfTen || exponent > kMaxPowerOfTen)
+    return false;
+  const UInt128& power = kPowersOfTen[exponent - kMinPowerOfTen];
+
+  // Normalizes the mantissa so that its top bit is set. The binary exponent
+  // of the power of ten is floor(log2(10) * exponent).
+  const int leading_zeros =
+      static_cast<int>(bits::CountLeadingZeroBits(mantissa));
+  mantissa <<= leading_zeros;
+  int64_t result_exponent = ((217706 * static_cast<int64_t>(exponent)) >> 16) +
+                            64 + kExponentBias - leading_zeros;
+
+  uint64_t high;
+  uint64_t low = Multiply128(mantissa, power.high, &high);
+  // When the bits below the 54 that are kept could carry, the low half of the
+  // power of ten is taken into account as well.
+  if ((high & 0x1ff) == 0x1ff && low + mantissa < mantissa) {
+    uint64_t extra_high;
+    uint64_t extra_low = Multiply128(mantissa, power.low, &extra_high);
+    uint64_t merged_low = low + extra_high;
+    uint64_t merged_high = high + (merged_low < low);
+    if ((merged_high & 0x1ff) == 0x1ff && merged_low + 1 == 0 &&
+        extra_low + mantissa < mantissa) {
+      return false;
+    }
+    high = merged_high;
+    low = merged_low;
+  }
+
+  // Keeps 54 bits, one more than the mantissa of a double, for rounding.
+  const uint64_t top_bit = high >> 63;
+  uint64_t result = high >> (top_bit + 9);
+  result_exponent -= 1 ^ top_bit;
+
+  // The product may have been exactly halfway between two doubles, or just
+  // below, which can't be told apart.
+  if (low == 0 && (high & 0x1ff) == 0 && (result & 3) == 1)
+    return false;
+
+  // Rounds to 53 bits.
+  result += result & 1;
+  result >>= 1;
+  if (result >> (kMantissaBits + 1)) {
+    result >>= 1;
+    ++result_exponent;
+  }
+  if (result_exponent <= 0 || result_exponent >= kExponentMask)
+    return false;
+
+  *bits = (static_cast<uint64_t>(result_exponent) << kMantissaBits) |
+          (result & kMantissaMask);
+  return true;
+}
+
+inline bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+}  // namespace
+
+size_t DoubleToShortestString(double value, char* buffer) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const uint64_t ieee_mantissa = bits & kMantissaMask;
+  const uint32_t ieee_exponent =
+      static_cast<uint32_t>(bits >> kMantissaBits) & kExponentMask;
+
+  char* out = buffer;
+  if (bits >> 63)
+    *out++ = '-';
+
+  // The digits, and the position of the decimal point relative to the first
+  // one, as returned by dtoa.
+  char digits[20];
+  char* digits_end = digits + arraysize(digits);
+  char* digits_begin;
+  int decimal_point;
+  if (ieee_exponent == kExponentMask) {
+    const char* name = ieee_mantissa ? "NaN" : "Infinity";
+    size_t length = strlen(name);
+    memcpy(out, name, length);
+    return out + length - buffer;
+  }
+  if (ieee_exponent == 0 && ieee_mantissa == 0) {
+    digits_begin = digits_end - 1;
+    *digits_begin = '0';
+    decimal_point = 1;
+  } else {
+    uint64_t decimal;
+    int exponent;
+    ShortestDecimal(ieee_mantissa, ieee_exponent, &decimal, &exponent);
+    digits_begin = FormatDecimalBackward(decimal, digits_end);
+    decimal_point = static_cast<int>(digits_end - digits_begin) + exponent;
+  }
+  const int num_digits = static_cast<int>(digits_end - digits_begin);
+
+  // Same layout as g_fmt().
+  if (decimal_point <= -4 || decimal_point > num_digits + 5) {
+    // Exponential notation, with at least two digits in the exponent.
+    *out++ = digits_begin[0];
+    if (num_digits > 1) {
+      *out++ = '.';
+      memcpy(out, digits_begin + 1, num_digits - 1);
+      out += num_digits - 1;
+    }
+    *out++ = 'e';
+    int exponent = decimal_point - 1;
+    if (exponent < 0) {
+      *out++ = '-';
+      exponent = -exponent;
+    } else {
+      *out++ = '+';
+    }
+    if (exponent >= 100) {
+      *out++ = static_cast<char>('0' + exponent / 100);
+      exponent %= 100;
+    }
+    memcpy(out, &kDecimalDigitPairs[exponent * 2], 2);
+    out += 2;
+  } else if (decimal_point <= 0) {
+    // No leading zero before the decimal point.
+    *out++ = '.';
+    memset(out, '0', -decimal_point);
+    out += -decimal_point;
+    memcpy(out, digits_begin, num_digits);
+    out += num_digits;
+  } else if (decimal_point >= num_digits) {
+    memcpy(out, digits_begin, num_digits);
+    out += num_digits;
+    memset(out, '0', decimal_point - num_digits);
+    out += decimal_point - num_digits;
+  } else {
+    memcpy(out, digits_begin, decimal_point);
+    out += decimal_point;
+    *out++ = '.';
+    memcpy(out, digits_begin + decimal_point, num_digits - decimal_point);
+    out += num_digits - decimal_point;
+  }
+  DCHECK_LE(static_cast<size_t>(out - buffer), kDoubleToStringBufferSize);
+  return out - buffer;
+}
+
+bool FastStringToDouble(StringPiece input, double* output) {
+  const char* p = input.data();
+  const char* const end = p + input.size();
+
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
+  }
+
+  // The significant digits, without leading zeros, and the power of ten they
+  // are multiplied by.
+  uint64_t mantissa = 0;
+  int num_digits = 0;
+  int exponent = 0;
+  bool has_digits = false;
+  for (; p != end && IsDigit(*p); ++p) {
+    has_digits = true;
+    if (mantissa == 0 && *p == '0')
+      continue;
+    if (++num_digits > 19)
+      return false;
+    mantissa = mantissa * 10 + (*p - '0');
+  }
+  if (p != end && *p == '.') {
+    for (++p; p != end && IsDigit(*p); ++p) {
+      has_digits = true;
+      --exponent;
+      if (mantissa == 0 && *p == '0')
+        continue;
+      if (++num_digits > 19)
+        return false;
+      mantissa = mantissa * 10 + (*p - '0');
+    }
+  }
+  if (!has_digits)
+    return false;
+
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    bool negative_exponent = false;
+    if (p != end && (*p == '-' || *p == '+')) {
+      negative_exponent = *p == '-';
+      ++p;
+    }
+    if (p == end || !IsDigit(*p))
+      return false;
+    // Larger exponents are left to the slow path, which handles overflow.
+    int explicit_exponent = 0;
+    for (; p != end && IsDigit(*p); ++p) {
+      explicit_exponent = explicit_exponent * 10 + (*p - '0');
+      if (explicit_exponent > 100000)
+        return false;
+    }
+    exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+  }
+  if (p != end)
+    return false;
+
+  if (mantissa == 0) {
+    *output = negative ? -0.0 : 0.0;
+    return true;
+  }
+
+  // Both the mantissa and the power of ten are exact doubles, so a single
+  // correctly rounded operation gives the correctly rounded result.
+  if (mantissa <= (uint64_t{1} << (kMantissaBits + 1)) && exponent >= -22 &&
+      exponent <= 22) {
+    double result = static_cast<double>(mantissa);
+    if (exponent < 0)
+      result /= kExactPowersOfTen[-exponent];
+    else
+      result *= kExactPowersOfTen[exponent];
+    *output = negative ? -result : result;
+    return true;
+  }
+
+  uint64_t bits;
+  if (!EiselLemire(mantissa, exponent, &bits))
+    return false;
+  if (negative)
+    bits |= uint64_t{1} << 63;
+  memcpy(output, &bits, sizeof(bits));
+  return true;
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,66 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_STRINGS_STRING_NUMBER_CONVERSIONS_INTERNAL_H_
+#define BASE_STRINGS_STRING_NUMBER_CONVERSIONS_INTERNAL_H_
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+namespace internal {
+
+// The decimal digits of 00 to 99, two characters each.
+extern const char kDecimalDigitPairs[200];
+
+// Writes the decimal digits of the unsigned integer |value| to the characters
+// ending before |end|, two at a time, and returns a pointer to the first one.
+template <typename CHAR, typename UINT>
+CHAR* FormatDecimalBackward(UINT value, CHAR* end) {
+  while (value >= 100) {
+    const char* pair = &kDecimalDigitPairs[(value % 100) * 2];
+    value /= 100;
+    *--end = static_cast<CHAR>(pair[1]);
+    *--end = static_cast<CHAR>(pair[0]);
+  }
+  if (value >= 10) {
+    const char* pair = &kDecimalDigitPairs[value * 2];
+    *--end = static_cast<CHAR>(pair[1]);
+    *--end = static_cast<CHAR>(pair[0]);
+  } else {
+    *--end = static_cast<CHAR>('0' + value);
+  }
+  return end;
+}
+
+// The longest output of DoubleToShortestString(), e.g.
+// "-2.2250738585072014e-308", is 24 characters.
+constexpr size_t kDoubleToStringBufferSize = 32;
+
+// Writes the shortest decimal representation of |value| which converts back
+// to it, exactly as dmg_fp::g_fmt() formats it, to |buffer|, and returns the
+// number of characters written. No terminating NUL is written. |buffer| must
+// hold kDoubleToStringBufferSize characters.
+//
+// This uses the Ryu algorithm (Ulf Adams, "Ryu: fast float-to-string
+// conversion", PLDI 2018), which only needs 128-bit multiplications by
+// precomputed powers of five, instead of dtoa's arbitrary precision arithmetic.
+BASE_EXPORT size_t DoubleToShortestString(double value, char* buffer);
+
+// Converts |input| to the nearest double, for the inputs which can be
+// converted without arbitrary precision arithmetic: decimal numbers in the
+// format accepted by dmg_fp::strtod(), with at most 19 significant digits,
+// whose value is a finite normal double. Returns false for all other inputs,
+// without writing to |output|; they need the slow path.
+//
+// This uses Clinger's fast path when the digits and the power of ten are both
+// exact doubles, and the Eisel-Lemire algorithm otherwise.
+BASE_EXPORT bool FastStringToDouble(StringPiece input, double* output);
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_STRINGS_STRING_NUMBER_CONVERSIONS_INTERNAL_H_
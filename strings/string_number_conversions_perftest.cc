@@ -0,0 +1,124 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/string_number_conversions.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "base/bit_cast.h"
+#include "base/debug/alias.h"
+#include "base/third_party/dmg_fp/dmg_fp.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kIterations = 1000000;
+
+// Numbers with few digits, as they typically appear in JSON.
+std::vector<double> ShortDoubles() {
+  std::mt19937_64 generator(42);
+  std::vector<double> values;
+  for (int i = 0; i < 1000; ++i)
+    values.push_back(static_cast<double>(generator() % 1000000) / 100);
+  return values;
+}
+
+// Doubles with random bits, which mostly need 16 or 17 digits.
+std::vector<double> RandomDoubles() {
+  std::mt19937_64 generator(42);
+  std::vector<double> values;
+  while (values.size() < 1000) {
+    double value = bit_cast<double>(static_cast<uint64_t>(generator()));
+    if (std::isfinite(value))
+      values.push_back(value);
+  }
+  return values;
+}
+
+size_t FormatWithDmgFp(double value, char* buffer) {
+  return strlen(dmg_fp::g_fmt(buffer, value));
+}
+
+size_t FormatWithNumberToBuffer(double value, char* buffer) {
+  return NumberToBuffer(value, span<char>(buffer, kMaxNumberToBufferLength));
+}
+
+double ParseWithDmgFp(const std::string& input) {
+  char* endptr;
+  return dmg_fp::strtod(input.c_str(), &endptr);
+}
+
+double ParseWithStringToDouble(const std::string& input) {
+  double output;
+  StringToDouble(input, &output);
+  return output;
+}
+
+void RunFormatTest(const char* trace,
+                   const std::vector<double>& values,
+                   size_t (*format)(double, char*)) {
+  char buffer[kMaxNumberToBufferLength];
+  size_t total_length = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i)
+    total_length += format(values[i % values.size()], buffer);
+  TimeDelta elapsed = TimeTicks::Now() - start;
+  debug::Alias(&total_length);
+  perf_test::PrintResult(
+      "double_to_string", "", trace,
+      static_cast<double>(elapsed.InNanoseconds()) / kIterations, "ns/number",
+      true);
+}
+
+void RunParseTest(const char* trace,
+                  const std::vector<double>& values,
+                  double (*parse)(const std::string&)) {
+  std::vector<std::string> inputs;
+  for (double value : values)
+    inputs.push_back(NumberToString(value));
+
+  double total = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i)
+    total += parse(inputs[i % inputs.size()]);
+  TimeDelta elapsed = TimeTicks::Now() - start;
+  debug::Alias(&total);
+  perf_test::PrintResult(
+      "string_to_double", "", trace,
+      static_cast<double>(elapsed.InNanoseconds()) / kIterations, "ns/number",
+      true);
+}
+
+}  // namespace
+
+TEST(StringNumberConversionsPerfTest, DoubleToString) {
+  RunFormatTest("dmg_fp_short", ShortDoubles(), &FormatWithDmgFp);
+  RunFormatTest("NumberToBuffer_short", ShortDoubles(),
+                &FormatWithNumberToBuffer);
+  RunFormatTest("dmg_fp_random", RandomDoubles(), &FormatWithDmgFp);
+  RunFormatTest("NumberToBuffer_random", RandomDoubles(),
+                &FormatWithNumberToBuffer);
+}
+
+TEST(StringNumberConversionsPerfTest, StringToDouble) {
+  RunParseTest("dmg_fp_short", ShortDoubles(), &ParseWithDmgFp);
+  RunParseTest("StringToDouble_short", ShortDoubles(),
+               &ParseWithStringToDouble);
+  RunParseTest("dmg_fp_random", RandomDoubles(), &ParseWithDmgFp);
+  RunParseTest("StringToDouble_random", RandomDoubles(),
+               &ParseWithStringToDouble);
+}
+
+}  // namespace base
@@ -4,6 +4,7 @@
 
 #include "base/strings/string_number_conversions.h"
 
+#include <ctype.h>
 #include <errno.h>
 #include <limits.h>
 #include <stddef.h>
@@ -12,12 +13,16 @@
 
 #include <cmath>
 #include <limits>
+#include <random>
+#include <string>
+#include <vector>
 
 #include "base/bit_cast.h"
 #include "base/format_macros.h"
 #include "base/macros.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/third_party/dmg_fp/dmg_fp.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -31,6 +36,42 @@ struct NumberToStringTest {
   const char* uexpected;
 };
 
+// The doubles whose conversions to and from strings are compared against
+// dmg_fp: the special values, powers of two and of ten across the whole range,
+// and random bit patterns.
+std::vector<double> InterestingDoubles() {
+  std::vector<double> values = {
+      0.0,
+      std::numeric_limits<double>::denorm_min(),
+      std::numeric_limits<double>::min(),
+      std::numeric_limits<double>::max(),
+      std::numeric_limits<double>::epsilon(),
+      std::numeric_limits<double>::infinity(),
+      std::numeric_limits<double>::quiet_NaN(),
+      0.1,
+      1.0 / 3.0,
+      5e-324,
+      9007199254740993.0,
+  };
+  for (int e = -1074; e <= 1023; ++e)
+    values.push_back(std::ldexp(1.0, e));
+  for (int e = -323; e <= 308; ++e) {
+    values.push_back(std::pow(10.0, e));
+    values.push_back(std::nextafter(std::pow(10.0, e), 0.0));
+  }
+  std::mt19937_64 generator(42);
+  for (int i = 0; i < 20000; ++i)
+    values.push_back(bit_cast<double>(static_cast<uint64_t>(generator())));
+  // Short decimals, which are the common case.
+  for (int i = 0; i < 10000; ++i)
+    values.push_back(static_cast<double>(generator() % 1000000) / 1000);
+
+  size_t size = values.size();
+  for (size_t i = 0; i < size; ++i)
+    values.push_back(-values[i]);
+  return values;
+}
+
 }  // namespace
 
 TEST(StringNumberConversionsTest, NumberToString) {
@@ -844,6 +885,50 @@ TEST(StringNumberConversionsTest, DoubleToString) {
   EXPECT_EQ("1334890332160", NumberToString(input));
 }
 
+TEST(StringNumberConversionsTest, DoubleToStringMatchesDmgFp) {
+  for (double value : InterestingDoubles()) {
+    char expected[32];
+    dmg_fp::g_fmt(expected, value);
+    EXPECT_EQ(expected, NumberToString(value)) << bit_cast<uint64_t>(value);
+  }
+}
+
+TEST(StringNumberConversionsTest, NumberToBuffer) {
+  char buffer[kMaxNumberToBufferLength];
+  EXPECT_EQ("-2147483648",
+            StringPiece(buffer, NumberToBuffer(std::numeric_limits<int>::min(),
+                                               buffer)));
+  EXPECT_EQ("4294967295",
+            StringPiece(buffer, NumberToBuffer(UINT_MAX, buffer)));
+  EXPECT_EQ("-9223372036854775808",
+            StringPiece(buffer, NumberToBuffer(
+                                    std::numeric_limits<int64_t>::min(),
+                                    buffer)));
+  EXPECT_EQ("18446744073709551615",
+            StringPiece(buffer, NumberToBuffer(
+                                    std::numeric_limits<uint64_t>::max(),
+                                    buffer)));
+  EXPECT_EQ("0", StringPiece(buffer, NumberToBuffer(0, buffer)));
+  EXPECT_EQ("-2.2250738585072014e-308",
+            StringPiece(buffer,
+                        NumberToBuffer(-std::numeric_limits<double>::min(),
+                                       buffer)));
+
+  for (int i = -1000; i <= 1000; i += 7) {
+    EXPECT_EQ(NumberToString(i),
+              StringPiece(buffer, NumberToBuffer(i, buffer)));
+    EXPECT_EQ(NumberToString(i * 12345678901LL),
+              StringPiece(buffer, NumberToBuffer(i * 12345678901LL, buffer)));
+    EXPECT_EQ(NumberToString(i / 7.0),
+              StringPiece(buffer, NumberToBuffer(i / 7.0, buffer)));
+  }
+
+  // Only the characters written are needed.
+  char small[2];
+  EXPECT_EQ(2u, NumberToBuffer(-1, small));
+  EXPECT_EQ("-1", StringPiece(small, 2));
+}
+
 TEST(StringNumberConversionsTest, HexEncode) {
   std::string hex(HexEncode(nullptr, 0));
   EXPECT_EQ(hex.length(), 0U);
@@ -902,4 +987,61 @@ TEST(StringNumberConversionsTest, StrtodFailures) {
   }
 }
 
+// Parses |input| with StringToDouble() and dmg_fp::strtod(), and checks that
+// the results are the same.
+void ExpectStringToDoubleMatchesDmgFp(const std::string& input) {
+  errno = 0;
+  char* endptr = nullptr;
+  double expected = dmg_fp::strtod(input.c_str(), &endptr);
+  bool expected_success = errno == 0 && !input.empty() &&
+                          endptr == input.c_str() + input.size() &&
+                          !isspace(input[0]);
+
+  double output;
+  EXPECT_EQ(expected_success, StringToDouble(input, &output)) << input;
+  EXPECT_EQ(bit_cast<uint64_t>(expected), bit_cast<uint64_t>(output))
+      << input;
+}
+
+TEST(StringNumberConversionsTest, StringToDoubleMatchesDmgFp) {
+  for (double value : InterestingDoubles()) {
+    if (!std::isfinite(value))
+      continue;
+    ExpectStringToDoubleMatchesDmgFp(NumberToString(value));
+    for (int precision : {1, 6, 15, 16, 17, 19, 25})
+      ExpectStringToDoubleMatchesDmgFp(StringPrintf("%.*e", precision, value));
+  }
+
+  // Random digits, decimal points and exponents.
+  std::mt19937_64 generator(42);
+  for (int i = 0; i < 20000; ++i) {
+    std::string input;
+    if (generator() % 2)
+      input.push_back("+-"[generator() % 2]);
+    int num_digits = generator() % 22;
+    int point = generator() % (num_digits + 2);
+    for (int j = 0; j < num_digits; ++j) {
+      if (j == point)
+        input.push_back('.');
+      input.push_back(static_cast<char>('0' + generator() % 10));
+    }
+    if (generator() % 2) {
+      input.append(generator() % 2 ? "e" : "E-");
+      input.append(IntToString(generator() % 400));
+    }
+    ExpectStringToDoubleMatchesDmgFp(input);
+  }
+
+  const char* const inputs[] = {
+      "0e999999999", "-0", "0.000", "1e-400", "1e400", "123456789e-330",
+      "2.2250738585072011e-308", "2.2250738585072014e-308",
+      "1.7976931348623157e308", "1.7976931348623159e308",
+      "9007199254740993", "9007199254740992.5", "4503599627370496.5",
+      "1.00000000000000011102230246251565404236316680908203126",
+      "1e", "1e+", ".", "-.", ".e1", "1..2", "0x10", "inf", "nan",
+  };
+  for (const char* input : inputs)
+    ExpectStringToDoubleMatchesDmgFp(input);
+}
+
 }  // namespace base
@@ -6,6 +6,7 @@
 #include "base/strings/string_piece.h"
 
 #include <limits.h>
+#include <string.h>
 
 #include <algorithm>
 #include <ostream>
@@ -117,7 +118,30 @@ size_t findT(const BasicStringPiece<STR>& self,
 }
 
 size_t find(const StringPiece& self, const StringPiece& s, size_t pos) {
-  return findT(self, s, pos);
+  if (pos > self.size())
+    return StringPiece::npos;
+  if (s.empty())
+    return pos;
+  if (self.size() - pos < s.size())
+    return StringPiece::npos;
+
+  // Finds the candidates by their first character with memchr(), which libc
+  // vectorizes, and checks their last character before comparing the rest.
+  const char* const begin = self.data();
+  const char* const last_start = begin + self.size() - s.size();
+  const char first = s[0];
+  const char last = s[s.size() - 1];
+  for (const char* start = begin + pos; start <= last_start; ++start) {
+    start = static_cast<const char*>(
+        memchr(start, first, static_cast<size_t>(last_start - start) + 1));
+    if (!start)
+      break;
+    if (start[s.size() - 1] == last &&
+        memcmp(start + 1, s.data() + 1, s.size() - 1) == 0) {
+      return static_cast<size_t>(start - begin);
+    }
+  }
+  return StringPiece::npos;
 }
 
 size_t find(const StringPiece16& self, const StringPiece16& s, size_t pos) {
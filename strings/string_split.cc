@@ -8,6 +8,7 @@
 
 #include "base/logging.h"
 #include "base/strings/string_util.h"
+#include "base/strings/substring_searcher.h"
 #include "base/third_party/icu/icu_utf.h"
 
 namespace base {
@@ -42,61 +43,52 @@ template<> StringPiece WhitespaceForType<std::string>() {
   return kWhitespaceASCII;
 }
 
-// Optimize the single-character case to call find() on the string instead,
-// since this is the common case and can be made faster. This could have been
-// done with template specialization too, but would have been less clear.
-//
-// There is no corresponding FindFirstNotOf because StringPiece already
-// implements these different versions that do the optimized searching.
-size_t FindFirstOf(StringPiece piece, char c, size_t pos) {
-  return piece.find(c, pos);
-}
-size_t FindFirstOf(StringPiece16 piece, char16 c, size_t pos) {
-  return piece.find(c, pos);
-}
-size_t FindFirstOf(StringPiece piece, StringPiece one_of, size_t pos) {
-  return piece.find_first_of(one_of, pos);
-}
-size_t FindFirstOf(StringPiece16 piece, StringPiece16 one_of, size_t pos) {
-  return piece.find_first_of(one_of, pos);
-}
-
-// General string splitter template. Can take 8- or 16-bit input, can produce
-// the corresponding string or StringPiece output, and can take single- or
-// multiple-character delimiters.
-//
-// DelimiterType is either a character (Str::value_type) or a string piece of
-// multiple characters (BasicStringPiece<Str>). StringPiece has a version of
-// find for both of these cases, and the single-character version is the most
-// common and can be implemented faster, which is why this is a template.
-template<typename Str, typename OutputStringType, typename DelimiterType>
-static std::vector<OutputStringType> SplitStringT(
-    BasicStringPiece<Str> str,
-    DelimiterType delimiter,
-    WhitespaceHandling whitespace,
-    SplitResult result_type) {
-  std::vector<OutputStringType> result;
-  if (str.empty())
-    return result;
-
-  size_t start = 0;
+// Implementation of internal::NextSplitPiece().
+template <typename Str>
+bool NextSplitPieceT(BasicStringPiece<Str> input,
+                     const internal::SeparatorSet<Str>& separators,
+                     WhitespaceHandling whitespace,
+                     SplitResult result_type,
+                     size_t* position,
+                     BasicStringPiece<Str>* piece) {
+  size_t start = *position;
   while (start != Str::npos) {
-    size_t end = FindFirstOf(str, delimiter, start);
+    size_t end = separators.FindFirst(input, start);
 
-    BasicStringPiece<Str> piece;
     if (end == Str::npos) {
-      piece = str.substr(start);
+      *piece = input.substr(start);
       start = Str::npos;
     } else {
-      piece = str.substr(start, end - start);
+      *piece = input.substr(start, end - start);
       start = end + 1;
     }
 
     if (whitespace == TRIM_WHITESPACE)
-      piece = TrimString(piece, WhitespaceForType<Str>(), TRIM_ALL);
+      *piece = TrimString(*piece, WhitespaceForType<Str>(), TRIM_ALL);
 
-    if (result_type == SPLIT_WANT_ALL || !piece.empty())
-      result.push_back(PieceToOutputType<Str, OutputStringType>(piece));
+    if (result_type == SPLIT_WANT_ALL || !piece->empty()) {
+      *position = start;
+      return true;
+    }
+  }
+  *position = Str::npos;
+  return false;
+}
+
+// General string splitter template. Can take 8- or 16-bit input, and can
+// produce the corresponding string or StringPiece output.
+template <typename Str, typename OutputStringType>
+std::vector<OutputStringType> SplitStringT(BasicStringPiece<Str> str,
+                                           BasicStringPiece<Str> separators,
+                                           WhitespaceHandling whitespace,
+                                           SplitResult result_type) {
+  std::vector<OutputStringType> result;
+  internal::SeparatorSet<Str> separator_set(separators);
+  size_t position = str.empty() ? Str::npos : 0;
+  BasicStringPiece<Str> piece;
+  while (NextSplitPieceT(str, separator_set, whitespace, result_type, &position,
+                         &piece)) {
+    result.push_back(PieceToOutputType<Str, OutputStringType>(piece));
   }
   return result;
 }
@@ -130,6 +122,24 @@ bool AppendStringKeyValue(StringPiece input,
   return true;
 }
 
+// Finds the delimiter of SplitStringUsingSubstrT(), which is searched for
+// repeatedly: with a SubstringSearcher in 8-bit strings.
+struct DelimiterSearcher16 {
+  size_t Find(StringPiece16 input, size_t pos) const {
+    return input.find(delimiter, pos);
+  }
+
+  StringPiece16 delimiter;
+};
+
+SubstringSearcher MakeDelimiterSearcher(StringPiece delimiter) {
+  return SubstringSearcher(delimiter);
+}
+
+DelimiterSearcher16 MakeDelimiterSearcher(StringPiece16 delimiter) {
+  return DelimiterSearcher16{delimiter};
+}
+
 template <typename Str, typename OutputStringType>
 void SplitStringUsingSubstrT(BasicStringPiece<Str> input,
                              BasicStringPiece<Str> delimiter,
@@ -140,9 +150,10 @@ void SplitStringUsingSubstrT(BasicStringPiece<Str> input,
   using size_type = typename Piece::size_type;
 
   result->clear();
+  const auto searcher = MakeDelimiterSearcher(delimiter);
   for (size_type begin_index = 0, end_index = 0; end_index != Piece::npos;
        begin_index = end_index + delimiter.size()) {
-    end_index = input.find(delimiter, begin_index);
+    end_index = searcher.Find(input, begin_index);
     Piece term = end_index == Piece::npos
                      ? input.substr(begin_index)
                      : input.substr(begin_index, end_index - begin_index);
@@ -161,63 +172,68 @@ std::vector<std::string> SplitString(StringPiece input,
                                      StringPiece separators,
                                      WhitespaceHandling whitespace,
                                      SplitResult result_type) {
-  if (separators.size() == 1) {
-    return SplitStringT<std::string, std::string, char>(
-        input, separators[0], whitespace, result_type);
-  }
-  return SplitStringT<std::string, std::string, StringPiece>(
-      input, separators, whitespace, result_type);
+  return SplitStringT<std::string, std::string>(input, separators, whitespace,
+                                                result_type);
 }
 
 std::vector<string16> SplitString(StringPiece16 input,
                                   StringPiece16 separators,
                                   WhitespaceHandling whitespace,
                                   SplitResult result_type) {
-  if (separators.size() == 1) {
-    return SplitStringT<string16, string16, char16>(
-        input, separators[0], whitespace, result_type);
-  }
-  return SplitStringT<string16, string16, StringPiece16>(
-      input, separators, whitespace, result_type);
+  return SplitStringT<string16, string16>(input, separators, whitespace,
+                                          result_type);
 }
 
 std::vector<StringPiece> SplitStringPiece(StringPiece input,
                                           StringPiece separators,
                                           WhitespaceHandling whitespace,
                                           SplitResult result_type) {
-  if (separators.size() == 1) {
-    return SplitStringT<std::string, StringPiece, char>(
-        input, separators[0], whitespace, result_type);
-  }
-  return SplitStringT<std::string, StringPiece, StringPiece>(
-      input, separators, whitespace, result_type);
+  return SplitStringT<std::string, StringPiece>(input, separators, whitespace,
+                                                result_type);
 }
 
 std::vector<StringPiece16> SplitStringPiece(StringPiece16 input,
                                             StringPiece16 separators,
                                             WhitespaceHandling whitespace,
                                             SplitResult result_type) {
-  if (separators.size() == 1) {
-    return SplitStringT<string16, StringPiece16, char16>(
-        input, separators[0], whitespace, result_type);
-  }
-  return SplitStringT<string16, StringPiece16, StringPiece16>(
-      input, separators, whitespace, result_type);
+  return SplitStringT<string16, StringPiece16>(input, separators, whitespace,
+                                               result_type);
+}
+
+namespace internal {
+
+bool NextSplitPiece(StringPiece input,
+                    const SeparatorSet<std::string>& separators,
+                    WhitespaceHandling whitespace,
+                    SplitResult result_type,
+                    size_t* position,
+                    StringPiece* piece) {
+  return NextSplitPieceT(input, separators, whitespace, result_type, position,
+                         piece);
 }
 
+bool NextSplitPiece(StringPiece16 input,
+                    const SeparatorSet<string16>& separators,
+                    WhitespaceHandling whitespace,
+                    SplitResult result_type,
+                    size_t* position,
+                    StringPiece16* piece) {
+  return NextSplitPieceT(input, separators, whitespace, result_type, position,
+                         piece);
+}
+
+}  // namespace internal
+
 bool SplitStringIntoKeyValuePairs(StringPiece input,
                                   char key_value_delimiter,
                                   char key_value_pair_delimiter,
                                   StringPairs* key_value_pairs) {
   key_value_pairs->clear();
 
-  std::vector<StringPiece> pairs = SplitStringPiece(
-      input, std::string(1, key_value_pair_delimiter),
-      TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY);
-  key_value_pairs->reserve(pairs.size());
-
   bool success = true;
-  for (const StringPiece& pair : pairs) {
+  for (StringPiece pair :
+       SplitStringPieceRange(input, StringPiece(&key_value_pair_delimiter, 1),
+                             TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY)) {
     if (!AppendStringKeyValue(pair, key_value_delimiter, key_value_pairs)) {
       // Don't return here, to allow for pairs without associated
       // value or key; just record that the split failed.
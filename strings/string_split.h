@@ -5,11 +5,18 @@
 #ifndef BASE_STRINGS_STRING_SPLIT_H_
 #define BASE_STRINGS_STRING_SPLIT_H_
 
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <iterator>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "base/base_export.h"
+#include "base/logging.h"
 #include "base/strings/string16.h"
 #include "base/strings/string_piece.h"
 
@@ -77,6 +84,189 @@ BASE_EXPORT std::vector<StringPiece16> SplitStringPiece(
     WhitespaceHandling whitespace,
     SplitResult result_type);
 
+namespace internal {
+
+// A set of separator characters, which finds them in strings faster than
+// StringPiece::find_first_of(): membership of the characters below 256 is
+// kept in a bitmap, and a single 8-bit separator is found with memchr().
+template <typename Str>
+class SeparatorSet {
+ public:
+  using CharT = typename Str::value_type;
+
+  explicit SeparatorSet(BasicStringPiece<Str> separators)
+      : num_separators_(separators.size()) {
+    for (CharT c : separators) {
+      UnsignedCharT value = static_cast<UnsignedCharT>(c);
+      if (value < 256)
+        bitmap_[value / 64] |= uint64_t{1} << (value % 64);
+      else
+        wide_separators_.push_back(c);
+    }
+    if (num_separators_ == 1)
+      single_separator_ = separators[0];
+  }
+
+  bool Contains(CharT c) const {
+    UnsignedCharT value = static_cast<UnsignedCharT>(c);
+    if (value < 256)
+      return (bitmap_[value / 64] >> (value % 64)) & 1;
+    return wide_separators_.find(c) != Str::npos;
+  }
+
+  // Returns the position of the first separator in |input| at or after
+  // |pos|, or npos.
+  size_t FindFirst(BasicStringPiece<Str> input, size_t pos) const {
+    if (pos >= input.size())
+      return Str::npos;
+    if (num_separators_ == 1)
+      return FindSingle(input, pos);
+    for (; pos < input.size(); ++pos) {
+      if (Contains(input[pos]))
+        return pos;
+    }
+    return Str::npos;
+  }
+
+ private:
+  using UnsignedCharT = typename std::make_unsigned<CharT>::type;
+
+  template <typename T = Str>
+  typename std::enable_if<sizeof(typename T::value_type) == 1, size_t>::type
+  FindSingle(BasicStringPiece<Str> input, size_t pos) const {
+    const void* found =
+        memchr(input.data() + pos, single_separator_, input.size() - pos);
+    return found ? static_cast<const CharT*>(found) - input.data() : Str::npos;
+  }
+
+  template <typename T = Str>
+  typename std::enable_if<sizeof(typename T::value_type) != 1, size_t>::type
+  FindSingle(BasicStringPiece<Str> input, size_t pos) const {
+    return input.find(single_separator_, pos);
+  }
+
+  uint64_t bitmap_[4] = {};
+  // The separators above 255, which only wide strings can have.
+  Str wide_separators_;
+  size_t num_separators_;
+  CharT single_separator_ = 0;
+};
+
+// Finds the next piece of |input| starting at |*position|, as the splitting
+// functions above return them, and updates |*position| to where the following
+// one starts. |*position| must start at 0, or npos for an empty |input|.
+// Returns false when there are no pieces left.
+BASE_EXPORT bool NextSplitPiece(StringPiece input,
+                                const SeparatorSet<std::string>& separators,
+                                WhitespaceHandling whitespace,
+                                SplitResult result_type,
+                                size_t* position,
+                                StringPiece* piece);
+BASE_EXPORT bool NextSplitPiece(StringPiece16 input,
+                                const SeparatorSet<string16>& separators,
+                                WhitespaceHandling whitespace,
+                                SplitResult result_type,
+                                size_t* position,
+                                StringPiece16* piece);
+
+}  // namespace internal
+
+// A lazy version of SplitStringPiece(): iterates over the same pieces as it
+// returns, but finds each one as it goes, without allocating. Like
+// SplitStringPiece(), the pieces point into |input|, which must outlive
+// them. This is useful to read the tokens of many strings once each:
+//
+//   for (StringPiece token : base::SplitStringPieceRange(
+//            line, ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+//     ...
+//   }
+template <typename Str>
+class BasicSplitStringPieceRange {
+ public:
+  using Piece = BasicStringPiece<Str>;
+
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Piece;
+    using difference_type = ptrdiff_t;
+    using pointer = const Piece*;
+    using reference = const Piece&;
+
+    // The end iterator.
+    Iterator() = default;
+
+    const Piece& operator*() const {
+      DCHECK(range_);
+      return piece_;
+    }
+    const Piece* operator->() const {
+      DCHECK(range_);
+      return &piece_;
+    }
+
+    Iterator& operator++() {
+      Advance();
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator previous = *this;
+      Advance();
+      return previous;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return range_ == other.range_ &&
+             (!range_ || position_ == other.position_);
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class BasicSplitStringPieceRange;
+
+    explicit Iterator(const BasicSplitStringPieceRange* range)
+        : range_(range), position_(range->input_.empty() ? Str::npos : 0) {
+      Advance();
+    }
+
+    void Advance() {
+      DCHECK(range_);
+      if (!internal::NextSplitPiece(range_->input_, range_->separators_,
+                                    range_->whitespace_, range_->result_type_,
+                                    &position_, &piece_)) {
+        range_ = nullptr;
+      }
+    }
+
+    // Null once past the last piece.
+    const BasicSplitStringPieceRange* range_ = nullptr;
+    size_t position_ = Str::npos;
+    Piece piece_;
+  };
+
+  BasicSplitStringPieceRange(Piece input,
+                             Piece separators,
+                             WhitespaceHandling whitespace,
+                             SplitResult result_type)
+      : input_(input),
+        separators_(separators),
+        whitespace_(whitespace),
+        result_type_(result_type) {}
+
+  // The iterators point to the range, so they must not outlive it.
+  Iterator begin() const { return Iterator(this); }
+  Iterator end() const { return Iterator(); }
+
+ private:
+  const Piece input_;
+  const internal::SeparatorSet<Str> separators_;
+  const WhitespaceHandling whitespace_;
+  const SplitResult result_type_;
+};
+
+using SplitStringPieceRange = BasicSplitStringPieceRange<std::string>;
+using SplitStringPiece16Range = BasicSplitStringPieceRange<string16>;
+
 using StringPairs = std::vector<std::pair<std::string, std::string>>;
 
 // Splits |line| into key value pairs according to the given delimiters and
@@ -383,4 +383,108 @@ TEST(StringSplitTest, SplitStringAlongWhitespace) {
   }
 }
 
+TEST(SplitStringPieceRangeTest, MatchesSplitStringPiece) {
+  const char* const kInputs[] = {
+      "",    ",",         ",,",          "a",       " a ",     "a,b",
+      ",a,", " a , b ,",  "a, ,b",       "a;b,c",   ";;,a;;b", "\t,\n,",
+      "abc", "a,b;c d,e", " , ; leading"};
+  const char* const kSeparators[] = {"", ",", ",;", ", ;\t"};
+  const WhitespaceHandling kWhitespace[] = {KEEP_WHITESPACE, TRIM_WHITESPACE};
+  const SplitResult kResultTypes[] = {SPLIT_WANT_ALL, SPLIT_WANT_NONEMPTY};
+
+  for (const char* input : kInputs) {
+    for (const char* separators : kSeparators) {
+      for (WhitespaceHandling whitespace : kWhitespace) {
+        for (SplitResult result_type : kResultTypes) {
+          std::vector<StringPiece> expected = SplitStringPiece(
+              input, separators, whitespace, result_type);
+          std::vector<StringPiece> actual;
+          for (StringPiece piece : SplitStringPieceRange(
+                   input, separators, whitespace, result_type)) {
+            actual.push_back(piece);
+          }
+          EXPECT_EQ(expected, actual) << "\"" << input << "\" split on \""
+                                      << separators << "\"";
+
+          std::vector<string16> expected16 =
+              SplitString(ASCIIToUTF16(input), ASCIIToUTF16(separators),
+                          whitespace, result_type);
+          std::vector<string16> actual16;
+          const string16 input16 = ASCIIToUTF16(input);
+          for (StringPiece16 piece : SplitStringPiece16Range(
+                   input16, ASCIIToUTF16(separators), whitespace,
+                   result_type)) {
+            actual16.push_back(piece.as_string());
+          }
+          EXPECT_EQ(expected16, actual16);
+        }
+      }
+    }
+  }
+}
+
+TEST(SplitStringPieceRangeTest, Iterators) {
+  const std::string input = "a,b,,c";
+  SplitStringPieceRange range(input, ",", KEEP_WHITESPACE,
+                              SPLIT_WANT_NONEMPTY);
+  auto it = range.begin();
+  EXPECT_EQ(it, range.begin());
+  EXPECT_NE(it, range.end());
+  EXPECT_EQ("a", *it);
+  EXPECT_EQ(1u, it->size());
+  EXPECT_EQ("a", *it++);
+  EXPECT_EQ("b", *it);
+  EXPECT_NE(it, range.begin());
+  EXPECT_EQ("c", *++it);
+  // The pieces point into the input.
+  EXPECT_EQ(input.data() + 5, it->data());
+  EXPECT_EQ(range.end(), ++it);
+
+  SplitStringPieceRange empty_range("", ",", KEEP_WHITESPACE, SPLIT_WANT_ALL);
+  EXPECT_EQ(empty_range.end(), empty_range.begin());
+}
+
+TEST(SplitStringPieceRangeTest, WideSeparators) {
+  // Separators above 255 aren't in the bitmap of SeparatorSet.
+  const string16 input = WideToUTF16(L"a\x2028" L"b \x3000" L"c\x00a0" L"d");
+  std::vector<string16> pieces;
+  for (StringPiece16 piece : SplitStringPiece16Range(
+           input, kWhitespaceUTF16, KEEP_WHITESPACE, SPLIT_WANT_NONEMPTY)) {
+    pieces.push_back(piece.as_string());
+  }
+  EXPECT_THAT(pieces, testing::ElementsAre(ASCIIToUTF16("a"), ASCIIToUTF16("b"),
+                                           ASCIIToUTF16("c"),
+                                           ASCIIToUTF16("d")));
+
+  // A single wide separator.
+  EXPECT_THAT(SplitString(input, WideToUTF16(L"\x3000"), KEEP_WHITESPACE,
+                          SPLIT_WANT_ALL),
+              testing::ElementsAre(WideToUTF16(L"a\x2028" L"b "),
+                                   WideToUTF16(L"c\x00a0" L"d")));
+}
+
+TEST(SplitStringPieceRangeTest, LongInput) {
+  // Exercises memchr() and the bitmap on long runs without separators.
+  std::string input;
+  for (int i = 0; i < 100; ++i) {
+    input += std::string(i * 7, 'x');
+    input += i % 2 ? ',' : ';';
+  }
+  size_t num_pieces = 0;
+  for (StringPiece piece : SplitStringPieceRange(input, ",", KEEP_WHITESPACE,
+                                                 SPLIT_WANT_ALL)) {
+    EXPECT_EQ(std::string::npos, piece.find(','));
+    ++num_pieces;
+  }
+  EXPECT_EQ(51u, num_pieces);
+
+  num_pieces = 0;
+  for (StringPiece piece : SplitStringPieceRange(input, ",;", KEEP_WHITESPACE,
+                                                 SPLIT_WANT_NONEMPTY)) {
+    EXPECT_EQ(std::string(num_pieces * 7 + 7, 'x'), piece);
+    ++num_pieces;
+  }
+  EXPECT_EQ(99u, num_pieces);
+}
+
 }  // namespace base
@@ -9,6 +9,7 @@
 #include <string>
 
 #include "base/strings/string_piece.h"
+#include "base/strings/string_split.h"
 
 namespace base {
 
@@ -96,8 +97,9 @@ class StringTokenizerT {
   // blocks the most obvious instances of this (e.g. passing a string literal to
   // the constructor), but caution must still be exercised.
   StringTokenizerT(const str& string,
-                   const str& delims) {
-    Init(string.begin(), string.end(), delims);
+                   const str& delims)
+      : delim_set_(delims) {
+    Init(string.begin(), string.end());
   }
 
   // Don't allow temporary strings to be used with string tokenizer, since
@@ -106,8 +108,9 @@ class StringTokenizerT {
 
   StringTokenizerT(const_iterator string_begin,
                    const_iterator string_end,
-                   const str& delims) {
-    Init(string_begin, string_end, delims);
+                   const str& delims)
+      : delim_set_(delims) {
+    Init(string_begin, string_end);
   }
 
   // Set the options for this tokenizer.  By default, this is 0.
@@ -151,14 +154,11 @@ class StringTokenizerT {
   }
 
  private:
-  void Init(const_iterator string_begin,
-            const_iterator string_end,
-            const str& delims) {
+  void Init(const_iterator string_begin, const_iterator string_end) {
     start_pos_ = string_begin;
     token_begin_ = string_begin;
     token_end_ = string_begin;
     end_ = string_end;
-    delims_ = delims;
     options_ = 0;
     token_is_delim_ = false;
   }
@@ -173,11 +173,11 @@ class StringTokenizerT {
       if (token_end_ == end_)
         return false;
       ++token_end_;
-      if (delims_.find(*token_begin_) == str::npos)
+      if (!delim_set_.Contains(*token_begin_))
         break;
       // else skip over delimiter.
     }
-    while (token_end_ != end_ && delims_.find(*token_end_) == str::npos)
+    while (token_end_ != end_ && !delim_set_.Contains(*token_end_))
       ++token_end_;
     return true;
   }
@@ -205,7 +205,7 @@ class StringTokenizerT {
   }
 
   bool IsDelim(char_type c) const {
-    return delims_.find(c) != str::npos;
+    return delim_set_.Contains(c);
   }
 
   bool IsQuote(char_type c) const {
@@ -241,7 +241,7 @@ class StringTokenizerT {
   const_iterator token_begin_;
   const_iterator token_end_;
   const_iterator end_;
-  str delims_;
+  internal::SeparatorSet<str> delim_set_;
   str quotes_;
   int options_;
   bool token_is_delim_;
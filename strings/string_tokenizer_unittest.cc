@@ -101,6 +101,25 @@ TEST(StringTokenizerTest, ManyDelims) {
   EXPECT_FALSE(t.GetNext());
 }
 
+TEST(StringTokenizerTest, WideDelims) {
+  std::wstring input = L"a\x2028" L"b c\x00a0" L"d";
+  WStringTokenizer t(input, L" \x00a0\x2028");
+
+  EXPECT_TRUE(t.GetNext());
+  EXPECT_EQ(L"a", t.token());
+
+  EXPECT_TRUE(t.GetNext());
+  EXPECT_EQ(L"b", t.token());
+
+  EXPECT_TRUE(t.GetNext());
+  EXPECT_EQ(L"c", t.token());
+
+  EXPECT_TRUE(t.GetNext());
+  EXPECT_EQ(L"d", t.token());
+
+  EXPECT_FALSE(t.GetNext());
+}
+
 TEST(StringTokenizerTest, ParseHeader) {
   string input = "Content-Type: text/html ; charset=UTF-8";
   StringTokenizer t(input, ": ;=");
@@ -18,11 +18,13 @@
 
 #include <algorithm>
 #include <limits>
+#include <type_traits>
 #include <vector>
 
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/singleton.h"
+#include "base/strings/substring_searcher.h"
 #include "base/strings/utf_string_conversion_utils.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/third_party/icu/icu_utf.h"
@@ -154,24 +156,79 @@ bool IsWprintfFormatPortable(const wchar_t* format) {
 
 namespace {
 
+// Branch-free versions of ToLowerASCII() and ToUpperASCII(), so that the loops
+// below are vectorized.
+template <typename Char>
+inline Char ToLowerASCIIBranchless(Char c) {
+  using UnsignedChar = typename std::make_unsigned<Char>::type;
+  const UnsignedChar u = static_cast<UnsignedChar>(c);
+  return static_cast<Char>(
+      u + ((static_cast<UnsignedChar>(u - 'A') < 26) << 5));
+}
+
+template <typename Char>
+inline Char ToUpperASCIIBranchless(Char c) {
+  using UnsignedChar = typename std::make_unsigned<Char>::type;
+  const UnsignedChar u = static_cast<UnsignedChar>(c);
+  return static_cast<Char>(
+      u - ((static_cast<UnsignedChar>(u - 'a') < 26) << 5));
+}
+
+template <typename StringType>
+void ToLowerASCIIInPlaceImpl(StringType* str) {
+  typename StringType::value_type* chars = &(*str)[0];
+  for (size_t i = 0; i < str->size(); ++i)
+    chars[i] = ToLowerASCIIBranchless(chars[i]);
+}
+
+template <typename StringType>
+void ToUpperASCIIInPlaceImpl(StringType* str) {
+  typename StringType::value_type* chars = &(*str)[0];
+  for (size_t i = 0; i < str->size(); ++i)
+    chars[i] = ToUpperASCIIBranchless(chars[i]);
+}
+
 template<typename StringType>
 StringType ToLowerASCIIImpl(BasicStringPiece<StringType> str) {
-  StringType ret;
-  ret.reserve(str.size());
-  for (size_t i = 0; i < str.size(); i++)
-    ret.push_back(ToLowerASCII(str[i]));
+  StringType ret(str.data(), str.size());
+  ToLowerASCIIInPlaceImpl(&ret);
   return ret;
 }
 
 template<typename StringType>
 StringType ToUpperASCIIImpl(BasicStringPiece<StringType> str) {
-  StringType ret;
-  ret.reserve(str.size());
-  for (size_t i = 0; i < str.size(); i++)
-    ret.push_back(ToUpperASCII(str[i]));
+  StringType ret(str.data(), str.size());
+  ToUpperASCIIInPlaceImpl(&ret);
   return ret;
 }
 
+// Case-insensitive comparisons first skip the blocks of kCompareBlockSize
+// characters which are equal. A block is compared without an early exit, so
+// that the comparison is vectorized.
+constexpr size_t kCompareBlockSize = 16;
+
+// Returns the position of the first block of the first |length| characters of
+// |a| and |b| where ToLowerASCII(a[i]) differs from b[i], or from
+// ToLowerASCII(b[i]) if |kLowerB|. Returns the position of the last, partial
+// block if there is no such block.
+template <bool kLowerB, typename CharA, typename CharB>
+size_t SkipEqualBlocksIgnoringCase(const CharA* a,
+                                   const CharB* b,
+                                   size_t length) {
+  size_t i = 0;
+  for (; i + kCompareBlockSize <= length; i += kCompareBlockSize) {
+    bool mismatch = false;
+    for (size_t j = 0; j < kCompareBlockSize; ++j) {
+      const CharB char_b =
+          kLowerB ? ToLowerASCIIBranchless(b[i + j]) : b[i + j];
+      mismatch |= ToLowerASCIIBranchless(a[i + j]) != char_b;
+    }
+    if (mismatch)
+      break;
+  }
+  return i;
+}
+
 }  // namespace
 
 std::string ToLowerASCII(StringPiece str) {
@@ -190,13 +247,30 @@ string16 ToUpperASCII(StringPiece16 str) {
   return ToUpperASCIIImpl<string16>(str);
 }
 
+void ToLowerASCIIInPlace(std::string* str) {
+  ToLowerASCIIInPlaceImpl(str);
+}
+
+void ToLowerASCIIInPlace(string16* str) {
+  ToLowerASCIIInPlaceImpl(str);
+}
+
+void ToUpperASCIIInPlace(std::string* str) {
+  ToUpperASCIIInPlaceImpl(str);
+}
+
+void ToUpperASCIIInPlace(string16* str) {
+  ToUpperASCIIInPlaceImpl(str);
+}
+
 template<class StringType>
 int CompareCaseInsensitiveASCIIT(BasicStringPiece<StringType> a,
                                  BasicStringPiece<StringType> b) {
   // Find the first characters that aren't equal and compare them.  If the end
   // of one of the strings is found before a nonequal character, the lengths
   // of the strings are compared.
-  size_t i = 0;
+  size_t i = SkipEqualBlocksIgnoringCase<true>(
+      a.data(), b.data(), std::min(a.length(), b.length()));
   while (i < a.length() && i < b.length()) {
     typename StringType::value_type lower_a = ToLowerASCII(a[i]);
     typename StringType::value_type lower_b = ToLowerASCII(b[i]);
@@ -517,6 +591,17 @@ bool IsStringUTF8(StringPiece str) {
   int32_t char_index = 0;
 
   while (char_index < src_len) {
+    // ASCII characters are all valid, so skip runs of them 8 bytes at a time.
+    while (src_len - char_index >= 8) {
+      uint64_t word;
+      memcpy(&word, src + char_index, sizeof(word));
+      if (word & UINT64_C(0x8080808080808080))
+        break;
+      char_index += 8;
+    }
+    if (char_index == src_len)
+      break;
+
     int32_t code_point;
     CBU8_NEXT(src, char_index, src_len, code_point);
     if (!IsValidCharacter(code_point))
@@ -545,7 +630,9 @@ static inline bool DoLowerCaseEqualsASCII(BasicStringPiece<Str> str,
                                           StringPiece lowercase_ascii) {
   if (str.size() != lowercase_ascii.size())
     return false;
-  for (size_t i = 0; i < str.size(); i++) {
+  for (size_t i = SkipEqualBlocksIgnoringCase<false>(
+           str.data(), lowercase_ascii.data(), str.size());
+       i < str.size(); i++) {
     if (ToLowerASCII(str[i]) != lowercase_ascii[i])
       return false;
   }
@@ -703,6 +790,22 @@ struct SubstringMatcher {
   size_t MatchSize() { return find_this.length(); }
 };
 
+// 8-bit strings are searched with a SubstringSearcher, since all the matches
+// of a single pattern are looked for.
+template <>
+struct SubstringMatcher<std::string> {
+  explicit SubstringMatcher(StringPiece find_this)
+      : searcher(find_this), length(find_this.length()) {}
+
+  size_t Find(const std::string& input, size_t pos) {
+    return searcher.Find(input, pos);
+  }
+  size_t MatchSize() { return length; }
+
+  SubstringSearcher searcher;
+  size_t length;
+};
+
 // A Matcher for DoReplaceMatchesAfterOffset() that matches single characters.
 template <class StringType>
 struct CharacterMatcher {
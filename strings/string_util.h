@@ -112,6 +112,13 @@ BASE_EXPORT string16 ToLowerASCII(StringPiece16 str);
 BASE_EXPORT std::string ToUpperASCII(StringPiece str);
 BASE_EXPORT string16 ToUpperASCII(StringPiece16 str);
 
+// Like ToLowerASCII() and ToUpperASCII(), but convert |str| in place rather
+// than allocating a new string.
+BASE_EXPORT void ToLowerASCIIInPlace(std::string* str);
+BASE_EXPORT void ToLowerASCIIInPlace(string16* str);
+BASE_EXPORT void ToUpperASCIIInPlace(std::string* str);
+BASE_EXPORT void ToUpperASCIIInPlace(string16* str);
+
 // Functor for case-insensitive ASCII comparisons for STL algorithms like
 // std::search.
 //
@@ -0,0 +1,118 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/string_util.h"
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "base/debug/alias.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+const int kIterations = 1000000;
+
+// HTTP header names and values, in mixed case.
+std::vector<std::string> HeaderStrings() {
+  return {"Content-Type",
+          "text/html; charset=UTF-8",
+          "Accept-Encoding",
+          "gzip, deflate, br",
+          "Strict-Transport-Security",
+          "max-age=31536000; includeSubDomains; preload",
+          "X-Content-Type-Options",
+          "Access-Control-Allow-Origin"};
+}
+
+template <typename StringType>
+void RunConversionTest(const char* trace,
+                       const std::vector<StringType>& inputs) {
+  size_t total_length = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i)
+    total_length += ToLowerASCII(inputs[i % inputs.size()]).size();
+  TimeDelta elapsed = TimeTicks::Now() - start;
+  debug::Alias(&total_length);
+  perf_test::PrintResult(
+      "to_lower_ascii", "", trace,
+      static_cast<double>(elapsed.InNanoseconds()) / kIterations, "ns/string",
+      true);
+
+  std::vector<StringType> strings = inputs;
+  start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i)
+    ToLowerASCIIInPlace(&strings[i % strings.size()]);
+  elapsed = TimeTicks::Now() - start;
+  debug::Alias(&strings);
+  perf_test::PrintResult(
+      "to_lower_ascii_in_place", "", trace,
+      static_cast<double>(elapsed.InNanoseconds()) / kIterations, "ns/string",
+      true);
+}
+
+template <typename StringType>
+void RunComparisonTest(const char* trace,
+                       const std::vector<StringType>& inputs) {
+  std::vector<StringType> upper_inputs;
+  for (const StringType& input : inputs)
+    upper_inputs.push_back(ToUpperASCII(input));
+
+  int equal = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    equal += EqualsCaseInsensitiveASCII(inputs[i % inputs.size()],
+                                        upper_inputs[i % inputs.size()]);
+  }
+  TimeDelta elapsed = TimeTicks::Now() - start;
+  debug::Alias(&equal);
+  perf_test::PrintResult(
+      "equals_case_insensitive_ascii", "", trace,
+      static_cast<double>(elapsed.InNanoseconds()) / kIterations,
+      "ns/comparison", true);
+
+  // |inputs| are HeaderStrings(), in 8 or 16 bits.
+  std::vector<std::string> lower_inputs;
+  for (const std::string& input : HeaderStrings())
+    lower_inputs.push_back(ToLowerASCII(input));
+  start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    equal += LowerCaseEqualsASCII(inputs[i % inputs.size()],
+                                  lower_inputs[i % inputs.size()]);
+  }
+  elapsed = TimeTicks::Now() - start;
+  debug::Alias(&equal);
+  perf_test::PrintResult(
+      "lower_case_equals_ascii", "", trace,
+      static_cast<double>(elapsed.InNanoseconds()) / kIterations,
+      "ns/comparison", true);
+}
+
+std::vector<string16> HeaderStrings16() {
+  std::vector<string16> strings;
+  for (const std::string& string : HeaderStrings())
+    strings.push_back(ASCIIToUTF16(string));
+  return strings;
+}
+
+}  // namespace
+
+TEST(StringUtilPerfTest, ToLowerASCII) {
+  RunConversionTest("8_bit", HeaderStrings());
+  RunConversionTest("16_bit", HeaderStrings16());
+}
+
+TEST(StringUtilPerfTest, CaseInsensitiveComparison) {
+  RunComparisonTest("8_bit", HeaderStrings());
+  RunComparisonTest("16_bit", HeaderStrings16());
+}
+
+}  // namespace base
@@ -531,6 +531,55 @@ TEST(StringUtilTest, ToUpperASCII) {
   EXPECT_EQ(ASCIIToUTF16("CC2"), ToUpperASCII(ASCIIToUTF16("Cc2")));
 }
 
+TEST(StringUtilTest, ToLowerAndUpperASCIIAllCharacters) {
+  // Only the ASCII letters change, in strings longer than a vector.
+  std::string all_chars;
+  string16 all_chars16;
+  for (int c = 0; c < 256; ++c)
+    all_chars.push_back(static_cast<char>(c));
+  for (int c = 0; c < 512; ++c)
+    all_chars16.push_back(static_cast<char16>(c * 129));
+  all_chars16.push_back(0xFFFF);
+
+  std::string lower = ToLowerASCII(all_chars);
+  std::string upper = ToUpperASCII(all_chars);
+  ASSERT_EQ(all_chars.size(), lower.size());
+  ASSERT_EQ(all_chars.size(), upper.size());
+  for (size_t i = 0; i < all_chars.size(); ++i) {
+    EXPECT_EQ(ToLowerASCII(all_chars[i]), lower[i]);
+    EXPECT_EQ(ToUpperASCII(all_chars[i]), upper[i]);
+  }
+
+  string16 lower16 = ToLowerASCII(all_chars16);
+  string16 upper16 = ToUpperASCII(all_chars16);
+  ASSERT_EQ(all_chars16.size(), lower16.size());
+  ASSERT_EQ(all_chars16.size(), upper16.size());
+  for (size_t i = 0; i < all_chars16.size(); ++i) {
+    EXPECT_EQ(ToLowerASCII(all_chars16[i]), lower16[i]);
+    EXPECT_EQ(ToUpperASCII(all_chars16[i]), upper16[i]);
+  }
+  EXPECT_EQ(ToLowerASCII(ASCIIToUTF16("Content-Type")),
+            ASCIIToUTF16("content-type"));
+}
+
+TEST(StringUtilTest, ToLowerAndUpperASCIIInPlace) {
+  std::string str("Content-Type: Text/HTML; charset=UTF-8");
+  ToLowerASCIIInPlace(&str);
+  EXPECT_EQ("content-type: text/html; charset=utf-8", str);
+  ToUpperASCIIInPlace(&str);
+  EXPECT_EQ("CONTENT-TYPE: TEXT/HTML; CHARSET=UTF-8", str);
+
+  string16 str16(ASCIIToUTF16("Cc2"));
+  ToLowerASCIIInPlace(&str16);
+  EXPECT_EQ(ASCIIToUTF16("cc2"), str16);
+  ToUpperASCIIInPlace(&str16);
+  EXPECT_EQ(ASCIIToUTF16("CC2"), str16);
+
+  std::string empty;
+  ToLowerASCIIInPlace(&empty);
+  EXPECT_EQ("", empty);
+}
+
 TEST(StringUtilTest, LowerCaseEqualsASCII) {
   static const struct {
     const char*    src_a;
@@ -547,6 +596,19 @@ TEST(StringUtilTest, LowerCaseEqualsASCII) {
     EXPECT_TRUE(LowerCaseEqualsASCII(lowercase_cases[i].src_a,
                                      lowercase_cases[i].dst));
   }
+
+  // Longer than a vector, with a difference in each position.
+  const std::string lower("accept-encoding: gzip, deflate, br");
+  const std::string mixed("Accept-Encoding: GZIP, deflate, BR");
+  EXPECT_TRUE(LowerCaseEqualsASCII(mixed, lower));
+  EXPECT_TRUE(LowerCaseEqualsASCII(ASCIIToUTF16(mixed), lower));
+  EXPECT_FALSE(LowerCaseEqualsASCII(lower, mixed));
+  for (size_t i = 0; i < lower.size(); ++i) {
+    std::string different = mixed;
+    different[i] = '~';
+    EXPECT_FALSE(LowerCaseEqualsASCII(different, lower)) << i;
+    EXPECT_FALSE(LowerCaseEqualsASCII(ASCIIToUTF16(different), lower)) << i;
+  }
 }
 
 TEST(StringUtilTest, FormatBytesUnlocalized) {
@@ -1321,6 +1383,26 @@ TEST(StringUtilTest, EqualsCaseInsensitiveASCII) {
   EXPECT_FALSE(EqualsCaseInsensitiveASCII("Asdf", "aSDFz"));
 }
 
+TEST(StringUtilTest, CaseInsensitiveASCIILongStrings) {
+  // Longer than a vector, with a difference in each position.
+  const std::string a("Strict-Transport-Security: max-age=31536000");
+  const std::string b("strict-transport-security: MAX-AGE=31536000");
+  EXPECT_EQ(0, CompareCaseInsensitiveASCII(a, b));
+  EXPECT_TRUE(EqualsCaseInsensitiveASCII(a, b));
+  EXPECT_TRUE(EqualsCaseInsensitiveASCII(ASCIIToUTF16(a), ASCIIToUTF16(b)));
+  for (size_t i = 0; i < a.size(); ++i) {
+    std::string smaller = b;
+    smaller[i] = '\x01';
+    EXPECT_EQ(1, CompareCaseInsensitiveASCII(a, smaller)) << i;
+    EXPECT_EQ(-1, CompareCaseInsensitiveASCII(smaller, a)) << i;
+    EXPECT_FALSE(EqualsCaseInsensitiveASCII(a, smaller)) << i;
+    EXPECT_EQ(1, CompareCaseInsensitiveASCII(ASCIIToUTF16(a),
+                                             ASCIIToUTF16(smaller)))
+        << i;
+  }
+  EXPECT_EQ(-1, CompareCaseInsensitiveASCII(a, b + "x"));
+}
+
 TEST(StringUtilTest, IsUnicodeWhitespace) {
   // NOT unicode white space.
   EXPECT_FALSE(IsUnicodeWhitespace(L'\0'));
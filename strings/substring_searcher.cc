@@ -0,0 +1,51 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/substring_searcher.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+namespace base {
+
+// static
+constexpr size_t SubstringSearcher::kMinSkippingPatternLength;
+
+SubstringSearcher::SubstringSearcher(StringPiece pattern) : pattern_(pattern) {
+  const size_t length = pattern_.size();
+  if (length < kMinSkippingPatternLength)
+    return;
+  const uint8_t max_skip = static_cast<uint8_t>(std::min<size_t>(length, 255));
+  memset(skip_, max_skip, sizeof(skip_));
+  // A window ending with a character of the pattern (but its last) moves until
+  // its last occurrence in the pattern is aligned with it.
+  for (size_t i = 0; i + 1 < length; ++i) {
+    const size_t skip = length - 1 - i;
+    uint8_t& entry = skip_[static_cast<uint8_t>(pattern_[i])];
+    entry = static_cast<uint8_t>(std::min<size_t>(skip, max_skip));
+  }
+}
+
+size_t SubstringSearcher::Find(StringPiece text, size_t pos) const {
+  const size_t length = pattern_.size();
+  if (length < kMinSkippingPatternLength)
+    return text.find(pattern_, pos);
+  if (pos > text.size() || text.size() - pos < length)
+    return StringPiece::npos;
+
+  const char* const data = text.data();
+  const char* const pattern = pattern_.data();
+  const char last = pattern[length - 1];
+  const size_t last_start = text.size() - length;
+  for (size_t start = pos; start <= last_start;) {
+    const char end = data[start + length - 1];
+    if (end == last && memcmp(data + start, pattern, length - 1) == 0)
+      return start;
+    start += skip_[static_cast<uint8_t>(end)];
+  }
+  return StringPiece::npos;
+}
+
+}  // namespace base
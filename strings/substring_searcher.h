@@ -0,0 +1,54 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_STRINGS_SUBSTRING_SEARCHER_H_
+#define BASE_STRINGS_SUBSTRING_SEARCHER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+
+// Finds a fixed pattern in 8-bit strings, with the Boyer-Moore-Horspool
+// algorithm: the pattern is preprocessed once, so that each mismatch skips
+// ahead by up to the length of the pattern. Use it instead of
+// StringPiece::find() to search for the same pattern repeatedly, e.g. all its
+// occurrences in a long string:
+//
+//   SubstringSearcher searcher("password=");
+//   for (size_t pos = searcher.Find(log); pos != StringPiece::npos;
+//        pos = searcher.Find(log, pos + 1)) {
+//     ...
+//   }
+//
+// Short patterns skip too little to beat the vectorized memchr() which
+// StringPiece::find() filters candidates with, so they are searched for with
+// the latter.
+class BASE_EXPORT SubstringSearcher {
+ public:
+  // |pattern| must outlive the searcher.
+  explicit SubstringSearcher(StringPiece pattern);
+
+  // Returns the position of the first occurrence of the pattern in |text| at
+  // or after |pos|, or StringPiece::npos if there is none.
+  size_t Find(StringPiece text, size_t pos = 0) const;
+
+ private:
+  // The shortest pattern searched for with Boyer-Moore-Horspool.
+  static constexpr size_t kMinSkippingPatternLength = 8;
+
+  StringPiece pattern_;
+
+  // How far to move the window of the search, by the value of its last
+  // character, capped at 255. Only used for patterns of at least
+  // kMinSkippingPatternLength characters.
+  uint8_t skip_[256];
+};
+
+}  // namespace base
+
+#endif  // BASE_STRINGS_SUBSTRING_SEARCHER_H_
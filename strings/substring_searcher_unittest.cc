@@ -0,0 +1,62 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/substring_searcher.h"
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Checks that SubstringSearcher finds |pattern| where std::string::find()
+// does, from every position of |text|.
+void ExpectFindsLikeStdString(const std::string& text,
+                              const std::string& pattern) {
+  SubstringSearcher searcher(pattern);
+  for (size_t pos = 0; pos <= text.size() + 1; ++pos) {
+    EXPECT_EQ(text.find(pattern, pos), searcher.Find(text, pos))
+        << "\"" << pattern << "\" in \"" << text << "\" from " << pos;
+  }
+}
+
+}  // namespace
+
+TEST(SubstringSearcherTest, ShortPatterns) {
+  ExpectFindsLikeStdString("", "");
+  ExpectFindsLikeStdString("abc", "");
+  ExpectFindsLikeStdString("", "a");
+  ExpectFindsLikeStdString("abcabc", "c");
+  ExpectFindsLikeStdString("abcabcab", "ab");
+  ExpectFindsLikeStdString("aaaaaa", "aaa");
+  ExpectFindsLikeStdString("abcab", "abcabc");
+}
+
+TEST(SubstringSearcherTest, LongPatterns) {
+  ExpectFindsLikeStdString("password=", "password=");
+  ExpectFindsLikeStdString("user=a password=b password=c", "password=");
+  ExpectFindsLikeStdString("passwordpassword=password", "password=");
+  ExpectFindsLikeStdString("aaaaaaaaaaaaaaaaaaaaaaaab", "aaaaaaaab");
+  ExpectFindsLikeStdString("abababababababab", "babababa");
+  ExpectFindsLikeStdString("no match in this text at all", "abcdefgh");
+
+  // Longer than the largest skip.
+  std::string pattern(300, 'x');
+  pattern.back() = 'y';
+  std::string text = std::string(700, 'x') + "y" + pattern;
+  EXPECT_EQ(text.find(pattern), SubstringSearcher(pattern).Find(text));
+  EXPECT_EQ(text.find(pattern, 401),
+            SubstringSearcher(pattern).Find(text, 401));
+}
+
+TEST(SubstringSearcherTest, NonAsciiCharacters) {
+  const std::string text("\xff\x80\x01\xfe\xff\x80\x01\xfe\x7f\x00\xff", 11);
+  ExpectFindsLikeStdString(text, std::string("\xfe\xff\x80\x01\xfe\x7f", 6));
+  ExpectFindsLikeStdString(
+      text, std::string("\x80\x01\xfe\xff\x80\x01\xfe\x7f\x00", 9));
+}
+
+}  // namespace base
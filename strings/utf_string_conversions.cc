@@ -5,6 +5,9 @@
 #include "base/strings/utf_string_conversions.h"
 
 #include <stdint.h>
+#include <string.h>
+
+#include <type_traits>
 
 #include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
@@ -75,6 +78,69 @@ void UnicodeAppendUnsafe(wchar_t* out, int32_t* size, uint32_t code_point) {
 
 #endif  // defined(WCHAR_T_IS_UTF32)
 
+// ASCII runs -----------------------------------------------------------------
+// ASCII symbols are encoded by the same single codeunit in all encodings, so
+// runs of them are copied without being decoded.
+
+template <typename Char>
+struct NonASCIIMask;
+
+template <>
+struct NonASCIIMask<char> {
+  static constexpr uint64_t value = 0x8080808080808080ULL;
+};
+
+template <>
+struct NonASCIIMask<char16> {
+  static constexpr uint64_t value = 0xFF80FF80FF80FF80ULL;
+};
+
+#if defined(WCHAR_T_IS_UTF32)
+template <>
+struct NonASCIIMask<wchar_t> {
+  static constexpr uint64_t value = 0xFFFFFF80FFFFFF80ULL;
+};
+#endif  // defined(WCHAR_T_IS_UTF32)
+
+template <typename Char>
+bool IsASCIICodeUnit(Char c) {
+  return static_cast<std::make_unsigned_t<Char>>(c) < 0x80;
+}
+
+// Returns the length of the run of ASCII codeunits at the start of src,
+// checking 8 bytes at a time.
+template <typename SrcChar>
+int32_t CountASCIIPrefix(const SrcChar* src, int32_t src_len) {
+  constexpr int32_t kCharsPerWord = sizeof(uint64_t) / sizeof(SrcChar);
+  int32_t i = 0;
+  for (; i + kCharsPerWord <= src_len; i += kCharsPerWord) {
+    uint64_t word;
+    memcpy(&word, src + i, sizeof(word));
+    if (word & NonASCIIMask<SrcChar>::value)
+      break;
+  }
+  while (i < src_len && IsASCIICodeUnit(src[i]))
+    ++i;
+  return i;
+}
+
+// Appends the run of ASCII codeunits at src[*i] to dest, and advances *i past
+// it. The loop is simple enough for compilers to vectorize.
+template <typename SrcChar, typename DestChar>
+void AppendASCIIRun(const SrcChar* src,
+                    int32_t* i,
+                    int32_t src_len,
+                    DestChar* dest,
+                    int32_t* dest_len) {
+  int32_t run_len = CountASCIIPrefix(src + *i, src_len - *i);
+  const SrcChar* run = src + *i;
+  DestChar* out = dest + *dest_len;
+  for (int32_t j = 0; j < run_len; ++j)
+    out[j] = static_cast<DestChar>(run[j]);
+  *i += run_len;
+  *dest_len += run_len;
+}
+
 // DoUTFConversion ------------------------------------------------------------
 // Main driver of UTFConversion specialized for different Src encodings.
 // dest has to have enough room for the converted text.
@@ -87,6 +153,11 @@ bool DoUTFConversion(const char* src,
   bool success = true;
 
   for (int32_t i = 0; i < src_len;) {
+    if (IsASCIICodeUnit(src[i])) {
+      AppendASCIIRun(src, &i, src_len, dest, dest_len);
+      continue;
+    }
+
     int32_t code_point;
     CBU8_NEXT(src, i, src_len, code_point);
 
@@ -121,6 +192,11 @@ bool DoUTFConversion(const char16* src,
   // Always have another symbol in order to avoid checking boundaries in the
   // middle of the surrogate pair.
   while (i < src_len - 1) {
+    if (IsASCIICodeUnit(src[i])) {
+      AppendASCIIRun(src, &i, src_len, dest, dest_len);
+      continue;
+    }
+
     int32_t code_point;
 
     if (CBU16_IS_LEAD(src[i]) && CBU16_IS_TRAIL(src[i + 1])) {
@@ -153,8 +229,13 @@ bool DoUTFConversion(const wchar_t* src,
                      int32_t* dest_len) {
   bool success = true;
 
-  for (int32_t i = 0; i < src_len; ++i) {
-    int32_t code_point = src[i];
+  for (int32_t i = 0; i < src_len;) {
+    if (IsASCIICodeUnit(src[i])) {
+      AppendASCIIRun(src, &i, src_len, dest, dest_len);
+      continue;
+    }
+
+    int32_t code_point = src[i++];
 
     if (!IsValidCodepoint(code_point)) {
       success = false;
@@ -206,6 +287,17 @@ bool UTF8ToUTF16(const char* src, size_t src_len, string16* output) {
   return UTFConversion(StringPiece(src, src_len), output);
 }
 
+bool UTF8ToUTF16(const char* src,
+                 size_t src_len,
+                 char16* dest,
+                 size_t* dest_len) {
+  int32_t dest_len32 = 0;
+  bool res =
+      DoUTFConversion(src, static_cast<int32_t>(src_len), dest, &dest_len32);
+  *dest_len = dest_len32;
+  return res;
+}
+
 string16 UTF8ToUTF16(StringPiece utf8) {
   string16 ret;
   // Ignore the success flag of this call, it will do the best it can for
@@ -218,6 +310,17 @@ bool UTF16ToUTF8(const char16* src, size_t src_len, std::string* output) {
   return UTFConversion(StringPiece16(src, src_len), output);
 }
 
+bool UTF16ToUTF8(const char16* src,
+                 size_t src_len,
+                 char* dest,
+                 size_t* dest_len) {
+  int32_t dest_len32 = 0;
+  bool res =
+      DoUTFConversion(src, static_cast<int32_t>(src_len), dest, &dest_len32);
+  *dest_len = dest_len32;
+  return res;
+}
+
 std::string UTF16ToUTF8(StringPiece16 utf16) {
   std::string ret;
   // Ignore the success flag of this call, it will do the best it can for
@@ -41,6 +41,19 @@ BASE_EXPORT bool UTF16ToUTF8(const char16* src, size_t src_len,
                              std::string* output);
 BASE_EXPORT std::string UTF16ToUTF8(StringPiece16 utf16);
 
+// Versions of the above that write the conversion to |dest| and its length to
+// |dest_len| instead of allocating a string, so that callers can reuse their
+// buffer. |dest| must have room for the longest possible conversion: |src_len|
+// codeunits for UTF8ToUTF16() and 3 * |src_len| for UTF16ToUTF8().
+BASE_EXPORT bool UTF8ToUTF16(const char* src,
+                             size_t src_len,
+                             char16* dest,
+                             size_t* dest_len);
+BASE_EXPORT bool UTF16ToUTF8(const char16* src,
+                             size_t src_len,
+                             char* dest,
+                             size_t* dest_len);
+
 // This converts an ASCII string, typically a hardcoded constant, to a UTF16
 // string.
 BASE_EXPORT string16 ASCIIToUTF16(StringPiece ascii);
@@ -0,0 +1,72 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/utf_string_conversions.h"
+
+#include <stddef.h>
+
+#include <string>
+
+#include "base/strings/string16.h"
+#include "base/test/perf_benchmark.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr int kIterations = 100000;
+
+// A URL, which is ASCII, and a sentence mixing Latin, Cyrillic and CJK text
+// and an emoji, which need 1 to 4 bytes per code point.
+constexpr char kAscii[] =
+    "https://www.example.com/search?q=utf+string+conversions&hl=en";
+constexpr char kNonAscii[] =
+    "Caf\xC3\xA9 \xD0\xBC\xD0\xB8\xD1\x80 \xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA"
+    "\x9E \xF0\x9F\x98\x80 na\xC3\xAFve r\xC3\xA9sum\xC3\xA9";
+
+void RunUTF8ToUTF16Test(const char* story, const std::string& input) {
+  PerfBenchmark benchmark("utf_string_conversions", story, kIterations);
+  benchmark.Run([&input](int iterations) {
+    size_t total_length = 0;
+    for (int i = 0; i < iterations; ++i)
+      total_length += UTF8ToUTF16(input).size();
+    EXPECT_GT(total_length, 0u);
+  });
+}
+
+void RunUTF16ToUTF8Test(const char* story, const string16& input) {
+  PerfBenchmark benchmark("utf_string_conversions", story, kIterations);
+  benchmark.Run([&input](int iterations) {
+    size_t total_length = 0;
+    for (int i = 0; i < iterations; ++i)
+      total_length += UTF16ToUTF8(input).size();
+    EXPECT_GT(total_length, 0u);
+  });
+}
+
+}  // namespace
+
+TEST(UTFStringConversionsPerfTest, UTF8ToUTF16) {
+  RunUTF8ToUTF16Test("utf8_to_utf16_ascii", kAscii);
+  RunUTF8ToUTF16Test("utf8_to_utf16_non_ascii", kNonAscii);
+}
+
+TEST(UTFStringConversionsPerfTest, UTF16ToUTF8) {
+  RunUTF16ToUTF8Test("utf16_to_utf8_ascii", UTF8ToUTF16(kAscii));
+  RunUTF16ToUTF8Test("utf16_to_utf8_non_ascii", UTF8ToUTF16(kNonAscii));
+}
+
+TEST(UTFStringConversionsPerfTest, ASCIIToUTF16) {
+  PerfBenchmark benchmark("utf_string_conversions", "ascii_to_utf16",
+                          kIterations);
+  benchmark.Run([](int iterations) {
+    size_t total_length = 0;
+    for (int i = 0; i < iterations; ++i)
+      total_length += ASCIIToUTF16(kAscii).size();
+    EXPECT_GT(total_length, 0u);
+  });
+}
+
+}  // namespace base
@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <stddef.h>
+#include <string.h>
 
 #include "base/logging.h"
 #include "base/macros.h"
@@ -208,4 +209,53 @@ TEST(UTFStringConversionsTest, ConvertMultiString) {
   EXPECT_EQ(expected, converted);
 }
 
+
+// Non-ASCII characters at every offset of a long ASCII string, so that they
+// are found at any position within the words scanned for ASCII runs.
+TEST(UTFStringConversionsTest, ConvertASCIIRuns) {
+  const std::string ascii = "The quick brown fox jumps over the lazy dog.";
+  for (size_t i = 0; i <= ascii.size(); ++i) {
+    // U+4F60, and an invalid byte.
+    std::string utf8 = ascii.substr(0, i) + "\xe4\xbd\xa0" + ascii.substr(i);
+    string16 utf16 = ASCIIToUTF16(ascii.substr(0, i)) + char16{0x4f60} +
+                     ASCIIToUTF16(ascii.substr(i));
+    string16 converted16;
+    EXPECT_TRUE(UTF8ToUTF16(utf8.data(), utf8.size(), &converted16));
+    EXPECT_EQ(utf16, converted16);
+    std::string converted8;
+    EXPECT_TRUE(UTF16ToUTF8(utf16.data(), utf16.size(), &converted8));
+    EXPECT_EQ(utf8, converted8);
+    EXPECT_EQ(UTF16ToWide(utf16), UTF8ToWide(utf8));
+    EXPECT_EQ(utf8, WideToUTF8(UTF8ToWide(utf8)));
+
+    std::string invalid_utf8 = ascii.substr(0, i) + "\xff" + ascii.substr(i);
+    string16 replaced16 = ASCIIToUTF16(ascii.substr(0, i)) + char16{0xfffd} +
+                          ASCIIToUTF16(ascii.substr(i));
+    EXPECT_FALSE(
+        UTF8ToUTF16(invalid_utf8.data(), invalid_utf8.size(), &converted16));
+    EXPECT_EQ(replaced16, converted16);
+  }
+}
+
+TEST(UTFStringConversionsTest, ConvertIntoBuffer) {
+  // "Hello, 世界"
+  const char kUTF8[] = "Hello, \xe4\xb8\x96\xe7\x95\x8c";
+  const string16 utf16 = UTF8ToUTF16(kUTF8);
+
+  char16 buffer16[arraysize(kUTF8)];
+  size_t length = 0;
+  EXPECT_TRUE(UTF8ToUTF16(kUTF8, strlen(kUTF8), buffer16, &length));
+  EXPECT_EQ(utf16, string16(buffer16, length));
+
+  char buffer8[3 * arraysize(kUTF8)];
+  EXPECT_TRUE(UTF16ToUTF8(utf16.data(), utf16.size(), buffer8, &length));
+  EXPECT_EQ(kUTF8, std::string(buffer8, length));
+
+  // A lone surrogate is replaced.
+  const char16 kInvalidUTF16[] = {'a', 0xd800, 'b'};
+  EXPECT_FALSE(UTF16ToUTF8(kInvalidUTF16, arraysize(kInvalidUTF16), buffer8,
+                           &length));
+  EXPECT_EQ("a\xef\xbf\xbd" "b", std::string(buffer8, length));
+}
+
 }  // namespace base
@@ -4,6 +4,8 @@
 
 #include "base/supports_user_data.h"
 
+#include "base/containers/stack_container.h"
+
 namespace base {
 
 SupportsUserData::SupportsUserData() {
@@ -41,8 +43,12 @@ void SupportsUserData::DetachFromSequence() {
 
 SupportsUserData::~SupportsUserData() {
   DCHECK(sequence_checker_.CalledOnValidSequence() || user_data_.empty());
-  DataMap local_user_data;
-  user_data_.swap(local_user_data);
+  if (user_data_.empty())
+    return;
+  StackVector<std::unique_ptr<Data>, kInlineUserDataCount> local_user_data;
+  for (auto& entry : user_data_)
+    local_user_data->push_back(std::move(entry.second));
+  user_data_.clear();
   // Now this->user_data_ is empty, and any destructors called transitively from
   // the destruction of |local_user_data| will see it that way instead of
   // examining a being-destroyed object.
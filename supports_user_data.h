@@ -9,6 +9,7 @@
 #include <memory>
 
 #include "base/base_export.h"
+#include "base/containers/small_map.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
 #include "base/sequence_checker.h"
@@ -52,7 +53,11 @@ class BASE_EXPORT SupportsUserData {
   virtual ~SupportsUserData();
 
  private:
-  using DataMap = std::map<const void*, std::unique_ptr<Data>>;
+  // Objects usually have a few pieces of user data, which are then kept
+  // inline rather than in the nodes of a std::map.
+  static constexpr int kInlineUserDataCount = 4;
+  using DataMap = small_map<std::map<const void*, std::unique_ptr<Data>>,
+                            kInlineUserDataCount>;
 
   // Externally-defined data accessible by key.
   DataMap user_data_;
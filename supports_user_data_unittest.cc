@@ -6,6 +6,7 @@
 
 #include <vector>
 
+#include "base/macros.h"
 #include "base/memory/ptr_util.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -36,5 +37,30 @@ TEST(SupportsUserDataTest, ClearWorksRecursively) {
   // Destruction of supports_user_data runs the actual test.
 }
 
+struct TestData : public SupportsUserData::Data {};
+
+// Goes past the entries which are stored inline.
+TEST(SupportsUserDataTest, ManyEntries) {
+  TestSupportsUserData supports_user_data;
+  char keys[8];
+  std::vector<TestData*> data;
+  for (char& key : keys) {
+    auto new_data = std::make_unique<TestData>();
+    data.push_back(new_data.get());
+    supports_user_data.SetUserData(&key, std::move(new_data));
+  }
+  for (size_t i = 0; i < arraysize(keys); ++i)
+    EXPECT_EQ(data[i], supports_user_data.GetUserData(&keys[i]));
+
+  supports_user_data.RemoveUserData(&keys[0]);
+  EXPECT_EQ(nullptr, supports_user_data.GetUserData(&keys[0]));
+  EXPECT_EQ(data[1], supports_user_data.GetUserData(&keys[1]));
+
+  auto replacement = std::make_unique<TestData>();
+  TestData* replacement_ptr = replacement.get();
+  supports_user_data.SetUserData(&keys[1], std::move(replacement));
+  EXPECT_EQ(replacement_ptr, supports_user_data.GetUserData(&keys[1]));
+}
+
 }  // namespace
 }  // namespace base
@@ -25,6 +25,8 @@
 #include <sys/types.h>
 
 #if defined(OS_POSIX)
+#include <sys/uio.h>
+
 #include "base/file_descriptor_posix.h"
 #endif
 
@@ -85,6 +87,20 @@ class BASE_EXPORT SyncSocket {
                                     size_t length,
                                     TimeDelta timeout);
 
+#if defined(OS_POSIX) && !defined(OS_NACL)
+  // Same as Send() but sends the |count| |buffers| one after the other, with
+  // as few system calls as possible (usually one). This is how to batch many
+  // small messages. |count| must be non-zero and at most IOV_MAX, and the
+  // total length must be non-zero. Returns the total number of bytes sent, or
+  // 0 upon failure.
+  virtual size_t SendV(const struct iovec* buffers, size_t count);
+
+  // Same as Receive() but fills the |count| |buffers| one after the other,
+  // with as few system calls as possible. Returns the total number of bytes
+  // received, or 0 upon failure.
+  size_t ReceiveV(const struct iovec* buffers, size_t count);
+#endif
+
   // Returns the number of bytes available. If non-zero, Receive() will not
   // not block when called.
   virtual size_t Peek();
@@ -142,6 +158,12 @@ class BASE_EXPORT CancelableSyncSocket : public SyncSocket {
   // Note that the socket will not be closed in this case.
   size_t Send(const void* buffer, size_t length) override;
 
+#if defined(OS_POSIX) && !defined(OS_NACL)
+  // Same as Send() above for all the |buffers| at once, so the socket is made
+  // non-blocking once per batch rather than once per message.
+  size_t SendV(const struct iovec* buffers, size_t count) override;
+#endif
+
  private:
 #if defined(OS_WIN)
   WaitableEvent shutdown_event_;
@@ -13,6 +13,9 @@
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+
+#include <vector>
 
 #if defined(OS_SOLARIS)
 #include <sys/filio.h>
@@ -20,6 +23,7 @@
 
 #include "base/files/file_util.h"
 #include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
 #include "base/threading/thread_restrictions.h"
 #include "build/build_config.h"
 
@@ -44,6 +48,52 @@ size_t SendHelper(SyncSocket::Handle handle,
              : 0;
 }
 
+// Transfers all the |count| |buffers| to or from |handle| with |transfer|,
+// which is writev() or readv(), calling it again with what remains after a
+// partial transfer.  Returns the number of bytes transferred or zero on error.
+size_t TransferVHelper(ssize_t (*transfer)(int, const struct iovec*, int),
+                       SyncSocket::Handle handle,
+                       const struct iovec* buffers,
+                       size_t count) {
+  DCHECK_GT(count, 0u);
+  DCHECK_LE(count, static_cast<size_t>(IOV_MAX));
+  DCHECK_NE(handle, SyncSocket::kInvalidHandle);
+  size_t length = 0;
+  for (size_t i = 0; i < count; ++i)
+    length += buffers[i].iov_len;
+  DCHECK_GT(length, 0u);
+  DCHECK_LE(length, kMaxMessageLength);
+
+  // |buffers| is only copied, to be advanced, after a partial transfer.
+  std::vector<struct iovec> remaining;
+  size_t transferred = 0;
+  while (true) {
+    const struct iovec* current =
+        remaining.empty() ? buffers : remaining.data();
+    const size_t current_count = remaining.empty() ? count : remaining.size();
+    const ssize_t result = HANDLE_EINTR(
+        transfer(handle, current, static_cast<int>(current_count)));
+    if (result <= 0)
+      return 0;
+    transferred += static_cast<size_t>(result);
+    if (transferred == length)
+      return length;
+
+    if (remaining.empty())
+      remaining.assign(buffers, buffers + count);
+    size_t skipped = static_cast<size_t>(result);
+    auto first = remaining.begin();
+    while (skipped >= first->iov_len) {
+      skipped -= first->iov_len;
+      ++first;
+    }
+    remaining.erase(remaining.begin(), first);
+    remaining.front().iov_base =
+        static_cast<char*>(remaining.front().iov_base) + skipped;
+    remaining.front().iov_len -= skipped;
+  }
+}
+
 bool CloseHandle(SyncSocket::Handle handle) {
   if (handle != SyncSocket::kInvalidHandle && close(handle) < 0) {
     DPLOG(ERROR) << "close";
@@ -195,6 +245,16 @@ size_t SyncSocket::ReceiveWithTimeout(void* buffer,
   return bytes_read_total;
 }
 
+size_t SyncSocket::SendV(const struct iovec* buffers, size_t count) {
+  AssertBlockingAllowed();
+  return TransferVHelper(&writev, handle_, buffers, count);
+}
+
+size_t SyncSocket::ReceiveV(const struct iovec* buffers, size_t count) {
+  AssertBlockingAllowed();
+  return TransferVHelper(&readv, handle_, buffers, count);
+}
+
 size_t SyncSocket::Peek() {
   DCHECK_NE(handle_, kInvalidHandle);
   int number_chars = 0;
@@ -244,6 +304,24 @@ size_t CancelableSyncSocket::Send(const void* buffer, size_t length) {
   return len;
 }
 
+size_t CancelableSyncSocket::SendV(const struct iovec* buffers, size_t count) {
+  const int flags = fcntl(handle_, F_GETFL);
+  if (flags != -1 && (flags & O_NONBLOCK) == 0) {
+    // Set the socket to non-blocking mode for sending if its original mode
+    // is blocking.
+    fcntl(handle_, F_SETFL, flags | O_NONBLOCK);
+  }
+
+  const size_t len = TransferVHelper(&writev, handle_, buffers, count);
+
+  if (flags != -1 && (flags & O_NONBLOCK) == 0) {
+    // Restore the original flags.
+    fcntl(handle_, F_SETFL, flags);
+  }
+
+  return len;
+}
+
 // static
 bool CancelableSyncSocket::CreatePair(CancelableSyncSocket* socket_a,
                                       CancelableSyncSocket* socket_b) {
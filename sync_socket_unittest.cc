@@ -4,11 +4,18 @@
 
 #include "base/sync_socket.h"
 
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
 #include "base/macros.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/simple_thread.h"
 #include "base/time/time.h"
+#include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -100,6 +107,75 @@ void SendReceivePeek(SyncSocket* socket_a, SyncSocket* socket_b) {
   ASSERT_TRUE(socket_b->Close());
 }
 
+#if defined(OS_POSIX)
+// Sends |data| with SendV() from another thread, in buffers of varying sizes,
+// while the socket buffer fills up and the peer receives.
+class SendVThread : public DelegateSimpleThread::Delegate {
+ public:
+  SendVThread(SyncSocket* socket, const std::vector<char>* data)
+      : socket_(socket), data_(data), thread_(this, "SendVThread") {
+    thread_.Start();
+  }
+
+  ~SendVThread() override = default;
+
+  void Run() override {
+    std::vector<struct iovec> buffers;
+    size_t offset = 0;
+    for (size_t size = 1; offset < data_->size(); size *= 2) {
+      size = std::min(size, data_->size() - offset);
+      buffers.push_back(
+          {const_cast<char*>(data_->data()) + offset, size});
+      offset += size;
+    }
+    sent_ = socket_->SendV(buffers.data(), buffers.size());
+  }
+
+  size_t Join() {
+    thread_.Join();
+    return sent_;
+  }
+
+ private:
+  SyncSocket* socket_;
+  const std::vector<char>* data_;
+  DelegateSimpleThread thread_;
+  size_t sent_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(SendVThread);
+};
+
+// Tests sending several buffers at once from |socket_a| to |socket_b|, and
+// receiving them into differently sized buffers.
+void SendVReceiveV(SyncSocket* socket_a, SyncSocket* socket_b) {
+  const int kFirst = 123;
+  const char kSecond[] = "four";
+  const int16_t kThird = 456;
+  struct iovec send_buffers[] = {
+      {const_cast<int*>(&kFirst), sizeof(kFirst)},
+      {const_cast<char*>(kSecond), sizeof(kSecond)},
+      {const_cast<int16_t*>(&kThird), sizeof(kThird)},
+  };
+  const size_t kLength = sizeof(kFirst) + sizeof(kSecond) + sizeof(kThird);
+  ASSERT_EQ(kLength, socket_a->SendV(send_buffers, arraysize(send_buffers)));
+  ASSERT_EQ(kLength, socket_b->Peek());
+
+  char received[kLength] = {};
+  struct iovec receive_buffers[] = {
+      {received, 3},
+      {received + 3, 0},
+      {received + 3, kLength - 3},
+  };
+  ASSERT_EQ(kLength,
+            socket_b->ReceiveV(receive_buffers, arraysize(receive_buffers)));
+  EXPECT_EQ(0, memcmp(&kFirst, received, sizeof(kFirst)));
+  EXPECT_EQ(0, memcmp(kSecond, received + sizeof(kFirst), sizeof(kSecond)));
+  EXPECT_EQ(0, memcmp(&kThird, received + sizeof(kFirst) + sizeof(kSecond),
+                      sizeof(kThird)));
+  ASSERT_EQ(0u, socket_b->Peek());
+}
+#endif  // defined(OS_POSIX)
+
 }  // namespace
 
 class SyncSocketTest : public testing::Test {
@@ -123,6 +199,30 @@ TEST_F(SyncSocketTest, ClonedSendReceivePeek) {
   SendReceivePeek(&socket_c, &socket_d);
 };
 
+#if defined(OS_POSIX)
+TEST_F(SyncSocketTest, SendVReceiveV) {
+  SendVReceiveV(&socket_a_, &socket_b_);
+}
+
+TEST_F(SyncSocketTest, SendVReceiveVLarge) {
+  // Larger than the socket buffer, so that both sides transfer partially.
+  std::vector<char> data(1 << 20);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<char>(i * 7);
+
+  SendVThread thread(&socket_a_, &data);
+  std::vector<char> received(data.size());
+  struct iovec receive_buffers[] = {
+      {received.data(), 1000},
+      {received.data() + 1000, received.size() - 1000},
+  };
+  EXPECT_EQ(data.size(),
+            socket_b_.ReceiveV(receive_buffers, arraysize(receive_buffers)));
+  EXPECT_EQ(data.size(), thread.Join());
+  EXPECT_EQ(data, received);
+}
+#endif  // defined(OS_POSIX)
+
 class CancelableSyncSocketTest : public testing::Test {
  public:
   void SetUp() override {
@@ -144,6 +244,19 @@ TEST_F(CancelableSyncSocketTest, ClonedSendReceivePeek) {
   SendReceivePeek(&socket_c, &socket_d);
 }
 
+#if defined(OS_POSIX)
+TEST_F(CancelableSyncSocketTest, SendVReceiveV) {
+  SendVReceiveV(&socket_a_, &socket_b_);
+}
+
+TEST_F(CancelableSyncSocketTest, SendVDoesNotBlock) {
+  // Once the socket buffer is full, SendV() fails rather than blocking.
+  std::vector<char> data(1 << 20);
+  struct iovec buffers[] = {{data.data(), data.size()}};
+  EXPECT_EQ(0u, socket_a_.SendV(buffers, arraysize(buffers)));
+}
+#endif  // defined(OS_POSIX)
+
 TEST_F(CancelableSyncSocketTest, ShutdownCancelsReceive) {
   HangingReceiveThread thread(&socket_b_, /* with_timeout = */ false);
 
@@ -0,0 +1,100 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/adaptive_spin_waiter.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/platform_thread.h"
+#include "build/build_config.h"
+
+// As in lock_impl_futex.cc, tells the processor that this is a busy wait.
+#if defined(ARCH_CPU_X86_FAMILY) || \
+    (defined(ARCH_CPU_MIPS64EL) && __mips_isa_rev >= 2)
+#define YIELD_PROCESSOR __asm__ __volatile__("pause")
+#elif (defined(ARCH_CPU_ARMEL) && __ARM_ARCH >= 6) || defined(ARCH_CPU_ARM64)
+#define YIELD_PROCESSOR __asm__ __volatile__("yield")
+#else
+#define YIELD_PROCESSOR ((void)0)
+#endif
+
+namespace base {
+
+namespace {
+
+// How many times the processor is paused between two polls of the event while
+// busy-waiting. Polling takes the lock of the event, which the signaling
+// thread also needs.
+constexpr int kPausesPerPoll = 16;
+
+}  // namespace
+
+AdaptiveSpinWaiter::AdaptiveSpinWaiter(TimeDelta max_spin_duration)
+    : max_spin_duration_(max_spin_duration),
+      spin_duration_(max_spin_duration) {
+  DCHECK_GE(max_spin_duration_, TimeDelta());
+}
+
+AdaptiveSpinWaiter::~AdaptiveSpinWaiter() = default;
+
+bool AdaptiveSpinWaiter::TimedWaitUntil(WaitableEvent* event,
+                                        TimeTicks end_time) {
+  DCHECK(event);
+  const TimeTicks start_time = TimeTicks::Now();
+
+  // Busy-wait for the first half of the polling, then yield the processor to
+  // the other threads which are ready to run until it's over.
+  const TimeTicks yield_time = std::min(start_time + spin_duration_ / 2,
+                                        end_time);
+  const TimeTicks spin_end_time = std::min(start_time + spin_duration_,
+                                           end_time);
+  for (TimeTicks now = start_time; now < spin_end_time;
+       now = TimeTicks::Now()) {
+    if (event->IsSignaled()) {
+      ++num_avoided_wakeups_;
+      UpdateSpinDuration(now - start_time, true);
+      return true;
+    }
+    if (now < yield_time) {
+      for (int i = 0; i < kPausesPerPoll; ++i)
+        YIELD_PROCESSOR;
+    } else {
+      PlatformThread::YieldCurrentThread();
+    }
+  }
+
+  bool signaled;
+  if (end_time.is_max()) {
+    // Calling TimedWaitUntil with TimeTicks::Max is not recommended per
+    // http://crbug.com/465948.
+    event->Wait();
+    signaled = true;
+  } else {
+    signaled = event->TimedWaitUntil(end_time);
+  }
+  UpdateSpinDuration(TimeTicks::Now() - start_time, signaled);
+  return signaled;
+}
+
+bool AdaptiveSpinWaiter::TimedWait(WaitableEvent* event, TimeDelta timeout) {
+  return TimedWaitUntil(event, timeout.is_max()
+                                   ? TimeTicks::Max()
+                                   : TimeTicks::Now() + timeout);
+}
+
+void AdaptiveSpinWaiter::UpdateSpinDuration(TimeDelta wait_duration,
+                                            bool signaled) {
+  // Polling for twice as long as the waits last catches most wake-ups, but
+  // polling isn't worth it when they come later than |max_spin_duration_|.
+  TimeDelta target;
+  if (signaled && wait_duration <= max_spin_duration_)
+    target = std::min(wait_duration * 2, max_spin_duration_);
+  // Move a quarter of the way, which smooths out the odd long or short wait.
+  // The rounding down makes the duration reach zero if waits keep timing out.
+  spin_duration_ = (spin_duration_ * 3 + target) / 4;
+}
+
+}  // namespace base
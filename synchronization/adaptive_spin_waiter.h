@@ -0,0 +1,68 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_SYNCHRONIZATION_ADAPTIVE_SPIN_WAITER_H_
+#define BASE_SYNCHRONIZATION_ADAPTIVE_SPIN_WAITER_H_
+
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+
+namespace base {
+
+class WaitableEvent;
+
+// Waits on a WaitableEvent the way a latency-critical thread that is given
+// work every few microseconds should: it first polls the event, busy-waiting
+// at first and then yielding the processor, and only blocks if the event
+// wasn't signaled by then. A wake-up caught while polling saves the sleep and
+// wake-up of the thread, which cost more than the polling.
+//
+// The polling duration adapts to how long the waits last: it grows towards
+// twice the durations of the waits that end within |max_spin_duration|, and
+// shrinks towards zero when they last longer, so that a thread which is idle
+// for long doesn't keep burning CPU time.
+//
+// This class is not thread-safe: an instance must be used by a single thread,
+// which typically waits on the same event each time.
+class BASE_EXPORT AdaptiveSpinWaiter {
+ public:
+  // |max_spin_duration| bounds how long a wait polls before blocking. Zero
+  // disables polling.
+  explicit AdaptiveSpinWaiter(TimeDelta max_spin_duration);
+  ~AdaptiveSpinWaiter();
+
+  // Waits until |event| is signaled or |end_time| is reached, which may be
+  // TimeTicks::Max() to wait forever. Returns true if |event| was signaled.
+  // As with WaitableEvent::TimedWaitUntil(), an automatically reset |event| is
+  // reset.
+  bool TimedWaitUntil(WaitableEvent* event, TimeTicks end_time);
+
+  // Same as TimedWaitUntil(), with a timeout which may be TimeDelta::Max().
+  bool TimedWait(WaitableEvent* event, TimeDelta timeout);
+
+  // Returns how long the next wait polls before blocking.
+  TimeDelta spin_duration() const { return spin_duration_; }
+
+  // Returns the number of waits that ended while polling, each of which saved
+  // a sleep and a wake-up.
+  uint64_t num_avoided_wakeups() const { return num_avoided_wakeups_; }
+
+ private:
+  // Adapts |spin_duration_| to a wait that lasted |wait_duration|, or that
+  // timed out if |signaled| is false.
+  void UpdateSpinDuration(TimeDelta wait_duration, bool signaled);
+
+  const TimeDelta max_spin_duration_;
+  TimeDelta spin_duration_;
+  uint64_t num_avoided_wakeups_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(AdaptiveSpinWaiter);
+};
+
+}  // namespace base
+
+#endif  // BASE_SYNCHRONIZATION_ADAPTIVE_SPIN_WAITER_H_
@@ -0,0 +1,63 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/adaptive_spin_waiter.h"
+
+#include "base/bind.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(AdaptiveSpinWaiterTest, SignaledBeforeWait) {
+  WaitableEvent event(WaitableEvent::ResetPolicy::AUTOMATIC,
+                      WaitableEvent::InitialState::NOT_SIGNALED);
+  AdaptiveSpinWaiter waiter(TimeDelta::FromMicroseconds(50));
+  event.Signal();
+  EXPECT_TRUE(waiter.TimedWait(&event, TimeDelta::Max()));
+  EXPECT_EQ(1u, waiter.num_avoided_wakeups());
+  // The signal was consumed.
+  EXPECT_FALSE(event.IsSignaled());
+}
+
+TEST(AdaptiveSpinWaiterTest, SignaledWhilePolling) {
+  WaitableEvent event(WaitableEvent::ResetPolicy::AUTOMATIC,
+                      WaitableEvent::InitialState::NOT_SIGNALED);
+  // Poll for much longer than it takes the other thread to signal.
+  AdaptiveSpinWaiter waiter(TimeDelta::FromSeconds(10));
+  Thread thread("AdaptiveSpinWaiterTest");
+  ASSERT_TRUE(thread.Start());
+  thread.task_runner()->PostDelayedTask(
+      FROM_HERE, BindOnce(&WaitableEvent::Signal, Unretained(&event)),
+      TimeDelta::FromMilliseconds(1));
+  EXPECT_TRUE(waiter.TimedWait(&event, TimeDelta::Max()));
+  EXPECT_EQ(1u, waiter.num_avoided_wakeups());
+  // Waits which end quickly shorten the polling.
+  EXPECT_LT(waiter.spin_duration(), TimeDelta::FromSeconds(10));
+}
+
+TEST(AdaptiveSpinWaiterTest, TimeOutsStopPolling) {
+  WaitableEvent event(WaitableEvent::ResetPolicy::AUTOMATIC,
+                      WaitableEvent::InitialState::NOT_SIGNALED);
+  AdaptiveSpinWaiter waiter(TimeDelta::FromMicroseconds(50));
+  EXPECT_EQ(TimeDelta::FromMicroseconds(50), waiter.spin_duration());
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_FALSE(waiter.TimedWait(&event, TimeDelta::FromMicroseconds(100)));
+  }
+  EXPECT_TRUE(waiter.spin_duration().is_zero());
+  EXPECT_EQ(0u, waiter.num_avoided_wakeups());
+}
+
+TEST(AdaptiveSpinWaiterTest, NoPolling) {
+  WaitableEvent event(WaitableEvent::ResetPolicy::AUTOMATIC,
+                      WaitableEvent::InitialState::NOT_SIGNALED);
+  AdaptiveSpinWaiter waiter((TimeDelta()));
+  event.Signal();
+  EXPECT_TRUE(waiter.TimedWait(&event, TimeDelta::Max()));
+  EXPECT_FALSE(waiter.TimedWait(&event, TimeDelta::FromMilliseconds(1)));
+  EXPECT_EQ(0u, waiter.num_avoided_wakeups());
+}
+
+}  // namespace base
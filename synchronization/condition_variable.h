@@ -69,9 +69,14 @@
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/synchronization/lock.h"
+#include "base/synchronization/synchronization_buildflags.h"
 #include "build/build_config.h"
 
-#if defined(OS_POSIX)
+#if BUILDFLAG(USE_FUTEX_LOCK)
+#include <stdint.h>
+
+#include <atomic>
+#elif defined(OS_POSIX)
 #include <pthread.h>
 #endif
 
@@ -107,6 +112,13 @@ class BASE_EXPORT ConditionVariable {
 #if defined(OS_WIN)
   CHROME_CONDITION_VARIABLE cv_;
   CHROME_SRWLOCK* const srwlock_;
+#elif BUILDFLAG(USE_FUTEX_LOCK)
+  // A futex which Signal() and Broadcast() increment to wake the waiters.
+  std::atomic<int32_t> sequence_{0};
+  // The number of threads in Wait() or TimedWait(), so that Signal() and
+  // Broadcast() can skip the system call when there are none.
+  std::atomic<int32_t> num_waiters_{0};
+  internal::LockImpl* const user_lock_impl_;
 #elif defined(OS_POSIX)
   pthread_cond_t condition_;
   pthread_mutex_t* user_mutex_;
@@ -0,0 +1,120 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A ConditionVariable built directly on a futex, used with lock_impl_futex.cc
+// instead of condition_variable_posix.cc when the use_futex_lock GN arg is
+// set.
+//
+// Waiters sleep on |sequence_| as long as it keeps the value it had before
+// they released the lock, and Signal() and Broadcast() increment it before
+// waking them, so that no wakeup is lost. Rather than waking every waiter
+// only for all but one to go back to sleep on the lock, Broadcast() wakes one
+// and requeues the others onto the lock's futex, where each Unlock() wakes the
+// next.
+
+#include "base/synchronization/condition_variable.h"
+
+#include <limits.h>
+#include <time.h>
+
+#include <algorithm>
+
+#include "base/synchronization/futex_linux.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/scoped_blocking_call.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/time/time.h"
+
+namespace base {
+
+namespace {
+
+// Waits for a Signal() or Broadcast() on a condition variable whose futex is
+// |sequence|, with |lock| held.
+void WaitForSequenceChange(std::atomic<int32_t>* sequence,
+                           internal::LockImpl* lock,
+                           const struct timespec* timeout) {
+  // Any Signal() or Broadcast() after the lock is released changes |sequence|
+  // from this value, so FutexWait() either returns at once or is woken.
+  const int32_t value = sequence->load(std::memory_order_relaxed);
+  lock->Unlock();
+  internal::FutexWait(sequence, value, timeout);
+  // Broadcast() may have moved other waiters to the lock's futex, so the lock
+  // must be retaken as contended for its Unlock() to wake them.
+  lock->LockContended();
+}
+
+}  // namespace
+
+ConditionVariable::ConditionVariable(Lock* user_lock)
+    : user_lock_impl_(&user_lock->lock_)
+#if DCHECK_IS_ON()
+    , user_lock_(user_lock)
+#endif
+{
+}
+
+ConditionVariable::~ConditionVariable() {
+  DCHECK_EQ(0, num_waiters_.load(std::memory_order_relaxed));
+}
+
+void ConditionVariable::Wait() {
+  internal::AssertBaseSyncPrimitivesAllowed();
+  ScopedBlockingCall scoped_blocking_call(BlockingType::MAY_BLOCK);
+#if DCHECK_IS_ON()
+  user_lock_->CheckHeldAndUnmark();
+#endif
+  num_waiters_.fetch_add(1, std::memory_order_relaxed);
+  WaitForSequenceChange(&sequence_, user_lock_impl_, nullptr);
+  num_waiters_.fetch_sub(1, std::memory_order_relaxed);
+#if DCHECK_IS_ON()
+  user_lock_->CheckUnheldAndMark();
+#endif
+}
+
+void ConditionVariable::TimedWait(const TimeDelta& max_time) {
+  internal::AssertBaseSyncPrimitivesAllowed();
+  ScopedBlockingCall scoped_blocking_call(BlockingType::MAY_BLOCK);
+  // FUTEX_WAIT takes a relative timeout on the monotonic clock.
+  const int64_t usecs = std::max<int64_t>(max_time.InMicroseconds(), 0);
+  struct timespec relative_time;
+  relative_time.tv_sec = usecs / Time::kMicrosecondsPerSecond;
+  relative_time.tv_nsec =
+      (usecs % Time::kMicrosecondsPerSecond) * Time::kNanosecondsPerMicrosecond;
+
+#if DCHECK_IS_ON()
+  user_lock_->CheckHeldAndUnmark();
+#endif
+  num_waiters_.fetch_add(1, std::memory_order_relaxed);
+  WaitForSequenceChange(&sequence_, user_lock_impl_, &relative_time);
+  num_waiters_.fetch_sub(1, std::memory_order_relaxed);
+#if DCHECK_IS_ON()
+  user_lock_->CheckUnheldAndMark();
+#endif
+}
+
+void ConditionVariable::Broadcast() {
+  // The waiters update |num_waiters_| with the lock held, so a thread which
+  // changed the condition with the lock held sees all the threads that
+  // waited for it.
+  if (num_waiters_.load(std::memory_order_seq_cst) == 0)
+    return;
+  const int32_t value =
+      sequence_.fetch_add(1, std::memory_order_seq_cst) + 1;
+  user_lock_impl_->MarkContended();
+  if (!internal::FutexWakeOneAndRequeue(&sequence_, value,
+                                        user_lock_impl_->native_handle())) {
+    // Another Signal() or Broadcast() changed |sequence_| in the meantime.
+    internal::FutexWake(&sequence_, INT_MAX);
+  }
+}
+
+void ConditionVariable::Signal() {
+  if (num_waiters_.load(std::memory_order_seq_cst) == 0)
+    return;
+  sequence_.fetch_add(1, std::memory_order_seq_cst);
+  internal::FutexWake(&sequence_, 1);
+}
+
+}  // namespace base
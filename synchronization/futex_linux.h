@@ -0,0 +1,76 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Thin wrappers around the futex(2) system call, for the futex-based LockImpl
+// and ConditionVariable. The futexes are private to the process, except for
+// the Shared variants, whose futexes may live in memory shared with other
+// processes.
+
+#ifndef BASE_SYNCHRONIZATION_FUTEX_LINUX_H_
+#define BASE_SYNCHRONIZATION_FUTEX_LINUX_H_
+
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+
+namespace base {
+namespace internal {
+
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t),
+              "std::atomic<int32_t> can't be used as a futex");
+
+inline int32_t* FutexAddress(std::atomic<int32_t>* futex) {
+  return reinterpret_cast<int32_t*>(futex);
+}
+
+// Sleeps as long as |*futex| is |expected_value|, until FutexWake() is called
+// on it or the relative |timeout| elapses, if not null. May also return early
+// for no reason.
+inline void FutexWait(std::atomic<int32_t>* futex,
+                      int32_t expected_value,
+                      const struct timespec* timeout) {
+  syscall(SYS_futex, FutexAddress(futex), FUTEX_WAIT_PRIVATE, expected_value,
+          timeout, nullptr, 0);
+}
+
+// Wakes up to |count| of the threads sleeping on |futex|.
+inline void FutexWake(std::atomic<int32_t>* futex, int count) {
+  syscall(SYS_futex, FutexAddress(futex), FUTEX_WAKE_PRIVATE, count, nullptr,
+          nullptr, 0);
+}
+
+// Same as FutexWait() and FutexWake(), for a futex in shared memory.
+inline void FutexWaitShared(std::atomic<int32_t>* futex,
+                            int32_t expected_value,
+                            const struct timespec* timeout) {
+  syscall(SYS_futex, FutexAddress(futex), FUTEX_WAIT, expected_value, timeout,
+          nullptr, 0);
+}
+
+inline void FutexWakeShared(std::atomic<int32_t>* futex, int count) {
+  syscall(SYS_futex, FutexAddress(futex), FUTEX_WAKE, count, nullptr, nullptr,
+          0);
+}
+
+// If |*futex| is still |expected_value|, wakes one of the threads sleeping on
+// |futex| and moves the others to sleep on |target| instead, and returns true.
+// Returns false otherwise.
+inline bool FutexWakeOneAndRequeue(std::atomic<int32_t>* futex,
+                                   int32_t expected_value,
+                                   std::atomic<int32_t>* target) {
+  // The fourth argument is the maximum number of threads to requeue.
+  return syscall(SYS_futex, FutexAddress(futex), FUTEX_CMP_REQUEUE_PRIVATE, 1,
+                 static_cast<long>(INT_MAX), FutexAddress(target),
+                 expected_value) >= 0;
+}
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_SYNCHRONIZATION_FUTEX_LINUX_H_
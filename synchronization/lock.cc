@@ -2,16 +2,26 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-// This file is used for debugging assertion support.  The Lock class
-// is functionally a wrapper around the LockImpl class, so the only
-// real intelligence in the class is in the debugging logic.
+// This file is used for debugging assertion support, and for profiling
+// contention.  The Lock class is functionally a wrapper around the LockImpl
+// class, so the only real intelligence in the class is in the debugging logic.
 
 #include "base/synchronization/lock.h"
 
-#if DCHECK_IS_ON()
+#include "base/time/time.h"
 
 namespace base {
 
+void Lock::AcquireProfiled(const void* program_counter) {
+  if (lock_.Try())
+    return;
+  const TimeTicks wait_start = TimeTicks::Now();
+  lock_.Lock();
+  LockContentionProfiler::RecordContention(this, program_counter, wait_start);
+}
+
+#if DCHECK_IS_ON()
+
 Lock::Lock() : lock_() {
 }
 
@@ -33,6 +43,6 @@ void Lock::CheckUnheldAndMark() {
   owning_thread_ref_ = PlatformThread::CurrentRef();
 }
 
-}  // namespace base
-
 #endif  // DCHECK_IS_ON()
+
+}  // namespace base
@@ -6,8 +6,11 @@
 #define BASE_SYNCHRONIZATION_LOCK_H_
 
 #include "base/base_export.h"
+#include "base/compiler_specific.h"
+#include "base/location.h"
 #include "base/logging.h"
 #include "base/macros.h"
+#include "base/synchronization/lock_contention_profiler.h"
 #include "base/synchronization/lock_impl.h"
 #include "base/threading/platform_thread.h"
 #include "build/build_config.h"
@@ -16,15 +19,25 @@ namespace base {
 
 // A convenient wrapper for an OS specific critical section.  The only real
 // intelligence in this class is in debug mode for the support for the
-// AssertAcquired() method.
+// AssertAcquired() method, and in reporting contention to the
+// LockContentionProfiler while it runs.
 class BASE_EXPORT Lock {
  public:
 #if !DCHECK_IS_ON()
    // Optimized wrapper implementation
   Lock() : lock_() {}
   ~Lock() {}
-  void Acquire() { lock_.Lock(); }
-  void Release() { lock_.Unlock(); }
+  void Acquire() {
+    if (UNLIKELY(LockContentionProfiler::IsRunning()))
+      AcquireProfiled(GetProgramCounter());
+    else
+      lock_.Lock();
+  }
+  void Release() {
+    if (UNLIKELY(LockContentionProfiler::IsRunning()))
+      LockContentionProfiler::RecordRelease(this);
+    lock_.Unlock();
+  }
 
   // If the lock is not held, take it and return true. If the lock is already
   // held by another thread, immediately return false. This must not be called
@@ -42,11 +55,16 @@ class BASE_EXPORT Lock {
   // a thread attempts to acquire the lock a second time (while already holding
   // it).
   void Acquire() {
-    lock_.Lock();
+    if (UNLIKELY(LockContentionProfiler::IsRunning()))
+      AcquireProfiled(GetProgramCounter());
+    else
+      lock_.Lock();
     CheckUnheldAndMark();
   }
   void Release() {
     CheckHeldAndUnmark();
+    if (UNLIKELY(LockContentionProfiler::IsRunning()))
+      LockContentionProfiler::RecordRelease(this);
     lock_.Unlock();
   }
 
@@ -86,6 +104,10 @@ class BASE_EXPORT Lock {
 #endif
 
  private:
+  // Acquires the lock, and reports to the LockContentionProfiler whether it
+  // had to wait for it, at |program_counter|.
+  void AcquireProfiled(const void* program_counter);
+
 #if DCHECK_IS_ON()
   // Members and routines taking care of locks assertions.
   // Note that this checks for recursive locks and allows them
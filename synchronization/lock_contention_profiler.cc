@@ -0,0 +1,377 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/lock_contention_profiler.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/allocator/partition_allocator/spin_lock.h"
+#include "base/bits.h"
+#include "base/json/json_writer.h"
+#include "base/metrics/histogram.h"
+#include "base/strings/stringprintf.h"
+#include "base/threading/platform_thread.h"
+#include "base/trace_event/trace_event.h"
+#include "base/values.h"
+
+namespace base {
+
+namespace {
+
+// The tables are picked by thread id, so that threads rarely share one. They
+// have a fixed size, and are protected by SpinLocks rather than Locks, as
+// they're updated from Lock itself.
+constexpr size_t kNumShards = 16;
+constexpr size_t kMaxSitesPerShard = 64;
+// Contended acquisitions not released yet, of all the threads of a shard.
+constexpr size_t kMaxHeldLocksPerShard = 32;
+constexpr size_t kMaxNamedLocks = 64;
+
+// Bucket 0 counts times under a microsecond, and bucket i > 0 times in
+// [2^(i-1), 2^i) microseconds. The last bucket also counts longer times.
+constexpr size_t kNumBuckets = 25;
+
+constexpr char kWaitTimeHistogram[] = "Lock.Contention.WaitTime";
+constexpr char kHoldTimeHistogram[] = "Lock.Contention.HoldTime";
+
+struct TimeStats {
+  void Add(TimeDelta time) {
+    total += time;
+    max = std::max(max, time);
+    const int64_t us = std::min<int64_t>(time.InMicroseconds(),
+                                         std::numeric_limits<uint32_t>::max());
+    const size_t bucket =
+        us <= 0 ? 0 : bits::Log2Floor(static_cast<uint32_t>(us)) + 1;
+    ++buckets[std::min(bucket, kNumBuckets - 1)];
+  }
+
+  void Merge(const TimeStats& other) {
+    total += other.total;
+    max = std::max(max, other.max);
+    for (size_t i = 0; i < kNumBuckets; ++i)
+      buckets[i] += other.buckets[i];
+  }
+
+  TimeDelta total;
+  TimeDelta max;
+  uint32_t buckets[kNumBuckets] = {};
+};
+
+struct Site {
+  const void* program_counter = nullptr;
+  const char* name = nullptr;
+  uint64_t contentions = 0;
+  TimeStats wait;
+  TimeStats hold;
+};
+
+struct HeldLock {
+  const Lock* lock;
+  PlatformThreadId thread_id;
+  Site* site;
+  TimeTicks acquire_time;
+};
+
+struct Shard {
+  subtle::SpinLock lock;
+  Site sites[kMaxSitesPerShard];
+  size_t num_sites = 0;
+  HeldLock held_locks[kMaxHeldLocksPerShard];
+  // Only written under |lock|, but read without it by RecordRelease(), to
+  // skip the Locks acquired without contention.
+  std::atomic<size_t> num_held_locks{0};
+  uint64_t num_dropped_contentions = 0;
+};
+
+struct NamedLock {
+  const Lock* lock;
+  const char* name;
+};
+
+class State {
+ public:
+  State() = default;
+
+  Shard* GetShardForCurrentThread(PlatformThreadId* thread_id) {
+    *thread_id = PlatformThread::CurrentId();
+    return &shards_[static_cast<size_t>(*thread_id) % kNumShards];
+  }
+
+  Shard* shard(size_t index) { return &shards_[index]; }
+
+  void Reset() {
+    for (Shard& shard : shards_) {
+      subtle::SpinLock::Guard guard(shard.lock);
+      std::fill(std::begin(shard.sites), std::end(shard.sites), Site());
+      shard.num_sites = 0;
+      shard.num_held_locks.store(0, std::memory_order_relaxed);
+      shard.num_dropped_contentions = 0;
+    }
+  }
+
+  void SetLockName(const Lock* lock, const char* name) {
+    subtle::SpinLock::Guard guard(named_locks_lock_);
+    NamedLock* const end = named_locks_ + num_named_locks_;
+    NamedLock* const it =
+        std::find_if(named_locks_, end, [lock](const NamedLock& named_lock) {
+          return named_lock.lock == lock;
+        });
+    if (it != end) {
+      if (name) {
+        it->name = name;
+      } else {
+        *it = named_locks_[num_named_locks_ - 1];
+        --num_named_locks_;
+      }
+    } else if (name && num_named_locks_ < kMaxNamedLocks) {
+      named_locks_[num_named_locks_++] = {lock, name};
+    }
+  }
+
+  const char* GetLockName(const Lock* lock) {
+    subtle::SpinLock::Guard guard(named_locks_lock_);
+    for (size_t i = 0; i < num_named_locks_; ++i) {
+      if (named_locks_[i].lock == lock)
+        return named_locks_[i].name;
+    }
+    return nullptr;
+  }
+
+ private:
+  Shard shards_[kNumShards];
+
+  subtle::SpinLock named_locks_lock_;
+  NamedLock named_locks_[kMaxNamedLocks];
+  size_t num_named_locks_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(State);
+};
+
+State* GetState() {
+  // Leaked, as Locks may be released during static destruction.
+  static State* const state = new State;
+  return state;
+}
+
+// Returns the sites of all the shards, merged.
+std::vector<Site> CollectSites() {
+  std::map<std::pair<const void*, const char*>, Site> sites_by_key;
+  // A shard is copied before being merged, as allocating while holding its
+  // SpinLock could deadlock if the allocator contends on a Lock.
+  std::vector<Site> shard_sites;
+  shard_sites.reserve(kMaxSitesPerShard);
+  for (size_t i = 0; i < kNumShards; ++i) {
+    Shard* const shard = GetState()->shard(i);
+    shard_sites.clear();
+    {
+      subtle::SpinLock::Guard guard(shard->lock);
+      shard_sites.insert(shard_sites.end(), shard->sites,
+                         shard->sites + shard->num_sites);
+    }
+    for (const Site& site : shard_sites) {
+      Site& merged_site =
+          sites_by_key[std::make_pair(site.program_counter, site.name)];
+      merged_site.program_counter = site.program_counter;
+      merged_site.name = site.name;
+      merged_site.contentions += site.contentions;
+      merged_site.wait.Merge(site.wait);
+      merged_site.hold.Merge(site.hold);
+    }
+  }
+
+  std::vector<Site> sites;
+  sites.reserve(sites_by_key.size());
+  for (const auto& key_and_site : sites_by_key)
+    sites.push_back(key_and_site.second);
+  std::sort(sites.begin(), sites.end(), [](const Site& a, const Site& b) {
+    return a.wait.total > b.wait.total;
+  });
+  return sites;
+}
+
+HistogramBase* GetHistogram(const std::string& name) {
+  return Histogram::FactoryGet(name, 1, 10 * Time::kMicrosecondsPerSecond, 50,
+                               HistogramBase::kUmaTargetedHistogramFlag);
+}
+
+void AddToHistogram(const TimeStats& stats, HistogramBase* histogram) {
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    if (stats.buckets[i])
+      histogram->AddCount(i == 0 ? 0 : 1 << (i - 1), stats.buckets[i]);
+  }
+}
+
+std::string GetSiteName(const LockContentionProfiler::SiteStats& site) {
+  return site.name ? site.name : StringPrintf("pc:%p", site.program_counter);
+}
+
+// The stats of the sites, as an argument of a trace event.
+class StatsTracingInfo : public trace_event::ConvertableToTraceFormat {
+ public:
+  explicit StatsTracingInfo(
+      std::vector<LockContentionProfiler::SiteStats> stats)
+      : stats_(std::move(stats)) {}
+
+  // trace_event::ConvertableToTraceFormat implementation.
+  void AppendAsTraceFormat(std::string* out) const override {
+    ListValue list;
+    for (const LockContentionProfiler::SiteStats& site : stats_) {
+      auto dict = std::make_unique<DictionaryValue>();
+      dict->SetString("site", GetSiteName(site));
+      dict->SetDouble("contentions", site.contentions);
+      dict->SetDouble("total_wait_us", site.total_wait_time.InMicroseconds());
+      dict->SetDouble("max_wait_us", site.max_wait_time.InMicroseconds());
+      dict->SetDouble("total_hold_us", site.total_hold_time.InMicroseconds());
+      dict->SetDouble("max_hold_us", site.max_hold_time.InMicroseconds());
+      list.Append(std::move(dict));
+    }
+    std::string tmp;
+    JSONWriter::Write(list, &tmp);
+    out->append(tmp);
+  }
+
+ private:
+  const std::vector<LockContentionProfiler::SiteStats> stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(StatsTracingInfo);
+};
+
+}  // namespace
+
+std::atomic_bool LockContentionProfiler::g_running_{false};
+
+// static
+void LockContentionProfiler::Start() {
+  GetState()->Reset();
+  g_running_.store(true, std::memory_order_relaxed);
+}
+
+// static
+void LockContentionProfiler::Stop() {
+  g_running_.store(false, std::memory_order_relaxed);
+}
+
+// static
+void LockContentionProfiler::SetLockName(const Lock* lock, const char* name) {
+  GetState()->SetLockName(lock, name);
+}
+
+// static
+std::vector<LockContentionProfiler::SiteStats>
+LockContentionProfiler::GetStats() {
+  std::vector<SiteStats> stats;
+  for (const Site& site : CollectSites()) {
+    stats.emplace_back();
+    SiteStats& site_stats = stats.back();
+    site_stats.program_counter = site.program_counter;
+    site_stats.name = site.name;
+    site_stats.contentions = site.contentions;
+    site_stats.total_wait_time = site.wait.total;
+    site_stats.max_wait_time = site.wait.max;
+    site_stats.total_hold_time = site.hold.total;
+    site_stats.max_hold_time = site.hold.max;
+  }
+  return stats;
+}
+
+// static
+uint64_t LockContentionProfiler::GetNumDroppedContentions() {
+  uint64_t num_dropped_contentions = 0;
+  for (size_t i = 0; i < kNumShards; ++i) {
+    Shard* const shard = GetState()->shard(i);
+    subtle::SpinLock::Guard guard(shard->lock);
+    num_dropped_contentions += shard->num_dropped_contentions;
+  }
+  return num_dropped_contentions;
+}
+
+// static
+void LockContentionProfiler::ReportStats() {
+  HistogramBase* const wait_histogram = GetHistogram(kWaitTimeHistogram);
+  HistogramBase* const hold_histogram = GetHistogram(kHoldTimeHistogram);
+  for (const Site& site : CollectSites()) {
+    AddToHistogram(site.wait, wait_histogram);
+    AddToHistogram(site.hold, hold_histogram);
+    if (site.name) {
+      AddToHistogram(site.wait, GetHistogram(std::string(kWaitTimeHistogram) +
+                                             "." + site.name));
+      AddToHistogram(site.hold, GetHistogram(std::string(kHoldTimeHistogram) +
+                                             "." + site.name));
+    }
+  }
+
+  TRACE_EVENT_INSTANT1(TRACE_DISABLED_BY_DEFAULT("lock_contention"),
+                       "LockContentionProfiler::Stats",
+                       TRACE_EVENT_SCOPE_PROCESS, "stats",
+                       std::make_unique<StatsTracingInfo>(GetStats()));
+}
+
+// static
+void LockContentionProfiler::RecordContention(const Lock* lock,
+                                              const void* program_counter,
+                                              TimeTicks wait_start) {
+  const TimeTicks acquire_time = TimeTicks::Now();
+  State* const state = GetState();
+  const char* const name = state->GetLockName(lock);
+  if (name)
+    program_counter = nullptr;
+
+  PlatformThreadId thread_id;
+  Shard* const shard = state->GetShardForCurrentThread(&thread_id);
+  subtle::SpinLock::Guard guard(shard->lock);
+  Site* const end = shard->sites + shard->num_sites;
+  Site* site = std::find_if(shard->sites, end, [&](const Site& candidate) {
+    return candidate.program_counter == program_counter &&
+           candidate.name == name;
+  });
+  if (site == end) {
+    if (shard->num_sites == kMaxSitesPerShard) {
+      ++shard->num_dropped_contentions;
+      return;
+    }
+    ++shard->num_sites;
+    site->program_counter = program_counter;
+    site->name = name;
+  }
+  ++site->contentions;
+  site->wait.Add(acquire_time - wait_start);
+
+  const size_t num_held_locks =
+      shard->num_held_locks.load(std::memory_order_relaxed);
+  if (num_held_locks < kMaxHeldLocksPerShard) {
+    shard->held_locks[num_held_locks] = {lock, thread_id, site, acquire_time};
+    shard->num_held_locks.store(num_held_locks + 1, std::memory_order_relaxed);
+  }
+}
+
+// static
+void LockContentionProfiler::RecordRelease(const Lock* lock) {
+  PlatformThreadId thread_id;
+  Shard* const shard = GetState()->GetShardForCurrentThread(&thread_id);
+  // This thread's contended acquisitions, if any, were counted by this thread.
+  if (shard->num_held_locks.load(std::memory_order_relaxed) == 0)
+    return;
+
+  const TimeTicks release_time = TimeTicks::Now();
+  subtle::SpinLock::Guard guard(shard->lock);
+  const size_t num_held_locks =
+      shard->num_held_locks.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < num_held_locks; ++i) {
+    HeldLock& held_lock = shard->held_locks[i];
+    if (held_lock.lock == lock && held_lock.thread_id == thread_id) {
+      held_lock.site->hold.Add(release_time - held_lock.acquire_time);
+      held_lock = shard->held_locks[num_held_locks - 1];
+      shard->num_held_locks.store(num_held_locks - 1,
+                                  std::memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+}  // namespace base
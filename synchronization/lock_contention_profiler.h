@@ -0,0 +1,98 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_SYNCHRONIZATION_LOCK_CONTENTION_PROFILER_H_
+#define BASE_SYNCHRONIZATION_LOCK_CONTENTION_PROFILER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+
+namespace base {
+
+class Lock;
+
+// An opt-in profiler of the contention of base::Lock, and so of SchedulerLock.
+// While it runs, each acquisition of a Lock held by another thread records how
+// long it waited for the Lock, and how long it then held it, at its site: the
+// program counter of the Acquire() call, or the name of the Lock if it has one
+// (see SetLockName()). Uncontended acquisitions only check whether the profiler
+// runs.
+//
+// The stats are aggregated in tables shared by as few threads as possible,
+// which are updated without allocating or taking a Lock, and read with
+// GetStats() or exported as histograms and a trace event with ReportStats():
+//
+//   LockContentionProfiler::Start();
+//   ...
+//   LockContentionProfiler::Stop();
+//   LockContentionProfiler::ReportStats();
+class BASE_EXPORT LockContentionProfiler {
+ public:
+  struct BASE_EXPORT SiteStats {
+    // The site: a program counter in the caller of Lock::Acquire(), or the
+    // name of the Lock, in which case |program_counter| is null.
+    const void* program_counter = nullptr;
+    const char* name = nullptr;
+
+    uint64_t contentions = 0;
+    TimeDelta total_wait_time;
+    TimeDelta max_wait_time;
+    // From the acquisition to the release, of the contended acquisitions only.
+    TimeDelta total_hold_time;
+    TimeDelta max_hold_time;
+  };
+
+  // Starts profiling, with empty stats.
+  static void Start();
+
+  // Stops profiling. The stats are kept until the next Start().
+  static void Stop();
+
+  static bool IsRunning() { return g_running_.load(std::memory_order_relaxed); }
+
+  // Records the contentions of |lock| under |name|, which must outlive it
+  // (e.g. a string literal), rather than at the program counters of their
+  // Acquire() calls. This is needed when |lock| is always acquired from the
+  // same wrapper, e.g. SchedulerLock in DCHECK builds. A null |name| clears it,
+  // which must be done before |lock| is destroyed. Locks beyond the first 64
+  // named at once aren't named.
+  static void SetLockName(const Lock* lock, const char* name);
+
+  // Returns the stats of all the sites with contentions, from the most to the
+  // least total wait time.
+  static std::vector<SiteStats> GetStats();
+
+  // Returns how many contentions weren't recorded because their table was
+  // full of other sites.
+  static uint64_t GetNumDroppedContentions();
+
+  // Records the wait and hold times of all the contentions, in microseconds,
+  // in the Lock.Contention.WaitTime and Lock.Contention.HoldTime histograms,
+  // and in the same histograms suffixed with the name of each named site. Also
+  // emits GetStats() as a "LockContentionProfiler::Stats" trace event in the
+  // disabled-by-default-lock_contention category.
+  static void ReportStats();
+
+  // Called by Lock, only while profiling. RecordContention() is called when
+  // |lock| was acquired, after waiting for it since |wait_start|.
+  static void RecordContention(const Lock* lock,
+                               const void* program_counter,
+                               TimeTicks wait_start);
+  static void RecordRelease(const Lock* lock);
+
+ private:
+  static std::atomic_bool g_running_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(LockContentionProfiler);
+};
+
+}  // namespace base
+
+#endif  // BASE_SYNCHRONIZATION_LOCK_CONTENTION_PROFILER_H_
@@ -0,0 +1,151 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/lock_contention_profiler.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/test/histogram_tester.h"
+#include "base/test/test_timeouts.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr char kLockName[] = "LockContentionProfilerTest";
+constexpr TimeDelta kHoldTime = TimeDelta::FromMilliseconds(10);
+
+// Makes another thread wait for |lock| while this thread holds it. The other
+// thread then holds it for kHoldTime.
+void Contend(Lock* lock) {
+  Thread thread("Waiter");
+  thread.Start();
+  WaitableEvent waiting(WaitableEvent::ResetPolicy::MANUAL,
+                        WaitableEvent::InitialState::NOT_SIGNALED);
+  lock->Acquire();
+  thread.task_runner()->PostTask(
+      FROM_HERE, BindOnce(
+                     [](Lock* lock, WaitableEvent* waiting) {
+                       waiting->Signal();
+                       AutoLock auto_lock(*lock);
+                       PlatformThread::Sleep(kHoldTime);
+                     },
+                     lock, &waiting));
+  waiting.Wait();
+  PlatformThread::Sleep(TestTimeouts::tiny_timeout());
+  lock->Release();
+  thread.Stop();
+}
+
+const LockContentionProfiler::SiteStats* FindSite(
+    const std::vector<LockContentionProfiler::SiteStats>& stats,
+    const char* name) {
+  const auto it =
+      std::find_if(stats.begin(), stats.end(),
+                   [name](const LockContentionProfiler::SiteStats& site) {
+                     return site.name == name;
+                   });
+  return it == stats.end() ? nullptr : &*it;
+}
+
+class LockContentionProfilerTest : public testing::Test {
+ protected:
+  LockContentionProfilerTest() {
+    LockContentionProfiler::SetLockName(&lock_, kLockName);
+  }
+
+  ~LockContentionProfilerTest() override {
+    LockContentionProfiler::Stop();
+    LockContentionProfiler::SetLockName(&lock_, nullptr);
+  }
+
+  Lock lock_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LockContentionProfilerTest);
+};
+
+}  // namespace
+
+TEST_F(LockContentionProfilerTest, RecordsContention) {
+  LockContentionProfiler::Start();
+  Contend(&lock_);
+  LockContentionProfiler::Stop();
+
+  const std::vector<LockContentionProfiler::SiteStats> stats =
+      LockContentionProfiler::GetStats();
+  const LockContentionProfiler::SiteStats* site = FindSite(stats, kLockName);
+  ASSERT_TRUE(site);
+  EXPECT_FALSE(site->program_counter);
+  EXPECT_EQ(1u, site->contentions);
+  EXPECT_GT(site->total_wait_time, TimeDelta());
+  EXPECT_EQ(site->total_wait_time, site->max_wait_time);
+  EXPECT_GE(site->total_hold_time, kHoldTime);
+  EXPECT_EQ(site->total_hold_time, site->max_hold_time);
+}
+
+TEST_F(LockContentionProfilerTest, UnnamedLock) {
+  Lock lock;
+  LockContentionProfiler::Start();
+  Contend(&lock);
+  LockContentionProfiler::Stop();
+
+  // The contention is recorded at the program counter of its Acquire() call.
+  const std::vector<LockContentionProfiler::SiteStats> stats =
+      LockContentionProfiler::GetStats();
+  const LockContentionProfiler::SiteStats* site = FindSite(stats, nullptr);
+  ASSERT_TRUE(site);
+  EXPECT_TRUE(site->program_counter);
+  EXPECT_GE(site->contentions, 1u);
+}
+
+TEST_F(LockContentionProfilerTest, NotRunning) {
+  LockContentionProfiler::Start();
+  LockContentionProfiler::Stop();
+  Contend(&lock_);
+  EXPECT_FALSE(FindSite(LockContentionProfiler::GetStats(), kLockName));
+}
+
+TEST_F(LockContentionProfilerTest, NoContention) {
+  LockContentionProfiler::Start();
+  for (int i = 0; i < 10; ++i) {
+    AutoLock auto_lock(lock_);
+  }
+  EXPECT_TRUE(lock_.Try());
+  lock_.Release();
+  LockContentionProfiler::Stop();
+  EXPECT_FALSE(FindSite(LockContentionProfiler::GetStats(), kLockName));
+}
+
+TEST_F(LockContentionProfilerTest, StartClearsStats) {
+  LockContentionProfiler::Start();
+  Contend(&lock_);
+  LockContentionProfiler::Start();
+  LockContentionProfiler::Stop();
+  EXPECT_FALSE(FindSite(LockContentionProfiler::GetStats(), kLockName));
+}
+
+TEST_F(LockContentionProfilerTest, ReportStats) {
+  LockContentionProfiler::Start();
+  Contend(&lock_);
+  LockContentionProfiler::Stop();
+
+  HistogramTester histogram_tester;
+  LockContentionProfiler::ReportStats();
+  histogram_tester.ExpectTotalCount(
+      "Lock.Contention.WaitTime.LockContentionProfilerTest", 1);
+  histogram_tester.ExpectTotalCount(
+      "Lock.Contention.HoldTime.LockContentionProfilerTest", 1);
+  EXPECT_GE(
+      histogram_tester.GetAllSamples("Lock.Contention.WaitTime").size(), 1u);
+}
+
+}  // namespace base
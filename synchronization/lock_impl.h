@@ -8,10 +8,15 @@
 #include "base/base_export.h"
 #include "base/logging.h"
 #include "base/macros.h"
+#include "base/synchronization/synchronization_buildflags.h"
 #include "build/build_config.h"
 
 #if defined(OS_WIN)
 #include "base/win/windows_types.h"
+#elif BUILDFLAG(USE_FUTEX_LOCK)
+#include <stdint.h>
+
+#include <atomic>
 #elif defined(OS_POSIX)
 #include <errno.h>
 #include <pthread.h>
@@ -27,6 +32,9 @@ class BASE_EXPORT LockImpl {
  public:
 #if defined(OS_WIN)
   using NativeHandle = CHROME_SRWLOCK;
+#elif BUILDFLAG(USE_FUTEX_LOCK)
+  // A futex holding one of the states below.
+  using NativeHandle = std::atomic<int32_t>;
 #elif defined(OS_POSIX)
   using NativeHandle = pthread_mutex_t;
 #endif
@@ -55,7 +63,31 @@ class BASE_EXPORT LockImpl {
   static bool PriorityInheritanceAvailable();
 #endif
 
+#if BUILDFLAG(USE_FUTEX_LOCK)
+  // Takes the lock, marking it as having waiters. ConditionVariable uses this
+  // to retake the lock after a wait, since Broadcast() may have moved other
+  // waiters to the lock's futex.
+  void LockContended();
+
+  // Marks the lock as having waiters if it is held, so that Unlock() wakes one
+  // of them. ConditionVariable::Broadcast() calls this before moving its
+  // waiters to the lock's futex.
+  void MarkContended();
+#endif
+
  private:
+#if BUILDFLAG(USE_FUTEX_LOCK)
+  enum : int32_t {
+    kUnlocked = 0,
+    kLocked = 1,
+    // Locked, with threads possibly sleeping on the futex.
+    kLockedContended = 2,
+  };
+
+  // Wakes a thread sleeping in LockContended().
+  void WakeWaiter();
+#endif
+
   NativeHandle native_handle_;
 
   DISALLOW_COPY_AND_ASSIGN(LockImpl);
@@ -65,6 +97,13 @@ class BASE_EXPORT LockImpl {
 void LockImpl::Unlock() {
   ::ReleaseSRWLockExclusive(reinterpret_cast<PSRWLOCK>(&native_handle_));
 }
+#elif BUILDFLAG(USE_FUTEX_LOCK)
+void LockImpl::Unlock() {
+  if (native_handle_.exchange(kUnlocked, std::memory_order_release) ==
+      kLockedContended) {
+    WakeWaiter();
+  }
+}
 #elif defined(OS_POSIX)
 void LockImpl::Unlock() {
   int rv = pthread_mutex_unlock(&native_handle_);
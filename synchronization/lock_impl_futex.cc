@@ -0,0 +1,113 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A LockImpl built directly on a futex, used instead of lock_impl_posix.cc on
+// Linux and Android when the use_futex_lock GN arg is set.
+//
+// The futex is the usual three-state mutex: unlocked, locked, and locked with
+// possible waiters, so uncontended Lock() and Unlock() are a single atomic
+// operation and Unlock() only makes a system call when someone may be asleep.
+// Unlike pthread_mutex_lock(), Lock() briefly polls a contended lock before
+// sleeping, as base::Lock's critical sections are usually short enough for
+// the holder to release it in the meantime, which saves two system calls and
+// two context switches.
+//
+// Unlock() doesn't hand the lock off to the thread it wakes: a running thread
+// may take it first, and the woken thread then goes back to sleep. This is
+// what pthread mutexes do too, and avoids lock convoys, where every
+// acquisition would have to wait for a thread to be scheduled. However, a
+// thread doesn't poll once others are asleep, so that it doesn't keep
+// overtaking them.
+
+#include "base/synchronization/lock_impl.h"
+
+#include "base/debug/activity_tracker.h"
+#include "base/synchronization/futex_linux.h"
+#include "build/build_config.h"
+
+// As in partition_allocator/spin_lock.cc, tells the processor that this is a
+// busy wait, so it can e.g. give more resources to the other hyper-thread.
+#if defined(ARCH_CPU_X86_FAMILY) || \
+    (defined(ARCH_CPU_MIPS64EL) && __mips_isa_rev >= 2)
+#define YIELD_PROCESSOR __asm__ __volatile__("pause")
+#elif (defined(ARCH_CPU_ARMEL) && __ARM_ARCH >= 6) || defined(ARCH_CPU_ARM64)
+#define YIELD_PROCESSOR __asm__ __volatile__("yield")
+#else
+#define YIELD_PROCESSOR ((void)0)
+#endif
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// How many times Lock() polls a lock held by another thread before sleeping.
+// This is a few microseconds, which is less than the cost of sleeping and
+// being woken up.
+constexpr int kSpinCount = 100;
+
+}  // namespace
+
+LockImpl::LockImpl() : native_handle_(kUnlocked) {}
+
+LockImpl::~LockImpl() {
+  DCHECK_EQ(kUnlocked, native_handle_.load(std::memory_order_relaxed));
+}
+
+bool LockImpl::Try() {
+  int32_t state = kUnlocked;
+  return native_handle_.compare_exchange_strong(
+      state, kLocked, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void LockImpl::Lock() {
+  // Unlike with pthread mutexes, Try() doesn't make a system call, so it's
+  // always worth trying before the (relatively expensive) tracked activity.
+  if (Try())
+    return;
+
+  base::debug::ScopedLockAcquireActivity lock_activity(this);
+  for (int i = 0; i < kSpinCount; ++i) {
+    int32_t state = native_handle_.load(std::memory_order_relaxed);
+    if (state == kLockedContended)
+      break;
+    if (state == kUnlocked &&
+        native_handle_.compare_exchange_weak(state, kLocked,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+      return;
+    }
+    YIELD_PROCESSOR;
+  }
+  LockContended();
+}
+
+void LockImpl::LockContended() {
+  // This thread doesn't know whether there are other waiters, so it takes the
+  // lock as contended. At worst, that costs an unneeded FutexWake().
+  while (native_handle_.exchange(kLockedContended, std::memory_order_acquire) !=
+         kUnlocked) {
+    FutexWait(&native_handle_, kLockedContended, nullptr);
+  }
+}
+
+void LockImpl::MarkContended() {
+  int32_t state = kLocked;
+  native_handle_.compare_exchange_strong(state, kLockedContended,
+                                         std::memory_order_relaxed);
+}
+
+void LockImpl::WakeWaiter() {
+  FutexWake(&native_handle_, 1);
+}
+
+// static
+bool LockImpl::PriorityInheritanceAvailable() {
+  // This would need FUTEX_LOCK_PI, which has the same security concerns as
+  // priority inheritance pthread mutexes: see lock_impl_posix.cc.
+  return false;
+}
+
+}  // namespace internal
+}  // namespace base
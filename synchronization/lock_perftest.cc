@@ -0,0 +1,173 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/lock.h"
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/threading/simple_thread.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+// These measure the Lock and ConditionVariable implementation that the build
+// uses: compare builds with and without the use_futex_lock GN arg.
+
+namespace base {
+
+namespace {
+
+constexpr int kIterations = 200000;
+
+// Repeatedly takes a lock shared with other threads to increment a counter.
+class LockUser : public DelegateSimpleThread::Delegate {
+ public:
+  LockUser(Lock* lock, int* counter) : lock_(lock), counter_(counter) {}
+
+  void Run() override {
+    for (int i = 0; i < kIterations; ++i) {
+      AutoLock auto_lock(*lock_);
+      ++*counter_;
+    }
+  }
+
+ private:
+  Lock* const lock_;
+  int* const counter_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockUser);
+};
+
+// Waits for |round| to advance |rounds| times, then decrements |remaining|.
+class RoundWaiter : public DelegateSimpleThread::Delegate {
+ public:
+  RoundWaiter(Lock* lock,
+              ConditionVariable* round_changed,
+              ConditionVariable* done,
+              const int* round,
+              int* remaining,
+              int rounds)
+      : lock_(lock),
+        round_changed_(round_changed),
+        done_(done),
+        round_(round),
+        remaining_(remaining),
+        rounds_(rounds) {}
+
+  void Run() override {
+    AutoLock auto_lock(*lock_);
+    for (int seen = 0; seen < rounds_; ++seen) {
+      while (*round_ == seen)
+        round_changed_->Wait();
+      if (--*remaining_ == 0)
+        done_->Signal();
+    }
+  }
+
+ private:
+  Lock* const lock_;
+  ConditionVariable* const round_changed_;
+  ConditionVariable* const done_;
+  const int* const round_;
+  int* const remaining_;
+  const int rounds_;
+
+  DISALLOW_COPY_AND_ASSIGN(RoundWaiter);
+};
+
+}  // namespace
+
+TEST(LockPerfTest, Uncontended) {
+  Lock lock;
+  int counter = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    AutoLock auto_lock(lock);
+    ++counter;
+  }
+  TimeDelta elapsed = TimeTicks::Now() - start;
+  EXPECT_EQ(kIterations, counter);
+  perf_test::PrintResult("acquire_release", "", "uncontended",
+                         elapsed.InNanoseconds() /
+                             static_cast<double>(kIterations),
+                         "ns/acquisition", true);
+}
+
+TEST(LockPerfTest, Contended) {
+  for (int num_threads : {2, 4, 8, 16}) {
+    Lock lock;
+    int counter = 0;
+    std::vector<std::unique_ptr<LockUser>> users;
+    std::vector<std::unique_ptr<DelegateSimpleThread>> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      users.push_back(std::make_unique<LockUser>(&lock, &counter));
+      threads.push_back(std::make_unique<DelegateSimpleThread>(
+          users.back().get(), "LockPerfTest"));
+    }
+
+    TimeTicks start = TimeTicks::Now();
+    for (const auto& thread : threads)
+      thread->Start();
+    for (const auto& thread : threads)
+      thread->Join();
+    TimeDelta elapsed = TimeTicks::Now() - start;
+
+    EXPECT_EQ(num_threads * kIterations, counter);
+    perf_test::PrintResult(
+        "acquire_release", StringPrintf("_%d_threads", num_threads),
+        "contended",
+        elapsed.InNanoseconds() /
+            static_cast<double>(num_threads * kIterations),
+        "ns/acquisition", true);
+  }
+}
+
+TEST(LockPerfTest, Broadcast) {
+  constexpr int kRounds = 2000;
+  for (int num_threads : {1, 4, 16}) {
+    Lock lock;
+    ConditionVariable round_changed(&lock);
+    ConditionVariable done(&lock);
+    int round = 0;
+    int remaining = 0;
+    std::vector<std::unique_ptr<RoundWaiter>> waiters;
+    std::vector<std::unique_ptr<DelegateSimpleThread>> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      waiters.push_back(std::make_unique<RoundWaiter>(
+          &lock, &round_changed, &done, &round, &remaining, kRounds));
+      threads.push_back(std::make_unique<DelegateSimpleThread>(
+          waiters.back().get(), "LockPerfTest"));
+      threads.back()->Start();
+    }
+
+    // Each round wakes all the waiters, and waits for them to have seen it.
+    TimeTicks start = TimeTicks::Now();
+    {
+      AutoLock auto_lock(lock);
+      for (int i = 0; i < kRounds; ++i) {
+        remaining = num_threads;
+        ++round;
+        round_changed.Broadcast();
+        while (remaining > 0)
+          done.Wait();
+      }
+    }
+    TimeDelta elapsed = TimeTicks::Now() - start;
+    for (const auto& thread : threads)
+      thread->Join();
+
+    perf_test::PrintResult(
+        "broadcast", StringPrintf("_%d_waiters", num_threads), "round_trip",
+        elapsed.InNanoseconds() / static_cast<double>(kRounds), "ns/round",
+        true);
+  }
+}
+
+}  // namespace base
@@ -0,0 +1,196 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Retired snapshots are reclaimed with epochs. A global epoch is incremented
+// every time a snapshot is retired, and each thread records the epoch at which
+// it entered its outermost read scope. A snapshot retired at epoch E can only
+// be in use by threads that entered their read scope at E or earlier: a thread
+// which read the epoch after it moved past E also reads the pointer after it
+// was replaced, as all of these accesses are sequentially consistent.
+
+#include "base/synchronization/rcu_ptr.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// Per-thread read scope state. Records are never deleted: a thread releases
+// its record when it exits, and a new thread may then reuse it.
+struct ReaderRecord {
+  // The epoch at which the thread entered its outermost read scope, or 0 if
+  // it's not in one.
+  std::atomic<uint64_t> epoch{0};
+
+  // Whether a thread owns this record.
+  std::atomic<bool> in_use{true};
+
+  // Depth of nested read scopes. Only accessed by the owning thread.
+  int nesting = 0;
+
+  // Immutable once the record is in |g_reader_records|.
+  ReaderRecord* next = nullptr;
+};
+
+struct RetiredSnapshot {
+  const void* ptr;
+  void (*deleter)(const void*);
+  uint64_t epoch;
+};
+
+struct RetiredList {
+  Lock lock;
+  std::vector<RetiredSnapshot> snapshots;
+};
+
+// Starts at 1 so that 0 can mean "not in a read scope".
+std::atomic<uint64_t> g_epoch{1};
+
+// Lock-free list of all reader records, to which records are only prepended.
+std::atomic<ReaderRecord*> g_reader_records{nullptr};
+
+// The size of the retired list, so that RcuReclaimRetired() can return
+// without taking the lock when it's empty.
+std::atomic<size_t> g_num_retired{0};
+
+RetiredList& GetRetiredList() {
+  static NoDestructor<RetiredList> retired_list;
+  return *retired_list;
+}
+
+void ReleaseReaderRecord(void* value) {
+  ReaderRecord* record = static_cast<ReaderRecord*>(value);
+  DCHECK_EQ(0, record->nesting);
+  record->in_use.store(false, std::memory_order_release);
+}
+
+ThreadLocalStorage::Slot& GetReaderRecordSlot() {
+  static NoDestructor<ThreadLocalStorage::Slot> reader_record_slot(
+      &ReleaseReaderRecord);
+  return *reader_record_slot;
+}
+
+ReaderRecord* GetReaderRecordForCurrentThread() {
+  ThreadLocalStorage::Slot& slot = GetReaderRecordSlot();
+  ReaderRecord* record = static_cast<ReaderRecord*>(slot.Get());
+  if (record)
+    return record;
+
+  for (record = g_reader_records.load(std::memory_order_acquire); record;
+       record = record->next) {
+    bool in_use = false;
+    if (!record->in_use.load(std::memory_order_relaxed) &&
+        record->in_use.compare_exchange_strong(in_use, true,
+                                               std::memory_order_acquire)) {
+      slot.Set(record);
+      return record;
+    }
+  }
+
+  record = new ReaderRecord;
+  ReaderRecord* head = g_reader_records.load(std::memory_order_relaxed);
+  do {
+    record->next = head;
+  } while (!g_reader_records.compare_exchange_weak(
+      head, record, std::memory_order_release, std::memory_order_relaxed));
+  slot.Set(record);
+  return record;
+}
+
+// Returns the earliest epoch at which a thread currently in a read scope
+// entered it.
+uint64_t GetOldestActiveEpoch() {
+  uint64_t oldest = std::numeric_limits<uint64_t>::max();
+  for (ReaderRecord* record = g_reader_records.load(std::memory_order_acquire);
+       record; record = record->next) {
+    const uint64_t epoch = record->epoch.load(std::memory_order_seq_cst);
+    if (epoch != 0)
+      oldest = std::min(oldest, epoch);
+  }
+  return oldest;
+}
+
+}  // namespace
+
+void RcuReadLock() {
+  ReaderRecord* record = GetReaderRecordForCurrentThread();
+  if (record->nesting++ == 0) {
+    record->epoch.store(g_epoch.load(std::memory_order_seq_cst),
+                        std::memory_order_seq_cst);
+  }
+}
+
+void RcuReadUnlock() {
+  ReaderRecord* record =
+      static_cast<ReaderRecord*>(GetReaderRecordSlot().Get());
+  DCHECK(record);
+  DCHECK_GT(record->nesting, 0);
+  if (--record->nesting == 0)
+    record->epoch.store(0, std::memory_order_release);
+}
+
+bool RcuIsInReadScope() {
+  ReaderRecord* record =
+      static_cast<ReaderRecord*>(GetReaderRecordSlot().Get());
+  return record && record->nesting > 0;
+}
+
+void RcuRetire(const void* ptr, void (*deleter)(const void*)) {
+  DCHECK(ptr);
+  RetiredList& retired_list = GetRetiredList();
+  {
+    AutoLock auto_lock(retired_list.lock);
+    retired_list.snapshots.push_back(
+        {ptr, deleter, g_epoch.fetch_add(1, std::memory_order_seq_cst)});
+    g_num_retired.store(retired_list.snapshots.size(),
+                        std::memory_order_relaxed);
+  }
+  RcuReclaimRetired();
+}
+
+void RcuReclaimRetired() {
+  if (g_num_retired.load(std::memory_order_relaxed) == 0)
+    return;
+
+  RetiredList& retired_list = GetRetiredList();
+  if (!retired_list.lock.Try())
+    return;
+
+  std::vector<RetiredSnapshot> reclaimable;
+  {
+    AutoLock auto_lock(retired_list.lock, AutoLock::AlreadyAcquired());
+    const uint64_t oldest_active_epoch = GetOldestActiveEpoch();
+    auto reclaimable_begin = std::stable_partition(
+        retired_list.snapshots.begin(), retired_list.snapshots.end(),
+        [oldest_active_epoch](const RetiredSnapshot& snapshot) {
+          return snapshot.epoch >= oldest_active_epoch;
+        });
+    reclaimable.assign(reclaimable_begin, retired_list.snapshots.end());
+    retired_list.snapshots.erase(reclaimable_begin,
+                                 retired_list.snapshots.end());
+    g_num_retired.store(retired_list.snapshots.size(),
+                        std::memory_order_relaxed);
+  }
+
+  // The deleters run without the lock, as they may retire snapshots too.
+  for (const RetiredSnapshot& snapshot : reclaimable)
+    snapshot.deleter(snapshot.ptr);
+}
+
+size_t RcuGetNumRetiredForTesting() {
+  return g_num_retired.load(std::memory_order_relaxed);
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,128 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// RcuPtr<T> publishes immutable snapshots of read-mostly data, in the style of
+// Linux's read-copy-update: readers access the current snapshot without taking
+// a lock or a reference, and a writer replaces it with a new one. The old
+// snapshot is deleted once no reader can still be using it.
+//
+// Readers must be inside an RcuReadScope, and must not use the snapshot, or
+// anything reached through it, after the scope ends:
+//
+//   base::RcuPtr<Registry> g_registry;
+//
+//   bool IsRegistered(const std::string& name) {
+//     base::RcuReadScope read_scope;
+//     return g_registry.Get()->Contains(name);
+//   }
+//
+//   void Register(const std::string& name) {
+//     base::AutoLock auto_lock(g_registry_write_lock);
+//     auto registry = std::make_unique<Registry>(*g_registry.GetForWriter());
+//     registry->Add(name);
+//     g_registry.Update(std::move(registry));
+//   }
+//
+// Entering and leaving an RcuReadScope never blocks, and only touches memory
+// belonging to the current thread, so readers don't contend with each other
+// or with writers. Writers pay instead: every Update() copies the data, and
+// the replaced snapshots stay alive until every read scope that was open when
+// it was replaced has closed. They are then deleted on whichever thread next
+// reclaims retired snapshots: one calling Update(), or a TaskScheduler worker
+// once it finishes a task.
+//
+// This is only a good trade for data which is read far more often than it
+// changes. Read scopes should be short, and must not wait for something which
+// may itself wait for reclamation.
+
+#ifndef BASE_SYNCHRONIZATION_RCU_PTR_H_
+#define BASE_SYNCHRONIZATION_RCU_PTR_H_
+
+#include <atomic>
+#include <memory>
+
+#include "base/base_export.h"
+#include "base/logging.h"
+#include "base/macros.h"
+
+namespace base {
+
+namespace internal {
+
+// Enter and leave a read scope on the current thread. Read scopes nest.
+BASE_EXPORT void RcuReadLock();
+BASE_EXPORT void RcuReadUnlock();
+BASE_EXPORT bool RcuIsInReadScope();
+
+// Arranges for |deleter| to be called on |ptr| once no read scope which is
+// open at the time of the call remains open.
+BASE_EXPORT void RcuRetire(const void* ptr, void (*deleter)(const void*));
+
+// Deletes the retired snapshots that no read scope can still be using. This is
+// cheap when there is nothing to reclaim, and doesn't wait if another thread
+// is already reclaiming.
+BASE_EXPORT void RcuReclaimRetired();
+
+// Returns how many retired snapshots are waiting to be deleted.
+BASE_EXPORT size_t RcuGetNumRetiredForTesting();
+
+}  // namespace internal
+
+// Makes RcuPtr::Get() usable on the current thread while in scope.
+class RcuReadScope {
+ public:
+  RcuReadScope() { internal::RcuReadLock(); }
+  ~RcuReadScope() { internal::RcuReadUnlock(); }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(RcuReadScope);
+};
+
+template <typename T>
+class RcuPtr {
+ public:
+  RcuPtr() = default;
+  explicit RcuPtr(std::unique_ptr<const T> value) : ptr_(value.release()) {}
+
+  // Retires the current snapshot, so that readers still using it are safe.
+  ~RcuPtr() { Retire(ptr_.load(std::memory_order_relaxed)); }
+
+  // Returns the current snapshot, which may be null. It remains valid until
+  // the current thread's outermost RcuReadScope ends.
+  const T* Get() const {
+    DCHECK(internal::RcuIsInReadScope());
+    return ptr_.load(std::memory_order_seq_cst);
+  }
+
+  // Returns the current snapshot, outside of a read scope. This is only safe
+  // when the caller guarantees that no other thread calls Update() until it's
+  // done with it, e.g. because updates are serialized by a lock it holds.
+  const T* GetForWriter() const {
+    return ptr_.load(std::memory_order_acquire);
+  }
+
+  // Publishes |value| as the new snapshot, and retires the previous one.
+  // Concurrent calls are safe, but a writer which derives the new snapshot
+  // from the current one must serialize with other writers itself, or risk
+  // losing their updates.
+  void Update(std::unique_ptr<const T> value) {
+    Retire(ptr_.exchange(value.release(), std::memory_order_seq_cst));
+  }
+
+ private:
+  static void Delete(const void* ptr) { delete static_cast<const T*>(ptr); }
+
+  static void Retire(const T* ptr) {
+    if (ptr)
+      internal::RcuRetire(ptr, &Delete);
+  }
+
+  std::atomic<const T*> ptr_{nullptr};
+
+  DISALLOW_COPY_AND_ASSIGN(RcuPtr);
+};
+
+}  // namespace base
+
+#endif  // BASE_SYNCHRONIZATION_RCU_PTR_H_
@@ -0,0 +1,199 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/rcu_ptr.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Counts live instances, and poisons itself when deleted so that readers of a
+// deleted snapshot see a mismatch.
+class Snapshot {
+ public:
+  explicit Snapshot(int value, std::atomic<int>* num_live = nullptr)
+      : value_(value), copy_(value), num_live_(num_live) {
+    if (num_live_)
+      num_live_->fetch_add(1);
+  }
+
+  ~Snapshot() {
+    value_ = -1;
+    copy_ = -2;
+    if (num_live_)
+      num_live_->fetch_sub(1);
+  }
+
+  int value() const { return value_; }
+  bool IsValid() const { return value_ == copy_; }
+
+ private:
+  volatile int value_;
+  volatile int copy_;
+  std::atomic<int>* const num_live_;
+
+  DISALLOW_COPY_AND_ASSIGN(Snapshot);
+};
+
+// Holds a read scope and the snapshot it read until |release| is signaled.
+class Reader : public SimpleThread {
+ public:
+  Reader(RcuPtr<Snapshot>* ptr, WaitableEvent* acquired, WaitableEvent* release)
+      : SimpleThread("Reader"),
+        ptr_(ptr),
+        acquired_(acquired),
+        release_(release) {}
+
+  void Run() override {
+    RcuReadScope read_scope;
+    const Snapshot* snapshot = ptr_->Get();
+    acquired_->Signal();
+    release_->Wait();
+    EXPECT_TRUE(snapshot->IsValid());
+    EXPECT_EQ(1, snapshot->value());
+  }
+
+ private:
+  RcuPtr<Snapshot>* const ptr_;
+  WaitableEvent* const acquired_;
+  WaitableEvent* const release_;
+
+  DISALLOW_COPY_AND_ASSIGN(Reader);
+};
+
+// Repeatedly reads the current snapshot until |done| is set, checking that it
+// hasn't been deleted and that its value never goes backwards.
+class ReaderLoop : public DelegateSimpleThread::Delegate {
+ public:
+  ReaderLoop(RcuPtr<Snapshot>* ptr, std::atomic<bool>* done)
+      : ptr_(ptr), done_(done) {}
+
+  void Run() override {
+    int last_value = 0;
+    while (!done_->load()) {
+      RcuReadScope read_scope;
+      const Snapshot* snapshot = ptr_->Get();
+      EXPECT_TRUE(snapshot->IsValid());
+      EXPECT_LE(last_value, snapshot->value());
+      last_value = snapshot->value();
+    }
+  }
+
+ private:
+  RcuPtr<Snapshot>* const ptr_;
+  std::atomic<bool>* const done_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReaderLoop);
+};
+
+}  // namespace
+
+TEST(RcuPtrTest, GetAndUpdate) {
+  RcuPtr<Snapshot> ptr;
+  {
+    RcuReadScope read_scope;
+    EXPECT_EQ(nullptr, ptr.Get());
+  }
+
+  ptr.Update(std::make_unique<Snapshot>(1));
+  RcuReadScope read_scope;
+  const Snapshot* first = ptr.Get();
+  ASSERT_TRUE(first);
+  EXPECT_EQ(1, first->value());
+
+  ptr.Update(std::make_unique<Snapshot>(2));
+  EXPECT_EQ(2, ptr.Get()->value());
+  EXPECT_EQ(2, ptr.GetForWriter()->value());
+
+  // The first snapshot was retired while this thread was reading it.
+  EXPECT_TRUE(first->IsValid());
+  EXPECT_EQ(1, first->value());
+}
+
+TEST(RcuPtrTest, NestedReadScopes) {
+  EXPECT_FALSE(internal::RcuIsInReadScope());
+  {
+    RcuReadScope outer_scope;
+    {
+      RcuReadScope inner_scope;
+      EXPECT_TRUE(internal::RcuIsInReadScope());
+    }
+    EXPECT_TRUE(internal::RcuIsInReadScope());
+  }
+  EXPECT_FALSE(internal::RcuIsInReadScope());
+}
+
+TEST(RcuPtrTest, UpdateWithoutReaders) {
+  std::atomic<int> num_live(0);
+  RcuPtr<Snapshot> ptr(std::make_unique<Snapshot>(1, &num_live));
+  ptr.Update(std::make_unique<Snapshot>(2, &num_live));
+  EXPECT_EQ(1, num_live.load());
+}
+
+TEST(RcuPtrTest, RetiredSnapshotOutlivesReadScope) {
+  std::atomic<int> num_live(0);
+  std::unique_ptr<RcuPtr<Snapshot>> ptr = std::make_unique<RcuPtr<Snapshot>>(
+      std::make_unique<Snapshot>(1, &num_live));
+
+  WaitableEvent acquired(WaitableEvent::ResetPolicy::MANUAL,
+                         WaitableEvent::InitialState::NOT_SIGNALED);
+  WaitableEvent release(WaitableEvent::ResetPolicy::MANUAL,
+                        WaitableEvent::InitialState::NOT_SIGNALED);
+  Reader reader(ptr.get(), &acquired, &release);
+  reader.Start();
+  acquired.Wait();
+
+  // The reader still uses the first snapshot, which can't be deleted by either
+  // Update() or the destruction of |ptr|.
+  ptr->Update(std::make_unique<Snapshot>(2, &num_live));
+  ptr.reset();
+  internal::RcuReclaimRetired();
+  EXPECT_EQ(2, num_live.load());
+  EXPECT_LE(2u, internal::RcuGetNumRetiredForTesting());
+
+  release.Signal();
+  reader.Join();
+  internal::RcuReclaimRetired();
+  EXPECT_EQ(0, num_live.load());
+}
+
+TEST(RcuPtrTest, ConcurrentReadersAndWriter) {
+  constexpr int kNumReaders = 4;
+  constexpr int kNumUpdates = 10000;
+
+  std::atomic<int> num_live(0);
+  std::atomic<bool> done(false);
+  {
+    RcuPtr<Snapshot> ptr(std::make_unique<Snapshot>(0, &num_live));
+    std::vector<std::unique_ptr<ReaderLoop>> readers;
+    std::vector<std::unique_ptr<DelegateSimpleThread>> threads;
+    for (int i = 0; i < kNumReaders; ++i) {
+      readers.push_back(std::make_unique<ReaderLoop>(&ptr, &done));
+      threads.push_back(std::make_unique<DelegateSimpleThread>(
+          readers.back().get(), "RcuPtrReader"));
+      threads.back()->Start();
+    }
+
+    for (int i = 1; i <= kNumUpdates; ++i)
+      ptr.Update(std::make_unique<Snapshot>(i, &num_live));
+
+    done.store(true);
+    for (const auto& thread : threads)
+      thread->Join();
+  }
+
+  internal::RcuReclaimRetired();
+  EXPECT_EQ(0, num_live.load());
+}
+
+}  // namespace base
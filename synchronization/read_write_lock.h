@@ -0,0 +1,124 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_SYNCHRONIZATION_READ_WRITE_LOCK_H_
+#define BASE_SYNCHRONIZATION_READ_WRITE_LOCK_H_
+
+#include "base/base_export.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/thread_annotations.h"
+#include "base/threading/platform_thread.h"
+#include "build/build_config.h"
+
+#if defined(OS_WIN)
+#include "base/win/windows_types.h"
+#elif defined(OS_POSIX)
+#include <pthread.h>
+#endif
+
+namespace base {
+
+// A reader-writer lock, for data which is read much more often than it is
+// written: any number of threads may hold it for reading at the same time, but
+// a thread holding it for writing excludes all others. It is not recursive,
+// and a thread holding it for reading must not try to upgrade to writing.
+//
+// Taking a ReadWriteLock costs more than taking a Lock, even for reading, so
+// only use one when readers actually contend, and hold it for long enough
+// that running them concurrently matters.
+//
+// Prefer the scoped AutoReadLock and AutoWriteLock below to calling the
+// Acquire and Release methods directly.
+class LOCKABLE BASE_EXPORT ReadWriteLock {
+ public:
+  enum class Preference {
+    // Lets new readers in while a writer waits, as long as there are other
+    // readers. This maximizes read throughput, but a steady stream of readers
+    // can starve writers.
+    kReaders,
+    // Makes new readers wait behind a waiting writer, so that writers can't
+    // be starved. This is the default.
+    kWriters,
+  };
+
+  explicit ReadWriteLock(Preference preference = Preference::kWriters);
+  ~ReadWriteLock();
+
+  void ReadAcquire() SHARED_LOCK_FUNCTION();
+  void ReadRelease() UNLOCK_FUNCTION();
+  // Takes the lock for reading if that doesn't require waiting, and returns
+  // whether it did.
+  bool TryReadAcquire() SHARED_TRYLOCK_FUNCTION(true);
+
+  void WriteAcquire() EXCLUSIVE_LOCK_FUNCTION();
+  void WriteRelease() UNLOCK_FUNCTION();
+  // Takes the lock for writing if that doesn't require waiting, and returns
+  // whether it did.
+  bool TryWriteAcquire() EXCLUSIVE_TRYLOCK_FUNCTION(true);
+
+  // DCHECKs that the current thread holds the lock for writing. Readers aren't
+  // tracked.
+#if DCHECK_IS_ON()
+  void AssertWriteAcquired() const ASSERT_EXCLUSIVE_LOCK();
+#else
+  void AssertWriteAcquired() const ASSERT_EXCLUSIVE_LOCK() {}
+#endif
+
+ private:
+#if defined(OS_WIN)
+  using NativeHandle = CHROME_SRWLOCK;
+#elif defined(OS_POSIX)
+  using NativeHandle = pthread_rwlock_t;
+#endif
+
+#if DCHECK_IS_ON()
+  // The thread holding the lock for writing, if any. Only accessed by that
+  // thread, or with the lock held for writing.
+  PlatformThreadRef writer_thread_ref_;
+#endif
+
+  NativeHandle native_handle_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadWriteLock);
+};
+
+// Holds a ReadWriteLock for reading while in scope.
+class SCOPED_LOCKABLE AutoReadLock {
+ public:
+  explicit AutoReadLock(ReadWriteLock& lock) SHARED_LOCK_FUNCTION(lock)
+      : lock_(lock) {
+    lock_.ReadAcquire();
+  }
+
+  ~AutoReadLock() UNLOCK_FUNCTION() { lock_.ReadRelease(); }
+
+ private:
+  ReadWriteLock& lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(AutoReadLock);
+};
+
+// Holds a ReadWriteLock for writing while in scope.
+class SCOPED_LOCKABLE AutoWriteLock {
+ public:
+  explicit AutoWriteLock(ReadWriteLock& lock) EXCLUSIVE_LOCK_FUNCTION(lock)
+      : lock_(lock) {
+    lock_.WriteAcquire();
+  }
+
+  ~AutoWriteLock() UNLOCK_FUNCTION() {
+    lock_.AssertWriteAcquired();
+    lock_.WriteRelease();
+  }
+
+ private:
+  ReadWriteLock& lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(AutoWriteLock);
+};
+
+}  // namespace base
+
+#endif  // BASE_SYNCHRONIZATION_READ_WRITE_LOCK_H_
@@ -0,0 +1,100 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/read_write_lock.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include "base/debug/activity_tracker.h"
+#include "build/build_config.h"
+
+namespace base {
+
+ReadWriteLock::ReadWriteLock(Preference preference) {
+  pthread_rwlockattr_t attributes;
+  int rv = pthread_rwlockattr_init(&attributes);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+#if defined(__GLIBC__) || (defined(OS_ANDROID) && __ANDROID_API__ >= 23)
+  // glibc and Bionic prefer readers by default. The other implementations,
+  // e.g. on Mac, already prefer writers, and don't support asking for readers.
+  if (preference == Preference::kWriters) {
+    rv = pthread_rwlockattr_setkind_np(
+        &attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+  }
+#endif
+  rv = pthread_rwlock_init(&native_handle_, &attributes);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+  rv = pthread_rwlockattr_destroy(&attributes);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+}
+
+ReadWriteLock::~ReadWriteLock() {
+#if DCHECK_IS_ON()
+  DCHECK(writer_thread_ref_.is_null());
+#endif
+  int rv = pthread_rwlock_destroy(&native_handle_);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+}
+
+void ReadWriteLock::ReadAcquire() {
+  // As in LockImpl::Lock(), only pay for the tracked blocking call if a try
+  // fails while the tracker is enabled.
+  if (debug::GlobalActivityTracker::IsEnabled() && TryReadAcquire())
+    return;
+
+  debug::ScopedLockAcquireActivity lock_activity(this);
+  int rv = pthread_rwlock_rdlock(&native_handle_);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+}
+
+void ReadWriteLock::ReadRelease() {
+  int rv = pthread_rwlock_unlock(&native_handle_);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+}
+
+bool ReadWriteLock::TryReadAcquire() {
+  int rv = pthread_rwlock_tryrdlock(&native_handle_);
+  DCHECK(rv == 0 || rv == EBUSY) << ". " << strerror(rv);
+  return rv == 0;
+}
+
+void ReadWriteLock::WriteAcquire() {
+  if (!debug::GlobalActivityTracker::IsEnabled() || !TryWriteAcquire()) {
+    debug::ScopedLockAcquireActivity lock_activity(this);
+    int rv = pthread_rwlock_wrlock(&native_handle_);
+    DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+#if DCHECK_IS_ON()
+    writer_thread_ref_ = PlatformThread::CurrentRef();
+#endif
+  }
+}
+
+void ReadWriteLock::WriteRelease() {
+#if DCHECK_IS_ON()
+  AssertWriteAcquired();
+  writer_thread_ref_ = PlatformThreadRef();
+#endif
+  int rv = pthread_rwlock_unlock(&native_handle_);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+}
+
+bool ReadWriteLock::TryWriteAcquire() {
+  int rv = pthread_rwlock_trywrlock(&native_handle_);
+  DCHECK(rv == 0 || rv == EBUSY) << ". " << strerror(rv);
+#if DCHECK_IS_ON()
+  if (rv == 0)
+    writer_thread_ref_ = PlatformThread::CurrentRef();
+#endif
+  return rv == 0;
+}
+
+#if DCHECK_IS_ON()
+void ReadWriteLock::AssertWriteAcquired() const {
+  DCHECK(writer_thread_ref_ == PlatformThread::CurrentRef());
+}
+#endif
+
+}  // namespace base
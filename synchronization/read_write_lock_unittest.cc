@@ -0,0 +1,142 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/read_write_lock.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/test/gtest_util.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Increments a counter |kIterations| times with the lock held for writing, and
+// checks that it doesn't change while held for reading.
+class ReadWriteLockUser : public DelegateSimpleThread::Delegate {
+ public:
+  static constexpr int kIterations = 1000;
+
+  ReadWriteLockUser(ReadWriteLock* lock, int* counter)
+      : lock_(lock), counter_(counter) {}
+
+  void Run() override {
+    for (int i = 0; i < kIterations; ++i) {
+      {
+        AutoWriteLock auto_lock(*lock_);
+        ++*counter_;
+      }
+      {
+        AutoReadLock auto_lock(*lock_);
+        const int value = *counter_;
+        PlatformThread::YieldCurrentThread();
+        EXPECT_EQ(value, *counter_);
+      }
+    }
+  }
+
+ private:
+  ReadWriteLock* const lock_;
+  int* const counter_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadWriteLockUser);
+};
+
+// Holds |lock| for reading until |release| is signaled.
+class Reader : public SimpleThread {
+ public:
+  Reader(ReadWriteLock* lock, WaitableEvent* acquired, WaitableEvent* release)
+      : SimpleThread("Reader"),
+        lock_(lock),
+        acquired_(acquired),
+        release_(release) {}
+
+  void Run() override {
+    AutoReadLock auto_lock(*lock_);
+    acquired_->Signal();
+    release_->Wait();
+  }
+
+ private:
+  ReadWriteLock* const lock_;
+  WaitableEvent* const acquired_;
+  WaitableEvent* const release_;
+
+  DISALLOW_COPY_AND_ASSIGN(Reader);
+};
+
+}  // namespace
+
+TEST(ReadWriteLockTest, Try) {
+  ReadWriteLock lock;
+  ASSERT_TRUE(lock.TryReadAcquire());
+  ASSERT_TRUE(lock.TryReadAcquire());
+  EXPECT_FALSE(lock.TryWriteAcquire());
+  lock.ReadRelease();
+  lock.ReadRelease();
+
+  ASSERT_TRUE(lock.TryWriteAcquire());
+  lock.AssertWriteAcquired();
+  EXPECT_FALSE(lock.TryReadAcquire());
+  EXPECT_FALSE(lock.TryWriteAcquire());
+  lock.WriteRelease();
+}
+
+TEST(ReadWriteLockTest, ConcurrentReaders) {
+  // A reader on another thread doesn't keep this thread from reading.
+  ReadWriteLock lock;
+  WaitableEvent acquired(WaitableEvent::ResetPolicy::MANUAL,
+                         WaitableEvent::InitialState::NOT_SIGNALED);
+  WaitableEvent release(WaitableEvent::ResetPolicy::MANUAL,
+                        WaitableEvent::InitialState::NOT_SIGNALED);
+  Reader reader(&lock, &acquired, &release);
+  reader.Start();
+  acquired.Wait();
+  {
+    AutoReadLock auto_lock(lock);
+    EXPECT_FALSE(lock.TryWriteAcquire());
+  }
+  release.Signal();
+  reader.Join();
+  EXPECT_TRUE(lock.TryWriteAcquire());
+  lock.WriteRelease();
+}
+
+TEST(ReadWriteLockTest, MutualExclusion) {
+  for (ReadWriteLock::Preference preference :
+       {ReadWriteLock::Preference::kReaders,
+        ReadWriteLock::Preference::kWriters}) {
+    constexpr int kThreads = 4;
+    ReadWriteLock lock(preference);
+    int counter = 0;
+    std::vector<std::unique_ptr<ReadWriteLockUser>> users;
+    std::vector<std::unique_ptr<DelegateSimpleThread>> threads;
+    for (int i = 0; i < kThreads; ++i) {
+      users.push_back(std::make_unique<ReadWriteLockUser>(&lock, &counter));
+      threads.push_back(std::make_unique<DelegateSimpleThread>(
+          users.back().get(), "ReadWriteLockUser"));
+    }
+    for (const auto& thread : threads)
+      thread->Start();
+    for (const auto& thread : threads)
+      thread->Join();
+
+    AutoReadLock auto_lock(lock);
+    EXPECT_EQ(kThreads * ReadWriteLockUser::kIterations, counter);
+  }
+}
+
+TEST(ReadWriteLockTest, AssertWriteAcquired) {
+  ReadWriteLock lock;
+  EXPECT_DCHECK_DEATH(lock.AssertWriteAcquired());
+  AutoReadLock auto_lock(lock);
+  EXPECT_DCHECK_DEATH(lock.AssertWriteAcquired());
+}
+
+}  // namespace base
@@ -0,0 +1,83 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/read_write_lock.h"
+
+#include <windows.h>
+
+#include "base/debug/activity_tracker.h"
+
+namespace base {
+
+namespace {
+
+PSRWLOCK AsSRWLock(CHROME_SRWLOCK* lock) {
+  return reinterpret_cast<PSRWLOCK>(lock);
+}
+
+}  // namespace
+
+// SRW locks have no preference to set: they wake waiters in a roughly FIFO
+// order, so neither readers nor writers are starved.
+ReadWriteLock::ReadWriteLock(Preference preference)
+    : native_handle_(SRWLOCK_INIT) {}
+
+ReadWriteLock::~ReadWriteLock() {
+#if DCHECK_IS_ON()
+  DCHECK(writer_thread_ref_.is_null());
+#endif
+}
+
+void ReadWriteLock::ReadAcquire() {
+  // As in LockImpl::Lock(), only pay for the tracked blocking call if a try
+  // fails while the tracker is enabled.
+  if (debug::GlobalActivityTracker::IsEnabled() && TryReadAcquire())
+    return;
+
+  debug::ScopedLockAcquireActivity lock_activity(this);
+  ::AcquireSRWLockShared(AsSRWLock(&native_handle_));
+}
+
+void ReadWriteLock::ReadRelease() {
+  ::ReleaseSRWLockShared(AsSRWLock(&native_handle_));
+}
+
+bool ReadWriteLock::TryReadAcquire() {
+  return !!::TryAcquireSRWLockShared(AsSRWLock(&native_handle_));
+}
+
+void ReadWriteLock::WriteAcquire() {
+  if (!debug::GlobalActivityTracker::IsEnabled() || !TryWriteAcquire()) {
+    debug::ScopedLockAcquireActivity lock_activity(this);
+    ::AcquireSRWLockExclusive(AsSRWLock(&native_handle_));
+#if DCHECK_IS_ON()
+    writer_thread_ref_ = PlatformThread::CurrentRef();
+#endif
+  }
+}
+
+void ReadWriteLock::WriteRelease() {
+#if DCHECK_IS_ON()
+  AssertWriteAcquired();
+  writer_thread_ref_ = PlatformThreadRef();
+#endif
+  ::ReleaseSRWLockExclusive(AsSRWLock(&native_handle_));
+}
+
+bool ReadWriteLock::TryWriteAcquire() {
+  if (!::TryAcquireSRWLockExclusive(AsSRWLock(&native_handle_)))
+    return false;
+#if DCHECK_IS_ON()
+  writer_thread_ref_ = PlatformThread::CurrentRef();
+#endif
+  return true;
+}
+
+#if DCHECK_IS_ON()
+void ReadWriteLock::AssertWriteAcquired() const {
+  DCHECK(writer_thread_ref_ == PlatformThread::CurrentRef());
+}
+#endif
+
+}  // namespace base
@@ -24,8 +24,10 @@
 #include "base/memory/ref_counted.h"
 #include "base/synchronization/lock.h"
 #elif defined(OS_POSIX)
+#include <stdint.h>
+
+#include <atomic>
 #include <list>
-#include <utility>
 
 #include "base/memory/ref_counted.h"
 #include "base/synchronization/lock.h"
@@ -244,13 +246,33 @@ class BASE_EXPORT WaitableEvent {
   struct WaitableEventKernel :
       public RefCountedThreadSafe<WaitableEventKernel> {
    public:
+    // Bits of |state_|.
+    enum : int32_t {
+      kSignaled = 1 << 0,
+      // Set while |waiters_| may be non-empty. It is only set and cleared with
+      // |lock_| held, so that Signal() can skip |lock_| while it's clear.
+      kHasWaiters = 1 << 1,
+    };
+
     WaitableEventKernel(ResetPolicy reset_policy, InitialState initial_state);
 
+    // If the event is signaled, resets it if it's auto-reset and returns
+    // true. Doesn't need |lock_|.
+    bool TryConsumeSignal();
+
+    // Like TryConsumeSignal(), but if the event isn't signaled, sets
+    // kHasWaiters so that it can't be signaled without |lock_| until a waiter
+    // is enqueued. Called with |lock_| held.
+    bool TryConsumeSignalOrPrepareToEnqueue();
+
     bool Dequeue(Waiter* waiter, void* tag);
 
+    // Clears kHasWaiters if |waiters_| is empty. Called with |lock_| held.
+    void UpdateHasWaiters();
+
     base::Lock lock_;
     const bool manual_reset_;
-    bool signaled_;
+    std::atomic<int32_t> state_;
     std::list<Waiter*> waiters_;
 
    private:
@@ -258,16 +280,9 @@ class BASE_EXPORT WaitableEvent {
     ~WaitableEventKernel();
   };
 
-  typedef std::pair<WaitableEvent*, size_t> WaiterAndIndex;
-
-  // When dealing with arrays of WaitableEvent*, we want to sort by the address
-  // of the WaitableEvent in order to have a globally consistent locking order.
-  // In that case we keep them, in sorted order, in an array of pairs where the
-  // second element is the index of the WaitableEvent in the original,
-  // unsorted, array.
-  static size_t EnqueueMany(WaiterAndIndex* waitables,
-                            size_t count, Waiter* waiter);
-
+  // Signal() once it has taken |kernel_->lock_|. Doesn't touch the
+  // WaitableEvent after signaling it, as a woken thread may delete it.
+  void SignalLocked();
   bool SignalAll();
   bool SignalOne();
   void Enqueue(Waiter* waiter);
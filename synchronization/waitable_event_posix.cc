@@ -5,16 +5,21 @@
 #include <stddef.h>
 
 #include <algorithm>
-#include <limits>
 #include <vector>
 
 #include "base/debug/activity_tracker.h"
 #include "base/logging.h"
 #include "base/synchronization/condition_variable.h"
 #include "base/synchronization/lock.h"
+#include "base/synchronization/synchronization_buildflags.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/threading/scoped_blocking_call.h"
 #include "base/threading/thread_restrictions.h"
+#include "base/time/time.h"
+
+#if BUILDFLAG(USE_FUTEX_LOCK)
+#include "base/synchronization/futex_linux.h"
+#endif
 
 // -----------------------------------------------------------------------------
 // A WaitableEvent on POSIX is implemented as a wait-list. Currently we don't
@@ -35,6 +40,11 @@
 // the wait-list of many events. An event passes a pointer to itself when
 // firing a waiter and so we can store that pointer to find out which event
 // triggered.
+//
+// The signaled state lives in an atomic word next to a bit saying whether the
+// wait-list may be non-empty, and that bit only changes with the lock held. So
+// signaling an event nobody waits on, and waiting on an event which is already
+// signaled, don't need the lock.
 // -----------------------------------------------------------------------------
 
 namespace base {
@@ -49,68 +59,92 @@ WaitableEvent::WaitableEvent(ResetPolicy reset_policy,
 WaitableEvent::~WaitableEvent() = default;
 
 void WaitableEvent::Reset() {
-  base::AutoLock locked(kernel_->lock_);
-  kernel_->signaled_ = false;
+  kernel_->state_.fetch_and(~WaitableEventKernel::kSignaled,
+                            std::memory_order_relaxed);
 }
 
 void WaitableEvent::Signal() {
-  base::AutoLock locked(kernel_->lock_);
+  // Without waiters, signaling is just setting the bit.
+  int32_t state = kernel_->state_.load(std::memory_order_relaxed);
+  while (!(state & WaitableEventKernel::kHasWaiters)) {
+    if (state & WaitableEventKernel::kSignaled)
+      return;
+    if (kernel_->state_.compare_exchange_weak(
+            state, state | WaitableEventKernel::kSignaled,
+            std::memory_order_release, std::memory_order_relaxed)) {
+      return;
+    }
+  }
 
-  if (kernel_->signaled_)
+  // Once the event is signaled, a thread waiting for it may delete it, so keep
+  // the kernel alive until its lock has been released.
+  scoped_refptr<WaitableEventKernel> kernel(kernel_);
+  base::AutoLock locked(kernel->lock_);
+  SignalLocked();
+}
+
+void WaitableEvent::SignalLocked() {
+  if (kernel_->state_.load(std::memory_order_relaxed) &
+      WaitableEventKernel::kSignaled) {
     return;
+  }
 
   if (kernel_->manual_reset_) {
     SignalAll();
-    kernel_->signaled_ = true;
-  } else {
+  } else if (SignalOne()) {
     // In the case of auto reset, if no waiters were woken, we remain
     // signaled.
-    if (!SignalOne())
-      kernel_->signaled_ = true;
+    return;
   }
+  kernel_->state_.fetch_or(WaitableEventKernel::kSignaled,
+                           std::memory_order_release);
 }
 
 bool WaitableEvent::IsSignaled() {
-  base::AutoLock locked(kernel_->lock_);
-
-  const bool result = kernel_->signaled_;
-  if (result && !kernel_->manual_reset_)
-    kernel_->signaled_ = false;
-  return result;
+  return kernel_->TryConsumeSignal();
 }
 
 // -----------------------------------------------------------------------------
 // Synchronous waits
 
 // -----------------------------------------------------------------------------
-// This is a synchronous waiter. The thread is waiting on the given condition
-// variable and the fired flag in this object.
+// This is a synchronous waiter. The thread sleeps until it is fired, either on
+// a futex or, without the use_futex_lock GN arg, on a condition variable.
 // -----------------------------------------------------------------------------
 class SyncWaiter : public WaitableEvent::Waiter {
  public:
-  SyncWaiter()
-      : fired_(false), signaling_event_(nullptr), lock_(), cv_(&lock_) {}
+  SyncWaiter() = default;
 
   bool Fire(WaitableEvent* signaling_event) override {
-    base::AutoLock locked(lock_);
-
-    if (fired_)
+    WaitableEvent* expected = nullptr;
+    if (!signaling_event_.compare_exchange_strong(expected, signaling_event,
+                                                  std::memory_order_acq_rel)) {
       return false;
+    }
 
-    fired_ = true;
-    signaling_event_ = signaling_event;
-
-    cv_.Broadcast();
+#if BUILDFLAG(USE_FUTEX_LOCK)
+    woken_.store(1, std::memory_order_release);
+    internal::FutexWake(&woken_, 1);
+#else
+    base::AutoLock locked(lock_);
+    woken_ = true;
+    cv_.Signal();
+#endif
 
     // Unlike AsyncWaiter objects, SyncWaiter objects are stack-allocated on
     // the blocking thread's stack.  There is no |delete this;| in Fire.  The
-    // SyncWaiter object is destroyed when it goes out of scope.
+    // SyncWaiter object is destroyed when it goes out of scope. That can't
+    // happen before Fire() returns, as the waiting thread takes the lock of
+    // the signaling event, which is held here, before returning.
 
     return true;
   }
 
+  // The WaitableEvent which fired this waiter, or null.
   WaitableEvent* signaling_event() const {
-    return signaling_event_;
+    WaitableEvent* signaling_event =
+        signaling_event_.load(std::memory_order_acquire);
+    return signaling_event == disabled() ? nullptr : signaling_event;
   }
 
   // ---------------------------------------------------------------------------
@@ -119,35 +153,66 @@ class SyncWaiter : public WaitableEvent::Waiter {
   // ---------------------------------------------------------------------------
   bool Compare(void* tag) override { return this == tag; }
 
-  // ---------------------------------------------------------------------------
-  // Called with lock held.
-  // ---------------------------------------------------------------------------
-  bool fired() const {
-    return fired_;
-  }
-
   // ---------------------------------------------------------------------------
   // During a TimedWait, we need a way to make sure that an auto-reset
   // WaitableEvent doesn't think that this event has been signaled between
-  // unlocking it and removing it from the wait-list. Called with lock held.
+  // the timeout and removing it from the wait-list. Returns whether it was
+  // fired before being disabled.
   // ---------------------------------------------------------------------------
-  void Disable() {
-    fired_ = true;
+  bool Disable() {
+    WaitableEvent* expected = nullptr;
+    return !signaling_event_.compare_exchange_strong(
+        expected, disabled(), std::memory_order_acq_rel);
   }
 
-  base::Lock* lock() {
-    return &lock_;
+  // Sleeps until fired or |end_time|. Returns whether it was fired.
+  bool WaitUntil(const TimeTicks& end_time) {
+    const bool finite_time = !end_time.is_max();
+#if BUILDFLAG(USE_FUTEX_LOCK)
+    while (!woken_.load(std::memory_order_acquire)) {
+      if (!finite_time) {
+        internal::FutexWait(&woken_, 0, nullptr);
+        continue;
+      }
+      const TimeDelta max_wait = end_time - TimeTicks::Now();
+      if (max_wait <= TimeDelta())
+        break;
+      const struct timespec relative_time = max_wait.ToTimeSpec();
+      internal::FutexWait(&woken_, 0, &relative_time);
+    }
+#else
+    base::AutoLock locked(lock_);
+    while (!woken_) {
+      if (!finite_time) {
+        cv_.Wait();
+        continue;
+      }
+      const TimeDelta max_wait = end_time - TimeTicks::Now();
+      if (max_wait <= TimeDelta())
+        break;
+      cv_.TimedWait(max_wait);
+    }
+#endif
+    return signaling_event() != nullptr;
   }
 
-  base::ConditionVariable* cv() {
-    return &cv_;
+ private:
+  // A value of |signaling_event_| which is never a WaitableEvent, meaning that
+  // this waiter won't accept being fired anymore.
+  WaitableEvent* disabled() const {
+    return reinterpret_cast<WaitableEvent*>(const_cast<SyncWaiter*>(this));
   }
 
- private:
-  bool fired_;
-  WaitableEvent* signaling_event_;  // The WaitableEvent which woke us
+  // Set once, by whichever of Fire() and Disable() comes first.
+  std::atomic<WaitableEvent*> signaling_event_{nullptr};
+
+#if BUILDFLAG(USE_FUTEX_LOCK)
+  std::atomic<int32_t> woken_{0};
+#else
+  bool woken_ = false;
   base::Lock lock_;
-  base::ConditionVariable cv_;
+  base::ConditionVariable cv_{&lock_};
+#endif
 };
 
 void WaitableEvent::Wait() {
@@ -163,208 +228,117 @@ bool WaitableEvent::TimedWait(const TimeDelta& wait_delta) {
 
 bool WaitableEvent::TimedWaitUntil(const TimeTicks& end_time) {
   internal::AssertBaseSyncPrimitivesAllowed();
+
+  // An event which is already signaled doesn't block.
+  if (kernel_->TryConsumeSignal())
+    return true;
+
   ScopedBlockingCall scoped_blocking_call(BlockingType::MAY_BLOCK);
   // Record the event that this thread is blocking upon (for hang diagnosis).
   base::debug::ScopedEventWaitActivity event_activity(this);
 
-  const bool finite_time = !end_time.is_max();
-
-  kernel_->lock_.Acquire();
-  if (kernel_->signaled_) {
-    if (!kernel_->manual_reset_) {
-      // In this case we were signaled when we had no waiters. Now that
-      // someone has waited upon us, we can automatically reset.
-      kernel_->signaled_ = false;
-    }
-
-    kernel_->lock_.Release();
-    return true;
-  }
-
   SyncWaiter sw;
-  sw.lock()->Acquire();
-
-  Enqueue(&sw);
-  kernel_->lock_.Release();
-  // We are violating locking order here by holding the SyncWaiter lock but not
-  // the WaitableEvent lock. However, this is safe because we don't lock @lock_
-  // again before unlocking it.
+  {
+    base::AutoLock locked(kernel_->lock_);
+    if (kernel_->TryConsumeSignalOrPrepareToEnqueue())
+      return true;
+    Enqueue(&sw);
+  }
 
-  for (;;) {
-    const TimeTicks current_time(TimeTicks::Now());
-
-    if (sw.fired() || (finite_time && current_time >= end_time)) {
-      const bool return_value = sw.fired();
-
-      // We can't acquire @lock_ before releasing the SyncWaiter lock (because
-      // of locking order), however, in between the two a signal could be fired
-      // and @sw would accept it, however we will still return false, so the
-      // signal would be lost on an auto-reset WaitableEvent. Thus we call
-      // Disable which makes sw::Fire return false.
-      sw.Disable();
-      sw.lock()->Release();
-
-      // This is a bug that has been enshrined in the interface of
-      // WaitableEvent now: |Dequeue| is called even when |sw.fired()| is true,
-      // even though it'll always return false in that case. However, taking
-      // the lock ensures that |Signal| has completed before we return and
-      // means that a WaitableEvent can synchronise its own destruction.
-      kernel_->lock_.Acquire();
-      kernel_->Dequeue(&sw, &sw);
-      kernel_->lock_.Release();
-
-      return return_value;
-    }
+  // We can't take the lock before disabling the SyncWaiter, as Fire() is
+  // called with it held. However, in between the two a signal could be fired
+  // and @sw would accept it, however we would still return false, so the
+  // signal would be lost on an auto-reset WaitableEvent. Thus we call Disable
+  // which makes sw::Fire return false.
+  const bool return_value = sw.WaitUntil(end_time) || sw.Disable();
+
+  // This is a bug that has been enshrined in the interface of WaitableEvent
+  // now: |Dequeue| is called even when |sw| was fired, even though it'll
+  // always return false in that case. However, taking the lock ensures that
+  // |Signal| has completed before we return and means that a WaitableEvent can
+  // synchronise its own destruction.
+  base::AutoLock locked(kernel_->lock_);
+  kernel_->Dequeue(&sw, &sw);
 
-    if (finite_time) {
-      const TimeDelta max_wait(end_time - current_time);
-      sw.cv()->TimedWait(max_wait);
-    } else {
-      sw.cv()->Wait();
-    }
-  }
+  return return_value;
 }
 
 // -----------------------------------------------------------------------------
 // Synchronous waiting on multiple objects.
 
-static bool  // StrictWeakOrdering
-cmp_fst_addr(const std::pair<WaitableEvent*, unsigned> &a,
-             const std::pair<WaitableEvent*, unsigned> &b) {
-  return a.first < b.first;
-}
-
 // static
 size_t WaitableEvent::WaitMany(WaitableEvent** raw_waitables,
                                size_t count) {
   internal::AssertBaseSyncPrimitivesAllowed();
   DCHECK(count) << "Cannot wait on no events";
-  ScopedBlockingCall scoped_blocking_call(BlockingType::MAY_BLOCK);
-  // Record an event (the first) that this thread is blocking upon.
-  base::debug::ScopedEventWaitActivity event_activity(raw_waitables[0]);
-
-  // We need to acquire the locks in a globally consistent order. Thus we sort
-  // the array of waitables by address. We actually sort a pairs so that we can
-  // map back to the original index values later.
-  std::vector<std::pair<WaitableEvent*, size_t> > waitables;
-  waitables.reserve(count);
-  for (size_t i = 0; i < count; ++i)
-    waitables.push_back(std::make_pair(raw_waitables[i], i));
 
-  DCHECK_EQ(count, waitables.size());
+#if DCHECK_IS_ON()
+  // The set of waitables must be distinct.
+  std::vector<WaitableEvent*> sorted_waitables(raw_waitables,
+                                               raw_waitables + count);
+  std::sort(sorted_waitables.begin(), sorted_waitables.end());
+  DCHECK(std::adjacent_find(sorted_waitables.begin(),
+                            sorted_waitables.end()) == sorted_waitables.end());
+#endif
 
-  sort(waitables.begin(), waitables.end(), cmp_fst_addr);
-
-  // The set of waitables must be distinct. Since we have just sorted by
-  // address, we can check this cheaply by comparing pairs of consecutive
-  // elements.
-  for (size_t i = 0; i < waitables.size() - 1; ++i) {
-    DCHECK(waitables[i].first != waitables[i+1].first);
+  // If events are already signaled, return the one with the lowest index.
+  for (size_t i = 0; i < count; ++i) {
+    if (raw_waitables[i]->kernel_->TryConsumeSignal())
+      return i;
   }
 
+  ScopedBlockingCall scoped_blocking_call(BlockingType::MAY_BLOCK);
+  // Record an event (the first) that this thread is blocking upon.
+  base::debug::ScopedEventWaitActivity event_activity(raw_waitables[0]);
+
+  // Enqueue a single SyncWaiter on the events one at a time, so that only one
+  // of their locks is ever held: there is no need for a global locking order.
+  // As soon as one of the events fires it, it needn't be enqueued on more.
   SyncWaiter sw;
+  size_t num_enqueued = 0;
+  for (; num_enqueued < count && !sw.signaling_event(); ++num_enqueued) {
+    WaitableEvent* const event = raw_waitables[num_enqueued];
+    base::AutoLock locked(event->kernel_->lock_);
+    if (!event->kernel_->TryConsumeSignalOrPrepareToEnqueue()) {
+      event->Enqueue(&sw);
+      continue;
+    }
 
-  const size_t r = EnqueueMany(&waitables[0], count, &sw);
-  if (r < count) {
-    // One of the events is already signaled. The SyncWaiter has not been
-    // enqueued anywhere.
-    return waitables[r].second;
+    // |event| was signaled since it was checked above, and its signal is now
+    // consumed. But if an event enqueued on earlier fired |sw| in the
+    // meantime, that one wins and |event| must be signaled again.
+    if (!sw.Fire(event))
+      event->SignalLocked();
+    break;
   }
 
-  // At this point, we hold the locks on all the WaitableEvents and we have
-  // enqueued our waiter in them all.
-  sw.lock()->Acquire();
-    // Release the WaitableEvent locks in the reverse order
-    for (size_t i = 0; i < count; ++i) {
-      waitables[count - (1 + i)].first->kernel_->lock_.Release();
-    }
-
-    for (;;) {
-      if (sw.fired())
-        break;
-
-      sw.cv()->Wait();
-    }
-  sw.lock()->Release();
+  sw.WaitUntil(TimeTicks::Max());
 
   // The address of the WaitableEvent which fired is stored in the SyncWaiter.
-  WaitableEvent *const signaled_event = sw.signaling_event();
-  // This will store the index of the raw_waitables which fired.
-  size_t signaled_index = 0;
-
-  // Take the locks of each WaitableEvent in turn (except the signaled one) and
-  // remove our SyncWaiter from the wait-list
+  WaitableEvent* const signaled_event = sw.signaling_event();
+  DCHECK(signaled_event);
+
+  // Take the locks of each WaitableEvent in turn and remove our SyncWaiter from
+  // the wait-list. For the signaled event, this ensures that |Signal| has
+  // completed by the time we return, because |Signal| holds this lock. This
+  // matches the behaviour of |Wait| and |TimedWait|.
+  size_t signaled_index = count;
   for (size_t i = 0; i < count; ++i) {
-    if (raw_waitables[i] != signaled_event) {
-      raw_waitables[i]->kernel_->lock_.Acquire();
-        // There's no possible ABA issue with the address of the SyncWaiter here
-        // because it lives on the stack. Thus the tag value is just the pointer
-        // value again.
-        raw_waitables[i]->kernel_->Dequeue(&sw, &sw);
-      raw_waitables[i]->kernel_->lock_.Release();
-    } else {
-      // By taking this lock here we ensure that |Signal| has completed by the
-      // time we return, because |Signal| holds this lock. This matches the
-      // behaviour of |Wait| and |TimedWait|.
-      raw_waitables[i]->kernel_->lock_.Acquire();
-      raw_waitables[i]->kernel_->lock_.Release();
+    if (raw_waitables[i] == signaled_event)
       signaled_index = i;
+    if (i < num_enqueued) {
+      base::AutoLock locked(raw_waitables[i]->kernel_->lock_);
+      // There's no possible ABA issue with the address of the SyncWaiter here
+      // because it lives on the stack. Thus the tag value is just the pointer
+      // value again.
+      raw_waitables[i]->kernel_->Dequeue(&sw, &sw);
     }
   }
+  DCHECK_LT(signaled_index, count);
 
   return signaled_index;
 }
 
-// -----------------------------------------------------------------------------
-// If return value == count:
-//   The locks of the WaitableEvents have been taken in order and the Waiter has
-//   been enqueued in the wait-list of each. None of the WaitableEvents are
-//   currently signaled
-// else:
-//   None of the WaitableEvent locks are held. The Waiter has not been enqueued
-//   in any of them and the return value is the index of the WaitableEvent which
-//   was signaled with the lowest input index from the original WaitMany call.
-// -----------------------------------------------------------------------------
-// static
-size_t WaitableEvent::EnqueueMany(std::pair<WaitableEvent*, size_t>* waitables,
-                                  size_t count,
-                                  Waiter* waiter) {
-  size_t winner = count;
-  size_t winner_index = count;
-  for (size_t i = 0; i < count; ++i) {
-    auto& kernel = waitables[i].first->kernel_;
-    kernel->lock_.Acquire();
-    if (kernel->signaled_ && waitables[i].second < winner) {
-      winner = waitables[i].second;
-      winner_index = i;
-    }
-  }
-
-  // No events signaled. All locks acquired. Enqueue the Waiter on all of them
-  // and return.
-  if (winner == count) {
-    for (size_t i = 0; i < count; ++i)
-      waitables[i].first->Enqueue(waiter);
-    return count;
-  }
-
-  // Unlock in reverse order and possibly clear the chosen winner's signal
-  // before returning its index.
-  for (auto* w = waitables + count - 1; w >= waitables; --w) {
-    auto& kernel = w->first->kernel_;
-    if (w->second == winner) {
-      if (!kernel->manual_reset_)
-        kernel->signaled_ = false;
-    }
-    kernel->lock_.Release();
-  }
-
-  return winner_index;
-}
-
-// -----------------------------------------------------------------------------
-
-
 // -----------------------------------------------------------------------------
 // Private functions...
 
@@ -372,10 +346,47 @@ WaitableEvent::WaitableEventKernel::WaitableEventKernel(
     ResetPolicy reset_policy,
     InitialState initial_state)
     : manual_reset_(reset_policy == ResetPolicy::MANUAL),
-      signaled_(initial_state == InitialState::SIGNALED) {}
+      state_(initial_state == InitialState::SIGNALED ? kSignaled : 0) {}
 
 WaitableEvent::WaitableEventKernel::~WaitableEventKernel() = default;
 
+bool WaitableEvent::WaitableEventKernel::TryConsumeSignal() {
+  int32_t state = state_.load(std::memory_order_acquire);
+  while (state & kSignaled) {
+    if (manual_reset_ ||
+        state_.compare_exchange_weak(state, state & ~kSignaled,
+                                     std::memory_order_acquire,
+                                     std::memory_order_acquire)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool WaitableEvent::WaitableEventKernel::TryConsumeSignalOrPrepareToEnqueue() {
+  int32_t state = state_.load(std::memory_order_acquire);
+  for (;;) {
+    int32_t new_state;
+    if (!(state & kSignaled))
+      new_state = state | kHasWaiters;
+    else if (!manual_reset_)
+      new_state = state & ~kSignaled;
+    else
+      return true;
+
+    if (state_.compare_exchange_weak(state, new_state,
+                                     std::memory_order_acquire,
+                                     std::memory_order_acquire)) {
+      return state & kSignaled;
+    }
+  }
+}
+
+void WaitableEvent::WaitableEventKernel::UpdateHasWaiters() {
+  if (waiters_.empty())
+    state_.fetch_and(~kHasWaiters, std::memory_order_relaxed);
+}
+
 // -----------------------------------------------------------------------------
 // Wake all waiting waiters. Called with lock held.
 // -----------------------------------------------------------------------------
@@ -389,6 +400,7 @@ bool WaitableEvent::SignalAll() {
   }
 
   kernel_->waiters_.clear();
+  kernel_->UpdateHasWaiters();
   return signaled_at_least_one;
 }
 
@@ -398,20 +410,27 @@ bool WaitableEvent::SignalAll() {
 // ---------------------------------------------------------------------------
 bool WaitableEvent::SignalOne() {
   for (;;) {
-    if (kernel_->waiters_.empty())
+    if (kernel_->waiters_.empty()) {
+      kernel_->UpdateHasWaiters();
       return false;
+    }
 
     const bool r = (*kernel_->waiters_.begin())->Fire(this);
     kernel_->waiters_.pop_front();
-    if (r)
+    if (r) {
+      kernel_->UpdateHasWaiters();
       return true;
+    }
   }
 }
 
 // -----------------------------------------------------------------------------
-// Add a waiter to the list of those waiting. Called with lock held.
+// Add a waiter to the list of those waiting. Called with lock held, after
+// TryConsumeSignalOrPrepareToEnqueue() returned false.
 // -----------------------------------------------------------------------------
 void WaitableEvent::Enqueue(Waiter* waiter) {
+  DCHECK(kernel_->state_.load(std::memory_order_relaxed) &
+         WaitableEventKernel::kHasWaiters);
   kernel_->waiters_.push_back(waiter);
 }
 
@@ -424,6 +443,7 @@ bool WaitableEvent::WaitableEventKernel::Dequeue(Waiter* waiter, void* tag) {
        i = waiters_.begin(); i != waiters_.end(); ++i) {
     if (*i == waiter && (*i)->Compare(tag)) {
       waiters_.erase(i);
+      UpdateHasWaiters();
       return true;
     }
   }
@@ -7,6 +7,7 @@
 #include <stddef.h>
 
 #include <algorithm>
+#include <memory>
 
 #include "base/compiler_specific.h"
 #include "base/threading/platform_thread.h"
@@ -204,6 +205,64 @@ TEST(WaitableEventTest, WaitMany) {
   EXPECT_EQ(2u, index);
 }
 
+// Signals |event| |count| times, waiting for |ack| after each time.
+class RepeatedWaitableEventSignaler : public PlatformThread::Delegate {
+ public:
+  RepeatedWaitableEventSignaler(int count,
+                                WaitableEvent* event,
+                                WaitableEvent* ack)
+      : count_(count), event_(event), ack_(ack) {}
+
+  void ThreadMain() override {
+    for (int i = 0; i < count_; ++i) {
+      event_->Signal();
+      ack_->Wait();
+    }
+  }
+
+ private:
+  const int count_;
+  WaitableEvent* const event_;
+  WaitableEvent* const ack_;
+};
+
+// Tests that when auto-reset events are signaled concurrently with WaitMany(),
+// each signal is returned by exactly one WaitMany().
+TEST(WaitableEventTest, WaitManyConcurrentSignals) {
+  constexpr size_t kNumEvents = 4;
+  constexpr int kNumSignals = 1000;
+
+  WaitableEvent* ev[kNumEvents];
+  WaitableEvent* ack[kNumEvents];
+  std::unique_ptr<RepeatedWaitableEventSignaler> signalers[kNumEvents];
+  PlatformThreadHandle threads[kNumEvents];
+  for (size_t i = 0; i < kNumEvents; ++i) {
+    ev[i] = new WaitableEvent(WaitableEvent::ResetPolicy::AUTOMATIC,
+                              WaitableEvent::InitialState::NOT_SIGNALED);
+    ack[i] = new WaitableEvent(WaitableEvent::ResetPolicy::AUTOMATIC,
+                               WaitableEvent::InitialState::NOT_SIGNALED);
+    signalers[i] = std::make_unique<RepeatedWaitableEventSignaler>(
+        kNumSignals, ev[i], ack[i]);
+    PlatformThread::Create(0, signalers[i].get(), &threads[i]);
+  }
+
+  int num_signals[kNumEvents] = {};
+  for (size_t i = 0; i < kNumEvents * kNumSignals; ++i) {
+    const size_t index = WaitableEvent::WaitMany(ev, kNumEvents);
+    ASSERT_LT(index, kNumEvents);
+    ++num_signals[index];
+    ack[index]->Signal();
+  }
+
+  for (size_t i = 0; i < kNumEvents; ++i) {
+    PlatformThread::Join(threads[i]);
+    EXPECT_EQ(kNumSignals, num_signals[i]);
+    EXPECT_FALSE(ev[i]->IsSignaled());
+    delete ev[i];
+    delete ack[i];
+  }
+}
+
 // Tests that using TimeDelta::Max() on TimedWait() is not the same as passing
 // a timeout of 0. (crbug.com/465948)
 TEST(WaitableEventTest, TimedWait) {
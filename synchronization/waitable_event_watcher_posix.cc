@@ -144,10 +144,7 @@ bool WaitableEventWatcher::StartWatching(
 
   AutoLock locked(kernel->lock_);
 
-  if (kernel->signaled_) {
-    if (!kernel->manual_reset_)
-      kernel->signaled_ = false;
-
+  if (kernel->TryConsumeSignalOrPrepareToEnqueue()) {
     // No hairpinning - we can't call the delegate directly here. We have to
     // post a task to |task_runner| as usual.
     task_runner->PostTask(FROM_HERE, std::move(internal_callback));
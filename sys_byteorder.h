@@ -3,8 +3,8 @@
 // found in the LICENSE file.
 
 // This header defines cross-platform ByteSwap() implementations for 16, 32 and
-// 64-bit values, and NetToHostXX() / HostToNextXX() functions equivalent to
-// the traditional ntohX() and htonX() functions.
+// 64-bit values and arrays of them, and NetToHostXX() / HostToNextXX()
+// functions equivalent to the traditional ntohX() and htonX() functions.
 // Use the functions defined here rather than using the platform-specific
 // functions directly.
 
@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 
+#include "base/containers/span.h"
 #include "base/logging.h"
 #include "build/build_config.h"
 
@@ -47,6 +48,24 @@ inline uint64_t ByteSwap(uint64_t x) {
 #endif
 }
 
+// Swaps the bytes of all the |values|, in place. These loops are simple enough
+// for the compiler to vectorize, which makes them much faster than swapping
+// the values one at a time elsewhere.
+inline void ByteSwapInPlace(span<uint16_t> values) {
+  for (uint16_t& value : values)
+    value = ByteSwap(value);
+}
+
+inline void ByteSwapInPlace(span<uint32_t> values) {
+  for (uint32_t& value : values)
+    value = ByteSwap(value);
+}
+
+inline void ByteSwapInPlace(span<uint64_t> values) {
+  for (uint64_t& value : values)
+    value = ByteSwap(value);
+}
+
 inline uintptr_t ByteSwapUintPtrT(uintptr_t x) {
   // We do it this way because some build configurations are ILP32 even when
   // defined(ARCH_CPU_64_BITS). Unfortunately, we can't use sizeof in #ifs. But,
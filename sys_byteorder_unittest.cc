@@ -41,6 +41,26 @@ TEST(ByteOrderTest, ByteSwap64) {
   EXPECT_EQ(k64BitTestData, reswapped);
 }
 
+TEST(ByteOrderTest, ByteSwapInPlace) {
+  // Long enough for the vectorized loops, with a tail.
+  uint16_t values16[19];
+  uint32_t values32[19];
+  uint64_t values64[19];
+  for (size_t i = 0; i < 19; ++i) {
+    values16[i] = k16BitTestData;
+    values32[i] = k32BitTestData;
+    values64[i] = k64BitTestData;
+  }
+  base::ByteSwapInPlace(values16);
+  base::ByteSwapInPlace(values32);
+  base::ByteSwapInPlace(values64);
+  for (size_t i = 0; i < 19; ++i) {
+    EXPECT_EQ(k16BitSwappedTestData, values16[i]);
+    EXPECT_EQ(k32BitSwappedTestData, values32[i]);
+    EXPECT_EQ(k64BitSwappedTestData, values64[i]);
+  }
+}
+
 TEST(ByteOrderTest, ByteSwapUintPtrT) {
 #if defined(ARCH_CPU_64_BITS)
   const uintptr_t test_data = static_cast<uintptr_t>(k64BitTestData);
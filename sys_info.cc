@@ -5,10 +5,13 @@
 #include "base/sys_info.h"
 
 #include <algorithm>
+#include <atomic>
 
 #include "base/base_switches.h"
 #include "base/command_line.h"
 #include "base/lazy_instance.h"
+#include "base/memory/ref_counted.h"
+#include "base/observer_list_threadsafe.h"
 #include "base/sys_info_internal.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
@@ -16,8 +19,32 @@
 namespace base {
 namespace {
 static const int kLowMemoryDeviceThresholdMB = 512;
+
+// The cached values of NumberOfEffectiveProcessors() and
+// AmountOfEffectivePhysicalMemory(), which are 0 until they are first read.
+struct EffectiveResourceLimits {
+  std::atomic<int> num_processors{0};
+  std::atomic<int64_t> physical_memory{0};
+  const scoped_refptr<
+      ObserverListThreadSafe<SysInfo::EffectiveResourceLimitsObserver>>
+      observers = MakeRefCounted<
+          ObserverListThreadSafe<SysInfo::EffectiveResourceLimitsObserver>>();
+};
+
+LazyInstance<EffectiveResourceLimits>::Leaky g_effective_resource_limits =
+    LAZY_INSTANCE_INITIALIZER;
+
+// Stores |value| in |cached_value|, and returns true if it replaced another
+// value.
+template <typename T>
+bool UpdateCachedValue(std::atomic<T>* cached_value, T value) {
+  const T previous_value =
+      cached_value->exchange(value, std::memory_order_relaxed);
+  return previous_value != 0 && previous_value != value;
 }
 
+}  // namespace
+
 // static
 int64_t SysInfo::AmountOfPhysicalMemory() {
   if (base::CommandLine::ForCurrentProcess()->HasSwitch(
@@ -44,6 +71,69 @@ int64_t SysInfo::AmountOfAvailablePhysicalMemory() {
   return AmountOfAvailablePhysicalMemoryImpl();
 }
 
+// static
+int SysInfo::NumberOfEffectiveProcessors() {
+  std::atomic<int>& cached_value =
+      g_effective_resource_limits.Get().num_processors;
+  int value = cached_value.load(std::memory_order_relaxed);
+  if (!value) {
+    value = NumberOfEffectiveProcessorsImpl();
+    cached_value.store(value, std::memory_order_relaxed);
+  }
+  return value;
+}
+
+// static
+int64_t SysInfo::AmountOfEffectivePhysicalMemory() {
+  std::atomic<int64_t>& cached_value =
+      g_effective_resource_limits.Get().physical_memory;
+  int64_t value = cached_value.load(std::memory_order_relaxed);
+  if (!value) {
+    value = AmountOfEffectivePhysicalMemoryImpl();
+    cached_value.store(value, std::memory_order_relaxed);
+  }
+  // Follow the low-end device mode of AmountOfPhysicalMemory().
+  return std::min(value, AmountOfPhysicalMemory());
+}
+
+// static
+void SysInfo::AddEffectiveResourceLimitsObserver(
+    EffectiveResourceLimitsObserver* observer) {
+  g_effective_resource_limits.Get().observers->AddObserver(observer);
+}
+
+// static
+void SysInfo::RemoveEffectiveResourceLimitsObserver(
+    EffectiveResourceLimitsObserver* observer) {
+  g_effective_resource_limits.Get().observers->RemoveObserver(observer);
+}
+
+// static
+void SysInfo::RefreshEffectiveResourceLimits() {
+  EffectiveResourceLimits& limits = g_effective_resource_limits.Get();
+  const bool num_processors_changed = UpdateCachedValue(
+      &limits.num_processors, NumberOfEffectiveProcessorsImpl());
+  const bool physical_memory_changed = UpdateCachedValue(
+      &limits.physical_memory, AmountOfEffectivePhysicalMemoryImpl());
+  if (num_processors_changed || physical_memory_changed) {
+    limits.observers->Notify(
+        FROM_HERE,
+        &EffectiveResourceLimitsObserver::OnEffectiveResourceLimitsChanged);
+  }
+}
+
+#if !defined(OS_LINUX) && !defined(OS_ANDROID)
+// static
+int SysInfo::NumberOfEffectiveProcessorsImpl() {
+  return NumberOfProcessors();
+}
+
+// static
+int64_t SysInfo::AmountOfEffectivePhysicalMemoryImpl() {
+  return AmountOfPhysicalMemoryImpl();
+}
+#endif  // !defined(OS_LINUX) && !defined(OS_ANDROID)
+
 bool SysInfo::IsLowEndDevice() {
   if (base::CommandLine::ForCurrentProcess()->HasSwitch(
           switches::kEnableLowEndDeviceMode)) {
@@ -10,6 +10,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/files/file_path.h"
@@ -33,6 +34,41 @@ class BASE_EXPORT SysInfo {
   // Return the number of bytes of physical memory on the current machine.
   static int64_t AmountOfPhysicalMemory();
 
+  // Returns the number of processors this process can actually use: fewer
+  // than NumberOfProcessors() if its CPU affinity excludes some of them, or if
+  // its cgroup has a CPU quota (cpu.cfs_quota_us in cgroup v1, cpu.max in v2),
+  // rounded up. These restrictions are only read on Linux and Android; on
+  // other platforms, this is NumberOfProcessors(). Size thread pools with this
+  // rather than NumberOfProcessors(), e.g. in containers.
+  static int NumberOfEffectiveProcessors();
+
+  // Returns the number of bytes of physical memory this process can use: the
+  // memory limit of its cgroup (memory.limit_in_bytes in cgroup v1,
+  // memory.max in v2) if it's lower than AmountOfPhysicalMemory().
+  static int64_t AmountOfEffectivePhysicalMemory();
+
+  // Observes changes of the values above, which are cached.
+  class BASE_EXPORT EffectiveResourceLimitsObserver {
+   public:
+    // Called on the sequence the observer was added on, when
+    // RefreshEffectiveResourceLimits() found new values.
+    virtual void OnEffectiveResourceLimitsChanged() = 0;
+
+   protected:
+    virtual ~EffectiveResourceLimitsObserver() = default;
+  };
+
+  // Must be called on a sequence, which will be notified.
+  static void AddEffectiveResourceLimitsObserver(
+      EffectiveResourceLimitsObserver* observer);
+  static void RemoveEffectiveResourceLimitsObserver(
+      EffectiveResourceLimitsObserver* observer);
+
+  // Reads NumberOfEffectiveProcessors() and AmountOfEffectivePhysicalMemory()
+  // again, e.g. because the container may have been resized, and notifies the
+  // observers if they changed. This reads files, so it may block.
+  static void RefreshEffectiveResourceLimits();
+
   // Return the number of bytes of current available physical memory on the
   // machine.
   // (The amount of memory that can be allocated without any significant
@@ -106,6 +142,14 @@ class BASE_EXPORT SysInfo {
   // allocate.
   static size_t VMAllocationGranularity();
 
+#if defined(OS_LINUX)
+  // Returns the logical processors of each online NUMA node, indexed by node
+  // id, as listed in /sys/devices/system/node. Ids of offline nodes map to
+  // empty lists. Returns an empty vector if the topology can't be read, e.g. on
+  // kernels built without NUMA support.
+  static std::vector<std::vector<int>> NumaNodeProcessors();
+#endif
+
 #if defined(OS_CHROMEOS)
   typedef std::map<std::string, std::string> LsbReleaseMap;
 
@@ -174,6 +218,10 @@ class BASE_EXPORT SysInfo {
   static int64_t AmountOfAvailablePhysicalMemoryImpl();
   static bool IsLowEndDeviceImpl();
 
+  // Uncached.
+  static int NumberOfEffectiveProcessorsImpl();
+  static int64_t AmountOfEffectivePhysicalMemoryImpl();
+
 #if defined(OS_LINUX) || defined(OS_ANDROID) || defined(OS_AIX)
   static int64_t AmountOfAvailablePhysicalMemory(
       const SystemMemoryInfoKB& meminfo);
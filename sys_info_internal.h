@@ -5,10 +5,17 @@
 #ifndef BASE_SYS_INFO_INTERNAL_H_
 #define BASE_SYS_INFO_INTERNAL_H_
 
+#include <stdint.h>
+
+#include "base/base_export.h"
 #include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "build/build_config.h"
 
 namespace base {
 
+class FilePath;
+
 namespace internal {
 
 template<typename T, T (*F)(void)>
@@ -27,6 +34,23 @@ class LazySysInfoValue {
   DISALLOW_COPY_AND_ASSIGN(LazySysInfoValue);
 };
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+// Exposed for testing. |proc_self_cgroup| lists the cgroups of a process, in
+// the format of /proc/self/cgroup, and |cgroup_root| is where their
+// hierarchies are mounted, i.e. /sys/fs/cgroup, with the cgroup v2 hierarchy
+// at its root. The limits of the cgroups and of their ancestors apply, so the
+// lowest one is returned.
+
+// Returns the CPU quota of the cgroups, rounded up to a number of processors,
+// or 0 if they have none.
+BASE_EXPORT int GetCgroupCpuQuota(const FilePath& cgroup_root,
+                                  StringPiece proc_self_cgroup);
+
+// Returns the memory limit of the cgroups in bytes, or 0 if they have none.
+BASE_EXPORT int64_t GetCgroupMemoryLimit(const FilePath& cgroup_root,
+                                         StringPiece proc_self_cgroup);
+#endif  // defined(OS_LINUX) || defined(OS_ANDROID)
+
 }  // namespace internal
 
 }  // namespace base
@@ -4,9 +4,12 @@
 
 #include "base/sys_info.h"
 
+#include <sched.h>
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 #include "base/files/file_util.h"
@@ -14,8 +17,13 @@
 #include "base/logging.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/process/process_metrics.h"
+#include "base/stl_util.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
 #include "base/sys_info_internal.h"
+#include "base/threading/thread_restrictions.h"
 #include "build/build_config.h"
 
 namespace {
@@ -38,10 +46,190 @@ base::LazyInstance<
     base::internal::LazySysInfoValue<int64_t, AmountOfPhysicalMemory>>::Leaky
     g_lazy_physical_memory = LAZY_INSTANCE_INITIALIZER;
 
+// Reads a list in the kernel's "0-3,8,10-11" format from |path| and appends its
+// ids to |ids|. Returns false if |path| can't be read or is malformed.
+bool ReadIdList(const base::FilePath& path, std::vector<int>* ids) {
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return false;
+  for (base::StringPiece range : base::SplitStringPiece(
+           contents, ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    const size_t dash = range.find('-');
+    int first;
+    int last;
+    if (!base::StringToInt(range.substr(0, dash), &first))
+      return false;
+    if (dash == base::StringPiece::npos)
+      last = first;
+    else if (!base::StringToInt(range.substr(dash + 1), &last))
+      return false;
+    if (first < 0 || last < first)
+      return false;
+    for (int id = first; id <= last; ++id)
+      ids->push_back(id);
+  }
+  return true;
+}
+
+constexpr char kCgroupRoot[] = "/sys/fs/cgroup";
+constexpr char kProcSelfCgroup[] = "/proc/self/cgroup";
+
+// cgroup v1 reports an unlimited memory.limit_in_bytes as the largest multiple
+// of the page size.
+constexpr int64_t kUnlimitedCgroupMemory = int64_t{1} << 62;
+
+// Returns the directories of the cgroups in |proc_self_cgroup| that are in a
+// hierarchy with |controller|, and of their ancestors.
+std::vector<base::FilePath> GetCgroupDirs(const base::FilePath& cgroup_root,
+                                          base::StringPiece proc_self_cgroup,
+                                          base::StringPiece controller) {
+  std::vector<base::FilePath> dirs;
+  for (base::StringPiece line :
+       base::SplitStringPiece(proc_self_cgroup, "\n", base::TRIM_WHITESPACE,
+                              base::SPLIT_WANT_NONEMPTY)) {
+    // Each line is "hierarchy-id:controller-list:cgroup-path", and the cgroup
+    // v2 hierarchy has an empty controller list.
+    const size_t first_colon = line.find(':');
+    if (first_colon == base::StringPiece::npos)
+      continue;
+    const size_t second_colon = line.find(':', first_colon + 1);
+    if (second_colon == base::StringPiece::npos)
+      continue;
+    const base::StringPiece controllers =
+        line.substr(first_colon + 1, second_colon - first_colon - 1);
+    base::FilePath dir = cgroup_root;
+    if (!controllers.empty()) {
+      if (!base::ContainsValue(
+              base::SplitStringPiece(controllers, ",", base::TRIM_WHITESPACE,
+                                     base::SPLIT_WANT_NONEMPTY),
+              controller)) {
+        continue;
+      }
+      dir = dir.Append(controllers);
+    }
+
+    // Without a cgroup namespace, a container sees the full path of its
+    // cgroup, but may have it mounted at the root of the hierarchy, so the
+    // ancestors are checked even when the cgroup's directory doesn't exist.
+    dirs.push_back(dir);
+    for (base::StringPiece component : base::SplitStringPiece(
+             line.substr(second_colon + 1), "/", base::KEEP_WHITESPACE,
+             base::SPLIT_WANT_NONEMPTY)) {
+      dir = dir.Append(component);
+      dirs.push_back(dir);
+    }
+  }
+  return dirs;
+}
+
+// Reads the integer in |path|. Returns false if there is none, e.g. if it's
+// "max".
+bool ReadCgroupValue(const base::FilePath& path, int64_t* value) {
+  std::string contents;
+  return base::ReadFileToString(path, &contents) &&
+         base::StringToInt64(
+             base::TrimWhitespaceASCII(contents, base::TRIM_ALL), value);
+}
+
+// Sets |*processors| to the CPU quota of the cgroup at |dir|, and returns
+// true, if it has one.
+bool ReadCgroupCpuQuota(const base::FilePath& dir, double* processors) {
+  int64_t quota;
+  int64_t period;
+  std::string cpu_max;
+  if (base::ReadFileToString(dir.Append("cpu.max"), &cpu_max)) {
+    // cgroup v2: "$MAX $PERIOD", where $MAX is "max" if there is no quota.
+    const std::vector<base::StringPiece> fields = base::SplitStringPiece(
+        cpu_max, " ", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+    if (fields.size() != 2 || !base::StringToInt64(fields[0], &quota) ||
+        !base::StringToInt64(fields[1], &period)) {
+      return false;
+    }
+  } else if (!ReadCgroupValue(dir.Append("cpu.cfs_quota_us"), &quota) ||
+             !ReadCgroupValue(dir.Append("cpu.cfs_period_us"), &period)) {
+    return false;
+  }
+  // cgroup v1 has a quota of -1 if there is none.
+  if (quota <= 0 || period <= 0)
+    return false;
+  *processors = static_cast<double>(quota) / period;
+  return true;
+}
+
+// Returns the contents of /proc/self/cgroup, or an empty string if the kernel
+// has no cgroups.
+std::string ReadProcSelfCgroup() {
+  std::string contents;
+  base::ReadFileToString(base::FilePath(kProcSelfCgroup), &contents);
+  return contents;
+}
+
 }  // namespace
 
 namespace base {
 
+namespace internal {
+
+int GetCgroupCpuQuota(const FilePath& cgroup_root,
+                      StringPiece proc_self_cgroup) {
+  double min_processors = 0;
+  for (const FilePath& dir :
+       GetCgroupDirs(cgroup_root, proc_self_cgroup, "cpu")) {
+    double processors;
+    if (ReadCgroupCpuQuota(dir, &processors) &&
+        (!min_processors || processors < min_processors)) {
+      min_processors = processors;
+    }
+  }
+  return static_cast<int>(std::ceil(min_processors));
+}
+
+int64_t GetCgroupMemoryLimit(const FilePath& cgroup_root,
+                             StringPiece proc_self_cgroup) {
+  int64_t min_limit = 0;
+  for (const FilePath& dir :
+       GetCgroupDirs(cgroup_root, proc_self_cgroup, "memory")) {
+    // memory.max is "max" in cgroup v2 if there is no limit.
+    int64_t limit;
+    if ((ReadCgroupValue(dir.Append("memory.max"), &limit) ||
+         ReadCgroupValue(dir.Append("memory.limit_in_bytes"), &limit)) &&
+        limit > 0 && limit < kUnlimitedCgroupMemory &&
+        (!min_limit || limit < min_limit)) {
+      min_limit = limit;
+    }
+  }
+  return min_limit;
+}
+
+}  // namespace internal
+
+// static
+int SysInfo::NumberOfEffectiveProcessorsImpl() {
+  int num_processors = NumberOfProcessors();
+  cpu_set_t cpu_set;
+  if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0)
+    num_processors = std::min(num_processors, CPU_COUNT(&cpu_set));
+
+  // procfs and cgroupfs are in memory, so reading them doesn't block.
+  ThreadRestrictions::ScopedAllowIO allow_io;
+  const int cpu_quota =
+      internal::GetCgroupCpuQuota(FilePath(kCgroupRoot), ReadProcSelfCgroup());
+  if (cpu_quota)
+    num_processors = std::min(num_processors, cpu_quota);
+  return std::max(num_processors, 1);
+}
+
+// static
+int64_t SysInfo::AmountOfEffectivePhysicalMemoryImpl() {
+  const int64_t physical_memory = AmountOfPhysicalMemoryImpl();
+  // procfs and cgroupfs are in memory, so reading them doesn't block.
+  ThreadRestrictions::ScopedAllowIO allow_io;
+  const int64_t memory_limit = internal::GetCgroupMemoryLimit(
+      FilePath(kCgroupRoot), ReadProcSelfCgroup());
+  return memory_limit ? std::min(physical_memory, memory_limit)
+                      : physical_memory;
+}
+
 // static
 int64_t SysInfo::AmountOfPhysicalMemoryImpl() {
   return g_lazy_physical_memory.Get().value();
@@ -91,4 +279,24 @@ std::string SysInfo::CPUModelName() {
   return std::string();
 }
 
+// static
+std::vector<std::vector<int>> SysInfo::NumaNodeProcessors() {
+  std::vector<int> online_nodes;
+  if (!ReadIdList(FilePath("/sys/devices/system/node/online"),
+                  &online_nodes) ||
+      online_nodes.empty()) {
+    return std::vector<std::vector<int>>();
+  }
+
+  std::vector<std::vector<int>> node_processors(online_nodes.back() + 1);
+  for (int node : online_nodes) {
+    if (!ReadIdList(FilePath(StringPrintf(
+                        "/sys/devices/system/node/node%d/cpulist", node)),
+                    &node_processors[node])) {
+      return std::vector<std::vector<int>>();
+    }
+  }
+  return node_processors;
+}
+
 }  // namespace base
@@ -4,12 +4,17 @@
 
 #include <stdint.h>
 
+#include <set>
+#include <vector>
+
 #include "base/environment.h"
 #include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/process/process_metrics.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
 #include "base/sys_info.h"
+#include "base/sys_info_internal.h"
 #include "base/threading/platform_thread.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
@@ -33,6 +38,18 @@ TEST_F(SysInfoTest, AmountOfMem) {
   EXPECT_GE(SysInfo::AmountOfVirtualMemory(), 0);
 }
 
+TEST_F(SysInfoTest, NumEffectiveProcs) {
+  EXPECT_GE(SysInfo::NumberOfEffectiveProcessors(), 1);
+  EXPECT_LE(SysInfo::NumberOfEffectiveProcessors(),
+            SysInfo::NumberOfProcessors());
+}
+
+TEST_F(SysInfoTest, AmountOfEffectiveMem) {
+  EXPECT_GT(SysInfo::AmountOfEffectivePhysicalMemory(), 0);
+  EXPECT_LE(SysInfo::AmountOfEffectivePhysicalMemory(),
+            SysInfo::AmountOfPhysicalMemory());
+}
+
 #if defined(OS_LINUX) || defined(OS_ANDROID)
 #if defined(OS_LINUX)
 #define MAYBE_AmountOfAvailablePhysicalMemory \
@@ -65,6 +82,92 @@ TEST_F(SysInfoTest, MAYBE_AmountOfAvailablePhysicalMemory) {
 }
 #endif  // defined(OS_LINUX) || defined(OS_ANDROID)
 
+#if defined(OS_LINUX)
+TEST_F(SysInfoTest, NumaNodeProcessors) {
+  // The topology may be unavailable. When it isn't, each processor must belong
+  // to one node at most.
+  std::set<int> processors;
+  for (const std::vector<int>& node : SysInfo::NumaNodeProcessors()) {
+    for (int processor : node) {
+      EXPECT_GE(processor, 0);
+      EXPECT_TRUE(processors.insert(processor).second) << processor;
+    }
+  }
+}
+
+namespace {
+
+// Writes |contents| to |file| in the cgroup directory |dir| under |root|.
+void WriteCgroupFile(const FilePath& root,
+                     StringPiece dir,
+                     StringPiece file,
+                     StringPiece contents) {
+  const FilePath path = root.Append(dir);
+  ASSERT_TRUE(CreateDirectory(path));
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            WriteFile(path.Append(file), contents.data(), contents.size()));
+}
+
+}  // namespace
+
+TEST_F(SysInfoTest, CgroupV1CpuQuota) {
+  ScopedTempDir root;
+  ASSERT_TRUE(root.CreateUniqueTempDir());
+  constexpr char kProcSelfCgroup[] =
+      "5:memory:/docker/abc\n4:cpu,cpuacct:/docker/abc\n";
+  EXPECT_EQ(0, internal::GetCgroupCpuQuota(root.GetPath(), kProcSelfCgroup));
+
+  WriteCgroupFile(root.GetPath(), "cpu,cpuacct/docker/abc", "cpu.cfs_quota_us",
+                  "150000\n");
+  WriteCgroupFile(root.GetPath(), "cpu,cpuacct/docker/abc",
+                  "cpu.cfs_period_us", "100000\n");
+  WriteCgroupFile(root.GetPath(), "cpu,cpuacct", "cpu.cfs_quota_us", "-1\n");
+  WriteCgroupFile(root.GetPath(), "cpu,cpuacct", "cpu.cfs_period_us",
+                  "100000\n");
+  EXPECT_EQ(2, internal::GetCgroupCpuQuota(root.GetPath(), kProcSelfCgroup));
+
+  // The stricter quota of an ancestor applies.
+  WriteCgroupFile(root.GetPath(), "cpu,cpuacct/docker", "cpu.cfs_quota_us",
+                  "50000\n");
+  WriteCgroupFile(root.GetPath(), "cpu,cpuacct/docker", "cpu.cfs_period_us",
+                  "100000\n");
+  EXPECT_EQ(1, internal::GetCgroupCpuQuota(root.GetPath(), kProcSelfCgroup));
+
+  // Only the cgroup with the cpu controller is considered.
+  EXPECT_EQ(0, internal::GetCgroupCpuQuota(root.GetPath(),
+                                           "5:memory:/docker/abc\n"));
+}
+
+TEST_F(SysInfoTest, CgroupV2CpuQuota) {
+  ScopedTempDir root;
+  ASSERT_TRUE(root.CreateUniqueTempDir());
+  constexpr char kProcSelfCgroup[] = "0::/a/b\n";
+  WriteCgroupFile(root.GetPath(), "a/b", "cpu.max", "max 100000\n");
+  EXPECT_EQ(0, internal::GetCgroupCpuQuota(root.GetPath(), kProcSelfCgroup));
+
+  WriteCgroupFile(root.GetPath(), "a", "cpu.max", "250000 100000\n");
+  EXPECT_EQ(3, internal::GetCgroupCpuQuota(root.GetPath(), kProcSelfCgroup));
+}
+
+TEST_F(SysInfoTest, CgroupMemoryLimit) {
+  ScopedTempDir root;
+  ASSERT_TRUE(root.CreateUniqueTempDir());
+  EXPECT_EQ(0, internal::GetCgroupMemoryLimit(root.GetPath(), ""));
+
+  // cgroup v1 without a limit.
+  WriteCgroupFile(root.GetPath(), "memory/docker/abc", "memory.limit_in_bytes",
+                  "9223372036854771712\n");
+  EXPECT_EQ(0, internal::GetCgroupMemoryLimit(root.GetPath(),
+                                              "5:memory:/docker/abc\n"));
+
+  // cgroup v2.
+  WriteCgroupFile(root.GetPath(), "a/b", "memory.max", "max\n");
+  WriteCgroupFile(root.GetPath(), "a", "memory.max", "1073741824\n");
+  EXPECT_EQ(1073741824,
+            internal::GetCgroupMemoryLimit(root.GetPath(), "0::/a/b\n"));
+}
+#endif  // defined(OS_LINUX)
+
 TEST_F(SysInfoTest, AmountOfFreeDiskSpace) {
   // We aren't actually testing that it's correct, just that it's sane.
   FilePath tmp_path;
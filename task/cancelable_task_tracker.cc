@@ -6,6 +6,7 @@
 
 #include <stddef.h>
 
+#include <memory>
 #include <utility>
 
 #include "base/bind.h"
@@ -13,34 +14,80 @@
 #include "base/callback_helpers.h"
 #include "base/location.h"
 #include "base/memory/ref_counted.h"
-#include "base/synchronization/cancellation_flag.h"
 #include "base/task_runner.h"
 #include "base/threading/sequenced_task_runner_handle.h"
 
 namespace base {
 
+namespace internal {
+
+// The cancellation flags of the tasks tracked by a CancelableTaskTracker since
+// its last TryCancelAll(). The flags are allocated by chunks which never move,
+// and are reused once their task is untracked, so that tracking a task usually
+// allocates nothing. Canceling all the tasks is a single store, after which
+// the tracker uses a new table.
+//
+// The flags are set on the sequence of the tracker, and read from any sequence
+// by the tasks, which keep the table alive.
+class CancelableTaskFlagTable
+    : public RefCountedThreadSafe<CancelableTaskFlagTable> {
+ public:
+  CancelableTaskFlagTable() = default;
+
+  bool IsCanceled(const std::atomic<bool>* flag) const {
+    return all_canceled_.load(std::memory_order_acquire) ||
+           flag->load(std::memory_order_acquire);
+  }
+
+  void CancelAll() { all_canceled_.store(true, std::memory_order_release); }
+
+  // Returns the flag of |slot|, allocating a chunk for it if needed. Slots are
+  // allocated in order.
+  std::atomic<bool>* GetFlag(size_t slot) {
+    const size_t chunk = slot / kChunkSize;
+    DCHECK_LE(chunk, chunks_.size());
+    if (chunk == chunks_.size())
+      chunks_.push_back(std::make_unique<Chunk>());
+    return &chunks_[chunk]->flags[slot % kChunkSize];
+  }
+
+ private:
+  friend class RefCountedThreadSafe<CancelableTaskFlagTable>;
+
+  static constexpr size_t kChunkSize = 64;
+
+  struct Chunk {
+    std::atomic<bool> flags[kChunkSize] = {};
+  };
+
+  ~CancelableTaskFlagTable() = default;
+
+  std::atomic<bool> all_canceled_{false};
+  std::vector<std::unique_ptr<Chunk>> chunks_;
+
+  DISALLOW_COPY_AND_ASSIGN(CancelableTaskFlagTable);
+};
+
+}  // namespace internal
+
 namespace {
 
-void RunIfNotCanceled(const CancellationFlag* flag, OnceClosure task) {
-  if (!flag->IsSet())
-    std::move(task).Run();
-}
+// The low bits of a TaskId are the slot of its flag, the other bits a serial
+// number which makes the TaskId unique.
+constexpr int kSlotBits = 24;
+constexpr CancelableTaskTracker::TaskId kSlotMask = (1 << kSlotBits) - 1;
 
-void RunIfNotCanceledThenUntrack(const CancellationFlag* flag,
-                                 OnceClosure task,
-                                 OnceClosure untrack) {
-  RunIfNotCanceled(flag, std::move(task));
-  std::move(untrack).Run();
+void RunIfNotCanceled(const internal::CancelableTaskFlagTable* flag_table,
+                      const std::atomic<bool>* flag,
+                      OnceClosure task) {
+  if (!flag_table->IsCanceled(flag))
+    std::move(task).Run();
 }
 
-bool IsCanceled(const CancellationFlag* flag,
+bool IsCanceled(const internal::CancelableTaskFlagTable* flag_table,
+                const std::atomic<bool>* flag,
                 ScopedClosureRunner* cleanup_runner) {
-  return flag->IsSet();
-}
-
-void RunAndDeleteFlag(OnceClosure closure, const CancellationFlag* flag) {
-  std::move(closure).Run();
-  delete flag;
+  return flag_table->IsCanceled(flag);
 }
 
 void RunOrPostToTaskRunner(TaskRunner* task_runner, OnceClosure closure) {
@@ -83,23 +130,22 @@ CancelableTaskTracker::TaskId CancelableTaskTracker::PostTaskAndReply(
   // We need a SequencedTaskRunnerHandle to run |reply|.
   DCHECK(SequencedTaskRunnerHandle::IsSet());
 
-  // Owned by reply callback below.
-  CancellationFlag* flag = new CancellationFlag();
-
-  TaskId id = next_id_;
-  next_id_++;  // int64_t is big enough that we ignore the potential overflow.
+  std::atomic<bool>* flag;
+  TaskId id = Track(&flag);
 
-  OnceClosure untrack_closure =
-      BindOnce(&CancelableTaskTracker::Untrack, weak_factory_.GetWeakPtr(), id);
   bool success = task_runner->PostTaskAndReply(
-      from_here, BindOnce(&RunIfNotCanceled, flag, std::move(task)),
-      BindOnce(&RunIfNotCanceledThenUntrack, Owned(flag), std::move(reply),
-               std::move(untrack_closure)));
-
-  if (!success)
+      from_here,
+      BindOnce(&RunIfNotCanceled, RetainedRef(flag_table_), flag,
+               std::move(task)),
+      BindOnce(&CancelableTaskTracker::RunIfNotCanceledThenUntrack,
+               RetainedRef(flag_table_), flag, std::move(reply),
+               weak_factory_.GetWeakPtr(), id));
+
+  if (!success) {
+    Untrack(id);
     return kBadTaskId;
+  }
 
-  Track(id, flag);
   return id;
 }
 
@@ -108,35 +154,27 @@ CancelableTaskTracker::TaskId CancelableTaskTracker::NewTrackedTaskId(
   DCHECK(sequence_checker_.CalledOnValidSequence());
   DCHECK(SequencedTaskRunnerHandle::IsSet());
 
-  TaskId id = next_id_;
-  next_id_++;  // int64_t is big enough that we ignore the potential overflow.
+  std::atomic<bool>* flag;
+  TaskId id = Track(&flag);
 
-  // Will be deleted by |untrack_and_delete_flag| after Untrack().
-  CancellationFlag* flag = new CancellationFlag();
-
-  OnceClosure untrack_and_delete_flag = BindOnce(
-      &RunAndDeleteFlag,
-      BindOnce(&CancelableTaskTracker::Untrack, weak_factory_.GetWeakPtr(), id),
-      flag);
-
-  // Will always run |untrack_and_delete_flag| on current sequence.
-  ScopedClosureRunner* untrack_and_delete_flag_runner =
-      new ScopedClosureRunner(BindOnce(
-          &RunOrPostToTaskRunner, RetainedRef(SequencedTaskRunnerHandle::Get()),
-          std::move(untrack_and_delete_flag)));
+  // Will always run Untrack() on current sequence.
+  ScopedClosureRunner* untrack_runner = new ScopedClosureRunner(BindOnce(
+      &RunOrPostToTaskRunner, RetainedRef(SequencedTaskRunnerHandle::Get()),
+      BindOnce(&CancelableTaskTracker::Untrack, weak_factory_.GetWeakPtr(),
+               id)));
 
   *is_canceled_cb =
-      Bind(&IsCanceled, flag, Owned(untrack_and_delete_flag_runner));
+      Bind(&IsCanceled, RetainedRef(flag_table_), flag, Owned(untrack_runner));
 
-  Track(id, flag);
   return id;
 }
 
 void CancelableTaskTracker::TryCancel(TaskId id) {
   DCHECK(sequence_checker_.CalledOnValidSequence());
 
-  const auto it = task_flags_.find(id);
-  if (it == task_flags_.end()) {
+  const size_t slot = static_cast<size_t>(id & kSlotMask);
+  if (!flag_table_ || slot >= slot_task_ids_.size() ||
+      slot_task_ids_[slot] != id) {
     // Two possibilities:
     //
     //   1. The task has already been untracked.
@@ -145,32 +183,72 @@ void CancelableTaskTracker::TryCancel(TaskId id) {
     // Since this function is best-effort, it's OK to ignore these.
     return;
   }
-  it->second->Set();
+  flag_table_->GetFlag(slot)->store(true, std::memory_order_release);
 }
 
 void CancelableTaskTracker::TryCancelAll() {
   DCHECK(sequence_checker_.CalledOnValidSequence());
-  for (const auto& it : task_flags_)
-    it.second->Set();
+  if (flag_table_) {
+    flag_table_->CancelAll();
+    flag_table_ = nullptr;
+  }
   weak_factory_.InvalidateWeakPtrs();
-  task_flags_.clear();
+  slot_task_ids_.clear();
+  free_slots_.clear();
 }
 
 bool CancelableTaskTracker::HasTrackedTasks() const {
   DCHECK(sequence_checker_.CalledOnValidSequence());
-  return !task_flags_.empty();
+  return slot_task_ids_.size() != free_slots_.size();
 }
 
-void CancelableTaskTracker::Track(TaskId id, CancellationFlag* flag) {
+CancelableTaskTracker::TaskId CancelableTaskTracker::Track(
+    std::atomic<bool>** flag) {
   DCHECK(sequence_checker_.CalledOnValidSequence());
-  bool success = task_flags_.insert(std::make_pair(id, flag)).second;
-  DCHECK(success);
+
+  if (!flag_table_)
+    flag_table_ = MakeRefCounted<internal::CancelableTaskFlagTable>();
+
+  size_t slot;
+  if (free_slots_.empty()) {
+    slot = slot_task_ids_.size();
+    CHECK_LE(slot, static_cast<size_t>(kSlotMask));
+    slot_task_ids_.push_back(kBadTaskId);
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  }
+
+  // int64_t is big enough that we ignore the potential overflow.
+  const TaskId id = (next_id_++ << kSlotBits) | static_cast<TaskId>(slot);
+  slot_task_ids_[slot] = id;
+
+  // The previous task using the slot, if any, doesn't read its flag anymore,
+  // and the tasks that will read it are posted after this.
+  *flag = flag_table_->GetFlag(slot);
+  (*flag)->store(false, std::memory_order_relaxed);
+  return id;
 }
 
 void CancelableTaskTracker::Untrack(TaskId id) {
   DCHECK(sequence_checker_.CalledOnValidSequence());
-  size_t num = task_flags_.erase(id);
-  DCHECK_EQ(1u, num);
+  const size_t slot = static_cast<size_t>(id & kSlotMask);
+  DCHECK_LT(slot, slot_task_ids_.size());
+  DCHECK_EQ(id, slot_task_ids_[slot]);
+  slot_task_ids_[slot] = kBadTaskId;
+  free_slots_.push_back(slot);
+}
+
+// static
+void CancelableTaskTracker::RunIfNotCanceledThenUntrack(
+    const internal::CancelableTaskFlagTable* flag_table,
+    const std::atomic<bool>* flag,
+    OnceClosure reply,
+    WeakPtr<CancelableTaskTracker> tracker,
+    TaskId id) {
+  RunIfNotCanceled(flag_table, flag, std::move(reply));
+  if (tracker)
+    tracker->Untrack(id);
 }
 
 }  // namespace base
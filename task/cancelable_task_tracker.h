@@ -36,25 +36,31 @@
 #ifndef BASE_TASK_CANCELABLE_TASK_TRACKER_H_
 #define BASE_TASK_CANCELABLE_TASK_TRACKER_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include <atomic>
 #include <utility>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/bind.h"
 #include "base/callback.h"
-#include "base/containers/small_map.h"
 #include "base/macros.h"
+#include "base/memory/scoped_refptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/post_task_and_reply_with_result_internal.h"
 #include "base/sequence_checker.h"
 
 namespace base {
 
-class CancellationFlag;
 class Location;
 class TaskRunner;
 
+namespace internal {
+class CancelableTaskFlagTable;
+}  // namespace internal
+
 class BASE_EXPORT CancelableTaskTracker {
  public:
   // All values except kBadTaskId are valid.
@@ -136,15 +142,32 @@ class BASE_EXPORT CancelableTaskTracker {
   bool HasTrackedTasks() const;
 
  private:
-  void Track(TaskId id, CancellationFlag* flag);
+  // Tracks a new task and returns its TaskId, and the flag by which it is
+  // canceled in |flag|.
+  TaskId Track(std::atomic<bool>** flag);
   void Untrack(TaskId id);
 
-  // Typically the number of tasks are 0-2 and occationally 3-4. But since
-  // this is a general API that could be used in unexpected ways, use a
-  // small_map instead of a flat_map to avoid falling over if there are many
-  // tasks.
-  small_map<std::map<TaskId, CancellationFlag*>, 4> task_flags_;
+  // Runs |reply| unless the task is canceled, by |flag| or by its whole
+  // |flag_table|, then untracks |id| if |tracker| is still alive.
+  static void RunIfNotCanceledThenUntrack(
+      const internal::CancelableTaskFlagTable* flag_table,
+      const std::atomic<bool>* flag,
+      OnceClosure reply,
+      WeakPtr<CancelableTaskTracker> tracker,
+      TaskId id);
+
+  // The flags of the tasks tracked since the last TryCancelAll(), which
+  // canceled the previous table as a whole. Created when a task is tracked.
+  scoped_refptr<internal::CancelableTaskFlagTable> flag_table_;
+
+  // The TaskId of the task using each slot of |flag_table_|, or kBadTaskId.
+  // The slot is encoded in the TaskId, so no map is needed to find it.
+  std::vector<TaskId> slot_task_ids_;
+
+  // The slots of |flag_table_| which can be reused.
+  std::vector<size_t> free_slots_;
 
+  // The serial number of the next TaskId, in its upper bits.
   TaskId next_id_;
   SequenceChecker sequence_checker_;
 
@@ -139,6 +139,29 @@ TEST_F(CancelableTaskTrackerTest, CancelPostedTaskAndReply) {
   test_task_runner->RunUntilIdle();
 }
 
+// Post a task and let it complete, then post another one, which reuses
+// its cancellation flag.  Canceling the first task should not cancel
+// the second one.
+TEST_F(CancelableTaskTrackerTest, CancelCompletedTaskAfterReuse) {
+  scoped_refptr<TestSimpleTaskRunner> test_task_runner(
+      new TestSimpleTaskRunner());
+
+  CancelableTaskTracker::TaskId first_task_id = task_tracker_.PostTask(
+      test_task_runner.get(), FROM_HERE, MakeExpectedRunClosure(FROM_HERE));
+  test_task_runner->RunUntilIdle();
+  RunCurrentLoopUntilIdle();
+  EXPECT_FALSE(task_tracker_.HasTrackedTasks());
+
+  CancelableTaskTracker::TaskId second_task_id = task_tracker_.PostTask(
+      test_task_runner.get(), FROM_HERE, MakeExpectedRunClosure(FROM_HERE));
+  EXPECT_NE(CancelableTaskTracker::kBadTaskId, second_task_id);
+  EXPECT_NE(first_task_id, second_task_id);
+
+  task_tracker_.TryCancel(first_task_id);
+  test_task_runner->RunUntilIdle();
+  RunCurrentLoopUntilIdle();
+}
+
 // Post a task with reply with the task tracker and cancel it after
 // running the task runner but before running the current message
 // loop.  The task should run but the reply should not.
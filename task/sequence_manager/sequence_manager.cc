@@ -0,0 +1,193 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/sequence_manager/sequence_manager.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/run_loop.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/default_tick_clock.h"
+#include "base/time/tick_clock.h"
+
+namespace base {
+namespace sequence_manager {
+
+namespace {
+
+constexpr char kQueueFunctionName[] = "SequenceManager::PostTask";
+
+}  // namespace
+
+SequenceManager::SequenceManager(
+    scoped_refptr<SingleThreadTaskRunner> thread_task_runner,
+    const TickClock* tick_clock)
+    : thread_task_runner_(std::move(thread_task_runner)),
+      tick_clock_(tick_clock),
+      weak_factory_(this) {
+  DCHECK(thread_task_runner_);
+  DCHECK(thread_task_runner_->RunsTasksInCurrentSequence());
+  DCHECK(tick_clock_);
+  weak_this_ = weak_factory_.GetWeakPtr();
+}
+
+SequenceManager::~SequenceManager() {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  // ShutdownTaskQueue() unregisters each queue from |queues_|.
+  const std::vector<scoped_refptr<TaskQueue>> queues = queues_;
+  for (const scoped_refptr<TaskQueue>& queue : queues)
+    queue->ShutdownTaskQueue();
+  DCHECK(queues_.empty());
+}
+
+// static
+std::unique_ptr<SequenceManager> SequenceManager::CreateOnCurrentThread() {
+  return std::make_unique<SequenceManager>(ThreadTaskRunnerHandle::Get(),
+                                           DefaultTickClock::GetInstance());
+}
+
+scoped_refptr<TaskQueue> SequenceManager::CreateTaskQueue(const char* name) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  scoped_refptr<TaskQueue> queue(
+      new TaskQueue(this, thread_task_runner_, name));
+  queues_.push_back(queue);
+  return queue;
+}
+
+void SequenceManager::ScheduleWork() {
+  {
+    AutoLock auto_lock(do_work_posted_lock_);
+    if (do_work_posted_)
+      return;
+    do_work_posted_ = true;
+  }
+  thread_task_runner_->PostTask(
+      FROM_HERE, BindOnce(&SequenceManager::DoWork, weak_this_));
+}
+
+void SequenceManager::UnregisterTaskQueue(TaskQueue* queue) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  auto it = std::find(queues_.begin(), queues_.end(), queue);
+  DCHECK(it != queues_.end());
+  queues_.erase(it);
+}
+
+TimeTicks SequenceManager::NowTicks() const {
+  return tick_clock_->NowTicks();
+}
+
+void SequenceManager::DidQueueTask(const PendingTask& pending_task) {
+  task_annotator_.DidQueueTask(kQueueFunctionName, pending_task);
+}
+
+void SequenceManager::DoWork() {
+  {
+    AutoLock auto_lock(do_work_posted_lock_);
+    do_work_posted_ = false;
+  }
+  RunNextTask();
+}
+
+void SequenceManager::DoDelayedWork(TimeTicks wake_up_time) {
+  if (wake_up_time == next_delayed_do_work_time_)
+    next_delayed_do_work_time_ = TimeTicks::Max();
+  RunNextTask();
+}
+
+void SequenceManager::RunNextTask() {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  const TimeTicks now = tick_clock_->NowTicks();
+  // Keep the queue alive in case its task shuts it down.
+  scoped_refptr<TaskQueue> queue = SelectQueue(now);
+  if (!queue) {
+    const TimeTicks wake_up_time = GetNextWakeUp(now);
+    if (!wake_up_time.is_max())
+      ScheduleDelayedWork(now, wake_up_time);
+    return;
+  }
+
+  PendingTask pending_task = queue->TakeNextReadyTask();
+
+  // Schedule the next task before running this one, so that a nested RunLoop
+  // in this task keeps running the queues' tasks.
+  ScheduleWork();
+
+  task_annotator_.RunTask(kQueueFunctionName, &pending_task);
+
+  if (queue->has_cpu_budget())
+    queue->ChargeCpuBudget(tick_clock_->NowTicks() - now);
+
+  // A DoWork() which ran in a nested RunLoop may have left non-nestable tasks
+  // behind without scheduling anything. This is a no-op if the DoWork() posted
+  // above didn't run yet.
+  ScheduleWork();
+}
+
+TaskQueue* SequenceManager::SelectQueue(TimeTicks now) {
+  const bool is_nested = RunLoop::IsNestedOnCurrentThread();
+  TaskQueue* selected_queue = nullptr;
+  int selected_sequence_num = 0;
+  for (const scoped_refptr<TaskQueue>& queue : queues_) {
+    if (!queue->IsQueueEnabled())
+      continue;
+    if (selected_queue &&
+        queue->GetQueuePriority() > selected_queue->GetQueuePriority()) {
+      continue;
+    }
+    const PendingTask* task = queue->GetNextReadyTask(now);
+    if (!task)
+      continue;
+    if (is_nested && task->nestable == Nestable::kNonNestable)
+      continue;
+    TimeTicks recovery_time;
+    if (queue->IsOutOfCpuBudget(now, &recovery_time))
+      continue;
+    // Among queues of equal priority, the oldest task goes first.
+    if (!selected_queue ||
+        queue->GetQueuePriority() < selected_queue->GetQueuePriority() ||
+        task->sequence_num < selected_sequence_num) {
+      selected_queue = queue.get();
+      selected_sequence_num = task->sequence_num;
+    }
+  }
+  return selected_queue;
+}
+
+TimeTicks SequenceManager::GetNextWakeUp(TimeTicks now) {
+  TimeTicks wake_up_time = TimeTicks::Max();
+  for (const scoped_refptr<TaskQueue>& queue : queues_) {
+    if (!queue->IsQueueEnabled())
+      continue;
+    // A queue out of budget wakes up when its budget recovers, if it has a
+    // task to run then. Its delayed tasks can't run before either.
+    TimeTicks recovery_time;
+    if (queue->IsOutOfCpuBudget(now, &recovery_time)) {
+      wake_up_time = std::min(
+          wake_up_time,
+          queue->GetNextReadyTask(now)
+              ? recovery_time
+              : std::max(recovery_time, queue->GetNextDelayedRunTime()));
+      continue;
+    }
+    wake_up_time = std::min(wake_up_time, queue->GetNextDelayedRunTime());
+  }
+  return wake_up_time;
+}
+
+void SequenceManager::ScheduleDelayedWork(TimeTicks now,
+                                          TimeTicks wake_up_time) {
+  if (wake_up_time >= next_delayed_do_work_time_)
+    return;
+  next_delayed_do_work_time_ = wake_up_time;
+  thread_task_runner_->PostDelayedTask(
+      FROM_HERE,
+      BindOnce(&SequenceManager::DoDelayedWork, weak_this_, wake_up_time),
+      wake_up_time - now);
+}
+
+}  // namespace sequence_manager
+}  // namespace base
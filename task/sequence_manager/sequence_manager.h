@@ -0,0 +1,130 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_SEQUENCE_MANAGER_SEQUENCE_MANAGER_H_
+#define BASE_TASK_SEQUENCE_MANAGER_SEQUENCE_MANAGER_H_
+
+#include <memory>
+#include <vector>
+
+#include "base/atomic_sequence_num.h"
+#include "base/base_export.h"
+#include "base/debug/task_annotator.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/pending_task.h"
+#include "base/single_thread_task_runner.h"
+#include "base/synchronization/lock.h"
+#include "base/task/sequence_manager/task_queue.h"
+#include "base/threading/thread_checker.h"
+#include "base/time/time.h"
+
+namespace base {
+
+class TickClock;
+
+namespace sequence_manager {
+
+// Runs the tasks of several TaskQueues on a single thread, on top of that
+// thread's MessageLoop: whenever a queue has work, the SequenceManager posts a
+// task to the MessageLoop which runs the next task from the queue of highest
+// priority that is enabled and within its CPU budget. One queue task runs per
+// MessageLoop task, so the MessageLoop's own tasks and native work interleave
+// with the queues' tasks. This lets a thread deprioritize bulk work, or
+// throttle it to a fraction of the thread's time, without a second thread.
+//
+// Picking the next queue is a scan over the queues, which is cheap for the
+// handful of queues a thread typically has.
+//
+// A SequenceManager must be created, used and deleted on a single thread.
+//
+// Example:
+//   auto sequence_manager = SequenceManager::CreateOnCurrentThread();
+//   scoped_refptr<TaskQueue> bulk_queue =
+//       sequence_manager->CreateTaskQueue("bulk");
+//   bulk_queue->SetQueuePriority(TaskQueue::kBestEffortPriority);
+//   bulk_queue->SetCpuBudget(0.1, TimeDelta::FromMilliseconds(50));
+//   bulk_queue->PostTask(FROM_HERE, BindOnce(&IndexPages));
+class BASE_EXPORT SequenceManager {
+ public:
+  // Creates a SequenceManager which runs tasks by posting to
+  // |thread_task_runner|, which must run tasks on the current thread, and uses
+  // |tick_clock| for delays and CPU budgets. |tick_clock| must outlive the
+  // SequenceManager and its TaskQueues.
+  SequenceManager(scoped_refptr<SingleThreadTaskRunner> thread_task_runner,
+                  const TickClock* tick_clock);
+
+  // Deletes the pending tasks of all TaskQueues and shuts them down.
+  ~SequenceManager();
+
+  // Creates a SequenceManager on top of the current thread's MessageLoop.
+  static std::unique_ptr<SequenceManager> CreateOnCurrentThread();
+
+  // Creates a TaskQueue of normal priority. |name| must outlive the queue.
+  scoped_refptr<TaskQueue> CreateTaskQueue(const char* name);
+
+ private:
+  friend class TaskQueue;
+
+  // Called by TaskQueues on any thread. Posts a DoWork() task unless one is
+  // already pending.
+  void ScheduleWork();
+
+  // Called by TaskQueue::ShutdownTaskQueue().
+  void UnregisterTaskQueue(TaskQueue* queue);
+
+  // Called by TaskQueues on any thread, with their lock held.
+  int GetNextSequenceNumber() { return sequence_num_.GetNext(); }
+  TimeTicks NowTicks() const;
+  void DidQueueTask(const PendingTask& pending_task);
+
+  // Runs the next task, if any can run, and schedules the next DoWork().
+  void DoWork();
+  void DoDelayedWork(TimeTicks wake_up_time);
+  void RunNextTask();
+
+  // Returns the queue whose task should run next at |now|, or nullptr if no
+  // task can run.
+  TaskQueue* SelectQueue(TimeTicks now);
+
+  // Returns when a task will be able to run, assuming no task can run at |now|.
+  TimeTicks GetNextWakeUp(TimeTicks now);
+
+  // Posts a DoDelayedWork() task for |wake_up_time| unless an earlier one is
+  // already pending.
+  void ScheduleDelayedWork(TimeTicks now, TimeTicks wake_up_time);
+
+  const scoped_refptr<SingleThreadTaskRunner> thread_task_runner_;
+  const TickClock* const tick_clock_;
+
+  debug::TaskAnnotator task_annotator_;
+
+  // Gives tasks their order across queues.
+  AtomicSequenceNumber sequence_num_;
+
+  // The registered queues.
+  std::vector<scoped_refptr<TaskQueue>> queues_;
+
+  // Whether a DoWork() task is posted and hasn't started running.
+  bool do_work_posted_ = false;
+  Lock do_work_posted_lock_;
+
+  // Time of the earliest pending DoDelayedWork() task.
+  TimeTicks next_delayed_do_work_time_ = TimeTicks::Max();
+
+  THREAD_CHECKER(thread_checker_);
+
+  // Bound to the current thread in the constructor, so that it can be copied
+  // by ScheduleWork() on any thread.
+  WeakPtr<SequenceManager> weak_this_;
+  WeakPtrFactory<SequenceManager> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(SequenceManager);
+};
+
+}  // namespace sequence_manager
+}  // namespace base
+
+#endif  // BASE_TASK_SEQUENCE_MANAGER_SEQUENCE_MANAGER_H_
@@ -0,0 +1,176 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/sequence_manager/sequence_manager.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/task/sequence_manager/task_queue.h"
+#include "base/test/simple_test_tick_clock.h"
+#include "base/test/test_mock_time_task_runner.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace sequence_manager {
+
+namespace {
+
+void RecordRun(std::vector<std::string>* run_order, std::string label) {
+  run_order->push_back(std::move(label));
+}
+
+void RecordRunAndAdvanceClock(std::vector<std::string>* run_order,
+                              std::string label,
+                              SimpleTestTickClock* clock,
+                              TimeDelta run_time) {
+  run_order->push_back(std::move(label));
+  clock->Advance(run_time);
+}
+
+class SequenceManagerTest : public testing::Test {
+ protected:
+  SequenceManagerTest()
+      : task_runner_(MakeRefCounted<TestMockTimeTaskRunner>()),
+        sequence_manager_(std::make_unique<SequenceManager>(
+            task_runner_,
+            task_runner_->GetMockTickClock())) {}
+
+  void PostRecordRun(TaskQueue* queue, std::string label) {
+    EXPECT_TRUE(queue->PostTask(
+        FROM_HERE, BindOnce(&RecordRun, &run_order_, std::move(label))));
+  }
+
+  const scoped_refptr<TestMockTimeTaskRunner> task_runner_;
+  std::unique_ptr<SequenceManager> sequence_manager_;
+  std::vector<std::string> run_order_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SequenceManagerTest);
+};
+
+}  // namespace
+
+// Verify that tasks of queues of equal priority run in posting order.
+TEST_F(SequenceManagerTest, EqualPriorityQueuesRunInPostingOrder) {
+  scoped_refptr<TaskQueue> queue_a = sequence_manager_->CreateTaskQueue("a");
+  scoped_refptr<TaskQueue> queue_b = sequence_manager_->CreateTaskQueue("b");
+
+  PostRecordRun(queue_a.get(), "a1");
+  PostRecordRun(queue_b.get(), "b1");
+  PostRecordRun(queue_a.get(), "a2");
+  PostRecordRun(queue_b.get(), "b2");
+  task_runner_->RunUntilIdle();
+
+  EXPECT_EQ((std::vector<std::string>{"a1", "b1", "a2", "b2"}), run_order_);
+}
+
+// Verify that all tasks of a queue of higher priority run before the tasks of
+// a queue of lower priority, regardless of posting order.
+TEST_F(SequenceManagerTest, HigherPriorityQueueRunsFirst) {
+  scoped_refptr<TaskQueue> low_queue =
+      sequence_manager_->CreateTaskQueue("low");
+  low_queue->SetQueuePriority(TaskQueue::kBestEffortPriority);
+  scoped_refptr<TaskQueue> high_queue =
+      sequence_manager_->CreateTaskQueue("high");
+  high_queue->SetQueuePriority(TaskQueue::kHighPriority);
+
+  PostRecordRun(low_queue.get(), "low1");
+  PostRecordRun(low_queue.get(), "low2");
+  PostRecordRun(high_queue.get(), "high1");
+  PostRecordRun(high_queue.get(), "high2");
+  task_runner_->RunUntilIdle();
+
+  EXPECT_EQ((std::vector<std::string>{"high1", "high2", "low1", "low2"}),
+            run_order_);
+}
+
+// Verify that the tasks of a disabled queue only run once it is enabled again.
+TEST_F(SequenceManagerTest, DisabledQueue) {
+  scoped_refptr<TaskQueue> queue = sequence_manager_->CreateTaskQueue("a");
+  queue->SetQueueEnabled(false);
+
+  PostRecordRun(queue.get(), "a1");
+  task_runner_->RunUntilIdle();
+  EXPECT_TRUE(run_order_.empty());
+
+  queue->SetQueueEnabled(true);
+  task_runner_->RunUntilIdle();
+  EXPECT_EQ((std::vector<std::string>{"a1"}), run_order_);
+}
+
+// Verify that a delayed task runs once its delay expires.
+TEST_F(SequenceManagerTest, DelayedTask) {
+  scoped_refptr<TaskQueue> queue = sequence_manager_->CreateTaskQueue("a");
+  constexpr TimeDelta kDelay = TimeDelta::FromMilliseconds(10);
+  EXPECT_TRUE(queue->PostDelayedTask(
+      FROM_HERE, BindOnce(&RecordRun, &run_order_, "delayed"), kDelay));
+  PostRecordRun(queue.get(), "immediate");
+
+  task_runner_->FastForwardBy(kDelay - TimeDelta::FromMilliseconds(1));
+  EXPECT_EQ((std::vector<std::string>{"immediate"}), run_order_);
+
+  task_runner_->FastForwardBy(TimeDelta::FromMilliseconds(1));
+  EXPECT_EQ((std::vector<std::string>{"immediate", "delayed"}), run_order_);
+}
+
+// Verify that tasks posted to a queue which was shut down don't run.
+TEST_F(SequenceManagerTest, ShutdownTaskQueue) {
+  scoped_refptr<TaskQueue> queue = sequence_manager_->CreateTaskQueue("a");
+  PostRecordRun(queue.get(), "a1");
+
+  queue->ShutdownTaskQueue();
+  EXPECT_FALSE(queue->PostTask(
+      FROM_HERE, BindOnce(&RecordRun, &run_order_, "a2")));
+  task_runner_->RunUntilIdle();
+
+  EXPECT_TRUE(run_order_.empty());
+}
+
+// Verify that a queue which ran out of CPU budget lets a queue of lower
+// priority run, and runs again once its budget recovers.
+TEST(SequenceManagerCpuBudgetTest, ThrottledQueueYieldsUntilBudgetRecovers) {
+  auto task_runner = MakeRefCounted<TestMockTimeTaskRunner>();
+  SimpleTestTickClock clock;
+  SequenceManager sequence_manager(task_runner, &clock);
+  std::vector<std::string> run_order;
+
+  scoped_refptr<TaskQueue> throttled_queue =
+      sequence_manager.CreateTaskQueue("throttled");
+  throttled_queue->SetCpuBudget(0.5, TimeDelta());
+  scoped_refptr<TaskQueue> low_queue = sequence_manager.CreateTaskQueue("low");
+  low_queue->SetQueuePriority(TaskQueue::kLowPriority);
+
+  // Each throttled task runs for 10 ms, during which the budget grows by 5 ms,
+  // so the budget drops from 0 to -5 ms.
+  constexpr TimeDelta kRunTime = TimeDelta::FromMilliseconds(10);
+  for (const char* label : {"throttled1", "throttled2"}) {
+    throttled_queue->PostTask(
+        FROM_HERE, BindOnce(&RecordRunAndAdvanceClock, &run_order, label,
+                            &clock, kRunTime));
+  }
+  low_queue->PostTask(FROM_HERE, BindOnce(&RecordRun, &run_order, "low"));
+
+  task_runner->RunUntilIdle();
+  EXPECT_EQ((std::vector<std::string>{"throttled1", "low"}), run_order);
+
+  // The budget recovers after 5 ms / 0.5 = 10 ms, when a wake-up is due. The
+  // queue thus gets half of the thread's time.
+  ASSERT_TRUE(task_runner->HasPendingTask());
+  EXPECT_EQ(kRunTime, task_runner->NextPendingTaskDelay());
+  clock.Advance(kRunTime);
+  task_runner->FastForwardBy(task_runner->NextPendingTaskDelay());
+  EXPECT_EQ((std::vector<std::string>{"throttled1", "low", "throttled2"}),
+            run_order);
+}
+
+}  // namespace sequence_manager
+}  // namespace base
@@ -0,0 +1,191 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/sequence_manager/task_queue.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/task/sequence_manager/sequence_manager.h"
+
+namespace base {
+namespace sequence_manager {
+
+TaskQueue::TaskQueue(SequenceManager* sequence_manager,
+                     scoped_refptr<SingleThreadTaskRunner> thread_task_runner,
+                     const char* name)
+    : name_(name),
+      thread_task_runner_(std::move(thread_task_runner)),
+      sequence_manager_(sequence_manager) {
+  DCHECK(sequence_manager_);
+}
+
+TaskQueue::~TaskQueue() = default;
+
+bool TaskQueue::PostDelayedTask(const Location& from_here,
+                                OnceClosure task,
+                                TimeDelta delay) {
+  return PostTaskImpl(from_here, std::move(task), delay, Nestable::kNestable);
+}
+
+bool TaskQueue::PostNonNestableDelayedTask(const Location& from_here,
+                                           OnceClosure task,
+                                           TimeDelta delay) {
+  return PostTaskImpl(from_here, std::move(task), delay,
+                      Nestable::kNonNestable);
+}
+
+bool TaskQueue::RunsTasksInCurrentSequence() const {
+  return thread_task_runner_->RunsTasksInCurrentSequence();
+}
+
+void TaskQueue::SetQueuePriority(QueuePriority priority) {
+  DCHECK(RunsTasksInCurrentSequence());
+  DCHECK_LT(priority, kQueuePriorityCount);
+  priority_ = priority;
+  if (sequence_manager_)
+    sequence_manager_->ScheduleWork();
+}
+
+void TaskQueue::SetQueueEnabled(bool enabled) {
+  DCHECK(RunsTasksInCurrentSequence());
+  is_enabled_ = enabled;
+  if (enabled && sequence_manager_)
+    sequence_manager_->ScheduleWork();
+}
+
+void TaskQueue::SetCpuBudget(double cpu_fraction, TimeDelta max_budget) {
+  DCHECK(RunsTasksInCurrentSequence());
+  DCHECK_GT(cpu_fraction, 0.0);
+  DCHECK_LE(cpu_fraction, 1.0);
+  DCHECK_GE(max_budget, TimeDelta());
+  if (!sequence_manager_)
+    return;
+  has_cpu_budget_ = true;
+  cpu_fraction_ = cpu_fraction;
+  max_budget_ = max_budget;
+  budget_ = max_budget;
+  budget_update_time_ = sequence_manager_->NowTicks();
+  sequence_manager_->ScheduleWork();
+}
+
+void TaskQueue::RemoveCpuBudget() {
+  DCHECK(RunsTasksInCurrentSequence());
+  has_cpu_budget_ = false;
+  if (sequence_manager_)
+    sequence_manager_->ScheduleWork();
+}
+
+void TaskQueue::ShutdownTaskQueue() {
+  DCHECK(RunsTasksInCurrentSequence());
+  if (!sequence_manager_)
+    return;
+
+  // Delete the tasks outside of |lock_|, as deleting them may post tasks.
+  base::queue<PendingTask> immediate_incoming_queue;
+  DelayedTaskQueue delayed_incoming_queue;
+  base::queue<PendingTask> work_queue;
+  work_queue.swap(work_queue_);
+  SequenceManager* const sequence_manager = sequence_manager_;
+  {
+    AutoLock auto_lock(lock_);
+    immediate_incoming_queue.swap(immediate_incoming_queue_);
+    delayed_incoming_queue.swap(delayed_incoming_queue_);
+    sequence_manager_ = nullptr;
+  }
+  sequence_manager->UnregisterTaskQueue(this);
+}
+
+bool TaskQueue::PostTaskImpl(const Location& from_here,
+                             OnceClosure task,
+                             TimeDelta delay,
+                             Nestable nestable) {
+  DCHECK(task);
+  PendingTask pending_task(from_here, std::move(task), TimeTicks(), nestable);
+  {
+    AutoLock auto_lock(lock_);
+    if (!sequence_manager_)
+      return false;
+
+    pending_task.sequence_num = sequence_manager_->GetNextSequenceNumber();
+    if (delay > TimeDelta()) {
+      pending_task.delayed_run_time = sequence_manager_->NowTicks() + delay;
+      sequence_manager_->DidQueueTask(pending_task);
+      delayed_incoming_queue_.push(std::move(pending_task));
+    } else {
+      sequence_manager_->DidQueueTask(pending_task);
+      immediate_incoming_queue_.push(std::move(pending_task));
+    }
+
+    // A DoWork() task also picks the next wake-up, which a delayed task may
+    // move earlier.
+    sequence_manager_->ScheduleWork();
+  }
+  return true;
+}
+
+const PendingTask* TaskQueue::GetNextReadyTask(TimeTicks now) {
+  if (work_queue_.empty()) {
+    AutoLock auto_lock(lock_);
+    while (!delayed_incoming_queue_.empty() &&
+           delayed_incoming_queue_.top().delayed_run_time <= now) {
+      // The task is popped right after being moved out of the heap, so the
+      // heap stays valid.
+      PendingTask pending_task =
+          std::move(const_cast<PendingTask&>(delayed_incoming_queue_.top()));
+      delayed_incoming_queue_.pop();
+      // A delayed task is ordered, relative to other queues' tasks, from the
+      // time it became due rather than the time it was posted.
+      pending_task.sequence_num = sequence_manager_->GetNextSequenceNumber();
+      immediate_incoming_queue_.push(std::move(pending_task));
+    }
+    work_queue_.swap(immediate_incoming_queue_);
+  }
+  return work_queue_.empty() ? nullptr : &work_queue_.front();
+}
+
+PendingTask TaskQueue::TakeNextReadyTask() {
+  DCHECK(!work_queue_.empty());
+  PendingTask pending_task = std::move(work_queue_.front());
+  work_queue_.pop();
+  return pending_task;
+}
+
+TimeTicks TaskQueue::GetNextDelayedRunTime() const {
+  AutoLock auto_lock(lock_);
+  return delayed_incoming_queue_.empty()
+             ? TimeTicks::Max()
+             : delayed_incoming_queue_.top().delayed_run_time;
+}
+
+bool TaskQueue::IsOutOfCpuBudget(TimeTicks now, TimeTicks* recovery_time) {
+  if (!has_cpu_budget_)
+    return false;
+
+  // The gain is truncated to whole microseconds. Don't move
+  // |budget_update_time_| until some budget is gained, otherwise frequent
+  // updates would never gain any.
+  const TimeDelta budget_gain = TimeDelta::FromMicrosecondsD(
+      (now - budget_update_time_).InMicroseconds() * cpu_fraction_);
+  if (!budget_gain.is_zero()) {
+    budget_ = std::min(max_budget_, budget_ + budget_gain);
+    budget_update_time_ = now;
+  }
+  if (budget_ >= TimeDelta())
+    return false;
+
+  *recovery_time = now + TimeDelta::FromMicrosecondsD(std::ceil(
+                             -budget_.InMicroseconds() / cpu_fraction_));
+  return true;
+}
+
+void TaskQueue::ChargeCpuBudget(TimeDelta run_time) {
+  DCHECK(has_cpu_budget_);
+  budget_ -= run_time;
+}
+
+}  // namespace sequence_manager
+}  // namespace base
@@ -0,0 +1,159 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_SEQUENCE_MANAGER_TASK_QUEUE_H_
+#define BASE_TASK_SEQUENCE_MANAGER_TASK_QUEUE_H_
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/containers/queue.h"
+#include "base/location.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/pending_task.h"
+#include "base/single_thread_task_runner.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace sequence_manager {
+
+class SequenceManager;
+
+// A queue of tasks run by a SequenceManager on its thread. Tasks can be posted
+// to a TaskQueue from any thread; they run in posting order relative to other
+// tasks of the same queue. The SequenceManager picks which queue runs next
+// from the priority, enabled state and CPU budget of its queues, which are
+// controlled with the methods below. Those must be called on the
+// SequenceManager's thread.
+class BASE_EXPORT TaskQueue : public SingleThreadTaskRunner {
+ public:
+  // Queues of higher priority always run before queues of lower priority.
+  // Queues of the same priority run in the order in which their tasks were
+  // posted.
+  enum QueuePriority {
+    // For urgent work which must run before anything else on the thread.
+    kControlPriority,
+    kHighPriority,
+    kNormalPriority,
+    kLowPriority,
+    // Only runs when no other queue has work to run.
+    kBestEffortPriority,
+    kQueuePriorityCount,
+  };
+
+  // SingleThreadTaskRunner:
+  bool PostDelayedTask(const Location& from_here,
+                       OnceClosure task,
+                       TimeDelta delay) override;
+  bool PostNonNestableDelayedTask(const Location& from_here,
+                                  OnceClosure task,
+                                  TimeDelta delay) override;
+  bool RunsTasksInCurrentSequence() const override;
+
+  // Returns the name passed to SequenceManager::CreateTaskQueue().
+  const char* name() const { return name_; }
+
+  void SetQueuePriority(QueuePriority priority);
+  QueuePriority GetQueuePriority() const { return priority_; }
+
+  // Tasks of a disabled queue don't run, but can still be posted. They run
+  // once the queue is enabled again. Queues are enabled by default.
+  void SetQueueEnabled(bool enabled);
+  bool IsQueueEnabled() const { return is_enabled_; }
+
+  // Throttles this queue so that its tasks use no more than |cpu_fraction| of
+  // the thread's time, on average. The queue's budget grows by |cpu_fraction|
+  // of the wall time that elapses, up to |max_budget|, and shrinks by the run
+  // time of each of its tasks. While the budget is negative, the queue's tasks
+  // don't run. |max_budget| bounds how long a burst of tasks can run after the
+  // queue was idle. The budget starts full.
+  void SetCpuBudget(double cpu_fraction, TimeDelta max_budget);
+
+  // Stops throttling this queue.
+  void RemoveCpuBudget();
+
+  // Deletes the pending tasks of this queue and unregisters it from its
+  // SequenceManager. Tasks posted afterwards are deleted right away, and the
+  // post methods return false. Called automatically when the SequenceManager
+  // is deleted.
+  void ShutdownTaskQueue();
+
+ private:
+  friend class SequenceManager;
+
+  TaskQueue(SequenceManager* sequence_manager,
+            scoped_refptr<SingleThreadTaskRunner> thread_task_runner,
+            const char* name);
+  ~TaskQueue() override;
+
+  bool PostTaskImpl(const Location& from_here,
+                    OnceClosure task,
+                    TimeDelta delay,
+                    Nestable nestable);
+
+  // The methods below are used by |sequence_manager_| on its thread.
+
+  // Returns the next task of this queue which can run at |now|, or nullptr if
+  // there is none. Delayed tasks due by |now| are appended to the queue when
+  // its immediate tasks run out.
+  const PendingTask* GetNextReadyTask(TimeTicks now);
+
+  // Removes and returns the task last returned by GetNextReadyTask().
+  PendingTask TakeNextReadyTask();
+
+  // Returns the run time of the earliest delayed task of this queue which isn't
+  // due yet, or TimeTicks::Max() if there is none.
+  TimeTicks GetNextDelayedRunTime() const;
+
+  bool has_cpu_budget() const { return has_cpu_budget_; }
+
+  // Returns true if this queue is throttled and ran out of budget at |now|. If
+  // so, sets |*recovery_time| to when its budget becomes positive again.
+  bool IsOutOfCpuBudget(TimeTicks now, TimeTicks* recovery_time);
+
+  // Charges |run_time| against the budget of this queue.
+  void ChargeCpuBudget(TimeDelta run_time);
+
+  const char* const name_;
+  const scoped_refptr<SingleThreadTaskRunner> thread_task_runner_;
+
+  // Synchronizes access to |sequence_manager_| from threads other than the
+  // SequenceManager's, and to the incoming queues.
+  mutable Lock lock_;
+
+  // Null once ShutdownTaskQueue() was called. Only modified on the
+  // SequenceManager's thread, which can read it without |lock_|.
+  SequenceManager* sequence_manager_;
+
+  // Tasks posted without a delay, and delayed tasks which became due, that
+  // aren't in |work_queue_| yet. Protected by |lock_|.
+  base::queue<PendingTask> immediate_incoming_queue_;
+
+  // Delayed tasks which aren't in |immediate_incoming_queue_| yet, earliest
+  // first. Protected by |lock_|.
+  DelayedTaskQueue delayed_incoming_queue_;
+
+  // The tasks to run next. Swapped with |immediate_incoming_queue_| when empty,
+  // so that the lock is only taken once per batch of tasks. Only accessed on
+  // the SequenceManager's thread, as are the members below.
+  base::queue<PendingTask> work_queue_;
+
+  QueuePriority priority_ = kNormalPriority;
+  bool is_enabled_ = true;
+
+  // CPU budget state. See SetCpuBudget().
+  bool has_cpu_budget_ = false;
+  double cpu_fraction_ = 1.0;
+  TimeDelta max_budget_;
+  TimeDelta budget_;
+  TimeTicks budget_update_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskQueue);
+};
+
+}  // namespace sequence_manager
+}  // namespace base
+
+#endif  // BASE_TASK_SEQUENCE_MANAGER_TASK_QUEUE_H_
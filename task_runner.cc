@@ -8,6 +8,7 @@
 
 #include "base/compiler_specific.h"
 #include "base/logging.h"
+#include "base/sequenced_task_runner.h"
 #include "base/threading/post_task_and_reply_impl.h"
 
 namespace base {
@@ -23,6 +24,7 @@ class PostTaskAndReplyTaskRunner : public internal::PostTaskAndReplyImpl {
 
  private:
   bool PostTask(const Location& from_here, OnceClosure task) override;
+  bool PostsTo(const SequencedTaskRunner* task_runner) const override;
 
   // Non-owning.
   TaskRunner* destination_;
@@ -38,12 +40,25 @@ bool PostTaskAndReplyTaskRunner::PostTask(const Location& from_here,
   return destination_->PostTask(from_here, std::move(task));
 }
 
+bool PostTaskAndReplyTaskRunner::PostsTo(
+    const SequencedTaskRunner* task_runner) const {
+  return destination_ == task_runner;
+}
+
 }  // namespace
 
 bool TaskRunner::PostTask(const Location& from_here, OnceClosure task) {
   return PostDelayedTask(from_here, std::move(task), base::TimeDelta());
 }
 
+bool TaskRunner::PostTasks(const Location& from_here,
+                           std::vector<OnceClosure> tasks) {
+  bool all_posted = true;
+  for (OnceClosure& task : tasks)
+    all_posted &= PostTask(from_here, std::move(task));
+  return all_posted;
+}
+
 bool TaskRunner::PostTaskAndReply(const Location& from_here,
                                   OnceClosure task,
                                   OnceClosure reply) {
@@ -7,6 +7,8 @@
 
 #include <stddef.h>
 
+#include <vector>
+
 #include "base/base_export.h"
 #include "base/callback.h"
 #include "base/location.h"
@@ -70,6 +72,16 @@ class BASE_EXPORT TaskRunner
                                OnceClosure task,
                                base::TimeDelta delay) = 0;
 
+  // Posts each of |tasks| as if by PostTask(), in order. Returns true if all of
+  // the tasks may be run at some point in the future, and false if any of them
+  // definitely will not be run.
+  //
+  // Implementations may post the whole batch at a lower cost than posting each
+  // task separately, e.g. by taking their locks once. The default
+  // implementation simply calls PostTask() for each task.
+  virtual bool PostTasks(const Location& from_here,
+                         std::vector<OnceClosure> tasks);
+
   // Returns true iff tasks posted to this TaskRunner are sequenced
   // with this call.
   //
@@ -89,7 +101,9 @@ class BASE_EXPORT TaskRunner
   virtual bool RunsTasksInCurrentSequence() const = 0;
 
   // Posts |task| on the current TaskRunner.  On completion, |reply|
-  // is posted to the thread that called PostTaskAndReply().  Both
+  // is posted to the thread that called PostTaskAndReply(), or run
+  // right after |task| if this is that thread's SequencedTaskRunner
+  // (i.e. SequencedTaskRunnerHandle::Get()).  Both
   // |task| and |reply| are guaranteed to be deleted on the thread
   // from which PostTaskAndReply() is invoked.  This allows objects
   // that must be deleted on the originating thread to be bound into
@@ -37,13 +37,12 @@ bool PostTaskAndReplyWithResult(TaskRunner* task_runner,
                                 OnceCallback<void(ReplyArgType)> reply) {
   DCHECK(task);
   DCHECK(reply);
-  TaskReturnType* result = new TaskReturnType();
-  return task_runner->PostTaskAndReply(
-      from_here,
-      BindOnce(&internal::ReturnAsParamAdapter<TaskReturnType>, std::move(task),
-               result),
-      BindOnce(&internal::ReplyAdapter<TaskReturnType, ReplyArgType>,
-               std::move(reply), Owned(result)));
+  using Relay =
+      internal::PostTaskAndReplyWithResultRelay<TaskReturnType, ReplyArgType>;
+  return task_runner->PostTask(
+      from_here, BindOnce(&Relay::RunTaskAndPostReply,
+                          Relay(task_runner, from_here, std::move(task),
+                                std::move(reply))));
 }
 
 // Callback version of PostTaskAndReplyWithResult above.
@@ -28,6 +28,25 @@ void StoreDoubleValue(double* destination, double value) {
   *destination = value;
 }
 
+// A result type without a default constructor.
+class Wrapped {
+ public:
+  explicit Wrapped(int value) : value_(value) {}
+
+  int value() const { return value_; }
+
+ private:
+  int value_;
+};
+
+Wrapped ReturnWrappedFourtyTwo() {
+  return Wrapped(42);
+}
+
+void StoreWrappedValue(int* destination, Wrapped wrapped) {
+  *destination = wrapped.value();
+}
+
 int g_foo_destruct_count = 0;
 int g_foo_free_count = 0;
 
@@ -94,6 +113,19 @@ TEST(TaskRunnerHelpersTest, PostTaskAndReplyWithResultImplicitConvert) {
   EXPECT_DOUBLE_EQ(42.0, result);
 }
 
+TEST(TaskRunnerHelpersTest, PostTaskAndReplyWithResultNotDefaultConstructible) {
+  int result = 0;
+
+  MessageLoop message_loop;
+  PostTaskAndReplyWithResult(message_loop.task_runner().get(), FROM_HERE,
+                             BindOnce(&ReturnWrappedFourtyTwo),
+                             BindOnce(&StoreWrappedValue, &result));
+
+  RunLoop().RunUntilIdle();
+
+  EXPECT_EQ(42, result);
+}
+
 TEST(TaskRunnerHelpersTest, PostTaskAndReplyWithResultPassed) {
   g_foo_destruct_count = 0;
   g_foo_free_count = 0;
@@ -122,4 +154,28 @@ TEST(TaskRunnerHelpersTest, PostTaskAndReplyWithResultPassedFreeProc) {
   EXPECT_EQ(1, g_foo_free_count);
 }
 
+// The reply runs right after the task when both run on the same sequence.
+TEST(TaskRunnerHelpersTest, PostTaskAndReplyWithResultSameSequence) {
+  int result = 0;
+  bool other_task_ran = false;
+
+  MessageLoop message_loop;
+  PostTaskAndReplyWithResult(
+      message_loop.task_runner().get(), FROM_HERE, BindOnce(&ReturnFourtyTwo),
+      BindOnce(
+          [](int* result, bool* other_task_ran, int value) {
+            EXPECT_FALSE(*other_task_ran);
+            *result = value;
+          },
+          &result, &other_task_ran));
+  message_loop.task_runner()->PostTask(
+      FROM_HERE, BindOnce([](bool* other_task_ran) { *other_task_ran = true; },
+                          &other_task_ran));
+
+  RunLoop().RunUntilIdle();
+
+  EXPECT_EQ(42, result);
+  EXPECT_TRUE(other_task_ran);
+}
+
 }  // namespace base
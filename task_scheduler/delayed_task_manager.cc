@@ -7,6 +7,7 @@
 #include <algorithm>
 
 #include "base/bind.h"
+#include "base/compiler_specific.h"
 #include "base/logging.h"
 #include "base/task_runner.h"
 #include "base/task_scheduler/task.h"
@@ -14,6 +15,19 @@
 namespace base {
 namespace internal {
 
+namespace {
+
+// Forwards a task ripe on a virtual clock, which may be before its
+// |delayed_run_time| on the real clock.
+void PostVirtualTimeTaskNow(
+    DelayedTaskManager::PostTaskNowCallback post_task_now_callback,
+    Task task) {
+  task.delayed_run_time = TimeTicks::Now();
+  std::move(post_task_now_callback).Run(std::move(task));
+}
+
+}  // namespace
+
 DelayedTaskManager::DelayedTaskManager(
     std::unique_ptr<const TickClock> tick_clock)
     : tick_clock_(std::move(tick_clock)) {
@@ -24,6 +38,17 @@ DelayedTaskManager::~DelayedTaskManager() = default;
 
 void DelayedTaskManager::Start(
     scoped_refptr<TaskRunner> service_thread_task_runner) {
+  StartInternal(std::move(service_thread_task_runner), false);
+}
+
+void DelayedTaskManager::StartWithVirtualTimeForTesting(
+    scoped_refptr<TaskRunner> delayed_task_runner) {
+  StartInternal(std::move(delayed_task_runner), true);
+}
+
+void DelayedTaskManager::StartInternal(
+    scoped_refptr<TaskRunner> service_thread_task_runner,
+    bool virtual_time) {
   DCHECK(service_thread_task_runner);
 
   decltype(tasks_added_before_start_) tasks_added_before_start;
@@ -33,6 +58,7 @@ void DelayedTaskManager::Start(
     DCHECK(!service_thread_task_runner_);
     DCHECK(!started_.IsSet());
     service_thread_task_runner_ = std::move(service_thread_task_runner);
+    virtual_time_ = virtual_time;
     tasks_added_before_start = std::move(tasks_added_before_start_);
     // |service_thread_task_runner_| must not change after |started_| is set
     // (cf. comment above |lock_| in header file).
@@ -86,6 +112,10 @@ void DelayedTaskManager::AddDelayedTaskNow(
   DCHECK(started_.IsSet());
   // TODO(fdoray): Use |task->delayed_run_time| on the service thread
   // MessageLoop rather than recomputing it from |delay|.
+  if (UNLIKELY(virtual_time_)) {
+    post_task_now_callback =
+        BindOnce(&PostVirtualTimeTaskNow, std::move(post_task_now_callback));
+  }
   service_thread_task_runner_->PostDelayedTask(
       FROM_HERE, BindOnce(std::move(post_task_now_callback), std::move(task)),
       delay);
@@ -46,11 +46,20 @@ class BASE_EXPORT DelayedTaskManager {
   // thread.
   void Start(scoped_refptr<TaskRunner> service_thread_task_runner);
 
+  // Same as Start(), except that the delays are timed by
+  // |delayed_task_runner|, on a virtual clock. The tasks may then become ripe
+  // before their |delayed_run_time|, which is reset to when they do.
+  void StartWithVirtualTimeForTesting(
+      scoped_refptr<TaskRunner> delayed_task_runner);
+
   // Schedules a call to |post_task_now_callback| with |task| as argument when
   // |task| is ripe for execution and Start() has been called.
   void AddDelayedTask(Task task, PostTaskNowCallback post_task_now_callback);
 
  private:
+  void StartInternal(scoped_refptr<TaskRunner> service_thread_task_runner,
+                     bool virtual_time);
+
   // Schedules a call to |post_task_now_callback| with |task| as argument when
   // |delay| expires. Start() must have been called before this.
   void AddDelayedTaskNow(Task task,
@@ -63,12 +72,15 @@ class BASE_EXPORT DelayedTaskManager {
 
   // Synchronizes access to all members below before |started_| is set. Once
   // |started_| is set:
-  // - |service_thread_task_runner| doest not change, so it can be read without
-  //   holding the lock.
+  // - |service_thread_task_runner| and |virtual_time_| do not change, so they
+  //   can be read without holding the lock.
   // - |tasks_added_before_start_| isn't accessed anymore.
   SchedulerLock lock_;
 
   scoped_refptr<TaskRunner> service_thread_task_runner_;
+  // Set by StartWithVirtualTimeForTesting(). Doesn't change once |started_| is
+  // set either.
+  bool virtual_time_ = false;
   std::vector<std::pair<Task, PostTaskNowCallback>> tasks_added_before_start_;
 
   DISALLOW_COPY_AND_ASSIGN(DelayedTaskManager);
@@ -0,0 +1,119 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task_scheduler/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/sys_info.h"
+#include "base/task_scheduler/post_task.h"
+
+namespace base {
+
+namespace {
+
+// State shared by the calling thread and the helper tasks of a ParallelFor().
+class ParallelForState : public RefCountedThreadSafe<ParallelForState> {
+ public:
+  ParallelForState(size_t begin,
+                   size_t end,
+                   size_t grain_size,
+                   RepeatingCallback<void(size_t, size_t)> fn)
+      : begin_(begin),
+        end_(end),
+        grain_size_(grain_size),
+        num_chunks_((end - begin + grain_size - 1) / grain_size),
+        num_remaining_chunks_(num_chunks_),
+        fn_(std::move(fn)) {}
+
+  size_t num_chunks() const { return num_chunks_; }
+
+  // Runs chunks until none are left to claim.
+  void RunChunks() {
+    for (size_t chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed);
+         chunk < num_chunks_;
+         chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed)) {
+      const size_t chunk_begin = begin_ + chunk * grain_size_;
+      fn_.Run(chunk_begin, std::min(chunk_begin + grain_size_, end_));
+      if (num_remaining_chunks_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        all_chunks_done_.Signal();
+    }
+  }
+
+  // Waits until all chunks have run, on any thread.
+  void WaitForAllChunks() {
+    if (num_remaining_chunks_.load(std::memory_order_acquire) != 0)
+      all_chunks_done_.Wait();
+  }
+
+ private:
+  friend class RefCountedThreadSafe<ParallelForState>;
+
+  ~ParallelForState() = default;
+
+  const size_t begin_;
+  const size_t end_;
+  const size_t grain_size_;
+  const size_t num_chunks_;
+
+  // The next chunk to claim. Increments past |num_chunks_| once all chunks are
+  // claimed, at most once per thread running chunks.
+  std::atomic<size_t> next_chunk_{0};
+
+  // The number of chunks which haven't finished running.
+  std::atomic<size_t> num_remaining_chunks_;
+
+  const RepeatingCallback<void(size_t, size_t)> fn_;
+
+  WaitableEvent all_chunks_done_{WaitableEvent::ResetPolicy::MANUAL,
+                                 WaitableEvent::InitialState::NOT_SIGNALED};
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelForState);
+};
+
+}  // namespace
+
+void ParallelFor(const Location& from_here,
+                 const TaskTraits& traits,
+                 size_t begin,
+                 size_t end,
+                 size_t grain_size,
+                 RepeatingCallback<void(size_t, size_t)> fn) {
+  DCHECK_GT(grain_size, 0u);
+  if (begin >= end)
+    return;
+
+  // A single chunk isn't worth a thread hop.
+  if (end - begin <= grain_size) {
+    fn.Run(begin, end);
+    return;
+  }
+
+  auto state = MakeRefCounted<ParallelForState>(begin, end, grain_size,
+                                                std::move(fn));
+
+  // Helpers beyond the number of cores, or of chunks besides the one the
+  // calling thread takes, would only find the work done.
+  const size_t num_helpers =
+      std::min(state->num_chunks() - 1,
+               static_cast<size_t>(SysInfo::NumberOfEffectiveProcessors()) - 1);
+  if (num_helpers > 0) {
+    std::vector<OnceClosure> helpers;
+    helpers.reserve(num_helpers);
+    for (size_t i = 0; i < num_helpers; ++i)
+      helpers.push_back(BindOnce(&ParallelForState::RunChunks, state));
+    PostTasksWithTraits(from_here, traits, std::move(helpers));
+  }
+
+  state->RunChunks();
+  state->WaitForAllChunks();
+}
+
+}  // namespace base
@@ -0,0 +1,105 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_SCHEDULER_PARALLEL_FOR_H_
+#define BASE_TASK_SCHEDULER_PARALLEL_FOR_H_
+
+#include <stddef.h>
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/task_scheduler/task_traits.h"
+
+namespace base {
+
+// Data-parallel loops on top of the TaskScheduler.
+//
+// ParallelFor() splits [begin, end) into chunks of |grain_size| indices (the
+// last one may be shorter) and calls |fn| once per chunk with the chunk's
+// [chunk_begin, chunk_end). Chunks are handed out dynamically, one at a time,
+// to the calling thread and to helper tasks posted with |traits|, so uneven
+// chunks balance out. ParallelFor() returns once every chunk has run. The
+// calling thread runs chunks itself rather than idling, so this completes even
+// if no helper task ever gets to run.
+//
+// Pick |grain_size| so that a chunk is worth at least a few microseconds of
+// work; each chunk costs an atomic operation and a callback invocation.
+// |traits| determine the priority of the helper tasks and whether they may
+// block; chunks run by the calling thread inherit its own. |fn| may run on
+// several threads at once, and must be thread-safe accordingly. |fn| is
+// destroyed on an arbitrary thread, possibly after ParallelFor() returns, but
+// is never run after ParallelFor() returns.
+//
+// The calling thread waits for chunks running on other threads, so it must be
+// allowed to wait (see ScopedAllowBaseSyncPrimitives). A TaskScheduler must be
+// registered (see post_task.h), unless the range fits in a single chunk.
+//
+// Example:
+//   std::vector<uint32_t> hashes(inputs.size());
+//   ParallelFor(FROM_HERE, {TaskPriority::USER_VISIBLE}, 0, inputs.size(), 64,
+//               BindRepeating(
+//                   [](const std::vector<std::string>* inputs,
+//                      std::vector<uint32_t>* hashes, size_t begin,
+//                      size_t end) {
+//                     for (size_t i = begin; i < end; ++i)
+//                       (*hashes)[i] = PersistentHash((*inputs)[i]);
+//                   },
+//                   &inputs, &hashes));
+BASE_EXPORT void ParallelFor(
+    const Location& from_here,
+    const TaskTraits& traits,
+    size_t begin,
+    size_t end,
+    size_t grain_size,
+    RepeatingCallback<void(size_t chunk_begin, size_t chunk_end)> fn);
+
+// Like ParallelFor(), but |map| returns a value for each chunk and the values
+// are folded, starting from |identity|, with |combine|. Values are combined in
+// chunk order on the calling thread, so |combine| needn't be commutative nor
+// thread-safe, and the result doesn't depend on how chunks were scheduled.
+template <typename T>
+T ParallelReduce(const Location& from_here,
+                 const TaskTraits& traits,
+                 size_t begin,
+                 size_t end,
+                 size_t grain_size,
+                 T identity,
+                 RepeatingCallback<T(size_t chunk_begin, size_t chunk_end)> map,
+                 RepeatingCallback<T(T, T)> combine) {
+  // Chunks store their results concurrently, which std::vector<bool> can't do.
+  static_assert(!std::is_same<T, bool>::value,
+                "ParallelReduce() doesn't support bool results.");
+  DCHECK_GT(grain_size, 0u);
+  if (begin >= end)
+    return identity;
+
+  const size_t num_chunks = (end - begin + grain_size - 1) / grain_size;
+  std::vector<T> chunk_results(num_chunks, identity);
+  ParallelFor(
+      from_here, traits, begin, end, grain_size,
+      BindRepeating(
+          [](const RepeatingCallback<T(size_t, size_t)>& map,
+             std::vector<T>* chunk_results, size_t range_begin,
+             size_t grain_size, size_t chunk_begin, size_t chunk_end) {
+            (*chunk_results)[(chunk_begin - range_begin) / grain_size] =
+                map.Run(chunk_begin, chunk_end);
+          },
+          std::move(map), Unretained(&chunk_results), begin, grain_size));
+
+  T result = std::move(identity);
+  for (T& chunk_result : chunk_results)
+    result = combine.Run(std::move(result), std::move(chunk_result));
+  return result;
+}
+
+}  // namespace base
+
+#endif  // BASE_TASK_SCHEDULER_PARALLEL_FOR_H_
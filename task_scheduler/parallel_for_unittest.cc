@@ -0,0 +1,101 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task_scheduler/parallel_for.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "base/bind.h"
+#include "base/macros.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/scoped_task_environment.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class TaskSchedulerParallelForTest : public testing::Test {
+ protected:
+  TaskSchedulerParallelForTest() = default;
+
+  test::ScopedTaskEnvironment scoped_task_environment_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TaskSchedulerParallelForTest);
+};
+
+}  // namespace
+
+TEST_F(TaskSchedulerParallelForTest, RunsEachIndexOnce) {
+  constexpr size_t kSize = 10010;
+  std::unique_ptr<std::atomic_int[]> num_runs(new std::atomic_int[kSize]);
+  for (size_t i = 0; i < kSize; ++i)
+    num_runs[i] = 0;
+
+  ParallelFor(FROM_HERE, {TaskPriority::USER_BLOCKING}, 3, kSize - 7, 7,
+              BindRepeating(
+                  [](std::atomic_int* num_runs, size_t begin, size_t end) {
+                    EXPECT_LT(begin, end);
+                    EXPECT_LE(end - begin, 7u);
+                    for (size_t i = begin; i < end; ++i)
+                      ++num_runs[i];
+                  },
+                  num_runs.get()));
+
+  for (size_t i = 0; i < kSize; ++i)
+    EXPECT_EQ(i >= 3 && i < kSize - 7 ? 1 : 0, num_runs[i].load()) << i;
+}
+
+TEST_F(TaskSchedulerParallelForTest, EmptyRange) {
+  ParallelFor(FROM_HERE, TaskTraits(), 5, 5, 1,
+              BindRepeating([](size_t begin, size_t end) {
+                ADD_FAILURE() << "Ran a chunk of an empty range.";
+              }));
+}
+
+TEST_F(TaskSchedulerParallelForTest, SingleChunkRunsOnCallingThread) {
+  const PlatformThreadRef calling_thread = PlatformThread::CurrentRef();
+  int num_chunks = 0;
+  ParallelFor(FROM_HERE, TaskTraits(), 0, 100, 100,
+              BindRepeating(
+                  [](PlatformThreadRef calling_thread, int* num_chunks,
+                     size_t begin, size_t end) {
+                    EXPECT_EQ(calling_thread, PlatformThread::CurrentRef());
+                    EXPECT_EQ(0u, begin);
+                    EXPECT_EQ(100u, end);
+                    ++*num_chunks;
+                  },
+                  calling_thread, &num_chunks));
+  EXPECT_EQ(1, num_chunks);
+}
+
+TEST_F(TaskSchedulerParallelForTest, Reduce) {
+  const uint64_t sum = ParallelReduce<uint64_t>(
+      FROM_HERE, {TaskPriority::USER_VISIBLE}, 1, 100001, 64, 0,
+      BindRepeating([](size_t begin, size_t end) {
+        uint64_t sum = 0;
+        for (size_t i = begin; i < end; ++i)
+          sum += i;
+        return sum;
+      }),
+      BindRepeating([](uint64_t a, uint64_t b) { return a + b; }));
+  EXPECT_EQ(uint64_t{100000} * 100001 / 2, sum);
+}
+
+// Chunk results are combined in order, whatever order the chunks ran in.
+TEST_F(TaskSchedulerParallelForTest, ReduceCombinesInChunkOrder) {
+  const std::string result = ParallelReduce<std::string>(
+      FROM_HERE, TaskTraits(), 0, 10, 3, "[",
+      BindRepeating([](size_t begin, size_t end) {
+        return NumberToString(begin) + "-" + NumberToString(end) + " ";
+      }),
+      BindRepeating([](std::string a, std::string b) { return a + b; }));
+  EXPECT_EQ("[0-3 3-6 6-9 9-10 ", result);
+}
+
+}  // namespace base
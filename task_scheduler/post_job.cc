@@ -0,0 +1,215 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task_scheduler/post_job.h"
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/task_scheduler/post_task.h"
+#include "base/task_scheduler/scheduler_worker_pool.h"
+
+namespace base {
+namespace internal {
+
+// State shared by the JobHandle and the worker tasks of a job.
+class JobState : public RefCountedThreadSafe<JobState> {
+ public:
+  JobState(const Location& from_here,
+           const TaskTraits& traits,
+           RepeatingCallback<void(JobDelegate*)> worker_task,
+           RepeatingCallback<size_t()> max_concurrency_callback)
+      : from_here_(from_here),
+        traits_(traits),
+        worker_task_(std::move(worker_task)),
+        max_concurrency_callback_(std::move(max_concurrency_callback)) {}
+
+  // Posts worker tasks until as many are posted or running as
+  // |max_concurrency_callback_| asks for.
+  void PostWorkersIfNeeded() {
+    const size_t max_concurrency = max_concurrency_callback_.Run();
+    size_t num_workers_to_post;
+    {
+      AutoLock auto_lock(lock_);
+      num_workers_to_post = NumWorkersToPostLockRequired(max_concurrency);
+    }
+    PostWorkers(num_workers_to_post);
+  }
+
+  bool ShouldYield() const {
+    return is_canceled_.load(std::memory_order_relaxed) ||
+           SchedulerWorkerPool::ShouldYieldFromCurrentThread(
+               traits_.priority());
+  }
+
+  // Worker tasks which are already posted return without running
+  // |worker_task_| once they get to run.
+  void Cancel() { is_canceled_.store(true, std::memory_order_relaxed); }
+
+  void Join() {
+    while (true) {
+      {
+        AutoLock auto_lock(lock_);
+        while (num_workers_ > 0)
+          worker_released_cv_.Wait();
+        if (is_canceled_.load(std::memory_order_relaxed))
+          return;
+      }
+      // No worker is posted, so the job is done unless it got more work
+      // without a call to NotifyConcurrencyIncrease().
+      if (max_concurrency_callback_.Run() == 0)
+        return;
+      PostWorkersIfNeeded();
+    }
+  }
+
+ private:
+  friend class RefCountedThreadSafe<JobState>;
+
+  ~JobState() = default;
+
+  // Returns the number of worker tasks to post to reach |max_concurrency|, and
+  // counts them as posted.
+  size_t NumWorkersToPostLockRequired(size_t max_concurrency) {
+    lock_.AssertAcquired();
+    if (is_canceled_.load(std::memory_order_relaxed) ||
+        max_concurrency <= num_workers_) {
+      return 0;
+    }
+    const size_t num_workers_to_post = max_concurrency - num_workers_;
+    num_workers_ += num_workers_to_post;
+    return num_workers_to_post;
+  }
+
+  void PostWorkers(size_t num_workers_to_post) {
+    if (num_workers_to_post == 0)
+      return;
+    std::vector<OnceClosure> workers;
+    workers.reserve(num_workers_to_post);
+    for (size_t i = 0; i < num_workers_to_post; ++i) {
+      // If the worker task is deleted without running, e.g. on shutdown, the
+      // ScopedClosureRunner releases its slot so that Join() doesn't hang.
+      workers.push_back(BindOnce(
+          &JobState::RunWorker, this,
+          ScopedClosureRunner(BindOnce(&JobState::ReleaseWorker, this))));
+    }
+    PostTasksWithTraits(from_here_, traits_, std::move(workers));
+  }
+
+  void RunWorker(ScopedClosureRunner release_worker) {
+    ignore_result(release_worker.Release());
+
+    if (!is_canceled_.load(std::memory_order_relaxed)) {
+      JobDelegate delegate(this);
+      worker_task_.Run(&delegate);
+    }
+
+    // Reposting from here rather than looping in place puts the job behind
+    // Sequences of higher priority that were posted in the meantime.
+    const size_t max_concurrency = max_concurrency_callback_.Run();
+    size_t num_workers_to_post;
+    {
+      AutoLock auto_lock(lock_);
+      DCHECK_GT(num_workers_, 0U);
+      --num_workers_;
+      num_workers_to_post = NumWorkersToPostLockRequired(max_concurrency);
+      if (num_workers_ == 0)
+        worker_released_cv_.Broadcast();
+    }
+    PostWorkers(num_workers_to_post);
+  }
+
+  void ReleaseWorker() {
+    AutoLock auto_lock(lock_);
+    DCHECK_GT(num_workers_, 0U);
+    --num_workers_;
+    if (num_workers_ == 0)
+      worker_released_cv_.Broadcast();
+  }
+
+  const Location from_here_;
+  const TaskTraits traits_;
+  const RepeatingCallback<void(JobDelegate*)> worker_task_;
+  const RepeatingCallback<size_t()> max_concurrency_callback_;
+
+  // Synchronizes access to |num_workers_|.
+  Lock lock_;
+
+  // Signaled when |num_workers_| reaches 0.
+  ConditionVariable worker_released_cv_{&lock_};
+
+  // Number of worker tasks that are posted or running.
+  size_t num_workers_ = 0;
+
+  // Set by Cancel().
+  std::atomic<bool> is_canceled_{false};
+
+  DISALLOW_COPY_AND_ASSIGN(JobState);
+};
+
+}  // namespace internal
+
+JobDelegate::JobDelegate(internal::JobState* job_state)
+    : job_state_(job_state) {
+  DCHECK(job_state_);
+}
+
+JobDelegate::~JobDelegate() = default;
+
+bool JobDelegate::ShouldYield() {
+  return job_state_->ShouldYield();
+}
+
+void JobDelegate::NotifyConcurrencyIncrease() {
+  job_state_->PostWorkersIfNeeded();
+}
+
+JobHandle::JobHandle() = default;
+
+JobHandle::JobHandle(scoped_refptr<internal::JobState> job_state)
+    : job_state_(std::move(job_state)) {}
+
+JobHandle::JobHandle(JobHandle&&) = default;
+
+JobHandle& JobHandle::operator=(JobHandle&&) = default;
+
+JobHandle::~JobHandle() = default;
+
+void JobHandle::NotifyConcurrencyIncrease() {
+  DCHECK(job_state_);
+  job_state_->PostWorkersIfNeeded();
+}
+
+void JobHandle::Cancel() {
+  DCHECK(job_state_);
+  job_state_->Cancel();
+}
+
+void JobHandle::Join() {
+  DCHECK(job_state_);
+  job_state_->Join();
+  job_state_ = nullptr;
+}
+
+JobHandle PostJob(const Location& from_here,
+                  const TaskTraits& traits,
+                  RepeatingCallback<void(JobDelegate*)> worker_task,
+                  RepeatingCallback<size_t()> max_concurrency_callback) {
+  DCHECK(worker_task);
+  DCHECK(max_concurrency_callback);
+  auto job_state = MakeRefCounted<internal::JobState>(
+      from_here, traits, std::move(worker_task),
+      std::move(max_concurrency_callback));
+  job_state->PostWorkersIfNeeded();
+  return JobHandle(std::move(job_state));
+}
+
+}  // namespace base
@@ -0,0 +1,129 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_SCHEDULER_POST_JOB_H_
+#define BASE_TASK_SCHEDULER_POST_JOB_H_
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/location.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/task_scheduler/task_traits.h"
+
+namespace base {
+
+namespace internal {
+class JobState;
+}  // namespace internal
+
+// Jobs run large, divisible work on as many TaskScheduler workers as the work
+// can use, without posting a task per work item.
+//
+// A job is made of a |worker_task| and a |max_concurrency_callback|. The
+// scheduler keeps up to |max_concurrency_callback|.Run() instances of
+// |worker_task| posted or running at once, each on its own worker, so idle
+// workers pick up the job, and workers which the pool adds when others block
+// (see ScopedBlockingCall) pick it up too. |worker_task| should process work
+// items until none are left or until JobDelegate::ShouldYield() returns true,
+// then return. When a |worker_task| returns, the job is posted again as long
+// as |max_concurrency_callback| asks for more workers; the new worker task
+// goes behind any Sequence of higher priority in the pool, which is how a job
+// yields at priority boundaries.
+//
+// |max_concurrency_callback| must return the number of workers that could
+// usefully run |worker_task| right now, which should usually be the number of
+// remaining work items, capped as needed. It must return 0 once all work is
+// done, otherwise the job never completes. It's called on arbitrary threads,
+// as is |worker_task|; both must be thread-safe.
+//
+// Example:
+//   JobHandle handle = PostJob(
+//       FROM_HERE, {TaskPriority::USER_VISIBLE},
+//       BindRepeating(
+//           [](WorkQueue* queue, JobDelegate* delegate) {
+//             while (!delegate->ShouldYield()) {
+//               Optional<WorkItem> item = queue->TakeItem();
+//               if (!item)
+//                 return;
+//               ProcessItem(*item);
+//             }
+//           },
+//           Unretained(&queue)),
+//       BindRepeating(&WorkQueue::NumRemainingItems, Unretained(&queue)));
+//   ...
+//   handle.Join();
+
+// Passed to the |worker_task| of a job to communicate with the scheduler.
+class BASE_EXPORT JobDelegate {
+ public:
+  explicit JobDelegate(internal::JobState* job_state);
+  ~JobDelegate();
+
+  // Returns true if the current |worker_task| should return as soon as
+  // possible: because the job was canceled, or because a Sequence of higher
+  // priority than the job is waiting in the worker's pool. Each call may
+  // acquire a lock, so call this between work items rather than within them.
+  bool ShouldYield();
+
+  // Lets the scheduler know that |max_concurrency_callback| may now return a
+  // larger value, e.g. because new work items were produced, so that more
+  // workers are put to work on the job.
+  void NotifyConcurrencyIncrease();
+
+ private:
+  internal::JobState* const job_state_;
+
+  DISALLOW_COPY_AND_ASSIGN(JobDelegate);
+};
+
+// Controls a job posted with PostJob(). Destroying a JobHandle doesn't affect
+// the job, which keeps running until its work is done.
+class BASE_EXPORT JobHandle {
+ public:
+  JobHandle();
+  // Used by PostJob().
+  explicit JobHandle(scoped_refptr<internal::JobState> job_state);
+  JobHandle(JobHandle&&);
+  JobHandle& operator=(JobHandle&&);
+  ~JobHandle();
+
+  // Returns true if this refers to a job.
+  explicit operator bool() const { return job_state_ != nullptr; }
+
+  // Same as JobDelegate::NotifyConcurrencyIncrease(), for use from outside the
+  // job.
+  void NotifyConcurrencyIncrease();
+
+  // Prevents new instances of |worker_task| from starting, and makes
+  // JobDelegate::ShouldYield() return true in the running ones. Doesn't wait
+  // for running instances to return.
+  void Cancel();
+
+  // Waits until no instance of |worker_task| is posted or running and
+  // |max_concurrency_callback| returns 0, or until the job is canceled and all
+  // running instances returned. The calling thread must be allowed to wait
+  // (see ScopedAllowBaseSyncPrimitives). Invalidates this JobHandle.
+  void Join();
+
+ private:
+  scoped_refptr<internal::JobState> job_state_;
+
+  DISALLOW_COPY_AND_ASSIGN(JobHandle);
+};
+
+// Posts a job made of |worker_task| and |max_concurrency_callback|, whose
+// worker tasks are posted with |traits|. A TaskScheduler must be registered
+// (see post_task.h).
+BASE_EXPORT JobHandle
+PostJob(const Location& from_here,
+        const TaskTraits& traits,
+        RepeatingCallback<void(JobDelegate*)> worker_task,
+        RepeatingCallback<size_t()> max_concurrency_callback);
+
+}  // namespace base
+
+#endif  // BASE_TASK_SCHEDULER_POST_JOB_H_
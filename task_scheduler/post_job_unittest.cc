@@ -0,0 +1,169 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task_scheduler/post_job.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "base/bind.h"
+#include "base/macros.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/test/scoped_task_environment.h"
+#include "base/test/test_timeouts.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kNumWorkItems = 1000;
+constexpr size_t kMaxConcurrency = 4;
+
+class TaskSchedulerPostJobTest : public testing::Test {
+ protected:
+  TaskSchedulerPostJobTest() = default;
+
+  test::ScopedTaskEnvironment scoped_task_environment_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TaskSchedulerPostJobTest);
+};
+
+// Work items shared by the worker tasks of a job.
+class WorkItems {
+ public:
+  explicit WorkItems(size_t num_items) : num_unclaimed_items_(num_items) {}
+
+  // Returns false if there was no item left to claim.
+  bool ClaimItem() {
+    size_t num_unclaimed_items = num_unclaimed_items_.load();
+    do {
+      if (num_unclaimed_items == 0)
+        return false;
+    } while (!num_unclaimed_items_.compare_exchange_weak(
+        num_unclaimed_items, num_unclaimed_items - 1));
+    return true;
+  }
+
+  size_t MaxConcurrency() const {
+    return std::min(num_unclaimed_items_.load(), kMaxConcurrency);
+  }
+
+ private:
+  std::atomic<size_t> num_unclaimed_items_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkItems);
+};
+
+}  // namespace
+
+// Verify that all work items of a job are processed, by no more than
+// max-concurrency worker tasks at once.
+TEST_F(TaskSchedulerPostJobTest, ProcessesAllItems) {
+  WorkItems work_items(kNumWorkItems);
+  std::atomic_size_t num_processed_items(0);
+  std::atomic_size_t num_running_workers(0);
+
+  JobHandle handle = PostJob(
+      FROM_HERE, {TaskPriority::USER_VISIBLE},
+      BindRepeating(
+          [](WorkItems* work_items, std::atomic_size_t* num_processed_items,
+             std::atomic_size_t* num_running_workers, JobDelegate* delegate) {
+            EXPECT_LE(++*num_running_workers, kMaxConcurrency);
+            while (!delegate->ShouldYield() && work_items->ClaimItem())
+              ++*num_processed_items;
+            --*num_running_workers;
+          },
+          Unretained(&work_items), Unretained(&num_processed_items),
+          Unretained(&num_running_workers)),
+      BindRepeating(&WorkItems::MaxConcurrency, Unretained(&work_items)));
+  EXPECT_TRUE(handle);
+  handle.Join();
+  EXPECT_FALSE(handle);
+
+  EXPECT_EQ(kNumWorkItems, num_processed_items.load());
+  EXPECT_EQ(0U, work_items.MaxConcurrency());
+}
+
+// Verify that a job whose worker tasks return after each item is reposted
+// until all work items are processed.
+TEST_F(TaskSchedulerPostJobTest, RepostsAfterYield) {
+  WorkItems work_items(kNumWorkItems);
+  std::atomic_size_t num_processed_items(0);
+
+  JobHandle handle = PostJob(
+      FROM_HERE, TaskTraits(),
+      BindRepeating(
+          [](WorkItems* work_items, std::atomic_size_t* num_processed_items,
+             JobDelegate* delegate) {
+            if (work_items->ClaimItem())
+              ++*num_processed_items;
+          },
+          Unretained(&work_items), Unretained(&num_processed_items)),
+      BindRepeating(&WorkItems::MaxConcurrency, Unretained(&work_items)));
+  handle.Join();
+
+  EXPECT_EQ(kNumWorkItems, num_processed_items.load());
+}
+
+// Verify that NotifyConcurrencyIncrease() puts the job back to work after it
+// ran out of work items.
+TEST_F(TaskSchedulerPostJobTest, NotifyConcurrencyIncrease) {
+  std::atomic_size_t num_available_items(0);
+  std::atomic_size_t num_processed_items(0);
+
+  JobHandle handle = PostJob(
+      FROM_HERE, TaskTraits(),
+      BindRepeating(
+          [](std::atomic_size_t* num_available_items,
+             std::atomic_size_t* num_processed_items, JobDelegate* delegate) {
+            while (!delegate->ShouldYield()) {
+              size_t num_items = num_available_items->load();
+              if (num_items == 0)
+                return;
+              if (num_available_items->compare_exchange_weak(num_items,
+                                                             num_items - 1)) {
+                ++*num_processed_items;
+              }
+            }
+          },
+          Unretained(&num_available_items), Unretained(&num_processed_items)),
+      BindRepeating(
+          [](std::atomic_size_t* num_available_items) {
+            return std::min(num_available_items->load(), kMaxConcurrency);
+          },
+          Unretained(&num_available_items)));
+
+  num_available_items = kNumWorkItems;
+  handle.NotifyConcurrencyIncrease();
+  handle.Join();
+
+  EXPECT_EQ(kNumWorkItems, num_processed_items.load());
+}
+
+// Verify that Cancel() makes ShouldYield() return true in running worker tasks
+// and lets Join() return while work items remain.
+TEST_F(TaskSchedulerPostJobTest, Cancel) {
+  WaitableEvent worker_running(WaitableEvent::ResetPolicy::MANUAL,
+                               WaitableEvent::InitialState::NOT_SIGNALED);
+
+  JobHandle handle = PostJob(
+      FROM_HERE, TaskTraits(),
+      BindRepeating(
+          [](WaitableEvent* worker_running, JobDelegate* delegate) {
+            worker_running->Signal();
+            while (!delegate->ShouldYield())
+              PlatformThread::Sleep(TestTimeouts::tiny_timeout());
+          },
+          Unretained(&worker_running)),
+      BindRepeating([]() -> size_t { return 2; }));
+
+  worker_running.Wait();
+  handle.Cancel();
+  handle.Join();
+}
+
+}  // namespace base
@@ -65,6 +65,17 @@ void PostTaskWithTraits(const Location& from_here,
   PostDelayedTaskWithTraits(from_here, traits, std::move(task), TimeDelta());
 }
 
+void PostTasksWithTraits(const Location& from_here,
+                         const TaskTraits& traits,
+                         std::vector<OnceClosure> tasks) {
+  DCHECK(TaskScheduler::GetInstance())
+      << "Ref. Prerequisite section of post_task.h.\n\n"
+         "Hint: if this is in a unit test, you're likely merely missing a "
+         "base::test::ScopedTaskEnvironment member in your fixture.\n";
+  TaskScheduler::GetInstance()->PostTasksWithTraits(
+      from_here, GetTaskTraitsWithExplicitPriority(traits), std::move(tasks));
+}
+
 void PostDelayedTaskWithTraits(const Location& from_here,
                                const TaskTraits& traits,
                                OnceClosure task,
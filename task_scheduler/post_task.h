@@ -6,6 +6,7 @@
 #define BASE_TASK_SCHEDULER_POST_TASK_H_
 
 #include <utility>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/bind.h"
@@ -123,6 +124,13 @@ BASE_EXPORT void PostTaskWithTraits(const Location& from_here,
                                     const TaskTraits& traits,
                                     OnceClosure task);
 
+// Posts each of |tasks| with specific |traits| to the TaskScheduler. This is
+// equivalent to calling PostTaskWithTraits() for each task, but enqueues the
+// whole batch at once and is therefore cheaper for large fan-outs.
+BASE_EXPORT void PostTasksWithTraits(const Location& from_here,
+                                     const TaskTraits& traits,
+                                     std::vector<OnceClosure> tasks);
+
 // Posts |task| with specific |traits| to the TaskScheduler. |task| will not run
 // before |delay| expires.
 //
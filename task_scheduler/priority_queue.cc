@@ -99,6 +99,9 @@ size_t PriorityQueue::Transaction::Size() const {
 
 PriorityQueue::PriorityQueue() = default;
 
+PriorityQueue::PriorityQueue(const SchedulerLock* predecessor_lock)
+    : container_lock_(predecessor_lock) {}
+
 PriorityQueue::~PriorityQueue() = default;
 
 std::unique_ptr<PriorityQueue::Transaction> PriorityQueue::BeginTransaction() {
@@ -73,6 +73,10 @@ class BASE_EXPORT PriorityQueue {
 
   PriorityQueue();
 
+  // Constructs a PriorityQueue whose Transactions may be started while a
+  // Transaction is alive on the PriorityQueue that owns |predecessor_lock|.
+  explicit PriorityQueue(const SchedulerLock* predecessor_lock);
+
   ~PriorityQueue();
 
   // Begins a Transaction. This method cannot be called on a thread which has an
@@ -11,6 +11,8 @@
 #include "base/macros.h"
 #include "base/synchronization/condition_variable.h"
 #include "base/synchronization/lock.h"
+#include "base/synchronization/lock_contention_profiler.h"
+#include "base/synchronization/read_write_lock.h"
 #include "base/task_scheduler/scheduler_lock_impl.h"
 
 namespace base {
@@ -42,8 +44,18 @@ namespace internal {
 // void AssertAcquired().
 //     DCHECKs if the lock is not acquired.
 //
+// void SetContentionProfilerName(const char* name)
+//     Names the lock in the LockContentionProfiler, which otherwise can't tell
+//     SchedulerLocks apart when DCHECK_IS_ON(), since they're all acquired in
+//     SchedulerLockImpl::Acquire(). A null |name| clears it, which must be done
+//     before the lock is destroyed.
+//
 // std::unique_ptr<ConditionVariable> CreateConditionVariable()
 //     Creates a condition variable using this as a lock.
+//
+// SchedulerReadWriteLock is the equivalent for base::ReadWriteLock. Its
+// predecessor may be a SchedulerLock or another SchedulerReadWriteLock, and
+// acquisitions for reading are checked like those for writing.
 
 #if DCHECK_IS_ON()
 class SchedulerLock : public SchedulerLockImpl {
@@ -52,16 +64,36 @@ class SchedulerLock : public SchedulerLockImpl {
   explicit SchedulerLock(const SchedulerLock* predecessor)
       : SchedulerLockImpl(predecessor) {}
 };
+
+class SchedulerReadWriteLock : public SchedulerReadWriteLockImpl {
+ public:
+  SchedulerReadWriteLock() = default;
+  explicit SchedulerReadWriteLock(const SchedulerLock* predecessor)
+      : SchedulerReadWriteLockImpl(predecessor) {}
+  explicit SchedulerReadWriteLock(const SchedulerReadWriteLock* predecessor)
+      : SchedulerReadWriteLockImpl(predecessor) {}
+};
 #else  // DCHECK_IS_ON()
 class SchedulerLock : public Lock {
  public:
   SchedulerLock() = default;
   explicit SchedulerLock(const SchedulerLock*) {}
 
+  void SetContentionProfilerName(const char* name) {
+    LockContentionProfiler::SetLockName(this, name);
+  }
+
   std::unique_ptr<ConditionVariable> CreateConditionVariable() {
     return std::unique_ptr<ConditionVariable>(new ConditionVariable(this));
   }
 };
+
+class SchedulerReadWriteLock : public ReadWriteLock {
+ public:
+  SchedulerReadWriteLock() = default;
+  explicit SchedulerReadWriteLock(const SchedulerLock*) {}
+  explicit SchedulerReadWriteLock(const SchedulerReadWriteLock*) {}
+};
 #endif  // DCHECK_IS_ON()
 
 // Provides the same functionality as base::AutoLock for SchedulerLock.
@@ -82,6 +114,39 @@ class AutoSchedulerLock {
   DISALLOW_COPY_AND_ASSIGN(AutoSchedulerLock);
 };
 
+// Provide the same functionality as base::AutoReadLock and base::AutoWriteLock
+// for SchedulerReadWriteLock.
+class AutoSchedulerReadLock {
+ public:
+  explicit AutoSchedulerReadLock(SchedulerReadWriteLock& lock) : lock_(lock) {
+    lock_.ReadAcquire();
+  }
+
+  ~AutoSchedulerReadLock() { lock_.ReadRelease(); }
+
+ private:
+  SchedulerReadWriteLock& lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(AutoSchedulerReadLock);
+};
+
+class AutoSchedulerWriteLock {
+ public:
+  explicit AutoSchedulerWriteLock(SchedulerReadWriteLock& lock) : lock_(lock) {
+    lock_.WriteAcquire();
+  }
+
+  ~AutoSchedulerWriteLock() {
+    lock_.AssertWriteAcquired();
+    lock_.WriteRelease();
+  }
+
+ private:
+  SchedulerReadWriteLock& lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(AutoSchedulerWriteLock);
+};
+
 }  // namespace internal
 }  // namespace base
 
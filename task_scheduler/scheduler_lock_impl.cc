@@ -11,6 +11,7 @@
 #include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock_contention_profiler.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/thread_local_storage.h"
 
@@ -19,30 +20,30 @@ namespace internal {
 
 namespace {
 
+// Tracks SchedulerLockImpls and SchedulerReadWriteLockImpls by address, so
+// that either kind can be the predecessor of a SchedulerReadWriteLockImpl.
 class SafeAcquisitionTracker {
  public:
   SafeAcquisitionTracker() : tls_acquired_locks_(&OnTLSDestroy) {}
 
-  void RegisterLock(
-      const SchedulerLockImpl* const lock,
-      const SchedulerLockImpl* const predecessor) {
+  void RegisterLock(const void* const lock, const void* const predecessor) {
     DCHECK_NE(lock, predecessor) << "Reentrant locks are unsupported.";
     AutoLock auto_lock(allowed_predecessor_map_lock_);
     allowed_predecessor_map_[lock] = predecessor;
     AssertSafePredecessor(lock);
   }
 
-  void UnregisterLock(const SchedulerLockImpl* const lock) {
+  void UnregisterLock(const void* const lock) {
     AutoLock auto_lock(allowed_predecessor_map_lock_);
     allowed_predecessor_map_.erase(lock);
   }
 
-  void RecordAcquisition(const SchedulerLockImpl* const lock) {
+  void RecordAcquisition(const void* const lock) {
     AssertSafeAcquire(lock);
     GetAcquiredLocksOnCurrentThread()->push_back(lock);
   }
 
-  void RecordRelease(const SchedulerLockImpl* const lock) {
+  void RecordRelease(const void* const lock) {
     LockVector* acquired_locks = GetAcquiredLocksOnCurrentThread();
     const auto iter_at_lock =
         std::find(acquired_locks->begin(), acquired_locks->end(), lock);
@@ -51,13 +52,12 @@ class SafeAcquisitionTracker {
   }
 
  private:
-  using LockVector = std::vector<const SchedulerLockImpl*>;
-  using PredecessorMap = std::unordered_map<
-      const SchedulerLockImpl*, const SchedulerLockImpl*>;
+  using LockVector = std::vector<const void*>;
+  using PredecessorMap = std::unordered_map<const void*, const void*>;
 
   // This asserts that the lock is safe to acquire. This means that this should
   // be run before actually recording the acquisition.
-  void AssertSafeAcquire(const SchedulerLockImpl* const lock) {
+  void AssertSafeAcquire(const void* const lock) {
     const LockVector* acquired_locks = GetAcquiredLocksOnCurrentThread();
 
     // If the thread currently holds no locks, this is inherently safe.
@@ -68,8 +68,7 @@ class SafeAcquisitionTracker {
     // predecessor.
     AutoLock auto_lock(allowed_predecessor_map_lock_);
     // Using at() is exception-safe here as |lock| was registered already.
-    const SchedulerLockImpl* allowed_predecessor =
-        allowed_predecessor_map_.at(lock);
+    const void* allowed_predecessor = allowed_predecessor_map_.at(lock);
     DCHECK_EQ(acquired_locks->back(), allowed_predecessor);
   }
 
@@ -82,10 +81,10 @@ class SafeAcquisitionTracker {
   // only contain cycle-free SchedulerLocks, this subsequent SchedulerLock is
   // itself cycle-free and may be safely added to the registered SchedulerLock
   // set.
-  void AssertSafePredecessor(const SchedulerLockImpl* lock) const {
+  void AssertSafePredecessor(const void* lock) const {
     allowed_predecessor_map_lock_.AssertAcquired();
     // Using at() is exception-safe here as |lock| was registered already.
-    const SchedulerLockImpl* predecessor = allowed_predecessor_map_.at(lock);
+    const void* predecessor = allowed_predecessor_map_.at(lock);
     if (predecessor) {
       DCHECK(allowed_predecessor_map_.find(predecessor) !=
              allowed_predecessor_map_.end())
@@ -147,10 +146,58 @@ void SchedulerLockImpl::AssertAcquired() const {
   lock_.AssertAcquired();
 }
 
+void SchedulerLockImpl::SetContentionProfilerName(const char* name) {
+  LockContentionProfiler::SetLockName(&lock_, name);
+}
+
 std::unique_ptr<ConditionVariable>
 SchedulerLockImpl::CreateConditionVariable() {
   return std::unique_ptr<ConditionVariable>(new ConditionVariable(&lock_));
 }
 
+SchedulerReadWriteLockImpl::SchedulerReadWriteLockImpl()
+    : SchedulerReadWriteLockImpl(static_cast<const void*>(nullptr)) {}
+
+SchedulerReadWriteLockImpl::SchedulerReadWriteLockImpl(
+    const SchedulerLockImpl* predecessor)
+    : SchedulerReadWriteLockImpl(static_cast<const void*>(predecessor)) {}
+
+SchedulerReadWriteLockImpl::SchedulerReadWriteLockImpl(
+    const SchedulerReadWriteLockImpl* predecessor)
+    : SchedulerReadWriteLockImpl(static_cast<const void*>(predecessor)) {}
+
+SchedulerReadWriteLockImpl::SchedulerReadWriteLockImpl(
+    const void* predecessor) {
+  g_safe_acquisition_tracker.Get().RegisterLock(this, predecessor);
+}
+
+SchedulerReadWriteLockImpl::~SchedulerReadWriteLockImpl() {
+  g_safe_acquisition_tracker.Get().UnregisterLock(this);
+}
+
+void SchedulerReadWriteLockImpl::ReadAcquire() {
+  lock_.ReadAcquire();
+  g_safe_acquisition_tracker.Get().RecordAcquisition(this);
+}
+
+void SchedulerReadWriteLockImpl::ReadRelease() {
+  lock_.ReadRelease();
+  g_safe_acquisition_tracker.Get().RecordRelease(this);
+}
+
+void SchedulerReadWriteLockImpl::WriteAcquire() {
+  lock_.WriteAcquire();
+  g_safe_acquisition_tracker.Get().RecordAcquisition(this);
+}
+
+void SchedulerReadWriteLockImpl::WriteRelease() {
+  lock_.WriteRelease();
+  g_safe_acquisition_tracker.Get().RecordRelease(this);
+}
+
+void SchedulerReadWriteLockImpl::AssertWriteAcquired() const {
+  lock_.AssertWriteAcquired();
+}
+
 }  // namespace internal
 }  // base
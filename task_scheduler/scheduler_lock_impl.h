@@ -10,6 +10,7 @@
 #include "base/base_export.h"
 #include "base/macros.h"
 #include "base/synchronization/lock.h"
+#include "base/synchronization/read_write_lock.h"
 
 namespace base {
 
@@ -32,6 +33,9 @@ class BASE_EXPORT SchedulerLockImpl {
 
   void AssertAcquired() const;
 
+  // See LockContentionProfiler::SetLockName().
+  void SetContentionProfilerName(const char* name);
+
   std::unique_ptr<ConditionVariable> CreateConditionVariable();
 
  private:
@@ -40,6 +44,32 @@ class BASE_EXPORT SchedulerLockImpl {
   DISALLOW_COPY_AND_ASSIGN(SchedulerLockImpl);
 };
 
+// A ReadWriteLock with the same checking as SchedulerLockImpl. Acquisitions
+// for reading are checked too, as a reader and a writer taking two locks in
+// opposite orders deadlock just like two writers.
+class BASE_EXPORT SchedulerReadWriteLockImpl {
+ public:
+  SchedulerReadWriteLockImpl();
+  explicit SchedulerReadWriteLockImpl(const SchedulerLockImpl* predecessor);
+  explicit SchedulerReadWriteLockImpl(
+      const SchedulerReadWriteLockImpl* predecessor);
+  ~SchedulerReadWriteLockImpl();
+
+  void ReadAcquire();
+  void ReadRelease();
+  void WriteAcquire();
+  void WriteRelease();
+
+  void AssertWriteAcquired() const;
+
+ private:
+  explicit SchedulerReadWriteLockImpl(const void* predecessor);
+
+  ReadWriteLock lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(SchedulerReadWriteLockImpl);
+};
+
 }  // namespace internal
 }  // namespace base
 
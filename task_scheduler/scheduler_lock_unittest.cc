@@ -291,6 +291,34 @@ TEST(TaskSchedulerLock, PredecessorLongerCycle) {
   EXPECT_DCHECK_DEATH({ LockCycle cycle; });
 }
 
+TEST(TaskSchedulerLock, ReadWriteLockAfterPredecessor) {
+  SchedulerLock predecessor;
+  SchedulerReadWriteLock lock(&predecessor);
+  SchedulerReadWriteLock successor(&lock);
+  {
+    AutoSchedulerLock auto_lock(predecessor);
+    AutoSchedulerReadLock auto_read_lock(lock);
+  }
+  {
+    AutoSchedulerWriteLock auto_write_lock(lock);
+    AutoSchedulerReadLock auto_read_lock(successor);
+  }
+}
+
+TEST(TaskSchedulerLock, ReadWriteLockWrongOrder) {
+  SchedulerLock predecessor;
+  SchedulerReadWriteLock lock(&predecessor);
+  // Reading is checked like writing.
+  EXPECT_DCHECK_DEATH({
+    lock.ReadAcquire();
+    predecessor.Acquire();
+  });
+  EXPECT_DCHECK_DEATH({
+    lock.WriteAcquire();
+    predecessor.Acquire();
+  });
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace base
@@ -4,6 +4,8 @@
 
 #include "base/task_scheduler/scheduler_worker_pool.h"
 
+#include <utility>
+
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/lazy_instance.h"
@@ -32,10 +34,10 @@ namespace {
 int g_active_pools_count = 0;
 
 // SchedulerWorkerPool that owns the current thread, if any.
-LazyInstance<ThreadLocalPointer<const SchedulerWorkerPool>>::Leaky
+LazyInstance<ThreadLocalPointer<SchedulerWorkerPool>>::Leaky
     tls_current_worker_pool = LAZY_INSTANCE_INITIALIZER;
 
-const SchedulerWorkerPool* GetCurrentWorkerPool() {
+SchedulerWorkerPool* GetCurrentWorkerPool() {
   return tls_current_worker_pool.Get().Get();
 }
 
@@ -66,6 +68,18 @@ class SchedulerParallelTaskRunner : public TaskRunner {
         MakeRefCounted<Sequence>());
   }
 
+  bool PostTasks(const Location& from_here,
+                 std::vector<OnceClosure> closures) override {
+    if (!g_active_pools_count)
+      return false;
+
+    std::vector<Task> tasks;
+    tasks.reserve(closures.size());
+    for (OnceClosure& closure : closures)
+      tasks.emplace_back(from_here, std::move(closure), traits_, TimeDelta());
+    return worker_pool_->PostTasksWithOneOffSequences(std::move(tasks));
+  }
+
   bool RunsTasksInCurrentSequence() const override {
     return GetCurrentWorkerPool() == worker_pool_;
   }
@@ -105,6 +119,20 @@ class SchedulerSequencedTaskRunner : public SequencedTaskRunner {
     return worker_pool_->PostTaskWithSequence(std::move(task), sequence_);
   }
 
+  bool PostTasks(const Location& from_here,
+                 std::vector<OnceClosure> closures) override {
+    if (!g_active_pools_count)
+      return false;
+
+    std::vector<Task> tasks;
+    tasks.reserve(closures.size());
+    for (OnceClosure& closure : closures) {
+      tasks.emplace_back(from_here, std::move(closure), traits_, TimeDelta());
+      tasks.back().sequenced_task_runner_ref = this;
+    }
+    return worker_pool_->PostTasksWithSequence(std::move(tasks), sequence_);
+  }
+
   bool PostNonNestableDelayedTask(const Location& from_here,
                                   OnceClosure closure,
                                   base::TimeDelta delay) override {
@@ -145,7 +173,7 @@ bool SchedulerWorkerPool::PostTaskWithSequence(
   DCHECK(task.task);
   DCHECK(sequence);
 
-  if (!task_tracker_->WillPostTask(task))
+  if (!task_tracker_->WillPostTask(&task))
     return false;
 
   if (task.delayed_run_time.is_null()) {
@@ -167,6 +195,63 @@ bool SchedulerWorkerPool::PostTaskWithSequence(
   return true;
 }
 
+bool SchedulerWorkerPool::PostTasksWithSequence(
+    std::vector<Task> tasks,
+    scoped_refptr<Sequence> sequence) {
+  DCHECK(sequence);
+
+  // WillPostTask() may mark tasks as sampled, which a std::remove_if()
+  // predicate isn't allowed to do, hence the manual compaction.
+  const size_t num_tasks = tasks.size();
+  size_t num_allowed_tasks = 0;
+  for (Task& task : tasks) {
+    DCHECK(task.task);
+    DCHECK(task.delayed_run_time.is_null());
+    if (!task_tracker_->WillPostTask(&task))
+      continue;
+    if (&task != &tasks[num_allowed_tasks])
+      tasks[num_allowed_tasks] = std::move(task);
+    ++num_allowed_tasks;
+  }
+  tasks.erase(tasks.begin() + num_allowed_tasks, tasks.end());
+  const bool all_posted = num_allowed_tasks == num_tasks;
+  if (tasks.empty())
+    return all_posted;
+
+  // See PostTaskWithSequenceNow().
+  if (sequence->PushTasks(std::move(tasks))) {
+    sequence = task_tracker_->WillScheduleSequence(std::move(sequence), this);
+    if (sequence)
+      OnCanScheduleSequence(std::move(sequence));
+  }
+  return all_posted;
+}
+
+bool SchedulerWorkerPool::PostTasksWithOneOffSequences(
+    std::vector<Task> tasks) {
+  bool all_posted = true;
+  std::vector<scoped_refptr<Sequence>> sequences;
+  sequences.reserve(tasks.size());
+  for (Task& task : tasks) {
+    DCHECK(task.task);
+    DCHECK(task.delayed_run_time.is_null());
+    if (!task_tracker_->WillPostTask(&task)) {
+      all_posted = false;
+      continue;
+    }
+
+    scoped_refptr<Sequence> sequence = MakeRefCounted<Sequence>();
+    sequence->PushTask(std::move(task));
+    sequence = task_tracker_->WillScheduleSequence(std::move(sequence), this);
+    if (sequence)
+      sequences.push_back(std::move(sequence));
+  }
+
+  if (!sequences.empty())
+    OnCanScheduleSequences(std::move(sequences));
+  return all_posted;
+}
+
 SchedulerWorkerPool::SchedulerWorkerPool(
     TrackedRef<TaskTracker> task_tracker,
     DelayedTaskManager* delayed_task_manager)
@@ -192,6 +277,17 @@ void SchedulerWorkerPool::UnbindFromCurrentThread() {
   tls_current_worker_pool.Get().Set(nullptr);
 }
 
+// static
+bool SchedulerWorkerPool::ShouldYieldFromCurrentThread(TaskPriority priority) {
+  SchedulerWorkerPool* const current_worker_pool = GetCurrentWorkerPool();
+  return current_worker_pool &&
+         current_worker_pool->HasSequenceWithPriorityAbove(priority);
+}
+
+bool SchedulerWorkerPool::HasSequenceWithPriorityAbove(TaskPriority priority) {
+  return false;
+}
+
 void SchedulerWorkerPool::PostTaskWithSequenceNow(
     Task task,
     scoped_refptr<Sequence> sequence) {
@@ -215,5 +311,11 @@ void SchedulerWorkerPool::PostTaskWithSequenceNow(
   }
 }
 
+void SchedulerWorkerPool::OnCanScheduleSequences(
+    std::vector<scoped_refptr<Sequence>> sequences) {
+  for (scoped_refptr<Sequence>& sequence : sequences)
+    OnCanScheduleSequence(std::move(sequence));
+}
+
 }  // namespace internal
 }  // namespace base
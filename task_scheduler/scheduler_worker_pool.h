@@ -5,6 +5,8 @@
 #ifndef BASE_TASK_SCHEDULER_SCHEDULER_WORKER_POOL_H_
 #define BASE_TASK_SCHEDULER_SCHEDULER_WORKER_POOL_H_
 
+#include <vector>
+
 #include "base/base_export.h"
 #include "base/memory/ref_counted.h"
 #include "base/sequenced_task_runner.h"
@@ -43,12 +45,31 @@ class BASE_EXPORT SchedulerWorkerPool : public CanScheduleSequenceObserver {
   // Returns true if |task| is posted.
   bool PostTaskWithSequence(Task task, scoped_refptr<Sequence> sequence);
 
+  // Posts |tasks|, which must not be delayed, to be executed by this
+  // SchedulerWorkerPool as part of |sequence|, in order. This takes the lock of
+  // |sequence| once for the whole batch. Returns true if all of |tasks| are
+  // posted; tasks which can't be posted are deleted.
+  bool PostTasksWithSequence(std::vector<Task> tasks,
+                             scoped_refptr<Sequence> sequence);
+
+  // Posts each of |tasks|, which must not be delayed, as part of a one-off
+  // single-task Sequence. Unlike calling PostTaskWithSequence() for each of
+  // them, this enqueues the batch under a single lock acquisition and wakes up
+  // no more workers than the batch can use. Returns true if all of |tasks| are
+  // posted; tasks which can't be posted are deleted.
+  bool PostTasksWithOneOffSequences(std::vector<Task> tasks);
+
   // Registers the worker pool in TLS.
   void BindToCurrentThread();
 
   // Resets the worker pool in TLS.
   void UnbindFromCurrentThread();
 
+  // Returns true if a task of |priority| running on the current thread should
+  // return early to let the pool that owns the current thread run a Sequence of
+  // higher priority. Returns false if no pool owns the current thread.
+  static bool ShouldYieldFromCurrentThread(TaskPriority priority);
+
   // Prevents new tasks from starting to run and waits for currently running
   // tasks to complete their execution. It is guaranteed that no thread will do
   // work on behalf of this SchedulerWorkerPool after this returns. It is
@@ -66,6 +87,17 @@ class BASE_EXPORT SchedulerWorkerPool : public CanScheduleSequenceObserver {
   // PostTaskWithSequence() and after |task|'s delayed run time.
   void PostTaskWithSequenceNow(Task task, scoped_refptr<Sequence> sequence);
 
+  // Called instead of OnCanScheduleSequence() for a batch of Sequences which
+  // can be scheduled. The default implementation calls OnCanScheduleSequence()
+  // for each of them.
+  virtual void OnCanScheduleSequences(
+      std::vector<scoped_refptr<Sequence>> sequences);
+
+  // Returns true if a Sequence with a priority higher than |priority| is
+  // waiting to be scheduled in this SchedulerWorkerPool. The default
+  // implementation returns false.
+  virtual bool HasSequenceWithPriorityAbove(TaskPriority priority);
+
   const TrackedRef<TaskTracker> task_tracker_;
   DelayedTaskManager* const delayed_task_manager_;
 
@@ -20,6 +20,7 @@
 #include "base/sequence_token.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
+#include "base/synchronization/adaptive_spin_waiter.h"
 #include "base/task_scheduler/scheduler_worker_pool_params.h"
 #include "base/task_scheduler/task_tracker.h"
 #include "base/task_scheduler/task_traits.h"
@@ -38,8 +39,6 @@
 namespace base {
 namespace internal {
 
-constexpr TimeDelta SchedulerWorkerPoolImpl::kBlockedWorkersPollPeriod;
-
 namespace {
 
 constexpr char kPoolNameSuffix[] = "Pool";
@@ -49,8 +48,39 @@ constexpr char kNumTasksBeforeDetachHistogramPrefix[] =
     "TaskScheduler.NumTasksBeforeDetach.";
 constexpr char kNumTasksBetweenWaitsHistogramPrefix[] =
     "TaskScheduler.NumTasksBetweenWaits.";
+constexpr char kBlockedWorkerReplacementDelayHistogramPrefix[] =
+    "TaskScheduler.BlockedWorkerReplacementDelay.";
+#if defined(OS_LINUX)
+constexpr char kCpuTimeBetweenWaitsHistogramPrefix[] =
+    "TaskScheduler.CpuTimeBetweenWaits.";
+constexpr char kRunQueueTimeBetweenWaitsHistogramPrefix[] =
+    "TaskScheduler.RunQueueTimeBetweenWaits.";
+constexpr char kInvoluntaryContextSwitchesBetweenWaitsHistogramPrefix[] =
+    "TaskScheduler.InvoluntaryContextSwitchesBetweenWaits.";
+#endif  // defined(OS_LINUX)
 constexpr size_t kMaxNumberOfWorkers = 256;
 
+// A worker which enters a MAY_BLOCK ScopedBlockingCall less than this long
+// after leaving a ScopedBlockingCall which caused a worker capacity increment
+// is likely to block again, e.g. when it does a series of small synchronous
+// reads. Its capacity is incremented right away instead of after
+// MayBlockThreshold(), to avoid starving the pool at each of these calls.
+constexpr TimeDelta kReblockedWorkerPeriod = TimeDelta::FromMilliseconds(100);
+
+// When work stealing is enabled, maximum number of consecutive Sequences that a
+// worker takes from its local PriorityQueue without comparing its front with
+// the front of the shared PriorityQueue. Bounds how long a Sequence in the
+// shared PriorityQueue can wait behind Sequences in a worker-local
+// PriorityQueue that it would have preempted.
+constexpr size_t kMaxLocalSequencesBetweenSharedQueueChecks = 8;
+
+// Maximum number of consecutive tasks that a worker runs from the same Sequence
+// without putting it back in a PriorityQueue, as long as no Sequence of higher
+// priority waits in the shared PriorityQueue. Saves a PriorityQueue push and
+// pop per task for Sequences with several tasks queued, while bounding how long
+// Sequences of the same priority wait behind them.
+constexpr size_t kMaxTasksPerSequenceBatch = 4;
+
 // Only used in DCHECKs.
 bool ContainsWorker(const std::vector<scoped_refptr<SchedulerWorker>>& workers,
                     const SchedulerWorker* worker) {
@@ -68,7 +98,11 @@ class SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl
       public BlockingObserver {
  public:
   // |outer| owns the worker for which this delegate is constructed.
-  SchedulerWorkerDelegateImpl(TrackedRef<SchedulerWorkerPoolImpl> outer);
+  // |local_priority_queue_index| is the index of the worker's entry in
+  // |outer->local_priority_queues_| when work stealing is enabled and is
+  // ignored otherwise.
+  SchedulerWorkerDelegateImpl(TrackedRef<SchedulerWorkerPoolImpl> outer,
+                              size_t local_priority_queue_index);
   ~SchedulerWorkerDelegateImpl() override;
 
   // SchedulerWorker::Delegate:
@@ -78,6 +112,7 @@ class SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl
   void DidRunTask() override;
   void ReEnqueueSequence(scoped_refptr<Sequence> sequence) override;
   TimeDelta GetSleepTimeout() override;
+  void WaitForWork(WaitableEvent* wake_up_event) override;
   void OnMainExit(SchedulerWorker* worker) override;
 
   // Sets |is_on_idle_workers_stack_| to be true and DCHECKS that |worker|
@@ -109,6 +144,14 @@ class SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl
   // incremented if this returns true.
   bool MustIncrementWorkerCapacityLockRequired();
 
+  // Returns the time when this worker entered a MAY_BLOCK ScopedBlockingCall
+  // which hasn't caused a worker capacity increment yet, or a null TimeTicks if
+  // it isn't within one.
+  TimeTicks may_block_start_time_lock_required() const {
+    outer_->lock_.AssertAcquired();
+    return may_block_start_time_;
+  }
+
  private:
   // Returns true if |worker| is allowed to cleanup and remove itself from the
   // pool. Called from GetWork() when no work is available.
@@ -122,8 +165,53 @@ class SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl
   // Called in GetWork() when a worker becomes idle.
   void OnWorkerBecomesIdleLockRequired(SchedulerWorker* worker);
 
+#if defined(OS_LINUX)
+  // Records how this worker was scheduled since the last call, in the
+  // TaskScheduler.*BetweenWaits histograms.
+  void RecordSchedulerStatsBetweenWaits();
+#endif
+
+  // Returns this worker's local PriorityQueue. Work stealing must be enabled.
+  PriorityQueue* local_priority_queue() const;
+
+  // Returns the next Sequence from this worker's local PriorityQueue, from the
+  // shared PriorityQueue if its front has precedence, or stolen from a peer's
+  // local PriorityQueue. Returns nullptr if no work was found. Work stealing
+  // must be enabled.
+  scoped_refptr<Sequence> GetWorkFromLocalOrPeerPriorityQueues();
+
+  // Returns a Sequence popped from the local PriorityQueue of another worker,
+  // or nullptr if all of them are empty. Work stealing must be enabled.
+  scoped_refptr<Sequence> StealWorkFromPeer();
+
+  // Moves all Sequences from this worker's local PriorityQueue to the shared
+  // PriorityQueue, so that other workers can run them while this worker is
+  // blocked or idle. No-op if work stealing is disabled.
+  void MoveLocalSequencesToSharedPriorityQueue();
+
   const TrackedRef<SchedulerWorkerPoolImpl> outer_;
 
+  // Index of this worker's entry in |outer_->local_priority_queues_|. Only
+  // meaningful when work stealing is enabled.
+  const size_t local_priority_queue_index_;
+
+  // Number of Sequences taken from the local PriorityQueue since the front of
+  // the shared PriorityQueue was last considered.
+  size_t num_local_sequences_since_shared_queue_check_ = 0;
+
+  // Sequence whose next task this worker runs without a PriorityQueue round
+  // trip. Set by ReEnqueueSequence() and taken by the next GetWork().
+  scoped_refptr<Sequence> batched_sequence_;
+
+  // Number of consecutive tasks run from the Sequence returned by the last
+  // GetWork().
+  size_t num_tasks_in_batch_ = 0;
+
+  // Index of the first entry of |outer_->local_priority_queues_| to look at
+  // the next time this worker tries to steal work. Starts the search where the
+  // last successful steal happened.
+  size_t next_steal_index_;
+
   // Time of the last detach.
   TimeTicks last_detach_time_;
 
@@ -135,6 +223,22 @@ class SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl
   // TaskScheduler.NumTasksBeforeDetach histogram was recorded.
   size_t num_tasks_since_last_detach_ = 0;
 
+  // Polls for work before the worker goes to sleep. Created by OnMainEntry()
+  // if the pool has a |max_idle_spin_duration_|.
+  std::unique_ptr<AdaptiveSpinWaiter> spin_waiter_;
+
+#if defined(OS_LINUX)
+  // How this worker's thread was scheduled as of the last sample. Sampled when
+  // the worker starts and before it waits after becoming idle, which is done
+  // outside of |outer_->lock_| because it takes system calls.
+  PlatformThread::SchedulerStats last_scheduler_stats_;
+  bool has_last_scheduler_stats_ = false;
+
+  // Whether the worker became idle since it last waited. Time outs of the
+  // wait on the idle workers stack aren't recorded.
+  bool became_idle_since_last_wait_ = false;
+#endif
+
   // Whether the worker holding this delegate is on the idle worker's stack.
   // Access synchronized by |outer_->lock_|.
   bool is_on_idle_workers_stack_ = true;
@@ -147,6 +251,10 @@ class SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl
   // BlockingScopeExited() is called. Access synchronized by |outer_->lock_|.
   TimeTicks may_block_start_time_;
 
+  // Time when the last ScopedBlockingCall which caused a worker capacity
+  // increment ended. Only accessed on the worker thread.
+  TimeTicks last_replaced_blocking_end_time_;
+
   // Whether this worker is currently running a task (i.e. GetWork() has
   // returned a non-empty sequence and DidRunTask() hasn't been called yet).
   bool is_running_task_ = false;
@@ -204,9 +312,51 @@ SchedulerWorkerPoolImpl::SchedulerWorkerPoolImpl(
           100,
           50,
           HistogramBase::kUmaTargetedHistogramFlag)),
+      // Mimics the UMA_HISTOGRAM_TIMES macro, with a 1 ms minimum since the
+      // delay is at least MayBlockThreshold().
+      blocked_worker_replacement_delay_histogram_(Histogram::FactoryTimeGet(
+          JoinString({kBlockedWorkerReplacementDelayHistogramPrefix,
+                      histogram_label, kPoolNameSuffix},
+                     ""),
+          TimeDelta::FromMilliseconds(1),
+          TimeDelta::FromSeconds(10),
+          50,
+          HistogramBase::kUmaTargetedHistogramFlag)),
+#if defined(OS_LINUX)
+      // Mimics the UMA_HISTOGRAM_TIMES macro, with a 1 ms minimum since most
+      // of the samples are expected to be short.
+      cpu_time_between_waits_histogram_(Histogram::FactoryTimeGet(
+          JoinString({kCpuTimeBetweenWaitsHistogramPrefix, histogram_label,
+                      kPoolNameSuffix},
+                     ""),
+          TimeDelta::FromMilliseconds(1),
+          TimeDelta::FromSeconds(10),
+          50,
+          HistogramBase::kUmaTargetedHistogramFlag)),
+      run_queue_time_between_waits_histogram_(Histogram::FactoryTimeGet(
+          JoinString({kRunQueueTimeBetweenWaitsHistogramPrefix,
+                      histogram_label, kPoolNameSuffix},
+                     ""),
+          TimeDelta::FromMilliseconds(1),
+          TimeDelta::FromSeconds(10),
+          50,
+          HistogramBase::kUmaTargetedHistogramFlag)),
+      // Mimics the UMA_HISTOGRAM_COUNTS_1000 macro.
+      involuntary_context_switches_between_waits_histogram_(
+          Histogram::FactoryGet(
+              JoinString(
+                  {kInvoluntaryContextSwitchesBetweenWaitsHistogramPrefix,
+                   histogram_label, kPoolNameSuffix},
+                  ""),
+              1,
+              1000,
+              50,
+              HistogramBase::kUmaTargetedHistogramFlag)),
+#endif  // defined(OS_LINUX)
       tracked_ref_factory_(this) {
   DCHECK(!histogram_label.empty());
   DCHECK(!pool_label_.empty());
+  lock_.SetContentionProfilerName("SchedulerWorkerPoolImpl");
 }
 
 void SchedulerWorkerPoolImpl::Start(
@@ -222,8 +372,21 @@ void SchedulerWorkerPoolImpl::Start(
   DCHECK_LE(initial_worker_capacity_, kMaxNumberOfWorkers);
   suggested_reclaim_time_ = params.suggested_reclaim_time();
   backward_compatibility_ = params.backward_compatibility();
+  processor_affinity_ = params.processor_affinity();
+  max_idle_spin_duration_ = params.max_idle_spin_duration();
   worker_environment_ = worker_environment;
 
+  work_stealing_enabled_ =
+      params.work_stealing() == SchedulerWorkStealing::ENABLED;
+  if (work_stealing_enabled_) {
+    local_priority_queues_.reserve(kMaxNumberOfWorkers);
+    for (size_t i = 0; i < kMaxNumberOfWorkers; ++i) {
+      local_priority_queues_.push_back(std::make_unique<PriorityQueue>(
+          shared_priority_queue_.container_lock()));
+    }
+    local_priority_queue_in_use_.assign(kMaxNumberOfWorkers, false);
+  }
+
   service_thread_task_runner_ = std::move(service_thread_task_runner);
 
   // The initial number of workers is |num_wake_ups_before_start_| + 1 to try to
@@ -260,6 +423,7 @@ SchedulerWorkerPoolImpl::~SchedulerWorkerPoolImpl() {
   //  2) In production, iff initialization failed.
   // In both cases |workers_| should be empty.
   DCHECK(workers_.empty());
+  lock_.SetContentionProfilerName(nullptr);
 }
 
 void SchedulerWorkerPoolImpl::OnCanScheduleSequence(
@@ -271,10 +435,39 @@ void SchedulerWorkerPoolImpl::OnCanScheduleSequence(
   WakeUpOneWorker();
 }
 
+void SchedulerWorkerPoolImpl::OnCanScheduleSequences(
+    std::vector<scoped_refptr<Sequence>> sequences) {
+  const size_t num_sequences = sequences.size();
+  {
+    std::unique_ptr<PriorityQueue::Transaction> shared_transaction(
+        shared_priority_queue_.BeginTransaction());
+    for (scoped_refptr<Sequence>& sequence : sequences) {
+      const auto sequence_sort_key = sequence->GetSortKey();
+      shared_transaction->Push(std::move(sequence), sequence_sort_key);
+    }
+  }
+
+  WakeUpWorkers(num_sequences);
+}
+
+bool SchedulerWorkerPoolImpl::HasSequenceWithPriorityAbove(
+    TaskPriority priority) {
+  std::unique_ptr<PriorityQueue::Transaction> shared_transaction(
+      shared_priority_queue_.BeginTransaction());
+  return !shared_transaction->IsEmpty() &&
+         shared_transaction->PeekSortKey().priority() > priority;
+}
+
 void SchedulerWorkerPoolImpl::GetHistograms(
     std::vector<const HistogramBase*>* histograms) const {
   histograms->push_back(detach_duration_histogram_);
   histograms->push_back(num_tasks_between_waits_histogram_);
+  histograms->push_back(blocked_worker_replacement_delay_histogram_);
+#if defined(OS_LINUX)
+  histograms->push_back(cpu_time_between_waits_histogram_);
+  histograms->push_back(run_queue_time_between_waits_histogram_);
+  histograms->push_back(involuntary_context_switches_between_waits_histogram_);
+#endif
 }
 
 int SchedulerWorkerPoolImpl::GetMaxConcurrentNonBlockedTasksDeprecated() const {
@@ -368,8 +561,11 @@ void SchedulerWorkerPoolImpl::MaximizeMayBlockThresholdForTesting() {
 }
 
 SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
-    SchedulerWorkerDelegateImpl(TrackedRef<SchedulerWorkerPoolImpl> outer)
-    : outer_(std::move(outer)) {
+    SchedulerWorkerDelegateImpl(TrackedRef<SchedulerWorkerPoolImpl> outer,
+                                size_t local_priority_queue_index)
+    : outer_(std::move(outer)),
+      local_priority_queue_index_(local_priority_queue_index),
+      next_steal_index_(local_priority_queue_index + 1) {
   // Bound in OnMainEntry().
   DETACH_FROM_THREAD(worker_thread_checker_);
 }
@@ -407,8 +603,24 @@ void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::OnMainEntry(
   }
 #endif  // defined(OS_WIN)
 
+#if defined(OS_LINUX)
+  if (!outer_->processor_affinity_.empty()) {
+    const bool affinity_set =
+        PlatformThread::SetCurrentThreadAffinity(outer_->processor_affinity_);
+    DPLOG_IF(ERROR, !affinity_set) << "Failed to set worker affinity";
+  }
+
+  has_last_scheduler_stats_ =
+      PlatformThread::GetCurrentThreadSchedulerStats(&last_scheduler_stats_);
+#endif
+
   DCHECK_EQ(num_tasks_since_last_wait_, 0U);
 
+  if (!outer_->max_idle_spin_duration_.is_zero()) {
+    spin_waiter_ =
+        std::make_unique<AdaptiveSpinWaiter>(outer_->max_idle_spin_duration_);
+  }
+
   PlatformThread::SetName(
       StringPrintf("TaskScheduler%sWorker", outer_->pool_label_.c_str()));
 
@@ -422,6 +634,7 @@ SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::GetWork(
   DCHECK_CALLED_ON_VALID_THREAD(worker_thread_checker_);
 
   DCHECK(!is_running_task_);
+  bool is_going_idle = false;
   {
     AutoSchedulerLock auto_lock(outer_->lock_);
 
@@ -433,6 +646,9 @@ SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::GetWork(
     DCHECK_EQ(is_on_idle_workers_stack_,
               outer_->idle_workers_stack_.Contains(worker));
     if (is_on_idle_workers_stack_) {
+      // Note: When work stealing is enabled, the local PriorityQueue of an idle
+      // worker is empty since a worker only goes idle after finding it empty
+      // and no other worker pushes to it.
       if (CanCleanupLockRequired(worker))
         CleanupLockRequired(worker);
       return nullptr;
@@ -445,11 +661,34 @@ SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::GetWork(
     if (outer_->NumberOfExcessWorkersLockRequired() >
         outer_->idle_workers_stack_.Size()) {
       OnWorkerBecomesIdleLockRequired(worker);
-      return nullptr;
+      is_going_idle = true;
     }
   }
-  scoped_refptr<Sequence> sequence;
-  {
+  if (is_going_idle) {
+    // Give away the Sequences that this worker would otherwise have run.
+    // |lock_| can't be held while doing so since it has the shared
+    // PriorityQueue's lock as its predecessor. A wake up of this worker can't
+    // be handled before GetWork() returns.
+    MoveLocalSequencesToSharedPriorityQueue();
+    if (batched_sequence_) {
+      const SequenceSortKey sequence_sort_key = batched_sequence_->GetSortKey();
+      outer_->shared_priority_queue_.BeginTransaction()->Push(
+          std::move(batched_sequence_), sequence_sort_key);
+      outer_->WakeUpOneWorker();
+    }
+    return nullptr;
+  }
+
+  // Keep running the Sequence kept by ReEnqueueSequence(), if any.
+  scoped_refptr<Sequence> sequence = std::move(batched_sequence_);
+  if (sequence) {
+    ++num_tasks_in_batch_;
+  } else {
+    num_tasks_in_batch_ = 1;
+    if (outer_->work_stealing_enabled_)
+      sequence = GetWorkFromLocalOrPeerPriorityQueues();
+  }
+  if (!sequence) {
     std::unique_ptr<PriorityQueue::Transaction> shared_transaction(
         outer_->shared_priority_queue_.BeginTransaction());
 
@@ -502,11 +741,31 @@ void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
   DCHECK_CALLED_ON_VALID_THREAD(worker_thread_checker_);
 
   const SequenceSortKey sequence_sort_key = sequence->GetSortKey();
-  outer_->shared_priority_queue_.BeginTransaction()->Push(std::move(sequence),
-                                                          sequence_sort_key);
+
+  // Run the next task of |sequence| right away unless it has had its share of
+  // consecutive tasks or a Sequence of higher priority is waiting.
+  if (num_tasks_in_batch_ < kMaxTasksPerSequenceBatch) {
+    std::unique_ptr<PriorityQueue::Transaction> shared_transaction(
+        outer_->shared_priority_queue_.BeginTransaction());
+    if (shared_transaction->IsEmpty() ||
+        shared_transaction->PeekSortKey().priority() <=
+            sequence_sort_key.priority()) {
+      batched_sequence_ = std::move(sequence);
+      return;
+    }
+  }
+
+  // When work stealing is enabled, keep |sequence| in this worker's local
+  // PriorityQueue to avoid contention on the shared PriorityQueue. Peers that
+  // run out of work can steal it.
+  PriorityQueue* const priority_queue = outer_->work_stealing_enabled_
+                                            ? local_priority_queue()
+                                            : &outer_->shared_priority_queue_;
+  priority_queue->BeginTransaction()->Push(std::move(sequence),
+                                           sequence_sort_key);
   // This worker will soon call GetWork(). Therefore, there is no need to wake
   // up a worker to run the sequence that was just inserted into
-  // |outer_->shared_priority_queue_|.
+  // |priority_queue|.
 }
 
 TimeDelta SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
@@ -515,6 +774,26 @@ TimeDelta SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
   return outer_->suggested_reclaim_time_;
 }
 
+void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::WaitForWork(
+    WaitableEvent* wake_up_event) {
+  DCHECK_CALLED_ON_VALID_THREAD(worker_thread_checker_);
+#if defined(OS_LINUX)
+  if (became_idle_since_last_wait_) {
+    became_idle_since_last_wait_ = false;
+    RecordSchedulerStatsBetweenWaits();
+  }
+#endif  // defined(OS_LINUX)
+
+  if (!spin_waiter_) {
+    SchedulerWorker::Delegate::WaitForWork(wake_up_event);
+    return;
+  }
+  const uint64_t num_avoided_wakeups = spin_waiter_->num_avoided_wakeups();
+  spin_waiter_->TimedWait(wake_up_event, GetSleepTimeout());
+  if (spin_waiter_->num_avoided_wakeups() != num_avoided_wakeups)
+    outer_->num_avoided_wakeups_.fetch_add(1, std::memory_order_relaxed);
+}
+
 bool SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
     CanCleanupLockRequired(SchedulerWorker* worker) {
   DCHECK_CALLED_ON_VALID_THREAD(worker_thread_checker_);
@@ -532,6 +811,8 @@ void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::CleanupLockRequired(
   outer_->cleanup_timestamps_.push(TimeTicks::Now());
   worker->Cleanup();
   outer_->RemoveFromIdleWorkersStackLockRequired(worker);
+  if (outer_->work_stealing_enabled_)
+    outer_->ReleaseLocalPriorityQueueLockRequired(local_priority_queue_index_);
 
   // Remove the worker from |workers_|.
   auto worker_iter =
@@ -555,10 +836,127 @@ void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
   // here.
   outer_->num_tasks_between_waits_histogram_->Add(num_tasks_since_last_wait_);
   num_tasks_since_last_wait_ = 0;
+#if defined(OS_LINUX)
+  became_idle_since_last_wait_ = true;
+#endif
   outer_->AddToIdleWorkersStackLockRequired(worker);
   SetIsOnIdleWorkersStackLockRequired(worker);
 }
 
+#if defined(OS_LINUX)
+void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
+    RecordSchedulerStatsBetweenWaits() {
+  DCHECK_CALLED_ON_VALID_THREAD(worker_thread_checker_);
+
+  PlatformThread::SchedulerStats stats;
+  if (!PlatformThread::GetCurrentThreadSchedulerStats(&stats)) {
+    has_last_scheduler_stats_ = false;
+    return;
+  }
+  if (has_last_scheduler_stats_) {
+    outer_->cpu_time_between_waits_histogram_->AddTime(
+        stats.cpu_time - last_scheduler_stats_.cpu_time);
+    outer_->run_queue_time_between_waits_histogram_->AddTime(
+        stats.run_queue_time - last_scheduler_stats_.run_queue_time);
+    outer_->involuntary_context_switches_between_waits_histogram_->Add(
+        static_cast<int>(stats.involuntary_context_switches -
+                         last_scheduler_stats_.involuntary_context_switches));
+  }
+  last_scheduler_stats_ = stats;
+  has_last_scheduler_stats_ = true;
+}
+#endif  // defined(OS_LINUX)
+
+PriorityQueue*
+SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::local_priority_queue()
+    const {
+  DCHECK(outer_->work_stealing_enabled_);
+  return outer_->local_priority_queues_[local_priority_queue_index_].get();
+}
+
+scoped_refptr<Sequence> SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
+    GetWorkFromLocalOrPeerPriorityQueues() {
+  DCHECK_CALLED_ON_VALID_THREAD(worker_thread_checker_);
+  DCHECK(outer_->work_stealing_enabled_);
+
+  // Fast path: take the next Sequence from the local PriorityQueue without
+  // touching the shared PriorityQueue.
+  if (num_local_sequences_since_shared_queue_check_ <
+      kMaxLocalSequencesBetweenSharedQueueChecks) {
+    std::unique_ptr<PriorityQueue::Transaction> local_transaction(
+        local_priority_queue()->BeginTransaction());
+    if (!local_transaction->IsEmpty()) {
+      ++num_local_sequences_since_shared_queue_check_;
+      return local_transaction->PopSequence();
+    }
+  }
+
+  // Pick whichever of the local and shared PriorityQueues has the front with
+  // the highest SequenceSortKey, as if all Sequences were in the same
+  // PriorityQueue. The shared PriorityQueue's lock is the predecessor of the
+  // local PriorityQueue's lock.
+  num_local_sequences_since_shared_queue_check_ = 0;
+  {
+    std::unique_ptr<PriorityQueue::Transaction> shared_transaction(
+        outer_->shared_priority_queue_.BeginTransaction());
+    std::unique_ptr<PriorityQueue::Transaction> local_transaction(
+        local_priority_queue()->BeginTransaction());
+    const bool local_has_precedence =
+        !local_transaction->IsEmpty() &&
+        (shared_transaction->IsEmpty() ||
+         shared_transaction->PeekSortKey() < local_transaction->PeekSortKey());
+    if (local_has_precedence)
+      return local_transaction->PopSequence();
+    if (!shared_transaction->IsEmpty())
+      return shared_transaction->PopSequence();
+  }
+
+  return StealWorkFromPeer();
+}
+
+scoped_refptr<Sequence> SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
+    StealWorkFromPeer() {
+  DCHECK_CALLED_ON_VALID_THREAD(worker_thread_checker_);
+  DCHECK(outer_->work_stealing_enabled_);
+
+  // Entries past |num_local_priority_queues_assigned_| were never assigned to a
+  // worker and are therefore empty. Entries that aren't currently assigned are
+  // empty too, but looking at them is harmless.
+  const size_t num_local_priority_queues =
+      outer_->num_local_priority_queues_assigned_.load(
+          std::memory_order_acquire);
+  for (size_t i = 0; i < num_local_priority_queues; ++i) {
+    const size_t index = (next_steal_index_ + i) % num_local_priority_queues;
+    if (index == local_priority_queue_index_)
+      continue;
+    std::unique_ptr<PriorityQueue::Transaction> peer_transaction(
+        outer_->local_priority_queues_[index]->BeginTransaction());
+    if (!peer_transaction->IsEmpty()) {
+      next_steal_index_ = index;
+      return peer_transaction->PopSequence();
+    }
+  }
+  return nullptr;
+}
+
+void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
+    MoveLocalSequencesToSharedPriorityQueue() {
+  if (!outer_->work_stealing_enabled_)
+    return;
+
+  std::unique_ptr<PriorityQueue::Transaction> shared_transaction(
+      outer_->shared_priority_queue_.BeginTransaction());
+  std::unique_ptr<PriorityQueue::Transaction> local_transaction(
+      local_priority_queue()->BeginTransaction());
+  while (!local_transaction->IsEmpty()) {
+    // Copy the sort key since the reference returned by PeekSortKey() is
+    // invalidated by PopSequence().
+    const SequenceSortKey sequence_sort_key = local_transaction->PeekSortKey();
+    shared_transaction->Push(local_transaction->PopSequence(),
+                             sequence_sort_key);
+  }
+}
+
 void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::OnMainExit(
     SchedulerWorker* worker) {
   DCHECK_CALLED_ON_VALID_THREAD(worker_thread_checker_);
@@ -620,7 +1018,13 @@ void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::BlockingStarted(
 
   switch (blocking_type) {
     case BlockingType::MAY_BLOCK:
-      MayBlockEntered();
+      if (!last_replaced_blocking_end_time_.is_null() &&
+          TimeTicks::Now() - last_replaced_blocking_end_time_ <
+              kReblockedWorkerPeriod) {
+        WillBlockEntered();
+      } else {
+        MayBlockEntered();
+      }
       break;
     case BlockingType::WILL_BLOCK:
       WillBlockEntered();
@@ -661,6 +1065,7 @@ void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::BlockingEnded() {
   AutoSchedulerLock auto_lock(outer_->lock_);
   if (incremented_worker_capacity_since_blocked_) {
     outer_->DecrementWorkerCapacityLockRequired();
+    last_replaced_blocking_end_time_ = TimeTicks::Now();
   } else {
     DCHECK(!may_block_start_time_.is_null());
     --outer_->num_pending_may_block_workers_;
@@ -673,6 +1078,10 @@ void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::BlockingEnded() {
 void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::MayBlockEntered() {
   DCHECK_CALLED_ON_VALID_THREAD(worker_thread_checker_);
 
+  // Sequences in the local PriorityQueue must be visible to
+  // AdjustWorkerCapacity() if this worker remains blocked.
+  MoveLocalSequencesToSharedPriorityQueue();
+
   {
     AutoSchedulerLock auto_lock(outer_->lock_);
 
@@ -687,6 +1096,10 @@ void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::MayBlockEntered() {
 void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::WillBlockEntered() {
   DCHECK_CALLED_ON_VALID_THREAD(worker_thread_checker_);
 
+  // Sequences in the local PriorityQueue must be taken into account below to
+  // decide whether to wake up a worker.
+  MoveLocalSequencesToSharedPriorityQueue();
+
   bool wake_up_allowed = false;
   {
     std::unique_ptr<PriorityQueue::Transaction> shared_transaction(
@@ -726,10 +1139,15 @@ bool SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
     MustIncrementWorkerCapacityLockRequired() {
   outer_->lock_.AssertAcquired();
 
-  if (!incremented_worker_capacity_since_blocked_ &&
-      !may_block_start_time_.is_null() &&
-      TimeTicks::Now() - may_block_start_time_ >= outer_->MayBlockThreshold()) {
+  if (incremented_worker_capacity_since_blocked_ ||
+      may_block_start_time_.is_null()) {
+    return false;
+  }
+
+  const TimeDelta blocked_time = TimeTicks::Now() - may_block_start_time_;
+  if (blocked_time >= outer_->MayBlockThreshold()) {
     incremented_worker_capacity_since_blocked_ = true;
+    outer_->blocked_worker_replacement_delay_histogram_->AddTime(blocked_time);
 
     // Reset |may_block_start_time_| so that BlockingScopeExited() knows that it
     // doesn't have to decrement |outer_->num_pending_may_block_workers_|.
@@ -793,6 +1211,20 @@ void SchedulerWorkerPoolImpl::WakeUpOneWorker() {
     PostAdjustWorkerCapacityTaskIfNeeded();
 }
 
+void SchedulerWorkerPoolImpl::WakeUpWorkers(size_t num_workers) {
+  bool wake_up_allowed = false;
+  {
+    AutoSchedulerLock auto_lock(lock_);
+    // More wake-ups than the pool can have workers would be no-ops.
+    num_workers = std::min(
+        num_workers, workers_.empty() ? kMaxNumberOfWorkers : worker_capacity_);
+    for (size_t i = 0; i < num_workers; ++i)
+      wake_up_allowed = WakeUpOneWorkerLockRequired();
+  }
+  if (wake_up_allowed)
+    PostAdjustWorkerCapacityTaskIfNeeded();
+}
+
 void SchedulerWorkerPoolImpl::MaintainAtLeastOneIdleWorkerLockRequired() {
   lock_.AssertAcquired();
 
@@ -838,17 +1270,23 @@ SchedulerWorkerPoolImpl::CreateRegisterAndStartSchedulerWorkerLockRequired() {
 
   DCHECK_LT(workers_.size(), worker_capacity_);
   DCHECK_LT(workers_.size(), kMaxNumberOfWorkers);
+  const size_t local_priority_queue_index =
+      work_stealing_enabled_ ? AssignLocalPriorityQueueLockRequired() : 0;
+
   // SchedulerWorker needs |lock_| as a predecessor for its thread lock
   // because in WakeUpOneWorker, |lock_| is first acquired and then
   // the thread lock is acquired when WakeUp is called on the worker.
   scoped_refptr<SchedulerWorker> worker = MakeRefCounted<SchedulerWorker>(
       priority_hint_,
       std::make_unique<SchedulerWorkerDelegateImpl>(
-          tracked_ref_factory_.GetTrackedRef()),
+          tracked_ref_factory_.GetTrackedRef(), local_priority_queue_index),
       task_tracker_, &lock_, backward_compatibility_);
 
-  if (!worker->Start())
+  if (!worker->Start()) {
+    if (work_stealing_enabled_)
+      ReleaseLocalPriorityQueueLockRequired(local_priority_queue_index);
     return nullptr;
+  }
 
   workers_.push_back(worker);
   DCHECK_LE(workers_.size(), worker_capacity_);
@@ -904,39 +1342,47 @@ TimeDelta SchedulerWorkerPoolImpl::MayBlockThreshold() const {
   if (maximum_blocked_threshold_for_testing_.IsSet())
     return TimeDelta::Max();
   // This value was set unscientifically based on intuition and may be adjusted
-  // in the future. This value is smaller than |kBlockedWorkersPollPeriod|
-  // because we hope than when multiple workers block around the same time, a
-  // single AdjustWorkerCapacity() call will perform all the necessary capacity
-  // adjustments.
+  // in the future.
   return TimeDelta::FromMilliseconds(10);
 }
 
 void SchedulerWorkerPoolImpl::PostAdjustWorkerCapacityTaskIfNeeded() {
+  TimeDelta delay;
   {
     AutoSchedulerLock auto_lock(lock_);
-    if (polling_worker_capacity_ ||
-        !ShouldPeriodicallyAdjustWorkerCapacityLockRequired()) {
+    if (adjust_worker_capacity_task_posted_ ||
+        !ShouldAdjustWorkerCapacityLockRequired()) {
       return;
     }
-    polling_worker_capacity_ = true;
+    delay = GetAdjustWorkerCapacityDelayLockRequired();
+    if (delay.is_max())
+      return;
+    adjust_worker_capacity_task_posted_ = true;
   }
   service_thread_task_runner_->PostDelayedTask(
       FROM_HERE,
       BindOnce(&SchedulerWorkerPoolImpl::AdjustWorkerCapacityTaskFunction,
                Unretained(this)),
-      kBlockedWorkersPollPeriod);
+      delay);
 }
 
 void SchedulerWorkerPoolImpl::AdjustWorkerCapacityTaskFunction() {
   DCHECK(service_thread_task_runner_->RunsTasksInCurrentSequence());
 
   AdjustWorkerCapacity();
+
+  TimeDelta delay;
   {
     AutoSchedulerLock auto_lock(lock_);
-    DCHECK(polling_worker_capacity_);
-
-    if (!ShouldPeriodicallyAdjustWorkerCapacityLockRequired()) {
-      polling_worker_capacity_ = false;
+    DCHECK(adjust_worker_capacity_task_posted_);
+
+    // Schedule the next adjustment for the next worker to reach
+    // MayBlockThreshold(), even if AdjustWorkerCapacity() just created an idle
+    // worker: workers which entered a MAY_BLOCK ScopedBlockingCall around the
+    // same time should all be replaced.
+    delay = GetAdjustWorkerCapacityDelayLockRequired();
+    if (delay.is_max()) {
+      adjust_worker_capacity_task_posted_ = false;
       return;
     }
   }
@@ -944,13 +1390,36 @@ void SchedulerWorkerPoolImpl::AdjustWorkerCapacityTaskFunction() {
       FROM_HERE,
       BindOnce(&SchedulerWorkerPoolImpl::AdjustWorkerCapacityTaskFunction,
                Unretained(this)),
-      kBlockedWorkersPollPeriod);
+      delay);
+}
+
+TimeDelta SchedulerWorkerPoolImpl::GetAdjustWorkerCapacityDelayLockRequired() {
+  lock_.AssertAcquired();
+
+  const TimeDelta may_block_threshold = MayBlockThreshold();
+  if (may_block_threshold.is_max())
+    return TimeDelta::Max();
+
+  TimeTicks earliest_may_block_start_time = TimeTicks::Max();
+  for (const scoped_refptr<SchedulerWorker>& worker : workers_) {
+    const TimeTicks may_block_start_time =
+        static_cast<SchedulerWorkerDelegateImpl*>(worker->delegate())
+            ->may_block_start_time_lock_required();
+    if (!may_block_start_time.is_null()) {
+      earliest_may_block_start_time =
+          std::min(earliest_may_block_start_time, may_block_start_time);
+    }
+  }
+  if (earliest_may_block_start_time.is_max())
+    return TimeDelta::Max();
+
+  return std::max(TimeDelta(), earliest_may_block_start_time +
+                                   may_block_threshold - TimeTicks::Now());
 }
 
-bool SchedulerWorkerPoolImpl::
-    ShouldPeriodicallyAdjustWorkerCapacityLockRequired() {
+bool SchedulerWorkerPoolImpl::ShouldAdjustWorkerCapacityLockRequired() {
   lock_.AssertAcquired();
-  // AdjustWorkerCapacity() must be periodically called when (1) there are no
+  // AdjustWorkerCapacity() must be scheduled when (1) there are no
   // idle workers that can do work (2) there are workers that are within the
   // scope of a MAY_BLOCK ScopedBlockingCall but haven't cause a capacity
   // increment yet.
@@ -975,5 +1444,33 @@ void SchedulerWorkerPoolImpl::IncrementWorkerCapacityLockRequired() {
   ++worker_capacity_;
 }
 
+size_t SchedulerWorkerPoolImpl::AssignLocalPriorityQueueLockRequired() {
+  lock_.AssertAcquired();
+  DCHECK(work_stealing_enabled_);
+
+  // There is always an unused entry since there can't be more than
+  // |kMaxNumberOfWorkers| workers.
+  auto it = std::find(local_priority_queue_in_use_.begin(),
+                      local_priority_queue_in_use_.end(), false);
+  DCHECK(it != local_priority_queue_in_use_.end());
+  *it = true;
+
+  const size_t index = it - local_priority_queue_in_use_.begin();
+  if (index >= num_local_priority_queues_assigned_.load(
+                   std::memory_order_relaxed)) {
+    num_local_priority_queues_assigned_.store(index + 1,
+                                              std::memory_order_release);
+  }
+  return index;
+}
+
+void SchedulerWorkerPoolImpl::ReleaseLocalPriorityQueueLockRequired(
+    size_t index) {
+  lock_.AssertAcquired();
+  DCHECK(work_stealing_enabled_);
+  DCHECK(local_priority_queue_in_use_[index]);
+  local_priority_queue_in_use_[index] = false;
+}
+
 }  // namespace internal
 }  // namespace base
@@ -6,7 +6,9 @@
 #define BASE_TASK_SCHEDULER_SCHEDULER_WORKER_POOL_IMPL_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -91,6 +93,13 @@ class BASE_EXPORT SchedulerWorkerPoolImpl : public SchedulerWorkerPool {
   // SchedulerWorkerPool:
   void JoinForTesting() override;
 
+  // Returns the number of times idle workers found work while polling for it
+  // rather than after being woken up. Always 0 unless the pool was started
+  // with a |max_idle_spin_duration|.
+  uint64_t num_avoided_wakeups() const {
+    return num_avoided_wakeups_.load(std::memory_order_relaxed);
+  }
+
   const HistogramBase* num_tasks_before_detach_histogram() const {
     return num_tasks_before_detach_histogram_;
   }
@@ -99,6 +108,25 @@ class BASE_EXPORT SchedulerWorkerPoolImpl : public SchedulerWorkerPool {
     return num_tasks_between_waits_histogram_;
   }
 
+  const HistogramBase* blocked_worker_replacement_delay_histogram() const {
+    return blocked_worker_replacement_delay_histogram_;
+  }
+
+#if defined(OS_LINUX)
+  const HistogramBase* cpu_time_between_waits_histogram() const {
+    return cpu_time_between_waits_histogram_;
+  }
+
+  const HistogramBase* run_queue_time_between_waits_histogram() const {
+    return run_queue_time_between_waits_histogram_;
+  }
+
+  const HistogramBase* involuntary_context_switches_between_waits_histogram()
+      const {
+    return involuntary_context_switches_between_waits_histogram_;
+  }
+#endif  // defined(OS_LINUX)
+
   void GetHistograms(std::vector<const HistogramBase*>* histograms) const;
 
   // Returns the maximum number of non-blocked tasks that can run concurrently
@@ -141,19 +169,15 @@ class BASE_EXPORT SchedulerWorkerPoolImpl : public SchedulerWorkerPool {
  private:
   class SchedulerWorkerDelegateImpl;
 
-  // Friend tests so that they can access |kBlockedWorkersPollPeriod| and
-  // BlockedThreshold().
+  // Friend tests so that they can access MayBlockThreshold().
   friend class TaskSchedulerWorkerPoolBlockingTest;
   friend class TaskSchedulerWorkerPoolMayBlockTest;
 
-  // The period between calls to AdjustWorkerCapacity() when the pool is at
-  // capacity. This value was set unscientifically based on intuition and may be
-  // adjusted in the future.
-  static constexpr TimeDelta kBlockedWorkersPollPeriod =
-      TimeDelta::FromMilliseconds(50);
-
   // SchedulerWorkerPool:
   void OnCanScheduleSequence(scoped_refptr<Sequence> sequence) override;
+  void OnCanScheduleSequences(
+      std::vector<scoped_refptr<Sequence>> sequences) override;
+  bool HasSequenceWithPriorityAbove(TaskPriority priority) override;
 
   // Waits until at least |n| workers are idle. |lock_| must be held to call
   // this function.
@@ -162,6 +186,10 @@ class BASE_EXPORT SchedulerWorkerPoolImpl : public SchedulerWorkerPool {
   // Wakes up the last worker from this worker pool to go idle, if any.
   void WakeUpOneWorker();
 
+  // Performs the same action as WakeUpOneWorker() |num_workers| times under a
+  // single acquisition of |lock_|, stopping at the pool's capacity.
+  void WakeUpWorkers(size_t num_workers);
+
   // Performs the same action as WakeUpOneWorker() except asserts |lock_| is
   // acquired rather than acquires it and returns true if worker wakeups are
   // permitted.
@@ -201,39 +229,85 @@ class BASE_EXPORT SchedulerWorkerPoolImpl : public SchedulerWorkerPool {
   // compensate for a worker that is within a MAY_BLOCK ScopedBlockingCall.
   TimeDelta MayBlockThreshold() const;
 
-  // Starts calling AdjustWorkerCapacity() periodically on
-  // |service_thread_task_runner_| if not already requested.
+  // Schedules a call to AdjustWorkerCapacity() on
+  // |service_thread_task_runner_| for when the first worker within a MAY_BLOCK
+  // ScopedBlockingCall reaches MayBlockThreshold(), if needed and not already
+  // scheduled.
   void PostAdjustWorkerCapacityTaskIfNeeded();
 
   // Calls AdjustWorkerCapacity() and schedules it again as necessary. May only
   // be called from the service thread.
   void AdjustWorkerCapacityTaskFunction();
 
-  // Returns true if AdjustWorkerCapacity() should periodically be called on
+  // Returns true if AdjustWorkerCapacity() should be scheduled on
   // |service_thread_task_runner_|.
-  bool ShouldPeriodicallyAdjustWorkerCapacityLockRequired();
+  bool ShouldAdjustWorkerCapacityLockRequired();
+
+  // Returns how long until the first worker within a MAY_BLOCK
+  // ScopedBlockingCall that hasn't caused a worker capacity increment reaches
+  // MayBlockThreshold(), or TimeDelta::Max() if none will.
+  TimeDelta GetAdjustWorkerCapacityDelayLockRequired();
 
   void DecrementWorkerCapacityLockRequired();
   void IncrementWorkerCapacityLockRequired();
 
+  // Assigns an unused entry of |local_priority_queues_| to a new worker and
+  // returns its index. Work stealing must be enabled.
+  size_t AssignLocalPriorityQueueLockRequired();
+
+  // Marks the entry of |local_priority_queues_| at |index| as unused. The
+  // PriorityQueue at |index| must be empty.
+  void ReleaseLocalPriorityQueueLockRequired(size_t index);
+
   const std::string pool_label_;
   const ThreadPriority priority_hint_;
 
   // PriorityQueue from which all threads of this worker pool get work.
   PriorityQueue shared_priority_queue_;
 
+  // Whether workers re-enqueue Sequences in worker-local PriorityQueues and
+  // steal work from each other. Initialized by Start(). Never modified
+  // afterwards (i.e. can be read without synchronization after Start()).
+  bool work_stealing_enabled_ = false;
+
+  // Worker-local PriorityQueues. Allocated by Start() when work stealing is
+  // enabled and never resized or released afterwards, so that a worker can
+  // steal from its peers without acquiring |lock_| (a worker that cleans up
+  // leaves behind an empty PriorityQueue that is reused by the next worker).
+  // Each PriorityQueue has |shared_priority_queue_|'s lock as its predecessor
+  // so that a worker can compare the front of its local PriorityQueue with the
+  // front of |shared_priority_queue_|.
+  std::vector<std::unique_ptr<PriorityQueue>> local_priority_queues_;
+
+  // One past the highest index of |local_priority_queues_| that was ever
+  // assigned to a worker. Bounds the search of workers looking for work to
+  // steal.
+  std::atomic<size_t> num_local_priority_queues_assigned_{0};
+
   // Suggested reclaim time for workers. Initialized by Start(). Never modified
   // afterwards (i.e. can be read without synchronization after Start()).
   TimeDelta suggested_reclaim_time_;
 
   SchedulerBackwardCompatibility backward_compatibility_;
 
+  // Logical processors to which workers restrict themselves when they start.
+  // Empty if workers may run on any processor. Initialized by Start(). Never
+  // modified afterwards.
+  std::vector<int> processor_affinity_;
+
+  // How long idle workers poll for work before going to sleep. Initialized by
+  // Start(). Never modified afterwards.
+  TimeDelta max_idle_spin_duration_;
+
+  // Number of wake-ups avoided by idle workers polling for work.
+  std::atomic<uint64_t> num_avoided_wakeups_{0};
+
   // Synchronizes accesses to |workers_|, |worker_capacity_|,
   // |num_pending_may_block_workers_|, |idle_workers_stack_|,
   // |idle_workers_stack_cv_for_testing_|, |num_wake_ups_before_start_|,
-  // |cleanup_timestamps_|, |polling_worker_capacity_|,
+  // |cleanup_timestamps_|, |adjust_worker_capacity_task_posted_|,
   // |worker_cleanup_disallowed_for_testing_|,
-  // |num_workers_cleaned_up_for_testing_|,
+  // |num_workers_cleaned_up_for_testing_|, |local_priority_queue_in_use_|,
   // |SchedulerWorkerDelegateImpl::is_on_idle_workers_stack_|,
   // |SchedulerWorkerDelegateImpl::incremented_worker_capacity_since_blocked_|
   // and |SchedulerWorkerDelegateImpl::may_block_start_time_|. Has
@@ -256,6 +330,9 @@ class BASE_EXPORT SchedulerWorkerPoolImpl : public SchedulerWorkerPool {
   // but haven't caused a worker capacity increase yet.
   int num_pending_may_block_workers_ = 0;
 
+  // Whether each entry of |local_priority_queues_| is assigned to a worker.
+  std::vector<bool> local_priority_queue_in_use_;
+
   // Environment to be initialized per worker.
   WorkerEnvironment worker_environment_ = WorkerEnvironment::NONE;
 
@@ -277,9 +354,9 @@ class BASE_EXPORT SchedulerWorkerPoolImpl : public SchedulerWorkerPool {
   // Timestamps get popped off the stack as new workers are added.
   base::stack<TimeTicks, std::vector<TimeTicks>> cleanup_timestamps_;
 
-  // Whether we are currently polling for necessary adjustments to
-  // |worker_capacity_|.
-  bool polling_worker_capacity_ = false;
+  // Whether a call to AdjustWorkerCapacity() is scheduled on
+  // |service_thread_task_runner_|.
+  bool adjust_worker_capacity_task_posted_ = false;
 
   // Indicates to the delegates that workers are not permitted to cleanup.
   bool worker_cleanup_disallowed_for_testing_ = false;
@@ -314,6 +391,24 @@ class BASE_EXPORT SchedulerWorkerPoolImpl : public SchedulerWorkerPool {
   // Intentionally leaked.
   HistogramBase* const num_tasks_between_waits_histogram_;
 
+  // TaskScheduler.BlockedWorkerReplacementDelay.[worker pool name] histogram.
+  // Intentionally leaked.
+  HistogramBase* const blocked_worker_replacement_delay_histogram_;
+
+#if defined(OS_LINUX)
+  // TaskScheduler.CpuTimeBetweenWaits.[worker pool name] histogram.
+  // Intentionally leaked.
+  HistogramBase* const cpu_time_between_waits_histogram_;
+
+  // TaskScheduler.RunQueueTimeBetweenWaits.[worker pool name] histogram.
+  // Intentionally leaked.
+  HistogramBase* const run_queue_time_between_waits_histogram_;
+
+  // TaskScheduler.InvoluntaryContextSwitchesBetweenWaits.[worker pool name]
+  // histogram. Intentionally leaked.
+  HistogramBase* const involuntary_context_switches_between_waits_histogram_;
+#endif  // defined(OS_LINUX)
+
   scoped_refptr<TaskRunner> service_thread_task_runner_;
 
   // Ensures recently cleaned up workers (ref.
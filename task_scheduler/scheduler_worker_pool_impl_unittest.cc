@@ -46,6 +46,10 @@
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+#if defined(OS_LINUX)
+#include <sched.h>
+#endif
+
 #if defined(OS_WIN)
 #include "base/win/com_init_util.h"
 #endif  // defined(OS_WIN)
@@ -305,6 +309,180 @@ INSTANTIATE_TEST_CASE_P(Sequenced,
                         TaskSchedulerWorkerPoolImplTestParam,
                         ::testing::Values(test::ExecutionMode::SEQUENCED));
 
+namespace {
+
+class TaskSchedulerWorkerPoolImplWorkStealingTest
+    : public TaskSchedulerWorkerPoolImplTestBase,
+      public testing::TestWithParam<test::ExecutionMode> {
+ protected:
+  TaskSchedulerWorkerPoolImplWorkStealingTest() = default;
+
+  void SetUp() override { TaskSchedulerWorkerPoolImplTestBase::CommonSetUp(); }
+
+  void TearDown() override {
+    TaskSchedulerWorkerPoolImplTestBase::CommonTearDown();
+  }
+
+ private:
+  void StartWorkerPool(TimeDelta suggested_reclaim_time,
+                       size_t num_workers) override {
+    ASSERT_TRUE(worker_pool_);
+    worker_pool_->Start(
+        SchedulerWorkerPoolParams(num_workers, suggested_reclaim_time,
+                                  SchedulerBackwardCompatibility::DISABLED,
+                                  SchedulerWorkStealing::ENABLED),
+        service_thread_.task_runner(),
+        SchedulerWorkerPoolImpl::WorkerEnvironment::NONE);
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(TaskSchedulerWorkerPoolImplWorkStealingTest);
+};
+
+}  // namespace
+
+TEST_P(TaskSchedulerWorkerPoolImplWorkStealingTest,
+       PostTasksWaitAllWorkersIdle) {
+  std::vector<std::unique_ptr<ThreadPostingTasksWaitIdle>>
+      threads_posting_tasks;
+  for (size_t i = 0; i < kNumThreadsPostingTasks; ++i) {
+    threads_posting_tasks.push_back(
+        std::make_unique<ThreadPostingTasksWaitIdle>(worker_pool_.get(),
+                                                     GetParam()));
+    threads_posting_tasks.back()->Start();
+  }
+
+  for (const auto& thread_posting_tasks : threads_posting_tasks) {
+    thread_posting_tasks->Join();
+    thread_posting_tasks->factory()->WaitForAllTasksToRun();
+  }
+
+  worker_pool_->WaitForAllWorkersIdleForTesting();
+}
+
+// Verify that Sequences re-enqueued in the local PriorityQueue of a worker that
+// becomes busy are run by its peers.
+TEST_P(TaskSchedulerWorkerPoolImplWorkStealingTest, PeersRunLocalSequences) {
+  // Post many tasks to many Sequences so that workers re-enqueue Sequences in
+  // their local PriorityQueues.
+  std::vector<std::unique_ptr<test::TestTaskFactory>> factories;
+  for (size_t i = 0; i < kNumWorkersInWorkerPool * 2; ++i) {
+    factories.push_back(std::make_unique<test::TestTaskFactory>(
+        CreateTaskRunnerWithExecutionMode(worker_pool_.get(), GetParam()),
+        GetParam()));
+    for (size_t j = 0; j < kNumTasksPostedPerThread; ++j)
+      EXPECT_TRUE(factories.back()->PostTask(PostNestedTask::NO, Closure()));
+  }
+
+  // Block all workers but one. The tasks of all Sequences must still run.
+  WaitableEvent event(WaitableEvent::ResetPolicy::MANUAL,
+                      WaitableEvent::InitialState::NOT_SIGNALED);
+  std::vector<std::unique_ptr<test::TestTaskFactory>> blocked_task_factories;
+  for (size_t i = 0; i < (kNumWorkersInWorkerPool - 1); ++i) {
+    blocked_task_factories.push_back(std::make_unique<test::TestTaskFactory>(
+        CreateTaskRunnerWithExecutionMode(worker_pool_.get(), GetParam()),
+        GetParam()));
+    EXPECT_TRUE(blocked_task_factories.back()->PostTask(
+        PostNestedTask::NO,
+        BindOnce(&WaitWithoutBlockingObserver, Unretained(&event))));
+  }
+  for (const auto& factory : blocked_task_factories)
+    factory->WaitForAllTasksToRun();
+
+  for (const auto& factory : factories)
+    factory->WaitForAllTasksToRun();
+
+  event.Signal();
+  worker_pool_->WaitForAllWorkersIdleForTesting();
+}
+
+INSTANTIATE_TEST_CASE_P(Parallel,
+                        TaskSchedulerWorkerPoolImplWorkStealingTest,
+                        ::testing::Values(test::ExecutionMode::PARALLEL));
+INSTANTIATE_TEST_CASE_P(Sequenced,
+                        TaskSchedulerWorkerPoolImplWorkStealingTest,
+                        ::testing::Values(test::ExecutionMode::SEQUENCED));
+
+namespace {
+
+class TaskSchedulerWorkerPoolImplSequenceBatchTest
+    : public TaskSchedulerWorkerPoolImplTestBase,
+      public testing::Test {
+ protected:
+  TaskSchedulerWorkerPoolImplSequenceBatchTest() = default;
+
+  void SetUp() override { CreateAndStartWorkerPool(TimeDelta::Max(), 1); }
+
+  void TearDown() override {
+    TaskSchedulerWorkerPoolImplTestBase::CommonTearDown();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TaskSchedulerWorkerPoolImplSequenceBatchTest);
+};
+
+}  // namespace
+
+// Verify that a worker running consecutive tasks from a Sequence switches to a
+// Sequence of higher priority as soon as one is waiting.
+TEST_F(TaskSchedulerWorkerPoolImplSequenceBatchTest,
+       HigherPrioritySequencePreemptsBatch) {
+  constexpr int kNumBackgroundTasks = 10;
+  WaitableEvent unblock(WaitableEvent::ResetPolicy::MANUAL,
+                        WaitableEvent::InitialState::NOT_SIGNALED);
+  WaitableEvent blocked(WaitableEvent::ResetPolicy::MANUAL,
+                        WaitableEvent::InitialState::NOT_SIGNALED);
+  WaitableEvent user_visible_task_ran(
+      WaitableEvent::ResetPolicy::MANUAL,
+      WaitableEvent::InitialState::NOT_SIGNALED);
+  int num_background_tasks_run = 0;
+  int num_run_before_user_visible_task = -1;
+
+  scoped_refptr<SequencedTaskRunner> background_task_runner =
+      worker_pool_->CreateSequencedTaskRunnerWithTraits(
+          {TaskPriority::BACKGROUND, WithBaseSyncPrimitives()});
+  background_task_runner->PostTask(
+      FROM_HERE, BindOnce(
+                     [](WaitableEvent* blocked, WaitableEvent* unblock,
+                        int* num_background_tasks_run) {
+                       blocked->Signal();
+                       WaitWithoutBlockingObserver(unblock);
+                       ++*num_background_tasks_run;
+                     },
+                     Unretained(&blocked), Unretained(&unblock),
+                     Unretained(&num_background_tasks_run)));
+  blocked.Wait();
+  for (int i = 0; i < kNumBackgroundTasks; ++i) {
+    background_task_runner->PostTask(
+        FROM_HERE, BindOnce([](int* num_background_tasks_run) {
+                     ++*num_background_tasks_run;
+                   },
+                   Unretained(&num_background_tasks_run)));
+  }
+
+  // The pool has a single worker, so the counters aren't accessed
+  // concurrently.
+  worker_pool_->CreateTaskRunnerWithTraits({TaskPriority::USER_VISIBLE})
+      ->PostTask(FROM_HERE,
+                 BindOnce(
+                     [](int* num_background_tasks_run,
+                        int* num_run_before_user_visible_task,
+                        WaitableEvent* user_visible_task_ran) {
+                       *num_run_before_user_visible_task =
+                           *num_background_tasks_run;
+                       user_visible_task_ran->Signal();
+                     },
+                     Unretained(&num_background_tasks_run),
+                     Unretained(&num_run_before_user_visible_task),
+                     Unretained(&user_visible_task_ran)));
+
+  unblock.Signal();
+  user_visible_task_ran.Wait();
+  EXPECT_EQ(1, num_run_before_user_visible_task);
+
+  task_tracker_.FlushForTesting();
+  EXPECT_EQ(kNumBackgroundTasks + 1, num_background_tasks_run);
+}
+
 #if defined(OS_WIN)
 
 namespace {
@@ -365,6 +543,78 @@ INSTANTIATE_TEST_CASE_P(Sequenced,
 
 #endif  // defined(OS_WIN)
 
+#if defined(OS_LINUX)
+
+namespace {
+
+// Returns the first logical processor on which the current thread may run.
+int GetFirstAllowedProcessor() {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CHECK_EQ(0, sched_getaffinity(0, sizeof(cpu_set), &cpu_set));
+  for (int processor = 0; processor < CPU_SETSIZE; ++processor) {
+    if (CPU_ISSET(processor, &cpu_set))
+      return processor;
+  }
+  NOTREACHED();
+  return 0;
+}
+
+class TaskSchedulerWorkerPoolImplAffinityTest
+    : public TaskSchedulerWorkerPoolImplTestBase,
+      public testing::Test {
+ protected:
+  TaskSchedulerWorkerPoolImplAffinityTest() = default;
+
+  void SetUp() override { TaskSchedulerWorkerPoolImplTestBase::CommonSetUp(); }
+
+  void TearDown() override {
+    TaskSchedulerWorkerPoolImplTestBase::CommonTearDown();
+  }
+
+  const int processor_ = GetFirstAllowedProcessor();
+
+ private:
+  void StartWorkerPool(TimeDelta suggested_reclaim_time,
+                       size_t num_workers) override {
+    ASSERT_TRUE(worker_pool_);
+    worker_pool_->Start(
+        SchedulerWorkerPoolParams(num_workers, suggested_reclaim_time,
+                                  SchedulerBackwardCompatibility::DISABLED,
+                                  SchedulerWorkStealing::DISABLED,
+                                  {processor_}),
+        service_thread_.task_runner(),
+        SchedulerWorkerPoolImpl::WorkerEnvironment::NONE);
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(TaskSchedulerWorkerPoolImplAffinityTest);
+};
+
+}  // namespace
+
+// Verify that workers run only on the processors in the pool's affinity.
+TEST_F(TaskSchedulerWorkerPoolImplAffinityTest, WorkersHaveAffinity) {
+  WaitableEvent task_ran(WaitableEvent::ResetPolicy::MANUAL,
+                         WaitableEvent::InitialState::NOT_SIGNALED);
+  worker_pool_->CreateTaskRunnerWithTraits({})->PostTask(
+      FROM_HERE, BindOnce(
+                     [](int processor, WaitableEvent* task_ran) {
+                       cpu_set_t cpu_set;
+                       CPU_ZERO(&cpu_set);
+                       ASSERT_EQ(0, sched_getaffinity(0, sizeof(cpu_set),
+                                                      &cpu_set));
+                       EXPECT_EQ(1, CPU_COUNT(&cpu_set));
+                       EXPECT_TRUE(CPU_ISSET(processor, &cpu_set));
+                       task_ran->Signal();
+                     },
+                     processor_, Unretained(&task_ran)));
+  task_ran.Wait();
+
+  worker_pool_->WaitForAllWorkersIdleForTesting();
+}
+
+#endif  // defined(OS_LINUX)
+
 namespace {
 
 class TaskSchedulerWorkerPoolImplPostTaskBeforeStartTest
@@ -687,6 +937,41 @@ TEST_F(TaskSchedulerWorkerPoolHistogramTest,
   worker_pool_->WaitForAllWorkersIdleForTesting();
 }
 
+#if defined(OS_LINUX)
+TEST_F(TaskSchedulerWorkerPoolHistogramTest, CpuTimeBetweenWaits) {
+  CreateAndStartWorkerPool(TimeDelta::Max(), kNumWorkersInWorkerPool);
+  auto task_runner = worker_pool_->CreateSequencedTaskRunnerWithTraits({});
+
+  // Post a task which uses 20 ms of CPU time.
+  task_runner->PostTask(FROM_HERE, BindOnce([]() {
+                          const ThreadTicks end =
+                              ThreadTicks::Now() +
+                              TimeDelta::FromMilliseconds(20);
+                          while (ThreadTicks::Now() < end) {
+                          }
+                        }));
+  worker_pool_->WaitForAllWorkersIdleForTesting();
+
+  // The histograms are recorded right before the worker waits. Make sure that
+  // it did, by waking it up.
+  task_runner->PostTask(FROM_HERE, DoNothing());
+  worker_pool_->WaitForAllWorkersIdleForTesting();
+
+  std::unique_ptr<HistogramSamples> samples =
+      worker_pool_->cpu_time_between_waits_histogram()->SnapshotSamples();
+  EXPECT_GE(samples->TotalCount(), 1);
+  EXPECT_GE(samples->sum(), 20);
+  EXPECT_GE(worker_pool_->run_queue_time_between_waits_histogram()
+                ->SnapshotSamples()
+                ->TotalCount(),
+            1);
+  EXPECT_GE(worker_pool_->involuntary_context_switches_between_waits_histogram()
+                ->SnapshotSamples()
+                ->TotalCount(),
+            1);
+}
+#endif  // defined(OS_LINUX)
+
 TEST_F(TaskSchedulerWorkerPoolHistogramTest, NumTasksBeforeCleanup) {
   // Strictly use two workers for this test to avoid depending on the
   // scheduler's logic to always keep one extra idle worker.
@@ -968,9 +1253,7 @@ class TaskSchedulerWorkerPoolBlockingTest
   // Returns how long we can expect a change to |worker_capacity_| to occur
   // after a task has become blocked.
   TimeDelta GetWorkerCapacityChangeSleepTime() {
-    return std::max(SchedulerWorkerPoolImpl::kBlockedWorkersPollPeriod,
-                    worker_pool_->MayBlockThreshold()) +
-           TestTimeouts::tiny_timeout();
+    return worker_pool_->MayBlockThreshold() + TestTimeouts::tiny_timeout();
   }
 
   // Waits indefinitely, until |worker_pool_|'s worker capacity increases to
@@ -1275,6 +1558,72 @@ TEST_F(TaskSchedulerWorkerPoolBlockingTest,
             kNumWorkersInWorkerPool);
 }
 
+// Verify that a MAY_BLOCK ScopedBlockingCall instantiated shortly after a
+// ScopedBlockingCall which incremented the worker capacity increments it right
+// away, without waiting for MayBlockThreshold().
+TEST_F(TaskSchedulerWorkerPoolBlockingTest, MayBlockAfterWillBlock) {
+  ASSERT_EQ(worker_pool_->GetWorkerCapacityForTesting(),
+            kNumWorkersInWorkerPool);
+  worker_pool_->MaximizeMayBlockThresholdForTesting();
+  WaitableEvent can_return(WaitableEvent::ResetPolicy::MANUAL,
+                           WaitableEvent::InitialState::NOT_SIGNALED);
+
+  // Saturate the pool so that a MAY_BLOCK ScopedBlockingCall would increment
+  // the worker capacity.
+  for (size_t i = 0; i < kNumWorkersInWorkerPool - 1; ++i) {
+    task_runner_->PostTask(FROM_HERE, BindOnce(&WaitWithoutBlockingObserver,
+                                               Unretained(&can_return)));
+  }
+
+  WaitableEvent did_instantiate_may_block(
+      WaitableEvent::ResetPolicy::MANUAL,
+      WaitableEvent::InitialState::NOT_SIGNALED);
+  task_runner_->PostTask(
+      FROM_HERE,
+      BindOnce(
+          [](WaitableEvent* did_instantiate_may_block,
+             WaitableEvent* can_return) {
+            { ScopedBlockingCall will_block(BlockingType::WILL_BLOCK); }
+            ScopedBlockingCall may_block(BlockingType::MAY_BLOCK);
+            did_instantiate_may_block->Signal();
+            WaitWithoutBlockingObserver(can_return);
+          },
+          Unretained(&did_instantiate_may_block), Unretained(&can_return)));
+
+  // The worker capacity was incremented although MayBlockThreshold() is never
+  // reached.
+  did_instantiate_may_block.Wait();
+  EXPECT_EQ(kNumWorkersInWorkerPool + 1,
+            worker_pool_->GetWorkerCapacityForTesting());
+
+  can_return.Signal();
+  task_tracker_.FlushForTesting();
+  EXPECT_EQ(worker_pool_->GetWorkerCapacityForTesting(),
+            kNumWorkersInWorkerPool);
+}
+
+// Verify that the delay before a worker within a MAY_BLOCK ScopedBlockingCall
+// is replaced is recorded.
+TEST_F(TaskSchedulerWorkerPoolBlockingTest, BlockedWorkerReplacementDelay) {
+  // The histogram is shared with the other pools of the same name.
+  const auto* histogram =
+      worker_pool_->blocked_worker_replacement_delay_histogram();
+  const int initial_count = histogram->SnapshotSamples()->TotalCount();
+
+  SaturateWithBlockingTasks(NestedBlockingType(BlockingType::MAY_BLOCK,
+                                               OptionalBlockingType::NO_BLOCK,
+                                               BlockingType::MAY_BLOCK));
+  ExpectWorkerCapacityIncreasesTo(2 * kNumWorkersInWorkerPool);
+
+  std::unique_ptr<HistogramSamples> samples = histogram->SnapshotSamples();
+  EXPECT_EQ(static_cast<int>(kNumWorkersInWorkerPool),
+            samples->TotalCount() - initial_count);
+  EXPECT_EQ(0, samples->GetCount(0));
+
+  UnblockTasks();
+  task_tracker_.FlushForTesting();
+}
+
 // Verify that workers that become idle due to the pool being over capacity will
 // eventually cleanup.
 TEST(TaskSchedulerWorkerPoolOverWorkerCapacityTest, VerifyCleanup) {
@@ -4,15 +4,23 @@
 
 #include "base/task_scheduler/scheduler_worker_pool_params.h"
 
+#include <utility>
+
 namespace base {
 
 SchedulerWorkerPoolParams::SchedulerWorkerPoolParams(
     int max_threads,
     TimeDelta suggested_reclaim_time,
-    SchedulerBackwardCompatibility backward_compatibility)
+    SchedulerBackwardCompatibility backward_compatibility,
+    SchedulerWorkStealing work_stealing,
+    std::vector<int> processor_affinity,
+    TimeDelta max_idle_spin_duration)
     : max_threads_(max_threads),
       suggested_reclaim_time_(suggested_reclaim_time),
-      backward_compatibility_(backward_compatibility) {}
+      backward_compatibility_(backward_compatibility),
+      work_stealing_(work_stealing),
+      processor_affinity_(std::move(processor_affinity)),
+      max_idle_spin_duration_(max_idle_spin_duration) {}
 
 SchedulerWorkerPoolParams::SchedulerWorkerPoolParams(
     const SchedulerWorkerPoolParams& other) = default;
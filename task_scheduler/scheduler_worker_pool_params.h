@@ -5,23 +5,48 @@
 #ifndef BASE_TASK_SCHEDULER_SCHEDULER_WORKER_POOL_PARAMS_H_
 #define BASE_TASK_SCHEDULER_SCHEDULER_WORKER_POOL_PARAMS_H_
 
+#include <vector>
+
 #include "base/task_scheduler/scheduler_worker_params.h"
 #include "base/time/time.h"
 
 namespace base {
 
+enum class SchedulerWorkStealing {
+  // All workers get work from the pool's shared PriorityQueue.
+  DISABLED,
+
+  // Each worker keeps the Sequences it re-enqueues in a worker-local
+  // PriorityQueue and steals from its peers' local PriorityQueues when it runs
+  // out of work. The shared PriorityQueue still receives newly scheduled
+  // Sequences and is periodically consulted for cross-priority fairness.
+  ENABLED,
+};
+
 class BASE_EXPORT SchedulerWorkerPoolParams final {
  public:
   // Constructs a set of params used to initialize a pool. The pool will contain
   // up to |max_threads|. |suggested_reclaim_time| sets a suggestion on when to
   // reclaim idle threads. The pool is free to ignore this value for performance
   // or correctness reasons. |backward_compatibility| indicates whether backward
-  // compatibility is enabled.
+  // compatibility is enabled. |work_stealing| indicates whether workers
+  // should use worker-local queues and steal work from each other.
+  // |processor_affinity|, if not empty, lists the logical processors to which
+  // the pool's workers are restricted, e.g. those of a NUMA node as returned by
+  // SysInfo::NumaNodeProcessors(), so that they don't migrate to processors
+  // away from the memory they use. It is only honored on Linux.
+  // |max_idle_spin_duration|, if not zero, is how long at most idle workers
+  // poll for work before going to sleep (see AdaptiveSpinWaiter). This is only
+  // worth it for pools whose tasks are latency-critical and come in every few
+  // microseconds, since the polling burns CPU time.
   SchedulerWorkerPoolParams(
       int max_threads,
       TimeDelta suggested_reclaim_time,
       SchedulerBackwardCompatibility backward_compatibility =
-          SchedulerBackwardCompatibility::DISABLED);
+          SchedulerBackwardCompatibility::DISABLED,
+      SchedulerWorkStealing work_stealing = SchedulerWorkStealing::DISABLED,
+      std::vector<int> processor_affinity = std::vector<int>(),
+      TimeDelta max_idle_spin_duration = TimeDelta());
 
   SchedulerWorkerPoolParams(const SchedulerWorkerPoolParams& other);
   SchedulerWorkerPoolParams& operator=(const SchedulerWorkerPoolParams& other);
@@ -31,11 +56,19 @@ class BASE_EXPORT SchedulerWorkerPoolParams final {
   SchedulerBackwardCompatibility backward_compatibility() const {
     return backward_compatibility_;
   }
+  SchedulerWorkStealing work_stealing() const { return work_stealing_; }
+  const std::vector<int>& processor_affinity() const {
+    return processor_affinity_;
+  }
+  TimeDelta max_idle_spin_duration() const { return max_idle_spin_duration_; }
 
  private:
   int max_threads_;
   TimeDelta suggested_reclaim_time_;
   SchedulerBackwardCompatibility backward_compatibility_;
+  SchedulerWorkStealing work_stealing_;
+  std::vector<int> processor_affinity_;
+  TimeDelta max_idle_spin_duration_;
 };
 
 }  // namespace base
@@ -4,7 +4,9 @@
 
 #include "base/task_scheduler/scheduler_worker_pool.h"
 
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/bind_helpers.h"
@@ -207,6 +209,44 @@ TEST_P(TaskSchedulerWorkerPoolTest, NestedPostTasks) {
   task_tracker_.FlushForTesting();
 }
 
+// Verify that all tasks posted as a batch run, in order for a sequenced
+// TaskRunner.
+TEST_P(TaskSchedulerWorkerPoolTest, PostTasksAsBatch) {
+  constexpr int kNumTasks = 1000;
+  StartWorkerPool();
+  auto task_runner = test::CreateTaskRunnerWithExecutionMode(
+      worker_pool_.get(), GetParam().execution_mode);
+
+  std::atomic_int num_tasks_run(0);
+  std::vector<OnceClosure> tasks;
+  for (int i = 0; i < kNumTasks; ++i) {
+    tasks.push_back(BindOnce(
+        [](int index, test::ExecutionMode execution_mode,
+           std::atomic_int* num_tasks_run) {
+          const int previous_num_tasks_run = num_tasks_run->fetch_add(1);
+          if (execution_mode == test::ExecutionMode::SEQUENCED)
+            EXPECT_EQ(index, previous_num_tasks_run);
+        },
+        i, GetParam().execution_mode, Unretained(&num_tasks_run)));
+  }
+  EXPECT_TRUE(task_runner->PostTasks(FROM_HERE, std::move(tasks)));
+
+  task_tracker_.FlushForTesting();
+  EXPECT_EQ(kNumTasks, num_tasks_run.load());
+}
+
+// Verify that a batch of tasks can't be posted after shutdown.
+TEST_P(TaskSchedulerWorkerPoolTest, PostTasksAsBatchAfterShutdown) {
+  StartWorkerPool();
+  auto task_runner = test::CreateTaskRunnerWithExecutionMode(
+      worker_pool_.get(), GetParam().execution_mode);
+  task_tracker_.Shutdown();
+  std::vector<OnceClosure> tasks;
+  tasks.push_back(BindOnce(&ShouldNotRun));
+  tasks.push_back(BindOnce(&ShouldNotRun));
+  EXPECT_FALSE(task_runner->PostTasks(FROM_HERE, std::move(tasks)));
+}
+
 // Verify that a Task can't be posted after shutdown.
 TEST_P(TaskSchedulerWorkerPoolTest, PostTaskAfterShutdown) {
   StartWorkerPool();
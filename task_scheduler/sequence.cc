@@ -22,11 +22,35 @@ bool Sequence::PushTask(Task task) {
   task.sequenced_time = base::TimeTicks::Now();
 
   AutoSchedulerLock auto_lock(lock_);
+  const bool was_empty = queue_.empty();
+  if (was_empty && task.is_sampled)
+    task.front_of_sequence_time = task.sequenced_time;
   ++num_tasks_per_priority_[static_cast<int>(task.traits.priority())];
   queue_.push(std::move(task));
 
-  // Return true if the sequence was empty before the push.
-  return queue_.size() == 1;
+  return was_empty;
+}
+
+bool Sequence::PushTasks(std::vector<Task> tasks) {
+  DCHECK(!tasks.empty());
+  const TimeTicks sequenced_time = TimeTicks::Now();
+  for (Task& task : tasks) {
+    // Use CHECK instead of DCHECK to crash earlier. See
+    // http://crbug.com/711167 for details.
+    CHECK(task.task);
+    DCHECK(task.sequenced_time.is_null());
+    task.sequenced_time = sequenced_time;
+  }
+
+  AutoSchedulerLock auto_lock(lock_);
+  const bool was_empty = queue_.empty();
+  if (was_empty && tasks.front().is_sampled)
+    tasks.front().front_of_sequence_time = sequenced_time;
+  for (Task& task : tasks) {
+    ++num_tasks_per_priority_[static_cast<int>(task.traits.priority())];
+    queue_.push(std::move(task));
+  }
+  return was_empty;
 }
 
 Optional<Task> Sequence::TakeTask() {
@@ -53,12 +77,22 @@ bool Sequence::Pop() {
   DCHECK(!queue_.empty());
   DCHECK(!queue_.front().task);
   queue_.pop();
-  return queue_.empty();
+  if (queue_.empty())
+    return true;
+  if (queue_.front().is_sampled)
+    queue_.front().front_of_sequence_time = TimeTicks::Now();
+  return false;
+}
+
+size_t Sequence::GetNumTasks() const {
+  AutoSchedulerLock auto_lock(lock_);
+  return queue_.size();
 }
 
 SequenceSortKey Sequence::GetSortKey() const {
   TaskPriority priority = TaskPriority::LOWEST;
   base::TimeTicks next_task_sequenced_time;
+  base::TimeTicks next_task_deadline = base::TimeTicks::Max();
 
   {
     AutoSchedulerLock auto_lock(lock_);
@@ -74,11 +108,18 @@ SequenceSortKey Sequence::GetSortKey() const {
       }
     }
 
-    // Save the sequenced time of the next task in the sequence.
-    next_task_sequenced_time = queue_.front().sequenced_time;
+    // Save the sequenced time and the start deadline of the next task in the
+    // sequence.
+    const Task& next_task = queue_.front();
+    next_task_sequenced_time = next_task.sequenced_time;
+    if (next_task.traits.has_start_deadline()) {
+      next_task_deadline =
+          next_task.sequenced_time + next_task.traits.start_deadline();
+    }
   }
 
-  return SequenceSortKey(priority, next_task_sequenced_time);
+  return SequenceSortKey(priority, next_task_sequenced_time,
+                         next_task_deadline);
 }
 
 Sequence::~Sequence() = default;
@@ -7,7 +7,10 @@
 
 #include <stddef.h>
 
+#include <vector>
+
 #include "base/base_export.h"
+#include "base/containers/chunked_deque.h"
 #include "base/containers/queue.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
@@ -48,6 +51,11 @@ class BASE_EXPORT Sequence : public RefCountedThreadSafe<Sequence> {
   // Sequence was empty before this operation.
   bool PushTask(Task task);
 
+  // Adds |tasks|, in order, at the end of the Sequence under a single lock
+  // acquisition. |tasks| must not be empty. Returns true if the Sequence was
+  // empty before this operation.
+  bool PushTasks(std::vector<Task> tasks);
+
   // Transfers ownership of the Task in the front slot of the Sequence to the
   // caller. The front slot of the Sequence will be nullptr and remain until
   // Pop(). Cannot be called on an empty Sequence or a Sequence whose front slot
@@ -68,6 +76,10 @@ class BASE_EXPORT Sequence : public RefCountedThreadSafe<Sequence> {
   // Sequence. Returns true if the Sequence is empty after this operation.
   bool Pop();
 
+  // Returns the number of slots in the Sequence, including a front slot
+  // emptied by TakeTask().
+  size_t GetNumTasks() const;
+
   // Returns a SequenceSortKey representing the priority of the Sequence. Cannot
   // be called on an empty Sequence.
   SequenceSortKey GetSortKey() const;
@@ -88,8 +100,8 @@ class BASE_EXPORT Sequence : public RefCountedThreadSafe<Sequence> {
   // Synchronizes access to all members.
   mutable SchedulerLock lock_;
 
-  // Queue of tasks to execute.
-  base::queue<Task> queue_;
+  // Queue of tasks to execute. Grows by blocks, without moving the tasks.
+  base::queue<Task, chunked_deque<Task>> queue_;
 
   // Number of tasks contained in the Sequence for each priority.
   size_t num_tasks_per_priority_[static_cast<int>(TaskPriority::HIGHEST) + 1] =
@@ -8,20 +8,25 @@ namespace base {
 namespace internal {
 
 SequenceSortKey::SequenceSortKey(TaskPriority priority,
-                                 TimeTicks next_task_sequenced_time)
+                                 TimeTicks next_task_sequenced_time,
+                                 TimeTicks next_task_deadline)
     : priority_(priority),
-      next_task_sequenced_time_(next_task_sequenced_time) {}
+      next_task_sequenced_time_(next_task_sequenced_time),
+      next_task_deadline_(next_task_deadline) {}
 
 bool SequenceSortKey::operator<(const SequenceSortKey& other) const {
   // This SequenceSortKey is considered less important than |other| if it has a
-  // lower priority or if it has the same priority but its next task was posted
-  // later than |other|'s.
+  // lower priority, or if it has the same priority but its next task has a
+  // later start deadline (no deadline being the latest), or if their deadlines
+  // are the same but its next task was posted later than |other|'s.
   const int priority_diff =
       static_cast<int>(priority_) - static_cast<int>(other.priority_);
   if (priority_diff < 0)
     return true;
   if (priority_diff > 0)
     return false;
+  if (next_task_deadline_ != other.next_task_deadline_)
+    return next_task_deadline_ > other.next_task_deadline_;
   return next_task_sequenced_time_ > other.next_task_sequenced_time_;
 }
 
@@ -15,19 +15,23 @@ namespace internal {
 // An immutable but assignable representation of the priority of a Sequence.
 class BASE_EXPORT SequenceSortKey final {
  public:
-  SequenceSortKey(TaskPriority priority, TimeTicks next_task_sequenced_time);
+  SequenceSortKey(TaskPriority priority,
+                  TimeTicks next_task_sequenced_time,
+                  TimeTicks next_task_deadline = TimeTicks::Max());
 
   TaskPriority priority() const { return priority_; }
   TimeTicks next_task_sequenced_time() const {
     return next_task_sequenced_time_;
   }
+  TimeTicks next_task_deadline() const { return next_task_deadline_; }
 
   bool operator<(const SequenceSortKey& other) const;
   bool operator>(const SequenceSortKey& other) const { return other < *this; }
 
   bool operator==(const SequenceSortKey& other) const {
     return priority_ == other.priority_ &&
-           next_task_sequenced_time_ == other.next_task_sequenced_time_;
+           next_task_sequenced_time_ == other.next_task_sequenced_time_ &&
+           next_task_deadline_ == other.next_task_deadline_;
   }
   bool operator!=(const SequenceSortKey& other) const {
     return !(other == *this);
@@ -44,6 +48,10 @@ class BASE_EXPORT SequenceSortKey final {
   // Sequenced time of the next task to run in the sequence at the time this
   // sort key was created.
   TimeTicks next_task_sequenced_time_;
+
+  // Time by which the next task to run in the sequence should start, per its
+  // StartWithin trait. TimeTicks::Max() if it has no deadline.
+  TimeTicks next_task_deadline_;
 };
 
 }  // namespace internal
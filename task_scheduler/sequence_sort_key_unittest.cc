@@ -239,5 +239,30 @@ TEST(TaskSchedulerSequenceSortKeyTest, OperatorNotEqual) {
   EXPECT_FALSE(key_f != key_f);
 }
 
+// Verify that within a priority, a key whose next task has an earlier start
+// deadline is more important, regardless of sequenced times, and that keys with
+// a deadline are more important than keys without one.
+TEST(TaskSchedulerSequenceSortKeyTest, OperatorLessThanWithDeadline) {
+  SequenceSortKey key_a(TaskPriority::USER_VISIBLE,
+                        TimeTicks::FromInternalValue(2000),
+                        TimeTicks::FromInternalValue(3000));
+  SequenceSortKey key_b(TaskPriority::USER_VISIBLE,
+                        TimeTicks::FromInternalValue(1000),
+                        TimeTicks::FromInternalValue(4000));
+  SequenceSortKey key_c(TaskPriority::USER_VISIBLE,
+                        TimeTicks::FromInternalValue(500));
+  SequenceSortKey key_d(TaskPriority::USER_BLOCKING,
+                        TimeTicks::FromInternalValue(2000));
+
+  EXPECT_FALSE(key_a < key_a);
+  EXPECT_LT(key_b, key_a);
+  EXPECT_LT(key_c, key_a);
+  EXPECT_LT(key_c, key_b);
+  EXPECT_LT(key_a, key_d);
+  EXPECT_LT(key_b, key_d);
+  EXPECT_NE(key_a, SequenceSortKey(TaskPriority::USER_VISIBLE,
+                                   TimeTicks::FromInternalValue(2000)));
+}
+
 }  // namespace internal
 }  // namespace base
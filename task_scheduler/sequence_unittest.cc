@@ -5,6 +5,7 @@
 #include "base/task_scheduler/sequence.h"
 
 #include <utility>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/bind_helpers.h"
@@ -94,6 +95,37 @@ TEST(TaskSchedulerSequenceTest, PushTakeRemove) {
   EXPECT_TRUE(sequence->Pop());
 }
 
+TEST(TaskSchedulerSequenceTest, PushTasks) {
+  testing::StrictMock<MockTask> mock_task_a;
+  testing::StrictMock<MockTask> mock_task_b;
+  testing::StrictMock<MockTask> mock_task_c;
+
+  scoped_refptr<Sequence> sequence = MakeRefCounted<Sequence>();
+
+  // PushTasks() should return true since the sequence was empty.
+  std::vector<Task> tasks;
+  tasks.push_back(CreateTask(&mock_task_a));
+  tasks.push_back(CreateTask(&mock_task_b));
+  EXPECT_TRUE(sequence->PushTasks(std::move(tasks)));
+
+  // PushTasks() should return false since the sequence isn't empty.
+  tasks.clear();
+  tasks.push_back(CreateTask(&mock_task_c));
+  EXPECT_FALSE(sequence->PushTasks(std::move(tasks)));
+
+  // The tasks should come out in the order in which they were pushed.
+  Optional<Task> task = sequence->TakeTask();
+  ExpectMockTask(&mock_task_a, &task.value());
+  EXPECT_FALSE(task->sequenced_time.is_null());
+  EXPECT_FALSE(sequence->Pop());
+  task = sequence->TakeTask();
+  ExpectMockTask(&mock_task_b, &task.value());
+  EXPECT_FALSE(sequence->Pop());
+  task = sequence->TakeTask();
+  ExpectMockTask(&mock_task_c, &task.value());
+  EXPECT_TRUE(sequence->Pop());
+}
+
 // Verifies the sort key of a sequence that contains one BACKGROUND task.
 TEST(TaskSchedulerSequenceTest, GetSortKeyBackground) {
   // Create a sequence with a BACKGROUND task.
@@ -51,9 +51,11 @@ Task::Task(const Location& posted_from,
 // this case.
 Task::Task(Task&& other) noexcept
     : PendingTask(std::move(other)),
+      is_sampled(other.is_sampled),
       traits(other.traits),
       delay(other.delay),
       sequenced_time(other.sequenced_time),
+      front_of_sequence_time(other.front_of_sequence_time),
       sequenced_task_runner_ref(std::move(other.sequenced_task_runner_ref)),
       single_thread_task_runner_ref(
           std::move(other.single_thread_task_runner_ref)) {}
@@ -40,6 +40,11 @@ struct BASE_EXPORT Task : public PendingTask {
 
   Task& operator=(Task&& other);
 
+  // True if this task was sampled for the TaskSchedulerObserver (see
+  // TaskTracker::SetObserver()). Declared first so that it fits in the tail
+  // padding of PendingTask.
+  bool is_sampled = false;
+
   // The TaskTraits of this task.
   TaskTraits traits;
 
@@ -52,6 +57,10 @@ struct BASE_EXPORT Task : public PendingTask {
   // in a sequence yet, this defaults to a null TimeTicks.
   TimeTicks sequenced_time;
 
+  // The time at which the task reached the front of its sequence. Only set for
+  // sampled tasks.
+  TimeTicks front_of_sequence_time;
+
   // A reference to the SequencedTaskRunner or SingleThreadTaskRunner that
   // posted this task, if any. Used to set ThreadTaskRunnerHandle and/or
   // SequencedTaskRunnerHandle while the task is running.
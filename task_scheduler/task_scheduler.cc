@@ -53,7 +53,7 @@ void TaskScheduler::StartWithDefaultParams() {
   // * The system is utilized maximally by foreground threads.
   // * The main thread is assumed to be busy, cap foreground workers at
   //   |num_cores - 1|.
-  const int num_cores = SysInfo::NumberOfProcessors();
+  const int num_cores = SysInfo::NumberOfEffectiveProcessors();
   constexpr int kBackgroundMaxThreads = 1;
   constexpr int kBackgroundBlockingMaxThreads = 2;
   const int kForegroundMaxThreads = std::max(1, num_cores - 1);
@@ -18,6 +18,7 @@
 #include "base/task_runner.h"
 #include "base/task_scheduler/scheduler_worker_pool_params.h"
 #include "base/task_scheduler/single_thread_task_runner_thread_mode.h"
+#include "base/task_scheduler/task_scheduler_observer.h"
 #include "base/task_scheduler/task_traits.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
@@ -94,6 +95,12 @@ class BASE_EXPORT TaskScheduler {
                                          OnceClosure task,
                                          TimeDelta delay) = 0;
 
+  // Posts each of |tasks| with specific |traits|, as if by
+  // PostDelayedTaskWithTraits() with no delay, but at a lower cost per task.
+  virtual void PostTasksWithTraits(const Location& from_here,
+                                   const TaskTraits& traits,
+                                   std::vector<OnceClosure> tasks) = 0;
+
   // Returns a TaskRunner whose PostTask invocations result in scheduling tasks
   // using |traits|. Tasks may run in any order and in parallel.
   virtual scoped_refptr<TaskRunner> CreateTaskRunnerWithTraits(
@@ -130,6 +137,12 @@ class BASE_EXPORT TaskScheduler {
   // Returns a vector of all histograms available in this task scheduler.
   virtual std::vector<const HistogramBase*> GetHistograms() const = 0;
 
+  // Sets |observer| to receive the scheduling events of 1 in every
+  // |sampling_interval| tasks posted from now on (see TaskSchedulerObserver).
+  // Can only be called once. |observer| must outlive this TaskScheduler.
+  virtual void SetObserver(TaskSchedulerObserver* observer,
+                           int sampling_interval) = 0;
+
   // Synchronously shuts down the scheduler. Once this is called, only tasks
   // posted with the BLOCK_SHUTDOWN behavior will be run. When this returns:
   // - All SKIP_ON_SHUTDOWN tasks that were already running have completed their
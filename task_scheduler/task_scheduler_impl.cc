@@ -58,6 +58,12 @@ TaskSchedulerImpl::~TaskSchedulerImpl() {
 #endif
 }
 
+void TaskSchedulerImpl::SetDelayedTaskRunnerForTesting(
+    scoped_refptr<TaskRunner> delayed_task_runner) {
+  DCHECK(!service_thread_.IsRunning());
+  delayed_task_runner_for_testing_ = std::move(delayed_task_runner);
+}
+
 void TaskSchedulerImpl::Start(const TaskScheduler::InitParams& init_params) {
   // This is set in Start() and not in the constructor because variation params
   // are usually not ready when TaskSchedulerImpl is instantiated in a process.
@@ -93,7 +99,12 @@ void TaskSchedulerImpl::Start(const TaskScheduler::InitParams& init_params) {
   // Needs to happen after starting the service thread to get its task_runner().
   scoped_refptr<TaskRunner> service_thread_task_runner =
       service_thread_.task_runner();
-  delayed_task_manager_.Start(service_thread_task_runner);
+  if (delayed_task_runner_for_testing_) {
+    delayed_task_manager_.StartWithVirtualTimeForTesting(
+        delayed_task_runner_for_testing_);
+  } else {
+    delayed_task_manager_.Start(service_thread_task_runner);
+  }
 
   single_thread_task_runner_manager_.Start();
 
@@ -133,6 +144,20 @@ void TaskSchedulerImpl::PostDelayedTaskWithTraits(const Location& from_here,
           MakeRefCounted<Sequence>());
 }
 
+void TaskSchedulerImpl::PostTasksWithTraits(const Location& from_here,
+                                            const TaskTraits& traits,
+                                            std::vector<OnceClosure> tasks) {
+  // Post each task as part of a one-off single-task Sequence.
+  const TaskTraits new_traits = SetUserBlockingPriorityIfNeeded(traits);
+  std::vector<Task> scheduler_tasks;
+  scheduler_tasks.reserve(tasks.size());
+  for (OnceClosure& task : tasks)
+    scheduler_tasks.emplace_back(from_here, std::move(task), new_traits,
+                                 TimeDelta());
+  GetWorkerPoolForTraits(new_traits)
+      ->PostTasksWithOneOffSequences(std::move(scheduler_tasks));
+}
+
 scoped_refptr<TaskRunner> TaskSchedulerImpl::CreateTaskRunnerWithTraits(
     const TaskTraits& traits) {
   const TaskTraits new_traits = SetUserBlockingPriorityIfNeeded(traits);
@@ -175,6 +200,11 @@ std::vector<const HistogramBase*> TaskSchedulerImpl::GetHistograms() const {
   return histograms;
 }
 
+void TaskSchedulerImpl::SetObserver(TaskSchedulerObserver* observer,
+                                    int sampling_interval) {
+  task_tracker_->SetObserver(observer, sampling_interval);
+}
+
 int TaskSchedulerImpl::GetMaxConcurrentNonBlockedTasksWithTraitsDeprecated(
     const TaskTraits& traits) const {
   return GetWorkerPoolForTraits(traits)
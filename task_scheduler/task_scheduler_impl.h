@@ -60,12 +60,22 @@ class BASE_EXPORT TaskSchedulerImpl : public TaskScheduler {
 
   ~TaskSchedulerImpl() override;
 
+  // For testing only. Times the delayed tasks posted after Start() with
+  // |delayed_task_runner| rather than with the service thread, e.g. to run
+  // them on the virtual clock of a TestMockTimeTaskRunner while the workers
+  // are real. Must be called before Start().
+  void SetDelayedTaskRunnerForTesting(
+      scoped_refptr<TaskRunner> delayed_task_runner);
+
   // TaskScheduler:
   void Start(const TaskScheduler::InitParams& init_params) override;
   void PostDelayedTaskWithTraits(const Location& from_here,
                                  const TaskTraits& traits,
                                  OnceClosure task,
                                  TimeDelta delay) override;
+  void PostTasksWithTraits(const Location& from_here,
+                           const TaskTraits& traits,
+                           std::vector<OnceClosure> tasks) override;
   scoped_refptr<TaskRunner> CreateTaskRunnerWithTraits(
       const TaskTraits& traits) override;
   scoped_refptr<SequencedTaskRunner> CreateSequencedTaskRunnerWithTraits(
@@ -79,6 +89,8 @@ class BASE_EXPORT TaskSchedulerImpl : public TaskScheduler {
       SingleThreadTaskRunnerThreadMode thread_mode) override;
 #endif  // defined(OS_WIN)
   std::vector<const HistogramBase*> GetHistograms() const override;
+  void SetObserver(TaskSchedulerObserver* observer,
+                   int sampling_interval) override;
   int GetMaxConcurrentNonBlockedTasksWithTraitsDeprecated(
       const TaskTraits& traits) const override;
   void Shutdown() override;
@@ -100,6 +112,9 @@ class BASE_EXPORT TaskSchedulerImpl : public TaskScheduler {
   DelayedTaskManager delayed_task_manager_;
   SchedulerSingleThreadTaskRunnerManager single_thread_task_runner_manager_;
 
+  // Set by SetDelayedTaskRunnerForTesting().
+  scoped_refptr<TaskRunner> delayed_task_runner_for_testing_;
+
   // Indicates that all tasks are handled as if they had been posted with
   // TaskPriority::USER_BLOCKING. Since this is set in Start(), it doesn't apply
   // to tasks posted before Start() or to tasks posted to TaskRunners created
@@ -22,6 +22,7 @@
 #include "base/task_scheduler/scheduler_worker_pool_params.h"
 #include "base/task_scheduler/task_traits.h"
 #include "base/task_scheduler/test_task_factory.h"
+#include "base/test/test_mock_time_task_runner.h"
 #include "base/test/test_timeouts.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/sequence_local_storage_slot.h"
@@ -632,6 +633,27 @@ TEST_F(TaskSchedulerImplTest, SequenceLocalStorage) {
   scheduler_.FlushForTesting();
 }
 
+// Verifies that delayed tasks are timed by the delayed task runner set for
+// testing, and then run by the workers.
+TEST_F(TaskSchedulerImplTest, DelayedTaskRunnerForTesting) {
+  auto delayed_task_runner = MakeRefCounted<TestMockTimeTaskRunner>();
+  scheduler_.SetDelayedTaskRunnerForTesting(delayed_task_runner);
+  StartTaskScheduler();
+
+  WaitableEvent task_ran(WaitableEvent::ResetPolicy::MANUAL,
+                         WaitableEvent::InitialState::NOT_SIGNALED);
+  scheduler_.PostDelayedTaskWithTraits(
+      FROM_HERE, TaskTraits(),
+      BindOnce(&WaitableEvent::Signal, Unretained(&task_ran)),
+      TimeDelta::FromDays(1));
+  delayed_task_runner->FastForwardBy(TimeDelta::FromHours(23));
+  scheduler_.FlushForTesting();
+  EXPECT_FALSE(task_ran.IsSignaled());
+
+  delayed_task_runner->FastForwardBy(TimeDelta::FromHours(1));
+  task_ran.Wait();
+}
+
 TEST_F(TaskSchedulerImplTest, FlushAsyncNoTasks) {
   StartTaskScheduler();
   bool called_back = false;
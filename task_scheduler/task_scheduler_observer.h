@@ -0,0 +1,72 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_SCHEDULER_TASK_SCHEDULER_OBSERVER_H_
+#define BASE_TASK_SCHEDULER_TASK_SCHEDULER_OBSERVER_H_
+
+#include <stddef.h>
+
+#include "base/location.h"
+#include "base/task_scheduler/task_traits.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// Receives scheduling events for a sample of the tasks posted to a
+// TaskScheduler (see TaskScheduler::SetObserver()). Only 1 in every
+// |sampling_interval| posted tasks is sampled, so that observing a busy
+// scheduler stays cheap; tasks which aren't sampled cost a single atomic
+// increment. Methods are called on arbitrary threads, possibly concurrently,
+// and must be thread-safe and fast: OnTaskStarted() and OnTaskFinished() run on
+// the worker which runs the task.
+class TaskSchedulerObserver {
+ public:
+  // Describes a sampled task which is about to run or just ran.
+  struct SampledTask {
+    // The site the task was posted from.
+    Location posted_from;
+
+    // The traits of the task.
+    TaskTraits traits;
+
+    // When the task was inserted in its Sequence (after its delay, if any).
+    TimeTicks sequenced_time;
+
+    // When the task reached the front of its Sequence. The task waited behind
+    // earlier tasks of its Sequence from |sequenced_time| to
+    // |front_of_sequence_time|, then waited for a worker (i.e. for its
+    // Sequence to be picked from a PriorityQueue) until |start_time|.
+    TimeTicks front_of_sequence_time;
+
+    // The number of tasks in the Sequence, this one included, when the task
+    // started.
+    size_t sequence_length = 0;
+
+    // When the task started running.
+    TimeTicks start_time;
+
+    // When the task finished running. Null in OnTaskStarted().
+    TimeTicks end_time;
+  };
+
+  virtual ~TaskSchedulerObserver() = default;
+
+  // Called when a sampled task with |traits| and |delay| is posted from
+  // |posted_from| at |post_time|.
+  virtual void OnTaskPosted(const Location& posted_from,
+                            const TaskTraits& traits,
+                            TimeDelta delay,
+                            TimeTicks post_time) = 0;
+
+  // Called right before |task| runs.
+  virtual void OnTaskStarted(const SampledTask& task) = 0;
+
+  // Called right after |task| ran. Sampled tasks which don't run because of
+  // shutdown get neither OnTaskStarted() nor OnTaskFinished().
+  virtual void OnTaskFinished(const SampledTask& task) = 0;
+};
+
+}  // namespace base
+
+#endif  // BASE_TASK_SCHEDULER_TASK_SCHEDULER_OBSERVER_H_
@@ -0,0 +1,125 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task_scheduler/task_scheduler_impl.h"
+
+#include <utility>
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/sequenced_task_runner.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/task_scheduler/scheduler_worker_pool_params.h"
+#include "base/task_scheduler/task_traits.h"
+#include "base/test/perf_benchmark.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+constexpr int kIterations = 10000;
+
+// Signals |done_| when the last of |num_tasks| tasks ran.
+class TaskCounter {
+ public:
+  explicit TaskCounter(int num_tasks)
+      : remaining_(num_tasks),
+        done_(WaitableEvent::ResetPolicy::MANUAL,
+              WaitableEvent::InitialState::NOT_SIGNALED) {}
+
+  void RunTask() {
+    if (subtle::Barrier_AtomicIncrement(&remaining_, -1) == 0)
+      done_.Signal();
+  }
+
+  void Wait() { done_.Wait(); }
+
+ private:
+  subtle::Atomic32 remaining_;
+  WaitableEvent done_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskCounter);
+};
+
+class TaskSchedulerPerfTest : public testing::Test {
+ protected:
+  TaskSchedulerPerfTest() : scheduler_("TaskSchedulerPerfTest") {}
+
+  void SetUp() override {
+    constexpr TimeDelta kSuggestedReclaimTime = TimeDelta::FromSeconds(30);
+    scheduler_.Start({{1, kSuggestedReclaimTime},
+                      {1, kSuggestedReclaimTime},
+                      {4, kSuggestedReclaimTime},
+                      {4, kSuggestedReclaimTime}});
+  }
+
+  void TearDown() override {
+    scheduler_.FlushForTesting();
+    scheduler_.JoinForTesting();
+  }
+
+  TaskSchedulerImpl scheduler_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TaskSchedulerPerfTest);
+};
+
+}  // namespace
+
+// Posts independent tasks, which the workers run in parallel.
+TEST_F(TaskSchedulerPerfTest, PostAndRunParallelTasks) {
+  PerfBenchmark benchmark("task_scheduler", "post_and_run_parallel",
+                          kIterations);
+  benchmark.Run([&](int iterations) {
+    TaskCounter counter(iterations);
+    for (int i = 0; i < iterations; ++i) {
+      scheduler_.PostDelayedTaskWithTraits(
+          FROM_HERE, {TaskPriority::USER_VISIBLE},
+          BindOnce(&TaskCounter::RunTask, Unretained(&counter)), TimeDelta());
+    }
+    counter.Wait();
+  });
+}
+
+// Posts the tasks in one batch.
+TEST_F(TaskSchedulerPerfTest, PostBatchAndRunParallelTasks) {
+  PerfBenchmark benchmark("task_scheduler", "post_batch_and_run_parallel",
+                          kIterations);
+  benchmark.Run([&](int iterations) {
+    TaskCounter counter(iterations);
+    std::vector<OnceClosure> tasks;
+    tasks.reserve(iterations);
+    for (int i = 0; i < iterations; ++i)
+      tasks.push_back(BindOnce(&TaskCounter::RunTask, Unretained(&counter)));
+    scheduler_.PostTasksWithTraits(FROM_HERE, {TaskPriority::USER_VISIBLE},
+                                   std::move(tasks));
+    counter.Wait();
+  });
+}
+
+// Posts the tasks to a sequence, which runs them one at a time.
+TEST_F(TaskSchedulerPerfTest, PostAndRunSequencedTasks) {
+  scoped_refptr<SequencedTaskRunner> task_runner =
+      scheduler_.CreateSequencedTaskRunnerWithTraits(
+          {TaskPriority::USER_VISIBLE});
+  PerfBenchmark benchmark("task_scheduler", "post_and_run_sequenced",
+                          kIterations);
+  benchmark.Run([&](int iterations) {
+    TaskCounter counter(iterations);
+    for (int i = 0; i < iterations; ++i) {
+      task_runner->PostTask(
+          FROM_HERE, BindOnce(&TaskCounter::RunTask, Unretained(&counter)));
+    }
+    counter.Wait();
+  });
+}
+
+}  // namespace internal
+}  // namespace base
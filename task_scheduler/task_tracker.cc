@@ -4,6 +4,7 @@
 
 #include "base/task_scheduler/task_tracker.h"
 
+#include <algorithm>
 #include <limits>
 #include <string>
 #include <vector>
@@ -16,7 +17,9 @@
 #include "base/metrics/histogram_macros.h"
 #include "base/sequence_token.h"
 #include "base/synchronization/condition_variable.h"
+#include "base/synchronization/rcu_ptr.h"
 #include "base/task_scheduler/scoped_set_task_priority_for_current_thread.h"
+#include "base/threading/platform_thread.h"
 #include "base/threading/sequence_local_storage_map.h"
 #include "base/threading/sequenced_task_runner_handle.h"
 #include "base/threading/thread_restrictions.h"
@@ -95,6 +98,18 @@ HistogramBase* GetTaskLatencyHistogram(StringPiece histogram_label,
                                HistogramBase::kUmaTargetedHistogramFlag);
 }
 
+HistogramBase* GetStartDeadlineMissHistogram(StringPiece histogram_label) {
+  DCHECK(!histogram_label.empty());
+  // Same bounds as the TaskScheduler.TaskLatencyMicroseconds histograms. Tasks
+  // that start before their deadline are recorded as 0, in the underflow
+  // bucket.
+  return Histogram::FactoryGet(
+      JoinString({"TaskScheduler.StartDeadlineMissMicroseconds",
+                  histogram_label},
+                 "."),
+      1, 20000, 50, HistogramBase::kUmaTargetedHistogramFlag);
+}
+
 // Upper bound for the
 // TaskScheduler.BlockShutdownTasksPostedDuringShutdown histogram.
 constexpr HistogramBase::Sample kMaxBlockShutdownTasksPostedDuringShutdown =
@@ -126,85 +141,122 @@ int GetMaxNumScheduledBackgroundSequences() {
 // be assumed from these calls (i.e. a thread reading
 // |HasShutdownStarted() == true| isn't guaranteed to see all writes made before
 // |StartShutdown()| on the thread that invoked it).
+//
+// Every post and run of a task that blocks shutdown updates the number of
+// tasks blocking shutdown, from all the threads of the scheduler. So that they
+// don't all write to the same cache line, that number is split over shards,
+// each updated by the threads whose id maps to it. A task may be counted in
+// one shard when it is posted and uncounted in another when it completes, so
+// only the sum of the shards is meaningful. It is computed when shutdown
+// starts, from which point the shards only record the changes to it, and the
+// total is kept under |lock_|.
 class TaskTracker::State {
  public:
-  State() = default;
+  // |predecessor| is the lock that may be held when calling the methods of
+  // this class.
+  explicit State(const SchedulerLock* predecessor) : lock_(predecessor) {}
 
   // Sets a flag indicating that shutdown has started. Returns true if there are
   // tasks blocking shutdown. Can only be called once.
   bool StartShutdown() {
-    const auto new_value =
-        subtle::NoBarrier_AtomicIncrement(&bits_, kShutdownHasStartedMask);
+    AutoSchedulerLock auto_lock(lock_);
+    DCHECK_EQ(num_tasks_blocking_shutdown_, 0);
+
+    for (Shard& shard : shards_) {
+      const auto new_bits = subtle::NoBarrier_AtomicIncrement(
+          &shard.bits, kShutdownHasStartedMask);
 
-    // Check that the "shutdown has started" bit isn't zero. This would happen
-    // if it was incremented twice.
-    DCHECK(new_value & kShutdownHasStartedMask);
+      // Check that the "shutdown has started" bit isn't zero. This would
+      // happen if it was incremented twice.
+      DCHECK(new_bits & kShutdownHasStartedMask);
 
-    const auto num_tasks_blocking_shutdown =
-        new_value >> kNumTasksBlockingShutdownBitOffset;
-    return num_tasks_blocking_shutdown != 0;
+      num_tasks_blocking_shutdown_ += GetNumTasksBlockingShutdown(new_bits);
+    }
+
+    DCHECK_GE(num_tasks_blocking_shutdown_, 0);
+    return num_tasks_blocking_shutdown_ != 0;
   }
 
   // Returns true if shutdown has started.
   bool HasShutdownStarted() const {
-    return subtle::NoBarrier_Load(&bits_) & kShutdownHasStartedMask;
-  }
-
-  // Returns true if there are tasks blocking shutdown.
-  bool AreTasksBlockingShutdown() const {
-    const auto num_tasks_blocking_shutdown =
-        subtle::NoBarrier_Load(&bits_) >> kNumTasksBlockingShutdownBitOffset;
-    DCHECK_GE(num_tasks_blocking_shutdown, 0);
-    return num_tasks_blocking_shutdown != 0;
+    return subtle::NoBarrier_Load(&GetShardForCurrentThread()->bits) &
+           kShutdownHasStartedMask;
   }
 
   // Increments the number of tasks blocking shutdown. Returns true if shutdown
   // has started.
   bool IncrementNumTasksBlockingShutdown() {
-#if DCHECK_IS_ON()
-    // Verify that no overflow will occur.
-    const auto num_tasks_blocking_shutdown =
-        subtle::NoBarrier_Load(&bits_) >> kNumTasksBlockingShutdownBitOffset;
-    DCHECK_LT(num_tasks_blocking_shutdown,
-              std::numeric_limits<subtle::Atomic32>::max() -
-                  kNumTasksBlockingShutdownIncrement);
-#endif
-
     const auto new_bits = subtle::NoBarrier_AtomicIncrement(
-        &bits_, kNumTasksBlockingShutdownIncrement);
-    return new_bits & kShutdownHasStartedMask;
+        &GetShardForCurrentThread()->bits, kNumTasksBlockingShutdownIncrement);
+    if (!(new_bits & kShutdownHasStartedMask))
+      return false;
+
+    // StartShutdown() summed this shard before the increment.
+    AutoSchedulerLock auto_lock(lock_);
+    DCHECK_LT(num_tasks_blocking_shutdown_,
+              std::numeric_limits<int>::max());
+    ++num_tasks_blocking_shutdown_;
+    return true;
   }
 
   // Decrements the number of tasks blocking shutdown. Returns true if shutdown
   // has started and the number of tasks blocking shutdown becomes zero.
   bool DecrementNumTasksBlockingShutdown() {
     const auto new_bits = subtle::NoBarrier_AtomicIncrement(
-        &bits_, -kNumTasksBlockingShutdownIncrement);
-    const bool shutdown_has_started = new_bits & kShutdownHasStartedMask;
-    const auto num_tasks_blocking_shutdown =
-        new_bits >> kNumTasksBlockingShutdownBitOffset;
-    DCHECK_GE(num_tasks_blocking_shutdown, 0);
-    return shutdown_has_started && num_tasks_blocking_shutdown == 0;
+        &GetShardForCurrentThread()->bits, -kNumTasksBlockingShutdownIncrement);
+    if (!(new_bits & kShutdownHasStartedMask))
+      return false;
+
+    // StartShutdown() summed this shard before the decrement.
+    AutoSchedulerLock auto_lock(lock_);
+    --num_tasks_blocking_shutdown_;
+    DCHECK_GE(num_tasks_blocking_shutdown_, 0);
+    return num_tasks_blocking_shutdown_ == 0;
   }
 
  private:
+  static constexpr size_t kNumShards = 16;
+  static constexpr size_t kCacheLineSize = 64;
+
   static constexpr subtle::Atomic32 kShutdownHasStartedMask = 1;
-  static constexpr subtle::Atomic32 kNumTasksBlockingShutdownBitOffset = 1;
-  static constexpr subtle::Atomic32 kNumTasksBlockingShutdownIncrement =
-      1 << kNumTasksBlockingShutdownBitOffset;
+  static constexpr subtle::Atomic32 kNumTasksBlockingShutdownIncrement = 2;
 
-  // The LSB indicates whether shutdown has started. The other bits count the
-  // number of tasks blocking shutdown.
-  // No barriers are required to read/write |bits_| as this class is only used
+  // The LSB of |bits| indicates whether shutdown has started. The other bits
+  // count the number of tasks blocking shutdown added minus the number
+  // removed from this shard, which may be negative.
+  // No barriers are required to read/write |bits| as this class is only used
   // as an atomic state checker, it doesn't provide sequential consistency
   // guarantees w.r.t. external state. Sequencing of the TaskTracker::State
   // operations themselves is guaranteed by the AtomicIncrement RMW (read-
   // modify-write) semantics however. For example, if two threads are racing to
   // call IncrementNumTasksBlockingShutdown() and StartShutdown() respectively,
   // either the first thread will win and the StartShutdown() call will see the
-  // blocking task or the second thread will win and
-  // IncrementNumTasksBlockingShutdown() will know that shutdown has started.
-  subtle::Atomic32 bits_ = 0;
+  // blocking task in the sum of the shards or the second thread will win and
+  // IncrementNumTasksBlockingShutdown() will know that shutdown has started,
+  // and wait for StartShutdown() to release |lock_| before counting the task.
+  struct Shard {
+    subtle::Atomic32 bits = 0;
+    char padding[kCacheLineSize - sizeof(subtle::Atomic32)];
+  };
+
+  static subtle::Atomic32 GetNumTasksBlockingShutdown(subtle::Atomic32 bits) {
+    return (bits & ~kShutdownHasStartedMask) /
+           kNumTasksBlockingShutdownIncrement;
+  }
+
+  Shard* GetShardForCurrentThread() const {
+    return &shards_[static_cast<size_t>(PlatformThread::CurrentId()) %
+                    kNumShards];
+  }
+
+  mutable Shard shards_[kNumShards];
+
+  // Synchronizes StartShutdown() with the updates of the shards that happen
+  // after it, and protects |num_tasks_blocking_shutdown_|.
+  SchedulerLock lock_;
+
+  // The number of tasks blocking shutdown, once shutdown has started.
+  int num_tasks_blocking_shutdown_ = 0;
 
   DISALLOW_COPY_AND_ASSIGN(State);
 };
@@ -246,9 +298,9 @@ TaskTracker::TaskTracker(StringPiece histogram_label)
 
 TaskTracker::TaskTracker(StringPiece histogram_label,
                          int max_num_scheduled_background_sequences)
-    : state_(new State),
-      flush_cv_(flush_lock_.CreateConditionVariable()),
+    : flush_cv_(flush_lock_.CreateConditionVariable()),
       shutdown_lock_(&flush_lock_),
+      state_(new State(&shutdown_lock_)),
       max_num_scheduled_background_sequences_(
           max_num_scheduled_background_sequences),
       task_latency_histograms_{
@@ -261,6 +313,8 @@ TaskTracker::TaskTracker(StringPiece histogram_label,
           {GetTaskLatencyHistogram(histogram_label, "UserBlockingTaskPriority"),
            GetTaskLatencyHistogram(histogram_label,
                                    "UserBlockingTaskPriority_MayBlock")}},
+      start_deadline_miss_histogram_(
+          GetStartDeadlineMissHistogram(histogram_label)),
       tracked_ref_factory_(this) {
   // Confirm that all |task_latency_histograms_| have been initialized above.
   DCHECK(*(&task_latency_histograms_[static_cast<int>(TaskPriority::HIGHEST) +
@@ -306,27 +360,49 @@ void TaskTracker::FlushAsyncForTesting(OnceClosure flush_callback) {
   }
 }
 
-bool TaskTracker::WillPostTask(const Task& task) {
-  DCHECK(task.task);
+bool TaskTracker::WillPostTask(Task* task) {
+  DCHECK(task->task);
 
-  if (!BeforePostTask(task.traits.shutdown_behavior()))
+  if (!BeforePostTask(task->traits.shutdown_behavior()))
     return false;
 
-  if (task.delayed_run_time.is_null())
+  if (task->delayed_run_time.is_null())
     subtle::NoBarrier_AtomicIncrement(&num_incomplete_undelayed_tasks_, 1);
 
   {
     TRACE_EVENT_WITH_FLOW0(
         kTaskSchedulerFlowTracingCategory, kQueueFunctionName,
-        TRACE_ID_MANGLE(task_annotator_.GetTaskTraceID(task)),
+        TRACE_ID_MANGLE(task_annotator_.GetTaskTraceID(*task)),
         TRACE_EVENT_FLAG_FLOW_OUT);
   }
 
-  task_annotator_.DidQueueTask(nullptr, task);
+  task_annotator_.DidQueueTask(nullptr, *task);
+
+  TaskSchedulerObserver* const observer =
+      observer_.load(std::memory_order_acquire);
+  if (observer) {
+    const uint32_t num_tasks_posted =
+        num_tasks_posted_since_observer_set_.fetch_add(
+            1, std::memory_order_relaxed);
+    if (num_tasks_posted % static_cast<uint32_t>(sampling_interval_) == 0) {
+      task->is_sampled = true;
+      observer->OnTaskPosted(task->posted_from, task->traits, task->delay,
+                             TimeTicks::Now());
+    }
+  }
 
   return true;
 }
 
+void TaskTracker::SetObserver(TaskSchedulerObserver* observer,
+                              int sampling_interval) {
+  DCHECK(observer);
+  DCHECK_GT(sampling_interval, 0);
+  DCHECK(!observer_.load(std::memory_order_relaxed));
+  sampling_interval_ = sampling_interval;
+  observer_.store(observer, std::memory_order_release);
+}
+
 scoped_refptr<Sequence> TaskTracker::WillScheduleSequence(
     scoped_refptr<Sequence> sequence,
     CanScheduleSequenceObserver* observer) {
@@ -369,10 +445,33 @@ scoped_refptr<Sequence> TaskTracker::RunAndPopNextTask(
   const bool can_run_task = BeforeRunTask(shutdown_behavior);
   const bool is_delayed = !task->delayed_run_time.is_null();
 
+  // |observer_| is set if |task| is sampled.
+  Optional<TaskSchedulerObserver::SampledTask> sampled_task;
+  if (task->is_sampled && can_run_task) {
+    sampled_task.emplace();
+    sampled_task->posted_from = task->posted_from;
+    sampled_task->traits = task->traits;
+    sampled_task->sequenced_time = task->sequenced_time;
+    sampled_task->front_of_sequence_time = task->front_of_sequence_time;
+    sampled_task->sequence_length = sequence->GetNumTasks();
+    sampled_task->start_time = TimeTicks::Now();
+    observer_.load(std::memory_order_relaxed)->OnTaskStarted(*sampled_task);
+  }
+
   RunOrSkipTask(std::move(task.value()), sequence.get(), can_run_task);
   if (can_run_task)
     AfterRunTask(shutdown_behavior);
 
+  if (sampled_task) {
+    sampled_task->end_time = TimeTicks::Now();
+    observer_.load(std::memory_order_relaxed)->OnTaskFinished(*sampled_task);
+  }
+
+  // Between tasks, this thread can't be in an RcuReadScope, so this is a good
+  // place to delete snapshots that RcuPtr writers couldn't delete because
+  // other threads were still reading them.
+  RcuReclaimRetired();
+
   if (!is_delayed)
     DecrementNumIncompleteUndelayedTasks();
 
@@ -660,7 +759,6 @@ bool TaskTracker::BeforeRunTask(TaskShutdownBehavior shutdown_behavior) {
     case TaskShutdownBehavior::BLOCK_SHUTDOWN: {
       // The number of tasks blocking shutdown has been incremented when the
       // task was posted.
-      DCHECK(state_->AreTasksBlockingShutdown());
 
       // Trying to run a BLOCK_SHUTDOWN task after shutdown has completed is
       // unexpected as it either shouldn't have been posted if shutdown
@@ -783,6 +881,12 @@ void TaskTracker::RecordTaskLatencyHistogram(const Task& task) {
                                ? 1
                                : 0]
                               ->Add(task_latency.InMicroseconds());
+
+  if (task.traits.has_start_deadline()) {
+    start_deadline_miss_histogram_->Add(
+        std::max(task_latency - task.traits.start_deadline(), TimeDelta())
+            .InMicroseconds());
+  }
 }
 
 void TaskTracker::CallFlushCallbackForTesting() {
@@ -5,6 +5,7 @@
 #ifndef BASE_TASK_SCHEDULER_TASK_TRACKER_H_
 #define BASE_TASK_SCHEDULER_TASK_TRACKER_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <queue>
@@ -22,6 +23,7 @@
 #include "base/task_scheduler/scheduler_lock.h"
 #include "base/task_scheduler/sequence.h"
 #include "base/task_scheduler/task.h"
+#include "base/task_scheduler/task_scheduler_observer.h"
 #include "base/task_scheduler/task_traits.h"
 #include "base/task_scheduler/tracked_ref.h"
 
@@ -123,7 +125,14 @@ class BASE_EXPORT TaskTracker {
 
   // Informs this TaskTracker that |task| is about to be posted. Returns true if
   // this operation is allowed (|task| should be posted if-and-only-if it is).
-  bool WillPostTask(const Task& task);
+  // Marks |task| as sampled if it is picked for the observer set with
+  // SetObserver().
+  bool WillPostTask(Task* task);
+
+  // Sets |observer| to be notified of the scheduling events of 1 in every
+  // |sampling_interval| tasks posted from now on. Can only be called once.
+  // |observer| must outlive this TaskTracker.
+  void SetObserver(TaskSchedulerObserver* observer, int sampling_interval);
 
   // Informs this TaskTracker that |sequence| is about to be scheduled. If this
   // returns |sequence|, it is expected that RunAndPopNextTask() will soon be
@@ -257,7 +266,8 @@ class BASE_EXPORT TaskTracker {
       CanScheduleSequenceObserver* observer);
 
   // Records the TaskScheduler.TaskLatency.[task priority].[may block] histogram
-  // for |task|.
+  // and, if |task| has a start deadline, the
+  // TaskScheduler.StartDeadlineMissMicroseconds histogram for |task|.
   void RecordTaskLatencyHistogram(const Task& task);
 
   // Calls |flush_callback_for_testing_| if one is available in a lock-safe
@@ -266,10 +276,6 @@ class BASE_EXPORT TaskTracker {
 
   debug::TaskAnnotator task_annotator_;
 
-  // Number of tasks blocking shutdown and boolean indicating whether shutdown
-  // has started.
-  const std::unique_ptr<State> state_;
-
   // Number of undelayed tasks that haven't completed their execution. Is
   // decremented with a memory barrier after a task runs. Is accessed with an
   // acquire memory barrier in FlushForTesting(). The memory barriers ensure
@@ -295,6 +301,10 @@ class BASE_EXPORT TaskTracker {
   // Synchronizes access to shutdown related members below.
   mutable SchedulerLock shutdown_lock_;
 
+  // Number of tasks blocking shutdown and boolean indicating whether shutdown
+  // has started. Its own lock may be acquired while holding |shutdown_lock_|.
+  const std::unique_ptr<State> state_;
+
   // Event instantiated when shutdown starts and signaled when shutdown
   // completes.
   std::unique_ptr<WaitableEvent> shutdown_event_;
@@ -325,6 +335,22 @@ class BASE_EXPORT TaskTracker {
   HistogramBase* const
       task_latency_histograms_[static_cast<int>(TaskPriority::HIGHEST) + 1][2];
 
+  // TaskScheduler.StartDeadlineMissMicroseconds histogram, which records by how
+  // much tasks with a StartWithin trait missed their deadline. Intentionally
+  // leaked.
+  HistogramBase* const start_deadline_miss_histogram_;
+
+  // Observer set by SetObserver(), if any. Written once, with a release barrier
+  // after |sampling_interval_|.
+  std::atomic<TaskSchedulerObserver*> observer_{nullptr};
+
+  // 1 in every |sampling_interval_| posted tasks is sampled for |observer_|.
+  int sampling_interval_ = 0;
+
+  // Number of tasks posted since |observer_| was set, used to pick the tasks
+  // to sample.
+  std::atomic<uint32_t> num_tasks_posted_since_observer_set_{0};
+
   // Number of BLOCK_SHUTDOWN tasks posted during shutdown.
   HistogramBase::Sample num_block_shutdown_tasks_posted_during_shutdown_ = 0;
 
@@ -12,6 +12,7 @@
 
 #include "base/base_export.h"
 #include "base/task_scheduler/task_traits_details.h"
+#include "base/time/time.h"
 #include "build/build_config.h"
 
 namespace base {
@@ -20,7 +21,7 @@ namespace base {
 // depend on priorities being expressed as a continuous zero-based list from
 // lowest to highest priority. Users of this API shouldn't otherwise care about
 // nor use the underlying values.
-enum class TaskPriority {
+enum class TaskPriority : uint8_t {
   // This will always be equal to the lowest priority available.
   LOWEST = 0,
   // User won't notice if this task takes an arbitrarily long time to complete.
@@ -40,7 +41,7 @@ enum class TaskPriority {
 };
 
 // Valid shutdown behaviors supported by the task scheduler.
-enum class TaskShutdownBehavior {
+enum class TaskShutdownBehavior : uint8_t {
   // Tasks posted with this mode which have not started executing before
   // shutdown is initiated will never run. Tasks with this mode running at
   // shutdown will be ignored (the worker will not be joined).
@@ -113,6 +114,35 @@ struct MayBlock {};
 // In doubt, consult with //base/task_scheduler/OWNERS.
 struct WithBaseSyncPrimitives {};
 
+// Tasks with this trait should start running within |delay| of being posted.
+// Among Sequences of the same TaskPriority, the one whose next task has the
+// earliest start deadline runs first, and Sequences whose next task has no
+// deadline run after those whose next task has one. This doesn't change how
+// Sequences of different priorities are ordered. How late tasks start relative
+// to their deadline is recorded in the
+// TaskScheduler.StartDeadlineMissMicroseconds histograms.
+//
+// E.g.
+// constexpr base::TaskTraits request_handler_traits = {
+//     base::TaskPriority::USER_BLOCKING,
+//     base::StartWithin(base::TimeDelta::FromMilliseconds(5))};
+struct StartWithin {
+  constexpr explicit StartWithin(TimeDelta delay) : delay(delay) {}
+  TimeDelta delay;
+};
+
+namespace internal {
+
+struct StartWithinArgGetter {
+  using ValueType = TimeDelta;
+  constexpr ValueType GetValueFromArg(StartWithin arg) const {
+    return arg.delay;
+  }
+  constexpr ValueType GetDefaultValue() const { return TimeDelta::Max(); }
+};
+
+}  // namespace internal
+
 // Describes immutable metadata for a single task or a group of tasks.
 class BASE_EXPORT TaskTraits {
  private:
@@ -122,6 +152,7 @@ class BASE_EXPORT TaskTraits {
     ValidTrait(TaskShutdownBehavior) {}
     ValidTrait(MayBlock) {}
     ValidTrait(WithBaseSyncPrimitives) {}
+    ValidTrait(StartWithin) {}
   };
 
  public:
@@ -134,8 +165,8 @@ class BASE_EXPORT TaskTraits {
   //
   // To get TaskTraits for tasks that require stricter guarantees and/or know
   // the specific TaskPriority appropriate for them, provide arguments of type
-  // TaskPriority, TaskShutdownBehavior, MayBlock, and/or WithBaseSyncPrimitives
-  // in any order to the constructor.
+  // TaskPriority, TaskShutdownBehavior, MayBlock, WithBaseSyncPrimitives and/or
+  // StartWithin in any order to the constructor.
   //
   // E.g.
   // constexpr base::TaskTraits default_traits = {};
@@ -165,6 +196,9 @@ class BASE_EXPORT TaskTraits {
             args...)),
         with_base_sync_primitives_(internal::GetValueFromArgList(
             internal::BooleanArgGetter<WithBaseSyncPrimitives>(),
+            args...)),
+        start_deadline_(internal::GetValueFromArgList(
+            internal::StartWithinArgGetter(),
             args...)) {}
 
   constexpr TaskTraits(const TaskTraits& other) = default;
@@ -204,6 +238,15 @@ class BASE_EXPORT TaskTraits {
     return with_base_sync_primitives_;
   }
 
+  // Returns true if tasks with these traits have a start deadline.
+  constexpr bool has_start_deadline() const {
+    return !start_deadline_.is_max();
+  }
+
+  // Returns the delay after being posted within which tasks with these traits
+  // should start running. TimeDelta::Max() if there is no such deadline.
+  constexpr TimeDelta start_deadline() const { return start_deadline_; }
+
  private:
   constexpr TaskTraits(const TaskTraits& left, const TaskTraits& right)
       : priority_set_explicitly_(left.priority_set_explicitly_ ||
@@ -218,7 +261,9 @@ class BASE_EXPORT TaskTraits {
                                : left.shutdown_behavior_),
         may_block_(left.may_block_ || right.may_block_),
         with_base_sync_primitives_(left.with_base_sync_primitives_ ||
-                                   right.with_base_sync_primitives_) {}
+                                   right.with_base_sync_primitives_),
+        start_deadline_(right.has_start_deadline() ? right.start_deadline_
+                                                   : left.start_deadline_) {}
 
   bool priority_set_explicitly_;
   TaskPriority priority_;
@@ -226,6 +271,7 @@ class BASE_EXPORT TaskTraits {
   TaskShutdownBehavior shutdown_behavior_;
   bool may_block_;
   bool with_base_sync_primitives_;
+  TimeDelta start_deadline_;
 };
 
 // Returns string literals for the enums defined in this file. These methods
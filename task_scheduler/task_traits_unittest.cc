@@ -15,6 +15,7 @@ TEST(TaskSchedulerTaskTraitsTest, Default) {
   EXPECT_EQ(TaskShutdownBehavior::SKIP_ON_SHUTDOWN, traits.shutdown_behavior());
   EXPECT_FALSE(traits.may_block());
   EXPECT_FALSE(traits.with_base_sync_primitives());
+  EXPECT_FALSE(traits.has_start_deadline());
 }
 
 TEST(TaskSchedulerTaskTraitsTest, TaskPriority) {
@@ -53,6 +54,16 @@ TEST(TaskSchedulerTaskTraitsTest, WithBaseSyncPrimitives) {
   EXPECT_TRUE(traits.with_base_sync_primitives());
 }
 
+TEST(TaskSchedulerTaskTraitsTest, StartWithin) {
+  constexpr TaskTraits traits = {
+      StartWithin(TimeDelta::FromMilliseconds(5))};
+  EXPECT_FALSE(traits.priority_set_explicitly());
+  EXPECT_EQ(TaskPriority::USER_VISIBLE, traits.priority());
+  EXPECT_FALSE(traits.may_block());
+  EXPECT_TRUE(traits.has_start_deadline());
+  EXPECT_EQ(TimeDelta::FromMilliseconds(5), traits.start_deadline());
+}
+
 TEST(TaskSchedulerTaskTraitsTest, MultipleTraits) {
   constexpr TaskTraits traits = {TaskPriority::BACKGROUND,
                                  TaskShutdownBehavior::BLOCK_SHUTDOWN,
@@ -158,6 +169,23 @@ TEST(TaskSchedulerTaskTraitsTest, OverrideWithBaseSyncPrimitives) {
   }
 }
 
+TEST(TaskSchedulerTaskTraitsTest, OverrideStartWithin) {
+  {
+    constexpr TaskTraits left = {StartWithin(TimeDelta::FromMilliseconds(5))};
+    constexpr TaskTraits right = {TaskPriority::USER_BLOCKING};
+    constexpr TaskTraits overridden = TaskTraits::Override(left, right);
+    EXPECT_TRUE(overridden.has_start_deadline());
+    EXPECT_EQ(TimeDelta::FromMilliseconds(5), overridden.start_deadline());
+  }
+  {
+    constexpr TaskTraits left = {StartWithin(TimeDelta::FromMilliseconds(5))};
+    constexpr TaskTraits right = {StartWithin(TimeDelta::FromMilliseconds(2))};
+    constexpr TaskTraits overridden = TaskTraits::Override(left, right);
+    EXPECT_TRUE(overridden.has_start_deadline());
+    EXPECT_EQ(TimeDelta::FromMilliseconds(2), overridden.start_deadline());
+  }
+}
+
 TEST(TaskSchedulerTaskTraitsTest, OverrideMultipleTraits) {
   constexpr TaskTraits left = {MayBlock(), TaskPriority::BACKGROUND,
                                TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN};
@@ -0,0 +1,170 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// base_macrobench replays a task workload (see TaskWorkload) on a
+// TaskScheduler and message loop threads, and prints how they kept up, as
+// perf_test results. Compare configurations by running it with different
+// switches:
+//
+//   base_macrobench [--workload=<workload.json>] [--repetitions=<n>]
+//                   [--foreground-workers=<n>] [--background-workers=<n>]
+//                   [--message-loop-type=default|ui|io]
+//                   [--allocator=malloc|partition_alloc]
+//                   [--virtual-time]
+//
+// With --virtual-time, the workload's post times are on a virtual clock, so
+// that the replay measures the scheduling overhead rather than the workload's
+// idle time.
+//
+// Without --workload, it replays TaskWorkload::CreateRequestReply().
+
+#include <stdio.h>
+
+#include <string>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/optional.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/task_workload.h"
+#include "base/test/task_workload_replayer.h"
+#include "base/time/time.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+constexpr char kWorkloadSwitch[] = "workload";
+constexpr char kRepetitionsSwitch[] = "repetitions";
+constexpr char kForegroundWorkersSwitch[] = "foreground-workers";
+constexpr char kBackgroundWorkersSwitch[] = "background-workers";
+constexpr char kMessageLoopTypeSwitch[] = "message-loop-type";
+constexpr char kAllocatorSwitch[] = "allocator";
+constexpr char kVirtualTimeSwitch[] = "virtual-time";
+
+// Sets |*value| to the positive integer of |switch_name|, if it's present.
+// Returns false if it's invalid.
+bool GetIntSwitch(const CommandLine& command_line,
+                  const char* switch_name,
+                  int* value) {
+  if (!command_line.HasSwitch(switch_name))
+    return true;
+  return StringToInt(command_line.GetSwitchValueASCII(switch_name), value) &&
+         *value > 0;
+}
+
+bool GetConfig(const CommandLine& command_line,
+               TaskWorkloadReplayer::Config* config,
+               int* repetitions) {
+  if (!GetIntSwitch(command_line, kRepetitionsSwitch, repetitions) ||
+      !GetIntSwitch(command_line, kForegroundWorkersSwitch,
+                    &config->foreground_workers) ||
+      !GetIntSwitch(command_line, kBackgroundWorkersSwitch,
+                    &config->background_workers)) {
+    return false;
+  }
+
+  if (command_line.HasSwitch(kMessageLoopTypeSwitch)) {
+    const std::string type =
+        command_line.GetSwitchValueASCII(kMessageLoopTypeSwitch);
+    if (type == "default")
+      config->message_loop_type = MessageLoop::TYPE_DEFAULT;
+    else if (type == "ui")
+      config->message_loop_type = MessageLoop::TYPE_UI;
+    else if (type == "io")
+      config->message_loop_type = MessageLoop::TYPE_IO;
+    else
+      return false;
+  }
+
+  if (command_line.HasSwitch(kAllocatorSwitch)) {
+    const std::string allocator =
+        command_line.GetSwitchValueASCII(kAllocatorSwitch);
+    if (allocator == "malloc")
+      config->allocator = TaskWorkloadReplayer::Allocator::kMalloc;
+    else if (allocator == "partition_alloc")
+      config->allocator = TaskWorkloadReplayer::Allocator::kPartitionAlloc;
+    else
+      return false;
+  }
+
+  config->virtual_time = command_line.HasSwitch(kVirtualTimeSwitch);
+  return true;
+}
+
+Optional<TaskWorkload> GetWorkload(const CommandLine& command_line) {
+  if (!command_line.HasSwitch(kWorkloadSwitch)) {
+    return TaskWorkload::CreateRequestReply(10000,
+                                            TimeDelta::FromMicroseconds(100));
+  }
+  std::string json;
+  if (!ReadFileToString(command_line.GetSwitchValuePath(kWorkloadSwitch),
+                        &json)) {
+    return nullopt;
+  }
+  return TaskWorkload::FromJSON(json);
+}
+
+void PrintResult(const TaskWorkloadReplayer::Result& result) {
+  perf_test::PrintResult("macrobench", "", "wall_time",
+                         result.wall_time.InMillisecondsF(), "ms", false);
+  perf_test::PrintResult("macrobench", "", "throughput",
+                         result.tasks_per_second, "tasks/s", true);
+  perf_test::PrintResult(
+      "macrobench", "", "post_cost_mean",
+      static_cast<double>(result.post_cost_mean.InNanoseconds()), "ns", false);
+  perf_test::PrintResult("macrobench", "", "latency_mean",
+                         result.latency_mean.InMillisecondsF(), "ms", false);
+  perf_test::PrintResult("macrobench", "", "latency_median",
+                         result.latency_median.InMillisecondsF(), "ms", false);
+  perf_test::PrintResult("macrobench", "", "latency_p90",
+                         result.latency_p90.InMillisecondsF(), "ms", false);
+  perf_test::PrintResult("macrobench", "", "latency_p99",
+                         result.latency_p99.InMillisecondsF(), "ms", true);
+  perf_test::PrintResult("macrobench", "", "latency_max",
+                         result.latency_max.InMillisecondsF(), "ms", false);
+  perf_test::PrintResult("macrobench", "", "allocator_lock_contentions",
+                         static_cast<double>(result.allocator_lock_contentions),
+                         "count", false);
+  perf_test::PrintResult(
+      "macrobench", "", "voluntary_context_switches",
+      static_cast<double>(result.voluntary_context_switches), "count", false);
+  perf_test::PrintResult(
+      "macrobench", "", "involuntary_context_switches",
+      static_cast<double>(result.involuntary_context_switches), "count",
+      false);
+}
+
+int RunMacrobench() {
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  TaskWorkloadReplayer::Config config;
+  int repetitions = 3;
+  if (!GetConfig(command_line, &config, &repetitions)) {
+    fprintf(stderr, "Invalid switches.\n");
+    return 1;
+  }
+  const Optional<TaskWorkload> workload = GetWorkload(command_line);
+  if (!workload) {
+    fprintf(stderr, "Couldn't read the workload.\n");
+    return 1;
+  }
+
+  TaskWorkloadReplayer replayer(config);
+  for (int i = 0; i < repetitions; ++i)
+    PrintResult(replayer.Replay(*workload));
+  return 0;
+}
+
+}  // namespace
+
+}  // namespace base
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit_manager;
+  base::CommandLine::Init(argc, argv);
+  return base::RunMacrobench();
+}
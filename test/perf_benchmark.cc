@@ -0,0 +1,66 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/test/perf_benchmark.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/test/perf_log.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+// Returns the nearest-rank |percentile| of |sorted_samples|.
+double Percentile(const std::vector<double>& sorted_samples,
+                  double percentile) {
+  const size_t rank = static_cast<size_t>(
+      ceil(percentile / 100 * sorted_samples.size()));
+  return sorted_samples[std::max<size_t>(rank, 1) - 1];
+}
+
+}  // namespace
+
+PerfBenchmark::PerfBenchmark(const std::string& metric,
+                             const std::string& story,
+                             int iterations)
+    : metric_(metric), story_(story), iterations_(iterations) {
+  DCHECK_GT(iterations, 0);
+}
+
+PerfBenchmark::~PerfBenchmark() = default;
+
+// static
+PerfBenchmark::Result PerfBenchmark::ComputeResult(
+    std::vector<double> samples) {
+  DCHECK(!samples.empty());
+  std::sort(samples.begin(), samples.end());
+  Result result;
+  result.min = samples.front();
+  result.median = Percentile(samples, 50);
+  result.p90 = Percentile(samples, 90);
+  result.max = samples.back();
+  result.mean = std::accumulate(samples.begin(), samples.end(), 0.0) /
+                samples.size();
+  return result;
+}
+
+void PerfBenchmark::Report(const Result& result) const {
+  const std::pair<const char*, double> statistics[] = {
+      {"min", result.min}, {"median", result.median}, {"p90", result.p90},
+      {"max", result.max}, {"mean", result.mean},
+  };
+  const std::string prefix = metric_ + "." + story_ + ".";
+  for (const auto& statistic : statistics)
+    LogPerfResult((prefix + statistic.first).c_str(), statistic.second, "ns");
+  perf_test::PrintResult(metric_, "", story_, result.median, "ns", true);
+}
+
+}  // namespace base
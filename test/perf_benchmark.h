@@ -0,0 +1,95 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TEST_PERF_BENCHMARK_H_
+#define BASE_TEST_PERF_BENCHMARK_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// Times a micro-benchmark over several repetitions, after warmup ones, and
+// reports the distribution of the time per iteration, so that a noisy run
+// shows up as a spread rather than as a regression:
+//
+//   TEST(FooPerfTest, Bar) {
+//     PerfBenchmark benchmark("foo", "bar", 100000);
+//     benchmark.Run([&](int iterations) {
+//       for (int i = 0; i < iterations; ++i)
+//         foo.Bar();
+//     });
+//   }
+//
+// The minimum, median, 90th percentile, maximum and mean are written to the
+// perf log as "<metric>.<story>.<statistic>\t<value>\tns" lines, and the
+// median is also printed with perf_test::PrintResult(). This requires a perf
+// log, which PerfTestSuite (base_perftests) initializes.
+class PerfBenchmark {
+ public:
+  // The times per iteration, in nanoseconds.
+  struct Result {
+    double min = 0;
+    double median = 0;
+    double p90 = 0;
+    double max = 0;
+    double mean = 0;
+  };
+
+  // Each repetition calls the benchmark function once with |iterations|.
+  PerfBenchmark(const std::string& metric,
+                const std::string& story,
+                int iterations);
+  ~PerfBenchmark();
+
+  void set_repetitions(int repetitions) { repetitions_ = repetitions; }
+  void set_warmup_repetitions(int warmup_repetitions) {
+    warmup_repetitions_ = warmup_repetitions;
+  }
+
+  // Runs |function|, a functor taking the number of iterations to run, for
+  // the warmup repetitions and then the timed ones, and reports the result.
+  // The work done outside of the iterations loop, e.g. setting up and
+  // tearing down a container, is included in the time, so it should be
+  // negligible or be what's measured.
+  template <typename Function>
+  Result Run(Function function) {
+    for (int i = 0; i < warmup_repetitions_; ++i)
+      function(iterations_);
+    std::vector<double> samples;
+    samples.reserve(repetitions_);
+    for (int i = 0; i < repetitions_; ++i) {
+      const TimeTicks start = TimeTicks::Now();
+      function(iterations_);
+      samples.push_back((TimeTicks::Now() - start).InNanoseconds() /
+                        static_cast<double>(iterations_));
+    }
+    const Result result = ComputeResult(std::move(samples));
+    Report(result);
+    return result;
+  }
+
+  // Returns the statistics of |samples|, which mustn't be empty. The
+  // percentiles are nearest-rank: they are samples.
+  static Result ComputeResult(std::vector<double> samples);
+
+ private:
+  void Report(const Result& result) const;
+
+  const std::string metric_;
+  const std::string story_;
+  const int iterations_;
+  int repetitions_ = 10;
+  int warmup_repetitions_ = 2;
+
+  DISALLOW_COPY_AND_ASSIGN(PerfBenchmark);
+};
+
+}  // namespace base
+
+#endif  // BASE_TEST_PERF_BENCHMARK_H_
@@ -0,0 +1,38 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/test/perf_benchmark.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(PerfBenchmarkTest, ComputeResult) {
+  PerfBenchmark::Result result = PerfBenchmark::ComputeResult(
+      {7, 1, 10, 3, 2, 9, 4, 6, 5, 8});
+  EXPECT_EQ(1, result.min);
+  EXPECT_EQ(5, result.median);
+  EXPECT_EQ(9, result.p90);
+  EXPECT_EQ(10, result.max);
+  EXPECT_EQ(5.5, result.mean);
+}
+
+TEST(PerfBenchmarkTest, ComputeResultOfOneSample) {
+  PerfBenchmark::Result result = PerfBenchmark::ComputeResult({42});
+  EXPECT_EQ(42, result.min);
+  EXPECT_EQ(42, result.median);
+  EXPECT_EQ(42, result.p90);
+  EXPECT_EQ(42, result.max);
+  EXPECT_EQ(42, result.mean);
+}
+
+TEST(PerfBenchmarkTest, ComputeResultOfTwoSamples) {
+  PerfBenchmark::Result result = PerfBenchmark::ComputeResult({4, 2});
+  EXPECT_EQ(2, result.min);
+  EXPECT_EQ(2, result.median);
+  EXPECT_EQ(4, result.p90);
+  EXPECT_EQ(3, result.mean);
+}
+
+}  // namespace base
@@ -21,7 +21,7 @@ namespace test {
 namespace {
 
 std::vector<StringPiece> GetFeatureVector(
-    const std::vector<Feature>& features) {
+    const std::vector<FeatureRef>& features) {
   std::vector<StringPiece> output;
   for (const Feature& feature : features) {
     output.push_back(feature.name);
@@ -117,8 +117,8 @@ void ScopedFeatureList::InitFromCommandLine(
 }
 
 void ScopedFeatureList::InitWithFeatures(
-    const std::vector<Feature>& enabled_features,
-    const std::vector<Feature>& disabled_features) {
+    const std::vector<FeatureRef>& enabled_features,
+    const std::vector<FeatureRef>& disabled_features) {
   InitWithFeaturesAndFieldTrials(enabled_features, {}, disabled_features);
 }
 
@@ -146,9 +146,9 @@ void ScopedFeatureList::InitWithFeatureState(const Feature& feature,
 }
 
 void ScopedFeatureList::InitWithFeaturesAndFieldTrials(
-    const std::vector<Feature>& enabled_features,
+    const std::vector<FeatureRef>& enabled_features,
     const std::vector<FieldTrial*>& trials_for_enabled_features,
-    const std::vector<Feature>& disabled_features) {
+    const std::vector<FeatureRef>& disabled_features) {
   DCHECK_LE(trials_for_enabled_features.size(), enabled_features.size());
 
   Features merged_features;
@@ -5,6 +5,7 @@
 #ifndef BASE_TEST_SCOPED_FEATURE_LIST_H_
 #define BASE_TEST_SCOPED_FEATURE_LIST_H_
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -17,6 +18,10 @@
 namespace base {
 namespace test {
 
+// Features are referred to rather than copied, since they hold the state cached
+// by FeatureList, which makes them non-copyable.
+using FeatureRef = std::reference_wrapper<const Feature>;
+
 // ScopedFeatureList resets the global FeatureList instance to a new empty
 // instance and restores the original instance upon destruction.
 // Note: Re-using the same object is not allowed. To reset the feature
@@ -63,8 +68,8 @@ class ScopedFeatureList final {
   // continue to apply, unless they conflict with the overrides passed into this
   // method. This is important for testing potentially unexpected feature
   // interactions.
-  void InitWithFeatures(const std::vector<Feature>& enabled_features,
-                        const std::vector<Feature>& disabled_features);
+  void InitWithFeatures(const std::vector<FeatureRef>& enabled_features,
+                        const std::vector<FeatureRef>& disabled_features);
 
   // Initializes and registers a FeatureList instance based on present
   // FeatureList and overridden with single enabled feature.
@@ -99,9 +104,9 @@ class ScopedFeatureList final {
   // features.
   // Trials are expected to outlive the ScopedFeatureList.
   void InitWithFeaturesAndFieldTrials(
-      const std::vector<Feature>& enabled_features,
+      const std::vector<FeatureRef>& enabled_features,
       const std::vector<FieldTrial*>& trials_for_enabled_features,
-      const std::vector<Feature>& disabled_features);
+      const std::vector<FeatureRef>& disabled_features);
 
   // Initializes and registers a FeatureList instance based on present
   // FeatureList and overridden with single enabled feature and associated field
@@ -0,0 +1,258 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/test/task_workload.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/values.h"
+
+namespace base {
+
+namespace {
+
+constexpr char kTasksKey[] = "tasks";
+constexpr char kPostTimeKey[] = "post_time_us";
+constexpr char kPostedFromKey[] = "posted_from";
+constexpr char kPriorityKey[] = "priority";
+constexpr char kMayBlockKey[] = "may_block";
+constexpr char kThreadKey[] = "thread";
+constexpr char kSequenceKey[] = "sequence";
+constexpr char kDurationKey[] = "duration_us";
+constexpr char kAllocatedBytesKey[] = "allocated_bytes";
+constexpr char kChildrenKey[] = "children";
+
+constexpr TaskPriority kPriorities[] = {TaskPriority::BACKGROUND,
+                                        TaskPriority::USER_VISIBLE,
+                                        TaskPriority::USER_BLOCKING};
+
+// Returns the number at |key| in |dict|, or |default_value| if there is none.
+// Returns nullopt if the value isn't a number, or is negative.
+Optional<double> GetNumber(const Value& dict,
+                           StringPiece key,
+                           double default_value) {
+  const Value* value = dict.FindKey(key);
+  if (!value)
+    return default_value;
+  if (!value->is_int() && !value->is_double())
+    return nullopt;
+  if (value->GetDouble() < 0)
+    return nullopt;
+  return value->GetDouble();
+}
+
+bool ParseTask(const Value& dict, TaskWorkload::Task* task) {
+  if (!dict.is_dict())
+    return false;
+
+  const Value* posted_from =
+      dict.FindKeyOfType(kPostedFromKey, Value::Type::STRING);
+  if (!posted_from)
+    return false;
+  task->posted_from = posted_from->GetString();
+
+  const Optional<double> post_time = GetNumber(dict, kPostTimeKey, 0);
+  const Optional<double> duration = GetNumber(dict, kDurationKey, 0);
+  const Optional<double> allocated_bytes =
+      GetNumber(dict, kAllocatedBytesKey, 0);
+  if (!post_time || !duration || !allocated_bytes)
+    return false;
+  task->post_time = TimeDelta::FromMicroseconds(*post_time);
+  task->duration = TimeDelta::FromMicroseconds(*duration);
+  task->allocated_bytes = static_cast<size_t>(*allocated_bytes);
+
+  if (const Value* priority = dict.FindKey(kPriorityKey)) {
+    if (!priority->is_string())
+      return false;
+    const auto it = std::find_if(
+        std::begin(kPriorities), std::end(kPriorities),
+        [priority](TaskPriority candidate) {
+          return priority->GetString() == TaskPriorityToString(candidate);
+        });
+    if (it == std::end(kPriorities))
+      return false;
+    task->priority = *it;
+  }
+
+  if (const Value* may_block = dict.FindKey(kMayBlockKey)) {
+    if (!may_block->is_bool())
+      return false;
+    task->may_block = may_block->GetBool();
+  }
+
+  if (const Value* thread = dict.FindKey(kThreadKey)) {
+    if (!thread->is_string())
+      return false;
+    task->thread = thread->GetString();
+  }
+
+  if (const Value* sequence = dict.FindKey(kSequenceKey)) {
+    if (!sequence->is_int() || sequence->GetInt() < -1)
+      return false;
+    task->sequence = sequence->GetInt();
+  }
+
+  if (const Value* children = dict.FindKey(kChildrenKey)) {
+    if (!children->is_list())
+      return false;
+    for (const Value& child : children->GetList()) {
+      if (!child.is_int() || child.GetInt() < 0)
+        return false;
+      task->children.push_back(child.GetInt());
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TaskWorkload::Task::Task() = default;
+TaskWorkload::Task::Task(const Task& other) = default;
+TaskWorkload::Task::~Task() = default;
+
+TaskWorkload::TaskWorkload() = default;
+TaskWorkload::TaskWorkload(const TaskWorkload& other) = default;
+TaskWorkload::TaskWorkload(TaskWorkload&& other) = default;
+TaskWorkload::~TaskWorkload() = default;
+TaskWorkload& TaskWorkload::operator=(const TaskWorkload& other) = default;
+TaskWorkload& TaskWorkload::operator=(TaskWorkload&& other) = default;
+
+// static
+Optional<TaskWorkload> TaskWorkload::FromJSON(StringPiece json) {
+  std::unique_ptr<Value> root = JSONReader::Read(json);
+  if (!root || !root->is_dict())
+    return nullopt;
+  const Value* tasks = root->FindKeyOfType(kTasksKey, Value::Type::LIST);
+  if (!tasks)
+    return nullopt;
+
+  TaskWorkload workload;
+  for (const Value& dict : tasks->GetList()) {
+    workload.tasks.emplace_back();
+    if (!ParseTask(dict, &workload.tasks.back()))
+      return nullopt;
+  }
+
+  // Each task is posted once: by the replay, or by its only parent, which
+  // comes before it so that there are no cycles.
+  std::vector<bool> is_child(workload.tasks.size());
+  for (size_t i = 0; i < workload.tasks.size(); ++i) {
+    for (size_t child : workload.tasks[i].children) {
+      if (child <= i || child >= workload.tasks.size() || is_child[child])
+        return nullopt;
+      is_child[child] = true;
+    }
+  }
+  return std::move(workload);
+}
+
+std::string TaskWorkload::ToJSON() const {
+  Value::ListStorage list;
+  for (const Task& task : tasks) {
+    Value dict(Value::Type::DICTIONARY);
+    dict.SetKey(kPostTimeKey,
+                Value(static_cast<double>(task.post_time.InMicroseconds())));
+    dict.SetKey(kPostedFromKey, Value(task.posted_from));
+    dict.SetKey(kPriorityKey, Value(TaskPriorityToString(task.priority)));
+    dict.SetKey(kMayBlockKey, Value(task.may_block));
+    dict.SetKey(kThreadKey, Value(task.thread));
+    dict.SetKey(kSequenceKey, Value(task.sequence));
+    dict.SetKey(kDurationKey,
+                Value(static_cast<double>(task.duration.InMicroseconds())));
+    dict.SetKey(kAllocatedBytesKey,
+                Value(static_cast<double>(task.allocated_bytes)));
+    Value::ListStorage children;
+    for (size_t child : task.children)
+      children.emplace_back(static_cast<int>(child));
+    dict.SetKey(kChildrenKey, Value(std::move(children)));
+    list.push_back(std::move(dict));
+  }
+  Value root(Value::Type::DICTIONARY);
+  root.SetKey(kTasksKey, Value(std::move(list)));
+
+  std::string json;
+  JSONWriter::Write(root, &json);
+  return json;
+}
+
+// static
+TaskWorkload TaskWorkload::CreateRequestReply(size_t num_requests,
+                                              TimeDelta request_interval) {
+  TaskWorkload workload;
+  for (size_t i = 0; i < num_requests; ++i) {
+    const size_t request = workload.tasks.size();
+    workload.tasks.resize(request + 3);
+
+    Task& handler = workload.tasks[request];
+    handler.children = {request + 1, request + 2};
+    handler.post_time = request_interval * static_cast<int>(i);
+    handler.posted_from = "HandleRequest";
+    handler.priority = TaskPriority::USER_BLOCKING;
+    handler.duration = TimeDelta::FromMicroseconds(100);
+    handler.allocated_bytes = 16 * 1024;
+
+    // Writes the result to disk, in order.
+    Task& store = workload.tasks[request + 1];
+    store.posted_from = "StoreResult";
+    store.priority = TaskPriority::BACKGROUND;
+    store.may_block = true;
+    store.sequence = 0;
+    store.duration = TimeDelta::FromMicroseconds(50);
+    store.allocated_bytes = 4 * 1024;
+
+    Task& reply = workload.tasks[request + 2];
+    reply.posted_from = "SendReply";
+    reply.thread = "io";
+    reply.duration = TimeDelta::FromMicroseconds(20);
+    reply.allocated_bytes = 1024;
+  }
+  return workload;
+}
+
+TaskWorkloadRecorder::TaskWorkloadRecorder()
+    : start_time_(TimeTicks::Now()) {}
+
+TaskWorkloadRecorder::~TaskWorkloadRecorder() = default;
+
+TaskWorkload TaskWorkloadRecorder::GetWorkload() const {
+  TaskWorkload workload;
+  {
+    AutoLock auto_lock(lock_);
+    workload = workload_;
+  }
+  std::stable_sort(
+      workload.tasks.begin(), workload.tasks.end(),
+      [](const TaskWorkload::Task& a, const TaskWorkload::Task& b) {
+        return a.post_time < b.post_time;
+      });
+  return workload;
+}
+
+void TaskWorkloadRecorder::OnTaskPosted(const Location& posted_from,
+                                        const TaskTraits& traits,
+                                        TimeDelta delay,
+                                        TimeTicks post_time) {}
+
+void TaskWorkloadRecorder::OnTaskStarted(const SampledTask& task) {}
+
+void TaskWorkloadRecorder::OnTaskFinished(const SampledTask& task) {
+  TaskWorkload::Task recorded_task;
+  // A delayed task is replayed as posted when its delay expired.
+  recorded_task.post_time =
+      std::max(TimeDelta(), task.sequenced_time - start_time_);
+  recorded_task.posted_from = task.posted_from.ToString();
+  recorded_task.priority = task.traits.priority();
+  recorded_task.may_block = task.traits.may_block();
+  recorded_task.duration = task.end_time - task.start_time;
+
+  AutoLock auto_lock(lock_);
+  workload_.tasks.push_back(std::move(recorded_task));
+}
+
+}  // namespace base
@@ -0,0 +1,133 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TEST_TASK_WORKLOAD_H_
+#define BASE_TEST_TASK_WORKLOAD_H_
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/optional.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
+#include "base/task_scheduler/task_scheduler_observer.h"
+#include "base/task_scheduler/task_traits.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// A graph of tasks to replay with TaskWorkloadReplayer, to benchmark the
+// scheduler, the message loops and the allocator together, under a realistic
+// load. A workload is recorded from a running TaskScheduler with
+// TaskWorkloadRecorder, or written by hand, and is stored as JSON:
+//
+//   {"tasks": [
+//     {"post_time_us": 0, "posted_from": "Foo@foo.cc:12",
+//      "priority": "USER_VISIBLE", "may_block": false, "thread": "",
+//      "sequence": -1, "duration_us": 200, "allocated_bytes": 4096,
+//      "children": [1]},
+//     {"posted_from": "Bar@bar.cc:34", "thread": "io", "duration_us": 20},
+//     ...
+//   ]}
+//
+// All the fields but "posted_from" are optional, with the defaults of
+// TaskWorkload::Task.
+struct TaskWorkload {
+  struct Task {
+    Task();
+    Task(const Task& other);
+    ~Task();
+
+    // When the task is posted, from the start of the replay. Ignored for the
+    // tasks posted by another task.
+    TimeDelta post_time;
+
+    // Where the task was posted from.
+    std::string posted_from;
+
+    TaskPriority priority = TaskPriority::USER_VISIBLE;
+    bool may_block = false;
+
+    // The name of the thread the task runs on, or an empty string to post it
+    // to the TaskScheduler.
+    std::string thread;
+
+    // The TaskScheduler tasks with the same non-negative |sequence| run in
+    // sequence, in the order they're posted. -1 for a parallel task.
+    int sequence = -1;
+
+    // How long the task keeps its thread busy.
+    TimeDelta duration;
+
+    // How many bytes the task allocates (and frees) while it runs.
+    size_t allocated_bytes = 0;
+
+    // The indices of the tasks this task posts when it's done, e.g. the
+    // replies to a request. They must be greater than its own index.
+    std::vector<size_t> children;
+  };
+
+  TaskWorkload();
+  TaskWorkload(const TaskWorkload& other);
+  TaskWorkload(TaskWorkload&& other);
+  ~TaskWorkload();
+  TaskWorkload& operator=(const TaskWorkload& other);
+  TaskWorkload& operator=(TaskWorkload&& other);
+
+  // Parses a workload in the JSON format above. Returns nullopt if |json|
+  // isn't a valid workload, e.g. if a task is the child of two tasks.
+  static Optional<TaskWorkload> FromJSON(StringPiece json);
+  std::string ToJSON() const;
+
+  // Returns a workload of |num_requests| requests, each a task which posts
+  // replies to a sequence and to the "io" thread, arriving every
+  // |request_interval|.
+  static TaskWorkload CreateRequestReply(size_t num_requests,
+                                         TimeDelta request_interval);
+
+  std::vector<Task> tasks;
+};
+
+// Records the tasks run by a TaskScheduler as a TaskWorkload:
+//
+//   TaskWorkloadRecorder recorder;
+//   TaskScheduler::GetInstance()->SetObserver(&recorder, 1);
+//   ...
+//   std::string json = recorder.GetWorkload().ToJSON();
+//
+// Only the sampled tasks are recorded, with their post time, traits and
+// duration. The recorder doesn't know the sequences of the tasks nor which
+// task posted which, so the recorded tasks are all parallel roots.
+class TaskWorkloadRecorder : public TaskSchedulerObserver {
+ public:
+  TaskWorkloadRecorder();
+  ~TaskWorkloadRecorder() override;
+
+  // Returns the tasks which ran so far, in the order they were posted.
+  TaskWorkload GetWorkload() const;
+
+  // TaskSchedulerObserver:
+  void OnTaskPosted(const Location& posted_from,
+                    const TaskTraits& traits,
+                    TimeDelta delay,
+                    TimeTicks post_time) override;
+  void OnTaskStarted(const SampledTask& task) override;
+  void OnTaskFinished(const SampledTask& task) override;
+
+ private:
+  // The post times are recorded from this time.
+  const TimeTicks start_time_;
+
+  mutable Lock lock_;
+  TaskWorkload workload_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskWorkloadRecorder);
+};
+
+}  // namespace base
+
+#endif  // BASE_TEST_TASK_WORKLOAD_H_
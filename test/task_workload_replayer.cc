@@ -0,0 +1,347 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/test/task_workload_replayer.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/allocator/partition_allocator/spin_lock.h"
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/partition_alloc_buildflags.h"
+#include "base/sequenced_task_runner.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/task_scheduler/scheduler_worker_pool_params.h"
+#include "base/task_scheduler/task_scheduler_impl.h"
+#include "base/test/test_mock_time_task_runner.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread.h"
+#include "build/build_config.h"
+
+#if BUILDFLAG(USE_PARTITION_ALLOC)
+#include "base/allocator/partition_allocator/partition_alloc.h"
+#endif
+
+#if defined(OS_POSIX)
+#include <sys/resource.h>
+#endif
+
+namespace base {
+
+namespace {
+
+// The most blocks a task has allocated at once.
+constexpr size_t kMaxLiveBlocks = 64;
+
+// Returns the nearest-rank |percentile| of |sorted_values|.
+TimeDelta Percentile(const std::vector<TimeDelta>& sorted_values,
+                     int percentile) {
+  const size_t rank = (percentile * sorted_values.size() + 99) / 100;
+  return sorted_values[std::max<size_t>(rank, 1) - 1];
+}
+
+void GetContextSwitches(int64_t* voluntary, int64_t* involuntary) {
+#if defined(OS_POSIX)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    *voluntary = usage.ru_nvcsw;
+    *involuntary = usage.ru_nivcsw;
+    return;
+  }
+#endif
+  *voluntary = 0;
+  *involuntary = 0;
+}
+
+// One replay of a workload.
+class WorkloadRun {
+ public:
+  WorkloadRun(const TaskWorkloadReplayer::Config& config,
+              const TaskWorkload& workload)
+      : config_(config),
+        workload_(workload),
+        scheduler_("TaskWorkloadReplayer"),
+        post_times_(workload.tasks.size()),
+        post_costs_(workload.tasks.size()),
+        start_times_(workload.tasks.size()),
+        remaining_tasks_(workload.tasks.size()),
+        done_(WaitableEvent::ResetPolicy::MANUAL,
+              WaitableEvent::InitialState::NOT_SIGNALED) {
+    if (config.virtual_time) {
+      virtual_time_task_runner_ = MakeRefCounted<TestMockTimeTaskRunner>();
+      scheduler_.SetDelayedTaskRunnerForTesting(virtual_time_task_runner_);
+    }
+    constexpr TimeDelta kSuggestedReclaimTime = TimeDelta::FromSeconds(30);
+    scheduler_.Start({{config.background_workers, kSuggestedReclaimTime},
+                      {config.background_workers, kSuggestedReclaimTime},
+                      {config.foreground_workers, kSuggestedReclaimTime},
+                      {config.foreground_workers, kSuggestedReclaimTime}});
+#if BUILDFLAG(USE_PARTITION_ALLOC)
+    partition_allocator_.init();
+#else
+    CHECK(config.allocator == TaskWorkloadReplayer::Allocator::kMalloc);
+#endif
+
+    // Create the threads and sequences, the latter with the traits of their
+    // first task.
+    for (const TaskWorkload::Task& task : workload.tasks) {
+      if (!task.thread.empty()) {
+        std::unique_ptr<Thread>& thread = threads_[task.thread];
+        if (!thread) {
+          thread = std::make_unique<Thread>(task.thread);
+          CHECK(thread->StartWithOptions(
+              Thread::Options(config.message_loop_type, 0)));
+        }
+      } else if (task.sequence >= 0 && !sequences_[task.sequence]) {
+        sequences_[task.sequence] =
+            scheduler_.CreateSequencedTaskRunnerWithTraits(GetTraits(task));
+      }
+    }
+  }
+
+  ~WorkloadRun() {
+    scheduler_.FlushForTesting();
+    scheduler_.JoinForTesting();
+  }
+
+  // Posts the root tasks at their post times, and returns when all the tasks
+  // ran.
+  void Run() {
+    std::vector<bool> is_child(workload_.tasks.size());
+    for (const TaskWorkload::Task& task : workload_.tasks) {
+      for (size_t child : task.children)
+        is_child[child] = true;
+    }
+    std::vector<size_t> roots;
+    for (size_t i = 0; i < workload_.tasks.size(); ++i) {
+      if (!is_child[i])
+        roots.push_back(i);
+    }
+    std::stable_sort(roots.begin(), roots.end(), [this](size_t a, size_t b) {
+      return workload_.tasks[a].post_time < workload_.tasks[b].post_time;
+    });
+
+    start_time_ = TimeTicks::Now();
+    if (virtual_time_task_runner_) {
+      for (size_t root : roots)
+        PostRootAtVirtualTime(root);
+      virtual_time_task_runner_->FastForwardUntilNoTasksRemain();
+    } else {
+      for (size_t root : roots) {
+        const TimeDelta wait = start_time_ + workload_.tasks[root].post_time -
+                               TimeTicks::Now();
+        if (wait > TimeDelta())
+          PlatformThread::Sleep(wait);
+        PostTask(root, TimeDelta());
+      }
+    }
+    if (!workload_.tasks.empty())
+      done_.Wait();
+  }
+
+  TaskWorkloadReplayer::Result GetResult() const {
+    TaskWorkloadReplayer::Result result;
+    result.num_tasks = workload_.tasks.size();
+    if (workload_.tasks.empty())
+      return result;
+
+    result.wall_time = end_time_ - start_time_;
+    result.tasks_per_second = result.num_tasks / result.wall_time.InSecondsF();
+
+    TimeDelta total_post_cost;
+    TimeDelta total_latency;
+    std::vector<TimeDelta> latencies(workload_.tasks.size());
+    for (size_t i = 0; i < workload_.tasks.size(); ++i) {
+      latencies[i] = start_times_[i] - post_times_[i];
+      total_post_cost += post_costs_[i];
+      total_latency += latencies[i];
+    }
+    result.post_cost_mean = total_post_cost / result.num_tasks;
+    result.latency_mean = total_latency / result.num_tasks;
+    std::sort(latencies.begin(), latencies.end());
+    result.latency_median = Percentile(latencies, 50);
+    result.latency_p90 = Percentile(latencies, 90);
+    result.latency_p99 = Percentile(latencies, 99);
+    result.latency_max = latencies.back();
+    return result;
+  }
+
+ private:
+  static TaskTraits GetTraits(const TaskWorkload::Task& task) {
+    return task.may_block ? TaskTraits(task.priority, MayBlock())
+                          : TaskTraits(task.priority);
+  }
+
+  // Posts the task |index|, after |delay| if it's a root task of the
+  // TaskScheduler replayed with virtual time. The post time of a delayed task
+  // is set when it becomes ripe.
+  void PostTask(size_t index, TimeDelta delay) {
+    const TaskWorkload::Task& task = workload_.tasks[index];
+    OnceClosure closure =
+        BindOnce(&WorkloadRun::RunTask, Unretained(this), index);
+    const TimeTicks post_start = TimeTicks::Now();
+    if (delay.is_zero())
+      post_times_[index] = post_start;
+    if (!task.thread.empty()) {
+      DCHECK(delay.is_zero());
+      threads_.at(task.thread)
+          ->task_runner()
+          ->PostTask(FROM_HERE, std::move(closure));
+    } else if (task.sequence >= 0) {
+      sequences_.at(task.sequence)
+          ->PostDelayedTask(FROM_HERE, std::move(closure), delay);
+    } else {
+      scheduler_.PostDelayedTaskWithTraits(FROM_HERE, GetTraits(task),
+                                           std::move(closure), delay);
+    }
+    post_costs_[index] = TimeTicks::Now() - post_start;
+  }
+
+  // Posts the root task |index| at its post time on the virtual clock.
+  void PostRootAtVirtualTime(size_t index) {
+    const TaskWorkload::Task& task = workload_.tasks[index];
+    if (task.post_time.is_zero()) {
+      PostTask(index, TimeDelta());
+    } else if (!task.thread.empty()) {
+      // The named threads aren't on the virtual clock: post the task to its
+      // thread when the clock reaches its post time.
+      virtual_time_task_runner_->PostDelayedTask(
+          FROM_HERE,
+          BindOnce(&WorkloadRun::PostTask, Unretained(this), index,
+                   TimeDelta()),
+          task.post_time);
+    } else {
+      // The TaskScheduler times its delayed tasks with
+      // |virtual_time_task_runner_|, which runs the tasks due at the same
+      // time in the order they were posted: this one runs right before the
+      // TaskScheduler's, when the task becomes ripe.
+      virtual_time_task_runner_->PostDelayedTask(
+          FROM_HERE,
+          BindOnce(&WorkloadRun::SetPostTime, Unretained(this), index),
+          task.post_time);
+      PostTask(index, task.post_time);
+    }
+  }
+
+  void SetPostTime(size_t index) { post_times_[index] = TimeTicks::Now(); }
+
+  void RunTask(size_t index) {
+    const TaskWorkload::Task& task = workload_.tasks[index];
+    const TimeTicks start_time = TimeTicks::Now();
+    start_times_[index] = start_time;
+
+    void* blocks[kMaxLiveBlocks];
+    size_t remaining_bytes = task.allocated_bytes;
+    while (remaining_bytes) {
+      size_t num_blocks = 0;
+      while (remaining_bytes && num_blocks < kMaxLiveBlocks) {
+        const size_t size = std::min(remaining_bytes, config_.allocation_size);
+        blocks[num_blocks] = Allocate(size);
+        // Touch the block, as a task would.
+        static_cast<volatile char*>(blocks[num_blocks])[0] = 0;
+        remaining_bytes -= size;
+        ++num_blocks;
+      }
+      for (size_t i = 0; i < num_blocks; ++i)
+        Free(blocks[i]);
+    }
+
+    // Keep the thread busy until the end of the task.
+    while (TimeTicks::Now() - start_time < task.duration) {
+    }
+
+    for (size_t child : task.children)
+      PostTask(child, TimeDelta());
+
+    if (remaining_tasks_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      end_time_ = TimeTicks::Now();
+      done_.Signal();
+    }
+  }
+
+  void* Allocate(size_t size) {
+#if BUILDFLAG(USE_PARTITION_ALLOC)
+    if (config_.allocator == TaskWorkloadReplayer::Allocator::kPartitionAlloc)
+      return partition_allocator_.root()->Alloc(size, "TaskWorkloadReplayer");
+#endif
+    return malloc(size);
+  }
+
+  void Free(void* block) {
+#if BUILDFLAG(USE_PARTITION_ALLOC)
+    if (config_.allocator ==
+        TaskWorkloadReplayer::Allocator::kPartitionAlloc) {
+      partition_allocator_.root()->Free(block);
+      return;
+    }
+#endif
+    free(block);
+  }
+
+  const TaskWorkloadReplayer::Config& config_;
+  const TaskWorkload& workload_;
+
+  // Times the delayed tasks of |scheduler_| with virtual time, if enabled.
+  scoped_refptr<TestMockTimeTaskRunner> virtual_time_task_runner_;
+  internal::TaskSchedulerImpl scheduler_;
+  std::map<std::string, std::unique_ptr<Thread>> threads_;
+  std::map<int, scoped_refptr<SequencedTaskRunner>> sequences_;
+#if BUILDFLAG(USE_PARTITION_ALLOC)
+  PartitionAllocatorGeneric partition_allocator_;
+#endif
+
+  // Each task writes its own elements, and they're read when all the tasks
+  // ran.
+  std::vector<TimeTicks> post_times_;
+  std::vector<TimeDelta> post_costs_;
+  std::vector<TimeTicks> start_times_;
+
+  TimeTicks start_time_;
+  // Written by the last task, before it signals |done_|.
+  TimeTicks end_time_;
+  std::atomic<size_t> remaining_tasks_;
+  WaitableEvent done_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkloadRun);
+};
+
+}  // namespace
+
+TaskWorkloadReplayer::TaskWorkloadReplayer(const Config& config)
+    : config_(config) {}
+
+TaskWorkloadReplayer::~TaskWorkloadReplayer() = default;
+
+TaskWorkloadReplayer::Result TaskWorkloadReplayer::Replay(
+    const TaskWorkload& workload) {
+  WorkloadRun run(config_, workload);
+
+  int64_t voluntary_context_switches;
+  int64_t involuntary_context_switches;
+  GetContextSwitches(&voluntary_context_switches,
+                     &involuntary_context_switches);
+  const uint64_t allocator_lock_contentions =
+      subtle::SpinLock::GetContentionCount();
+
+  run.Run();
+
+  Result result = run.GetResult();
+  result.allocator_lock_contentions =
+      subtle::SpinLock::GetContentionCount() - allocator_lock_contentions;
+  GetContextSwitches(&result.voluntary_context_switches,
+                     &result.involuntary_context_switches);
+  result.voluntary_context_switches -= voluntary_context_switches;
+  result.involuntary_context_switches -= involuntary_context_switches;
+  return result;
+}
+
+}  // namespace base
@@ -0,0 +1,113 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TEST_TASK_WORKLOAD_REPLAYER_H_
+#define BASE_TEST_TASK_WORKLOAD_REPLAYER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/macros.h"
+#include "base/message_loop/message_loop.h"
+#include "base/test/task_workload.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// Replays a TaskWorkload on a new TaskSchedulerImpl and message loop threads,
+// and measures how well they kept up, so that configurations can be compared
+// end to end under the same load:
+//
+//   TaskWorkloadReplayer::Config config;
+//   config.foreground_workers = 8;
+//   TaskWorkloadReplayer::Result result =
+//       TaskWorkloadReplayer(config).Replay(workload);
+//
+// The tasks are posted at their post time, or by their parent, and each one
+// keeps its thread busy for its duration while it allocates and frees its
+// bytes.
+//
+// With Config::virtual_time, the post times are on a virtual clock instead:
+// the root tasks are posted as delayed tasks, and the clock jumps to each
+// post time as soon as the tasks due before it were handed to the workers.
+// The replay then takes as long as the workers need to run the tasks, which
+// measures the overhead of the scheduler, delayed tasks included, without
+// waiting out the idle time of the workload.
+class TaskWorkloadReplayer {
+ public:
+  enum class Allocator {
+    // malloc() and free().
+    kMalloc,
+    // A PartitionAllocatorGeneric shared by all the tasks. Only available
+    // when PartitionAlloc is (see use_partition_alloc).
+    kPartitionAlloc,
+  };
+
+  struct Config {
+    // The maximum number of threads of the foreground and background pools of
+    // the TaskScheduler. The pools for blocking tasks have as many threads.
+    int foreground_workers = 4;
+    int background_workers = 1;
+
+    // The type of the MessageLoops of the named threads.
+    MessageLoop::Type message_loop_type = MessageLoop::TYPE_DEFAULT;
+
+    // The allocator of the bytes allocated by the tasks.
+    Allocator allocator = Allocator::kMalloc;
+
+    // The allocated bytes of a task are allocated in blocks of this size.
+    size_t allocation_size = 256;
+
+    // Whether the post times of the root tasks are on a virtual clock.
+    bool virtual_time = false;
+  };
+
+  struct Result {
+    size_t num_tasks = 0;
+
+    // From the first post to the end of the last task.
+    TimeDelta wall_time;
+    double tasks_per_second = 0;
+
+    // The mean time spent in the call posting a task, including the delayed
+    // root tasks with virtual time.
+    TimeDelta post_cost_mean;
+
+    // The latencies of the tasks, from when they're posted, or become ripe
+    // for delayed tasks, to when they start. With enough workers for the
+    // load, this is the overhead of scheduling a task.
+    TimeDelta latency_mean;
+    TimeDelta latency_median;
+    TimeDelta latency_p90;
+    TimeDelta latency_p99;
+    TimeDelta latency_max;
+
+    // How many times a thread waited for a PartitionAlloc lock (see
+    // SpinLock::GetContentionCount()). With Allocator::kMalloc, this only
+    // counts the other partitions of the process, if they're used meanwhile.
+    uint64_t allocator_lock_contentions = 0;
+
+    // The context switches of the process during the replay, on POSIX. The
+    // voluntary ones are mostly threads blocking on a lock or going idle,
+    // the involuntary ones threads preempted because there were more
+    // runnable threads than cores.
+    int64_t voluntary_context_switches = 0;
+    int64_t involuntary_context_switches = 0;
+  };
+
+  explicit TaskWorkloadReplayer(const Config& config);
+  ~TaskWorkloadReplayer();
+
+  // Replays |workload|, and returns when all its tasks ran.
+  Result Replay(const TaskWorkload& workload);
+
+ private:
+  const Config config_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskWorkloadReplayer);
+};
+
+}  // namespace base
+
+#endif  // BASE_TEST_TASK_WORKLOAD_REPLAYER_H_
@@ -0,0 +1,172 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/test/task_workload.h"
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/partition_alloc_buildflags.h"
+#include "base/task_scheduler/scheduler_worker_pool_params.h"
+#include "base/task_scheduler/task_scheduler_impl.h"
+#include "base/test/task_workload_replayer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(TaskWorkloadTest, FromJSON) {
+  Optional<TaskWorkload> workload = TaskWorkload::FromJSON(R"({"tasks": [
+      {"post_time_us": 10, "posted_from": "Foo", "priority": "BACKGROUND",
+       "may_block": true, "sequence": 2, "duration_us": 20,
+       "allocated_bytes": 30, "children": [1]},
+      {"posted_from": "Bar", "thread": "io"}]})");
+  ASSERT_TRUE(workload);
+  ASSERT_EQ(2u, workload->tasks.size());
+
+  const TaskWorkload::Task& foo = workload->tasks[0];
+  EXPECT_EQ(TimeDelta::FromMicroseconds(10), foo.post_time);
+  EXPECT_EQ("Foo", foo.posted_from);
+  EXPECT_EQ(TaskPriority::BACKGROUND, foo.priority);
+  EXPECT_TRUE(foo.may_block);
+  EXPECT_EQ("", foo.thread);
+  EXPECT_EQ(2, foo.sequence);
+  EXPECT_EQ(TimeDelta::FromMicroseconds(20), foo.duration);
+  EXPECT_EQ(30u, foo.allocated_bytes);
+  EXPECT_EQ(std::vector<size_t>({1}), foo.children);
+
+  const TaskWorkload::Task& bar = workload->tasks[1];
+  EXPECT_EQ(TimeDelta(), bar.post_time);
+  EXPECT_EQ(TaskPriority::USER_VISIBLE, bar.priority);
+  EXPECT_FALSE(bar.may_block);
+  EXPECT_EQ("io", bar.thread);
+  EXPECT_EQ(-1, bar.sequence);
+  EXPECT_TRUE(bar.children.empty());
+}
+
+TEST(TaskWorkloadTest, FromInvalidJSON) {
+  EXPECT_FALSE(TaskWorkload::FromJSON("{"));
+  EXPECT_FALSE(TaskWorkload::FromJSON("[]"));
+  EXPECT_FALSE(TaskWorkload::FromJSON(R"({"tasks": [{}]})"));
+  EXPECT_FALSE(TaskWorkload::FromJSON(
+      R"({"tasks": [{"posted_from": "Foo", "priority": "HIGH"}]})"));
+  EXPECT_FALSE(TaskWorkload::FromJSON(
+      R"({"tasks": [{"posted_from": "Foo", "duration_us": -1}]})"));
+  // A task can't post itself or an earlier task.
+  EXPECT_FALSE(TaskWorkload::FromJSON(
+      R"({"tasks": [{"posted_from": "Foo", "children": [0]}]})"));
+  // A task can't be posted twice.
+  EXPECT_FALSE(TaskWorkload::FromJSON(R"({"tasks": [
+      {"posted_from": "Foo", "children": [1, 1]},
+      {"posted_from": "Bar"}]})"));
+  EXPECT_FALSE(TaskWorkload::FromJSON(
+      R"({"tasks": [{"posted_from": "Foo", "children": [1]}]})"));
+}
+
+TEST(TaskWorkloadTest, JSONRoundTrip) {
+  const TaskWorkload workload =
+      TaskWorkload::CreateRequestReply(3, TimeDelta::FromMilliseconds(1));
+  Optional<TaskWorkload> parsed = TaskWorkload::FromJSON(workload.ToJSON());
+  ASSERT_TRUE(parsed);
+  ASSERT_EQ(workload.tasks.size(), parsed->tasks.size());
+  for (size_t i = 0; i < workload.tasks.size(); ++i) {
+    const TaskWorkload::Task& task = workload.tasks[i];
+    const TaskWorkload::Task& parsed_task = parsed->tasks[i];
+    EXPECT_EQ(task.post_time, parsed_task.post_time);
+    EXPECT_EQ(task.posted_from, parsed_task.posted_from);
+    EXPECT_EQ(task.priority, parsed_task.priority);
+    EXPECT_EQ(task.may_block, parsed_task.may_block);
+    EXPECT_EQ(task.thread, parsed_task.thread);
+    EXPECT_EQ(task.sequence, parsed_task.sequence);
+    EXPECT_EQ(task.duration, parsed_task.duration);
+    EXPECT_EQ(task.allocated_bytes, parsed_task.allocated_bytes);
+    EXPECT_EQ(task.children, parsed_task.children);
+  }
+}
+
+TEST(TaskWorkloadTest, Recorder) {
+  internal::TaskSchedulerImpl scheduler("Test");
+  TaskWorkloadRecorder recorder;
+  scheduler.SetObserver(&recorder, 1);
+  constexpr TimeDelta kReclaimTime = TimeDelta::FromSeconds(30);
+  scheduler.Start({{1, kReclaimTime},
+                   {1, kReclaimTime},
+                   {2, kReclaimTime},
+                   {2, kReclaimTime}});
+  scheduler.PostDelayedTaskWithTraits(FROM_HERE, {TaskPriority::BACKGROUND},
+                                      DoNothing(), TimeDelta());
+  scheduler.PostDelayedTaskWithTraits(
+      FROM_HERE, {TaskPriority::USER_BLOCKING, MayBlock()}, DoNothing(),
+      TimeDelta());
+  scheduler.FlushForTesting();
+  scheduler.JoinForTesting();
+
+  const TaskWorkload workload = recorder.GetWorkload();
+  ASSERT_EQ(2u, workload.tasks.size());
+  for (const TaskWorkload::Task& task : workload.tasks) {
+    EXPECT_FALSE(task.posted_from.empty());
+    if (task.priority == TaskPriority::BACKGROUND) {
+      EXPECT_FALSE(task.may_block);
+    } else {
+      EXPECT_EQ(TaskPriority::USER_BLOCKING, task.priority);
+      EXPECT_TRUE(task.may_block);
+    }
+  }
+  EXPECT_LE(workload.tasks[0].post_time, workload.tasks[1].post_time);
+}
+
+TEST(TaskWorkloadReplayerTest, Replay) {
+  const TaskWorkload workload =
+      TaskWorkload::CreateRequestReply(20, TimeDelta::FromMicroseconds(200));
+  TaskWorkloadReplayer::Config config;
+  config.foreground_workers = 2;
+  TaskWorkloadReplayer::Result result =
+      TaskWorkloadReplayer(config).Replay(workload);
+  EXPECT_EQ(workload.tasks.size(), result.num_tasks);
+  // The last request is posted after 19 intervals.
+  EXPECT_GE(result.wall_time, TimeDelta::FromMicroseconds(19 * 200));
+  EXPECT_GT(result.tasks_per_second, 0);
+  EXPECT_LE(result.latency_median, result.latency_p90);
+  EXPECT_LE(result.latency_p90, result.latency_p99);
+  EXPECT_LE(result.latency_p99, result.latency_max);
+}
+
+#if BUILDFLAG(USE_PARTITION_ALLOC)
+TEST(TaskWorkloadReplayerTest, ReplayWithPartitionAlloc) {
+  const TaskWorkload workload =
+      TaskWorkload::CreateRequestReply(20, TimeDelta::FromMicroseconds(200));
+  TaskWorkloadReplayer::Config config;
+  config.allocator = TaskWorkloadReplayer::Allocator::kPartitionAlloc;
+  TaskWorkloadReplayer::Result result =
+      TaskWorkloadReplayer(config).Replay(workload);
+  EXPECT_EQ(workload.tasks.size(), result.num_tasks);
+}
+#endif  // BUILDFLAG(USE_PARTITION_ALLOC)
+
+// With virtual time, the replay doesn't wait for the post times.
+TEST(TaskWorkloadReplayerTest, ReplayWithVirtualTime) {
+  constexpr TimeDelta kRequestInterval = TimeDelta::FromSeconds(10);
+  TaskWorkload workload =
+      TaskWorkload::CreateRequestReply(20, kRequestInterval);
+  // Also post requests to a sequence, and to a named thread, which isn't on
+  // the virtual clock.
+  workload.tasks[3].sequence = 1;
+  workload.tasks[6].thread = "io";
+  TaskWorkloadReplayer::Config config;
+  config.virtual_time = true;
+  TaskWorkloadReplayer::Result result =
+      TaskWorkloadReplayer(config).Replay(workload);
+  EXPECT_EQ(workload.tasks.size(), result.num_tasks);
+  EXPECT_LT(result.wall_time, kRequestInterval);
+  EXPECT_GT(result.post_cost_mean, TimeDelta());
+  EXPECT_LE(result.latency_median, result.latency_max);
+  EXPECT_LE(result.latency_mean, result.latency_max);
+}
+
+TEST(TaskWorkloadReplayerTest, ReplayEmptyWorkload) {
+  TaskWorkloadReplayer::Result result =
+      TaskWorkloadReplayer(TaskWorkloadReplayer::Config())
+          .Replay(TaskWorkload());
+  EXPECT_EQ(0u, result.num_tasks);
+}
+
+}  // namespace base
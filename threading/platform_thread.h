@@ -11,6 +11,8 @@
 
 #include <stddef.h>
 
+#include <vector>
+
 #include "base/base_export.h"
 #include "base/macros.h"
 #include "base/time/time.h"
@@ -229,6 +231,62 @@ class BASE_EXPORT PlatformThread {
   // whole thread group's (i.e. process) priority.
   static void SetThreadPriority(PlatformThreadId thread_id,
                                 ThreadPriority priority);
+
+  // What the kernel knows of how the current thread was scheduled, since it
+  // started.
+  struct SchedulerStats {
+    // Time spent running.
+    TimeDelta cpu_time;
+    // Time spent runnable but waiting for a CPU, including the delay between
+    // being woken up and running. Zero if the kernel doesn't keep schedstats.
+    TimeDelta run_queue_time;
+    // Number of times the thread gave up the CPU to wait for something.
+    int64_t voluntary_context_switches;
+    // Number of times the thread was preempted.
+    int64_t involuntary_context_switches;
+  };
+
+  // Fills |stats| for the current thread. This is meant to be sampled often:
+  // it takes a few system calls, and /proc/thread-self/schedstat is kept open
+  // for the lifetime of the thread after the first call. Returns false on
+  // failure.
+  static bool GetCurrentThreadSchedulerStats(SchedulerStats* stats);
+
+  // Restricts the current thread to the logical processors in |processors|,
+  // numbered as in SysInfo::NumaNodeProcessors(). Returns false on failure,
+  // e.g. if none of |processors| is available to the process.
+  static bool SetCurrentThreadAffinity(const std::vector<int>& processors);
+
+  // How SetCurrentThreadRealtime() schedules a thread ahead of all the threads
+  // with a ThreadPriority. Meant for the few threads whose latency is critical,
+  // since a real-time thread which doesn't block can starve the others.
+  struct RealtimePolicy {
+    enum class Type {
+      // Runs whenever it's runnable, until it blocks or yields (SCHED_FIFO).
+      FIFO,
+      // Gets |runtime| of CPU time in each |period|, within |deadline| of the
+      // start of the period (SCHED_DEADLINE). The kernel refuses it if the
+      // CPU time reserved for such threads would be exceeded.
+      DEADLINE,
+    };
+
+    Type type = Type::FIFO;
+    // The SCHED_FIFO priority, from 1 to 99, also used if DEADLINE falls back
+    // to FIFO.
+    int fifo_priority = 8;
+    // Only used with DEADLINE. A zero |deadline| is the same as |period|.
+    TimeDelta runtime;
+    TimeDelta deadline;
+    TimeDelta period;
+  };
+
+  // Schedules the current thread according to |policy|. Real-time scheduling
+  // needs CAP_SYS_NICE or a high enough RLIMIT_RTPRIO, and DEADLINE further
+  // needs the kernel to accept its parameters, so this falls back: DEADLINE
+  // to FIFO, and FIFO to ThreadPriority::REALTIME_AUDIO, which at least raises
+  // the nice value when allowed. Returns whether |policy| itself was applied.
+  // Threads forked by a real-time thread aren't real-time.
+  static bool SetCurrentThreadRealtime(const RealtimePolicy& policy);
 #endif
 
  private:
@@ -7,6 +7,7 @@
 
 #include "base/base_export.h"
 #include "base/threading/platform_thread.h"
+#include "build/build_config.h"
 
 namespace base {
 
@@ -41,6 +42,13 @@ bool SetCurrentThreadPriorityForPlatform(ThreadPriority priority);
 // Returns false otherwise, leaving |priority| untouched.
 bool GetCurrentThreadPriorityForPlatform(ThreadPriority* priority);
 
+#if defined(OS_LINUX)
+// Forgets the id of the current thread cached by PlatformThread::CurrentId().
+// Must be called in the child of a fork which bypasses pthread_atfork()
+// handlers, like a raw clone().
+BASE_EXPORT void InvalidateTidCache();
+#endif
+
 }  // namespace internal
 
 }  // namespace base
@@ -5,21 +5,31 @@
 #include "base/threading/platform_thread.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
 #include <sched.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
 
 #include "base/files/file_util.h"
 #include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/no_destructor.h"
+#include "base/posix/eintr_wrapper.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
 #include "base/threading/platform_thread_internal_posix.h"
 #include "base/threading/thread_id_name_manager.h"
+#include "base/threading/thread_local_storage.h"
 #include "build/build_config.h"
 
 #if !defined(OS_NACL) && !defined(OS_AIX)
 #include <pthread.h>
 #include <sys/prctl.h>
 #include <sys/resource.h>
+#include <sys/syscall.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -27,6 +37,78 @@
 
 namespace base {
 namespace {
+#if !defined(OS_NACL) && !defined(OS_AIX)
+#if !defined(SCHED_DEADLINE)
+#define SCHED_DEADLINE 6
+#endif
+#if !defined(SCHED_RESET_ON_FORK)
+#define SCHED_RESET_ON_FORK 0x40000000
+#endif
+
+// The argument of sched_setattr(), which glibc doesn't wrap.
+struct SchedAttr {
+  uint32_t size;
+  uint32_t sched_policy;
+  uint64_t sched_flags;
+  int32_t sched_nice;
+  uint32_t sched_priority;
+  uint64_t sched_runtime;
+  uint64_t sched_deadline;
+  uint64_t sched_period;
+};
+
+// Like SCHED_RESET_ON_FORK, for sched_setattr(). A SCHED_DEADLINE thread
+// can't fork without it.
+constexpr uint64_t kSchedFlagResetOnFork = 0x01;
+
+bool SetCurrentThreadDeadline(const PlatformThread::RealtimePolicy& policy) {
+  SchedAttr attr = {};
+  attr.size = sizeof(attr);
+  attr.sched_policy = SCHED_DEADLINE;
+  attr.sched_flags = kSchedFlagResetOnFork;
+  attr.sched_runtime = policy.runtime.InNanoseconds();
+  attr.sched_deadline = policy.deadline.is_zero()
+                            ? policy.period.InNanoseconds()
+                            : policy.deadline.InNanoseconds();
+  attr.sched_period = policy.period.InNanoseconds();
+  if (syscall(__NR_sched_setattr, 0, &attr, 0) != 0) {
+    DVPLOG(1) << "Failed to set SCHED_DEADLINE";
+    return false;
+  }
+  return true;
+}
+
+// Holds, for each thread, the descriptor of its schedstat file plus one, or
+// -1 if it can't be opened, so that the file is only opened once per thread.
+ThreadLocalStorage::Slot& SchedstatFdSlot() {
+  static NoDestructor<ThreadLocalStorage::Slot> slot([](void* value) {
+    intptr_t fd = reinterpret_cast<intptr_t>(value) - 1;
+    if (fd >= 0)
+      close(static_cast<int>(fd));
+  });
+  return *slot;
+}
+
+int GetCurrentThreadSchedstatFd() {
+  ThreadLocalStorage::Slot& slot = SchedstatFdSlot();
+  intptr_t value = reinterpret_cast<intptr_t>(slot.Get());
+  if (!value) {
+    // /proc/thread-self appeared in Linux 3.17.
+    int fd = HANDLE_EINTR(
+        open("/proc/thread-self/schedstat", O_RDONLY | O_CLOEXEC));
+    if (fd < 0) {
+      fd = HANDLE_EINTR(open(StringPrintf("/proc/self/task/%d/schedstat",
+                                          PlatformThread::CurrentId())
+                                 .c_str(),
+                             O_RDONLY | O_CLOEXEC));
+    }
+    value = fd < 0 ? -1 : fd + 1;
+    slot.Set(reinterpret_cast<void*>(value));
+  }
+  return static_cast<int>(value - 1);
+}
+#endif  //  !defined(OS_NACL) && !defined(OS_AIX)
+
 #if !defined(OS_NACL)
 const FilePath::CharType kCgroupDirectory[] =
     FILE_PATH_LITERAL("/sys/fs/cgroup");
@@ -165,6 +247,70 @@ void PlatformThread::SetThreadPriority(PlatformThreadId thread_id,
               << nice_setting;
   }
 }
+
+// static
+bool PlatformThread::GetCurrentThreadSchedulerStats(SchedulerStats* stats) {
+  struct timespec cpu_time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time) != 0)
+    return false;
+  struct rusage usage;
+  if (getrusage(RUSAGE_THREAD, &usage) != 0)
+    return false;
+
+  stats->cpu_time = TimeDelta::FromTimeSpec(cpu_time);
+  stats->voluntary_context_switches = usage.ru_nvcsw;
+  stats->involuntary_context_switches = usage.ru_nivcsw;
+  stats->run_queue_time = TimeDelta();
+
+  // The file is "<cpu time> <run queue time> <timeslices>", in nanoseconds.
+  // It is regenerated each time it is read from the start.
+  int fd = GetCurrentThreadSchedstatFd();
+  if (fd >= 0) {
+    char buffer[96];
+    ssize_t size = HANDLE_EINTR(pread(fd, buffer, sizeof(buffer) - 1, 0));
+    uint64_t run_ns;
+    uint64_t run_queue_ns;
+    if (size > 0) {
+      buffer[size] = '\0';
+      if (sscanf(buffer, "%" SCNu64 " %" SCNu64, &run_ns, &run_queue_ns) ==
+          2) {
+        stats->run_queue_time = TimeDelta::FromNanoseconds(run_queue_ns);
+      }
+    }
+  }
+  return true;
+}
+
+// static
+bool PlatformThread::SetCurrentThreadAffinity(
+    const std::vector<int>& processors) {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int processor : processors) {
+    if (processor < 0 || processor >= CPU_SETSIZE)
+      return false;
+    CPU_SET(processor, &cpu_set);
+  }
+  return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+}
+
+// static
+bool PlatformThread::SetCurrentThreadRealtime(const RealtimePolicy& policy) {
+  if (policy.type == RealtimePolicy::Type::DEADLINE &&
+      SetCurrentThreadDeadline(policy)) {
+    return true;
+  }
+
+  const struct sched_param param = {policy.fifo_priority};
+  if (pthread_setschedparam(pthread_self(), SCHED_FIFO | SCHED_RESET_ON_FORK,
+                            &param) == 0) {
+    return policy.type == RealtimePolicy::Type::FIFO;
+  }
+  DVPLOG(1) << "Failed to set SCHED_FIFO";
+
+  SetCurrentThreadPriority(ThreadPriority::REALTIME_AUDIO);
+  return false;
+}
 #endif  //  !defined(OS_NACL) && !defined(OS_AIX)
 
 void InitThreading() {}
@@ -15,6 +15,7 @@
 
 #include <memory>
 
+#include "base/compiler_specific.h"
 #include "base/debug/activity_tracker.h"
 #include "base/lazy_instance.h"
 #include "base/logging.h"
@@ -41,6 +42,14 @@ size_t GetDefaultThreadStackSize(const pthread_attr_t& attributes);
 
 namespace {
 
+#if defined(OS_LINUX)
+// The id of the current thread, or -1 until PlatformThread::CurrentId() is
+// first called on it, since gettid() is a syscall and CurrentId() is called
+// on hot paths. The initial-exec model makes it a fixed offset from the thread
+// pointer.
+__attribute__((tls_model("initial-exec"))) thread_local pid_t g_thread_id = -1;
+#endif
+
 struct ThreadParams {
   ThreadParams()
       : delegate(nullptr), joinable(false), priority(ThreadPriority::NORMAL) {}
@@ -132,6 +141,16 @@ bool CreateThread(size_t stack_size,
 
 }  // namespace
 
+#if defined(OS_LINUX)
+namespace internal {
+
+void InvalidateTidCache() {
+  g_thread_id = -1;
+}
+
+}  // namespace internal
+#endif
+
 // static
 PlatformThreadId PlatformThread::CurrentId() {
   // Pthreads doesn't have the concept of a thread ID, so we have to reach down
@@ -139,7 +158,16 @@ PlatformThreadId PlatformThread::CurrentId() {
 #if defined(OS_MACOSX)
   return pthread_mach_thread_np(pthread_self());
 #elif defined(OS_LINUX)
-  return syscall(__NR_gettid);
+  if (UNLIKELY(g_thread_id == -1)) {
+    // The child of a fork() has a single thread, with another id than the
+    // thread which forked it. The handler is registered before any id is
+    // cached, so no child inherits a stale one.
+    static const int at_fork_registered =
+        pthread_atfork(nullptr, nullptr, &internal::InvalidateTidCache);
+    ALLOW_UNUSED_LOCAL(at_fork_registered);
+    g_thread_id = syscall(__NR_gettid);
+  }
+  return g_thread_id;
 #elif defined(OS_ANDROID)
   return gettid();
 #elif defined(OS_FUCHSIA)
@@ -190,7 +218,7 @@ void PlatformThread::Sleep(TimeDelta duration) {
 
 // static
 const char* PlatformThread::GetName() {
-  return ThreadIdNameManager::GetInstance()->GetName(CurrentId());
+  return ThreadIdNameManager::GetInstance()->GetNameForCurrentThread();
 }
 
 // static
@@ -8,15 +8,25 @@
 #include "base/macros.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/threading/platform_thread.h"
+#include "base/time/time.h"
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 #if defined(OS_POSIX)
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "base/posix/eintr_wrapper.h"
 #include "base/threading/platform_thread_internal_posix.h"
 #elif defined(OS_WIN)
 #include <windows.h>
 #endif
 
+#if defined(OS_LINUX)
+#include <sys/syscall.h>
+#endif
+
 namespace base {
 
 // Trivial tests that thread runs and doesn't crash on create, join, or detach -
@@ -355,6 +365,96 @@ TEST(PlatformThreadTest, GetNiceValueToThreadPriority) {
 #endif  // defined(OS_POSIX) && !defined(OS_MACOSX) && !defined(OS_IOS) &&
         // !defined(OS_FUCHSIA)
 
+#if defined(OS_LINUX)
+TEST(PlatformThreadTest, GetCurrentThreadSchedulerStats) {
+  PlatformThread::SchedulerStats before;
+  ASSERT_TRUE(PlatformThread::GetCurrentThreadSchedulerStats(&before));
+
+  const ThreadTicks end = ThreadTicks::Now() + TimeDelta::FromMilliseconds(10);
+  while (ThreadTicks::Now() < end) {
+  }
+  // Give up the CPU once.
+  PlatformThread::Sleep(TimeDelta::FromMilliseconds(1));
+
+  PlatformThread::SchedulerStats after;
+  ASSERT_TRUE(PlatformThread::GetCurrentThreadSchedulerStats(&after));
+  EXPECT_GE(after.cpu_time - before.cpu_time, TimeDelta::FromMilliseconds(10));
+  EXPECT_GE(after.run_queue_time, before.run_queue_time);
+  EXPECT_GT(after.voluntary_context_switches,
+            before.voluntary_context_switches);
+  EXPECT_GE(after.involuntary_context_switches,
+            before.involuntary_context_switches);
+}
+
+TEST(PlatformThreadTest, CurrentIdAfterFork) {
+  // Warm up the thread id cache.
+  ASSERT_EQ(syscall(__NR_gettid), PlatformThread::CurrentId());
+
+  const pid_t pid = fork();
+  if (pid == 0)
+    _exit(syscall(__NR_gettid) == PlatformThread::CurrentId() ? 0 : 1);
+
+  ASSERT_NE(-1, pid);
+  int status = 42;
+  ASSERT_EQ(pid, HANDLE_EINTR(waitpid(pid, &status, 0)));
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+}
+
+namespace {
+
+class RealtimeThread : public PlatformThread::Delegate {
+ public:
+  explicit RealtimeThread(const PlatformThread::RealtimePolicy& policy)
+      : policy_(policy) {}
+
+  bool applied() const { return applied_; }
+  int scheduling_policy() const { return scheduling_policy_; }
+
+  // PlatformThread::Delegate:
+  void ThreadMain() override {
+    applied_ = PlatformThread::SetCurrentThreadRealtime(policy_);
+    scheduling_policy_ = sched_getscheduler(0);
+  }
+
+ private:
+  const PlatformThread::RealtimePolicy policy_;
+  bool applied_ = false;
+  int scheduling_policy_ = -1;
+
+  DISALLOW_COPY_AND_ASSIGN(RealtimeThread);
+};
+
+}  // namespace
+
+TEST(PlatformThreadTest, SetCurrentThreadRealtime) {
+  // Whether the policies are allowed depends on the privileges of the test,
+  // so only check that they're really applied when reported to be.
+  PlatformThread::RealtimePolicy fifo;
+  RealtimeThread fifo_thread(fifo);
+  PlatformThreadHandle handle;
+  ASSERT_TRUE(PlatformThread::Create(0, &fifo_thread, &handle));
+  PlatformThread::Join(handle);
+  if (fifo_thread.applied()) {
+    EXPECT_EQ(SCHED_FIFO,
+              fifo_thread.scheduling_policy() & ~SCHED_RESET_ON_FORK);
+  }
+
+  PlatformThread::RealtimePolicy deadline;
+  deadline.type = PlatformThread::RealtimePolicy::Type::DEADLINE;
+  deadline.runtime = TimeDelta::FromMilliseconds(1);
+  deadline.deadline = TimeDelta::FromMilliseconds(10);
+  deadline.period = TimeDelta::FromMilliseconds(10);
+  RealtimeThread deadline_thread(deadline);
+  ASSERT_TRUE(PlatformThread::Create(0, &deadline_thread, &handle));
+  PlatformThread::Join(handle);
+  if (deadline_thread.applied()) {
+    EXPECT_EQ(6 /* SCHED_DEADLINE */,
+              deadline_thread.scheduling_policy() & ~SCHED_RESET_ON_FORK);
+  }
+}
+#endif  // defined(OS_LINUX)
+
 TEST(PlatformThreadTest, SetHugeThreadName) {
   // Construct an excessively long thread name.
   std::string long_name(1024, 'a');
@@ -21,10 +21,14 @@ class PostTaskAndReplyRelay {
  public:
   PostTaskAndReplyRelay(const Location& from_here,
                         OnceClosure task,
-                        OnceClosure reply)
+                        OnceClosure reply,
+                        scoped_refptr<SequencedTaskRunner> reply_task_runner,
+                        bool run_reply_inline)
       : from_here_(from_here),
         task_(std::move(task)),
-        reply_(std::move(reply)) {}
+        reply_(std::move(reply)),
+        reply_task_runner_(std::move(reply_task_runner)),
+        run_reply_inline_(run_reply_inline) {}
   PostTaskAndReplyRelay(PostTaskAndReplyRelay&&) = default;
 
   ~PostTaskAndReplyRelay() {
@@ -78,6 +82,12 @@ class PostTaskAndReplyRelay {
     DCHECK(relay.task_);
     std::move(relay.task_).Run();
 
+    if (relay.run_reply_inline_) {
+      DCHECK(relay.reply_task_runner_->RunsTasksInCurrentSequence());
+      RunReply(std::move(relay));
+      return;
+    }
+
     // Keep a reference to the reply TaskRunner for the PostTask() call before
     // |relay| is moved into a callback.
     scoped_refptr<SequencedTaskRunner> reply_task_runner =
@@ -100,8 +110,10 @@ class PostTaskAndReplyRelay {
   const Location from_here_;
   OnceClosure task_;
   OnceClosure reply_;
-  const scoped_refptr<SequencedTaskRunner> reply_task_runner_ =
-      SequencedTaskRunnerHandle::Get();
+  const scoped_refptr<SequencedTaskRunner> reply_task_runner_;
+  // Whether |task_| runs on |reply_task_runner_|, so that |reply_| can run
+  // right after it.
+  const bool run_reply_inline_;
 
   DISALLOW_COPY_AND_ASSIGN(PostTaskAndReplyRelay);
 };
@@ -116,10 +128,21 @@ bool PostTaskAndReplyImpl::PostTaskAndReply(const Location& from_here,
   DCHECK(task) << from_here.ToString();
   DCHECK(reply) << from_here.ToString();
 
-  return PostTask(from_here,
-                  BindOnce(&PostTaskAndReplyRelay::RunTaskAndPostReply,
-                           PostTaskAndReplyRelay(from_here, std::move(task),
-                                                 std::move(reply))));
+  scoped_refptr<SequencedTaskRunner> reply_task_runner =
+      SequencedTaskRunnerHandle::Get();
+  const bool run_reply_inline = PostsTo(reply_task_runner.get());
+  return PostTask(
+      from_here,
+      BindOnce(&PostTaskAndReplyRelay::RunTaskAndPostReply,
+               PostTaskAndReplyRelay(from_here, std::move(task),
+                                     std::move(reply),
+                                     std::move(reply_task_runner),
+                                     run_reply_inline)));
+}
+
+bool PostTaskAndReplyImpl::PostsTo(
+    const SequencedTaskRunner* task_runner) const {
+  return false;
 }
 
 }  // namespace internal
@@ -12,6 +12,9 @@
 #include "base/location.h"
 
 namespace base {
+
+class SequencedTaskRunner;
+
 namespace internal {
 
 // Inherit from this in a class that implements PostTask to send a task to a
@@ -24,7 +27,8 @@ class BASE_EXPORT PostTaskAndReplyImpl {
   virtual ~PostTaskAndReplyImpl() = default;
 
   // Posts |task| by calling PostTask(). On completion, posts |reply| to the
-  // origin sequence. Can only be called when
+  // origin sequence, or runs it right away if PostTask() posts to the origin
+  // sequence's SequencedTaskRunner (see PostsTo()). Can only be called when
   // SequencedTaskRunnerHandle::IsSet(). Each callback is deleted synchronously
   // after running, or scheduled for asynchronous deletion on the origin
   // sequence if it can't run (e.g. if a TaskRunner skips it on shutdown). See
@@ -38,6 +42,11 @@ class BASE_EXPORT PostTaskAndReplyImpl {
 
  private:
   virtual bool PostTask(const Location& from_here, OnceClosure task) = 0;
+
+  // Returns true if PostTask() posts to |task_runner|. The reply then runs at
+  // the end of the task rather than in a task of its own, since it would run
+  // on the same sequence anyway.
+  virtual bool PostsTo(const SequencedTaskRunner* task_runner) const;
 };
 
 }  // namespace internal
@@ -12,6 +12,7 @@
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
 #include "base/test/test_mock_time_task_runner.h"
+#include "base/threading/sequenced_task_runner_handle.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -32,6 +33,10 @@ class PostTaskAndReplyTaskRunner : public internal::PostTaskAndReplyImpl {
     return destination_->PostTask(from_here, std::move(task));
   }
 
+  bool PostsTo(const SequencedTaskRunner* task_runner) const override {
+    return destination_ == task_runner;
+  }
+
   // Non-owning.
   TaskRunner* const destination_;
 };
@@ -194,5 +199,35 @@ TEST_F(PostTaskAndReplyImplTest, ReplyDoesNotRun) {
   EXPECT_TRUE(delete_reply_flag_);
 }
 
+TEST_F(PostTaskAndReplyImplTest, PostTaskAndReplyToReplySequence) {
+  // |reply_runner_| is bound to this thread through a proxy.
+  EXPECT_TRUE(
+      PostTaskAndReplyTaskRunner(SequencedTaskRunnerHandle::Get().get())
+          .PostTaskAndReply(
+              FROM_HERE,
+              BindOnce(&MockObject::Task, Unretained(&mock_object_),
+                       MakeRefCounted<ObjectToDelete>(&delete_task_flag_)),
+              BindOnce(&MockObject::Reply, Unretained(&mock_object_),
+                       MakeRefCounted<ObjectToDelete>(&delete_reply_flag_))));
+  bool other_task_ran = false;
+  reply_runner_->PostTask(
+      FROM_HERE, BindOnce([](bool* other_task_ran) { *other_task_ran = true; },
+                          Unretained(&other_task_ran)));
+
+  // The reply should run right after the task, rather than be posted after the
+  // other task.
+  testing::InSequence in_sequence;
+  EXPECT_CALL(mock_object_, Task(_));
+  EXPECT_CALL(mock_object_, Reply(_))
+      .WillOnce(testing::Invoke(
+          [&other_task_ran](scoped_refptr<ObjectToDelete> object) {
+            EXPECT_FALSE(other_task_ran);
+          }));
+  reply_runner_->RunUntilIdleWithRunsTasksInCurrentSequence();
+  EXPECT_TRUE(other_task_ran);
+  EXPECT_TRUE(delete_task_flag_);
+  EXPECT_TRUE(delete_reply_flag_);
+}
+
 }  // namespace internal
 }  // namespace base
@@ -9,13 +9,40 @@
 #include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/threading/thread_local.h"
+#include "build/build_config.h"
 
 namespace base {
 namespace internal {
 
 namespace {
+
+#if defined(OS_LINUX)
+// The SequenceLocalStorageMap bound to the current thread. The initial-exec
+// model makes it a fixed offset from the thread pointer, unlike the
+// ThreadLocalStorage lookup of ThreadLocalPointer.
+__attribute__((tls_model("initial-exec"))) thread_local SequenceLocalStorageMap*
+    g_current_sequence_local_storage = nullptr;
+
+SequenceLocalStorageMap* GetCurrentSequenceLocalStorage() {
+  return g_current_sequence_local_storage;
+}
+
+void SetCurrentSequenceLocalStorage(SequenceLocalStorageMap* map) {
+  g_current_sequence_local_storage = map;
+}
+#else
 LazyInstance<ThreadLocalPointer<SequenceLocalStorageMap>>::Leaky
     tls_current_sequence_local_storage = LAZY_INSTANCE_INITIALIZER;
+
+SequenceLocalStorageMap* GetCurrentSequenceLocalStorage() {
+  return tls_current_sequence_local_storage.Get().Get();
+}
+
+void SetCurrentSequenceLocalStorage(SequenceLocalStorageMap* map) {
+  tls_current_sequence_local_storage.Get().Set(map);
+}
+#endif
+
 }  // namespace
 
 SequenceLocalStorageMap::SequenceLocalStorageMap() = default;
@@ -25,18 +52,18 @@ SequenceLocalStorageMap::~SequenceLocalStorageMap() = default;
 ScopedSetSequenceLocalStorageMapForCurrentThread::
     ScopedSetSequenceLocalStorageMapForCurrentThread(
         SequenceLocalStorageMap* sequence_local_storage) {
-  DCHECK(!tls_current_sequence_local_storage.Get().Get());
-  tls_current_sequence_local_storage.Get().Set(sequence_local_storage);
+  DCHECK(!GetCurrentSequenceLocalStorage());
+  SetCurrentSequenceLocalStorage(sequence_local_storage);
 }
 
 ScopedSetSequenceLocalStorageMapForCurrentThread::
     ~ScopedSetSequenceLocalStorageMapForCurrentThread() {
-  tls_current_sequence_local_storage.Get().Set(nullptr);
+  SetCurrentSequenceLocalStorage(nullptr);
 }
 
 SequenceLocalStorageMap& SequenceLocalStorageMap::GetForCurrentThread() {
   SequenceLocalStorageMap* current_sequence_local_storage =
-      tls_current_sequence_local_storage.Get().Get();
+      GetCurrentSequenceLocalStorage();
 
   DCHECK(current_sequence_local_storage)
       << "SequenceLocalStorageSlot cannot be used because no "
@@ -47,28 +74,18 @@ SequenceLocalStorageMap& SequenceLocalStorageMap::GetForCurrentThread() {
   return *current_sequence_local_storage;
 }
 
-void* SequenceLocalStorageMap::Get(int slot_id) {
-  const auto it = sls_map_.find(slot_id);
-  if (it == sls_map_.end())
-    return nullptr;
-  return it->second.value();
-}
-
 void SequenceLocalStorageMap::Set(
     int slot_id,
     SequenceLocalStorageMap::ValueDestructorPair value_destructor_pair) {
-  auto it = sls_map_.find(slot_id);
-
-  if (it == sls_map_.end())
-    sls_map_.emplace(slot_id, std::move(value_destructor_pair));
-  else
-    it->second = std::move(value_destructor_pair);
-
-  // The maximum number of entries in the map is 256. This can be adjusted, but
-  // will require reviewing the choice of data structure for the map.
-  DCHECK_LE(sls_map_.size(), 256U);
+  DCHECK_GE(slot_id, 0);
+  if (static_cast<size_t>(slot_id) >= values_.size())
+    values_.resize(slot_id + 1);
+  values_[slot_id] = std::move(value_destructor_pair);
 }
 
+SequenceLocalStorageMap::ValueDestructorPair::ValueDestructorPair()
+    : value_(nullptr), destructor_(nullptr) {}
+
 SequenceLocalStorageMap::ValueDestructorPair::ValueDestructorPair(
     void* value,
     DestructorFunc* destructor)
@@ -5,8 +5,11 @@
 #ifndef BASE_THREADING_SEQUENCE_LOCAL_STORAGE_MAP_H_
 #define BASE_THREADING_SEQUENCE_LOCAL_STORAGE_MAP_H_
 
+#include <stddef.h>
+
+#include <vector>
+
 #include "base/base_export.h"
-#include "base/containers/flat_map.h"
 #include "base/macros.h"
 
 namespace base {
@@ -37,6 +40,8 @@ class BASE_EXPORT SequenceLocalStorageMap {
    public:
     using DestructorFunc = void(void*);
 
+    // Holds no value.
+    ValueDestructorPair();
     ValueDestructorPair(void* value, DestructorFunc* destructor);
     ~ValueDestructorPair();
 
@@ -54,18 +59,21 @@ class BASE_EXPORT SequenceLocalStorageMap {
   };
 
   // Returns the value stored in |slot_id| or nullptr if no value was stored.
-  void* Get(int slot_id);
+  void* Get(int slot_id) {
+    return static_cast<size_t>(slot_id) < values_.size()
+               ? values_[slot_id].value()
+               : nullptr;
+  }
 
   // Stores |value_destructor_pair| in |slot_id|. Overwrites and destroys any
   // previously stored value.
   void Set(int slot_id, ValueDestructorPair value_destructor_pair);
 
  private:
-  // Map from slot id to ValueDestructorPair.
-  // flat_map was chosen because there are expected to be relatively few entries
-  // in the map. For low number of entries, flat_map is known to perform better
-  // than other map implementations.
-  base::flat_map<int, ValueDestructorPair> sls_map_;
+  // ValueDestructorPairs indexed by slot id. Slot ids are handed out densely
+  // from 0, so this is only as large as the highest slot id used by the
+  // sequence, and Get() is a bounds check and an index.
+  std::vector<ValueDestructorPair> values_;
 
   DISALLOW_COPY_AND_ASSIGN(SequenceLocalStorageMap);
 };
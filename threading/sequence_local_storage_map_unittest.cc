@@ -64,6 +64,22 @@ TEST(SequenceLocalStorageMapTest, SetGet) {
   EXPECT_EQ(*static_cast<int*>(sequence_local_storage_map.Get(kSlotId)), 5);
 }
 
+// Verify that the slots which weren't set, below and above the ones which
+// were, have no value.
+TEST(SequenceLocalStorageMapTest, GetUnsetSlots) {
+  SequenceLocalStorageMap sequence_local_storage_map;
+  EXPECT_EQ(nullptr, sequence_local_storage_map.Get(kSlotId));
+
+  sequence_local_storage_map.Set(kSlotId + 2,
+                                 CreateValueDestructorPair<int>(5));
+
+  EXPECT_EQ(nullptr, sequence_local_storage_map.Get(kSlotId));
+  EXPECT_EQ(nullptr, sequence_local_storage_map.Get(kSlotId + 1));
+  EXPECT_EQ(*static_cast<int*>(sequence_local_storage_map.Get(kSlotId + 2)),
+            5);
+  EXPECT_EQ(nullptr, sequence_local_storage_map.Get(kSlotId + 3));
+}
+
 // Verify that the destructor is called on a value stored in the
 // SequenceLocalStorageMap when SequenceLocalStorageMap is destroyed.
 TEST(SequenceLocalStorageMapTest, Destructor) {
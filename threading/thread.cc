@@ -97,6 +97,10 @@ bool Thread::StartWithOptions(const Options& options) {
     type = MessageLoop::TYPE_CUSTOM;
 
   message_loop_timer_slack_ = options.timer_slack;
+#if defined(OS_LINUX)
+  processor_affinity_ = options.processor_affinity;
+  realtime_policy_ = options.realtime_policy;
+#endif
   std::unique_ptr<MessageLoop> message_loop_owned =
       MessageLoop::CreateUnbound(type, options.message_pump_factory);
   message_loop_ = message_loop_owned.get();
@@ -298,6 +302,15 @@ void Thread::ThreadMain() {
   PlatformThread::SetName(name_.c_str());
   ANNOTATE_THREAD_NAME(name_.c_str());  // Tell the name to race detector.
 
+#if defined(OS_LINUX)
+  if (!processor_affinity_.empty() &&
+      !PlatformThread::SetCurrentThreadAffinity(processor_affinity_)) {
+    DLOG(WARNING) << "Failed to set the affinity of thread " << name_;
+  }
+  if (realtime_policy_)
+    PlatformThread::SetCurrentThreadRealtime(*realtime_policy_);
+#endif
+
   // Lazily initialize the |message_loop| so that it can run on this thread.
   DCHECK(message_loop_);
   std::unique_ptr<MessageLoop> message_loop(message_loop_);
@@ -9,12 +9,14 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/callback.h"
 #include "base/macros.h"
 #include "base/message_loop/message_loop.h"
 #include "base/message_loop/timer_slack.h"
+#include "base/optional.h"
 #include "base/sequence_checker.h"
 #include "base/single_thread_task_runner.h"
 #include "base/synchronization/atomic_flag.h"
@@ -87,6 +89,18 @@ class BASE_EXPORT Thread : PlatformThread::Delegate {
     // Specifies the initial thread priority.
     ThreadPriority priority = ThreadPriority::NORMAL;
 
+#if defined(OS_LINUX)
+    // If not empty, the logical processors the thread is restricted to, set
+    // before the message loop starts. See
+    // PlatformThread::SetCurrentThreadAffinity().
+    std::vector<int> processor_affinity;
+
+    // If set, the thread switches to this real-time scheduling policy before
+    // the message loop starts, overriding |priority|. See
+    // PlatformThread::SetCurrentThreadRealtime().
+    Optional<PlatformThread::RealtimePolicy> realtime_policy;
+#endif
+
     // If false, the thread will not be joined on destruction. This is intended
     // for threads that want TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN
     // semantics. Non-joinable threads can't be joined (must be leaked and
@@ -338,6 +352,13 @@ class BASE_EXPORT Thread : PlatformThread::Delegate {
   // a thread.
   TimerSlack message_loop_timer_slack_ = TIMER_SLACK_NONE;
 
+#if defined(OS_LINUX)
+  // Store Options::processor_affinity and Options::realtime_policy until they
+  // are applied on the thread.
+  std::vector<int> processor_affinity_;
+  Optional<PlatformThread::RealtimePolicy> realtime_policy_;
+#endif
+
   // The name of the thread.  Used for debugging purposes.
   const std::string name_;
 
@@ -9,14 +9,12 @@
 namespace base {
 
 ThreadCheckerImpl::ThreadCheckerImpl() {
-  AutoLock auto_lock(lock_);
   EnsureAssigned();
 }
 
 ThreadCheckerImpl::~ThreadCheckerImpl() = default;
 
 bool ThreadCheckerImpl::CalledOnValidThread() const {
-  AutoLock auto_lock(lock_);
   EnsureAssigned();
 
   // Always return true when called from the task from which this
@@ -38,20 +36,28 @@ bool ThreadCheckerImpl::CalledOnValidThread() const {
 }
 
 void ThreadCheckerImpl::DetachFromThread() {
-  AutoLock auto_lock(lock_);
-  thread_id_ = PlatformThreadRef();
-  task_token_ = TaskToken();
-  sequence_token_ = SequenceToken();
+  // The members are overwritten when the checker is bound again.
+  state_.store(UNBOUND, std::memory_order_release);
 }
 
 void ThreadCheckerImpl::EnsureAssigned() const {
-  lock_.AssertAcquired();
-  if (!thread_id_.is_null())
+  if (LIKELY(state_.load(std::memory_order_acquire) == BOUND))
     return;
 
-  thread_id_ = PlatformThread::CurrentRef();
-  task_token_ = TaskToken::GetForCurrentThread();
-  sequence_token_ = SequenceToken::GetForCurrentThread();
+  int expected = UNBOUND;
+  if (state_.compare_exchange_strong(expected, BINDING,
+                                     std::memory_order_acquire)) {
+    thread_id_ = PlatformThread::CurrentRef();
+    task_token_ = TaskToken::GetForCurrentThread();
+    sequence_token_ = SequenceToken::GetForCurrentThread();
+    state_.store(BOUND, std::memory_order_release);
+    return;
+  }
+
+  // Another thread is binding the checker, so this check is about to fail;
+  // wait for the members to be written before reading them.
+  while (state_.load(std::memory_order_acquire) != BOUND)
+    PlatformThread::YieldCurrentThread();
 }
 
 }  // namespace base
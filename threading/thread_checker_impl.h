@@ -5,10 +5,11 @@
 #ifndef BASE_THREADING_THREAD_CHECKER_IMPL_H_
 #define BASE_THREADING_THREAD_CHECKER_IMPL_H_
 
+#include <atomic>
+
 #include "base/base_export.h"
 #include "base/compiler_specific.h"
 #include "base/sequence_token.h"
-#include "base/synchronization/lock.h"
 #include "base/threading/platform_thread.h"
 
 namespace base {
@@ -32,12 +33,16 @@ class BASE_EXPORT ThreadCheckerImpl {
   void DetachFromThread();
 
  private:
+  // Binds the checker to the current thread, if it isn't bound yet.
   void EnsureAssigned() const;
 
-  // Members are mutable so that CalledOnValidThread() can set them.
+  // Binding states of the checker. The members below are written while
+  // BINDING, and only read once BOUND, until the next DetachFromThread(), so
+  // that checks are lock-free: a bound checker only loads |state_|.
+  enum State : int { UNBOUND, BINDING, BOUND };
+  mutable std::atomic<int> state_{UNBOUND};
 
-  // Synchronizes access to all members.
-  mutable base::Lock lock_;
+  // Members are mutable so that CalledOnValidThread() can set them.
 
   // Thread on which CalledOnValidThread() may return true.
   mutable PlatformThreadRef thread_id_;
@@ -4,6 +4,10 @@
 
 #include "base/threading/thread_local_storage.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "base/atomicops.h"
 #include "base/logging.h"
 #include "base/synchronization/lock.h"
@@ -30,8 +34,16 @@ using base::internal::PlatformThreadLocalStorage;
 //                         Your Data!
 //
 // Using a single OS TLS slot, Chrome TLS allocates an array on demand for the
-// lifetime of each thread that requests Chrome TLS data. Each per-thread TLS
-// array matches the length of the per-process global metadata array.
+// lifetime of each thread that requests Chrome TLS data. The per-thread TLS
+// array holds the first kThreadLocalStorageInlineSize slots inline, which is
+// enough for most processes. The slots past these are kept in an overflow
+// array, allocated and grown when one of them is set on the thread, so that
+// the number of slots is only limited by the per-process global metadata
+// array, which grows when all its slots are in use.
+//
+// Where the compiler supports initial-exec thread_local variables, the pointer
+// to the per-thread TLS array is mirrored in one, so that accessing a slot
+// doesn't go through the OS TLS API.
 //
 // A per-process global TLS metadata array tracks information about each item in
 // the per-thread array:
@@ -108,8 +120,9 @@ void* const kUninitialized = nullptr;
 // A sentinel value to indicate that the TLS system has been destroyed.
 void* const kDestroyed = reinterpret_cast<void*>(1);
 
-// The maximum number of slots in our thread local storage stack.
-constexpr int kThreadLocalStorageSize = 256;
+// The number of slots stored inline in the per-thread TLS array, and the
+// initial size of the metadata array.
+constexpr int kThreadLocalStorageInlineSize = 256;
 
 enum TlsStatus {
   FREE,
@@ -127,18 +140,96 @@ struct TlsVectorEntry {
   uint32_t version;
 };
 
+struct TlsVector {
+  TlsVectorEntry entries[kThreadLocalStorageInlineSize];
+
+  // The entries of the slots past the inline ones, |overflow_size| of them.
+  // Null until one of these slots is set on the thread.
+  TlsVectorEntry* overflow;
+  size_t overflow_size;
+};
+
 // This lock isn't needed until after we've constructed the per-thread TLS
 // vector, so it's safe to use.
 base::Lock* GetTLSMetadataLock() {
   static auto* lock = new base::Lock();
   return lock;
 }
-TlsMetadata g_tls_metadata[kThreadLocalStorageSize];
+
+// The metadata of the slots, |g_tls_metadata_size| of them. It starts as
+// |g_initial_tls_metadata| and doubles when all the slots are in use. Guarded
+// by GetTLSMetadataLock().
+TlsMetadata g_initial_tls_metadata[kThreadLocalStorageInlineSize];
+TlsMetadata* g_tls_metadata = g_initial_tls_metadata;
+size_t g_tls_metadata_size = kThreadLocalStorageInlineSize;
 size_t g_last_assigned_slot = 0;
 
 // The maximum number of times to try to clear slots by calling destructors.
 // Use pthread naming convention for clarity.
-constexpr int kMaxDestructorIterations = kThreadLocalStorageSize;
+constexpr int kMaxDestructorIterations = kThreadLocalStorageInlineSize;
+
+#if defined(OS_LINUX)
+// Mirror of the value of the OS TLS slot, see SetTlsVector(). The initial-exec
+// model makes it a fixed offset from the thread pointer.
+__attribute__((tls_model("initial-exec"))) thread_local TlsVector*
+    g_tls_vector = nullptr;
+#endif
+
+// Returns the per-thread TLS array, or one of the sentinels kUninitialized and
+// kDestroyed.
+TlsVector* GetTlsVector() {
+#if defined(OS_LINUX)
+  return g_tls_vector;
+#else
+  return static_cast<TlsVector*>(PlatformThreadLocalStorage::GetTLSValue(
+      base::subtle::NoBarrier_Load(&g_native_tls_key)));
+#endif
+}
+
+// Sets the value of the OS TLS slot |key| to |tls_vector|. All the changes go
+// through here so that the thread_local mirror stays in sync.
+void SetTlsVector(PlatformThreadLocalStorage::TLSKey key, void* tls_vector) {
+  PlatformThreadLocalStorage::SetTLSValue(key, tls_vector);
+#if defined(OS_LINUX)
+  g_tls_vector = static_cast<TlsVector*>(tls_vector);
+#endif
+}
+
+// Returns the entry of |slot| in |tls_data|, or null if it is past the end of
+// the overflow array.
+TlsVectorEntry* GetTlsVectorEntry(TlsVector* tls_data, int slot) {
+  if (slot < kThreadLocalStorageInlineSize)
+    return &tls_data->entries[slot];
+  size_t index = slot - kThreadLocalStorageInlineSize;
+  return index < tls_data->overflow_size ? &tls_data->overflow[index]
+                                         : nullptr;
+}
+
+// Grows the overflow array of |tls_data| to hold |slot|, and returns its entry.
+TlsVectorEntry* GrowTlsVector(TlsVector* tls_data, int slot) {
+  size_t index = slot - kThreadLocalStorageInlineSize;
+  size_t size = std::max<size_t>(tls_data->overflow_size,
+                                 kThreadLocalStorageInlineSize);
+  while (size <= index)
+    size *= 2;
+  // The allocator may itself use TLS, so the entries are only copied once it
+  // has returned.
+  TlsVectorEntry* overflow = new TlsVectorEntry[size]();
+  if (tls_data->overflow_size >= size) {
+    // A re-entrant call already grew the array.
+    delete[] overflow;
+    return &tls_data->overflow[index];
+  }
+  TlsVectorEntry* old_overflow = tls_data->overflow;
+  if (old_overflow) {
+    memcpy(overflow, old_overflow,
+           tls_data->overflow_size * sizeof(TlsVectorEntry));
+  }
+  tls_data->overflow = overflow;
+  tls_data->overflow_size = size;
+  delete[] old_overflow;
+  return &overflow[index];
+}
 
 // This function is called to initialize our entire Chromium TLS system.
 // It may be called very early, and we need to complete most all of the setup
@@ -146,7 +237,7 @@ constexpr int kMaxDestructorIterations = kThreadLocalStorageSize;
 // recursively depend on this initialization.
 // As a result, we use Atomics, and avoid anything (like a singleton) that might
 // require memory allocations.
-TlsVectorEntry* ConstructTlsVector() {
+TlsVector* ConstructTlsVector() {
   PlatformThreadLocalStorage::TLSKey key =
       base::subtle::NoBarrier_Load(&g_native_tls_key);
   if (key == PlatformThreadLocalStorage::TLS_KEY_OUT_OF_INDEXES) {
@@ -188,30 +279,83 @@ TlsVectorEntry* ConstructTlsVector() {
   // allocated vector, so that we don't have dependence on our allocator until
   // our service is in place. (i.e., don't even call new until after we're
   // setup)
-  TlsVectorEntry stack_allocated_tls_data[kThreadLocalStorageSize];
-  memset(stack_allocated_tls_data, 0, sizeof(stack_allocated_tls_data));
+  TlsVector stack_allocated_tls_data;
+  memset(&stack_allocated_tls_data, 0, sizeof(stack_allocated_tls_data));
   // Ensure that any rentrant calls change the temp version.
-  PlatformThreadLocalStorage::SetTLSValue(key, stack_allocated_tls_data);
+  SetTlsVector(key, &stack_allocated_tls_data);
 
   // Allocate an array to store our data.
-  TlsVectorEntry* tls_data = new TlsVectorEntry[kThreadLocalStorageSize];
-  memcpy(tls_data, stack_allocated_tls_data, sizeof(stack_allocated_tls_data));
-  PlatformThreadLocalStorage::SetTLSValue(key, tls_data);
+  TlsVector* tls_data = new TlsVector;
+  memcpy(tls_data, &stack_allocated_tls_data,
+         sizeof(stack_allocated_tls_data));
+  SetTlsVector(key, tls_data);
   return tls_data;
 }
 
-void OnThreadExitInternal(TlsVectorEntry* tls_data) {
+// Calls the destructors of the slots past the inline ones of |tls_data| until
+// none of them is set, then frees its overflow array.
+void DestroyTlsVectorOverflow(TlsVector* tls_data) {
+  if (!tls_data->overflow)
+    return;
+
+  std::vector<TlsMetadata> tls_metadata;
+  int remaining_attempts = kMaxDestructorIterations;
+  bool need_to_scan_destructors = true;
+  while (need_to_scan_destructors) {
+    need_to_scan_destructors = false;
+    // Destructors may initialize slots, and set them, so the metadata is
+    // snapshotted again at each pass.
+    {
+      base::AutoLock auto_lock(*GetTLSMetadataLock());
+      size_t end = std::min(
+          g_tls_metadata_size,
+          kThreadLocalStorageInlineSize + tls_data->overflow_size);
+      tls_metadata.assign(g_tls_metadata + kThreadLocalStorageInlineSize,
+                          g_tls_metadata + end);
+    }
+    for (size_t i = 0; i < tls_metadata.size(); ++i) {
+      // The overflow array may be reallocated by the destructors.
+      TlsVectorEntry* entry = &tls_data->overflow[i];
+      void* tls_value = entry->data;
+      if (!tls_value || tls_metadata[i].status == TlsStatus::FREE ||
+          entry->version != tls_metadata[i].version)
+        continue;
+
+      base::ThreadLocalStorage::TLSDestructorFunc destructor =
+          tls_metadata[i].destructor;
+      if (!destructor)
+        continue;
+      entry->data = nullptr;  // pre-clear the slot.
+      destructor(tls_value);
+      need_to_scan_destructors = true;
+    }
+    if (--remaining_attempts <= 0) {
+      NOTREACHED();  // Destructors might not have been called.
+      break;
+    }
+  }
+
+  delete[] tls_data->overflow;
+  tls_data->overflow = nullptr;
+  tls_data->overflow_size = 0;
+}
+
+void OnThreadExitInternal(TlsVector* tls_data) {
   // This branch is for POSIX, where this function is called twice. The first
   // pass calls dtors and sets state to kDestroyed. The second pass sets
   // kDestroyed to kUninitialized.
   if (tls_data == kDestroyed) {
     PlatformThreadLocalStorage::TLSKey key =
         base::subtle::NoBarrier_Load(&g_native_tls_key);
-    PlatformThreadLocalStorage::SetTLSValue(key, kUninitialized);
+    SetTlsVector(key, kUninitialized);
     return;
   }
 
   DCHECK(tls_data);
+  // The slots past the inline ones belong to services which were set up late,
+  // so they are destroyed first, while the allocator certainly still works.
+  DestroyTlsVectorOverflow(tls_data);
+
   // Some allocators, such as TCMalloc, use TLS. As a result, when a thread
   // terminates, one of the destructor calls we make may be to shut down an
   // allocator. We have to be careful that after we've shutdown all of the known
@@ -221,19 +365,20 @@ void OnThreadExitInternal(TlsVectorEntry* tls_data) {
   // allocated vector, so that we don't have dependence on our allocator after
   // we have called all g_tls_metadata destructors. (i.e., don't even call
   // delete[] after we're done with destructors.)
-  TlsVectorEntry stack_allocated_tls_data[kThreadLocalStorageSize];
-  memcpy(stack_allocated_tls_data, tls_data, sizeof(stack_allocated_tls_data));
+  TlsVector stack_allocated_tls_data;
+  memcpy(&stack_allocated_tls_data, tls_data,
+         sizeof(stack_allocated_tls_data));
   // Ensure that any re-entrant calls change the temp version.
   PlatformThreadLocalStorage::TLSKey key =
       base::subtle::NoBarrier_Load(&g_native_tls_key);
-  PlatformThreadLocalStorage::SetTLSValue(key, stack_allocated_tls_data);
-  delete[] tls_data;  // Our last dependence on an allocator.
+  SetTlsVector(key, &stack_allocated_tls_data);
+  delete tls_data;  // Our last dependence on an allocator.
 
   // Snapshot the TLS Metadata so we don't have to lock on every access.
-  TlsMetadata tls_metadata[kThreadLocalStorageSize];
+  TlsMetadata tls_metadata[kThreadLocalStorageInlineSize];
   {
     base::AutoLock auto_lock(*GetTLSMetadataLock());
-    memcpy(tls_metadata, g_tls_metadata, sizeof(g_tls_metadata));
+    memcpy(tls_metadata, g_tls_metadata, sizeof(tls_metadata));
   }
 
   int remaining_attempts = kMaxDestructorIterations;
@@ -246,23 +391,29 @@ void OnThreadExitInternal(TlsVectorEntry* tls_data) {
     // allocator) and should also be destroyed last. If we get the order wrong,
     // then we'll iterate several more times, so it is really not that critical
     // (but it might help).
-    for (int slot = 0; slot < kThreadLocalStorageSize ; ++slot) {
-      void* tls_value = stack_allocated_tls_data[slot].data;
+    for (int slot = 0; slot < kThreadLocalStorageInlineSize; ++slot) {
+      TlsVectorEntry* entry = &stack_allocated_tls_data.entries[slot];
+      void* tls_value = entry->data;
       if (!tls_value || tls_metadata[slot].status == TlsStatus::FREE ||
-          stack_allocated_tls_data[slot].version != tls_metadata[slot].version)
+          entry->version != tls_metadata[slot].version)
         continue;
 
       base::ThreadLocalStorage::TLSDestructorFunc destructor =
           tls_metadata[slot].destructor;
       if (!destructor)
         continue;
-      stack_allocated_tls_data[slot].data = nullptr;  // pre-clear the slot.
+      entry->data = nullptr;  // pre-clear the slot.
       destructor(tls_value);
       // Any destructor might have called a different service, which then set a
       // different slot to a non-null value. Hence we need to check the whole
       // vector again. This is a pthread standard.
       need_to_scan_destructors = true;
     }
+    // Setting a slot past the inline ones allocated a new overflow array.
+    if (stack_allocated_tls_data.overflow) {
+      DestroyTlsVectorOverflow(&stack_allocated_tls_data);
+      need_to_scan_destructors = true;
+    }
     if (--remaining_attempts <= 0) {
       NOTREACHED();  // Destructors might not have been called.
       break;
@@ -270,7 +421,7 @@ void OnThreadExitInternal(TlsVectorEntry* tls_data) {
   }
 
   // Remove our stack allocated vector.
-  PlatformThreadLocalStorage::SetTLSValue(key, kDestroyed);
+  SetTlsVector(key, kDestroyed);
 }
 
 }  // namespace
@@ -294,11 +445,11 @@ void PlatformThreadLocalStorage::OnThreadExit() {
   // Maybe we have never initialized TLS for this thread.
   if (tls_data == kUninitialized)
     return;
-  OnThreadExitInternal(static_cast<TlsVectorEntry*>(tls_data));
+  OnThreadExitInternal(static_cast<TlsVector*>(tls_data));
 }
 #elif defined(OS_POSIX)
 void PlatformThreadLocalStorage::OnThreadExit(void* value) {
-  OnThreadExitInternal(static_cast<TlsVectorEntry*>(value));
+  OnThreadExitInternal(static_cast<TlsVector*>(value));
 }
 #endif  // defined(OS_WIN)
 
@@ -320,37 +471,60 @@ void ThreadLocalStorage::Slot::Initialize(TLSDestructorFunc destructor) {
     ConstructTlsVector();
   }
 
-  // Grab a new slot.
+  // Grab a new slot. The metadata array which is replaced when growing it is
+  // freed once the lock is released.
+  std::unique_ptr<TlsMetadata[]> unused_tls_metadata;
   {
     base::AutoLock auto_lock(*GetTLSMetadataLock());
-    for (int i = 0; i < kThreadLocalStorageSize; ++i) {
-      // Tracking the last assigned slot is an attempt to find the next
-      // available slot within one iteration. Under normal usage, slots remain
-      // in use for the lifetime of the process (otherwise before we reclaimed
-      // slots, we would have run out of slots). This makes it highly likely the
-      // next slot is going to be a free slot.
-      size_t slot_candidate =
-          (g_last_assigned_slot + 1 + i) % kThreadLocalStorageSize;
-      if (g_tls_metadata[slot_candidate].status == TlsStatus::FREE) {
-        g_tls_metadata[slot_candidate].status = TlsStatus::IN_USE;
-        g_tls_metadata[slot_candidate].destructor = destructor;
-        g_last_assigned_slot = slot_candidate;
-        DCHECK_EQ(kInvalidSlotValue, slot_);
-        slot_ = slot_candidate;
-        version_ = g_tls_metadata[slot_candidate].version;
+    while (slot_ == kInvalidSlotValue) {
+      for (size_t i = 0; i < g_tls_metadata_size; ++i) {
+        // Tracking the last assigned slot is an attempt to find the next
+        // available slot within one iteration. Under normal usage, slots
+        // remain in use for the lifetime of the process (otherwise before we
+        // reclaimed slots, we would have run out of slots). This makes it
+        // highly likely the next slot is going to be a free slot.
+        size_t slot_candidate =
+            (g_last_assigned_slot + 1 + i) % g_tls_metadata_size;
+        if (g_tls_metadata[slot_candidate].status == TlsStatus::FREE) {
+          g_tls_metadata[slot_candidate].status = TlsStatus::IN_USE;
+          g_tls_metadata[slot_candidate].destructor = destructor;
+          g_last_assigned_slot = slot_candidate;
+          slot_ = slot_candidate;
+          version_ = g_tls_metadata[slot_candidate].version;
+          break;
+        }
+      }
+      if (slot_ != kInvalidSlotValue)
         break;
+
+      // All the slots are in use: double the metadata array. The allocator may
+      // use TLS, so it is called without the lock.
+      size_t size = g_tls_metadata_size;
+      TlsMetadata* tls_metadata;
+      {
+        base::AutoUnlock auto_unlock(*GetTLSMetadataLock());
+        tls_metadata = new TlsMetadata[size * 2]();
+      }
+      if (g_tls_metadata_size != size) {
+        // Another thread grew the array meanwhile.
+        unused_tls_metadata.reset(tls_metadata);
+        continue;
       }
+      memcpy(tls_metadata, g_tls_metadata, size * sizeof(TlsMetadata));
+      if (g_tls_metadata != g_initial_tls_metadata)
+        unused_tls_metadata.reset(g_tls_metadata);
+      g_tls_metadata = tls_metadata;
+      g_tls_metadata_size = size * 2;
     }
   }
   CHECK_NE(slot_, kInvalidSlotValue);
-  CHECK_LT(slot_, kThreadLocalStorageSize);
 }
 
 void ThreadLocalStorage::Slot::Free() {
   DCHECK_NE(slot_, kInvalidSlotValue);
-  DCHECK_LT(slot_, kThreadLocalStorageSize);
   {
     base::AutoLock auto_lock(*GetTLSMetadataLock());
+    DCHECK_LT(static_cast<size_t>(slot_), g_tls_metadata_size);
     g_tls_metadata[slot_].status = TlsStatus::FREE;
     g_tls_metadata[slot_].destructor = nullptr;
     ++(g_tls_metadata[slot_].version);
@@ -359,31 +533,29 @@ void ThreadLocalStorage::Slot::Free() {
 }
 
 void* ThreadLocalStorage::Slot::Get() const {
-  TlsVectorEntry* tls_data = static_cast<TlsVectorEntry*>(
-      PlatformThreadLocalStorage::GetTLSValue(
-          base::subtle::NoBarrier_Load(&g_native_tls_key)));
+  TlsVector* tls_data = GetTlsVector();
   DCHECK_NE(tls_data, kDestroyed);
   if (!tls_data)
     return nullptr;
   DCHECK_NE(slot_, kInvalidSlotValue);
-  DCHECK_LT(slot_, kThreadLocalStorageSize);
+  const TlsVectorEntry* entry = GetTlsVectorEntry(tls_data, slot_);
   // Version mismatches means this slot was previously freed.
-  if (tls_data[slot_].version != version_)
+  if (!entry || entry->version != version_)
     return nullptr;
-  return tls_data[slot_].data;
+  return entry->data;
 }
 
 void ThreadLocalStorage::Slot::Set(void* value) {
-  TlsVectorEntry* tls_data = static_cast<TlsVectorEntry*>(
-      PlatformThreadLocalStorage::GetTLSValue(
-          base::subtle::NoBarrier_Load(&g_native_tls_key)));
+  TlsVector* tls_data = GetTlsVector();
   DCHECK_NE(tls_data, kDestroyed);
   if (!tls_data)
     tls_data = ConstructTlsVector();
   DCHECK_NE(slot_, kInvalidSlotValue);
-  DCHECK_LT(slot_, kThreadLocalStorageSize);
-  tls_data[slot_].data = value;
-  tls_data[slot_].version = version_;
+  TlsVectorEntry* entry = GetTlsVectorEntry(tls_data, slot_);
+  if (!entry)
+    entry = GrowTlsVector(tls_data, slot_);
+  entry->data = value;
+  entry->version = version_;
 }
 
 ThreadLocalStorage::Slot::Slot(TLSDestructorFunc destructor) {
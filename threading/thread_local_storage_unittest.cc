@@ -9,6 +9,9 @@
 #include <process.h>
 #endif
 
+#include <memory>
+#include <vector>
+
 #include "base/macros.h"
 #include "base/no_destructor.h"
 #include "base/threading/simple_thread.h"
@@ -96,6 +99,33 @@ void ThreadLocalStorageCleanup(void *value) {
   TLSSlot().Set(value);
 }
 
+// Sets all the slots of a thread to distinct values, which their destructor
+// counts.
+class ManySlotsRunner : public DelegateSimpleThread::Delegate {
+ public:
+  explicit ManySlotsRunner(
+      const std::vector<std::unique_ptr<ThreadLocalStorage::Slot>>* slots)
+      : slots_(slots) {}
+  ~ManySlotsRunner() override = default;
+
+  void Run() override {
+    for (size_t i = 0; i < slots_->size(); ++i)
+      (*slots_)[i]->Set(&values_[i]);
+    for (size_t i = 0; i < slots_->size(); ++i)
+      EXPECT_EQ(&values_[i], (*slots_)[i]->Get());
+  }
+
+  static void Destroy(void* value) { ++*static_cast<int*>(value); }
+
+  int value(size_t i) const { return values_[i]; }
+
+ private:
+  const std::vector<std::unique_ptr<ThreadLocalStorage::Slot>>* const slots_;
+  int values_[1000] = {};
+
+  DISALLOW_COPY_AND_ASSIGN(ManySlotsRunner);
+};
+
 #if defined(OS_POSIX)
 constexpr intptr_t kDummyValue = 0xABCD;
 constexpr size_t kKeyCount = 20;
@@ -257,6 +287,30 @@ TEST(ThreadLocalStorageTest, TLSReclaim) {
   }
 }
 
+TEST(ThreadLocalStorageTest, ManySlots) {
+  // More slots than are stored inline in the per-thread vectors.
+  const size_t kNumSlots = 1000;
+  std::vector<std::unique_ptr<ThreadLocalStorage::Slot>> slots;
+  for (size_t i = 0; i < kNumSlots; ++i) {
+    slots.push_back(
+        std::make_unique<ThreadLocalStorage::Slot>(&ManySlotsRunner::Destroy));
+  }
+
+  ManySlotsRunner runner(&slots);
+  DelegateSimpleThread thread(&runner, "tls thread");
+  thread.Start();
+  thread.Join();
+  for (size_t i = 0; i < kNumSlots; ++i)
+    EXPECT_EQ(1, runner.value(i));
+
+  // The slots weren't set on this thread.
+  for (size_t i = 0; i < kNumSlots; ++i)
+    EXPECT_EQ(nullptr, slots[i]->Get());
+  slots.back()->Set(reinterpret_cast<void*>(0xBAADF00D));
+  EXPECT_EQ(reinterpret_cast<void*>(0xBAADF00D), slots.back()->Get());
+  slots.back()->Set(nullptr);
+}
+
 #if defined(OS_POSIX)
 // Unlike POSIX, Windows does not iterate through the OS TLS to cleanup any
 // values there. Instead a per-module thread destruction function is called.
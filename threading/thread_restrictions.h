@@ -142,6 +142,7 @@ namespace internal {
 class TaskTracker;
 }
 
+class AtExitManager;
 class GetAppOutputScopedAllowBaseSyncPrimitives;
 class SimpleThread;
 class StackSamplingProfiler;
@@ -222,6 +223,7 @@ class BASE_EXPORT ScopedAllowBlocking {
   friend class mojo::CoreLibraryInitializer;
   friend class resource_coordinator::TabManagerDelegate;  // crbug.com/778703
   friend class ui::MaterialDesignController;
+  friend class AtExitManager;  // Runs flush tasks in FastExit().
   friend class ScopedAllowBlockingForTesting;
   friend class StackSamplingProfiler;
 
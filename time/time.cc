@@ -27,9 +27,15 @@ TimeNowFunction g_time_now_function = &subtle::TimeNowIgnoringOverride;
 TimeNowFunction g_time_now_from_system_time_function =
     &subtle::TimeNowFromSystemTimeIgnoringOverride;
 
+TimeNowFunction g_time_now_coarse_function =
+    &subtle::TimeNowCoarseIgnoringOverride;
+
 TimeTicksNowFunction g_time_ticks_now_function =
     &subtle::TimeTicksNowIgnoringOverride;
 
+TimeTicksNowFunction g_time_ticks_now_coarse_function =
+    &subtle::TimeTicksNowCoarseIgnoringOverride;
+
 ThreadTicksNowFunction g_thread_ticks_now_function =
     &subtle::ThreadTicksNowIgnoringOverride;
 
@@ -161,6 +167,11 @@ Time Time::NowFromSystemTime() {
   return internal::g_time_now_from_system_time_function();
 }
 
+// static
+Time Time::NowCoarse() {
+  return internal::g_time_now_coarse_function();
+}
+
 // static
 Time Time::FromDeltaSinceWindowsEpoch(TimeDelta delta) {
   return Time(delta.InMicroseconds());
@@ -332,6 +343,11 @@ TimeTicks TimeTicks::Now() {
   return internal::g_time_ticks_now_function();
 }
 
+// static
+TimeTicks TimeTicks::NowCoarse() {
+  return internal::g_time_ticks_now_coarse_function();
+}
+
 // static
 TimeTicks TimeTicks::UnixEpoch() {
   static const base::NoDestructor<base::TimeTicks> epoch([]() {
@@ -528,6 +528,12 @@ class BASE_EXPORT Time : public time_internal::TimeBase<Time> {
   // For timing sensitive unittests, this function should be used.
   static Time NowFromSystemTime();
 
+  // Returns the current time, like Now(), but possibly from a cheaper clock of
+  // a resolution of a few milliseconds, which may lag behind Now() by as much.
+  // Use it for timestamps read very often and compared at a coarse scale,
+  // e.g. expiry times.
+  static Time NowCoarse();
+
   // Converts to/from TimeDeltas relative to the Windows epoch (1601-01-01
   // 00:00:00 UTC). Prefer these methods for opaque serialization and
   // deserialization of time values, e.g.
@@ -826,6 +832,13 @@ class BASE_EXPORT TimeTicks : public time_internal::TimeBase<TimeTicks> {
   // microsecond.
   static TimeTicks Now();
 
+  // Returns the current tick count, like Now() and with the same origin, but
+  // possibly from a cheaper clock of a resolution of a few milliseconds, which
+  // may lag behind Now() by as much. The values returned are still monotonic.
+  // Use it for timestamps read very often and compared at a coarse scale,
+  // e.g. timeouts or cache expiry.
+  static TimeTicks NowCoarse();
+
   // Returns true if the high resolution clock is working on this system and
   // Now() will return high resolution values. Note that, on systems where the
   // high resolution clock works but is deemed inefficient, the low resolution
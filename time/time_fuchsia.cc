@@ -40,6 +40,11 @@ Time TimeNowFromSystemTimeIgnoringOverride() {
   // Just use TimeNowIgnoringOverride() because it returns the system time.
   return TimeNowIgnoringOverride();
 }
+
+Time TimeNowCoarseIgnoringOverride() {
+  // There is no cheaper clock to use.
+  return TimeNowIgnoringOverride();
+}
 }  // namespace subtle
 
 // TimeTicks ------------------------------------------------------------------
@@ -51,6 +56,11 @@ TimeTicks TimeTicksNowIgnoringOverride() {
   return TimeTicks() +
          TimeDelta::FromMicroseconds(ZxTimeToMicroseconds(nanos_since_boot));
 }
+
+TimeTicks TimeTicksNowCoarseIgnoringOverride() {
+  // There is no cheaper clock with the same origin.
+  return TimeTicksNowIgnoringOverride();
+}
 }  // namespace subtle
 
 // static
@@ -146,6 +146,11 @@ Time TimeNowFromSystemTimeIgnoringOverride() {
   // Just use TimeNowIgnoringOverride() because it returns the system time.
   return TimeNowIgnoringOverride();
 }
+
+Time TimeNowCoarseIgnoringOverride() {
+  // There is no cheaper clock to use.
+  return TimeNowIgnoringOverride();
+}
 }  // namespace subtle
 
 // static
@@ -275,6 +280,11 @@ namespace subtle {
 TimeTicks TimeTicksNowIgnoringOverride() {
   return TimeTicks() + TimeDelta::FromMicroseconds(ComputeCurrentTicks());
 }
+
+TimeTicks TimeTicksNowCoarseIgnoringOverride() {
+  // There is no cheaper clock with the same origin.
+  return TimeTicksNowIgnoringOverride();
+}
 }  // namespace subtle
 
 // static
@@ -80,6 +80,18 @@ Time TimeNowFromSystemTimeIgnoringOverride() {
   // Just use TimeNowIgnoringOverride() because it returns the system time.
   return TimeNowIgnoringOverride();
 }
+
+Time TimeNowCoarseIgnoringOverride() {
+#if defined(CLOCK_REALTIME_COARSE)
+  // The coarse clocks return the time of the last timer tick, read from the
+  // vDSO without a syscall nor a hardware counter read.
+  return Time() +
+         TimeDelta::FromMicroseconds(ClockNow(CLOCK_REALTIME_COARSE) +
+                                     Time::kTimeTToMicrosecondsOffset);
+#else
+  return TimeNowIgnoringOverride();
+#endif
+}
 }  // namespace subtle
 
 // TimeTicks ------------------------------------------------------------------
@@ -88,6 +100,15 @@ namespace subtle {
 TimeTicks TimeTicksNowIgnoringOverride() {
   return TimeTicks() + TimeDelta::FromMicroseconds(ClockNow(CLOCK_MONOTONIC));
 }
+
+TimeTicks TimeTicksNowCoarseIgnoringOverride() {
+#if defined(CLOCK_MONOTONIC_COARSE)
+  return TimeTicks() +
+         TimeDelta::FromMicroseconds(ClockNow(CLOCK_MONOTONIC_COARSE));
+#else
+  return TimeTicksNowIgnoringOverride();
+#endif
+}
 }  // namespace subtle
 
 // static
@@ -19,7 +19,8 @@ using ThreadTicksNowFunction = decltype(&ThreadTicks::Now);
 namespace subtle {
 
 // Override the return value of Time::Now and Time::NowFromSystemTime /
-// TimeTicks::Now / ThreadTicks::Now to emulate time, e.g. for tests or to
+// TimeTicks::Now / ThreadTicks::Now, as well as of the NowCoarse() variants of
+// the first two, to emulate time, e.g. for tests or to
 // modify progression of time. Note that the override should be set while
 // single-threaded and before the first call to Now() to avoid threading issues
 // and inconsistencies in returned values. Nested overrides are not allowed.
@@ -48,7 +49,9 @@ class BASE_EXPORT ScopedTimeClockOverrides {
 // override time.
 BASE_EXPORT Time TimeNowIgnoringOverride();
 BASE_EXPORT Time TimeNowFromSystemTimeIgnoringOverride();
+BASE_EXPORT Time TimeNowCoarseIgnoringOverride();
 BASE_EXPORT TimeTicks TimeTicksNowIgnoringOverride();
+BASE_EXPORT TimeTicks TimeTicksNowCoarseIgnoringOverride();
 BASE_EXPORT ThreadTicks ThreadTicksNowIgnoringOverride();
 
 }  // namespace subtle
@@ -64,7 +67,9 @@ namespace internal {
 // functions by ScopedTimeClockOverrides.
 extern TimeNowFunction g_time_now_function;
 extern TimeNowFunction g_time_now_from_system_time_function;
+extern TimeNowFunction g_time_now_coarse_function;
 extern TimeTicksNowFunction g_time_ticks_now_function;
+extern TimeTicksNowFunction g_time_ticks_now_coarse_function;
 extern ThreadTicksNowFunction g_thread_ticks_now_function;
 
 }  // namespace internal
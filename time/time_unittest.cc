@@ -15,6 +15,7 @@
 #include "base/macros.h"
 #include "base/strings/stringprintf.h"
 #include "base/threading/platform_thread.h"
+#include "base/time/coarse_tick_clock.h"
 #include "base/time/time_override.h"
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -933,6 +934,33 @@ TEST(TimeTicks, NowOverride) {
   EXPECT_GT(TimeTicks::Max(), subtle::TimeTicksNowIgnoringOverride());
 }
 
+TEST(TimeTicks, NowCoarse) {
+  // The coarse clock has the same origin as Now(), lagging by no more than a
+  // few milliseconds.
+  const TimeDelta kMaxLag = TimeDelta::FromMilliseconds(100);
+  TimeTicks before = TimeTicks::Now();
+  TimeTicks coarse = TimeTicks::NowCoarse();
+  TimeTicks after = TimeTicks::Now();
+  EXPECT_LE(coarse, after);
+  EXPECT_GE(coarse, before - kMaxLag);
+  EXPECT_LE(coarse, TimeTicks::NowCoarse());
+  EXPECT_LE(CoarseTickClock::GetInstance()->NowTicks(), TimeTicks::Now());
+
+  Time time_before = Time::Now();
+  Time time_coarse = Time::NowCoarse();
+  EXPECT_LE(time_coarse, Time::Now());
+  EXPECT_GE(time_coarse, time_before - kMaxLag);
+
+  // The coarse clocks follow the overrides.
+  TimeTicksOverride::now_ticks_ = TimeTicks::Min();
+  subtle::ScopedTimeClockOverrides overrides(nullptr, &TimeTicksOverride::Now,
+                                             nullptr);
+  EXPECT_EQ(TimeTicks::Min() + TimeDelta::FromSeconds(1),
+            TimeTicks::NowCoarse());
+  EXPECT_EQ(TimeTicks::Min() + TimeDelta::FromSeconds(2),
+            CoarseTickClock::GetInstance()->NowTicks());
+}
+
 class ThreadTicksOverride {
  public:
   static ThreadTicks Now() {
@@ -164,6 +164,11 @@ Time TimeNowFromSystemTimeIgnoringOverride() {
   InitializeClock();
   return Time() + TimeDelta::FromMicroseconds(g_initial_time);
 }
+
+Time TimeNowCoarseIgnoringOverride() {
+  // TimeNowIgnoringOverride() already derives the time from the tick count.
+  return TimeNowIgnoringOverride();
+}
 }  // namespace subtle
 
 // static
@@ -582,6 +587,11 @@ namespace subtle {
 TimeTicks TimeTicksNowIgnoringOverride() {
   return g_time_ticks_now_ignoring_override_function();
 }
+
+TimeTicks TimeTicksNowCoarseIgnoringOverride() {
+  // There is no cheaper clock with the same origin.
+  return TimeTicksNowIgnoringOverride();
+}
 }  // namespace subtle
 
 // static
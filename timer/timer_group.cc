@@ -0,0 +1,171 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/timer/timer_group.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "base/time/tick_clock.h"
+
+namespace base {
+
+TimerGroup::TimerGroup(TimeDelta slack, const TickClock* tick_clock)
+    : slack_(slack),
+      tick_clock_(tick_clock),
+      scheduled_run_time_(TimeTicks::Max()),
+      weak_factory_(this) {
+  DCHECK_GE(slack_, TimeDelta());
+  // The group may be created on a different sequence than the one it is used
+  // on.
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+TimerGroup::~TimerGroup() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(buckets_.empty());
+  DCHECK(ready_timers_.empty());
+}
+
+void TimerGroup::SetTaskRunner(scoped_refptr<SequencedTaskRunner> task_runner) {
+  DCHECK(buckets_.empty());
+  DCHECK_EQ(TimeTicks::Max(), scheduled_run_time_);
+  task_runner_ = std::move(task_runner);
+}
+
+TimeTicks TimerGroup::Now() const {
+  return tick_clock_ ? tick_clock_->NowTicks() : TimeTicks::Now();
+}
+
+void TimerGroup::AddTimer(GroupedTimer* timer) {
+  DCHECK(!timer->next());
+  TimeTicks bucket_time = GetBucketTime(timer->desired_run_time_);
+  buckets_[bucket_time].Append(timer);
+  timer->bucket_time_ = bucket_time;
+  ScheduleTask();
+}
+
+void TimerGroup::RemoveTimer(GroupedTimer* timer) {
+  DCHECK(timer->next());
+  timer->RemoveFromList();
+  if (timer->bucket_time_) {
+    auto it = buckets_.find(*timer->bucket_time_);
+    DCHECK(it != buckets_.end());
+    if (it->second.empty())
+      buckets_.erase(it);
+    timer->bucket_time_.reset();
+  }
+}
+
+TimeTicks TimerGroup::GetBucketTime(TimeTicks desired_run_time) const {
+  if (slack_.is_zero())
+    return desired_run_time;
+  TimeDelta remainder = (desired_run_time - TimeTicks()) % slack_;
+  if (remainder.is_zero())
+    return desired_run_time;
+  return desired_run_time - remainder + slack_;
+}
+
+void TimerGroup::ScheduleTask() {
+  if (buckets_.empty())
+    return;
+  TimeTicks run_time = buckets_.begin()->first;
+  // A task already posted for an earlier time will schedule the next one.
+  if (run_time >= scheduled_run_time_)
+    return;
+
+  if (!task_runner_)
+    task_runner_ = SequencedTaskRunnerHandle::Get();
+  scheduled_run_time_ = run_time;
+  // The task is attributed to the first timer of its bucket.
+  task_runner_->PostDelayedTask(
+      buckets_.begin()->second.head()->value()->posted_from_,
+      BindOnce(&TimerGroup::OnScheduledTask, weak_factory_.GetWeakPtr(),
+               run_time),
+      std::max(run_time - Now(), TimeDelta()));
+}
+
+void TimerGroup::OnScheduledTask(TimeTicks run_time) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (run_time != scheduled_run_time_)
+    return;
+
+  // Move the timers of the buckets due to |ready_timers_|, or to their new
+  // bucket if they were reset to a later deadline. This doesn't schedule a
+  // task, since all the buckets are at or after |scheduled_run_time_|.
+  TimeTicks now = Now();
+  while (!buckets_.empty() && buckets_.begin()->first <= now) {
+    Bucket& bucket = buckets_.begin()->second;
+    while (!bucket.empty()) {
+      GroupedTimer* timer = bucket.head()->value();
+      timer->RemoveFromList();
+      timer->bucket_time_.reset();
+      if (timer->desired_run_time_ > now)
+        AddTimer(timer);
+      else
+        ready_timers_.Append(timer);
+    }
+    buckets_.erase(buckets_.begin());
+  }
+
+  // The tasks may start timers, which then post a task for them.
+  scheduled_run_time_ = TimeTicks::Max();
+  WeakPtr<TimerGroup> group = weak_factory_.GetWeakPtr();
+  while (!ready_timers_.empty()) {
+    GroupedTimer* timer = ready_timers_.head()->value();
+    timer->RemoveFromList();
+    // Copy the task, since it may delete the timer.
+    RepeatingClosure task = timer->user_task_;
+    task.Run();
+    if (!group)
+      return;
+  }
+  ScheduleTask();
+}
+
+GroupedTimer::GroupedTimer(TimerGroup* group) : group_(group) {
+  DCHECK(group_);
+}
+
+GroupedTimer::~GroupedTimer() {
+  Stop();
+}
+
+void GroupedTimer::Start(const Location& posted_from,
+                         TimeDelta delay,
+                         RepeatingClosure user_task) {
+  posted_from_ = posted_from;
+  delay_ = delay;
+  user_task_ = std::move(user_task);
+  Reset();
+}
+
+void GroupedTimer::Stop() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(group_->sequence_checker_);
+  if (IsRunning())
+    group_->RemoveTimer(this);
+}
+
+void GroupedTimer::Reset() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(group_->sequence_checker_);
+  DCHECK(!user_task_.is_null());
+  desired_run_time_ = group_->Now() + delay_;
+
+  // A timer whose bucket is due no later than the new deadline stays there,
+  // and is moved when its bucket is reached.
+  if (bucket_time_ && group_->GetBucketTime(desired_run_time_) >= *bucket_time_)
+    return;
+
+  if (IsRunning())
+    group_->RemoveTimer(this);
+  group_->AddTimer(this);
+}
+
+bool GroupedTimer::IsRunning() const {
+  return next() != nullptr;
+}
+
+}  // namespace base
@@ -0,0 +1,179 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// TimerGroup multiplexes many one-shot GroupedTimers onto a single delayed
+// task, for the code which keeps a very large number of timers that are mostly
+// reset before they fire, e.g. connection idle timeouts:
+//
+//   class Server {
+//    public:
+//     Server() : timer_group_(TimeDelta::FromSeconds(1)) {}
+//     ...
+//    private:
+//     TimerGroup timer_group_;
+//     std::vector<std::unique_ptr<Connection>> connections_;
+//   };
+//
+//   class Connection {
+//    public:
+//     explicit Connection(TimerGroup* timer_group)
+//         : idle_timer_(timer_group) {
+//       idle_timer_.Start(FROM_HERE, TimeDelta::FromMinutes(5), this,
+//                         &Connection::OnIdle);
+//     }
+//     void OnDataReceived() { idle_timer_.Reset(); }
+//     ...
+//    private:
+//     GroupedTimer idle_timer_;
+//   };
+//
+// The deadlines of the timers are rounded up to a multiple of the |slack| of
+// their group, so that all the timers due within the same |slack| interval
+// fire together from one task. A timer may thus fire up to |slack| late, but
+// never early.
+//
+// Resetting a timer to a later deadline is O(1): the timer stays where it is
+// and is only moved to its new deadline when its old one is reached. Starting
+// or resetting it to an earlier deadline costs O(log n) in the number of
+// distinct deadlines, and only posts a new task when it becomes the earliest
+// one of the group.
+//
+// Unlike OneShotTimer, these classes must be used on a single sequence, and the
+// TimerGroup must outlive its GroupedTimers.
+
+#ifndef BASE_TIMER_TIMER_GROUP_H_
+#define BASE_TIMER_TIMER_GROUP_H_
+
+#include <map>
+
+#include "base/base_export.h"
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/containers/linked_list.h"
+#include "base/location.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/optional.h"
+#include "base/sequence_checker.h"
+#include "base/sequenced_task_runner.h"
+#include "base/time/time.h"
+
+namespace base {
+
+class GroupedTimer;
+class TickClock;
+
+class BASE_EXPORT TimerGroup {
+ public:
+  // The timers fire up to |slack| after their deadline, which may be zero to
+  // fire each deadline on its own. If |tick_clock| is provided, it is used
+  // instead of TimeTicks::Now() to compute the deadlines.
+  explicit TimerGroup(TimeDelta slack, const TickClock* tick_clock = nullptr);
+  ~TimerGroup();
+
+  // Sets the task runner on which the timers fire, which defaults to the one
+  // of the sequence on which the first timer is started. It can only be called
+  // before any timer is started.
+  void SetTaskRunner(scoped_refptr<SequencedTaskRunner> task_runner);
+
+  TimeDelta slack() const { return slack_; }
+
+ private:
+  friend class GroupedTimer;
+
+  using Bucket = LinkedList<GroupedTimer>;
+
+  // Returns the current tick count.
+  TimeTicks Now() const;
+
+  // Adds |timer| to the bucket of its |desired_run_time_|, and makes sure that
+  // a task is posted for it.
+  void AddTimer(GroupedTimer* timer);
+
+  // Removes |timer| from its bucket, or from |ready_timers_|.
+  void RemoveTimer(GroupedTimer* timer);
+
+  // Returns the time at which the timers of |desired_run_time| fire.
+  TimeTicks GetBucketTime(TimeTicks desired_run_time) const;
+
+  // Posts a task for the earliest bucket if none is posted for it or earlier.
+  void ScheduleTask();
+
+  // Fires the timers due, unless the task was superseded by an earlier one.
+  void OnScheduledTask(TimeTicks run_time);
+
+  const TimeDelta slack_;
+  const TickClock* const tick_clock_;
+  scoped_refptr<SequencedTaskRunner> task_runner_;
+
+  // The timers which will fire, by the time at which they will. Timers reset
+  // to a later deadline stay in their previous bucket until it's due.
+  std::map<TimeTicks, Bucket> buckets_;
+
+  // The timers which are due and being fired by OnScheduledTask().
+  Bucket ready_timers_;
+
+  // The run time of the earliest task posted, or TimeTicks::Max() if there is
+  // none. Tasks of a later run time are superseded and ignored.
+  TimeTicks scheduled_run_time_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  WeakPtrFactory<TimerGroup> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimerGroup);
+};
+
+// A one-shot timer of a TimerGroup. The task is retained after the timer fires,
+// so it can be restarted with Reset().
+class BASE_EXPORT GroupedTimer : public LinkNode<GroupedTimer> {
+ public:
+  explicit GroupedTimer(TimerGroup* group);
+  ~GroupedTimer();
+
+  // Starts the timer to run |user_task| at the given |delay| from now. If the
+  // timer is already running, it will be replaced to call |user_task|.
+  void Start(const Location& posted_from,
+             TimeDelta delay,
+             RepeatingClosure user_task);
+
+  template <class Receiver>
+  void Start(const Location& posted_from,
+             TimeDelta delay,
+             Receiver* receiver,
+             void (Receiver::*method)()) {
+    Start(posted_from, delay, BindRepeating(method, Unretained(receiver)));
+  }
+
+  // Stops the timer. It is a no-op if the timer is not running.
+  void Stop();
+
+  // Restarts the timer with the delay it was last started with. The task must
+  // have been set by Start().
+  void Reset();
+
+  bool IsRunning() const;
+
+  TimeTicks desired_run_time() const { return desired_run_time_; }
+
+ private:
+  friend class TimerGroup;
+
+  TimerGroup* const group_;
+
+  Location posted_from_;
+  TimeDelta delay_;
+  RepeatingClosure user_task_;
+
+  TimeTicks desired_run_time_;
+
+  // The bucket of |group_| which holds the timer, if any.
+  Optional<TimeTicks> bucket_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(GroupedTimer);
+};
+
+}  // namespace base
+
+#endif  // BASE_TIMER_TIMER_GROUP_H_
@@ -0,0 +1,158 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/timer/timer_group.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/test/test_mock_time_task_runner.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+void Increment(int* count) {
+  ++*count;
+}
+
+class TimerGroupTest : public testing::Test {
+ protected:
+  TimerGroupTest()
+      : task_runner_(new TestMockTimeTaskRunner(Time::UnixEpoch(),
+                                                TimeTicks())) {}
+
+  std::unique_ptr<TimerGroup> CreateTimerGroup(TimeDelta slack) {
+    auto group =
+        std::make_unique<TimerGroup>(slack, task_runner_->GetMockTickClock());
+    group->SetTaskRunner(task_runner_);
+    return group;
+  }
+
+  scoped_refptr<TestMockTimeTaskRunner> task_runner_;
+};
+
+}  // namespace
+
+TEST_F(TimerGroupTest, OneTaskForManyTimers) {
+  std::unique_ptr<TimerGroup> group = CreateTimerGroup(TimeDelta());
+  int count = 0;
+  std::vector<std::unique_ptr<GroupedTimer>> timers;
+  for (int i = 0; i < 1000; ++i) {
+    timers.push_back(std::make_unique<GroupedTimer>(group.get()));
+    timers.back()->Start(FROM_HERE, TimeDelta::FromMilliseconds(i + 1),
+                         BindRepeating(&Increment, &count));
+  }
+  // Neither the timers due after the first one nor resetting them to later
+  // deadlines post a task.
+  EXPECT_EQ(1u, task_runner_->GetPendingTaskCount());
+  for (auto& timer : timers)
+    timer->Reset();
+  EXPECT_EQ(1u, task_runner_->GetPendingTaskCount());
+  EXPECT_EQ(TimeDelta::FromMilliseconds(1),
+            task_runner_->NextPendingTaskDelay());
+
+  task_runner_->FastForwardBy(TimeDelta::FromMilliseconds(500));
+  EXPECT_EQ(500, count);
+  task_runner_->FastForwardBy(TimeDelta::FromMilliseconds(500));
+  EXPECT_EQ(1000, count);
+  for (auto& timer : timers)
+    EXPECT_FALSE(timer->IsRunning());
+  EXPECT_FALSE(task_runner_->HasPendingTask());
+}
+
+TEST_F(TimerGroupTest, ResetToLaterDeadline) {
+  std::unique_ptr<TimerGroup> group = CreateTimerGroup(TimeDelta());
+  int count = 0;
+  GroupedTimer timer(group.get());
+  timer.Start(FROM_HERE, TimeDelta::FromMilliseconds(10),
+              BindRepeating(&Increment, &count));
+  task_runner_->FastForwardBy(TimeDelta::FromMilliseconds(5));
+  timer.Reset();
+  EXPECT_EQ(1u, task_runner_->GetPendingTaskCount());
+
+  // The timer is moved to its new deadline when the old one is reached.
+  task_runner_->FastForwardBy(TimeDelta::FromMilliseconds(9));
+  EXPECT_EQ(0, count);
+  EXPECT_TRUE(timer.IsRunning());
+  task_runner_->FastForwardBy(TimeDelta::FromMilliseconds(1));
+  EXPECT_EQ(1, count);
+  EXPECT_FALSE(timer.IsRunning());
+
+  // The task is retained.
+  timer.Reset();
+  task_runner_->FastForwardBy(TimeDelta::FromMilliseconds(10));
+  EXPECT_EQ(2, count);
+}
+
+TEST_F(TimerGroupTest, Slack) {
+  std::unique_ptr<TimerGroup> group =
+      CreateTimerGroup(TimeDelta::FromMilliseconds(10));
+  int counts[4] = {};
+  const int kDelaysMs[4] = {1, 5, 10, 12};
+  std::vector<std::unique_ptr<GroupedTimer>> timers;
+  for (int i = 0; i < 4; ++i) {
+    timers.push_back(std::make_unique<GroupedTimer>(group.get()));
+    timers.back()->Start(FROM_HERE, TimeDelta::FromMilliseconds(kDelaysMs[i]),
+                         BindRepeating(&Increment, &counts[i]));
+  }
+  EXPECT_EQ(1u, task_runner_->GetPendingTaskCount());
+
+  // The timers due within the same 10ms fire together, never early.
+  task_runner_->FastForwardBy(TimeDelta::FromMilliseconds(9));
+  EXPECT_EQ(0, counts[0]);
+  task_runner_->FastForwardBy(TimeDelta::FromMilliseconds(1));
+  EXPECT_EQ(1, counts[0]);
+  EXPECT_EQ(1, counts[1]);
+  EXPECT_EQ(1, counts[2]);
+  EXPECT_EQ(0, counts[3]);
+  task_runner_->FastForwardBy(TimeDelta::FromMilliseconds(10));
+  EXPECT_EQ(1, counts[3]);
+}
+
+TEST_F(TimerGroupTest, StopAndDeleteFromTask) {
+  std::unique_ptr<TimerGroup> group = CreateTimerGroup(TimeDelta());
+  int count = 0;
+  auto stopped_timer = std::make_unique<GroupedTimer>(group.get());
+  auto deleted_timer = std::make_unique<GroupedTimer>(group.get());
+  GroupedTimer timer(group.get());
+  timer.Start(FROM_HERE, TimeDelta::FromMilliseconds(10),
+              BindRepeating(
+                  [](std::unique_ptr<GroupedTimer>* deleted_timer) {
+                    deleted_timer->reset();
+                  },
+                  &deleted_timer));
+  stopped_timer->Start(FROM_HERE, TimeDelta::FromMilliseconds(10),
+                       BindRepeating(&Increment, &count));
+  deleted_timer->Start(FROM_HERE, TimeDelta::FromMilliseconds(10),
+                       BindRepeating(&Increment, &count));
+  stopped_timer->Stop();
+  EXPECT_FALSE(stopped_timer->IsRunning());
+
+  task_runner_->FastForwardBy(TimeDelta::FromMilliseconds(10));
+  EXPECT_FALSE(deleted_timer);
+  EXPECT_EQ(0, count);
+  EXPECT_FALSE(task_runner_->HasPendingTask());
+}
+
+TEST_F(TimerGroupTest, StartFromTask) {
+  std::unique_ptr<TimerGroup> group = CreateTimerGroup(TimeDelta());
+  int count = 0;
+  GroupedTimer timer(group.get());
+  GroupedTimer restarted_timer(group.get());
+  restarted_timer.Start(FROM_HERE, TimeDelta::FromMilliseconds(5),
+                        BindRepeating(&Increment, &count));
+  timer.Start(FROM_HERE, TimeDelta::FromMilliseconds(10),
+              BindRepeating(&GroupedTimer::Reset,
+                            Unretained(&restarted_timer)));
+  task_runner_->FastForwardBy(TimeDelta::FromMilliseconds(10));
+  EXPECT_EQ(1, count);
+  EXPECT_TRUE(restarted_timer.IsRunning());
+  task_runner_->FastForwardBy(TimeDelta::FromMilliseconds(5));
+  EXPECT_EQ(2, count);
+}
+
+}  // namespace base
@@ -27,10 +27,10 @@ static_assert(std::is_pod<TraceCategory>::value, "TraceCategory must be POD");
 
 // These entries must be kept consistent with the kCategory* consts below.
 TraceCategory g_categories[kMaxCategories] = {
-    {0, 0, "tracing categories exhausted; must increase kMaxCategories"},
-    {0, 0, "tracing already shutdown"},  // See kCategoryAlreadyShutdown below.
-    {0, 0, "__metadata"},                // See kCategoryMetadata below.
-    {0, 0, "toplevel"},                  // Warmup the toplevel category.
+    {0, 0, 0, "tracing categories exhausted; must increase kMaxCategories"},
+    {0, 0, 0, "tracing already shutdown"},  // See kCategoryAlreadyShutdown.
+    {0, 0, 0, "__metadata"},                // See kCategoryMetadata below.
+    {0, 0, 0, "toplevel"},                  // Warmup the toplevel category.
 };
 
 base::subtle::AtomicWord g_category_index = kNumBuiltinCategories;
@@ -0,0 +1,82 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/category_sampler.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread_local.h"
+
+namespace base {
+namespace trace_event {
+
+namespace {
+
+constexpr uint64_t kKeepAllThreshold = uint64_t{1} << 32;
+
+// Returns the next number of a xorshift generator whose state is kept per
+// thread, so that threads don't contend on it.
+uint32_t NextRandomNumber() {
+  static auto* random_state = new ThreadLocalPointer<void>();
+  uint32_t state =
+      static_cast<uint32_t>(reinterpret_cast<uintptr_t>(random_state->Get()));
+  if (!state) {
+    // The state must not be 0. Seeding from the thread id is enough, the
+    // numbers only need to be spread evenly.
+    state = static_cast<uint32_t>(PlatformThread::CurrentId()) * 2654435761u;
+    state |= 1;
+  }
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  random_state->Set(reinterpret_cast<void*>(static_cast<uintptr_t>(state)));
+  return state;
+}
+
+}  // namespace
+
+CategorySampler::CategorySampler(double sampling_rate,
+                                 uint32_t max_events_per_second)
+    : sampling_threshold_(static_cast<uint64_t>(
+          std::min(std::max(sampling_rate, 0.0), 1.0) * kKeepAllThreshold)),
+      emission_interval_ns_(max_events_per_second
+                                ? Time::kNanosecondsPerSecond /
+                                      max_events_per_second
+                                : 0),
+      burst_tolerance_ns_(max_events_per_second
+                              ? emission_interval_ns_ *
+                                    (max_events_per_second - 1)
+                              : 0),
+      theoretical_arrival_time_ns_(0) {}
+
+CategorySampler::~CategorySampler() = default;
+
+bool CategorySampler::ShouldRecordEvent(TimeTicks timestamp) {
+  if (sampling_threshold_ < kKeepAllThreshold &&
+      NextRandomNumber() >= sampling_threshold_) {
+    return false;
+  }
+  if (!emission_interval_ns_)
+    return true;
+
+  int64_t now_ns = timestamp.since_origin().InMicroseconds() *
+                   Time::kNanosecondsPerMicrosecond;
+  int64_t arrival_time_ns =
+      theoretical_arrival_time_ns_.load(std::memory_order_relaxed);
+  int64_t new_arrival_time_ns;
+  do {
+    int64_t start_ns = std::max(arrival_time_ns, now_ns);
+    // The bucket is empty.
+    if (start_ns - now_ns > burst_tolerance_ns_)
+      return false;
+    new_arrival_time_ns = start_ns + emission_interval_ns_;
+  } while (!theoretical_arrival_time_ns_.compare_exchange_weak(
+      arrival_time_ns, new_arrival_time_ns, std::memory_order_relaxed));
+  return true;
+}
+
+}  // namespace trace_event
+}  // namespace base
@@ -0,0 +1,56 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TRACE_EVENT_CATEGORY_SAMPLER_H_
+#define BASE_TRACE_EVENT_CATEGORY_SAMPLER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace trace_event {
+
+// Decides which of the events of the categories with a sampling config (see
+// TraceConfig::CategorySamplingConfig) are recorded. Each event is kept with
+// probability |sampling_rate|, and the kept events are then rate limited to
+// |max_events_per_second| by a token bucket holding up to a second of events.
+//
+// ShouldRecordEvent() is called for every event of the categories, from any
+// thread: it takes no lock, the randomness comes from a thread-local generator
+// and the token bucket is a single atomic.
+class BASE_EXPORT CategorySampler {
+ public:
+  // |max_events_per_second| is 0 if the events aren't rate limited.
+  CategorySampler(double sampling_rate, uint32_t max_events_per_second);
+  ~CategorySampler();
+
+  // Returns whether the event of time |timestamp| should be recorded.
+  bool ShouldRecordEvent(TimeTicks timestamp);
+
+ private:
+  // The events are kept if a random 32-bit number is less than this, which is
+  // 2^32 when they are all kept.
+  const uint64_t sampling_threshold_;
+
+  // The token bucket is implemented as the equivalent generic cell rate
+  // algorithm: |theoretical_arrival_time_ns_| is the time at which the bucket
+  // will be full again, which may be ahead of the current time by up to
+  // |burst_tolerance_ns_|. Each event recorded moves it forward by
+  // |emission_interval_ns_|.
+  const int64_t emission_interval_ns_;
+  const int64_t burst_tolerance_ns_;
+  std::atomic<int64_t> theoretical_arrival_time_ns_;
+
+  DISALLOW_COPY_AND_ASSIGN(CategorySampler);
+};
+
+}  // namespace trace_event
+}  // namespace base
+
+#endif  // BASE_TRACE_EVENT_CATEGORY_SAMPLER_H_
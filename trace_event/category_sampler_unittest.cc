@@ -0,0 +1,63 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/category_sampler.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace trace_event {
+
+namespace {
+
+int CountRecordedEvents(CategorySampler* sampler,
+                        TimeTicks timestamp,
+                        int num_events) {
+  int num_recorded = 0;
+  for (int i = 0; i < num_events; ++i) {
+    if (sampler->ShouldRecordEvent(timestamp))
+      ++num_recorded;
+  }
+  return num_recorded;
+}
+
+}  // namespace
+
+TEST(CategorySamplerTest, SamplingRate) {
+  TimeTicks now = TimeTicks() + TimeDelta::FromSeconds(1);
+  CategorySampler all(1, 0);
+  EXPECT_EQ(1000, CountRecordedEvents(&all, now, 1000));
+  CategorySampler none(0, 0);
+  EXPECT_EQ(0, CountRecordedEvents(&none, now, 1000));
+
+  CategorySampler tenth(0.1, 0);
+  int num_recorded = CountRecordedEvents(&tenth, now, 100000);
+  EXPECT_GT(num_recorded, 9000);
+  EXPECT_LT(num_recorded, 11000);
+}
+
+TEST(CategorySamplerTest, RateLimit) {
+  TimeTicks now = TimeTicks() + TimeDelta::FromSeconds(1);
+  CategorySampler sampler(1, 100);
+  // Up to a second of events are recorded at once.
+  EXPECT_EQ(100, CountRecordedEvents(&sampler, now, 1000));
+
+  // Then the bucket refills at the rate.
+  now += TimeDelta::FromMilliseconds(50);
+  EXPECT_EQ(5, CountRecordedEvents(&sampler, now, 1000));
+  now += TimeDelta::FromSeconds(10);
+  EXPECT_EQ(100, CountRecordedEvents(&sampler, now, 1000));
+}
+
+TEST(CategorySamplerTest, SamplingRateAndRateLimit) {
+  TimeTicks now = TimeTicks() + TimeDelta::FromSeconds(1);
+  CategorySampler sampler(0.5, 10);
+  // The events sampled out don't use up the rate limit.
+  EXPECT_EQ(10, CountRecordedEvents(&sampler, now, 1000));
+  now += TimeDelta::FromSeconds(1);
+  EXPECT_EQ(10, CountRecordedEvents(&sampler, now, 1000));
+}
+
+}  // namespace trace_event
+}  // namespace base
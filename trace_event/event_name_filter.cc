@@ -4,6 +4,9 @@
 
 #include "base/trace_event/event_name_filter.h"
 
+#include <stdint.h>
+
+#include "base/trace_event/common/trace_event_common.h"
 #include "base/trace_event/trace_event_impl.h"
 
 namespace base {
@@ -12,14 +15,48 @@ namespace trace_event {
 // static
 const char EventNameFilter::kName[] = "event_whitelist_predicate";
 
+// static
+constexpr size_t EventNameFilter::kNameCacheSize;
+
 EventNameFilter::EventNameFilter(
     std::unique_ptr<EventNamesWhitelist> event_names_whitelist)
-    : event_names_whitelist_(std::move(event_names_whitelist)) {}
+    : event_names_whitelist_(std::move(event_names_whitelist)),
+      event_names_(event_names_whitelist_->begin(),
+                   event_names_whitelist_->end()) {
+  for (size_t i = 0; i < kNameCacheSize; ++i) {
+    whitelisted_names_[i].store(nullptr, std::memory_order_relaxed);
+    rejected_names_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
 
 EventNameFilter::~EventNameFilter() = default;
 
 bool EventNameFilter::FilterTraceEvent(const TraceEvent& trace_event) const {
-  return event_names_whitelist_->count(trace_event.name()) != 0;
+  const char* name = trace_event.name();
+  if (trace_event.flags() & TRACE_EVENT_FLAG_COPY)
+    return event_names_.count(name) != 0;
+
+  // The names of events are never null, so empty cache entries don't match.
+  const size_t index = GetNameCacheIndex(name);
+  if (whitelisted_names_[index].load(std::memory_order_relaxed) == name)
+    return true;
+  if (rejected_names_[index].load(std::memory_order_relaxed) == name)
+    return false;
+
+  const bool whitelisted = event_names_.count(name) != 0;
+  (whitelisted ? whitelisted_names_ : rejected_names_)[index].store(
+      name, std::memory_order_relaxed);
+  return whitelisted;
+}
+
+// static
+size_t EventNameFilter::GetNameCacheIndex(const char* name) {
+  // Mixes the bits of the pointer, since string literals tend to be laid out
+  // close together, with variable alignment.
+  const uint64_t hash =
+      static_cast<uint64_t>(reinterpret_cast<uintptr_t>(name)) *
+      UINT64_C(0x9e3779b97f4a7c15);
+  return static_cast<size_t>(hash >> 32) & (kNameCacheSize - 1);
 }
 
 }  // namespace trace_event
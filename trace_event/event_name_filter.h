@@ -5,12 +5,16 @@
 #ifndef BASE_TRACE_EVENT_EVENT_NAME_FILTER_H_
 #define BASE_TRACE_EVENT_EVENT_NAME_FILTER_H_
 
+#include <stddef.h>
+
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_set>
 
 #include "base/base_export.h"
 #include "base/macros.h"
+#include "base/strings/string_piece.h"
 #include "base/trace_event/trace_event_filter.h"
 
 namespace base {
@@ -19,10 +23,10 @@ namespace trace_event {
 class TraceEvent;
 
 // Filters trace events by checking the full name against a whitelist.
-// The current implementation is quite simple and dumb and just uses a
-// hashtable which requires char* to std::string conversion. It could be smarter
-// and use a bloom filter trie. However, today this is used too rarely to
-// justify that cost.
+// Since the names of events are usually string literals, whose addresses don't
+// change, the verdicts are cached by name pointer: most events are filtered
+// with a couple of loads, and the whitelist is only searched, without copying
+// the name, the first time a name is seen or when cached names collide.
 class BASE_EXPORT EventNameFilter : public TraceEventFilter {
  public:
   using EventNamesWhitelist = std::unordered_set<std::string>;
@@ -35,7 +39,25 @@ class BASE_EXPORT EventNameFilter : public TraceEventFilter {
   bool FilterTraceEvent(const TraceEvent&) const override;
 
  private:
+  // The number of name pointers cached for each verdict. A power of 2.
+  static constexpr size_t kNameCacheSize = 256;
+
+  using NameCache = std::atomic<const char*>[kNameCacheSize];
+
+  static size_t GetNameCacheIndex(const char* name);
+
   std::unique_ptr<const EventNamesWhitelist> event_names_whitelist_;
+  // Views of the strings of |event_names_whitelist_|, to look names up without
+  // converting them to std::string.
+  std::unordered_set<StringPiece, StringPieceHash> event_names_;
+
+  // Name pointers recently found in the whitelist, and not found in it. Each
+  // one is only ever in the cache of its verdict, so concurrent updates can
+  // evict names, but never make the filter return a wrong verdict. Names of
+  // events with TRACE_EVENT_FLAG_COPY aren't cached, since their storage is
+  // reused.
+  mutable NameCache whitelisted_names_;
+  mutable NameCache rejected_names_;
 
   DISALLOW_COPY_AND_ASSIGN(EventNameFilter);
 };
@@ -4,18 +4,24 @@
 
 #include "base/trace_event/event_name_filter.h"
 
+#include <string.h>
+
+#include <string>
+
 #include "base/memory/ptr_util.h"
+#include "base/trace_event/common/trace_event_common.h"
 #include "base/trace_event/trace_event_impl.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
 namespace trace_event {
 
-const TraceEvent& MakeTraceEvent(const char* name) {
+const TraceEvent& MakeTraceEvent(const char* name,
+                                 unsigned int flags = TRACE_EVENT_FLAG_NONE) {
   static TraceEvent event;
   event.Reset();
   event.Initialize(0, TimeTicks(), ThreadTicks(), 'b', nullptr, name, "", 0, 0,
-                   0, nullptr, nullptr, nullptr, nullptr, 0);
+                   0, nullptr, nullptr, nullptr, nullptr, flags);
   return event;
 }
 
@@ -38,5 +44,32 @@ TEST(TraceEventNameFilterTest, Whitelist) {
   EXPECT_FALSE(filter->FilterTraceEvent(MakeTraceEvent("foobar")));
 }
 
+// The verdicts cached for names don't apply to other names, even when they
+// are copied to the same storage.
+TEST(TraceEventNameFilterTest, CachedVerdicts) {
+  auto whitelist = std::make_unique<EventNameFilter::EventNamesWhitelist>();
+  whitelist->insert("foo");
+  auto filter = std::make_unique<EventNameFilter>(std::move(whitelist));
+
+  static const char kFoo[] = "foo";
+  static const char kBar[] = "bar";
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(filter->FilterTraceEvent(MakeTraceEvent(kFoo)));
+    EXPECT_FALSE(filter->FilterTraceEvent(MakeTraceEvent(kBar)));
+  }
+
+  char name[4];
+  for (const char* copied_name : {"foo", "bar", "foo", "bar"}) {
+    strcpy(name, copied_name);
+    EXPECT_EQ(strcmp(name, "foo") == 0,
+              filter->FilterTraceEvent(
+                  MakeTraceEvent(name, TRACE_EVENT_FLAG_COPY)));
+  }
+
+  // Names which aren't string literals are looked up by value.
+  const std::string foo = "foo";
+  EXPECT_TRUE(filter->FilterTraceEvent(MakeTraceEvent(foo.c_str())));
+}
+
 }  // namespace trace_event
 }  // namespace base
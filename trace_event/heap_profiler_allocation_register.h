@@ -8,6 +8,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <type_traits>
 #include <utility>
 
@@ -27,14 +28,22 @@ namespace internal {
 
 // Allocates a region of virtual address space of |size| rounded up to the
 // system page size. The memory is zeroed by the system. A guard page is
-// added after the end.
+// added after the end. The memory must be committed with
+// CommitGuardedVirtualMemory() before it's used.
 void* AllocateGuardedVirtualMemory(size_t size);
 
+// Commits |size| bytes at |address|, which are within a region allocated by
+// AllocateGuardedVirtualMemory() and page aligned. Returns false if the system
+// is out of memory.
+bool CommitGuardedVirtualMemory(void* address, size_t size);
+
 // Frees a region of virtual address space allocated by a call to
 // |AllocateVirtualMemory|.
 void FreeGuardedVirtualMemory(void* address, size_t allocated_size);
 
-// Hash map that mmaps memory only once in the constructor. Its API is
+// Hash map that mmaps memory only once in the constructor, and commits the
+// cells as they are first used, so that its capacity costs address space but
+// not committed memory. Its API is
 // similar to std::unordered_map, only index (KVIndex) is used to address
 template <size_t NumBuckets, class Key, class Value, class KeyHasher>
 class FixedHashMap {
@@ -61,7 +70,12 @@ class FixedHashMap {
         buckets_(static_cast<Bucket*>(
             AllocateGuardedVirtualMemory(NumBuckets * sizeof(Bucket)))),
         free_list_(nullptr),
-        next_unused_cell_(0) {}
+        next_unused_cell_(0),
+        committed_cells_size_(0) {
+    CHECK(CommitGuardedVirtualMemory(buckets_,
+                                     bits::Align(NumBuckets * sizeof(Bucket),
+                                                 GetPageSize())));
+  }
 
   ~FixedHashMap() {
     FreeGuardedVirtualMemory(cells_, num_cells_ * sizeof(Cell));
@@ -204,10 +218,32 @@ class FixedHashMap {
       return nullptr;
     }
 
-    // Otherwise pick the next cell that has not been touched before.
+    // Otherwise pick the next cell that has not been touched before,
+    // committing more cells if needed.
+    if ((next_unused_cell_ + 1) * sizeof(Cell) > committed_cells_size_ &&
+        !CommitMoreCells()) {
+      return nullptr;
+    }
     return &cells_[next_unused_cell_++];
   }
 
+  // Commits the next chunk of |cells_|. Returns false if the system is out of
+  // memory.
+  bool CommitMoreCells() {
+    const size_t page_size = GetPageSize();
+    const size_t cells_size = bits::Align(num_cells_ * sizeof(Cell), page_size);
+    const size_t commit_size =
+        std::min(bits::Align(kCellsCommitSize, page_size),
+                 cells_size - committed_cells_size_);
+    if (!CommitGuardedVirtualMemory(
+            reinterpret_cast<char*>(cells_) + committed_cells_size_,
+            commit_size)) {
+      return false;
+    }
+    committed_cells_size_ += commit_size;
+    return true;
+  }
+
   // Returns a value in the range [0, NumBuckets - 1] (inclusive).
   size_t Hash(const Key& key) const {
     if (NumBuckets == (NumBuckets & ~(NumBuckets - 1))) {
@@ -242,6 +278,12 @@ class FixedHashMap {
   // is used. This is the high water mark for the number of entries stored.
   size_t next_unused_cell_;
 
+  // The number of bytes of |cells_| which are committed, from its start.
+  size_t committed_cells_size_;
+
+  // How much of |cells_| is committed at once.
+  static constexpr size_t kCellsCommitSize = 64 * 1024;
+
   DISALLOW_COPY_AND_ASSIGN(FixedHashMap);
 };
 
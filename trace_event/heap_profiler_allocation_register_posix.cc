@@ -73,6 +73,11 @@ void* AllocateGuardedVirtualMemory(size_t size) {
   return addr;
 }
 
+bool CommitGuardedVirtualMemory(void* address, size_t size) {
+  // The pages are backed by memory when they are first touched.
+  return true;
+}
+
 void FreeGuardedVirtualMemory(void* address, size_t allocated_size) {
   size_t size = bits::Align(allocated_size, GetPageSize()) + GetGuardSize();
 #if defined(OS_FUCHSIA)
@@ -32,6 +32,20 @@ class AllocationRegisterTest : public testing::Test {
   size_t GetHighWaterMark(const AllocationRegister& reg) {
     return reg.allocations_.next_unused_cell_;
   }
+
+  size_t GetCommittedCellsSize(const AllocationRegister& reg) {
+    return reg.allocations_.committed_cells_size_;
+  }
+
+  size_t GetCellsCommitSize() {
+    return bits::Align(AllocationRegister::AllocationMap::kCellsCommitSize,
+                       GetPageSize());
+  }
+
+  size_t GetAllocationCapacityPerCommit() {
+    return GetCellsCommitSize() /
+           sizeof(AllocationRegister::AllocationMap::Cell);
+  }
 };
 
 // Iterates over all entries in the allocation register and returns the bitwise
@@ -267,6 +281,24 @@ TEST_F(AllocationRegisterTest, OverflowAllocationTest) {
   }
 }
 
+// Check that the cells are committed as the table fills up.
+TEST_F(AllocationRegisterTest, CommitsCellsOnDemand) {
+  const size_t allocation_capacity = 3 * GetAllocationCapacityPerCommit();
+  AllocationRegister reg(allocation_capacity, kBacktraceCapacity);
+  AllocationContext ctx;
+  EXPECT_EQ(0u, GetCommittedCellsSize(reg));
+
+  ASSERT_TRUE(reg.Insert(reinterpret_cast<void*>(1), 1, ctx));
+  EXPECT_EQ(GetCellsCommitSize(), GetCommittedCellsSize(reg));
+
+  for (size_t i = 1; i < allocation_capacity; i++)
+    ASSERT_TRUE(reg.Insert(reinterpret_cast<void*>(i + 1), 1, ctx));
+  EXPECT_LE(2 * GetCellsCommitSize(), GetCommittedCellsSize(reg));
+  EXPECT_EQ(allocation_capacity, SumAllSizes(reg));
+  EXPECT_FALSE(reg.Insert(
+      reinterpret_cast<void*>(allocation_capacity + 1), 1, ctx));
+}
+
 // Check that the table handles overflows of the backtrace storage (but not the
 // allocations storage) gracefully.
 TEST_F(AllocationRegisterTest, OverflowBacktraceTest) {
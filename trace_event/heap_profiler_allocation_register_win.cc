@@ -27,16 +27,13 @@ void* AllocateGuardedVirtualMemory(size_t size) {
   // Add space for a guard page at the end.
   size_t map_size = size + GetGuardSize();
 
-  // Reserve the address space. This does not make the memory usable yet.
+  // Reserve the address space. This does not make the memory usable yet, the
+  // non-guard pages are committed by CommitGuardedVirtualMemory() as they are
+  // needed.
   void* addr = VirtualAlloc(nullptr, map_size, MEM_RESERVE, PAGE_NOACCESS);
 
   PCHECK(addr != nullptr);
 
-  // Commit the non-guard pages as read-write memory.
-  void* result = VirtualAlloc(addr, size, MEM_COMMIT, PAGE_READWRITE);
-
-  PCHECK(result != nullptr);
-
   // Mark the last page of the allocated address space as guard page. (NB: The
   // |PAGE_GUARD| flag is not the flag to use here, that flag can be used to
   // detect and intercept access to a certain memory region. Accessing a
@@ -44,12 +41,17 @@ void* AllocateGuardedVirtualMemory(size_t size) {
   // read/write accessible space is still at least |min_size| bytes.
   void* guard_addr =
       reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(addr) + size);
-  result = VirtualAlloc(guard_addr, GetGuardSize(), MEM_COMMIT, PAGE_NOACCESS);
+  void* result =
+      VirtualAlloc(guard_addr, GetGuardSize(), MEM_COMMIT, PAGE_NOACCESS);
   PCHECK(result != nullptr);
 
   return addr;
 }
 
+bool CommitGuardedVirtualMemory(void* address, size_t size) {
+  return VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+}
+
 void FreeGuardedVirtualMemory(void* address, size_t allocated_size) {
   // For |VirtualFree|, the size passed with |MEM_RELEASE| must be 0. Windows
   // automatically frees the entire region that was reserved by the
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <string>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -170,6 +171,42 @@ std::vector<Bucket> BreakDownBy(const Bucket& bucket,
   return buckets;
 }
 
+// Appends |entry| to the "entries" array being written in |traced_value|.
+// |buffer| is scratch space for formatting.
+void SerializeEntry(const Entry& entry,
+                    std::string* buffer,
+                    TracedValue* traced_value) {
+  traced_value->BeginDictionary();
+
+  // Format size as hexadecimal string into |buffer|.
+  SStringPrintf(buffer, "%" PRIx64, static_cast<uint64_t>(entry.size));
+  traced_value->SetString("size", *buffer);
+
+  SStringPrintf(buffer, "%" PRIx64, static_cast<uint64_t>(entry.count));
+  traced_value->SetString("count", *buffer);
+
+  if (entry.stack_frame_id == -1) {
+    // An empty backtrace (which will have ID -1) is represented by the empty
+    // string, because there is no leaf frame to reference in |stackFrames|.
+    traced_value->SetString("bt", "");
+  } else {
+    // Format index of the leaf frame as a string, because |stackFrames| is a
+    // dictionary, not an array.
+    SStringPrintf(buffer, "%i", entry.stack_frame_id);
+    traced_value->SetString("bt", *buffer);
+  }
+
+  // Type ID -1 (cumulative size for all types) is represented by the absence
+  // of the "type" key in the dictionary.
+  if (entry.type_id != -1) {
+    // Format the type ID as a string.
+    SStringPrintf(buffer, "%i", entry.type_id);
+    traced_value->SetString("type", *buffer);
+  }
+
+  traced_value->EndDictionary();
+}
+
 }  // namespace
 
 bool operator<(Entry lhs, Entry rhs) {
@@ -268,37 +305,8 @@ std::unique_ptr<TracedValue> Serialize(const std::set<Entry>& entries) {
 
   traced_value->BeginArray("entries");
 
-  for (const Entry& entry : entries) {
-    traced_value->BeginDictionary();
-
-    // Format size as hexadecimal string into |buffer|.
-    SStringPrintf(&buffer, "%" PRIx64, static_cast<uint64_t>(entry.size));
-    traced_value->SetString("size", buffer);
-
-    SStringPrintf(&buffer, "%" PRIx64, static_cast<uint64_t>(entry.count));
-    traced_value->SetString("count", buffer);
-
-    if (entry.stack_frame_id == -1) {
-      // An empty backtrace (which will have ID -1) is represented by the empty
-      // string, because there is no leaf frame to reference in |stackFrames|.
-      traced_value->SetString("bt", "");
-    } else {
-      // Format index of the leaf frame as a string, because |stackFrames| is a
-      // dictionary, not an array.
-      SStringPrintf(&buffer, "%i", entry.stack_frame_id);
-      traced_value->SetString("bt", buffer);
-    }
-
-    // Type ID -1 (cumulative size for all types) is represented by the absence
-    // of the "type" key in the dictionary.
-    if (entry.type_id != -1) {
-      // Format the type ID as a string.
-      SStringPrintf(&buffer, "%i", entry.type_id);
-      traced_value->SetString("type", buffer);
-    }
-
-    traced_value->EndDictionary();
-  }
+  for (const Entry& entry : entries)
+    SerializeEntry(entry, &buffer, traced_value.get());
 
   traced_value->EndArray();  // "entries"
   return traced_value;
@@ -319,5 +327,48 @@ std::unique_ptr<TracedValue> ExportHeapDump(
   return Serialize(writer.Summarize(metrics_by_context));
 }
 
+std::unique_ptr<TracedValue> ExportHeapDumpIncrementally(
+    const std::unordered_map<AllocationContext, AllocationMetrics>&
+        metrics_by_context,
+    const HeapProfilerSerializationState& heap_profiler_serialization_state) {
+  TRACE_EVENT0(TRACE_DISABLED_BY_DEFAULT("memory-infra"),
+               "ExportHeapDumpIncrementally");
+  StackFrameDeduplicator* stack_frame_deduplicator =
+      heap_profiler_serialization_state.stack_frame_deduplicator();
+  TypeNameDeduplicator* type_name_deduplicator =
+      heap_profiler_serialization_state.type_name_deduplicator();
+  std::string buffer;
+  std::unique_ptr<TracedValue> traced_value(new TracedValue);
+
+  // The contexts are distinct keys already, so each one is an entry of its
+  // own and is written right away.
+  internal::Entry total = {0, 0, -1, -1};
+  traced_value->BeginArray("entries");
+  for (const auto& context_and_metrics : metrics_by_context) {
+    DCHECK_GT(context_and_metrics.second.size, 0u);
+    DCHECK_GT(context_and_metrics.second.count, 0u);
+    const AllocationContext& context = context_and_metrics.first;
+    const StackFrame* backtrace_begin = std::begin(context.backtrace.frames);
+
+    internal::Entry entry;
+    entry.size = context_and_metrics.second.size;
+    entry.count = context_and_metrics.second.count;
+    entry.stack_frame_id = stack_frame_deduplicator->Insert(
+        backtrace_begin, backtrace_begin + context.backtrace.frame_count);
+    entry.type_id = type_name_deduplicator->Insert(context.type_name);
+    internal::SerializeEntry(entry, &buffer, traced_value.get());
+
+    total.size += entry.size;
+    total.count += entry.count;
+  }
+  internal::SerializeEntry(total, &buffer, traced_value.get());
+  traced_value->EndArray();  // "entries"
+
+  traced_value->BeginArray("nodes");
+  stack_frame_deduplicator->SerializeIncrementally(traced_value.get());
+  traced_value->EndArray();  // "nodes"
+  return traced_value;
+}
+
 }  // namespace trace_event
 }  // namespace base
@@ -32,6 +32,17 @@ BASE_EXPORT std::unique_ptr<TracedValue> ExportHeapDump(
         metrics_by_context,
     const HeapProfilerSerializationState& heap_profiler_serialization_state);
 
+// Writes |metrics_by_context| in one pass, without breaking down the heap,
+// and returns a traced value with an "entries" array of one entry per context
+// plus the total, in the format of ExportHeapDump(). The stack frames that
+// earlier dumps of the session did not carry are written in a "nodes" array,
+// see StackFrameDeduplicator::SerializeIncrementally(). This is cheaper than
+// ExportHeapDump() on heaps with many contexts, but includes the long tail.
+BASE_EXPORT std::unique_ptr<TracedValue> ExportHeapDumpIncrementally(
+    const std::unordered_map<AllocationContext, AllocationMetrics>&
+        metrics_by_context,
+    const HeapProfilerSerializationState& heap_profiler_serialization_state);
+
 namespace internal {
 
 namespace {
@@ -13,7 +13,10 @@
 #include "base/json/json_reader.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/trace_event/heap_profiler_allocation_context.h"
+#include "base/trace_event/heap_profiler_serialization_state.h"
 #include "base/trace_event/heap_profiler_stack_frame_deduplicator.h"
 #include "base/trace_event/heap_profiler_type_name_deduplicator.h"
 #include "base/trace_event/trace_event_argument.h"
@@ -325,6 +328,55 @@ TEST(HeapDumpWriterTest, InsignificantValuesNotDumped) {
   AssertNotDumped(dump, bt_initialize, -1);
 }
 
+TEST(HeapDumpWriterTest, ExportHeapDumpIncrementally) {
+  scoped_refptr<HeapProfilerSerializationState> state =
+      new HeapProfilerSerializationState;
+  state->SetStackFrameDeduplicator(WrapUnique(new StackFrameDeduplicator));
+  state->SetTypeNameDeduplicator(WrapUnique(new TypeNameDeduplicator));
+
+  auto export_heap_dump = [&state](
+      const std::unordered_map<AllocationContext, AllocationMetrics>&
+          metrics_by_context) {
+    std::string json;
+    ExportHeapDumpIncrementally(metrics_by_context, *state)
+        ->AppendAsTraceFormat(&json);
+    return JSONReader::Read(json);
+  };
+
+  std::unordered_map<AllocationContext, AllocationMetrics> metrics_by_context;
+  AllocationContext ctx;
+  ctx.backtrace.frames[0] = kBrowserMain;
+  ctx.backtrace.frames[1] = kCreateWidget;
+  ctx.backtrace.frame_count = 2;
+  ctx.type_name = kInt;
+  metrics_by_context[ctx] = {10, 5};
+
+  // Small allocations are not left out, and the total comes last.
+  std::unique_ptr<Value> dump = export_heap_dump(metrics_by_context);
+  const Value::ListStorage& entries = dump->FindKey("entries")->GetList();
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_EQ("a", entries[0].FindKey("size")->GetString());
+  EXPECT_EQ("5", entries[0].FindKey("count")->GetString());
+  EXPECT_EQ("1", entries[0].FindKey("bt")->GetString());
+  EXPECT_EQ(IntToString(state->type_name_deduplicator()->Insert(kInt)),
+            entries[0].FindKey("type")->GetString());
+  EXPECT_EQ("a", entries[1].FindKey("size")->GetString());
+  EXPECT_EQ("", entries[1].FindKey("bt")->GetString());
+  EXPECT_EQ(nullptr, entries[1].FindKey("type"));
+  EXPECT_EQ(2u, dump->FindKey("nodes")->GetList().size());
+
+  // The next dump carries only the new stack frames.
+  ctx.backtrace.frames[1] = kInitialize;
+  metrics_by_context[ctx] = {20, 1};
+  dump = export_heap_dump(metrics_by_context);
+  EXPECT_EQ(3u, dump->FindKey("entries")->GetList().size());
+  const Value::ListStorage& nodes = dump->FindKey("nodes")->GetList();
+  ASSERT_EQ(1u, nodes.size());
+  EXPECT_EQ(2, nodes[0].FindKey("id")->GetInt());
+  EXPECT_EQ("Initialize", nodes[0].FindKey("name")->GetString());
+  EXPECT_EQ(0, nodes[0].FindKey("parent")->GetInt());
+}
+
 }  // namespace internal
 }  // namespace trace_event
 }  // namespace base
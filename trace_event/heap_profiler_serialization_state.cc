@@ -8,7 +8,8 @@ namespace base {
 namespace trace_event {
 
 HeapProfilerSerializationState::HeapProfilerSerializationState()
-    : heap_profiler_breakdown_threshold_bytes_(0) {}
+    : heap_profiler_breakdown_threshold_bytes_(0),
+      incremental_heap_dumps_(false) {}
 HeapProfilerSerializationState::~HeapProfilerSerializationState() = default;
 
 void HeapProfilerSerializationState::SetStackFrameDeduplicator(
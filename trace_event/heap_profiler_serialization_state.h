@@ -54,6 +54,14 @@ class BASE_EXPORT HeapProfilerSerializationState
     return heap_profiler_breakdown_threshold_bytes_;
   }
 
+  // Whether heap dumps are written by ExportHeapDumpIncrementally() rather
+  // than broken down by ExportHeapDump().
+  void set_incremental_heap_dumps(bool value) {
+    incremental_heap_dumps_ = value;
+  }
+
+  bool incremental_heap_dumps() const { return incremental_heap_dumps_; }
+
   bool is_initialized() const {
     return stack_frame_deduplicator_ && type_name_deduplicator_ &&
            heap_profiler_breakdown_threshold_bytes_;
@@ -72,6 +80,8 @@ class BASE_EXPORT HeapProfilerSerializationState
   std::unique_ptr<TypeNameDeduplicator> type_name_deduplicator_;
 
   uint32_t heap_profiler_breakdown_threshold_bytes_;
+
+  bool incremental_heap_dumps_;
 };
 
 }  // namespace trace_event
@@ -12,6 +12,7 @@
 #include <utility>
 
 #include "base/hash.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/stringprintf.h"
 #include "base/trace_event/memory_usage_estimator.h"
 #include "base/trace_event/trace_event.h"
@@ -33,6 +34,23 @@ size_t HashBacktrace(const StackFrame* begin, const StackFrame* end) {
   return hash;
 }
 
+// Formats the name of |frame| into |name|.
+void GetFrameName(const StackFrame& frame, std::string* name) {
+  switch (frame.type) {
+    case StackFrame::Type::TRACE_EVENT_NAME:
+      StringPiece(static_cast<const char*>(frame.value)).CopyToString(name);
+      break;
+    case StackFrame::Type::THREAD_NAME:
+      SStringPrintf(name, "[Thread: %s]",
+                    static_cast<const char*>(frame.value));
+      break;
+    case StackFrame::Type::PROGRAM_COUNTER:
+      SStringPrintf(name, "pc:%" PRIxPTR,
+                    reinterpret_cast<uintptr_t>(frame.value));
+      break;
+  }
+}
+
 }  // namespace
 
 StackFrameDeduplicator::FrameNode::FrameNode(StackFrame frame,
@@ -147,25 +165,8 @@ void StackFrameDeduplicator::AppendAsTraceFormat(std::string* out) const {
     out->append(stringify_buffer);
 
     std::unique_ptr<TracedValue> frame_node_value(new TracedValue);
-    const StackFrame& frame = frame_node->frame;
-    switch (frame.type) {
-      case StackFrame::Type::TRACE_EVENT_NAME:
-        frame_node_value->SetString("name",
-                                    static_cast<const char*>(frame.value));
-        break;
-      case StackFrame::Type::THREAD_NAME:
-        SStringPrintf(&stringify_buffer,
-                      "[Thread: %s]",
-                      static_cast<const char*>(frame.value));
-        frame_node_value->SetString("name", stringify_buffer);
-        break;
-      case StackFrame::Type::PROGRAM_COUNTER:
-        SStringPrintf(&stringify_buffer,
-                      "pc:%" PRIxPTR,
-                      reinterpret_cast<uintptr_t>(frame.value));
-        frame_node_value->SetString("name", stringify_buffer);
-        break;
-    }
+    GetFrameName(frame_node->frame, &stringify_buffer);
+    frame_node_value->SetString("name", stringify_buffer);
     if (frame_node->parent_frame_index != FrameNode::kInvalidFrameIndex) {
       SStringPrintf(&stringify_buffer, "%d", frame_node->parent_frame_index);
       frame_node_value->SetString("parent", stringify_buffer);
@@ -182,6 +183,21 @@ void StackFrameDeduplicator::AppendAsTraceFormat(std::string* out) const {
   out->append("}");  // End the |stackFrames| dictionary.
 }
 
+void StackFrameDeduplicator::SerializeIncrementally(
+    TracedValue* traced_value) {
+  std::string name;
+  for (; last_exported_index_ < frames_.size(); ++last_exported_index_) {
+    const FrameNode& frame_node = frames_[last_exported_index_];
+    traced_value->BeginDictionary();
+    traced_value->SetInteger("id", static_cast<int>(last_exported_index_));
+    GetFrameName(frame_node.frame, &name);
+    traced_value->SetString("name", name);
+    if (frame_node.parent_frame_index != FrameNode::kInvalidFrameIndex)
+      traced_value->SetInteger("parent", frame_node.parent_frame_index);
+    traced_value->EndDictionary();
+  }
+}
+
 void StackFrameDeduplicator::EstimateTraceMemoryOverhead(
     TraceEventMemoryOverhead* overhead) {
   size_t memory_usage = EstimateMemoryUsage(frames_) +
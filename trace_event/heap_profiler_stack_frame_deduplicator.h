@@ -19,6 +19,7 @@ namespace base {
 namespace trace_event {
 
 class TraceEventMemoryOverhead;
+class TracedValue;
 
 // A data structure that allows grouping a set of backtraces in a space-
 // efficient manner by creating a call tree and writing it as a set of (node,
@@ -67,6 +68,12 @@ class BASE_EXPORT StackFrameDeduplicator : public ConvertableToTraceFormat {
   // the trace log.
   void AppendAsTraceFormat(std::string* out) const override;
 
+  // Appends the frame nodes inserted since the previous call to the array
+  // being written in |traced_value|, as dictionaries with "id", "name" and
+  // "parent" keys. Used by incremental heap dumps, which carry only the frames
+  // that earlier dumps of the session did not.
+  void SerializeIncrementally(TracedValue* traced_value);
+
   // Estimates memory overhead including |sizeof(StackFrameDeduplicator)|.
   void EstimateTraceMemoryOverhead(TraceEventMemoryOverhead* overhead) override;
 
@@ -85,6 +92,9 @@ class BASE_EXPORT StackFrameDeduplicator : public ConvertableToTraceFormat {
   // Match() is used on the found frame_index to detect collisions.
   std::unordered_map<size_t, int> backtrace_lookup_table_;
 
+  // The number of frames written by SerializeIncrementally().
+  size_t last_exported_index_ = 0;
+
   DISALLOW_COPY_AND_ASSIGN(StackFrameDeduplicator);
 };
 
@@ -6,9 +6,13 @@
 
 #include <iterator>
 #include <memory>
+#include <string>
 
+#include "base/json/json_reader.h"
 #include "base/macros.h"
 #include "base/trace_event/heap_profiler_allocation_context.h"
+#include "base/trace_event/trace_event_argument.h"
+#include "base/values.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -148,5 +152,43 @@ TEST(StackFrameDeduplicatorTest, Deduplication) {
   ASSERT_TRUE(dedup->begin() + 3 == dedup->end());
 }
 
+TEST(StackFrameDeduplicatorTest, SerializeIncrementally) {
+  StackFrame bt0[] = {kBrowserMain, kCreateWidget};
+  StackFrame bt1[] = {kBrowserMain, kInitialize};
+  StackFrameDeduplicator dedup;
+
+  auto serialize = [&dedup]() {
+    TracedValue traced_value;
+    traced_value.BeginArray("nodes");
+    dedup.SerializeIncrementally(&traced_value);
+    traced_value.EndArray();
+    std::string json;
+    traced_value.AppendAsTraceFormat(&json);
+    std::unique_ptr<Value> value = JSONReader::Read(json);
+    return value->FindKey("nodes")->Clone();
+  };
+
+  dedup.Insert(std::begin(bt0), std::end(bt0));
+  Value nodes = serialize();
+  ASSERT_EQ(2u, nodes.GetList().size());
+  EXPECT_EQ(0, nodes.GetList()[0].FindKey("id")->GetInt());
+  EXPECT_EQ("BrowserMain", nodes.GetList()[0].FindKey("name")->GetString());
+  EXPECT_EQ(nullptr, nodes.GetList()[0].FindKey("parent"));
+  EXPECT_EQ(1, nodes.GetList()[1].FindKey("id")->GetInt());
+  EXPECT_EQ("CreateWidget", nodes.GetList()[1].FindKey("name")->GetString());
+  EXPECT_EQ(0, nodes.GetList()[1].FindKey("parent")->GetInt());
+
+  // Only the frames which were not serialized before are written.
+  dedup.Insert(std::begin(bt0), std::end(bt0));
+  dedup.Insert(std::begin(bt1), std::end(bt1));
+  nodes = serialize();
+  ASSERT_EQ(1u, nodes.GetList().size());
+  EXPECT_EQ(2, nodes.GetList()[0].FindKey("id")->GetInt());
+  EXPECT_EQ("Initialize", nodes.GetList()[0].FindKey("name")->GetString());
+  EXPECT_EQ(0, nodes.GetList()[0].FindKey("parent")->GetInt());
+
+  EXPECT_TRUE(serialize().GetList().empty());
+}
+
 }  // namespace trace_event
 }  // namespace base
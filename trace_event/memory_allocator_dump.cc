@@ -39,6 +39,12 @@ MemoryAllocatorDump::MemoryAllocatorDump(
   // The |absolute_name| can contain slash separator, but not leading or
   // trailing ones.
   DCHECK(absolute_name[0] != '/' && *absolute_name.rbegin() != '/');
+
+  // Background dumps, e.g. the periodic ones, typically hold just a size and
+  // an object count. Making room for them upfront saves a reallocation per
+  // dump.
+  if (level_of_detail_ == MemoryDumpLevelOfDetail::BACKGROUND)
+    entries_.reserve(2);
 }
 
 MemoryAllocatorDump::~MemoryAllocatorDump() = default;
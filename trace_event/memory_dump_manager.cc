@@ -18,6 +18,7 @@
 #include "base/debug/stack_trace.h"
 #include "base/debug/thread_heap_usage_tracker.h"
 #include "base/memory/ptr_util.h"
+#include "base/partition_alloc_buildflags.h"
 #include "base/sequenced_task_runner.h"
 #include "base/strings/string_util.h"
 #include "base/third_party/dynamic_annotations/dynamic_annotations.h"
@@ -39,6 +40,10 @@
 #include "base/trace_event/trace_event_argument.h"
 #include "build/build_config.h"
 
+#if BUILDFLAG(USE_PARTITION_ALLOC)
+#include "base/trace_event/partition_alloc_dump_provider.h"
+#endif
+
 #if defined(OS_ANDROID)
 #include "base/trace_event/java_heap_dump_provider_android.h"
 
@@ -317,6 +322,12 @@ void MemoryDumpManager::Initialize(
                        nullptr);
 #endif
 
+#if BUILDFLAG(USE_PARTITION_ALLOC)
+  // Reports the partitions registered with it, if any.
+  RegisterDumpProvider(PartitionAllocDumpProvider::GetInstance(),
+                       "PartitionAlloc", nullptr);
+#endif
+
   TRACE_EVENT_WARMUP_CATEGORY(kTraceCategory);
 }
 
@@ -740,6 +751,8 @@ void MemoryDumpManager::SetupForTracing(
   heap_profiler_serialization_state_
       ->set_heap_profiler_breakdown_threshold_bytes(
           memory_dump_config.heap_profiler_options.breakdown_threshold_bytes);
+  heap_profiler_serialization_state_->set_incremental_heap_dumps(
+      memory_dump_config.heap_profiler_options.incremental);
   InitializeHeapProfilerStateIfNeededLocked();
 
   // At this point we must have the ability to request global dumps.
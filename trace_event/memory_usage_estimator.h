@@ -9,6 +9,7 @@
 
 #include <array>
 #include <deque>
+#include <iterator>
 #include <list>
 #include <map>
 #include <memory>
@@ -28,6 +29,7 @@
 #include "base/containers/linked_list.h"
 #include "base/containers/mru_cache.h"
 #include "base/containers/queue.h"
+#include "base/macros.h"
 #include "base/strings/string16.h"
 #include "base/template_util.h"
 
@@ -289,6 +291,27 @@ struct EMUCaller<
   static size_t Call(const T& value) { return 0; }
 };
 
+// IsNonAllocating<T>::value is true iff EstimateItemMemoryUsage(T) is known to
+// be 0 at compile time, so that containers of T are estimated in O(1) instead
+// of walking their items.
+template <class T, class X = void>
+struct IsNonAllocating : std::false_type {};
+
+template <class T>
+struct IsNonAllocating<
+    T,
+    std::enable_if_t<!HasEMU<T>::value && IsKnownNonAllocatingType_v<T>>>
+    : std::true_type {};
+
+template <class F, class S>
+struct IsNonAllocating<std::pair<F, S>>
+    : std::integral_constant<bool,
+                             IsNonAllocating<F>::value &&
+                                 IsNonAllocating<S>::value> {};
+
+template <class T, size_t N>
+struct IsNonAllocating<std::array<T, N>> : IsNonAllocating<T> {};
+
 // Returns reference to the underlying container of a container adapter.
 // Works for std::stack, std::queue and std::priority_queue.
 template <class A>
@@ -310,6 +333,9 @@ size_t EstimateItemMemoryUsage(const T& value) {
 
 template <class I>
 size_t EstimateIterableMemoryUsage(const I& iterable) {
+  using value_type = std::decay_t<decltype(*std::begin(iterable))>;
+  if (internal::IsNonAllocating<value_type>::value)
+    return 0;
   size_t memory_usage = 0;
   for (const auto& item : iterable) {
     memory_usage += EstimateItemMemoryUsage(item);
@@ -364,6 +390,8 @@ size_t EstimateMemoryUsage(T (&array)[N]) {
 template <class T>
 size_t EstimateMemoryUsage(const T* array, size_t array_length) {
   size_t memory_usage = sizeof(T) * array_length;
+  if (internal::IsNonAllocating<T>::value)
+    return memory_usage;
   for (size_t i = 0; i != array_length; ++i) {
     memory_usage += EstimateItemMemoryUsage(array[i]);
   }
@@ -657,6 +685,94 @@ size_t EstimateMemoryUsage(
   return internal::DoEstimateMemoryUsageForMruCache(mru_cache);
 }
 
+// Allocation counting
+//
+// Estimating a container walks all of its nodes, which is slow for large
+// containers estimated often. They can instead allocate through a
+// CountingAllocator, which keeps the number of bytes they hold up to date in
+// an AllocationCounter:
+//
+// using FooMapAllocator = CountingAllocator<std::pair<const int, Foo>>;
+// std::map<int, Foo, std::less<int>, FooMapAllocator> map_{
+//     FooMapAllocator(&map_allocation_counter_)};
+//
+// size_t MyClass::EstimateMemoryUsage() const {
+//   // O(1), but doesn't include what the Foo(s) allocate themselves.
+//   return base::trace_event::EstimateMemoryUsage(map_allocation_counter_);
+// }
+//
+// An AllocationCounter isn't thread-safe, so the containers sharing it must be
+// used on a single sequence. It must outlive them.
+class AllocationCounter {
+ public:
+  AllocationCounter() = default;
+
+  void Add(size_t bytes) { allocated_bytes_ += bytes; }
+  void Subtract(size_t bytes) { allocated_bytes_ -= bytes; }
+
+  size_t EstimateMemoryUsage() const { return allocated_bytes_; }
+
+ private:
+  size_t allocated_bytes_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationCounter);
+};
+
+// Allocates through |A| and counts the bytes allocated in an
+// AllocationCounter. Containers adopt the allocator, and so the counter, of
+// the containers they are assigned or swapped with.
+template <class T, class A = std::allocator<T>>
+class CountingAllocator : public A {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  template <class U>
+  struct rebind {
+    using other = CountingAllocator<
+        U,
+        typename std::allocator_traits<A>::template rebind_alloc<U>>;
+  };
+
+  explicit CountingAllocator(AllocationCounter* counter,
+                             const A& allocator = A())
+      : A(allocator), counter_(counter) {}
+
+  template <class U, class B>
+  CountingAllocator(const CountingAllocator<U, B>& other)
+      : A(other), counter_(other.counter()) {}
+
+  T* allocate(size_t n) {
+    counter_->Add(n * sizeof(T));
+    return std::allocator_traits<A>::allocate(*this, n);
+  }
+
+  void deallocate(T* p, size_t n) {
+    counter_->Subtract(n * sizeof(T));
+    std::allocator_traits<A>::deallocate(*this, p, n);
+  }
+
+  AllocationCounter* counter() const { return counter_; }
+
+ private:
+  AllocationCounter* counter_;
+};
+
+template <class T, class A, class U, class B>
+bool operator==(const CountingAllocator<T, A>& lhs,
+                const CountingAllocator<U, B>& rhs) {
+  return lhs.counter() == rhs.counter();
+}
+
+template <class T, class A, class U, class B>
+bool operator!=(const CountingAllocator<T, A>& lhs,
+                const CountingAllocator<U, B>& rhs) {
+  return !(lhs == rhs);
+}
+
 }  // namespace trace_event
 }  // namespace base
 
@@ -6,6 +6,10 @@
 
 #include <stdlib.h>
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "base/memory/ptr_util.h"
 #include "base/strings/string16.h"
 #include "build/build_config.h"
@@ -261,5 +265,37 @@ TEST(EstimateMemoryUsageTest, IsStandardContainerComplexIteratorTest) {
   static_assert(!internal::IsStandardContainerComplexIterator<abstract*>(), "");
 }
 
+TEST(EstimateMemoryUsageTest, IsNonAllocating) {
+  static_assert(internal::IsNonAllocating<int>::value, "");
+  static_assert(internal::IsNonAllocating<std::pair<const int, char*>>::value,
+                "");
+  static_assert(internal::IsNonAllocating<std::array<double, 4>>::value, "");
+  static_assert(!internal::IsNonAllocating<std::string>::value, "");
+  static_assert(!internal::IsNonAllocating<Data>::value, "");
+  static_assert(!internal::IsNonAllocating<std::pair<int, Data>>::value, "");
+}
+
+TEST(EstimateMemoryUsageTest, CountingAllocator) {
+  using Allocator = CountingAllocator<std::pair<const int, int>>;
+  AllocationCounter counter;
+  {
+    std::map<int, int, std::less<int>, Allocator> map{Allocator(&counter)};
+    for (int i = 0; i < 100; ++i)
+      map[i] = i;
+    EXPECT_LE(100 * sizeof(std::pair<const int, int>),
+              EstimateMemoryUsage(counter));
+
+    std::vector<int, CountingAllocator<int>> vector{
+        CountingAllocator<int>(&counter)};
+    const size_t map_usage = EstimateMemoryUsage(counter);
+    vector.reserve(10);
+    EXPECT_EQ(map_usage + 10 * sizeof(int), EstimateMemoryUsage(counter));
+
+    map.erase(map.begin(), map.end());
+    EXPECT_EQ(10 * sizeof(int), EstimateMemoryUsage(counter));
+  }
+  EXPECT_EQ(0u, EstimateMemoryUsage(counter));
+}
+
 }  // namespace trace_event
 }  // namespace base
@@ -0,0 +1,240 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/partition_alloc_dump_provider.h"
+
+#include <inttypes.h>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "base/allocator/partition_allocator/partition_alloc.h"
+#include "base/logging.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/strings/stringprintf.h"
+#include "base/trace_event/memory_allocator_dump.h"
+#include "base/trace_event/process_memory_dump.h"
+
+namespace base {
+namespace trace_event {
+
+namespace {
+
+constexpr char kPartitionsDumpName[] = "partition_alloc/partitions";
+
+// The names of the entries of the lifetime histograms.
+constexpr const char* kLifetimeNames[] = {
+    "lifetime_below_10us", "lifetime_below_100us", "lifetime_below_1ms",
+    "lifetime_below_10ms", "lifetime_below_100ms", "lifetime_below_1s",
+    "lifetime_below_10s",  "lifetime_10s_or_more",
+};
+static_assert(arraysize(kLifetimeNames) == kLifetimeHistogramNumBuckets,
+              "a name is needed for each lifetime");
+
+// Adds the sizes common to the partition and bucket dumps.
+void AddSizes(MemoryAllocatorDump* dump,
+              size_t resident_bytes,
+              size_t active_bytes) {
+  dump->AddScalar(MemoryAllocatorDump::kNameSize,
+                  MemoryAllocatorDump::kUnitsBytes, resident_bytes);
+  dump->AddScalar("allocated_objects_size", MemoryAllocatorDump::kUnitsBytes,
+                  active_bytes);
+  // Resident bytes which hold no allocation: free slots, and the end of slot
+  // spans which is too small for a slot.
+  dump->AddScalar("fragmented_size", MemoryAllocatorDump::kUnitsBytes,
+                  resident_bytes - std::min(resident_bytes, active_bytes));
+}
+
+// Returns the number of events per second over |elapsed| for a counter which
+// went from |last_count| to |count|.
+uint64_t PerSecond(uint64_t count, uint64_t last_count, TimeDelta elapsed) {
+  DCHECK_GE(count, last_count);
+  return static_cast<uint64_t>((count - last_count) / elapsed.InSecondsF());
+}
+
+}  // namespace
+
+// Turns the stats of a partition into allocator dumps.
+class PartitionAllocDumpProvider::StatsDumper : public PartitionStatsDumper {
+ public:
+  StatsDumper(Partition* partition,
+              const MemoryDumpArgs& args,
+              ProcessMemoryDump* pmd,
+              TimeTicks now)
+      : partition_(partition),
+        args_(args),
+        pmd_(pmd),
+        now_(now),
+        dump_name_(StringPrintf("%s/%s", kPartitionsDumpName,
+                                partition->name)) {}
+
+  // Saves the counts of the buckets for the next detailed dump.
+  ~StatsDumper() {
+    if (args_.level_of_detail != MemoryDumpLevelOfDetail::DETAILED)
+      return;
+    partition_->last_detailed_dump_time = now_;
+    partition_->last_bucket_counts.swap(bucket_counts_);
+  }
+
+  // PartitionStatsDumper implementation.
+  void PartitionDumpTotals(const char* partition_name,
+                           const PartitionMemoryStats* stats) override {
+    MemoryAllocatorDump* dump = pmd_->CreateAllocatorDump(dump_name_);
+    dump->AddScalar("virtual_size", MemoryAllocatorDump::kUnitsBytes,
+                    stats->total_mmapped_bytes);
+    AddSizes(dump, stats->total_resident_bytes, stats->total_active_bytes);
+
+    Counts counts;
+    counts.num_allocations = stats->total_num_allocations;
+    counts.num_frees = stats->total_num_frees;
+    AddCounts(dump, counts, partition_->last_counts,
+              partition_->last_dump_time);
+
+    if (args_.level_of_detail == MemoryDumpLevelOfDetail::BACKGROUND)
+      RecordHistograms(stats, counts);
+
+    partition_->last_dump_time = now_;
+    partition_->last_counts = counts;
+  }
+
+  void PartitionsDumpBucketStats(
+      const char* partition_name,
+      const PartitionBucketMemoryStats* stats) override {
+    // Direct mappings have no counts, and are part of the totals.
+    if (stats->is_direct_map)
+      return;
+    MemoryAllocatorDump* dump = pmd_->CreateAllocatorDump(
+        StringPrintf("%s/buckets/bucket_%" PRIu32, dump_name_.c_str(),
+                     stats->bucket_slot_size));
+    dump->AddScalar("slot_size", MemoryAllocatorDump::kUnitsBytes,
+                    stats->bucket_slot_size);
+    AddSizes(dump, stats->resident_bytes, stats->active_bytes);
+
+    Counts& counts = bucket_counts_[stats->bucket_slot_size];
+    counts.num_allocations = stats->num_allocations;
+    counts.num_frees = stats->num_frees;
+    auto last_counts = partition_->last_bucket_counts.find(
+        stats->bucket_slot_size);
+    AddCounts(dump, counts,
+              last_counts != partition_->last_bucket_counts.end()
+                  ? last_counts->second
+                  : Counts(),
+              partition_->last_detailed_dump_time);
+
+    for (size_t i = 0; i < kLifetimeHistogramNumBuckets; ++i) {
+      dump->AddScalar(kLifetimeNames[i], MemoryAllocatorDump::kUnitsObjects,
+                      stats->lifetime_histogram[i]);
+    }
+  }
+
+ private:
+  // Adds |counts| to |dump|, with their rates since |last_counts| were
+  // collected at |last_dump_time|, if there was such a dump.
+  void AddCounts(MemoryAllocatorDump* dump,
+                 const Counts& counts,
+                 const Counts& last_counts,
+                 TimeTicks last_dump_time) {
+    dump->AddScalar("num_allocations", MemoryAllocatorDump::kUnitsObjects,
+                    counts.num_allocations);
+    dump->AddScalar("num_frees", MemoryAllocatorDump::kUnitsObjects,
+                    counts.num_frees);
+    TimeDelta elapsed = now_ - last_dump_time;
+    if (last_dump_time.is_null() || elapsed <= TimeDelta())
+      return;
+    dump->AddScalar(
+        "allocations_per_second", MemoryAllocatorDump::kUnitsObjects,
+        PerSecond(counts.num_allocations, last_counts.num_allocations,
+                  elapsed));
+    dump->AddScalar(
+        "frees_per_second", MemoryAllocatorDump::kUnitsObjects,
+        PerSecond(counts.num_frees, last_counts.num_frees, elapsed));
+  }
+
+  void RecordHistograms(const PartitionMemoryStats* stats,
+                        const Counts& counts) {
+    const std::string suffix = std::string(".") + partition_->name;
+    if (stats->total_resident_bytes) {
+      UmaHistogramPercentage(
+          "Memory.PartitionAlloc.Fragmentation" + suffix,
+          static_cast<int>(100 -
+                           100 * std::min(stats->total_active_bytes,
+                                          stats->total_resident_bytes) /
+                               stats->total_resident_bytes));
+    }
+    TimeDelta elapsed = now_ - partition_->last_dump_time;
+    if (partition_->last_dump_time.is_null() || elapsed <= TimeDelta())
+      return;
+    uint64_t allocations_per_second =
+        PerSecond(counts.num_allocations,
+                  partition_->last_counts.num_allocations, elapsed);
+    UmaHistogramCounts1M(
+        "Memory.PartitionAlloc.AllocationsPerSecond" + suffix,
+        static_cast<int>(std::min<uint64_t>(
+            allocations_per_second, std::numeric_limits<int>::max())));
+  }
+
+  Partition* const partition_;
+  const MemoryDumpArgs args_;
+  ProcessMemoryDump* const pmd_;
+  const TimeTicks now_;
+  const std::string dump_name_;
+  std::map<uint32_t, Counts> bucket_counts_;
+
+  DISALLOW_COPY_AND_ASSIGN(StatsDumper);
+};
+
+PartitionAllocDumpProvider::Partition::Partition(const char* name,
+                                                 PartitionRootGeneric* root)
+    : name(name), root(root) {}
+
+PartitionAllocDumpProvider::Partition::~Partition() = default;
+
+// static
+PartitionAllocDumpProvider* PartitionAllocDumpProvider::GetInstance() {
+  return Singleton<PartitionAllocDumpProvider,
+                   LeakySingletonTraits<PartitionAllocDumpProvider>>::get();
+}
+
+PartitionAllocDumpProvider::PartitionAllocDumpProvider() = default;
+
+PartitionAllocDumpProvider::~PartitionAllocDumpProvider() = default;
+
+void PartitionAllocDumpProvider::RegisterPartition(
+    const char* name,
+    PartitionRootGeneric* root) {
+  AutoLock lock(lock_);
+  DCHECK(std::none_of(partitions_.begin(), partitions_.end(),
+                      [root](const std::unique_ptr<Partition>& partition) {
+                        return partition->root == root;
+                      }));
+  partitions_.push_back(std::make_unique<Partition>(name, root));
+}
+
+void PartitionAllocDumpProvider::UnregisterPartition(
+    PartitionRootGeneric* root) {
+  AutoLock lock(lock_);
+  auto it = std::find_if(partitions_.begin(), partitions_.end(),
+                         [root](const std::unique_ptr<Partition>& partition) {
+                           return partition->root == root;
+                         });
+  DCHECK(it != partitions_.end());
+  partitions_.erase(it);
+}
+
+bool PartitionAllocDumpProvider::OnMemoryDump(const MemoryDumpArgs& args,
+                                              ProcessMemoryDump* pmd) {
+  AutoLock lock(lock_);
+  TimeTicks now = TimeTicks::Now();
+  bool is_light_dump =
+      args.level_of_detail != MemoryDumpLevelOfDetail::DETAILED;
+  for (const std::unique_ptr<Partition>& partition : partitions_) {
+    StatsDumper dumper(partition.get(), args, pmd, now);
+    partition->root->DumpStats(partition->name, is_light_dump, &dumper);
+  }
+  return true;
+}
+
+}  // namespace trace_event
+}  // namespace base
@@ -0,0 +1,84 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TRACE_EVENT_PARTITION_ALLOC_DUMP_PROVIDER_H_
+#define BASE_TRACE_EVENT_PARTITION_ALLOC_DUMP_PROVIDER_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/singleton.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "base/trace_event/memory_dump_provider.h"
+
+namespace base {
+
+struct PartitionRootGeneric;
+
+namespace trace_event {
+
+// Dump provider which reports the memory usage and the allocation statistics
+// of the generic partitions registered with it, under
+// "partition_alloc/partitions/<name>". Detailed dumps also report each bucket,
+// with its lifetime histogram if the partition has lifetime sampling enabled.
+//
+// The allocation and free rates are averaged since the previous dump, or the
+// previous detailed dump for the buckets. The fragmentation and the rates of
+// each partition are also recorded in UMA histograms on background dumps.
+class BASE_EXPORT PartitionAllocDumpProvider : public MemoryDumpProvider {
+ public:
+  static PartitionAllocDumpProvider* GetInstance();
+
+  // Starts reporting |root| as |name|, which must be a string literal.
+  void RegisterPartition(const char* name, PartitionRootGeneric* root);
+
+  // Stops reporting |root|. Must be called before |root| is destroyed.
+  void UnregisterPartition(PartitionRootGeneric* root);
+
+  // MemoryDumpProvider implementation.
+  bool OnMemoryDump(const MemoryDumpArgs& args,
+                    ProcessMemoryDump* pmd) override;
+
+ private:
+  friend struct DefaultSingletonTraits<PartitionAllocDumpProvider>;
+  class StatsDumper;
+
+  struct Counts {
+    uint64_t num_allocations = 0;
+    uint64_t num_frees = 0;
+  };
+
+  struct Partition {
+    Partition(const char* name, PartitionRootGeneric* root);
+    ~Partition();
+
+    const char* const name;
+    PartitionRootGeneric* const root;
+
+    // The counts of the partition at the previous dump.
+    TimeTicks last_dump_time;
+    Counts last_counts;
+    // The counts of the buckets at the previous detailed dump, by slot size.
+    TimeTicks last_detailed_dump_time;
+    std::map<uint32_t, Counts> last_bucket_counts;
+  };
+
+  PartitionAllocDumpProvider();
+  ~PartitionAllocDumpProvider() override;
+
+  Lock lock_;
+  std::vector<std::unique_ptr<Partition>> partitions_;
+
+  DISALLOW_COPY_AND_ASSIGN(PartitionAllocDumpProvider);
+};
+
+}  // namespace trace_event
+}  // namespace base
+
+#endif  // BASE_TRACE_EVENT_PARTITION_ALLOC_DUMP_PROVIDER_H_
@@ -0,0 +1,113 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/partition_alloc_dump_provider.h"
+
+#include <string>
+
+#include "base/allocator/partition_allocator/partition_alloc.h"
+#include "base/threading/platform_thread.h"
+#include "base/trace_event/memory_allocator_dump.h"
+#include "base/trace_event/process_memory_dump.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+#if !defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
+
+namespace base {
+namespace trace_event {
+
+namespace {
+
+bool GetScalar(const MemoryAllocatorDump* dump,
+               const std::string& name,
+               uint64_t* value) {
+  for (const MemoryAllocatorDump::Entry& entry : dump->entries()) {
+    if (entry.name == name) {
+      *value = entry.value_uint64;
+      return true;
+    }
+  }
+  return false;
+}
+
+class PartitionAllocDumpProviderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    allocator_.init();
+    PartitionAllocDumpProvider::GetInstance()->RegisterPartition(
+        "test_partition", allocator_.root());
+  }
+
+  void TearDown() override {
+    PartitionAllocDumpProvider::GetInstance()->UnregisterPartition(
+        allocator_.root());
+  }
+
+  std::unique_ptr<ProcessMemoryDump> Dump() {
+    MemoryDumpArgs dump_args = {MemoryDumpLevelOfDetail::DETAILED};
+    std::unique_ptr<ProcessMemoryDump> pmd(
+        new ProcessMemoryDump(nullptr, dump_args));
+    PartitionAllocDumpProvider::GetInstance()->OnMemoryDump(dump_args,
+                                                            pmd.get());
+    return pmd;
+  }
+
+  PartitionRootGeneric* root() { return allocator_.root(); }
+
+ private:
+  PartitionAllocatorGeneric allocator_;
+};
+
+}  // namespace
+
+TEST_F(PartitionAllocDumpProviderTest, DumpsPartitionAndBuckets) {
+  void* ptr = root()->Alloc(1000, "");
+  std::unique_ptr<ProcessMemoryDump> pmd = Dump();
+
+  const MemoryAllocatorDump* partition_dump =
+      pmd->GetAllocatorDump("partition_alloc/partitions/test_partition");
+  ASSERT_TRUE(partition_dump);
+  uint64_t value = 0;
+  EXPECT_TRUE(GetScalar(partition_dump, "num_allocations", &value));
+  EXPECT_EQ(1u, value);
+  EXPECT_TRUE(GetScalar(partition_dump, "fragmented_size", &value));
+  EXPECT_GT(value, 0u);
+  // There is no previous dump to compute rates from.
+  EXPECT_FALSE(GetScalar(partition_dump, "allocations_per_second", &value));
+
+  size_t slot_size =
+      internal::PartitionCookieSizeAdjustAdd(root()->ActualSize(1000));
+  const MemoryAllocatorDump* bucket_dump = pmd->GetAllocatorDump(
+      "partition_alloc/partitions/test_partition/buckets/bucket_" +
+      std::to_string(slot_size));
+  ASSERT_TRUE(bucket_dump);
+  EXPECT_TRUE(GetScalar(bucket_dump, "num_allocations", &value));
+  EXPECT_EQ(1u, value);
+  EXPECT_TRUE(GetScalar(bucket_dump, "lifetime_below_10us", &value));
+
+  root()->Free(ptr);
+}
+
+TEST_F(PartitionAllocDumpProviderTest, DumpsRatesSincePreviousDump) {
+  Dump();
+  void* ptr = root()->Alloc(1000, "");
+  root()->Free(ptr);
+  // Makes sure that time passes between the dumps.
+  PlatformThread::Sleep(TimeDelta::FromMilliseconds(1));
+  std::unique_ptr<ProcessMemoryDump> pmd = Dump();
+
+  const MemoryAllocatorDump* partition_dump =
+      pmd->GetAllocatorDump("partition_alloc/partitions/test_partition");
+  ASSERT_TRUE(partition_dump);
+  uint64_t value = 0;
+  EXPECT_TRUE(GetScalar(partition_dump, "num_frees", &value));
+  EXPECT_EQ(1u, value);
+  EXPECT_TRUE(GetScalar(partition_dump, "allocations_per_second", &value));
+  EXPECT_TRUE(GetScalar(partition_dump, "frees_per_second", &value));
+}
+
+}  // namespace trace_event
+}  // namespace base
+
+#endif  // !defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
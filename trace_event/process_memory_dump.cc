@@ -40,6 +40,12 @@ namespace {
 
 const char kEdgeTypeOwnership[] = "ownership";
 
+bool IsSameAllocatorDump(const MemoryAllocatorDump& a,
+                         const MemoryAllocatorDump& b) {
+  return a.guid() == b.guid() && a.flags() == b.flags() &&
+         a.entries() == b.entries();
+}
+
 std::string GetSharedGlobalAllocatorDumpName(
     const MemoryAllocatorDumpGuid& guid) {
   return "global/" + guid.ToString();
@@ -328,8 +334,12 @@ void ProcessMemoryDump::DumpHeapUsage(
   // enabled when a process dump is in progress.
   if (heap_profiler_serialization_state() && !metrics_by_context.empty()) {
     DCHECK_EQ(0ul, heap_dumps_.count(allocator_name));
-    std::unique_ptr<TracedValue> heap_dump = ExportHeapDump(
-        metrics_by_context, *heap_profiler_serialization_state());
+    std::unique_ptr<TracedValue> heap_dump =
+        heap_profiler_serialization_state()->incremental_heap_dumps()
+            ? ExportHeapDumpIncrementally(metrics_by_context,
+                                          *heap_profiler_serialization_state())
+            : ExportHeapDump(metrics_by_context,
+                             *heap_profiler_serialization_state());
     heap_dumps_[allocator_name] = std::move(heap_dump);
   }
 
@@ -396,6 +406,48 @@ void ProcessMemoryDump::SerializeAllocatorDumpsInto(TracedValue* value) const {
     value->EndDictionary();
   }
 
+  SerializeAllocatorDumpsEdgesInto(value);
+}
+
+void ProcessMemoryDump::SerializeAllocatorDumpsInto(
+    TracedValue* value,
+    const ProcessMemoryDump& previous_dump) const {
+  // Both maps are sorted by name, so they are walked in a single pass.
+  std::vector<const MemoryAllocatorDump*> unchanged_dumps;
+  bool has_changed_dumps = false;
+  auto previous_it = previous_dump.allocator_dumps_.begin();
+  for (const auto& allocator_dump_it : allocator_dumps_) {
+    while (previous_it != previous_dump.allocator_dumps_.end() &&
+           previous_it->first < allocator_dump_it.first) {
+      ++previous_it;
+    }
+    if (previous_it != previous_dump.allocator_dumps_.end() &&
+        previous_it->first == allocator_dump_it.first &&
+        IsSameAllocatorDump(*previous_it->second, *allocator_dump_it.second)) {
+      unchanged_dumps.push_back(allocator_dump_it.second.get());
+      continue;
+    }
+    if (!has_changed_dumps) {
+      value->BeginDictionary("allocators");
+      has_changed_dumps = true;
+    }
+    allocator_dump_it.second->AsValueInto(value);
+  }
+  if (has_changed_dumps)
+    value->EndDictionary();
+
+  if (!unchanged_dumps.empty()) {
+    value->BeginArray("unchanged_allocators");
+    for (const MemoryAllocatorDump* dump : unchanged_dumps)
+      value->AppendString(dump->absolute_name());
+    value->EndArray();
+  }
+
+  SerializeAllocatorDumpsEdgesInto(value);
+}
+
+void ProcessMemoryDump::SerializeAllocatorDumpsEdgesInto(
+    TracedValue* value) const {
   value->BeginArray("allocators_graph");
   for (const auto& it : allocator_dumps_edges_) {
     const MemoryAllocatorDumpEdge& edge = it.second;
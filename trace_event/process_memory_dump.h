@@ -236,6 +236,14 @@ class BASE_EXPORT ProcessMemoryDump {
   // dumps.
   void SerializeAllocatorDumpsInto(TracedValue* value) const;
 
+  // Same as above, but only serializes the MemoryAllocatorDump(s) which are
+  // new or changed since |previous_dump|, for periodic dumps where most of
+  // them stay the same. The names of the unchanged dumps are listed under
+  // "unchanged_allocators", for the importer to carry them over. Edges are
+  // always serialized.
+  void SerializeAllocatorDumpsInto(TracedValue* value,
+                                   const ProcessMemoryDump& previous_dump) const;
+
   // Populate the traced value with information about the heap profiler.
   void SerializeHeapProfilerDumpsInto(TracedValue* value) const;
 
@@ -251,6 +259,8 @@ class BASE_EXPORT ProcessMemoryDump {
   MemoryAllocatorDump* AddAllocatorDumpInternal(
       std::unique_ptr<MemoryAllocatorDump> mad);
 
+  void SerializeAllocatorDumpsEdgesInto(TracedValue* value) const;
+
   // A per-process token, valid throughout all the lifetime of the current
   // process, used to disambiguate dumps with the same name generated in
   // different processes.
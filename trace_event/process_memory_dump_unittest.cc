@@ -6,6 +6,8 @@
 
 #include <stddef.h>
 
+#include <iterator>
+
 #include "base/memory/aligned_memory.h"
 #include "base/memory/ptr_util.h"
 #include "base/memory/shared_memory_tracker.h"
@@ -174,6 +176,49 @@ TEST(ProcessMemoryDumpTest, Clear) {
   pmd1.reset();
 }
 
+TEST(ProcessMemoryDumpTest, SerializeChangedAllocatorDumps) {
+  ProcessMemoryDump previous_pmd(nullptr, kDetailedDumpArgs);
+  previous_pmd.CreateAllocatorDump("unchanged")
+      ->AddScalar(MemoryAllocatorDump::kNameSize,
+                  MemoryAllocatorDump::kUnitsBytes, 1);
+  previous_pmd.CreateAllocatorDump("changed")
+      ->AddScalar(MemoryAllocatorDump::kNameSize,
+                  MemoryAllocatorDump::kUnitsBytes, 2);
+  previous_pmd.CreateAllocatorDump("removed");
+
+  ProcessMemoryDump pmd(nullptr, kDetailedDumpArgs);
+  pmd.CreateAllocatorDump("unchanged")
+      ->AddScalar(MemoryAllocatorDump::kNameSize,
+                  MemoryAllocatorDump::kUnitsBytes, 1);
+  pmd.CreateAllocatorDump("changed")
+      ->AddScalar(MemoryAllocatorDump::kNameSize,
+                  MemoryAllocatorDump::kUnitsBytes, 3);
+  pmd.CreateAllocatorDump("added");
+
+  auto traced_value = std::make_unique<TracedValue>();
+  pmd.SerializeAllocatorDumpsInto(traced_value.get(), previous_pmd);
+  std::unique_ptr<Value> value = traced_value->ToBaseValue();
+
+  const Value* allocators = value->FindKey("allocators");
+  ASSERT_TRUE(allocators);
+  EXPECT_EQ(2, std::distance(allocators->DictItems().begin(),
+                             allocators->DictItems().end()));
+  EXPECT_TRUE(allocators->FindKey("changed"));
+  EXPECT_TRUE(allocators->FindKey("added"));
+
+  const Value* unchanged_allocators = value->FindKey("unchanged_allocators");
+  ASSERT_TRUE(unchanged_allocators);
+  ASSERT_EQ(1u, unchanged_allocators->GetList().size());
+  EXPECT_EQ("unchanged", unchanged_allocators->GetList()[0].GetString());
+
+  // Nothing changed since the dump itself.
+  traced_value = std::make_unique<TracedValue>();
+  pmd.SerializeAllocatorDumpsInto(traced_value.get(), pmd);
+  value = traced_value->ToBaseValue();
+  EXPECT_FALSE(value->FindKey("allocators"));
+  EXPECT_EQ(3u, value->FindKey("unchanged_allocators")->GetList().size());
+}
+
 TEST(ProcessMemoryDumpTest, TakeAllDumpsFrom) {
   std::unique_ptr<TracedValue> traced_value(new TracedValue);
   std::unordered_map<AllocationContext, AllocationMetrics> metrics_by_context;
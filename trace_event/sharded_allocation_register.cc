@@ -4,23 +4,40 @@
 
 #include "base/trace_event/sharded_allocation_register.h"
 
+#include <stdint.h>
+
 #include "base/trace_event/trace_event_memory_overhead.h"
 #include "build/build_config.h"
 
 namespace base {
 namespace trace_event {
 
+namespace {
+
 // This number affects the bucket and capacity counts of AllocationRegister at
-// "base/trace_event/heap_profiler_allocation_register.h".
+// "base/trace_event/heap_profiler_allocation_register.h". The registers commit
+// their memory as they fill up, so more shards cost address space rather than
+// committed memory.
 #if defined(OS_ANDROID) || defined(OS_IOS)
-const size_t ShardCount = 1;
-#elif defined(OS_MACOSX)
-const size_t ShardCount = 64;
+const int kShardBits = 0;
 #else
-// Using ShardCount = 64 adds about 1.6GB of committed memory, which triggers
-// the sandbox's committed memory limit.
-const size_t ShardCount = 16;
+const int kShardBits = 6;
 #endif
+const size_t ShardCount = size_t{1} << kShardBits;
+
+// Returns the shard of |address|. AllocationRegister picks buckets from the low
+// bits of AddressHasher, so the shard comes from an independent hash: with the
+// same bits, the addresses of a shard would all land in 1/ShardCount of its
+// buckets, making for long chains to walk under the lock.
+size_t GetShardIndex(const void* address) {
+  // Fibonacci hashing, keeping the top |kShardBits| bits of the product.
+  const uint64_t hash = static_cast<uint64_t>(
+                            reinterpret_cast<uintptr_t>(address)) *
+                        UINT64_C(0x9E3779B97F4A7C15);
+  return static_cast<size_t>((hash >> 32) >> (32 - kShardBits));
+}
+
+}  // namespace
 
 ShardedAllocationRegister::ShardedAllocationRegister() : enabled_(false) {}
 
@@ -39,17 +56,13 @@ void ShardedAllocationRegister::SetDisabled() {
 bool ShardedAllocationRegister::Insert(const void* address,
                                        size_t size,
                                        const AllocationContext& context) {
-  AllocationRegister::AddressHasher hasher;
-  size_t index = hasher(address) % ShardCount;
-  RegisterAndLock& ral = allocation_registers_[index];
+  RegisterAndLock& ral = allocation_registers_[GetShardIndex(address)];
   AutoLock lock(ral.lock);
   return ral.allocation_register.Insert(address, size, context);
 }
 
 void ShardedAllocationRegister::Remove(const void* address) {
-  AllocationRegister::AddressHasher hasher;
-  size_t index = hasher(address) % ShardCount;
-  RegisterAndLock& ral = allocation_registers_[index];
+  RegisterAndLock& ral = allocation_registers_[GetShardIndex(address)];
   AutoLock lock(ral.lock);
   return ral.allocation_register.Remove(address);
 }
@@ -57,9 +70,7 @@ void ShardedAllocationRegister::Remove(const void* address) {
 bool ShardedAllocationRegister::Get(
     const void* address,
     AllocationRegister::Allocation* out_allocation) const {
-  AllocationRegister::AddressHasher hasher;
-  size_t index = hasher(address) % ShardCount;
-  RegisterAndLock& ral = allocation_registers_[index];
+  RegisterAndLock& ral = allocation_registers_[GetShardIndex(address)];
   AutoLock lock(ral.lock);
   return ral.allocation_register.Get(address, out_allocation);
 }
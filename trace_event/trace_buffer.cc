@@ -4,10 +4,14 @@
 
 #include "base/trace_event/trace_buffer.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
 
+#include "base/containers/circular_deque.h"
 #include "base/macros.h"
 #include "base/trace_event/heap_profiler.h"
 #include "base/trace_event/trace_event_impl.h"
@@ -17,6 +21,57 @@ namespace trace_event {
 
 namespace {
 
+// Encoding of the CompactedTraceBufferChunks.
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+uint64_t ReadVarint(const char** data) {
+  uint64_t value = 0;
+  for (int shift = 0;; shift += 7) {
+    const uint8_t byte = static_cast<uint8_t>(*(*data)++);
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return value;
+  }
+}
+
+// Zigzag-encodes |value| so that small negative values stay short.
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Appends |string|, which may be null.
+void AppendString(const char* string, std::string* out) {
+  if (!string) {
+    AppendVarint(0, out);
+    return;
+  }
+  const size_t length = strlen(string);
+  AppendVarint(length + 1, out);
+  out->append(string, length);
+}
+
+// Reads a string appended by AppendString() into |storage|, and returns it.
+const char* ReadString(const char** data, std::string* storage) {
+  const uint64_t length = ReadVarint(data);
+  if (!length)
+    return nullptr;
+  storage->assign(*data, length - 1);
+  *data += length - 1;
+  return storage->c_str();
+}
+
 class TraceBufferRingBuffer : public TraceBuffer {
  public:
   TraceBufferRingBuffer(size_t max_chunks)
@@ -103,6 +158,19 @@ class TraceBufferRingBuffer : public TraceBuffer {
     return nullptr;
   }
 
+  void ResetIteration() override { current_iteration_index_ = queue_head_; }
+
+  std::unique_ptr<TraceBufferChunk> TakeNextChunk() override {
+    while (current_iteration_index_ != queue_tail_) {
+      size_t chunk_index = recyclable_chunks_queue_[current_iteration_index_];
+      current_iteration_index_ = NextQueueIndex(current_iteration_index_);
+      // Skip uninitialized and taken chunks.
+      if (chunk_index < chunks_.size() && chunks_[chunk_index])
+        return std::move(chunks_[chunk_index]);
+    }
+    return nullptr;
+  }
+
   void EstimateTraceMemoryOverhead(
       TraceEventMemoryOverhead* overhead) override {
     overhead->Add(TraceEventMemoryOverhead::kTraceBuffer, sizeof(*this));
@@ -151,6 +219,202 @@ class TraceBufferRingBuffer : public TraceBuffer {
   DISALLOW_COPY_AND_ASSIGN(TraceBufferRingBuffer);
 };
 
+class TraceBufferCompactingRingBuffer : public TraceBuffer {
+ public:
+  explicit TraceBufferCompactingRingBuffer(size_t max_chunks)
+      : max_chunks_(max_chunks),
+        max_slots_(max_chunks * kMaxCompactionRatio),
+        max_memory_usage_(max_chunks * sizeof(TraceBufferChunk)) {
+    DCHECK_LE(max_slots_, TraceBufferChunk::kMaxChunkIndex + 1);
+  }
+
+  std::unique_ptr<TraceBufferChunk> GetChunk(size_t* index) override {
+    HEAP_PROFILER_SCOPED_IGNORE;
+
+    RecompactExpandedChunks();
+    current_iteration_index_ = 0;
+
+    // Recycle the oldest chunks until there is room for a new one.
+    std::unique_ptr<TraceBufferChunk> chunk;
+    while (!retired_slots_.empty() &&
+           (memory_usage_ + sizeof(TraceBufferChunk) > max_memory_usage_ ||
+            (free_slots_.empty() && slots_.size() >= max_slots_))) {
+      const size_t oldest = retired_slots_.front();
+      retired_slots_.pop_front();
+      Slot& slot = slots_[oldest];
+      memory_usage_ -= GetMemoryUsage(slot);
+      if (slot.chunk && !chunk)
+        chunk = std::move(slot.chunk);
+      slot.chunk.reset();
+      slot.compacted.reset();
+      free_slots_.push_back(oldest);
+    }
+
+    if (!free_slots_.empty()) {
+      *index = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      // Because the number of threads is much less than the number of slots,
+      // there is always one which isn't in flight.
+      DCHECK_LT(slots_.size(), max_slots_);
+      *index = slots_.size();
+      slots_.emplace_back();
+    }
+    memory_usage_ += sizeof(TraceBufferChunk);
+
+    if (chunk)
+      chunk->Reset(current_chunk_seq_++);
+    else
+      chunk.reset(new TraceBufferChunk(current_chunk_seq_++));
+    return chunk;
+  }
+
+  void ReturnChunk(size_t index,
+                   std::unique_ptr<TraceBufferChunk> chunk) override {
+    DCHECK(chunk);
+    DCHECK_LT(index, slots_.size());
+    Slot& slot = slots_[index];
+    DCHECK(!slot.chunk && !slot.compacted);
+    slot.chunk = std::move(chunk);
+    CompactIfFull(&slot);
+    retired_slots_.push_back(index);
+  }
+
+  bool IsFull() const override { return false; }
+
+  size_t Size() const override {
+    // The number of events which would use as much memory without compaction.
+    return memory_usage_ / sizeof(TraceBufferChunk) *
+           TraceBufferChunk::kTraceBufferChunkSize;
+  }
+
+  size_t Capacity() const override {
+    return max_chunks_ * TraceBufferChunk::kTraceBufferChunkSize;
+  }
+
+  TraceEvent* GetEventByHandle(TraceEventHandle handle) override {
+    if (handle.chunk_index >= slots_.size())
+      return nullptr;
+    Slot& slot = slots_[handle.chunk_index];
+    if (slot.compacted && slot.compacted->seq() == handle.chunk_seq) {
+      // The event is typically a complete event whose duration is being set:
+      // its chunk is compacted again by the next GetChunk().
+      Expand(&slot);
+      expanded_slots_.push_back(handle.chunk_index);
+    }
+    TraceBufferChunk* chunk = slot.chunk.get();
+    if (!chunk || chunk->seq() != handle.chunk_seq)
+      return nullptr;
+    return chunk->GetEventAt(handle.event_index);
+  }
+
+  const TraceBufferChunk* NextChunk() override {
+    // Only the chunk returned last is kept expanded.
+    RecompactExpandedChunks();
+    while (current_iteration_index_ < retired_slots_.size()) {
+      const size_t index = retired_slots_[current_iteration_index_++];
+      Slot& slot = slots_[index];
+      if (slot.compacted) {
+        Expand(&slot);
+        expanded_slots_.push_back(index);
+      }
+      if (slot.chunk)
+        return slot.chunk.get();
+    }
+    return nullptr;
+  }
+
+  void ResetIteration() override {
+    RecompactExpandedChunks();
+    current_iteration_index_ = 0;
+  }
+
+  std::unique_ptr<TraceBufferChunk> TakeNextChunk() override {
+    while (current_iteration_index_ < retired_slots_.size()) {
+      Slot& slot = slots_[retired_slots_[current_iteration_index_++]];
+      memory_usage_ -= GetMemoryUsage(slot);
+      // Skip taken chunks.
+      if (slot.compacted)
+        return CompactedTraceBufferChunk::Expand(std::move(slot.compacted));
+      if (slot.chunk)
+        return std::move(slot.chunk);
+    }
+    return nullptr;
+  }
+
+  void EstimateTraceMemoryOverhead(
+      TraceEventMemoryOverhead* overhead) override {
+    overhead->Add(TraceEventMemoryOverhead::kTraceBuffer,
+                  sizeof(*this) + slots_.capacity() * sizeof(Slot) +
+                      retired_slots_.capacity() * sizeof(size_t) +
+                      free_slots_.capacity() * sizeof(size_t));
+    for (size_t index : retired_slots_) {
+      Slot& slot = slots_[index];
+      if (slot.chunk)
+        slot.chunk->EstimateTraceMemoryOverhead(overhead);
+      else if (slot.compacted)
+        slot.compacted->EstimateTraceMemoryOverhead(overhead);
+    }
+  }
+
+ private:
+  // Holds a chunk which isn't in flight, compacted or not, or nothing.
+  struct Slot {
+    std::unique_ptr<TraceBufferChunk> chunk;
+    std::unique_ptr<CompactedTraceBufferChunk> compacted;
+  };
+
+  static size_t GetMemoryUsage(const Slot& slot) {
+    if (slot.compacted)
+      return slot.compacted->EstimateMemoryUsage();
+    return slot.chunk ? sizeof(TraceBufferChunk) : 0;
+  }
+
+  void CompactIfFull(Slot* slot) {
+    if (!slot->chunk || !slot->chunk->IsFull())
+      return;
+    memory_usage_ -= sizeof(TraceBufferChunk);
+    slot->compacted =
+        CompactedTraceBufferChunk::Compact(std::move(slot->chunk));
+    memory_usage_ += slot->compacted->EstimateMemoryUsage();
+  }
+
+  void Expand(Slot* slot) {
+    memory_usage_ -= slot->compacted->EstimateMemoryUsage();
+    slot->chunk = CompactedTraceBufferChunk::Expand(std::move(slot->compacted));
+    memory_usage_ += sizeof(TraceBufferChunk);
+  }
+
+  void RecompactExpandedChunks() {
+    // The slots may have been recycled since, in which case they don't hold a
+    // full chunk anymore, or hold a chunk compacted already.
+    for (size_t index : expanded_slots_)
+      CompactIfFull(&slots_[index]);
+    expanded_slots_.clear();
+  }
+
+  const size_t max_chunks_;
+  const size_t max_slots_;
+  const size_t max_memory_usage_;
+
+  // The memory used by the chunks, in flight or not.
+  size_t memory_usage_ = 0;
+
+  std::vector<Slot> slots_;
+  // The slots holding the chunks which aren't in flight, oldest first.
+  circular_deque<size_t> retired_slots_;
+  // The slots which were recycled and aren't in flight.
+  std::vector<size_t> free_slots_;
+  // The slots whose chunks were expanded to access their events.
+  std::vector<size_t> expanded_slots_;
+
+  // Position in |retired_slots_| of the next chunk of the iteration.
+  size_t current_iteration_index_ = 0;
+  uint32_t current_chunk_seq_ = 1;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceBufferCompactingRingBuffer);
+};
+
 class TraceBufferVector : public TraceBuffer {
  public:
   TraceBufferVector(size_t max_chunks)
@@ -215,6 +479,19 @@ class TraceBufferVector : public TraceBuffer {
     return nullptr;
   }
 
+  void ResetIteration() override { current_iteration_index_ = 0; }
+
+  std::unique_ptr<TraceBufferChunk> TakeNextChunk() override {
+    while (current_iteration_index_ < chunks_.size()) {
+      // Skip in-flight and taken chunks.
+      std::unique_ptr<TraceBufferChunk>& chunk =
+          chunks_[current_iteration_index_++];
+      if (chunk)
+        return std::move(chunk);
+    }
+    return nullptr;
+  }
+
   void EstimateTraceMemoryOverhead(
       TraceEventMemoryOverhead* overhead) override {
     const size_t chunks_ptr_vector_allocated_size =
@@ -300,6 +577,247 @@ void TraceBufferChunk::EstimateTraceMemoryOverhead(
   overhead->Update(*cached_overhead_estimate_);
 }
 
+CompactedTraceBufferChunk::CompactedTraceBufferChunk(uint32_t seq)
+    : seq_(seq) {}
+
+CompactedTraceBufferChunk::~CompactedTraceBufferChunk() = default;
+
+// Each event is encoded as:
+//   varint  zigzag(timestamp - previous timestamp)
+//   varint  zigzag(thread timestamp - previous thread timestamp)
+//   byte    phase
+//   varint  flags
+//   varint  zigzag(thread id)
+//   varint  id
+//   varint  bind id
+//   varint  zigzag(duration)           Only for complete events.
+//   varint  zigzag(thread duration)    Only for complete events with a thread
+//                                      timestamp.
+//   pointer category
+//   name    name
+//   name    scope
+//   byte    number of arguments
+//   And for each argument:
+//   name    name
+//   byte    type
+//   value   Depending on the type: a zigzag varint for integers, the 8 bytes
+//           of doubles, a pointer for strings, a string for copied strings,
+//           nothing for convertables, a varint otherwise.
+// Pointers are encoded as varints, 0 for null and the index in |pointers_| + 1
+// otherwise. Names are pointers, or strings with TRACE_EVENT_FLAG_COPY.
+// Strings are encoded as varints, 0 for null and their length + 1 otherwise,
+// followed by their characters.
+// static
+std::unique_ptr<CompactedTraceBufferChunk> CompactedTraceBufferChunk::Compact(
+    std::unique_ptr<TraceBufferChunk> chunk) {
+  std::unique_ptr<CompactedTraceBufferChunk> compacted(
+      new CompactedTraceBufferChunk(chunk->seq()));
+  std::string* data = &compacted->data_;
+  int64_t last_timestamp = 0;
+  int64_t last_thread_timestamp = 0;
+  for (size_t i = 0; i < chunk->size(); ++i) {
+    TraceEvent* event = chunk->GetEventAt(i);
+    const int64_t timestamp = event->timestamp().ToInternalValue();
+    AppendVarint(ZigZagEncode(timestamp - last_timestamp), data);
+    last_timestamp = timestamp;
+    const int64_t thread_timestamp = event->thread_timestamp().ToInternalValue();
+    AppendVarint(ZigZagEncode(thread_timestamp - last_thread_timestamp), data);
+    last_thread_timestamp = thread_timestamp;
+    data->push_back(event->phase());
+    AppendVarint(event->flags(), data);
+    AppendVarint(ZigZagEncode(event->thread_id()), data);
+    AppendVarint(event->id(), data);
+    AppendVarint(event->bind_id(), data);
+    if (event->phase() == TRACE_EVENT_PHASE_COMPLETE) {
+      AppendVarint(ZigZagEncode(event->duration().ToInternalValue()), data);
+      if (!event->thread_timestamp().is_null()) {
+        AppendVarint(ZigZagEncode(event->thread_duration().ToInternalValue()),
+                     data);
+      }
+    }
+    compacted->AppendPointer(event->category_group_enabled());
+
+    // The names are copied into the event with TRACE_EVENT_FLAG_COPY, see
+    // TraceEvent::Initialize().
+    const bool copy = event->flags() & TRACE_EVENT_FLAG_COPY;
+    auto append_name = [&](const char* name) {
+      if (copy)
+        AppendString(name, data);
+      else
+        compacted->AppendPointer(name);
+    };
+    append_name(event->name());
+    append_name(event->scope());
+
+    int num_args = 0;
+    while (num_args < kTraceMaxNumArgs && event->arg_name(num_args))
+      ++num_args;
+    data->push_back(static_cast<char>(num_args));
+    for (int arg = 0; arg < num_args; ++arg) {
+      append_name(event->arg_name(arg));
+      const unsigned char type = event->arg_type(arg);
+      data->push_back(static_cast<char>(type));
+      const TraceEvent::TraceValue value = event->arg_value(arg);
+      switch (type) {
+        case TRACE_VALUE_TYPE_INT:
+          AppendVarint(ZigZagEncode(value.as_int), data);
+          break;
+        case TRACE_VALUE_TYPE_DOUBLE: {
+          char bytes[sizeof(value.as_double)];
+          memcpy(bytes, &value.as_double, sizeof(bytes));
+          data->append(bytes, sizeof(bytes));
+          break;
+        }
+        case TRACE_VALUE_TYPE_STRING:
+          compacted->AppendPointer(value.as_string);
+          break;
+        case TRACE_VALUE_TYPE_COPY_STRING:
+          AppendString(value.as_string, data);
+          break;
+        case TRACE_VALUE_TYPE_CONVERTABLE:
+          compacted->convertables_.push_back(
+              event->TakeArgConvertableValue(arg));
+          break;
+        default:
+          // Booleans, unsigned integers and pointers.
+          AppendVarint(value.as_uint, data);
+          break;
+      }
+    }
+    ++compacted->size_;
+  }
+  data->shrink_to_fit();
+  compacted->pointers_.shrink_to_fit();
+  return compacted;
+}
+
+// static
+std::unique_ptr<TraceBufferChunk> CompactedTraceBufferChunk::Expand(
+    std::unique_ptr<CompactedTraceBufferChunk> compacted) {
+  std::unique_ptr<TraceBufferChunk> chunk(
+      new TraceBufferChunk(compacted->seq()));
+  const char* data = compacted->data_.data();
+  auto read_pointer = [&]() -> const void* {
+    const uint64_t reference = ReadVarint(&data);
+    return reference ? compacted->pointers_[reference - 1] : nullptr;
+  };
+  auto next_convertable = compacted->convertables_.begin();
+  int64_t timestamp = 0;
+  int64_t thread_timestamp = 0;
+  for (size_t i = 0; i < compacted->size(); ++i) {
+    timestamp += ZigZagDecode(ReadVarint(&data));
+    thread_timestamp += ZigZagDecode(ReadVarint(&data));
+    const char phase = *data++;
+    const unsigned int flags = static_cast<unsigned int>(ReadVarint(&data));
+    const int thread_id = static_cast<int>(ZigZagDecode(ReadVarint(&data)));
+    const unsigned long long id = ReadVarint(&data);
+    const unsigned long long bind_id = ReadVarint(&data);
+    int64_t duration = -1;
+    int64_t thread_duration = -1;
+    if (phase == TRACE_EVENT_PHASE_COMPLETE) {
+      duration = ZigZagDecode(ReadVarint(&data));
+      if (thread_timestamp)
+        thread_duration = ZigZagDecode(ReadVarint(&data));
+    }
+    const unsigned char* category_group_enabled =
+        static_cast<const unsigned char*>(read_pointer());
+
+    // Holds the strings until TraceEvent::Initialize() copies them.
+    std::string strings[2 + 2 * kTraceMaxNumArgs];
+    std::string* next_string = strings;
+    const bool copy = flags & TRACE_EVENT_FLAG_COPY;
+    auto read_name = [&]() {
+      return copy ? ReadString(&data, next_string++)
+                  : static_cast<const char*>(read_pointer());
+    };
+    const char* name = read_name();
+    const char* scope = read_name();
+
+    const int num_args = *data++;
+    const char* arg_names[kTraceMaxNumArgs];
+    unsigned char arg_types[kTraceMaxNumArgs];
+    unsigned long long arg_values[kTraceMaxNumArgs];
+    std::unique_ptr<ConvertableToTraceFormat> convertables[kTraceMaxNumArgs];
+    for (int arg = 0; arg < num_args; ++arg) {
+      arg_names[arg] = read_name();
+      arg_types[arg] = static_cast<unsigned char>(*data++);
+      arg_values[arg] = 0;
+      switch (arg_types[arg]) {
+        case TRACE_VALUE_TYPE_INT:
+          arg_values[arg] =
+              static_cast<unsigned long long>(ZigZagDecode(ReadVarint(&data)));
+          break;
+        case TRACE_VALUE_TYPE_DOUBLE:
+          static_assert(sizeof(double) == sizeof(unsigned long long),
+                        "Doubles are stored in the argument values.");
+          memcpy(&arg_values[arg], data, sizeof(double));
+          data += sizeof(double);
+          break;
+        case TRACE_VALUE_TYPE_STRING:
+          arg_values[arg] = reinterpret_cast<uintptr_t>(read_pointer());
+          break;
+        case TRACE_VALUE_TYPE_COPY_STRING:
+          arg_values[arg] = reinterpret_cast<uintptr_t>(
+              ReadString(&data, next_string++));
+          break;
+        case TRACE_VALUE_TYPE_CONVERTABLE:
+          convertables[arg] = std::move(*next_convertable++);
+          break;
+        default:
+          arg_values[arg] = ReadVarint(&data);
+          break;
+      }
+    }
+
+    size_t event_index;
+    TraceEvent* event = chunk->AddTraceEvent(&event_index);
+    event->Initialize(thread_id, TimeTicks::FromInternalValue(timestamp),
+                      ThreadTicks::FromInternalValue(thread_timestamp), phase,
+                      category_group_enabled, name, scope, id, bind_id,
+                      num_args, arg_names, arg_types, arg_values,
+                      convertables, flags);
+    if (duration != -1) {
+      event->UpdateDuration(
+          TimeTicks::FromInternalValue(timestamp + duration),
+          ThreadTicks::FromInternalValue(thread_timestamp + thread_duration));
+    }
+  }
+  DCHECK_EQ(compacted->data_.data() + compacted->data_.size(), data);
+  DCHECK(next_convertable == compacted->convertables_.end());
+  return chunk;
+}
+
+size_t CompactedTraceBufferChunk::EstimateMemoryUsage() const {
+  return sizeof(*this) + data_.capacity() +
+         pointers_.capacity() * sizeof(const void*) +
+         convertables_.capacity() *
+             sizeof(std::unique_ptr<ConvertableToTraceFormat>);
+}
+
+void CompactedTraceBufferChunk::EstimateTraceMemoryOverhead(
+    TraceEventMemoryOverhead* overhead) {
+  overhead->Add(TraceEventMemoryOverhead::kTraceBufferChunk,
+                EstimateMemoryUsage());
+  for (const auto& convertable : convertables_)
+    convertable->EstimateTraceMemoryOverhead(overhead);
+}
+
+void CompactedTraceBufferChunk::AppendPointer(const void* pointer) {
+  if (!pointer) {
+    AppendVarint(0, &data_);
+    return;
+  }
+  // The events of a chunk refer to few distinct pointers, mostly repeating
+  // recent ones.
+  auto it = std::find(pointers_.rbegin(), pointers_.rend(), pointer);
+  if (it == pointers_.rend()) {
+    pointers_.push_back(pointer);
+    AppendVarint(pointers_.size(), &data_);
+  } else {
+    AppendVarint(pointers_.rend() - it, &data_);
+  }
+}
+
 TraceResultBuffer::OutputCallback
 TraceResultBuffer::SimpleOutput::GetCallback() {
   return Bind(&SimpleOutput::Append, Unretained(this));
@@ -339,6 +857,11 @@ TraceBuffer* TraceBuffer::CreateTraceBufferRingBuffer(size_t max_chunks) {
   return new TraceBufferRingBuffer(max_chunks);
 }
 
+TraceBuffer* TraceBuffer::CreateTraceBufferCompactingRingBuffer(
+    size_t max_chunks) {
+  return new TraceBufferCompactingRingBuffer(max_chunks);
+}
+
 TraceBuffer* TraceBuffer::CreateTraceBufferVectorOfSize(size_t max_chunks) {
   return new TraceBufferVector(max_chunks);
 }
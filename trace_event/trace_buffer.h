@@ -8,7 +8,12 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "base/base_export.h"
+#include "base/macros.h"
 #include "base/trace_event/trace_event.h"
 #include "base/trace_event/trace_event_impl.h"
 
@@ -54,6 +59,49 @@ class BASE_EXPORT TraceBufferChunk {
   uint32_t seq_;
 };
 
+// A full TraceBufferChunk compacted into a byte string, which typically takes 5
+// to 10 times less memory, so that a ring buffer can retain more events. The
+// timestamps are delta-encoded and the integers varint-encoded. The pointers to
+// the categories, names and other strings which aren't copied into the events
+// are stored once per chunk, the copied strings inline. The
+// ConvertableToTraceFormat arguments are kept as objects.
+class BASE_EXPORT CompactedTraceBufferChunk {
+ public:
+  ~CompactedTraceBufferChunk();
+
+  // Moves the events of |chunk| into a compacted chunk.
+  static std::unique_ptr<CompactedTraceBufferChunk> Compact(
+      std::unique_ptr<TraceBufferChunk> chunk);
+
+  // Restores the events of |chunk|, with the same sequence number.
+  static std::unique_ptr<TraceBufferChunk> Expand(
+      std::unique_ptr<CompactedTraceBufferChunk> chunk);
+
+  uint32_t seq() const { return seq_; }
+  size_t size() const { return size_; }
+
+  // Returns the memory used by the chunk, excluding the convertables.
+  size_t EstimateMemoryUsage() const;
+
+  void EstimateTraceMemoryOverhead(TraceEventMemoryOverhead* overhead);
+
+ private:
+  explicit CompactedTraceBufferChunk(uint32_t seq);
+
+  // Appends to |data_| a reference to |pointer|, which outlives the chunk.
+  void AppendPointer(const void* pointer);
+
+  const uint32_t seq_;
+  size_t size_ = 0;
+  std::string data_;
+  // The pointers referred to by |data_|.
+  std::vector<const void*> pointers_;
+  // The convertable arguments of the events, in order.
+  std::vector<std::unique_ptr<ConvertableToTraceFormat>> convertables_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompactedTraceBufferChunk);
+};
+
 // TraceBuffer holds the events as they are collected.
 class BASE_EXPORT TraceBuffer {
  public:
@@ -68,9 +116,19 @@ class BASE_EXPORT TraceBuffer {
   virtual size_t Capacity() const = 0;
   virtual TraceEvent* GetEventByHandle(TraceEventHandle handle) = 0;
 
-  // For iteration. Each TraceBuffer can only be iterated once.
+  // For iteration. Each TraceBuffer can only be iterated once, unless the
+  // iteration is reset. The chunk returned may be invalidated by the next
+  // call.
   virtual const TraceBufferChunk* NextChunk() = 0;
 
+  // Makes NextChunk() start over from the first chunk which isn't in flight,
+  // so that the buffer can be iterated while it is still in use.
+  virtual void ResetIteration() = 0;
+
+  // Same as NextChunk(), except that the chunk is removed from the buffer, so
+  // that its memory can be freed as soon as it has been read. The buffer
+  // can't be used to add events afterwards, only to take the other chunks.
+  virtual std::unique_ptr<TraceBufferChunk> TakeNextChunk() = 0;
 
   // Computes an estimate of the size of the buffer, including all the retained
   // objects.
@@ -78,7 +136,17 @@ class BASE_EXPORT TraceBuffer {
       TraceEventMemoryOverhead* overhead) = 0;
 
   static TraceBuffer* CreateTraceBufferRingBuffer(size_t max_chunks);
+  // Same as CreateTraceBufferRingBuffer(), except that full chunks are
+  // compacted once returned (see CompactedTraceBufferChunk), and the oldest
+  // chunks are recycled when the buffer uses as much memory as |max_chunks|
+  // chunks which aren't compacted. Retains up to kMaxCompactionRatio times more
+  // events than CreateTraceBufferRingBuffer() for the same |max_chunks|.
+  static TraceBuffer* CreateTraceBufferCompactingRingBuffer(size_t max_chunks);
   static TraceBuffer* CreateTraceBufferVectorOfSize(size_t max_chunks);
+
+  // The maximum number of chunks a compacting ring buffer holds for each chunk
+  // of its memory budget.
+  static const size_t kMaxCompactionRatio = 8;
 };
 
 // TraceResultBuffer collects and converts trace fragments returned by TraceLog
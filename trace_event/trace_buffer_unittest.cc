@@ -0,0 +1,209 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/trace_buffer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/trace_event/trace_event.h"
+#include "base/trace_event/trace_event_argument.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace trace_event {
+
+namespace {
+
+const char kStaticString[] = "static";
+
+// Adds an event to |chunk| whose arguments and flags depend on |i|.
+void AddEvent(TraceBufferChunk* chunk, int i) {
+  const char* arg_names[kTraceMaxNumArgs] = {"a", "b"};
+  unsigned char arg_types[kTraceMaxNumArgs];
+  TraceEvent::TraceValue values[kTraceMaxNumArgs];
+  std::unique_ptr<ConvertableToTraceFormat> convertables[kTraceMaxNumArgs];
+  const std::string copied_string = "copied " + std::to_string(i);
+  char phase = TRACE_EVENT_PHASE_INSTANT;
+  unsigned int flags = TRACE_EVENT_FLAG_NONE;
+  unsigned long long id = trace_event_internal::kNoId;
+  ThreadTicks thread_timestamp;
+  switch (i % 4) {
+    case 0:
+      arg_types[0] = TRACE_VALUE_TYPE_INT;
+      values[0].as_int = -i;
+      arg_types[1] = TRACE_VALUE_TYPE_STRING;
+      values[1].as_string = kStaticString;
+      break;
+    case 1:
+      phase = TRACE_EVENT_PHASE_COMPLETE;
+      thread_timestamp = ThreadTicks() + TimeDelta::FromMicroseconds(i);
+      arg_types[0] = TRACE_VALUE_TYPE_DOUBLE;
+      values[0].as_double = i / 3.0;
+      arg_types[1] = TRACE_VALUE_TYPE_BOOL;
+      values[1].as_bool = true;
+      break;
+    case 2:
+      flags = TRACE_EVENT_FLAG_COPY | TRACE_EVENT_FLAG_HAS_ID;
+      id = 1000000 + i;
+      arg_types[0] = TRACE_VALUE_TYPE_COPY_STRING;
+      values[0].as_string = copied_string.c_str();
+      arg_types[1] = TRACE_VALUE_TYPE_UINT;
+      values[1].as_uint = 1ull << 40;
+      break;
+    case 3: {
+      std::unique_ptr<TracedValue> traced_value(new TracedValue());
+      traced_value->SetInteger("i", i);
+      arg_types[0] = TRACE_VALUE_TYPE_CONVERTABLE;
+      convertables[0] = std::move(traced_value);
+      arg_types[1] = TRACE_VALUE_TYPE_POINTER;
+      values[1].as_pointer = chunk;
+      break;
+    }
+  }
+  unsigned long long arg_values[kTraceMaxNumArgs];
+  for (int arg = 0; arg < kTraceMaxNumArgs; ++arg)
+    arg_values[arg] = values[arg].as_uint;
+
+  size_t event_index;
+  TraceEvent* event = chunk->AddTraceEvent(&event_index);
+  const TimeTicks timestamp =
+      TimeTicks() + TimeDelta::FromMicroseconds(1000 + 10 * i);
+  const std::string name = "event " + std::to_string(i % 3);
+  event->Initialize(
+      i % 2 ? 7 : 8, timestamp, thread_timestamp, phase,
+      TraceLog::GetCategoryGroupEnabled("cat"),
+      flags & TRACE_EVENT_FLAG_COPY ? name.c_str() : kStaticString,
+      trace_event_internal::kGlobalScope, id, trace_event_internal::kNoId,
+      kTraceMaxNumArgs, arg_names, arg_types, arg_values, convertables, flags);
+  if (phase == TRACE_EVENT_PHASE_COMPLETE) {
+    event->UpdateDuration(timestamp + TimeDelta::FromMicroseconds(i),
+                          thread_timestamp + TimeDelta::FromMicroseconds(1));
+  }
+}
+
+std::string ToJSON(const TraceBufferChunk& chunk) {
+  std::string json;
+  for (size_t i = 0; i < chunk.size(); ++i) {
+    chunk.GetEventAt(i)->AppendAsJSON(&json, ArgumentFilterPredicate());
+    json.append("\n");
+  }
+  return json;
+}
+
+// Fills a chunk of |buffer| with instant events, and returns its sequence
+// number.
+uint32_t AddFullChunk(TraceBuffer* buffer) {
+  size_t index;
+  std::unique_ptr<TraceBufferChunk> chunk = buffer->GetChunk(&index);
+  const uint32_t seq = chunk->seq();
+  for (size_t i = 0; i < TraceBufferChunk::kTraceBufferChunkSize; ++i)
+    AddEvent(chunk.get(), 0);
+  buffer->ReturnChunk(index, std::move(chunk));
+  return seq;
+}
+
+}  // namespace
+
+TEST(CompactedTraceBufferChunkTest, CompactAndExpand) {
+  const size_t chunk_size = TraceBufferChunk::kTraceBufferChunkSize;
+  std::unique_ptr<TraceBufferChunk> chunk(new TraceBufferChunk(42));
+  for (size_t i = 0; i < chunk_size; ++i)
+    AddEvent(chunk.get(), i);
+  const std::string expected_json = ToJSON(*chunk);
+
+  std::unique_ptr<CompactedTraceBufferChunk> compacted =
+      CompactedTraceBufferChunk::Compact(std::move(chunk));
+  EXPECT_EQ(42u, compacted->seq());
+  EXPECT_EQ(chunk_size, compacted->size());
+  EXPECT_LT(compacted->EstimateMemoryUsage() * 4, sizeof(TraceBufferChunk));
+
+  chunk = CompactedTraceBufferChunk::Expand(std::move(compacted));
+  EXPECT_EQ(42u, chunk->seq());
+  EXPECT_EQ(expected_json, ToJSON(*chunk));
+}
+
+TEST(TraceBufferCompactingRingBufferTest, RetainsMoreChunks) {
+  const size_t kMaxChunks = 4;
+  std::unique_ptr<TraceBuffer> buffer(
+      TraceBuffer::CreateTraceBufferCompactingRingBuffer(kMaxChunks));
+  uint32_t last_seq = 0;
+  for (int i = 0; i < 100; ++i) {
+    last_seq = AddFullChunk(buffer.get());
+    EXPECT_LE(buffer->Size(), buffer->Capacity());
+  }
+
+  // The chunks retained are the most recent ones.
+  std::vector<uint32_t> seqs;
+  while (std::unique_ptr<TraceBufferChunk> chunk = buffer->TakeNextChunk()) {
+    EXPECT_TRUE(chunk->IsFull());
+    seqs.push_back(chunk->seq());
+  }
+  // Compaction leaves room for several times as many chunks as the buffer
+  // would hold otherwise.
+  EXPECT_GT(seqs.size(), 2 * kMaxChunks);
+  EXPECT_LE(seqs.size(), kMaxChunks * TraceBuffer::kMaxCompactionRatio);
+  for (size_t i = 0; i < seqs.size(); ++i)
+    EXPECT_EQ(last_seq - seqs.size() + 1 + i, seqs[i]);
+}
+
+TEST(TraceBufferCompactingRingBufferTest, GetEventByHandleInCompactedChunk) {
+  std::unique_ptr<TraceBuffer> buffer(
+      TraceBuffer::CreateTraceBufferCompactingRingBuffer(4));
+  size_t index;
+  std::unique_ptr<TraceBufferChunk> chunk = buffer->GetChunk(&index);
+  TraceEventHandle handle;
+  handle.chunk_seq = chunk->seq();
+  handle.chunk_index = static_cast<unsigned>(index);
+  handle.event_index = 1;
+  for (size_t i = 0; i < TraceBufferChunk::kTraceBufferChunkSize; ++i)
+    AddEvent(chunk.get(), 1);
+  // The duration of the event is still to be set.
+  chunk->GetEventAt(1)->Reset();
+  buffer->ReturnChunk(index, std::move(chunk));
+
+  TraceEvent* event = buffer->GetEventByHandle(handle);
+  ASSERT_TRUE(event);
+  EXPECT_EQ(-1, event->duration().ToInternalValue());
+  event->UpdateDuration(event->timestamp() + TimeDelta::FromMicroseconds(5),
+                        event->thread_timestamp());
+
+  // Compacts the chunk again.
+  AddFullChunk(buffer.get());
+
+  chunk = buffer->TakeNextChunk();
+  ASSERT_TRUE(chunk);
+  EXPECT_EQ(handle.chunk_seq, chunk->seq());
+  EXPECT_EQ(5, chunk->GetEventAt(1)->duration().InMicroseconds());
+
+  // Handles with another sequence number don't find events.
+  handle.chunk_seq = 0;
+  EXPECT_FALSE(buffer->GetEventByHandle(handle));
+}
+
+// Iterating over the buffer without taking the chunks leaves them intact.
+TEST(TraceBufferCompactingRingBufferTest, NextChunk) {
+  std::unique_ptr<TraceBuffer> buffer(
+      TraceBuffer::CreateTraceBufferCompactingRingBuffer(4));
+  const uint32_t first_seq = AddFullChunk(buffer.get());
+  AddFullChunk(buffer.get());
+
+  for (int iteration = 0; iteration < 2; ++iteration) {
+    buffer->ResetIteration();
+    uint32_t seq = first_seq;
+    while (const TraceBufferChunk* chunk = buffer->NextChunk()) {
+      EXPECT_EQ(seq++, chunk->seq());
+      EXPECT_TRUE(chunk->IsFull());
+    }
+    EXPECT_EQ(first_seq + 2, seq);
+  }
+}
+
+}  // namespace trace_event
+}  // namespace base
@@ -26,7 +26,11 @@ struct TraceCategory {
     DEPRECATED_ENABLED_FOR_EVENT_CALLBACK = 1 << 2,
 
     ENABLED_FOR_ETW_EXPORT = 1 << 3,
-    ENABLED_FOR_FILTERING = 1 << 4
+    ENABLED_FOR_FILTERING = 1 << 4,
+
+    // Only set along with ENABLED_FOR_RECORDING, when only some of the events
+    // are recorded (see TraceConfig::CategorySamplingConfig).
+    ENABLED_FOR_SAMPLING = 1 << 5
   };
 
   static const TraceCategory* FromStatePtr(const uint8_t* state_ptr) {
@@ -77,9 +81,20 @@ struct TraceCategory {
     *const_cast<volatile uint32_t*>(&enabled_filters_) = enabled_filters;
   }
 
+  // The index of the sampler of the category, when ENABLED_FOR_SAMPLING is
+  // set.
+  uint8_t sampler_index() const {
+    return *const_cast<volatile const uint8_t*>(&sampler_index_);
+  }
+
+  void set_sampler_index(uint8_t sampler_index) {
+    *const_cast<volatile uint8_t*>(&sampler_index_) = sampler_index;
+  }
+
   void reset_for_testing() {
     set_state(0);
     set_enabled_filters(0);
+    set_sampler_index(0);
   }
 
   // These fields should not be accessed directly, not even by tracing code.
@@ -95,6 +110,10 @@ struct TraceCategory {
   // about missing some events.
   uint8_t state_;
 
+  // Set before ENABLED_FOR_SAMPLING, and kept afterwards so that it stays
+  // valid for the events racing with the state change.
+  uint8_t sampler_index_;
+
   // When ENABLED_FOR_FILTERING is set, this contains a bitmap to the
   // corresponding filter (see event_filters.h).
   uint32_t enabled_filters_;
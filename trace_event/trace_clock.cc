@@ -0,0 +1,154 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/trace_clock.h"
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "base/time/time_override.h"
+#include "build/build_config.h"
+
+#if (defined(OS_LINUX) || defined(OS_ANDROID)) && defined(ARCH_CPU_X86_FAMILY)
+#include <time.h>
+#include <x86intrin.h>
+
+#include "base/cpu.h"
+#include "base/logging.h"
+
+#define TSC_CLOCK_SUPPORTED 1
+#endif
+
+namespace base {
+namespace trace_event {
+
+#if defined(TSC_CLOCK_SUPPORTED)
+
+namespace {
+
+// The TSC frequency is measured over at least this long. Reading the TSC and
+// the monotonic clock together is precise to about 100 ns, so this keeps the
+// error of the frequency, and the drift of the clock, within a few ppm.
+constexpr int64_t kCalibrationNs = 50 * Time::kNanosecondsPerMicrosecond *
+                                   Time::kMicrosecondsPerMillisecond;
+
+// Maps the TSC to the monotonic clock (in nanoseconds) as
+// |ns_base| + (tsc - |tsc_base|) * |ns_per_tick|.
+struct TSCCalibration {
+  uint64_t tsc_base;
+  int64_t ns_base;
+  double ns_per_tick;
+};
+
+std::atomic<bool> g_tsc_enabled{false};
+
+// Published once the calibration is done, and never deleted.
+std::atomic<const TSCCalibration*> g_calibration{nullptr};
+
+// The readings the calibration started with. |g_initial_tsc| is 0 until
+// EnableTSC() is first called.
+std::atomic<uint64_t> g_initial_tsc{0};
+std::atomic<int64_t> g_initial_ns{0};
+
+int64_t MonotonicNowNs() {
+  struct timespec ts;
+  CHECK(clock_gettime(CLOCK_MONOTONIC, &ts) == 0);
+  return static_cast<int64_t>(ts.tv_sec) * Time::kNanosecondsPerSecond +
+         ts.tv_nsec;
+}
+
+// Reads the TSC and the monotonic clock at the same time, as far as possible.
+void ReadClocks(uint64_t* tsc, int64_t* ns) {
+  uint64_t tsc_before = __rdtsc();
+  *ns = MonotonicNowNs();
+  uint64_t tsc_after = __rdtsc();
+  *tsc = tsc_before + (tsc_after - tsc_before) / 2;
+}
+
+TimeTicks NsToTimeTicks(int64_t ns) {
+  // Truncates to microseconds like TimeTicks::Now() does.
+  return TimeTicks() +
+         TimeDelta::FromMicroseconds(ns / Time::kNanosecondsPerMicrosecond);
+}
+
+// Returns the time while the TSC isn't calibrated yet, and finishes the
+// calibration when enough time has passed.
+TimeTicks NowWhileCalibrating() {
+  uint64_t tsc;
+  int64_t ns;
+  ReadClocks(&tsc, &ns);
+  uint64_t initial_tsc = g_initial_tsc.load(std::memory_order_acquire);
+  int64_t initial_ns = g_initial_ns.load(std::memory_order_relaxed);
+  if (ns - initial_ns >= kCalibrationNs && tsc > initial_tsc) {
+    auto* calibration = new TSCCalibration{
+        tsc, ns, static_cast<double>(ns - initial_ns) / (tsc - initial_tsc)};
+    const TSCCalibration* expected = nullptr;
+    // Another thread may have finished the calibration first.
+    if (!g_calibration.compare_exchange_strong(expected, calibration,
+                                               std::memory_order_release)) {
+      delete calibration;
+    }
+  }
+  return NsToTimeTicks(ns);
+}
+
+}  // namespace
+
+// static
+TimeTicks TraceClock::Now() {
+  if (g_tsc_enabled.load(std::memory_order_relaxed)) {
+    const TSCCalibration* calibration =
+        g_calibration.load(std::memory_order_acquire);
+    if (!calibration)
+      return NowWhileCalibrating();
+    // The TSC of the CPUs is synchronized, but may be read slightly before
+    // the base on another CPU, hence the signed difference.
+    int64_t ticks = static_cast<int64_t>(__rdtsc() - calibration->tsc_base);
+    return NsToTimeTicks(calibration->ns_base +
+                         static_cast<int64_t>(ticks * calibration->ns_per_tick));
+  }
+  return subtle::TimeTicksNowIgnoringOverride();
+}
+
+// static
+bool TraceClock::EnableTSC() {
+  static const bool is_supported = CPU().has_non_stop_time_stamp_counter();
+  if (!is_supported)
+    return false;
+  if (!g_initial_tsc.load(std::memory_order_relaxed)) {
+    uint64_t tsc;
+    int64_t ns;
+    ReadClocks(&tsc, &ns);
+    g_initial_ns.store(ns, std::memory_order_relaxed);
+    g_initial_tsc.store(tsc, std::memory_order_release);
+  }
+  g_tsc_enabled.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+// static
+void TraceClock::DisableTSC() {
+  g_tsc_enabled.store(false, std::memory_order_relaxed);
+}
+
+#else  // defined(TSC_CLOCK_SUPPORTED)
+
+// static
+TimeTicks TraceClock::Now() {
+  return subtle::TimeTicksNowIgnoringOverride();
+}
+
+// static
+bool TraceClock::EnableTSC() {
+  return false;
+}
+
+// static
+void TraceClock::DisableTSC() {}
+
+#endif  // defined(TSC_CLOCK_SUPPORTED)
+
+}  // namespace trace_event
+}  // namespace base
@@ -0,0 +1,50 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TRACE_EVENT_TRACE_CLOCK_H_
+#define BASE_TRACE_EVENT_TRACE_CLOCK_H_
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace trace_event {
+
+// The clock of the timestamps of trace events. It is TimeTicks::Now(),
+// ignoring overrides, unless EnableTSC() switches it to reading the time stamp
+// counter of the CPU, which is several times cheaper than the clock_gettime()
+// call behind TimeTicks::Now() for the events which are recorded millions of
+// times.
+//
+// The TSC readings are converted to TimeTicks as they are made, so the
+// timestamps can still be compared with ones from TimeTicks::Now(), e.g. those
+// of TRACE_EVENT_*_WITH_TIMESTAMP macros or of other processes.
+class BASE_EXPORT TraceClock {
+ public:
+  // Returns the current time.
+  static TimeTicks Now();
+
+  // Starts using the TSC, if it is invariant (it ticks at a constant rate
+  // regardless of the power state of the CPU) and the platform is supported,
+  // i.e. x86 Linux or Android. Returns whether the TSC will be used.
+  //
+  // The TSC frequency is calibrated against TimeTicks the first time: Now()
+  // keeps calling TimeTicks::Now() for the first 50 ms after that, until the
+  // frequency is known precisely enough.
+  //
+  // EnableTSC() and DisableTSC() must not be called concurrently, unlike Now().
+  static bool EnableTSC();
+
+  // Goes back to using TimeTicks::Now().
+  static void DisableTSC();
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(TraceClock);
+};
+
+}  // namespace trace_event
+}  // namespace base
+
+#endif  // BASE_TRACE_EVENT_TRACE_CLOCK_H_
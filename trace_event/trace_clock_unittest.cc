@@ -0,0 +1,56 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/trace_clock.h"
+
+#include "base/threading/platform_thread.h"
+#include "base/time/time_override.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace trace_event {
+
+namespace {
+
+// Checks that TraceClock::Now() agrees with TimeTicks::Now().
+void ExpectNowIsTimeTicksNow() {
+  TimeTicks before = subtle::TimeTicksNowIgnoringOverride();
+  TimeTicks now = TraceClock::Now();
+  TimeTicks after = subtle::TimeTicksNowIgnoringOverride();
+  // Allow for the error of the TSC calibration.
+  EXPECT_LE(before - TimeDelta::FromMilliseconds(1), now);
+  EXPECT_GE(after + TimeDelta::FromMilliseconds(1), now);
+}
+
+}  // namespace
+
+TEST(TraceClockTest, Now) {
+  ExpectNowIsTimeTicksNow();
+}
+
+TEST(TraceClockTest, TSC) {
+  if (!TraceClock::EnableTSC())
+    return;
+
+  // The TSC is used once it is calibrated.
+  ExpectNowIsTimeTicksNow();
+  PlatformThread::Sleep(TimeDelta::FromMilliseconds(60));
+  for (int i = 0; i < 10; ++i) {
+    ExpectNowIsTimeTicksNow();
+    PlatformThread::Sleep(TimeDelta::FromMilliseconds(10));
+  }
+
+  TimeTicks last = TraceClock::Now();
+  for (int i = 0; i < 1000; ++i) {
+    TimeTicks now = TraceClock::Now();
+    EXPECT_LE(last, now);
+    last = now;
+  }
+
+  TraceClock::DisableTSC();
+  ExpectNowIsTimeTicksNow();
+}
+
+}  // namespace trace_event
+}  // namespace base
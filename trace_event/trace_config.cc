@@ -32,6 +32,7 @@ const char kEnableArgumentFilter[] = "enable-argument-filter";
 // String parameters that can be used to parse the trace config string.
 const char kRecordModeParam[] = "record_mode";
 const char kEnableSystraceParam[] = "enable_systrace";
+const char kEnableTSCClockParam[] = "enable_tsc_clock";
 const char kEnableArgumentFilterParam[] = "enable_argument_filter";
 
 // String parameters that is used to parse memory dump config in trace config
@@ -45,12 +46,18 @@ const char kTriggerTypeParam[] = "type";
 const char kPeriodicIntervalLegacyParam[] = "periodic_interval_ms";
 const char kHeapProfilerOptions[] = "heap_profiler_options";
 const char kBreakdownThresholdBytes[] = "breakdown_threshold_bytes";
+const char kIncrementalHeapDumps[] = "incremental";
 
 // String parameters used to parse category event filters.
 const char kEventFiltersParam[] = "event_filters";
 const char kFilterPredicateParam[] = "filter_predicate";
 const char kFilterArgsParam[] = "filter_args";
 
+// String parameters used to parse the category sampling configs.
+const char kCategorySamplingParam[] = "category_sampling";
+const char kSamplingRateParam[] = "sampling_rate";
+const char kMaxEventsPerSecondParam[] = "max_events_per_second";
+
 class ConvertableTraceConfigToTraceFormat
     : public base::trace_event::ConvertableToTraceFormat {
  public:
@@ -79,10 +86,12 @@ std::set<MemoryDumpLevelOfDetail> GetDefaultAllowedMemoryDumpModes() {
 }  // namespace
 
 TraceConfig::MemoryDumpConfig::HeapProfiler::HeapProfiler()
-    : breakdown_threshold_bytes(kDefaultBreakdownThresholdBytes) {}
+    : breakdown_threshold_bytes(kDefaultBreakdownThresholdBytes),
+      incremental(false) {}
 
 void TraceConfig::MemoryDumpConfig::HeapProfiler::Clear() {
   breakdown_threshold_bytes = kDefaultBreakdownThresholdBytes;
+  incremental = false;
 }
 
 void TraceConfig::ResetMemoryDumpConfig(
@@ -113,6 +122,7 @@ void TraceConfig::MemoryDumpConfig::Merge(
   heap_profiler_options.breakdown_threshold_bytes =
       std::min(heap_profiler_options.breakdown_threshold_bytes,
                config.heap_profiler_options.breakdown_threshold_bytes);
+  heap_profiler_options.incremental |= config.heap_profiler_options.incremental;
 }
 
 TraceConfig::EventFilterConfig::EventFilterConfig(
@@ -182,6 +192,13 @@ bool TraceConfig::EventFilterConfig::IsCategoryGroupEnabled(
   return category_filter_.IsCategoryGroupEnabled(category_group_name);
 }
 
+TraceConfig::CategorySamplingConfig::CategorySamplingConfig() = default;
+
+TraceConfig::CategorySamplingConfig::CategorySamplingConfig(
+    const CategorySamplingConfig& other) = default;
+
+TraceConfig::CategorySamplingConfig::~CategorySamplingConfig() = default;
+
 // static
 std::string TraceConfig::TraceRecordModeToStr(TraceRecordMode record_mode) {
   switch (record_mode) {
@@ -236,9 +253,11 @@ TraceConfig& TraceConfig::operator=(const TraceConfig& rhs) {
   record_mode_ = rhs.record_mode_;
   enable_systrace_ = rhs.enable_systrace_;
   enable_argument_filter_ = rhs.enable_argument_filter_;
+  enable_tsc_clock_ = rhs.enable_tsc_clock_;
   category_filter_ = rhs.category_filter_;
   memory_dump_config_ = rhs.memory_dump_config_;
   event_filters_ = rhs.event_filters_;
+  category_sampling_configs_ = rhs.category_sampling_configs_;
   return *this;
 }
 
@@ -268,7 +287,8 @@ bool TraceConfig::IsCategoryGroupEnabled(
 void TraceConfig::Merge(const TraceConfig& config) {
   if (record_mode_ != config.record_mode_
       || enable_systrace_ != config.enable_systrace_
-      || enable_argument_filter_ != config.enable_argument_filter_) {
+      || enable_argument_filter_ != config.enable_argument_filter_
+      || enable_tsc_clock_ != config.enable_tsc_clock_) {
     DLOG(ERROR) << "Attempting to merge trace config with a different "
                 << "set of options.";
   }
@@ -279,21 +299,28 @@ void TraceConfig::Merge(const TraceConfig& config) {
 
   event_filters_.insert(event_filters_.end(), config.event_filters().begin(),
                         config.event_filters().end());
+
+  category_sampling_configs_.insert(category_sampling_configs_.end(),
+                                    config.category_sampling_configs_.begin(),
+                                    config.category_sampling_configs_.end());
 }
 
 void TraceConfig::Clear() {
   record_mode_ = RECORD_UNTIL_FULL;
   enable_systrace_ = false;
   enable_argument_filter_ = false;
+  enable_tsc_clock_ = false;
   category_filter_.Clear();
   memory_dump_config_.Clear();
   event_filters_.clear();
+  category_sampling_configs_.clear();
 }
 
 void TraceConfig::InitializeDefault() {
   record_mode_ = RECORD_UNTIL_FULL;
   enable_systrace_ = false;
   enable_argument_filter_ = false;
+  enable_tsc_clock_ = false;
 }
 
 void TraceConfig::InitializeFromConfigDict(const DictionaryValue& dict) {
@@ -315,6 +342,7 @@ void TraceConfig::InitializeFromConfigDict(const DictionaryValue& dict) {
   enable_systrace_ = dict.GetBoolean(kEnableSystraceParam, &val) ? val : false;
   enable_argument_filter_ =
       dict.GetBoolean(kEnableArgumentFilterParam, &val) ? val : false;
+  enable_tsc_clock_ = dict.GetBoolean(kEnableTSCClockParam, &val) ? val : false;
 
   category_filter_.InitializeFromConfigDict(dict);
 
@@ -322,6 +350,10 @@ void TraceConfig::InitializeFromConfigDict(const DictionaryValue& dict) {
   if (dict.GetList(kEventFiltersParam, &category_event_filters))
     SetEventFiltersFromConfigList(*category_event_filters);
 
+  const base::ListValue* category_sampling_configs = nullptr;
+  if (dict.GetList(kCategorySamplingParam, &category_sampling_configs))
+    SetCategorySamplingConfigsFromConfigList(*category_sampling_configs);
+
   if (category_filter_.IsCategoryEnabled(MemoryDumpManager::kTraceCategory)) {
     // If dump triggers not set, the client is using the legacy with just
     // category enabled. So, use the default periodic dump config.
@@ -349,6 +381,7 @@ void TraceConfig::InitializeFromStrings(StringPiece category_filter_string,
   record_mode_ = RECORD_UNTIL_FULL;
   enable_systrace_ = false;
   enable_argument_filter_ = false;
+  enable_tsc_clock_ = false;
   if (!trace_options_string.empty()) {
     std::vector<std::string> split =
         SplitString(trace_options_string, ",", TRIM_WHITESPACE, SPLIT_WANT_ALL);
@@ -439,6 +472,9 @@ void TraceConfig::SetMemoryDumpConfigFromConfigDict(
       memory_dump_config_.heap_profiler_options.breakdown_threshold_bytes =
           MemoryDumpConfig::HeapProfiler::kDefaultBreakdownThresholdBytes;
     }
+    heap_profiler_options->GetBoolean(
+        kIncrementalHeapDumps,
+        &memory_dump_config_.heap_profiler_options.incremental);
   }
 }
 
@@ -469,12 +505,38 @@ void TraceConfig::SetEventFiltersFromConfigList(
   }
 }
 
+void TraceConfig::SetCategorySamplingConfigsFromConfigList(
+    const base::ListValue& category_sampling_configs) {
+  category_sampling_configs_.clear();
+
+  for (const Value& value : category_sampling_configs.GetList()) {
+    const DictionaryValue* dict = nullptr;
+    if (!value.GetAsDictionary(&dict))
+      continue;
+
+    CategorySamplingConfig config;
+    config.category_filter.InitializeFromConfigDict(*dict);
+    dict->GetDouble(kSamplingRateParam, &config.sampling_rate);
+    int max_events_per_second = 0;
+    if (dict->GetInteger(kMaxEventsPerSecondParam, &max_events_per_second) &&
+        max_events_per_second > 0) {
+      config.max_events_per_second =
+          static_cast<uint32_t>(max_events_per_second);
+    }
+    category_sampling_configs_.push_back(config);
+  }
+}
+
 std::unique_ptr<DictionaryValue> TraceConfig::ToDict() const {
   auto dict = std::make_unique<DictionaryValue>();
   dict->SetString(kRecordModeParam,
                   TraceConfig::TraceRecordModeToStr(record_mode_));
   dict->SetBoolean(kEnableSystraceParam, enable_systrace_);
   dict->SetBoolean(kEnableArgumentFilterParam, enable_argument_filter_);
+  // Only written when set, for the configs to read the same as before the
+  // option existed.
+  if (enable_tsc_clock_)
+    dict->SetBoolean(kEnableTSCClockParam, true);
 
   category_filter_.ToDict(dict.get());
 
@@ -489,6 +551,22 @@ std::unique_ptr<DictionaryValue> TraceConfig::ToDict() const {
     dict->Set(kEventFiltersParam, std::move(filter_list));
   }
 
+  if (!category_sampling_configs_.empty()) {
+    auto sampling_list = std::make_unique<ListValue>();
+    for (const CategorySamplingConfig& config : category_sampling_configs_) {
+      auto sampling_dict = std::make_unique<DictionaryValue>();
+      config.category_filter.ToDict(sampling_dict.get());
+      sampling_dict->SetDouble(kSamplingRateParam, config.sampling_rate);
+      if (config.max_events_per_second) {
+        sampling_dict->SetInteger(
+            kMaxEventsPerSecondParam,
+            static_cast<int>(config.max_events_per_second));
+      }
+      sampling_list->Append(std::move(sampling_dict));
+    }
+    dict->Set(kCategorySamplingParam, std::move(sampling_list));
+  }
+
   if (category_filter_.IsCategoryEnabled(MemoryDumpManager::kTraceCategory)) {
     auto allowed_modes = std::make_unique<ListValue>();
     for (auto dump_mode : memory_dump_config_.allowed_dump_modes)
@@ -515,12 +593,16 @@ std::unique_ptr<DictionaryValue> TraceConfig::ToDict() const {
     // the periodic dumps are not enabled.
     memory_dump_config->Set(kTriggersParam, std::move(triggers_list));
 
-    if (memory_dump_config_.heap_profiler_options.breakdown_threshold_bytes !=
-        MemoryDumpConfig::HeapProfiler::kDefaultBreakdownThresholdBytes) {
+    const MemoryDumpConfig::HeapProfiler& heap_profiler_options =
+        memory_dump_config_.heap_profiler_options;
+    if (heap_profiler_options.breakdown_threshold_bytes !=
+            MemoryDumpConfig::HeapProfiler::kDefaultBreakdownThresholdBytes ||
+        heap_profiler_options.incremental) {
       auto options = std::make_unique<DictionaryValue>();
-      options->SetInteger(
-          kBreakdownThresholdBytes,
-          memory_dump_config_.heap_profiler_options.breakdown_threshold_bytes);
+      options->SetInteger(kBreakdownThresholdBytes,
+                          heap_profiler_options.breakdown_threshold_bytes);
+      if (heap_profiler_options.incremental)
+        options->SetBoolean(kIncrementalHeapDumps, true);
       memory_dump_config->Set(kHeapProfilerOptions, std::move(options));
     }
     dict->Set(kMemoryDumpConfigParam, std::move(memory_dump_config));
@@ -72,6 +72,10 @@ class BASE_EXPORT TraceConfig {
       void Clear();
 
       uint32_t breakdown_threshold_bytes;
+
+      // Whether each heap dump is written in one pass with the stack frames
+      // new since the previous dump, rather than broken down.
+      bool incremental;
     };
 
     // Reset the values in the config.
@@ -120,6 +124,29 @@ class BASE_EXPORT TraceConfig {
   };
   typedef std::vector<EventFilterConfig> EventFilters;
 
+  // Limits the events recorded in the categories of |category_filter|, so that
+  // categories with many events can be recorded without flooding the trace
+  // buffer. The first config which applies to a category group is used, and
+  // the rate limit is shared by the groups using the same config. Applies to
+  // each event independently, so the events of a category
+  // group should all be complete (TRACE_EVENT*) or instant, rather than
+  // begin/end pairs.
+  struct BASE_EXPORT CategorySamplingConfig {
+    CategorySamplingConfig();
+    CategorySamplingConfig(const CategorySamplingConfig& other);
+    ~CategorySamplingConfig();
+
+    TraceConfigCategoryFilter category_filter;
+
+    // The probability of each event to be recorded.
+    double sampling_rate = 1;
+
+    // The maximum number of events recorded per second, or 0 if unlimited.
+    // Up to a second of events can be recorded at once.
+    uint32_t max_events_per_second = 0;
+  };
+  using CategorySamplingConfigs = std::vector<CategorySamplingConfig>;
+
   static std::string TraceRecordModeToStr(TraceRecordMode record_mode);
 
   TraceConfig();
@@ -171,10 +198,18 @@ class BASE_EXPORT TraceConfig {
   //     "record_mode": "record-continuously",
   //     "enable_systrace": true,
   //     "enable_argument_filter": true,
+  //     "enable_tsc_clock": true,
   //     "included_categories": ["included",
   //                             "inc_pattern*",
   //                             "disabled-by-default-memory-infra"],
   //     "excluded_categories": ["excluded", "exc_pattern*"],
+  //     "category_sampling": [
+  //       {
+  //         "included_categories": ["high_frequency*"],
+  //         "sampling_rate": 0.01,
+  //         "max_events_per_second": 100
+  //       }
+  //     ],
   //     "memory_dump_config": {
   //       "triggers": [
   //         {
@@ -202,10 +237,14 @@ class BASE_EXPORT TraceConfig {
   TraceRecordMode GetTraceRecordMode() const { return record_mode_; }
   bool IsSystraceEnabled() const { return enable_systrace_; }
   bool IsArgumentFilterEnabled() const { return enable_argument_filter_; }
+  // Whether the events are timestamped with the TSC where possible, see
+  // TraceClock::EnableTSC().
+  bool IsTSCClockEnabled() const { return enable_tsc_clock_; }
 
   void SetTraceRecordMode(TraceRecordMode mode) { record_mode_ = mode; }
   void EnableSystrace() { enable_systrace_ = true; }
   void EnableArgumentFilter() { enable_argument_filter_ = true; }
+  void EnableTSCClock() { enable_tsc_clock_ = true; }
 
   // Writes the string representation of the TraceConfig. The string is JSON
   // formatted.
@@ -243,6 +282,13 @@ class BASE_EXPORT TraceConfig {
     event_filters_ = filter_configs;
   }
 
+  const CategorySamplingConfigs& category_sampling_configs() const {
+    return category_sampling_configs_;
+  }
+  void SetCategorySamplingConfigs(const CategorySamplingConfigs& configs) {
+    category_sampling_configs_ = configs;
+  }
+
  private:
   FRIEND_TEST_ALL_PREFIXES(TraceConfigTest, TraceConfigFromValidLegacyFormat);
   FRIEND_TEST_ALL_PREFIXES(TraceConfigTest,
@@ -268,6 +314,8 @@ class BASE_EXPORT TraceConfig {
   void SetDefaultMemoryDumpConfig();
 
   void SetEventFiltersFromConfigList(const base::ListValue& event_filters);
+  void SetCategorySamplingConfigsFromConfigList(
+      const base::ListValue& category_sampling_configs);
   std::unique_ptr<DictionaryValue> ToDict() const;
 
   std::string ToTraceOptionsString() const;
@@ -275,12 +323,15 @@ class BASE_EXPORT TraceConfig {
   TraceRecordMode record_mode_;
   bool enable_systrace_ : 1;
   bool enable_argument_filter_ : 1;
+  bool enable_tsc_clock_ : 1;
 
   TraceConfigCategoryFilter category_filter_;
 
   MemoryDumpConfig memory_dump_config_;
 
   EventFilters event_filters_;
+
+  CategorySamplingConfigs category_sampling_configs_;
 };
 
 }  // namespace trace_event
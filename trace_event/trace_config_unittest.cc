@@ -539,6 +539,65 @@ TEST(TraceConfigTest, MergingTraceConfigs) {
                tc.ToString().c_str());
 }
 
+TEST(TraceConfigTest, TSCClock) {
+  TraceConfig tc("{\"enable_tsc_clock\":true}");
+  EXPECT_TRUE(tc.IsTSCClockEnabled());
+  EXPECT_TRUE(TraceConfig(tc.ToString()).IsTSCClockEnabled());
+
+  // The option is only written when set.
+  TraceConfig default_tc;
+  EXPECT_FALSE(default_tc.IsTSCClockEnabled());
+  EXPECT_EQ(std::string::npos, default_tc.ToString().find("enable_tsc_clock"));
+
+  tc.Clear();
+  EXPECT_FALSE(tc.IsTSCClockEnabled());
+}
+
+TEST(TraceConfigTest, CategorySamplingConfigs) {
+  const char config_string[] =
+      "{"
+      "\"category_sampling\":["
+      "{"
+      "\"included_categories\":[\"high_frequency*\"],"
+      "\"max_events_per_second\":100,"
+      "\"sampling_rate\":0.01"
+      "},"
+      "{"
+      "\"included_categories\":[\"cc\"],"
+      "\"sampling_rate\":0.5"
+      "}"
+      "],"
+      "\"enable_argument_filter\":false,"
+      "\"enable_systrace\":false,"
+      "\"included_categories\":[\"*\"],"
+      "\"record_mode\":\"record-continuously\""
+      "}";
+  TraceConfig tc(config_string);
+  EXPECT_STREQ(config_string, tc.ToString().c_str());
+
+  ASSERT_EQ(2u, tc.category_sampling_configs().size());
+  const TraceConfig::CategorySamplingConfig& config =
+      tc.category_sampling_configs()[0];
+  EXPECT_TRUE(config.category_filter.IsCategoryGroupEnabled("high_frequency"));
+  EXPECT_FALSE(config.category_filter.IsCategoryGroupEnabled("cc"));
+  EXPECT_DOUBLE_EQ(0.01, config.sampling_rate);
+  EXPECT_EQ(100u, config.max_events_per_second);
+  const TraceConfig::CategorySamplingConfig& other_config =
+      tc.category_sampling_configs()[1];
+  EXPECT_DOUBLE_EQ(0.5, other_config.sampling_rate);
+  EXPECT_EQ(0u, other_config.max_events_per_second);
+
+  // The configs are kept in order when merging.
+  TraceConfig tc2("{\"category_sampling\":[{\"included_categories\":"
+                  "[\"other\"],\"sampling_rate\":0.1}]}");
+  tc.Merge(tc2);
+  ASSERT_EQ(3u, tc.category_sampling_configs().size());
+  EXPECT_DOUBLE_EQ(0.1, tc.category_sampling_configs()[2].sampling_rate);
+
+  tc.Clear();
+  EXPECT_TRUE(tc.category_sampling_configs().empty());
+}
+
 TEST(TraceConfigTest, IsCategoryGroupEnabled) {
   // Enabling a disabled- category does not require all categories to be traced
   // to be included.
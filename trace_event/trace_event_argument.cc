@@ -5,6 +5,7 @@
 #include "base/trace_event/trace_event_argument.h"
 
 #include <stdint.h>
+#include <string.h>
 
 #include <utility>
 
@@ -69,6 +70,180 @@ std::string ReadKeyName(PickleIterator& pickle_iterator) {
   DCHECK(res);
   return key_name;
 }
+
+// Same as ReadKeyName(), without copying the name.
+StringPiece ReadKeyNamePiece(PickleIterator& pickle_iterator) {
+  const char* type = nullptr;
+  bool res = pickle_iterator.ReadBytes(&type, 1);
+  StringPiece key_name;
+  if (res && *type == kTypeCStr) {
+    uint64_t ptr_value = 0;
+    res = pickle_iterator.ReadUInt64(&ptr_value);
+    key_name = reinterpret_cast<const char*>(static_cast<uintptr_t>(ptr_value));
+  } else if (res && *type == kTypeString) {
+    res = pickle_iterator.ReadStringPiece(&key_name);
+  }
+  DCHECK(res);
+  return key_name;
+}
+
+// Field numbers of the messages of the binary format, see
+// TraceEventBinaryWriter. All of them fit in a single byte tag.
+enum BinaryFormatField {
+  kDictEntry = 1,
+  kArrayValue = 1,
+  kValueKey = 1,
+  kValueBool = 2,
+  kValueInt = 3,
+  kValueDouble = 4,
+  kValueString = 5,
+  kValueDict = 6,
+  kValueArray = 7,
+};
+
+enum WireType {
+  kVarint = 0,
+  kFixed64 = 1,
+  kLengthDelimited = 2,
+};
+
+// An entry of a dictionary or an array, as read from the pickle. Containers
+// are read up to their contents.
+struct BinaryEntry {
+  char type;
+  bool has_key;
+  StringPiece key;
+  union {
+    bool as_bool;
+    int as_int;
+    double as_double;
+  };
+  StringPiece as_string;
+};
+
+void ReadBinaryEntry(char type,
+                     bool in_dict,
+                     PickleIterator* it,
+                     BinaryEntry* entry) {
+  entry->type = type;
+  switch (type) {
+    case kTypeBool:
+      CHECK(it->ReadBool(&entry->as_bool));
+      break;
+    case kTypeInt:
+      CHECK(it->ReadInt(&entry->as_int));
+      break;
+    case kTypeDouble:
+      CHECK(it->ReadDouble(&entry->as_double));
+      break;
+    case kTypeString:
+      CHECK(it->ReadStringPiece(&entry->as_string));
+      break;
+    case kTypeStartDict:
+    case kTypeStartArray:
+      break;
+    default:
+      NOTREACHED();
+  }
+  entry->has_key = in_dict;
+  if (in_dict)
+    entry->key = ReadKeyNamePiece(*it);
+}
+
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+size_t VarintSize(uint64_t value) {
+  size_t size = 1;
+  for (; value >= 0x80; value >>= 7)
+    ++size;
+  return size;
+}
+
+size_t LengthDelimitedFieldSize(size_t size) {
+  return 1 + VarintSize(size) + size;
+}
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void AppendTag(int field, WireType wire_type, std::string* out) {
+  out->push_back(static_cast<char>((field << 3) | wire_type));
+}
+
+void AppendLengthDelimitedField(int field,
+                                StringPiece value,
+                                std::string* out) {
+  AppendTag(field, kLengthDelimited, out);
+  AppendVarint(value.size(), out);
+  value.AppendToString(out);
+}
+
+// Returns the size of the Value message of |entry|, whose contents take
+// |content_size| bytes if it is a container.
+size_t GetValueSize(const BinaryEntry& entry, size_t content_size) {
+  size_t size = entry.has_key ? LengthDelimitedFieldSize(entry.key.size()) : 0;
+  switch (entry.type) {
+    case kTypeBool:
+      return size + 2;
+    case kTypeInt:
+      return size + 1 + VarintSize(ZigZagEncode(entry.as_int));
+    case kTypeDouble:
+      return size + 1 + sizeof(double);
+    case kTypeString:
+      return size + LengthDelimitedFieldSize(entry.as_string.size());
+    default:
+      return size + LengthDelimitedFieldSize(content_size);
+  }
+}
+
+// Appends |entry| to the Dict or Array containing it. The contents of a
+// container, of size |content_size|, are appended afterwards.
+void AppendBinaryEntry(const BinaryEntry& entry,
+                       size_t content_size,
+                       std::string* out) {
+  // Dict entries and Array values have the same field number.
+  AppendTag(kDictEntry, kLengthDelimited, out);
+  AppendVarint(GetValueSize(entry, content_size), out);
+  if (entry.has_key)
+    AppendLengthDelimitedField(kValueKey, entry.key, out);
+  switch (entry.type) {
+    case kTypeBool:
+      AppendTag(kValueBool, kVarint, out);
+      AppendVarint(entry.as_bool, out);
+      break;
+    case kTypeInt:
+      AppendTag(kValueInt, kVarint, out);
+      AppendVarint(ZigZagEncode(entry.as_int), out);
+      break;
+    case kTypeDouble: {
+      AppendTag(kValueDouble, kFixed64, out);
+      uint64_t bits;
+      memcpy(&bits, &entry.as_double, sizeof(bits));
+      // The encoding is little-endian.
+      for (size_t i = 0; i < sizeof(bits); ++i, bits >>= 8)
+        out->push_back(static_cast<char>(bits & 0xFF));
+      break;
+    }
+    case kTypeString:
+      AppendLengthDelimitedField(kValueString, entry.as_string, out);
+      break;
+    case kTypeStartDict:
+    case kTypeStartArray:
+      AppendTag(entry.type == kTypeStartDict ? kValueDict : kValueArray,
+                kLengthDelimited, out);
+      AppendVarint(content_size, out);
+      break;
+  }
+}
+
 }  // namespace
 
 TracedValue::TracedValue() : TracedValue(0) {
@@ -563,6 +738,80 @@ void TracedValue::AppendAsTraceFormat(std::string* out) const {
   DCHECK(state_stack.empty());
 }
 
+bool TracedValue::AppendAsBinaryFormat(std::string* out) const {
+  DCHECK_CURRENT_CONTAINER_IS(kStackTypeDict);
+  DCHECK_CONTAINER_STACK_DEPTH_EQ(1u);
+
+  // Messages are preceded by their size, so the sizes of the containers are
+  // computed in a first pass over the pickle, and the output is written in a
+  // second one.
+  std::vector<size_t> container_sizes;
+  size_t size = ComputeBinaryFormatSizes(&container_sizes);
+  size_t end = out->size() + size;
+  out->reserve(end);
+
+  // Whether each enclosing container is a dictionary, innermost last.
+  std::vector<bool> in_dict(1, true);
+  size_t container_index = 1;
+  PickleIterator it(pickle_);
+  for (const char* type; it.ReadBytes(&type, 1);) {
+    if (*type == kTypeEndDict || *type == kTypeEndArray) {
+      in_dict.pop_back();
+      continue;
+    }
+    BinaryEntry entry;
+    ReadBinaryEntry(*type, in_dict.back(), &it, &entry);
+    if (*type == kTypeStartDict || *type == kTypeStartArray) {
+      AppendBinaryEntry(entry, container_sizes[container_index++], out);
+      in_dict.push_back(*type == kTypeStartDict);
+    } else {
+      AppendBinaryEntry(entry, 0, out);
+    }
+  }
+  DCHECK_EQ(end, out->size());
+  return true;
+}
+
+size_t TracedValue::GetBinaryFormatSize() const {
+  std::vector<size_t> container_sizes;
+  return ComputeBinaryFormatSizes(&container_sizes);
+}
+
+size_t TracedValue::ComputeBinaryFormatSizes(
+    std::vector<size_t>* container_sizes) const {
+  struct Container {
+    BinaryEntry entry;
+    // In |container_sizes|.
+    size_t index;
+  };
+  std::vector<Container> stack(1);
+  stack.back().entry.type = kTypeStartDict;
+  container_sizes->assign(1, 0);
+
+  PickleIterator it(pickle_);
+  for (const char* type; it.ReadBytes(&type, 1);) {
+    if (*type == kTypeEndDict || *type == kTypeEndArray) {
+      Container container = stack.back();
+      stack.pop_back();
+      (*container_sizes)[stack.back().index] += LengthDelimitedFieldSize(
+          GetValueSize(container.entry, (*container_sizes)[container.index]));
+      continue;
+    }
+    BinaryEntry entry;
+    ReadBinaryEntry(*type, stack.back().entry.type == kTypeStartDict, &it,
+                    &entry);
+    if (*type == kTypeStartDict || *type == kTypeStartArray) {
+      stack.push_back({entry, container_sizes->size()});
+      container_sizes->push_back(0);
+    } else {
+      (*container_sizes)[stack.back().index] +=
+          LengthDelimitedFieldSize(GetValueSize(entry, 0));
+    }
+  }
+  DCHECK_EQ(1u, stack.size());
+  return (*container_sizes)[0];
+}
+
 void TracedValue::EstimateTraceMemoryOverhead(
     TraceEventMemoryOverhead* overhead) {
   overhead->Add(TraceEventMemoryOverhead::kTracedValue,
@@ -60,6 +60,11 @@ class BASE_EXPORT TracedValue : public ConvertableToTraceFormat {
 
   // ConvertableToTraceFormat implementation.
   void AppendAsTraceFormat(std::string* out) const override;
+  bool AppendAsBinaryFormat(std::string* out) const override;
+
+  // Returns the number of bytes appended by AppendAsBinaryFormat(), which
+  // reserves them up front.
+  size_t GetBinaryFormatSize() const;
 
   void EstimateTraceMemoryOverhead(TraceEventMemoryOverhead* overhead) override;
 
@@ -76,6 +81,11 @@ class BASE_EXPORT TracedValue : public ConvertableToTraceFormat {
   std::unique_ptr<base::Value> ToBaseValue() const;
 
  private:
+  // Computes the sizes of the contents of the containers in the binary format,
+  // in the order they are begun, preceded by that of the root dictionary.
+  // Returns the latter, which is the size of the whole output.
+  size_t ComputeBinaryFormatSizes(std::vector<size_t>* container_sizes) const;
+
   Pickle pickle_;
 
 #ifndef NDEBUG
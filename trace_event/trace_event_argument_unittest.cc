@@ -6,6 +6,7 @@
 
 #include <stddef.h>
 
+#include <string>
 #include <utility>
 
 #include "base/memory/ptr_util.h"
@@ -161,5 +162,54 @@ TEST(TraceEventArgumentTest, PassTracedValue) {
   EXPECT_EQ("{\"b\":2,\"c\":[\"foo\"],\"f\":3,\"g\":{}}", json);
 }
 
+TEST(TraceEventArgumentTest, BinaryFormat) {
+  auto value = std::make_unique<TracedValue>();
+  value->SetBoolean("b", false);
+  value->BeginArray("a");
+  value->AppendInteger(-1);
+  value->EndArray();
+
+  std::string binary;
+  EXPECT_TRUE(value->AppendAsBinaryFormat(&binary));
+  // Dict { entry { key: "b" bool_value: false }
+  //        entry { key: "a" array_value { value { int_value: -1 } } } }
+  const char kExpected[] =
+      "\x0a\x05\x0a\x01" "b" "\x10\x00"
+      "\x0a\x09\x0a\x01" "a" "\x3a\x04\x0a\x02\x18\x01";
+  EXPECT_EQ(std::string(kExpected, sizeof(kExpected) - 1), binary);
+  EXPECT_EQ(binary.size(), value->GetBinaryFormatSize());
+}
+
+TEST(TraceEventArgumentTest, BinaryFormatSize) {
+  auto value = std::make_unique<TracedValue>();
+  EXPECT_EQ(0u, value->GetBinaryFormatSize());
+
+  // Sizes of more than 127 bytes take several bytes to encode.
+  std::string long_string(200, 'x');
+  value->SetStringWithCopiedName(long_string, long_string);
+  value->BeginDictionary("dict");
+  value->SetDouble("d", 1.5);
+  value->BeginArray("array");
+  for (int i = 0; i < 100; ++i) {
+    value->BeginDictionary();
+    value->SetInteger("i", i * 1000);
+    value->EndDictionary();
+  }
+  value->AppendString(long_string);
+  value->EndArray();
+  value->EndDictionary();
+
+  auto outer_value = std::make_unique<TracedValue>();
+  outer_value->SetValue("inner", *value);
+
+  for (const TracedValue* traced_value : {value.get(), outer_value.get()}) {
+    // The output is appended to the existing contents.
+    std::string binary = "prefix";
+    EXPECT_TRUE(traced_value->AppendAsBinaryFormat(&binary));
+    EXPECT_EQ("prefix", binary.substr(0, 6));
+    EXPECT_EQ(binary.size() - 6, traced_value->GetBinaryFormatSize());
+  }
+}
+
 }  // namespace trace_event
 }  // namespace base
@@ -0,0 +1,284 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/trace_event_binary_writer.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+#include "base/trace_event/trace_event.h"
+
+namespace base {
+namespace trace_event {
+
+namespace {
+
+// Wire types of the protocol buffer encoding.
+enum WireType {
+  kVarint = 0,
+  kFixed64 = 1,
+  kLengthDelimited = 2,
+};
+
+// TracePacket fields.
+enum PacketField {
+  kPacketInternedString = 1,
+  kPacketEvent = 2,
+};
+
+// InternedString fields.
+enum InternedStringField {
+  kInternedStringIid = 1,
+  kInternedStringValue = 2,
+};
+
+// Event fields.
+enum EventField {
+  kEventTimestampDelta = 1,
+  kEventPhase = 2,
+  kEventCategoryIid = 3,
+  kEventNameIid = 4,
+  kEventThreadId = 5,
+  kEventProcessId = 6,
+  kEventFlags = 7,
+  kEventDuration = 8,
+  kEventThreadTimestampDelta = 9,
+  kEventThreadDuration = 10,
+  kEventId = 11,
+  kEventScopeIid = 12,
+  kEventBindId = 13,
+  kEventArg = 14,
+  kEventArgsStripped = 15,
+};
+
+// Arg fields.
+enum ArgField {
+  kArgNameIid = 1,
+  kArgBool = 2,
+  kArgUint = 3,
+  kArgInt = 4,
+  kArgDouble = 5,
+  kArgPointer = 6,
+  kArgStringIid = 7,
+  kArgString = 8,
+  kArgJson = 9,
+  kArgStripped = 10,
+  kArgDict = 11,
+};
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void AppendTag(int field, WireType wire_type, std::string* out) {
+  AppendVarint((static_cast<uint64_t>(field) << 3) | wire_type, out);
+}
+
+void AppendVarintField(int field, uint64_t value, std::string* out) {
+  AppendTag(field, kVarint, out);
+  AppendVarint(value, out);
+}
+
+// Int32 and int64 fields are sign-extended to 64 bits, sint64 fields are
+// zigzag-encoded so that small negative values stay short.
+void AppendInt64Field(int field, int64_t value, std::string* out) {
+  AppendVarintField(field, static_cast<uint64_t>(value), out);
+}
+
+void AppendSint64Field(int field, int64_t value, std::string* out) {
+  AppendVarintField(
+      field,
+      (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63),
+      out);
+}
+
+void AppendDoubleField(int field, double value, std::string* out) {
+  AppendTag(field, kFixed64, out);
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  // The encoding is little-endian.
+  for (size_t i = 0; i < sizeof(bits); ++i, bits >>= 8)
+    out->push_back(static_cast<char>(bits & 0xFF));
+}
+
+void AppendLengthDelimitedField(int field,
+                                StringPiece value,
+                                std::string* out) {
+  AppendTag(field, kLengthDelimited, out);
+  AppendVarint(value.size(), out);
+  value.AppendToString(out);
+}
+
+}  // namespace
+
+TraceEventBinaryWriter::TraceEventBinaryWriter(
+    const ArgumentFilterPredicate& argument_filter_predicate)
+    : argument_filter_predicate_(argument_filter_predicate) {}
+
+TraceEventBinaryWriter::~TraceEventBinaryWriter() = default;
+
+void TraceEventBinaryWriter::AppendEvent(const TraceEvent& event,
+                                         std::string* out) {
+  const char* category_group_name =
+      TraceLog::GetCategoryGroupName(event.category_group_enabled());
+
+  event_.clear();
+  int64_t timestamp_us = event.timestamp().ToInternalValue();
+  AppendSint64Field(kEventTimestampDelta, timestamp_us - last_timestamp_us_,
+                    &event_);
+  last_timestamp_us_ = timestamp_us;
+  AppendVarintField(kEventPhase, static_cast<unsigned char>(event.phase()),
+                    &event_);
+  AppendVarintField(kEventCategoryIid,
+                    InternString(category_group_name, out), &event_);
+  AppendVarintField(kEventNameIid, InternString(event.name(), out), &event_);
+
+  // thread_id() holds the process id when TRACE_EVENT_FLAG_HAS_PROCESS_ID is
+  // set, see TraceEvent.
+  if (event.flags() & TRACE_EVENT_FLAG_HAS_PROCESS_ID)
+    AppendInt64Field(kEventProcessId, event.thread_id(), &event_);
+  else
+    AppendInt64Field(kEventThreadId, event.thread_id(), &event_);
+  if (event.flags())
+    AppendVarintField(kEventFlags, event.flags(), &event_);
+
+  if (event.phase() == TRACE_EVENT_PHASE_COMPLETE) {
+    int64_t duration = event.duration().ToInternalValue();
+    if (duration != -1)
+      AppendInt64Field(kEventDuration, duration, &event_);
+    if (!event.thread_timestamp().is_null()) {
+      int64_t thread_duration = event.thread_duration().ToInternalValue();
+      if (thread_duration != -1)
+        AppendInt64Field(kEventThreadDuration, thread_duration, &event_);
+    }
+  }
+  if (!event.thread_timestamp().is_null()) {
+    int64_t thread_timestamp_us = event.thread_timestamp().ToInternalValue();
+    AppendSint64Field(kEventThreadTimestampDelta,
+                      thread_timestamp_us - last_thread_timestamp_us_,
+                      &event_);
+    last_thread_timestamp_us_ = thread_timestamp_us;
+  }
+
+  if (event.flags() & (TRACE_EVENT_FLAG_HAS_ID | TRACE_EVENT_FLAG_HAS_LOCAL_ID |
+                       TRACE_EVENT_FLAG_HAS_GLOBAL_ID)) {
+    AppendVarintField(kEventId, event.id(), &event_);
+    if (event.scope() != trace_event_internal::kGlobalScope)
+      AppendVarintField(kEventScopeIid, InternString(event.scope(), out),
+                        &event_);
+  }
+  if (event.flags() & TRACE_EVENT_FLAG_FLOW_OUT ||
+      event.flags() & TRACE_EVENT_FLAG_FLOW_IN) {
+    AppendVarintField(kEventBindId, event.bind_id(), &event_);
+  }
+
+  // Same filtering as TraceEvent::AppendAsJSON().
+  ArgumentNameFilterPredicate argument_name_filter_predicate;
+  bool strip_args =
+      event.arg_name(0) && !argument_filter_predicate_.is_null() &&
+      !argument_filter_predicate_.Run(category_group_name, event.name(),
+                                      &argument_name_filter_predicate);
+  if (strip_args) {
+    AppendVarintField(kEventArgsStripped, 1, &event_);
+  } else {
+    for (int i = 0; i < kTraceMaxNumArgs && event.arg_name(i); ++i) {
+      AppendArg(event, i,
+                !argument_name_filter_predicate.is_null() &&
+                    !argument_name_filter_predicate.Run(event.arg_name(i)),
+                out);
+    }
+  }
+
+  AppendLengthDelimitedField(kPacketEvent, event_, out);
+}
+
+uint64_t TraceEventBinaryWriter::InternString(StringPiece value,
+                                              std::string* out) {
+  auto it = interned_strings_.find(value);
+  if (it != interned_strings_.end())
+    return it->second;
+
+  // Zero is the default value, which isn't used as an id.
+  uint64_t iid = interned_strings_.size() + 1;
+  interned_string_storage_.push_back(value.as_string());
+  interned_strings_.emplace(interned_string_storage_.back(), iid);
+
+  arg_.clear();
+  AppendVarintField(kInternedStringIid, iid, &arg_);
+  AppendLengthDelimitedField(kInternedStringValue, value, &arg_);
+  AppendLengthDelimitedField(kPacketInternedString, arg_, out);
+  return iid;
+}
+
+void TraceEventBinaryWriter::AppendArg(const TraceEvent& event,
+                                       int index,
+                                       bool stripped,
+                                       std::string* out) {
+  // Strings are interned first, since they use |arg_| too.
+  uint64_t name_iid = InternString(event.arg_name(index), out);
+  uint64_t string_iid = 0;
+  if (!stripped && event.arg_type(index) == TRACE_VALUE_TYPE_STRING &&
+      event.arg_value(index).as_string) {
+    string_iid = InternString(event.arg_value(index).as_string, out);
+  }
+
+  arg_.clear();
+  AppendVarintField(kArgNameIid, name_iid, &arg_);
+  TraceEvent::TraceValue value = event.arg_value(index);
+  if (stripped) {
+    AppendVarintField(kArgStripped, 1, &arg_);
+  } else {
+    switch (event.arg_type(index)) {
+      case TRACE_VALUE_TYPE_BOOL:
+        AppendVarintField(kArgBool, value.as_bool, &arg_);
+        break;
+      case TRACE_VALUE_TYPE_UINT:
+        AppendVarintField(kArgUint, value.as_uint, &arg_);
+        break;
+      case TRACE_VALUE_TYPE_INT:
+        AppendSint64Field(kArgInt, value.as_int, &arg_);
+        break;
+      case TRACE_VALUE_TYPE_DOUBLE:
+        AppendDoubleField(kArgDouble, value.as_double, &arg_);
+        break;
+      case TRACE_VALUE_TYPE_POINTER:
+        AppendVarintField(kArgPointer,
+                          static_cast<uint64_t>(
+                              reinterpret_cast<uintptr_t>(value.as_pointer)),
+                          &arg_);
+        break;
+      case TRACE_VALUE_TYPE_STRING:
+        if (string_iid)
+          AppendVarintField(kArgStringIid, string_iid, &arg_);
+        break;
+      case TRACE_VALUE_TYPE_COPY_STRING:
+        if (value.as_string)
+          AppendLengthDelimitedField(kArgString, value.as_string, &arg_);
+        break;
+      case TRACE_VALUE_TYPE_CONVERTABLE: {
+        const ConvertableToTraceFormat* convertable =
+            event.arg_convertable_value(index);
+        value_.clear();
+        if (convertable->AppendAsBinaryFormat(&value_)) {
+          AppendLengthDelimitedField(kArgDict, value_, &arg_);
+        } else {
+          convertable->AppendAsTraceFormat(&value_);
+          AppendLengthDelimitedField(kArgJson, value_, &arg_);
+        }
+        break;
+      }
+      default:
+        NOTREACHED() << "Don't know how to serialize this value";
+        break;
+    }
+  }
+  AppendLengthDelimitedField(kEventArg, arg_, &event_);
+}
+
+}  // namespace trace_event
+}  // namespace base
@@ -0,0 +1,148 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TRACE_EVENT_TRACE_EVENT_BINARY_WRITER_H_
+#define BASE_TRACE_EVENT_TRACE_EVENT_BINARY_WRITER_H_
+
+#include <stdint.h>
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "base/trace_event/trace_event_impl.h"
+
+namespace base {
+namespace trace_event {
+
+// Serializes TraceEvents in a compact binary format, as an alternative to
+// TraceEvent::AppendAsJSON(). Strings are interned: each one is written once,
+// the first time it is used, and referred to by an id afterwards. Timestamps
+// are written as deltas from the previous event, in microseconds.
+//
+// The output uses the protocol buffer wire format. It is the serialization of
+// the Trace message below, so the outputs for consecutive events can simply be
+// concatenated. They must be kept in order, since events refer to the strings
+// interned before them.
+//
+//   message Trace {
+//     repeated TracePacket packet = 1;
+//   }
+//   message TracePacket {
+//     optional InternedString interned_string = 1;
+//     optional Event event = 2;
+//   }
+//   message InternedString {
+//     optional uint64 iid = 1;
+//     optional string value = 2;
+//   }
+//   message Event {
+//     optional sint64 timestamp_delta_us = 1;
+//     optional uint32 phase = 2;
+//     optional uint64 category_iid = 3;
+//     optional uint64 name_iid = 4;
+//     optional int32 thread_id = 5;
+//     // Set instead of |thread_id| for TRACE_EVENT_FLAG_HAS_PROCESS_ID.
+//     optional int32 process_id = 6;
+//     optional uint32 flags = 7;
+//     optional int64 duration_us = 8;
+//     optional sint64 thread_timestamp_delta_us = 9;
+//     optional int64 thread_duration_us = 10;
+//     optional uint64 id = 11;
+//     optional uint64 scope_iid = 12;
+//     optional uint64 bind_id = 13;
+//     repeated Arg arg = 14;
+//     // Set when the argument filter removed all the arguments.
+//     optional bool args_stripped = 15;
+//   }
+//   message Arg {
+//     optional uint64 name_iid = 1;
+//     oneof value {
+//       bool bool_value = 2;
+//       uint64 uint_value = 3;
+//       sint64 int_value = 4;
+//       double double_value = 5;
+//       uint64 pointer_value = 6;
+//       uint64 string_iid = 7;
+//       string string_value = 8;
+//       // The output of ConvertableToTraceFormat::AppendAsTraceFormat().
+//       string json_value = 9;
+//       // Set when the argument name filter removed the value.
+//       bool stripped = 10;
+//       // Set instead of |json_value| when the ConvertableToTraceFormat
+//       // supports AppendAsBinaryFormat(), e.g. for TracedValues.
+//       Dict dict_value = 11;
+//     }
+//   }
+//   message Dict {
+//     repeated Value entry = 1;
+//   }
+//   message Array {
+//     repeated Value value = 1;
+//   }
+//   message Value {
+//     // Only set for the entries of a Dict.
+//     optional string key = 1;
+//     oneof value {
+//       bool bool_value = 2;
+//       sint64 int_value = 3;
+//       double double_value = 4;
+//       string string_value = 5;
+//       Dict dict_value = 6;
+//       Array array_value = 7;
+//     }
+//   }
+//
+// Optional fields are omitted when they have their default value, or when the
+// event doesn't have them (e.g. durations of events which aren't complete).
+class BASE_EXPORT TraceEventBinaryWriter {
+ public:
+  explicit TraceEventBinaryWriter(
+      const ArgumentFilterPredicate& argument_filter_predicate =
+          ArgumentFilterPredicate());
+  ~TraceEventBinaryWriter();
+
+  // Appends the serialization of |event| to |out|, preceded by the strings it
+  // uses for the first time.
+  void AppendEvent(const TraceEvent& event, std::string* out);
+
+ private:
+  // Returns the id of |value|, first appending it to |out| if it wasn't
+  // interned yet.
+  uint64_t InternString(StringPiece value, std::string* out);
+
+  // Appends argument |index| of |event| to |event_|, and the strings it uses
+  // for the first time to |out|. If |stripped|, the value is marked as
+  // stripped instead of being written.
+  void AppendArg(const TraceEvent& event,
+                 int index,
+                 bool stripped,
+                 std::string* out);
+
+  const ArgumentFilterPredicate argument_filter_predicate_;
+
+  // The interned strings and their ids. The keys point into
+  // |interned_string_storage_|.
+  std::unordered_map<StringPiece, uint64_t, StringPieceHash> interned_strings_;
+  std::deque<std::string> interned_string_storage_;
+
+  int64_t last_timestamp_us_ = 0;
+  int64_t last_thread_timestamp_us_ = 0;
+
+  // Scratch buffers for the messages being serialized, kept to reuse their
+  // capacity.
+  std::string event_;
+  std::string arg_;
+  std::string value_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceEventBinaryWriter);
+};
+
+}  // namespace trace_event
+}  // namespace base
+
+#endif  // BASE_TRACE_EVENT_TRACE_EVENT_BINARY_WRITER_H_
@@ -0,0 +1,419 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/trace_event_binary_writer.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/strings/string_piece.h"
+#include "base/trace_event/trace_event.h"
+#include "base/trace_event/trace_event_argument.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace trace_event {
+
+namespace {
+
+// A field of a protocol buffer message.
+struct Field {
+  int number;
+  uint64_t varint = 0;
+  StringPiece bytes;
+};
+
+bool ReadVarint(StringPiece* input, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64 && !input->empty(); shift += 7) {
+    uint8_t byte = (*input)[0];
+    input->remove_prefix(1);
+    *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+// Parses the fields of a message, which must only use the wire types of the
+// binary format.
+std::vector<Field> ParseMessage(StringPiece input) {
+  std::vector<Field> fields;
+  while (!input.empty()) {
+    uint64_t tag;
+    EXPECT_TRUE(ReadVarint(&input, &tag));
+    Field field;
+    field.number = static_cast<int>(tag >> 3);
+    switch (tag & 7) {
+      case 0:
+        EXPECT_TRUE(ReadVarint(&input, &field.varint));
+        break;
+      case 1:
+        EXPECT_GE(input.size(), 8u);
+        field.bytes = input.substr(0, 8);
+        input.remove_prefix(8);
+        break;
+      case 2: {
+        uint64_t size;
+        EXPECT_TRUE(ReadVarint(&input, &size));
+        EXPECT_GE(input.size(), size);
+        field.bytes = input.substr(0, size);
+        input.remove_prefix(size);
+        break;
+      }
+      default:
+        ADD_FAILURE() << "Unexpected wire type " << (tag & 7);
+        return fields;
+    }
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Formats a Dict or Array message like the JSON of the TracedValue it was
+// written from.
+std::string FormatContainer(StringPiece message, bool is_dict) {
+  std::string out = is_dict ? "{" : "[";
+  for (const Field& entry : ParseMessage(message)) {
+    EXPECT_EQ(1, entry.number);
+    if (out.size() > 1)
+      out += ",";
+    for (const Field& field : ParseMessage(entry.bytes)) {
+      switch (field.number) {
+        case 1:
+          out += "\"" + field.bytes.as_string() + "\":";
+          break;
+        case 2:
+          out += field.varint ? "true" : "false";
+          break;
+        case 3:
+          out += std::to_string(ZigZagDecode(field.varint));
+          break;
+        case 4: {
+          double d;
+          memcpy(&d, field.bytes.data(), sizeof(d));
+          out += std::to_string(d);
+          break;
+        }
+        case 5:
+          out += "\"" + field.bytes.as_string() + "\"";
+          break;
+        case 6:
+        case 7:
+          out += FormatContainer(field.bytes, field.number == 6);
+          break;
+        default:
+          ADD_FAILURE() << "Unexpected value field " << field.number;
+      }
+    }
+  }
+  return out + (is_dict ? "}" : "]");
+}
+
+// Decodes a binary trace, resolving the interned strings.
+class TraceReader {
+ public:
+  struct Event {
+    std::map<int, uint64_t> varints;
+    std::string category;
+    std::string name;
+    int64_t timestamp_us = 0;
+    // Argument names and values, formatted as strings.
+    std::map<std::string, std::string> args;
+    // The Arg field number of the value of each argument.
+    std::map<std::string, int> arg_fields;
+  };
+
+  explicit TraceReader(StringPiece trace) { Read(trace); }
+
+  const std::vector<Event>& events() const { return events_; }
+  int num_interned_strings() const { return num_interned_strings_; }
+
+ private:
+  void Read(StringPiece trace) {
+    int64_t timestamp_us = 0;
+    for (const Field& packet : ParseMessage(trace)) {
+      if (packet.number == 1) {
+        ++num_interned_strings_;
+        std::vector<Field> fields = ParseMessage(packet.bytes);
+        ASSERT_EQ(2u, fields.size());
+        EXPECT_FALSE(strings_.count(fields[0].varint));
+        strings_[fields[0].varint] = fields[1].bytes.as_string();
+        continue;
+      }
+      ASSERT_EQ(2, packet.number);
+      Event event;
+      for (const Field& field : ParseMessage(packet.bytes)) {
+        if (field.number == 14) {
+          AddArg(field.bytes, &event);
+          continue;
+        }
+        event.varints[field.number] = field.varint;
+        if (field.number == 1) {
+          timestamp_us += ZigZagDecode(field.varint);
+          event.timestamp_us = timestamp_us;
+        }
+      }
+      event.category = strings_[event.varints[3]];
+      event.name = strings_[event.varints[4]];
+      events_.push_back(event);
+    }
+  }
+
+  void AddArg(StringPiece arg, Event* event) {
+    std::vector<Field> fields = ParseMessage(arg);
+    ASSERT_EQ(2u, fields.size());
+    ASSERT_EQ(1, fields[0].number);
+    std::string name = strings_[fields[0].varint];
+    const Field& value = fields[1];
+    std::string& formatted = event->args[name];
+    event->arg_fields[name] = value.number;
+    switch (value.number) {
+      case 2:
+        formatted = value.varint ? "true" : "false";
+        break;
+      case 3:
+        formatted = std::to_string(value.varint);
+        break;
+      case 4:
+        formatted = std::to_string(ZigZagDecode(value.varint));
+        break;
+      case 5: {
+        double d;
+        memcpy(&d, value.bytes.data(), sizeof(d));
+        formatted = std::to_string(d);
+        break;
+      }
+      case 7:
+        formatted = strings_[value.varint];
+        break;
+      case 8:
+      case 9:
+        formatted = value.bytes.as_string();
+        break;
+      case 10:
+        formatted = "__stripped__";
+        break;
+      case 11:
+        formatted = FormatContainer(value.bytes, true);
+        break;
+      default:
+        ADD_FAILURE() << "Unexpected arg field " << value.number;
+    }
+  }
+
+  std::map<uint64_t, std::string> strings_;
+  int num_interned_strings_ = 0;
+  std::vector<Event> events_;
+};
+
+// A convertable which only has a JSON representation.
+class JsonConvertable : public ConvertableToTraceFormat {
+ public:
+  void AppendAsTraceFormat(std::string* out) const override {
+    out->append("{\"json\":true}");
+  }
+};
+
+void InitializeEvent(TraceEvent* event,
+                     int64_t timestamp_us,
+                     const char* name,
+                     int num_args,
+                     const char* const* arg_names,
+                     const unsigned char* arg_types,
+                     const unsigned long long* arg_values,
+                     std::unique_ptr<ConvertableToTraceFormat>* convertables) {
+  event->Initialize(
+      1, TimeTicks() + TimeDelta::FromMicroseconds(timestamp_us), ThreadTicks(),
+      TRACE_EVENT_PHASE_INSTANT, TraceLog::GetCategoryGroupEnabled("cat"),
+      name, trace_event_internal::kGlobalScope, trace_event_internal::kNoId,
+      trace_event_internal::kNoId, num_args, arg_names, arg_types, arg_values,
+      convertables, TRACE_EVENT_FLAG_NONE);
+}
+
+bool IsArgumentAllowed(const char* arg_name) {
+  return strcmp(arg_name, "secret") != 0;
+}
+
+bool FilterArguments(const char* category_group_name,
+                     const char* event_name,
+                     ArgumentNameFilterPredicate* arg_filter) {
+  if (strcmp(event_name, "filtered") == 0) {
+    *arg_filter = BindRepeating(&IsArgumentAllowed);
+    return true;
+  }
+  return strcmp(event_name, "stripped") != 0;
+}
+
+void AppendOutput(std::string* out,
+                  const scoped_refptr<RefCountedString>& chunk,
+                  bool has_more_events) {
+  out->append(chunk->data());
+}
+
+}  // namespace
+
+TEST(TraceEventBinaryWriterTest, EventsAndArgs) {
+  std::unique_ptr<TracedValue> traced_value(new TracedValue());
+  traced_value->SetInteger("x", 1);
+  std::unique_ptr<ConvertableToTraceFormat> convertables[kTraceMaxNumArgs];
+  convertables[1] = std::move(traced_value);
+
+  const char* arg_names[] = {"int", "json"};
+  const unsigned char arg_types[] = {TRACE_VALUE_TYPE_INT,
+                                     TRACE_VALUE_TYPE_CONVERTABLE};
+  const unsigned long long arg_values[] = {static_cast<unsigned long long>(-5),
+                                           0};
+  TraceEvent first;
+  InitializeEvent(&first, 1000, "event", 2, arg_names, arg_types, arg_values,
+                  convertables);
+
+  const char* other_arg_names[] = {"string", "double"};
+  const unsigned char other_arg_types[] = {TRACE_VALUE_TYPE_STRING,
+                                           TRACE_VALUE_TYPE_DOUBLE};
+  TraceEvent::TraceValue other_values[2];
+  other_values[0].as_string = "event";
+  other_values[1].as_double = 0.5;
+  unsigned long long other_arg_values[2];
+  memcpy(other_arg_values, other_values, sizeof(other_arg_values));
+  TraceEvent second;
+  InitializeEvent(&second, 750, "event", 2, other_arg_names, other_arg_types,
+                  other_arg_values, nullptr);
+
+  TraceEventBinaryWriter writer;
+  std::string trace;
+  writer.AppendEvent(first, &trace);
+  writer.AppendEvent(second, &trace);
+  writer.AppendEvent(second, &trace);
+
+  TraceReader reader(trace);
+  // "cat", "event", "int", "json", "string" and "double".
+  EXPECT_EQ(6, reader.num_interned_strings());
+  ASSERT_EQ(3u, reader.events().size());
+
+  const TraceReader::Event& event = reader.events()[0];
+  EXPECT_EQ("cat", event.category);
+  EXPECT_EQ("event", event.name);
+  EXPECT_EQ(1000, event.timestamp_us);
+  EXPECT_EQ(static_cast<uint64_t>(TRACE_EVENT_PHASE_INSTANT),
+            event.varints.at(2));
+  EXPECT_EQ(1u, event.varints.at(5));
+  ASSERT_EQ(2u, event.args.size());
+  EXPECT_EQ("-5", event.args.at("int"));
+  EXPECT_EQ("{\"x\":1}", event.args.at("json"));
+  // TracedValues aren't converted to JSON.
+  EXPECT_EQ(11, event.arg_fields.at("json"));
+
+  for (size_t i = 1; i < 3; ++i) {
+    const TraceReader::Event& other_event = reader.events()[i];
+    EXPECT_EQ(750, other_event.timestamp_us);
+    ASSERT_EQ(2u, other_event.args.size());
+    EXPECT_EQ("event", other_event.args.at("string"));
+    EXPECT_EQ(std::to_string(0.5), other_event.args.at("double"));
+  }
+}
+
+TEST(TraceEventBinaryWriterTest, ConvertableArgs) {
+  std::unique_ptr<TracedValue> traced_value(new TracedValue());
+  traced_value->SetString("s", "string");
+  traced_value->BeginDictionary("dict");
+  traced_value->SetBoolean("b", false);
+  traced_value->SetDouble("d", 0.5);
+  traced_value->BeginArray("array");
+  traced_value->AppendInteger(-300);
+  traced_value->BeginArray();
+  traced_value->EndArray();
+  traced_value->EndArray();
+  traced_value->EndDictionary();
+  std::unique_ptr<ConvertableToTraceFormat> convertables[kTraceMaxNumArgs];
+  convertables[0] = std::move(traced_value);
+  convertables[1].reset(new JsonConvertable());
+
+  const char* arg_names[] = {"traced", "json"};
+  const unsigned char arg_types[] = {TRACE_VALUE_TYPE_CONVERTABLE,
+                                     TRACE_VALUE_TYPE_CONVERTABLE};
+  const unsigned long long arg_values[] = {0, 0};
+  TraceEvent event;
+  InitializeEvent(&event, 0, "event", 2, arg_names, arg_types, arg_values,
+                  convertables);
+
+  TraceEventBinaryWriter writer;
+  std::string trace;
+  writer.AppendEvent(event, &trace);
+
+  TraceReader reader(trace);
+  ASSERT_EQ(1u, reader.events().size());
+  const TraceReader::Event& read_event = reader.events()[0];
+  EXPECT_EQ(11, read_event.arg_fields.at("traced"));
+  EXPECT_EQ("{\"s\":\"string\",\"dict\":{\"b\":false,\"d\":" +
+                std::to_string(0.5) + ",\"array\":[-300,[]]}}",
+            read_event.args.at("traced"));
+  EXPECT_EQ(9, read_event.arg_fields.at("json"));
+  EXPECT_EQ("{\"json\":true}", read_event.args.at("json"));
+}
+
+TEST(TraceEventBinaryWriterTest, ArgumentFilter) {
+  const char* arg_names[] = {"public", "secret"};
+  const unsigned char arg_types[] = {TRACE_VALUE_TYPE_BOOL,
+                                     TRACE_VALUE_TYPE_UINT};
+  const unsigned long long arg_values[] = {1, 2};
+
+  TraceEvent filtered;
+  InitializeEvent(&filtered, 0, "filtered", 2, arg_names, arg_types,
+                  arg_values, nullptr);
+  TraceEvent stripped;
+  InitializeEvent(&stripped, 0, "stripped", 2, arg_names, arg_types,
+                  arg_values, nullptr);
+
+  TraceEventBinaryWriter writer(BindRepeating(&FilterArguments));
+  std::string trace;
+  writer.AppendEvent(filtered, &trace);
+  writer.AppendEvent(stripped, &trace);
+
+  TraceReader reader(trace);
+  ASSERT_EQ(2u, reader.events().size());
+  ASSERT_EQ(2u, reader.events()[0].args.size());
+  EXPECT_EQ("true", reader.events()[0].args.at("public"));
+  EXPECT_EQ("__stripped__", reader.events()[0].args.at("secret"));
+  EXPECT_TRUE(reader.events()[1].args.empty());
+  EXPECT_EQ(1u, reader.events()[1].varints.at(15));
+}
+
+TEST(TraceEventBinaryWriterTest, FlushAsBinary) {
+  TraceLog* trace_log = TraceLog::GetInstance();
+  trace_log->SetEnabled(TraceConfig("binary_writer_test", ""),
+                        TraceLog::RECORDING_MODE);
+  for (int i = 0; i < 1000; ++i)
+    TRACE_EVENT_INSTANT1("binary_writer_test", "instant",
+                         TRACE_EVENT_SCOPE_THREAD, "index", i);
+  trace_log->SetDisabled();
+
+  std::string trace;
+  trace_log->FlushAsBinary(BindRepeating(&AppendOutput, &trace));
+
+  TraceReader reader(trace);
+  int num_instant_events = 0;
+  for (const TraceReader::Event& event : reader.events()) {
+    if (event.name != "instant")
+      continue;
+    EXPECT_EQ("binary_writer_test", event.category);
+    EXPECT_EQ(std::to_string(num_instant_events), event.args.at("index"));
+    ++num_instant_events;
+  }
+  EXPECT_EQ(1000, num_instant_events);
+}
+
+}  // namespace trace_event
+}  // namespace base
@@ -49,6 +49,12 @@ class BASE_EXPORT ConvertableToTraceFormat {
   // appended.
   virtual void AppendAsTraceFormat(std::string* out) const = 0;
 
+  // Appends the class info in the binary trace format, as a serialized Dict
+  // message (see TraceEventBinaryWriter), and returns true. Returns false,
+  // leaving |out| unchanged, if the class has no binary representation, in
+  // which case the output of AppendAsTraceFormat() is used instead.
+  virtual bool AppendAsBinaryFormat(std::string* out) const;
+
   virtual void EstimateTraceMemoryOverhead(TraceEventMemoryOverhead* overhead);
 
   std::string ToString() const {
@@ -142,6 +148,22 @@ class BASE_EXPORT TraceEvent {
 
   const char* name() const { return name_; }
 
+  // The arguments, in the order they were given. |index| must be less than
+  // kTraceMaxNumArgs, and arguments with a null name aren't set.
+  const char* arg_name(int index) const { return arg_names_[index]; }
+  unsigned char arg_type(int index) const { return arg_types_[index]; }
+  TraceValue arg_value(int index) const { return arg_values_[index]; }
+  ConvertableToTraceFormat* arg_convertable_value(int index) const {
+    return convertable_values_[index].get();
+  }
+
+  // Releases the ConvertableToTraceFormat of argument |index|, e.g. to move
+  // the event into a CompactedTraceBufferChunk.
+  std::unique_ptr<ConvertableToTraceFormat> TakeArgConvertableValue(
+      int index) {
+    return std::move(convertable_values_[index]);
+  }
+
 #if defined(OS_ANDROID)
   void SendToATrace();
 #endif
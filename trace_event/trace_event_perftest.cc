@@ -0,0 +1,97 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/trace_event.h"
+
+#include "base/macros.h"
+#include "base/test/perf_benchmark.h"
+#include "base/trace_event/trace_config.h"
+#include "base/trace_event/trace_log.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace trace_event {
+
+namespace {
+
+constexpr int kIterations = 100000;
+
+class TraceEventPerfTest : public testing::Test {
+ protected:
+  TraceEventPerfTest() = default;
+
+  // Records the "perf" category, in a ring buffer so that the events keep
+  // being recorded however many there are.
+  void StartTracing() {
+    TraceLog::GetInstance()->SetEnabled(
+        TraceConfig("perf", RECORD_CONTINUOUSLY), TraceLog::RECORDING_MODE);
+  }
+
+  void TearDown() override {
+    TraceLog::GetInstance()->SetDisabled();
+    TraceLog::ResetForTesting();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TraceEventPerfTest);
+};
+
+}  // namespace
+
+// The cost of the trace events when tracing is off: a load and a branch.
+TEST_F(TraceEventPerfTest, Disabled) {
+  PerfBenchmark benchmark("trace_event", "disabled", kIterations);
+  benchmark.Run([](int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      TRACE_EVENT0("perf", "TraceEventPerfTest");
+    }
+  });
+}
+
+// Events of a category which isn't recorded, while tracing is on.
+TEST_F(TraceEventPerfTest, CategoryNotRecorded) {
+  StartTracing();
+  PerfBenchmark benchmark("trace_event", "category_not_recorded",
+                          kIterations);
+  benchmark.Run([](int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      TRACE_EVENT0("perf_not_recorded", "TraceEventPerfTest");
+    }
+  });
+}
+
+TEST_F(TraceEventPerfTest, ScopedEvent) {
+  StartTracing();
+  PerfBenchmark benchmark("trace_event", "scoped_event", kIterations);
+  benchmark.Run([](int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      TRACE_EVENT0("perf", "TraceEventPerfTest");
+    }
+  });
+}
+
+TEST_F(TraceEventPerfTest, ScopedEventWithArguments) {
+  StartTracing();
+  PerfBenchmark benchmark("trace_event", "scoped_event_with_arguments",
+                          kIterations);
+  benchmark.Run([](int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      TRACE_EVENT2("perf", "TraceEventPerfTest", "index", i, "name", "value");
+    }
+  });
+}
+
+TEST_F(TraceEventPerfTest, InstantEvent) {
+  StartTracing();
+  PerfBenchmark benchmark("trace_event", "instant_event", kIterations);
+  benchmark.Run([](int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      TRACE_EVENT_INSTANT0("perf", "TraceEventPerfTest",
+                           TRACE_EVENT_SCOPE_THREAD);
+    }
+  });
+}
+
+}  // namespace trace_event
+}  // namespace base
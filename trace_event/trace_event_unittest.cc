@@ -14,6 +14,9 @@
 
 #include "base/bind.h"
 #include "base/command_line.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
 #include "base/json/json_reader.h"
 #include "base/json/json_writer.h"
 #include "base/location.h"
@@ -22,11 +25,13 @@
 #include "base/memory/ref_counted_memory.h"
 #include "base/memory/singleton.h"
 #include "base/process/process_handle.h"
+#include "base/run_loop.h"
 #include "base/single_thread_task_runner.h"
 #include "base/stl_util.h"
 #include "base/strings/pattern.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/waitable_event.h"
+#include "base/test/scoped_task_environment.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/thread.h"
 #include "base/time/time.h"
@@ -36,6 +41,7 @@
 #include "base/trace_event/trace_event.h"
 #include "base/trace_event/trace_event_filter.h"
 #include "base/trace_event/trace_event_filter_test_utils.h"
+#include "base/trace_event/trace_file_sink.h"
 #include "base/values.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -2690,6 +2696,88 @@ TEST_F(TraceEventTestFixture, TraceBufferRingBufferFullIteration) {
   TraceLog::GetInstance()->SetDisabled();
 }
 
+#if defined(OS_POSIX)
+TEST_F(TraceEventTestFixture, WriteSnapshot) {
+  TraceLog* trace_log = TraceLog::GetInstance();
+  trace_log->SetEnabled(
+      TraceConfig(kRecordAllCategoryFilter, RECORD_CONTINUOUSLY),
+      TraceLog::RECORDING_MODE);
+  TRACE_EVENT_INSTANT0("all", "before snapshot", TRACE_EVENT_SCOPE_THREAD);
+
+  FilePath path;
+  FILE* file = CreateAndOpenTemporaryFile(&path);
+  ASSERT_TRUE(file);
+  EXPECT_TRUE(trace_log->WriteSnapshot(fileno(file)));
+  fclose(file);
+  // Tracing goes on.
+  EXPECT_TRUE(trace_log->IsEnabled());
+  TRACE_EVENT_INSTANT0("all", "after snapshot", TRACE_EVENT_SCOPE_THREAD);
+
+  std::string snapshot;
+  ASSERT_TRUE(ReadFileToString(path, &snapshot));
+  DeleteFile(path, false);
+  std::unique_ptr<Value> root = JSONReader::Read(snapshot, JSON_PARSE_RFC);
+  ASSERT_TRUE(root) << snapshot;
+  ASSERT_TRUE(root->is_list());
+  std::vector<std::string> names;
+  for (const Value& event : root->GetList()) {
+    const Value* name = event.FindKey("name");
+    ASSERT_TRUE(name);
+    names.push_back(name->GetString());
+  }
+  EXPECT_TRUE(ContainsValue(names, "before snapshot"));
+  EXPECT_FALSE(ContainsValue(names, "after snapshot"));
+
+  // The snapshot leaves the events to be flushed.
+  EndTraceAndFlush();
+  EXPECT_TRUE(FindNamePhase("before snapshot", "I"));
+  EXPECT_TRUE(FindNamePhase("after snapshot", "I"));
+}
+#endif  // defined(OS_POSIX)
+
+void OnTraceFileWritten(Closure quit_closure, bool* success, bool result) {
+  *success = result;
+  quit_closure.Run();
+}
+
+TEST_F(TraceEventTestFixture, FlushToTraceFileSink) {
+  test::ScopedTaskEnvironment task_environment;
+  BeginTrace();
+  // Enough events for the flush to output several chunks.
+  const int kNumEvents = 10000;
+  for (int i = 0; i < kNumEvents; ++i)
+    TRACE_EVENT_INSTANT1("all", "event", TRACE_EVENT_SCOPE_THREAD, "i", i);
+  TraceLog::GetInstance()->SetDisabled();
+
+  FilePath path;
+  ASSERT_TRUE(CreateTemporaryFile(&path));
+  RunLoop run_loop;
+  bool success = false;
+  auto sink = MakeRefCounted<TraceFileSink>(
+      File(path, File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE),
+      TraceFileSink::Format::kJSON,
+      BindOnce(&OnTraceFileWritten, run_loop.QuitClosure(), &success));
+  TraceLog::GetInstance()->Flush(sink->GetOutputCallback(), true);
+  sink = nullptr;
+  run_loop.Run();
+  EXPECT_TRUE(success);
+
+  std::string trace;
+  ASSERT_TRUE(ReadFileToString(path, &trace));
+  DeleteFile(path, false);
+  std::unique_ptr<Value> root = JSONReader::Read(trace, JSON_PARSE_RFC);
+  ASSERT_TRUE(root);
+  const Value* events = root->FindKeyOfType("traceEvents", Value::Type::LIST);
+  ASSERT_TRUE(events);
+  int num_events = 0;
+  for (const Value& event : events->GetList()) {
+    const Value* name = event.FindKey("name");
+    if (name && name->GetString() == "event")
+      ++num_events;
+  }
+  EXPECT_EQ(kNumEvents, num_events);
+}
+
 TEST_F(TraceEventTestFixture, TraceRecordAsMuchAsPossibleMode) {
   TraceLog::GetInstance()->SetEnabled(
     TraceConfig(kRecordAllCategoryFilter, RECORD_AS_MUCH_AS_POSSIBLE),
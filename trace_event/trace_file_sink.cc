@@ -0,0 +1,79 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/trace_file_sink.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/sequenced_task_runner.h"
+#include "base/task_scheduler/post_task.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+
+namespace base {
+namespace trace_event {
+
+TraceFileSink::TraceFileSink(File file,
+                             Format format,
+                             DoneCallback done_callback)
+    : format_(format),
+      task_runner_(CreateSequencedTaskRunnerWithTraits(
+          {MayBlock(), TaskPriority::BACKGROUND,
+           TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN})),
+      reply_task_runner_(SequencedTaskRunnerHandle::Get()),
+      file_(std::move(file)),
+      done_callback_(std::move(done_callback)),
+      failed_(!file_.IsValid()) {}
+
+TraceFileSink::~TraceFileSink() = default;
+
+TraceLog::OutputCallback TraceFileSink::GetOutputCallback() {
+  return BindRepeating(&TraceFileSink::OnOutput, this);
+}
+
+void TraceFileSink::OnOutput(const scoped_refptr<RefCountedString>& chunk,
+                             bool has_more_events) {
+  // The chunks are posted in order to a sequence, so they are written in
+  // order even when the flush runs on a worker thread.
+  task_runner_->PostTask(FROM_HERE, BindOnce(&TraceFileSink::WriteChunk, this,
+                                             chunk, has_more_events));
+}
+
+void TraceFileSink::WriteChunk(scoped_refptr<RefCountedString> chunk,
+                               bool has_more_events) {
+  if (!started_) {
+    started_ = true;
+    if (format_ == Format::kJSON)
+      Write("{\"traceEvents\":[");
+  }
+  if (chunk->size()) {
+    // The JSON chunks are lists of events without the separators between
+    // them, while the binary ones only need to be concatenated.
+    if (format_ == Format::kJSON && has_events_)
+      Write(",\n");
+    Write(chunk->data());
+    has_events_ = true;
+  }
+  // Free the chunk before the next one is written.
+  chunk = nullptr;
+
+  if (has_more_events)
+    return;
+  if (format_ == Format::kJSON)
+    Write("]}");
+  file_.Close();
+  reply_task_runner_->PostTask(
+      FROM_HERE, BindOnce(std::move(done_callback_), !failed_));
+}
+
+void TraceFileSink::Write(StringPiece data) {
+  if (failed_)
+    return;
+  int size = static_cast<int>(data.size());
+  failed_ = file_.WriteAtCurrentPos(data.data(), size) != size;
+}
+
+}  // namespace trace_event
+}  // namespace base
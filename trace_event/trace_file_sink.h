@@ -0,0 +1,83 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TRACE_EVENT_TRACE_FILE_SINK_H_
+#define BASE_TRACE_EVENT_TRACE_FILE_SINK_H_
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/files/file.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/trace_event/trace_log.h"
+
+namespace base {
+
+class SequencedTaskRunner;
+
+namespace trace_event {
+
+// Writes the output of TraceLog::Flush() or FlushAsBinary() to a file as it is
+// produced, so that a large trace is never held in memory as a whole: each
+// chunk is written on a background sequence and freed, while TraceLog frees
+// the events as it serializes them. The JSON output is written as a complete
+// trace, i.e. {"traceEvents":[...]}. The file isn't compressed.
+//
+// Example:
+//   TraceLog::GetInstance()->SetDisabled();
+//   auto sink = MakeRefCounted<TraceFileSink>(
+//       std::move(file), TraceFileSink::Format::kJSON,
+//       BindOnce(&OnTraceWritten));
+//   TraceLog::GetInstance()->Flush(sink->GetOutputCallback(),
+//                                  true /* use_worker_thread */);
+class BASE_EXPORT TraceFileSink
+    : public RefCountedThreadSafe<TraceFileSink> {
+ public:
+  enum class Format {
+    kJSON,
+    kBinary,
+  };
+
+  // Called with whether the whole trace was written.
+  using DoneCallback = OnceCallback<void(bool success)>;
+
+  // |file| must be open for writing. |done_callback| is run on the current
+  // sequence once the last chunk is written and |file| is closed.
+  TraceFileSink(File file, Format format, DoneCallback done_callback);
+
+  // Returns the callback to pass to TraceLog::Flush() or FlushAsBinary(),
+  // according to the format. It keeps the sink alive.
+  TraceLog::OutputCallback GetOutputCallback();
+
+ private:
+  friend class RefCountedThreadSafe<TraceFileSink>;
+  ~TraceFileSink();
+
+  void OnOutput(const scoped_refptr<RefCountedString>& chunk,
+                bool has_more_events);
+
+  // Run on |task_runner_|.
+  void WriteChunk(scoped_refptr<RefCountedString> chunk,
+                  bool has_more_events);
+  void Write(StringPiece data);
+
+  const Format format_;
+  const scoped_refptr<SequencedTaskRunner> task_runner_;
+  const scoped_refptr<SequencedTaskRunner> reply_task_runner_;
+
+  // Accessed on |task_runner_| only.
+  File file_;
+  DoneCallback done_callback_;
+  bool started_ = false;
+  bool has_events_ = false;
+  bool failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceFileSink);
+};
+
+}  // namespace trace_event
+}  // namespace base
+
+#endif  // BASE_TRACE_EVENT_TRACE_FILE_SINK_H_
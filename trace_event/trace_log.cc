@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <memory>
 #include <utility>
 
@@ -13,6 +14,7 @@
 #include "base/bind.h"
 #include "base/command_line.h"
 #include "base/debug/leak_annotations.h"
+#include "base/files/file_util.h"
 #include "base/location.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
@@ -33,7 +35,9 @@
 #include "base/threading/thread_id_name_manager.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "base/time/time.h"
+#include "base/time/time_override.h"
 #include "base/trace_event/category_registry.h"
+#include "base/trace_event/category_sampler.h"
 #include "base/trace_event/event_name_filter.h"
 #include "base/trace_event/heap_profiler.h"
 #include "base/trace_event/heap_profiler_allocation_context_tracker.h"
@@ -42,7 +46,9 @@
 #include "base/trace_event/memory_dump_provider.h"
 #include "base/trace_event/process_memory_dump.h"
 #include "base/trace_event/trace_buffer.h"
+#include "base/trace_event/trace_clock.h"
 #include "base/trace_event/trace_event.h"
+#include "base/trace_event/trace_event_binary_writer.h"
 #include "build/build_config.h"
 
 #if defined(OS_WIN)
@@ -85,6 +91,13 @@ std::vector<std::unique_ptr<TraceEventFilter>>& GetCategoryGroupFilters() {
   return *filters;
 }
 
+// The CategorySamplers of the category sampling configs of the most recent
+// tracing session, indexed by TraceCategory::sampler_index().
+std::vector<std::unique_ptr<CategorySampler>>& GetCategorySamplers() {
+  static auto* samplers = new std::vector<std::unique_ptr<CategorySampler>>();
+  return *samplers;
+}
+
 ThreadTicks ThreadNow() {
   return ThreadTicks::IsSupported()
              ? base::subtle::ThreadTicksNowIgnoringOverride()
@@ -163,6 +176,16 @@ void ForEachCategoryFilter(const unsigned char* category_group_enabled,
   }
 }
 
+bool ShouldRecordSampledEvent(const unsigned char* category_group_enabled,
+                              TimeTicks timestamp) {
+  const TraceCategory* category =
+      CategoryRegistry::GetCategoryByStatePtr(category_group_enabled);
+  size_t index = category->sampler_index();
+  if (index >= GetCategorySamplers().size())
+    return true;
+  return GetCategorySamplers()[index]->ShouldRecordEvent(timestamp);
+}
+
 }  // namespace
 
 // A helper class that allows the lock to be acquired in the middle of the scope
@@ -267,13 +290,11 @@ TraceEvent* TraceLog::ThreadLocalEventBuffer::AddTraceEvent(
     TraceEventHandle* handle) {
   CheckThisIsCurrentBuffer();
 
-  if (chunk_ && chunk_->IsFull()) {
+  if (!chunk_ || chunk_->IsFull()) {
+    // Return the full chunk and get the next one under a single acquisition of
+    // the lock, which is shared by all the threads adding events.
     AutoLock lock(trace_log_->lock_);
     FlushWhileLocked();
-    chunk_.reset();
-  }
-  if (!chunk_) {
-    AutoLock lock(trace_log_->lock_);
     chunk_ = trace_log_->logged_events_->GetChunk(&chunk_index_);
     trace_log_->CheckIfBufferIsFullWhileLocked();
   }
@@ -361,6 +382,7 @@ TraceLog::TraceLog()
       trace_options_(kInternalRecordUntilFull),
       trace_config_(TraceConfig()),
       thread_shared_chunk_index_(0),
+      flush_as_binary_(false),
       generation_(0),
       use_worker_thread_(false),
       trace_event_override_(0),
@@ -467,6 +489,18 @@ void TraceLog::UpdateCategoryState(TraceCategory* category) {
   if (enabled_modes_ & RECORDING_MODE &&
       trace_config_.IsCategoryGroupEnabled(category->name())) {
     state_flags |= TraceCategory::ENABLED_FOR_RECORDING;
+
+    const TraceConfig::CategorySamplingConfigs& sampling_configs =
+        trace_config_.category_sampling_configs();
+    for (size_t i = 0;
+         i < sampling_configs.size() && i < GetCategorySamplers().size(); ++i) {
+      if (sampling_configs[i].category_filter.IsCategoryGroupEnabled(
+              category->name())) {
+        category->set_sampler_index(static_cast<uint8_t>(i));
+        state_flags |= TraceCategory::ENABLED_FOR_SAMPLING;
+        break;
+      }
+    }
   }
 
   // TODO(primiano): this is a temporary workaround for catapult:#2341,
@@ -504,6 +538,7 @@ void TraceLog::UpdateCategoryState(TraceCategory* category) {
 void TraceLog::UpdateCategoryRegistry() {
   lock_.AssertAcquired();
   CreateFiltersForTraceConfig();
+  CreateSamplersForTraceConfig();
   for (TraceCategory& category : CategoryRegistry::GetAllCategories()) {
     UpdateCategoryState(&category);
   }
@@ -542,6 +577,26 @@ void TraceLog::CreateFiltersForTraceConfig() {
   }
 }
 
+void TraceLog::CreateSamplersForTraceConfig() {
+  if (!(enabled_modes_ & RECORDING_MODE))
+    return;
+
+  // Like the filters, the samplers can't be changed while trace events could
+  // be using them.
+  if (GetCategorySamplers().size())
+    return;
+
+  for (const auto& sampling_config :
+       trace_config_.category_sampling_configs()) {
+    if (GetCategorySamplers().size() > std::numeric_limits<uint8_t>::max()) {
+      NOTREACHED() << "Too many category sampling configs";
+      break;
+    }
+    GetCategorySamplers().push_back(std::make_unique<CategorySampler>(
+        sampling_config.sampling_rate, sampling_config.max_events_per_second));
+  }
+}
+
 void TraceLog::GetKnownCategoryGroups(
     std::vector<std::string>* category_groups) {
   for (const auto& category : CategoryRegistry::GetAllCategories()) {
@@ -572,11 +627,13 @@ void TraceLog::SetEnabled(const TraceConfig& trace_config,
       return;
     }
 
-    // Clear all filters from previous tracing session. These filters are not
-    // cleared at the end of tracing because some threads which hit trace event
-    // when disabling, could try to use the filters.
-    if (!enabled_modes_)
+    // Clear all filters and samplers from previous tracing session. These are
+    // not cleared at the end of tracing because some threads which hit trace
+    // event when disabling, could try to use them.
+    if (!enabled_modes_) {
       GetCategoryGroupFilters().clear();
+      GetCategorySamplers().clear();
+    }
 
     // Update trace config for recording.
     const bool already_recording = enabled_modes_ & RECORDING_MODE;
@@ -616,6 +673,9 @@ void TraceLog::SetEnabled(const TraceConfig& trace_config,
       UseNextTraceBuffer();
     }
 
+    if (trace_config_.IsTSCClockEnabled())
+      TraceClock::EnableTSC();
+
     num_traces_recorded_++;
 
     UpdateCategoryRegistry();
@@ -701,8 +761,10 @@ void TraceLog::SetDisabledWhileLocked(uint8_t modes_to_disable) {
   if (modes_to_disable & FILTERING_MODE)
     enabled_event_filters_.clear();
 
-  if (modes_to_disable & RECORDING_MODE)
+  if (modes_to_disable & RECORDING_MODE) {
     trace_config_.Clear();
+    TraceClock::DisableTSC();
+  }
 
   UpdateCategoryRegistry();
 
@@ -826,17 +888,87 @@ void TraceLog::CheckIfBufferIsFullWhileLocked() {
 // 4. If any thread hasn't finish its flush in time, finish the flush.
 void TraceLog::Flush(const TraceLog::OutputCallback& cb,
                      bool use_worker_thread) {
-  FlushInternal(cb, use_worker_thread, false);
+  FlushInternal(cb, use_worker_thread, false, false);
+}
+
+void TraceLog::FlushAsBinary(const TraceLog::OutputCallback& cb,
+                             bool use_worker_thread) {
+  FlushInternal(cb, use_worker_thread, false, true);
+}
+
+#if defined(OS_POSIX)
+bool TraceLog::WriteSnapshot(int fd) {
+  HEAP_PROFILER_SCOPED_IGNORE;
+  // Same format as the output of TraceResultBuffer.
+  std::string json = "[";
+  json.reserve(kTraceEventBufferSizeInBytes * 5 / 4);
+  bool success = true;
+  bool needs_comma = false;
+  auto append_event = [&](const TraceEvent& event,
+                          const ArgumentFilterPredicate& predicate) {
+    if (json.size() > kTraceEventBufferSizeInBytes) {
+      success &= WriteFileDescriptor(fd, json.data(),
+                                     static_cast<int>(json.size()));
+      json.clear();
+    }
+    if (needs_comma)
+      json.append(",\n");
+    needs_comma = true;
+    event.AppendAsJSON(&json, predicate);
+  };
+
+  {
+    // The chunks which aren't in flight only change while the lock is held.
+    AutoLock lock(lock_);
+    ArgumentFilterPredicate argument_filter_predicate;
+    if (trace_options() & kInternalEnableArgumentFilter)
+      argument_filter_predicate = argument_filter_predicate_;
+
+    if (logged_events_) {
+      logged_events_->ResetIteration();
+      while (const TraceBufferChunk* chunk = logged_events_->NextChunk()) {
+        for (size_t i = 0; i < chunk->size(); ++i)
+          append_event(*chunk->GetEventAt(i), argument_filter_predicate);
+      }
+      // Leave the buffer as it was, for Flush().
+      logged_events_->ResetIteration();
+    }
+    if (thread_shared_chunk_) {
+      for (size_t i = 0; i < thread_shared_chunk_->size(); ++i) {
+        append_event(*thread_shared_chunk_->GetEventAt(i),
+                     argument_filter_predicate);
+      }
+    }
+
+    // Of the metadata which AddMetadataEventsWhileLocked() adds to the buffer
+    // for Flush(), only the thread names are written, and not added.
+    AutoLock thread_info_lock(thread_info_lock_);
+    for (const auto& it : thread_names_) {
+      if (it.second.empty())
+        continue;
+      TraceEvent event;
+      InitializeMetadataEvent(&event, it.first, "thread_name", "name",
+                              it.second);
+      append_event(event, argument_filter_predicate);
+    }
+  }
+
+  json.append("]");
+  success &=
+      WriteFileDescriptor(fd, json.data(), static_cast<int>(json.size()));
+  return success;
 }
+#endif  // defined(OS_POSIX)
 
 void TraceLog::CancelTracing(const OutputCallback& cb) {
   SetDisabled();
-  FlushInternal(cb, false, true);
+  FlushInternal(cb, false, true, false);
 }
 
 void TraceLog::FlushInternal(const TraceLog::OutputCallback& cb,
                              bool use_worker_thread,
-                             bool discard_events) {
+                             bool discard_events,
+                             bool binary) {
   use_worker_thread_ = use_worker_thread;
   if (IsEnabled()) {
     // Can't flush when tracing is enabled because otherwise PostTask would
@@ -862,6 +994,7 @@ void TraceLog::FlushInternal(const TraceLog::OutputCallback& cb,
                              : nullptr;
     DCHECK(thread_message_loops_.empty() || flush_task_runner_);
     flush_output_callback_ = cb;
+    flush_as_binary_ = binary;
 
     if (thread_shared_chunk_) {
       logged_events_->ReturnChunk(thread_shared_chunk_index_,
@@ -903,7 +1036,10 @@ void TraceLog::ConvertTraceEventsToTraceFormat(
   scoped_refptr<RefCountedString> json_events_str_ptr = new RefCountedString();
   const size_t kReserveCapacity = kTraceEventBufferSizeInBytes * 5 / 4;
   json_events_str_ptr->data().reserve(kReserveCapacity);
-  while (const TraceBufferChunk* chunk = logged_events->NextChunk()) {
+  // The chunks are freed as they are serialized, for the flush not to hold
+  // both the events and their serialization.
+  while (std::unique_ptr<TraceBufferChunk> chunk =
+             logged_events->TakeNextChunk()) {
     for (size_t j = 0; j < chunk->size(); ++j) {
       size_t size = json_events_str_ptr->size();
       if (size > kTraceEventBufferSizeInBytes) {
@@ -920,9 +1056,36 @@ void TraceLog::ConvertTraceEventsToTraceFormat(
   flush_output_callback.Run(json_events_str_ptr, false);
 }
 
+void TraceLog::ConvertTraceEventsToBinaryFormat(
+    std::unique_ptr<TraceBuffer> logged_events,
+    const OutputCallback& flush_output_callback,
+    const ArgumentFilterPredicate& argument_filter_predicate) {
+  if (flush_output_callback.is_null())
+    return;
+
+  HEAP_PROFILER_SCOPED_IGNORE;
+  TraceEventBinaryWriter writer(argument_filter_predicate);
+  scoped_refptr<RefCountedString> events_str_ptr = new RefCountedString();
+  const size_t kReserveCapacity = kTraceEventBufferSizeInBytes * 5 / 4;
+  events_str_ptr->data().reserve(kReserveCapacity);
+  while (std::unique_ptr<TraceBufferChunk> chunk =
+             logged_events->TakeNextChunk()) {
+    for (size_t j = 0; j < chunk->size(); ++j) {
+      if (events_str_ptr->size() > kTraceEventBufferSizeInBytes) {
+        flush_output_callback.Run(events_str_ptr, true);
+        events_str_ptr = new RefCountedString();
+        events_str_ptr->data().reserve(kReserveCapacity);
+      }
+      writer.AppendEvent(*chunk->GetEventAt(j), &events_str_ptr->data());
+    }
+  }
+  flush_output_callback.Run(events_str_ptr, false);
+}
+
 void TraceLog::FinishFlush(int generation, bool discard_events) {
   std::unique_ptr<TraceBuffer> previous_logged_events;
   OutputCallback flush_output_callback;
+  bool flush_as_binary;
   ArgumentFilterPredicate argument_filter_predicate;
 
   if (!CheckGeneration(generation))
@@ -938,6 +1101,7 @@ void TraceLog::FinishFlush(int generation, bool discard_events) {
     flush_task_runner_ = nullptr;
     flush_output_callback = flush_output_callback_;
     flush_output_callback_.Reset();
+    flush_as_binary = flush_as_binary_;
 
     if (trace_options() & kInternalEnableArgumentFilter) {
       CHECK(!argument_filter_predicate_.is_null());
@@ -953,20 +1117,21 @@ void TraceLog::FinishFlush(int generation, bool discard_events) {
     return;
   }
 
+  auto convert_trace_events = flush_as_binary
+                                  ? &TraceLog::ConvertTraceEventsToBinaryFormat
+                                  : &TraceLog::ConvertTraceEventsToTraceFormat;
   if (use_worker_thread_) {
     base::PostTaskWithTraits(
         FROM_HERE,
         {MayBlock(), TaskPriority::BACKGROUND,
          TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN},
-        BindOnce(&TraceLog::ConvertTraceEventsToTraceFormat,
-                 std::move(previous_logged_events), flush_output_callback,
-                 argument_filter_predicate));
+        BindOnce(convert_trace_events, std::move(previous_logged_events),
+                 flush_output_callback, argument_filter_predicate));
     return;
   }
 
-  ConvertTraceEventsToTraceFormat(std::move(previous_logged_events),
-                                  flush_output_callback,
-                                  argument_filter_predicate);
+  convert_trace_events(std::move(previous_logged_events),
+                       flush_output_callback, argument_filter_predicate);
 }
 
 // Run in each thread holding a local event buffer.
@@ -1185,6 +1350,16 @@ TraceEventHandle TraceLog::AddTraceEventWithThreadIdAndTimestamp(
   DCHECK(name);
   DCHECK(!timestamp.is_null());
 
+  // Drop the events which aren't sampled before doing any work for them,
+  // unless they still have to be filtered.
+  bool sampled_out =
+      (*category_group_enabled & TraceCategory::ENABLED_FOR_SAMPLING) &&
+      !ShouldRecordSampledEvent(category_group_enabled, timestamp);
+  if (sampled_out &&
+      !(*category_group_enabled & TraceCategory::ENABLED_FOR_FILTERING)) {
+    return handle;
+  }
+
   if (flags & TRACE_EVENT_FLAG_MANGLE_ID) {
     if ((flags & TRACE_EVENT_FLAG_FLOW_IN) ||
         (flags & TRACE_EVENT_FLAG_FLOW_OUT))
@@ -1207,7 +1382,7 @@ TraceEventHandle TraceLog::AddTraceEventWithThreadIdAndTimestamp(
   // current thread to avoid locks in most cases.
   if (thread_id == static_cast<int>(PlatformThread::CurrentId())) {
     const char* new_name =
-        ThreadIdNameManager::GetInstance()->GetName(thread_id);
+        ThreadIdNameManager::GetInstance()->GetNameForCurrentThread();
     // Check if the thread name has been set or changed since the previous
     // call (if any), but don't bother if the new name is empty. Note this will
     // not detect a thread name change within the same char* buffer address: we
@@ -1284,7 +1459,7 @@ TraceEventHandle TraceLog::AddTraceEventWithThreadIdAndTimestamp(
   // If enabled for recording, the event should be added only if one of the
   // filters indicates or category is not enabled for filtering.
   if ((*category_group_enabled & TraceCategory::ENABLED_FOR_RECORDING) &&
-      !disabled_by_filters) {
+      !disabled_by_filters && !sampled_out) {
     OptionalAutoLock lock(&lock_);
 
     TraceEvent* trace_event = nullptr;
@@ -1647,7 +1822,7 @@ TraceBuffer* TraceLog::CreateTraceBuffer() {
   HEAP_PROFILER_SCOPED_IGNORE;
   InternalTraceOptions options = trace_options();
   if (options & kInternalRecordContinuously) {
-    return TraceBuffer::CreateTraceBufferRingBuffer(
+    return TraceBuffer::CreateTraceBufferCompactingRingBuffer(
         kTraceEventRingBufferChunks);
   }
   if (options & kInternalEchoToConsole) {
@@ -1689,6 +1864,10 @@ void ConvertableToTraceFormat::EstimateTraceMemoryOverhead(
                 sizeof(*this));
 }
 
+bool ConvertableToTraceFormat::AppendAsBinaryFormat(std::string* out) const {
+  return false;
+}
+
 void TraceLog::AddAsyncEnabledStateObserver(
     WeakPtr<AsyncEnabledStateObserver> listener) {
   AutoLock lock(lock_);
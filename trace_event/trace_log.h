@@ -17,8 +17,8 @@
 #include "base/containers/stack.h"
 #include "base/gtest_prod_util.h"
 #include "base/macros.h"
-#include "base/time/time_override.h"
 #include "base/trace_event/memory_dump_provider.h"
+#include "base/trace_event/trace_clock.h"
 #include "base/trace_event/trace_config.h"
 #include "base/trace_event/trace_event_impl.h"
 #include "build/build_config.h"
@@ -175,6 +175,22 @@ class BASE_EXPORT TraceLog : public MemoryDumpProvider {
                               bool has_more_events)> OutputCallback;
   void Flush(const OutputCallback& cb, bool use_worker_thread = false);
 
+  // Same as Flush(), except that the events are serialized with
+  // TraceEventBinaryWriter instead of as JSON. The chunks passed to |cb| must
+  // be concatenated in order to be read.
+  void FlushAsBinary(const OutputCallback& cb, bool use_worker_thread = false);
+
+#if defined(OS_POSIX)
+  // Writes the events collected so far to |fd| as a JSON trace, without
+  // disabling tracing and without posting tasks to the threads, e.g. to record
+  // what led to a slow request or a crash. With RECORD_CONTINUOUSLY, this turns
+  // the ring buffer into a flight recorder keeping the latest events in fixed
+  // memory. Unlike Flush(), the events of the chunks still held by the threads
+  // (less than a chunk per thread) are left out. Threads needing a new chunk
+  // wait for the snapshot to be written. Returns false if writing failed.
+  bool WriteSnapshot(int fd);
+#endif
+
   // Cancels tracing and discards collected data.
   void CancelTracing(const OutputCallback& cb);
 
@@ -383,6 +399,7 @@ class BASE_EXPORT TraceLog : public MemoryDumpProvider {
   void UpdateCategoryState(TraceCategory* category);
 
   void CreateFiltersForTraceConfig();
+  void CreateSamplersForTraceConfig();
 
   InternalTraceOptions GetInternalOptionsFromTraceConfig(
       const TraceConfig& config);
@@ -417,7 +434,8 @@ class BASE_EXPORT TraceLog : public MemoryDumpProvider {
 
   void FlushInternal(const OutputCallback& cb,
                      bool use_worker_thread,
-                     bool discard_events);
+                     bool discard_events,
+                     bool binary);
 
   // |generation| is used in the following callbacks to check if the callback
   // is called for the flush of the current |logged_events_|.
@@ -427,6 +445,10 @@ class BASE_EXPORT TraceLog : public MemoryDumpProvider {
       std::unique_ptr<TraceBuffer> logged_events,
       const TraceLog::OutputCallback& flush_output_callback,
       const ArgumentFilterPredicate& argument_filter_predicate);
+  static void ConvertTraceEventsToBinaryFormat(
+      std::unique_ptr<TraceBuffer> logged_events,
+      const TraceLog::OutputCallback& flush_output_callback,
+      const ArgumentFilterPredicate& argument_filter_predicate);
   void FinishFlush(int generation, bool discard_events);
   void OnFlushTimeout(int generation, bool discard_events);
 
@@ -439,8 +461,7 @@ class BASE_EXPORT TraceLog : public MemoryDumpProvider {
   void UseNextTraceBuffer();
 
   TimeTicks OffsetNow() const {
-    // This should be TRACE_TIME_TICKS_NOW but include order makes that hard.
-    return OffsetTimestamp(base::subtle::TimeTicksNowIgnoringOverride());
+    return OffsetTimestamp(TraceClock::Now());
   }
   TimeTicks OffsetTimestamp(const TimeTicks& timestamp) const {
     return timestamp - time_offset_;
@@ -511,6 +532,7 @@ class BASE_EXPORT TraceLog : public MemoryDumpProvider {
 
   // Set when asynchronous Flush is in progress.
   OutputCallback flush_output_callback_;
+  bool flush_as_binary_;
   scoped_refptr<SingleThreadTaskRunner> flush_task_runner_;
   ArgumentFilterPredicate argument_filter_predicate_;
   subtle::AtomicWord generation_;
@@ -4,9 +4,8 @@
 
 #include "base/unguessable_token.h"
 
-#include "base/format_macros.h"
+#include "base/guid.h"
 #include "base/rand_util.h"
-#include "base/strings/stringprintf.h"
 
 namespace base {
 
@@ -14,7 +13,10 @@ UnguessableToken::UnguessableToken(uint64_t high, uint64_t low)
     : high_(high), low_(low) {}
 
 std::string UnguessableToken::ToString() const {
-  return base::StringPrintf("%016" PRIX64 "%016" PRIX64, high_, low_);
+  std::string result(32, '\0');
+  char* end = internal::WriteHexDigits(high_, 16, true, &result[0]);
+  internal::WriteHexDigits(low_, 16, true, end);
+  return result;
 }
 
 // static
@@ -0,0 +1,81 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/value_path.h"
+
+#include "base/logging.h"
+#include "base/strings/string_util.h"
+
+namespace base {
+
+ValuePath::Component::Component(StringPiece key) : key(key.as_string()) {}
+
+ValuePath::ValuePath(std::initializer_list<StringPiece> path)
+    : ValuePath(make_span(path.begin(), path.size())) {}
+
+ValuePath::ValuePath(span<const StringPiece> path) {
+  components_.reserve(path.size());
+  for (const StringPiece key : path)
+    components_.emplace_back(key);
+}
+
+ValuePath::ValuePath(ValuePath&& other) = default;
+
+ValuePath& ValuePath::operator=(ValuePath&& other) = default;
+
+ValuePath::~ValuePath() = default;
+
+// static
+ValuePath ValuePath::FromDottedPath(StringPiece path) {
+  DCHECK(IsStringUTF8(path));
+  std::vector<StringPiece> components;
+  for (size_t delimiter_position = path.find('.');
+       delimiter_position != StringPiece::npos;
+       delimiter_position = path.find('.')) {
+    components.push_back(path.substr(0, delimiter_position));
+    path = path.substr(delimiter_position + 1);
+  }
+  components.push_back(path);
+  return ValuePath(components);
+}
+
+const Value* ValuePath::Find(const Value& root) {
+  const Value* current = &root;
+  for (Component& component : components_) {
+    if (!current->is_dict())
+      return nullptr;
+    const Value::DictStorage& dict = current->dict_;
+    // Keys are unique, so the key at the hint is the one searched for if it
+    // compares equal, whatever changed in the dictionary since.
+    if (component.hint < dict.size() &&
+        (dict.begin() + component.hint)->first == component.key) {
+      current = (dict.begin() + component.hint)->second.get();
+      continue;
+    }
+    auto found = dict.find(component.key);
+    if (found == dict.end())
+      return nullptr;
+    component.hint = found - dict.begin();
+    current = found->second.get();
+  }
+  return current;
+}
+
+Value* ValuePath::Find(Value* root) {
+  return const_cast<Value*>(Find(*static_cast<const Value*>(root)));
+}
+
+const Value* ValuePath::FindOfType(const Value& root, Value::Type type) {
+  const Value* result = Find(root);
+  if (!result || result->type() != type)
+    return nullptr;
+  return result;
+}
+
+Value* ValuePath::FindOfType(Value* root, Value::Type type) {
+  return const_cast<Value*>(
+      FindOfType(*static_cast<const Value*>(root), type));
+}
+
+}  // namespace base
@@ -0,0 +1,79 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_VALUE_PATH_H_
+#define BASE_VALUE_PATH_H_
+
+#include <stddef.h>
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+
+namespace base {
+
+// ValuePath is a path through nested dictionaries, split once, for lookups
+// which are repeated, e.g. when polling the same settings of a configuration.
+// Value::FindPath() and the dotted paths of DictionaryValue search each
+// dictionary by binary search, comparing keys at every step; a ValuePath
+// remembers where each of its keys was found, and only searches again when
+// the key isn't there anymore, so lookups in dictionaries which didn't change
+// cost a key comparison per component.
+//
+// Lookups update the remembered positions, so a ValuePath must not be used on
+// several threads at once, even if the Values it is used with are const.
+//
+// Example:
+//
+//   ValuePath path = ValuePath::FromDottedPath("net.proxy.port");
+//   ...
+//   const Value* port = path.FindOfType(config, Value::Type::INTEGER);
+class BASE_EXPORT ValuePath {
+ public:
+  explicit ValuePath(std::initializer_list<StringPiece> path);
+  explicit ValuePath(span<const StringPiece> path);
+  ValuePath(ValuePath&& other);
+  ValuePath& operator=(ValuePath&& other);
+  ~ValuePath();
+
+  // Returns the path of the components of |path| separated by '.', as used by
+  // DictionaryValue::Get().
+  static ValuePath FromDottedPath(StringPiece path);
+
+  // Returns the Value at this path from |root|, or null if there is none. The
+  // path doesn't need to be in dictionaries: the same ValuePath can be used
+  // with different roots, although lookups are only faster when it is used
+  // repeatedly with the same dictionaries.
+  const Value* Find(const Value& root);
+  Value* Find(Value* root);
+
+  // Like Find(), but only returns the Value if it has type |type|.
+  const Value* FindOfType(const Value& root, Value::Type type);
+  Value* FindOfType(Value* root, Value::Type type);
+
+  size_t size() const { return components_.size(); }
+
+ private:
+  struct Component {
+    explicit Component(StringPiece key);
+
+    std::string key;
+    // The index at which |key| was last found in its dictionary.
+    size_t hint = 0;
+  };
+
+  std::vector<Component> components_;
+
+  DISALLOW_COPY_AND_ASSIGN(ValuePath);
+};
+
+}  // namespace base
+
+#endif  // BASE_VALUE_PATH_H_
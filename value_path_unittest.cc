@@ -0,0 +1,104 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/value_path.h"
+
+#include <string>
+#include <vector>
+
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Returns {"a": {"b": {"c": 1, "d": "foo"}, "e": 2}, "f": [3]}.
+Value MakeValue() {
+  Value b(Value::Type::DICTIONARY);
+  b.SetKey("c", Value(1));
+  b.SetKey("d", Value("foo"));
+  Value a(Value::Type::DICTIONARY);
+  a.SetKey("b", std::move(b));
+  a.SetKey("e", Value(2));
+  Value list(Value::Type::LIST);
+  list.GetList().emplace_back(3);
+  Value root(Value::Type::DICTIONARY);
+  root.SetKey("a", std::move(a));
+  root.SetKey("f", std::move(list));
+  return root;
+}
+
+}  // namespace
+
+TEST(ValuePathTest, Find) {
+  Value root = MakeValue();
+  ValuePath path({"a", "b", "c"});
+  EXPECT_EQ(3u, path.size());
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_TRUE(path.Find(root));
+    EXPECT_EQ(Value(1), *path.Find(root));
+    EXPECT_EQ(root.FindPath({"a", "b", "c"}), path.Find(root));
+  }
+  EXPECT_EQ(Value(2), *ValuePath({"a", "e"}).Find(root));
+  EXPECT_EQ(&root, ValuePath(span<const StringPiece>()).Find(root));
+
+  EXPECT_FALSE(ValuePath({"a", "x"}).Find(root));
+  EXPECT_FALSE(ValuePath({"a", "b", "c", "d"}).Find(root));
+  // Lists aren't searched.
+  EXPECT_FALSE(ValuePath({"f", "0"}).Find(root));
+
+  Value* found = path.Find(&root);
+  ASSERT_TRUE(found);
+  *found = Value(5);
+  EXPECT_EQ(Value(5), *root.FindPath({"a", "b", "c"}));
+}
+
+TEST(ValuePathTest, FindOfType) {
+  Value root = MakeValue();
+  ValuePath path({"a", "b", "d"});
+  EXPECT_EQ("foo", path.FindOfType(root, Value::Type::STRING)->GetString());
+  EXPECT_FALSE(path.FindOfType(root, Value::Type::INTEGER));
+  EXPECT_TRUE(path.FindOfType(&root, Value::Type::STRING));
+}
+
+TEST(ValuePathTest, FromDottedPath) {
+  Value root = MakeValue();
+  ValuePath path = ValuePath::FromDottedPath("a.b.d");
+  EXPECT_EQ(3u, path.size());
+  EXPECT_EQ(Value("foo"), *path.Find(root));
+  EXPECT_EQ(1u, ValuePath::FromDottedPath("a").size());
+  EXPECT_EQ(3u, ValuePath::FromDottedPath("a..").size());
+  EXPECT_FALSE(ValuePath::FromDottedPath("a..").Find(root));
+}
+
+// Lookups are still correct when the dictionaries change, which moves the keys
+// found by previous lookups, and when the path is used with other roots.
+TEST(ValuePathTest, ChangedDictionaries) {
+  Value root = MakeValue();
+  ValuePath path({"a", "e"});
+  EXPECT_EQ(Value(2), *path.Find(root));
+
+  // Moves "e" after new keys.
+  Value* a = root.FindKey("a");
+  for (const char* key : {"c", "d", "0", "ee"})
+    a->SetKey(key, Value(key));
+  EXPECT_EQ(Value(2), *path.Find(root));
+
+  // Moves "e" before the key where it was.
+  a->RemoveKey("b");
+  a->RemoveKey("c");
+  EXPECT_EQ(Value(2), *path.Find(root));
+
+  a->RemoveKey("e");
+  EXPECT_FALSE(path.Find(root));
+  a->SetKey("e", Value(3));
+  EXPECT_EQ(Value(3), *path.Find(root));
+
+  Value other = MakeValue();
+  EXPECT_EQ(Value(2), *path.Find(other));
+  EXPECT_EQ(Value(3), *path.Find(root));
+}
+
+}  // namespace base
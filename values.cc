@@ -292,23 +292,31 @@ bool Value::RemoveKey(StringPiece key) {
 
 Value* Value::SetKey(StringPiece key, Value value) {
   CHECK(is_dict());
+  // The value of an existing key is assigned in place, which saves allocating
+  // a new Value for it.
+  auto found = dict_.lower_bound(key);
+  if (found != dict_.end() && found->first == key) {
+    *found->second = std::move(value);
+    return found->second.get();
+  }
   // NOTE: We can't use |insert_or_assign| here, as only |try_emplace| does
   // an explicit conversion from StringPiece to std::string if necessary.
-  auto val_ptr = std::make_unique<Value>(std::move(value));
-  auto result = dict_.try_emplace(key, std::move(val_ptr));
-  if (!result.second) {
-    // val_ptr is guaranteed to be still intact at this point.
-    result.first->second = std::move(val_ptr);
-  }
-  return result.first->second.get();
+  return dict_
+      .try_emplace(found, key, std::make_unique<Value>(std::move(value)))
+      ->second.get();
 }
 
 Value* Value::SetKey(std::string&& key, Value value) {
   CHECK(is_dict());
+  auto found = dict_.lower_bound(key);
+  if (found != dict_.end() && found->first == key) {
+    *found->second = std::move(value);
+    return found->second.get();
+  }
   return dict_
-      .insert_or_assign(std::move(key),
-                        std::make_unique<Value>(std::move(value)))
-      .first->second.get();
+      .try_emplace(found, std::move(key),
+                   std::make_unique<Value>(std::move(value)))
+      ->second.get();
 }
 
 Value* Value::SetKey(const char* key, Value value) {
@@ -365,6 +365,9 @@ class BASE_EXPORT Value {
   };
 
  private:
+  // Looks up keys in |dict_| by position.
+  friend class ValuePath;
+
   void InternalMoveConstructFrom(Value&& that);
   void InternalCleanup();
 
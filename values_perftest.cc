@@ -0,0 +1,129 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "base/value_path.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+constexpr int kIterations = 10;
+
+// Returns |count| keys, long enough not to fit in the inline buffer of a
+// std::string for half of them.
+std::vector<std::string> GenerateKeys(int count) {
+  std::vector<std::string> keys;
+  for (int i = 0; i < count; ++i) {
+    keys.push_back((i % 2 ? "a_rather_long_key_" : "key_") + IntToString(i));
+  }
+  return keys;
+}
+
+// Generates a list of |count| dictionaries with the members named |keys|.
+Value GenerateDictList(int count, const std::vector<std::string>& keys) {
+  Value list(Value::Type::LIST);
+  list.GetList().reserve(count);
+  for (int i = 0; i < count; ++i) {
+    Value dict(Value::Type::DICTIONARY);
+    for (size_t j = 0; j < keys.size(); ++j)
+      dict.SetKey(keys[j], Value(static_cast<int>(j)));
+    list.GetList().push_back(std::move(dict));
+  }
+  return list;
+}
+
+}  // namespace
+
+class ValuesPerfTest : public testing::Test {
+ public:
+  void TestDictionaries(int count, int key_count) {
+    const std::string description = "Count: " + IntToString(count) +
+                                    ", Keys: " + IntToString(key_count);
+    const std::vector<std::string> keys = GenerateKeys(key_count);
+
+    TimeTicks start = TimeTicks::Now();
+    Value list = GenerateDictList(count, keys);
+    perf_test::PrintResult("Construct", "", description,
+                           (TimeTicks::Now() - start).InMillisecondsF(), "ms",
+                           true);
+
+    start = TimeTicks::Now();
+    int sum = 0;
+    for (int i = 0; i < kIterations; ++i) {
+      for (const Value& dict : list.GetList()) {
+        for (const std::string& key : keys)
+          sum += dict.FindKey(key)->GetInt();
+      }
+    }
+    perf_test::PrintResult("Lookup", "", description,
+                           (TimeTicks::Now() - start).InMillisecondsF(), "ms",
+                           true);
+    EXPECT_GT(sum, 0);
+
+    start = TimeTicks::Now();
+    for (Value& dict : list.GetList()) {
+      for (const std::string& key : keys)
+        dict.SetKey(key, Value(true));
+    }
+    perf_test::PrintResult("Overwrite", "", description,
+                           (TimeTicks::Now() - start).InMillisecondsF(), "ms",
+                           true);
+
+    start = TimeTicks::Now();
+    Value copy = list.Clone();
+    perf_test::PrintResult("Clone", "", description,
+                           (TimeTicks::Now() - start).InMillisecondsF(), "ms",
+                           true);
+
+    start = TimeTicks::Now();
+    copy = Value();
+    perf_test::PrintResult("Destroy", "", description,
+                           (TimeTicks::Now() - start).InMillisecondsF(), "ms",
+                           true);
+  }
+};
+
+TEST_F(ValuesPerfTest, Dictionaries) {
+  for (int key_count : {4, 16, 64})
+    TestDictionaries(10000, key_count);
+}
+
+// Compares repeated lookups of the same path with FindPath() and ValuePath.
+TEST_F(ValuesPerfTest, PathLookups) {
+  constexpr int kLookups = 1000000;
+  const std::vector<std::string> keys = GenerateKeys(64);
+  const Value leaf = std::move(GenerateDictList(1, keys).GetList()[0]);
+  Value middle = leaf.Clone();
+  middle.SetKey(keys[41], leaf.Clone());
+  Value root = leaf.Clone();
+  root.SetKey(keys[40], std::move(middle));
+  const std::vector<StringPiece> components = {keys[40], keys[41], keys[42]};
+
+  TimeTicks start = TimeTicks::Now();
+  int sum = 0;
+  for (int i = 0; i < kLookups; ++i)
+    sum += root.FindPath(components)->GetInt();
+  perf_test::PrintResult("PathLookup", "", "FindPath",
+                         (TimeTicks::Now() - start).InMillisecondsF(), "ms",
+                         true);
+
+  ValuePath path(components);
+  start = TimeTicks::Now();
+  for (int i = 0; i < kLookups; ++i)
+    sum -= path.Find(root)->GetInt();
+  perf_test::PrintResult("PathLookup", "", "ValuePath",
+                         (TimeTicks::Now() - start).InMillisecondsF(), "ms",
+                         true);
+  EXPECT_EQ(0, sum);
+}
+
+}  // namespace base
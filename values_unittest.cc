@@ -598,6 +598,21 @@ TEST(ValuesTest, SetKey) {
   EXPECT_EQ(Value(std::move(storage)), dict);
 }
 
+TEST(ValuesTest, SetKeyOverwrite) {
+  Value dict(Value::Type::DICTIONARY);
+  Value* value = dict.SetKey("key", Value(1));
+  Value* nested = dict.SetKey("nested", Value(Value::Type::DICTIONARY));
+  nested->SetKey("key", Value(2));
+
+  // The values of existing keys are assigned in place.
+  EXPECT_EQ(value, dict.SetKey(StringPiece("key"), Value("string")));
+  EXPECT_EQ(Value("string"), *value);
+  EXPECT_EQ(value, dict.SetKey(std::string("key"), Value(3)));
+  EXPECT_EQ(Value(3), *value);
+  EXPECT_EQ(nested, dict.SetKey("nested", nested->FindKey("key")->Clone()));
+  EXPECT_EQ(Value(2), *nested);
+}
+
 TEST(ValuesTest, FindPath) {
   // Construct a dictionary path {root}.foo.bar = 123
   Value foo(Value::Type::DICTIONARY);